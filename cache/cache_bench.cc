@@ -14,7 +14,11 @@ int main() {
 #include <stdio.h>
 #include <sys/types.h>
 #include <cinttypes>
+#include <cstdlib>
 #include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "port/port.h"
 #include "rocksdb/cache.h"
@@ -36,6 +40,10 @@ DEFINE_uint32(threads, 16, "Number of concurrent threads to run.");
 DEFINE_uint64(cache_size, 1 * GiB,
               "Number of bytes to use as a cache of uncompressed data.");
 DEFINE_uint32(num_shard_bits, 6, "shard_bits.");
+DEFINE_string(num_shard_bits_list, "",
+              "Comma-separated list of shard_bits values. When set, the "
+              "benchmark is repeated once per value instead of using "
+              "--num_shard_bits.");
 
 DEFINE_double(resident_ratio, 0.25,
               "Ratio of keys fitting in cache to keyspace.");
@@ -342,6 +350,8 @@ class CacheBench {
     printf("RocksDB version     : %d.%d\n", kMajorVersion, kMinorVersion);
     printf("Number of threads   : %u\n", FLAGS_threads);
     printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
+    printf("Cache type          : %s\n",
+           FLAGS_use_clock_cache ? "clock" : "lru");
     printf("Cache size          : %" PRIu64 "\n", FLAGS_cache_size);
     printf("Num shard bits      : %u\n", FLAGS_num_shard_bits);
     printf("Max key             : %" PRIu64 "\n", max_key_);
@@ -365,17 +375,31 @@ int main(int argc, char** argv) {
     exit(1);
   }
 
-  ROCKSDB_NAMESPACE::CacheBench bench;
-  if (FLAGS_populate_cache) {
-    bench.PopulateCache();
-    printf("Population complete\n");
-    printf("----------------------------\n");
-  }
-  if (bench.Run()) {
-    return 0;
+  std::vector<uint32_t> shard_bits_list;
+  if (FLAGS_num_shard_bits_list.empty()) {
+    shard_bits_list.push_back(FLAGS_num_shard_bits);
   } else {
-    return 1;
+    std::stringstream ss(FLAGS_num_shard_bits_list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+      shard_bits_list.push_back(
+          static_cast<uint32_t>(std::strtoul(item.c_str(), nullptr, 10)));
+    }
+  }
+
+  for (uint32_t shard_bits : shard_bits_list) {
+    FLAGS_num_shard_bits = shard_bits;
+    ROCKSDB_NAMESPACE::CacheBench bench;
+    if (FLAGS_populate_cache) {
+      bench.PopulateCache();
+      printf("Population complete\n");
+      printf("----------------------------\n");
+    }
+    if (!bench.Run()) {
+      return 1;
+    }
   }
+  return 0;
 }
 
 #endif  // GFLAGS
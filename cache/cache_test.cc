@@ -18,6 +18,7 @@
 #include "cache/lru_cache.h"
 #include "test_util/testharness.h"
 #include "util/coding.h"
+#include "util/random.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -307,6 +308,33 @@ TEST_P(CacheTest, HitAndMiss) {
   ASSERT_EQ(101, deleted_values_[0]);
 }
 
+TEST_P(CacheTest, MultiLookup) {
+  const int kNumKeys = 64;
+  for (int i = 0; i < kNumKeys; i += 2) {
+    Insert(i, i + 1000);
+  }
+
+  std::vector<std::string> encoded;
+  std::vector<Slice> keys;
+  for (int i = 0; i < kNumKeys; ++i) {
+    encoded.push_back(EncodeKey(i));
+  }
+  for (const auto& key : encoded) {
+    keys.emplace_back(key);
+  }
+  std::vector<Cache::Handle*> handles(kNumKeys);
+  cache_->MultiLookup(keys.data(), keys.size(), handles.data());
+  for (int i = 0; i < kNumKeys; ++i) {
+    if (i % 2 == 0) {
+      ASSERT_NE(handles[i], nullptr);
+      ASSERT_EQ(i + 1000, DecodeValue(cache_->Value(handles[i])));
+      cache_->Release(handles[i]);
+    } else {
+      ASSERT_EQ(handles[i], nullptr);
+    }
+  }
+}
+
 TEST_P(CacheTest, InsertSameKey) {
   Insert(1, 1);
   Insert(1, 2);
@@ -757,6 +785,61 @@ TEST_P(CacheTest, GetCharge) {
   cache_->Release(h1);
 }
 
+TEST_P(CacheTest, ConcurrentLookups) {
+  // One shard so that the threads evict and erase from the same hash table
+  // while looking it up
+  const int kNumKeys = 2000;
+  auto cache = NewCache(kNumKeys / 2, 0, false);
+  for (int i = 0; i < kNumKeys; i++) {
+    Insert(cache, i, i);
+  }
+  std::atomic<int> wrong_values(0);
+  auto worker = [&](uint32_t seed) {
+    Random rnd(seed);
+    for (int i = 0; i < 20000; i++) {
+      const int key = static_cast<int>(rnd.Uniform(kNumKeys));
+      switch (rnd.Uniform(4)) {
+        case 0:
+          ASSERT_OK(cache->Insert(EncodeKey(key), EncodeValue(key), 1,
+                                  &dumbDeleter));
+          break;
+        case 1:
+          cache->Erase(EncodeKey(key));
+          break;
+        default: {
+          Cache::Handle* handle = cache->Lookup(EncodeKey(key));
+          if (handle != nullptr) {
+            if (DecodeValue(cache->Value(handle)) != key) {
+              wrong_values++;
+            }
+            cache->Release(handle);
+          }
+        }
+      }
+    }
+  };
+  std::vector<port::Thread> threads;
+  for (uint32_t i = 0; i < 8; i++) {
+    threads.emplace_back(worker, i + 1);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, wrong_values.load());
+  ASSERT_LE(cache->GetUsage(), static_cast<size_t>(kNumKeys / 2));
+  // Entries still in the cache can be found
+  int found = 0;
+  for (int i = 0; i < kNumKeys; i++) {
+    Cache::Handle* handle = cache->Lookup(EncodeKey(i));
+    if (handle != nullptr) {
+      ASSERT_EQ(i, DecodeValue(cache->Value(handle)));
+      cache->Release(handle);
+      found++;
+    }
+  }
+  ASSERT_EQ(cache->GetUsage(), static_cast<size_t>(found));
+}
+
 #ifdef SUPPORT_CLOCK_CACHE
 std::shared_ptr<Cache> (*new_clock_cache_func)(
     size_t, int, bool, CacheMetadataChargePolicy) = NewClockCache;
@@ -27,13 +27,8 @@ std::shared_ptr<Cache> NewClockCache(
 #include <assert.h>
 #include <atomic>
 #include <deque>
-
-// "tbb/concurrent_hash_map.h" requires RTTI if exception is enabled.
-// Disable it so users can chooose to disable RTTI.
-#ifndef ROCKSDB_USE_RTTI
-#define TBB_USE_EXCEPTIONS 0
-#endif
-#include "tbb/concurrent_hash_map.h"
+#include <memory>
+#include <vector>
 
 #include "cache/sharded_cache.h"
 #include "port/malloc.h"
@@ -61,9 +56,9 @@ namespace {
 // to be re-use. This is to avoid memory dealocation, which is hard to deal
 // with in concurrent environment.
 //
-// The cache also maintains a concurrent hash map for lookup. Any concurrent
-// hash map implementation should do the work. We currently use
-// tbb::concurrent_hash_map because it supports concurrent erase.
+// The cache also maintains a hash table for lookup, ClockHashTable, which is
+// an open addressing table with linear probing that can be searched without
+// locking while it is modified.
 //
 // Each cache handle has the following flags and counters, which are squeeze
 // in an atomic interger, to make sure the handle always be in a consistent
@@ -135,7 +130,7 @@ namespace {
 //    recycle bin:   | 1 | 5 |
 //                   +---+---+
 //
-// A global mutex guards the circular list, the head, and the recycle bin.
+// A per-shard mutex guards the circular list, the head, and the recycle bin.
 // We additionally require that modifying the hash map needs to hold the mutex.
 // As such, Modifying the cache (such as Insert() and Erase()) require to
 // hold the mutex. Lookup() only access the hash map and the flags associated
@@ -227,25 +222,185 @@ struct CacheHandle {
   }
 };
 
-// Key of hash map. We store hash value with the key for convenience.
-struct CacheKey {
-  Slice key;
-  uint32_t hash_value;
+// Hash table from cache keys to cache handles, with open addressing and
+// linear probing. Lookup() takes no lock and may run concurrently with the
+// other methods, which must be called holding the shard mutex.
+//
+// Each slot holds a handle and its hash. Handles are never freed before the
+// table, so a lookup can read a handle it found even if the handle has been
+// erased since, and it verifies the key only once it holds a reference.
+// Erase() moves the following entries of the probe sequence back instead of
+// leaving tombstones, and bumps version_ around the moves, like a seqlock,
+// so that a lookup that raced with it and found nothing retries. The table
+// doubles when it gets half full; the old slots are kept until the table is
+// destroyed as lookups may still be reading them.
+class ClockHashTable {
+ public:
+  ClockHashTable() : version_(0), count_(0) { Grow(kInitialSize); }
+
+  // Returns the handle for which match(handle) returns true among the
+  // handles with the given hash, or nullptr. match() takes a reference on
+  // the handle before checking its key, and gives it back if it does not
+  // match.
+  template <typename Match>
+  CacheHandle* Lookup(uint32_t hash, const Match& match) const {
+    while (true) {
+      const uint64_t version = version_.load(std::memory_order_acquire);
+      if (version & 1) {
+        port::AsmVolatilePause();
+        continue;
+      }
+      const Slots* slots = slots_.load(std::memory_order_acquire);
+      size_t i = hash & slots->mask;
+      for (size_t probes = 0; probes <= slots->mask; probes++) {
+        const Slot& slot = slots->slots[i];
+        CacheHandle* handle = slot.handle.load(std::memory_order_acquire);
+        if (handle == nullptr) {
+          break;
+        }
+        if (slot.hash.load(std::memory_order_relaxed) == hash &&
+            match(handle)) {
+          return handle;
+        }
+        i = (i + 1) & slots->mask;
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (version_.load(std::memory_order_relaxed) == version) {
+        return nullptr;
+      }
+    }
+  }
 
-  CacheKey() = default;
+  // Returns the handle of the key, or nullptr. Requires the shard mutex.
+  CacheHandle* Find(const Slice& key, uint32_t hash) const {
+    const Slots* slots = slots_.load(std::memory_order_relaxed);
+    for (size_t i = hash & slots->mask;; i = (i + 1) & slots->mask) {
+      CacheHandle* handle =
+          slots->slots[i].handle.load(std::memory_order_relaxed);
+      if (handle == nullptr ||
+          (handle->hash == hash && handle->key == key)) {
+        return handle;
+      }
+    }
+  }
 
-  CacheKey(const Slice& k, uint32_t h) {
-    key = k;
-    hash_value = h;
+  // Inserts handle, which replaces the handle of the same key if there is
+  // one. Returns the replaced handle or nullptr. Requires the shard mutex.
+  CacheHandle* Insert(CacheHandle* handle) {
+    if ((count_ + 1) * 2 > slots_.load(std::memory_order_relaxed)->mask + 1) {
+      Grow(2 * (slots_.load(std::memory_order_relaxed)->mask + 1));
+    }
+    Slots* slots = slots_.load(std::memory_order_relaxed);
+    for (size_t i = handle->hash & slots->mask;; i = (i + 1) & slots->mask) {
+      Slot& slot = slots->slots[i];
+      CacheHandle* existing = slot.handle.load(std::memory_order_relaxed);
+      if (existing == nullptr) {
+        slot.hash.store(handle->hash, std::memory_order_relaxed);
+        slot.handle.store(handle, std::memory_order_release);
+        count_++;
+        return nullptr;
+      }
+      if (existing->hash == handle->hash && existing->key == handle->key) {
+        slot.handle.store(handle, std::memory_order_release);
+        return existing;
+      }
+    }
   }
 
-  static bool equal(const CacheKey& a, const CacheKey& b) {
-    return a.hash_value == b.hash_value && a.key == b.key;
+  // Removes handle, which must be in the table. Requires the shard mutex.
+  void Erase(CacheHandle* handle) {
+    Slots* slots = slots_.load(std::memory_order_relaxed);
+    const size_t mask = slots->mask;
+    size_t i = handle->hash & mask;
+    while (slots->slots[i].handle.load(std::memory_order_relaxed) != handle) {
+      assert(slots->slots[i].handle.load(std::memory_order_relaxed) !=
+             nullptr);
+      i = (i + 1) & mask;
+    }
+    const uint64_t version = version_.load(std::memory_order_relaxed);
+    version_.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    // Move back the entries that would not be found past the hole at i
+    for (size_t j = (i + 1) & mask;; j = (j + 1) & mask) {
+      Slot& slot = slots->slots[j];
+      CacheHandle* moved = slot.handle.load(std::memory_order_relaxed);
+      if (moved == nullptr) {
+        break;
+      }
+      const uint32_t moved_hash = slot.hash.load(std::memory_order_relaxed);
+      const size_t home = moved_hash & mask;
+      if (i <= j ? (i < home && home <= j) : (i < home || home <= j)) {
+        continue;
+      }
+      slots->slots[i].hash.store(moved_hash, std::memory_order_relaxed);
+      slots->slots[i].handle.store(moved, std::memory_order_relaxed);
+      i = j;
+    }
+    slots->slots[i].handle.store(nullptr, std::memory_order_relaxed);
+    version_.store(version + 2, std::memory_order_release);
+    count_--;
+  }
+
+  // Removes all the handles. Requires the shard mutex.
+  void Clear() {
+    Slots* slots = slots_.load(std::memory_order_relaxed);
+    const uint64_t version = version_.load(std::memory_order_relaxed);
+    version_.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i <= slots->mask; i++) {
+      slots->slots[i].handle.store(nullptr, std::memory_order_relaxed);
+    }
+    version_.store(version + 2, std::memory_order_release);
+    count_ = 0;
   }
 
-  static size_t hash(const CacheKey& a) {
-    return static_cast<size_t>(a.hash_value);
+ private:
+  static const size_t kInitialSize = 64;
+
+  struct Slot {
+    std::atomic<uint32_t> hash{0};
+    std::atomic<CacheHandle*> handle{nullptr};
+  };
+
+  struct Slots {
+    explicit Slots(size_t size) : mask(size - 1), slots(new Slot[size]) {}
+
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+  };
+
+  void Grow(size_t size) {
+    assert((size & (size - 1)) == 0);
+    Slots* grown = new Slots(size);
+    const Slots* slots = slots_.load(std::memory_order_relaxed);
+    if (slots != nullptr) {
+      for (size_t i = 0; i <= slots->mask; i++) {
+        CacheHandle* handle =
+            slots->slots[i].handle.load(std::memory_order_relaxed);
+        if (handle == nullptr) {
+          continue;
+        }
+        const uint32_t hash = slots->slots[i].hash.load(
+            std::memory_order_relaxed);
+        size_t j = hash & grown->mask;
+        while (grown->slots[j].handle.load(std::memory_order_relaxed) !=
+               nullptr) {
+          j = (j + 1) & grown->mask;
+        }
+        grown->slots[j].hash.store(hash, std::memory_order_relaxed);
+        grown->slots[j].handle.store(handle, std::memory_order_relaxed);
+      }
+    }
+    all_slots_.emplace_back(grown);
+    slots_.store(grown, std::memory_order_release);
   }
+
+  // Odd while entries are being moved
+  std::atomic<uint64_t> version_;
+  std::atomic<Slots*> slots_{nullptr};
+  // The current slots and the ones they replaced
+  std::vector<std::unique_ptr<Slots>> all_slots_;
+  size_t count_;
 };
 
 struct CleanupContext {
@@ -259,9 +414,6 @@ struct CleanupContext {
 // A cache shard which maintains its own CLOCK cache.
 class ClockCacheShard final : public CacheShard {
  public:
-  // Hash map type.
-  typedef tbb::concurrent_hash_map<CacheKey, CacheHandle*, CacheKey> HashTable;
-
   ClockCacheShard();
   ~ClockCacheShard() override;
 
@@ -377,8 +529,8 @@ class ClockCacheShard final : public CacheShard {
   // Whether allow insert into cache if cache is full.
   std::atomic<bool> strict_capacity_limit_;
 
-  // Hash table (tbb::concurrent_hash_map) for lookup.
-  HashTable table_;
+  // Hash table for lookup.
+  ClockHashTable table_;
 };
 
 ClockCacheShard::ClockCacheShard()
@@ -511,9 +663,7 @@ bool ClockCacheShard::TryEvict(CacheHandle* handle, CleanupContext* context) {
   uint32_t flags = kInCacheBit;
   if (handle->flags.compare_exchange_strong(flags, 0, std::memory_order_acquire,
                                             std::memory_order_relaxed)) {
-    bool erased __attribute__((__unused__)) =
-        table_.erase(CacheKey(handle->key, handle->hash));
-    assert(erased);
+    table_.Erase(handle);
     RecycleHandle(handle, context);
     return true;
   }
@@ -596,15 +746,14 @@ CacheHandle* ClockCacheShard::Insert(
   handle->charge = charge;
   handle->deleter = deleter;
   uint32_t flags = hold_reference ? kInCacheBit + kOneRef : kInCacheBit;
-  handle->flags.store(flags, std::memory_order_relaxed);
-  HashTable::accessor accessor;
-  if (table_.find(accessor, CacheKey(key, hash))) {
+  // Release semantics so that a lookup still holding the handle from before
+  // it was recycled sees the new key once its Ref() succeeds.
+  handle->flags.store(flags, std::memory_order_release);
+  CacheHandle* existing_handle = table_.Insert(handle);
+  if (existing_handle != nullptr) {
     *overwritten = true;
-    CacheHandle* existing_handle = accessor->second;
-    table_.erase(accessor);
     UnsetInCache(existing_handle, context);
   }
-  table_.insert(HashTable::value_type(CacheKey(key, hash), handle));
   if (hold_reference) {
     pinned_usage_.fetch_add(total_charge, std::memory_order_relaxed);
   }
@@ -618,7 +767,6 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                                Cache::Handle** out_handle,
                                Cache::Priority /*priority*/) {
   CleanupContext context;
-  HashTable::accessor accessor;
   char* key_data = new char[key.size()];
   memcpy(key_data, key.data(), key.size());
   Slice key_copy(key_data, key.size());
@@ -642,27 +790,24 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
 }
 
 Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  HashTable::const_accessor accessor;
-  if (!table_.find(accessor, CacheKey(key, hash))) {
-    return nullptr;
-  }
-  CacheHandle* handle = accessor->second;
-  accessor.release();
-  // Ref() could fail if another thread sneak in and evict/erase the cache
-  // entry before we are able to hold reference.
-  if (!Ref(reinterpret_cast<Cache::Handle*>(handle))) {
-    return nullptr;
-  }
-  // Double check the key since the handle may now representing another key
-  // if other threads sneak in, evict/erase the entry and re-used the handle
-  // for another cache entry.
-  if (hash != handle->hash || key != handle->key) {
-    CleanupContext context;
-    Unref(handle, false, &context);
-    // It is possible Unref() delete the entry, so we need to cleanup.
-    Cleanup(context);
-    return nullptr;
-  }
+  CleanupContext context;
+  CacheHandle* handle = table_.Lookup(hash, [&](CacheHandle* candidate) {
+    // Ref() could fail if another thread sneak in and evict/erase the cache
+    // entry before we are able to hold reference.
+    if (!Ref(reinterpret_cast<Cache::Handle*>(candidate))) {
+      return false;
+    }
+    // Double check the key since the handle may now representing another key
+    // if other threads sneak in, evict/erase the entry and re-used the handle
+    // for another cache entry.
+    if (hash != candidate->hash || key != candidate->key) {
+      Unref(candidate, false, &context);
+      return false;
+    }
+    return true;
+  });
+  // It is possible Unref() delete an entry, so we need to cleanup.
+  Cleanup(context);
   return reinterpret_cast<Cache::Handle*>(handle);
 }
 
@@ -686,11 +831,10 @@ void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
 bool ClockCacheShard::EraseAndConfirm(const Slice& key, uint32_t hash,
                                       CleanupContext* context) {
   MutexLock l(&mutex_);
-  HashTable::accessor accessor;
   bool erased = false;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* handle = accessor->second;
-    table_.erase(accessor);
+  CacheHandle* handle = table_.Find(key, hash);
+  if (handle != nullptr) {
+    table_.Erase(handle);
     erased = UnsetInCache(handle, context);
   }
   return erased;
@@ -700,7 +844,7 @@ void ClockCacheShard::EraseUnRefEntries() {
   CleanupContext context;
   {
     MutexLock l(&mutex_);
-    table_.clear();
+    table_.Clear();
     for (auto& handle : list_) {
       UnsetInCache(&handle, &context);
     }
@@ -0,0 +1,248 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/compressed_secondary_cache.h"
+
+#include <inttypes.h>
+
+#include "util/compression.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Same format as block based tables use, which stores the uncompressed size
+// for the compressions that do not record it themselves
+const uint32_t kCompressFormatVersion = 2;
+
+void DeleteStoredValue(const Slice& /*key*/, void* value) {
+  delete static_cast<std::string*>(value);
+}
+
+}  // namespace
+
+CompressedSecondaryCache::CompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts)
+    : opts_(opts),
+      cv_(&mutex_),
+      pending_bytes_(0),
+      in_flight_(0),
+      num_dropped_(0),
+      closing_(false) {
+  if (opts_.persistent_cache != nullptr) {
+    persistent_cache_ = opts_.persistent_cache;
+  } else {
+    cache_ = NewLRUCache(opts_.capacity, opts_.num_shard_bits);
+  }
+  thread_ = port::Thread(&CompressedSecondaryCache::BackgroundThread, this);
+}
+
+CompressedSecondaryCache::~CompressedSecondaryCache() {
+  {
+    MutexLock l(&mutex_);
+    closing_ = true;
+    cv_.SignalAll();
+  }
+  thread_.join();
+}
+
+Status CompressedSecondaryCache::Insert(const Slice& key, const Slice& value) {
+  MutexLock l(&mutex_);
+  if (closing_) {
+    return Status::ShutdownInProgress();
+  }
+  if (pending_bytes_ + value.size() > opts_.max_pending_bytes) {
+    num_dropped_++;
+    return Status::Incomplete("Secondary cache backlog is full");
+  }
+  std::string k = key.ToString();
+  auto it = pending_.find(k);
+  if (it != pending_.end()) {
+    pending_bytes_ -= it->second.size();
+    it->second.assign(value.data(), value.size());
+  } else {
+    pending_order_.push_back(k);
+    pending_.emplace(std::move(k), value.ToString());
+  }
+  pending_bytes_ += value.size();
+  cv_.Signal();
+  return Status::OK();
+}
+
+Status CompressedSecondaryCache::Lookup(const Slice& key, std::string* value) {
+  assert(value != nullptr);
+  {
+    MutexLock l(&mutex_);
+    auto it = pending_.find(key.ToString());
+    if (it != pending_.end()) {
+      *value = it->second;
+      return Status::OK();
+    }
+  }
+
+  Slice stored;
+  std::string stored_buf;
+  Cache::Handle* handle = nullptr;
+  std::unique_ptr<char[]> persistent_buf;
+  if (cache_ != nullptr) {
+    handle = cache_->Lookup(key);
+    if (handle == nullptr) {
+      return Status::NotFound();
+    }
+    stored = *static_cast<std::string*>(cache_->Value(handle));
+  } else {
+    size_t size = 0;
+    Status s = persistent_cache_->Lookup(key, &persistent_buf, &size);
+    if (!s.ok()) {
+      return Status::NotFound();
+    }
+    stored = Slice(persistent_buf.get(), size);
+  }
+
+  Status s;
+  if (stored.empty()) {
+    s = Status::Corruption("Empty secondary cache entry");
+  } else {
+    CompressionType type = static_cast<CompressionType>(stored[0]);
+    stored.remove_prefix(1);
+    if (type == kNoCompression) {
+      value->assign(stored.data(), stored.size());
+    } else {
+      UncompressionContext context(type);
+      UncompressionInfo info(context, UncompressionDict::GetEmptyDict(), type);
+      size_t uncompressed_size = 0;
+      CacheAllocationPtr uncompressed =
+          UncompressData(info, stored.data(), stored.size(), &uncompressed_size,
+                         kCompressFormatVersion);
+      if (!uncompressed) {
+        s = Status::Corruption("Cannot uncompress secondary cache entry");
+      } else {
+        value->assign(uncompressed.get(), uncompressed_size);
+      }
+    }
+  }
+  if (handle != nullptr) {
+    cache_->Release(handle);
+  }
+  return s;
+}
+
+void CompressedSecondaryCache::Erase(const Slice& key) {
+  std::string k = key.ToString();
+  {
+    MutexLock l(&mutex_);
+    auto it = pending_.find(k);
+    if (it != pending_.end()) {
+      // The key stays in pending_order_ and is skipped when popped
+      pending_bytes_ -= it->second.size();
+      pending_.erase(it);
+    }
+  }
+  // PersistentCache has no way to drop a single key; a stale copy there is
+  // harmless as the value of a key never changes and it ages out by itself.
+  if (cache_ != nullptr) {
+    cache_->Erase(key);
+  }
+}
+
+void CompressedSecondaryCache::Store(const std::string& key,
+                                     const std::string& value) {
+  std::string stored;
+  stored.reserve(value.size() + 1);
+  stored.push_back(static_cast<char>(kNoCompression));
+  if (opts_.compression_type != kNoCompression) {
+    CompressionOptions compression_opts;
+    CompressionContext context(opts_.compression_type);
+    CompressionInfo info(compression_opts, context,
+                         CompressionDict::GetEmptyDict(),
+                         opts_.compression_type,
+                         0 /* sample_for_compression */);
+    std::string compressed;
+    if (CompressData(value, info, kCompressFormatVersion, &compressed) &&
+        compressed.size() < value.size()) {
+      stored[0] = static_cast<char>(opts_.compression_type);
+      stored.append(compressed);
+    }
+  }
+  if (stored.size() == 1) {
+    stored.append(value);
+  }
+
+  if (cache_ != nullptr) {
+    std::string* buf = new std::string(std::move(stored));
+    Status s = cache_->Insert(key, buf, buf->size(), &DeleteStoredValue);
+    s.PermitUncheckedError();
+  } else {
+    Status s = persistent_cache_->Insert(key, stored.data(), stored.size());
+    s.PermitUncheckedError();
+  }
+}
+
+void CompressedSecondaryCache::BackgroundThread() {
+  MutexLock l(&mutex_);
+  while (true) {
+    while (pending_order_.empty() && !closing_) {
+      cv_.Wait();
+    }
+    if (closing_) {
+      break;
+    }
+    std::string key = std::move(pending_order_.front());
+    pending_order_.pop_front();
+    auto it = pending_.find(key);
+    if (it == pending_.end()) {
+      // Erased while pending
+      continue;
+    }
+    std::string value = std::move(it->second);
+    pending_.erase(it);
+    in_flight_++;
+    mutex_.Unlock();
+    Store(key, value);
+    mutex_.Lock();
+    // Keep the bytes accounted until the entry can be found in the store
+    pending_bytes_ -= value.size();
+    in_flight_--;
+    cv_.SignalAll();
+  }
+}
+
+void CompressedSecondaryCache::TEST_WaitForPending() {
+  MutexLock l(&mutex_);
+  while (!pending_order_.empty() || in_flight_ > 0) {
+    cv_.Wait();
+  }
+}
+
+size_t CompressedSecondaryCache::TEST_GetNumDropped() const {
+  MutexLock l(&mutex_);
+  return num_dropped_;
+}
+
+std::string CompressedSecondaryCache::GetPrintableOptions() const {
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize,
+           "    secondary_cache_capacity : %" ROCKSDB_PRIszt
+           "\n"
+           "    secondary_cache_compression_type : %d\n"
+           "    secondary_cache_max_pending_bytes : %" ROCKSDB_PRIszt
+           "\n"
+           "    secondary_cache_persistent : %d\n",
+           opts_.capacity, static_cast<int>(opts_.compression_type),
+           opts_.max_pending_bytes, persistent_cache_ != nullptr);
+  return std::string(buffer);
+}
+
+std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts) {
+  if (!CompressionTypeSupported(opts.compression_type)) {
+    return nullptr;
+  }
+  return std::make_shared<CompressedSecondaryCache>(opts);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
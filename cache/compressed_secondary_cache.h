@@ -0,0 +1,69 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "port/port.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/persistent_cache.h"
+#include "rocksdb/secondary_cache.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Secondary cache that compresses entries on a background thread and keeps
+// them either in an in-memory LRU cache or in a PersistentCache.
+//
+// Insert() only copies the entry into a pending queue, so eviction from the
+// primary cache does not pay for compression or device writes. Lookup()
+// checks the pending queue before the store, so an entry is visible as soon
+// as Insert() returns.
+//
+// Stored format: 1 byte CompressionType followed by the (compressed) value.
+class CompressedSecondaryCache : public SecondaryCache {
+ public:
+  explicit CompressedSecondaryCache(const CompressedSecondaryCacheOptions& opts);
+  ~CompressedSecondaryCache() override;
+
+  const char* Name() const override { return "CompressedSecondaryCache"; }
+
+  Status Insert(const Slice& key, const Slice& value) override;
+  Status Lookup(const Slice& key, std::string* value) override;
+  void Erase(const Slice& key) override;
+
+  std::string GetPrintableOptions() const override;
+
+  // Blocks until the background thread has stored every pending entry
+  void TEST_WaitForPending();
+  size_t TEST_GetNumDropped() const;
+
+ private:
+  void BackgroundThread();
+  void Store(const std::string& key, const std::string& value);
+
+  const CompressedSecondaryCacheOptions opts_;
+  // Only one of these is set
+  std::shared_ptr<Cache> cache_;
+  std::shared_ptr<PersistentCache> persistent_cache_;
+
+  mutable port::Mutex mutex_;
+  port::CondVar cv_;
+  // Entries waiting for the background thread, in insertion order. A key
+  // inserted again while pending just replaces the queued value.
+  std::unordered_map<std::string, std::string> pending_;
+  std::deque<std::string> pending_order_;
+  size_t pending_bytes_;
+  // Number of entries popped but not yet stored
+  int in_flight_;
+  size_t num_dropped_;
+  bool closing_;
+  port::Thread thread_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
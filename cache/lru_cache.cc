@@ -12,12 +12,74 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <string>
 
 #include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// Typical charge of a block cache entry, used to size the TinyLFU sketch
+// from the shard capacity
+const size_t kTinyLfuEntryChargeEstimate = 4096;
+const size_t kTinyLfuMaxSketchWords = size_t{1} << 22;
+
+const uint64_t kSketchSeeds[4] = {0xc3a5c85c97cb3127U, 0xb492b66fbe98f273U,
+                                  0x9ae16a3b2f90404fU, 0xcbf29ce484222325U};
+}  // namespace
+
+void FrequencySketch::Resize(size_t num_keys) {
+  size_t num_words = 16;
+  while (num_words < num_keys && num_words < kTinyLfuMaxSketchWords) {
+    num_words *= 2;
+  }
+  if (num_words == table_.size()) {
+    return;
+  }
+  table_.assign(num_words, 0);
+  mask_ = num_words - 1;
+  additions_ = 0;
+  sample_size_ = 10 * num_words;
+}
+
+void FrequencySketch::Increment(uint32_t hash) {
+  assert(!table_.empty());
+  bool added = false;
+  for (uint64_t seed : kSketchSeeds) {
+    // Only the high half of the product depends on all bits of hash
+    uint64_t h = uint64_t{hash} * seed;
+    uint64_t& word = table_[(h >> 32) & mask_];
+    int shift = static_cast<int>(h >> 60) * 4;
+    if (((word >> shift) & 0xf) < 0xf) {
+      word += uint64_t{1} << shift;
+      added = true;
+    }
+  }
+  if (added && ++additions_ >= sample_size_) {
+    Halve();
+  }
+}
+
+uint32_t FrequencySketch::Estimate(uint32_t hash) const {
+  assert(!table_.empty());
+  uint32_t result = 0xf;
+  for (uint64_t seed : kSketchSeeds) {
+    uint64_t h = uint64_t{hash} * seed;
+    uint64_t word = table_[(h >> 32) & mask_];
+    int shift = static_cast<int>(h >> 60) * 4;
+    result = std::min(result, static_cast<uint32_t>((word >> shift) & 0xf));
+  }
+  return result;
+}
+
+void FrequencySketch::Halve() {
+  for (uint64_t& word : table_) {
+    word = (word >> 1) & 0x7777777777777777U;
+  }
+  additions_ /= 2;
+}
+
 LRUHandleTable::LRUHandleTable() : list_(nullptr), length_(0), elems_(0) {
   Resize();
 }
@@ -98,15 +160,20 @@ void LRUHandleTable::Resize() {
 LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
                              double high_pri_pool_ratio,
                              bool use_adaptive_mutex,
-                             CacheMetadataChargePolicy metadata_charge_policy)
+                             CacheMetadataChargePolicy metadata_charge_policy,
+                             SecondaryCache* secondary_cache,
+                             bool tiny_lfu_admission)
     : capacity_(0),
+      secondary_cache_(secondary_cache),
       high_pri_pool_usage_(0),
       strict_capacity_limit_(strict_capacity_limit),
       high_pri_pool_ratio_(high_pri_pool_ratio),
       high_pri_pool_capacity_(0),
+      tiny_lfu_admission_(tiny_lfu_admission),
       usage_(0),
       lru_usage_(0),
-      mutex_(use_adaptive_mutex) {
+      num_rejected_(0),
+      mutex_("LRUCacheShard::mutex_", use_adaptive_mutex) {
   set_metadata_charge_policy(metadata_charge_policy);
   // Make empty circular linked list
   lru_.next = &lru_;
@@ -118,7 +185,7 @@ LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
 void LRUCacheShard::EraseUnRefEntries() {
   autovector<LRUHandle*> last_reference_list;
   {
-    MutexLock l(&mutex_);
+    ProfiledMutexLock l(&mutex_);
     while (lru_.next != &lru_) {
       LRUHandle* old = lru_.next;
       // LRU list contains only elements which can be evicted
@@ -146,7 +213,7 @@ void LRUCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
   };
 
   if (thread_safe) {
-    MutexLock l(&mutex_);
+    ProfiledMutexLock l(&mutex_);
     applyCallback();
   } else {
     applyCallback();
@@ -154,13 +221,13 @@ void LRUCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
 }
 
 void LRUCacheShard::TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri) {
-  MutexLock l(&mutex_);
+  ProfiledMutexLock l(&mutex_);
   *lru = &lru_;
   *lru_low_pri = lru_low_pri_;
 }
 
 size_t LRUCacheShard::TEST_GetLRUSize() {
-  MutexLock l(&mutex_);
+  ProfiledMutexLock l(&mutex_);
   LRUHandle* lru_handle = lru_.next;
   size_t lru_size = 0;
   while (lru_handle != &lru_) {
@@ -171,10 +238,15 @@ size_t LRUCacheShard::TEST_GetLRUSize() {
 }
 
 double LRUCacheShard::GetHighPriPoolRatio() {
-  MutexLock l(&mutex_);
+  ProfiledMutexLock l(&mutex_);
   return high_pri_pool_ratio_;
 }
 
+size_t LRUCacheShard::TEST_GetNumRejected() {
+  ProfiledMutexLock l(&mutex_);
+  return num_rejected_;
+}
+
 void LRUCacheShard::LRU_Remove(LRUHandle* e) {
   assert(e->next != nullptr);
   assert(e->prev != nullptr);
@@ -248,28 +320,61 @@ void LRUCacheShard::EvictFromLRU(size_t charge,
   }
 }
 
+bool LRUCacheShard::Admit(uint32_t hash) const {
+  assert(lru_.next != &lru_);
+  // Ties are rejected as in the paper: a key seen once does not replace
+  // another key seen once, until it is seen again
+  return sketch_.Estimate(hash) > sketch_.Estimate(lru_.next->hash);
+}
+
+void LRUCacheShard::MaybeDemote(LRUHandle* e) {
+  if (secondary_cache_ != nullptr && e->IsSecondaryCacheCompatible()) {
+    secondary_cache_->Insert(e->key(), (*e->helper->save_to)(e->value))
+        .PermitUncheckedError();
+  }
+}
+
 void LRUCacheShard::SetCapacity(size_t capacity) {
   autovector<LRUHandle*> last_reference_list;
   {
-    MutexLock l(&mutex_);
+    ProfiledMutexLock l(&mutex_);
     capacity_ = capacity;
     high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
+    if (tiny_lfu_admission_) {
+      sketch_.Resize(capacity_ / kTinyLfuEntryChargeEstimate);
+    }
     EvictFromLRU(0, &last_reference_list);
   }
 
   // Free the entries outside of mutex for performance reasons
   for (auto entry : last_reference_list) {
+    MaybeDemote(entry);
     entry->Free();
   }
 }
 
 void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
-  MutexLock l(&mutex_);
+  ProfiledMutexLock l(&mutex_);
   strict_capacity_limit_ = strict_capacity_limit;
 }
 
 Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  MutexLock l(&mutex_);
+  ProfiledMutexLock l(&mutex_);
+  return reinterpret_cast<Cache::Handle*>(LookupLocked(key, hash));
+}
+
+void LRUCacheShard::MultiLookup(const Slice* keys, const uint32_t* hashes,
+                                const size_t* indexes, size_t n,
+                                Cache::Handle** handles) {
+  ProfiledMutexLock l(&mutex_);
+  for (size_t i = 0; i < n; ++i) {
+    size_t k = indexes[i];
+    LRUHandle* e = LookupLocked(keys[k], hashes[k]);
+    handles[k] = reinterpret_cast<Cache::Handle*>(e);
+  }
+}
+
+LRUHandle* LRUCacheShard::LookupLocked(const Slice& key, uint32_t hash) {
   LRUHandle* e = table_.Lookup(key, hash);
   if (e != nullptr) {
     assert(e->InCache());
@@ -279,13 +384,17 @@ Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
     }
     e->Ref();
     e->SetHit();
+    if (tiny_lfu_admission_) {
+      // Misses are counted by the insert that follows them
+      sketch_.Increment(hash);
+    }
   }
-  return reinterpret_cast<Cache::Handle*>(e);
+  return e;
 }
 
 bool LRUCacheShard::Ref(Cache::Handle* h) {
   LRUHandle* e = reinterpret_cast<LRUHandle*>(h);
-  MutexLock l(&mutex_);
+  ProfiledMutexLock l(&mutex_);
   // To create another reference - entry must be already externally referenced
   assert(e->HasRefs());
   e->Ref();
@@ -293,7 +402,7 @@ bool LRUCacheShard::Ref(Cache::Handle* h) {
 }
 
 void LRUCacheShard::SetHighPriorityPoolRatio(double high_pri_pool_ratio) {
-  MutexLock l(&mutex_);
+  ProfiledMutexLock l(&mutex_);
   high_pri_pool_ratio_ = high_pri_pool_ratio;
   high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
   MaintainPoolSize();
@@ -305,8 +414,9 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
   }
   LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
   bool last_reference = false;
+  bool evicted = false;
   {
-    MutexLock l(&mutex_);
+    ProfiledMutexLock l(&mutex_);
     last_reference = e->Unref();
     if (last_reference && e->InCache()) {
       // The item is still in cache, and nobody else holds a reference to it
@@ -316,6 +426,7 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
         // Take this opportunity and remove the item
         table_.Remove(e->key(), e->hash);
         e->SetInCache(false);
+        evicted = !force_erase;
       } else {
         // Put the item back on the LRU list, and don't free it
         LRU_Insert(e);
@@ -331,6 +442,9 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
 
   // Free the entry here outside of mutex for performance reasons
   if (last_reference) {
+    if (evicted) {
+      MaybeDemote(e);
+    }
     e->Free();
   }
   return last_reference;
@@ -340,6 +454,24 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                              size_t charge,
                              void (*deleter)(const Slice& key, void* value),
                              Cache::Handle** handle, Cache::Priority priority) {
+  return InsertItem(key, hash, value, charge, deleter, nullptr, handle,
+                    priority);
+}
+
+Status LRUCacheShard::InsertWithHelper(const Slice& key, uint32_t hash,
+                                       void* value,
+                                       const Cache::CacheItemHelper* helper,
+                                       size_t charge, Cache::Handle** handle,
+                                       Cache::Priority priority) {
+  return InsertItem(key, hash, value, charge, nullptr, helper, handle,
+                    priority);
+}
+
+Status LRUCacheShard::InsertItem(
+    const Slice& key, uint32_t hash, void* value, size_t charge,
+    void (*deleter)(const Slice& key, void* value),
+    const Cache::CacheItemHelper* helper, Cache::Handle** handle,
+    Cache::Priority priority) {
   // Allocate the memory here outside of the mutex
   // If the cache is full, we'll have to release it
   // It shouldn't happen very often though.
@@ -349,10 +481,15 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   autovector<LRUHandle*> last_reference_list;
 
   e->value = value;
-  e->deleter = deleter;
   e->charge = charge;
   e->key_length = key.size();
   e->flags = 0;
+  if (helper != nullptr) {
+    e->helper = helper;
+    e->flags |= LRUHandle::IS_SECONDARY_CACHE_COMPATIBLE;
+  } else {
+    e->deleter = deleter;
+  }
   e->hash = hash;
   e->refs = 0;
   e->next = e->prev = nullptr;
@@ -360,16 +497,46 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   e->SetPriority(priority);
   memcpy(e->key_data, key.data(), key.size());
   size_t total_charge = e->CalcTotalCharge(metadata_charge_policy_);
+  size_t num_evicted = 0;
 
   {
-    MutexLock l(&mutex_);
+    ProfiledMutexLock l(&mutex_);
+
+    bool admitted = true;
+    if (tiny_lfu_admission_) {
+      sketch_.Increment(hash);
+      admitted = priority == Cache::Priority::HIGH ||
+                 (usage_ + total_charge) <= capacity_ || lru_.next == &lru_ ||
+                 Admit(hash);
+    }
 
-    // Free the space following strict LRU policy until enough space
-    // is freed or the lru list is empty
-    EvictFromLRU(total_charge, &last_reference_list);
+    if (admitted) {
+      // Free the space following strict LRU policy until enough space
+      // is freed or the lru list is empty
+      EvictFromLRU(total_charge, &last_reference_list);
+      num_evicted = last_reference_list.size();
+    }
 
-    if ((usage_ + total_charge) > capacity_ &&
-        (strict_capacity_limit_ || handle == nullptr)) {
+    if (!admitted) {
+      num_rejected_++;
+      e->SetInCache(false);
+      if (handle == nullptr) {
+        // As if the entry was inserted and evicted immediately
+        last_reference_list.push_back(e);
+      } else if (strict_capacity_limit_ &&
+                 (usage_ + total_charge) > capacity_) {
+        delete[] reinterpret_cast<char*>(e);
+        *handle = nullptr;
+        s = Status::Incomplete("Insert rejected by TinyLFU admission.");
+      } else {
+        // The caller still gets to use the value. The entry is not in the
+        // table, so it is freed on its last release.
+        usage_ += total_charge;
+        e->Ref();
+        *handle = reinterpret_cast<Cache::Handle*>(e);
+      }
+    } else if ((usage_ + total_charge) > capacity_ &&
+               (strict_capacity_limit_ || handle == nullptr)) {
       if (handle == nullptr) {
         // Don't insert the entry but still return ok, as if the entry inserted
         // into cache and get evicted immediately.
@@ -409,8 +576,11 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   }
 
   // Free the entries here outside of mutex for performance reasons
-  for (auto entry : last_reference_list) {
-    entry->Free();
+  for (size_t i = 0; i < last_reference_list.size(); i++) {
+    if (i < num_evicted) {
+      MaybeDemote(last_reference_list[i]);
+    }
+    last_reference_list[i]->Free();
   }
 
   return s;
@@ -420,7 +590,7 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
   LRUHandle* e;
   bool last_reference = false;
   {
-    MutexLock l(&mutex_);
+    ProfiledMutexLock l(&mutex_);
     e = table_.Remove(key, hash);
     if (e != nullptr) {
       assert(e->InCache());
@@ -444,12 +614,12 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
 }
 
 size_t LRUCacheShard::GetUsage() const {
-  MutexLock l(&mutex_);
+  ProfiledMutexLock l(&mutex_);
   return usage_;
 }
 
 size_t LRUCacheShard::GetPinnedUsage() const {
-  MutexLock l(&mutex_);
+  ProfiledMutexLock l(&mutex_);
   assert(usage_ >= lru_usage_);
   return usage_ - lru_usage_;
 }
@@ -458,9 +628,11 @@ std::string LRUCacheShard::GetPrintableOptions() const {
   const int kBufferSize = 200;
   char buffer[kBufferSize];
   {
-    MutexLock l(&mutex_);
-    snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
-             high_pri_pool_ratio_);
+    ProfiledMutexLock l(&mutex_);
+    snprintf(buffer, kBufferSize,
+             "    high_pri_pool_ratio: %.3lf\n"
+             "    tiny_lfu_admission: %d\n",
+             high_pri_pool_ratio_, tiny_lfu_admission_);
   }
   return std::string(buffer);
 }
@@ -469,9 +641,12 @@ LRUCache::LRUCache(size_t capacity, int num_shard_bits,
                    bool strict_capacity_limit, double high_pri_pool_ratio,
                    std::shared_ptr<MemoryAllocator> allocator,
                    bool use_adaptive_mutex,
-                   CacheMetadataChargePolicy metadata_charge_policy)
+                   CacheMetadataChargePolicy metadata_charge_policy,
+                   std::shared_ptr<SecondaryCache> secondary_cache,
+                   bool tiny_lfu_admission)
     : ShardedCache(capacity, num_shard_bits, strict_capacity_limit,
-                   std::move(allocator)) {
+                   std::move(allocator)),
+      secondary_cache_(std::move(secondary_cache)) {
   num_shards_ = 1 << num_shard_bits;
   shards_ = reinterpret_cast<LRUCacheShard*>(
       port::cacheline_aligned_alloc(sizeof(LRUCacheShard) * num_shards_));
@@ -479,7 +654,8 @@ LRUCache::LRUCache(size_t capacity, int num_shard_bits,
   for (int i = 0; i < num_shards_; i++) {
     new (&shards_[i])
         LRUCacheShard(per_shard, strict_capacity_limit, high_pri_pool_ratio,
-                      use_adaptive_mutex, metadata_charge_policy);
+                      use_adaptive_mutex, metadata_charge_policy,
+                      secondary_cache_.get(), tiny_lfu_admission);
   }
 }
 
@@ -528,6 +704,56 @@ void LRUCache::DisownData() {
 #endif  // __clang__
 }
 
+Status LRUCache::InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle, Priority priority) {
+  assert(helper != nullptr);
+  uint32_t hash = HashSlice(key);
+  return shards_[Shard(hash)].InsertWithHelper(key, hash, value, helper,
+                                               charge, handle, priority);
+}
+
+Cache::Handle* LRUCache::LookupWithHelper(const Slice& key,
+                                          const CacheItemHelper* helper,
+                                          void* create_context,
+                                          Priority priority,
+                                          Statistics* stats) {
+  Handle* handle = Lookup(key, stats);
+  if (handle != nullptr || secondary_cache_ == nullptr ||
+      helper == nullptr || helper->create == nullptr) {
+    return handle;
+  }
+
+  std::string contents;
+  if (!secondary_cache_->Lookup(key, &contents).ok()) {
+    return nullptr;
+  }
+  size_t charge = 0;
+  void* value = (*helper->create)(contents, create_context, &charge);
+  if (value == nullptr) {
+    return nullptr;
+  }
+  Status s = InsertWithHelper(key, value, helper, charge, &handle, priority);
+  if (!s.ok()) {
+    (*helper->deleter)(key, value);
+    return nullptr;
+  }
+  // The entry lives in the primary cache again until its next eviction
+  secondary_cache_->Erase(key);
+  return handle;
+}
+
+std::string LRUCache::GetPrintableOptions() const {
+  std::string ret = ShardedCache::GetPrintableOptions();
+  if (secondary_cache_ != nullptr) {
+    ret.append("    secondary_cache: ");
+    ret.append(secondary_cache_->Name());
+    ret.append("\n");
+    ret.append(secondary_cache_->GetPrintableOptions());
+  }
+  return ret;
+}
+
 size_t LRUCache::TEST_GetLRUSize() {
   size_t lru_size_of_all_shards = 0;
   for (int i = 0; i < num_shards_; i++) {
@@ -545,31 +771,34 @@ double LRUCache::GetHighPriPoolRatio() {
 }
 
 std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
-  return NewLRUCache(cache_opts.capacity, cache_opts.num_shard_bits,
-                     cache_opts.strict_capacity_limit,
-                     cache_opts.high_pri_pool_ratio,
-                     cache_opts.memory_allocator, cache_opts.use_adaptive_mutex,
-                     cache_opts.metadata_charge_policy);
-}
-
-std::shared_ptr<Cache> NewLRUCache(
-    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-    double high_pri_pool_ratio,
-    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
-    CacheMetadataChargePolicy metadata_charge_policy) {
+  int num_shard_bits = cache_opts.num_shard_bits;
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
-  if (high_pri_pool_ratio < 0.0 || high_pri_pool_ratio > 1.0) {
+  if (cache_opts.high_pri_pool_ratio < 0.0 ||
+      cache_opts.high_pri_pool_ratio > 1.0) {
     // invalid high_pri_pool_ratio
     return nullptr;
   }
   if (num_shard_bits < 0) {
-    num_shard_bits = GetDefaultCacheShardBits(capacity);
+    num_shard_bits = GetDefaultCacheShardBits(cache_opts.capacity);
   }
   return std::make_shared<LRUCache>(
+      cache_opts.capacity, num_shard_bits, cache_opts.strict_capacity_limit,
+      cache_opts.high_pri_pool_ratio, cache_opts.memory_allocator,
+      cache_opts.use_adaptive_mutex, cache_opts.metadata_charge_policy,
+      cache_opts.secondary_cache, cache_opts.tiny_lfu_admission);
+}
+
+std::shared_ptr<Cache> NewLRUCache(
+    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+    double high_pri_pool_ratio,
+    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
+    CacheMetadataChargePolicy metadata_charge_policy) {
+  return NewLRUCache(LRUCacheOptions(
       capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
-      std::move(memory_allocator), use_adaptive_mutex, metadata_charge_policy);
+      std::move(memory_allocator), use_adaptive_mutex,
+      metadata_charge_policy));
 }
 
 }  // namespace ROCKSDB_NAMESPACE
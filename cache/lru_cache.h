@@ -9,11 +9,14 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "cache/sharded_cache.h"
 
+#include "monitoring/lock_profiler.h"
 #include "port/malloc.h"
 #include "port/port.h"
+#include "rocksdb/secondary_cache.h"
 #include "util/autovector.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -49,7 +52,11 @@ namespace ROCKSDB_NAMESPACE {
 
 struct LRUHandle {
   void* value;
-  void (*deleter)(const Slice&, void* value);
+  union {
+    void (*deleter)(const Slice&, void* value);
+    // Set instead of deleter when IS_SECONDARY_CACHE_COMPATIBLE is set
+    const Cache::CacheItemHelper* helper;
+  };
   LRUHandle* next_hash;
   LRUHandle* next;
   LRUHandle* prev;
@@ -69,6 +76,9 @@ struct LRUHandle {
     IN_HIGH_PRI_POOL = (1 << 2),
     // Wwhether this entry has had any lookups (hits).
     HAS_HIT = (1 << 3),
+    // Whether this entry was inserted with a CacheItemHelper and can be
+    // demoted to the secondary cache.
+    IS_SECONDARY_CACHE_COMPATIBLE = (1 << 4),
   };
 
   uint8_t flags;
@@ -95,6 +105,9 @@ struct LRUHandle {
   bool IsHighPri() const { return flags & IS_HIGH_PRI; }
   bool InHighPriPool() const { return flags & IN_HIGH_PRI_POOL; }
   bool HasHit() const { return flags & HAS_HIT; }
+  bool IsSecondaryCacheCompatible() const {
+    return flags & IS_SECONDARY_CACHE_COMPATIBLE;
+  }
 
   void SetInCache(bool in_cache) {
     if (in_cache) {
@@ -124,7 +137,9 @@ struct LRUHandle {
 
   void Free() {
     assert(refs == 0);
-    if (deleter) {
+    if (IsSecondaryCacheCompatible()) {
+      (*helper->deleter)(key(), value);
+    } else if (deleter) {
       (*deleter)(key(), value);
     }
     delete[] reinterpret_cast<char*>(this);
@@ -188,12 +203,41 @@ class LRUHandleTable {
   uint32_t elems_;
 };
 
+// A Count-Min sketch of 4-bit counters that estimates how often each key was
+// accessed recently, for the TinyLFU admission policy (Einziger et al.,
+// "TinyLFU: A Highly Efficient Cache Admission Policy"). Each 64-bit word
+// holds 16 counters and each key maps to one counter in each of four rows.
+// Once the number of increments reaches ten times the number of words, all
+// counters are halved so that old popularity fades.
+class FrequencySketch {
+ public:
+  FrequencySketch() : mask_(0), additions_(0), sample_size_(0) {}
+
+  // Sizes the sketch for about num_keys distinct keys. The counters are
+  // cleared if the size changes.
+  void Resize(size_t num_keys);
+
+  void Increment(uint32_t hash);
+  // Estimated number of recent accesses to hash, capped at 15
+  uint32_t Estimate(uint32_t hash) const;
+
+ private:
+  void Halve();
+
+  std::vector<uint64_t> table_;
+  size_t mask_;
+  size_t additions_;
+  size_t sample_size_;
+};
+
 // A single shard of sharded cache.
 class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
  public:
   LRUCacheShard(size_t capacity, bool strict_capacity_limit,
                 double high_pri_pool_ratio, bool use_adaptive_mutex,
-                CacheMetadataChargePolicy metadata_charge_policy);
+                CacheMetadataChargePolicy metadata_charge_policy,
+                SecondaryCache* secondary_cache = nullptr,
+                bool tiny_lfu_admission = false);
   virtual ~LRUCacheShard() override = default;
 
   // Separate from constructor so caller can easily make an array of LRUCache
@@ -213,7 +257,13 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
                         void (*deleter)(const Slice& key, void* value),
                         Cache::Handle** handle,
                         Cache::Priority priority) override;
+  Status InsertWithHelper(const Slice& key, uint32_t hash, void* value,
+                          const Cache::CacheItemHelper* helper, size_t charge,
+                          Cache::Handle** handle, Cache::Priority priority);
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
+  virtual void MultiLookup(const Slice* keys, const uint32_t* hashes,
+                           const size_t* indexes, size_t n,
+                           Cache::Handle** handles) override;
   virtual bool Ref(Cache::Handle* handle) override;
   virtual bool Release(Cache::Handle* handle,
                        bool force_erase = false) override;
@@ -242,7 +292,23 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   //  Retrives high pri pool ratio
   double GetHighPriPoolRatio();
 
+  // Number of inserts rejected by the TinyLFU admission filter
+  size_t TEST_GetNumRejected();
+
  private:
+  Status InsertItem(const Slice& key, uint32_t hash, void* value,
+                    size_t charge,
+                    void (*deleter)(const Slice& key, void* value),
+                    const Cache::CacheItemHelper* helper,
+                    Cache::Handle** handle, Cache::Priority priority);
+
+  // Hands an entry evicted for capacity to the secondary cache, if both
+  // allow it. Called without holding mutex_, before e->Free().
+  void MaybeDemote(LRUHandle* e);
+
+  // Lookup() with mutex_ held
+  LRUHandle* LookupLocked(const Slice& key, uint32_t hash);
+
   void LRU_Remove(LRUHandle* e);
   void LRU_Insert(LRUHandle* e);
 
@@ -256,9 +322,16 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // holding the mutex_
   void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted);
 
+  // TinyLFU: whether a new entry of the given hash may take the place of the
+  // next entry to be evicted. Requires the LRU list to be non-empty.
+  bool Admit(uint32_t hash) const;
+
   // Initialized before use.
   size_t capacity_;
 
+  // Owned by LRUCache, may be nullptr.
+  SecondaryCache* secondary_cache_;
+
   // Memory size for entries in high-pri pool.
   size_t high_pri_pool_usage_;
 
@@ -280,6 +353,9 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // Pointer to head of low-pri pool in LRU list.
   LRUHandle* lru_low_pri_;
 
+  // Whether inserts go through the TinyLFU admission filter.
+  const bool tiny_lfu_admission_;
+
   // ------------^^^^^^^^^^^^^-----------
   // Not frequently modified data members
   // ------------------------------------
@@ -299,10 +375,16 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // Memory size for entries residing only in the LRU list
   size_t lru_usage_;
 
+  // Access frequencies for TinyLFU, sized from capacity_. Empty when
+  // tiny_lfu_admission_ is false.
+  FrequencySketch sketch_;
+
+  size_t num_rejected_;
+
   // mutex_ protects the following state.
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
-  mutable port::Mutex mutex_;
+  mutable ProfiledPortMutex mutex_;
 };
 
 class LRUCache
@@ -316,7 +398,9 @@ class LRUCache
            std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
            bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
            CacheMetadataChargePolicy metadata_charge_policy =
-               kDontChargeCacheMetadata);
+               kDontChargeCacheMetadata,
+           std::shared_ptr<SecondaryCache> secondary_cache = nullptr,
+           bool tiny_lfu_admission = false);
   virtual ~LRUCache();
   virtual const char* Name() const override { return "LRUCache"; }
   virtual CacheShard* GetShard(int shard) override;
@@ -325,6 +409,16 @@ class LRUCache
   virtual size_t GetCharge(Handle* handle) const override;
   virtual uint32_t GetHash(Handle* handle) const override;
   virtual void DisownData() override;
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle = nullptr,
+                                  Priority priority = Priority::LOW) override;
+  virtual Handle* LookupWithHelper(const Slice& key,
+                                   const CacheItemHelper* helper,
+                                   void* create_context,
+                                   Priority priority = Priority::LOW,
+                                   Statistics* stats = nullptr) override;
+  virtual std::string GetPrintableOptions() const override;
 
   //  Retrieves number of elements in LRU, for unit test purpose only
   size_t TEST_GetLRUSize();
@@ -334,6 +428,7 @@ class LRUCache
  private:
   LRUCacheShard* shards_ = nullptr;
   int num_shards_ = 0;
+  std::shared_ptr<SecondaryCache> secondary_cache_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
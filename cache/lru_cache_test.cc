@@ -5,10 +5,16 @@
 
 #include "cache/lru_cache.h"
 
+#include <map>
 #include <string>
 #include <vector>
+#include "cache/compressed_secondary_cache.h"
+#include "cache/slow_memory_secondary_cache.h"
 #include "port/port.h"
+#include "rocksdb/memory_allocator.h"
+#include "rocksdb/statistics.h"
 #include "test_util/testharness.h"
+#include "util/compression.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -191,6 +197,359 @@ TEST_F(LRUCacheTest, EntriesWithPriority) {
   ValidateLRUList({"e", "f", "g", "Z", "d"}, 2);
 }
 
+TEST(FrequencySketchTest, CountAndAge) {
+  FrequencySketch sketch;
+  sketch.Resize(1024);
+  for (int i = 0; i < 5; i++) {
+    sketch.Increment(42);
+  }
+  // Count-Min never underestimates
+  ASSERT_GE(sketch.Estimate(42), 5u);
+  ASSERT_EQ(0u, sketch.Estimate(43));
+  for (int i = 0; i < 100; i++) {
+    sketch.Increment(7);
+  }
+  ASSERT_EQ(15u, sketch.Estimate(7));
+
+  // Enough other increments halve all counters
+  for (uint32_t i = 0; i < 10 * 1024; i++) {
+    sketch.Increment(1000 + i);
+  }
+  ASSERT_LE(sketch.Estimate(7), 8u);
+  ASSERT_LE(sketch.Estimate(42), 3u);
+
+  // Resizing to the same size keeps the counters
+  sketch.Resize(1000);
+  ASSERT_GT(sketch.Estimate(7), 0u);
+  sketch.Resize(4096);
+  ASSERT_EQ(0u, sketch.Estimate(7));
+}
+
+class LRUCacheTinyLfuTest : public testing::Test {
+ public:
+  static std::shared_ptr<Cache> NewCache(size_t capacity,
+                                         bool tiny_lfu_admission) {
+    LRUCacheOptions opts(capacity, 0 /*num_shard_bits*/,
+                         false /*strict_capacity_limit*/,
+                         0.0 /*high_pri_pool_ratio*/);
+    opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    opts.tiny_lfu_admission = tiny_lfu_admission;
+    return NewLRUCache(opts);
+  }
+
+  // Looks up key and inserts it on a miss, like a block cache read
+  static bool Access(Cache* cache, const std::string& key) {
+    Cache::Handle* handle = cache->Lookup(key);
+    if (handle != nullptr) {
+      cache->Release(handle);
+      return true;
+    }
+    EXPECT_OK(cache->Insert(key, nullptr /*value*/, 1 /*charge*/,
+                            nullptr /*deleter*/));
+    return false;
+  }
+
+  static size_t NumRejected(Cache* cache) {
+    return static_cast<LRUCacheShard*>(
+               static_cast<LRUCache*>(cache)->GetShard(0))
+        ->TEST_GetNumRejected();
+  }
+};
+
+TEST_F(LRUCacheTinyLfuTest, ScanResistance) {
+  const int kNumHot = 8;
+  const int kScanLength = 32;
+  const int kRounds = 10;
+  size_t hot_hits[2] = {0, 0};
+  for (bool tiny_lfu : {false, true}) {
+    std::shared_ptr<Cache> cache = NewCache(16, tiny_lfu);
+    for (int round = 0; round < kRounds; round++) {
+      for (int i = 0; i < kNumHot; i++) {
+        bool hit = Access(cache.get(), "hot" + std::to_string(i));
+        if (round >= 3 && hit) {
+          hot_hits[tiny_lfu]++;
+        }
+      }
+      // A scan of blocks that are never read again, twice the capacity
+      for (int i = 0; i < kScanLength; i++) {
+        Access(cache.get(),
+               "scan" + std::to_string(round) + "_" + std::to_string(i));
+      }
+    }
+    ASSERT_EQ(tiny_lfu, NumRejected(cache.get()) > 0);
+  }
+  // Each scan flushes the hot set out of plain LRU, but not past TinyLFU
+  ASSERT_EQ(0u, hot_hits[0]);
+  ASSERT_EQ(size_t{kNumHot} * (kRounds - 3), hot_hits[1]);
+}
+
+TEST_F(LRUCacheTinyLfuTest, Admission) {
+  std::shared_ptr<Cache> cache = NewCache(4, true /*tiny_lfu_admission*/);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_FALSE(Access(cache.get(), std::to_string(i)));
+  }
+  ASSERT_EQ(0u, NumRejected(cache.get()));
+
+  // A key seen once does not replace the next victim "0", also seen once,
+  // but does on its next access
+  ASSERT_FALSE(Access(cache.get(), "4"));
+  ASSERT_EQ(1u, NumRejected(cache.get()));
+  ASSERT_EQ(4u, cache->GetUsage());
+  ASSERT_FALSE(Access(cache.get(), "4"));
+  ASSERT_EQ(1u, NumRejected(cache.get()));
+  ASSERT_TRUE(Access(cache.get(), "4"));
+  ASSERT_EQ(nullptr, cache->Lookup("0"));
+
+  // A rejected insert that asks for a handle still gets one, but the entry
+  // is not cached and is freed on release
+  Cache::Handle* handle = nullptr;
+  ASSERT_OK(cache->Insert("new", nullptr /*value*/, 1 /*charge*/,
+                          nullptr /*deleter*/, &handle));
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(2u, NumRejected(cache.get()));
+  ASSERT_EQ(5u, cache->GetUsage());
+  ASSERT_EQ(1u, cache->GetPinnedUsage());
+  cache->Release(handle);
+  ASSERT_EQ(4u, cache->GetUsage());
+  ASSERT_EQ(nullptr, cache->Lookup("new"));
+
+  // High-priority entries bypass the filter
+  ASSERT_OK(cache->Insert("high", nullptr /*value*/, 1 /*charge*/,
+                          nullptr /*deleter*/, nullptr /*handle*/,
+                          Cache::Priority::HIGH));
+  ASSERT_EQ(2u, NumRejected(cache.get()));
+  handle = cache->Lookup("high");
+  ASSERT_NE(nullptr, handle);
+  cache->Release(handle);
+
+  // "new" has now been seen more often than the next victim
+  ASSERT_FALSE(Access(cache.get(), "new"));
+  ASSERT_TRUE(Access(cache.get(), "new"));
+  ASSERT_EQ(2u, NumRejected(cache.get()));
+}
+
+class TestSecondaryCache : public SecondaryCache {
+ public:
+  const char* Name() const override { return "TestSecondaryCache"; }
+
+  Status Insert(const Slice& key, const Slice& value) override {
+    num_inserts_++;
+    entries_[key.ToString()] = value.ToString();
+    return Status::OK();
+  }
+
+  Status Lookup(const Slice& key, std::string* value) override {
+    auto it = entries_.find(key.ToString());
+    if (it == entries_.end()) {
+      return Status::NotFound();
+    }
+    *value = it->second;
+    return Status::OK();
+  }
+
+  void Erase(const Slice& key) override { entries_.erase(key.ToString()); }
+
+  bool Contains(const std::string& key) const {
+    return entries_.count(key) > 0;
+  }
+
+  int num_inserts_ = 0;
+
+ private:
+  std::map<std::string, std::string> entries_;
+};
+
+class LRUSecondaryCacheTest : public testing::Test {
+ public:
+  static Slice SaveString(void* value) {
+    return *static_cast<std::string*>(value);
+  }
+
+  static void* CreateString(const Slice& contents, void* /*create_context*/,
+                            size_t* charge) {
+    *charge = contents.size();
+    return new std::string(contents.ToString());
+  }
+
+  static void DeleteString(const Slice& /*key*/, void* value) {
+    delete static_cast<std::string*>(value);
+  }
+
+  static const Cache::CacheItemHelper kHelper;
+};
+
+const Cache::CacheItemHelper LRUSecondaryCacheTest::kHelper = {
+    &LRUSecondaryCacheTest::SaveString, &LRUSecondaryCacheTest::CreateString,
+    &LRUSecondaryCacheTest::DeleteString};
+
+TEST_F(LRUSecondaryCacheTest, DemoteAndPromote) {
+  auto secondary_cache = std::make_shared<TestSecondaryCache>();
+  LRUCacheOptions opts(1024, 0 /*num_shard_bits*/,
+                       false /*strict_capacity_limit*/,
+                       0.5 /*high_pri_pool_ratio*/);
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  opts.secondary_cache = secondary_cache;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+
+  std::string v1(300, 'a');
+  std::string v2(300, 'b');
+  ASSERT_OK(cache->InsertWithHelper("k1", new std::string(v1), &kHelper,
+                                    v1.size()));
+  ASSERT_OK(cache->InsertWithHelper("k2", new std::string(v2), &kHelper,
+                                    v2.size()));
+  // Entries inserted without a helper are never demoted
+  ASSERT_OK(cache->Insert("plain", new std::string(v1), v1.size(),
+                          &DeleteString));
+  ASSERT_EQ(0, secondary_cache->num_inserts_);
+
+  // Evicts k1
+  ASSERT_OK(cache->InsertWithHelper("k3", new std::string(v2), &kHelper,
+                                    v2.size()));
+  ASSERT_EQ(1, secondary_cache->num_inserts_);
+  ASSERT_TRUE(secondary_cache->Contains("k1"));
+  ASSERT_EQ(nullptr, cache->Lookup("k1"));
+
+  // A plain lookup does not consult the secondary cache, a helper lookup
+  // promotes the entry back
+  Cache::Handle* handle =
+      cache->LookupWithHelper("k1", &kHelper, nullptr /*create_context*/);
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(v1, *static_cast<std::string*>(cache->Value(handle)));
+  ASSERT_EQ(v1.size(), cache->GetCharge(handle));
+  cache->Release(handle);
+  ASSERT_FALSE(secondary_cache->Contains("k1"));
+
+  // Erased entries are not demoted
+  int inserts = secondary_cache->num_inserts_;
+  cache->Erase("k1");
+  ASSERT_EQ(inserts, secondary_cache->num_inserts_);
+  ASSERT_FALSE(secondary_cache->Contains("k1"));
+  ASSERT_EQ(nullptr, cache->LookupWithHelper("k1", &kHelper, nullptr));
+  ASSERT_EQ(nullptr, cache->LookupWithHelper("missing", &kHelper, nullptr));
+
+  // Shrinking the cache demotes what it evicts
+  cache->SetCapacity(0);
+  ASSERT_TRUE(secondary_cache->Contains("k2") ||
+              secondary_cache->Contains("k3"));
+  ASSERT_FALSE(secondary_cache->Contains("plain"));
+}
+
+TEST_F(LRUSecondaryCacheTest, CompressedSecondaryCache) {
+  CompressedSecondaryCacheOptions opts;
+  opts.capacity = 1 << 20;
+  opts.compression_type = kNoCompression;
+  for (auto type : {kLZ4Compression, kSnappyCompression, kZSTD}) {
+    if (CompressionTypeSupported(type)) {
+      opts.compression_type = type;
+      break;
+    }
+  }
+  std::shared_ptr<SecondaryCache> secondary_cache =
+      NewCompressedSecondaryCache(opts);
+  ASSERT_NE(nullptr, secondary_cache);
+  auto* compressed_cache =
+      static_cast<CompressedSecondaryCache*>(secondary_cache.get());
+
+  std::string compressible(8192, 'x');
+  std::string value;
+  ASSERT_OK(secondary_cache->Insert("k1", compressible));
+  ASSERT_OK(secondary_cache->Insert("k2", "short"));
+  // Visible while still pending
+  ASSERT_OK(secondary_cache->Lookup("k1", &value));
+  ASSERT_EQ(compressible, value);
+
+  compressed_cache->TEST_WaitForPending();
+  ASSERT_OK(secondary_cache->Lookup("k1", &value));
+  ASSERT_EQ(compressible, value);
+  ASSERT_OK(secondary_cache->Lookup("k2", &value));
+  ASSERT_EQ("short", value);
+  ASSERT_TRUE(secondary_cache->Lookup("k3", &value).IsNotFound());
+
+  secondary_cache->Erase("k1");
+  ASSERT_TRUE(secondary_cache->Lookup("k1", &value).IsNotFound());
+  ASSERT_EQ(0U, compressed_cache->TEST_GetNumDropped());
+
+  // Inserts beyond the backlog limit are dropped
+  opts.max_pending_bytes = 0;
+  secondary_cache = NewCompressedSecondaryCache(opts);
+  ASSERT_TRUE(secondary_cache->Insert("k1", compressible).IsIncomplete());
+  ASSERT_TRUE(secondary_cache->Lookup("k1", &value).IsNotFound());
+}
+
+class CountingAllocator : public MemoryAllocator {
+ public:
+  const char* Name() const override { return "CountingAllocator"; }
+
+  void* Allocate(size_t size) override {
+    num_allocated_++;
+    return new char[size];
+  }
+
+  void Deallocate(void* p) override {
+    num_deallocated_++;
+    delete[] static_cast<char*>(p);
+  }
+
+  int num_allocated_ = 0;
+  int num_deallocated_ = 0;
+};
+
+TEST_F(LRUSecondaryCacheTest, SlowMemorySecondaryCache) {
+  auto allocator = std::make_shared<CountingAllocator>();
+  SlowMemorySecondaryCacheOptions slow_opts;
+  slow_opts.capacity = 1000;
+  slow_opts.num_shard_bits = 0;
+  slow_opts.memory_allocator = allocator;
+  slow_opts.statistics = CreateDBStatistics();
+  std::shared_ptr<SecondaryCache> secondary_cache =
+      NewSlowMemorySecondaryCache(slow_opts);
+  auto* slow_cache =
+      static_cast<SlowMemorySecondaryCache*>(secondary_cache.get());
+
+  LRUCacheOptions opts(1024, 0 /*num_shard_bits*/,
+                       false /*strict_capacity_limit*/,
+                       0.5 /*high_pri_pool_ratio*/);
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  opts.secondary_cache = secondary_cache;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+
+  std::string v1(300, 'a');
+  std::string v2(300, 'b');
+  ASSERT_OK(cache->InsertWithHelper("k1", new std::string(v1), &kHelper,
+                                    v1.size()));
+  ASSERT_OK(cache->InsertWithHelper("k2", new std::string(v2), &kHelper,
+                                    v2.size()));
+  ASSERT_OK(cache->InsertWithHelper("k3", new std::string(v2), &kHelper,
+                                    v2.size()));
+  ASSERT_OK(cache->InsertWithHelper("k4", new std::string(v2), &kHelper,
+                                    v2.size()));
+
+  // k1 spilled to the slow tier, in memory of its allocator
+  ASSERT_EQ(1, allocator->num_allocated_);
+  ASSERT_EQ(v1.size(), slow_cache->TEST_GetUsage());
+  Statistics* stats = slow_opts.statistics.get();
+  ASSERT_EQ(1, stats->getTickerCount(SLOW_MEMORY_CACHE_ADD));
+
+  // Promoted back to DRAM on access, which frees the slow copy
+  Cache::Handle* handle =
+      cache->LookupWithHelper("k1", &kHelper, nullptr /*create_context*/);
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(v1, *static_cast<std::string*>(cache->Value(handle)));
+  cache->Release(handle);
+  ASSERT_EQ(1, stats->getTickerCount(SLOW_MEMORY_CACHE_HIT));
+  ASSERT_EQ(1, allocator->num_deallocated_);
+
+  // Promoting k1 spilled k2
+  ASSERT_EQ(2, allocator->num_allocated_);
+  ASSERT_EQ(nullptr, cache->LookupWithHelper("missing", &kHelper, nullptr));
+  ASSERT_EQ(1, stats->getTickerCount(SLOW_MEMORY_CACHE_MISS));
+
+  // The slow tier has its own capacity
+  cache->SetCapacity(0);
+  ASSERT_LE(slow_cache->TEST_GetUsage(), slow_opts.capacity);
+  ASSERT_EQ(5, stats->getTickerCount(SLOW_MEMORY_CACHE_ADD));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
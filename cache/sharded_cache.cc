@@ -9,7 +9,9 @@
 
 #include "cache/sharded_cache.h"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "util/mutexlock.h"
 
@@ -56,6 +58,31 @@ Cache::Handle* ShardedCache::Lookup(const Slice& key, Statistics* /*stats*/) {
   return GetShard(Shard(hash))->Lookup(key, hash);
 }
 
+void ShardedCache::MultiLookup(const Slice* keys, size_t num_keys,
+                               Handle** handles, Statistics* /*stats*/) {
+  std::vector<uint32_t> hashes(num_keys);
+  std::vector<size_t> indexes(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    hashes[i] = HashSlice(keys[i]);
+    indexes[i] = i;
+  }
+  // Groups the keys by shard, each shard being looked up once
+  std::sort(indexes.begin(), indexes.end(), [&](size_t a, size_t b) {
+    return Shard(hashes[a]) < Shard(hashes[b]);
+  });
+  size_t start = 0;
+  while (start < num_keys) {
+    uint32_t shard = Shard(hashes[indexes[start]]);
+    size_t end = start + 1;
+    while (end < num_keys && Shard(hashes[indexes[end]]) == shard) {
+      ++end;
+    }
+    GetShard(shard)->MultiLookup(keys, hashes.data(), &indexes[start],
+                                 end - start, handles);
+    start = end;
+  }
+}
+
 bool ShardedCache::Ref(Handle* handle) {
   uint32_t hash = GetHash(handle);
   return GetShard(Shard(hash))->Ref(handle);
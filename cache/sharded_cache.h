@@ -29,6 +29,16 @@ class CacheShard {
                         void (*deleter)(const Slice& key, void* value),
                         Cache::Handle** handle, Cache::Priority priority) = 0;
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) = 0;
+  // Looks up keys[indexes[i]], of hash hashes[indexes[i]], for i < n,
+  // setting handles[indexes[i]].
+  virtual void MultiLookup(const Slice* keys, const uint32_t* hashes,
+                           const size_t* indexes, size_t n,
+                           Cache::Handle** handles) {
+    for (size_t i = 0; i < n; ++i) {
+      size_t k = indexes[i];
+      handles[k] = Lookup(keys[k], hashes[k]);
+    }
+  }
   virtual bool Ref(Cache::Handle* handle) = 0;
   virtual bool Release(Cache::Handle* handle, bool force_erase = false) = 0;
   virtual void Erase(const Slice& key, uint32_t hash) = 0;
@@ -73,6 +83,8 @@ class ShardedCache : public Cache {
                         void (*deleter)(const Slice& key, void* value),
                         Handle** handle, Priority priority) override;
   virtual Handle* Lookup(const Slice& key, Statistics* stats) override;
+  virtual void MultiLookup(const Slice* keys, size_t num_keys,
+                           Handle** handles, Statistics* stats) override;
   virtual bool Ref(Handle* handle) override;
   virtual bool Release(Handle* handle, bool force_erase = false) override;
   virtual void Erase(const Slice& key) override;
@@ -89,7 +101,7 @@ class ShardedCache : public Cache {
 
   int GetNumShardBits() const { return num_shard_bits_; }
 
- private:
+ protected:
   static inline uint32_t HashSlice(const Slice& s) {
     return static_cast<uint32_t>(GetSliceNPHash64(s));
   }
@@ -99,6 +111,7 @@ class ShardedCache : public Cache {
     return (num_shard_bits_ > 0) ? (hash >> (32 - num_shard_bits_)) : 0;
   }
 
+ private:
   int num_shard_bits_;
   mutable port::Mutex capacity_mutex_;
   size_t capacity_;
@@ -0,0 +1,87 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/slow_memory_secondary_cache.h"
+
+#include <string.h>
+
+#include "memory/memory_allocator.h"
+#include "monitoring/statistics.h"
+#include "rocksdb/memory_allocator.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+struct StoredValue {
+  CacheAllocationPtr data;
+  size_t size;
+};
+
+void DeleteStoredValue(const Slice& /*key*/, void* value) {
+  delete static_cast<StoredValue*>(value);
+}
+
+}  // namespace
+
+SlowMemorySecondaryCache::SlowMemorySecondaryCache(
+    const SlowMemorySecondaryCacheOptions& opts)
+    : opts_(opts) {
+  LRUCacheOptions cache_opts(opts.capacity, opts.num_shard_bits,
+                             false /*strict_capacity_limit*/,
+                             0.0 /*high_pri_pool_ratio*/);
+  // The capacity is for the slow tier, the metadata lives in DRAM
+  cache_opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  cache_ = NewLRUCache(cache_opts);
+}
+
+Status SlowMemorySecondaryCache::Insert(const Slice& key, const Slice& value) {
+  StoredValue* stored = new StoredValue();
+  stored->data = AllocateBlock(value.size(), opts_.memory_allocator.get());
+  stored->size = value.size();
+  memcpy(stored->data.get(), value.data(), value.size());
+  Status s = cache_->Insert(key, stored, stored->size, &DeleteStoredValue);
+  if (s.ok()) {
+    RecordTick(opts_.statistics.get(), SLOW_MEMORY_CACHE_ADD);
+  }
+  return s;
+}
+
+Status SlowMemorySecondaryCache::Lookup(const Slice& key, std::string* value) {
+  assert(value != nullptr);
+  Cache::Handle* handle = cache_->Lookup(key);
+  if (handle == nullptr) {
+    RecordTick(opts_.statistics.get(), SLOW_MEMORY_CACHE_MISS);
+    return Status::NotFound();
+  }
+  const StoredValue* stored =
+      static_cast<const StoredValue*>(cache_->Value(handle));
+  value->assign(stored->data.get(), stored->size);
+  cache_->Release(handle);
+  RecordTick(opts_.statistics.get(), SLOW_MEMORY_CACHE_HIT);
+  return Status::OK();
+}
+
+void SlowMemorySecondaryCache::Erase(const Slice& key) { cache_->Erase(key); }
+
+std::string SlowMemorySecondaryCache::GetPrintableOptions() const {
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize,
+           "    secondary_cache_capacity : %" ROCKSDB_PRIszt
+           "\n"
+           "    secondary_cache_memory_allocator : %s\n",
+           opts_.capacity,
+           opts_.memory_allocator != nullptr ? opts_.memory_allocator->Name()
+                                             : "None");
+  return std::string(buffer);
+}
+
+std::shared_ptr<SecondaryCache> NewSlowMemorySecondaryCache(
+    const SlowMemorySecondaryCacheOptions& opts) {
+  return std::make_shared<SlowMemorySecondaryCache>(opts);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,45 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/secondary_cache.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Secondary cache keeping entries uncompressed in memory from
+// opts.memory_allocator, typically a larger and slower tier than the DRAM
+// of the primary cache, e.g. CXL or persistent memory through
+// MemkindKmemAllocator.
+//
+// Entries are copied to the slow tier on Insert(), which only costs a copy,
+// and copied back on Lookup(). They are kept in an LRU cache, charged by
+// their size.
+class SlowMemorySecondaryCache : public SecondaryCache {
+ public:
+  explicit SlowMemorySecondaryCache(
+      const SlowMemorySecondaryCacheOptions& opts);
+
+  const char* Name() const override { return "SlowMemorySecondaryCache"; }
+
+  Status Insert(const Slice& key, const Slice& value) override;
+  Status Lookup(const Slice& key, std::string* value) override;
+  void Erase(const Slice& key) override;
+
+  std::string GetPrintableOptions() const override;
+
+  // Bytes of entries kept
+  size_t TEST_GetUsage() const { return cache_->GetUsage(); }
+
+ private:
+  const SlowMemorySecondaryCacheOptions opts_;
+  std::shared_ptr<Cache> cache_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -9,11 +9,13 @@
 
 #include "db/arena_wrapped_db_iter.h"
 #include "memory/arena.h"
+#include "monitoring/perf_context_imp.h"
 #include "rocksdb/env.h"
 #include "rocksdb/iterator.h"
 #include "rocksdb/options.h"
 #include "table/internal_iterator.h"
 #include "table/iterator_wrapper.h"
+#include "util/mutexlock.h"
 #include "util/user_comparator_wrapper.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -39,6 +41,7 @@ void ArenaWrappedDBIter::Init(Env* env, const ReadOptions& read_options,
                               ReadCallback* read_callback, DBImpl* db_impl,
                               ColumnFamilyData* cfd, bool allow_blob,
                               bool allow_refresh) {
+  arena_.SetRecycleBlocks(read_options.recycle_arena_blocks);
   auto mem = arena_.AllocateAligned(sizeof(DBIter));
   db_iter_ = new (mem) DBIter(env, read_options, cf_options, mutable_cf_options,
                               cf_options.user_comparator, nullptr, sequence,
@@ -60,14 +63,21 @@ Status ArenaWrappedDBIter::Refresh() {
   uint64_t cur_sv_number = cfd_->GetSuperVersionNumber();
   TEST_SYNC_POINT("ArenaWrappedDBIter::Refresh:1");
   TEST_SYNC_POINT("ArenaWrappedDBIter::Refresh:2");
-  if (sv_number_ != cur_sv_number) {
+  // The range tombstones added to the memtable since the iterator was built
+  // are not in its aggregator. The sequence number is read first, as the
+  // memtable marks itself as having range tombstones before they are
+  // published.
+  SequenceNumber latest_seq = db_impl_->GetLatestSequenceNumber();
+  if (sv_number_ != cur_sv_number || mem_ == nullptr ||
+      !mem_->IsRangeDelTableEmpty()) {
     Env* env = db_iter_->env();
     db_iter_->~DBIter();
     arena_.~Arena();
     new (&arena_) Arena();
+    arena_.SetRecycleBlocks(read_options_.recycle_arena_blocks);
 
     SuperVersion* sv = cfd_->GetReferencedSuperVersion(db_impl_);
-    SequenceNumber latest_seq = db_impl_->GetLatestSequenceNumber();
+    latest_seq = db_impl_->GetLatestSequenceNumber();
     if (read_callback_) {
       read_callback_->Refresh(latest_seq);
     }
@@ -80,8 +90,9 @@ Status ArenaWrappedDBIter::Refresh() {
         read_options_, cfd_, sv, &arena_, db_iter_->GetRangeDelAggregator(),
         latest_seq, /* allow_unprepared_value */ true);
     SetIterUnderDBIter(internal_iter);
+    SetMemTable(sv->mem);
   } else {
-    db_iter_->set_sequence(db_impl_->GetLatestSequenceNumber());
+    db_iter_->set_sequence(latest_seq);
     db_iter_->set_valid(false);
   }
   return Status::OK();
@@ -105,4 +116,159 @@ ArenaWrappedDBIter* NewArenaWrappedDbIterator(
   return iter;
 }
 
+namespace {
+// All but the snapshot, as only the iterators without one are recycled, and
+// trace_id, which iterators do not use
+bool SameIteratorOptions(const ReadOptions& a, const ReadOptions& b) {
+  return a.iterate_lower_bound == b.iterate_lower_bound &&
+         a.iterate_upper_bound == b.iterate_upper_bound &&
+         a.readahead_size == b.readahead_size &&
+         a.max_skippable_internal_keys == b.max_skippable_internal_keys &&
+         a.read_tier == b.read_tier &&
+         a.verify_checksums == b.verify_checksums &&
+         a.fill_cache == b.fill_cache && a.tailing == b.tailing &&
+         a.managed == b.managed && a.total_order_seek == b.total_order_seek &&
+         a.auto_prefix_mode == b.auto_prefix_mode &&
+         a.prefix_same_as_start == b.prefix_same_as_start &&
+         a.pin_data == b.pin_data &&
+         a.background_purge_on_iterator_cleanup ==
+             b.background_purge_on_iterator_cleanup &&
+         a.ignore_range_deletions == b.ignore_range_deletions &&
+         !a.table_filter && !b.table_filter &&
+         a.iter_start_seqnum == b.iter_start_seqnum &&
+         a.timestamp == b.timestamp && a.iter_start_ts == b.iter_start_ts &&
+         a.deadline == b.deadline && a.io_timeout == b.io_timeout &&
+         a.value_size_soft_limit == b.value_size_soft_limit &&
+         a.async_io == b.async_io &&
+         a.optimize_multiget_for_io == b.optimize_multiget_for_io &&
+         a.recycle_arena_blocks == b.recycle_arena_blocks &&
+         a.recycle_iterator == b.recycle_iterator;
+}
+
+// Gives the iterator back to the pool when deleted
+class RecycledDBIter : public Iterator {
+ public:
+  RecycledDBIter(IteratorPool* pool, ArenaWrappedDBIter* iter)
+      : pool_(pool), iter_(iter) {}
+  ~RecycledDBIter() override { pool_->Give(iter_); }
+
+  bool Valid() const override { return iter_->Valid(); }
+  void SeekToFirst() override { iter_->SeekToFirst(); }
+  void SeekToLast() override { iter_->SeekToLast(); }
+  void Seek(const Slice& target) override { iter_->Seek(target); }
+  void SeekForPrev(const Slice& target) override {
+    iter_->SeekForPrev(target);
+  }
+  void Next() override { iter_->Next(); }
+  size_t NextBatch(
+      size_t max_entries, size_t max_bytes,
+      const std::function<void(const Slice& key, const Slice& value)>&
+          callback) override {
+    return iter_->NextBatch(max_entries, max_bytes, callback);
+  }
+  void Prev() override { iter_->Prev(); }
+  Slice key() const override { return iter_->key(); }
+  Slice value() const override { return iter_->value(); }
+  Status status() const override { return iter_->status(); }
+  Slice timestamp() const override { return iter_->timestamp(); }
+  Status GetProperty(std::string prop_name, std::string* prop) override {
+    return iter_->GetProperty(prop_name, prop);
+  }
+  Status Refresh() override { return iter_->Refresh(); }
+
+ private:
+  IteratorPool* const pool_;
+  ArenaWrappedDBIter* const iter_;
+};
+}  // namespace
+
+IteratorPool::IteratorPool() : has_orphans_(false), local_(&OnThreadExit) {}
+
+ArenaWrappedDBIter* IteratorPool::Take(ColumnFamilyData* cfd,
+                                       const ReadOptions& read_options) {
+  if (has_orphans_.load(std::memory_order_relaxed)) {
+    DeleteOrphans();
+  }
+  auto* local = static_cast<ThreadIterators*>(local_.Get());
+  if (local != nullptr) {
+    auto& iters = local->iters;
+    for (size_t i = iters.size(); i > 0; --i) {
+      ArenaWrappedDBIter* iter = iters[i - 1];
+      if (iter->cfd() != cfd ||
+          !SameIteratorOptions(iter->GetReadOptions(), read_options)) {
+        continue;
+      }
+      iters.erase(iters.begin() + (i - 1));
+      if (!iter->Refresh().ok()) {
+        delete iter;
+        break;
+      }
+      PERF_COUNTER_ADD(iterator_recycle_hit_count, 1);
+      return iter;
+    }
+  }
+  PERF_COUNTER_ADD(iterator_recycle_miss_count, 1);
+  return nullptr;
+}
+
+Iterator* IteratorPool::Wrap(ArenaWrappedDBIter* iter) {
+  return new RecycledDBIter(this, iter);
+}
+
+void IteratorPool::Give(ArenaWrappedDBIter* iter) {
+  if (!iter->CanRefresh() || !iter->status().ok()) {
+    delete iter;
+    return;
+  }
+  auto* local = static_cast<ThreadIterators*>(local_.Get());
+  if (local == nullptr) {
+    local = new ThreadIterators(this);
+    local_.Reset(local);
+  }
+  ArenaWrappedDBIter* evicted = nullptr;
+  if (local->iters.size() >= kMaxIteratorsPerThread) {
+    evicted = local->iters.front();
+    local->iters.erase(local->iters.begin());
+  }
+  local->iters.push_back(iter);
+  delete evicted;
+}
+
+void IteratorPool::Clear() {
+  autovector<void*> locals;
+  local_.Scrape(&locals, nullptr);
+  for (void* ptr : locals) {
+    auto* local = static_cast<ThreadIterators*>(ptr);
+    for (auto* iter : local->iters) {
+      delete iter;
+    }
+    delete local;
+  }
+  DeleteOrphans();
+}
+
+void IteratorPool::OnThreadExit(void* ptr) {
+  auto* local = static_cast<ThreadIterators*>(ptr);
+  IteratorPool* pool = local->pool;
+  {
+    MutexLock l(&pool->orphans_mutex_);
+    pool->orphans_.insert(pool->orphans_.end(), local->iters.begin(),
+                          local->iters.end());
+    pool->has_orphans_.store(true, std::memory_order_relaxed);
+  }
+  delete local;
+}
+
+void IteratorPool::DeleteOrphans() {
+  std::vector<ArenaWrappedDBIter*> orphans;
+  {
+    MutexLock l(&orphans_mutex_);
+    orphans.swap(orphans_);
+    has_orphans_.store(false, std::memory_order_relaxed);
+  }
+  for (auto* iter : orphans) {
+    delete iter;
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -9,16 +9,20 @@
 
 #pragma once
 #include <stdint.h>
+#include <atomic>
 #include <string>
+#include <vector>
 #include "db/db_impl/db_impl.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
 #include "db/range_del_aggregator.h"
 #include "memory/arena.h"
 #include "options/cf_options.h"
+#include "port/port.h"
 #include "rocksdb/db.h"
 #include "rocksdb/iterator.h"
 #include "util/autovector.h"
+#include "util/thread_local.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -59,6 +63,12 @@ class ArenaWrappedDBIter : public Iterator {
     db_iter_->SeekForPrev(target);
   }
   void Next() override { db_iter_->Next(); }
+  size_t NextBatch(
+      size_t max_entries, size_t max_bytes,
+      const std::function<void(const Slice& key, const Slice& value)>&
+          callback) override {
+    return db_iter_->NextBatch(max_entries, max_bytes, callback);
+  }
   void Prev() override { db_iter_->Prev(); }
   Slice key() const override { return db_iter_->key(); }
   Slice value() const override { return db_iter_->value(); }
@@ -88,6 +98,14 @@ class ArenaWrappedDBIter : public Iterator {
     allow_blob_ = allow_blob;
   }
 
+  // The mutable memtable of the super version the iterator reads
+  void SetMemTable(MemTable* mem) { mem_ = mem; }
+
+  ColumnFamilyData* cfd() const { return cfd_; }
+  bool CanRefresh() const {
+    return cfd_ != nullptr && db_impl_ != nullptr && allow_refresh_;
+  }
+
  private:
   DBIter* db_iter_;
   Arena arena_;
@@ -98,6 +116,62 @@ class ArenaWrappedDBIter : public Iterator {
   ReadCallback* read_callback_;
   bool allow_blob_ = false;
   bool allow_refresh_ = true;
+  MemTable* mem_ = nullptr;
+};
+
+// The iterators of ReadOptions::recycle_iterator. An iterator deleted by the
+// user goes to a pool of the deleting thread, and the next NewIterator() of
+// that thread on the same column family with the same read options takes
+// it back, refreshed.
+class IteratorPool {
+ public:
+  // In the pool of each thread, the least recently given back evicted
+  static const size_t kMaxIteratorsPerThread = 4;
+
+  IteratorPool();
+  ~IteratorPool() { Clear(); }
+
+  // No copying allowed
+  IteratorPool(const IteratorPool&) = delete;
+  void operator=(const IteratorPool&) = delete;
+
+  // Returns an iterator of cfd from the pool of this thread, created with
+  // the same read options and refreshed, or nullptr if there is none.
+  ArenaWrappedDBIter* Take(ColumnFamilyData* cfd,
+                           const ReadOptions& read_options);
+
+  // Returns the iterator handed to the user, which gives iter back to the
+  // pool of the deleting thread when deleted.
+  Iterator* Wrap(ArenaWrappedDBIter* iter);
+
+  // Keeps iter in the pool of this thread, or deletes it if it can not be
+  // refreshed.
+  void Give(ArenaWrappedDBIter* iter);
+
+  // Deletes the iterators of all the threads.
+  // REQUIRES: No concurrent Take() or deletion of a wrapped iterator
+  void Clear();
+
+ private:
+  struct ThreadIterators {
+    explicit ThreadIterators(IteratorPool* _pool) : pool(_pool) {}
+    IteratorPool* pool;
+    // The most recently given back last
+    std::vector<ArenaWrappedDBIter*> iters;
+  };
+
+  // Deleting an iterator may take the DB mutex, which must not be taken on
+  // thread exit, under the mutex of ThreadLocalPtr: the iterators of the
+  // exiting threads are left to the next Take() or Clear() to delete.
+  static void OnThreadExit(void* ptr);
+  void DeleteOrphans();
+
+  port::Mutex orphans_mutex_;
+  std::vector<ArenaWrappedDBIter*> orphans_;
+  std::atomic<bool> has_orphans_;
+  // ThreadIterators of each thread. Declared last to be destroyed first, as
+  // its destruction runs OnThreadExit() for the threads left.
+  ThreadLocalPtr local_;
 };
 
 // Generate the arena wrapped iterator class.
@@ -11,6 +11,7 @@
 #include "db/blob/blob_index.h"
 #include "db/blob/blob_log_format.h"
 #include "db/blob/blob_log_writer.h"
+#include "db/blob/blob_value_cache.h"
 #include "db/version_set.h"
 #include "file/filename.h"
 #include "file/read_write_util.h"
@@ -32,12 +33,14 @@ BlobFileBuilder::BlobFileBuilder(
     const std::string& column_family_name, Env::IOPriority io_priority,
     Env::WriteLifeTimeHint write_hint,
     std::vector<std::string>* blob_file_paths,
-    std::vector<BlobFileAddition>* blob_file_additions)
+    std::vector<BlobFileAddition>* blob_file_additions, int output_level,
+    bool fill_blob_cache)
     : BlobFileBuilder([versions]() { return versions->NewFileNumber(); }, env,
                       fs, immutable_cf_options, mutable_cf_options,
                       file_options, job_id, column_family_id,
                       column_family_name, io_priority, write_hint,
-                      blob_file_paths, blob_file_additions) {}
+                      blob_file_paths, blob_file_additions, output_level,
+                      fill_blob_cache, versions->blob_cache_key_prefix()) {}
 
 BlobFileBuilder::BlobFileBuilder(
     std::function<uint64_t()> file_number_generator, Env* env, FileSystem* fs,
@@ -47,7 +50,8 @@ BlobFileBuilder::BlobFileBuilder(
     const std::string& column_family_name, Env::IOPriority io_priority,
     Env::WriteLifeTimeHint write_hint,
     std::vector<std::string>* blob_file_paths,
-    std::vector<BlobFileAddition>* blob_file_additions)
+    std::vector<BlobFileAddition>* blob_file_additions, int output_level,
+    bool fill_blob_cache, const std::string& blob_cache_key_prefix)
     : file_number_generator_(std::move(file_number_generator)),
       env_(env),
       fs_(fs),
@@ -63,6 +67,11 @@ BlobFileBuilder::BlobFileBuilder(
       write_hint_(write_hint),
       blob_file_paths_(blob_file_paths),
       blob_file_additions_(blob_file_additions),
+      output_level_(output_level),
+      blob_cache_(fill_blob_cache && !blob_cache_key_prefix.empty()
+                      ? immutable_cf_options->blob_cache.get()
+                      : nullptr),
+      blob_cache_key_prefix_(blob_cache_key_prefix),
       blob_count_(0),
       blob_bytes_(0) {
   assert(file_number_generator_);
@@ -88,7 +97,7 @@ Status BlobFileBuilder::Add(const Slice& key, const Slice& value,
   }
 
   {
-    const Status s = OpenBlobFileIfNeeded();
+    const Status s = OpenBlobFileIfNeeded(value.size());
     if (!s.ok()) {
       return s;
     }
@@ -115,6 +124,14 @@ Status BlobFileBuilder::Add(const Slice& key, const Slice& value,
     }
   }
 
+  if (blob_cache_) {
+    BlobValueCache::Insert(
+        blob_cache_,
+        BlobValueCache::GetKey(blob_cache_key_prefix_, blob_file_number,
+                               blob_offset),
+        value, immutable_cf_options_->statistics);
+  }
+
   {
     const Status s = CloseBlobFileIfNeeded();
     if (!s.ok()) {
@@ -138,7 +155,7 @@ Status BlobFileBuilder::Finish() {
 
 bool BlobFileBuilder::IsBlobFileOpen() const { return !!writer_; }
 
-Status BlobFileBuilder::OpenBlobFileIfNeeded() {
+Status BlobFileBuilder::OpenBlobFileIfNeeded(uint64_t value_size) {
   if (IsBlobFileOpen()) {
     return Status::OK();
   }
@@ -177,6 +194,15 @@ Status BlobFileBuilder::OpenBlobFileIfNeeded() {
   file->SetIOPriority(io_priority_);
   file->SetWriteLifeTimeHint(write_hint_);
 
+  {
+    int64_t creation_time = 0;
+    // Best effort, blob files without a creation time share zones by level
+    // and value size only
+    env_->GetCurrentTime(&creation_time).PermitUncheckedError();
+    file->SetBlobFileHint(output_level_, static_cast<uint64_t>(creation_time),
+                          value_size);
+  }
+
   Statistics* const statistics = immutable_cf_options_->statistics;
 
   std::unique_ptr<WritableFileWriter> file_writer(new WritableFileWriter(
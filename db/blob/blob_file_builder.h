@@ -25,6 +25,7 @@ class BlobFileAddition;
 class Status;
 class Slice;
 class BlobLogWriter;
+class Cache;
 
 class BlobFileBuilder {
  public:
@@ -37,8 +38,11 @@ class BlobFileBuilder {
                   Env::IOPriority io_priority,
                   Env::WriteLifeTimeHint write_hint,
                   std::vector<std::string>* blob_file_paths,
-                  std::vector<BlobFileAddition>* blob_file_additions);
+                  std::vector<BlobFileAddition>* blob_file_additions,
+                  int output_level = -1, bool fill_blob_cache = false);
 
+  // Blobs are only added to the blob cache if a blob_cache_key_prefix is
+  // given, see VersionSet::blob_cache_key_prefix()
   BlobFileBuilder(std::function<uint64_t()> file_number_generator, Env* env,
                   FileSystem* fs,
                   const ImmutableCFOptions* immutable_cf_options,
@@ -49,7 +53,9 @@ class BlobFileBuilder {
                   Env::IOPriority io_priority,
                   Env::WriteLifeTimeHint write_hint,
                   std::vector<std::string>* blob_file_paths,
-                  std::vector<BlobFileAddition>* blob_file_additions);
+                  std::vector<BlobFileAddition>* blob_file_additions,
+                  int output_level = -1, bool fill_blob_cache = false,
+                  const std::string& blob_cache_key_prefix = std::string());
 
   BlobFileBuilder(const BlobFileBuilder&) = delete;
   BlobFileBuilder& operator=(const BlobFileBuilder&) = delete;
@@ -61,7 +67,7 @@ class BlobFileBuilder {
 
  private:
   bool IsBlobFileOpen() const;
-  Status OpenBlobFileIfNeeded();
+  Status OpenBlobFileIfNeeded(uint64_t value_size);
   Status CompressBlobIfNeeded(Slice* blob, std::string* compressed_blob) const;
   Status WriteBlobToFile(const Slice& key, const Slice& blob,
                          uint64_t* blob_file_number, uint64_t* blob_offset);
@@ -83,6 +89,9 @@ class BlobFileBuilder {
   Env::WriteLifeTimeHint write_hint_;
   std::vector<std::string>* blob_file_paths_;
   std::vector<BlobFileAddition>* blob_file_additions_;
+  int output_level_;  // -1 if unknown
+  Cache* blob_cache_;  // Written blobs are added to it if set
+  std::string blob_cache_key_prefix_;
   std::unique_ptr<BlobLogWriter> writer_;
   uint64_t blob_count_;
   uint64_t blob_bytes_;
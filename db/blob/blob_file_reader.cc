@@ -5,6 +5,7 @@
 
 #include "db/blob/blob_file_reader.h"
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 
@@ -333,6 +334,145 @@ Status BlobFileReader::GetBlob(const ReadOptions& read_options,
   return Status::OK();
 }
 
+void BlobFileReader::MultiGetBlob(
+    const ReadOptions& read_options,
+    std::vector<BlobReadRequest>* read_reqs) const {
+  assert(read_reqs);
+
+  // Records at most this far apart are read with a single request
+  constexpr uint64_t kMaxCoalescingGap = 4096;
+
+  const uint64_t num_blobs = read_reqs->size();
+
+  // Index of the coalesced read request covering each blob, or num_blobs if
+  // the blob is not read
+  std::vector<size_t> read_index(num_blobs, num_blobs);
+  std::vector<FSReadRequest> fs_reqs;
+  fs_reqs.reserve(num_blobs);
+
+  for (size_t i = 0; i < num_blobs; ++i) {
+    const BlobReadRequest& req = (*read_reqs)[i];
+    assert(req.user_key);
+    assert(req.value);
+    assert(req.status);
+    assert(i == 0 || (*read_reqs)[i - 1].offset <= req.offset);
+
+    const uint64_t key_size = req.user_key->size();
+
+    if (!IsValidBlobOffset(req.offset, key_size, req.value_size, file_size_)) {
+      *req.status = Status::Corruption("Invalid blob offset");
+      continue;
+    }
+
+    if (req.compression_type != compression_type_) {
+      *req.status =
+          Status::Corruption("Compression type mismatch when reading blob");
+      continue;
+    }
+
+    // See GetBlob() for the adjustment
+    const uint64_t adjustment =
+        read_options.verify_checksums
+            ? BlobLogRecord::CalculateAdjustmentForRecordHeader(key_size)
+            : 0;
+    assert(req.offset >= adjustment);
+
+    const uint64_t record_offset = req.offset - adjustment;
+    const uint64_t record_end = req.offset + req.value_size;
+
+    if (fs_reqs.empty() ||
+        record_offset > fs_reqs.back().offset + fs_reqs.back().len +
+                            kMaxCoalescingGap) {
+      FSReadRequest fs_req;
+      fs_req.offset = record_offset;
+      fs_req.len = static_cast<size_t>(record_end - record_offset);
+      fs_req.scratch = nullptr;
+      fs_reqs.emplace_back(fs_req);
+    } else {
+      FSReadRequest& fs_req = fs_reqs.back();
+      const uint64_t end = std::max(fs_req.offset + fs_req.len, record_end);
+      fs_req.offset = std::min(fs_req.offset, record_offset);
+      fs_req.len = static_cast<size_t>(end - fs_req.offset);
+    }
+
+    read_index[i] = fs_reqs.size() - 1;
+  }
+
+  if (fs_reqs.empty()) {
+    return;
+  }
+
+  std::vector<Buffer> bufs;
+  AlignedBuf aligned_buf;
+
+  if (!file_reader_->use_direct_io()) {
+    bufs.reserve(fs_reqs.size());
+    for (auto& fs_req : fs_reqs) {
+      bufs.emplace_back(new char[fs_req.len]);
+      fs_req.scratch = bufs.back().get();
+    }
+  }
+
+  TEST_SYNC_POINT("BlobFileReader::MultiGetBlob:ReadFromFile");
+
+  const Status s = file_reader_->MultiRead(IOOptions(), fs_reqs.data(),
+                                           fs_reqs.size(), &aligned_buf);
+
+  TEST_SYNC_POINT_CALLBACK("BlobFileReader::MultiGetBlob:TamperWithResult",
+                           &fs_reqs);
+
+  // All reads are done at this point, so the blobs below are independent of
+  // each other and of the file
+  for (size_t i = 0; i < num_blobs; ++i) {
+    if (read_index[i] == num_blobs) {
+      continue;
+    }
+
+    const BlobReadRequest& req = (*read_reqs)[i];
+    const FSReadRequest& fs_req = fs_reqs[read_index[i]];
+
+    if (!s.ok()) {
+      *req.status = s;
+      continue;
+    }
+
+    if (!fs_req.status.ok()) {
+      *req.status = fs_req.status;
+      continue;
+    }
+
+    const uint64_t key_size = req.user_key->size();
+    const uint64_t adjustment =
+        read_options.verify_checksums
+            ? BlobLogRecord::CalculateAdjustmentForRecordHeader(key_size)
+            : 0;
+    const uint64_t record_offset = req.offset - adjustment;
+    const uint64_t record_size = req.value_size + adjustment;
+
+    assert(record_offset >= fs_req.offset);
+    if (record_offset + record_size > fs_req.offset + fs_req.result.size()) {
+      *req.status = Status::Corruption("Failed to read data from blob file");
+      continue;
+    }
+
+    const Slice record_slice(
+        fs_req.result.data() + (record_offset - fs_req.offset),
+        static_cast<size_t>(record_size));
+
+    if (read_options.verify_checksums) {
+      *req.status = VerifyBlob(record_slice, *req.user_key, req.value_size);
+      if (!req.status->ok()) {
+        continue;
+      }
+    }
+
+    const Slice value_slice(record_slice.data() + adjustment, req.value_size);
+
+    *req.status =
+        UncompressBlobIfNeeded(value_slice, req.compression_type, req.value);
+  }
+}
+
 Status BlobFileReader::VerifyBlob(const Slice& record_slice,
                                   const Slice& user_key, uint64_t value_size) {
   BlobLogRecord record;
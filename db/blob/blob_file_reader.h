@@ -7,6 +7,7 @@
 
 #include <cinttypes>
 #include <memory>
+#include <vector>
 
 #include "file/random_access_file_reader.h"
 #include "rocksdb/compression_type.h"
@@ -24,6 +25,16 @@ class PinnableSlice;
 
 class BlobFileReader {
  public:
+  // A blob to be retrieved by MultiGetBlob
+  struct BlobReadRequest {
+    const Slice* user_key;
+    uint64_t offset;
+    uint64_t value_size;
+    CompressionType compression_type;
+    PinnableSlice* value;
+    Status* status;
+  };
+
   static Status Create(const ImmutableCFOptions& immutable_cf_options,
                        const FileOptions& file_options,
                        uint32_t column_family_id,
@@ -40,6 +51,13 @@ class BlobFileReader {
                  uint64_t offset, uint64_t value_size,
                  CompressionType compression_type, PinnableSlice* value) const;
 
+  // Retrieves the blobs specified by *read_reqs, which has to be sorted by
+  // offset, using a single MultiRead. Records that are close to each other in
+  // the file are coalesced into one read request. The result of each blob is
+  // reported through its own status.
+  void MultiGetBlob(const ReadOptions& read_options,
+                    std::vector<BlobReadRequest>* read_reqs) const;
+
  private:
   BlobFileReader(std::unique_ptr<RandomAccessFileReader>&& file_reader,
                  uint64_t file_size, CompressionType compression_type);
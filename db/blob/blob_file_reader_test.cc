@@ -7,6 +7,7 @@
 
 #include <cassert>
 #include <string>
+#include <vector>
 
 #include "db/blob/blob_log_format.h"
 #include "db/blob/blob_log_writer.h"
@@ -27,19 +28,22 @@ namespace ROCKSDB_NAMESPACE {
 
 namespace {
 
-// Creates a test blob file with a single blob in it. Note: this method
+// Creates a test blob file with the given blobs in it. Note: this method
 // makes it possible to test various corner cases by allowing the caller
 // to specify the contents of various blob file header/footer fields.
 void WriteBlobFile(const ImmutableCFOptions& immutable_cf_options,
                    uint32_t column_family_id, bool has_ttl,
                    const ExpirationRange& expiration_range_header,
                    const ExpirationRange& expiration_range_footer,
-                   uint64_t blob_file_number, const Slice& key,
-                   const Slice& blob, CompressionType compression_type,
-                   uint64_t* blob_offset, uint64_t* blob_size) {
+                   uint64_t blob_file_number, const std::vector<Slice>& keys,
+                   const std::vector<Slice>& blobs,
+                   CompressionType compression_type,
+                   std::vector<uint64_t>* blob_offsets,
+                   std::vector<uint64_t>* blob_sizes) {
   assert(!immutable_cf_options.cf_paths.empty());
-  assert(blob_offset);
-  assert(blob_size);
+  assert(keys.size() == blobs.size());
+  assert(blob_offsets);
+  assert(blob_sizes);
 
   const std::string blob_file_path = BlobFileName(
       immutable_cf_options.cf_paths.front().path, blob_file_number);
@@ -64,36 +68,40 @@ void WriteBlobFile(const ImmutableCFOptions& immutable_cf_options,
 
   ASSERT_OK(blob_log_writer.WriteHeader(header));
 
-  std::string compressed_blob;
-  Slice blob_to_write;
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    std::string compressed_blob;
+    Slice blob_to_write;
 
-  if (compression_type == kNoCompression) {
-    blob_to_write = blob;
-    *blob_size = blob.size();
-  } else {
-    CompressionOptions opts;
-    CompressionContext context(compression_type);
-    constexpr uint64_t sample_for_compression = 0;
+    if (compression_type == kNoCompression) {
+      blob_to_write = blobs[i];
+    } else {
+      CompressionOptions opts;
+      CompressionContext context(compression_type);
+      constexpr uint64_t sample_for_compression = 0;
 
-    CompressionInfo info(opts, context, CompressionDict::GetEmptyDict(),
-                         compression_type, sample_for_compression);
+      CompressionInfo info(opts, context, CompressionDict::GetEmptyDict(),
+                           compression_type, sample_for_compression);
 
-    constexpr uint32_t compression_format_version = 2;
+      constexpr uint32_t compression_format_version = 2;
 
-    ASSERT_TRUE(
-        CompressData(blob, info, compression_format_version, &compressed_blob));
+      ASSERT_TRUE(CompressData(blobs[i], info, compression_format_version,
+                               &compressed_blob));
 
-    blob_to_write = compressed_blob;
-    *blob_size = compressed_blob.size();
-  }
+      blob_to_write = compressed_blob;
+    }
 
-  uint64_t key_offset = 0;
+    uint64_t key_offset = 0;
+    uint64_t blob_offset = 0;
 
-  ASSERT_OK(
-      blob_log_writer.AddRecord(key, blob_to_write, &key_offset, blob_offset));
+    ASSERT_OK(blob_log_writer.AddRecord(keys[i], blob_to_write, &key_offset,
+                                        &blob_offset));
+
+    blob_offsets->emplace_back(blob_offset);
+    blob_sizes->emplace_back(blob_to_write.size());
+  }
 
   BlobLogFooter footer;
-  footer.blob_count = 1;
+  footer.blob_count = blobs.size();
   footer.expiration_range = expiration_range_footer;
 
   std::string checksum_method;
@@ -103,6 +111,31 @@ void WriteBlobFile(const ImmutableCFOptions& immutable_cf_options,
       blob_log_writer.AppendFooter(footer, &checksum_method, &checksum_value));
 }
 
+// Creates a test blob file with a single blob in it.
+void WriteBlobFile(const ImmutableCFOptions& immutable_cf_options,
+                   uint32_t column_family_id, bool has_ttl,
+                   const ExpirationRange& expiration_range_header,
+                   const ExpirationRange& expiration_range_footer,
+                   uint64_t blob_file_number, const Slice& key,
+                   const Slice& blob, CompressionType compression_type,
+                   uint64_t* blob_offset, uint64_t* blob_size) {
+  assert(blob_offset);
+  assert(blob_size);
+
+  std::vector<uint64_t> blob_offsets;
+  std::vector<uint64_t> blob_sizes;
+
+  WriteBlobFile(immutable_cf_options, column_family_id, has_ttl,
+                expiration_range_header, expiration_range_footer,
+                blob_file_number, {key}, {blob}, compression_type,
+                &blob_offsets, &blob_sizes);
+
+  if (!blob_offsets.empty()) {
+    *blob_offset = blob_offsets.front();
+    *blob_size = blob_sizes.front();
+  }
+}
+
 }  // anonymous namespace
 
 class BlobFileReaderTest : public testing::Test {
@@ -231,6 +264,86 @@ TEST_F(BlobFileReaderTest, CreateReaderAndGetBlob) {
   }
 }
 
+TEST_F(BlobFileReaderTest, MultiGetBlob) {
+  Options options;
+  options.env = &mock_env_;
+  options.cf_paths.emplace_back(
+      test::PerThreadDBPath(&mock_env_, "BlobFileReaderTest_MultiGetBlob"), 0);
+  options.enable_blob_files = true;
+
+  ImmutableCFOptions immutable_cf_options(options);
+
+  constexpr uint32_t column_family_id = 1;
+  constexpr bool has_ttl = false;
+  constexpr ExpirationRange expiration_range;
+  constexpr uint64_t blob_file_number = 1;
+
+  const std::vector<Slice> keys{"key1", "key2", "key3"};
+  const std::vector<Slice> blobs{"blob1", "blob2", "blob3"};
+
+  std::vector<uint64_t> blob_offsets;
+  std::vector<uint64_t> blob_sizes;
+
+  WriteBlobFile(immutable_cf_options, column_family_id, has_ttl,
+                expiration_range, expiration_range, blob_file_number, keys,
+                blobs, kNoCompression, &blob_offsets, &blob_sizes);
+
+  constexpr HistogramImpl* blob_file_read_hist = nullptr;
+
+  std::unique_ptr<BlobFileReader> reader;
+
+  ASSERT_OK(BlobFileReader::Create(immutable_cf_options, FileOptions(),
+                                   column_family_id, blob_file_read_hist,
+                                   blob_file_number, &reader));
+
+  // Make sure the blobs can be retrieved with and without checksum
+  // verification
+  for (bool verify_checksums : {false, true}) {
+    ReadOptions read_options;
+    read_options.verify_checksums = verify_checksums;
+
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<Status> statuses(keys.size());
+    std::vector<BlobFileReader::BlobReadRequest> read_reqs;
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+      read_reqs.push_back({&keys[i], blob_offsets[i], blob_sizes[i],
+                           kNoCompression, &values[i], &statuses[i]});
+    }
+
+    reader->MultiGetBlob(read_options, &read_reqs);
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+      ASSERT_OK(statuses[i]);
+      ASSERT_EQ(values[i], blobs[i]);
+    }
+  }
+
+  // An invalid request fails on its own
+  {
+    ReadOptions read_options;
+    read_options.verify_checksums = true;
+
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<Status> statuses(keys.size());
+    std::vector<BlobFileReader::BlobReadRequest> read_reqs;
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+      read_reqs.push_back({&keys[i], blob_offsets[i], blob_sizes[i],
+                           i == 1 ? kZSTD : kNoCompression, &values[i],
+                           &statuses[i]});
+    }
+
+    reader->MultiGetBlob(read_options, &read_reqs);
+
+    ASSERT_OK(statuses[0]);
+    ASSERT_EQ(values[0], blobs[0]);
+    ASSERT_TRUE(statuses[1].IsCorruption());
+    ASSERT_OK(statuses[2]);
+    ASSERT_EQ(values[2], blobs[2]);
+  }
+}
+
 TEST_F(BlobFileReaderTest, Malformed) {
   // Write a blob file consisting of nothing but a header, and make sure we
   // detect the error when we open it for reading
@@ -0,0 +1,90 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/blob/blob_value_cache.h"
+
+#include <atomic>
+#include <cassert>
+
+#include "cache/cache_helpers.h"
+#include "monitoring/statistics.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/slice.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+void ReleaseCacheHandle(void* arg1, void* arg2) {
+  Cache* const cache = static_cast<Cache*>(arg1);
+  Cache::Handle* const handle = static_cast<Cache::Handle*>(arg2);
+
+  cache->Release(handle);
+}
+
+}  // anonymous namespace
+
+std::string BlobValueCache::NewKeyPrefix() {
+  static std::atomic<uint64_t> next_id{1};
+
+  std::string key_prefix;
+  PutVarint64(&key_prefix, next_id.fetch_add(1, std::memory_order_relaxed));
+
+  return key_prefix;
+}
+
+std::string BlobValueCache::GetKey(const std::string& key_prefix,
+                                   uint64_t blob_file_number,
+                                   uint64_t offset) {
+  std::string key(key_prefix);
+  PutVarint64Varint64(&key, blob_file_number, offset);
+
+  return key;
+}
+
+bool BlobValueCache::Lookup(Cache* cache, const Slice& key,
+                            Statistics* statistics, PinnableSlice* value) {
+  assert(cache);
+  assert(value);
+
+  Cache::Handle* const handle = cache->Lookup(key, statistics);
+  if (!handle) {
+    RecordTick(statistics, BLOB_DB_CACHE_MISS);
+    return false;
+  }
+
+  const std::string* const blob =
+      GetFromCacheHandle<std::string>(cache, handle);
+
+  RecordTick(statistics, BLOB_DB_CACHE_HIT);
+  RecordTick(statistics, BLOB_DB_CACHE_BYTES_READ, blob->size());
+
+  value->Reset();
+  value->PinSlice(*blob, &ReleaseCacheHandle, cache, handle);
+
+  return true;
+}
+
+void BlobValueCache::Insert(Cache* cache, const Slice& key, const Slice& blob,
+                            Statistics* statistics) {
+  assert(cache);
+
+  std::string* const value = new std::string(blob.data(), blob.size());
+
+  const Status s = cache->Insert(key, value, value->size(),
+                                 &DeleteCacheEntry<std::string>,
+                                 nullptr /* handle */, Cache::Priority::LOW);
+  if (!s.ok()) {
+    // The cache deletes the entry if the insertion fails
+    RecordTick(statistics, BLOB_DB_CACHE_ADD_FAILURES);
+    return;
+  }
+
+  RecordTick(statistics, BLOB_DB_CACHE_ADD);
+  RecordTick(statistics, BLOB_DB_CACHE_BYTES_WRITE, blob.size());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,43 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cinttypes>
+#include <string>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Cache;
+class PinnableSlice;
+class Slice;
+class Statistics;
+
+// Helpers for the optional cache of uncompressed blob values (see
+// AdvancedColumnFamilyOptions::blob_cache). A blob is keyed by a prefix that
+// is unique to the DB instance, its blob file number and its offset; since
+// blob files are immutable and file numbers are never reused, cached values
+// never have to be invalidated.
+class BlobValueCache {
+ public:
+  // Returns a key prefix that is unique within the process.
+  static std::string NewKeyPrefix();
+
+  static std::string GetKey(const std::string& key_prefix,
+                            uint64_t blob_file_number, uint64_t offset);
+
+  // Looks up the blob with the given key. On a hit, the cached value is pinned
+  // in *value and true is returned.
+  static bool Lookup(Cache* cache, const Slice& key, Statistics* statistics,
+                     PinnableSlice* value);
+
+  // Adds a copy of blob to the cache, charged at its size.
+  static void Insert(Cache* cache, const Slice& key, const Slice& blob,
+                     Statistics* statistics);
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -44,6 +44,139 @@ TEST_F(DBBlobBasicTest, GetBlob) {
                   .IsIncomplete());
 }
 
+TEST_F(DBBlobBasicTest, GetBlobFromCache) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.blob_cache = NewLRUCache(1 << 20);
+  options.statistics = CreateDBStatistics();
+
+  Reopen(options);
+
+  constexpr char key[] = "key";
+  constexpr char blob_value[] = "blob_value";
+
+  ASSERT_OK(Put(key, blob_value));
+  ASSERT_OK(Flush());
+
+  // Reads with fill_cache unset leave the cache alone
+  ReadOptions no_fill_options;
+  no_fill_options.fill_cache = false;
+
+  PinnableSlice result;
+  ASSERT_OK(db_->Get(no_fill_options, db_->DefaultColumnFamily(), key,
+                     &result));
+  ASSERT_EQ(result, blob_value);
+  ASSERT_EQ(TestGetTickerCount(options, BLOB_DB_CACHE_MISS), 1);
+  ASSERT_EQ(TestGetTickerCount(options, BLOB_DB_CACHE_ADD), 0);
+
+  ASSERT_EQ(Get(key), blob_value);
+  ASSERT_EQ(TestGetTickerCount(options, BLOB_DB_CACHE_MISS), 2);
+  ASSERT_EQ(TestGetTickerCount(options, BLOB_DB_CACHE_ADD), 1);
+
+  ASSERT_EQ(Get(key), blob_value);
+  ASSERT_EQ(TestGetTickerCount(options, BLOB_DB_CACHE_HIT), 1);
+
+  // Cached blobs can be read without I/O
+  ReadOptions read_options;
+  read_options.read_tier = kBlockCacheTier;
+
+  result.Reset();
+  ASSERT_OK(db_->Get(read_options, db_->DefaultColumnFamily(), key, &result));
+  ASSERT_EQ(result, blob_value);
+  ASSERT_EQ(TestGetTickerCount(options, BLOB_DB_CACHE_HIT), 2);
+}
+
+TEST_F(DBBlobBasicTest, PrepopulateBlobCache) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.blob_cache = NewLRUCache(1 << 20);
+  options.prepopulate_blob_cache = true;
+  options.statistics = CreateDBStatistics();
+
+  Reopen(options);
+
+  constexpr char key[] = "key";
+  constexpr char blob_value[] = "blob_value";
+
+  ASSERT_OK(Put(key, blob_value));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(TestGetTickerCount(options, BLOB_DB_CACHE_ADD), 1);
+
+  for (bool fill_cache : {false, true}) {
+    ReadOptions read_options;
+    read_options.fill_cache = fill_cache;
+
+    PinnableSlice result;
+    ASSERT_OK(
+        db_->Get(read_options, db_->DefaultColumnFamily(), key, &result));
+    ASSERT_EQ(result, blob_value);
+  }
+
+  ASSERT_EQ(TestGetTickerCount(options, BLOB_DB_CACHE_HIT), 2);
+  ASSERT_EQ(TestGetTickerCount(options, BLOB_DB_CACHE_MISS), 0);
+}
+
+TEST_F(DBBlobBasicTest, MultiGetBlobs) {
+  constexpr size_t min_blob_size = 6;
+
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = min_blob_size;
+
+  Reopen(options);
+
+  // Two blob files with two blobs each, plus an inlined value and a value in
+  // the memtable
+  ASSERT_OK(Put("key1", "blob_value1"));
+  ASSERT_OK(Put("key2", "blob_value2"));
+  ASSERT_OK(Put("key3", "short"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("key4", "blob_value4"));
+  ASSERT_OK(Put("key5", "blob_value5"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("key6", "memtable_value"));
+
+  std::vector<std::string> key_strs{"key5", "key1", "key3", "key6",
+                                    "key2", "key4", "no_such_key"};
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  std::vector<PinnableSlice> values(keys.size());
+  std::vector<Status> statuses(keys.size());
+
+  db_->MultiGet(ReadOptions(), db_->DefaultColumnFamily(), keys.size(),
+                keys.data(), values.data(), statuses.data());
+
+  ASSERT_OK(statuses[0]);
+  ASSERT_EQ(values[0], "blob_value5");
+  ASSERT_OK(statuses[1]);
+  ASSERT_EQ(values[1], "blob_value1");
+  ASSERT_OK(statuses[2]);
+  ASSERT_EQ(values[2], "short");
+  ASSERT_OK(statuses[3]);
+  ASSERT_EQ(values[3], "memtable_value");
+  ASSERT_OK(statuses[4]);
+  ASSERT_EQ(values[4], "blob_value2");
+  ASSERT_OK(statuses[5]);
+  ASSERT_EQ(values[5], "blob_value4");
+  ASSERT_TRUE(statuses[6].IsNotFound());
+
+  // Blobs can only be read from the blob files
+  ReadOptions read_options;
+  read_options.read_tier = kBlockCacheTier;
+
+  std::vector<PinnableSlice> cached_values(keys.size());
+  std::vector<Status> cached_statuses(keys.size());
+
+  db_->MultiGet(read_options, db_->DefaultColumnFamily(), keys.size(),
+                keys.data(), cached_values.data(), cached_statuses.data());
+
+  ASSERT_TRUE(cached_statuses[0].IsIncomplete());
+  ASSERT_TRUE(cached_statuses[1].IsIncomplete());
+  ASSERT_OK(cached_statuses[2]);
+  ASSERT_EQ(cached_values[2], "short");
+}
+
 TEST_F(DBBlobBasicTest, GetBlob_CorruptIndex) {
   Options options = GetDefaultOptions();
   options.enable_blob_files = true;
@@ -129,6 +262,114 @@ TEST_F(DBBlobBasicTest, GetBlob_IndexWithInvalidFileNumber) {
                   .IsCorruption());
 }
 
+TEST_F(DBBlobBasicTest, GarbageCollectOldBlobsDuringCompaction) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.enable_blob_garbage_collection = true;
+  options.blob_garbage_collection_age_cutoff = 0.5;
+  options.disable_auto_compactions = true;
+  options.statistics = CreateDBStatistics();
+
+  Reopen(options);
+
+  constexpr size_t num_blob_files = 4;
+
+  for (size_t i = 0; i < num_blob_files; ++i) {
+    ASSERT_OK(Put("key" + ToString(i), "blob_value" + ToString(i)));
+    ASSERT_OK(Flush());
+  }
+
+  auto get_blob_file_numbers = [this]() {
+    VersionSet* const versions = dbfull()->TEST_GetVersionSet();
+    assert(versions);
+
+    ColumnFamilyData* const cfd = versions->GetColumnFamilySet()->GetDefault();
+    assert(cfd);
+
+    const VersionStorageInfo* const storage_info =
+        cfd->current()->storage_info();
+    assert(storage_info);
+
+    std::vector<uint64_t> blob_file_numbers;
+    for (const auto& pair : storage_info->GetBlobFiles()) {
+      blob_file_numbers.emplace_back(pair.first);
+    }
+
+    return blob_file_numbers;
+  };
+
+  const std::vector<uint64_t> original_blob_files = get_blob_file_numbers();
+  ASSERT_EQ(original_blob_files.size(), num_blob_files);
+
+  constexpr Slice* begin = nullptr;
+  constexpr Slice* end = nullptr;
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), begin, end));
+
+  for (size_t i = 0; i < num_blob_files; ++i) {
+    ASSERT_EQ(Get("key" + ToString(i)), "blob_value" + ToString(i));
+  }
+
+  // The blobs of the two oldest files were moved to a new blob file, which
+  // left the old files without any referencing SST.
+  const std::vector<uint64_t> new_blob_files = get_blob_file_numbers();
+  ASSERT_EQ(new_blob_files.size(), 3);
+  ASSERT_EQ(new_blob_files[0], original_blob_files[2]);
+  ASSERT_EQ(new_blob_files[1], original_blob_files[3]);
+  ASSERT_GT(new_blob_files[2], original_blob_files[3]);
+
+  ASSERT_EQ(TestGetTickerCount(options, BLOB_DB_GC_NUM_KEYS_RELOCATED), 2);
+  ASSERT_GT(TestGetTickerCount(options, BLOB_DB_GC_BYTES_RELOCATED), 0);
+}
+
+TEST_F(DBBlobBasicTest, BlobFileStartingLevel) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.blob_file_starting_level = 1;
+  options.disable_auto_compactions = true;
+
+  Reopen(options);
+
+  auto get_blob_file_count = [this]() {
+    VersionSet* const versions = dbfull()->TEST_GetVersionSet();
+    assert(versions);
+
+    ColumnFamilyData* const cfd = versions->GetColumnFamilySet()->GetDefault();
+    assert(cfd);
+
+    return cfd->current()->storage_info()->GetBlobFiles().size();
+  };
+
+  constexpr char key[] = "key";
+  constexpr char blob_value[] = "blob_value";
+
+  // The flush keeps the value inline
+  ASSERT_OK(Put(key, blob_value));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(get_blob_file_count(), 0);
+  ASSERT_EQ(Get(key), blob_value);
+
+  // The compaction into L1 moves it to a blob file
+  CompactRangeOptions cro;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_EQ(NumTableFilesAtLevel(0), 0);
+  ASSERT_EQ(NumTableFilesAtLevel(1), 1);
+  ASSERT_EQ(get_blob_file_count(), 1);
+  ASSERT_EQ(Get(key), blob_value);
+
+  // Flushes write blob files again once the starting level is lowered
+  ASSERT_OK(
+      db_->SetOptions(db_->DefaultColumnFamily(),
+                      {{"blob_file_starting_level", "0"}}));
+  ASSERT_OK(Put("key2", blob_value));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(get_blob_file_count(), 2);
+  ASSERT_EQ(Get("key2"), blob_value);
+}
+
 class DBBlobBasicIOErrorTest : public DBBlobBasicTest,
                                public testing::WithParamInterface<std::string> {
  protected:
@@ -0,0 +1,146 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/block_cache_warmup.h"
+
+#include <algorithm>
+
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// The file is
+//   fixed32: kMagic
+//   varint64: number of blocks
+//   for each block, by file number and offset:
+//     varint64: file number
+//     varint64: offset
+//     varint64: size
+//   fixed32: masked crc32c of all of the above
+const uint32_t kMagic = 0x42435731;  // "BCW1"
+}  // namespace
+
+size_t BlockCacheWarmup::KeyHash::operator()(const Key& key) const {
+  char buf[2 * sizeof(uint64_t)];
+  EncodeFixed64(buf, key.file_number);
+  EncodeFixed64(buf + sizeof(uint64_t), key.offset);
+  return static_cast<size_t>(Hash64(buf, sizeof(buf)));
+}
+
+BlockCacheWarmup::BlockCacheWarmup(uint64_t max_size)
+    : max_size_(max_size),
+      max_generation_size_per_shard_(
+          std::max<uint64_t>(max_size / 2 / kNumShards, 1)) {}
+
+void BlockCacheWarmup::Record(uint64_t file_number, uint64_t offset,
+                              uint64_t size, bool cache_hit) {
+  if (cache_hit && !Random::GetTLSInstance()->OneIn(kSampleHitsOneIn)) {
+    return;
+  }
+  Key key{file_number, offset};
+  Shard& shard = shards_[KeyHash()(key) % kNumShards];
+  MutexLock l(&shard.mutex);
+  if (!shard.current.emplace(key, size).second) {
+    return;
+  }
+  shard.current_size += size;
+  if (shard.current_size > max_generation_size_per_shard_) {
+    shard.previous.swap(shard.current);
+    shard.current.clear();
+    shard.current_size = 0;
+  }
+}
+
+Status BlockCacheWarmup::Save(FileSystem* fs, const std::string& fname,
+                              const std::function<bool(uint64_t)>& is_live,
+                              size_t* num_blocks) {
+  std::vector<BlockInfo> blocks;
+  uint64_t total_size = 0;
+  // The current generations first
+  for (int generation = 0; generation < 2; generation++) {
+    for (auto& shard : shards_) {
+      MutexLock l(&shard.mutex);
+      const BlockMap& map = generation == 0 ? shard.current : shard.previous;
+      for (const auto& entry : map) {
+        if (total_size + entry.second > max_size_) {
+          break;
+        }
+        if ((generation == 1 && shard.current.count(entry.first) > 0) ||
+            !is_live(entry.first.file_number)) {
+          continue;
+        }
+        blocks.push_back(
+            {entry.first.file_number, entry.first.offset, entry.second});
+        total_size += entry.second;
+      }
+    }
+  }
+  std::sort(blocks.begin(), blocks.end(),
+            [](const BlockInfo& a, const BlockInfo& b) {
+              return a.file_number < b.file_number ||
+                     (a.file_number == b.file_number && a.offset < b.offset);
+            });
+
+  std::string data;
+  PutFixed32(&data, kMagic);
+  PutVarint64(&data, blocks.size());
+  for (const auto& block : blocks) {
+    PutVarint64(&data, block.file_number);
+    PutVarint64(&data, block.offset);
+    PutVarint64(&data, block.size);
+  }
+  PutFixed32(&data, crc32c::Mask(crc32c::Value(data.data(), data.size())));
+  *num_blocks = blocks.size();
+  return WriteStringToFile(fs, data, fname, true /* should_sync */);
+}
+
+Status BlockCacheWarmup::Load(FileSystem* fs, const std::string& fname,
+                              std::vector<BlockInfo>* blocks) {
+  blocks->clear();
+  std::string data;
+  Status s = ReadFileToString(fs, fname, &data);
+  if (!s.ok()) {
+    return s;
+  }
+  if (data.size() < 2 * sizeof(uint32_t)) {
+    return Status::Corruption("Truncated block cache warm-up file", fname);
+  }
+  const size_t body_size = data.size() - sizeof(uint32_t);
+  const uint32_t expected_crc =
+      crc32c::Unmask(DecodeFixed32(data.data() + body_size));
+  if (crc32c::Value(data.data(), body_size) != expected_crc) {
+    return Status::Corruption("Block cache warm-up file checksum mismatch",
+                              fname);
+  }
+
+  Slice input(data.data(), body_size);
+  if (DecodeFixed32(input.data()) != kMagic) {
+    return Status::Corruption("Bad block cache warm-up file magic", fname);
+  }
+  input.remove_prefix(sizeof(uint32_t));
+  uint64_t num_blocks = 0;
+  bool ok = GetVarint64(&input, &num_blocks);
+  for (uint64_t i = 0; ok && i < num_blocks; i++) {
+    BlockInfo block;
+    ok = GetVarint64(&input, &block.file_number) &&
+         GetVarint64(&input, &block.offset) &&
+         GetVarint64(&input, &block.size);
+    if (ok) {
+      blocks->push_back(block);
+    }
+  }
+  if (!ok || !input.empty()) {
+    blocks->clear();
+    return Status::Corruption("Bad block cache warm-up file record", fname);
+  }
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,92 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The data blocks of the table files read through the block cache, for
+// saving the hottest ones to a file that the next DB::Open() reads them
+// back into the block cache from, instead of the cache warming up with the
+// reads.
+//
+// A block is recorded when it is inserted into the block cache, and on one
+// in kSampleHitsOneIn cache hits. The blocks recorded make two generations
+// of up to half the size limit each: the current one, recorded into, and
+// the previous one, dropped when the current one fills up and takes its
+// place. So the blocks kept are about the most recently read ones.
+class BlockCacheWarmup {
+ public:
+  struct BlockInfo {
+    uint64_t file_number;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  static const int kSampleHitsOneIn = 16;
+
+  // Keeps up to max_size bytes of blocks
+  explicit BlockCacheWarmup(uint64_t max_size);
+
+  // No copying allowed
+  BlockCacheWarmup(const BlockCacheWarmup&) = delete;
+  void operator=(const BlockCacheWarmup&) = delete;
+
+  // Records a data block found in or inserted into the block cache
+  void Record(uint64_t file_number, uint64_t offset, uint64_t size,
+              bool cache_hit);
+
+  // Saves the blocks recorded of the files is_live returns true for in
+  // fname, up to the size limit, the most recently read first
+  Status Save(FileSystem* fs, const std::string& fname,
+              const std::function<bool(uint64_t)>& is_live,
+              size_t* num_blocks);
+
+  // Reads the blocks saved in fname, sorted by file number and offset.
+  // Returns NotFound if there is no such file, and Corruption if it does
+  // not check out.
+  static Status Load(FileSystem* fs, const std::string& fname,
+                     std::vector<BlockInfo>* blocks);
+
+ private:
+  static const int kNumShards = 16;
+
+  struct Key {
+    uint64_t file_number;
+    uint64_t offset;
+    bool operator==(const Key& other) const {
+      return file_number == other.file_number && offset == other.offset;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+  // The block sizes by block
+  typedef std::unordered_map<Key, uint64_t, KeyHash> BlockMap;
+
+  struct Shard {
+    port::Mutex mutex;
+    BlockMap current;
+    uint64_t current_size = 0;
+    BlockMap previous;
+  };
+
+  const uint64_t max_size_;
+  const uint64_t max_generation_size_per_shard_;
+  Shard shards_[kNumShards];
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -22,6 +22,7 @@
 #include "db/output_validator.h"
 #include "db/range_del_aggregator.h"
 #include "db/table_cache.h"
+#include "db/table_properties_collector.h"
 #include "db/version_edit.h"
 #include "file/filename.h"
 #include "file/read_write_util.h"
@@ -152,6 +153,14 @@ Status BuildTable(
       }
       file->SetIOPriority(io_priority);
       file->SetWriteLifeTimeHint(write_hint);
+      const uint64_t bucket_seconds =
+          mutable_cf_options.compaction_options_fifo.zone_time_bucket_seconds;
+      if (ioptions.compaction_style == kCompactionStyleFIFO &&
+          bucket_seconds > 0) {
+        // FIFO TTL expires files by their creation time
+        uint64_t t = creation_time ? creation_time : file_creation_time;
+        file->SetTimeBucket(t / bucket_seconds + 1);
+      }
 
       file_writer.reset(new WritableFileWriter(
           std::move(file), fname, file_options, env, io_tracer,
@@ -173,12 +182,16 @@ Status BuildTable(
                       snapshot_checker);
 
     std::unique_ptr<BlobFileBuilder> blob_file_builder(
-        (mutable_cf_options.enable_blob_files && blob_file_additions)
+        (mutable_cf_options.enable_blob_files &&
+         mutable_cf_options.blob_file_starting_level <= 0 &&
+         blob_file_additions)
             ? new BlobFileBuilder(versions, env, fs, &ioptions,
                                   &mutable_cf_options, &file_options, job_id,
                                   column_family_id, column_family_name,
                                   io_priority, write_hint, &blob_file_paths,
-                                  blob_file_additions)
+                                  blob_file_additions, 0 /* output_level */,
+                                  mutable_cf_options.prepopulate_blob_cache &&
+                                      reason == TableFileCreationReason::kFlush)
             : nullptr);
 
     CompactionIterator c_iter(
@@ -243,6 +256,8 @@ Status BuildTable(
       meta->marked_for_compaction = builder->NeedCompact();
       assert(meta->fd.GetFileSize() > 0);
       tp = builder->GetTableProperties(); // refresh now that builder is finished
+      GetTimestampRange(tp.user_collected_properties, &meta->min_timestamp,
+                        &meta->max_timestamp);
       if (table_properties) {
         *table_properties = tp;
       }
@@ -12,6 +12,7 @@
 #include "rocksdb/c.h"
 
 #include <stdlib.h>
+#include "db/write_batch_internal.h"
 #include "port/port.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/compaction_filter.h"
@@ -112,6 +113,7 @@ using ROCKSDB_NAMESPACE::TransactionOptions;
 using ROCKSDB_NAMESPACE::WALRecoveryMode;
 using ROCKSDB_NAMESPACE::WritableFile;
 using ROCKSDB_NAMESPACE::WriteBatch;
+using ROCKSDB_NAMESPACE::WriteBatchInternal;
 using ROCKSDB_NAMESPACE::WriteBatchWithIndex;
 using ROCKSDB_NAMESPACE::WriteOptions;
 
@@ -169,6 +171,10 @@ struct rocksdb_perfcontext_t     { PerfContext*      rep; };
 struct rocksdb_pinnableslice_t {
   PinnableSlice rep;
 };
+struct rocksdb_pinned_values_t {
+  std::vector<PinnableSlice> values;
+  std::vector<Status> statuses;
+};
 struct rocksdb_transactiondb_options_t {
   TransactionDBOptions rep;
 };
@@ -1191,6 +1197,90 @@ void rocksdb_multi_get_cf(
   }
 }
 
+namespace {
+// Looks up the keys packed in keys, saving the statuses that are not OK or
+// NotFound in errs
+void BatchedMultiGet(rocksdb_t* db, const rocksdb_readoptions_t* options,
+                     rocksdb_column_family_handle_t* column_family,
+                     size_t num_keys, const char* keys,
+                     const size_t* key_offsets, bool sorted_input,
+                     PinnableSlice* values, Status* statuses, char** errs) {
+  std::vector<Slice> key_slices(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    key_slices[i] =
+        Slice(keys + key_offsets[i], key_offsets[i + 1] - key_offsets[i]);
+  }
+  db->rep->MultiGet(options->rep, column_family->rep, num_keys,
+                    key_slices.data(), values, statuses, sorted_input);
+  for (size_t i = 0; i < num_keys; i++) {
+    if (statuses[i].ok() || statuses[i].IsNotFound()) {
+      errs[i] = nullptr;
+    } else {
+      errs[i] = strdup(statuses[i].ToString().c_str());
+    }
+  }
+}
+}  // namespace
+
+size_t rocksdb_batched_multi_get_cf_into(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    rocksdb_column_family_handle_t* column_family, size_t num_keys,
+    const char* keys, const size_t* key_offsets, unsigned char sorted_input,
+    char* values, size_t values_size, size_t* value_offsets,
+    unsigned char* found, char** errs) {
+  std::vector<PinnableSlice> pinned(num_keys);
+  std::vector<Status> statuses(num_keys);
+  BatchedMultiGet(db, options, column_family, num_keys, keys, key_offsets,
+                  sorted_input, pinned.data(), statuses.data(), errs);
+  size_t used = 0;
+  value_offsets[0] = 0;
+  for (size_t i = 0; i < num_keys; i++) {
+    found[i] = statuses[i].ok();
+    if (found[i]) {
+      if (pinned[i].size() > values_size - used) {
+        // Drop the errors of the keys not done, as the caller retries them
+        for (size_t j = i; j < num_keys; j++) {
+          free(errs[j]);
+          errs[j] = nullptr;
+        }
+        return i;
+      }
+      memcpy(values + used, pinned[i].data(), pinned[i].size());
+      used += pinned[i].size();
+    }
+    value_offsets[i + 1] = used;
+  }
+  return num_keys;
+}
+
+rocksdb_pinned_values_t* rocksdb_batched_multi_get_cf_pinned(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    rocksdb_column_family_handle_t* column_family, size_t num_keys,
+    const char* keys, const size_t* key_offsets, unsigned char sorted_input,
+    char** errs) {
+  rocksdb_pinned_values_t* result = new rocksdb_pinned_values_t;
+  result->values.resize(num_keys);
+  result->statuses.resize(num_keys);
+  BatchedMultiGet(db, options, column_family, num_keys, keys, key_offsets,
+                  sorted_input, result->values.data(),
+                  result->statuses.data(), errs);
+  return result;
+}
+
+const char* rocksdb_pinned_values_get(const rocksdb_pinned_values_t* values,
+                                      size_t index, size_t* vlen) {
+  if (index >= values->statuses.size() || !values->statuses[index].ok()) {
+    *vlen = 0;
+    return nullptr;
+  }
+  *vlen = values->values[index].size();
+  return values->values[index].data();
+}
+
+void rocksdb_pinned_values_destroy(rocksdb_pinned_values_t* values) {
+  delete values;
+}
+
 unsigned char rocksdb_key_may_exist(rocksdb_t* db,
                                     const rocksdb_readoptions_t* options,
                                     const char* key, size_t key_len,
@@ -1652,6 +1742,28 @@ void rocksdb_writebatch_putv_cf(
              SliceParts(value_slices.data(), num_values));
 }
 
+void rocksdb_writebatch_put_packed_cf(
+    rocksdb_writebatch_t* b, rocksdb_column_family_handle_t* column_family,
+    size_t num_entries, const char* keys, const size_t* key_offsets,
+    const char* values, const size_t* value_offsets) {
+  for (size_t i = 0; i < num_entries; i++) {
+    Slice key(keys + key_offsets[i], key_offsets[i + 1] - key_offsets[i]);
+    Slice value(values + value_offsets[i],
+                value_offsets[i + 1] - value_offsets[i]);
+    b->rep.Put(column_family->rep, key, value);
+  }
+}
+
+void rocksdb_writebatch_append_data(rocksdb_writebatch_t* b, const char* rep,
+                                    size_t size, char** errptr) {
+  if (size < WriteBatchInternal::kHeader) {
+    SaveError(errptr, Status::InvalidArgument("Malformed write batch"));
+    return;
+  }
+  WriteBatch src(std::string(rep, size));
+  SaveError(errptr, WriteBatchInternal::Append(&b->rep, &src));
+}
+
 void rocksdb_writebatch_merge(
     rocksdb_writebatch_t* b,
     const char* key, size_t klen,
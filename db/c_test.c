@@ -1300,6 +1300,71 @@ int main(int argc, char** argv) {
       Free(&vals[i]);
     }
 
+    {
+      // Packed puts, and a batch appended whole
+      rocksdb_writebatch_t* packed = rocksdb_writebatch_create();
+      const size_t put_key_offsets[3] = {0, 2, 5};
+      const size_t put_value_offsets[3] = {0, 2, 5};
+      rocksdb_writebatch_put_packed_cf(packed, handles[1], 2, "k1k22",
+                                       put_key_offsets, "v1v22",
+                                       put_value_offsets);
+      rocksdb_writebatch_t* other = rocksdb_writebatch_create();
+      rocksdb_writebatch_put_cf(other, handles[1], "k3", 2, "v3", 2);
+      size_t rep_size;
+      const char* rep = rocksdb_writebatch_data(other, &rep_size);
+      rocksdb_writebatch_append_data(packed, rep, rep_size, &err);
+      CheckNoError(err);
+      rocksdb_writebatch_append_data(packed, rep, 3, &err);
+      CheckCondition(err != NULL);
+      Free(&err);
+      CheckCondition(rocksdb_writebatch_count(packed) == 3);
+      rocksdb_write(db, woptions, packed, &err);
+      CheckNoError(err);
+      rocksdb_writebatch_destroy(other);
+      rocksdb_writebatch_destroy(packed);
+      CheckGetCF(db, roptions, handles[1], "k1", "v1");
+      CheckGetCF(db, roptions, handles[1], "k22", "v22");
+      CheckGetCF(db, roptions, handles[1], "k3", "v3");
+
+      const size_t key_offsets[4] = {0, 3, 5, 9};
+      char arena[16];
+      size_t value_offsets[4];
+      unsigned char found[3];
+      size_t n = rocksdb_batched_multi_get_cf_into(
+          db, roptions, handles[1], 3, "boxk1nope", key_offsets, 0, arena,
+          sizeof(arena), value_offsets, found, errs);
+      CheckCondition(n == 3);
+      for (i = 0; i < 3; i++) {
+        CheckEqual(NULL, errs[i], 0);
+      }
+      CheckCondition(found[0] && found[1] && !found[2]);
+      CheckEqual("c", arena + value_offsets[0],
+                 value_offsets[1] - value_offsets[0]);
+      CheckEqual("v1", arena + value_offsets[1],
+                 value_offsets[2] - value_offsets[1]);
+      CheckCondition(value_offsets[3] == value_offsets[2]);
+      // Only the first value fits
+      n = rocksdb_batched_multi_get_cf_into(
+          db, roptions, handles[1], 3, "boxk1nope", key_offsets, 0, arena, 2,
+          value_offsets, found, errs);
+      CheckCondition(n == 1);
+      CheckEqual("c", arena, value_offsets[1]);
+
+      rocksdb_pinned_values_t* pinned = rocksdb_batched_multi_get_cf_pinned(
+          db, roptions, handles[1], 3, "boxk1nope", key_offsets, 0, errs);
+      for (i = 0; i < 3; i++) {
+        CheckEqual(NULL, errs[i], 0);
+      }
+      size_t val_len;
+      const char* val = rocksdb_pinned_values_get(pinned, 0, &val_len);
+      CheckEqual("c", val, val_len);
+      val = rocksdb_pinned_values_get(pinned, 1, &val_len);
+      CheckEqual("v1", val, val_len);
+      val = rocksdb_pinned_values_get(pinned, 2, &val_len);
+      CheckEqual(NULL, val, val_len);
+      rocksdb_pinned_values_destroy(pinned);
+    }
+
     {
       unsigned char value_found = 0;
 
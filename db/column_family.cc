@@ -26,6 +26,7 @@
 #include "db/job_context.h"
 #include "db/range_del_aggregator.h"
 #include "db/table_properties_collector.h"
+#include "db/version_files_snapshot.h"
 #include "db/version_set.h"
 #include "db/write_controller.h"
 #include "file/sst_file_manager_impl.h"
@@ -117,6 +118,11 @@ void GetIntTblPropCollectorFactory(
     int_tbl_prop_collector_factories->emplace_back(
         new UserKeyTablePropertiesCollectorFactory(collector_factories[i]));
   }
+  if (ioptions.user_comparator->timestamp_size() > 0) {
+    int_tbl_prop_collector_factories->emplace_back(
+        new TimestampTablePropertiesCollectorFactory(
+            ioptions.user_comparator));
+  }
 }
 
 Status CheckCompressionSupported(const ColumnFamilyOptions& cf_options) {
@@ -560,6 +566,12 @@ ColumnFamilyData::ColumnFamilyData(
         new InternalStats(ioptions_.num_levels, db_options.env, this));
     table_cache_.reset(new TableCache(ioptions_, file_options, _table_cache,
                                       block_cache_tracer, io_tracer));
+    if (column_family_set != nullptr) {
+      table_cache_->SetMetadataCheckpoint(
+          column_family_set->table_metadata_checkpoint());
+      table_cache_->SetBlockCacheWarmup(
+          column_family_set->block_cache_warmup());
+    }
     blob_file_cache_.reset(
         new BlobFileCache(_table_cache, ioptions(), soptions(), id_,
                           internal_stats_->GetBlobFileReadHist()));
@@ -730,6 +742,15 @@ const double kDecSlowdownRatio = 1 / kIncSlowdownRatio;
 const double kNearStopSlowdownRatio = 0.6;
 const double kDelayRecoverSlowdownRatio = 1.4;
 
+// smooth_write_stall: rates are sampled over windows of at least this long
+const uint64_t kSmoothStallWindowMicros = 1000000;
+// Pending compaction bytes are projected this far at their growth rate
+const double kSmoothStallHorizonSec = 30;
+// Integral time of the controller, and the bound of its integral term
+const double kSmoothStallIntegralSec = 60;
+// The smoothing delay never goes below this fraction of the base rate
+const double kSmoothStallMinRatio = 0.1;
+
 namespace {
 // If penalize_stop is true, we further reduce slowdown rate.
 std::unique_ptr<WriteControllerToken> SetupDelay(
@@ -828,7 +849,7 @@ int GetL0ThresholdSpeedupCompaction(int level0_file_num_compaction_trigger,
 }
 }  // namespace
 
-std::pair<WriteStallCondition, ColumnFamilyData::WriteStallCause>
+std::pair<WriteStallCondition, WriteStallCause>
 ColumnFamilyData::GetWriteStallConditionAndCause(
     int num_unflushed_memtables, int num_l0_files,
     uint64_t num_compaction_needed_bytes,
@@ -863,6 +884,114 @@ ColumnFamilyData::GetWriteStallConditionAndCause(
   return {WriteStallCondition::kNormal, WriteStallCause::kNone};
 }
 
+std::unique_ptr<WriteControllerToken> ColumnFamilyData::SetupSmoothDelay(
+    WriteController* write_controller,
+    const MutableCFOptions& mutable_cf_options) {
+  if (!mutable_cf_options.smooth_write_stall ||
+      mutable_cf_options.disable_auto_compactions) {
+    smooth_stall_ = SmoothStallState();
+    return nullptr;
+  }
+  auto* vstorage = current_->storage_info();
+  const uint64_t now = ioptions_.env->NowMicros();
+  const uint64_t compaction_needed_bytes =
+      vstorage->estimated_compaction_needed_bytes();
+  const uint64_t bytes_flushed =
+      internal_stats_->GetCFStats(InternalStats::BYTES_FLUSHED);
+
+  // Sample flush throughput and compaction debt growth. Version changes come
+  // in bursts, so rates are only taken over windows long enough to mean
+  // something, and averaged with the previous window.
+  if (smooth_stall_.window_start_micros == 0 ||
+      now < smooth_stall_.window_start_micros) {
+    smooth_stall_.window_start_micros = now;
+    smooth_stall_.window_bytes_flushed = bytes_flushed;
+    smooth_stall_.window_compaction_needed_bytes = compaction_needed_bytes;
+  } else if (now - smooth_stall_.window_start_micros >=
+             kSmoothStallWindowMicros) {
+    double window_sec =
+        static_cast<double>(now - smooth_stall_.window_start_micros) / 1e6;
+    double flush_rate =
+        static_cast<double>(bytes_flushed -
+                            smooth_stall_.window_bytes_flushed) /
+        window_sec;
+    double debt_growth_rate =
+        (static_cast<double>(compaction_needed_bytes) -
+         static_cast<double>(smooth_stall_.window_compaction_needed_bytes)) /
+        window_sec;
+    smooth_stall_.flush_rate = (smooth_stall_.flush_rate + flush_rate) / 2;
+    smooth_stall_.debt_growth_rate =
+        (smooth_stall_.debt_growth_rate + debt_growth_rate) / 2;
+    smooth_stall_.window_start_micros = now;
+    smooth_stall_.window_bytes_flushed = bytes_flushed;
+    smooth_stall_.window_compaction_needed_bytes = compaction_needed_bytes;
+  }
+
+  // The error is how far L0 and the projected compaction debt are past their
+  // targets, as a fraction of the way from the target to the slowdown
+  // trigger. Negative below target.
+  double error = -1;
+  if (mutable_cf_options.level0_slowdown_writes_trigger > 0) {
+    int target_l0 = mutable_cf_options.smooth_write_stall_target_l0_files;
+    if (target_l0 <= 0) {
+      target_l0 = (mutable_cf_options.level0_file_num_compaction_trigger +
+                   mutable_cf_options.level0_slowdown_writes_trigger) /
+                  2;
+    }
+    target_l0 = std::min(target_l0,
+                         mutable_cf_options.level0_slowdown_writes_trigger - 1);
+    int span =
+        std::max(1, mutable_cf_options.level0_slowdown_writes_trigger -
+                        target_l0);
+    error = std::max(
+        error, static_cast<double>(vstorage->l0_delay_trigger_count() -
+                                   target_l0) /
+                   span);
+  }
+  const uint64_t soft_limit =
+      mutable_cf_options.soft_pending_compaction_bytes_limit;
+  if (soft_limit > 0) {
+    uint64_t target_bytes =
+        mutable_cf_options.smooth_write_stall_target_pending_compaction_bytes;
+    if (target_bytes == 0 || target_bytes >= soft_limit) {
+      target_bytes = soft_limit / 2;
+    }
+    double projected = static_cast<double>(compaction_needed_bytes) +
+                       std::max(0.0, smooth_stall_.debt_growth_rate) *
+                           kSmoothStallHorizonSec;
+    error = std::max(error, (projected - static_cast<double>(target_bytes)) /
+                                static_cast<double>(soft_limit - target_bytes));
+  }
+
+  // The integral only builds up while past the targets and is bounded, so it
+  // cannot wind up during a long stretch at or below them.
+  if (smooth_stall_.last_micros != 0 && now > smooth_stall_.last_micros) {
+    double dt_sec =
+        static_cast<double>(now - smooth_stall_.last_micros) / 1e6;
+    smooth_stall_.integral = std::min(
+        kSmoothStallIntegralSec,
+        std::max(0.0, smooth_stall_.integral + std::max(-1.0, error) * dt_sec));
+  }
+  smooth_stall_.last_micros = now;
+
+  double output = error + smooth_stall_.integral / kSmoothStallIntegralSec;
+  if (output <= 0) {
+    return nullptr;
+  }
+
+  // The recent flush throughput is what the tree absorbed; if it is not known
+  // yet fall back to delayed_write_rate.
+  const uint64_t max_write_rate = write_controller->max_delayed_write_rate();
+  double base_rate = static_cast<double>(max_write_rate);
+  if (smooth_stall_.flush_rate > 0) {
+    base_rate = std::min(base_rate, smooth_stall_.flush_rate);
+  }
+  double write_rate =
+      base_rate * std::max(kSmoothStallMinRatio, 1 - std::min(output, 1.0));
+  return write_controller->GetDelayToken(
+      std::max(static_cast<uint64_t>(write_rate), uint64_t{1}));
+}
+
 WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
       const MutableCFOptions& mutable_cf_options) {
   auto write_stall_condition = WriteStallCondition::kNormal;
@@ -877,6 +1006,9 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
         vstorage->estimated_compaction_needed_bytes(), mutable_cf_options);
     write_stall_condition = write_stall_condition_and_cause.first;
     auto write_stall_cause = write_stall_condition_and_cause.second;
+    internal_stats_->UpdateWriteStall(
+        write_stall_condition, write_stall_cause, imm()->NumNotFlushed(),
+        vstorage->l0_delay_trigger_count(), compaction_needed_bytes);
 
     bool was_stopped = write_controller->IsStopped();
     bool needed_delay = write_controller->NeedsDelay();
@@ -974,7 +1106,19 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
           write_controller->delayed_write_rate());
     } else {
       assert(write_stall_condition == WriteStallCondition::kNormal);
-      if (vstorage->l0_delay_trigger_count() >=
+      std::unique_ptr<WriteControllerToken> smooth_delay_token =
+          SetupSmoothDelay(write_controller, mutable_cf_options);
+      const bool smoothing = smooth_delay_token != nullptr;
+      if (smoothing) {
+        write_controller_token_ = std::move(smooth_delay_token);
+        ROCKS_LOG_INFO(ioptions_.info_log,
+                       "[%s] Smoothing writes with %d level-0 files and "
+                       "estimated pending compaction bytes %" PRIu64
+                       " rate %" PRIu64,
+                       name_.c_str(), vstorage->l0_delay_trigger_count(),
+                       compaction_needed_bytes,
+                       write_controller->delayed_write_rate());
+      } else if (vstorage->l0_delay_trigger_count() >=
           GetL0ThresholdSpeedupCompaction(
               mutable_cf_options.level0_file_num_compaction_trigger,
               mutable_cf_options.level0_slowdown_writes_trigger)) {
@@ -1006,8 +1150,8 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
       }
       // If the DB recovers from delay conditions, we reward with reducing
       // double the slowdown ratio. This is to balance the long term slowdown
-      // increase signal.
-      if (needed_delay) {
+      // increase signal. The smoothing delay sets its rate itself.
+      if (needed_delay && !smoothing) {
         uint64_t write_rate = write_controller->delayed_write_rate();
         write_controller->set_delayed_write_rate(static_cast<uint64_t>(
             static_cast<double>(write_rate) * kDelayRecoverSlowdownRatio));
@@ -1030,6 +1174,19 @@ const FileOptions* ColumnFamilyData::soptions() const {
 
 void ColumnFamilyData::SetCurrent(Version* current_version) {
   current_ = current_version;
+  PublishFilesSnapshot();
+}
+
+void ColumnFamilyData::PublishFilesSnapshot() {
+  if (current_ == nullptr) {
+    return;
+  }
+  // Only written under the DB mutex, so files_snapshot_ is the latest
+  std::shared_ptr<const VersionFilesSnapshot> snapshot =
+      std::make_shared<const VersionFilesSnapshot>(
+          &internal_comparator_, *current_->storage_info(),
+          files_snapshot_.get());
+  std::atomic_store(&files_snapshot_, snapshot);
 }
 
 uint64_t ColumnFamilyData::GetNumLiveVersions() const {
@@ -1261,6 +1418,12 @@ void ColumnFamilyData::InstallSuperVersion(
   super_version_->version_number = super_version_number_;
   super_version_->write_stall_condition =
       RecalculateWriteStallConditions(mutable_cf_options);
+  std::vector<WriteStallIntervalInfo> ended_write_stalls;
+  internal_stats_->TakeEndedWriteStalls(&ended_write_stalls);
+  for (auto& stall : ended_write_stalls) {
+    sv_context->PushWriteStallIntervalNotification(std::move(stall),
+                                                   ioptions());
+  }
 
   if (old_superversion != nullptr) {
     // Reset SuperVersions cached in thread local storage.
@@ -1340,6 +1503,13 @@ Status ColumnFamilyData::ValidateOptions(
           "Block-Based Table format. ");
     }
   }
+
+  if (cf_options.blob_garbage_collection_age_cutoff < 0.0 ||
+      cf_options.blob_garbage_collection_age_cutoff > 1.0) {
+    return Status::InvalidArgument(
+        "The age cutoff for blob garbage collection should be in the range "
+        "[0.0, 1.0].");
+  }
   return s;
 }
 
@@ -1441,7 +1611,9 @@ ColumnFamilySet::ColumnFamilySet(const std::string& dbname,
       write_buffer_manager_(_write_buffer_manager),
       write_controller_(_write_controller),
       block_cache_tracer_(block_cache_tracer),
-      io_tracer_(io_tracer) {
+      io_tracer_(io_tracer),
+      table_metadata_checkpoint_(nullptr),
+      block_cache_warmup_(nullptr) {
   // initialize linked list
   dummy_cfd_->prev_ = dummy_cfd_;
   dummy_cfd_->next_ = dummy_cfd_;
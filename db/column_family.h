@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -32,6 +33,7 @@ namespace ROCKSDB_NAMESPACE {
 class Version;
 class VersionSet;
 class VersionStorageInfo;
+class VersionFilesSnapshot;
 class MemTable;
 class MemTableListVersion;
 class CompactionPicker;
@@ -45,6 +47,8 @@ class InstrumentedMutex;
 class InstrumentedMutexLock;
 struct SuperVersionContext;
 class BlobFileCache;
+class BlockCacheWarmup;
+class TableMetadataCheckpoint;
 
 extern const double kIncSlowdownRatio;
 // This file contains a list of data structures for managing column family
@@ -362,7 +366,16 @@ class ColumnFamilyData {
   MemTable* mem() { return mem_; }
   Version* current() { return current_; }
   Version* dummy_versions() { return dummy_versions_; }
+  // Also publishes the files snapshot of _current
   void SetCurrent(Version* _current);
+  // The table files of the current Version, for the readers that cannot take
+  // the DB mutex. nullptr until the first Version is installed.
+  std::shared_ptr<const VersionFilesSnapshot> GetFilesSnapshot() const {
+    return std::atomic_load(&files_snapshot_);
+  }
+  // Publishes a new files snapshot of current(), for when files start or
+  // stop being compacted. REQUIRES: DB mutex held
+  void PublishFilesSnapshot();
   uint64_t GetNumLiveVersions() const;  // REQUIRE: DB mutex held
   uint64_t GetTotalSstFilesSize() const;  // REQUIRE: DB mutex held
   uint64_t GetLiveSstFilesSize() const;   // REQUIRE: DB mutex held
@@ -472,12 +485,6 @@ class ColumnFamilyData {
   bool queued_for_flush() { return queued_for_flush_; }
   bool queued_for_compaction() { return queued_for_compaction_; }
 
-  enum class WriteStallCause {
-    kNone,
-    kMemtableLimit,
-    kL0FileCountLimit,
-    kPendingCompactionBytes,
-  };
   static std::pair<WriteStallCondition, WriteStallCause>
   GetWriteStallConditionAndCause(int num_unflushed_memtables, int num_l0_files,
                                  uint64_t num_compaction_needed_bytes,
@@ -525,10 +532,18 @@ class ColumnFamilyData {
 
   std::vector<std::string> GetDbPaths() const;
 
+  // Returns the delay token of smooth_write_stall, or nullptr if writes need
+  // no smoothing delay.
+  std::unique_ptr<WriteControllerToken> SetupSmoothDelay(
+      WriteController* write_controller,
+      const MutableCFOptions& mutable_cf_options);
+
   uint32_t id_;
   const std::string name_;
   Version* dummy_versions_;  // Head of circular doubly-linked list of versions.
   Version* current_;         // == dummy_versions->prev_
+  // Set with std::atomic_store, read with std::atomic_load
+  std::shared_ptr<const VersionFilesSnapshot> files_snapshot_;
 
   std::atomic<int> refs_;      // outstanding references to ColumnFamilyData
   std::atomic<bool> initialized_;
@@ -594,6 +609,20 @@ class ColumnFamilyData {
 
   uint64_t prev_compaction_needed_bytes_;
 
+  // State of the smooth_write_stall controller. Rates are in bytes per second
+  // and averaged over windows of at least kSmoothStallWindowMicros.
+  struct SmoothStallState {
+    uint64_t last_micros = 0;
+    // Integral of the controller error over seconds
+    double integral = 0;
+    uint64_t window_start_micros = 0;
+    uint64_t window_bytes_flushed = 0;
+    uint64_t window_compaction_needed_bytes = 0;
+    double flush_rate = 0;
+    double debt_growth_rate = 0;
+  };
+  SmoothStallState smooth_stall_;
+
   // if the database was opened with 2pc enabled
   bool allow_2pc_;
 
@@ -689,6 +718,22 @@ class ColumnFamilySet {
 
   WriteController* write_controller() { return write_controller_; }
 
+  // The metadata saved at the last DB close, for the table caches of the
+  // column families created from now on to open their tables from
+  void set_table_metadata_checkpoint(TableMetadataCheckpoint* checkpoint) {
+    table_metadata_checkpoint_ = checkpoint;
+  }
+  TableMetadataCheckpoint* table_metadata_checkpoint() const {
+    return table_metadata_checkpoint_;
+  }
+
+  // Where the table caches of the column families created from now on
+  // record the data blocks read through the block cache
+  void set_block_cache_warmup(BlockCacheWarmup* block_cache_warmup) {
+    block_cache_warmup_ = block_cache_warmup;
+  }
+  BlockCacheWarmup* block_cache_warmup() const { return block_cache_warmup_; }
+
  private:
   friend class ColumnFamilyData;
   // helper function that gets called from cfd destructor
@@ -721,6 +766,8 @@ class ColumnFamilySet {
   WriteController* write_controller_;
   BlockCacheTracer* const block_cache_tracer_;
   std::shared_ptr<IOTracer> io_tracer_;
+  TableMetadataCheckpoint* table_metadata_checkpoint_;
+  BlockCacheWarmup* block_cache_warmup_;
 };
 
 // We use ColumnFamilyMemTablesImpl to provide WriteBatch a way to access
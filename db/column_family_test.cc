@@ -2251,6 +2251,32 @@ TEST_P(ColumnFamilyTest, CreateMissingColumnFamilies) {
   Close();
 }
 
+TEST_P(ColumnFamilyTest, CreateManyMissingColumnFamilies) {
+  std::vector<std::string> cfs = {"default"};
+  for (int i = 0; i < 100; i++) {
+    cfs.push_back("tenant" + ToString(i));
+  }
+  // One OPTIONS file for all the column families created by the open
+  int options_file_writes = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::WriteOptionsFile:1",
+      [&](void* /*arg*/) { options_file_writes++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+  db_options_.create_missing_column_families = true;
+  Open(cfs);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(1, options_file_writes);
+  ASSERT_EQ(cfs.size(), handles_.size());
+  ASSERT_OK(Put(100, "key", "value"));
+  Close();
+
+  db_options_.create_missing_column_families = false;
+  Open(cfs);
+  ASSERT_EQ("value", Get(100, "key"));
+  Close();
+}
+
 TEST_P(ColumnFamilyTest, SanitizeOptions) {
   DBOptions db_options;
   for (int s = kCompactionStyleLevel; s <= kCompactionStyleUniversal; ++s) {
@@ -2809,6 +2835,63 @@ TEST_P(ColumnFamilyTest, CompactionSpeedupSingleColumnFamily) {
   ASSERT_EQ(1, dbfull()->TEST_BGCompactionsAllowed());
 }
 
+TEST_P(ColumnFamilyTest, SmoothWriteStall) {
+  const uint64_t kBaseRate = 800000u;
+  db_options_.delayed_write_rate = kBaseRate;
+
+  Open({"default"});
+  ColumnFamilyData* cfd =
+      static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())->cfd();
+
+  VersionStorageInfo* vstorage = cfd->current()->storage_info();
+
+  MutableCFOptions mutable_cf_options(column_family_options_);
+
+  mutable_cf_options.level0_slowdown_writes_trigger = 20;
+  mutable_cf_options.level0_stop_writes_trigger = 10000;
+  mutable_cf_options.soft_pending_compaction_bytes_limit = 200;
+  mutable_cf_options.hard_pending_compaction_bytes_limit = 2000;
+  mutable_cf_options.disable_auto_compactions = false;
+  mutable_cf_options.smooth_write_stall = true;
+  mutable_cf_options.smooth_write_stall_target_pending_compaction_bytes = 100;
+
+  vstorage->TEST_set_estimated_compaction_needed_bytes(50);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+
+  // Halfway from the target to the soft limit
+  vstorage->TEST_set_estimated_compaction_needed_bytes(150);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+  uint64_t smoothed_rate = GetDbDelayedWriteRate();
+  ASSERT_LE(smoothed_rate, kBaseRate / 2);
+  ASSERT_GT(smoothed_rate, kBaseRate / 4);
+
+  vstorage->TEST_set_estimated_compaction_needed_bytes(190);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_LT(GetDbDelayedWriteRate(), smoothed_rate);
+  smoothed_rate = GetDbDelayedWriteRate();
+
+  // The slowdown trigger starts from the smoothed rate
+  vstorage->TEST_set_estimated_compaction_needed_bytes(201);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_LT(GetDbDelayedWriteRate(), smoothed_rate);
+
+  vstorage->TEST_set_estimated_compaction_needed_bytes(50);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+
+  mutable_cf_options.smooth_write_stall = false;
+  vstorage->TEST_set_estimated_compaction_needed_bytes(150);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+}
+
 TEST_P(ColumnFamilyTest, WriteStallTwoColumnFamilies) {
   const uint64_t kBaseRate = 810000u;
   db_options_.delayed_write_rate = kBaseRate;
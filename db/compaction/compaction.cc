@@ -9,6 +9,7 @@
 
 #include "db/compaction/compaction.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <vector>
 
@@ -72,6 +73,7 @@ void Compaction::SetInputVersion(Version* _input_version) {
   cfd_->Ref();
   input_version_->Ref();
   edit_.SetColumnFamily(cfd_->GetID());
+  cfd_->PublishFilesSnapshot();
 }
 
 void Compaction::GetBoundaryKeys(
@@ -273,6 +275,30 @@ Compaction::Compaction(VersionStorageInfo* vstorage,
   GetBoundaryKeys(vstorage, inputs_, &smallest_user_key_, &largest_user_key_);
 }
 
+void Compaction::SkipInputFiles(const std::vector<const FileMetaData*>& files) {
+  if (files.empty()) {
+    return;
+  }
+  read_levels_.resize(num_input_levels());
+  read_boundaries_.resize(num_input_levels());
+  for (size_t which = 0; which < num_input_levels(); which++) {
+    const CompactionInputFiles& level_inputs = inputs_[which];
+    std::vector<FileMetaData*> to_read;
+    for (size_t i = 0; i < level_inputs.size(); i++) {
+      FileMetaData* f = level_inputs[i];
+      if (std::find(files.begin(), files.end(), f) != files.end()) {
+        continue;
+      }
+      to_read.push_back(f);
+      if (!level_inputs.atomic_compaction_unit_boundaries.empty()) {
+        read_boundaries_[which].push_back(
+            level_inputs.atomic_compaction_unit_boundaries[i]);
+      }
+    }
+    DoGenerateLevelFilesBrief(&read_levels_[which], to_read, &arena_);
+  }
+}
+
 Compaction::~Compaction() {
   if (input_version_ != nullptr) {
     input_version_->Unref();
@@ -295,27 +321,6 @@ bool Compaction::InputCompressionMatchesOutput() const {
   return matches;
 }
 
-void Compaction::PreCalculateMinMaxKey(Slice& s_key, Slice& l_key, const InternalKeyComparator* icmp) {
-
-  InternalKey s, l;
-  for (const CompactionInputFiles& f : inputs_) {
-   for (const FileMetaData* fm : f.files) {
-    if (s.rep()->empty() && l.rep()->empty()) {
-      s = fm->smallest;
-      l = fm->largest;
-    } else {
-      if (icmp->Compare(fm->smallest, s) < 0)
-        s = fm->smallest;
-      if (icmp->Compare(l, fm->largest) < 0)
-        l = fm->largest;
-    }
-   }
-  }
-  assert(!(s.rep()->empty()) && !(l.rep()->empty()));
-  s_key = s.user_key(); 
-  l_key = l.user_key();
-}
-
 bool Compaction::IsTrivialMove() const {
   // Avoid a move if there is lots of overlapping grandparent data.
   // Otherwise, the move could create a parent file that will require
@@ -337,6 +342,12 @@ bool Compaction::IsTrivialMove() const {
     return false;
   }
 
+  // A move would leave the files on the storage tier of the start level
+  if (immutable_cf_options_.fs->GetStorageTier(start_level_) !=
+      immutable_cf_options_.fs->GetStorageTier(output_level_)) {
+    return false;
+  }
+
   // Used in universal compaction, where trivial move can be done if the
   // input files are non overlapping
   if ((mutable_cf_options_.compaction_options_universal.allow_trivial_move) &&
@@ -477,6 +488,7 @@ uint64_t Compaction::CalculateTotalInputSize() const {
 void Compaction::ReleaseCompactionFiles(Status status) {
   MarkFilesBeingCompacted(false);
   cfd_->compaction_picker()->ReleaseCompactionFiles(this, status);
+  cfd_->PublishFilesSnapshot();
 }
 
 void Compaction::ResetNextCompactionIndex() {
@@ -588,8 +600,7 @@ bool Compaction::ShouldFormSubcompactions() const {
     return false;
   }
   if (cfd_->ioptions()->compaction_style == kCompactionStyleLevel) {
-    return (start_level_ == 0 || is_manual_compaction_) && output_level_ > 0 &&
-           !IsOutputLevelEmpty();
+    return (start_level_ == 0 || is_manual_compaction_) && output_level_ > 0;
   } else if (cfd_->ioptions()->compaction_style == kCompactionStyleUniversal) {
     return number_levels_ > 1 && output_level_ > 0;
   } else {
@@ -88,7 +88,6 @@ class Compaction {
 
   ~Compaction();
 
-  void PreCalculateMinMaxKey(Slice&, Slice&, const InternalKeyComparator* );
   // Returns the level associated to the specified compaction input level.
   // If compaction_input_level is not specified, then input_level is set to 0.
   int level(size_t compaction_input_level = 0) const {
@@ -156,6 +155,24 @@ class Compaction {
     return &input_levels_[compaction_input_level];
   }
 
+  // Makes the input iterators skip `files`, whose keys are all deleted by
+  // range tombstones of the compaction. They are still deleted with the
+  // other input files.
+  // REQUIRES: called before the input iterators are made
+  void SkipInputFiles(const std::vector<const FileMetaData*>& files);
+
+  // input_levels() and boundaries() less the files skipped, to read
+  const LevelFilesBrief* input_levels_to_read(
+      size_t compaction_input_level) const {
+    return read_levels_.empty() ? input_levels(compaction_input_level)
+                                : &read_levels_[compaction_input_level];
+  }
+  const std::vector<AtomicCompactionUnitBoundary>* boundaries_to_read(
+      size_t compaction_input_level) const {
+    return read_boundaries_.empty() ? boundaries(compaction_input_level)
+                                    : &read_boundaries_[compaction_input_level];
+  }
+
   // Maximum size of files to build during this compaction.
   uint64_t max_output_file_size() const { return max_output_file_size_; }
 
@@ -352,6 +369,10 @@ class Compaction {
   // A copy of inputs_, organized more closely in memory
   autovector<LevelFilesBrief, 2> input_levels_;
 
+  // input_levels_ and the boundaries less the skipped files, when some are
+  autovector<LevelFilesBrief, 2> read_levels_;
+  std::vector<std::vector<AtomicCompactionUnitBoundary>> read_boundaries_;
+
   // State used to check for number of overlapping grandparent files
   // (grandparent == "output_level_ + 1")
   std::vector<FileMetaData*> grandparents_;
@@ -6,8 +6,11 @@
 #include "db/compaction/compaction_iterator.h"
 
 #include <cinttypes>
+#include <iterator>
+#include <limits>
 
 #include "db/blob/blob_file_builder.h"
+#include "db/blob/blob_index.h"
 #include "db/snapshot_checker.h"
 #include "port/likely.h"
 #include "rocksdb/listener.h"
@@ -32,6 +35,160 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+// Reads the input ahead, copying up to batch_size entries at a time, and
+// passes the key-values of the entries CompactionIterator would call
+// FilterV2() on to a single FilterBatch() call. Those are the first entry of
+// each user key, when it is a value or a blob index, since without a
+// snapshot checker all entries are committed. CompactionIterator then takes
+// the decision of the current entry with FilterEntry(). The entries of the
+// previous batch are kept, since the value of the previous entry may still
+// be in use after Next().
+class CompactionFilterBatchIterator : public InternalIterator {
+ public:
+  CompactionFilterBatchIterator(InternalIterator* input, const Comparator* cmp,
+                                const CompactionFilter* filter, int level,
+                                size_t batch_size, Env* env,
+                                bool report_detailed_time,
+                                uint64_t* filter_time)
+      : input_(input),
+        cmp_(cmp),
+        filter_(filter),
+        level_(level),
+        batch_size_(batch_size),
+        env_(env),
+        report_detailed_time_(report_detailed_time),
+        filter_time_(filter_time) {
+    FillBatch();
+  }
+
+  bool Valid() const override { return pos_ < entries_.size(); }
+
+  void SeekToFirst() override {
+    input_->SeekToFirst();
+    has_last_user_key_ = false;
+    FillBatch();
+  }
+
+  void Seek(const Slice& target) override {
+    input_->Seek(target);
+    has_last_user_key_ = false;
+    FillBatch();
+  }
+
+  void Next() override {
+    assert(Valid());
+    if (++pos_ == entries_.size()) {
+      FillBatch();
+    }
+  }
+
+  // Compactions only iterate forward
+  void SeekToLast() override { assert(false); }
+  void SeekForPrev(const Slice& /*target*/) override { assert(false); }
+  void Prev() override { assert(false); }
+
+  Slice key() const override {
+    assert(Valid());
+    return entries_[pos_].key;
+  }
+
+  Slice value() const override {
+    assert(Valid());
+    return entries_[pos_].value;
+  }
+
+  Status status() const override { return input_->status(); }
+
+  void SetPinnedItersMgr(PinnedIteratorsManager* pinned_iters_mgr) override {
+    input_->SetPinnedItersMgr(pinned_iters_mgr);
+  }
+
+  // The filter call of the current entry, or nullptr if it had none
+  CompactionFilter::BatchEntry* FilterEntry() {
+    assert(Valid());
+    size_t i = entries_[pos_].filter_index;
+    return i < batch_.size() ? &batch_[i] : nullptr;
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string value;
+    // Index in batch_, or port::kMaxSizet without a filter call
+    size_t filter_index;
+  };
+
+  void FillBatch() {
+    prev_entries_.swap(entries_);
+    entries_.clear();
+    // Never reallocated while filling, as last_user_key_ points into it
+    entries_.reserve(batch_size_);
+    batch_.clear();
+    pos_ = 0;
+    size_t num_filtered = 0;
+    for (; entries_.size() < batch_size_ && input_->Valid(); input_->Next()) {
+      entries_.push_back(Entry{input_->key().ToString(),
+                               input_->value().ToString(), port::kMaxSizet});
+      Entry& entry = entries_.back();
+      ParsedInternalKey ikey;
+      if (!ParseInternalKey(entry.key, &ikey).ok()) {
+        // CompactionIterator compares the next key to none either
+        has_last_user_key_ = false;
+        continue;
+      }
+      bool first =
+          !has_last_user_key_ || !cmp_->Equal(ikey.user_key, last_user_key_);
+      has_last_user_key_ = true;
+      last_user_key_ = ikey.user_key;
+      if (first && (ikey.type == kTypeValue || ikey.type == kTypeBlobIndex)) {
+        entry.filter_index = num_filtered++;
+      }
+    }
+    if (num_filtered == 0) {
+      return;
+    }
+
+    batch_.resize(num_filtered);
+    for (const Entry& entry : entries_) {
+      if (entry.filter_index == port::kMaxSizet) {
+        continue;
+      }
+      CompactionFilter::BatchEntry& filter_entry = batch_[entry.filter_index];
+      // As in CompactionIterator::InvokeFilterIfNeeded(), blob indexes are
+      // passed with their internal key
+      if (ExtractValueType(entry.key) == kTypeValue) {
+        filter_entry.key = ExtractUserKey(entry.key);
+        filter_entry.value_type = CompactionFilter::ValueType::kValue;
+      } else {
+        filter_entry.key = entry.key;
+        filter_entry.value_type = CompactionFilter::ValueType::kBlobIndex;
+      }
+      filter_entry.existing_value = entry.value;
+    }
+    StopWatchNano timer(env_, report_detailed_time_);
+    filter_->FilterBatch(level_, batch_.data(), batch_.size());
+    *filter_time_ +=
+        env_ != nullptr && report_detailed_time_ ? timer.ElapsedNanos() : 0;
+  }
+
+  InternalIterator* const input_;
+  const Comparator* const cmp_;
+  const CompactionFilter* const filter_;
+  const int level_;
+  const size_t batch_size_;
+  Env* const env_;
+  const bool report_detailed_time_;
+  uint64_t* const filter_time_;
+
+  std::vector<Entry> entries_;
+  std::vector<Entry> prev_entries_;
+  size_t pos_ = 0;
+  std::vector<CompactionFilter::BatchEntry> batch_;
+  // Points into entries_ or prev_entries_
+  Slice last_user_key_;
+  bool has_last_user_key_ = false;
+};
+
 CompactionIterator::CompactionIterator(
     InternalIterator* input, const Comparator* cmp, MergeHelper* merge_helper,
     SequenceNumber last_sequence, std::vector<SequenceNumber>* snapshots,
@@ -90,12 +247,18 @@ CompactionIterator::CompactionIterator(
       current_user_key_sequence_(0),
       current_user_key_snapshot_(0),
       merge_out_iter_(merge_helper_),
+      blob_garbage_collection_cutoff_file_number_(
+          ComputeBlobGarbageCollectionCutoffFileNumber(compaction_.get())),
       current_key_committed_(false),
       info_log_(info_log),
       allow_data_in_errors_(allow_data_in_errors),
       timestamp_size_(cmp_ ? cmp_->timestamp_size() : 0),
       full_history_ts_low_(full_history_ts_low),
-      cmp_with_history_ts_low_(0) {
+      cmp_with_history_ts_low_(0),
+      use_fast_path_(snapshots->empty() && snapshot_checker == nullptr &&
+                     compaction_filter == nullptr && timestamp_size_ == 0),
+      bytewise_equal_(cmp_ != nullptr &&
+                      !cmp_->CanKeysWithDifferentByteContentsBeEqual()) {
   assert(compaction_filter_ == nullptr || compaction_ != nullptr);
   assert(snapshots_ != nullptr);
   bottommost_level_ = compaction_ == nullptr
@@ -105,6 +268,15 @@ CompactionIterator::CompactionIterator(
   if (compaction_ != nullptr) {
     level_ptrs_ = std::vector<size_t>(compaction_->number_levels(), 0);
   }
+  // Without a snapshot checker, the entries the filter gets are known ahead
+  if (compaction_filter_ != nullptr && snapshot_checker_ == nullptr &&
+      compaction_filter_->FilterBatchSize() > 0) {
+    filter_batch_input_.reset(new CompactionFilterBatchIterator(
+        input_, cmp_, compaction_filter_, compaction_->level(),
+        compaction_filter_->FilterBatchSize(), env_, report_detailed_time_,
+        &iter_stats_.total_filter_time));
+    input_ = filter_batch_input_.get();
+  }
   if (snapshots_->size() == 0) {
     // optimize for fast path if there are no snapshots
     visible_at_tip_ = true;
@@ -214,7 +386,14 @@ bool CompactionIterator::InvokeFilterIfNeeded(bool* need_skip,
     // Hack: pass internal key to BlobIndexCompactionFilter since it needs
     // to get sequence number.
     Slice& filter_key = ikey_.type == kTypeValue ? ikey_.user_key : key_;
-    {
+    CompactionFilter::BatchEntry* batched =
+        filter_batch_input_ != nullptr ? filter_batch_input_->FilterEntry()
+                                       : nullptr;
+    if (batched != nullptr) {
+      filter = batched->decision;
+      compaction_filter_value_.swap(batched->new_value);
+      compaction_filter_skip_until_.rep()->swap(batched->skip_until);
+    } else {
       StopWatchNano timer(env_, report_detailed_time_);
       filter = compaction_filter_->FilterV2(
           compaction_->level(), filter_key, value_type, value_,
@@ -273,6 +452,9 @@ void CompactionIterator::NextFromInput() {
 
   while (!valid_ && input_->Valid() && !IsPausingManualCompaction() &&
          !IsShuttingDown()) {
+    if (use_fast_path_ && !clear_and_output_next_key_ && NextFromInputFast()) {
+      continue;
+    }
     key_ = input_->key();
     value_ = input_->value();
     iter_stats_.num_input_records++;
@@ -350,7 +532,7 @@ void CompactionIterator::NextFromInput() {
         current_user_key_snapshot_ = 0;
         has_current_user_key_ = true;
       }
-      current_user_key_ = ikey_.user_key;
+      SetCurrentUserKey(ikey_.user_key);
 
       has_outputted_key_ = false;
 
@@ -722,25 +904,171 @@ void CompactionIterator::NextFromInput() {
   }
 }
 
+bool CompactionIterator::NextFromInputFast() {
+  assert(use_fast_path_);
+  while (input_->Valid() && !IsPausingManualCompaction() &&
+         !IsShuttingDown()) {
+    const Slice key = input_->key();
+    if (key.size() < kNumInternalBytes) {
+      return false;
+    }
+    const uint64_t packed =
+        DecodeFixed64(key.data() + key.size() - kNumInternalBytes);
+    const ValueType type = static_cast<ValueType>(packed & 0xff);
+    if (type != kTypeValue && type != kTypeBlobIndex) {
+      return false;
+    }
+    const Slice user_key(key.data(), key.size() - kNumInternalBytes);
+    iter_stats_.num_input_records++;
+    iter_stats_.total_input_raw_key_bytes += key.size();
+    iter_stats_.total_input_raw_value_bytes += input_->value().size();
+
+    if (has_current_user_key_ && EqualsCurrentUserKey(user_key)) {
+      // Hidden by a newer entry for same user key, see rule (A) in
+      // NextFromInput()
+      ++iter_stats_.num_record_drop_hidden;
+      input_->Next();
+      continue;
+    }
+
+    // First occurrence of this user key
+    ikey_.sequence = packed >> 8;
+    ikey_.type = type;
+    key_ = current_key_.SetInternalKey(key, &ikey_);
+    SetCurrentUserKey(ikey_.user_key);
+    has_current_user_key_ = true;
+    has_outputted_key_ = false;
+    current_key_committed_ = true;
+    current_user_key_sequence_ = ikey_.sequence;
+    current_user_key_snapshot_ = earliest_snapshot_;
+
+    if (range_del_agg_->ShouldDelete(
+            key_, RangeDelPositioningMode::kForwardTraversal)) {
+      ++iter_stats_.num_record_drop_hidden;
+      ++iter_stats_.num_record_drop_range_del;
+      input_->Next();
+      continue;
+    }
+    value_ = input_->value();
+    valid_ = true;
+    return true;
+  }
+  return true;
+}
+
+bool CompactionIterator::ExtractLargeValueIfNeeded() {
+  assert(ikey_.type == kTypeValue);
+
+  if (!blob_file_builder_) {
+    return false;
+  }
+
+  blob_index_.clear();
+  const Status s = blob_file_builder_->Add(user_key(), value_, &blob_index_);
+
+  if (!s.ok()) {
+    status_ = s;
+    valid_ = false;
+    return false;
+  }
+
+  if (blob_index_.empty()) {
+    return false;
+  }
+
+  value_ = blob_index_;
+  ikey_.type = kTypeBlobIndex;
+  current_key_.UpdateInternalKey(ikey_.sequence, ikey_.type);
+
+  return true;
+}
+
+void CompactionIterator::GarbageCollectBlobIfNeeded() {
+  assert(ikey_.type == kTypeBlobIndex);
+
+  if (!compaction_ || !compaction_->enable_blob_garbage_collection()) {
+    return;
+  }
+
+  BlobIndex blob_index;
+
+  {
+    const Status s = blob_index.DecodeFrom(value_);
+    if (!s.ok()) {
+      status_ = s;
+      valid_ = false;
+      return;
+    }
+  }
+
+  // Blobs written by the legacy stacked BlobDB are left alone
+  if (blob_index.IsInlined() || blob_index.HasTTL()) {
+    return;
+  }
+
+  if (blob_index.file_number() >=
+      blob_garbage_collection_cutoff_file_number_) {
+    return;
+  }
+
+  const Version* const version = compaction_->input_version();
+  assert(version);
+
+  blob_value_.Reset();
+  blob_value_.PinSelf(value_);
+
+  {
+    const Status s = version->GetBlob(ReadOptions(), user_key(), &blob_value_);
+    if (!s.ok()) {
+      status_ = s;
+      valid_ = false;
+      return;
+    }
+  }
+
+  ++iter_stats_.num_blobs_relocated;
+  iter_stats_.total_blob_bytes_relocated += blob_index.size();
+
+  // The blob is written to a new blob file if it is still large enough,
+  // otherwise it is stored inline in the SST file
+  value_ = blob_value_;
+  ikey_.type = kTypeValue;
+  current_key_.UpdateInternalKey(ikey_.sequence, ikey_.type);
+
+  ExtractLargeValueIfNeeded();
+}
+
+uint64_t CompactionIterator::ComputeBlobGarbageCollectionCutoffFileNumber(
+    const CompactionProxy* compaction) {
+  if (!compaction || !compaction->enable_blob_garbage_collection()) {
+    return 0;
+  }
+
+  Version* const version = compaction->input_version();
+  assert(version);
+
+  const VersionStorageInfo* const storage_info = version->storage_info();
+  assert(storage_info);
+
+  const auto& blob_files = storage_info->GetBlobFiles();
+
+  auto it = blob_files.begin();
+  std::advance(it, static_cast<size_t>(
+                       compaction->blob_garbage_collection_age_cutoff() *
+                       blob_files.size()));
+
+  return it != blob_files.end() ? it->first
+                                : std::numeric_limits<uint64_t>::max();
+}
+
 void CompactionIterator::PrepareOutput() {
   if (valid_) {
     if (ikey_.type == kTypeValue) {
-      if (blob_file_builder_) {
-        blob_index_.clear();
-        const Status s =
-            blob_file_builder_->Add(user_key(), value_, &blob_index_);
-
-        if (!s.ok()) {
-          status_ = s;
-          valid_ = false;
-        } else if (!blob_index_.empty()) {
-          value_ = blob_index_;
-          ikey_.type = kTypeBlobIndex;
-          current_key_.UpdateInternalKey(ikey_.sequence, ikey_.type);
-        }
-      }
+      ExtractLargeValueIfNeeded();
     } else if (ikey_.type == kTypeBlobIndex) {
-      if (compaction_filter_) {
+      if (!compaction_filter_) {
+        GarbageCollectBlobIfNeeded();
+      } else {
         const auto blob_decision = compaction_filter_->PrepareBlobOutput(
             user_key(), value_, &compaction_filter_value_);
 
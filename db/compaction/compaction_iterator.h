@@ -22,6 +22,7 @@
 namespace ROCKSDB_NAMESPACE {
 
 class BlobFileBuilder;
+class CompactionFilterBatchIterator;
 
 class CompactionIterator {
  public:
@@ -53,6 +54,16 @@ class CompactionIterator {
     virtual bool preserve_deletes() const {
       return compaction_->immutable_cf_options()->preserve_deletes;
     }
+    virtual bool enable_blob_garbage_collection() const {
+      return compaction_->mutable_cf_options()->enable_blob_garbage_collection;
+    }
+    virtual double blob_garbage_collection_age_cutoff() const {
+      return compaction_->mutable_cf_options()
+          ->blob_garbage_collection_age_cutoff;
+    }
+    virtual Version* input_version() const {
+      return compaction_->input_version();
+    }
 
    protected:
     CompactionProxy() = default;
@@ -123,11 +134,55 @@ class CompactionIterator {
   // Processes the input stream to find the next output
   void NextFromInput();
 
+  // Processes puts and blob indexes of the input stream when use_fast_path_,
+  // dropping all but the newest version of each user key. Returns false,
+  // leaving the input at the entry, when an entry needs NextFromInput()'s
+  // general handling; otherwise returns true once an output is found or the
+  // input is exhausted.
+  bool NextFromInputFast();
+
+  // Returns whether user_key equals current_user_key_, which must be set.
+  inline bool EqualsCurrentUserKey(const Slice& user_key) const {
+    if (!bytewise_equal_) {
+      return cmp_->Equal(user_key, current_user_key_);
+    }
+    return user_key.size() == current_user_key_.size() &&
+           KeyPrefix(user_key) == current_user_key_prefix_ &&
+           memcmp(user_key.data(), current_user_key_.data(),
+                  user_key.size()) == 0;
+  }
+
+  // Sets current_user_key_ and caches its first bytes
+  inline void SetCurrentUserKey(const Slice& user_key) {
+    current_user_key_ = user_key;
+    current_user_key_prefix_ = KeyPrefix(user_key);
+  }
+
+  static inline uint64_t KeyPrefix(const Slice& key) {
+    uint64_t prefix = 0;
+    memcpy(&prefix, key.data(), std::min<size_t>(key.size(), sizeof(prefix)));
+    return prefix;
+  }
+
   // Do last preparations before presenting the output to the callee. At this
   // point this only zeroes out the sequence number if possible for better
   // compression.
   void PrepareOutput();
 
+  // Writes the value of a kTypeValue record to a blob file if it is large
+  // enough and replaces it with the blob reference. Returns true if the value
+  // was extracted.
+  bool ExtractLargeValueIfNeeded();
+
+  // Relocates the blob referenced by a kTypeBlobIndex record if it lives in
+  // one of the oldest blob files, see blob_garbage_collection_age_cutoff.
+  void GarbageCollectBlobIfNeeded();
+
+  // Blob files with a number lower than the returned one are subject to
+  // garbage collection in this compaction.
+  static uint64_t ComputeBlobGarbageCollectionCutoffFileNumber(
+      const CompactionProxy* compaction);
+
   // Invoke compaction filter if needed.
   // Return true on success, false on failures (e.g.: kIOError).
   bool InvokeFilterIfNeeded(bool* need_skip, Slice* skip_until);
@@ -219,6 +274,8 @@ class CompactionIterator {
 
   IterKey current_key_;
   Slice current_user_key_;
+  // The first bytes of current_user_key_, see EqualsCurrentUserKey()
+  uint64_t current_user_key_prefix_ = 0;
   Slice current_ts_;
   SequenceNumber current_user_key_sequence_;
   SequenceNumber current_user_key_snapshot_;
@@ -235,6 +292,8 @@ class CompactionIterator {
   // merge operands and then releasing them after consuming them.
   PinnedIteratorsManager pinned_iters_mgr_;
   std::string blob_index_;
+  PinnableSlice blob_value_;
+  uint64_t blob_garbage_collection_cutoff_file_number_;
   std::string compaction_filter_value_;
   InternalKey compaction_filter_skip_until_;
   // "level_ptrs" holds indices that remember which file of an associated
@@ -266,6 +325,16 @@ class CompactionIterator {
   // Saved result of ucmp->CompareTimestamp(current_ts_, *full_history_ts_low_)
   int cmp_with_history_ts_low_;
 
+  // Without snapshots, snapshot checker, compaction filter and timestamps,
+  // the newest put of a user key hides all older versions, which
+  // NextFromInputFast() drops with few checks
+  bool use_fast_path_;
+  // Whether user keys are equal only if their bytes are
+  bool bytewise_equal_;
+  // Wraps the input, which input_ then points to, when the compaction filter
+  // takes batches. See CompactionFilter::FilterBatchSize().
+  std::unique_ptr<CompactionFilterBatchIterator> filter_batch_input_;
+
   bool IsShuttingDown() {
     // This is a best-effort facility, so memory_order_relaxed is sufficient.
     return shutting_down_ && shutting_down_->load(std::memory_order_relaxed);
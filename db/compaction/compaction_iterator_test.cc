@@ -173,6 +173,12 @@ class FakeCompaction : public CompactionIterator::CompactionProxy {
 
   bool preserve_deletes() const override { return false; }
 
+  bool enable_blob_garbage_collection() const override { return false; }
+
+  double blob_garbage_collection_age_cutoff() const override { return 0.0; }
+
+  Version* input_version() const override { return nullptr; }
+
   bool key_not_exists_beyond_output_level = false;
 
   bool is_bottommost_level = false;
@@ -517,6 +523,68 @@ TEST_P(CompactionIteratorTest, CompactionFilterSkipUntil) {
   ASSERT_EQ(expected_actions, iter_->log);
 }
 
+TEST_P(CompactionIteratorTest, CompactionFilterBatch) {
+  class Filter : public CompactionFilter {
+   public:
+    size_t FilterBatchSize() const override { return 3; }
+
+    void FilterBatch(int level, BatchEntry* entries,
+                     size_t n) const override {
+      batch_sizes.push_back(n);
+      CompactionFilter::FilterBatch(level, entries, n);
+    }
+
+    Decision FilterV2(int /*level*/, const Slice& key, ValueType t,
+                      const Slice& /*existing_value*/, std::string* new_value,
+                      std::string* /*skip_until*/) const override {
+      std::string k = key.ToString();
+      keys.push_back(k);
+      EXPECT_EQ(k == "g" ? ValueType::kMergeOperand : ValueType::kValue, t);
+      if (k == "b") {
+        return Decision::kRemove;
+      }
+      if (k == "c") {
+        *new_value = "changed";
+        return Decision::kChangeValue;
+      }
+      return Decision::kKeep;
+    }
+
+    const char* Name() const override {
+      return "CompactionIteratorTest.CompactionFilterBatch::Filter";
+    }
+
+    mutable std::vector<size_t> batch_sizes;
+    mutable std::vector<std::string> keys;
+  };
+
+  NoMergingMergeOp merge_op;
+  Filter filter;
+  RunTest(
+      {test::KeyStr("a", 50, kTypeValue), test::KeyStr("a", 40, kTypeValue),
+       test::KeyStr("b", 60, kTypeValue), test::KeyStr("c", 55, kTypeValue),
+       test::KeyStr("d", 70, kTypeDeletion), test::KeyStr("d", 30, kTypeValue),
+       test::KeyStr("e", 80, kTypeValue), test::KeyStr("f", 20, kTypeValue),
+       test::KeyStr("g", 90, kTypeMerge)},
+      {"av50", "av40", "bv60", "cv55", "", "dv30", "ev80", "fv20", "gm90"},
+      {test::KeyStr("a", 50, kTypeValue), test::KeyStr("b", 60, kTypeDeletion),
+       test::KeyStr("c", 55, kTypeValue), test::KeyStr("d", 70, kTypeDeletion),
+       test::KeyStr("e", 80, kTypeValue), test::KeyStr("f", 20, kTypeValue),
+       test::KeyStr("g", 90, kTypeMerge)},
+      {"av50", "", "changed", "", "ev80", "fv20", "gm90"}, kMaxSequenceNumber,
+      &merge_op, &filter);
+
+  // Merge operands still go through FilterV2() one by one
+  ASSERT_EQ(std::vector<std::string>({"a", "b", "c", "e", "f", "g"}),
+            filter.keys);
+  if (GetParam()) {
+    // The entries to filter are not known ahead with a snapshot checker
+    ASSERT_TRUE(filter.batch_sizes.empty());
+  } else {
+    ASSERT_EQ(std::vector<size_t>({2, 1, 2}), filter.batch_sizes);
+  }
+}
+
 TEST_P(CompactionIteratorTest, ShuttingDownInFilter) {
   NoMergingMergeOp merge_op;
   StallingFilter filter;
@@ -745,6 +813,42 @@ TEST_P(CompactionIteratorTest, ConvertToPutAtBottom) {
           true /*bottomost_level*/);
 }
 
+// Without snapshots, puts are deduplicated on the fast path, which hands
+// deletions and merges back to the general path.
+TEST_P(CompactionIteratorTest, NoSnapshotFastPath) {
+  std::shared_ptr<MergeOperator> merge_op =
+      MergeOperators::CreateStringAppendOperator();
+  InitIterators(
+      {test::KeyStr("a", 9, kTypeValue), test::KeyStr("a", 8, kTypeValue),
+       test::KeyStr("a", 7, kTypeValue), test::KeyStr("b", 6, kTypeDeletion),
+       test::KeyStr("b", 5, kTypeValue), test::KeyStr("c", 4, kTypeMerge),
+       test::KeyStr("c", 3, kTypeValue), test::KeyStr("d", 2, kTypeValue),
+       test::KeyStr("d", 1, kTypeValue), test::KeyStr("ma", 8, kTypeValue),
+       test::KeyStr("mb", 11, kTypeValue)},
+      {"a9", "a8", "a7", "", "b5", "c4", "c3", "d2", "d1", "ma8", "mb11"},
+      {test::KeyStr("m", 10, kTypeRangeDeletion)}, {"z"}, kMaxSequenceNumber,
+      kMaxSequenceNumber, merge_op.get());
+  c_iter_->SeekToFirst();
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (; c_iter_->Valid(); c_iter_->Next()) {
+    keys.push_back(c_iter_->key().ToString());
+    values.push_back(c_iter_->value().ToString());
+  }
+  ASSERT_OK(c_iter_->status());
+  ASSERT_EQ(std::vector<std::string>(
+                {test::KeyStr("a", 9, kTypeValue),
+                 test::KeyStr("b", 6, kTypeDeletion),
+                 test::KeyStr("c", 4, kTypeValue),
+                 test::KeyStr("d", 2, kTypeValue),
+                 test::KeyStr("mb", 11, kTypeValue)}),
+            keys);
+  ASSERT_EQ(std::vector<std::string>({"a9", "", "c3,c4", "d2", "mb11"}),
+            values);
+  ASSERT_EQ(11U, c_iter_->iter_stats().num_input_records);
+  ASSERT_EQ(1U, c_iter_->iter_stats().num_record_drop_range_del);
+}
+
 INSTANTIATE_TEST_CASE_P(CompactionIteratorTestInstance, CompactionIteratorTest,
                         testing::Values(true, false));
 
@@ -26,11 +26,13 @@
 #include "db/blob/blob_file_addition.h"
 #include "db/blob/blob_file_builder.h"
 #include "db/builder.h"
+#include "db/compaction/pipelined_compaction_iterator.h"
 #include "db/db_impl/db_impl.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
 #include "db/error_handler.h"
 #include "db/event_helpers.h"
+#include "db/key_distribution.h"
 #include "db/log_reader.h"
 #include "db/log_writer.h"
 #include "db/memtable.h"
@@ -39,6 +41,7 @@
 #include "db/merge_helper.h"
 #include "db/output_validator.h"
 #include "db/range_del_aggregator.h"
+#include "db/table_properties_collector.h"
 #include "db/version_set.h"
 #include "file/filename.h"
 #include "file/read_write_util.h"
@@ -46,10 +49,12 @@
 #include "file/writable_file_writer.h"
 #include "logging/log_buffer.h"
 #include "logging/logging.h"
+#include "options/options_helper.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/thread_status_util.h"
 #include "port/port.h"
+#include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/sst_partitioner.h"
@@ -444,105 +449,38 @@ void CompactionJob::Prepare() {
   }
 }
 
-struct RangeWithSize {
-  Range range;
-  uint64_t size;
-
-  RangeWithSize(const Slice& a, const Slice& b, uint64_t s = 0)
-      : range(a, b), size(s) {}
-};
-
 void CompactionJob::GenSubcompactionBoundaries() {
   auto* c = compact_->compaction;
   auto* cfd = c->column_family_data();
   const Comparator* cfd_comparator = cfd->user_comparator();
-  std::vector<Slice> bounds;
   int start_lvl = c->start_level();
   int out_lvl = c->output_level();
 
-  // Add the starting and/or ending key of certain input files as a potential
-  // boundary
+  // Sample user keys from the index of every input file, see
+  // KeyDistribution::AddFile()
+  KeyDistribution distribution;
+  // Table readers could potentially be opened to read the index blocks,
+  // which may incur I/O. Unlock db mutex to reduce contention
+  db_mutex_->Unlock();
   for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
     int lvl = c->level(lvl_idx);
-    if (lvl >= start_lvl && lvl <= out_lvl) {
-      const LevelFilesBrief* flevel = c->input_levels(lvl_idx);
-      size_t num_files = flevel->num_files;
-
-      if (num_files == 0) {
-        continue;
-      }
-
-      if (lvl == 0) {
-        // For level 0 add the starting and ending key of each file since the
-        // files may have greatly differing key ranges (not range-partitioned)
-        for (size_t i = 0; i < num_files; i++) {
-          bounds.emplace_back(flevel->files[i].smallest_key);
-          bounds.emplace_back(flevel->files[i].largest_key);
-        }
-      } else {
-        // For all other levels add the smallest/largest key in the level to
-        // encompass the range covered by that level
-        bounds.emplace_back(flevel->files[0].smallest_key);
-        bounds.emplace_back(flevel->files[num_files - 1].largest_key);
-        if (lvl == out_lvl) {
-          // For the last level include the starting keys of all files since
-          // the last level is the largest and probably has the widest key
-          // range. Since it's range partitioned, the ending key of one file
-          // and the starting key of the next are very close (or identical).
-          for (size_t i = 1; i < num_files; i++) {
-            bounds.emplace_back(flevel->files[i].smallest_key);
-          }
-        }
-      }
+    if (lvl < start_lvl || lvl > out_lvl) {
+      continue;
+    }
+    for (size_t i = 0; i < c->num_input_files(lvl_idx); i++) {
+      distribution.AddFile(cfd->table_cache(), cfd->internal_comparator(),
+                           *c->input(lvl_idx, i));
     }
   }
+  db_mutex_->Lock();
+  const uint64_t sum = distribution.TotalBytes();
 
-  std::sort(bounds.begin(), bounds.end(),
-            [cfd_comparator](const Slice& a, const Slice& b) -> bool {
-              return cfd_comparator->Compare(ExtractUserKey(a),
-                                             ExtractUserKey(b)) < 0;
-            });
-  // Remove duplicated entries from bounds
-  bounds.erase(
-      std::unique(bounds.begin(), bounds.end(),
-                  [cfd_comparator](const Slice& a, const Slice& b) -> bool {
-                    return cfd_comparator->Compare(ExtractUserKey(a),
-                                                   ExtractUserKey(b)) == 0;
-                  }),
-      bounds.end());
-
-  // Combine consecutive pairs of boundaries into ranges with an approximate
-  // size of data covered by keys in that range
-  uint64_t sum = 0;
-  std::vector<RangeWithSize> ranges;
+  // Group the anchors into subcompactions
+  const double min_file_fill_percent = 4.0 / 5;
   // Get input version from CompactionState since it's already referenced
   // earlier in SetInputVersioCompaction::SetInputVersion and will not change
-  // when db_mutex_ is released below
+  // when db_mutex_ is released above
   auto* v = compact_->compaction->input_version();
-  for (auto it = bounds.begin();;) {
-    const Slice a = *it;
-    ++it;
-
-    if (it == bounds.end()) {
-      break;
-    }
-
-    const Slice b = *it;
-
-    // ApproximateSize could potentially create table reader iterator to seek
-    // to the index block and may incur I/O cost in the process. Unlock db
-    // mutex to reduce contention
-    db_mutex_->Unlock();
-    uint64_t size = versions_->ApproximateSize(SizeApproximationOptions(), v, a,
-                                               b, start_lvl, out_lvl + 1,
-                                               TableReaderCaller::kCompaction);
-    db_mutex_->Lock();
-    ranges.emplace_back(a, b, size);
-    sum += size;
-  }
-
-  // Group the ranges into subcompactions
-  const double min_file_fill_percent = 4.0 / 5;
   int base_level = v->storage_info()->base_level();
   uint64_t max_output_files = static_cast<uint64_t>(std::ceil(
       sum / min_file_fill_percent /
@@ -550,32 +488,24 @@ void CompactionJob::GenSubcompactionBoundaries() {
           c->immutable_cf_options()->compaction_style, base_level,
           c->immutable_cf_options()->level_compaction_dynamic_level_bytes)));
   uint64_t subcompactions =
-      std::min({static_cast<uint64_t>(ranges.size()),
+      std::min({static_cast<uint64_t>(distribution.NumSamples()),
                 static_cast<uint64_t>(c->max_subcompactions()),
                 max_output_files});
 
   if (subcompactions > 1) {
-    double mean = sum * 1.0 / subcompactions;
-    // Greedily add ranges to the subcompaction until the sum of the ranges'
-    // sizes becomes >= the expected mean size of a subcompaction
-    sum = 0;
-    for (size_t i = 0; i + 1 < ranges.size(); i++) {
-      sum += ranges[i].size;
-      if (subcompactions == 1) {
-        // If there's only one left to schedule then it goes to the end so no
-        // need to put an end boundary
-        continue;
-      }
-      if (sum >= mean) {
-        boundaries_.emplace_back(ExtractUserKey(ranges[i].range.limit));
-        sizes_.emplace_back(sum);
-        subcompactions--;
-        sum = 0;
+    distribution.Build(cfd_comparator, static_cast<size_t>(subcompactions));
+    const auto& buckets = distribution.buckets();
+    for (size_t i = 0; i < buckets.size(); i++) {
+      if (i + 1 < buckets.size()) {
+        boundary_keys_.emplace_back(buckets[i].largest_user_key);
       }
+      sizes_.emplace_back(buckets[i].bytes);
+    }
+    for (const auto& key : boundary_keys_) {
+      boundaries_.emplace_back(key);
     }
-    sizes_.emplace_back(sum + ranges.back().size);
   } else {
-    // Only one range so its size is the total sum of sizes computed above
+    // Only one subcompaction so its size is the total sum of sizes
     sizes_.emplace_back(sum);
   }
 }
@@ -586,6 +516,7 @@ Status CompactionJob::Run() {
   TEST_SYNC_POINT("CompactionJob::Run():Start");
   log_buffer_->FlushBufferToLog();
   LogCompaction();
+  SkipInputsCoveredByRangeDeletions();
 
   const size_t num_threads = compact_->sub_compact_states.size();
   assert(num_threads > 0);
@@ -746,9 +677,7 @@ Status CompactionJob::Run() {
   TablePropertiesCollection tp;
   for (const auto& state : compact_->sub_compact_states) {
     for (const auto& output : state.outputs) {
-      auto fn =
-          TableFileName(state.compaction->immutable_cf_options()->cf_paths,
-                        output.meta.fd.GetNumber(), output.meta.fd.GetPathId());
+      auto fn = GetTableFileName(output.meta.fd.GetNumber());
       tp[fn] = output.table_properties;
     }
   }
@@ -869,6 +798,13 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
   stream << "num_single_delete_fallthrough"
          << compaction_job_stats_->num_single_del_fallthru;
 
+  if (compaction_job_stats_->num_blobs_relocated > 0) {
+    stream << "num_blobs_relocated"
+           << compaction_job_stats_->num_blobs_relocated
+           << "total_blob_bytes_relocated"
+           << compaction_job_stats_->total_blob_bytes_relocated;
+  }
+
   if (measure_io_stats_) {
     stream << "file_write_nanos" << compaction_job_stats_->file_write_nanos;
     stream << "file_range_sync_nanos"
@@ -893,37 +829,175 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
   CleanupCompaction();
   return status;
 }
-//Only Used for ZenFS Experiment
-void CompactionJob::PreCalculateMinMaxKey(Slice& smallest, Slice& largest) {
-
-    ColumnFamilyData* cfd = compact_->compaction->column_family_data();
-    auto vstorage = cfd->current()->storage_info();
-    const InternalKeyComparator* icmp = vstorage->InternalComparator();
-
-    compact_->compaction->PreCalculateMinMaxKey(smallest, largest, icmp);
 
+namespace {
+// The range deletions of the input files are added to the range deletion
+// aggregator as the files are opened, so a merge thread would race with the
+// output files reading them
+bool InputHasRangeDeletions(const Compaction* c) {
+  for (size_t level = 0; level < c->num_input_levels(); level++) {
+    for (size_t i = 0; i < c->num_input_files(level); i++) {
+      std::shared_ptr<const TableProperties> tp;
+      Status s =
+          c->input_version()->GetTableProperties(&tp, c->input(level, i));
+      if (!s.ok() || tp == nullptr || tp->num_range_deletions > 0) {
+        return true;
+      }
+    }
+  }
+  return false;
 }
+}  // namespace
 
-void CompactionJob::PrintMinMaxKey() {
+void CompactionJob::SkipInputsCoveredByRangeDeletions() {
+  Compaction* c = compact_->compaction;
+  ColumnFamilyData* cfd = c->column_family_data();
+  const Comparator* ucmp = cfd->user_comparator();
+  if (ucmp->timestamp_size() > 0 || snapshot_checker_ != nullptr) {
+    return;
+  }
+#ifndef ROCKSDB_LITE
+  if (db_options_.compaction_service) {
+    return;
+  }
+#endif  // !ROCKSDB_LITE
 
-    Slice s = compact_->SmallestUserKey();
-    Slice l = compact_->LargestUserKey();
+  struct Tombstone {
+    Slice start;
+    Slice end;
+    SequenceNumber seq;
+  };
+  ReadOptions read_options;
+  read_options.fill_cache = false;
+  TableCache* table_cache = cfd->table_cache();
+  std::vector<Cache::Handle*> handles;
+  std::vector<std::unique_ptr<FragmentedRangeTombstoneIterator>> iters;
+  std::vector<Tombstone> tombstones;
+  for (size_t level = 0; level < c->num_input_levels(); level++) {
+    for (size_t i = 0; i < c->num_input_files(level); i++) {
+      const FileMetaData* f = c->input(level, i);
+      std::shared_ptr<const TableProperties> tp;
+      Status s = c->input_version()->GetTableProperties(&tp, f);
+      if (!s.ok() || tp == nullptr || tp->num_range_deletions == 0) {
+        continue;
+      }
+      TableReader* table = f->fd.table_reader;
+      if (table == nullptr) {
+        Cache::Handle* handle = nullptr;
+        s = table_cache->FindTable(read_options, file_options_for_read_,
+                                   cfd->internal_comparator(), f->fd, &handle);
+        if (!s.ok()) {
+          continue;
+        }
+        handles.push_back(handle);
+        table = table_cache->GetTableReaderFromHandle(handle);
+      }
+      std::unique_ptr<FragmentedRangeTombstoneIterator> iter(
+          table->NewRangeTombstoneIterator(read_options));
+      if (iter == nullptr) {
+        continue;
+      }
+      // A tombstone deletes the keys within the bounds of its file. The
+      // largest key may be a point key, so it is left out.
+      const Slice smallest = f->smallest.user_key();
+      const Slice largest = f->largest.user_key();
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        Slice start = iter->start_key();
+        Slice end = iter->end_key();
+        if (ucmp->Compare(start, smallest) < 0) {
+          start = smallest;
+        }
+        if (ucmp->Compare(end, largest) > 0) {
+          end = largest;
+        }
+        if (ucmp->Compare(start, end) < 0) {
+          tombstones.push_back({start, end, iter->seq()});
+        }
+      }
+      iters.push_back(std::move(iter));
+    }
+  }
+
+  std::vector<const FileMetaData*> covered;
+  uint64_t covered_bytes = 0;
+  if (!tombstones.empty()) {
+    std::sort(tombstones.begin(), tombstones.end(),
+              [ucmp](const Tombstone& a, const Tombstone& b) {
+                return ucmp->Compare(a.start, b.start) < 0;
+              });
+    for (size_t level = 0; level < c->num_input_levels(); level++) {
+      for (size_t i = 0; i < c->num_input_files(level); i++) {
+        const FileMetaData* f = c->input(level, i);
+        // A tombstone deletes all the keys of the file when newer than them
+        // with no snapshot in between, that is no later than the first
+        // snapshot at or after the oldest key.
+        auto snapshot =
+            std::lower_bound(existing_snapshots_.begin(),
+                             existing_snapshots_.end(), f->fd.smallest_seqno);
+        const SequenceNumber max_seq = snapshot == existing_snapshots_.end()
+                                           ? kMaxSequenceNumber
+                                           : *snapshot;
+        // The tombstones, by start key, have to leave no gap from the
+        // smallest key up to past the largest one
+        Slice covered_to = f->smallest.user_key();
+        bool is_covered = false;
+        for (const auto& t : tombstones) {
+          if (t.seq <= f->fd.largest_seqno || t.seq > max_seq) {
+            continue;
+          }
+          if (ucmp->Compare(t.start, covered_to) > 0) {
+            break;
+          }
+          if (ucmp->Compare(t.end, covered_to) > 0) {
+            covered_to = t.end;
+            if (ucmp->Compare(f->largest.user_key(), covered_to) < 0) {
+              is_covered = true;
+              break;
+            }
+          }
+        }
+        if (is_covered) {
+          covered.push_back(f);
+          covered_bytes += f->fd.GetFileSize();
+        }
+      }
+    }
+  }
+  iters.clear();
+  for (auto handle : handles) {
+    table_cache->ReleaseHandle(handle);
+  }
 
-    std::cerr <<"After Compaction" << std::endl;
-    std::cerr <<"smallest_key :: ";
-    for (size_t i=0; i<s.size(); i++)
-        std::cerr << s.data()[i];
-    std::cerr<<std::endl;
-    std::cerr <<"smallest_key :: ";
-    for (size_t i=0; i<l.size(); i++)
-        std::cerr << l.data()[i];
-    std::cerr<<std::endl;
+  if (covered.empty()) {
+    return;
+  }
+  c->SkipInputFiles(covered);
+  RecordTick(stats_, COMPACTION_RANGE_DEL_DROP_FILES, covered.size());
+  RecordTick(stats_, COMPACTION_RANGE_DEL_DROP_FILE_BYTES, covered_bytes);
+  ROCKS_LOG_INFO(db_options_.info_log,
+                 "[%s] [JOB %d] Dropping %" ROCKSDB_PRIszt
+                 " input files, %" PRIu64
+                 " bytes, without reading them: range tombstones delete all "
+                 "their keys",
+                 cfd->GetName().c_str(), job_id_, covered.size(),
+                 covered_bytes);
 }
 
 void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   assert(sub_compact);
   assert(sub_compact->compaction);
 
+#ifndef ROCKSDB_LITE
+  if (db_options_.compaction_service) {
+    CompactionServiceJobStatus comp_status =
+        ProcessKeyValueCompactionWithCompactionService(sub_compact);
+    if (comp_status != CompactionServiceJobStatus::kUseLocal) {
+      return;
+    }
+    // Fall back to running the subcompaction locally
+  }
+#endif  // !ROCKSDB_LITE
+
   uint64_t prev_cpu_micros = env_->NowCPUNanos() / 1000;
 
   ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
@@ -968,6 +1042,10 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   // (a) concurrent compactions,
   // (b) CompactionFilter::Decision::kRemoveAndSkipUntil.
   read_options.total_order_seek = true;
+  const bool pipelined = db_options_.enable_pipelined_compaction &&
+                         !InputHasRangeDeletions(sub_compact->compaction);
+  // Let the input blocks be read ahead while they are merged
+  read_options.async_io = pipelined;
 
   // Although the v2 aggregator is what the level iterator(s) know about,
   // the AddTombstones calls will be propagated down to the v1 aggregator.
@@ -1013,13 +1091,16 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   std::vector<std::string> blob_file_paths;
 
   std::unique_ptr<BlobFileBuilder> blob_file_builder(
-      mutable_cf_options->enable_blob_files
+      (mutable_cf_options->enable_blob_files &&
+       sub_compact->compaction->output_level() >=
+           mutable_cf_options->blob_file_starting_level)
           ? new BlobFileBuilder(
                 versions_, env_, fs_.get(),
                 sub_compact->compaction->immutable_cf_options(),
                 mutable_cf_options, &file_options_, job_id_, cfd->GetID(),
                 cfd->GetName(), Env::IOPriority::IO_LOW, write_hint_,
-                &blob_file_paths, &sub_compact->blob_file_additions)
+                &blob_file_paths, &sub_compact->blob_file_additions,
+                sub_compact->compaction->output_level())
           : nullptr);
 
   TEST_SYNC_POINT("CompactionJob::Run():Inprogress");
@@ -1048,7 +1129,10 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       sub_compact->compaction, compaction_filter, shutting_down_,
       preserve_deletes_seqnum_, manual_compaction_paused_,
       db_options_.info_log));
-  auto c_iter = sub_compact->c_iter.get();
+  PipelinedCompactionIterator pipe(
+      sub_compact->c_iter.get(), input.get(), cfd->user_comparator(), end,
+      pipelined, env_, [this]() { RecordCompactionIOStats(); });
+  auto c_iter = &pipe;
   c_iter->SeekToFirst();
   if (c_iter->Valid() && sub_compact->compaction->output_level() != 0) {
     // ShouldStopBefore() maintains state based on keys processed so far. The
@@ -1057,7 +1141,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     sub_compact->ShouldStopBefore(c_iter->key(),
                                   sub_compact->current_output_file_size);
   }
-  const auto& c_iter_stats = c_iter->iter_stats();
+  const auto& c_iter_stats = sub_compact->c_iter->iter_stats();
 
   std::unique_ptr<SstPartitioner> partitioner =
       sub_compact->compaction->output_level() == 0
@@ -1076,10 +1160,12 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
         cfd->user_comparator()->Compare(c_iter->user_key(), *end) >= 0) {
       break;
     }
-    if (c_iter_stats.num_input_records % kRecordStatsEvery ==
-        kRecordStatsEvery - 1) {
+    // The merge thread of a pipelined compaction records its own I/O stats,
+    // and its key stats are only read once it is done
+    if (!pipelined && c_iter_stats.num_input_records % kRecordStatsEvery ==
+                          kRecordStatsEvery - 1) {
       RecordDroppedKeys(c_iter_stats, &sub_compact->compaction_job_stats);
-      c_iter->ResetRecordCounts();
+      sub_compact->c_iter->ResetRecordCounts();
       RecordCompactionIOStats();
     }
 
@@ -1151,13 +1237,14 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
         next_key = &c_iter->key();
       }
       CompactionIterationStats range_del_out_stats;
-      status = FinishCompactionOutputFile(input->status(), sub_compact,
+      status = FinishCompactionOutputFile(c_iter->input_status(), sub_compact,
                                           &range_del_agg, &range_del_out_stats,
                                           next_key);
       RecordDroppedKeys(range_del_out_stats,
                         &sub_compact->compaction_job_stats);
     }
   }
+  pipe.Finish();
   sub_compact->compaction_job_stats.num_input_deletion_records =
       c_iter_stats.num_input_deletion_records;
   sub_compact->compaction_job_stats.num_corrupt_keys =
@@ -1170,9 +1257,17 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       c_iter_stats.total_input_raw_key_bytes;
   sub_compact->compaction_job_stats.total_input_raw_value_bytes +=
       c_iter_stats.total_input_raw_value_bytes;
+  sub_compact->compaction_job_stats.num_blobs_relocated +=
+      c_iter_stats.num_blobs_relocated;
+  sub_compact->compaction_job_stats.total_blob_bytes_relocated +=
+      c_iter_stats.total_blob_bytes_relocated;
 
   RecordTick(stats_, FILTER_OPERATION_TOTAL_TIME,
              c_iter_stats.total_filter_time);
+  RecordTick(stats_, BLOB_DB_GC_NUM_KEYS_RELOCATED,
+             c_iter_stats.num_blobs_relocated);
+  RecordTick(stats_, BLOB_DB_GC_BYTES_RELOCATED,
+             c_iter_stats.total_blob_bytes_relocated);
   RecordDroppedKeys(c_iter_stats, &sub_compact->compaction_job_stats);
   RecordCompactionIOStats();
 
@@ -1193,7 +1288,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     status = input->status();
   }
   if (status.ok()) {
-    status = c_iter->status();
+    status = sub_compact->c_iter->status();
   }
 
   if (status.ok() && sub_compact->builder == nullptr &&
@@ -1223,7 +1318,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   }
 
   sub_compact->compaction_job_stats.cpu_micros =
-      env_->NowCPUNanos() / 1000 - prev_cpu_micros;
+      env_->NowCPUNanos() / 1000 - prev_cpu_micros + pipe.merge_cpu_micros();
 
   if (measure_io_stats_) {
     sub_compact->compaction_job_stats.file_write_nanos +=
@@ -1258,6 +1353,169 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   sub_compact->status = status;
 }
 
+#ifndef ROCKSDB_LITE
+CompactionServiceJobStatus
+CompactionJob::ProcessKeyValueCompactionWithCompactionService(
+    SubcompactionState* sub_compact) {
+  assert(sub_compact);
+  assert(sub_compact->compaction);
+  assert(db_options_.compaction_service);
+
+  const Compaction* compaction = sub_compact->compaction;
+  ColumnFamilyData* cfd = compaction->column_family_data();
+  const MutableCFOptions* mutable_cf_options = compaction->mutable_cf_options();
+  if (mutable_cf_options->enable_blob_files) {
+    // The service only returns table files
+    return CompactionServiceJobStatus::kUseLocal;
+  }
+
+  CompactionServiceInput compaction_input;
+  compaction_input.column_family_name = cfd->GetName();
+  ConfigOptions config_options;
+  // The mutable DB options are not known here and are left at their defaults
+  Status s = GetStringFromDBOptions(
+      config_options, BuildDBOptions(db_options_, MutableDBOptions()),
+      &compaction_input.db_options);
+  if (s.ok()) {
+    s = GetStringFromColumnFamilyOptions(
+        config_options,
+        BuildColumnFamilyOptions(cfd->GetLatestCFOptions(),
+                                 *mutable_cf_options),
+        &compaction_input.cf_options);
+  }
+  if (!s.ok()) {
+    sub_compact->status = s;
+    return CompactionServiceJobStatus::kFailure;
+  }
+  compaction_input.snapshots = existing_snapshots_;
+  for (size_t level = 0; level < compaction->num_input_levels(); level++) {
+    for (size_t i = 0; i < compaction->num_input_files(level); i++) {
+      compaction_input.input_files.push_back(
+          compaction->input(level, i)->fd.GetNumber());
+    }
+  }
+  compaction_input.output_level = compaction->output_level();
+  if (sub_compact->start != nullptr) {
+    compaction_input.has_begin = true;
+    compaction_input.begin = sub_compact->start->ToString();
+  }
+  if (sub_compact->end != nullptr) {
+    compaction_input.has_end = true;
+    compaction_input.end = sub_compact->end->ToString();
+  }
+  compaction_input.approx_size = sub_compact->approx_size;
+
+  std::string compaction_input_binary;
+  compaction_input.EncodeTo(&compaction_input_binary);
+
+  // Subcompactions of one job get ids of their own
+  const uint64_t service_job_id =
+      (static_cast<uint64_t>(job_id_) << 32) |
+      static_cast<uint64_t>(sub_compact - &compact_->sub_compact_states[0]);
+  ROCKS_LOG_INFO(db_options_.info_log,
+                 "[%s] [JOB %d] Starting remote compaction (output level: %d)"
+                 " on %s",
+                 cfd->GetName().c_str(), job_id_,
+                 compaction_input.output_level,
+                 db_options_.compaction_service->Name());
+  CompactionServiceJobStatus comp_status =
+      db_options_.compaction_service->Start(compaction_input_binary,
+                                            service_job_id);
+  if (comp_status != CompactionServiceJobStatus::kSuccess) {
+    if (comp_status == CompactionServiceJobStatus::kFailure) {
+      sub_compact->status =
+          Status::Incomplete("CompactionService failed to start compaction");
+    }
+    return comp_status;
+  }
+
+  std::string compaction_result_binary;
+  comp_status = db_options_.compaction_service->WaitForComplete(
+      service_job_id, &compaction_result_binary);
+  if (comp_status != CompactionServiceJobStatus::kSuccess) {
+    if (comp_status == CompactionServiceJobStatus::kFailure) {
+      sub_compact->status =
+          Status::Incomplete("CompactionService failed to run compaction");
+    }
+    return comp_status;
+  }
+
+  CompactionServiceResult compaction_result;
+  s = CompactionServiceResult::DecodeFrom(compaction_result_binary,
+                                          &compaction_result);
+  if (s.ok()) {
+    s = compaction_result.status;
+  }
+  if (!s.ok()) {
+    sub_compact->status = s;
+    return CompactionServiceJobStatus::kFailure;
+  }
+
+  // Move the output files into the DB under new file numbers
+  auto sfm =
+      static_cast<SstFileManagerImpl*>(db_options_.sst_file_manager.get());
+  for (const auto& file : compaction_result.output_files) {
+    const uint64_t file_number = versions_->NewFileNumber();
+    const std::string src_file =
+        compaction_result.output_path + "/" + file.file_name;
+    const std::string tgt_file = GetTableFileName(file_number);
+    s = fs_->RenameFile(src_file, tgt_file, IOOptions(), nullptr);
+    uint64_t file_size = 0;
+    if (s.ok()) {
+      s = fs_->GetFileSize(tgt_file, IOOptions(), &file_size, nullptr);
+    }
+    if (!s.ok()) {
+      sub_compact->status = s;
+      return CompactionServiceJobStatus::kFailure;
+    }
+
+    FileMetaData meta;
+    meta.fd = FileDescriptor(file_number, compaction->output_path_id(),
+                             file_size, file.smallest_seqno,
+                             file.largest_seqno);
+    meta.smallest.DecodeFrom(file.smallest_internal_key);
+    meta.largest.DecodeFrom(file.largest_internal_key);
+    meta.oldest_ancester_time = file.oldest_ancester_time;
+    meta.file_creation_time = file.file_creation_time;
+    meta.marked_for_compaction = file.marked_for_compaction;
+    meta.file_checksum = file.file_checksum;
+    meta.file_checksum_func_name = file.file_checksum_func_name;
+
+    std::shared_ptr<const TableProperties> table_properties;
+    s = cfd->table_cache()->GetTableProperties(
+        file_options_, cfd->internal_comparator(), meta.fd, &table_properties,
+        mutable_cf_options->prefix_extractor.get());
+    if (!s.ok()) {
+      sub_compact->status = s;
+      return CompactionServiceJobStatus::kFailure;
+    }
+    GetTimestampRange(table_properties->user_collected_properties,
+                      &meta.min_timestamp, &meta.max_timestamp);
+
+    sub_compact->outputs.emplace_back(std::move(meta),
+                                      cfd->internal_comparator(),
+                                      /*enable_order_check=*/false,
+                                      /*enable_hash=*/paranoid_file_checks_);
+    auto* output = sub_compact->current_output();
+    output->validator.SetHash(file.paranoid_hash);
+    output->finished = true;
+    output->table_properties = std::move(table_properties);
+
+    if (sfm && output->meta.fd.GetPathId() == 0) {
+      s = sfm->OnAddFile(tgt_file);
+      if (!s.ok()) {
+        sub_compact->status = s;
+        return CompactionServiceJobStatus::kFailure;
+      }
+    }
+  }
+  sub_compact->num_output_records = compaction_result.num_output_records;
+  sub_compact->total_bytes = compaction_result.total_bytes;
+  sub_compact->status = Status::OK();
+  return CompactionServiceJobStatus::kSuccess;
+}
+#endif  // !ROCKSDB_LITE
+
 void CompactionJob::RecordDroppedKeys(
     const CompactionIterationStats& c_iter_stats,
     CompactionJobStats* compaction_job_stats) {
@@ -1536,9 +1794,7 @@ Status CompactionJob::FinishCompactionOutputFile(
     // If there is nothing to output, no necessary to generate a sst file.
     // This happens when the output level is bottom level, at the same time
     // the sub_compact output nothing.
-    std::string fname =
-        TableFileName(sub_compact->compaction->immutable_cf_options()->cf_paths,
-                      meta->fd.GetNumber(), meta->fd.GetPathId());
+    std::string fname = GetTableFileName(meta->fd.GetNumber());
     env_->DeleteFile(fname);
 
     // Also need to remove the file from outputs, or it will be added to the
@@ -1549,6 +1805,8 @@ Status CompactionJob::FinishCompactionOutputFile(
   }
 
   if (s.ok() && (current_entries > 0 || tp.num_range_deletions > 0)) {
+    GetTimestampRange(tp.user_collected_properties, &meta->min_timestamp,
+                      &meta->max_timestamp);
     // Output to event logger and fire events.
     sub_compact->current_output()->table_properties =
         std::make_shared<TableProperties>(tp);
@@ -1563,9 +1821,7 @@ Status CompactionJob::FinishCompactionOutputFile(
   FileDescriptor output_fd;
   uint64_t oldest_blob_file_number = kInvalidBlobFileNumber;
   if (meta != nullptr) {
-    fname =
-        TableFileName(sub_compact->compaction->immutable_cf_options()->cf_paths,
-                      meta->fd.GetNumber(), meta->fd.GetPathId());
+    fname = GetTableFileName(meta->fd.GetNumber());
     output_fd = meta->fd;
     oldest_blob_file_number = meta->oldest_blob_file_number;
   } else {
@@ -1687,9 +1943,7 @@ Status CompactionJob::OpenCompactionOutputFile(
   assert(sub_compact->builder == nullptr);
   // no need to lock because VersionSet::next_file_number_ is atomic
   uint64_t file_number = versions_->NewFileNumber();
-  std::string fname =
-      TableFileName(sub_compact->compaction->immutable_cf_options()->cf_paths,
-                    file_number, sub_compact->compaction->output_path_id());
+  std::string fname = GetTableFileName(file_number);
   // Fire events.
   ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
 #ifndef ROCKSDB_LITE
@@ -1704,9 +1958,30 @@ Status CompactionJob::OpenCompactionOutputFile(
   TEST_SYNC_POINT_CALLBACK("CompactionJob::OpenCompactionOutputFile",
                            &syncpoint_arg);
 #endif
+  FileOptions fo_copy = file_options_;
+  {
+    // The output can only cover the subcompaction's share of the input range
+    const Compaction* c = sub_compact->compaction;
+    Slice smallest_user_key =
+        sub_compact->start ? *sub_compact->start : c->GetSmallestUserKey();
+    Slice largest_user_key =
+        sub_compact->end ? *sub_compact->end : c->GetLargestUserKey();
+    FilePlacementHint& hint = fo_copy.placement_hint;
+    hint.level = c->output_level();
+    hint.smallest = InternalKey(smallest_user_key, kMaxSequenceNumber,
+                                kValueTypeForSeek)
+                        .Encode()
+                        .ToString();
+    hint.largest =
+        InternalKey(largest_user_key, 0, kTypeDeletion).Encode().ToString();
+    hint.expected_size = c->max_output_file_size();
+    if (sub_compact->approx_size > 0) {
+      hint.expected_size =
+          std::min(hint.expected_size, sub_compact->approx_size);
+    }
+  }
   Status s;
-  IOStatus io_s =
-      NewWritableFile(fs_.get(), fname, &writable_file, file_options_);
+  IOStatus io_s = NewWritableFile(fs_.get(), fname, &writable_file, fo_copy);
   s = io_s;
   if (sub_compact->io_status.ok()) {
     sub_compact->io_status = io_s;
@@ -1763,6 +2038,16 @@ Status CompactionJob::OpenCompactionOutputFile(
 
   writable_file->SetIOPriority(Env::IOPriority::IO_LOW);
   writable_file->SetWriteLifeTimeHint(write_hint_);
+  {
+    const Compaction* c = sub_compact->compaction;
+    const uint64_t bucket_seconds =
+        c->mutable_cf_options()->compaction_options_fifo.zone_time_bucket_seconds;
+    if (c->immutable_cf_options()->compaction_style == kCompactionStyleFIFO &&
+        bucket_seconds > 0) {
+      // Intra-L0 FIFO compactions only merge files of one bucket
+      writable_file->SetTimeBucket(oldest_ancester_time / bucket_seconds + 1);
+    }
+  }
   writable_file->SetPreallocationBlockSize(static_cast<size_t>(
       sub_compact->compaction->OutputFilePreallocationSize()));
   const auto& listeners =
@@ -1793,6 +2078,11 @@ Status CompactionJob::OpenCompactionOutputFile(
   return s;
 }
 
+std::string CompactionJob::GetTableFileName(uint64_t file_number) {
+  return TableFileName(compact_->compaction->immutable_cf_options()->cf_paths,
+                       file_number, compact_->compaction->output_path_id());
+}
+
 void CompactionJob::CleanupCompaction() {
   for (SubcompactionState& sub_compact : compact_->sub_compact_states) {
     const auto& sub_status = sub_compact.status;
@@ -1944,4 +2234,282 @@ void CompactionJob::LogCompaction() {
   }
 }
 
+#ifndef ROCKSDB_LITE
+namespace {
+// Status only exposes its full constructor to subclasses
+class DecodedStatus : public Status {
+ public:
+  DecodedStatus(Code _code, SubCode _subcode, const Slice& msg)
+      : Status(_code, _subcode, msg, Slice()) {}
+};
+
+bool GetLengthPrefixedString(Slice* input, std::string* value) {
+  Slice slice;
+  if (!GetLengthPrefixedSlice(input, &slice)) {
+    return false;
+  }
+  value->assign(slice.data(), slice.size());
+  return true;
+}
+
+bool GetBool(Slice* input, bool* value) {
+  uint32_t v;
+  if (!GetVarint32(input, &v) || v > 1) {
+    return false;
+  }
+  *value = v != 0;
+  return true;
+}
+}  // namespace
+
+void CompactionServiceInput::EncodeTo(std::string* dst) const {
+  PutLengthPrefixedSlice(dst, column_family_name);
+  PutLengthPrefixedSlice(dst, db_options);
+  PutLengthPrefixedSlice(dst, cf_options);
+  PutVarint64(dst, snapshots.size());
+  for (SequenceNumber snapshot : snapshots) {
+    PutVarint64(dst, snapshot);
+  }
+  PutVarint64(dst, input_files.size());
+  for (uint64_t file_number : input_files) {
+    PutVarint64(dst, file_number);
+  }
+  PutVarint32(dst, static_cast<uint32_t>(output_level));
+  PutVarint32(dst, has_begin ? 1 : 0);
+  PutLengthPrefixedSlice(dst, begin);
+  PutVarint32(dst, has_end ? 1 : 0);
+  PutLengthPrefixedSlice(dst, end);
+  PutVarint64(dst, approx_size);
+}
+
+Status CompactionServiceInput::DecodeFrom(const Slice& src,
+                                          CompactionServiceInput* input) {
+  assert(input != nullptr);
+  Slice in = src;
+  uint64_t num_snapshots = 0;
+  if (!GetLengthPrefixedString(&in, &input->column_family_name) ||
+      !GetLengthPrefixedString(&in, &input->db_options) ||
+      !GetLengthPrefixedString(&in, &input->cf_options) ||
+      !GetVarint64(&in, &num_snapshots) || num_snapshots > in.size()) {
+    return Status::Corruption("Bad compaction service input");
+  }
+  input->snapshots.resize(static_cast<size_t>(num_snapshots));
+  for (auto& snapshot : input->snapshots) {
+    if (!GetVarint64(&in, &snapshot)) {
+      return Status::Corruption("Bad compaction service input snapshots");
+    }
+  }
+  uint64_t num_files = 0;
+  if (!GetVarint64(&in, &num_files) || num_files > in.size()) {
+    return Status::Corruption("Bad compaction service input files");
+  }
+  input->input_files.resize(static_cast<size_t>(num_files));
+  for (auto& file_number : input->input_files) {
+    if (!GetVarint64(&in, &file_number)) {
+      return Status::Corruption("Bad compaction service input files");
+    }
+  }
+  uint32_t output_level = 0;
+  if (!GetVarint32(&in, &output_level) || !GetBool(&in, &input->has_begin) ||
+      !GetLengthPrefixedString(&in, &input->begin) ||
+      !GetBool(&in, &input->has_end) ||
+      !GetLengthPrefixedString(&in, &input->end) ||
+      !GetVarint64(&in, &input->approx_size) || !in.empty()) {
+    return Status::Corruption("Bad compaction service input");
+  }
+  input->output_level = static_cast<int>(output_level);
+  return Status::OK();
+}
+
+void CompactionServiceResult::EncodeTo(std::string* dst) const {
+  PutVarint32(dst, static_cast<uint32_t>(status.code()));
+  PutVarint32(dst, static_cast<uint32_t>(status.subcode()));
+  PutLengthPrefixedSlice(
+      dst, status.getState() != nullptr ? status.getState() : "");
+  PutVarint64(dst, output_files.size());
+  for (const auto& file : output_files) {
+    PutLengthPrefixedSlice(dst, file.file_name);
+    PutVarint64(dst, file.smallest_seqno);
+    PutVarint64(dst, file.largest_seqno);
+    PutLengthPrefixedSlice(dst, file.smallest_internal_key);
+    PutLengthPrefixedSlice(dst, file.largest_internal_key);
+    PutVarint64(dst, file.oldest_ancester_time);
+    PutVarint64(dst, file.file_creation_time);
+    PutVarint64(dst, file.paranoid_hash);
+    PutVarint32(dst, file.marked_for_compaction ? 1 : 0);
+    PutLengthPrefixedSlice(dst, file.file_checksum);
+    PutLengthPrefixedSlice(dst, file.file_checksum_func_name);
+  }
+  PutVarint32(dst, static_cast<uint32_t>(output_level));
+  PutLengthPrefixedSlice(dst, output_path);
+  PutVarint64(dst, num_output_records);
+  PutVarint64(dst, total_bytes);
+}
+
+Status CompactionServiceResult::DecodeFrom(const Slice& src,
+                                           CompactionServiceResult* result) {
+  assert(result != nullptr);
+  Slice in = src;
+  uint32_t code = 0;
+  uint32_t subcode = 0;
+  Slice msg;
+  if (!GetVarint32(&in, &code) || !GetVarint32(&in, &subcode) ||
+      !GetLengthPrefixedSlice(&in, &msg) || code >= Status::kMaxCode ||
+      subcode >= Status::kMaxSubCode) {
+    return Status::Corruption("Bad compaction service result status");
+  }
+  if (code == Status::kOk) {
+    result->status = Status::OK();
+  } else {
+    result->status = DecodedStatus(static_cast<Status::Code>(code),
+                                   static_cast<Status::SubCode>(subcode), msg);
+  }
+  uint64_t num_files = 0;
+  if (!GetVarint64(&in, &num_files) || num_files > in.size()) {
+    return Status::Corruption("Bad compaction service result files");
+  }
+  result->output_files.resize(static_cast<size_t>(num_files));
+  for (auto& file : result->output_files) {
+    if (!GetLengthPrefixedString(&in, &file.file_name) ||
+        !GetVarint64(&in, &file.smallest_seqno) ||
+        !GetVarint64(&in, &file.largest_seqno) ||
+        !GetLengthPrefixedString(&in, &file.smallest_internal_key) ||
+        !GetLengthPrefixedString(&in, &file.largest_internal_key) ||
+        !GetVarint64(&in, &file.oldest_ancester_time) ||
+        !GetVarint64(&in, &file.file_creation_time) ||
+        !GetVarint64(&in, &file.paranoid_hash) ||
+        !GetBool(&in, &file.marked_for_compaction) ||
+        !GetLengthPrefixedString(&in, &file.file_checksum) ||
+        !GetLengthPrefixedString(&in, &file.file_checksum_func_name)) {
+      return Status::Corruption("Bad compaction service result files");
+    }
+  }
+  uint32_t output_level = 0;
+  if (!GetVarint32(&in, &output_level) ||
+      !GetLengthPrefixedString(&in, &result->output_path) ||
+      !GetVarint64(&in, &result->num_output_records) ||
+      !GetVarint64(&in, &result->total_bytes) || !in.empty()) {
+    return Status::Corruption("Bad compaction service result");
+  }
+  result->output_level = static_cast<int>(output_level);
+  return Status::OK();
+}
+
+CompactionServiceCompactionJob::CompactionServiceCompactionJob(
+    int job_id, Compaction* compaction, const ImmutableDBOptions& db_options,
+    const FileOptions& file_options, VersionSet* versions,
+    const std::atomic<bool>* shutting_down,
+    const SequenceNumber preserve_deletes_seqnum, LogBuffer* log_buffer,
+    FSDirectory* output_directory, Statistics* stats,
+    InstrumentedMutex* db_mutex, ErrorHandler* db_error_handler,
+    std::vector<SequenceNumber> existing_snapshots,
+    std::shared_ptr<Cache> table_cache, EventLogger* event_logger,
+    const std::string& dbname, CompactionJobStats* compaction_job_stats,
+    const std::shared_ptr<IOTracer>& io_tracer, const std::string& db_id,
+    const std::string& db_session_id, const std::string& output_path,
+    const CompactionServiceInput& compaction_service_input,
+    CompactionServiceResult* compaction_service_result)
+    : CompactionJob(
+          job_id, compaction, db_options, file_options, versions,
+          shutting_down, preserve_deletes_seqnum, log_buffer,
+          /*db_directory=*/nullptr, output_directory,
+          /*blob_output_directory=*/nullptr, stats, db_mutex,
+          db_error_handler, std::move(existing_snapshots), kMaxSequenceNumber,
+          /*snapshot_checker=*/nullptr, std::move(table_cache), event_logger,
+          compaction->mutable_cf_options()->paranoid_file_checks,
+          compaction->mutable_cf_options()->report_bg_io_stats, dbname,
+          compaction_job_stats, Env::Priority::USER, io_tracer,
+          /*manual_compaction_paused=*/nullptr, db_id, db_session_id),
+      output_path_(output_path),
+      compaction_input_(compaction_service_input),
+      compaction_result_(compaction_service_result),
+      begin_(compaction_input_.begin),
+      end_(compaction_input_.end) {
+  assert(compaction_result_ != nullptr);
+}
+
+void CompactionServiceCompactionJob::Prepare() {
+  AutoThreadOperationStageUpdater stage_updater(
+      ThreadStatus::STAGE_COMPACTION_PREPARE);
+
+  auto* c = compact_->compaction;
+  assert(c->column_family_data() != nullptr);
+  write_hint_ =
+      c->column_family_data()->CalculateSSTWriteHint(c->output_level());
+  bottommost_level_ = c->bottommost_level();
+
+  compact_->sub_compact_states.emplace_back(
+      c, compaction_input_.has_begin ? &begin_ : nullptr,
+      compaction_input_.has_end ? &end_ : nullptr,
+      compaction_input_.approx_size);
+}
+
+Status CompactionServiceCompactionJob::Run() {
+  AutoThreadOperationStageUpdater stage_updater(
+      ThreadStatus::STAGE_COMPACTION_RUN);
+
+  assert(compact_->sub_compact_states.size() == 1);
+  SubcompactionState* sub_compact = &compact_->sub_compact_states[0];
+  log_buffer_->FlushBufferToLog();
+  LogCompaction();
+
+  const uint64_t start_micros = env_->NowMicros();
+  ProcessKeyValueCompaction(sub_compact);
+  compaction_stats_.micros = env_->NowMicros() - start_micros;
+  compaction_stats_.cpu_micros = sub_compact->compaction_job_stats.cpu_micros;
+  RecordTimeToHistogram(stats_, COMPACTION_TIME, compaction_stats_.micros);
+  RecordTimeToHistogram(stats_, COMPACTION_CPU_TIME,
+                        compaction_stats_.cpu_micros);
+
+  Status status = sub_compact->status;
+  IOStatus io_s = sub_compact->io_status;
+  if (io_status_.ok()) {
+    io_status_ = io_s;
+  }
+  if (status.ok() && output_directory_) {
+    io_s = output_directory_->Fsync(IOOptions(), nullptr);
+    if (io_status_.ok()) {
+      io_status_ = io_s;
+    }
+    status = io_s;
+  }
+
+  AggregateStatistics();
+  UpdateCompactionStats();
+  RecordCompactionIOStats();
+  LogFlush(db_options_.info_log);
+  compact_->status = status;
+
+  // Describe the output files for the DB, which installs them
+  compaction_result_->status = status;
+  compaction_result_->output_level = compact_->compaction->output_level();
+  compaction_result_->output_path = output_path_;
+  compaction_result_->output_files.clear();
+  for (const auto& output : sub_compact->outputs) {
+    const FileMetaData& meta = output.meta;
+    CompactionServiceOutputFile file;
+    file.file_name = MakeTableFileName(meta.fd.GetNumber());
+    file.smallest_seqno = meta.fd.smallest_seqno;
+    file.largest_seqno = meta.fd.largest_seqno;
+    file.smallest_internal_key = meta.smallest.Encode().ToString();
+    file.largest_internal_key = meta.largest.Encode().ToString();
+    file.oldest_ancester_time = meta.oldest_ancester_time;
+    file.file_creation_time = meta.file_creation_time;
+    file.paranoid_hash = output.validator.GetHash();
+    file.marked_for_compaction = meta.marked_for_compaction;
+    file.file_checksum = meta.file_checksum;
+    file.file_checksum_func_name = meta.file_checksum_func_name;
+    compaction_result_->output_files.push_back(std::move(file));
+  }
+  compaction_result_->num_output_records = sub_compact->num_output_records;
+  compaction_result_->total_bytes = sub_compact->total_bytes;
+  return status;
+}
+
+std::string CompactionServiceCompactionJob::GetTableFileName(
+    uint64_t file_number) {
+  return MakeTableFileName(output_path_, file_number);
+}
+#endif  // !ROCKSDB_LITE
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -80,7 +80,7 @@ class CompactionJob {
       const std::atomic<int>* manual_compaction_paused = nullptr,
       const std::string& db_id = "", const std::string& db_session_id = "");
 
-  ~CompactionJob();
+  virtual ~CompactionJob();
 
   // no copy/move
   CompactionJob(CompactionJob&& job) = delete;
@@ -103,9 +103,7 @@ class CompactionJob {
   // Return the IO status
   IOStatus io_status() const { return io_status_; }
 
-  void PreCalculateMinMaxKey(Slice&, Slice&);
-  void PrintMinMaxKey();
- private:
+ protected:
   struct SubcompactionState;
 
   void AggregateStatistics();
@@ -122,6 +120,13 @@ class CompactionJob {
   // Call compaction filter. Then iterate through input and compact the
   // kv-pairs
   void ProcessKeyValueCompaction(SubcompactionState* sub_compact);
+#ifndef ROCKSDB_LITE
+  // Runs the subcompaction on db_options_.compaction_service and adds the
+  // files it produced to the subcompaction's outputs. Returns kUseLocal if
+  // the subcompaction has to be run locally instead.
+  CompactionServiceJobStatus ProcessKeyValueCompactionWithCompactionService(
+      SubcompactionState* sub_compact);
+#endif  // !ROCKSDB_LITE
 
   Status FinishCompactionOutputFile(
       const Status& input_status, SubcompactionState* sub_compact,
@@ -143,6 +148,14 @@ class CompactionJob {
 
   void LogCompaction();
 
+  // Makes the compaction skip the input files whose keys are all deleted by
+  // range tombstones of its inputs, in the same snapshot stripe, so that
+  // they are dropped without being read.
+  void SkipInputsCoveredByRangeDeletions();
+
+  // Returns the path of the output table file with the given number
+  virtual std::string GetTableFileName(uint64_t file_number);
+
   int job_id_;
 
   struct CompactionState;
@@ -194,7 +207,9 @@ class CompactionJob {
   bool bottommost_level_;
   bool paranoid_file_checks_;
   bool measure_io_stats_;
-  // Stores the Slices that designate the boundaries for each subcompaction
+  // Stores the user keys that designate the boundaries for each
+  // subcompaction, and the Slices referring to them
+  std::vector<std::string> boundary_keys_;
   std::vector<Slice> boundaries_;
   // Stores the approx size of keys covered in the range of each subcompaction
   std::vector<uint64_t> sizes_;
@@ -203,4 +218,107 @@ class CompactionJob {
   IOStatus io_status_;
 };
 
+#ifndef ROCKSDB_LITE
+// The compaction job that the DB hands to the CompactionService, see
+// DB::OpenAndCompact()
+struct CompactionServiceInput {
+  std::string column_family_name;
+  // The DB and column family options, as option strings
+  std::string db_options;
+  std::string cf_options;
+
+  std::vector<SequenceNumber> snapshots;
+
+  // The numbers of the input files, on any level
+  std::vector<uint64_t> input_files;
+  int output_level = 0;
+
+  // The key range of the subcompaction; begin is inclusive, end exclusive
+  bool has_begin = false;
+  std::string begin;
+  bool has_end = false;
+  std::string end;
+
+  uint64_t approx_size = 0;
+
+  void EncodeTo(std::string* dst) const;
+  static Status DecodeFrom(const Slice& src, CompactionServiceInput* input);
+};
+
+// An output file of a CompactionServiceInput, as written by the worker
+struct CompactionServiceOutputFile {
+  // The name of the file in CompactionServiceResult::output_path
+  std::string file_name;
+  SequenceNumber smallest_seqno = 0;
+  SequenceNumber largest_seqno = 0;
+  // Encoded InternalKeys
+  std::string smallest_internal_key;
+  std::string largest_internal_key;
+  uint64_t oldest_ancester_time = 0;
+  uint64_t file_creation_time = 0;
+  uint64_t paranoid_hash = 0;
+  bool marked_for_compaction = false;
+  std::string file_checksum;
+  std::string file_checksum_func_name;
+};
+
+// The result of a CompactionServiceInput, returned by DB::OpenAndCompact()
+struct CompactionServiceResult {
+  Status status;
+  std::vector<CompactionServiceOutputFile> output_files;
+  int output_level = 0;
+
+  // The directory holding output_files
+  std::string output_path;
+
+  uint64_t num_output_records = 0;
+  uint64_t total_bytes = 0;
+
+  void EncodeTo(std::string* dst) const;
+  static Status DecodeFrom(const Slice& src, CompactionServiceResult* result);
+};
+
+// Runs a CompactionServiceInput on the worker. The compaction has a single
+// subcompaction and writes its output files into output_path; they are
+// described in the result instead of being installed.
+class CompactionServiceCompactionJob : private CompactionJob {
+ public:
+  CompactionServiceCompactionJob(
+      int job_id, Compaction* compaction, const ImmutableDBOptions& db_options,
+      const FileOptions& file_options, VersionSet* versions,
+      const std::atomic<bool>* shutting_down,
+      const SequenceNumber preserve_deletes_seqnum, LogBuffer* log_buffer,
+      FSDirectory* output_directory, Statistics* stats,
+      InstrumentedMutex* db_mutex, ErrorHandler* db_error_handler,
+      std::vector<SequenceNumber> existing_snapshots,
+      std::shared_ptr<Cache> table_cache, EventLogger* event_logger,
+      const std::string& dbname, CompactionJobStats* compaction_job_stats,
+      const std::shared_ptr<IOTracer>& io_tracer, const std::string& db_id,
+      const std::string& db_session_id, const std::string& output_path,
+      const CompactionServiceInput& compaction_service_input,
+      CompactionServiceResult* compaction_service_result);
+
+  // REQUIRED: mutex held
+  void Prepare();
+
+  // REQUIRED: mutex not held
+  Status Run();
+
+  // REQUIRED: mutex held
+  using CompactionJob::CleanupCompaction;
+
+  using CompactionJob::io_status;
+
+ private:
+  std::string GetTableFileName(uint64_t file_number) override;
+
+  const std::string output_path_;
+  const CompactionServiceInput& compaction_input_;
+  CompactionServiceResult* compaction_result_;
+  // The subcompaction bounds, pointing into compaction_input_
+  Slice begin_;
+  Slice end_;
+};
+#endif  // !ROCKSDB_LITE
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -26,6 +26,12 @@ uint64_t GetTotalFilesSize(const std::vector<FileMetaData*>& files) {
   }
   return total_size;
 }
+
+// Zone time bucket a file was written with, see
+// CompactionOptionsFIFO::zone_time_bucket_seconds
+uint64_t GetTimeBucket(FileMetaData* f, uint64_t bucket_seconds) {
+  return f->TryGetOldestAncesterTime() / bucket_seconds + 1;
+}
 }  // anonymous namespace
 
 bool FIFOCompactionPicker::NeedsCompaction(
@@ -142,8 +148,22 @@ Compaction* FIFOCompactionPicker::PickSizeCompaction(
           static_cast<size_t>(MultiplyCheckOverflow(
               static_cast<uint64_t>(mutable_cf_options.write_buffer_size),
               1.1));
+      // Merging files of different time buckets would keep the zones of the
+      // older bucket alive until the newer one expires
+      std::vector<FileMetaData*> bucket_files;
+      const uint64_t bucket_seconds =
+          mutable_cf_options.compaction_options_fifo.zone_time_bucket_seconds;
+      if (bucket_seconds > 0) {
+        uint64_t bucket = GetTimeBucket(level_files[0], bucket_seconds);
+        for (auto f : level_files) {
+          if (GetTimeBucket(f, bucket_seconds) != bucket) {
+            break;
+          }
+          bucket_files.push_back(f);
+        }
+      }
       if (FindIntraL0Compaction(
-              level_files,
+              bucket_seconds > 0 ? bucket_files : level_files,
               mutable_cf_options
                   .level0_file_num_compaction_trigger /* min_files_to_compact */
               ,
@@ -103,6 +103,12 @@ class LevelCompactionBuilder {
       const autovector<std::pair<int, FileMetaData*>>& level_files,
       bool compact_to_next_level);
 
+  // Zone space the file system gets back once the files in both inputs are
+  // deleted, per byte of input. Used to rank candidates when
+  // zone_aware_compaction_window is set.
+  double ZoneFreeScore(const CompactionInputFiles& start_inputs,
+                       const CompactionInputFiles& output_inputs) const;
+
   const std::string& cf_name_;
   VersionStorageInfo* vstorage_;
   SequenceNumber earliest_mem_seqno_;
@@ -427,6 +433,17 @@ bool LevelCompactionBuilder::PickFileToCompact() {
   const std::vector<FileMetaData*>& level_files =
       vstorage_->LevelFiles(start_level_);
 
+  // With a zone aware window, compare the first eligible candidates by the
+  // zone space they free and keep the best one. L0 files overlap, so the
+  // choice there is left to the L0 logic.
+  const size_t window =
+      start_level_ > 0 ? ioptions_.zone_aware_compaction_window : 0;
+  CompactionInputFiles best_inputs;
+  int best_index = -1;
+  double best_score = -1;
+  size_t nr_scored = 0;
+  unsigned int first_idx = 0;
+
   unsigned int cmp_idx;
   for (cmp_idx = vstorage_->NextCompactionIndex(start_level_);
        cmp_idx < file_size.size(); cmp_idx++) {
@@ -469,8 +486,30 @@ bool LevelCompactionBuilder::PickFileToCompact() {
       start_level_inputs_.clear();
       continue;
     }
-    base_index_ = index;
-    break;
+    if (window == 0) {
+      base_index_ = index;
+      break;
+    }
+    if (nr_scored == 0) {
+      first_idx = cmp_idx;
+    }
+    double score = ZoneFreeScore(start_level_inputs_, output_level_inputs);
+    if (score > best_score) {
+      best_score = score;
+      best_inputs = start_level_inputs_;
+      best_index = index;
+    }
+    start_level_inputs_.clear();
+    if (++nr_scored >= window) {
+      break;
+    }
+  }
+
+  if (nr_scored > 0) {
+    start_level_inputs_ = best_inputs;
+    base_index_ = best_index;
+    // Candidates passed over are still ahead in compaction_pri order
+    cmp_idx = first_idx;
   }
 
   // store where to start the iteration in the next call to PickCompaction
@@ -479,6 +518,24 @@ bool LevelCompactionBuilder::PickFileToCompact() {
   return start_level_inputs_.size() > 0;
 }
 
+double LevelCompactionBuilder::ZoneFreeScore(
+    const CompactionInputFiles& start_inputs,
+    const CompactionInputFiles& output_inputs) const {
+  std::vector<uint64_t> fnos;
+  uint64_t input_bytes = 0;
+  for (const auto* inputs : {&start_inputs, &output_inputs}) {
+    for (const auto* f : inputs->files) {
+      fnos.push_back(f->fd.GetNumber());
+      input_bytes += f->fd.GetFileSize();
+    }
+  }
+  if (input_bytes == 0) {
+    return 0;
+  }
+  return static_cast<double>(ioptions_.fs->GetZoneFreeBytes(fnos)) /
+         static_cast<double>(input_bytes);
+}
+
 bool LevelCompactionBuilder::PickIntraL0Compaction() {
   start_level_inputs_.clear();
   const std::vector<FileMetaData*>& level_files =
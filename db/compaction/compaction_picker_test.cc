@@ -500,6 +500,126 @@ TEST_F(CompactionPickerTest, CompactionUniversalIngestBehindReservedLevel) {
   // output level should be the one above the bottom-most
   ASSERT_EQ(1, compaction->output_level());
 }
+TEST_F(CompactionPickerTest, UniversalLazyLevelingMergesFullTier) {
+  const uint64_t kFileSize = 1000;
+  mutable_cf_options_.write_buffer_size = kFileSize;
+  mutable_cf_options_.level0_file_num_compaction_trigger = 10;
+  mutable_cf_options_.compaction_options_universal.runs_per_tier = 3;
+  UniversalCompactionPicker universal_compaction_picker(ioptions_, &icmp_);
+
+  NewVersionStorage(5, kCompactionStyleUniversal);
+  Add(0, 1U, "150", "200", kFileSize, 0, 500, 550);
+  Add(0, 2U, "201", "250", kFileSize, 0, 401, 450);
+  // Tier 1, which is not full
+  Add(3, 3U, "100", "300", kFileSize * 4, 0, 301, 350);
+  // Tier 4
+  Add(4, 4U, "100", "300", kFileSize * 100, 0, 101, 150);
+  UpdateVersionStorageInfo();
+  std::unique_ptr<Compaction> compaction(
+      universal_compaction_picker.PickCompaction(
+          cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+          &log_buffer_));
+  ASSERT_TRUE(compaction.get() == nullptr);
+
+  NewVersionStorage(5, kCompactionStyleUniversal);
+  Add(0, 1U, "150", "200", kFileSize, 0, 500, 550);
+  Add(0, 2U, "201", "250", kFileSize, 0, 401, 450);
+  Add(0, 5U, "260", "300", kFileSize, 0, 351, 400);
+  Add(3, 3U, "100", "300", kFileSize * 4, 0, 301, 350);
+  Add(4, 4U, "100", "300", kFileSize * 100, 0, 101, 150);
+  UpdateVersionStorageInfo();
+  ASSERT_TRUE(universal_compaction_picker.NeedsCompaction(vstorage_.get()));
+
+  // The full tier 0 becomes a sorted run of tier 1, above the one there.
+  compaction.reset(universal_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+      &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(CompactionReason::kUniversalSortedRunNum,
+            compaction->compaction_reason());
+  ASSERT_EQ(3U, compaction->num_input_files(0));
+  ASSERT_EQ(2, compaction->output_level());
+}
+
+TEST_F(CompactionPickerTest, UniversalLazyLevelingMergesIntoOldestRun) {
+  const uint64_t kFileSize = 1000;
+  mutable_cf_options_.write_buffer_size = kFileSize;
+  mutable_cf_options_.level0_file_num_compaction_trigger = 10;
+  mutable_cf_options_.compaction_options_universal.runs_per_tier = 3;
+  UniversalCompactionPicker universal_compaction_picker(ioptions_, &icmp_);
+
+  NewVersionStorage(5, kCompactionStyleUniversal);
+  Add(0, 1U, "150", "200", kFileSize, 0, 500, 550);
+  Add(0, 2U, "201", "250", kFileSize, 0, 401, 450);
+  Add(0, 5U, "260", "300", kFileSize, 0, 351, 400);
+  // Tier 1, so the full tier 0 is the one just below
+  Add(4, 4U, "100", "300", kFileSize * 5, 0, 101, 150);
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(
+      universal_compaction_picker.PickCompaction(
+          cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+          &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(CompactionReason::kUniversalSizeAmplification,
+            compaction->compaction_reason());
+  ASSERT_EQ(3U, compaction->num_input_files(0));
+  ASSERT_EQ(1U, compaction->num_input_files(4));
+  ASSERT_EQ(4, compaction->output_level());
+}
+
+TEST_F(CompactionPickerTest, UniversalIncrementalSizeAmp) {
+  const uint64_t kFileSize = 1000;
+  mutable_cf_options_.level0_file_num_compaction_trigger = 2;
+  mutable_cf_options_.max_compaction_bytes = kFileSize * 14 / 5;
+  mutable_cf_options_.compaction_options_universal.incremental = true;
+  UniversalCompactionPicker universal_compaction_picker(ioptions_, &icmp_);
+
+  NewVersionStorage(5, kCompactionStyleUniversal);
+  Add(3, 1U, "100", "149", kFileSize, 0, 201, 250);
+  Add(3, 2U, "150", "199", kFileSize, 0, 201, 250);
+  Add(3, 3U, "200", "249", kFileSize, 0, 201, 250);
+  Add(3, 4U, "250", "299", kFileSize, 0, 201, 250);
+  Add(4, 5U, "100", "149", kFileSize * 2 / 5, 0, 101, 150);
+  Add(4, 6U, "150", "199", kFileSize * 2 / 5, 0, 101, 150);
+  Add(4, 7U, "200", "249", kFileSize * 2 / 5, 0, 101, 150);
+  Add(4, 8U, "250", "299", kFileSize * 2 / 5, 0, 101, 150);
+  UpdateVersionStorageInfo();
+
+  // A slice of two files of each level, half of max_compaction_bytes
+  std::unique_ptr<Compaction> compaction(
+      universal_compaction_picker.PickCompaction(
+          cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+          &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(CompactionReason::kUniversalSizeAmplification,
+            compaction->compaction_reason());
+  ASSERT_EQ(3, compaction->start_level());
+  ASSERT_EQ(4, compaction->output_level());
+  ASSERT_EQ(2U, compaction->num_input_files(0));
+  ASSERT_EQ(1U, compaction->input(0, 0)->fd.GetNumber());
+  ASSERT_EQ(2U, compaction->input(0, 1)->fd.GetNumber());
+  ASSERT_EQ(2U, compaction->num_input_files(1));
+  ASSERT_EQ(5U, compaction->input(1, 0)->fd.GetNumber());
+  ASSERT_EQ(6U, compaction->input(1, 1)->fd.GetNumber());
+
+  // Without it, all the sorted runs are compacted
+  mutable_cf_options_.compaction_options_universal.incremental = false;
+  NewVersionStorage(5, kCompactionStyleUniversal);
+  Add(3, 1U, "100", "149", kFileSize, 0, 201, 250);
+  Add(3, 2U, "150", "199", kFileSize, 0, 201, 250);
+  Add(3, 3U, "200", "249", kFileSize, 0, 201, 250);
+  Add(3, 4U, "250", "299", kFileSize, 0, 201, 250);
+  Add(4, 5U, "100", "299", kFileSize, 0, 101, 150);
+  UpdateVersionStorageInfo();
+  compaction.reset(universal_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+      &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(4U, compaction->num_input_files(0));
+  ASSERT_EQ(1U, compaction->num_input_files(1));
+}
+
 // Tests if the files can be trivially moved in multi level
 // universal compaction when allow_trivial_move option is set
 // In this test as the input files overlaps, they cannot
@@ -791,6 +911,44 @@ TEST_F(CompactionPickerTest, CompactionPriMinOverlapping1) {
   ASSERT_GE(uint64_t{55000000}, compaction->OutputFilePreallocationSize());
 }
 
+TEST_F(CompactionPickerTest, CompactionPriByReadHotness) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  ioptions_.compaction_pri = kByReadHotness;
+  mutable_cf_options_.target_file_size_base = 100000000000;
+  mutable_cf_options_.target_file_size_multiplier = 10;
+  mutable_cf_options_.max_bytes_for_level_base = 10 * 1024 * 1024;
+  mutable_cf_options_.RefreshDerivedOptions(ioptions_);
+
+  Add(2, 6U, "150", "179", 50000000U);
+  files_.back()->stats.num_reads_sampled = 3000;
+  Add(2, 7U, "180", "220", 60000000U);
+  Add(2, 8U, "321", "400", 50000000U);
+  files_.back()->stats.num_reads_sampled = 2000;
+  Add(2, 9U, "721", "800", 50000000U);
+  files_.back()->stats.num_reads_sampled = 2500;
+
+  Add(3, 26U, "150", "170", 260000000U);
+  Add(3, 30U, "750", "900", 260000000U);
+  Add(4, 40U, "700", "900", 260000000U);
+  UpdateVersionStorageInfo();
+
+  // File 9 is read less than file 6, but a read of its range checks three
+  // files rather than two.
+  ASSERT_EQ(4U, vstorage_->FilesByCompactionPri(2).size());
+  ASSERT_EQ(3, vstorage_->FilesByCompactionPri(2)[0]);
+  ASSERT_EQ(0, vstorage_->FilesByCompactionPri(2)[1]);
+  ASSERT_EQ(2, vstorage_->FilesByCompactionPri(2)[2]);
+  // The file that is not read comes last.
+  ASSERT_EQ(1, vstorage_->FilesByCompactionPri(2)[3]);
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+      &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(1U, compaction->num_input_files(0));
+  ASSERT_EQ(9U, compaction->input(0, 0)->fd.GetNumber());
+}
+
 TEST_F(CompactionPickerTest, CompactionPriMinOverlapping2) {
   NewVersionStorage(6, kCompactionStyleLevel);
   ioptions_.compaction_pri = kMinOverlappingRatio;
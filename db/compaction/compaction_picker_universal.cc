@@ -87,6 +87,23 @@ class UniversalCompactionBuilder {
   // Pick Universal compaction to limit space amplification.
   Compaction* PickCompactionToReduceSizeAmp();
 
+  // Pick a key range slice of the second oldest sorted run, of about
+  // max_compaction_bytes / 2, to merge into the oldest one. Of the slices,
+  // the one with the lowest fanout, the bytes of the oldest sorted run per
+  // byte of the second oldest one, is picked, if lower than fanout_threshold.
+  // See CompactionOptionsUniversal::incremental.
+  Compaction* PickIncrementalForReduceSizeAmp(double fanout_threshold);
+
+  // Pick a lazy leveling compaction of the first tier that is full. See
+  // CompactionOptionsUniversal::runs_per_tier.
+  Compaction* PickLazyLevelingCompaction();
+
+  // Form a compaction of the sorted runs from start_index to
+  // first_index_after, exclusive.
+  Compaction* PickCompactionForSortedRuns(size_t start_index,
+                                          size_t first_index_after,
+                                          CompactionReason compaction_reason);
+
   Compaction* PickDeleteTriggeredCompaction();
 
   // Form a compaction from the sorted run indicated by start_index to the
@@ -361,11 +378,11 @@ Compaction* UniversalCompactionBuilder::PickCompaction() {
   score_ = vstorage_->CompactionScore(kLevel0);
   sorted_runs_ = CalculateSortedRuns(*vstorage_);
 
+  const int trigger = UniversalCompactionTrigger(mutable_cf_options_);
   if (sorted_runs_.size() == 0 ||
       (vstorage_->FilesMarkedForPeriodicCompaction().empty() &&
        vstorage_->FilesMarkedForCompaction().empty() &&
-       sorted_runs_.size() < (unsigned int)mutable_cf_options_
-                                 .level0_file_num_compaction_trigger)) {
+       sorted_runs_.size() < static_cast<size_t>(trigger))) {
     ROCKS_LOG_BUFFER(log_buffer_, "[%s] Universal: nothing to do\n",
                      cf_name_.c_str());
     TEST_SYNC_POINT_CALLBACK(
@@ -387,11 +404,16 @@ Compaction* UniversalCompactionBuilder::PickCompaction() {
   }
 
   // Check for size amplification.
-  if (c == nullptr &&
-      sorted_runs_.size() >=
-          static_cast<size_t>(
-              mutable_cf_options_.level0_file_num_compaction_trigger)) {
-    if ((c = PickCompactionToReduceSizeAmp()) != nullptr) {
+  if (c == nullptr && sorted_runs_.size() >= static_cast<size_t>(trigger)) {
+    if (mutable_cf_options_.compaction_options_universal.runs_per_tier != 0) {
+      // Lazy leveling bounds the size amplification by leveling the oldest
+      // sorted run, and replaces the size ratio rule with the tiers.
+      if ((c = PickLazyLevelingCompaction()) != nullptr) {
+        ROCKS_LOG_BUFFER(log_buffer_,
+                         "[%s] Universal: compacting for lazy leveling\n",
+                         cf_name_.c_str());
+      }
+    } else if ((c = PickCompactionToReduceSizeAmp()) != nullptr) {
       ROCKS_LOG_BUFFER(log_buffer_, "[%s] Universal: compacting for size amp\n",
                        cf_name_.c_str());
     } else {
@@ -404,36 +426,35 @@ Compaction* UniversalCompactionBuilder::PickCompaction() {
         ROCKS_LOG_BUFFER(log_buffer_,
                          "[%s] Universal: compacting for size ratio\n",
                          cf_name_.c_str());
-      } else {
-        // Size amplification and file size ratios are within configured limits.
-        // If max read amplification is exceeding configured limits, then force
-        // compaction without looking at filesize ratios and try to reduce
-        // the number of files to fewer than level0_file_num_compaction_trigger.
-        // This is guaranteed by NeedsCompaction()
-        assert(sorted_runs_.size() >=
-               static_cast<size_t>(
-                   mutable_cf_options_.level0_file_num_compaction_trigger));
-        // Get the total number of sorted runs that are not being compacted
-        int num_sr_not_compacted = 0;
-        for (size_t i = 0; i < sorted_runs_.size(); i++) {
-          if (sorted_runs_[i].being_compacted == false) {
-            num_sr_not_compacted++;
-          }
+      }
+    }
+    if (c == nullptr) {
+      // Size amplification and file size ratios are within configured limits.
+      // If max read amplification is exceeding configured limits, then force
+      // compaction without looking at filesize ratios and try to reduce
+      // the number of files to fewer than level0_file_num_compaction_trigger.
+      // This is guaranteed by NeedsCompaction()
+      assert(sorted_runs_.size() >= static_cast<size_t>(trigger));
+      // Get the total number of sorted runs that are not being compacted
+      int num_sr_not_compacted = 0;
+      for (size_t i = 0; i < sorted_runs_.size(); i++) {
+        if (sorted_runs_[i].being_compacted == false) {
+          num_sr_not_compacted++;
         }
+      }
 
-        // The number of sorted runs that are not being compacted is greater
-        // than the maximum allowed number of sorted runs
-        if (num_sr_not_compacted >
-            mutable_cf_options_.level0_file_num_compaction_trigger) {
-          unsigned int num_files =
-              num_sr_not_compacted -
-              mutable_cf_options_.level0_file_num_compaction_trigger + 1;
-          if ((c = PickCompactionToReduceSortedRuns(UINT_MAX, num_files)) !=
-              nullptr) {
-            ROCKS_LOG_BUFFER(log_buffer_,
-                             "[%s] Universal: compacting for file num -- %u\n",
-                             cf_name_.c_str(), num_files);
-          }
+      // The number of sorted runs that are not being compacted is greater
+      // than the maximum allowed number of sorted runs
+      if (num_sr_not_compacted >
+          mutable_cf_options_.level0_file_num_compaction_trigger) {
+        unsigned int num_files =
+            num_sr_not_compacted -
+            mutable_cf_options_.level0_file_num_compaction_trigger + 1;
+        if ((c = PickCompactionToReduceSortedRuns(UINT_MAX, num_files)) !=
+            nullptr) {
+          ROCKS_LOG_BUFFER(log_buffer_,
+                           "[%s] Universal: compacting for file num -- %u\n",
+                           cf_name_.c_str(), num_files);
         }
       }
     }
@@ -646,7 +667,20 @@ Compaction* UniversalCompactionBuilder::PickCompactionToReduceSortedRuns(
   if (!done || candidate_count <= 1) {
     return nullptr;
   }
-  size_t first_index_after = start_index + candidate_count;
+
+  CompactionReason compaction_reason;
+  if (max_number_of_files_to_compact == UINT_MAX) {
+    compaction_reason = CompactionReason::kUniversalSizeRatio;
+  } else {
+    compaction_reason = CompactionReason::kUniversalSortedRunNum;
+  }
+  return PickCompactionForSortedRuns(
+      start_index, start_index + candidate_count, compaction_reason);
+}
+
+Compaction* UniversalCompactionBuilder::PickCompactionForSortedRuns(
+    size_t start_index, size_t first_index_after,
+    CompactionReason compaction_reason) {
   // Compression is enabled if files compacted earlier already reached
   // size ratio of compression.
   bool enable_compression = true;
@@ -712,12 +746,6 @@ Compaction* UniversalCompactionBuilder::PickCompactionToReduceSortedRuns(
                      cf_name_.c_str(), file_num_buf);
   }
 
-  CompactionReason compaction_reason;
-  if (max_number_of_files_to_compact == UINT_MAX) {
-    compaction_reason = CompactionReason::kUniversalSizeRatio;
-  } else {
-    compaction_reason = CompactionReason::kUniversalSortedRunNum;
-  }
   return new Compaction(
       vstorage_, ioptions_, mutable_cf_options_, mutable_db_options_,
       std::move(inputs), output_level,
@@ -732,6 +760,80 @@ Compaction* UniversalCompactionBuilder::PickCompactionToReduceSortedRuns(
       score_, false /* deletion_compaction */, compaction_reason);
 }
 
+// Group the sorted runs other than the oldest one into tiers by size, and
+// compact the newest runs_per_tier consecutive sorted runs of the same tier.
+// They are merged into one sorted run of the next tier, unless that is the
+// tier of the oldest sorted run or the one below, in which case they are
+// merged into the oldest sorted run together with all the sorted runs in
+// between.
+Compaction* UniversalCompactionBuilder::PickLazyLevelingCompaction() {
+  const uint64_t runs_per_tier = std::max(
+      mutable_cf_options_.compaction_options_universal.runs_per_tier, 2U);
+  const uint64_t base_size =
+      std::max<uint64_t>(mutable_cf_options_.write_buffer_size, 1);
+  auto tier_of = [&](const SortedRun& sr) {
+    int tier = 0;
+    uint64_t tier_limit = base_size * runs_per_tier;
+    while (sr.size >= tier_limit &&
+           tier_limit <= port::kMaxUint64 / runs_per_tier) {
+      tier_limit *= runs_per_tier;
+      tier++;
+    }
+    return tier;
+  };
+
+  if (sorted_runs_.size() < 2) {
+    return nullptr;
+  }
+  const size_t last_index = sorted_runs_.size() - 1;
+  const int last_tier = tier_of(sorted_runs_[last_index]);
+
+  size_t start_index = 0;
+  size_t count = 0;
+  int tier = -1;
+  for (size_t i = 0; i < last_index; i++) {
+    const SortedRun& sr = sorted_runs_[i];
+    if (sr.being_compacted) {
+      count = 0;
+      tier = -1;
+      continue;
+    }
+    int sr_tier = tier_of(sr);
+    if (count == 0 || sr_tier != tier) {
+      start_index = i;
+      count = 0;
+      tier = sr_tier;
+    }
+    if (++count < runs_per_tier) {
+      continue;
+    }
+
+    char file_num_buf[kFormatFileNumberBufSize];
+    sorted_runs_[start_index].Dump(file_num_buf, sizeof(file_num_buf), true);
+    if (tier + 1 < last_tier) {
+      ROCKS_LOG_BUFFER(log_buffer_,
+                       "[%s] Universal: tier %d is full from %s[%" PRIu64 "]",
+                       cf_name_.c_str(), tier, file_num_buf,
+                       static_cast<uint64_t>(start_index));
+      return PickCompactionForSortedRuns(
+          start_index, i + 1, CompactionReason::kUniversalSortedRunNum);
+    }
+    for (size_t j = i + 1; j <= last_index; j++) {
+      if (sorted_runs_[j].being_compacted) {
+        return nullptr;
+      }
+    }
+    ROCKS_LOG_BUFFER(log_buffer_,
+                     "[%s] Universal: tier %d is full from %s[%" PRIu64
+                     "], merging it into the oldest sorted run",
+                     cf_name_.c_str(), tier, file_num_buf,
+                     static_cast<uint64_t>(start_index));
+    return PickCompactionToOldest(
+        start_index, CompactionReason::kUniversalSizeAmplification);
+  }
+  return nullptr;
+}
+
 // Look at overall size amplification. If size amplification
 // exceeeds the configured value, then do a compaction
 // of the candidate files all the way upto the earliest
@@ -818,10 +920,187 @@ Compaction* UniversalCompactionBuilder::PickCompactionToReduceSizeAmp() {
         " earliest-file-size %" PRIu64,
         cf_name_.c_str(), candidate_size, earliest_file_size);
   }
+
+  // A slice only merges the second oldest sorted run, so it is picked while
+  // its fanout is not much above the one of the full compaction
+  if (mutable_cf_options_.compaction_options_universal.incremental) {
+    double fanout_threshold = static_cast<double>(earliest_file_size) /
+                              static_cast<double>(candidate_size) * 1.8;
+    Compaction* c = PickIncrementalForReduceSizeAmp(fanout_threshold);
+    if (c != nullptr) {
+      return c;
+    }
+  }
   return PickCompactionToOldest(start_index,
                                 CompactionReason::kUniversalSizeAmplification);
 }
 
+Compaction* UniversalCompactionBuilder::PickIncrementalForReduceSizeAmp(
+    double fanout_threshold) {
+  assert(sorted_runs_.size() >= 2);
+  const int second_last_level = sorted_runs_[sorted_runs_.size() - 2].level;
+  const int output_level = sorted_runs_.back().level;
+  if (second_last_level == 0) {
+    // An L0 file can not be split
+    return nullptr;
+  }
+  const std::vector<FileMetaData*>& files =
+      vstorage_->LevelFiles(second_last_level);
+  const std::vector<FileMetaData*>& bottom_files =
+      vstorage_->LevelFiles(output_level);
+  assert(!files.empty());
+  assert(!bottom_files.empty());
+
+  // A window of the files of the second oldest sorted run slides over it,
+  // growing until it reaches half of max_compaction_bytes with the files of
+  // the oldest one it overlaps, which leaves room for the clean cut
+  // expansions, and then shrinking from its start.
+  const uint64_t slice_size = mutable_cf_options_.max_compaction_bytes / 2;
+  size_t picked_start = 0;
+  size_t picked_end = 0;
+  double picked_fanout = fanout_threshold;
+  size_t start = 0;
+  size_t bottom_start = 0;
+  size_t bottom_end = 0;
+  uint64_t size = 0;
+  uint64_t bottom_size = 0;
+  // Whether bottom_files[bottom_end] is in bottom_size already
+  bool bottom_end_counted = false;
+  for (size_t end = 0; end < files.size(); end++) {
+    const FileMetaData* end_file = files[end];
+
+    // The files of the oldest sorted run before end_file
+    size_t skipped = 0;
+    while (bottom_end < bottom_files.size() &&
+           icmp_->Compare(bottom_files[bottom_end]->largest,
+                          end_file->smallest) < 0) {
+      if (!bottom_end_counted) {
+        bottom_size += bottom_files[bottom_end]->fd.GetFileSize();
+      }
+      bottom_end++;
+      bottom_end_counted = false;
+      skipped++;
+    }
+    if (skipped > 1) {
+      // A file of the oldest sorted run is in the gap between two files,
+      // which does not need to be compacted, so a new window starts
+      start = end;
+    }
+    if (start == end) {
+      size = 0;
+      bottom_size = 0;
+      bottom_start = bottom_end;
+      bottom_end_counted = false;
+    }
+    size += end_file->fd.GetFileSize();
+
+    // The files of the oldest sorted run end_file overlaps
+    while (bottom_end < bottom_files.size() &&
+           icmp_->Compare(bottom_files[bottom_end]->smallest,
+                          end_file->largest) < 0) {
+      if (!bottom_end_counted) {
+        bottom_size += bottom_files[bottom_end]->fd.GetFileSize();
+        bottom_end_counted = true;
+      }
+      if (icmp_->Compare(bottom_files[bottom_end]->largest,
+                         end_file->largest) > 0) {
+        // It may overlap the next file too
+        break;
+      }
+      bottom_end++;
+      bottom_end_counted = false;
+    }
+
+    if ((size + bottom_size > slice_size || end + 1 == files.size()) &&
+        size > 0) {
+      double fanout =
+          static_cast<double>(bottom_size) / static_cast<double>(size);
+      if (fanout < picked_fanout) {
+        picked_start = start;
+        picked_end = end;
+        picked_fanout = fanout;
+      }
+      while (size + bottom_size > slice_size && start <= end) {
+        size -= files[start]->fd.GetFileSize();
+        start++;
+        if (start < files.size()) {
+          while (bottom_start < bottom_end &&
+                 icmp_->Compare(bottom_files[bottom_start]->largest,
+                                files[start]->smallest) < 0) {
+            bottom_size -= bottom_files[bottom_start]->fd.GetFileSize();
+            bottom_start++;
+          }
+        }
+      }
+    }
+  }
+  if (picked_fanout >= fanout_threshold) {
+    return nullptr;
+  }
+
+  CompactionInputFiles second_last_inputs;
+  second_last_inputs.level = second_last_level;
+  for (size_t i = picked_start; i <= picked_end; i++) {
+    if (files[i]->being_compacted) {
+      return nullptr;
+    }
+    second_last_inputs.files.push_back(files[i]);
+  }
+  if (!picker_->ExpandInputsToCleanCut(cf_name_, vstorage_,
+                                       &second_last_inputs)) {
+    return nullptr;
+  }
+  CompactionInputFiles bottom_inputs;
+  bottom_inputs.level = output_level;
+  int parent_index = -1;
+  if (!picker_->SetupOtherInputs(cf_name_, mutable_cf_options_, vstorage_,
+                                 &second_last_inputs, &bottom_inputs,
+                                 &parent_index, /*base_index=*/-1)) {
+    return nullptr;
+  }
+
+  std::vector<CompactionInputFiles> inputs(output_level - second_last_level +
+                                           1);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    inputs[i].level = second_last_level + static_cast<int>(i);
+  }
+  inputs.front().files = second_last_inputs.files;
+  inputs.back().files = bottom_inputs.files;
+  if (picker_->FilesRangeOverlapWithCompaction(inputs, output_level)) {
+    return nullptr;
+  }
+
+  uint64_t slice_bytes = 0;
+  for (const auto& level_inputs : inputs) {
+    for (const auto* f : level_inputs.files) {
+      slice_bytes += f->fd.GetFileSize();
+    }
+  }
+  ROCKS_LOG_BUFFER(log_buffer_,
+                   "[%s] Universal: size amp picking a slice of %" PRIu64
+                   " bytes of levels %d and %d, fanout %.2f",
+                   cf_name_.c_str(), slice_bytes, second_last_level,
+                   output_level, picked_fanout);
+
+  // The slices are placed as a full compaction would be
+  uint32_t path_id = GetPathId(
+      ioptions_, mutable_cf_options_,
+      sorted_runs_[sorted_runs_.size() - 2].size + sorted_runs_.back().size);
+  return new Compaction(
+      vstorage_, ioptions_, mutable_cf_options_, mutable_db_options_,
+      std::move(inputs), output_level,
+      MaxFileSizeForLevel(mutable_cf_options_, output_level,
+                          kCompactionStyleUniversal),
+      LLONG_MAX, path_id,
+      GetCompressionType(ioptions_, vstorage_, mutable_cf_options_,
+                         output_level, 1, true /* enable_compression */),
+      GetCompressionOptions(mutable_cf_options_, vstorage_, output_level,
+                            true /* enable_compression */),
+      /* max_subcompactions */ 0, /* grandparents */ {}, /* is manual */ false,
+      score_, false /* deletion_compaction */,
+      CompactionReason::kUniversalSizeAmplification);
+}
+
 // Pick files marked for compaction. Typically, files are marked by
 // CompactOnDeleteCollector due to the presence of tombstones.
 Compaction* UniversalCompactionBuilder::PickDeleteTriggeredCompaction() {
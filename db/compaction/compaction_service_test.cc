@@ -0,0 +1,261 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <map>
+
+#include "db/compaction/compaction_job.h"
+#include "db/db_test_util.h"
+#include "port/stack_trace.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+#ifndef ROCKSDB_LITE
+// Runs every job right away with DB::OpenAndCompact() on a directory of the
+// DB, as a worker on another host would
+class MyTestCompactionService : public CompactionService {
+ public:
+  MyTestCompactionService(const std::string& db_path, const Options& options)
+      : db_path_(db_path), options_(options) {}
+
+  const char* Name() const override { return "MyTestCompactionService"; }
+
+  CompactionServiceJobStatus Start(const std::string& compaction_service_input,
+                                   uint64_t job_id) override {
+    MutexLock l(&mutex_);
+    if (start_status_ != CompactionServiceJobStatus::kSuccess) {
+      return start_status_;
+    }
+    jobs_.emplace(job_id, compaction_service_input);
+    return CompactionServiceJobStatus::kSuccess;
+  }
+
+  CompactionServiceJobStatus WaitForComplete(
+      uint64_t job_id, std::string* compaction_service_result) override {
+    std::string compaction_input;
+    {
+      MutexLock l(&mutex_);
+      auto it = jobs_.find(job_id);
+      if (it == jobs_.end()) {
+        return CompactionServiceJobStatus::kFailure;
+      }
+      compaction_input = std::move(it->second);
+      jobs_.erase(it);
+    }
+
+    CompactionServiceOptionsOverride options_override;
+    options_override.env = options_.env;
+    options_override.comparator = options_.comparator;
+    options_override.table_factory = options_.table_factory;
+    Status s = DB::OpenAndCompact(db_path_, db_path_ + "/" + ToString(job_id),
+                                  compaction_input, compaction_service_result,
+                                  options_override);
+    if (!s.ok()) {
+      return CompactionServiceJobStatus::kFailure;
+    }
+    compaction_num_.fetch_add(1);
+    return CompactionServiceJobStatus::kSuccess;
+  }
+
+  int GetCompactionNum() { return compaction_num_.load(); }
+
+  void OverrideStartStatus(CompactionServiceJobStatus s) {
+    MutexLock l(&mutex_);
+    start_status_ = s;
+  }
+
+ private:
+  port::Mutex mutex_;
+  std::atomic_int compaction_num_{0};
+  std::map<uint64_t, std::string> jobs_;
+  const std::string db_path_;
+  Options options_;
+  CompactionServiceJobStatus start_status_ =
+      CompactionServiceJobStatus::kSuccess;
+};
+
+class CompactionServiceTest : public DBTestBase {
+ public:
+  CompactionServiceTest()
+      : DBTestBase("/compaction_service_test", /*env_do_fsync=*/true) {}
+
+ protected:
+  Options ServiceOptions() {
+    Options options = CurrentOptions();
+    options.env = env_;
+    options.disable_auto_compactions = true;
+    service_ = std::make_shared<MyTestCompactionService>(dbname_, options);
+    options.compaction_service = service_;
+    return options;
+  }
+
+  void GenerateTestData() {
+    for (int i = 0; i < 20; i++) {
+      for (int j = 0; j < 10; j++) {
+        int key_id = i * 10 + j;
+        ASSERT_OK(Put(Key(key_id), "value" + ToString(key_id)));
+      }
+      ASSERT_OK(Flush());
+    }
+    for (int i = 0; i < 10; i++) {
+      for (int j = 0; j < 10; j++) {
+        int key_id = i * 20 + j * 2;
+        ASSERT_OK(Put(Key(key_id), "value_new" + ToString(key_id)));
+      }
+      ASSERT_OK(Flush());
+    }
+  }
+
+  void VerifyTestData() {
+    for (int i = 0; i < 200; i++) {
+      auto result = Get(Key(i));
+      if (i % 2) {
+        ASSERT_EQ(result, "value" + ToString(i));
+      } else {
+        ASSERT_EQ(result, "value_new" + ToString(i));
+      }
+    }
+  }
+
+  std::shared_ptr<MyTestCompactionService> service_;
+};
+
+TEST_F(CompactionServiceTest, BasicCompactions) {
+  Options options = ServiceOptions();
+  DestroyAndReopen(options);
+  GenerateTestData();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(service_->GetCompactionNum(), 0);
+  ASSERT_EQ("0,1", FilesPerLevel());
+  VerifyTestData();
+
+  // The installed files survive a reopen
+  Reopen(options);
+  VerifyTestData();
+}
+
+TEST_F(CompactionServiceTest, AutoCompactions) {
+  Options options = ServiceOptions();
+  options.disable_auto_compactions = false;
+  options.level0_file_num_compaction_trigger = 4;
+  options.max_subcompactions = 4;
+  DestroyAndReopen(options);
+  GenerateTestData();
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+
+  ASSERT_GT(service_->GetCompactionNum(), 0);
+  VerifyTestData();
+}
+
+TEST_F(CompactionServiceTest, ParanoidFileChecks) {
+  Options options = ServiceOptions();
+  options.paranoid_file_checks = true;
+  DestroyAndReopen(options);
+  GenerateTestData();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(service_->GetCompactionNum(), 0);
+  VerifyTestData();
+}
+
+TEST_F(CompactionServiceTest, FailedToStart) {
+  Options options = ServiceOptions();
+  DestroyAndReopen(options);
+  GenerateTestData();
+
+  service_->OverrideStartStatus(CompactionServiceJobStatus::kFailure);
+  Status s = db_->CompactRange(CompactRangeOptions(), nullptr, nullptr);
+  ASSERT_TRUE(s.IsIncomplete());
+  ASSERT_EQ(service_->GetCompactionNum(), 0);
+}
+
+TEST_F(CompactionServiceTest, UseLocal) {
+  Options options = ServiceOptions();
+  DestroyAndReopen(options);
+  GenerateTestData();
+
+  service_->OverrideStartStatus(CompactionServiceJobStatus::kUseLocal);
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(service_->GetCompactionNum(), 0);
+  ASSERT_EQ("0,1", FilesPerLevel());
+  VerifyTestData();
+}
+
+TEST_F(CompactionServiceTest, SerializeInputAndResult) {
+  CompactionServiceInput input;
+  input.column_family_name = "cf";
+  input.db_options = "max_open_files=-1;";
+  input.cf_options = "num_levels=4;";
+  input.snapshots = {10, 20};
+  input.input_files = {7, 8, 9};
+  input.output_level = 3;
+  input.has_begin = true;
+  input.begin = "a";
+  input.approx_size = 1234;
+  std::string encoded;
+  input.EncodeTo(&encoded);
+
+  CompactionServiceInput decoded_input;
+  ASSERT_OK(CompactionServiceInput::DecodeFrom(encoded, &decoded_input));
+  ASSERT_EQ(input.column_family_name, decoded_input.column_family_name);
+  ASSERT_EQ(input.db_options, decoded_input.db_options);
+  ASSERT_EQ(input.cf_options, decoded_input.cf_options);
+  ASSERT_EQ(input.snapshots, decoded_input.snapshots);
+  ASSERT_EQ(input.input_files, decoded_input.input_files);
+  ASSERT_EQ(input.output_level, decoded_input.output_level);
+  ASSERT_TRUE(decoded_input.has_begin);
+  ASSERT_EQ("a", decoded_input.begin);
+  ASSERT_FALSE(decoded_input.has_end);
+  ASSERT_EQ(input.approx_size, decoded_input.approx_size);
+  ASSERT_TRUE(CompactionServiceInput::DecodeFrom(
+                  Slice(encoded.data(), encoded.size() - 1), &decoded_input)
+                  .IsCorruption());
+
+  CompactionServiceResult result;
+  result.status = Status::Incomplete("paused");
+  CompactionServiceOutputFile file;
+  file.file_name = "000012.sst";
+  file.smallest_seqno = 5;
+  file.largest_seqno = 6;
+  file.smallest_internal_key = "key1";
+  file.largest_internal_key = "key2";
+  file.paranoid_hash = 42;
+  file.marked_for_compaction = true;
+  result.output_files.push_back(file);
+  result.output_level = 3;
+  result.output_path = "/tmp/output";
+  result.num_output_records = 100;
+  result.total_bytes = 4096;
+  encoded.clear();
+  result.EncodeTo(&encoded);
+
+  CompactionServiceResult decoded_result;
+  ASSERT_OK(CompactionServiceResult::DecodeFrom(encoded, &decoded_result));
+  ASSERT_TRUE(decoded_result.status.IsIncomplete());
+  ASSERT_EQ(result.status.ToString(), decoded_result.status.ToString());
+  ASSERT_EQ(1U, decoded_result.output_files.size());
+  const auto& decoded_file = decoded_result.output_files[0];
+  ASSERT_EQ(file.file_name, decoded_file.file_name);
+  ASSERT_EQ(file.smallest_seqno, decoded_file.smallest_seqno);
+  ASSERT_EQ(file.largest_seqno, decoded_file.largest_seqno);
+  ASSERT_EQ(file.smallest_internal_key, decoded_file.smallest_internal_key);
+  ASSERT_EQ(file.largest_internal_key, decoded_file.largest_internal_key);
+  ASSERT_EQ(file.paranoid_hash, decoded_file.paranoid_hash);
+  ASSERT_TRUE(decoded_file.marked_for_compaction);
+  ASSERT_EQ(result.output_level, decoded_result.output_level);
+  ASSERT_EQ(result.output_path, decoded_result.output_path);
+  ASSERT_EQ(result.num_output_records, decoded_result.num_output_records);
+  ASSERT_EQ(result.total_bytes, decoded_result.total_bytes);
+}
+#endif  // ROCKSDB_LITE
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
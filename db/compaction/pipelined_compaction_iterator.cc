@@ -0,0 +1,167 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/compaction/pipelined_compaction_iterator.h"
+
+#include "test_util/sync_point.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+PipelinedCompactionIterator::PipelinedCompactionIterator(
+    CompactionIterator* c_iter, InternalIterator* input,
+    const Comparator* ucmp, const Slice* end, bool pipelined, Env* env,
+    std::function<void()> on_batch)
+    : c_iter_(c_iter),
+      input_(input),
+      ucmp_(ucmp),
+      end_(end),
+      pipelined_(pipelined),
+      env_(env),
+      on_batch_(std::move(on_batch)),
+      cv_(&mu_) {
+  assert(c_iter_ != nullptr);
+  assert(input_ != nullptr);
+}
+
+PipelinedCompactionIterator::~PipelinedCompactionIterator() { Finish(); }
+
+void PipelinedCompactionIterator::SeekToFirst() {
+  if (!pipelined_) {
+    c_iter_->SeekToFirst();
+    return;
+  }
+  assert(!merge_thread_.joinable());
+  for (size_t i = 0; i < kNumBatches; i++) {
+    free_batches_.emplace_back(new Batch());
+  }
+  merge_thread_ = port::Thread(&PipelinedCompactionIterator::MergeThread, this);
+  NextBatch();
+}
+
+void PipelinedCompactionIterator::Next() {
+  if (!pipelined_) {
+    c_iter_->Next();
+    return;
+  }
+  assert(valid_);
+  if (++pos_ < current_->entries.size()) {
+    UpdateCurrent();
+  } else {
+    NextBatch();
+  }
+}
+
+void PipelinedCompactionIterator::Finish() {
+  if (!merge_thread_.joinable()) {
+    return;
+  }
+  {
+    MutexLock l(&mu_);
+    stop_ = true;
+    cv_.SignalAll();
+  }
+  merge_thread_.join();
+  valid_ = false;
+}
+
+void PipelinedCompactionIterator::MergeThread() {
+  const uint64_t start_cpu_nanos = env_->NowCPUNanos();
+  c_iter_->SeekToFirst();
+  bool done = false;
+  while (!done) {
+    std::unique_ptr<Batch> batch;
+    {
+      MutexLock l(&mu_);
+      while (free_batches_.empty() && !stop_) {
+        cv_.Wait();
+      }
+      if (stop_) {
+        break;
+      }
+      batch = std::move(free_batches_.front());
+      free_batches_.pop_front();
+    }
+
+    batch->data.clear();
+    batch->entries.clear();
+    while (c_iter_->Valid() && batch->data.size() < kBatchBytes) {
+      const Slice& user_key = c_iter_->user_key();
+      if (end_ != nullptr && ucmp_->Compare(user_key, *end_) >= 0) {
+        done = true;
+        break;
+      }
+      const Slice& key = c_iter_->key();
+      const Slice& value = c_iter_->value();
+      const ParsedInternalKey& ikey = c_iter_->ikey();
+      batch->entries.push_back({batch->data.size(), key.size(),
+                                user_key.size(), value.size(), ikey.sequence,
+                                ikey.type});
+      batch->data.append(key.data(), key.size());
+      batch->data.append(user_key.data(), user_key.size());
+      batch->data.append(value.data(), value.size());
+      c_iter_->Next();
+    }
+    if (!c_iter_->Valid()) {
+      done = true;
+    }
+    if (on_batch_) {
+      on_batch_();
+    }
+    TEST_SYNC_POINT("PipelinedCompactionIterator::MergeThread:Batch");
+
+    MutexLock l(&mu_);
+    if (batch->entries.empty()) {
+      free_batches_.push_back(std::move(batch));
+    } else {
+      full_batches_.push_back(std::move(batch));
+    }
+    if (done) {
+      merge_status_ = c_iter_->status();
+    }
+    cv_.SignalAll();
+  }
+  merge_cpu_micros_ = (env_->NowCPUNanos() - start_cpu_nanos) / 1000;
+
+  MutexLock l(&mu_);
+  merge_done_ = true;
+  cv_.SignalAll();
+}
+
+void PipelinedCompactionIterator::NextBatch() {
+  MutexLock l(&mu_);
+  if (current_ != nullptr) {
+    free_batches_.push_back(std::move(current_));
+    cv_.SignalAll();
+  }
+  while (full_batches_.empty() && !merge_done_) {
+    cv_.Wait();
+  }
+  if (full_batches_.empty()) {
+    valid_ = false;
+    status_ = merge_status_;
+    return;
+  }
+  current_ = std::move(full_batches_.front());
+  full_batches_.pop_front();
+  pos_ = 0;
+  UpdateCurrent();
+}
+
+void PipelinedCompactionIterator::UpdateCurrent() {
+  assert(pos_ < current_->entries.size());
+  const Entry& entry = current_->entries[pos_];
+  const char* p = current_->data.data() + entry.offset;
+  key_ = Slice(p, entry.key_size);
+  p += entry.key_size;
+  ikey_.user_key = Slice(p, entry.user_key_size);
+  ikey_.sequence = entry.sequence;
+  ikey_.type = entry.type;
+  p += entry.user_key_size;
+  value_ = Slice(p, entry.value_size);
+  valid_ = true;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
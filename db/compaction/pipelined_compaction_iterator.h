@@ -0,0 +1,135 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/compaction/compaction_iterator.h"
+#include "port/port.h"
+#include "rocksdb/env.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// PipelinedCompactionIterator hands the output of a CompactionIterator to the
+// compaction loop, which builds and writes the output files.
+//
+// When pipelined, the CompactionIterator runs on a thread of its own: it
+// reads and merges the input into batches of copied entries, which are passed
+// to the compaction loop through a bounded queue. Reading and merging thus
+// overlap with building and writing the output. Otherwise, every call is
+// forwarded to the CompactionIterator.
+//
+// When pipelined, the CompactionIterator, its input iterator and the range
+// deletion aggregator they fill must not be used until Finish() returns.
+class PipelinedCompactionIterator {
+ public:
+  // end is the exclusive upper bound of the user keys to return, or nullptr.
+  // on_batch, if set, is called on the merge thread after each batch, e.g.
+  // to record the thread's I/O stats.
+  PipelinedCompactionIterator(CompactionIterator* c_iter,
+                              InternalIterator* input,
+                              const Comparator* ucmp, const Slice* end,
+                              bool pipelined, Env* env,
+                              std::function<void()> on_batch = nullptr);
+
+  ~PipelinedCompactionIterator();
+
+  // No copying allowed
+  PipelinedCompactionIterator(const PipelinedCompactionIterator&) = delete;
+  PipelinedCompactionIterator& operator=(const PipelinedCompactionIterator&) =
+      delete;
+
+  // Starts the merge thread, if pipelined, and positions at the first entry
+  void SeekToFirst();
+  void Next();
+
+  bool Valid() const { return pipelined_ ? valid_ : c_iter_->Valid(); }
+  const Slice& key() const { return pipelined_ ? key_ : c_iter_->key(); }
+  const Slice& value() const { return pipelined_ ? value_ : c_iter_->value(); }
+  const Slice& user_key() const {
+    return pipelined_ ? ikey_.user_key : c_iter_->user_key();
+  }
+  const ParsedInternalKey& ikey() const {
+    return pipelined_ ? ikey_ : c_iter_->ikey();
+  }
+  // When pipelined, the status of the CompactionIterator once all of its
+  // entries were returned, and OK before
+  Status status() const { return pipelined_ ? status_ : c_iter_->status(); }
+  // The status of the input iterator, as far as the entries returned so far
+  // are concerned
+  Status input_status() const {
+    return pipelined_ ? status_ : input_->status();
+  }
+
+  // Stops the merge thread and waits for it to exit, after which the
+  // CompactionIterator can be used again. Idempotent.
+  void Finish();
+
+  bool pipelined() const { return pipelined_; }
+
+  // The CPU time spent on the merge thread
+  uint64_t merge_cpu_micros() const { return merge_cpu_micros_; }
+
+ private:
+  struct Entry {
+    size_t offset;
+    size_t key_size;
+    size_t user_key_size;
+    size_t value_size;
+    SequenceNumber sequence;
+    ValueType type;
+  };
+
+  struct Batch {
+    std::string data;
+    std::vector<Entry> entries;
+  };
+
+  // The number of batches, including the one being filled and the one being
+  // consumed, which bounds the queue
+  static const size_t kNumBatches = 4;
+  // A batch is handed over once its entries take this many bytes
+  static const size_t kBatchBytes = 256 << 10;
+
+  void MergeThread();
+  // Moves to the next batch from the queue, or to the end
+  void NextBatch();
+  void UpdateCurrent();
+
+  CompactionIterator* const c_iter_;
+  InternalIterator* const input_;
+  const Comparator* const ucmp_;
+  const Slice* const end_;
+  const bool pipelined_;
+  Env* const env_;
+  std::function<void()> on_batch_;
+
+  port::Mutex mu_;
+  port::CondVar cv_;
+  // Protected by mu_
+  std::deque<std::unique_ptr<Batch>> full_batches_;
+  std::deque<std::unique_ptr<Batch>> free_batches_;
+  bool merge_done_ = false;
+  bool stop_ = false;
+  Status merge_status_;
+
+  port::Thread merge_thread_;
+  uint64_t merge_cpu_micros_ = 0;
+
+  // The batch being consumed, and the current entry in it
+  std::unique_ptr<Batch> current_;
+  size_t pos_ = 0;
+  bool valid_ = false;
+  Slice key_;
+  Slice value_;
+  ParsedInternalKey ikey_;
+  Status status_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
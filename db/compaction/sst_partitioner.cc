@@ -8,6 +8,8 @@
 
 #include <algorithm>
 
+#include "rocksdb/file_system.h"
+
 namespace ROCKSDB_NAMESPACE {
 
 PartitionerResult SstPartitionerFixedPrefix::ShouldPartition(
@@ -41,4 +43,53 @@ std::shared_ptr<SstPartitionerFactory> NewSstPartitionerFixedPrefixFactory(
   return std::make_shared<SstPartitionerFixedPrefixFactory>(prefix_len);
 }
 
+PartitionerResult SstPartitionerZoneCapacity::ShouldPartition(
+    const PartitionerRequest& request) {
+  if (max_capacity_ == 0) {
+    return kNotRequired;
+  }
+  uint64_t size = request.current_output_file_size;
+  if (size < last_size_) {
+    // The previous output file was ended by the target file size
+    Consume(last_size_);
+  }
+  last_size_ = size;
+  if (size >= remaining_ / 100 * (100 - reserve_pct_)) {
+    Consume(size);
+    last_size_ = 0;
+    return kRequired;
+  }
+  return kNotRequired;
+}
+
+void SstPartitionerZoneCapacity::Consume(uint64_t size) {
+  // The next file goes to an empty zone once this one is (nearly) filled
+  if (size >= remaining_ / 100 * (100 - reserve_pct_) ||
+      remaining_ - size < max_capacity_ / 100 * (reserve_pct_ + 1)) {
+    remaining_ = max_capacity_;
+  } else {
+    remaining_ -= size;
+  }
+}
+
+bool SstPartitionerZoneCapacity::CanDoTrivialMove(
+    const Slice& /* smallest_user_key */, const Slice& /* largest_user_key */) {
+  // A trivial move keeps the file where it is
+  return true;
+}
+
+std::unique_ptr<SstPartitioner>
+SstPartitionerZoneCapacityFactory::CreatePartitioner(
+    const SstPartitioner::Context& context) const {
+  uint64_t max_capacity = 0;
+  uint64_t remaining = fs_->GetZoneCapacity(context.output_level, &max_capacity);
+  return std::unique_ptr<SstPartitioner>(new SstPartitionerZoneCapacity(
+      remaining, max_capacity, std::min<uint32_t>(reserve_pct_, 50)));
+}
+
+std::shared_ptr<SstPartitionerFactory> NewSstPartitionerZoneCapacityFactory(
+    std::shared_ptr<FileSystem> fs, uint32_t reserve_pct) {
+  return std::make_shared<SstPartitionerZoneCapacityFactory>(fs, reserve_pct);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -26,6 +26,8 @@
 #include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
+#include "rocksdb/file_checksum.h"
+#include "rocksdb/rate_limiter.h"
 #include "rocksdb/table.h"
 #include "rocksdb/write_batch.h"
 #include "table/block_based/block_based_table_builder.h"
@@ -354,6 +356,52 @@ TEST_F(CorruptionTest, VerifyChecksumReadahead) {
   CloseDb();
 }
 
+TEST_F(CorruptionTest, VerifyChecksumParallel) {
+  Options options;
+  options.write_buffer_size = 100 * 1024 * 1024;
+  options.enable_blob_files = true;
+  options.min_blob_size = kValueSize / 2;
+  Reopen(&options);
+  // 5 table files, each with a blob file
+  Build(5000, 1000);
+  DBImpl* dbi = static_cast_with_check<DBImpl>(db_);
+  ASSERT_OK(dbi->TEST_FlushMemTable());
+
+  VerifyChecksumOptions verify_options;
+  verify_options.max_threads = 4;
+  verify_options.readahead_size = 64 * 1024;
+  verify_options.verify_file_checksums = true;
+  // The full file checksums need a generator
+  ASSERT_TRUE(dbi->VerifyChecksum(ReadOptions(), verify_options)
+                  .IsInvalidArgument());
+
+  options.file_checksum_gen_factory = GetFileChecksumGenCrc32cFactory();
+  Reopen(&options);
+  Build(5000, 5000, 1000);
+  dbi = static_cast_with_check<DBImpl>(db_);
+  ASSERT_OK(dbi->TEST_FlushMemTable());
+
+  std::shared_ptr<RateLimiter> rate_limiter(NewGenericRateLimiter(
+      1 << 30, 100 * 1000, 10, RateLimiter::Mode::kReadsOnly));
+  verify_options.rate_limiter = rate_limiter;
+  verify_options.verify_blob_files = true;
+  ASSERT_OK(dbi->VerifyChecksum(ReadOptions(), verify_options));
+  // The blob values are read at least once
+  ASSERT_GT(rate_limiter->GetTotalBytesThrough(), 10000 * kValueSize);
+
+  // A corrupted blob value is only caught with the blob files
+  Corrupt(kBlobFile, 5000, 1);
+  ASSERT_OK(dbi->VerifyChecksum());
+  verify_options.verify_file_checksums = false;
+  ASSERT_TRUE(
+      dbi->VerifyChecksum(ReadOptions(), verify_options).IsCorruption());
+  verify_options.verify_blob_files = false;
+  ASSERT_OK(dbi->VerifyChecksum(ReadOptions(), verify_options));
+
+  Corrupt(kTableFile, 100, 1);
+  ASSERT_NOK(dbi->VerifyChecksum(ReadOptions(), verify_options));
+}
+
 TEST_F(CorruptionTest, TableFileIndexData) {
   Options options;
   // very big, we'll trigger flushes manually
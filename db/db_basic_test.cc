@@ -970,7 +970,7 @@ TEST_F(DBBasicTest, ChecksumTest) {
   BlockBasedTableOptions table_options;
   Options options = CurrentOptions();
   // change when new checksum type added
-  int max_checksum = static_cast<int>(kxxHash64);
+  int max_checksum = static_cast<int>(kXXH3);
   const int kNumPerFile = 2;
 
   // generate one table with each type of checksum
@@ -1570,6 +1570,72 @@ TEST_F(DBBasicTest, MultiGetBatchedMultiLevel) {
   }
 }
 
+TEST_F(DBBasicTest, MultiGetBatchedParallelFileLookup) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  env_->SetBackgroundThreads(2, Env::Priority::USER);
+
+  for (int i = 0; i < 128; ++i) {
+    ASSERT_OK(Put(Key(i), "val_l2_" + std::to_string(i)));
+    if (i % 16 == 15) {
+      ASSERT_OK(Flush());
+    }
+  }
+  MoveFilesToLevel(2);
+
+  // L1 overwrites the even keys and deletes one key of every 32
+  for (int i = 0; i < 128; i += 2) {
+    ASSERT_OK(Put(Key(i), "val_l1_" + std::to_string(i)));
+    if (i % 32 == 0) {
+      ASSERT_OK(Delete(Key(i + 1)));
+    }
+    if (i % 16 == 14) {
+      ASSERT_OK(Flush());
+    }
+  }
+  MoveFilesToLevel(1);
+  ASSERT_GT(NumTableFilesAtLevel(1), 1);
+  ASSERT_GT(NumTableFilesAtLevel(2), 1);
+
+  std::vector<std::string> key_strs;
+  std::vector<Slice> keys;
+  for (int i = 0; i < 128; ++i) {
+    key_strs.push_back(Key(i));
+  }
+  for (const auto& key : key_strs) {
+    keys.push_back(key);
+  }
+
+  std::atomic<int> num_parallel_lookups{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "Version::MultiGet:ParallelLookup",
+      [&](void* /*arg*/) { num_parallel_lookups++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  for (bool parallel : {false, true}) {
+    ReadOptions ro;
+    ro.optimize_multiget_for_io = parallel;
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<Status> statuses(keys.size());
+    db_->MultiGet(ro, db_->DefaultColumnFamily(), keys.size(), keys.data(),
+                  values.data(), statuses.data());
+    for (int i = 0; i < 128; ++i) {
+      if (i % 32 == 1) {
+        ASSERT_TRUE(statuses[i].IsNotFound());
+      } else {
+        ASSERT_OK(statuses[i]);
+        ASSERT_EQ((i % 2 == 0 ? "val_l1_" : "val_l2_") + std::to_string(i),
+                  values[i].ToString());
+      }
+    }
+    ASSERT_EQ(parallel, num_parallel_lookups > 0);
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBBasicTest, MultiGetBatchedMultiLevelMerge) {
   Options options = CurrentOptions();
   options.disable_auto_compactions = true;
@@ -11,6 +11,7 @@
 #include "cache/lru_cache.h"
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
+#include "rocksdb/secondary_cache.h"
 #include "util/compression.h"
 #include "util/random.h"
 
@@ -292,6 +293,53 @@ TEST_F(DBBlockCacheTest, TestWithCompressedBlockCache) {
 
 // Make sure that when options.block_cache is set, after a new table is
 // created its index/filter blocks are added to block cache.
+TEST_F(DBBlockCacheTest, SecondaryCache) {
+  ReadOptions read_options;
+  auto table_options = GetTableOptions();
+  auto options = GetOptions(table_options);
+  InitTable(options);
+  ASSERT_OK(Flush());
+
+  CompressedSecondaryCacheOptions secondary_opts;
+  secondary_opts.capacity = 1 << 20;
+  secondary_opts.compression_type = kNoCompression;
+  for (auto type : {kLZ4Compression, kSnappyCompression, kZSTD}) {
+    if (CompressionTypeSupported(type)) {
+      secondary_opts.compression_type = type;
+      break;
+    }
+  }
+  // Every data block is evicted from the primary cache once it is released
+  LRUCacheOptions cache_opts(0 /*capacity*/, 0 /*num_shard_bits*/,
+                             false /*strict_capacity_limit*/,
+                             0.0 /*high_pri_pool_ratio*/);
+  cache_opts.secondary_cache = NewCompressedSecondaryCache(secondary_opts);
+  ASSERT_NE(nullptr, cache_opts.secondary_cache);
+  table_options.block_cache = NewLRUCache(cache_opts);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  std::string value(kValueSize, 'a');
+  uint64_t hits = TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT);
+  uint64_t misses = TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(hits, TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT));
+  ASSERT_EQ(misses + kNumBlocks,
+            TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  ASSERT_EQ(0U, table_options.block_cache->GetUsage());
+
+  // Served from the secondary cache without reading the file
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(hits + kNumBlocks,
+            TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT));
+  ASSERT_EQ(misses + kNumBlocks,
+            TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+}
+
 TEST_F(DBBlockCacheTest, IndexAndFilterBlocksOfNewTableAddedToCache) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
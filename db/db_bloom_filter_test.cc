@@ -1231,6 +1231,84 @@ TEST_P(DBBloomFilterTestVaryPrefixAndFormatVer, PartitionedMultiGet) {
   EXPECT_TRUE(found_spanning >= 2);
 }
 
+// Filter partitions missing from the block cache are read together
+TEST_P(DBBloomFilterTestVaryPrefixAndFormatVer, PartitionedMultiGetColdCache) {
+  Options options = CurrentOptions();
+  if (use_prefix_) {
+    options.prefix_extractor.reset(NewCappedPrefixTransform(9));
+  }
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  BlockBasedTableOptions bbto;
+  bbto.filter_policy.reset(NewBloomFilterPolicy(20));
+  bbto.partition_filters = true;
+  bbto.index_type = BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+  bbto.whole_key_filtering = !use_prefix_;
+  bbto.metadata_block_size = 290;
+  bbto.cache_index_and_filter_blocks = true;
+  bbto.block_cache = NewLRUCache(64 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+  DestroyAndReopen(options);
+
+  constexpr uint32_t N = 12000;
+  for (uint32_t i = 0; i < N; i += 2) {
+    ASSERT_OK(Put(UKey(i), UKey(i)));
+  }
+  ASSERT_OK(Flush());
+
+  size_t num_multi_reads = 0;
+  size_t num_partitions_read = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "PartitionedFilterBlockReader::GetFilterPartitionBlocks:MultiRead",
+      [&](void* arg) {
+        ++num_multi_reads;
+        num_partitions_read += *static_cast<size_t*>(arg);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  constexpr uint32_t Q = 29;
+  constexpr uint32_t kStride = (N / Q) | 1;
+  std::array<std::string, Q> keys;
+  std::array<Slice, Q> key_slices;
+  std::array<ColumnFamilyHandle*, Q> column_families;
+  std::array<Status, Q> statuses;
+  std::array<PinnableSlice, Q> values;
+  for (int round = 0; round < 2; ++round) {
+    // Evict every filter partition not held by the table reader
+    bbto.block_cache->SetCapacity(0);
+    bbto.block_cache->SetCapacity(64 << 20);
+    num_multi_reads = 0;
+    num_partitions_read = 0;
+    TestGetAndResetTickerCount(options, BLOCK_CACHE_FILTER_MISS);
+
+    for (uint32_t i = 0; i < Q; ++i) {
+      keys[i] = UKey(i * kStride + round);
+      key_slices[i] = Slice(keys[i]);
+      column_families[i] = db_->DefaultColumnFamily();
+      statuses[i] = Status();
+      values[i] = PinnableSlice();
+    }
+    db_->MultiGet(ReadOptions(), Q, &column_families[0], &key_slices[0],
+                  &values[0], /*timestamps=*/nullptr, &statuses[0], true);
+    for (uint32_t i = 0; i < Q; ++i) {
+      if ((i * kStride + round) % 2 == 0) {
+        ASSERT_OK(statuses[i]);
+        ASSERT_EQ(keys[i], values[i].ToString());
+      } else {
+        ASSERT_TRUE(statuses[i].IsNotFound());
+      }
+    }
+
+    // The keys span many partitions, all read with one MultiRead
+    EXPECT_EQ(1U, num_multi_reads);
+    EXPECT_GE(num_partitions_read, Q / 2 + 1);
+    EXPECT_GE(TestGetAndResetTickerCount(options, BLOCK_CACHE_FILTER_MISS),
+              num_partitions_read);
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 INSTANTIATE_TEST_CASE_P(DBBloomFilterTestVaryPrefixAndFormatVer,
                         DBBloomFilterTestVaryPrefixAndFormatVer,
                         ::testing::Values(
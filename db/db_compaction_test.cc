@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "db/db_test_util.h"
+#include "env/composite_env_wrapper.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/concurrent_task_limiter.h"
@@ -1026,7 +1027,7 @@ TEST_F(DBCompactionTest, CompactionSstPartitioner) {
 
   std::vector<LiveFileMetaData> files;
   dbfull()->GetLiveFilesMetaData(&files);
-  ASSERT_EQ(2, files.size());
+  ASSERT_EQ(2U, files.size());
   ASSERT_EQ("A2", Get("aaaa1"));
   ASSERT_EQ("B", Get("bbbb1"));
 }
@@ -1050,7 +1051,7 @@ TEST_F(DBCompactionTest, CompactionSstPartitionerNonTrivial) {
 
   std::vector<LiveFileMetaData> files;
   dbfull()->GetLiveFilesMetaData(&files);
-  ASSERT_EQ(2, files.size());
+  ASSERT_EQ(2U, files.size());
   ASSERT_EQ("A", Get("aaaa1"));
   ASSERT_EQ("B", Get("bbbb1"));
 }
@@ -4972,7 +4973,8 @@ INSTANTIATE_TEST_CASE_P(
     ::testing::Values(CompactionPri::kByCompensatedSize,
                       CompactionPri::kOldestLargestSeqFirst,
                       CompactionPri::kOldestSmallestSeqFirst,
-                      CompactionPri::kMinOverlappingRatio));
+                      CompactionPri::kMinOverlappingRatio,
+                      CompactionPri::kByReadHotness));
 
 class NoopMergeOperator : public MergeOperator {
  public:
@@ -5925,6 +5927,300 @@ TEST_F(DBCompactionTest, CompactionWithBlob) {
   ASSERT_EQ(compaction_stats[1].num_output_files, 2);
 }
 
+TEST_F(DBCompactionTest, PipelinedCompaction) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.enable_pipelined_compaction = true;
+  options.compaction_readahead_size = 64 << 10;
+  options.target_file_size_base = 64 << 10;
+  options.max_subcompactions = 2;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 1000; i++) {
+    values.push_back(rnd.RandomString(1000));
+  }
+  for (int i = 0; i < 4; i++) {
+    for (int j = i; j < 1000; j += 4) {
+      ASSERT_OK(Put(Key(j), values[j]));
+    }
+    ASSERT_OK(Flush());
+  }
+  // Overwrite some of the keys, and delete others
+  for (int j = 0; j < 1000; j += 3) {
+    if (j % 2 == 0) {
+      values[j] = rnd.RandomString(1000);
+      ASSERT_OK(Put(Key(j), values[j]));
+    } else {
+      values[j].clear();
+      ASSERT_OK(Delete(Key(j)));
+    }
+  }
+  ASSERT_OK(Flush());
+
+  std::atomic<int> num_batches{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "PipelinedCompactionIterator::MergeThread:Batch",
+      [&](void* /*arg*/) { num_batches++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // Each batch holds up to 256KB of entries
+  ASSERT_GT(num_batches.load(), 1);
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_GT(NumTableFilesAtLevel(1), 1);
+  for (int j = 0; j < 1000; j++) {
+    ASSERT_EQ(values[j].empty() ? "NOT_FOUND" : values[j], Get(Key(j)));
+  }
+}
+
+TEST_F(DBCompactionTest, SubcompactionsIntoEmptyLevel) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.max_subcompactions = 4;
+  options.target_file_size_base = 1 << 20;
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  // Every L0 file spans the whole key range, so the subcompaction boundaries
+  // can only come from within the files
+  Random rnd(301);
+  for (int i = 0; i < 4; i++) {
+    for (int j = i; j < 4000; j += 4) {
+      ASSERT_OK(Put(Key(j), rnd.RandomString(1000)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ("4", FilesPerLevel(0));
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  HistogramData subcompactions;
+  options.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                    &subcompactions);
+  ASSERT_EQ(4, subcompactions.max);
+  for (int j = 0; j < 4000; j++) {
+    ASSERT_NE("NOT_FOUND", Get(Key(j)));
+  }
+}
+
+// Records the placement hint every table file is created with
+class PlacementHintFS : public FileSystemWrapper {
+ public:
+  explicit PlacementHintFS(const std::shared_ptr<FileSystem>& target)
+      : FileSystemWrapper(target) {}
+
+  IOStatus NewWritableFile(const std::string& fname,
+                           const FileOptions& file_opts,
+                           std::unique_ptr<FSWritableFile>* result,
+                           IODebugContext* dbg) override {
+    uint64_t number;
+    FileType type;
+    if (ParseFileName(fname.substr(fname.find_last_of('/') + 1), &number,
+                      &type) &&
+        type == kTableFile) {
+      MutexLock l(&mutex_);
+      hints_[number] = file_opts.placement_hint;
+    }
+    return target()->NewWritableFile(fname, file_opts, result, dbg);
+  }
+
+  FilePlacementHint GetHint(uint64_t number) {
+    MutexLock l(&mutex_);
+    return hints_[number];
+  }
+
+ private:
+  port::Mutex mutex_;
+  std::map<uint64_t, FilePlacementHint> hints_;
+};
+
+TEST_F(DBCompactionTest, PlacementHintAtOpen) {
+  auto fs = std::make_shared<PlacementHintFS>(env_->GetFileSystem());
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+  Options options = CurrentOptions();
+  options.env = env.get();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put(Key(10), "val"));
+  ASSERT_OK(Put(Key(20), "val"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put(Key(5), "val"));
+  ASSERT_OK(Put(Key(15), "val"));
+  ASSERT_OK(Flush());
+
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(2U, files.size());
+  for (const auto& file : files) {
+    // A flush hints the memtables' exact key range
+    FilePlacementHint hint = fs->GetHint(file.file_number);
+    ASSERT_EQ(0, hint.level);
+    ASSERT_EQ(file.smallestkey, ExtractUserKey(hint.smallest).ToString());
+    ASSERT_EQ(file.largestkey, ExtractUserKey(hint.largest).ToString());
+    ASSERT_GT(hint.expected_size, 0);
+  }
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  files.clear();
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(1U, files.size());
+  // A compaction hints its input's key range
+  FilePlacementHint hint = fs->GetHint(files[0].file_number);
+  ASSERT_EQ(1, hint.level);
+  ASSERT_EQ(Key(5), ExtractUserKey(hint.smallest).ToString());
+  ASSERT_EQ(Key(20), ExtractUserKey(hint.largest).ToString());
+  ASSERT_GT(hint.expected_size, 0);
+
+  Close();
+}
+
+TEST_F(DBCompactionTest, PlacementHintL0Stream) {
+  auto fs = std::make_shared<PlacementHintFS>(env_->GetFileSystem());
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+  Options options = CurrentOptions();
+  options.env = env.get();
+  options.disable_auto_compactions = true;
+  options.target_file_size_base = 4 << 10;
+  options.max_flush_partitions = 2;
+  DestroyAndReopen(options);
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  Random rnd(301);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(200)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(NumTableFilesAtLevel(1), 1);
+
+  ASSERT_OK(Put(Key(0), "val"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put(Key(99), "val"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put(1, Key(99), "val"));
+  ASSERT_OK(Flush(1));
+
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  int l0_files = 0;
+  for (const auto& file : files) {
+    if (file.level != 0) {
+      continue;
+    }
+    l0_files++;
+    FilePlacementHint hint = fs->GetHint(file.file_number);
+    if (file.column_family_name == "pikachu") {
+      // Without L1 files the column family is one range
+      ASSERT_EQ(1U, hint.column_family_id);
+      ASSERT_EQ(0U, hint.key_range);
+    } else {
+      // The first and the last L1 files are in different ranges
+      ASSERT_EQ(0U, hint.column_family_id);
+      ASSERT_EQ(file.smallestkey == Key(0) ? 0U : 1U, hint.key_range);
+    }
+  }
+  ASSERT_EQ(3, l0_files);
+
+  Close();
+}
+
+// Deletes files in batches, counting the files of each batch
+class BatchDeleteFS : public FileSystemWrapper {
+ public:
+  explicit BatchDeleteFS(const std::shared_ptr<FileSystem>& target)
+      : FileSystemWrapper(target) {}
+
+  IOStatus DeleteFiles(const std::vector<std::string>& fnames,
+                       const IOOptions& options,
+                       std::vector<IOStatus>* statuses,
+                       IODebugContext* dbg) override {
+    statuses->clear();
+    for (const auto& fname : fnames) {
+      statuses->push_back(target()->DeleteFile(fname, options, dbg));
+    }
+    MutexLock l(&mutex_);
+    batches_.push_back(fnames.size());
+    return IOStatus::OK();
+  }
+
+  std::vector<size_t> GetBatches() {
+    MutexLock l(&mutex_);
+    return batches_;
+  }
+
+ private:
+  port::Mutex mutex_;
+  std::vector<size_t> batches_;
+};
+
+TEST_F(DBCompactionTest, DeleteObsoleteFilesInBatch) {
+  auto fs = std::make_shared<BatchDeleteFS>(env_->GetFileSystem());
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+  Options options = CurrentOptions();
+  options.env = env.get();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  const int kNumFiles = 5;
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_OK(Put(Key(0), "val"));
+    ASSERT_OK(Put(Key(100 + i), "val"));
+    ASSERT_OK(Flush());
+  }
+  std::vector<LiveFileMetaData> inputs;
+  db_->GetLiveFilesMetaData(&inputs);
+  ASSERT_EQ(kNumFiles, inputs.size());
+
+  size_t num_batches = fs->GetBatches().size();
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  std::vector<size_t> batches = fs->GetBatches();
+  // The compaction inputs go in one batch
+  ASSERT_NE(batches.end(), std::find(batches.begin() + num_batches,
+                                     batches.end(), size_t{kNumFiles}));
+  for (const auto& file : inputs) {
+    ASSERT_TRUE(env_->FileExists(dbname_ + file.name).IsNotFound());
+  }
+  ASSERT_EQ("val", Get(Key(0)));
+}
+
+TEST_F(DBCompactionTest, PipelinedCompactionWithRangeDeletion) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.enable_pipelined_compaction = true;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "val" + ToString(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(10), Key(20)));
+  ASSERT_OK(Flush());
+
+  // The range deletion makes the compaction run without a merge thread
+  std::atomic<int> num_batches{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "PipelinedCompactionIterator::MergeThread:Batch",
+      [&](void* /*arg*/) { num_batches++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_EQ(0, num_batches.load());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(i >= 10 && i < 20 ? "NOT_FOUND" : "val" + ToString(i),
+              Get(Key(i)));
+  }
+}
+
 class DBCompactionTestBlobError
     : public DBCompactionTest,
       public testing::WithParamInterface<std::string> {
@@ -446,6 +446,59 @@ TEST_F(DBFlushTest, FireOnFlushCompletedAfterCommittedResult) {
 }
 #endif  // !ROCKSDB_LITE
 
+TEST_F(DBFlushTest, PartitionedFlush) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.write_buffer_size = 32 << 20;
+  options.target_file_size_base = 256 << 10;
+  options.max_flush_partitions = 4;
+  Reopen(options);
+
+  Random rnd(301);
+  const int kNumKeys = 20000;
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumKeys; i++) {
+    values.push_back(rnd.RandomString(100));
+    // Overwrites, so that versions of a key must stay in the same file
+    ASSERT_OK(Put(Key(i), "old"));
+    ASSERT_OK(Put(Key(i), values.back()));
+  }
+  ASSERT_OK(Flush());
+
+  VersionStorageInfo* storage_info =
+      dbfull()->TEST_GetVersionSet()->GetColumnFamilySet()->GetDefault()
+          ->current()->storage_info();
+  std::vector<FileMetaData*> l0_files = storage_info->LevelFiles(0);
+  ASSERT_EQ(l0_files.size(), 4);
+  // The files cover disjoint key ranges
+  const Comparator* ucmp = options.comparator;
+  std::sort(l0_files.begin(), l0_files.end(),
+            [ucmp](const FileMetaData* a, const FileMetaData* b) {
+              return ucmp->Compare(a->smallest.user_key(),
+                                   b->smallest.user_key()) < 0;
+            });
+  for (size_t i = 1; i < l0_files.size(); i++) {
+    ASSERT_LT(ucmp->Compare(l0_files[i - 1]->largest.user_key(),
+                            l0_files[i]->smallest.user_key()),
+              0);
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+
+  // Not split with a range deletion in the memtable
+  ASSERT_OK(Put(Key(0), "new"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(1), Key(2)));
+  for (int i = 2; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), values[i]));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ(NumTableFilesAtLevel(0), 5);
+  ASSERT_EQ("new", Get(Key(0)));
+  ASSERT_EQ("NOT_FOUND", Get(Key(1)));
+}
+
 TEST_F(DBFlushTest, FlushWithBlob) {
   constexpr uint64_t min_blob_size = 10;
 
@@ -30,6 +30,10 @@
 #include <chrono>
 
 #include "db/arena_wrapped_db_iter.h"
+#include "db/blob/blob_file_meta.h"
+#include "db/blob/blob_log_format.h"
+#include "db/blob/blob_log_sequential_reader.h"
+#include "db/block_cache_warmup.h"
 #include "db/builder.h"
 #include "db/compaction/compaction_job.h"
 #include "db/db_info_dumper.h"
@@ -49,9 +53,11 @@
 #include "db/memtable_list.h"
 #include "db/merge_context.h"
 #include "db/merge_helper.h"
+#include "db/options_advisor.h"
 #include "db/periodic_work_scheduler.h"
 #include "db/range_tombstone_fragmenter.h"
 #include "db/table_cache.h"
+#include "db/table_metadata_checkpoint.h"
 #include "db/table_properties_collector.h"
 #include "db/transaction_log_impl.h"
 #include "db/version_set.h"
@@ -71,6 +77,7 @@
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/persistent_stats_history.h"
+#include "monitoring/span_tracer_imp.h"
 #include "monitoring/thread_status_updater.h"
 #include "monitoring/thread_status_util.h"
 #include "options/cf_options.h"
@@ -162,7 +169,7 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       mutable_db_options_(initial_db_options_),
       stats_(immutable_db_options_.statistics.get()),
       mutex_(stats_, env_, DB_MUTEX_WAIT_MICROS,
-             immutable_db_options_.use_adaptive_mutex),
+             immutable_db_options_.use_adaptive_mutex, "DBImpl::mutex_"),
       default_cf_handle_(nullptr),
       max_total_in_memory_state_(0),
       file_options_(BuildDBOptions(immutable_db_options_, mutable_db_options_)),
@@ -194,6 +201,9 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       bg_flush_scheduled_(0),
       num_running_flushes_(0),
       bg_purge_scheduled_(0),
+      bg_open_table_files_scheduled_(0),
+      num_table_files_pending_open_(0),
+      bg_block_cache_warmup_scheduled_(0),
       disable_delete_obsolete_files_(0),
       pending_purge_obsolete_files_(0),
       delete_obsolete_files_last_run_(env_->NowMicros()),
@@ -236,7 +246,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       preserve_deletes_(options.preserve_deletes),
       closed_(false),
       error_handler_(this, immutable_db_options_, &mutex_),
-      atomic_flush_install_cv_(&mutex_) {
+      atomic_flush_install_cv_(&mutex_),
+      async_write_cv_(&async_write_mutex_) {
   // !batch_per_trx_ implies seq_per_batch_ because it is only unset for
   // WriteUnprepared, which should use seq_per_batch_.
   assert(batch_per_txn_ || seq_per_batch_);
@@ -260,6 +271,27 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
                                  io_tracer_));
   column_family_memtables_.reset(
       new ColumnFamilyMemTablesImpl(versions_->GetColumnFamilySet()));
+  if (immutable_db_options_.max_table_metadata_checkpoint_size > 0) {
+    table_metadata_checkpoint_.reset(new TableMetadataCheckpoint());
+    versions_->GetColumnFamilySet()->set_table_metadata_checkpoint(
+        table_metadata_checkpoint_.get());
+  }
+  if (immutable_db_options_.block_cache_warmup_save_period_sec > 0) {
+    block_cache_warmup_.reset(new BlockCacheWarmup(
+        immutable_db_options_.max_block_cache_warmup_size));
+    versions_->GetColumnFamilySet()->set_block_cache_warmup(
+        block_cache_warmup_.get());
+  }
+  if (immutable_db_options_.options_advisor_period_sec > 0) {
+    options_advisor_.reset(new OptionsAdvisor(this, &event_logger_));
+  }
+  iterator_pool_.reset(new IteratorPool());
+  if (immutable_db_options_.enable_pipelined_write &&
+      immutable_db_options_.wal_streams > 1) {
+    for (size_t i = 0; i < immutable_db_options_.wal_streams; i++) {
+      wal_lanes_.emplace_back(new WALLane());
+    }
+  }
 
   DumpRocksDBBuildVersion(immutable_db_options_.info_log.get());
   SetDbSessionId();
@@ -274,89 +306,78 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
   preserve_deletes_seqnum_.store(0);
 }
 
-const InternalKeyComparator* DBImpl::GetDefaultICMP(){
+std::shared_ptr<const VersionFilesSnapshot> DBImpl::GetDefaultFilesSnapshot() {
+  /* ZenFS may ask before the default column family is installed */
+  auto cfd = versions_->GetColumnFamilySet()->GetDefault();
+  if (cfd == nullptr) return nullptr;
+  return cfd->GetFilesSnapshot();
+}
 
-    auto vstorage = versions_->GetColumnFamilySet()->GetDefault()->current()->storage_info();
-    return vstorage->InternalComparator();
+const InternalKeyComparator* DBImpl::GetDefaultICMP(){
+  auto snapshot = GetDefaultFilesSnapshot();
+  if (snapshot == nullptr) return nullptr;
+  return snapshot->icmp();
+}
 
+const Comparator* DBImpl::GetUserComp() {
+  const InternalKeyComparator* icmp = GetDefaultICMP();
+  assert(icmp);
+  return icmp != nullptr ? icmp->user_comparator() : nullptr;
 }
 
 void DBImpl::FindClosestFilesWithSameLevel(const int level, std::vector<uint64_t>& fno_list) {
-
-  auto vstorage = versions_->GetColumnFamilySet()->GetDefault()->current()->storage_info();
-  auto files = vstorage->LevelFiles(level);
-  
-  for (const auto f : files) {
-    uint64_t fno = f->fd.GetNumber();
-    fno_list.push_back(fno);
-  }
+  SameLevelFileList(level, fno_list);
 }
 
 void DBImpl::SameLevelFileList(const int level, std::vector<uint64_t>& fno_list){
+  auto snapshot = GetDefaultFilesSnapshot();
+  if (snapshot == nullptr || level < 0 || level >= snapshot->num_levels())
+    return;
 
-  auto vstorage = versions_->GetColumnFamilySet()->GetDefault()->current()->storage_info();
+  for (const auto& f : snapshot->LevelFiles(level)) {
+    fno_list.push_back(f.number);
+  }
+}
+void DBImpl::BeingCompactedFileList(std::set<uint64_t>& fno_set) {
+  auto snapshot = GetDefaultFilesSnapshot();
+  if (snapshot == nullptr) return;
 
-  auto files = vstorage->LevelFiles(level);
-  
-  for (const auto f : files) {
-    uint64_t fno = f->fd.GetNumber();
-    fno_list.push_back(fno);
+  for (int level = 0; level < snapshot->num_levels(); level++) {
+    for (const auto& f : snapshot->LevelFiles(level)) {
+      if (f.being_compacted) fno_set.insert(f.number);
+    }
   }
 }
+
 int DBImpl::Getlevel() {
-  auto vstorage =
-      versions_->GetColumnFamilySet()->GetDefault()->current()->storage_info();
-  return vstorage->num_levels();
+  auto snapshot = GetDefaultFilesSnapshot();
+  return snapshot != nullptr ? snapshot->num_levels() : 0;
 }
 void DBImpl::AdjacentFileList(const InternalKey& s, const InternalKey& l, const int level, std::vector<uint64_t>& fno_list){
+  auto snapshot = GetDefaultFilesSnapshot();
+  if (snapshot == nullptr) return;
+  std::vector<const VersionFilesSnapshot::File*> files;
 
-  auto vstorage = versions_->GetColumnFamilySet()->GetDefault()->current()->storage_info();
-  CompactionInputFiles output_level_inputs;
-  CompactionInputFiles output_level_inputs_2;
-  
-  vstorage->GetOverlappingInputs(level+1, &s, &l, &output_level_inputs.files);
-  
-  if (level != 0) {
-    vstorage->GetOverlappingInputs(level-1, &s, &l, &output_level_inputs_2.files);
-  } else {
-    vstorage->GetOverlappingInputs(0, &s, &l, &output_level_inputs_2.files);
-  }
-  
-  for (const auto& f : output_level_inputs.files) {
-    if (!f->being_compacted){
-      uint64_t fno = f->fd.GetNumber();
-      fno_list.push_back(fno);
-    }
-  }
- 
-  for (const auto& f : output_level_inputs_2.files) {
-    if (!f->being_compacted) {
-      uint64_t fno = f->fd.GetNumber();
-      fno_list.push_back(fno);
-    }
+  snapshot->GetOverlappingFiles(level + 1, s, l, &files);
+  /* L0 files are compacted together with the other L0 files */
+  snapshot->GetOverlappingFiles(level != 0 ? level - 1 : 0, s, l, &files);
+
+  for (const auto f : files) {
+    if (!f->being_compacted) fno_list.push_back(f->number);
   }
 }
 void DBImpl::GetAllOverlappingFiles(const InternalKey& s, const InternalKey& l,
                                     std::vector<uint64_t>& fno_list) {
-  auto vstorage = versions_->GetColumnFamilySet()->GetDefault()->current()->storage_info();
-
-  // ļбȷûо
   fno_list.clear();
+  auto snapshot = GetDefaultFilesSnapshot();
+  if (snapshot == nullptr) return;
 
-  // в㼶
-  for (int level = 0; level < vstorage->num_levels(); level++) {
-    CompactionInputFiles overlapping_files;
-
-    // ȡǰ㼶Χ [s, l] صļ
-    vstorage->GetOverlappingInputs(level, &s, &l, &overlapping_files.files);
-
-    // صļļӵб
-    for (const auto& f : overlapping_files.files) {
-      if (!f->being_compacted) {  // ȷļûڱѹ
-        uint64_t fno = f->fd.GetNumber();
-        fno_list.push_back(fno);
-      }
-    }
+  std::vector<const VersionFilesSnapshot::File*> files;
+  for (int level = 0; level < snapshot->num_levels(); level++) {
+    snapshot->GetOverlappingFiles(level, s, l, &files);
+  }
+  for (const auto f : files) {
+    if (!f->being_compacted) fno_list.push_back(f->number);
   }
 }
 
@@ -578,6 +599,11 @@ void DBImpl::CancelAllBackgroundWork(bool wait) {
 }
 
 Status DBImpl::CloseHelper() {
+  // Finish the writes queued by WriteAsync while the DB is fully usable
+  StopAsyncWriteThreads();
+  // Unpin the super versions of the recycled iterators
+  iterator_pool_->Clear();
+
   // Guarantee that there is no background error recovery in progress before
   // continuing with the shutdown
   mutex_.Lock();
@@ -605,11 +631,23 @@ Status DBImpl::CloseHelper() {
   // Wait for background work to finish
   while (bg_bottom_compaction_scheduled_ || bg_compaction_scheduled_ ||
          bg_flush_scheduled_ || bg_purge_scheduled_ ||
+         bg_open_table_files_scheduled_ || bg_block_cache_warmup_scheduled_ ||
          pending_purge_obsolete_files_ ||
          error_handler_.IsRecoveryInProgress()) {
     TEST_SYNC_POINT("DBImpl::~DBImpl:WaitJob");
     bg_cv_.Wait();
   }
+  // Not by read-only and secondary instances, which do not hold the lock
+  if (table_metadata_checkpoint_ != nullptr && opened_successfully_ &&
+      db_lock_ != nullptr) {
+    SaveTableMetadataCheckpoint();
+  }
+  if (block_cache_warmup_ != nullptr && opened_successfully_ &&
+      db_lock_ != nullptr) {
+    mutex_.Unlock();
+    SaveBlockCacheWarmup();
+    mutex_.Lock();
+  }
   TEST_SYNC_POINT_CALLBACK("DBImpl::CloseHelper:PendingPurgeFinished",
                            &files_grabbed_for_purge_);
   EraseThreadStatusDbInfo();
@@ -789,7 +827,9 @@ void DBImpl::StartPeriodicWorkScheduler() {
 
   periodic_work_scheduler_->Register(
       this, mutable_db_options_.stats_dump_period_sec,
-      mutable_db_options_.stats_persist_period_sec);
+      mutable_db_options_.stats_persist_period_sec,
+      immutable_db_options_.block_cache_warmup_save_period_sec,
+      immutable_db_options_.options_advisor_period_sec);
 #endif  // !ROCKSDB_LITE
 }
 
@@ -970,21 +1010,38 @@ void DBImpl::DumpStats() {
     return;
   }
   TEST_SYNC_POINT("DBImpl::DumpStats:StartRunning");
+  autovector<ColumnFamilyData*> cfds;
   {
     InstrumentedMutexLock l(&mutex_);
     default_cf_internal_stats_->GetStringProperty(
         *db_property_info, DB::Properties::kDBStats, &stats);
     for (auto cfd : *versions_->GetColumnFamilySet()) {
       if (cfd->initialized()) {
-        cfd->internal_stats()->GetStringProperty(
-            *cf_property_info, DB::Properties::kCFStatsNoFileHistogram, &stats);
+        cfd->Ref();
+        cfds.push_back(cfd);
       }
     }
-    for (auto cfd : *versions_->GetColumnFamilySet()) {
-      if (cfd->initialized()) {
-        cfd->internal_stats()->GetStringProperty(
-            *cf_property_info, DB::Properties::kCFFileHistogram, &stats);
-      }
+  }
+  // The mutex is taken for one column family at a time, so that with
+  // thousands of them the dump does not hold it for long
+  for (auto cfd : cfds) {
+    InstrumentedMutexLock l(&mutex_);
+    if (!cfd->IsDropped()) {
+      cfd->internal_stats()->GetStringProperty(
+          *cf_property_info, DB::Properties::kCFStatsNoFileHistogram, &stats);
+    }
+  }
+  for (auto cfd : cfds) {
+    InstrumentedMutexLock l(&mutex_);
+    if (!cfd->IsDropped()) {
+      cfd->internal_stats()->GetStringProperty(
+          *cf_property_info, DB::Properties::kCFFileHistogram, &stats);
+    }
+  }
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : cfds) {
+      cfd->UnrefAndTryDelete();
     }
   }
   TEST_SYNC_POINT("DBImpl::DumpStats:2");
@@ -1013,6 +1070,54 @@ void DBImpl::FlushInfoLog() {
   LogFlush(immutable_db_options_.info_log);
 }
 
+void DBImpl::RunOptionsAdvisor() {
+  if (options_advisor_ == nullptr || shutdown_initiated_) {
+    return;
+  }
+  TEST_SYNC_POINT("DBImpl::RunOptionsAdvisor:StartRunning");
+  options_advisor_->Run();
+}
+
+void DBImpl::SaveBlockCacheWarmup() {
+  if (block_cache_warmup_ == nullptr) {
+    return;
+  }
+  TEST_SYNC_POINT("DBImpl::SaveBlockCacheWarmup:StartRunning");
+  std::unordered_set<uint64_t> live_files;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped() || !cfd->initialized()) {
+        continue;
+      }
+      const VersionStorageInfo* vstorage = cfd->current()->storage_info();
+      for (int level = 0; level < vstorage->num_levels(); level++) {
+        for (FileMetaData* f : vstorage->LevelFiles(level)) {
+          live_files.insert(f->fd.GetNumber());
+        }
+      }
+    }
+  }
+
+  const std::string fname = BlockCacheWarmupFileName(dbname_);
+  size_t num_blocks = 0;
+  Status s = block_cache_warmup_->Save(
+      fs_.get(), fname,
+      [&live_files](uint64_t file_number) {
+        return live_files.count(file_number) > 0;
+      },
+      &num_blocks);
+  if (s.ok()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Saved %" ROCKSDB_PRIszt
+                   " data blocks to warm the block cache up with to %s",
+                   num_blocks, fname.c_str());
+  } else {
+    ROCKS_LOG_WARN(immutable_db_options_.info_log, "Failed to save %s: %s",
+                   fname.c_str(), s.ToString().c_str());
+  }
+}
+
 Status DBImpl::TablesRangeTombstoneSummary(ColumnFamilyHandle* column_family,
                                            int max_entries_to_print,
                                            std::string* out_str) {
@@ -1193,7 +1298,8 @@ Status DBImpl::SetDBOptions(
         periodic_work_scheduler_->Unregister(this);
         periodic_work_scheduler_->Register(
             this, new_options.stats_dump_period_sec,
-            new_options.stats_persist_period_sec);
+            new_options.stats_persist_period_sec,
+            immutable_db_options_.block_cache_warmup_save_period_sec);
         mutex_.Lock();
       }
       write_controller_.set_max_delayed_write_rate(
@@ -1342,6 +1448,9 @@ Status DBImpl::SyncWAL() {
       assert(!log.getting_synced);
       log.getting_synced = true;
       logs_to_sync.push_back(log.writer);
+      for (auto* stream : log.streams) {
+        logs_to_sync.push_back(stream);
+      }
     }
 
     need_log_dir_sync = !log_dir_synced_;
@@ -1410,6 +1519,7 @@ void DBImpl::MarkLogsSynced(uint64_t up_to, bool synced_dir,
     assert(log.getting_synced);
     if (status.ok() && logs_.size() > 1) {
       logs_to_free_.push_back(log.ReleaseWriter());
+      log.ReleaseStreams(&logs_to_free_);
       // To modify logs_ both mutex_ and log_write_mutex_ must be held
       InstrumentedMutexLock l(&log_write_mutex_);
       it = logs_.erase(it);
@@ -1667,6 +1777,17 @@ class GetWithTimestampReadCallback : public ReadCallback {
 };
 }  // namespace
 
+Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
+                       GetImplOptions& get_impl_options) {
+  SpanScope span_scope(immutable_db_options_.span_tracer.get(),
+                       read_options.trace_id, "Get", env_);
+  if (InstrumentationEnabled(stats_)) {
+    return GetImpl<true>(read_options, key, get_impl_options);
+  }
+  return GetImpl<false>(read_options, key, get_impl_options);
+}
+
+template <bool kInstrumented>
 Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
                        GetImplOptions& get_impl_options) {
   assert(get_impl_options.value != nullptr ||
@@ -1687,9 +1808,10 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
   }
 #endif  // NDEBUG
 
-  PERF_CPU_TIMER_GUARD(get_cpu_nanos, env_);
-  StopWatch sw(env_, stats_, DB_GET);
-  PERF_TIMER_GUARD(get_snapshot_time);
+  Statistics* const stats = kInstrumented ? stats_ : nullptr;
+  PERF_CPU_TIMER_GUARD_IF(kInstrumented, get_cpu_nanos, env_);
+  StopWatch sw(env_, stats, DB_GET);
+  PERF_TIMER_GUARD_IF(kInstrumented, get_snapshot_time);
 
   auto cfh = static_cast_with_check<ColumnFamilyHandleImpl>(
       get_impl_options.column_family);
@@ -1767,7 +1889,8 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
   // First look in the memtable, then in the immutable memtable (if any).
   // s is both in/out. When in, s could either be OK or MergeInProgress.
   // merge_operands will contain the sequence of merges in the latter case.
-  LookupKey lkey(key, snapshot, read_options.timestamp);
+  LookupKey lkey(key, snapshot, read_options.timestamp,
+                 read_options.recycle_arena_blocks);
   PERF_TIMER_STOP(get_snapshot_time);
 
   bool skip_memtable = (read_options.read_tier == kPersistedTier &&
@@ -1783,7 +1906,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
                        get_impl_options.is_blob_index)) {
         done = true;
         get_impl_options.value->PinSelf();
-        RecordTick(stats_, MEMTABLE_HIT);
+        RecordTick(stats, MEMTABLE_HIT);
       } else if ((s.ok() || s.IsMergeInProgress()) &&
                  sv->imm->Get(lkey, get_impl_options.value->GetSelf(),
                               timestamp, &s, &merge_context,
@@ -1792,7 +1915,8 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
                               get_impl_options.is_blob_index)) {
         done = true;
         get_impl_options.value->PinSelf();
-        RecordTick(stats_, MEMTABLE_HIT);
+        RecordTick(stats, MEMTABLE_HIT);
+        RecordTick(stats, IMMUTABLE_MEMTABLE_HIT);
       }
     } else {
       // Get Merge Operands associated with key, Merge Operands should not be
@@ -1801,13 +1925,14 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
                        &merge_context, &max_covering_tombstone_seq,
                        read_options, nullptr, nullptr, false)) {
         done = true;
-        RecordTick(stats_, MEMTABLE_HIT);
+        RecordTick(stats, MEMTABLE_HIT);
       } else if ((s.ok() || s.IsMergeInProgress()) &&
                  sv->imm->GetMergeOperands(lkey, &s, &merge_context,
                                            &max_covering_tombstone_seq,
                                            read_options)) {
         done = true;
-        RecordTick(stats_, MEMTABLE_HIT);
+        RecordTick(stats, MEMTABLE_HIT);
+        RecordTick(stats, IMMUTABLE_MEMTABLE_HIT);
       }
     }
     if (!done && !s.ok() && !s.IsMergeInProgress()) {
@@ -1816,7 +1941,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
     }
   }
   if (!done) {
-    PERF_TIMER_GUARD(get_from_output_files_time);
+    PERF_TIMER_GUARD_IF(kInstrumented, get_from_output_files_time);
     sv->current->Get(
         read_options, lkey, get_impl_options.value, timestamp, &s,
         &merge_context, &max_covering_tombstone_seq,
@@ -1825,15 +1950,15 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
         get_impl_options.get_value ? get_impl_options.callback : nullptr,
         get_impl_options.get_value ? get_impl_options.is_blob_index : nullptr,
         get_impl_options.get_value);
-    RecordTick(stats_, MEMTABLE_MISS);
+    RecordTick(stats, MEMTABLE_MISS);
   }
 
   {
-    PERF_TIMER_GUARD(get_post_process_time);
+    PERF_TIMER_GUARD_IF(kInstrumented, get_post_process_time);
 
     ReturnAndCleanupSuperVersion(cfd, sv);
 
-    RecordTick(stats_, NUMBER_KEYS_READ);
+    RecordTick(stats, NUMBER_KEYS_READ);
     size_t size = 0;
     if (s.ok()) {
       if (get_impl_options.get_value) {
@@ -1855,10 +1980,10 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
           }
         }
       }
-      RecordTick(stats_, BYTES_READ, size);
-      PERF_COUNTER_ADD(get_read_bytes, size);
+      RecordTick(stats, BYTES_READ, size);
+      PERF_COUNTER_ADD_IF(kInstrumented, get_read_bytes, size);
     }
-    RecordInHistogram(stats_, BYTES_PER_READ, size);
+    RecordInHistogram(stats, BYTES_PER_READ, size);
   }
   return s;
 }
@@ -1876,6 +2001,8 @@ std::vector<Status> DBImpl::MultiGet(
     const std::vector<ColumnFamilyHandle*>& column_family,
     const std::vector<Slice>& keys, std::vector<std::string>* values,
     std::vector<std::string>* timestamps) {
+  SpanScope span_scope(immutable_db_options_.span_tracer.get(),
+                       read_options.trace_id, "MultiGet", env_);
   PERF_CPU_TIMER_GUARD(get_cpu_nanos, env_);
   StopWatch sw(env_, stats_, DB_MULTIGET);
   PERF_TIMER_GUARD(get_snapshot_time);
@@ -1981,6 +2108,7 @@ std::vector<Status> DBImpl::MultiGet(
                                          read_options, read_callback)) {
         done = true;
         RecordTick(stats_, MEMTABLE_HIT);
+        RecordTick(stats_, IMMUTABLE_MEMTABLE_HIT);
       }
     }
     if (!done) {
@@ -2190,6 +2318,8 @@ void DBImpl::MultiGet(const ReadOptions& read_options, const size_t num_keys,
   if (num_keys == 0) {
     return;
   }
+  SpanScope span_scope(immutable_db_options_.span_tracer.get(),
+                       read_options.trace_id, "MultiGet", env_);
 
 #ifndef NDEBUG
   for (size_t i = 0; i < num_keys; ++i) {
@@ -2368,6 +2498,8 @@ void DBImpl::MultiGet(const ReadOptions& read_options,
                       const Slice* keys, PinnableSlice* values,
                       std::string* timestamps, Status* statuses,
                       const bool sorted_input) {
+  SpanScope span_scope(immutable_db_options_.span_tracer.get(),
+                       read_options.trace_id, "MultiGet", env_);
   autovector<KeyContext, MultiGetContext::MAX_BATCH_SIZE> key_context;
   autovector<KeyContext*, MultiGetContext::MAX_BATCH_SIZE> sorted_keys;
   sorted_keys.resize(num_keys);
@@ -2871,6 +3003,14 @@ Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
     // Note: no need to consider the special case of
     // last_seq_same_as_publish_seq_==false since NewIterator is overridden in
     // WritePreparedTxnDB
+    if (read_options.recycle_iterator && read_options.snapshot == nullptr) {
+      ArenaWrappedDBIter* iter = iterator_pool_->Take(cfd, read_options);
+      if (iter == nullptr) {
+        iter = NewIteratorImpl(read_options, cfd, kMaxSequenceNumber,
+                               read_callback);
+      }
+      return iterator_pool_->Wrap(iter);
+    }
     result = NewIteratorImpl(read_options, cfd,
                              (read_options.snapshot != nullptr)
                                  ? read_options.snapshot->GetSequenceNumber()
@@ -2959,6 +3099,7 @@ ArenaWrappedDBIter* DBImpl::NewIteratorImpl(const ReadOptions& read_options,
       db_iter->GetRangeDelAggregator(), snapshot,
       /* allow_unprepared_value */ true);
   db_iter->SetIterUnderDBIter(internal_iter);
+  db_iter->SetMemTable(sv->mem);
 
   return db_iter;
 }
@@ -3021,30 +3162,27 @@ const Snapshot* DBImpl::GetSnapshotForWriteConflictBoundary() {
 }
 #endif  // ROCKSDB_LITE
 
-SnapshotImpl* DBImpl::GetSnapshotImpl(bool is_write_conflict_boundary,
-                                      bool lock) {
+SnapshotImpl* DBImpl::GetSnapshotImpl(bool is_write_conflict_boundary) {
   int64_t unix_time = 0;
   env_->GetCurrentTime(&unix_time).PermitUncheckedError();  // Ignore error
-  SnapshotImpl* s = new SnapshotImpl;
-
-  if (lock) {
-    mutex_.Lock();
-  }
   // returns null if the underlying memtable does not support snapshot.
   if (!is_snapshot_supported_) {
-    if (lock) {
-      mutex_.Unlock();
-    }
-    delete s;
     return nullptr;
   }
-  auto snapshot_seq = last_seq_same_as_publish_seq_
-                          ? versions_->LastSequence()
-                          : versions_->LastPublishedSequence();
-  SnapshotImpl* snapshot =
-      snapshots_.New(s, snapshot_seq, unix_time, is_write_conflict_boundary);
-  if (lock) {
-    mutex_.Unlock();
+  SnapshotImpl* s = new SnapshotImpl;
+  SnapshotImpl* snapshot = snapshots_.New(
+      s,
+      [this]() {
+        return last_seq_same_as_publish_seq_
+                   ? versions_->LastSequence()
+                   : versions_->LastPublishedSequence();
+      },
+      unix_time, is_write_conflict_boundary);
+  if (!is_snapshot_supported_) {
+    // A column family not supporting snapshots was created concurrently
+    snapshots_.Delete(snapshot);
+    delete snapshot;
+    return nullptr;
   }
   return snapshot;
 }
@@ -3063,19 +3201,29 @@ bool CfdListContains(const CfdList& list, ColumnFamilyData* cfd) {
 
 void DBImpl::ReleaseSnapshot(const Snapshot* s) {
   const SnapshotImpl* casted_s = reinterpret_cast<const SnapshotImpl*>(s);
-  {
+  snapshots_.Delete(casted_s);
+  delete casted_s;
+
+  auto last_seq = [this]() {
+    return last_seq_same_as_publish_seq_ ? versions_->LastSequence()
+                                         : versions_->LastPublishedSequence();
+  };
+  // Only takes the DB mutex when the oldest snapshot may have moved past
+  // the threshold, which is checked on the unlocked oldest snapshot of
+  // every shard first.
+  SequenceNumber oldest_snapshot =
+      snapshots_.empty()
+          ? last_seq()
+          : static_cast<SequenceNumber>(snapshots_.GetOldestSnapshotSequence());
+  if (oldest_snapshot > bottommost_files_mark_threshold_.load()) {
     InstrumentedMutexLock l(&mutex_);
-    snapshots_.Delete(casted_s);
-    uint64_t oldest_snapshot;
-    if (snapshots_.empty()) {
-      if (last_seq_same_as_publish_seq_) {
-        oldest_snapshot = versions_->LastSequence();
-      } else {
-        oldest_snapshot = versions_->LastPublishedSequence();
-      }
-    } else {
-      oldest_snapshot = snapshots_.oldest()->number_;
+    oldest_snapshot = snapshots_.GetOldestSequence(last_seq());
+    // Snapshots taken concurrently may have been missed by the oldest
+    // snapshot applied last, which this one must not go below.
+    if (oldest_snapshot < oldest_snapshot_applied_) {
+      return;
     }
+    oldest_snapshot_applied_ = oldest_snapshot;
     // Avoid to go through every column family by checking a global threshold
     // first.
     if (oldest_snapshot > bottommost_files_mark_threshold_) {
@@ -3107,7 +3255,6 @@ void DBImpl::ReleaseSnapshot(const Snapshot* s) {
       bottommost_files_mark_threshold_ = new_bottommost_files_mark_threshold;
     }
   }
-  delete casted_s;
 }
 
 #ifndef ROCKSDB_LITE
@@ -3198,6 +3345,10 @@ DBOptions DBImpl::GetDBOptions() const {
 
 bool DBImpl::GetProperty(ColumnFamilyHandle* column_family,
                          const Slice& property, std::string* value) {
+  if (property.starts_with(DB::Properties::kZenFSPrefix)) {
+    value->clear();
+    return fs_->GetProperty(property.ToString(), value);
+  }
   const DBPropertyInfo* property_info = GetPropertyInfo(property);
   value->clear();
   auto cfd =
@@ -3251,6 +3402,12 @@ bool DBImpl::GetMapProperty(ColumnFamilyHandle* column_family,
 
 bool DBImpl::GetIntProperty(ColumnFamilyHandle* column_family,
                             const Slice& property, uint64_t* value) {
+  if (property.starts_with(DB::Properties::kZenFSPrefix)) {
+    std::string str_value;
+    if (!fs_->GetProperty(property.ToString(), &str_value)) return false;
+    Slice in(str_value);
+    return ConsumeDecimalNumber(&in, value) && in.empty();
+  }
   const DBPropertyInfo* property_info = GetPropertyInfo(property);
   if (property_info == nullptr || property_info->handle_int == nullptr) {
     return false;
@@ -3510,6 +3667,10 @@ Status DBImpl::GetUpdatesSince(
     SequenceNumber seq, std::unique_ptr<TransactionLogIterator>* iter,
     const TransactionLogIterator::ReadOptions& read_options) {
   RecordTick(stats_, GET_UPDATES_SINCE_CALLS);
+  if (immutable_db_options_.wal_streams > 1) {
+    return Status::NotSupported(
+        "GetUpdatesSince is not supported with wal_streams > 1");
+  }
   if (seq > versions_->LastSequence()) {
     return Status::NotFound("Requested sequence not yet written in the db");
   }
@@ -4818,7 +4979,101 @@ Status DBImpl::CreateColumnFamilyWithImport(
   return status;
 }
 
+namespace {
+// Reads every record of a blob file, checking its CRCs
+Status VerifyBlobFile(FileSystem* fs, const FileOptions& file_options,
+                      const std::string& fname, size_t readahead_size) {
+  std::unique_ptr<FSRandomAccessFile> file;
+  uint64_t file_size = 0;
+  IOStatus io_s = fs->NewRandomAccessFile(fname, file_options, &file, nullptr);
+  if (io_s.ok()) {
+    io_s = fs->GetFileSize(fname, IOOptions(), &file_size, nullptr);
+  }
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (file_size < BlobLogHeader::kSize + BlobLogFooter::kSize) {
+    return Status::Corruption("Blob file too small", fname);
+  }
+  std::unique_ptr<RandomAccessFileReader> file_reader(
+      new RandomAccessFileReader(std::move(file), fname));
+  RandomAccessFileReader* raw_reader = file_reader.get();
+  BlobLogSequentialReader reader(std::move(file_reader), nullptr /* env */,
+                                 nullptr /* statistics */);
+
+  BlobLogHeader header;
+  Status s = reader.ReadHeader(&header);
+  const uint64_t records_end = file_size - BlobLogFooter::kSize;
+  uint64_t prefetched_to = 0;
+  while (s.ok() && reader.GetNextByte() < records_end) {
+    if (readahead_size > 0 && reader.GetNextByte() >= prefetched_to) {
+      // Only a hint, the reads below do not depend on it
+      raw_reader->Prefetch(reader.GetNextByte(), readahead_size)
+          .PermitUncheckedError();
+      prefetched_to = reader.GetNextByte() + readahead_size;
+    }
+    BlobLogRecord record;
+    s = reader.ReadRecord(&record, BlobLogSequentialReader::kReadHeaderKeyBlob);
+  }
+  if (s.ok() && reader.GetNextByte() != records_end) {
+    s = Status::Corruption("Blob record crosses the footer");
+  }
+  if (s.ok()) {
+    BlobLogFooter footer;
+    s = reader.ReadFooter(&footer);
+  }
+  if (!s.ok()) {
+    return Status::Corruption(fname, s.ToString());
+  }
+  return s;
+}
+
+// Recomputes the full file checksum of a file, to compare it with the one
+// recorded in the MANIFEST
+Status VerifyFullFileChecksum(FileSystem* fs, FileChecksumGenFactory* factory,
+                              const std::string& fname,
+                              const std::string& expected_checksum,
+                              const std::string& expected_func_name,
+                              size_t readahead_size, bool allow_mmap_reads,
+                              std::shared_ptr<IOTracer>& io_tracer) {
+  if (expected_func_name == kUnknownFileChecksumFuncName) {
+    return Status::OK();
+  }
+  std::string checksum;
+  std::string func_name;
+  IOStatus io_s = GenerateOneFileChecksum(
+      fs, fname, factory, &checksum, &func_name, readahead_size,
+      allow_mmap_reads, io_tracer);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (func_name != expected_func_name) {
+    return Status::InvalidArgument(
+        "Checksum function name mismatch for " + fname,
+        func_name + " vs " + expected_func_name);
+  }
+  if (checksum != expected_checksum) {
+    return Status::Corruption("File checksum mismatch", fname);
+  }
+  return Status::OK();
+}
+}  // namespace
+
 Status DBImpl::VerifyChecksum(const ReadOptions& read_options) {
+  VerifyChecksumOptions verify_options;
+  // Keep the readahead of read_options
+  verify_options.readahead_size = 0;
+  return VerifyChecksum(read_options, verify_options);
+}
+
+Status DBImpl::VerifyChecksum(const ReadOptions& read_options,
+                              const VerifyChecksumOptions& verify_options) {
+  FileChecksumGenFactory* checksum_factory =
+      immutable_db_options_.file_checksum_gen_factory.get();
+  if (verify_options.verify_file_checksums && checksum_factory == nullptr) {
+    return Status::InvalidArgument(
+        "verify_file_checksums requires a file_checksum_gen_factory");
+  }
   Status s;
   std::vector<ColumnFamilyData*> cfd_list;
   {
@@ -4834,29 +5089,102 @@ Status DBImpl::VerifyChecksum(const ReadOptions& read_options) {
   for (auto cfd : cfd_list) {
     sv_list.push_back(cfd->GetReferencedSuperVersion(this));
   }
+
+  // All reads go through the rate limiter, if any
+  std::shared_ptr<FileSystem> fs = immutable_db_options_.fs;
+  if (verify_options.rate_limiter != nullptr) {
+    fs = NewReadRateLimitedFileSystem(fs, verify_options.rate_limiter);
+  }
+  CompositeEnvWrapper verify_env(env_, fs);
+  ReadOptions ro(read_options);
+  ro.fill_cache = false;
+  if (verify_options.readahead_size != 0) {
+    ro.readahead_size = verify_options.readahead_size;
+  }
+
+  struct FileToVerify {
+    size_t cf_index;
+    std::string fname;
+    bool is_blob;
+    std::string checksum;
+    std::string checksum_func_name;
+  };
+  std::vector<Options> cf_opts;
+  std::vector<FileToVerify> files;
   for (auto& sv : sv_list) {
     VersionStorageInfo* vstorage = sv->current->storage_info();
     ColumnFamilyData* cfd = sv->current->cfd();
-    Options opts;
     {
       InstrumentedMutexLock l(&mutex_);
-      opts = Options(BuildDBOptions(immutable_db_options_, mutable_db_options_),
-                     cfd->GetLatestCFOptions());
-    }
-    for (int i = 0; i < vstorage->num_non_empty_levels() && s.ok(); i++) {
-      for (size_t j = 0; j < vstorage->LevelFilesBrief(i).num_files && s.ok();
-           j++) {
-        const auto& fd = vstorage->LevelFilesBrief(i).files[j].fd;
-        std::string fname = TableFileName(cfd->ioptions()->cf_paths,
-                                          fd.GetNumber(), fd.GetPathId());
-        s = ROCKSDB_NAMESPACE::VerifySstFileChecksum(opts, file_options_,
-                                                     read_options, fname);
+      cf_opts.emplace_back(
+          BuildDBOptions(immutable_db_options_, mutable_db_options_),
+          cfd->GetLatestCFOptions());
+    }
+    cf_opts.back().env = &verify_env;
+    for (int i = 0; i < vstorage->num_non_empty_levels(); i++) {
+      for (size_t j = 0; j < vstorage->LevelFilesBrief(i).num_files; j++) {
+        const FdWithKeyRange& f = vstorage->LevelFilesBrief(i).files[j];
+        files.push_back(
+            {cf_opts.size() - 1,
+             TableFileName(cfd->ioptions()->cf_paths, f.fd.GetNumber(),
+                           f.fd.GetPathId()),
+             false /* is_blob */, f.file_metadata->file_checksum,
+             f.file_metadata->file_checksum_func_name});
       }
     }
-    if (!s.ok()) {
-      break;
+    if (verify_options.verify_blob_files) {
+      for (const auto& pair : vstorage->GetBlobFiles()) {
+        const auto& meta = pair.second;
+        files.push_back({cf_opts.size() - 1,
+                         BlobFileName(cfd->ioptions()->cf_paths.front().path,
+                                      meta->GetBlobFileNumber()),
+                         true /* is_blob */, meta->GetChecksumValue(),
+                         meta->GetChecksumMethod()});
+      }
     }
   }
+
+  std::atomic<size_t> next_file(0);
+  std::atomic<bool> failed(false);
+  port::Mutex error_mutex;
+  std::function<void()> verify_func([&]() {
+    while (!failed.load(std::memory_order_relaxed)) {
+      size_t idx = next_file.fetch_add(1);
+      if (idx >= files.size()) {
+        break;
+      }
+      const FileToVerify& file = files[idx];
+      Status file_s;
+      if (file.is_blob) {
+        file_s = VerifyBlobFile(fs.get(), file_options_, file.fname,
+                                verify_options.readahead_size);
+      } else {
+        file_s = ROCKSDB_NAMESPACE::VerifySstFileChecksum(
+            cf_opts[file.cf_index], file_options_, ro, file.fname);
+      }
+      if (file_s.ok() && verify_options.verify_file_checksums) {
+        file_s = VerifyFullFileChecksum(
+            fs.get(), checksum_factory, file.fname, file.checksum,
+            file.checksum_func_name, verify_options.readahead_size,
+            immutable_db_options_.allow_mmap_reads, io_tracer_);
+      }
+      if (!file_s.ok()) {
+        MutexLock l(&error_mutex);
+        if (s.ok()) {
+          s = file_s;
+        }
+        failed.store(true, std::memory_order_relaxed);
+      }
+    }
+  });
+  std::vector<port::Thread> threads;
+  for (int i = 1; i < verify_options.max_threads; i++) {
+    threads.emplace_back(verify_func);
+  }
+  verify_func();
+  for (auto& t : threads) {
+    t.join();
+  }
   bool defer_purge =
           immutable_db_options().avoid_unnecessary_blocking_io;
   {
@@ -4992,7 +5320,8 @@ Status DBImpl::ReserveFileNumbersBeforeIngestion(
 }
 
 Status DBImpl::GetCreationTimeOfOldestFile(uint64_t* creation_time) {
-  if (mutable_db_options_.max_open_files == -1) {
+  if (mutable_db_options_.max_open_files == -1 &&
+      !immutable_db_options_.lazy_open_table_files) {
     uint64_t oldest_time = port::kMaxUint64;
     for (auto cfd : *versions_->GetColumnFamilySet()) {
       if (!cfd->IsDropped()) {
@@ -5015,7 +5344,9 @@ Status DBImpl::GetCreationTimeOfOldestFile(uint64_t* creation_time) {
     *creation_time = oldest_time;
     return Status::OK();
   } else {
-    return Status::NotSupported("This API only works if max_open_files = -1");
+    return Status::NotSupported(
+        "This API only works if max_open_files = -1 and table files are not "
+        "opened lazily");
   }
 }
 #endif  // ROCKSDB_LITE
@@ -44,7 +44,9 @@
 #include "db/snapshot_impl.h"
 #include "db/trim_history_scheduler.h"
 #include "db/version_edit.h"
+#include "db/version_files_snapshot.h"
 #include "db/wal_manager.h"
+#include "db/write_batch_internal.h"
 #include "db/write_controller.h"
 #include "db/write_thread.h"
 #include "logging/event_logger.h"
@@ -73,13 +75,17 @@ namespace ROCKSDB_NAMESPACE {
 class Arena;
 class ArenaWrappedDBIter;
 class InMemoryStatsHistoryIterator;
+class IteratorPool;
 class MemTable;
+class OptionsAdvisor;
 class PersistentStatsHistoryIterator;
 class PeriodicWorkScheduler;
 #ifndef NDEBUG
 class PeriodicWorkTestScheduler;
 #endif  // !NDEBUG
+class BlockCacheWarmup;
 class TableCache;
+class TableMetadataCheckpoint;
 class TaskLimiterToken;
 class Version;
 class VersionEdit;
@@ -143,17 +149,16 @@ class DBImpl : public DB {
   void operator=(const DBImpl&) = delete;
 
   virtual ~DBImpl();
+  // The ZenFS callbacks below read the default column family through its
+  // files snapshot, without the DB mutex
+  std::shared_ptr<const VersionFilesSnapshot> GetDefaultFilesSnapshot();
   const InternalKeyComparator* GetDefaultICMP();
-  const Comparator* GetUserComp(){
-    const Comparator* user_cmp 
-      = versions_.get()->GetColumnFamilySet()->GetDefault()->current()->User_comparator();
-    assert(user_cmp);
-    return user_cmp;
-  }
+  const Comparator* GetUserComp();
   void FindClosestFilesWithSameLevel(const int, std::vector<uint64_t>&); 
   void AdjacentFileList(const InternalKey&, const InternalKey&, const int, std::vector<uint64_t>&); 
   void GetAllOverlappingFiles(const InternalKey& s, const InternalKey& l, std::vector<uint64_t>& fno_list);
   void SameLevelFileList(const int, std::vector<uint64_t>&); 
+  void BeingCompactedFileList(std::set<uint64_t>& fno_set);
   int Getlevel();
   // ---- Implementations of the DB interface ----
   using DB::Resume;
@@ -178,6 +183,8 @@ class DBImpl : public DB {
   using DB::Write;
   virtual Status Write(const WriteOptions& options,
                        WriteBatch* updates) override;
+  virtual void WriteAsync(const WriteOptions& options, WriteBatch* updates,
+                          std::function<void(const Status&)> callback) override;
 
   using DB::Get;
   virtual Status Get(const ReadOptions& options,
@@ -448,6 +455,9 @@ class DBImpl : public DB {
 
   using DB::VerifyChecksum;
   virtual Status VerifyChecksum(const ReadOptions& /*read_options*/) override;
+  virtual Status VerifyChecksum(
+      const ReadOptions& read_options,
+      const VerifyChecksumOptions& verify_options) override;
 
   using DB::StartTrace;
   virtual Status StartTrace(
@@ -748,6 +758,12 @@ class DBImpl : public DB {
     return num_running_compactions_;
   }
 
+  // Returns the number of table files left to open in the background with
+  // lazy_open_table_files.
+  uint64_t num_table_files_pending_open() const {
+    return num_table_files_pending_open_.load(std::memory_order_relaxed);
+  }
+
   const WriteController& write_controller() { return write_controller_; }
 
   // @param read_options Must outlive the returned iterator.
@@ -1031,6 +1047,14 @@ class DBImpl : public DB {
   // flush LOG out of application buffer
   void FlushInfoLog();
 
+  // save the data blocks to warm the block cache of the next DB::Open() up
+  // with, with block_cache_warmup_save_period_sec
+  void SaveBlockCacheWarmup();
+
+  // samples the statistics and tunes the options with, with
+  // options_advisor_period_sec
+  void RunOptionsAdvisor();
+
  protected:
   const std::string dbname_;
   std::string db_id_;
@@ -1227,6 +1251,7 @@ class DBImpl : public DB {
   friend class DB;
   friend class ErrorHandler;
   friend class InternalStats;
+  friend class OptionsAdvisor;
   friend class PessimisticTransaction;
   friend class TransactionBaseImpl;
   friend class WriteCommittedTxn;
@@ -1241,6 +1266,7 @@ class DBImpl : public DB {
 #endif
   friend struct SuperVersion;
   friend class CompactedDBImpl;
+  friend class DBImplSecondary;
   friend class DBTest_ConcurrentFlushWAL_Test;
   friend class DBTest_MixedSlowdownOptionsStop_Test;
   friend class DBCompactionTest_CompactBottomLevelFilesWithDeletions_Test;
@@ -1258,6 +1284,12 @@ class DBImpl : public DB {
   struct PrepickedCompaction;
   struct PurgeFileInfo;
 
+  // GetImpl(), with the statistics and perf context instrumentation compiled
+  // in or out
+  template <bool kInstrumented>
+  Status GetImpl(const ReadOptions& options, const Slice& key,
+                 GetImplOptions& get_impl_options);
+
   struct WriteContext {
     SuperVersionContext superversion_context;
     autovector<MemTable*> memtables_to_free_;
@@ -1279,6 +1311,9 @@ class DBImpl : public DB {
     uint64_t number;
     uint64_t size = 0;
     bool getting_flushed = false;
+    // Files of the extra WAL streams of this log, see DBOptions::wal_streams.
+    // They are deleted together with the log.
+    std::vector<uint64_t> stream_numbers;
   };
 
   struct LogWriterNumber {
@@ -1291,10 +1326,25 @@ class DBImpl : public DB {
       writer = nullptr;
       return w;
     }
+    template <class T>
+    void ReleaseStreams(T* to_free) {
+      for (auto* s : streams) {
+        to_free->push_back(s);
+      }
+      streams.clear();
+    }
     Status ClearWriter() {
       Status s = writer->WriteBuffer();
       delete writer;
       writer = nullptr;
+      for (auto* w : streams) {
+        Status ss = w->WriteBuffer();
+        if (s.ok()) {
+          s = ss;
+        }
+        delete w;
+      }
+      streams.clear();
       return s;
     }
 
@@ -1302,6 +1352,8 @@ class DBImpl : public DB {
     // Visual Studio doesn't support deque's member to be noncopyable because
     // of a std::unique_ptr as a member.
     log::Writer* writer;  // own
+    // Writers of the extra WAL streams of this log, see DBOptions::wal_streams
+    std::vector<log::Writer*> streams;  // own
     // true for some prefix of logs_
     bool getting_synced = false;
   };
@@ -1415,6 +1467,13 @@ class DBImpl : public DB {
   void DeleteObsoleteFileImpl(int job_id, const std::string& fname,
                               const std::string& path_to_sync, FileType type,
                               uint64_t number);
+  // Delete obsolete files with one FileSystem::DeleteFiles() call where
+  // the file system supports it, one by one otherwise
+  void DeleteObsoleteFilesImpl(int job_id,
+                               const std::vector<PurgeFileInfo>& files);
+  void LogObsoleteFileDeletion(int job_id, const std::string& fname,
+                               FileType type, uint64_t number,
+                               const Status& file_deletion_status);
 
   // Background process needs to call
   //     auto x = CaptureCurrentFileNumberInPendingOutputs()
@@ -1569,13 +1628,40 @@ class DBImpl : public DB {
   Status PreprocessWrite(const WriteOptions& write_options, bool* need_log_sync,
                          WriteContext* write_context);
 
-  WriteBatch* MergeBatch(const WriteThread::WriteGroup& write_group,
-                         WriteBatch* tmp_batch, size_t* write_with_wal,
-                         WriteBatch** to_be_cached_state);
+  // The WAL record of a write group. A group with a single batch to log is
+  // logged as that batch. Otherwise the record is the header of the merged
+  // batch followed by the payloads of the batches, which log::Writer appends
+  // from where they are instead of having them copied into one batch first.
+  struct WALRecord {
+    // The batch logged as it is, or nullptr if the record is merged
+    WriteBatch* batch = nullptr;
+    // Contents of the batch logged as it is
+    Slice contents;
+    // `header` followed by the payloads if the record is merged
+    char header[WriteBatchInternal::kHeader];
+    std::vector<Slice> parts;
+    size_t size = 0;
+    size_t write_with_wal = 0;
+    WriteBatch* to_be_cached_state = nullptr;
+
+    void SetSequence(SequenceNumber sequence);
+    SliceParts Parts() const {
+      return parts.empty()
+                 ? SliceParts(&contents, 1)
+                 : SliceParts(parts.data(), static_cast<int>(parts.size()));
+    }
+  };
+
+  // Collects the batches of write_group that go to the WAL into *record.
+  void GatherBatches(const WriteThread::WriteGroup& write_group,
+                     WALRecord* record);
 
   IOStatus WriteToWAL(const WriteBatch& merged_batch, log::Writer* log_writer,
                       uint64_t* log_used, uint64_t* log_size);
 
+  IOStatus WriteToWAL(const WALRecord& record, log::Writer* log_writer,
+                      uint64_t* log_used);
+
   IOStatus WriteToWAL(const WriteThread::WriteGroup& write_group,
                       log::Writer* log_writer, uint64_t* log_used,
                       bool need_log_sync, bool need_log_dir_sync,
@@ -1585,6 +1671,28 @@ class DBImpl : public DB {
                                 uint64_t* log_used,
                                 SequenceNumber* last_sequence, size_t seq_inc);
 
+  // Used by PipelinedWriteImpl when wal_streams > 1. Releases the WAL stage
+  // of write_group and appends it to the next WAL lane, then syncs all lanes
+  // once the groups released before have written if need_log_sync.
+  IOStatus WriteToWALLane(WriteThread::WriteGroup& write_group,
+                          uint64_t* log_used, bool need_log_sync,
+                          bool need_log_dir_sync, SequenceNumber sequence);
+
+  // Points the WAL lanes to the writers of logs_.back().
+  // REQUIRES: log_write_mutex_ held and no WAL lane in use.
+  void ResetWALLanes();
+
+  // Syncs the lanes appended to since their last sync.
+  IOStatus SyncWALLanes();
+
+  // Body of the threads started by WriteAsync. Runs the queued writes until
+  // the queue is empty and StopAsyncWriteThreads was called.
+  void AsyncWriteThread();
+
+  // Lets the async write threads finish the queued writes and joins them.
+  // Later WriteAsync calls fail with ShutdownInProgress.
+  void StopAsyncWriteThreads();
+
   // Used by WriteImpl to update bg_error_ if paranoid check is enabled.
   // Caller must hold mutex_.
   void WriteStatusCheckOnLocked(const Status& status);
@@ -1645,12 +1753,27 @@ class DBImpl : public DB {
   static void BGWorkBottomCompaction(void* arg);
   static void BGWorkFlush(void* arg);
   static void BGWorkPurge(void* arg);
+  static void BGWorkOpenTableFiles(void* arg);
+  static void BGWorkBlockCacheWarmup(void* arg);
   static void UnscheduleCompactionCallback(void* arg);
   static void UnscheduleFlushCallback(void* arg);
   void BackgroundCallCompaction(PrepickedCompaction* prepicked_compaction,
                                 Env::Priority thread_pri);
   void BackgroundCallFlush(Env::Priority thread_pri);
   void BackgroundCallPurge();
+  struct OpenTableFilesJob;
+  // Opens the table files not opened by DB::Open() in the background, with
+  // lazy_open_table_files
+  void MaybeScheduleOpenTableFiles();
+  void BackgroundCallOpenTableFiles(OpenTableFilesJob* job);
+  // Saves the metadata of the open table files for the next DB::Open(),
+  // with max_table_metadata_checkpoint_size
+  void SaveTableMetadataCheckpoint();
+  struct BlockCacheWarmupJob;
+  // Reads the data blocks saved by SaveBlockCacheWarmup() into the block
+  // cache in the background
+  void MaybeScheduleBlockCacheWarmup();
+  void BackgroundCallBlockCacheWarmup(BlockCacheWarmupJob* job);
   Status BackgroundCompaction(bool* madeProgress, JobContext* job_context,
                               LogBuffer* log_buffer,
                               PrepickedCompaction* prepicked_compaction,
@@ -1699,8 +1822,8 @@ class DBImpl : public DB {
   // helper function to call after some of the logs_ were synced
   void MarkLogsSynced(uint64_t up_to, bool synced_dir, const Status& status);
 
-  SnapshotImpl* GetSnapshotImpl(bool is_write_conflict_boundary,
-                                bool lock = true);
+  // Takes a snapshot without the mutex, which the caller may hold
+  SnapshotImpl* GetSnapshotImpl(bool is_write_conflict_boundary);
 
   uint64_t GetMaxTotalWalSize() const;
 
@@ -1757,6 +1880,12 @@ class DBImpl : public DB {
   IOStatus CreateWAL(uint64_t log_file_num, uint64_t recycle_log_number,
                      size_t preallocate_block_size, log::Writer** new_log);
 
+  // Creates the writers of the extra WAL streams of a new log, one per file
+  // number. Deletes the writers created so far on failure.
+  IOStatus CreateWALStreams(const std::vector<uint64_t>& stream_numbers,
+                            size_t preallocate_block_size,
+                            std::vector<log::Writer*>* streams);
+
   // Validate self-consistency of DB options
   static Status ValidateOptions(const DBOptions& db_options);
   // Validate self-consistency of DB options and its consistency with cf options
@@ -1844,6 +1973,21 @@ class DBImpl : public DB {
   // table_cache_ provides its own synchronization
   std::shared_ptr<Cache> table_cache_;
 
+  // The metadata of the table files saved at the last close, for the table
+  // cache to open them with. Null without max_table_metadata_checkpoint_size.
+  std::unique_ptr<TableMetadataCheckpoint> table_metadata_checkpoint_;
+
+  // The data blocks read through the block cache. Null without
+  // block_cache_warmup_save_period_sec.
+  std::unique_ptr<BlockCacheWarmup> block_cache_warmup_;
+
+  // Null without options_advisor_period_sec. Only run by the periodic work
+  // scheduler, which is unregistered before it is destroyed.
+  std::unique_ptr<OptionsAdvisor> options_advisor_;
+
+  // The iterators of ReadOptions::recycle_iterator deleted by the user
+  std::unique_ptr<IteratorPool> iterator_pool_;
+
   // Lock over the persistent DB state.  Non-nullptr iff successfully acquired.
   FileLock* db_lock_;
 
@@ -1938,7 +2082,23 @@ class DBImpl : public DB {
   // threads. Protected by db mutex.
   autovector<log::Writer*> logs_to_free_;
 
-  bool is_snapshot_supported_;
+  // One lane per WAL stream when wal_streams > 1, empty otherwise. Lane 0
+  // appends to logs_.back().writer, lane i to logs_.back().streams[i - 1].
+  // The writers only change in ResetWALLanes, while no group is in the WAL
+  // stage.
+  struct WALLane {
+    log::Writer* writer = nullptr;
+    // Serializes the appends and syncs of writer
+    port::Mutex mutex;
+    // Appended to since the last sync, protected by mutex
+    bool dirty = false;
+  };
+  std::vector<std::unique_ptr<WALLane>> wal_lanes_;
+  // Lane of the next write group, only accessed by the WAL stage leader
+  size_t next_wal_lane_ = 0;
+
+  // Read without the mutex by GetSnapshotImpl
+  std::atomic<bool> is_snapshot_supported_;
 
   std::map<uint64_t, std::map<std::string, uint64_t>> stats_history_;
 
@@ -1951,7 +2111,6 @@ class DBImpl : public DB {
   WriteBufferManager* write_buffer_manager_;
 
   WriteThread write_thread_;
-  WriteBatch tmp_batch_;
   // The write thread when the writers have no memtable write. This will be used
   // in 2PC to batch the prepares separately from the serial commit.
   WriteThread nonmem_write_thread_;
@@ -2038,6 +2197,13 @@ class DBImpl : public DB {
   // number of background obsolete file purge jobs, submitted to the HIGH pool
   int bg_purge_scheduled_;
 
+  // number of background table file opening jobs, submitted to the LOW pool
+  int bg_open_table_files_scheduled_;
+  std::atomic<uint64_t> num_table_files_pending_open_;
+
+  // number of background block cache warm-up jobs, submitted to the LOW pool
+  int bg_block_cache_warmup_scheduled_;
+
   std::deque<ManualCompactionState*> manual_compaction_dequeue_;
 
   // shall we disable deletion of obsolete files
@@ -2115,8 +2281,14 @@ class DBImpl : public DB {
   bool opened_successfully_;
 
   // The min threshold to triggere bottommost compaction for removing
-  // garbages, among all column families.
-  SequenceNumber bottommost_files_mark_threshold_ = kMaxSequenceNumber;
+  // garbages, among all column families. Written with the mutex held, read
+  // without it by ReleaseSnapshot.
+  std::atomic<SequenceNumber> bottommost_files_mark_threshold_{
+      kMaxSequenceNumber};
+
+  // The oldest snapshot ReleaseSnapshot last passed to
+  // VersionStorageInfo::UpdateOldestSnapshot, protected by mutex_
+  SequenceNumber oldest_snapshot_applied_ = 0;
 
   LogsWithPrepTracker logs_with_prep_tracker_;
 
@@ -2182,6 +2354,21 @@ class DBImpl : public DB {
   // installed to MANIFEST first.
   InstrumentedCondVar atomic_flush_install_cv_;
 
+  // A write queued by WriteAsync
+  struct AsyncWrite {
+    WriteOptions options;
+    WriteBatch* batch;
+    std::function<void(const Status&)> callback;
+  };
+  // Protects the async write members below
+  port::Mutex async_write_mutex_;
+  port::CondVar async_write_cv_;
+  std::deque<AsyncWrite> async_write_queue_;
+  std::vector<port::Thread> async_write_threads_;
+  // Threads waiting for async_write_queue_ to fill
+  int async_write_idle_threads_ = 0;
+  bool async_write_stopped_ = false;
+
   bool wal_in_db_path_;
 };
 
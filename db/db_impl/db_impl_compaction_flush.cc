@@ -167,6 +167,8 @@ Status DBImpl::FlushMemTableToOutputFile(
   TEST_SYNC_POINT("DBImpl::FlushMemTableToOutputFile:BeforePickMemtables");
   flush_job.PickMemTable();
   TEST_SYNC_POINT("DBImpl::FlushMemTableToOutputFile:AfterPickMemtables");
+  cfd->internal_stats()->AddRunningJob(job_context->job_id, true /* is_flush */,
+                                       0 /* output_level */);
 
 #ifndef ROCKSDB_LITE
   // may temporarily unlock and lock the mutex.
@@ -207,6 +209,8 @@ Status DBImpl::FlushMemTableToOutputFile(
   if (io_s.ok()) {
     io_s = flush_job.io_status();
   }
+  cfd->internal_stats()->RemoveRunningJob(
+      job_context->job_id, s.ok() ? file_meta.fd.GetFileSize() : 0);
   if (s.ok()) {
     InstallSuperVersionAndScheduleWork(cfd, superversion_context,
                                        mutable_cf_options);
@@ -282,6 +286,10 @@ Status DBImpl::FlushMemTableToOutputFile(
       std::string file_path = MakeTableFileName(
           cfd->ioptions()->cf_paths[0].path, file_meta.fd.GetNumber());
       sfm->OnAddFile(file_path);
+      for (const FileMetaData& meta : flush_job.GetPartitionFileMetas()) {
+        sfm->OnAddFile(MakeTableFileName(cfd->ioptions()->cf_paths[0].path,
+                                         meta.fd.GetNumber()));
+      }
       if (sfm->IsMaxAllowedSpaceReached()) {
         Status new_bg_error =
             Status::SpaceLimit("Max allowed space was reached");
@@ -403,6 +411,8 @@ Status DBImpl::AtomicFlushMemTablesToOutputFiles(
         false /* sync_output_directory */, false /* write_manifest */,
         thread_pri, io_tracer_, db_id_, db_session_id_));
     jobs.back()->PickMemTable();
+    cfd->internal_stats()->AddRunningJob(
+        job_context->job_id, true /* is_flush */, 0 /* output_level */);
   }
 
   std::vector<FileMetaData> file_meta(num_cfs);
@@ -582,6 +592,11 @@ Status DBImpl::AtomicFlushMemTablesToOutputFiles(
         &job_context->memtables_to_free, directories_.GetDbDir(), log_buffer);
   }
 
+  for (int i = 0; i != num_cfs; ++i) {
+    cfds[i]->internal_stats()->RemoveRunningJob(
+        job_context->job_id, s.ok() ? file_meta[i].fd.GetFileSize() : 0);
+  }
+
   if (s.ok()) {
     assert(num_cfs ==
            static_cast<int>(job_context->superversion_contexts.size()));
@@ -634,6 +649,10 @@ Status DBImpl::AtomicFlushMemTablesToOutputFiles(
         std::string file_path = MakeTableFileName(
             cfds[i]->ioptions()->cf_paths[0].path, file_meta[i].fd.GetNumber());
         sfm->OnAddFile(file_path);
+        for (const FileMetaData& meta : jobs[i]->GetPartitionFileMetas()) {
+          sfm->OnAddFile(MakeTableFileName(
+              cfds[i]->ioptions()->cf_paths[0].path, meta.fd.GetNumber()));
+        }
         if (sfm->IsMaxAllowedSpaceReached() &&
             error_handler_.GetBGError().ok()) {
           Status new_bg_error =
@@ -1424,7 +1443,8 @@ Status DBImpl::ReFitLevel(ColumnFamilyData* cfd, int level, int target_level) {
                    f->fd.smallest_seqno, f->fd.largest_seqno,
                    f->marked_for_compaction, f->oldest_blob_file_number,
                    f->oldest_ancester_time, f->file_creation_time,
-                   f->file_checksum, f->file_checksum_func_name);
+                   f->file_checksum, f->file_checksum_func_name,
+                   f->min_timestamp, f->max_timestamp);
     }
     ROCKS_LOG_DEBUG(immutable_db_options_.info_log,
                     "[%s] Apply version edit:\n%s", cfd->GetName().c_str(),
@@ -2871,7 +2891,8 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
                            f->fd.largest_seqno, f->marked_for_compaction,
                            f->oldest_blob_file_number, f->oldest_ancester_time,
                            f->file_creation_time, f->file_checksum,
-                           f->file_checksum_func_name);
+                           f->file_checksum_func_name,
+                           f->min_timestamp, f->max_timestamp);
 
         ROCKS_LOG_BUFFER(
             log_buffer,
@@ -2963,11 +2984,8 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
         is_manual ? &manual_compaction_paused_ : nullptr, db_id_,
         db_session_id_);
     compaction_job.Prepare();
-    //TODO::Percacluate Max and Min User level key with Compaction argument of current compaction job.
-
-    //Slice s_key, l_key;
-    //compaction_job.PreCalculateMinMaxKey(s_key, l_key);
-    //uint64_t c_fno = compaction_job.GetMeta()->fd.GetNumber();
+    c->column_family_data()->internal_stats()->AddRunningJob(
+        job_context->job_id, false /* is_flush */, c->output_level());
 
     NotifyOnCompactionBegin(c->column_family_data(), c.get(), status,
                             compaction_job_stats, job_context->job_id);
@@ -2980,6 +2998,9 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
     mutex_.Lock();
     status = compaction_job.Install(*c->mutable_cf_options());
     io_s = compaction_job.io_status();
+    c->column_family_data()->internal_stats()->RemoveRunningJob(
+        job_context->job_id,
+        status.ok() ? compaction_job_stats.total_output_bytes : 0);
     if (status.ok()) {
       InstallSuperVersionAndScheduleWork(c->column_family_data(),
                                          &job_context->superversion_contexts[0],
@@ -3271,12 +3292,13 @@ void DBImpl::InstallSuperVersionAndScheduleWork(
   // compaction may already be released here. But assuming there will always be
   // newer snapshot created and released frequently, the compaction will be
   // triggered soon anyway.
-  bottommost_files_mark_threshold_ = kMaxSequenceNumber;
+  SequenceNumber bottommost_files_mark_threshold = kMaxSequenceNumber;
   for (auto* my_cfd : *versions_->GetColumnFamilySet()) {
-    bottommost_files_mark_threshold_ = std::min(
-        bottommost_files_mark_threshold_,
+    bottommost_files_mark_threshold = std::min(
+        bottommost_files_mark_threshold,
         my_cfd->current()->storage_info()->bottommost_files_mark_threshold());
   }
+  bottommost_files_mark_threshold_ = bottommost_files_mark_threshold;
 
   // Whenever we install new SuperVersion, we might need to issue new flushes or
   // compactions.
@@ -3336,7 +3358,7 @@ void DBImpl::GetSnapshotContext(
     // in snapshot_seqs and force compaction iterator to consider such
     // snapshots.
     const Snapshot* job_snapshot =
-        GetSnapshotImpl(false /*write_conflict_boundary*/, false /*lock*/);
+        GetSnapshotImpl(false /*write_conflict_boundary*/);
     job_context->job_snapshot.reset(new ManagedSnapshot(this, job_snapshot));
   }
   *snapshot_seqs = snapshots_.GetAll(earliest_write_conflict_snapshot);
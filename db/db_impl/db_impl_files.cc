@@ -253,6 +253,9 @@ void DBImpl::FindObsoleteFiles(JobContext* job_context, bool force,
       } else {
         job_context->log_delete_files.push_back(earliest.number);
       }
+      for (uint64_t stream_number : earliest.stream_numbers) {
+        job_context->log_delete_files.push_back(stream_number);
+      }
       if (job_context->size_log_to_delete == 0) {
         job_context->prev_total_log_size = total_log_size_;
         job_context->num_alive_log_files = num_alive_log_files;
@@ -278,6 +281,7 @@ void DBImpl::FindObsoleteFiles(JobContext* job_context, bool force,
         continue;
       }
       logs_to_free_.push_back(log.ReleaseWriter());
+      log.ReleaseStreams(&logs_to_free_);
       {
         InstrumentedMutexLock wl(&log_write_mutex_);
         logs_.pop_front();
@@ -328,6 +332,50 @@ void DBImpl::DeleteObsoleteFileImpl(int job_id, const std::string& fname,
   }
   TEST_SYNC_POINT_CALLBACK("DBImpl::DeleteObsoleteFileImpl:AfterDeletion",
                            &file_deletion_status);
+  LogObsoleteFileDeletion(job_id, fname, type, number, file_deletion_status);
+}
+
+void DBImpl::DeleteObsoleteFilesImpl(int job_id,
+                                     const std::vector<PurgeFileInfo>& files) {
+  std::vector<std::string> fnames;
+  fnames.reserve(files.size());
+  for (const auto& file : files) {
+    fnames.push_back(file.fname);
+  }
+  std::vector<IOStatus> statuses;
+  IOStatus io_s = fs_->DeleteFiles(fnames, IOOptions(), &statuses, nullptr);
+  if (io_s.IsNotSupported()) {
+    for (const auto& file : files) {
+      DeleteObsoleteFileImpl(job_id, file.fname, file.dir_to_sync, file.type,
+                             file.number);
+    }
+    return;
+  }
+  statuses.resize(files.size(), io_s);
+
+#ifndef ROCKSDB_LITE
+  // As DeleteDBFile(), which passes these files to the SstFileManager
+  // unless wal_in_db_path_ is false
+  SstFileManagerImpl* sfm = static_cast<SstFileManagerImpl*>(
+      immutable_db_options_.sst_file_manager.get());
+#endif  // !ROCKSDB_LITE
+  for (size_t i = 0; i < files.size(); i++) {
+    Status file_deletion_status = io_s.ok() ? statuses[i] : io_s;
+#ifndef ROCKSDB_LITE
+    if (file_deletion_status.ok() && sfm != nullptr && wal_in_db_path_) {
+      sfm->OnDeleteFile(files[i].fname).PermitUncheckedError();
+    }
+#endif  // !ROCKSDB_LITE
+    TEST_SYNC_POINT_CALLBACK("DBImpl::DeleteObsoleteFileImpl:AfterDeletion",
+                             &file_deletion_status);
+    LogObsoleteFileDeletion(job_id, files[i].fname, files[i].type,
+                            files[i].number, file_deletion_status);
+  }
+}
+
+void DBImpl::LogObsoleteFileDeletion(int job_id, const std::string& fname,
+                                     FileType type, uint64_t number,
+                                     const Status& file_deletion_status) {
   if (file_deletion_status.ok()) {
     ROCKS_LOG_DEBUG(immutable_db_options_.info_log,
                     "[JOB %d] Delete %s type=%d #%" PRIu64 " -- %s\n", job_id,
@@ -455,6 +503,18 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
 
   bool own_files = OwnTablesAndLogs();
   std::unordered_set<uint64_t> files_to_del;
+  // Table, blob and WAL files are deleted together, unless the
+  // SstFileManager throttles their deletion. On ZenFS this takes a single
+  // metadata record instead of one per file.
+#ifndef ROCKSDB_LITE
+  SstFileManagerImpl* sfm = static_cast<SstFileManagerImpl*>(
+      immutable_db_options_.sst_file_manager.get());
+  const bool batch_deletions =
+      sfm == nullptr || sfm->GetDeleteRateBytesPerSecond() <= 0;
+#else
+  const bool batch_deletions = true;
+#endif  // !ROCKSDB_LITE
+  std::vector<PurgeFileInfo> files_to_batch;
   for (const auto& candidate_file : candidate_files) {
     const std::string& to_delete = candidate_file.file_name;
     uint64_t number;
@@ -526,6 +586,8 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
       case kDBLockFile:
       case kIdentityFile:
       case kMetaDatabase:
+      case kTableMetadataFile:
+      case kBlockCacheWarmupFile:
         keep = true;
         break;
     }
@@ -572,10 +634,17 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
     if (schedule_only) {
       InstrumentedMutexLock guard_lock(&mutex_);
       SchedulePendingPurge(fname, dir_to_sync, type, number, state.job_id);
+    } else if (batch_deletions && (type == kTableFile || type == kBlobFile ||
+                                   type == kWalFile)) {
+      files_to_batch.emplace_back(fname, dir_to_sync, type, number,
+                                  state.job_id);
     } else {
       DeleteObsoleteFileImpl(state.job_id, fname, dir_to_sync, type, number);
     }
   }
+  if (!files_to_batch.empty()) {
+    DeleteObsoleteFilesImpl(state.job_id, files_to_batch);
+  }
 
   {
     // After purging obsolete files, remove them from files_grabbed_for_purge_.
@@ -8,19 +8,24 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include <cinttypes>
 
+#include "db/block_cache_warmup.h"
 #include "db/builder.h"
 #include "db/db_impl/db_impl.h"
 #include "db/error_handler.h"
 #include "db/periodic_work_scheduler.h"
+#include "db/table_metadata_checkpoint.h"
 #include "env/composite_env_wrapper.h"
 #include "file/read_write_util.h"
 #include "file/sst_file_manager_impl.h"
 #include "file/writable_file_writer.h"
+#include "monitoring/iostats_context_imp.h"
 #include "monitoring/persistent_stats_history.h"
 #include "options/options_helper.h"
 #include "rocksdb/table.h"
 #include "rocksdb/wal_filter.h"
 #include "test_util/sync_point.h"
+#include "util/compression.h"
+#include "util/mutexlock.h"
 #include "util/rate_limiter.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -254,6 +259,34 @@ Status DBImpl::ValidateOptions(const DBOptions& db_options) {
         "atomic_flush is incompatible with enable_pipelined_write");
   }
 
+  if (db_options.wal_streams == 0) {
+    return Status::InvalidArgument("wal_streams must be greater than 0");
+  }
+
+  if (db_options.max_async_write_threads < 1) {
+    return Status::InvalidArgument(
+        "max_async_write_threads must be greater than 0");
+  }
+
+  if (db_options.wal_streams > 1) {
+    if (!db_options.enable_pipelined_write) {
+      return Status::InvalidArgument(
+          "wal_streams > 1 requires enable_pipelined_write");
+    }
+    if (db_options.manual_wal_flush || db_options.recycle_log_file_num > 0 ||
+        db_options.allow_2pc) {
+      return Status::NotSupported(
+          "wal_streams > 1 is incompatible with manual_wal_flush, "
+          "recycle_log_file_num and allow_2pc");
+    }
+  }
+
+  if (!StreamingCompressionTypeSupported(db_options.wal_compression)) {
+    return Status::InvalidArgument(
+        "wal_compression is not supported: " +
+        CompressionTypeToString(db_options.wal_compression));
+  }
+
   // TODO remove this restriction
   if (db_options.atomic_flush && db_options.best_efforts_recovery) {
     return Status::InvalidArgument(
@@ -455,6 +488,28 @@ Status DBImpl::Recover(
         }
       }
     }
+    // Read once: the tables it describes may be gone by the next open
+    const std::string metadata_fname = TableMetadataFileName(dbname_);
+    if (table_metadata_checkpoint_ != nullptr) {
+      Status load_s =
+          table_metadata_checkpoint_->Load(fs_.get(), metadata_fname);
+      if (load_s.ok()) {
+        ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                       "Read the metadata of %" ROCKSDB_PRIszt
+                       " table files from %s",
+                       table_metadata_checkpoint_->NumTails(),
+                       metadata_fname.c_str());
+      } else if (!load_s.IsNotFound()) {
+        ROCKS_LOG_WARN(immutable_db_options_.info_log, "Ignoring %s: %s",
+                       metadata_fname.c_str(), load_s.ToString().c_str());
+      }
+    }
+    if (env_->FileExists(metadata_fname).ok()) {
+      s = env_->DeleteFile(metadata_fname);
+      if (!s.ok()) {
+        return s;
+      }
+    }
   } else if (immutable_db_options_.best_efforts_recovery) {
     assert(files_in_dbname.empty());
     Status s = env_->GetChildren(dbname_, &files_in_dbname);
@@ -793,6 +848,121 @@ Status DBImpl::InitPersistStatsColumnFamily() {
 }
 
 // REQUIRES: wal_numbers are sorted in ascending order
+namespace {
+// Reads the records of a WAL on its own thread, ahead of the replay. The
+// corruptions found while reading are reported to the replay's reporter in
+// order with the records, as if the replay read the log itself.
+class WalReadAhead : public log::Reader::Reporter {
+ public:
+  // At most this many bytes of records are read ahead
+  static const size_t kMaxBufferedBytes = 4 << 20;
+
+  WalReadAhead(log::Reader::Reporter* reporter, WALRecoveryMode mode)
+      : reporter_(reporter), mode_(mode), cv_(&mu_) {}
+
+  ~WalReadAhead() override {
+    {
+      MutexLock l(&mu_);
+      stop_ = true;
+      cv_.SignalAll();
+    }
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  // Starts reading from *reader, which must report to this object and
+  // outlive it.
+  void Start(log::Reader* reader) {
+    thread_ = port::Thread([this, reader]() { ReadAll(reader); });
+  }
+
+  // Same as log::Reader::ReadRecord().
+  bool ReadRecord(Slice* record, std::string* scratch) {
+    MutexLock l(&mu_);
+    while (true) {
+      while (entries_.empty() && !done_) {
+        cv_.Wait();
+      }
+      if (entries_.empty()) {
+        return false;
+      }
+      Entry entry = std::move(entries_.front());
+      entries_.pop_front();
+      buffered_ -= entry.record.size();
+      cv_.SignalAll();
+      if (!entry.corruption) {
+        scratch->swap(entry.record);
+        *record = Slice(*scratch);
+        return true;
+      }
+      mu_.Unlock();
+      reporter_->Corruption(entry.bytes, entry.status);
+      mu_.Lock();
+    }
+  }
+
+  // Called by the log reader on the read-ahead thread
+  void Corruption(size_t bytes, const Status& status) override {
+    MutexLock l(&mu_);
+    Entry entry;
+    entry.corruption = true;
+    entry.bytes = bytes;
+    entry.status = status;
+    entries_.push_back(std::move(entry));
+    cv_.SignalAll();
+  }
+
+ private:
+  struct Entry {
+    std::string record;
+    bool corruption = false;
+    size_t bytes = 0;
+    Status status;
+  };
+
+  void ReadAll(log::Reader* reader) {
+    Slice record;
+    std::string scratch;
+    bool more = true;
+    while (more) {
+      more = reader->ReadRecord(&record, &scratch, mode_);
+      MutexLock l(&mu_);
+      if (more) {
+        Entry entry;
+        entry.record.assign(record.data(), record.size());
+        buffered_ += entry.record.size();
+        entries_.push_back(std::move(entry));
+        cv_.SignalAll();
+      }
+      while (buffered_ > kMaxBufferedBytes && !stop_) {
+        cv_.Wait();
+      }
+      if (stop_) {
+        break;
+      }
+    }
+    MutexLock l(&mu_);
+    done_ = true;
+    cv_.SignalAll();
+  }
+
+  log::Reader::Reporter* const reporter_;
+  const WALRecoveryMode mode_;
+  port::Mutex mu_;
+  port::CondVar cv_;
+  std::deque<Entry> entries_;
+  size_t buffered_ = 0;
+  bool done_ = false;
+  bool stop_ = false;
+  port::Thread thread_;
+};
+
+// The bytes of batches inserted into the memtables at once when replaying
+// the WALs on several threads
+const size_t kWalReplayGroupBytes = 4 << 20;
+}  // namespace
+
 Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                                SequenceNumber* next_sequence, bool read_only,
                                bool* corrupted_wal_found) {
@@ -853,6 +1023,182 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
   bool flushed = false;
   uint64_t corrupted_wal_number = kMaxSequenceNumber;
   uint64_t min_wal_number = MinLogNumberToKeep();
+
+  // Flushes the memtables that filled up with batches of WAL wal_number,
+  // whose replay continues from sequence `next`. Errors set *fatal as they
+  // must fail the recovery rather than count as a corrupted record.
+  auto flush_full_memtables = [&](uint64_t b_wal_number, SequenceNumber next,
+                                  bool* fatal) {
+    Status s;
+    if (read_only) {
+      return s;
+    }
+    // we can do this because this is called before client has access to the
+    // DB and there is only a single thread operating on DB
+    ColumnFamilyData* cfd;
+
+    while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+      cfd->UnrefAndTryDelete();
+      // If this asserts, it means that InsertInto failed in
+      // filtering updates to already-flushed column families
+      assert(cfd->GetLogNumber() <= b_wal_number);
+      (void)b_wal_number;
+      auto iter = version_edits.find(cfd->GetID());
+      assert(iter != version_edits.end());
+      VersionEdit* edit = &iter->second;
+      s = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
+      if (!s.ok()) {
+        // Reflect errors immediately so that conditions like full
+        // file-systems cause the DB::Open() to fail.
+        *fatal = true;
+        return s;
+      }
+      flushed = true;
+
+      cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(), next);
+    }
+    return s;
+  };
+
+  // Inserts a batch read from WAL wal_number into the memtables and flushes
+  // the memtables that filled up. *batch_next is set past the batch. Errors
+  // that must fail the recovery rather than count as a corrupted record set
+  // *fatal.
+  auto insert_batch = [&](WriteBatch* b, uint64_t b_wal_number,
+                          SequenceNumber* batch_next, bool* fatal) {
+    // If column family was not found, it might mean that the WAL write
+    // batch references to the column family that was dropped after the
+    // insert. We don't want to fail the whole write batch in that case --
+    // we just ignore the update.
+    // That's why we set ignore missing column families to true
+    bool has_valid_writes = false;
+    Status s = WriteBatchInternal::InsertInto(
+        b, column_family_memtables_.get(), &flush_scheduler_,
+        &trim_history_scheduler_, true, b_wal_number, this,
+        false /* concurrent_memtable_writes */, batch_next, &has_valid_writes,
+        seq_per_batch_, batch_per_txn_);
+    MaybeIgnoreError(&s);
+    if (!s.ok()) {
+      return s;
+    }
+
+    if (has_valid_writes) {
+      s = flush_full_memtables(b_wal_number, *batch_next, fatal);
+    }
+    return s;
+  };
+
+  // With wal_recovery_threads > 1 the batches are inserted in groups, each
+  // group on several threads with concurrent memtable writes.
+  const int replay_threads = immutable_db_options_.wal_recovery_threads;
+  bool parallel_replay =
+      replay_threads > 1 &&
+      immutable_db_options_.allow_concurrent_memtable_write &&
+      !immutable_db_options_.allow_2pc && !seq_per_batch_ &&
+      immutable_db_options_.wal_streams <= 1;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->GetLatestMutableCFOptions()->max_successive_merges > 0) {
+      parallel_replay = false;
+    }
+  }
+  struct PendingBatch {
+    WriteBatch batch;
+    size_t record_size;
+    Status status;
+    SequenceNumber next = kMaxSequenceNumber;
+    bool has_valid_writes = false;
+  };
+  std::vector<PendingBatch> pending_batches;
+  size_t pending_bytes = 0;
+  // Inserts the pending batches of WAL wal_number and flushes the memtables
+  // that filled up. On a batch that fails to insert, sets *failed_size to
+  // the size of its record and returns its status. *fatal is set as in
+  // insert_batch.
+  auto insert_pending = [&](uint64_t b_wal_number, size_t* failed_size,
+                            bool* fatal) {
+    std::atomic<size_t> next_index(0);
+    auto insert = [&]() {
+      ColumnFamilyMemTablesImpl column_family_memtables(
+          versions_->GetColumnFamilySet());
+      size_t i;
+      while ((i = next_index.fetch_add(1, std::memory_order_relaxed)) <
+             pending_batches.size()) {
+        PendingBatch& pending = pending_batches[i];
+        // Missing column families are ignored, see insert_batch
+        pending.status = WriteBatchInternal::InsertInto(
+            &pending.batch, &column_family_memtables, &flush_scheduler_,
+            &trim_history_scheduler_, true, b_wal_number, this,
+            true /* concurrent_memtable_writes */, &pending.next,
+            &pending.has_valid_writes, seq_per_batch_, batch_per_txn_);
+      }
+    };
+    std::vector<port::Thread> threads;
+    const size_t num_threads = std::min(
+        pending_batches.size(), static_cast<size_t>(replay_threads));
+    for (size_t i = 1; i < num_threads; i++) {
+      threads.emplace_back(insert);
+    }
+    insert();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    Status s;
+    bool has_valid_writes = false;
+    for (auto& pending : pending_batches) {
+      s = pending.status;
+      MaybeIgnoreError(&s);
+      if (!s.ok()) {
+        *failed_size = pending.record_size;
+        break;
+      }
+      *next_sequence = pending.next;
+      has_valid_writes |= pending.has_valid_writes;
+    }
+    pending_batches.clear();
+    pending_bytes = 0;
+    if (has_valid_writes) {
+      Status flush_s =
+          flush_full_memtables(b_wal_number, *next_sequence, fatal);
+      if (!flush_s.ok()) {
+        s = flush_s;
+      }
+    }
+    return s;
+  };
+
+  // With several WAL streams the batches of one log are spread over several
+  // files, in no particular order. Batches past the next expected sequence
+  // are held back until the batches before them are replayed.
+  const bool merge_streams = immutable_db_options_.wal_streams > 1;
+  SequenceNumber stream_next = versions_->LastSequence() + 1;
+  std::multimap<SequenceNumber, std::pair<uint64_t, WriteBatch>>
+      held_batches;
+  // Inserts a batch of the streams and the held batches it makes replayable
+  auto insert_stream_batch = [&](WriteBatch* b, uint64_t b_wal_number,
+                                 bool* fatal) {
+    Status s;
+    while (true) {
+      SequenceNumber batch_next = kMaxSequenceNumber;
+      s = insert_batch(b, b_wal_number, &batch_next, fatal);
+      if (!s.ok()) {
+        break;
+      }
+      if (*next_sequence == kMaxSequenceNumber ||
+          batch_next > *next_sequence) {
+        *next_sequence = batch_next;
+      }
+      stream_next = std::max(stream_next, batch_next);
+      if (held_batches.empty() || held_batches.begin()->first > stream_next) {
+        break;
+      }
+      auto held = held_batches.begin();
+      b_wal_number = held->second.first;
+      *b = std::move(held->second.second);
+      held_batches.erase(held);
+    }
+    return s;
+  };
   for (auto wal_number : wal_numbers) {
     if (wal_number < min_wal_number) {
       ROCKS_LOG_INFO(immutable_db_options_.info_log,
@@ -921,21 +1267,38 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     // paranoid_checks==false so that corruptions cause entire commits
     // to be skipped instead of propagating bad information (like overly
     // large sequence numbers).
-    log::Reader reader(immutable_db_options_.info_log, std::move(file_reader),
-                       &reporter, true /*checksum*/, wal_number);
+    // With wal_recovery_threads > 1 the log is read by a WalReadAhead, which
+    // is declared last so that its thread stops before the reader goes away.
+    std::unique_ptr<log::Reader> reader;
+    std::unique_ptr<WalReadAhead> read_ahead;
+    if (replay_threads > 1) {
+      read_ahead.reset(new WalReadAhead(
+          &reporter, immutable_db_options_.wal_recovery_mode));
+    }
+    reader.reset(new log::Reader(
+        immutable_db_options_.info_log, std::move(file_reader),
+        read_ahead ? static_cast<log::Reader::Reporter*>(read_ahead.get())
+                   : &reporter,
+        true /*checksum*/, wal_number));
 
     // Determine if we should tolerate incomplete records at the tail end of the
     // Read all the records and add to a memtable
     std::string scratch;
     Slice record;
     WriteBatch batch;
+    auto read_record = [&]() {
+      return read_ahead ? read_ahead->ReadRecord(&record, &scratch)
+                        : reader->ReadRecord(
+                              &record, &scratch,
+                              immutable_db_options_.wal_recovery_mode);
+    };
 
     TEST_SYNC_POINT_CALLBACK("DBImpl::RecoverLogFiles:BeforeReadWal",
                              /*arg=*/nullptr);
-    while (!stop_replay_by_wal_filter &&
-           reader.ReadRecord(&record, &scratch,
-                             immutable_db_options_.wal_recovery_mode) &&
-           status.ok()) {
+    if (read_ahead) {
+      read_ahead->Start(reader.get());
+    }
+    while (!stop_replay_by_wal_filter && read_record() && status.ok()) {
       if (record.size() < WriteBatchInternal::kHeader) {
         reporter.Corruption(record.size(),
                             Status::Corruption("log record too small"));
@@ -1041,49 +1404,46 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       }
 #endif  // ROCKSDB_LITE
 
-      // If column family was not found, it might mean that the WAL write
-      // batch references to the column family that was dropped after the
-      // insert. We don't want to fail the whole write batch in that case --
-      // we just ignore the update.
-      // That's why we set ignore missing column families to true
-      bool has_valid_writes = false;
-      status = WriteBatchInternal::InsertInto(
-          &batch, column_family_memtables_.get(), &flush_scheduler_,
-          &trim_history_scheduler_, true, wal_number, this,
-          false /* concurrent_memtable_writes */, next_sequence,
-          &has_valid_writes, seq_per_batch_, batch_per_txn_);
-      MaybeIgnoreError(&status);
+      bool fatal = false;
+      size_t failed_size = record.size();
+      if (parallel_replay) {
+        pending_bytes += record.size();
+        pending_batches.emplace_back();
+        pending_batches.back().batch = std::move(batch);
+        pending_batches.back().record_size = record.size();
+        if (pending_bytes >= kWalReplayGroupBytes) {
+          status = insert_pending(wal_number, &failed_size, &fatal);
+        }
+      } else if (!merge_streams) {
+        status = insert_batch(&batch, wal_number, next_sequence, &fatal);
+      } else if (sequence > stream_next) {
+        held_batches.emplace(sequence, std::make_pair(wal_number, batch));
+      } else {
+        status = insert_stream_batch(&batch, wal_number, &fatal);
+      }
+      if (fatal) {
+        return status;
+      }
       if (!status.ok()) {
         // We are treating this as a failure while reading since we read valid
         // blocks that do not form coherent data
-        reporter.Corruption(record.size(), status);
+        reporter.Corruption(failed_size, status);
         continue;
       }
+    }
 
-      if (has_valid_writes && !read_only) {
-        // we can do this because this is called before client has access to the
-        // DB and there is only a single thread operating on DB
-        ColumnFamilyData* cfd;
-
-        while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
-          cfd->UnrefAndTryDelete();
-          // If this asserts, it means that InsertInto failed in
-          // filtering updates to already-flushed column families
-          assert(cfd->GetLogNumber() <= wal_number);
-          auto iter = version_edits.find(cfd->GetID());
-          assert(iter != version_edits.end());
-          VersionEdit* edit = &iter->second;
-          status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
-          if (!status.ok()) {
-            // Reflect errors immediately so that conditions like full
-            // file-systems cause the DB::Open() to fail.
-            return status;
-          }
-          flushed = true;
-
-          cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
-                                 *next_sequence);
-        }
+    if (!pending_batches.empty()) {
+      // The pending batches were read before whatever ended the replay of
+      // this log, so they are replayed first
+      bool fatal = false;
+      size_t failed_size = 0;
+      Status s = insert_pending(wal_number, &failed_size, &fatal);
+      if (fatal) {
+        return s;
+      }
+      if (!s.ok()) {
+        reporter.Corruption(failed_size, s);
+        status = s;
       }
     }
 
@@ -1140,6 +1500,51 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       versions_->SetLastSequence(last_sequence);
     }
   }
+  if (status.ok() && !held_batches.empty()) {
+    // The batches before the gap were never synced, so neither were the held
+    // batches. Only kSkipAnyCorruptedRecords replays past the gap.
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "%s %" ROCKSDB_PRIszt
+                   " batches of WAL streams past missing seq #%" PRIu64,
+                   immutable_db_options_.wal_recovery_mode ==
+                           WALRecoveryMode::kSkipAnyCorruptedRecords
+                       ? "Replaying"
+                       : "Dropping",
+                   held_batches.size(), stream_next);
+    if (immutable_db_options_.wal_recovery_mode ==
+        WALRecoveryMode::kSkipAnyCorruptedRecords) {
+      while (status.ok() && !held_batches.empty()) {
+        auto held = held_batches.begin();
+        uint64_t held_wal_number = held->second.first;
+        WriteBatch held_batch(std::move(held->second.second));
+        held_batches.erase(held);
+        stream_next = WriteBatchInternal::Sequence(&held_batch);
+        bool fatal = false;
+        status = insert_stream_batch(&held_batch, held_wal_number, &fatal);
+        if (!fatal) {
+          status = Status::OK();
+        }
+      }
+      if (!status.ok()) {
+        return status;
+      }
+    } else {
+      // Flush what was replayed so that the WAL files, and the dropped
+      // batches whose sequence numbers new writes reuse, become obsolete.
+      flushed = true;
+    }
+    held_batches.clear();
+    flush_scheduler_.Clear();
+    trim_history_scheduler_.Clear();
+    auto last_sequence = *next_sequence - 1;
+    if ((*next_sequence != kMaxSequenceNumber) &&
+        (versions_->LastSequence() <= last_sequence)) {
+      versions_->SetLastAllocatedSequence(last_sequence);
+      versions_->SetLastPublishedSequence(last_sequence);
+      versions_->SetLastSequence(last_sequence);
+    }
+  }
+
   // Compare the corrupted log number to all columnfamily's current log number.
   // Abort Open() if any column family's log number is greater than
   // the corrupted log number, which means CF contains data beyond the point of
@@ -1402,7 +1807,8 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
                   meta.fd.smallest_seqno, meta.fd.largest_seqno,
                   meta.marked_for_compaction, meta.oldest_blob_file_number,
                   meta.oldest_ancester_time, meta.file_creation_time,
-                  meta.file_checksum, meta.file_checksum_func_name);
+                  meta.file_checksum, meta.file_checksum_func_name,
+                  meta.min_timestamp, meta.max_timestamp);
 
     edit->SetBlobFileAdditions(std::move(blob_file_additions));
   }
@@ -1503,7 +1909,35 @@ IOStatus DBImpl::CreateWAL(uint64_t log_file_num, uint64_t recycle_log_number,
         nullptr /* stats */, listeners));
     *new_log = new log::Writer(std::move(file_writer), log_file_num,
                                immutable_db_options_.recycle_log_file_num > 0,
-                               immutable_db_options_.manual_wal_flush);
+                               immutable_db_options_.manual_wal_flush,
+                               immutable_db_options_.wal_compression);
+    io_s = (*new_log)->AddCompressionTypeRecord();
+    if (!io_s.ok()) {
+      delete *new_log;
+      *new_log = nullptr;
+    }
+  }
+  return io_s;
+}
+
+IOStatus DBImpl::CreateWALStreams(const std::vector<uint64_t>& stream_numbers,
+                                  size_t preallocate_block_size,
+                                  std::vector<log::Writer*>* streams) {
+  IOStatus io_s;
+  for (uint64_t stream_number : stream_numbers) {
+    log::Writer* stream = nullptr;
+    io_s = CreateWAL(stream_number, 0 /*recycle_log_number*/,
+                     preallocate_block_size, &stream);
+    if (!io_s.ok()) {
+      break;
+    }
+    streams->push_back(stream);
+  }
+  if (!io_s.ok()) {
+    for (auto* stream : *streams) {
+      delete stream;
+    }
+    streams->clear();
   }
   return io_s;
 }
@@ -1572,16 +2006,32 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
   s = impl->Recover(column_families, false, false, false, &recovered_seq);
   if (s.ok()) {
     uint64_t new_log_number = impl->versions_->NewFileNumber();
+    std::vector<uint64_t> stream_numbers;
+    for (size_t i = 1; i < impl->wal_lanes_.size(); i++) {
+      stream_numbers.push_back(impl->versions_->NewFileNumber());
+    }
     log::Writer* new_log = nullptr;
+    std::vector<log::Writer*> streams;
     const size_t preallocate_block_size =
         impl->GetWalPreallocateBlockSize(max_write_buffer_size);
     s = impl->CreateWAL(new_log_number, 0 /*recycle_log_number*/,
                         preallocate_block_size, &new_log);
+    if (s.ok() && !stream_numbers.empty()) {
+      s = impl->CreateWALStreams(stream_numbers, preallocate_block_size,
+                                 &streams);
+      if (!s.ok()) {
+        delete new_log;
+      }
+    }
     if (s.ok()) {
       InstrumentedMutexLock wl(&impl->log_write_mutex_);
       impl->logfile_number_ = new_log_number;
       assert(new_log != nullptr);
       impl->logs_.emplace_back(new_log_number, new_log);
+      if (!impl->wal_lanes_.empty()) {
+        impl->logs_.back().streams = streams;
+        impl->ResetWALLanes();
+      }
     }
 
     if (s.ok()) {
@@ -1595,10 +2045,12 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
           impl->NewThreadStatusCfInfo(cfd);
         } else {
           if (db_options.create_missing_column_families) {
-            // missing column family, create it
+            // missing column family, create it. The OPTIONS file is
+            // written once at the end of the open rather than for each
+            // of them, as CreateColumnFamily() would.
             ColumnFamilyHandle* handle;
             impl->mutex_.Unlock();
-            s = impl->CreateColumnFamily(cf.options, cf.name, &handle);
+            s = impl->CreateColumnFamilyImpl(cf.options, cf.name, &handle);
             impl->mutex_.Lock();
             if (s.ok()) {
               handles->push_back(handle);
@@ -1624,6 +2076,7 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
       }
       impl->alive_log_files_.push_back(
           DBImpl::LogFileNumberSize(impl->logfile_number_));
+      impl->alive_log_files_.back().stream_numbers = stream_numbers;
       if (impl->two_write_queues_) {
         impl->log_write_mutex_.Unlock();
       }
@@ -1703,6 +2156,15 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
     *dbptr = impl;
     impl->opened_successfully_ = true;
     impl->MaybeScheduleFlushOrCompaction();
+    impl->MaybeScheduleOpenTableFiles();
+    impl->MaybeScheduleBlockCacheWarmup();
+    // With a table cache of no capacity limit, all the tables are open by
+    // now or by the background job, which drops the tails left
+    if (impl->table_metadata_checkpoint_ != nullptr &&
+        impl->mutable_db_options_.max_open_files == -1 &&
+        impl->bg_open_table_files_scheduled_ == 0) {
+      impl->table_metadata_checkpoint_->Clear();
+    }
   } else {
     persist_options_status.PermitUncheckedError();
   }
@@ -1816,4 +2278,400 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
   }
   return s;
 }
+
+struct DBImpl::OpenTableFilesJob {
+  struct ColumnFamily {
+    ColumnFamilyData* cfd;
+    // Referenced until the job ends
+    Version* version;
+    std::shared_ptr<const SliceTransform> prefix_extractor;
+    size_t max_file_size_for_l0_meta_pin;
+  };
+  struct File {
+    size_t cf_index;
+    FileMetaData* file_meta;
+    int level;
+  };
+
+  DBImpl* db;
+  std::vector<ColumnFamily> column_families;
+  // The L0 files of all the column families first, the last level last
+  std::vector<File> files;
+};
+
+void DBImpl::MaybeScheduleOpenTableFiles() {
+  mutex_.AssertHeld();
+  if (!immutable_db_options_.lazy_open_table_files ||
+      table_cache_->GetCapacity() != TableCache::kInfiniteCapacity) {
+    return;
+  }
+
+  OpenTableFilesJob* job = new OpenTableFilesJob();
+  job->db = this;
+  int num_levels = 0;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped()) {
+      continue;
+    }
+    cfd->Ref();
+    Version* version = cfd->current();
+    version->Ref();
+    const MutableCFOptions* cf_options = cfd->GetLatestMutableCFOptions();
+    job->column_families.push_back({cfd, version, cf_options->prefix_extractor,
+                                    MaxFileSizeForL0MetaPin(*cf_options)});
+    num_levels = std::max(num_levels, version->storage_info()->num_levels());
+  }
+  for (int level = 0; level < num_levels; level++) {
+    for (size_t i = 0; i < job->column_families.size(); i++) {
+      const VersionStorageInfo* vstorage =
+          job->column_families[i].version->storage_info();
+      if (level >= vstorage->num_levels()) {
+        continue;
+      }
+      for (FileMetaData* f : vstorage->LevelFiles(level)) {
+        if (f->fd.table_reader == nullptr) {
+          job->files.push_back({i, f, level});
+        }
+      }
+    }
+  }
+
+  num_table_files_pending_open_.store(job->files.size(),
+                                      std::memory_order_relaxed);
+  bg_open_table_files_scheduled_++;
+  env_->Schedule(&DBImpl::BGWorkOpenTableFiles, job, Env::Priority::LOW,
+                 nullptr);
+}
+
+void DBImpl::BGWorkOpenTableFiles(void* arg) {
+  IOSTATS_SET_THREAD_POOL_ID(Env::Priority::LOW);
+  TEST_SYNC_POINT("DBImpl::BGWorkOpenTableFiles:Start");
+  OpenTableFilesJob* job = reinterpret_cast<OpenTableFilesJob*>(arg);
+  job->db->BackgroundCallOpenTableFiles(job);
+  TEST_SYNC_POINT("DBImpl::BGWorkOpenTableFiles:End");
+}
+
+void DBImpl::BackgroundCallOpenTableFiles(OpenTableFilesJob* job) {
+  const uint64_t start_micros = env_->NowMicros();
+  const size_t num_files = job->files.size();
+  // Logs the progress at every tenth of the files
+  const size_t progress_step = std::max<size_t>(num_files / 10, 1);
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "Opening %" ROCKSDB_PRIszt " table files in the background",
+                 num_files);
+
+  std::atomic<size_t> next_file(0);
+  std::atomic<size_t> num_opened(0);
+  std::atomic<size_t> num_failed(0);
+  std::function<void()> open_files_func([&]() {
+    while (!shutting_down_.load(std::memory_order_acquire)) {
+      size_t file_idx = next_file.fetch_add(1);
+      if (file_idx >= num_files) {
+        break;
+      }
+      const OpenTableFilesJob::File& file = job->files[file_idx];
+      const OpenTableFilesJob::ColumnFamily& cf =
+          job->column_families[file.cf_index];
+      // The handle is released right away: the table reader stays in the
+      // table cache, which has no capacity limit, for the reads to find it
+      Cache::Handle* handle = nullptr;
+      Status s = cf.cfd->table_cache()->FindTable(
+          ReadOptions(), file_options_, cf.cfd->internal_comparator(),
+          file.file_meta->fd, &handle, cf.prefix_extractor.get(),
+          false /* no_io */, true /* record_read_stats */,
+          cf.cfd->internal_stats()->GetFileReadHist(file.level),
+          false /* skip_filters */, file.level,
+          false /* prefetch_index_and_filter_in_cache */,
+          cf.max_file_size_for_l0_meta_pin);
+      if (handle != nullptr) {
+        cf.cfd->table_cache()->ReleaseHandle(handle);
+      }
+      if (!s.ok()) {
+        num_failed.fetch_add(1);
+        ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                       "[%s] Failed to open table file #%" PRIu64 ": %s",
+                       cf.cfd->GetName().c_str(),
+                       file.file_meta->fd.GetNumber(), s.ToString().c_str());
+      }
+      num_table_files_pending_open_.fetch_sub(1, std::memory_order_relaxed);
+      size_t opened = num_opened.fetch_add(1) + 1;
+      if (opened % progress_step == 0 && opened < num_files) {
+        ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                       "Opened %" ROCKSDB_PRIszt " of %" ROCKSDB_PRIszt
+                       " table files in the background",
+                       opened, num_files);
+      }
+    }
+  });
+
+  std::vector<port::Thread> threads;
+  for (int i = 1; i < immutable_db_options_.max_file_opening_threads; i++) {
+    threads.emplace_back(open_files_func);
+  }
+  open_files_func();
+  for (auto& t : threads) {
+    t.join();
+  }
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "Opened %" ROCKSDB_PRIszt " of %" ROCKSDB_PRIszt
+                 " table files in the background in %" PRIu64
+                 " ms, %" ROCKSDB_PRIszt " failed",
+                 num_opened.load(), num_files,
+                 (env_->NowMicros() - start_micros) / 1000,
+                 num_failed.load());
+  if (table_metadata_checkpoint_ != nullptr) {
+    table_metadata_checkpoint_->Clear();
+  }
+
+  mutex_.Lock();
+  for (auto& cf : job->column_families) {
+    cf.version->Unref();
+    cf.cfd->UnrefAndTryDelete();
+  }
+  delete job;
+  bg_open_table_files_scheduled_--;
+  bg_cv_.SignalAll();
+  // IMPORTANT: there should be no code after calling SignalAll. This call may
+  // signal the DB destructor that it's OK to proceed with destruction.
+  mutex_.Unlock();
+}
+
+void DBImpl::SaveTableMetadataCheckpoint() {
+  mutex_.AssertHeld();
+  autovector<Version*> versions;
+  int num_levels = 0;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped() || !cfd->initialized()) {
+      continue;
+    }
+    cfd->current()->Ref();
+    versions.push_back(cfd->current());
+    num_levels =
+        std::max(num_levels, cfd->current()->storage_info()->num_levels());
+  }
+  mutex_.Unlock();
+
+  // The lower levels first, as the most read, up to the size limit. Only
+  // the tables open already are saved, so as not to open any at close.
+  const uint64_t max_size =
+      immutable_db_options_.max_table_metadata_checkpoint_size;
+  const uint64_t start_micros = env_->NowMicros();
+  std::vector<TableMetadataCheckpoint::FileTail> tails;
+  uint64_t total_size = 0;
+  for (int level = 0; level < num_levels; level++) {
+    for (Version* version : versions) {
+      const VersionStorageInfo* vstorage = version->storage_info();
+      if (level >= vstorage->num_levels()) {
+        continue;
+      }
+      TableCache* table_cache = version->cfd()->table_cache();
+      for (FileMetaData* f : vstorage->LevelFiles(level)) {
+        Cache::Handle* handle = nullptr;
+        TableReader* table_reader = f->fd.table_reader;
+        if (table_reader == nullptr &&
+            table_cache
+                ->FindTable(ReadOptions(), file_options_,
+                            version->cfd()->internal_comparator(), f->fd,
+                            &handle, nullptr /* prefix_extractor */,
+                            true /* no_io */)
+                .ok()) {
+          table_reader = table_cache->GetTableReaderFromHandle(handle);
+        }
+        TableMetadataCheckpoint::FileTail file_tail;
+        if (table_reader != nullptr &&
+            table_reader->ReadMetadataTail(&file_tail.tail).ok() &&
+            total_size + file_tail.tail.size() <= max_size) {
+          file_tail.file_number = f->fd.GetNumber();
+          file_tail.file_size = f->fd.GetFileSize();
+          total_size += file_tail.tail.size();
+          tails.push_back(std::move(file_tail));
+        }
+        if (handle != nullptr) {
+          table_cache->ReleaseHandle(handle);
+        }
+      }
+    }
+  }
+
+  const std::string fname = TableMetadataFileName(dbname_);
+  Status s = TableMetadataCheckpoint::Save(fs_.get(), fname, tails);
+  if (s.ok()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Saved the metadata of %" ROCKSDB_PRIszt
+                   " table files, %" PRIu64 " bytes, to %s in %" PRIu64
+                   " ms",
+                   tails.size(), total_size, fname.c_str(),
+                   (env_->NowMicros() - start_micros) / 1000);
+  } else {
+    ROCKS_LOG_WARN(immutable_db_options_.info_log, "Failed to save %s: %s",
+                   fname.c_str(), s.ToString().c_str());
+    env_->DeleteFile(fname).PermitUncheckedError();
+  }
+
+  mutex_.Lock();
+  for (Version* version : versions) {
+    version->Unref();
+  }
+}
+
+struct DBImpl::BlockCacheWarmupJob {
+  struct ColumnFamily {
+    ColumnFamilyData* cfd;
+    // Referenced until the job ends
+    Version* version;
+    std::shared_ptr<const SliceTransform> prefix_extractor;
+  };
+  DBImpl* db;
+  std::vector<ColumnFamily> column_families;
+};
+
+void DBImpl::MaybeScheduleBlockCacheWarmup() {
+  mutex_.AssertHeld();
+  if (block_cache_warmup_ == nullptr) {
+    return;
+  }
+
+  BlockCacheWarmupJob* job = new BlockCacheWarmupJob();
+  job->db = this;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped()) {
+      continue;
+    }
+    cfd->Ref();
+    Version* version = cfd->current();
+    version->Ref();
+    job->column_families.push_back(
+        {cfd, version, cfd->GetLatestMutableCFOptions()->prefix_extractor});
+  }
+  bg_block_cache_warmup_scheduled_++;
+  env_->Schedule(&DBImpl::BGWorkBlockCacheWarmup, job, Env::Priority::LOW,
+                 nullptr);
+}
+
+void DBImpl::BGWorkBlockCacheWarmup(void* arg) {
+  IOSTATS_SET_THREAD_POOL_ID(Env::Priority::LOW);
+  TEST_SYNC_POINT("DBImpl::BGWorkBlockCacheWarmup:Start");
+  BlockCacheWarmupJob* job = reinterpret_cast<BlockCacheWarmupJob*>(arg);
+  job->db->BackgroundCallBlockCacheWarmup(job);
+  TEST_SYNC_POINT("DBImpl::BGWorkBlockCacheWarmup:End");
+}
+
+void DBImpl::BackgroundCallBlockCacheWarmup(BlockCacheWarmupJob* job) {
+  const uint64_t start_micros = env_->NowMicros();
+  const std::string fname = BlockCacheWarmupFileName(dbname_);
+  std::vector<BlockCacheWarmup::BlockInfo> blocks;
+  Status s = BlockCacheWarmup::Load(fs_.get(), fname, &blocks);
+  if (!s.ok() && !s.IsNotFound()) {
+    ROCKS_LOG_WARN(immutable_db_options_.info_log, "Ignoring %s: %s",
+                   fname.c_str(), s.ToString().c_str());
+  }
+
+  struct LiveFile {
+    size_t cf_index;
+    FileMetaData* file_meta;
+    int level;
+  };
+  std::unordered_map<uint64_t, LiveFile> live_files;
+  for (size_t i = 0; i < job->column_families.size(); i++) {
+    const VersionStorageInfo* vstorage =
+        job->column_families[i].version->storage_info();
+    for (int level = 0; level < vstorage->num_levels(); level++) {
+      for (FileMetaData* f : vstorage->LevelFiles(level)) {
+        live_files[f->fd.GetNumber()] = {i, f, level};
+      }
+    }
+  }
+
+  // The blocks of a file are read in batches of sorted reads, each paid for
+  // to the rate limiter before it is issued
+  const size_t kBatchSize = MultiGetContext::MAX_BATCH_SIZE;
+  RateLimiter* rate_limiter = immutable_db_options_.rate_limiter.get();
+  Statistics* stats = immutable_db_options_.statistics.get();
+  size_t num_loaded = 0;
+  size_t num_failed_files = 0;
+  size_t begin = 0;
+  while (begin < blocks.size() &&
+         !shutting_down_.load(std::memory_order_acquire)) {
+    const uint64_t file_number = blocks[begin].file_number;
+    size_t end = begin;
+    while (end < blocks.size() && blocks[end].file_number == file_number) {
+      end++;
+    }
+    auto live_file = live_files.find(file_number);
+    if (live_file == live_files.end()) {
+      // Deleted since
+      begin = end;
+      continue;
+    }
+    const BlockCacheWarmupJob::ColumnFamily& cf =
+        job->column_families[live_file->second.cf_index];
+    TableCache* table_cache = cf.cfd->table_cache();
+    Cache::Handle* handle = nullptr;
+    s = table_cache->FindTable(
+        ReadOptions(), file_options_, cf.cfd->internal_comparator(),
+        live_file->second.file_meta->fd, &handle, cf.prefix_extractor.get(),
+        false /* no_io */, true /* record_read_stats */,
+        cf.cfd->internal_stats()->GetFileReadHist(live_file->second.level),
+        false /* skip_filters */, live_file->second.level);
+    TableReader* table_reader =
+        s.ok() ? table_cache->GetTableReaderFromHandle(handle) : nullptr;
+    std::vector<BlockHandle> batch;
+    int64_t batch_bytes = 0;
+    for (size_t i = begin; s.ok() && i <= end; i++) {
+      if (!batch.empty() &&
+          (i == end || batch.size() == kBatchSize ||
+           shutting_down_.load(std::memory_order_acquire))) {
+        while (rate_limiter != nullptr && batch_bytes > 0) {
+          const int64_t bytes =
+              std::min(batch_bytes, rate_limiter->GetSingleBurstBytes());
+          rate_limiter->Request(bytes, Env::IO_LOW, stats,
+                                RateLimiter::OpType::kRead);
+          batch_bytes -= bytes;
+        }
+        size_t num_batch_loaded = 0;
+        s = table_reader->LoadBlocksIntoCache(ReadOptions(), batch,
+                                              &num_batch_loaded);
+        num_loaded += num_batch_loaded;
+        RecordTick(stats, BLOCK_CACHE_WARMUP_BLOCKS, num_batch_loaded);
+        batch.clear();
+        batch_bytes = 0;
+      }
+      if (i < end && !shutting_down_.load(std::memory_order_acquire)) {
+        batch.emplace_back(blocks[i].offset, blocks[i].size);
+        batch_bytes +=
+            static_cast<int64_t>(blocks[i].size + kBlockTrailerSize);
+      }
+    }
+    if (handle != nullptr) {
+      table_cache->ReleaseHandle(handle);
+    }
+    if (!s.ok()) {
+      num_failed_files++;
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "[%s] Failed to warm the block cache up with table file "
+                     "#%" PRIu64 ": %s",
+                     cf.cfd->GetName().c_str(), file_number,
+                     s.ToString().c_str());
+    }
+    begin = end;
+  }
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "Read %" ROCKSDB_PRIszt " of %" ROCKSDB_PRIszt
+                 " data blocks into the block cache in %" PRIu64
+                 " ms, %" ROCKSDB_PRIszt " table files failed",
+                 num_loaded, blocks.size(),
+                 (env_->NowMicros() - start_micros) / 1000, num_failed_files);
+
+  mutex_.Lock();
+  for (auto& cf : job->column_families) {
+    cf.version->Unref();
+    cf.cfd->UnrefAndTryDelete();
+  }
+  delete job;
+  bg_block_cache_warmup_scheduled_--;
+  bg_cv_.SignalAll();
+  // IMPORTANT: there should be no code after calling SignalAll. This call may
+  // signal the DB destructor that it's OK to proceed with destruction.
+  mutex_.Unlock();
+}
 }  // namespace ROCKSDB_NAMESPACE
@@ -8,10 +8,13 @@
 #include <cinttypes>
 
 #include "db/arena_wrapped_db_iter.h"
+#include "db/compaction/compaction_job.h"
 #include "db/merge_context.h"
 #include "logging/auto_roll_logger.h"
 #include "monitoring/perf_context_imp.h"
+#include "rocksdb/convenience.h"
 #include "util/cast_util.h"
+#include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -24,7 +27,9 @@ DBImplSecondary::DBImplSecondary(const DBOptions& db_options,
   LogFlush(immutable_db_options_.info_log);
 }
 
-DBImplSecondary::~DBImplSecondary() {}
+DBImplSecondary::~DBImplSecondary() {
+  StopCatchingUpWithPrimary().PermitUncheckedError();
+}
 
 Status DBImplSecondary::Recover(
     const std::vector<ColumnFamilyDescriptor>& column_families,
@@ -574,6 +579,57 @@ Status DBImplSecondary::TryCatchUpWithPrimary() {
   return s;
 }
 
+Status DBImplSecondary::StartCatchingUpWithPrimary(uint64_t max_wait_us) {
+  MutexLock l(&catch_up_mutex_);
+  if (catch_up_watcher_ != nullptr) {
+    return Status::Busy("Already catching up with the primary");
+  }
+  std::vector<std::string> dirs = {dbname_};
+  if (immutable_db_options_.wal_dir != dbname_) {
+    dirs.push_back(immutable_db_options_.wal_dir);
+  }
+  catch_up_watcher_.reset(new PrimaryChangeWatcher(env_, dirs));
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "Catching up with the primary %s",
+                 catch_up_watcher_->IsNotified() ? "when notified of changes"
+                                                 : "by polling");
+  catch_up_thread_ = port::Thread(
+      [this, max_wait_us]() { BGCatchUpWithPrimary(max_wait_us); });
+  return Status::OK();
+}
+
+Status DBImplSecondary::StopCatchingUpWithPrimary() {
+  MutexLock l(&catch_up_mutex_);
+  if (catch_up_watcher_ == nullptr) {
+    return Status::OK();
+  }
+  catch_up_watcher_->Stop();
+  catch_up_thread_.join();
+  catch_up_watcher_.reset();
+  return Status::OK();
+}
+
+void DBImplSecondary::BGCatchUpWithPrimary(uint64_t max_wait_us) {
+  // Set before the thread starts, and reset only after it is joined
+  PrimaryChangeWatcher* watcher = catch_up_watcher_.get();
+  while (watcher->Wait(max_wait_us)) {
+    // The WAL readers are kept open, so each round reads on from where the
+    // last one stopped
+    Status s = TryCatchUpWithPrimary();
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Failed to catch up with the primary: %s",
+                     s.ToString().c_str());
+    }
+  }
+}
+
+Status DBImplSecondary::Close() {
+  Status s = StopCatchingUpWithPrimary();
+  Status close_s = DBImpl::Close();
+  return s.ok() ? close_s : s;
+}
+
 Status DB::OpenAsSecondary(const Options& options, const std::string& dbname,
                            const std::string& secondary_path, DB** dbptr) {
   *dbptr = nullptr;
@@ -662,6 +718,149 @@ Status DB::OpenAsSecondary(
   }
   return s;
 }
+
+Status DBImplSecondary::CompactWithoutInstallation(
+    ColumnFamilyHandle* cfh, const std::string& output_path,
+    const CompactionServiceInput& input, CompactionServiceResult* result) {
+  InstrumentedMutexLock l(&mutex_);
+  auto cfd = static_cast_with_check<ColumnFamilyHandleImpl>(cfh)->cfd();
+  assert(cfd != nullptr);
+
+  Version* version = cfd->current();
+  VersionStorageInfo* vstorage = version->storage_info();
+  std::unordered_set<uint64_t> input_set(input.input_files.begin(),
+                                         input.input_files.end());
+  std::vector<CompactionInputFiles> input_files;
+  CompactionOptions comp_options;
+  Status s = cfd->compaction_picker()->GetCompactionInputsFromFileNumbers(
+      &input_files, &input_set, vstorage, comp_options);
+  if (!s.ok()) {
+    return s;
+  }
+  if (input.output_level < 0 || input.output_level >= vstorage->num_levels()) {
+    return Status::InvalidArgument("Invalid compaction output level");
+  }
+
+  const MutableCFOptions* mutable_cf_options = cfd->GetLatestMutableCFOptions();
+  comp_options.output_file_size_limit = MaxFileSizeForLevel(
+      *mutable_cf_options, input.output_level,
+      cfd->ioptions()->compaction_style, vstorage->base_level(),
+      cfd->ioptions()->level_compaction_dynamic_level_bytes);
+  std::unique_ptr<Compaction> c(cfd->compaction_picker()->CompactFiles(
+      comp_options, input_files, input.output_level, vstorage,
+      *mutable_cf_options, mutable_db_options_, /*output_path_id=*/0));
+  assert(c != nullptr);
+  c->SetInputVersion(version);
+
+  std::unique_ptr<FSDirectory> output_dir;
+  IOStatus io_s =
+      fs_->NewDirectory(output_path, IOOptions(), &output_dir, nullptr);
+  if (!io_s.ok()) {
+    c->ReleaseCompactionFiles(io_s);
+    return io_s;
+  }
+
+  LogBuffer log_buffer(InfoLogLevel::INFO_LEVEL,
+                       immutable_db_options_.info_log.get());
+  CompactionJobStats compaction_job_stats;
+  CompactionServiceCompactionJob compaction_job(
+      next_job_id_.fetch_add(1), c.get(), immutable_db_options_,
+      file_options_for_compaction_, versions_.get(), &shutting_down_,
+      preserve_deletes_seqnum_.load(), &log_buffer, output_dir.get(), stats_,
+      &mutex_, &error_handler_, input.snapshots, table_cache_, &event_logger_,
+      dbname_, &compaction_job_stats, io_tracer_, db_id_, db_session_id_,
+      output_path, input, result);
+
+  compaction_job.Prepare();
+
+  mutex_.Unlock();
+  s = compaction_job.Run();
+  mutex_.Lock();
+
+  compaction_job.io_status().PermitUncheckedError();
+  compaction_job.CleanupCompaction();
+  c->ReleaseCompactionFiles(s);
+  log_buffer.FlushBufferToLog();
+  return s;
+}
+
+Status DB::OpenAndCompact(
+    const std::string& name, const std::string& output_directory,
+    const std::string& input, std::string* output,
+    const CompactionServiceOptionsOverride& override_options) {
+  assert(output != nullptr);
+  CompactionServiceInput compaction_input;
+  Status s = CompactionServiceInput::DecodeFrom(input, &compaction_input);
+  if (!s.ok()) {
+    return s;
+  }
+
+  ConfigOptions config_options;
+  DBOptions db_options;
+  ColumnFamilyOptions cf_options;
+  s = GetDBOptionsFromString(config_options, DBOptions(),
+                             compaction_input.db_options, &db_options);
+  if (s.ok()) {
+    s = GetColumnFamilyOptionsFromString(config_options,
+                                         ColumnFamilyOptions(),
+                                         compaction_input.cf_options,
+                                         &cf_options);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  db_options.env = override_options.env;
+  db_options.file_checksum_gen_factory =
+      override_options.file_checksum_gen_factory;
+  // Required by secondary instances
+  db_options.max_open_files = -1;
+  cf_options.comparator = override_options.comparator;
+  cf_options.merge_operator = override_options.merge_operator;
+  cf_options.compaction_filter = override_options.compaction_filter;
+  cf_options.compaction_filter_factory =
+      override_options.compaction_filter_factory;
+  cf_options.prefix_extractor = override_options.prefix_extractor;
+  if (override_options.table_factory) {
+    cf_options.table_factory = override_options.table_factory;
+  }
+  cf_options.sst_partitioner_factory =
+      override_options.sst_partitioner_factory;
+
+  // The default column family has to be opened as well
+  std::vector<ColumnFamilyDescriptor> column_families;
+  column_families.emplace_back(compaction_input.column_family_name,
+                               cf_options);
+  if (compaction_input.column_family_name != kDefaultColumnFamilyName) {
+    column_families.emplace_back(kDefaultColumnFamilyName, cf_options);
+  }
+
+  s = db_options.env->CreateDirIfMissing(output_directory);
+  if (!s.ok()) {
+    return s;
+  }
+  std::vector<ColumnFamilyHandle*> handles;
+  DB* db = nullptr;
+  s = DB::OpenAsSecondary(db_options, name, output_directory, column_families,
+                          &handles, &db);
+  if (!s.ok()) {
+    return s;
+  }
+
+  CompactionServiceResult compaction_result;
+  auto db_secondary = static_cast_with_check<DBImplSecondary>(db);
+  s = db_secondary->CompactWithoutInstallation(
+      handles[0], output_directory, compaction_input, &compaction_result);
+  compaction_result.status = s;
+  output->clear();
+  compaction_result.EncodeTo(output);
+
+  for (auto handle : handles) {
+    delete handle;
+  }
+  delete db;
+  return s;
+}
 #else   // !ROCKSDB_LITE
 
 Status DB::OpenAsSecondary(const Options& /*options*/,
@@ -678,6 +877,13 @@ Status DB::OpenAsSecondary(
     std::vector<ColumnFamilyHandle*>* /*handles*/, DB** /*dbptr*/) {
   return Status::NotSupported("Not supported in ROCKSDB_LITE.");
 }
+
+Status DB::OpenAndCompact(
+    const std::string& /*name*/, const std::string& /*output_directory*/,
+    const std::string& /*input*/, std::string* /*output*/,
+    const CompactionServiceOptionsOverride& /*override_options*/) {
+  return Status::NotSupported("Not supported in ROCKSDB_LITE.");
+}
 #endif  // !ROCKSDB_LITE
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -10,9 +10,13 @@
 #include <string>
 #include <vector>
 #include "db/db_impl/db_impl.h"
+#include "db/db_impl/primary_change_watcher.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+struct CompactionServiceInput;
+struct CompactionServiceResult;
+
 // A wrapper class to hold log reader, log reporter, log status.
 class LogReaderContainer {
  public:
@@ -210,6 +214,12 @@ class DBImplSecondary : public DBImpl {
   // method can take long time due to all the I/O and CPU costs.
   Status TryCatchUpWithPrimary() override;
 
+  Status StartCatchingUpWithPrimary(uint64_t max_wait_us) override;
+
+  Status StopCatchingUpWithPrimary() override;
+
+  using DBImpl::Close;
+  Status Close() override;
 
   // Try to find log reader using log_number from log_readers_ map, initialize
   // if it doesn't exist
@@ -222,6 +232,14 @@ class DBImplSecondary : public DBImpl {
   // not flag the missing file as inconsistency.
   Status CheckConsistency() override;
 
+  // Runs the compaction described by input on the files of the current
+  // version, writing the output files into output_path without installing
+  // them, and describes them in result. See DB::OpenAndCompact().
+  Status CompactWithoutInstallation(ColumnFamilyHandle* cfh,
+                                    const std::string& output_path,
+                                    const CompactionServiceInput& input,
+                                    CompactionServiceResult* result);
+
  protected:
   // ColumnFamilyCollector is a write batch handler which does nothing
   // except recording unique column family IDs
@@ -326,6 +344,13 @@ class DBImplSecondary : public DBImpl {
 
   // Current WAL number replayed for each column family.
   std::unordered_map<ColumnFamilyData*, uint64_t> cfd_to_current_log_;
+
+  // Catching up in the background, see StartCatchingUpWithPrimary()
+  void BGCatchUpWithPrimary(uint64_t max_wait_us);
+
+  port::Mutex catch_up_mutex_;  // Guards the two below
+  std::unique_ptr<PrimaryChangeWatcher> catch_up_watcher_;
+  port::Thread catch_up_thread_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -12,9 +12,11 @@
 #include "db/error_handler.h"
 #include "db/event_helpers.h"
 #include "monitoring/perf_context_imp.h"
+#include "monitoring/span_tracer_imp.h"
 #include "options/options_helper.h"
 #include "test_util/sync_point.h"
 #include "util/cast_util.h"
+#include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
 // Convenience methods
@@ -53,6 +55,63 @@ Status DBImpl::Write(const WriteOptions& write_options, WriteBatch* my_batch) {
   return WriteImpl(write_options, my_batch, nullptr, nullptr);
 }
 
+void DBImpl::WriteAsync(const WriteOptions& write_options,
+                        WriteBatch* my_batch,
+                        std::function<void(const Status&)> callback) {
+  {
+    MutexLock l(&async_write_mutex_);
+    if (!async_write_stopped_) {
+      async_write_queue_.push_back(
+          AsyncWrite{write_options, my_batch, std::move(callback)});
+      if (async_write_idle_threads_ > 0) {
+        async_write_cv_.Signal();
+      } else if (async_write_threads_.size() <
+                 static_cast<size_t>(
+                     immutable_db_options_.max_async_write_threads)) {
+        async_write_threads_.emplace_back(&DBImpl::AsyncWriteThread, this);
+      }
+      return;
+    }
+  }
+  callback(Status::ShutdownInProgress());
+}
+
+void DBImpl::AsyncWriteThread() {
+  MutexLock l(&async_write_mutex_);
+  while (true) {
+    if (async_write_queue_.empty()) {
+      if (async_write_stopped_) {
+        break;
+      }
+      async_write_idle_threads_++;
+      async_write_cv_.Wait();
+      async_write_idle_threads_--;
+      continue;
+    }
+    AsyncWrite w = std::move(async_write_queue_.front());
+    async_write_queue_.pop_front();
+    async_write_mutex_.Unlock();
+    // Write() rather than WriteImpl() so that the DB classes refusing writes
+    // refuse async ones too
+    Status s = Write(w.options, w.batch);
+    w.callback(s);
+    async_write_mutex_.Lock();
+  }
+}
+
+void DBImpl::StopAsyncWriteThreads() {
+  {
+    MutexLock l(&async_write_mutex_);
+    async_write_stopped_ = true;
+    async_write_cv_.SignalAll();
+  }
+  // No thread is started once stopped, so the threads can be joined unlocked
+  for (auto& thread : async_write_threads_) {
+    thread.join();
+  }
+  async_write_threads_.clear();
+}
+
 #ifndef ROCKSDB_LITE
 Status DBImpl::WriteWithCallback(const WriteOptions& write_options,
                                  WriteBatch* my_batch,
@@ -74,6 +133,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   if (my_batch == nullptr) {
     return Status::Corruption("Batch is nullptr!");
   }
+  SpanScope span_scope(immutable_db_options_.span_tracer.get(),
+                       write_options.trace_id, "Write", env_);
   if (tracer_) {
     InstrumentedMutexLock lock(&trace_mutex_);
     if (tracer_) {
@@ -536,9 +597,17 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
                           wal_write_group.size - 1);
         RecordTick(stats_, WRITE_DONE_BY_OTHER, wal_write_group.size - 1);
       }
-      io_s = WriteToWAL(wal_write_group, log_writer, log_used, need_log_sync,
-                        need_log_dir_sync, current_sequence);
+      if (wal_lanes_.empty()) {
+        io_s = WriteToWAL(wal_write_group, log_writer, log_used,
+                          need_log_sync, need_log_dir_sync, current_sequence);
+      } else {
+        io_s = WriteToWALLane(wal_write_group, log_used, need_log_sync,
+                              need_log_dir_sync, current_sequence);
+      }
       w.status = io_s;
+    } else if (!wal_lanes_.empty()) {
+      // Every group is released so that the groups keep their order
+      write_thread_.ReleaseBatchGroupLeader(wal_write_group);
     }
 
     if (!w.CallbackFailed()) {
@@ -549,7 +618,7 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
       }
     }
 
-    if (need_log_sync) {
+    if (need_log_sync && wal_lanes_.empty()) {
       mutex_.Lock();
       MarkLogsSynced(logfile_number_, need_log_dir_sync, w.status);
       mutex_.Unlock();
@@ -946,6 +1015,12 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
     PERF_TIMER_START(write_pre_and_post_process_time);
   }
 
+  if (status.ok() && *need_log_sync && !wal_lanes_.empty()) {
+    // WriteToWALLane syncs the lanes of the current log, and SwitchMemtable
+    // syncs them before switching to a new log.
+    return status;
+  }
+
   if (status.ok() && *need_log_sync) {
     // Wait until the parallel syncs are finished. Any sync process has to sync
     // the front log too so it is enough to check the status of front()
@@ -973,14 +1048,19 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
   return status;
 }
 
-WriteBatch* DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
-                               WriteBatch* tmp_batch, size_t* write_with_wal,
-                               WriteBatch** to_be_cached_state) {
-  assert(write_with_wal != nullptr);
-  assert(tmp_batch != nullptr);
-  assert(*to_be_cached_state == nullptr);
-  WriteBatch* merged_batch = nullptr;
-  *write_with_wal = 0;
+void DBImpl::WALRecord::SetSequence(SequenceNumber sequence) {
+  if (batch != nullptr) {
+    WriteBatchInternal::SetSequence(batch, sequence);
+  } else {
+    EncodeFixed64(header, sequence);
+  }
+}
+
+void DBImpl::GatherBatches(const WriteThread::WriteGroup& write_group,
+                           WALRecord* record) {
+  assert(record != nullptr);
+  assert(record->to_be_cached_state == nullptr);
+  record->write_with_wal = 0;
   auto* leader = write_group.leader;
   assert(!leader->disable_wal);  // Same holds for all in the batch group
   if (write_group.size == 1 && !leader->CallbackFailed() &&
@@ -988,31 +1068,51 @@ WriteBatch* DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
     // we simply write the first WriteBatch to WAL if the group only
     // contains one batch, that batch should be written to the WAL,
     // and the batch is not wanting to be truncated
-    merged_batch = leader->batch;
-    if (WriteBatchInternal::IsLatestPersistentState(merged_batch)) {
-      *to_be_cached_state = merged_batch;
+    record->batch = leader->batch;
+    record->contents = WriteBatchInternal::Contents(leader->batch);
+    record->size = record->contents.size();
+    if (WriteBatchInternal::IsLatestPersistentState(leader->batch)) {
+      record->to_be_cached_state = leader->batch;
     }
-    *write_with_wal = 1;
-  } else {
-    // WAL needs all of the batches flattened into a single batch.
-    // We could avoid copying here with an iov-like AddRecord
-    // interface
-    merged_batch = tmp_batch;
-    for (auto writer : write_group) {
-      if (!writer->CallbackFailed()) {
-        Status s = WriteBatchInternal::Append(merged_batch, writer->batch,
-                                              /*WAL_only*/ true);
-        // Always returns Status::OK.
-        assert(s.ok());
-        if (WriteBatchInternal::IsLatestPersistentState(writer->batch)) {
-          // We only need to cache the last of such write batch
-          *to_be_cached_state = writer->batch;
-        }
-        (*write_with_wal)++;
-      }
+    record->write_with_wal = 1;
+    return;
+  }
+  // The WAL needs the batches as a single batch. Its header is built here
+  // and the payloads are referenced in place, up to the WAL termination
+  // point of each batch.
+  record->batch = nullptr;
+  record->parts.reserve(write_group.size + 1);
+  record->parts.emplace_back(record->header, WriteBatchInternal::kHeader);
+  record->size = WriteBatchInternal::kHeader;
+  uint32_t count = 0;
+  for (auto writer : write_group) {
+    if (writer->CallbackFailed()) {
+      continue;
+    }
+    const WriteBatch* batch = writer->batch;
+    const SavePoint& batch_end = batch->GetWalTerminationPoint();
+    const Slice contents = WriteBatchInternal::Contents(batch);
+    size_t end = contents.size();
+    if (batch_end.is_cleared()) {
+      count += WriteBatchInternal::Count(batch);
+    } else {
+      end = batch_end.size;
+      count += batch_end.count;
     }
+    assert(end >= WriteBatchInternal::kHeader && end <= contents.size());
+    if (end > WriteBatchInternal::kHeader) {
+      record->parts.emplace_back(contents.data() + WriteBatchInternal::kHeader,
+                                 end - WriteBatchInternal::kHeader);
+      record->size += end - WriteBatchInternal::kHeader;
+    }
+    if (WriteBatchInternal::IsLatestPersistentState(batch)) {
+      // We only need to cache the last of such write batch
+      record->to_be_cached_state = writer->batch;
+    }
+    record->write_with_wal++;
   }
-  return merged_batch;
+  EncodeFixed64(record->header, 0);
+  EncodeFixed32(record->header + 8, count);
 }
 
 // When two_write_queues_ is disabled, this function is called from the only
@@ -1021,8 +1121,16 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
                             log::Writer* log_writer, uint64_t* log_used,
                             uint64_t* log_size) {
   assert(log_size != nullptr);
-  Slice log_entry = WriteBatchInternal::Contents(&merged_batch);
-  *log_size = log_entry.size();
+  WALRecord record;
+  record.contents = WriteBatchInternal::Contents(&merged_batch);
+  record.size = record.contents.size();
+  *log_size = record.size;
+  return WriteToWAL(record, log_writer, log_used);
+}
+
+// Same requirements as above.
+IOStatus DBImpl::WriteToWAL(const WALRecord& record, log::Writer* log_writer,
+                            uint64_t* log_used) {
   // When two_write_queues_ WriteToWAL has to be protected from concurretn calls
   // from the two queues anyway and log_write_mutex_ is already held. Otherwise
   // if manual_wal_flush_ is enabled we need to protect log_writer->AddRecord
@@ -1034,7 +1142,7 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   if (UNLIKELY(needs_locking)) {
     log_write_mutex_.Lock();
   }
-  IOStatus io_s = log_writer->AddRecord(log_entry);
+  IOStatus io_s = log_writer->AddRecord(record.Parts());
 
   if (UNLIKELY(needs_locking)) {
     log_write_mutex_.Unlock();
@@ -1042,10 +1150,10 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   if (log_used != nullptr) {
     *log_used = logfile_number_;
   }
-  total_log_size_ += log_entry.size();
+  total_log_size_ += record.size;
   // TODO(myabandeh): it might be unsafe to access alive_log_files_.back() here
   // since alive_log_files_ might be modified concurrently
-  alive_log_files_.back().AddSize(log_entry.size());
+  alive_log_files_.back().AddSize(record.size);
   log_empty_ = false;
   return io_s;
 }
@@ -1057,24 +1165,21 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
   IOStatus io_s;
   assert(!write_group.leader->disable_wal);
   // Same holds for all in the batch group
-  size_t write_with_wal = 0;
-  WriteBatch* to_be_cached_state = nullptr;
-  WriteBatch* merged_batch = MergeBatch(write_group, &tmp_batch_,
-                                        &write_with_wal, &to_be_cached_state);
-  if (merged_batch == write_group.leader->batch) {
+  WALRecord record;
+  GatherBatches(write_group, &record);
+  if (record.batch == write_group.leader->batch) {
     write_group.leader->log_used = logfile_number_;
-  } else if (write_with_wal > 1) {
+  } else if (record.write_with_wal > 1) {
     for (auto writer : write_group) {
       writer->log_used = logfile_number_;
     }
   }
 
-  WriteBatchInternal::SetSequence(merged_batch, sequence);
+  record.SetSequence(sequence);
 
-  uint64_t log_size;
-  io_s = WriteToWAL(*merged_batch, log_writer, log_used, &log_size);
-  if (to_be_cached_state) {
-    cached_recoverable_state_ = *to_be_cached_state;
+  io_s = WriteToWAL(record, log_writer, log_used);
+  if (record.to_be_cached_state) {
+    cached_recoverable_state_ = *record.to_be_cached_state;
     cached_recoverable_state_empty_ = false;
   }
 
@@ -1102,19 +1207,119 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
     }
   }
 
-  if (merged_batch == &tmp_batch_) {
-    tmp_batch_.Clear();
+  if (io_s.ok()) {
+    auto stats = default_cf_internal_stats_;
+    if (need_log_sync) {
+      stats->AddDBStats(InternalStats::kIntStatsWalFileSynced, 1);
+      RecordTick(stats_, WAL_FILE_SYNCED);
+    }
+    stats->AddDBStats(InternalStats::kIntStatsWalFileBytes, record.size);
+    RecordTick(stats_, WAL_FILE_BYTES, record.size);
+    stats->AddDBStats(InternalStats::kIntStatsWriteWithWal,
+                      record.write_with_wal);
+    RecordTick(stats_, WRITE_WITH_WAL, record.write_with_wal);
+  }
+  return io_s;
+}
+
+IOStatus DBImpl::WriteToWALLane(WriteThread::WriteGroup& write_group,
+                                uint64_t* log_used, bool need_log_sync,
+                                bool need_log_dir_sync,
+                                SequenceNumber sequence) {
+  assert(!write_group.leader->disable_wal);
+  assert(!wal_lanes_.empty());
+  // Merging and accounting are done while still leading the WAL stage. The
+  // batches are merged into a local buffer since the group still needs it
+  // after leaving the WAL stage.
+  WALRecord record;
+  GatherBatches(write_group, &record);
+  if (record.batch == write_group.leader->batch) {
+    write_group.leader->log_used = logfile_number_;
+  } else if (record.write_with_wal > 1) {
+    for (auto writer : write_group) {
+      writer->log_used = logfile_number_;
+    }
+  }
+  record.SetSequence(sequence);
+  if (record.to_be_cached_state) {
+    cached_recoverable_state_ = *record.to_be_cached_state;
+    cached_recoverable_state_empty_ = false;
+  }
+
+  std::string merged;
+  Slice log_entry(record.Parts(), &merged);
+  if (log_used != nullptr) {
+    *log_used = logfile_number_;
+  }
+  total_log_size_ += log_entry.size();
+  alive_log_files_.back().AddSize(log_entry.size());
+  log_empty_ = false;
+  WALLane* lane = wal_lanes_[next_wal_lane_++ % wal_lanes_.size()].get();
+
+  write_thread_.ReleaseBatchGroupLeader(write_group);
+
+  IOStatus io_s;
+  {
+    MutexLock l(&lane->mutex);
+    io_s = lane->writer->AddRecord(log_entry);
+    lane->dirty = true;
+  }
+
+  if (io_s.ok() && need_log_sync) {
+    // Groups released earlier are acknowledged before this one, so their
+    // appends must be synced too.
+    write_thread_.AwaitReleasedGroups(write_group);
+    StopWatch sw(env_, stats_, WAL_FILE_SYNC_MICROS);
+    io_s = SyncWALLanes();
+    if (io_s.ok() && need_log_dir_sync) {
+      io_s = directories_.GetWalDir()->Fsync(IOOptions(), nullptr);
+      if (io_s.ok()) {
+        InstrumentedMutexLock l(&mutex_);
+        log_dir_synced_ = true;
+      }
+    }
   }
+
   if (io_s.ok()) {
     auto stats = default_cf_internal_stats_;
     if (need_log_sync) {
       stats->AddDBStats(InternalStats::kIntStatsWalFileSynced, 1);
       RecordTick(stats_, WAL_FILE_SYNCED);
     }
-    stats->AddDBStats(InternalStats::kIntStatsWalFileBytes, log_size);
-    RecordTick(stats_, WAL_FILE_BYTES, log_size);
-    stats->AddDBStats(InternalStats::kIntStatsWriteWithWal, write_with_wal);
-    RecordTick(stats_, WRITE_WITH_WAL, write_with_wal);
+    stats->AddDBStats(InternalStats::kIntStatsWalFileBytes, log_entry.size());
+    RecordTick(stats_, WAL_FILE_BYTES, log_entry.size());
+    stats->AddDBStats(InternalStats::kIntStatsWriteWithWal,
+                      record.write_with_wal);
+    RecordTick(stats_, WRITE_WITH_WAL, record.write_with_wal);
+  }
+  return io_s;
+}
+
+void DBImpl::ResetWALLanes() {
+  log_write_mutex_.AssertHeld();
+  assert(!logs_.empty());
+  const LogWriterNumber& log = logs_.back();
+  assert(log.streams.size() + 1 == wal_lanes_.size());
+  for (size_t i = 0; i < wal_lanes_.size(); i++) {
+    WALLane* lane = wal_lanes_[i].get();
+    MutexLock l(&lane->mutex);
+    lane->writer = i == 0 ? log.writer : log.streams[i - 1];
+    lane->dirty = false;
+  }
+}
+
+IOStatus DBImpl::SyncWALLanes() {
+  IOStatus io_s;
+  for (auto& lane : wal_lanes_) {
+    MutexLock l(&lane->mutex);
+    if (!lane->dirty) {
+      continue;
+    }
+    io_s = lane->writer->file()->Sync(immutable_db_options_.use_fsync);
+    if (!io_s.ok()) {
+      break;
+    }
+    lane->dirty = false;
   }
   return io_s;
 }
@@ -1126,31 +1331,27 @@ IOStatus DBImpl::ConcurrentWriteToWAL(
 
   assert(!write_group.leader->disable_wal);
   // Same holds for all in the batch group
-  WriteBatch tmp_batch;
-  size_t write_with_wal = 0;
-  WriteBatch* to_be_cached_state = nullptr;
-  WriteBatch* merged_batch =
-      MergeBatch(write_group, &tmp_batch, &write_with_wal, &to_be_cached_state);
+  WALRecord record;
+  GatherBatches(write_group, &record);
 
   // We need to lock log_write_mutex_ since logs_ and alive_log_files might be
   // pushed back concurrently
   log_write_mutex_.Lock();
-  if (merged_batch == write_group.leader->batch) {
+  if (record.batch == write_group.leader->batch) {
     write_group.leader->log_used = logfile_number_;
-  } else if (write_with_wal > 1) {
+  } else if (record.write_with_wal > 1) {
     for (auto writer : write_group) {
       writer->log_used = logfile_number_;
     }
   }
   *last_sequence = versions_->FetchAddLastAllocatedSequence(seq_inc);
   auto sequence = *last_sequence + 1;
-  WriteBatchInternal::SetSequence(merged_batch, sequence);
+  record.SetSequence(sequence);
 
   log::Writer* log_writer = logs_.back().writer;
-  uint64_t log_size;
-  io_s = WriteToWAL(*merged_batch, log_writer, log_used, &log_size);
-  if (to_be_cached_state) {
-    cached_recoverable_state_ = *to_be_cached_state;
+  io_s = WriteToWAL(record, log_writer, log_used);
+  if (record.to_be_cached_state) {
+    cached_recoverable_state_ = *record.to_be_cached_state;
     cached_recoverable_state_empty_ = false;
   }
   log_write_mutex_.Unlock();
@@ -1158,12 +1359,12 @@ IOStatus DBImpl::ConcurrentWriteToWAL(
   if (io_s.ok()) {
     const bool concurrent = true;
     auto stats = default_cf_internal_stats_;
-    stats->AddDBStats(InternalStats::kIntStatsWalFileBytes, log_size,
-                      concurrent);
-    RecordTick(stats_, WAL_FILE_BYTES, log_size);
-    stats->AddDBStats(InternalStats::kIntStatsWriteWithWal, write_with_wal,
+    stats->AddDBStats(InternalStats::kIntStatsWalFileBytes, record.size,
                       concurrent);
-    RecordTick(stats_, WRITE_WITH_WAL, write_with_wal);
+    RecordTick(stats_, WAL_FILE_BYTES, record.size);
+    stats->AddDBStats(InternalStats::kIntStatsWriteWithWal,
+                      record.write_with_wal, concurrent);
+    RecordTick(stats_, WRITE_WITH_WAL, record.write_with_wal);
   }
   return io_s;
 }
@@ -1694,6 +1895,13 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   }
   uint64_t new_log_number =
       creating_new_log ? versions_->NewFileNumber() : logfile_number_;
+  std::vector<uint64_t> stream_numbers;
+  std::vector<log::Writer*> new_streams;
+  if (creating_new_log) {
+    for (size_t i = 1; i < wal_lanes_.size(); i++) {
+      stream_numbers.push_back(versions_->NewFileNumber());
+    }
+  }
   const MutableCFOptions mutable_cf_options = *cfd->GetLatestMutableCFOptions();
 
   // Set memtable_info for memtable sealed callback
@@ -1712,10 +1920,21 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
       GetWalPreallocateBlockSize(mutable_cf_options.write_buffer_size);
   mutex_.Unlock();
   if (creating_new_log) {
+    if (!wal_lanes_.empty()) {
+      // Synced writes only sync the lanes of the current log, the log we
+      // switch away from has to be durable before.
+      io_s = SyncWALLanes();
+    }
     // TODO: Write buffer size passed in should be max of all CF's instead
     // of mutable_cf_options.write_buffer_size.
-    io_s = CreateWAL(new_log_number, recycle_log_number, preallocate_block_size,
-                     &new_log);
+    if (io_s.ok()) {
+      io_s = CreateWAL(new_log_number, recycle_log_number,
+                       preallocate_block_size, &new_log);
+    }
+    if (io_s.ok() && !stream_numbers.empty()) {
+      io_s = CreateWALStreams(stream_numbers, preallocate_block_size,
+                              &new_streams);
+    }
     if (s.ok()) {
       s = io_s;
     }
@@ -1762,6 +1981,11 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
       log_dir_synced_ = false;
       logs_.emplace_back(logfile_number_, new_log);
       alive_log_files_.push_back(LogFileNumberSize(logfile_number_));
+      if (!wal_lanes_.empty()) {
+        logs_.back().streams = new_streams;
+        alive_log_files_.back().stream_numbers = stream_numbers;
+        ResetWALLanes();
+      }
     }
     log_write_mutex_.Unlock();
   }
@@ -1775,6 +1999,9 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
     if (new_log) {
       delete new_log;
     }
+    for (auto* stream : new_streams) {
+      delete stream;
+    }
     SuperVersion* new_superversion =
         context->superversion_context.new_superversion.release();
     if (new_superversion != nullptr) {
@@ -1812,11 +2039,29 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   }
 
   cfd->mem()->SetNextLogNumber(logfile_number_);
+  // Keep the sealed memtable alive while it migrates, as it may be flushed
+  // meanwhile
+  MemTable* sealed_mem = nullptr;
+  if (immutable_db_options_.immutable_memtable_numa_node >= 0) {
+    sealed_mem = cfd->mem();
+    sealed_mem->Ref();
+  }
   cfd->imm()->Add(cfd->mem(), &context->memtables_to_free_);
   new_mem->Ref();
   cfd->SetMemtable(new_mem);
   InstallSuperVersionAndScheduleWork(cfd, &context->superversion_context,
                                      mutable_cf_options);
+  if (sealed_mem != nullptr) {
+    mutex_.Unlock();
+    size_t moved = sealed_mem->MoveToNumaNode(
+        immutable_db_options_.immutable_memtable_numa_node);
+    RecordTick(stats_, IMMUTABLE_MEMTABLE_BYTES_MIGRATED, moved);
+    mutex_.Lock();
+    MemTable* to_free = sealed_mem->Unref();
+    if (to_free != nullptr) {
+      context->memtables_to_free_.push_back(to_free);
+    }
+  }
 #ifndef ROCKSDB_LITE
   mutex_.Unlock();
   // Notify client that memtable is sealed, now that we have successfully
@@ -340,6 +340,46 @@ TEST_F(DBSecondaryTest, OpenAsSecondaryWALTailing) {
   verify_db_func("new_foo_value_1", "new_bar_value");
 }
 
+TEST_F(DBSecondaryTest, CatchUpWithPrimaryInBackground) {
+  Options options;
+  options.env = env_;
+  Reopen(options);
+  ASSERT_TRUE(db_->StartCatchingUpWithPrimary(1000).IsNotSupported());
+
+  Options options1;
+  options1.env = env_;
+  options1.max_open_files = -1;
+  OpenSecondary(options1);
+  ASSERT_OK(db_secondary_->StartCatchingUpWithPrimary(10000));
+  ASSERT_TRUE(db_secondary_->StartCatchingUpWithPrimary(10000).IsBusy());
+
+  const auto wait_for_value = [&](const std::string& expected) {
+    std::string value;
+    for (int i = 0; i < 1000; ++i) {
+      Status s = db_secondary_->Get(ReadOptions(), "foo", &value);
+      if (s.ok() && value == expected) {
+        break;
+      }
+      ASSERT_TRUE(s.ok() || s.IsNotFound());
+      env_->SleepForMicroseconds(10000);
+    }
+    ASSERT_EQ(expected, value);
+  };
+
+  ASSERT_OK(Put("foo", "foo_value0"));
+  wait_for_value("foo_value0");
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("foo", "foo_value1"));
+  wait_for_value("foo_value1");
+
+  ASSERT_OK(db_secondary_->StopCatchingUpWithPrimary());
+  ASSERT_OK(db_secondary_->StopCatchingUpWithPrimary());
+  // Restarts after being stopped, and stops on close
+  ASSERT_OK(db_secondary_->StartCatchingUpWithPrimary(10000));
+  ASSERT_OK(Put("foo", "foo_value2"));
+  wait_for_value("foo_value2");
+}
+
 TEST_F(DBSecondaryTest, OpenWithNonExistColumnFamily) {
   Options options;
   options.env = env_;
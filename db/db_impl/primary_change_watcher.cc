@@ -0,0 +1,110 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "db/db_impl/primary_change_watcher.h"
+
+#include <algorithm>
+
+#ifdef OS_LINUX
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+PrimaryChangeWatcher::PrimaryChangeWatcher(
+    Env* env, const std::vector<std::string>& dirs)
+    : env_(env), cv_(&mutex_) {
+#ifdef OS_LINUX
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  bool watched = inotify_fd_ >= 0 && stop_fd_ >= 0;
+  // The primary appends to the MANIFEST and WALs, and creates new ones
+  const uint32_t kMask = IN_MODIFY | IN_CREATE | IN_MOVED_TO;
+  for (const auto& dir : dirs) {
+    if (!watched) {
+      break;
+    }
+    // Fails, and the watcher falls back to time outs, for a directory not
+    // in the local file system, as with ZenFS
+    watched = inotify_add_watch(inotify_fd_, dir.c_str(), kMask) >= 0;
+  }
+  if (!watched && inotify_fd_ >= 0) {
+    close(inotify_fd_);
+    inotify_fd_ = -1;
+  }
+#else
+  (void)dirs;
+#endif
+}
+
+PrimaryChangeWatcher::~PrimaryChangeWatcher() {
+#ifdef OS_LINUX
+  if (inotify_fd_ >= 0) {
+    close(inotify_fd_);
+  }
+  if (stop_fd_ >= 0) {
+    close(stop_fd_);
+  }
+#endif
+}
+
+bool PrimaryChangeWatcher::IsNotified() const {
+#ifdef OS_LINUX
+  return inotify_fd_ >= 0;
+#else
+  return false;
+#endif
+}
+
+bool PrimaryChangeWatcher::Wait(uint64_t timeout_us) {
+#ifdef OS_LINUX
+  if (inotify_fd_ >= 0) {
+    struct pollfd fds[2];
+    fds[0].fd = inotify_fd_;
+    fds[0].events = POLLIN;
+    fds[1].fd = stop_fd_;
+    fds[1].events = POLLIN;
+    int timeout_ms = static_cast<int>(
+        std::min<uint64_t>((timeout_us + 999) / 1000, port::kMaxInt32));
+    if (poll(fds, 2, timeout_ms) > 0 && (fds[0].revents & POLLIN)) {
+      // The events only tell that something changed, so they are dropped
+      char buf[4096];
+      while (read(inotify_fd_, buf, sizeof(buf)) > 0) {
+      }
+    }
+    MutexLock l(&mutex_);
+    return !stopped_;
+  }
+#endif
+  MutexLock l(&mutex_);
+  if (!stopped_) {
+    cv_.TimedWait(env_->NowMicros() + timeout_us);
+  }
+  return !stopped_;
+}
+
+void PrimaryChangeWatcher::Stop() {
+  MutexLock l(&mutex_);
+  stopped_ = true;
+  cv_.SignalAll();
+#ifdef OS_LINUX
+  if (stop_fd_ >= 0) {
+    uint64_t one = 1;
+    ssize_t written = write(stop_fd_, &one, sizeof(one));
+    (void)written;
+  }
+#endif
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !ROCKSDB_LITE
@@ -0,0 +1,54 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Waits for a primary DB to change its files, for a secondary instance to
+// catch up as soon as it does rather than by polling. On Linux, with the
+// directories of the DB in the local file system, the watcher is notified
+// of the files written and created there by inotify. Otherwise, or if the
+// notifications are lost, Wait() times out, and the caller polls.
+class PrimaryChangeWatcher {
+ public:
+  PrimaryChangeWatcher(Env* env, const std::vector<std::string>& dirs);
+  ~PrimaryChangeWatcher();
+
+  // No copying allowed
+  PrimaryChangeWatcher(const PrimaryChangeWatcher&) = delete;
+  void operator=(const PrimaryChangeWatcher&) = delete;
+
+  // Whether changes are notified, rather than only timed out on
+  bool IsNotified() const;
+
+  // Waits up to timeout_us for a change. Returns false once stopped.
+  bool Wait(uint64_t timeout_us);
+
+  // Makes Wait() return false from now on, including the one in progress
+  void Stop();
+
+ private:
+  Env* const env_;
+#ifdef OS_LINUX
+  int inotify_fd_ = -1;
+  int stop_fd_ = -1;  // An eventfd signaled by Stop()
+#endif
+  port::Mutex mutex_;
+  port::CondVar cv_;
+  bool stopped_ = false;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !ROCKSDB_LITE
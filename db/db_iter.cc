@@ -164,6 +164,27 @@ void DBIter::Next() {
   }
 }
 
+size_t DBIter::NextBatch(
+    size_t max_entries, size_t max_bytes,
+    const std::function<void(const Slice& key, const Slice& value)>&
+        callback) {
+  // As the default one, but with the calls to key(), value() and Next() of
+  // this final class not virtual, and without the wrapper of the arena.
+  // Next() steps the internal iterators with NextAndGetResult(), which
+  // brings the key and the bound check of the block up in the same call.
+  size_t num_entries = 0;
+  size_t bytes = 0;
+  while (num_entries < max_entries && bytes < max_bytes && valid_) {
+    const Slice k = key();
+    const Slice v = value();
+    callback(k, v);
+    num_entries++;
+    bytes += k.size() + v.size();
+    Next();
+  }
+  return num_entries;
+}
+
 // PRE: saved_key_ has the current user key if skipping_saved_key
 // POST: saved_key_ should have the next user key if valid_,
 //       if the current entry is a result of merge
@@ -192,6 +192,10 @@ class DBIter final : public Iterator {
   Status GetProperty(std::string prop_name, std::string* prop) override;
 
   void Next() final override;
+  size_t NextBatch(
+      size_t max_entries, size_t max_bytes,
+      const std::function<void(const Slice& key, const Slice& value)>&
+          callback) override;
   void Prev() final override;
   // 'target' does not contain timestamp, even if user timestamp feature is
   // enabled.
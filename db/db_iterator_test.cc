@@ -2353,6 +2353,85 @@ TEST_P(DBIteratorTest, RefreshWithSnapshot) {
   delete iter;
 }
 
+TEST_P(DBIteratorTest, RefreshWithRangeDeletion) {
+  ASSERT_OK(Put("x", "y"));
+  std::unique_ptr<Iterator> iter(NewIterator(ReadOptions()));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+
+  // The super version did not change, but the range tombstone is not in the
+  // aggregator of the iterator
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a",
+                             "z"));
+  ASSERT_OK(iter->Refresh());
+  iter->SeekToFirst();
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_OK(iter->status());
+}
+
+TEST_P(DBIteratorTest, RecycleIterator) {
+  ReadOptions ro;
+  ro.recycle_iterator = true;
+  SetPerfLevel(kEnableCount);
+  ASSERT_OK(Put("a", "1"));
+  Iterator* iter = db_->NewIterator(ro);
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("a", iter->key().ToString());
+  delete iter;
+
+  // Taken back, and sees the writes since
+  get_perf_context()->Reset();
+  ASSERT_OK(Put("b", "2"));
+  iter = db_->NewIterator(ro);
+  ASSERT_EQ(1, get_perf_context()->iterator_recycle_hit_count);
+  iter->SeekToLast();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("b", iter->key().ToString());
+  delete iter;
+
+  // Rebuilt on a new super version
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("c", "3"));
+  get_perf_context()->Reset();
+  iter = db_->NewIterator(ro);
+  ASSERT_EQ(1, get_perf_context()->iterator_recycle_hit_count);
+  std::string keys;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    keys += iter->key().ToString();
+  }
+  ASSERT_EQ("abc", keys);
+  // Not shared while in use
+  Iterator* iter2 = db_->NewIterator(ro);
+  ASSERT_EQ(1, get_perf_context()->iterator_recycle_miss_count);
+  delete iter;
+  delete iter2;
+
+  // Other options do not match
+  ReadOptions other_ro = ro;
+  other_ro.total_order_seek = true;
+  get_perf_context()->Reset();
+  iter = db_->NewIterator(other_ro);
+  ASSERT_EQ(0, get_perf_context()->iterator_recycle_hit_count);
+  ASSERT_EQ(1, get_perf_context()->iterator_recycle_miss_count);
+  delete iter;
+
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "b",
+                             "z"));
+  iter = db_->NewIterator(ro);
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("a", iter->key().ToString());
+  iter->Next();
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_OK(iter->status());
+  delete iter;
+  SetPerfLevel(kDisable);
+
+  // The iterators left in the pool are deleted on close
+  Close();
+}
+
 TEST_P(DBIteratorTest, CreationFailure) {
   SyncPoint::GetInstance()->SetCallBack(
       "DBImpl::NewInternalIterator:StatusCallback", [](void* arg) {
@@ -2403,6 +2482,114 @@ TEST_P(DBIteratorTest, UpperBoundWithChangeDirection) {
   delete iter;
 }
 
+TEST_P(DBIteratorTest, IterateBoundsPruneFiles) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  // Three files in L1, and two overlapping them in L0
+  for (const char* prefix : {"a", "c", "e"}) {
+    ASSERT_OK(Put(std::string(prefix) + "1", "v"));
+    ASSERT_OK(Put(std::string(prefix) + "2", "v"));
+    ASSERT_OK(Flush());
+  }
+  MoveFilesToLevel(1);
+  ASSERT_EQ("0,3", FilesPerLevel());
+  ASSERT_OK(Put("g1", "v"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("b1", "v"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("2,3", FilesPerLevel());
+
+  SetPerfLevel(kEnableCount);
+  {
+    std::string upper_bound = "b5";
+    Slice ub_slice(upper_bound);
+    ReadOptions ro;
+    ro.iterate_upper_bound = &ub_slice;
+    get_perf_context()->Reset();
+    std::unique_ptr<Iterator> iter(NewIterator(ro));
+    std::vector<std::string> keys;
+    for (iter->Seek("a"); iter->Valid(); iter->Next()) {
+      keys.push_back(iter->key().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(std::vector<std::string>({"a1", "a2", "b1"}), keys);
+    // The L0 file of g1 on Seek(), and the L1 file of c1 on Next()
+    ASSERT_EQ(2, get_perf_context()->iter_bound_pruned_file_count);
+  }
+  {
+    std::string lower_bound = "d";
+    Slice lb_slice(lower_bound);
+    ReadOptions ro;
+    ro.iterate_lower_bound = &lb_slice;
+    get_perf_context()->Reset();
+    std::unique_ptr<Iterator> iter(NewIterator(ro));
+    std::vector<std::string> keys;
+    for (iter->SeekForPrev("z"); iter->Valid(); iter->Prev()) {
+      keys.push_back(iter->key().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(std::vector<std::string>({"g1", "e2", "e1"}), keys);
+    // The L0 file of b1 on SeekForPrev(), and the L1 file of c1 on Prev()
+    ASSERT_EQ(2, get_perf_context()->iter_bound_pruned_file_count);
+  }
+  SetPerfLevel(kDisable);
+}
+
+TEST_P(DBIteratorTest, NextBatch) {
+  Options options = CurrentOptions();
+  DestroyAndReopen(options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "old" + ToString(i)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 100; i += 3) {
+    ASSERT_OK(Put(Key(i), "new" + ToString(i)));
+  }
+  for (int i = 1; i < 100; i += 5) {
+    ASSERT_OK(Delete(Key(i)));
+  }
+
+  std::vector<std::pair<std::string, std::string>> expected;
+  std::unique_ptr<Iterator> iter(NewIterator(ReadOptions()));
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    expected.emplace_back(iter->key().ToString(), iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+
+  std::vector<std::pair<std::string, std::string>> entries;
+  auto collect = [&](const Slice& key, const Slice& value) {
+    entries.emplace_back(key.ToString(), value.ToString());
+  };
+  iter->SeekToFirst();
+  size_t n;
+  while ((n = iter->NextBatch(7, port::kMaxSizet, collect)) > 0) {
+    ASSERT_TRUE(n == 7 || !iter->Valid());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(expected, entries);
+
+  // Stops at the entry that reaches max_bytes
+  entries.clear();
+  iter->SeekToFirst();
+  ASSERT_EQ(2, iter->NextBatch(10, expected[0].first.size() +
+                                       expected[0].second.size() + 1,
+                               collect));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(expected[2].first, iter->key().ToString());
+
+  // Goes forward after Prev()
+  entries.clear();
+  iter->SeekToLast();
+  iter->Prev();
+  ASSERT_EQ(2, iter->NextBatch(10, port::kMaxSizet, collect));
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_OK(iter->status());
+  expected.erase(expected.begin(), expected.end() - 2);
+  ASSERT_EQ(expected, entries);
+}
+
 TEST_P(DBIteratorTest, TableFilter) {
   ASSERT_OK(Put("a", "1"));
   dbfull()->Flush(FlushOptions());
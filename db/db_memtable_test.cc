@@ -313,6 +313,68 @@ TEST_F(DBMemTableTest, InsertWithHint) {
   ASSERT_EQ("vvv", Get("NotInPrefixDomain"));
 }
 
+TEST_F(DBMemTableTest, SkipListPrefixIndex) {
+  for (size_t lookahead : {0, 4}) {
+    Options options;
+    options.create_if_missing = true;
+    options.env = env_;
+    options.prefix_extractor.reset(NewFixedPrefixTransform(4));
+    // Few enough buckets for prefixes to collide
+    options.memtable_factory.reset(new SkipListFactory(lookahead, 2));
+    DestroyAndReopen(options);
+
+    const int kNumPrefixes = 8;
+    const int kNumKeys = 10;
+    // Backwards, for the first key of each prefix to change
+    for (int k = kNumKeys - 1; k >= 0; k--) {
+      for (int p = 0; p < kNumPrefixes; p++) {
+        ASSERT_OK(Put("pre" + ToString(p) + "k" + ToString(k),
+                      "v" + ToString(k)));
+      }
+    }
+    const Snapshot* snapshot = db_->GetSnapshot();
+    ASSERT_OK(Put("pre0k0", "new"));
+    ASSERT_OK(Put("pre0", "prefix_only"));
+
+    ReadOptions read_opts;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_opts));
+    for (int p = 0; p < kNumPrefixes; p++) {
+      std::string prefix = "pre" + ToString(p);
+      iter->Seek(prefix);
+      if (p == 0) {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ("pre0", iter->key().ToString());
+        iter->Next();
+      }
+      for (int k = 0; k < kNumKeys; k++) {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(prefix + "k" + ToString(k), iter->key().ToString());
+        ASSERT_EQ((p == 0 && k == 0) ? "new" : "v" + ToString(k),
+                  iter->value().ToString());
+        iter->Next();
+      }
+      // Past the first key of the prefix
+      iter->Seek(prefix + "k5");
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(prefix + "k5", iter->key().ToString());
+    }
+    iter->Seek("pre9");
+    ASSERT_TRUE(!iter->Valid() || !iter->key().starts_with("pre9"));
+    ASSERT_OK(iter->status());
+
+    // The first key of the prefix is newer than the snapshot
+    read_opts.snapshot = snapshot;
+    iter.reset(db_->NewIterator(read_opts));
+    iter->Seek("pre0");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("pre0k0", iter->key().ToString());
+    ASSERT_EQ("v0", iter->value().ToString());
+    ASSERT_OK(iter->status());
+    iter.reset();
+    db_->ReleaseSnapshot(snapshot);
+  }
+}
+
 TEST_F(DBMemTableTest, ColumnFamilyId) {
   // Verifies MemTableRepFactory is told the right column family id.
   Options options;
@@ -332,6 +394,74 @@ TEST_F(DBMemTableTest, ColumnFamilyId) {
   }
 }
 
+TEST_F(DBMemTableTest, ImmutableMemtableNumaNode) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = CreateDBStatistics();
+  // Node 0 always exists. Where migrating is not supported or not allowed,
+  // the memtables just stay where they are.
+  options.immutable_memtable_numa_node = 0;
+  options.max_write_buffer_number = 4;
+  options.min_write_buffer_number_to_merge = 3;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  std::string value = rnd.RandomString(1000);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), value));
+  }
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+  ASSERT_OK(Put("active", "v"));
+
+  ASSERT_EQ(value, Get(Key(7)));
+  ASSERT_EQ(1, TestGetTickerCount(options, IMMUTABLE_MEMTABLE_HIT));
+  ASSERT_EQ("v", Get("active"));
+  ASSERT_EQ(2, TestGetTickerCount(options, MEMTABLE_HIT));
+  ASSERT_EQ(1, TestGetTickerCount(options, IMMUTABLE_MEMTABLE_HIT));
+
+  // The migrated memtable flushes as usual
+  ASSERT_OK(Flush());
+  ASSERT_EQ(value, Get(Key(7)));
+}
+
+TEST_F(DBMemTableTest, BytewiseKeyComparator) {
+  // The inlined bytewise comparison orders keys like the user comparator
+  InternalKeyComparator icmp(BytewiseComparator());
+  MemTable::KeyComparator key_cmp(icmp);
+  ASSERT_TRUE(key_cmp.bytewise);
+  ASSERT_FALSE(MemTable::KeyComparator(
+                   InternalKeyComparator(ReverseBytewiseComparator()))
+                   .bytewise);
+
+  Random rnd(301);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 200; i++) {
+    // Short alphabet and shared prefixes so that keys often differ late, in
+    // or after the first 16 bytes, or only in length or sequence number
+    std::string user_key = i % 2 == 0 ? "0123456789abcdef" : "";
+    int len = rnd.Uniform(40);
+    for (int j = 0; j < len; j++) {
+      user_key.push_back(static_cast<char>('a' + rnd.Uniform(2) * 0x80));
+    }
+    for (SequenceNumber seq : {SequenceNumber{1}, SequenceNumber{2}}) {
+      std::string encoded;
+      PutLengthPrefixedSlice(&encoded,
+                             InternalKey(user_key, seq, kTypeValue).Encode());
+      keys.push_back(encoded);
+    }
+  }
+  auto sign = [](int r) { return r < 0 ? -1 : (r > 0 ? 1 : 0); };
+  for (const auto& a : keys) {
+    for (const auto& b : keys) {
+      Slice ka = GetLengthPrefixedSlice(a.data());
+      Slice kb = GetLengthPrefixedSlice(b.data());
+      int expected = sign(icmp.CompareKeySeq(ka, kb));
+      ASSERT_EQ(expected, sign(key_cmp(a.data(), b.data())));
+      ASSERT_EQ(expected, sign(key_cmp(a.data(), kb)));
+    }
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
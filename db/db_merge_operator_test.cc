@@ -163,6 +163,53 @@ TEST_F(DBMergeOperatorTest, MergeErrorOnWrite) {
   VerifyDBInternal({{"k1", "corrupted"}, {"k1", "v2"}, {"k1", "v1"}});
 }
 
+TEST_F(DBMergeOperatorTest, PreaggregateMergeOperands) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.merge_operator = MergeOperators::CreateUInt64AddOperator();
+  options.inplace_update_support = true;
+  options.allow_concurrent_memtable_write = false;
+  options.preaggregate_merge_operands = true;
+  options.statistics = CreateDBStatistics();
+  options.env = env_;
+  DestroyAndReopen(options);
+
+  auto encode = [](uint64_t n) {
+    std::string encoded;
+    PutFixed64(&encoded, n);
+    return encoded;
+  };
+  ASSERT_OK(Put("k1", encode(10)));
+  for (uint64_t i = 1; i <= 100; i++) {
+    ASSERT_OK(Merge("k1", encode(i)));
+    ASSERT_OK(Merge("k2", encode(i)));
+  }
+  // Each key keeps its first operand, into which the others are combined
+  ASSERT_EQ(198U, TestGetTickerCount(options, NUMBER_MERGE_OPERANDS_COMBINED));
+  VerifyDBInternal({{"k1", encode(5050)},
+                    {"k1", encode(10)},
+                    {"k2", encode(5050)}});
+  ASSERT_EQ(encode(5060), Get("k1"));
+  ASSERT_EQ(encode(5050), Get("k2"));
+
+  // The WAL holds every operand, which are combined again on recovery
+  Reopen(options);
+  ASSERT_EQ(encode(5060), Get("k1"));
+  ASSERT_EQ(encode(5050), Get("k2"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(encode(5060), Get("k1"));
+  ASSERT_EQ(encode(5050), Get("k2"));
+
+  // Without inplace_update_support, operands are added as usual
+  options.inplace_update_support = false;
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+  ASSERT_OK(Merge("k2", encode(1)));
+  ASSERT_OK(Merge("k2", encode(2)));
+  ASSERT_EQ(0U, TestGetTickerCount(options, NUMBER_MERGE_OPERANDS_COMBINED));
+  ASSERT_EQ(encode(5053), Get("k2"));
+}
+
 TEST_F(DBMergeOperatorTest, MergeErrorOnIteration) {
   Options options;
   options.create_if_missing = true;
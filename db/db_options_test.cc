@@ -950,6 +950,63 @@ TEST_F(DBOptionsTest, ChangeCompression) {
   SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(DBOptionsTest, OptionsAdvisor) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  // Long enough for only the test to run the advisor
+  options.options_advisor_period_sec = 24 * 3600;
+  options.level0_file_num_compaction_trigger = 2;
+  options.level0_slowdown_writes_trigger = 2;
+  options.level0_stop_writes_trigger = 20;
+  options.max_bytes_for_level_base = options.write_buffer_size * 2;
+  options.options_advisor_max_change_factor = 4.0;
+
+  // Each flush from the second one on stalls writes, as L0 is not compacted
+  auto add_l0_files = [&](int n) {
+    for (int i = 0; i < n; i++) {
+      ASSERT_OK(Put("key" + ToString(i), "value"));
+      ASSERT_OK(Flush());
+    }
+  };
+
+  // Recommendations only
+  DestroyAndReopen(options);
+  ASSERT_OK(
+      dbfull()->SetOptions({{"level0_file_num_compaction_trigger", "100"}}));
+  add_l0_files(2);
+  dbfull()->RunOptionsAdvisor();
+  ASSERT_EQ(2, db_->GetOptions().level0_slowdown_writes_trigger);
+  ASSERT_EQ(options.max_bytes_for_level_base,
+            db_->GetOptions().max_bytes_for_level_base);
+
+  options.options_advisor_apply_changes = true;
+  DestroyAndReopen(options);
+  ASSERT_OK(
+      dbfull()->SetOptions({{"level0_file_num_compaction_trigger", "100"}}));
+  add_l0_files(2);
+  dbfull()->RunOptionsAdvisor();
+  ASSERT_EQ(3, db_->GetOptions().level0_slowdown_writes_trigger);
+  // Toward the size of L0 when compacted, within the change factor
+  ASSERT_EQ(options.max_bytes_for_level_base * 4,
+            db_->GetOptions().max_bytes_for_level_base);
+  ASSERT_EQ(options.max_background_jobs,
+            db_->GetDBOptions().max_background_jobs);
+
+  // More stalls than before the changes roll them back
+  add_l0_files(2);
+  dbfull()->RunOptionsAdvisor();
+  ASSERT_EQ(2, db_->GetOptions().level0_slowdown_writes_trigger);
+  ASSERT_EQ(options.max_bytes_for_level_base,
+            db_->GetOptions().max_bytes_for_level_base);
+
+  // And the options are then left alone for a while
+  add_l0_files(1);
+  dbfull()->RunOptionsAdvisor();
+  ASSERT_EQ(2, db_->GetOptions().level0_slowdown_writes_trigger);
+  ASSERT_EQ(options.max_bytes_for_level_base,
+            db_->GetOptions().max_bytes_for_level_base);
+}
+
 #endif  // ROCKSDB_LITE
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -1547,6 +1547,55 @@ TEST_F(DBPropertiesTest, SstFilesSize) {
   ASSERT_TRUE(listener->callback_triggered);
 }
 
+TEST_F(DBPropertiesTest, KeyDistribution) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.target_file_size_base = 16 << 10;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  std::string value;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kKeyDistribution, &value));
+  ASSERT_EQ("Buckets: 0 Samples: 0 Bytes: 0\n", value);
+
+  Random rnd(301);
+  for (int i = 0; i < 200; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(500)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(NumTableFilesAtLevel(1), 1);
+
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kKeyDistribution, &value));
+  std::vector<std::string> lines = StringSplit(value, '\n');
+  // The index blocks give several samples per file
+  size_t num_buckets = 0;
+  size_t num_samples = 0;
+  uint64_t bytes = 0;
+  ASSERT_EQ(3, sscanf(lines[0].c_str(),
+                      "Buckets: %" ROCKSDB_PRIszt " Samples: %" ROCKSDB_PRIszt
+                      " Bytes: %" PRIu64,
+                      &num_buckets, &num_samples, &bytes));
+  ASSERT_GT(num_samples, static_cast<size_t>(NumTableFilesAtLevel(1)));
+  ASSERT_GT(num_buckets, 1U);
+  ASSERT_EQ(num_buckets + 1, lines.size());
+  // The last bucket ends with the largest key
+  ASSERT_NE(std::string::npos,
+            lines.back().find(Slice(Key(199)).ToString(true /* hex */)));
+
+  std::string at_level;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kKeyDistributionAtLevel + "1",
+                               &at_level));
+  ASSERT_EQ(value, at_level);
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kKeyDistributionAtLevel + "0",
+                               &at_level));
+  ASSERT_EQ("Buckets: 0 Samples: 0 Bytes: 0\n", at_level);
+  ASSERT_FALSE(db_->GetProperty(
+      DB::Properties::kKeyDistributionAtLevel + ToString(1000), &at_level));
+}
+
 TEST_F(DBPropertiesTest, MinObsoleteSstNumberToKeep) {
   class TestListener : public EventListener {
    public:
@@ -1713,6 +1762,48 @@ TEST_F(DBPropertiesTest, BlockCacheProperties) {
   ASSERT_EQ(0, value);
 }
 
+TEST_F(DBPropertiesTest, BlockCacheAllocatorStats) {
+  class StatsAllocator : public MemoryAllocator {
+   public:
+    const char* Name() const override { return "StatsAllocator"; }
+    void* Allocate(size_t size) override { return new char[size]; }
+    void Deallocate(void* p) override { delete[] static_cast<char*>(p); }
+    bool GetProperty(const std::string& property,
+                     std::string* value) const override {
+      if (property != kStatsProperty) {
+        return false;
+      }
+      *value = "fragmentation: 0.0%";
+      return true;
+    }
+  };
+
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  std::string value;
+
+  // The default allocator reports nothing
+  table_options.block_cache = NewLRUCache(1 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  ASSERT_FALSE(
+      db_->GetProperty(DB::Properties::kBlockCacheAllocatorStats, &value));
+
+  table_options.block_cache =
+      NewLRUCache(1 << 20, -1 /* num_shard_bits */,
+                  false /* strict_capacity_limit */,
+                  0.5 /* high_pri_pool_ratio */,
+                  std::make_shared<StatsAllocator>());
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  ASSERT_OK(Put("key", "value"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("value", Get("key"));
+  ASSERT_TRUE(
+      db_->GetProperty(DB::Properties::kBlockCacheAllocatorStats, &value));
+  ASSERT_EQ("fragmentation: 0.0%", value);
+}
+
 #endif  // ROCKSDB_LITE
 }  // namespace ROCKSDB_NAMESPACE
 
@@ -354,6 +354,49 @@ TEST_F(DBRangeDelTest, CompactionRemovesCoveredKeys) {
   }
 }
 
+TEST_F(DBRangeDelTest, CompactionDropsCoveredFilesWithoutReading) {
+  Options opts = CurrentOptions();
+  opts.disable_auto_compactions = true;
+  opts.statistics = CreateDBStatistics();
+  Reopen(opts);
+
+  for (int i = 10; i < 20; ++i) {
+    ASSERT_OK(Put(Key(i), "val"));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), Key(0),
+                             Key(100)));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(2, NumTableFilesAtLevel(0));
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(1, TestGetTickerCount(opts, COMPACTION_RANGE_DEL_DROP_FILES));
+  ASSERT_GT(TestGetTickerCount(opts, COMPACTION_RANGE_DEL_DROP_FILE_BYTES), 0);
+  ASSERT_EQ(0, TestGetTickerCount(opts, COMPACTION_KEY_DROP_RANGE_DEL));
+  ReadOptions read_opts;
+  read_opts.ignore_range_deletions = true;
+  std::string value;
+  ASSERT_TRUE(db_->Get(read_opts, Key(15), &value).IsNotFound());
+
+  // A snapshot between the keys and the tombstone keeps the file
+  for (int i = 10; i < 20; ++i) {
+    ASSERT_OK(Put(Key(i), "val2"));
+  }
+  ASSERT_OK(Flush());
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), Key(0),
+                             Key(100)));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(1, TestGetTickerCount(opts, COMPACTION_RANGE_DEL_DROP_FILES));
+  read_opts.ignore_range_deletions = false;
+  read_opts.snapshot = snapshot;
+  ASSERT_OK(db_->Get(read_opts, Key(15), &value));
+  ASSERT_EQ("val2", value);
+  read_opts.snapshot = nullptr;
+  ASSERT_TRUE(db_->Get(read_opts, Key(15), &value).IsNotFound());
+  db_->ReleaseSnapshot(snapshot);
+}
+
 TEST_F(DBRangeDelTest, ValidLevelSubcompactionBoundaries) {
   const int kNumPerFile = 100, kNumFiles = 4, kFileBytes = 100 << 10;
   Options options = CurrentOptions();
@@ -697,6 +740,43 @@ TEST_F(DBRangeDelTest, GetCoveredKeyFromSst) {
   } while (ChangeOptions(kRangeDelSkipConfigs));
 }
 
+TEST_F(DBRangeDelTest, GetWithRangeTombstoneIndex) {
+  // Lookups of keys outside the version's range tombstones skip the tables'
+  // tombstones, which the results must not show, also when the tables are
+  // not all held open and the index is not built
+  for (int max_open_files : {-1, 10}) {
+    Options options = CurrentOptions();
+    options.max_open_files = max_open_files;
+    options.disable_auto_compactions = true;
+    DestroyAndReopen(options);
+    for (int i = 0; i < 20; ++i) {
+      ASSERT_OK(Put(Key(i), "val" + ToString(i)));
+    }
+    ASSERT_OK(Flush());
+    const Snapshot* snapshot = db_->GetSnapshot();
+    ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                               Key(5), Key(10)));
+    ASSERT_OK(Flush());
+    ASSERT_OK(Put(Key(7), "new"));
+    ASSERT_OK(Flush());
+    ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                               Key(15), Key(18)));
+    ASSERT_OK(Flush());
+
+    for (int i = 0; i < 20; ++i) {
+      if (i == 7) {
+        ASSERT_EQ("new", Get(Key(i)));
+      } else if ((i >= 5 && i < 10) || (i >= 15 && i < 18)) {
+        ASSERT_EQ("NOT_FOUND", Get(Key(i)));
+      } else {
+        ASSERT_EQ("val" + ToString(i), Get(Key(i)));
+      }
+      ASSERT_EQ("val" + ToString(i), Get(Key(i), snapshot));
+    }
+    db_->ReleaseSnapshot(snapshot);
+  }
+}
+
 TEST_F(DBRangeDelTest, GetCoveredMergeOperandFromMemtable) {
   const int kNumMergeOps = 10;
   Options opts = CurrentOptions();
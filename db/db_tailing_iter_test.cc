@@ -531,6 +531,59 @@ TEST_F(DBTestTailingIterator, SeekToFirstWithUpperBoundBug) {
   ASSERT_EQ(iter->key().ToString(), "aa");
 }
 
+TEST_F(DBTestTailingIterator, NextKeepsUnchangedChildren) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  // A file below L0
+  ASSERT_OK(Put("a1", "v"));
+  ASSERT_OK(Put("a3", "v"));
+  ASSERT_OK(Put("a5", "v"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  // An L0 file
+  ASSERT_OK(Put("b1", "v"));
+  ASSERT_OK(Put("b3", "v"));
+  ASSERT_OK(Flush());
+
+  ReadOptions read_options;
+  read_options.tailing = true;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("a1", iter->key().ToString());
+
+  int kept_levels = 0;
+  bool kept_l0 = false;
+  SyncPoint::GetInstance()->SetCallBack(
+      "ForwardIterator::RenewIterators:KeepLevel",
+      [&](void* /*arg*/) { ++kept_levels; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "ForwardIterator::RenewIterators:Copy",
+      [&](void* /*arg*/) { kept_l0 = true; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // A new L0 file renews the iterators on the next Next()
+  ASSERT_OK(Put("a2", "v"));
+  ASSERT_OK(Put("a4", "v"));
+  ASSERT_OK(Flush());
+
+  std::vector<std::string> keys;
+  for (iter->Next(); iter->Valid(); iter->Next()) {
+    keys.push_back(iter->key().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(std::vector<std::string>({"a2", "a3", "a4", "a5", "b1", "b3"}),
+            keys);
+  ASSERT_EQ(1, kept_levels);
+  ASSERT_TRUE(kept_l0);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 #endif  // !defined(ROCKSDB_LITE)
@@ -6423,6 +6423,53 @@ TEST_F(DBTest, RowCache) {
   ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
 }
 
+TEST_F(DBTest, RowCacheNegativeEntries) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.row_cache = NewLRUCache(8192);
+  options.row_cache_negative_entries = true;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("a", "1"));
+  ASSERT_OK(Put("e", "5"));
+  ASSERT_OK(Flush());
+
+  // The lookup of an absent key in the file is kept
+  ASSERT_EQ(Get("c"), "NOT_FOUND");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 0);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
+  ASSERT_EQ(Get("c"), "NOT_FOUND");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
+
+  // MultiGet looks the keys up together, hits and misses alike
+  ASSERT_EQ(MultiGet({"a", "b", "d"}),
+            std::vector<std::string>({"1", "NOT_FOUND", "NOT_FOUND"}));
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 4);
+  ASSERT_EQ(MultiGet({"a", "b", "d", "c"}),
+            std::vector<std::string>(
+                {"1", "NOT_FOUND", "NOT_FOUND", "NOT_FOUND"}));
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 5);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 4);
+
+  // A key written later is read from the newer file
+  ASSERT_OK(Put("c", "3"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(Get("c"), "3");
+
+  // Lookups in files with range deletions are not kept
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "x",
+                             "y"));
+  ASSERT_OK(Put("w", "23"));
+  ASSERT_OK(Put("z", "26"));
+  ASSERT_OK(Flush());
+  uint64_t misses = TestGetTickerCount(options, ROW_CACHE_MISS);
+  ASSERT_EQ(Get("x1"), "NOT_FOUND");
+  ASSERT_EQ(Get("x1"), "NOT_FOUND");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), misses + 2);
+}
+
 TEST_F(DBTest, PinnableSliceAndRowCache) {
   Options options = CurrentOptions();
   options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
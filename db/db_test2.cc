@@ -12,10 +12,17 @@
 
 #include "db/db_test_util.h"
 #include "db/read_callback.h"
+#include "env/fs_hedged.h"
+#include "env/fs_tiered.h"
+#include "file/file_util.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
+#include "rocksdb/compressor.h"
+#include "rocksdb/lock_profiler.h"
 #include "rocksdb/persistent_cache.h"
+#include "rocksdb/utilities/parallel_scan.h"
 #include "rocksdb/wal_filter.h"
+#include "util/compression.h"
 #include "util/random.h"
 #include "utilities/fault_injection_env.h"
 
@@ -1390,6 +1397,179 @@ TEST_F(DBTest2, PresetCompressionDictLocality) {
   }
 }
 
+TEST_F(DBTest2, PresetCompressionDictShared) {
+  if (!ZSTD_Supported()) {
+    return;
+  }
+  // Verifies that with a shared dictionary, the files written before the
+  // first training have no dictionary, the files written after it share the
+  // trained one, and the readers share one cached copy of it.
+  const int kNumEntriesPerFile = 1 << 10;
+  const int kNumBytesPerEntry = 1 << 10;
+  const int kNumFiles = 5;
+  Options options = CurrentOptions();
+  options.compression = kZSTD;
+  options.compression_opts.max_dict_bytes = 256 << 10;
+  // Trained once the third file is written
+  options.compression_opts.shared_dict_retrain_bytes = 2560 << 10;
+  options.disable_auto_compactions = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.cache_index_and_filter_blocks = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumFiles; ++i) {
+    for (int j = 0; j < kNumEntriesPerFile; ++j) {
+      values.push_back(rnd.RandomString(kNumBytesPerEntry));
+      ASSERT_OK(Put(Key(i * kNumEntriesPerFile + j), values.back()));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(kNumFiles, NumTableFilesAtLevel(0));
+
+  TablePropertiesCollection props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+  ASSERT_EQ(static_cast<size_t>(kNumFiles), props.size());
+  std::vector<uint64_t> dict_ids;
+  for (const auto& file_props : props) {
+    dict_ids.push_back(file_props.second->compression_dict_id);
+  }
+  // Three files without a dictionary, then two with the same one
+  std::sort(dict_ids.begin(), dict_ids.end());
+  ASSERT_EQ(0U, dict_ids[0]);
+  ASSERT_EQ(0U, dict_ids[2]);
+  ASSERT_NE(0U, dict_ids[3]);
+  ASSERT_EQ(dict_ids[3], dict_ids[4]);
+
+  for (int i = 0; i < kNumFiles * kNumEntriesPerFile; ++i) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+  ASSERT_EQ(1, options.statistics->getTickerCount(
+                   BLOCK_CACHE_COMPRESSION_DICT_ADD));
+}
+
+namespace {
+// Compresses with the built-in libraries, as an accelerator producing the
+// same streams would, completing batches on threads of its own
+class TestCompressor : public Compressor {
+ public:
+  TestCompressor(CompressionType type, bool fail_every_other)
+      : type_(type), fail_every_other_(fail_every_other) {}
+
+  ~TestCompressor() override {
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  const char* Name() const override { return "TestCompressor"; }
+
+  bool Supports(CompressionType type) const override { return type == type_; }
+
+  Status Compress(CompressionType type, const CompressionOptions& opts,
+                  const Slice& input, std::string* output) override {
+    if (fail_every_other_ && num_calls_.fetch_add(1) % 2 == 0) {
+      return Status::Busy();
+    }
+    CompressionContext context(type);
+    CompressionInfo info(opts, context, CompressionDict::GetEmptyDict(), type,
+                         0 /* sample_for_compression */);
+    std::string framed;
+    if (!CompressData(input, info, 2 /* compress_format_version */,
+                      &framed)) {
+      return Status::NotSupported();
+    }
+    // Strip the framing the table builder adds back
+    Slice stream(framed);
+    uint32_t size;
+    if (type != kSnappyCompression && !GetVarint32(&stream, &size)) {
+      return Status::Corruption();
+    }
+    output->append(stream.data(), stream.size());
+    num_compressed_.fetch_add(1);
+    return Status::OK();
+  }
+
+  void CompressAsync(CompressionType type, const CompressionOptions& opts,
+                     std::vector<Block>* blocks,
+                     std::function<void()> done) override {
+    num_batches_.fetch_add(1);
+    MutexLock l(&mutex_);
+    threads_.emplace_back([this, type, &opts, blocks, done] {
+      Compressor::CompressAsync(type, opts, blocks, done);
+    });
+  }
+
+  int num_compressed() const { return num_compressed_.load(); }
+  int num_batches() const { return num_batches_.load(); }
+
+ private:
+  const CompressionType type_;
+  const bool fail_every_other_;
+  std::atomic<int> num_calls_{0};
+  std::atomic<int> num_compressed_{0};
+  std::atomic<int> num_batches_{0};
+  port::Mutex mutex_;
+  std::vector<port::Thread> threads_;
+};
+}  // namespace
+
+TEST_F(DBTest2, CompressorPlugin) {
+  CompressionType type = kNoCompression;
+  if (Snappy_Supported()) {
+    type = kSnappyCompression;
+  } else if (LZ4_Supported()) {
+    type = kLZ4Compression;
+  } else if (Zlib_Supported()) {
+    type = kZlibCompression;
+  } else if (ZSTD_Supported()) {
+    type = kZSTD;
+  } else {
+    return;
+  }
+  const int kNumKeys = 1000;
+
+  for (bool parallel : {false, true}) {
+    for (bool fail_every_other : {false, true}) {
+      auto compressor =
+          std::make_shared<TestCompressor>(type, fail_every_other);
+      Options options = CurrentOptions();
+      options.compression = type;
+      options.compression_opts.parallel_threads = parallel ? 4 : 1;
+      options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+      BlockBasedTableOptions table_options;
+      table_options.compressor = compressor;
+      options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+      DestroyAndReopen(options);
+
+      Random rnd(301);
+      std::vector<std::string> values;
+      for (int i = 0; i < kNumKeys; ++i) {
+        values.push_back(rnd.RandomString(100) + std::string(400, 'v'));
+        ASSERT_OK(Put(Key(i), values.back()));
+      }
+      ASSERT_OK(Flush());
+
+      ASSERT_GT(compressor->num_compressed(), 0);
+      if (parallel) {
+        ASSERT_GT(compressor->num_batches(), 0);
+      }
+      ASSERT_GT(options.statistics->getTickerCount(NUMBER_BLOCK_COMPRESSED),
+                0);
+
+      // Read the blocks back from the file with the built-in decompression
+      Reopen(options);
+      for (int i = 0; i < kNumKeys; ++i) {
+        ASSERT_EQ(values[i], Get(Key(i)));
+      }
+      Close();
+    }
+  }
+}
+
 class CompactionCompressionListener : public EventListener {
  public:
   explicit CompactionCompressionListener(Options* db_options)
@@ -1786,6 +1966,65 @@ TEST_F(DBTest2, DuplicateSnapshot) {
     db_->ReleaseSnapshot(s);
   }
 }
+
+TEST_F(DBTest2, ConcurrentSnapshots) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  DBImpl* dbi = static_cast_with_check<DBImpl>(db_);
+
+  // Overwrites, flushes and compacts the same keys while the other threads
+  // take snapshots, whose reads must not change
+  std::atomic<bool> stop{false};
+  port::Thread writer([&]() {
+    for (int i = 0; !stop.load(); i++) {
+      for (int k = 0; k < 10; k++) {
+        ASSERT_OK(Put(Key(k), ToString(i)));
+      }
+      if (i % 50 == 0) {
+        ASSERT_OK(Flush());
+      }
+      if (i % 200 == 0) {
+        ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+      }
+    }
+  });
+
+  std::vector<port::Thread> readers;
+  for (int t = 0; t < 4; t++) {
+    readers.emplace_back([&]() {
+      Random rnd(301);
+      for (int i = 0; i < 500; i++) {
+        const Snapshot* snapshot = db_->GetSnapshot();
+        ReadOptions read_options;
+        read_options.snapshot = snapshot;
+        std::string first;
+        ASSERT_OK(db_->Get(read_options, Key(rnd.Uniform(10)), &first));
+        env_->SleepForMicroseconds(rnd.Uniform(100));
+        std::vector<SequenceNumber> seqs = dbi->snapshots().GetAll();
+        ASSERT_TRUE(std::is_sorted(seqs.begin(), seqs.end()));
+        ASSERT_LE(static_cast<SequenceNumber>(
+                      dbi->snapshots().GetOldestSnapshotSequence()),
+                  snapshot->GetSequenceNumber());
+        // All keys are written with the same value by a write
+        for (int k = 0; k < 10; k++) {
+          std::string value;
+          ASSERT_OK(db_->Get(read_options, Key(k), &value));
+          ASSERT_EQ(first, value);
+        }
+        db_->ReleaseSnapshot(snapshot);
+      }
+    });
+  }
+  for (auto& t : readers) {
+    t.join();
+  }
+  stop.store(true);
+  writer.join();
+
+  ASSERT_TRUE(dbi->snapshots().empty());
+  ASSERT_EQ(0, dbi->snapshots().GetOldestSnapshotSequence());
+}
 #endif  // ROCKSDB_LITE
 
 class PinL0IndexAndFilterBlocksTest
@@ -3739,6 +3978,77 @@ TEST_F(DBTest2, TraceWithLimit) {
   ASSERT_OK(DestroyDB(dbname2, options));
 }
 
+TEST_F(DBTest2, ShardedTraceReplay) {
+  Options options = CurrentOptions();
+  ReadOptions ro;
+  WriteOptions wo;
+  TraceOptions trace_opts;
+  EnvOptions env_opts;
+  Reopen(options);
+
+  std::string trace_filename = dbname_ + "/rocksdb.trace_sharded";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(NewFileTraceWriter(env_, env_opts, trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(trace_opts, std::move(trace_writer)));
+  // Overwrites that only come out right replayed in order, single keys and
+  // batches of keys of all the shards
+  const int kNumKeys = 100;
+  int num_writes = 0;
+  int num_gets = 0;
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(Key(i), "v" + ToString(round)));
+      num_writes++;
+      ASSERT_EQ("v" + ToString(round), Get(Key(i)));
+      num_gets++;
+    }
+    WriteBatch batch;
+    for (int i = 0; i < kNumKeys; i += 10) {
+      ASSERT_OK(batch.Put(Key(i), "batch" + ToString(round)));
+    }
+    ASSERT_OK(db_->Write(wo, &batch));
+    num_writes++;
+  }
+  ASSERT_OK(db_->DeleteRange(wo, db_->DefaultColumnFamily(), Key(90),
+                             Key(95)));
+  num_writes++;
+  ASSERT_OK(Put(Key(92), "after_range_deletion"));
+  num_writes++;
+  ASSERT_OK(db_->EndTrace());
+
+  std::string dbname2 = test::PerThreadDBPath(env_, "/db_replay_sharded");
+  ASSERT_OK(DestroyDB(dbname2, options));
+  DB* db2 = nullptr;
+  options.create_if_missing = true;
+  ASSERT_OK(DB::Open(options, dbname2, &db2));
+
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(NewFileTraceReader(env_, env_opts, trace_filename, &trace_reader));
+  Replayer replayer(db2, {db2->DefaultColumnFamily()},
+                    std::move(trace_reader));
+  ASSERT_OK(replayer.SetFastForward(1000));
+  ReplayLatencies latencies;
+  ASSERT_OK(replayer.ShardedReplay(/*threads_num=*/4, &latencies));
+  ASSERT_EQ(static_cast<uint64_t>(num_writes), latencies.write.num());
+  ASSERT_EQ(static_cast<uint64_t>(num_gets), latencies.get.num());
+  ASSERT_NE(std::string::npos, latencies.ToString().find("Get"));
+
+  for (int i = 0; i < kNumKeys; i++) {
+    std::string expected;
+    std::string value;
+    Status s = db_->Get(ro, Key(i), &expected);
+    ASSERT_EQ(s.code(), db2->Get(ro, Key(i), &value).code());
+    ASSERT_EQ(expected, value);
+  }
+  std::string value;
+  ASSERT_TRUE(db2->Get(ro, Key(91), &value).IsNotFound());
+  ASSERT_OK(db2->Get(ro, Key(92), &value));
+  ASSERT_EQ("after_range_deletion", value);
+
+  delete db2;
+  ASSERT_OK(DestroyDB(dbname2, options));
+}
+
 TEST_F(DBTest2, TraceWithSampling) {
   Options options = CurrentOptions();
   ReadOptions ro;
@@ -4037,6 +4347,134 @@ TEST_F(DBTest2, PinnableSliceAndMmapReads) {
 #endif
 }
 
+TEST_F(DBTest2, ServeDataBlocksFromMmap) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  if (options.env != Env::Default()) {
+    ROCKSDB_GTEST_SKIP("Test requires default environment");
+    return;
+  }
+  options.allow_mmap_reads = true;
+  options.compression = kNoCompression;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+  table_options.block_size = 256;
+  table_options.serve_data_blocks_from_mmap = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  const int kNumKeys = 200;
+  std::vector<std::string> keys;
+  for (int i = 0; i < kNumKeys; i++) {
+    keys.push_back(Key(i));
+    ASSERT_OK(Put(Key(i), "value" + ToString(i)));
+  }
+  ASSERT_OK(Flush());
+
+  auto verify = [&]() {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ("value" + ToString(i), Get(Key(i)));
+    }
+    std::vector<std::string> values = MultiGet(keys);
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ("value" + ToString(i), values[i]);
+    }
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ("value" + ToString(count), iter->value().ToString());
+      count++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kNumKeys, count);
+  };
+
+  // Data blocks bypass the block cache while index and filter blocks use it
+  verify();
+  ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_DATA_ADD));
+  ASSERT_GT(TestGetTickerCount(options, BLOCK_CACHE_INDEX_ADD) +
+                TestGetTickerCount(options, BLOCK_CACHE_INDEX_HIT),
+            0);
+  ASSERT_GT(TestGetTickerCount(options, BLOCK_CACHE_FILTER_ADD) +
+                TestGetTickerCount(options, BLOCK_CACHE_FILTER_HIT),
+            0);
+
+#ifndef ROCKSDB_LITE
+  Close();
+  options.max_open_files = -1;
+  ASSERT_OK(ReadOnlyReopen(options));
+  verify();
+  ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_DATA_ADD));
+#endif  // !ROCKSDB_LITE
+
+  // Without the option, data blocks are looked up in the block cache
+  table_options.serve_data_blocks_from_mmap = false;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  options.max_open_files = 100;
+  Reopen(options);
+  verify();
+  ASSERT_GT(TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS), 0);
+}
+
+#ifndef ROCKSDB_LITE
+TEST_F(DBTest2, PerLevelBlockSize) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  BlockBasedTableOptions table_options;
+  table_options.block_size_per_level = {1024, 8192};
+  table_options.block_restart_interval_per_level = {4, 32};
+  table_options.auto_tune_block_size = true;
+  table_options.max_auto_tuned_block_size = 64 * 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // The average data block size of the only table of the DB
+  auto avg_block_size = [&]() {
+    TablePropertiesCollection props;
+    EXPECT_OK(db_->GetPropertiesOfAllTables(&props));
+    EXPECT_EQ(1U, props.size());
+    const TableProperties& p = *props.begin()->second;
+    return p.data_size / p.num_data_blocks;
+  };
+
+  const int kNumKeys = 4000;
+  Random rnd(301);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(100)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ("1", FilesPerLevel());
+  ASSERT_LT(avg_block_size(), 2048U);
+
+  CompactRangeOptions cro;
+  cro.change_level = true;
+  cro.target_level = 1;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  uint64_t block_size = avg_block_size();
+  ASSERT_GT(block_size, 4096U);
+  ASSERT_LT(block_size, 16384U);
+
+  // Level 1 is only scanned, so its next table gets the largest blocks
+  for (int i = 0; i < 2000; i++) {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    iter->Seek(Key(i));
+    ASSERT_TRUE(iter->Valid());
+  }
+  cro.change_level = false;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  ASSERT_GT(avg_block_size(), 32U * 1024);
+}
+#endif  // ROCKSDB_LITE
+
 TEST_F(DBTest2, DISABLED_IteratorPinnedMemory) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
@@ -5202,6 +5640,483 @@ TEST_F(DBTest2, PointInTimeRecoveryWithIOErrorWhileReadingWal) {
   Status s = TryReopen(options);
   ASSERT_TRUE(s.IsIOError());
 }
+
+TEST_F(DBTest2, LockProfiler) {
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(1 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  ResetLockContentionStats();
+  SetLockProfilingSampleOneIn(1);
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("bar", Get("foo"));
+  SetLockProfilingSampleOneIn(0);
+
+  std::vector<LockContentionStats> stats;
+  GetLockContentionStats(&stats);
+  std::set<std::string> lock_names;
+  for (const auto& s : stats) {
+    lock_names.insert(s.lock_name);
+    ASSERT_GT(s.sampled_acquisitions, 0);
+    ASSERT_GE(s.total_wait_nanos, s.max_wait_nanos);
+    ASSERT_GE(s.total_hold_nanos, s.max_hold_nanos);
+    ASSERT_EQ(std::string::npos, s.acquire_site.find("lock_profiler.h"));
+    ASSERT_EQ(std::string::npos, s.acquire_site.find("instrumented_mutex"));
+  }
+  ASSERT_EQ(1, lock_names.count("DBImpl::mutex_"));
+  ASSERT_EQ(1, lock_names.count("WriteThread::newest_writer_"));
+  ASSERT_EQ(1, lock_names.count("LRUCacheShard::mutex_"));
+  ASSERT_NE(std::string::npos,
+            LockContentionStatsToString().find("DBImpl::mutex_"));
+
+  // Nothing is sampled once profiling is off
+  ResetLockContentionStats();
+  ASSERT_OK(Put("foo", "baz"));
+  GetLockContentionStats(&stats);
+  ASSERT_TRUE(stats.empty());
+}
+
+TEST_F(DBTest2, LazyOpenTableFiles) {
+  const int kNumFiles = 4;
+  Options options = CurrentOptions();
+  options.max_open_files = -1;
+  options.skip_stats_update_on_db_open = true;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+    ASSERT_OK(Flush());
+  }
+
+  options.lazy_open_table_files = true;
+  options.statistics = CreateDBStatistics();
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"DBTest2::LazyOpenTableFiles:Checked",
+        "DBImpl::BGWorkOpenTableFiles:Start"},
+       {"DBImpl::BGWorkOpenTableFiles:End",
+        "DBTest2::LazyOpenTableFiles:Opened"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+  Reopen(options);
+
+  // No file is opened by DB::Open()
+  ASSERT_EQ(0, options.statistics->getTickerCount(NO_FILE_OPENS));
+  uint64_t pending = 0;
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kNumTableFilesPendingOpen,
+                                  &pending));
+  ASSERT_EQ(kNumFiles, pending);
+  // A file is opened on its first read
+  ASSERT_EQ("v0", Get(Key(0)));
+  ASSERT_EQ(1, options.statistics->getTickerCount(NO_FILE_OPENS));
+
+  // And the others in the background
+  TEST_SYNC_POINT("DBTest2::LazyOpenTableFiles:Checked");
+  TEST_SYNC_POINT("DBTest2::LazyOpenTableFiles:Opened");
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kNumTableFilesPendingOpen,
+                                  &pending));
+  ASSERT_EQ(0, pending);
+  ASSERT_EQ(kNumFiles, options.statistics->getTickerCount(NO_FILE_OPENS));
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+  ASSERT_EQ(kNumFiles, options.statistics->getTickerCount(NO_FILE_OPENS));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBTest2, TableMetadataCheckpoint) {
+  const int kNumFiles = 4;
+  Options options = CurrentOptions();
+  options.max_open_files = -1;
+  options.disable_auto_compactions = true;
+  options.max_table_metadata_checkpoint_size = 1 << 20;
+  Reopen(options);
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+    ASSERT_OK(Flush());
+  }
+
+  // Saved at close, and read and deleted at open
+  Close();
+  const std::string fname = TableMetadataFileName(dbname_);
+  ASSERT_OK(env_->FileExists(fname));
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+  ASSERT_TRUE(env_->FileExists(fname).IsNotFound());
+  ASSERT_EQ(kNumFiles, options.statistics->getTickerCount(
+                           TABLE_OPEN_PREFETCHED_TAIL_HIT));
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+
+  // Not used once the tables changed
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  Close();
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+  ASSERT_EQ(1, options.statistics->getTickerCount(
+                   TABLE_OPEN_PREFETCHED_TAIL_HIT));
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+
+  // A corrupted file is ignored
+  Close();
+  std::string data;
+  ASSERT_OK(ReadFileToString(env_, fname, &data));
+  data[data.size() / 2] ^= 0x55;
+  ASSERT_OK(WriteStringToFile(env_, data, fname));
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+  ASSERT_TRUE(env_->FileExists(fname).IsNotFound());
+  ASSERT_EQ(0, options.statistics->getTickerCount(
+                   TABLE_OPEN_PREFETCHED_TAIL_HIT));
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+
+  // Nor saved without the option
+  options.max_table_metadata_checkpoint_size = 0;
+  Reopen(options);
+  Close();
+  ASSERT_TRUE(env_->FileExists(fname).IsNotFound());
+}
+
+TEST_F(DBTest2, BlockCacheWarmup) {
+  const int kNumKeys = 1000;
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.block_cache_warmup_save_period_sec = 3600;
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumKeys; i++) {
+    values.push_back(rnd.RandomString(100));
+    ASSERT_OK(Put(Key(i), values.back()));
+    if (i % 250 == 249) {
+      ASSERT_OK(Flush());
+    }
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+
+  // Saved at close
+  Close();
+  ASSERT_OK(env_->FileExists(BlockCacheWarmupFileName(dbname_)));
+
+  // And read into the new block cache after open
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  options.statistics = CreateDBStatistics();
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"DBImpl::BGWorkBlockCacheWarmup:End",
+        "DBTest2::BlockCacheWarmup:WarmedUp"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+  Reopen(options);
+  TEST_SYNC_POINT("DBTest2::BlockCacheWarmup:WarmedUp");
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_GT(options.statistics->getTickerCount(BLOCK_CACHE_WARMUP_BLOCKS), 0);
+  const uint64_t data_misses =
+      options.statistics->getTickerCount(BLOCK_CACHE_DATA_MISS);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+  ASSERT_EQ(data_misses,
+            options.statistics->getTickerCount(BLOCK_CACHE_DATA_MISS));
+
+  // The blocks of the files compacted away are skipped
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  Close();
+  options.statistics = CreateDBStatistics();
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"DBImpl::BGWorkBlockCacheWarmup:End",
+        "DBTest2::BlockCacheWarmup:WarmedUp"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+  Reopen(options);
+  TEST_SYNC_POINT("DBTest2::BlockCacheWarmup:WarmedUp");
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(0, options.statistics->getTickerCount(BLOCK_CACHE_WARMUP_BLOCKS));
+}
+
+#ifndef ROCKSDB_LITE
+TEST_F(DBTest2, ParallelScan) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+  const int kNumFiles = 10;
+  const int kKeysPerFile = 100;
+  std::vector<std::string> expected;
+  for (int f = 0; f < kNumFiles; f++) {
+    for (int i = 0; i < kKeysPerFile; i++) {
+      expected.push_back(Key(f * kKeysPerFile + i));
+      ASSERT_OK(Put(expected.back(), "v" + expected.back()));
+    }
+    ASSERT_OK(Flush());
+  }
+  MoveFilesToLevel(1);
+  expected.push_back(Key(kNumFiles * kKeysPerFile));
+  ASSERT_OK(Put(expected.back(), "v" + expected.back()));
+
+  std::mutex mutex;
+  std::map<size_t, std::vector<std::string>> partitions;
+  ParallelScanCallback collect = [&](const ParallelScanBatch& batch) {
+    EXPECT_EQ(batch.keys.size(), batch.values.size());
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& keys = partitions[batch.partition];
+    for (size_t i = 0; i < batch.keys.size(); i++) {
+      EXPECT_EQ("v" + batch.keys[i].ToString(), batch.values[i].ToString());
+      keys.push_back(batch.keys[i].ToString());
+    }
+    return Status::OK();
+  };
+  auto scanned = [&]() {
+    std::vector<std::string> keys;
+    for (const auto& partition : partitions) {
+      keys.insert(keys.end(), partition.second.begin(),
+                  partition.second.end());
+    }
+    return keys;
+  };
+
+  ParallelScanOptions scan_options;
+  scan_options.num_threads = 3;
+  scan_options.num_partitions = 5;
+  scan_options.batch_size = 100;
+  ASSERT_OK(ParallelScan(db_, nullptr, scan_options, collect));
+  ASSERT_EQ(5, partitions.size());
+  ASSERT_EQ(expected, scanned());
+
+  partitions.clear();
+  const std::string lower = Key(150);
+  const std::string upper = Key(750);
+  const Slice lower_slice(lower);
+  const Slice upper_slice(upper);
+  scan_options.lower_bound = &lower_slice;
+  scan_options.upper_bound = &upper_slice;
+  ASSERT_OK(ParallelScan(db_, nullptr, scan_options, collect));
+  ASSERT_GT(partitions.size(), 1);
+  ASSERT_EQ(std::vector<std::string>(expected.begin() + 150,
+                                     expected.begin() + 750),
+            scanned());
+
+  // The first error stops the scan
+  ASSERT_TRUE(ParallelScan(db_, nullptr, scan_options,
+                           [](const ParallelScanBatch&) {
+                             return Status::Aborted("stop");
+                           })
+                  .IsAborted());
+}
+#endif  // ROCKSDB_LITE
+
+TEST_F(DBTest2, VersionFilesSnapshot) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(Put(Key(i * 10), "v"));
+    ASSERT_OK(Put(Key(i * 10 + 5), "v"));
+    ASSERT_OK(Flush());
+  }
+
+  std::shared_ptr<const VersionFilesSnapshot> before =
+      dbfull()->GetDefaultFilesSnapshot();
+  ASSERT_NE(nullptr, before);
+  ASSERT_EQ(3, before->LevelFiles(0).size());
+  std::vector<LiveFileMetaData> live;
+  db_->GetLiveFilesMetaData(&live);
+  ASSERT_EQ(3, live.size());
+  for (const auto& f : before->LevelFiles(0)) {
+    ASSERT_FALSE(f.being_compacted);
+    ASSERT_EQ(1, std::count_if(live.begin(), live.end(),
+                               [&](const LiveFileMetaData& m) {
+                                 return m.level == 0 &&
+                                        MakeTableFileName("", f.number) ==
+                                            m.name;
+                               }));
+  }
+  std::vector<const VersionFilesSnapshot::File*> overlapping;
+  before->GetOverlappingFiles(0, InternalKey(Key(12), 0, kTypeValue),
+                              InternalKey(Key(13), 0, kTypeValue),
+                              &overlapping);
+  ASSERT_EQ(1, overlapping.size());
+  ASSERT_EQ(Key(10), overlapping[0]->smallest.user_key().ToString());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  std::shared_ptr<const VersionFilesSnapshot> after =
+      dbfull()->GetDefaultFilesSnapshot();
+  ASSERT_EQ(0, after->LevelFiles(0).size());
+  ASSERT_EQ(1, after->LevelFiles(1).size());
+  ASSERT_FALSE(after->LevelFiles(1)[0].being_compacted);
+  overlapping.clear();
+  after->GetOverlappingFiles(1, InternalKey(Key(12), 0, kTypeValue),
+                             InternalKey(Key(13), 0, kTypeValue),
+                             &overlapping);
+  ASSERT_EQ(1, overlapping.size());
+  // The old snapshot is left as it was
+  ASSERT_EQ(3, before->LevelFiles(0).size());
+}
+
+TEST_F(DBTest2, VersionFilesSnapshotSharesUnchangedLevels) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+  ASSERT_OK(Put(Key(1), "v"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  std::shared_ptr<const VersionFilesSnapshot> before =
+      dbfull()->GetDefaultFilesSnapshot();
+  ASSERT_EQ(1, before->LevelFiles(1).size());
+
+  ASSERT_OK(Put(Key(2), "v"));
+  ASSERT_OK(Flush());
+  std::shared_ptr<const VersionFilesSnapshot> after =
+      dbfull()->GetDefaultFilesSnapshot();
+  ASSERT_EQ(0, before->LevelFiles(0).size());
+  ASSERT_EQ(1, after->LevelFiles(0).size());
+  // The flush left L1 as it was
+  ASSERT_EQ(&before->LevelFiles(1), &after->LevelFiles(1));
+}
+
+#ifndef ROCKSDB_LITE
+TEST_F(DBTest2, TieredFileSystem) {
+  const std::string fast_root = test::PerThreadDBPath(env_, "fast_tier");
+  ASSERT_OK(env_->CreateDirIfMissing(fast_root));
+  std::shared_ptr<FileSystem> fs = NewTieredFileSystem(
+      env_->GetFileSystem(), fast_root, env_->GetFileSystem(), 0);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+  Options options = CurrentOptions();
+  options.env = env.get();
+  options.num_levels = 3;
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put(Key(1), "v1"));
+  ASSERT_OK(Put(Key(2), "v2"));
+  ASSERT_OK(Flush());
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(1, files.size());
+  // L0 files are on the fast tier
+  ASSERT_OK(env_->FileExists(fast_root + dbname_ + files[0].name));
+  ASSERT_TRUE(env_->FileExists(dbname_ + files[0].name).IsNotFound());
+  ASSERT_OK(env_->FileExists(fast_root + CurrentFileName(dbname_)));
+
+  // The compaction into L1 moves the data to the slow tier, even where it
+  // could have moved the file
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  files.clear();
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(1, files.size());
+  ASSERT_GT(files[0].level, 0);
+  ASSERT_OK(env_->FileExists(dbname_ + files[0].name));
+  ASSERT_TRUE(
+      env_->FileExists(fast_root + dbname_ + files[0].name).IsNotFound());
+
+  // Files of a previous run are found on either tier
+  Reopen(options);
+  ASSERT_EQ("v1", Get(Key(1)));
+  ASSERT_EQ("v2", Get(Key(2)));
+
+  Close();
+  ASSERT_OK(DestroyDB(dbname_, options));
+  ASSERT_OK(DestroyDir(env_, fast_root));
+}
+
+namespace {
+// Delays the reads of the random access files by delay_us
+class SlowReadFileSystem : public FileSystemWrapper {
+ public:
+  explicit SlowReadFileSystem(const std::shared_ptr<FileSystem>& fs)
+      : FileSystemWrapper(fs) {}
+
+  const char* Name() const override { return "SlowReadFileSystem"; }
+
+  IOStatus NewRandomAccessFile(const std::string& f,
+                               const FileOptions& file_opts,
+                               std::unique_ptr<FSRandomAccessFile>* r,
+                               IODebugContext* dbg) override {
+    class SlowFile : public FSRandomAccessFileWrapper {
+     public:
+      SlowFile(std::unique_ptr<FSRandomAccessFile>&& file,
+               std::shared_ptr<std::atomic<int>> delay_us)
+          : FSRandomAccessFileWrapper(file.get()),
+            file_(std::move(file)),
+            delay_us_(delay_us) {}
+
+      IOStatus Read(uint64_t offset, size_t n, const IOOptions& options,
+                    Slice* result, char* scratch,
+                    IODebugContext* dbg) const override {
+        Env::Default()->SleepForMicroseconds(delay_us_->load());
+        return file_->Read(offset, n, options, result, scratch, dbg);
+      }
+
+     private:
+      std::unique_ptr<FSRandomAccessFile> file_;
+      std::shared_ptr<std::atomic<int>> delay_us_;
+    };
+
+    std::unique_ptr<FSRandomAccessFile> file;
+    IOStatus s = target()->NewRandomAccessFile(f, file_opts, &file, dbg);
+    if (s.ok()) {
+      r->reset(new SlowFile(std::move(file), delay_us));
+    }
+    return s;
+  }
+
+  std::shared_ptr<std::atomic<int>> delay_us =
+      std::make_shared<std::atomic<int>>(0);
+};
+}  // namespace
+
+TEST_F(DBTest2, HedgedReadFileSystem) {
+  auto slow_fs = std::make_shared<SlowReadFileSystem>(env_->GetFileSystem());
+  HedgedReadOptions hedged_options;
+  hedged_options.replica_fs = env_->GetFileSystem();
+  hedged_options.min_samples = 1;
+  hedged_options.min_delay_us = 1000;
+  hedged_options.max_delay_us = 2000;
+  hedged_options.statistics = CreateDBStatistics();
+  std::shared_ptr<FileSystem> fs =
+      NewHedgedReadFileSystem(slow_fs, hedged_options);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+  Options options = CurrentOptions();
+  options.env = env.get();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ("v0", Get(Key(0)));
+
+  // The reads of the slow file system lose to their hedges on the replica
+  slow_fs->delay_us->store(50000);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+  Statistics* stats = hedged_options.statistics.get();
+  ASSERT_GT(stats->getTickerCount(HEDGED_READS), 0);
+  ASSERT_GT(stats->getTickerCount(HEDGED_READ_WINS), 0);
+  ASSERT_LE(stats->getTickerCount(HEDGED_READ_WINS),
+            stats->getTickerCount(HEDGED_READS));
+
+  slow_fs->delay_us->store(0);
+  Close();
+  ASSERT_OK(DestroyDB(dbname_, options));
+}
+#endif  // ROCKSDB_LITE
 }  // namespace ROCKSDB_NAMESPACE
 
 #ifdef ROCKSDB_UNITTESTS_WITH_CUSTOM_OBJECTS_FROM_STATIC_LIBS
@@ -946,6 +946,44 @@ TEST_P(DBTestUniversalCompaction, UniversalCompactionOptions) {
   ASSERT_EQ(NumSortedRuns(1), 1);
 }
 
+TEST_P(DBTestUniversalCompaction, UniversalCompactionLazyLeveling) {
+  Options options = CurrentOptions();
+  options.compaction_style = kCompactionStyleUniversal;
+  options.write_buffer_size = 105 << 10;    // 105KB
+  options.target_file_size_base = 32 << 10;  // 32KB
+  options.level0_file_num_compaction_trigger = 20;
+  options.num_levels = num_levels_;
+  options.compaction_options_universal.runs_per_tier = 3;
+  DestroyAndReopen(options);
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  Random rnd(301);
+  int key_idx = 0;
+  for (int num = 0; num < 16; num++) {
+    // Write about 60KB (60 values, each 1K)
+    for (int i = 0; i < 60; i++) {
+      ASSERT_OK(Put(1, Key(key_idx), rnd.RandomString(990)));
+      key_idx++;
+    }
+    ASSERT_OK(Flush(1));
+    ASSERT_OK(dbfull()->TEST_WaitForCompact());
+    if (num == 3) {
+      // The first full tier is merged into the oldest sorted run, which is
+      // in the tier just above, long before the trigger is reached.
+      ASSERT_EQ(NumSortedRuns(1), 1);
+    }
+    // At most two sorted runs of each tier besides the oldest sorted run
+    ASSERT_LE(NumSortedRuns(1), 5);
+  }
+  for (int i = 0; i < key_idx; i++) {
+    ASSERT_NE("NOT_FOUND", Get(1, Key(i)));
+  }
+
+  std::string stats;
+  ASSERT_TRUE(dbfull()->GetProperty(handles_[1], "rocksdb.cfstats", &stats));
+  ASSERT_NE(std::string::npos, stats.find("Amplification:"));
+}
+
 TEST_P(DBTestUniversalCompaction, UniversalCompactionStopStyleSimilarSize) {
   Options options = CurrentOptions();
   options.compaction_style = kCompactionStyleUniversal;
@@ -13,6 +13,7 @@
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "test_util/sync_point.h"
+#include "util/compression.h"
 #include "utilities/fault_injection_env.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -1038,10 +1039,144 @@ TEST_F(DBWALTest, SyncMultipleLogs) {
   ASSERT_OK(dbfull()->SyncWAL());
 }
 
+TEST_F(DBWALTest, RecoverWithWALStreams) {
+  const int kNumThreads = 4;
+  const int kNumKeysPerThread = 200;
+
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.enable_pipelined_write = true;
+  options.wal_streams = 3;
+  options.avoid_flush_during_recovery = true;
+  DestroyAndReopen(options);
+
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      WriteOptions wo;
+      wo.sync = (t == 0);
+      for (int i = 0; i < kNumKeysPerThread; i++) {
+        std::string key = Key(t * kNumKeysPerThread + i);
+        ASSERT_OK(db_->Put(wo, key, "v" + key));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  SequenceNumber last_sequence = dbfull()->GetLatestSequenceNumber();
+
+  Reopen(options);
+  ASSERT_EQ(last_sequence, dbfull()->GetLatestSequenceNumber());
+  for (int i = 0; i < kNumThreads * kNumKeysPerThread; i++) {
+    ASSERT_EQ("v" + Key(i), Get(Key(i)));
+  }
+
+  // A memtable switch rolls every stream to new files
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+  ASSERT_OK(Put("foo", "v2"));
+  Reopen(options);
+  ASSERT_EQ("v2", Get("foo"));
+
+  options.enable_pipelined_write = false;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+}
+
+TEST_F(DBWALTest, WALCompression) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.avoid_flush_during_recovery = true;
+  options.wal_compression = kSnappyCompression;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  if (!StreamingCompressionTypeSupported(kZSTD)) {
+    ROCKSDB_GTEST_SKIP("Test requires ZSTD streaming compression");
+    return;
+  }
+
+  options.wal_compression = kZSTD;
+  DestroyAndReopen(options);
+  Random rnd(301);
+  // Spans several log blocks so that it is compressed in chunks
+  const std::string large = rnd.RandomString(100000);
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(Put("large", large));
+  ASSERT_OK(Put("compressible", std::string(100000, 'x')));
+  ASSERT_OK(Delete("foo"));
+  ASSERT_OK(Put("bar", "v1"));
+
+  Reopen(options);
+  ASSERT_EQ("NOT_FOUND", Get("foo"));
+  ASSERT_EQ(large, Get("large"));
+  ASSERT_EQ(std::string(100000, 'x'), Get("compressible"));
+  ASSERT_EQ("v1", Get("bar"));
+
+  // Logs written with and without compression can be recovered together
+  options.wal_compression = kNoCompression;
+  Reopen(options);
+  ASSERT_OK(Put("bar", "v2"));
+  options.wal_compression = kZSTD;
+  Reopen(options);
+  ASSERT_OK(Put("foo", "v3"));
+  options.wal_compression = kNoCompression;
+  Reopen(options);
+  ASSERT_EQ("v3", Get("foo"));
+  ASSERT_EQ("v2", Get("bar"));
+  ASSERT_EQ(large, Get("large"));
+}
+
 // Github issue 1339. Prior the fix we read sequence id from the first log to
 // a local variable, then keep increase the variable as we replay logs,
 // ignoring actual sequence id of the records. This is incorrect if some writes
 // come with WAL disabled.
+TEST_F(DBWALTest, ParallelRecovery) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.avoid_flush_during_recovery = true;
+  for (bool concurrent_inserts : {true, false}) {
+    options.wal_recovery_threads = 1;
+    options.write_buffer_size = 64 << 20;
+    options.allow_concurrent_memtable_write = concurrent_inserts;
+    DestroyAndReopen(options);
+    CreateAndReopenWithCF({"pikachu"}, options);
+    // Spans several replay groups and WAL files, with keys overwritten
+    // across them
+    const int kNumKeys = 20000;
+    Random rnd(301);
+    for (int round = 0; round < 3; round++) {
+      for (int i = 0; i < kNumKeys; i++) {
+        ASSERT_OK(
+            Put(i % 2, Key(i), rnd.RandomString(200) + ToString(round)));
+      }
+      if (round == 0) {
+        ASSERT_OK(Delete(1, Key(0)));
+      }
+      dbfull()->TEST_SwitchWAL();
+    }
+    std::vector<std::string> values;
+    for (int i = 0; i < kNumKeys; i++) {
+      values.push_back(Get(i % 2, Key(i)));
+    }
+
+    // Memtables fill up during the replay
+    options.wal_recovery_threads = 4;
+    options.write_buffer_size = 1 << 20;
+    ReopenWithColumnFamilies({"default", "pikachu"}, options);
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(values[i], Get(i % 2, Key(i)));
+    }
+    ASSERT_OK(Put(0, "foo", "v1"));
+
+    // Recovering again replays the same data
+    options.wal_recovery_threads = 1;
+    ReopenWithColumnFamilies({"default", "pikachu"}, options);
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(values[i], Get(i % 2, Key(i)));
+    }
+    ASSERT_EQ("v1", Get(0, "foo"));
+  }
+}
+
 TEST_F(DBWALTest, PartOfWritesWithWALDisabled) {
   std::unique_ptr<FaultInjectionTestEnv> fault_env(
       new FaultInjectionTestEnv(env_));
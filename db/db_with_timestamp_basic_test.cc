@@ -1649,6 +1649,89 @@ TEST_F(DBBasicTestWithTimestamp, MultiGetNoReturnTs) {
   Close();
 }
 
+TEST_F(DBBasicTestWithTimestamp, PruneFilesNewerThanReadTimestamp) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.disable_auto_compactions = true;
+  const size_t kTimestampSize = Timestamp(0, 0).size();
+  TestComparator test_cmp(kTimestampSize);
+  options.comparator = &test_cmp;
+  DestroyAndReopen(options);
+
+  const std::vector<std::string> write_timestamps = {Timestamp(1, 0),
+                                                     Timestamp(10, 0)};
+  for (size_t i = 0; i < write_timestamps.size(); ++i) {
+    WriteOptions write_opts;
+    Slice write_ts = write_timestamps[i];
+    write_opts.timestamp = &write_ts;
+    ASSERT_OK(db_->Put(write_opts, "a", "value" + std::to_string(i)));
+    ASSERT_OK(db_->Put(write_opts, "b", "value" + std::to_string(i)));
+    ASSERT_OK(Flush());
+  }
+
+  TablePropertiesCollection props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+  ASSERT_EQ(2, props.size());
+  for (const auto& item : props) {
+    const auto& user_props = item.second->user_collected_properties;
+    auto min_pos = user_props.find("rocksdb.timestamp.min");
+    ASSERT_NE(user_props.end(), min_pos);
+    ASSERT_EQ(min_pos->second, user_props.at("rocksdb.timestamp.max"));
+  }
+
+  SetPerfLevel(kEnableCount);
+  for (int reopen = 0; reopen < 2; ++reopen) {
+    std::string read_ts_str = Timestamp(5, 0);
+    Slice read_ts = read_ts_str;
+    ReadOptions read_opts;
+    read_opts.timestamp = &read_ts;
+
+    get_perf_context()->Reset();
+    std::string value;
+    ASSERT_OK(db_->Get(read_opts, "a", &value));
+    ASSERT_EQ("value0", value);
+    ASSERT_EQ(1, get_perf_context()->timestamp_pruned_file_count);
+
+    get_perf_context()->Reset();
+    ColumnFamilyHandle* cfh = db_->DefaultColumnFamily();
+    ColumnFamilyHandle* column_families[] = {cfh, cfh};
+    Slice keys[] = {"a", "b"};
+    PinnableSlice values[2];
+    Status statuses[2];
+    db_->MultiGet(read_opts, /*num_keys=*/2, &column_families[0], &keys[0],
+                  &values[0], &statuses[0], /*sorted_input=*/false);
+    for (size_t i = 0; i < 2; ++i) {
+      ASSERT_OK(statuses[i]);
+      ASSERT_EQ("value0", values[i]);
+    }
+    ASSERT_EQ(1, get_perf_context()->timestamp_pruned_file_count);
+
+    get_perf_context()->Reset();
+    std::unique_ptr<Iterator> it(db_->NewIterator(read_opts));
+    int count = 0;
+    for (it->SeekToFirst(); it->Valid(); it->Next(), ++count) {
+      ASSERT_EQ("value0", it->value());
+    }
+    ASSERT_OK(it->status());
+    ASSERT_EQ(2, count);
+    ASSERT_EQ(1, get_perf_context()->timestamp_pruned_file_count);
+    it.reset();
+
+    // A read at the newest timestamp opens both files
+    read_ts_str = Timestamp(20, 0);
+    read_ts = read_ts_str;
+    get_perf_context()->Reset();
+    ASSERT_OK(db_->Get(read_opts, "a", &value));
+    ASSERT_EQ("value1", value);
+    ASSERT_EQ(0, get_perf_context()->timestamp_pruned_file_count);
+
+    // The timestamp ranges are kept in the MANIFEST
+    Reopen(options);
+  }
+  SetPerfLevel(kDisable);
+  Close();
+}
+
 #endif  // !ROCKSDB_LITE
 
 INSTANTIATE_TEST_CASE_P(
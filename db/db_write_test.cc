@@ -441,6 +441,111 @@ TEST_P(DBWriteTest, ConcurrentlyDisabledWAL) {
     ASSERT_LE(bytes_num, 1024 * 100);
 }
 
+TEST_P(DBWriteTest, WriteAsync) {
+  const int kNumWrites = 100;
+  Options options = GetOptions();
+  options.max_async_write_threads = 3;
+  Reopen(options);
+
+  port::Mutex mutex;
+  port::CondVar cv(&mutex);
+  // Guarded by mutex
+  int completed = 0;
+  std::vector<Status> statuses(kNumWrites);
+  std::vector<WriteBatch> batches(kNumWrites);
+  for (int i = 0; i < kNumWrites; i++) {
+    ASSERT_OK(batches[i].Put(Key(i), "v" + ToString(i)));
+    dbfull()->WriteAsync(WriteOptions(), &batches[i],
+                         [&, i](const Status& s) {
+                           MutexLock l(&mutex);
+                           statuses[i] = s;
+                           completed++;
+                           cv.SignalAll();
+                         });
+  }
+  {
+    MutexLock l(&mutex);
+    while (completed < kNumWrites) {
+      cv.Wait();
+    }
+  }
+  for (int i = 0; i < kNumWrites; i++) {
+    ASSERT_OK(statuses[i]);
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+
+  // Closing the DB finishes the queued writes, later ones are refused
+  WriteBatch last_batch;
+  ASSERT_OK(last_batch.Put("last", "v"));
+  Status last_status = Status::Incomplete();
+  dbfull()->WriteAsync(WriteOptions(), &last_batch,
+                       [&](const Status& s) { last_status = s; });
+  Close();
+  ASSERT_OK(last_status);
+  Reopen(options);
+  ASSERT_EQ("v", Get("last"));
+
+  Status refused;
+  ASSERT_OK(dbfull()->Close());
+  dbfull()->WriteAsync(WriteOptions(), &last_batch,
+                       [&](const Status& s) { refused = s; });
+  ASSERT_TRUE(refused.IsShutdownInProgress());
+}
+
+TEST_P(DBWriteTest, LargeBatchInsert) {
+  // Large batches are inserted into the memtable as one sorted batch
+  const int kNumKeys = 1000;
+  Random rnd(301);
+  for (bool concurrent : {false, true}) {
+    Options options = GetOptions();
+    options.allow_concurrent_memtable_write = concurrent;
+    DestroyAndReopen(options);
+
+    std::vector<int> order(kNumKeys);
+    for (int i = 0; i < kNumKeys; i++) {
+      order[i] = i;
+    }
+    for (int i = 1; i < kNumKeys; i++) {
+      std::swap(order[i], order[rnd.Uniform(i + 1)]);
+    }
+    WriteBatch batch;
+    for (int i : order) {
+      ASSERT_OK(batch.Put(Key(i), "v1"));
+    }
+    // Later entries for the same key in the batch win
+    for (int i = 0; i < kNumKeys; i += 3) {
+      ASSERT_OK(batch.Put(Key(i), "v2"));
+    }
+    for (int i = 1; i < kNumKeys; i += 3) {
+      ASSERT_OK(batch.Delete(Key(i)));
+    }
+    ASSERT_OK(batch.DeleteRange(Key(kNumKeys - 10), Key(kNumKeys)));
+    ASSERT_OK(db_->Write(WriteOptions(), &batch));
+
+    for (int pass = 0; pass < 2; pass++) {
+      std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+      iter->SeekToFirst();
+      for (int i = 0; i < kNumKeys - 10; i++) {
+        if (i % 3 == 1) {
+          ASSERT_EQ("NOT_FOUND", Get(Key(i)));
+          continue;
+        }
+        std::string expected = i % 3 == 0 ? "v2" : "v1";
+        ASSERT_EQ(expected, Get(Key(i)));
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(Key(i), iter->key().ToString());
+        ASSERT_EQ(expected, iter->value().ToString());
+        iter->Next();
+      }
+      ASSERT_FALSE(iter->Valid());
+      ASSERT_OK(iter->status());
+      iter.reset();
+      // Recovery replays the batch the same way
+      Reopen(options);
+    }
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
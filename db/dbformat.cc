@@ -166,13 +166,17 @@ void InternalKeyComparator::FindShortSuccessor(std::string* key) const {
 }
 
 LookupKey::LookupKey(const Slice& _user_key, SequenceNumber s,
-                     const Slice* ts) {
+                     const Slice* ts, bool recycle_block)
+    : recycled_block_(false) {
   size_t usize = _user_key.size();
   size_t ts_sz = (nullptr == ts) ? 0 : ts->size();
   size_t needed = usize + ts_sz + 13;  // A conservative estimate
   char* dst;
   if (needed <= sizeof(space_)) {
     dst = space_;
+  } else if (recycle_block && needed <= Arena::kMinBlockSize) {
+    dst = Arena::TakeRecycledBlock();
+    recycled_block_ = true;
   } else {
     dst = new char[needed];
   }
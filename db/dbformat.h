@@ -238,6 +238,10 @@ class InternalKeyComparator
               std::string(user_comparator_.Name());
     }
   }
+  // Unnamed, for comparators made per comparison, with the
+  // GetBuiltinComparator() of c found once
+  InternalKeyComparator(const Comparator* c, BuiltinComparator builtin)
+      : Comparator(c->timestamp_size()), user_comparator_(c, builtin) {}
   virtual ~InternalKeyComparator() {}
 
   virtual const char* Name() const override;
@@ -10,6 +10,7 @@
 #include "db/dbformat.h"
 #include "logging/logging.h"
 #include "test_util/testharness.h"
+#include "util/random.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -199,6 +200,39 @@ TEST_F(FormatTest, RangeTombstoneSerializeEndKey) {
   ASSERT_LT(cmp.Compare(t.SerializeEndKey(), k), 0);
 }
 
+TEST_F(FormatTest, BuiltinComparatorFastPath) {
+  Random rnd(301);
+  auto sign = [](int r) { return r < 0 ? -1 : (r > 0 ? 1 : 0); };
+  const UserComparatorWrapper bytewise(BytewiseComparator());
+  const UserComparatorWrapper reverse(ReverseBytewiseComparator());
+  ASSERT_EQ(BuiltinComparator::kBytewise, bytewise.builtin());
+  ASSERT_EQ(BuiltinComparator::kReverseBytewise, reverse.builtin());
+  for (int i = 0; i < 10000; i++) {
+    // Short alphabets and lengths, for equal words and common prefixes
+    std::string a(rnd.Uniform(20), 'a');
+    std::string b(rnd.Uniform(20), 'a');
+    for (auto& c : a) {
+      c = static_cast<char>(rnd.Uniform(2) == 0 ? 0xff : 'a');
+    }
+    for (size_t j = 0; j < b.size() && j < a.size(); j++) {
+      b[j] = rnd.OneIn(8) ? static_cast<char>(0x01) : a[j];
+    }
+    int expected = sign(Slice(a).compare(Slice(b)));
+    ASSERT_EQ(expected, sign(bytewise.Compare(a, b)));
+    ASSERT_EQ(-expected, sign(reverse.Compare(a, b)));
+    ASSERT_EQ(expected == 0, bytewise.Equal(a, b));
+  }
+
+  const InternalKeyComparator icmp(BytewiseComparator(),
+                                   BuiltinComparator::kBytewise);
+  ASSERT_LT(icmp.Compare(IKey("abcdefgh1", 5, kTypeValue),
+                         IKey("abcdefgh2", 9, kTypeValue)),
+            0);
+  ASSERT_LT(icmp.Compare(IKey("abcdefgh1", 9, kTypeValue),
+                         IKey("abcdefgh1", 5, kTypeValue)),
+            0);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
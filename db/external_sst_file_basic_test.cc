@@ -9,6 +9,7 @@
 #include "db/version_edit.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
+#include "rocksdb/parallel_sst_file_writer.h"
 #include "rocksdb/sst_file_writer.h"
 #include "test_util/testutil.h"
 #include "util/random.h"
@@ -218,6 +219,92 @@ TEST_F(ExternalSSTFileBasicTest, Basic) {
   DestroyAndRecreateExternalSSTFilesDir();
 }
 
+TEST_F(ExternalSSTFileBasicTest, ParallelSstFileWriter) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  DestroyAndReopen(options);
+  ASSERT_OK(Put(Key(5000), "old"));
+  ASSERT_OK(Put(Key(5001), "old"));
+
+  std::vector<ExternalSstFileInfo> file_infos;
+  {
+    ParallelSstFileWriter writer(EnvOptions(), options, sst_files_dir_ + "p",
+                                 4 /* num_threads */,
+                                 16 << 10 /* target_file_size */);
+    // Two pre-partitioned ranges after the stream
+    for (int p = 0; p < 2; p++) {
+      ASSERT_OK(writer.AddPartition([p](SstFileWriter* w) {
+        for (int k = 10000 + p * 1000; k < 10000 + (p + 1) * 1000; k++) {
+          Status s = w->Put(Key(k), Key(k) + "_part");
+          if (!s.ok()) {
+            return s;
+          }
+        }
+        return Status::OK();
+      }));
+    }
+    for (int k = 0; k < 5000; k++) {
+      ASSERT_OK(writer.Put(Key(k), Key(k) + "_val"));
+    }
+    ASSERT_OK(writer.Merge(Key(5000), "new"));
+    ASSERT_OK(writer.Delete(Key(5001)));
+    ASSERT_TRUE(writer.Put(Key(4000), "bad_val").IsInvalidArgument());
+    ASSERT_OK(writer.Finish(&file_infos));
+    ASSERT_TRUE(writer.Put(Key(6000), "bad_val").IsInvalidArgument());
+
+    ASSERT_GT(file_infos.size(), 3U);
+    uint64_t num_entries = 0;
+    for (size_t i = 0; i < file_infos.size(); i++) {
+      if (i > 0) {
+        ASSERT_LT(file_infos[i - 1].largest_key, file_infos[i].smallest_key);
+      }
+      num_entries += file_infos[i].num_entries;
+    }
+    ASSERT_EQ(7002U, num_entries);
+
+    const SequenceNumber seqno = db_->GetLatestSequenceNumber();
+    ASSERT_OK(writer.Ingest(db_, IngestExternalFileOptions()));
+    // All the files were ingested with a single global sequence number
+    ASSERT_EQ(seqno + 1, db_->GetLatestSequenceNumber());
+  }
+
+  for (int k = 0; k < 5000; k++) {
+    ASSERT_EQ(Key(k) + "_val", Get(Key(k)));
+  }
+  ASSERT_EQ("old,new", Get(Key(5000)));
+  ASSERT_EQ("NOT_FOUND", Get(Key(5001)));
+  for (int k = 10000; k < 12000; k++) {
+    ASSERT_EQ(Key(k) + "_part", Get(Key(k)));
+  }
+
+  DestroyAndRecreateExternalSSTFilesDir();
+}
+
+TEST_F(ExternalSSTFileBasicTest, ParallelSstFileWriterError) {
+  Options options = CurrentOptions();
+  std::vector<std::string> files;
+  {
+    ParallelSstFileWriter writer(EnvOptions(), options, sst_files_dir_ + "p",
+                                 2 /* num_threads */,
+                                 4 << 10 /* target_file_size */);
+    for (int k = 0; k < 1000; k++) {
+      ASSERT_OK(writer.Put(Key(k), Key(k) + "_val"));
+    }
+    // A partition that fails fails the whole load
+    ASSERT_OK(writer.AddPartition([](SstFileWriter*) {
+      return Status::IOError("injected");
+    }));
+    ASSERT_TRUE(writer.Finish().IsIOError());
+    ASSERT_TRUE(
+        writer.Ingest(db_, IngestExternalFileOptions()).IsInvalidArgument());
+  }
+  // The files built were deleted
+  ASSERT_OK(env_->GetChildren(sst_files_dir_, &files));
+  for (const auto& file : files) {
+    ASSERT_EQ(std::string::npos, file.find(".sst"));
+  }
+}
+
 class ChecksumVerifyHelper {
  private:
   Options options_;
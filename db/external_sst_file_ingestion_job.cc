@@ -123,6 +123,20 @@ Status ExternalSstFileIngestionJob::Prepare(
                            path_inside_db.c_str(), status.ToString().c_str());
           }
         }
+      } else if (status.IsNotSupported() &&
+                 ingestion_options_.failed_move_fall_back_to_rename) {
+        // The FS has no links, e.g. ZenFS, but the file can still be moved
+        // into the DB without copying its data.
+        status = fs_->RenameFile(path_outside_db, path_inside_db, IOOptions(),
+                                 nullptr);
+        TEST_SYNC_POINT_CALLBACK(
+            "ExternalSstFileIngestionJob::Prepare:RenameFile", &status);
+        if (status.ok()) {
+          f.renamed_file = true;
+        } else if (status.IsNotSupported() &&
+                   ingestion_options_.failed_move_fall_back_to_copy) {
+          f.copy_file = true;
+        }
       } else if (status.IsNotSupported() &&
                  ingestion_options_.failed_move_fall_back_to_copy) {
         // Original file is on a different FS, use copy instead of hard linking.
@@ -291,15 +305,7 @@ Status ExternalSstFileIngestionJob::Prepare(
   if (!status.ok()) {
     // We failed, remove all files that we copied into the db
     for (IngestedFileInfo& f : files_to_ingest_) {
-      if (f.internal_file_path.empty()) {
-        continue;
-      }
-      Status s = env_->DeleteFile(f.internal_file_path);
-      if (!s.ok()) {
-        ROCKS_LOG_WARN(db_options_.info_log,
-                       "AddFile() clean up for file %s failed : %s",
-                       f.internal_file_path.c_str(), s.ToString().c_str());
-      }
+      RemoveInternalFile(&f);
     }
   }
 
@@ -455,20 +461,32 @@ void ExternalSstFileIngestionJob::UpdateStats() {
       InternalStats::INGESTED_LEVEL0_NUM_FILES_TOTAL, total_l0_files);
 }
 
+void ExternalSstFileIngestionJob::RemoveInternalFile(IngestedFileInfo* f) {
+  if (f->internal_file_path.empty()) {
+    return;
+  }
+  Status s;
+  if (f->renamed_file) {
+    // Give the file back to the caller
+    s = env_->RenameFile(f->internal_file_path, f->external_file_path);
+  } else {
+    s = env_->DeleteFile(f->internal_file_path);
+  }
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(db_options_.info_log,
+                   "AddFile() clean up for file %s failed : %s",
+                   f->internal_file_path.c_str(), s.ToString().c_str());
+  }
+  f->internal_file_path.clear();
+  f->renamed_file = false;
+}
+
 void ExternalSstFileIngestionJob::Cleanup(const Status& status) {
   if (!status.ok()) {
     // We failed to add the files to the database
     // remove all the files we copied
     for (IngestedFileInfo& f : files_to_ingest_) {
-      if (f.internal_file_path.empty()) {
-        continue;
-      }
-      Status s = env_->DeleteFile(f.internal_file_path);
-      if (!s.ok()) {
-        ROCKS_LOG_WARN(db_options_.info_log,
-                       "AddFile() clean up for file %s failed : %s",
-                       f.internal_file_path.c_str(), s.ToString().c_str());
-      }
+      RemoveInternalFile(&f);
     }
     consumed_seqno_count_ = 0;
     files_overlap_ = false;
@@ -791,7 +809,8 @@ Status ExternalSstFileIngestionJob::AssignGlobalSeqnoForIngestedFile(
         fs_->NewRandomRWFile(file_to_ingest->internal_file_path, env_options_,
                              &rwfile, nullptr);
     if (status.ok()) {
-      FSRandomRWFilePtr fsptr(std::move(rwfile), io_tracer_);
+      FSRandomRWFilePtr fsptr(std::move(rwfile), io_tracer_,
+                              file_to_ingest->internal_file_path);
       std::string seqno_val;
       PutFixed64(&seqno_val, seqno);
       status = fsptr->Write(file_to_ingest->global_seqno_offset, seqno_val,
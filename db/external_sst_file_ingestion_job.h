@@ -64,6 +64,9 @@ struct IngestedFileInfo {
   // ingestion_options.move_files is false by default, thus copy_file is true
   // by default.
   bool copy_file = true;
+  // Whether the external sst file was renamed into the DB, see
+  // IngestExternalFileOptions::failed_move_fall_back_to_rename
+  bool renamed_file = false;
   // The checksum of ingested file
   std::string file_checksum;
   // The name of checksum function that generate the checksum
@@ -132,6 +135,10 @@ class ExternalSstFileIngestionJob {
   int ConsumedSequenceNumbersCount() const { return consumed_seqno_count_; }
 
  private:
+  // Removes the file that was copied, linked or renamed into the DB for
+  // file_to_ingest after a failure. A renamed file is renamed back.
+  void RemoveInternalFile(IngestedFileInfo* file_to_ingest);
+
   // Open the external file and populate `file_to_ingest` with all the
   // external information we need to ingest this file.
   Status GetIngestedFileInfo(const std::string& external_file,
@@ -2170,6 +2170,72 @@ TEST_P(ExternSSTFileLinkFailFallbackTest, LinkFailFallBackExternalSst) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(ExternSSTFileLinkFailFallbackTest, LinkFailFallBackToRename) {
+  test_env_->set_fail_link(true);
+  DestroyAndReopen(options_);
+  ASSERT_OK(Put(Key(0), "db_value"));
+  ASSERT_OK(Flush());
+
+  const int kNumKeys = 10000;
+  std::string file_path = sst_files_dir_ + "file1.sst";
+  SstFileWriter sst_file_writer(EnvOptions(), options_, nullptr /* cfh */,
+                                true /* invalidate_page_cache */,
+                                Env::IO_TOTAL, false /* skip_filters */,
+                                Env::WLTH_EXTREME);
+  ASSERT_OK(sst_file_writer.Open(file_path));
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(sst_file_writer.Put(Key(i), Key(i) + "_value"));
+  }
+  ASSERT_OK(sst_file_writer.Finish());
+  uint64_t file_size = 0;
+  ASSERT_OK(env_->GetFileSize(file_path, &file_size));
+
+  bool copyfile = false;
+  int renames = 0;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "ExternalSstFileIngestionJob::Prepare:CopyFile",
+      [&](void* /* arg */) { copyfile = true; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "ExternalSstFileIngestionJob::Prepare:RenameFile",
+      [&](void* /* arg */) { renames++; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  IngestExternalFileOptions ifo;
+  ifo.move_files = true;
+  ifo.failed_move_fall_back_to_copy = true;
+  ifo.failed_move_fall_back_to_rename = true;
+
+  // A failed ingestion renames the file back
+  ifo.allow_global_seqno = false;
+  ASSERT_NOK(db_->IngestExternalFile({file_path}, ifo));
+  ASSERT_EQ(1, renames);
+  ASSERT_OK(env_->FileExists(file_path));
+
+  ifo.allow_global_seqno = true;
+  ASSERT_OK(db_->IngestExternalFile({file_path}, ifo));
+  ASSERT_EQ(2, renames);
+  ASSERT_FALSE(copyfile);
+  ASSERT_TRUE(env_->FileExists(file_path).IsNotFound());
+
+  ColumnFamilyHandleImpl* cfh =
+      static_cast<ColumnFamilyHandleImpl*>(dbfull()->DefaultColumnFamily());
+  const std::vector<InternalStats::CompactionStats>& comp_stats =
+      cfh->cfd()->internal_stats()->TEST_GetCompactionStats();
+  uint64_t bytes_copied = 0;
+  uint64_t bytes_moved = 0;
+  for (const auto& stats : comp_stats) {
+    bytes_copied += stats.bytes_written;
+    bytes_moved += stats.bytes_moved;
+  }
+  ASSERT_EQ(0, bytes_copied);
+  ASSERT_EQ(file_size, bytes_moved);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(Key(i) + "_value", Get(Key(i)));
+  }
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 class TestIngestExternalFileListener : public EventListener {
  public:
   void OnExternalFileIngested(DB* /*db*/,
@@ -2403,7 +2469,7 @@ TEST_F(ExternalSSTFileTest, IngestFileWrittenWithCompressionDictionary) {
 
 // Very slow, not worth the cost to run regularly
 TEST_F(ExternalSSTFileTest, DISABLED_HugeBlockChecksum) {
-  int max_checksum = static_cast<int>(kxxHash64);
+  int max_checksum = static_cast<int>(kXXH3);
   for (int i = 0; i <= max_checksum; ++i) {
     BlockBasedTableOptions table_options;
     table_options.checksum = static_cast<ChecksumType>(i);
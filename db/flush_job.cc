@@ -12,12 +12,14 @@
 #include <cinttypes>
 
 #include <algorithm>
+#include <unordered_set>
 #include <vector>
 
 #include "db/builder.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
 #include "db/event_helpers.h"
+#include "db/key_distribution.h"
 #include "db/log_reader.h"
 #include "db/log_writer.h"
 #include "db/memtable.h"
@@ -80,6 +82,71 @@ const char* GetFlushReasonString (FlushReason flush_reason) {
   }
 }
 
+namespace {
+
+// The entries of an iterator over the memtables with user keys in
+// [lower, upper), a nullptr bound being unbounded, for each of the key
+// ranges of a flush split by max_flush_partitions to be written from its
+// own iterator. All versions of a user key go into the same range.
+class FlushPartitionIterator : public InternalIterator {
+ public:
+  FlushPartitionIterator(InternalIterator* iter, const Comparator* ucmp,
+                         const std::string* lower, const std::string* upper)
+      : iter_(iter), ucmp_(ucmp), lower_(lower), upper_(upper) {}
+
+  bool Valid() const override {
+    if (!iter_->Valid()) {
+      return false;
+    }
+    Slice user_key = ExtractUserKey(iter_->key());
+    return (lower_ == nullptr || ucmp_->Compare(user_key, *lower_) >= 0) &&
+           (upper_ == nullptr || ucmp_->Compare(user_key, *upper_) < 0);
+  }
+
+  void SeekToFirst() override {
+    if (lower_ == nullptr) {
+      iter_->SeekToFirst();
+    } else {
+      iter_->Seek(InternalKey(*lower_, kMaxSequenceNumber, kValueTypeForSeek)
+                      .Encode());
+    }
+  }
+
+  void SeekToLast() override {
+    if (upper_ == nullptr) {
+      iter_->SeekToLast();
+      return;
+    }
+    iter_->Seek(
+        InternalKey(*upper_, kMaxSequenceNumber, kValueTypeForSeek).Encode());
+    if (iter_->Valid()) {
+      iter_->Prev();
+    } else {
+      iter_->SeekToLast();
+    }
+  }
+
+  void Seek(const Slice& target) override { iter_->Seek(target); }
+  void SeekForPrev(const Slice& target) override {
+    iter_->SeekForPrev(target);
+  }
+  void Next() override { iter_->Next(); }
+  void Prev() override { iter_->Prev(); }
+  Slice key() const override { return iter_->key(); }
+  Slice value() const override { return iter_->value(); }
+  Status status() const override { return iter_->status(); }
+  bool IsKeyPinned() const override { return iter_->IsKeyPinned(); }
+  bool IsValuePinned() const override { return iter_->IsValuePinned(); }
+
+ private:
+  InternalIterator* const iter_;
+  const Comparator* const ucmp_;
+  const std::string* const lower_;
+  const std::string* const upper_;
+};
+
+}  // namespace
+
 FlushJob::FlushJob(
     const std::string& dbname, ColumnFamilyData* cfd,
     const ImmutableDBOptions& db_options,
@@ -295,6 +362,75 @@ Status FlushJob::Run(LogsWithPrepTracker* prep_tracker,
   return s;
 }
 
+void FlushJob::PickPartitionBoundaries(uint64_t total_data_size,
+                                       std::vector<std::string>* boundaries) {
+  // Splits into at most a range per target file size of data
+  uint64_t partitions = mutable_cf_options_.max_flush_partitions;
+  if (mutable_cf_options_.target_file_size_base > 0) {
+    partitions =
+        std::min(partitions,
+                 total_data_size / mutable_cf_options_.target_file_size_base);
+  }
+  const Comparator* ucmp = cfd_->user_comparator();
+  // With timestamps, the versions of a key would be split up
+  if (partitions <= 1 || ucmp->timestamp_size() > 0) {
+    return;
+  }
+
+  // Samples the user keys of the memtables, each in proportion to its
+  // entries, and splits at the quantiles of the sample
+  const uint64_t kSamplesPerPartition = 64;
+  uint64_t total_entries = 0;
+  for (MemTable* m : mems_) {
+    total_entries += m->num_entries();
+  }
+  std::vector<Slice> keys;
+  std::unordered_set<const char*> entries;
+  for (MemTable* m : mems_) {
+    if (total_entries == 0) {
+      break;
+    }
+    uint64_t target = static_cast<uint64_t>(
+        static_cast<double>(kSamplesPerPartition * partitions) *
+        m->num_entries() / total_entries);
+    if (target == 0) {
+      continue;
+    }
+    m->UniqueRandomSample(target, &entries);
+    for (const char* entry : entries) {
+      keys.push_back(ExtractUserKey(GetLengthPrefixedSlice(entry)));
+    }
+  }
+  std::sort(keys.begin(), keys.end(), [ucmp](const Slice& a, const Slice& b) {
+    return ucmp->Compare(a, b) < 0;
+  });
+  keys.erase(std::unique(keys.begin(), keys.end(),
+                         [ucmp](const Slice& a, const Slice& b) {
+                           return ucmp->Compare(a, b) == 0;
+                         }),
+             keys.end());
+  // A boundary above the first sampled key leaves keys on both sides
+  for (uint64_t i = 1; i < partitions; i++) {
+    size_t index = static_cast<size_t>(keys.size() * i / partitions);
+    if (index > 0 &&
+        (boundaries->empty() ||
+         ucmp->Compare(keys[index], Slice(boundaries->back())) > 0)) {
+      boundaries->push_back(keys[index].ToString());
+    }
+  }
+}
+
+uint32_t FlushJob::L0KeyRange(const Slice& user_key) const {
+  // One sample per file needs no I/O on the flush path
+  KeyDistribution distribution;
+  for (const FileMetaData* f : base_->storage_info()->LevelFiles(1)) {
+    distribution.AddFile(nullptr, cfd_->internal_comparator(), *f);
+  }
+  const Comparator* ucmp = cfd_->user_comparator();
+  distribution.Build(ucmp, mutable_cf_options_.max_flush_partitions);
+  return static_cast<uint32_t>(distribution.FindBucket(ucmp, user_key));
+}
+
 void FlushJob::Cancel() {
   db_mutex_->AssertHeld();
   assert(base_ != nullptr);
@@ -397,35 +533,125 @@ Status FlushJob::WriteLevel0Table() {
                                    ? current_time
                                    : meta_.oldest_ancester_time;
 
-      IOStatus io_s;
-      s = BuildTable(
-          dbname_, versions_, db_options_.env, db_options_.fs.get(),
-          *cfd_->ioptions(), mutable_cf_options_, file_options_,
-          cfd_->table_cache(), iter.get(), std::move(range_del_iters), &meta_,
-          &blob_file_additions, cfd_->internal_comparator(),
-          cfd_->int_tbl_prop_collector_factories(), cfd_->GetID(),
-          cfd_->GetName(), existing_snapshots_,
-          earliest_write_conflict_snapshot_, snapshot_checker_,
-          output_compression_, mutable_cf_options_.sample_for_compression,
-          mutable_cf_options_.compression_opts,
-          mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
-          TableFileCreationReason::kFlush, &io_s, io_tracer_, event_logger_,
-          job_context_->job_id, Env::IO_HIGH, &table_properties_, 0 /* level */,
-          creation_time, oldest_key_time, write_hint, current_time, db_id_,
-          db_session_id_);
-      if (!io_s.ok()) {
-        io_status_ = io_s;
+      // The key ranges written in parallel, the first one into meta_ from
+      // iter, the others from iterators of their own
+      std::vector<std::string> boundaries;
+      if (range_del_iters.empty()) {
+        PickPartitionBoundaries(total_data_size, &boundaries);
+      }
+      std::vector<FlushOutput> outputs(boundaries.size() + 1);
+      outputs[0].meta = meta_;
+      for (size_t i = 1; i < outputs.size(); i++) {
+        outputs[i].meta.fd = FileDescriptor(versions_->NewFileNumber(), 0, 0);
+        outputs[i].meta.oldest_ancester_time = meta_.oldest_ancester_time;
+        outputs[i].meta.file_creation_time = meta_.file_creation_time;
+      }
+
+      auto build = [&](InternalIterator* input,
+                       std::vector<std::unique_ptr<
+                           FragmentedRangeTombstoneIterator>>&& range_dels,
+                       FlushOutput* output) {
+        // The key range and raw data size of the output let the file system
+        // place the L0 file when it is created
+        FileOptions fo_copy = file_options_;
+        fo_copy.placement_hint.level = 0;
+        fo_copy.placement_hint.expected_size = total_data_size / outputs.size();
+        fo_copy.placement_hint.column_family_id = cfd_->GetID();
+        input->SeekToFirst();
+        if (input->Valid()) {
+          fo_copy.placement_hint.smallest = input->key().ToString();
+          fo_copy.placement_hint.key_range =
+              L0KeyRange(ExtractUserKey(input->key()));
+          input->SeekToLast();
+          fo_copy.placement_hint.largest = input->key().ToString();
+        }
+
+        const uint64_t prev_bytes_written = IOSTATS(bytes_written);
+        output->status = BuildTable(
+            dbname_, versions_, db_options_.env, db_options_.fs.get(),
+            *cfd_->ioptions(), mutable_cf_options_, fo_copy,
+            cfd_->table_cache(), input, std::move(range_dels), &output->meta,
+            &output->blob_file_additions, cfd_->internal_comparator(),
+            cfd_->int_tbl_prop_collector_factories(), cfd_->GetID(),
+            cfd_->GetName(), existing_snapshots_,
+            earliest_write_conflict_snapshot_, snapshot_checker_,
+            output_compression_, mutable_cf_options_.sample_for_compression,
+            mutable_cf_options_.compression_opts,
+            mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
+            TableFileCreationReason::kFlush, &output->io_status, io_tracer_,
+            event_logger_, job_context_->job_id, Env::IO_HIGH,
+            &output->table_properties, 0 /* level */, creation_time,
+            oldest_key_time, write_hint, current_time, db_id_,
+            db_session_id_);
+        output->bytes_written = IOSTATS(bytes_written) - prev_bytes_written;
+      };
+
+      if (boundaries.empty()) {
+        build(iter.get(), std::move(range_del_iters), &outputs[0]);
+      } else {
+        const Comparator* ucmp = cfd_->user_comparator();
+        std::vector<port::Thread> threads;
+        threads.reserve(boundaries.size());
+        for (size_t i = 1; i < outputs.size(); i++) {
+          threads.emplace_back([&, i]() {
+            Arena partition_arena;
+            std::vector<InternalIterator*> partition_memtables;
+            for (MemTable* m : mems_) {
+              partition_memtables.push_back(
+                  m->NewIterator(ro, &partition_arena));
+            }
+            ScopedArenaIterator partition_iter(NewMergingIterator(
+                &cfd_->internal_comparator(), &partition_memtables[0],
+                static_cast<int>(partition_memtables.size()),
+                &partition_arena));
+            FlushPartitionIterator input(
+                partition_iter.get(), ucmp, &boundaries[i - 1],
+                i < boundaries.size() ? &boundaries[i] : nullptr);
+            build(&input, {}, &outputs[i]);
+          });
+        }
+        FlushPartitionIterator input(iter.get(), ucmp, nullptr,
+                                     &boundaries[0]);
+        build(&input, {}, &outputs[0]);
+        for (auto& thread : threads) {
+          thread.join();
+        }
+      }
+
+      meta_ = outputs[0].meta;
+      table_properties_ = outputs[0].table_properties;
+      partition_metas_.clear();
+      for (size_t i = 0; i < outputs.size(); i++) {
+        FlushOutput& output = outputs[i];
+        if (s.ok() && !output.status.ok()) {
+          s = output.status;
+        }
+        if (io_status_.ok() && !output.io_status.ok()) {
+          io_status_ = output.io_status;
+        }
+        blob_file_additions.insert(blob_file_additions.end(),
+                                   output.blob_file_additions.begin(),
+                                   output.blob_file_additions.end());
+        if (i > 0) {
+          // Counted by RecordFlushIOStats() with the bytes of this thread
+          IOSTATS_ADD(bytes_written, output.bytes_written);
+          partition_metas_.push_back(output.meta);
+        }
+        ROCKS_LOG_INFO(db_options_.info_log,
+                       "[%s] [JOB %d] Level-0 flush table #%" PRIu64
+                       ": %" PRIu64
+                       " bytes %s"
+                       "%s",
+                       cfd_->GetName().c_str(), job_context_->job_id,
+                       output.meta.fd.GetNumber(),
+                       output.meta.fd.GetFileSize(),
+                       output.status.ToString().c_str(),
+                       output.meta.marked_for_compaction
+                           ? " (needs compaction)"
+                           : "");
       }
       LogFlush(db_options_.info_log);
     }
-    ROCKS_LOG_INFO(db_options_.info_log,
-                   "[%s] [JOB %d] Level-0 flush table #%" PRIu64 ": %" PRIu64
-                   " bytes %s"
-                   "%s",
-                   cfd_->GetName().c_str(), job_context_->job_id,
-                   meta_.fd.GetNumber(), meta_.fd.GetFileSize(),
-                   s.ToString().c_str(),
-                   meta_.marked_for_compaction ? " (needs compaction)" : "");
 
     if (s.ok() && output_file_directory_ != nullptr && sync_output_directory_) {
       s = output_file_directory_->Fsync(IOOptions(), nullptr);
@@ -437,7 +663,20 @@ Status FlushJob::WriteLevel0Table() {
 
   // Note that if file_size is zero, the file has been deleted and
   // should not be added to the manifest.
-  const bool has_output = meta_.fd.GetFileSize() > 0;
+  std::vector<const FileMetaData*> output_metas;
+  output_metas.push_back(&meta_);
+  for (const FileMetaData& meta : partition_metas_) {
+    output_metas.push_back(&meta);
+  }
+  uint64_t output_bytes = 0;
+  int num_output_files = 0;
+  for (const FileMetaData* meta : output_metas) {
+    if (meta->fd.GetFileSize() > 0) {
+      output_bytes += meta->fd.GetFileSize();
+      num_output_files++;
+    }
+  }
+  const bool has_output = num_output_files > 0;
 
   if (s.ok() && has_output) {
     // if we have more than 1 background thread, then we cannot
@@ -445,12 +684,19 @@ Status FlushJob::WriteLevel0Table() {
     // threads could be concurrently producing compacted files for
     // that key range.
     // Add file to L0
-    edit_->AddFile(0 /* level */, meta_.fd.GetNumber(), meta_.fd.GetPathId(),
-                   meta_.fd.GetFileSize(), meta_.smallest, meta_.largest,
-                   meta_.fd.smallest_seqno, meta_.fd.largest_seqno,
-                   meta_.marked_for_compaction, meta_.oldest_blob_file_number,
-                   meta_.oldest_ancester_time, meta_.file_creation_time,
-                   meta_.file_checksum, meta_.file_checksum_func_name);
+    for (const FileMetaData* meta : output_metas) {
+      if (meta->fd.GetFileSize() == 0) {
+        continue;
+      }
+      edit_->AddFile(0 /* level */, meta->fd.GetNumber(), meta->fd.GetPathId(),
+                     meta->fd.GetFileSize(), meta->smallest, meta->largest,
+                     meta->fd.smallest_seqno, meta->fd.largest_seqno,
+                     meta->marked_for_compaction,
+                     meta->oldest_blob_file_number,
+                     meta->oldest_ancester_time, meta->file_creation_time,
+                     meta->file_checksum, meta->file_checksum_func_name,
+                     meta->min_timestamp, meta->max_timestamp);
+    }
 
     edit_->SetBlobFileAdditions(std::move(blob_file_additions));
   }
@@ -465,8 +711,8 @@ Status FlushJob::WriteLevel0Table() {
   stats.cpu_micros = db_options_.env->NowCPUNanos() / 1000 - start_cpu_micros;
 
   if (has_output) {
-    stats.bytes_written = meta_.fd.GetFileSize();
-    stats.num_output_files = 1;
+    stats.bytes_written = output_bytes;
+    stats.num_output_files = num_output_files;
   }
 
   const auto& blobs = edit_->GetBlobFileAdditions();
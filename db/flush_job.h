@@ -95,11 +95,34 @@ class FlushJob {
   // Return the IO status
   IOStatus io_status() const { return io_status_; }
 
+  // The files written besides the one of the file_meta of Run(), when the
+  // flush was split into key ranges by max_flush_partitions
+  const std::vector<FileMetaData>& GetPartitionFileMetas() const {
+    return partition_metas_;
+  }
+
  private:
+  // A file written by the flush, with the results of writing it
+  struct FlushOutput {
+    FileMetaData meta;
+    std::vector<BlobFileAddition> blob_file_additions;
+    TableProperties table_properties;
+    Status status;
+    IOStatus io_status;
+    uint64_t bytes_written = 0;
+  };
+
   void ReportStartedFlush();
   void ReportFlushInputSize(const autovector<MemTable*>& mems);
   void RecordFlushIOStats();
   Status WriteLevel0Table();
+  // Appends to *boundaries the user keys splitting the memtables into the
+  // key ranges written in parallel, none if the flush is not to be split
+  void PickPartitionBoundaries(uint64_t total_data_size,
+                               std::vector<std::string>* boundaries);
+  // The coarse key range of L1 user_key falls in, out of as many ranges
+  // holding about as many bytes of L1 files as a flush has partitions at most
+  uint32_t L0KeyRange(const Slice& user_key) const;
 #ifndef ROCKSDB_LITE
   std::unique_ptr<FlushJobInfo> GetFlushJobInfo() const;
 #endif  // !ROCKSDB_LITE
@@ -156,6 +179,8 @@ class FlushJob {
 
   // Variables below are set by PickMemTable():
   FileMetaData meta_;
+  // Set by WriteLevel0Table(), see GetPartitionFileMetas()
+  std::vector<FileMetaData> partition_metas_;
   autovector<MemTable*> mems_;
   VersionEdit* edit_;
   Version* base_;
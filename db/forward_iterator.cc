@@ -17,6 +17,7 @@
 #include "db/job_context.h"
 #include "db/range_del_aggregator.h"
 #include "db/range_tombstone_fragmenter.h"
+#include "monitoring/perf_context_imp.h"
 #include "rocksdb/env.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
@@ -40,7 +41,7 @@ class ForwardLevelIterator : public InternalIterator {
                        bool allow_unprepared_value)
       : cfd_(cfd),
         read_options_(read_options),
-        files_(files),
+        files_(&files),
         valid_(false),
         file_index_(std::numeric_limits<uint32_t>::max()),
         file_iter_(nullptr),
@@ -57,8 +58,15 @@ class ForwardLevelIterator : public InternalIterator {
     }
   }
 
+  // Moves the iterator to the same files of a newer version, keeping its
+  // position
+  void SetFiles(const std::vector<FileMetaData*>& files) {
+    assert(files == *files_);
+    files_ = &files;
+  }
+
   void SetFileIndex(uint32_t file_index) {
-    assert(file_index < files_.size());
+    assert(file_index < files_->size());
     status_ = Status::OK();
     if (file_index != file_index_) {
       file_index_ = file_index;
@@ -66,7 +74,7 @@ class ForwardLevelIterator : public InternalIterator {
     }
   }
   void Reset() {
-    assert(file_index_ < files_.size());
+    assert(file_index_ < files_->size());
 
     // Reset current pointer
     if (pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled()) {
@@ -79,7 +87,7 @@ class ForwardLevelIterator : public InternalIterator {
                                          kMaxSequenceNumber /* upper_bound */);
     file_iter_ = cfd_->table_cache()->NewIterator(
         read_options_, *(cfd_->soptions()), cfd_->internal_comparator(),
-        *files_[file_index_],
+        *(*files_)[file_index_],
         read_options_.ignore_range_deletions ? nullptr : &range_del_agg,
         prefix_extractor_, /*table_reader_ptr=*/nullptr,
         /*file_read_hist=*/nullptr, TableReaderCaller::kUserIterator,
@@ -146,7 +154,16 @@ class ForwardLevelIterator : public InternalIterator {
       if (valid_) {
         return;
       }
-      if (file_index_ + 1 >= files_.size()) {
+      if (file_index_ + 1 >= files_->size()) {
+        valid_ = false;
+        return;
+      }
+      if (read_options_.iterate_upper_bound != nullptr &&
+          cfd_->internal_comparator().user_comparator()->Compare(
+              (*files_)[file_index_ + 1]->smallest.user_key(),
+              *read_options_.iterate_upper_bound) >= 0) {
+        // The rest of the files are out of the bound
+        PERF_COUNTER_ADD(iter_bound_pruned_file_count, 1);
         valid_ = false;
         return;
       }
@@ -202,7 +219,7 @@ class ForwardLevelIterator : public InternalIterator {
  private:
   const ColumnFamilyData* const cfd_;
   const ReadOptions& read_options_;
-  const std::vector<FileMetaData*>& files_;
+  const std::vector<FileMetaData*>* files_;
 
   bool valid_;
   uint32_t file_index_;
@@ -364,7 +381,8 @@ void ForwardIterator::Seek(const Slice& internal_key) {
 }
 
 void ForwardIterator::SeekInternal(const Slice& internal_key,
-                                   bool seek_to_first) {
+                                   bool seek_to_first,
+                                   const RenewedChildren* renewed) {
   assert(mutable_iter_);
   // mutable
   seek_to_first ? mutable_iter_->SeekToFirst() :
@@ -376,7 +394,9 @@ void ForwardIterator::SeekInternal(const Slice& internal_key,
   // an option to turn it off.
   if (seek_to_first || NeedToSeekImmutable(internal_key)) {
     immutable_status_ = Status::OK();
-    if (has_iter_trimmed_for_upper_bound_ &&
+    // The trimmed iterators are behind internal_key or past the upper bound,
+    // so that a Next() does not need them back
+    if (renewed == nullptr && has_iter_trimmed_for_upper_bound_ &&
         (
             // prev_ is not set yet
             is_prev_set_ == false ||
@@ -412,7 +432,7 @@ void ForwardIterator::SeekInternal(const Slice& internal_key,
     const VersionStorageInfo* vstorage = sv_->current->storage_info();
     const std::vector<FileMetaData*>& l0 = vstorage->LevelFiles(0);
     for (size_t i = 0; i < l0.size(); ++i) {
-      if (!l0_iters_[i]) {
+      if (!l0_iters_[i] || ResumeKeptChild(l0_iters_[i], renewed)) {
         continue;
       }
       if (seek_to_first) {
@@ -450,7 +470,8 @@ void ForwardIterator::SeekInternal(const Slice& internal_key,
       if (level_files.empty()) {
         continue;
       }
-      if (level_iters_[level - 1] == nullptr) {
+      if (level_iters_[level - 1] == nullptr ||
+          ResumeKeptChild(level_iters_[level - 1], renewed)) {
         continue;
       }
       uint32_t f_idx = 0;
@@ -459,6 +480,16 @@ void ForwardIterator::SeekInternal(const Slice& internal_key,
                                 static_cast<uint32_t>(level_files.size()));
       }
 
+      if (f_idx < level_files.size() &&
+          IsOverUpperBound(level_files[f_idx]->smallest.Encode())) {
+        // Nothing in this level is interesting, without opening the file
+        PERF_COUNTER_ADD(iter_bound_pruned_file_count, 1);
+        has_iter_trimmed_for_upper_bound_ = true;
+        DeleteIterator(level_iters_[level - 1]);
+        level_iters_[level - 1] = nullptr;
+        continue;
+      }
+
       // Seek
       if (f_idx < level_files.size()) {
         level_iters_[level - 1]->SetFileIndex(f_idx);
@@ -508,10 +539,12 @@ void ForwardIterator::Next() {
 
     if (sv_ == nullptr) {
       RebuildIterators(true);
+      SeekInternal(old_key, false);
     } else {
-      RenewIterators();
+      RenewedChildren renewed;
+      RenewIterators(&renewed);
+      SeekInternal(old_key, false, &renewed);
     }
-    SeekInternal(old_key, false);
     if (!valid_ || key().compare(old_key) != 0) {
       return;
     }
@@ -674,7 +707,8 @@ void ForwardIterator::RebuildIterators(bool refresh_sv) {
   for (const auto* l0 : l0_files) {
     if ((read_options_.iterate_upper_bound != nullptr) &&
         cfd_->internal_comparator().user_comparator()->Compare(
-            l0->smallest.user_key(), *read_options_.iterate_upper_bound) > 0) {
+            l0->smallest.user_key(), *read_options_.iterate_upper_bound) >= 0) {
+      PERF_COUNTER_ADD(iter_bound_pruned_file_count, 1);
       // No need to set has_iter_trimmed_for_upper_bound_: this ForwardIterator
       // will never be interested in files with smallest key above
       // iterate_upper_bound, since iterate_upper_bound can't be changed.
@@ -704,11 +738,24 @@ void ForwardIterator::RebuildIterators(bool refresh_sv) {
   }
 }
 
-void ForwardIterator::RenewIterators() {
+void ForwardIterator::RenewIterators(RenewedChildren* renewed) {
   SuperVersion* svnew;
   assert(sv_);
   svnew = cfd_->GetReferencedSuperVersion(db_);
 
+  // The children in the heap, and the current one, are at or past the
+  // current key. The others have nothing more for a Next().
+  bool resumable = renewed != nullptr && valid_ && immutable_status_.ok();
+  if (resumable) {
+    if (current_ != mutable_iter_) {
+      renewed->positioned.insert(current_);
+    }
+    while (!immutable_min_heap_.empty()) {
+      renewed->positioned.insert(immutable_min_heap_.top());
+      immutable_min_heap_.pop();
+    }
+  }
+
   if (mutable_iter_ != nullptr) {
     DeleteIterator(mutable_iter_, true /* is_arena */);
   }
@@ -755,11 +802,20 @@ void ForwardIterator::RenewIterators() {
         TEST_SYNC_POINT_CALLBACK("ForwardIterator::RenewIterators:Null", this);
       } else {
         l0_iters_new.push_back(l0_iters_[iold]);
+        if (resumable) {
+          renewed->kept.insert(l0_iters_[iold]);
+        }
         l0_iters_[iold] = nullptr;
         TEST_SYNC_POINT_CALLBACK("ForwardIterator::RenewIterators:Copy", this);
       }
       continue;
     }
+    if (IsOverUpperBound(l0_files_new[inew]->smallest.Encode())) {
+      // As in RebuildIterators()
+      PERF_COUNTER_ADD(iter_bound_pruned_file_count, 1);
+      l0_iters_new.push_back(nullptr);
+      continue;
+    }
     l0_iters_new.push_back(cfd_->table_cache()->NewIterator(
         read_options_, *cfd_->soptions(), cfd_->internal_comparator(),
         *l0_files_new[inew],
@@ -779,11 +835,35 @@ void ForwardIterator::RenewIterators() {
   l0_iters_.clear();
   l0_iters_ = l0_iters_new;
 
+  // The iterators of the levels whose files did not change are kept
+  std::vector<ForwardLevelIterator*> level_iters_new;
+  level_iters_new.reserve(vstorage_new->num_levels() - 1);
+  for (int32_t level = 1; level < vstorage_new->num_levels(); ++level) {
+    const auto& level_files_new = vstorage_new->LevelFiles(level);
+    ForwardLevelIterator* level_iter =
+        static_cast<size_t>(level - 1) < level_iters_.size()
+            ? level_iters_[level - 1]
+            : nullptr;
+    if (level_iter != nullptr && !level_files_new.empty() &&
+        vstorage->LevelFiles(level) == level_files_new &&
+        svnew->mutable_cf_options.prefix_extractor.get() ==
+            sv_->mutable_cf_options.prefix_extractor.get()) {
+      level_iter->SetFiles(level_files_new);
+      level_iters_new.push_back(level_iter);
+      if (resumable) {
+        renewed->kept.insert(level_iter);
+      }
+      level_iters_[level - 1] = nullptr;
+      TEST_SYNC_POINT_CALLBACK("ForwardIterator::RenewIterators:KeepLevel",
+                               this);
+      continue;
+    }
+    level_iters_new.push_back(NewLevelIterator(svnew, level));
+  }
   for (auto* l : level_iters_) {
     DeleteIterator(l);
   }
-  level_iters_.clear();
-  BuildLevelIterators(vstorage_new);
+  level_iters_ = level_iters_new;
   current_ = nullptr;
   is_prev_set_ = false;
   SVCleanup();
@@ -800,23 +880,36 @@ void ForwardIterator::RenewIterators() {
 void ForwardIterator::BuildLevelIterators(const VersionStorageInfo* vstorage) {
   level_iters_.reserve(vstorage->num_levels() - 1);
   for (int32_t level = 1; level < vstorage->num_levels(); ++level) {
-    const auto& level_files = vstorage->LevelFiles(level);
-    if ((level_files.empty()) ||
-        ((read_options_.iterate_upper_bound != nullptr) &&
-         (user_comparator_->Compare(*read_options_.iterate_upper_bound,
-                                    level_files[0]->smallest.user_key()) <
-          0))) {
-      level_iters_.push_back(nullptr);
-      if (!level_files.empty()) {
-        has_iter_trimmed_for_upper_bound_ = true;
-      }
-    } else {
-      level_iters_.push_back(new ForwardLevelIterator(
-          cfd_, read_options_, level_files,
-          sv_->mutable_cf_options.prefix_extractor.get(),
-          allow_unprepared_value_));
-    }
+    level_iters_.push_back(NewLevelIterator(sv_, level));
+  }
+}
+
+ForwardLevelIterator* ForwardIterator::NewLevelIterator(const SuperVersion* sv,
+                                                        int32_t level) {
+  const auto& level_files = sv->current->storage_info()->LevelFiles(level);
+  if (level_files.empty()) {
+    return nullptr;
+  }
+  if (read_options_.iterate_upper_bound != nullptr &&
+      user_comparator_->Compare(*read_options_.iterate_upper_bound,
+                                level_files[0]->smallest.user_key()) < 0) {
+    has_iter_trimmed_for_upper_bound_ = true;
+    return nullptr;
+  }
+  return new ForwardLevelIterator(
+      cfd_, read_options_, level_files,
+      sv->mutable_cf_options.prefix_extractor.get(), allow_unprepared_value_);
+}
+
+bool ForwardIterator::ResumeKeptChild(InternalIterator* child,
+                                      const RenewedChildren* renewed) {
+  if (renewed == nullptr || renewed->kept.count(child) == 0) {
+    return false;
+  }
+  if (renewed->positioned.count(child) > 0) {
+    immutable_min_heap_.push(child);
   }
+  return true;
 }
 
 void ForwardIterator::ResetIncompleteIterators() {
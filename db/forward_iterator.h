@@ -7,6 +7,7 @@
 #ifndef ROCKSDB_LITE
 
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include <queue>
 
@@ -95,11 +96,29 @@ class ForwardIterator : public InternalIterator {
     DBImpl* db, SuperVersion* sv, bool background_purge_on_iterator_cleanup);
   static void DeferredSVCleanup(void* arg);
 
+  // The children RenewIterators() kept for the files still in the new
+  // version, and those of them positioned at or past the current key, which
+  // a Next() resumes from without seeking them again.
+  struct RenewedChildren {
+    std::unordered_set<InternalIterator*> kept;
+    std::unordered_set<InternalIterator*> positioned;
+  };
+
   void RebuildIterators(bool refresh_sv);
-  void RenewIterators();
+  // Keeps the iterators of the L0 files, and of the levels, that did not
+  // change. If renewed is not null, fills it for the Next() that follows.
+  void RenewIterators(RenewedChildren* renewed = nullptr);
   void BuildLevelIterators(const VersionStorageInfo* vstorage);
+  // Returns nullptr for an empty level, or one out of iterate_upper_bound
+  ForwardLevelIterator* NewLevelIterator(const SuperVersion* sv,
+                                         int32_t level);
   void ResetIncompleteIterators();
-  void SeekInternal(const Slice& internal_key, bool seek_to_first);
+  void SeekInternal(const Slice& internal_key, bool seek_to_first,
+                    const RenewedChildren* renewed = nullptr);
+  // Returns whether child is one of renewed->kept, and if so pushes it onto
+  // the heap when it is positioned.
+  bool ResumeKeptChild(InternalIterator* child,
+                       const RenewedChildren* renewed);
   void UpdateCurrent();
   bool NeedToSeekImmutable(const Slice& internal_key);
   void DeleteCurrentIter();
@@ -20,6 +20,7 @@
 
 #include "db/column_family.h"
 #include "db/db_impl/db_impl.h"
+#include "db/key_distribution.h"
 #include "rocksdb/table.h"
 #include "util/string_util.h"
 
@@ -249,8 +250,13 @@ static const std::string aggregated_table_properties =
     "aggregated-table-properties";
 static const std::string aggregated_table_properties_at_level =
     aggregated_table_properties + "-at-level";
+static const std::string key_distribution = "key-distribution";
+static const std::string key_distribution_at_level =
+    key_distribution + "-at-level";
 static const std::string num_running_compactions = "num-running-compactions";
 static const std::string num_running_flushes = "num-running-flushes";
+static const std::string num_table_files_pending_open =
+    "num-table-files-pending-open";
 static const std::string actual_delayed_write_rate =
     "actual-delayed-write-rate";
 static const std::string is_write_stopped = "is-write-stopped";
@@ -258,7 +264,11 @@ static const std::string estimate_oldest_key_time = "estimate-oldest-key-time";
 static const std::string block_cache_capacity = "block-cache-capacity";
 static const std::string block_cache_usage = "block-cache-usage";
 static const std::string block_cache_pinned_usage = "block-cache-pinned-usage";
+static const std::string block_cache_allocator_stats =
+    "block-cache-allocator-stats";
 static const std::string options_statistics = "options-statistics";
+static const std::string write_stall_attribution = "write-stall-attribution";
+static const std::string zenfs_prefix = "zenfs.";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
     rocksdb_prefix + num_files_at_level_prefix;
@@ -285,6 +295,8 @@ const std::string DB::Properties::kNumRunningCompactions =
     rocksdb_prefix + num_running_compactions;
 const std::string DB::Properties::kNumRunningFlushes =
     rocksdb_prefix + num_running_flushes;
+const std::string DB::Properties::kNumTableFilesPendingOpen =
+    rocksdb_prefix + num_table_files_pending_open;
 const std::string DB::Properties::kBackgroundErrors =
     rocksdb_prefix + background_errors;
 const std::string DB::Properties::kCurSizeActiveMemTable =
@@ -334,6 +346,10 @@ const std::string DB::Properties::kAggregatedTableProperties =
     rocksdb_prefix + aggregated_table_properties;
 const std::string DB::Properties::kAggregatedTablePropertiesAtLevel =
     rocksdb_prefix + aggregated_table_properties_at_level;
+const std::string DB::Properties::kKeyDistribution =
+    rocksdb_prefix + key_distribution;
+const std::string DB::Properties::kKeyDistributionAtLevel =
+    rocksdb_prefix + key_distribution_at_level;
 const std::string DB::Properties::kActualDelayedWriteRate =
     rocksdb_prefix + actual_delayed_write_rate;
 const std::string DB::Properties::kIsWriteStopped =
@@ -346,8 +362,13 @@ const std::string DB::Properties::kBlockCacheUsage =
     rocksdb_prefix + block_cache_usage;
 const std::string DB::Properties::kBlockCachePinnedUsage =
     rocksdb_prefix + block_cache_pinned_usage;
+const std::string DB::Properties::kBlockCacheAllocatorStats =
+    rocksdb_prefix + block_cache_allocator_stats;
 const std::string DB::Properties::kOptionsStatistics =
     rocksdb_prefix + options_statistics;
+const std::string DB::Properties::kWriteStallAttribution =
+    rocksdb_prefix + write_stall_attribution;
+const std::string DB::Properties::kZenFSPrefix = rocksdb_prefix + zenfs_prefix;
 
 const std::unordered_map<std::string, DBPropertyInfo>
     InternalStats::ppt_name_to_info = {
@@ -380,6 +401,15 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kAggregatedTablePropertiesAtLevel,
          {false, &InternalStats::HandleAggregatedTablePropertiesAtLevel,
           nullptr, nullptr, nullptr}},
+        {DB::Properties::kKeyDistribution,
+         {false, &InternalStats::HandleKeyDistribution, nullptr, nullptr,
+          nullptr}},
+        {DB::Properties::kKeyDistributionAtLevel,
+         {false, &InternalStats::HandleKeyDistributionAtLevel, nullptr,
+          nullptr, nullptr}},
+        {DB::Properties::kWriteStallAttribution,
+         {false, &InternalStats::HandleWriteStallAttribution, nullptr,
+          nullptr, nullptr}},
         {DB::Properties::kNumImmutableMemTable,
          {false, nullptr, &InternalStats::HandleNumImmutableMemTable, nullptr,
           nullptr}},
@@ -466,6 +496,9 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kNumRunningCompactions,
          {false, nullptr, &InternalStats::HandleNumRunningCompactions, nullptr,
           nullptr}},
+        {DB::Properties::kNumTableFilesPendingOpen,
+         {false, nullptr, &InternalStats::HandleNumTableFilesPendingOpen,
+          nullptr, nullptr}},
         {DB::Properties::kActualDelayedWriteRate,
          {false, nullptr, &InternalStats::HandleActualDelayedWriteRate, nullptr,
           nullptr}},
@@ -484,6 +517,9 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kBlockCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlockCachePinnedUsage, nullptr,
           nullptr}},
+        {DB::Properties::kBlockCacheAllocatorStats,
+         {false, &InternalStats::HandleBlockCacheAllocatorStats, nullptr,
+          nullptr, nullptr}},
         {DB::Properties::kOptionsStatistics,
          {false, nullptr, nullptr, nullptr,
           &DBImpl::GetPropertyHandleOptionsStatistics}},
@@ -649,6 +685,73 @@ bool InternalStats::HandleAggregatedTablePropertiesAtLevel(std::string* value,
   return true;
 }
 
+void InternalStats::DumpKeyDistribution(int level, std::string* value) {
+  // Reading the index blocks of every file of a large DB under the mutex
+  // would stall it, so only about this many files are sampled and the others
+  // are taken whole
+  const size_t kMaxSampledFiles = 64;
+  const size_t kNumBuckets = 64;
+  const VersionStorageInfo* vstorage = cfd_->current()->storage_info();
+  size_t num_files = 0;
+  for (int l = 0; l < number_levels_; l++) {
+    if (level < 0 || l == level) {
+      num_files += vstorage->LevelFiles(l).size();
+    }
+  }
+  const size_t stride = std::max<size_t>(1, num_files / kMaxSampledFiles);
+  KeyDistribution distribution;
+  size_t i = 0;
+  for (int l = 0; l < number_levels_; l++) {
+    if (level >= 0 && l != level) {
+      continue;
+    }
+    for (const FileMetaData* f : vstorage->LevelFiles(l)) {
+      distribution.AddFile(i++ % stride == 0 ? cfd_->table_cache() : nullptr,
+                           cfd_->internal_comparator(), *f);
+    }
+  }
+  distribution.Build(cfd_->user_comparator(), kNumBuckets);
+  *value = distribution.ToString();
+}
+
+bool InternalStats::HandleKeyDistribution(std::string* value,
+                                          Slice /*suffix*/) {
+  DumpKeyDistribution(-1 /* all levels */, value);
+  return true;
+}
+
+bool InternalStats::HandleKeyDistributionAtLevel(std::string* value,
+                                                 Slice suffix) {
+  uint64_t level;
+  bool ok = ConsumeDecimalNumber(&suffix, &level) && suffix.empty();
+  if (!ok || static_cast<int>(level) >= number_levels_) {
+    return false;
+  }
+  DumpKeyDistribution(static_cast<int>(level), value);
+  return true;
+}
+
+bool InternalStats::HandleWriteStallAttribution(std::string* value,
+                                                Slice /*suffix*/) {
+  value->clear();
+  for (const auto& stall : recent_write_stalls_) {
+    DumpWriteStall(stall, false /* active */, value);
+  }
+  if (write_stall_active_) {
+    WriteStallIntervalInfo stall = write_stall_;
+    const uint64_t now = env_->NowMicros();
+    stall.duration_micros = now - stall.start_micros;
+    stall.bytes_written =
+        BytesWrittenByJobs() - write_stall_bytes_written_at_start_;
+    for (const auto& job : running_jobs_) {
+      stall.blocking_jobs.push_back(job.second.info);
+      stall.blocking_jobs.back().run_micros = now - job.second.start_micros;
+    }
+    DumpWriteStall(stall, true /* active */, value);
+  }
+  return true;
+}
+
 bool InternalStats::HandleNumImmutableMemTable(uint64_t* value, DBImpl* /*db*/,
                                                Version* /*version*/) {
   *value = cfd_->imm()->NumNotFlushed();
@@ -674,6 +777,13 @@ bool InternalStats::HandleNumRunningFlushes(uint64_t* value, DBImpl* db,
   return true;
 }
 
+bool InternalStats::HandleNumTableFilesPendingOpen(uint64_t* value,
+                                                   DBImpl* db,
+                                                   Version* /*version*/) {
+  *value = db->num_table_files_pending_open();
+  return true;
+}
+
 bool InternalStats::HandleCompactionPending(uint64_t* value, DBImpl* /*db*/,
                                             Version* /*version*/) {
   // 1 if the system already determines at least one compaction is needed.
@@ -946,6 +1056,17 @@ bool InternalStats::HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* /*db*/,
   return true;
 }
 
+bool InternalStats::HandleBlockCacheAllocatorStats(std::string* value,
+                                                   Slice /*suffix*/) {
+  Cache* block_cache;
+  bool ok = HandleBlockCacheStat(&block_cache);
+  if (!ok || block_cache->memory_allocator() == nullptr) {
+    return false;
+  }
+  return block_cache->memory_allocator()->GetProperty(
+      MemoryAllocator::kStatsProperty, value);
+}
+
 void InternalStats::DumpDBStats(std::string* value) {
   char buf[1000];
   // DB-level stats, only available from default column family
@@ -1347,6 +1468,35 @@ void InternalStats::DumpCFStatsNoFileHistogram(std::string* value) {
   cf_stats_snapshot_.compact_bytes_read = compact_bytes_read;
   cf_stats_snapshot_.compact_micros = compact_micros;
 
+  // Each L0 file and each non-empty level below is a sorted run. The space
+  // amplification counts all the data above the last sorted run as extra,
+  // as universal compaction does.
+  const auto* vstorage = cfd_->current()->storage_info();
+  uint64_t num_sorted_runs = vstorage->NumLevelFiles(0);
+  uint64_t total_bytes = 0;
+  uint64_t last_run_bytes = 0;
+  for (int level = 0; level < number_levels_; level++) {
+    uint64_t level_bytes = vstorage->NumLevelBytes(level);
+    if (level > 0 && level_bytes > 0) {
+      num_sorted_runs++;
+      last_run_bytes = level_bytes;
+    }
+    total_bytes += level_bytes;
+  }
+  if (last_run_bytes == 0 && !vstorage->LevelFiles(0).empty()) {
+    last_run_bytes = vstorage->LevelFiles(0).back()->fd.GetFileSize();
+  }
+  double space_amp =
+      (last_run_bytes == 0)
+          ? 0.0
+          : static_cast<double>(total_bytes - last_run_bytes) / last_run_bytes;
+  snprintf(buf, sizeof(buf),
+           "Amplification: %.2f write, %.2f space, %" PRIu64
+           " sorted runs\n",
+           levels_stats[-1][LevelStatType::WRITE_AMP], space_amp,
+           num_sorted_runs);
+  value->append(buf);
+
   snprintf(buf, sizeof(buf),
            "Stalls(count): %" PRIu64
            " level0_slowdown, "
@@ -1409,6 +1559,127 @@ void InternalStats::DumpCFFileHistogram(std::string* value) {
   *value = oss.str();
 }
 
+void InternalStats::AddRunningJob(int job_id, bool is_flush,
+                                  int output_level) {
+  RunningJob& job = running_jobs_[job_id];
+  job.info.job_id = job_id;
+  job.info.is_flush = is_flush;
+  job.info.output_level = output_level;
+  job.start_micros = env_->NowMicros();
+}
+
+void InternalStats::RemoveRunningJob(int job_id, uint64_t bytes_written) {
+  auto it = running_jobs_.find(job_id);
+  if (it == running_jobs_.end()) {
+    return;
+  }
+  if (write_stall_active_) {
+    WriteStallBlockingJobInfo info = it->second.info;
+    info.run_micros = env_->NowMicros() - it->second.start_micros;
+    info.finished = true;
+    info.bytes_written = bytes_written;
+    write_stall_.blocking_jobs.push_back(info);
+  }
+  running_jobs_.erase(it);
+}
+
+void InternalStats::UpdateWriteStall(WriteStallCondition condition,
+                                     WriteStallCause cause,
+                                     int num_unflushed_memtables,
+                                     int num_l0_files,
+                                     uint64_t pending_compaction_bytes) {
+  if (condition != WriteStallCondition::kNormal) {
+    if (!write_stall_active_) {
+      write_stall_active_ = true;
+      write_stall_ = WriteStallIntervalInfo();
+      write_stall_.cf_name = cfd_->GetName();
+      write_stall_.condition = condition;
+      write_stall_.cause = cause;
+      write_stall_.start_micros = env_->NowMicros();
+      write_stall_.num_unflushed_memtables = num_unflushed_memtables;
+      write_stall_.num_l0_files = num_l0_files;
+      write_stall_.pending_compaction_bytes = pending_compaction_bytes;
+      write_stall_bytes_written_at_start_ = BytesWrittenByJobs();
+    } else if (condition == WriteStallCondition::kStopped) {
+      write_stall_.condition = condition;
+    }
+    return;
+  }
+  if (!write_stall_active_) {
+    return;
+  }
+
+  // The stall is over: the jobs still running held it up all along
+  write_stall_active_ = false;
+  const uint64_t now = env_->NowMicros();
+  write_stall_.duration_micros = now - write_stall_.start_micros;
+  write_stall_.bytes_written =
+      BytesWrittenByJobs() - write_stall_bytes_written_at_start_;
+  for (const auto& job : running_jobs_) {
+    write_stall_.blocking_jobs.push_back(job.second.info);
+    write_stall_.blocking_jobs.back().run_micros =
+        now - job.second.start_micros;
+  }
+  std::sort(write_stall_.blocking_jobs.begin(),
+            write_stall_.blocking_jobs.end(),
+            [](const WriteStallBlockingJobInfo& a,
+               const WriteStallBlockingJobInfo& b) {
+              return a.job_id < b.job_id;
+            });
+
+  if (recent_write_stalls_.size() >= kMaxRecentWriteStalls) {
+    recent_write_stalls_.pop_front();
+  }
+  recent_write_stalls_.push_back(write_stall_);
+  if (ended_write_stalls_.size() < kMaxRecentWriteStalls) {
+    ended_write_stalls_.push_back(std::move(write_stall_));
+  }
+  write_stall_ = WriteStallIntervalInfo();
+}
+
+void InternalStats::TakeEndedWriteStalls(
+    std::vector<WriteStallIntervalInfo>* stalls) {
+  stalls->swap(ended_write_stalls_);
+  ended_write_stalls_.clear();
+}
+
+uint64_t InternalStats::BytesWrittenByJobs() const {
+  uint64_t bytes_written = 0;
+  for (const auto& stats : comp_stats_) {
+    bytes_written += stats.bytes_written;
+  }
+  return bytes_written;
+}
+
+void InternalStats::DumpWriteStall(const WriteStallIntervalInfo& stall,
+                                   bool active, std::string* value) {
+  static const char* const kCauseNames[] = {
+      "none", "memtable-limit", "l0-file-count-limit",
+      "pending-compaction-bytes"};
+  const double seconds = stall.duration_micros / kMicrosInSec;
+  char buf[1000];
+  snprintf(buf, sizeof(buf),
+           "%s at %" PRIu64 " us: %s by %s for %.3f s, queued %d memtables, "
+           "%d L0 files, %" PRIu64 " compaction bytes, written %.1f MB "
+           "(%.1f MB/s)\n",
+           active ? "Active stall" : "Stall", stall.start_micros,
+           stall.condition == WriteStallCondition::kStopped ? "stopped"
+                                                            : "delayed",
+           kCauseNames[static_cast<int>(stall.cause)], seconds,
+           stall.num_unflushed_memtables, stall.num_l0_files,
+           stall.pending_compaction_bytes, stall.bytes_written / kMB,
+           seconds > 0 ? stall.bytes_written / kMB / seconds : 0.0);
+  value->append(buf);
+  for (const auto& job : stall.blocking_jobs) {
+    snprintf(buf, sizeof(buf),
+             "  %s job %d to L%d: %.3f s, %s, written %.1f MB\n",
+             job.is_flush ? "flush" : "compaction", job.job_id,
+             job.output_level, job.run_micros / kMicrosInSec,
+             job.finished ? "finished" : "running", job.bytes_written / kMB);
+    value->append(buf);
+  }
+}
+
 #else
 
 const DBPropertyInfo* GetPropertyInfo(const Slice& /*property*/) {
@@ -9,11 +9,13 @@
 //
 
 #pragma once
+#include <deque>
 #include <map>
 #include <string>
 #include <vector>
 
 #include "db/version_set.h"
+#include "rocksdb/listener.h"
 
 class ColumnFamilyData;
 
@@ -357,6 +359,10 @@ class InternalStats {
     ++cf_stats_count_[type];
   }
 
+  uint64_t GetCFStats(InternalCFStatsType type) const {
+    return cf_stats_value_[type];
+  }
+
   void AddDBStats(InternalDBStatsType type, uint64_t value,
                   bool concurrent = false) {
     auto& v = db_stats_[type];
@@ -382,6 +388,24 @@ class InternalStats {
 
   uint64_t BumpAndGetBackgroundErrorCount() { return ++bg_error_count_; }
 
+  // Write stall attribution, protected by the DB mutex. A flush or
+  // compaction of the column family running while writes are stalled is
+  // reported as one of the jobs holding the stall up.
+
+  // Called when a flush or compaction of the column family starts, and
+  // when it ends, after it installs its results
+  void AddRunningJob(int job_id, bool is_flush, int output_level);
+  void RemoveRunningJob(int job_id, uint64_t bytes_written);
+
+  // Called with the write stall condition of the column family whenever it
+  // is recalculated
+  void UpdateWriteStall(WriteStallCondition condition, WriteStallCause cause,
+                        int num_unflushed_memtables, int num_l0_files,
+                        uint64_t pending_compaction_bytes);
+
+  // Moves out the write stalls which ended since the last call
+  void TakeEndedWriteStalls(std::vector<WriteStallIntervalInfo>* stalls);
+
   bool GetStringProperty(const DBPropertyInfo& property_info,
                          const Slice& property, std::string* value);
 
@@ -417,6 +441,12 @@ class InternalStats {
   void DumpCFStats(std::string* value);
   void DumpCFStatsNoFileHistogram(std::string* value);
   void DumpCFFileHistogram(std::string* value);
+  void DumpWriteStall(const WriteStallIntervalInfo& stall, bool active,
+                      std::string* value);
+  // Of the files of level, or of all the levels if level < 0
+  void DumpKeyDistribution(int level, std::string* value);
+  // The bytes written by the flushes and compactions of the column family
+  uint64_t BytesWrittenByJobs() const;
 
   bool HandleBlockCacheStat(Cache** block_cache);
 
@@ -533,6 +563,10 @@ class InternalStats {
   bool HandleSsTables(std::string* value, Slice suffix);
   bool HandleAggregatedTableProperties(std::string* value, Slice suffix);
   bool HandleAggregatedTablePropertiesAtLevel(std::string* value, Slice suffix);
+  bool HandleKeyDistribution(std::string* value, Slice suffix);
+  bool HandleKeyDistributionAtLevel(std::string* value, Slice suffix);
+  bool HandleWriteStallAttribution(std::string* value, Slice suffix);
+  bool HandleBlockCacheAllocatorStats(std::string* value, Slice suffix);
   bool HandleNumImmutableMemTable(uint64_t* value, DBImpl* db,
                                   Version* version);
   bool HandleNumImmutableMemTableFlushed(uint64_t* value, DBImpl* db,
@@ -540,6 +574,8 @@ class InternalStats {
   bool HandleMemTableFlushPending(uint64_t* value, DBImpl* db,
                                   Version* version);
   bool HandleNumRunningFlushes(uint64_t* value, DBImpl* db, Version* version);
+  bool HandleNumTableFilesPendingOpen(uint64_t* value, DBImpl* db,
+                                      Version* version);
   bool HandleCompactionPending(uint64_t* value, DBImpl* db, Version* version);
   bool HandleNumRunningCompactions(uint64_t* value, DBImpl* db,
                                    Version* version);
@@ -594,6 +630,22 @@ class InternalStats {
   // or compaction will cause the counter to increase too.
   uint64_t bg_error_count_;
 
+  // The flushes and compactions running, by job id
+  struct RunningJob {
+    WriteStallBlockingJobInfo info;
+    uint64_t start_micros;
+  };
+  std::map<int, RunningJob> running_jobs_;
+  // The write stall going on, if any
+  bool write_stall_active_ = false;
+  WriteStallIntervalInfo write_stall_;
+  uint64_t write_stall_bytes_written_at_start_ = 0;
+  // The latest write stalls, oldest first, and those not reported to the
+  // listeners yet
+  static const size_t kMaxRecentWriteStalls = 16;
+  std::deque<WriteStallIntervalInfo> recent_write_stalls_;
+  std::vector<WriteStallIntervalInfo> ended_write_stalls_;
+
   const int number_levels_;
   Env* env_;
   ColumnFamilyData* cfd_;
@@ -668,6 +720,8 @@ class InternalStats {
 
   void AddCFStats(InternalCFStatsType /*type*/, uint64_t /*value*/) {}
 
+  uint64_t GetCFStats(InternalCFStatsType /*type*/) const { return 0; }
+
   void AddDBStats(InternalDBStatsType /*type*/, uint64_t /*value*/,
                   bool /*concurrent */ = false) {}
 
@@ -679,6 +733,18 @@ class InternalStats {
 
   uint64_t BumpAndGetBackgroundErrorCount() { return 0; }
 
+  void AddRunningJob(int /*job_id*/, bool /*is_flush*/,
+                     int /*output_level*/) {}
+  void RemoveRunningJob(int /*job_id*/, uint64_t /*bytes_written*/) {}
+
+  void UpdateWriteStall(WriteStallCondition /*condition*/,
+                        WriteStallCause /*cause*/,
+                        int /*num_unflushed_memtables*/, int /*num_l0_files*/,
+                        uint64_t /*pending_compaction_bytes*/) {}
+
+  void TakeEndedWriteStalls(
+      std::vector<WriteStallIntervalInfo>* /*stalls*/) {}
+
   bool GetStringProperty(const DBPropertyInfo& /*property_info*/,
                          const Slice& /*property*/, std::string* /*value*/) {
     return false;
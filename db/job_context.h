@@ -26,9 +26,16 @@ struct SuperVersionContext {
     const ImmutableCFOptions* immutable_cf_options;
   };
 
+  struct WriteStallIntervalNotification {
+    WriteStallIntervalInfo write_stall_interval_info;
+    const ImmutableCFOptions* immutable_cf_options;
+  };
+
   autovector<SuperVersion*> superversions_to_free;
 #ifndef ROCKSDB_DISABLE_STALL_NOTIFICATION
   autovector<WriteStallNotification> write_stall_notifications;
+  std::vector<WriteStallIntervalNotification>
+      write_stall_interval_notifications;
 #endif
   std::unique_ptr<SuperVersion>
       new_superversion;  // if nullptr no new superversion
@@ -40,6 +47,8 @@ struct SuperVersionContext {
       : superversions_to_free(std::move(other.superversions_to_free)),
 #ifndef ROCKSDB_DISABLE_STALL_NOTIFICATION
         write_stall_notifications(std::move(other.write_stall_notifications)),
+        write_stall_interval_notifications(
+            std::move(other.write_stall_interval_notifications)),
 #endif
         new_superversion(std::move(other.new_superversion)) {
   }
@@ -51,7 +60,8 @@ struct SuperVersionContext {
   inline bool HaveSomethingToDelete() const {
 #ifndef ROCKSDB_DISABLE_STALL_NOTIFICATION
     return !superversions_to_free.empty() ||
-           !write_stall_notifications.empty();
+           !write_stall_notifications.empty() ||
+           !write_stall_interval_notifications.empty();
 #else
     return !superversions_to_free.empty();
 #endif
@@ -75,6 +85,22 @@ struct SuperVersionContext {
 #endif  // !defined(ROCKSDB_LITE) && !defined(ROCKSDB_DISABLE_STALL_NOTIFICATION)
   }
 
+  void PushWriteStallIntervalNotification(WriteStallIntervalInfo&& info,
+                                          const ImmutableCFOptions* ioptions) {
+#if !defined(ROCKSDB_LITE) && !defined(ROCKSDB_DISABLE_STALL_NOTIFICATION)
+    if (ioptions->listeners.empty()) {
+      return;
+    }
+    WriteStallIntervalNotification notif;
+    notif.write_stall_interval_info = std::move(info);
+    notif.immutable_cf_options = ioptions;
+    write_stall_interval_notifications.push_back(std::move(notif));
+#else
+    (void)info;
+    (void)ioptions;
+#endif  // !defined(ROCKSDB_LITE) && !defined(ROCKSDB_DISABLE_STALL_NOTIFICATION)
+  }
+
   void Clean() {
 #if !defined(ROCKSDB_LITE) && !defined(ROCKSDB_DISABLE_STALL_NOTIFICATION)
     // notify listeners on changed write stall conditions
@@ -84,6 +110,12 @@ struct SuperVersionContext {
       }
     }
     write_stall_notifications.clear();
+    for (auto& notif : write_stall_interval_notifications) {
+      for (auto& listener : notif.immutable_cf_options->listeners) {
+        listener->OnWriteStallInterval(notif.write_stall_interval_info);
+      }
+    }
+    write_stall_interval_notifications.clear();
 #endif  // !ROCKSDB_LITE
     // free superversions
     for (auto s : superversions_to_free) {
@@ -95,6 +127,7 @@ struct SuperVersionContext {
   ~SuperVersionContext() {
 #ifndef ROCKSDB_DISABLE_STALL_NOTIFICATION
     assert(write_stall_notifications.empty());
+    assert(write_stall_interval_notifications.empty());
 #endif
     assert(superversions_to_free.empty());
   }
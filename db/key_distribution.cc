@@ -0,0 +1,109 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/key_distribution.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "db/dbformat.h"
+#include "db/table_cache.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+void KeyDistribution::AddFile(TableCache* table_cache,
+                              const InternalKeyComparator& icmp,
+                              const FileMetaData& f) {
+  std::vector<TableReader::Anchor> file_anchors;
+  if (table_cache != nullptr) {
+    Status s = table_cache->ApproximateKeyAnchors(ReadOptions(), icmp, f.fd,
+                                                  &file_anchors);
+    if (!s.ok()) {
+      file_anchors.clear();
+    }
+  }
+  if (file_anchors.empty()) {
+    file_anchors.emplace_back(f.largest.user_key(), f.fd.GetFileSize());
+  }
+  for (auto& anchor : file_anchors) {
+    total_bytes_ += anchor.range_size;
+    anchors_.emplace_back(std::move(anchor));
+  }
+}
+
+void KeyDistribution::Build(const Comparator* ucmp, size_t max_buckets) {
+  buckets_.clear();
+  if (anchors_.empty()) {
+    return;
+  }
+  std::sort(anchors_.begin(), anchors_.end(),
+            [ucmp](const TableReader::Anchor& a,
+                   const TableReader::Anchor& b) -> bool {
+              return ucmp->Compare(a.user_key, b.user_key) < 0;
+            });
+
+  // Cutting at multiples of the mean keeps rounding errors from piling up
+  // on the last bucket
+  const size_t num_buckets =
+      std::max<size_t>(1, std::min(max_buckets, anchors_.size()));
+  const double mean = total_bytes_ * 1.0 / num_buckets;
+  uint64_t cumulative = 0;
+  uint64_t bucket_size = 0;
+  for (size_t i = 0; i + 1 < anchors_.size(); i++) {
+    cumulative += anchors_[i].range_size;
+    bucket_size += anchors_[i].range_size;
+    if (buckets_.size() + 1 >= num_buckets ||
+        cumulative < mean * (buckets_.size() + 1)) {
+      continue;
+    }
+    // Bucket keys must be strictly increasing, and the last bucket must not
+    // be empty
+    if ((!buckets_.empty() &&
+         ucmp->Compare(anchors_[i].user_key,
+                       buckets_.back().largest_user_key) <= 0) ||
+        ucmp->Compare(anchors_[i].user_key, anchors_.back().user_key) >= 0) {
+      continue;
+    }
+    buckets_.emplace_back(anchors_[i].user_key, bucket_size);
+    bucket_size = 0;
+  }
+  buckets_.emplace_back(anchors_.back().user_key,
+                        bucket_size + anchors_.back().range_size);
+}
+
+size_t KeyDistribution::FindBucket(const Comparator* ucmp,
+                                   const Slice& user_key) const {
+  auto it = std::lower_bound(
+      buckets_.begin(), buckets_.end(), user_key,
+      [ucmp](const Bucket& b, const Slice& key) -> bool {
+        return ucmp->Compare(b.largest_user_key, key) < 0;
+      });
+  if (it == buckets_.end()) {
+    return buckets_.empty() ? 0 : buckets_.size() - 1;
+  }
+  return static_cast<size_t>(it - buckets_.begin());
+}
+
+std::string KeyDistribution::ToString() const {
+  std::string result;
+  char buf[200];
+  snprintf(buf, sizeof(buf),
+           "Buckets: %" ROCKSDB_PRIszt " Samples: %" ROCKSDB_PRIszt
+           " Bytes: %" PRIu64 "\n",
+           buckets_.size(), anchors_.size(), total_bytes_);
+  result.append(buf);
+  for (size_t i = 0; i < buckets_.size(); i++) {
+    const Bucket& b = buckets_[i];
+    snprintf(buf, sizeof(buf),
+             "%5" ROCKSDB_PRIszt " %12" PRIu64 " %6.2f%% ", i, b.bytes,
+             total_bytes_ ? 100.0 * b.bytes / total_bytes_ : 0.0);
+    result.append(buf);
+    result.append(Slice(b.largest_user_key).ToString(true /* hex */));
+    result.append("\n");
+  }
+  return result;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
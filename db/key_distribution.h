@@ -0,0 +1,62 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "db/version_edit.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/slice.h"
+#include "table/table_reader.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class InternalKeyComparator;
+class TableCache;
+
+// A byte-weighted histogram of a key space, built from the index block
+// separators of table files without reading their data blocks. Bucket i
+// holds the user keys after the largest key of bucket i - 1 up to its own,
+// and about as many bytes as the other buckets.
+class KeyDistribution {
+ public:
+  struct Bucket {
+    Bucket(const std::string& _largest_user_key, uint64_t _bytes)
+        : largest_user_key(_largest_user_key), bytes(_bytes) {}
+    std::string largest_user_key;
+    uint64_t bytes;
+  };
+
+  // Adds samples of the user keys of f, each with the size of the data of f
+  // since the previous one, see TableReader::ApproximateKeyAnchors(). If
+  // table_cache is nullptr, or f cannot be sampled, f is one sample of its
+  // largest key and its whole size, which needs no I/O.
+  void AddFile(TableCache* table_cache, const InternalKeyComparator& icmp,
+               const FileMetaData& f);
+
+  // Groups the samples added so far into at most max_buckets buckets, cut
+  // where the bytes reach the next multiple of the mean bucket size
+  void Build(const Comparator* ucmp, size_t max_buckets);
+
+  uint64_t TotalBytes() const { return total_bytes_; }
+  size_t NumSamples() const { return anchors_.size(); }
+  const std::vector<Bucket>& buckets() const { return buckets_; }
+
+  // The bucket holding user_key, the last one for keys past all buckets and
+  // 0 if there are none
+  size_t FindBucket(const Comparator* ucmp, const Slice& user_key) const;
+
+  // One line per bucket, with the keys in hex
+  std::string ToString() const;
+
+ private:
+  std::vector<TableReader::Anchor> anchors_;
+  uint64_t total_bytes_ = 0;
+  std::vector<Bucket> buckets_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
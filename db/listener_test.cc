@@ -504,6 +504,73 @@ TEST_F(EventListenerTest, DisableBGCompaction) {
   ASSERT_GE(listener->slowdown_count, kSlowdownTrigger * 9);
 }
 
+class TestWriteStallIntervalListener : public EventListener {
+ public:
+  void OnWriteStallInterval(const WriteStallIntervalInfo& info) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stalls_.push_back(info);
+  }
+
+  std::vector<WriteStallIntervalInfo> stalls_;
+  std::mutex mutex_;
+};
+
+TEST_F(EventListenerTest, WriteStallInterval) {
+  Options options;
+  options.env = CurrentOptions().env;
+  options.create_if_missing = true;
+  options.level0_file_num_compaction_trigger = 2;
+  options.level0_slowdown_writes_trigger = 2;
+  options.level0_stop_writes_trigger = 100;
+  options.compression = kNoCompression;
+  auto listener = std::make_shared<TestWriteStallIntervalListener>();
+  options.listeners.push_back(listener);
+  DestroyAndReopen(options);
+
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"DBImpl::BackgroundCompaction:NonTrivial:BeforeRun",
+        "EventListenerTest::WriteStallInterval:Running"},
+       {"EventListenerTest::WriteStallInterval:Checked",
+        "DBImpl::BackgroundCompaction:NonTrivial:AfterRun"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // The second L0 file delays the writes until the compaction it triggers
+  // clears L0
+  FlushOptions fo;
+  fo.allow_write_stall = true;
+  for (int i = 0; i < 2; i++) {
+    ASSERT_OK(Put("key", ToString(i)));
+    ASSERT_OK(db_->Flush(fo));
+  }
+  TEST_SYNC_POINT("EventListenerTest::WriteStallInterval:Running");
+  std::string attribution;
+  ASSERT_TRUE(
+      db_->GetProperty(DB::Properties::kWriteStallAttribution, &attribution));
+  ASSERT_EQ(0, attribution.find("Active stall"));
+  ASSERT_NE(std::string::npos, attribution.find("compaction job"));
+  ASSERT_NE(std::string::npos, attribution.find("running"));
+  TEST_SYNC_POINT("EventListenerTest::WriteStallInterval:Checked");
+
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  SyncPoint::GetInstance()->DisableProcessing();
+  ASSERT_EQ(1, listener->stalls_.size());
+  const WriteStallIntervalInfo& stall = listener->stalls_[0];
+  ASSERT_EQ(kDefaultColumnFamilyName, stall.cf_name);
+  ASSERT_EQ(WriteStallCondition::kDelayed, stall.condition);
+  ASSERT_EQ(WriteStallCause::kL0FileCountLimit, stall.cause);
+  ASSERT_EQ(2, stall.num_l0_files);
+  ASSERT_EQ(1, stall.blocking_jobs.size());
+  ASSERT_FALSE(stall.blocking_jobs[0].is_flush);
+  ASSERT_TRUE(stall.blocking_jobs[0].finished);
+  ASSERT_EQ(1, stall.blocking_jobs[0].output_level);
+  ASSERT_GT(stall.blocking_jobs[0].bytes_written, 0);
+  ASSERT_GT(stall.bytes_written, 0);
+
+  ASSERT_TRUE(
+      db_->GetProperty(DB::Properties::kWriteStallAttribution, &attribution));
+  ASSERT_EQ(0, attribution.find("Stall"));
+}
+
 class TestCompactionReasonListener : public EventListener {
  public:
   void OnCompactionCompleted(DB* /*db*/, const CompactionJobInfo& ci) override {
@@ -32,8 +32,13 @@ enum RecordType {
   kRecyclableFirstType = 6,
   kRecyclableMiddleType = 7,
   kRecyclableLastType = 8,
+
+  // Names the compression type of all following records. Only ever written
+  // as the first record of a log file.
+  kSetCompressionType = 9,
+  kRecyclableSetCompressionType = 10,
 };
-static const int kMaxRecordType = kRecyclableLastType;
+static const int kMaxRecordType = kRecyclableSetCompressionType;
 
 static const unsigned int kBlockSize = 32768;
 
@@ -15,6 +15,7 @@
 #include "rocksdb/env.h"
 #include "test_util/sync_point.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -38,7 +39,9 @@ Reader::Reader(std::shared_ptr<Logger> info_log,
       last_record_offset_(0),
       end_of_buffer_offset_(0),
       log_number_(log_num),
-      recycled_(false) {}
+      recycled_(false),
+      first_record_read_(false),
+      compression_type_record_read_(false) {}
 
 Reader::~Reader() {
   delete[] backing_store_;
@@ -79,6 +82,7 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
         scratch->clear();
         *record = fragment;
         last_record_offset_ = prospective_record_offset;
+        first_record_read_ = true;
         return true;
 
       case kFirstType:
@@ -114,10 +118,21 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
           scratch->append(fragment.data(), fragment.size());
           *record = Slice(*scratch);
           last_record_offset_ = prospective_record_offset;
+          first_record_read_ = true;
           return true;
         }
         break;
 
+      case kSetCompressionType:
+      case kRecyclableSetCompressionType:
+        if (compression_type_record_read_ || first_record_read_) {
+          ReportCorruption(fragment.size(),
+                           "SetCompressionType not the first record");
+        } else {
+          InitCompression(fragment);
+        }
+        break;
+
       case kBadHeader:
         if (wal_recovery_mode == WALRecoveryMode::kAbsoluteConsistency) {
           // in clean shutdown we don't expect any error in the log files
@@ -270,6 +285,64 @@ void Reader::UnmarkEOFInternal() {
   }
 }
 
+void Reader::InitCompression(const Slice& payload) {
+  compression_type_record_read_ = true;
+  if (payload.size() != sizeof(uint32_t)) {
+    ReportCorruption(payload.size(), "bad SetCompressionType record");
+    return;
+  }
+  const CompressionType type =
+      static_cast<CompressionType>(DecodeFixed32(payload.data()));
+  if (type == kNoCompression) {
+    return;
+  }
+  uncompress_.reset(StreamingUncompress::Create(type, kBlockSize));
+  if (uncompress_ == nullptr) {
+    ReportDrop(payload.size(),
+               Status::NotSupported("WAL compression type not supported",
+                                    CompressionTypeToString(type)));
+    return;
+  }
+  uncompressed_buffer_.reset(new char[kBlockSize]);
+}
+
+bool Reader::UncompressFragment(unsigned int type, Slice* fragment) {
+  switch (type) {
+    case kFullType:
+    case kRecyclableFullType:
+    case kFirstType:
+    case kRecyclableFirstType:
+      // Every logical record is a frame of its own. Drop whatever is left of
+      // the frame of a record that was cut short.
+      uncompress_->Reset();
+      break;
+    case kMiddleType:
+    case kRecyclableMiddleType:
+    case kLastType:
+    case kRecyclableLastType:
+      break;
+    default:
+      return true;
+  }
+  uncompressed_record_.clear();
+  const char* input = fragment->data();
+  int remaining = 0;
+  do {
+    size_t uncompressed_size = 0;
+    remaining = uncompress_->Uncompress(input, fragment->size(),
+                                        uncompressed_buffer_.get(),
+                                        &uncompressed_size);
+    if (remaining < 0) {
+      ReportCorruption(fragment->size(), "could not uncompress record");
+      return false;
+    }
+    uncompressed_record_.append(uncompressed_buffer_.get(), uncompressed_size);
+    input = nullptr;
+  } while (remaining > 0);
+  *fragment = Slice(uncompressed_record_);
+  return true;
+}
+
 void Reader::ReportCorruption(size_t bytes, const char* reason) {
   ReportDrop(bytes, Status::Corruption(reason));
 }
@@ -336,7 +409,8 @@ unsigned int Reader::ReadPhysicalRecord(Slice* result, size_t* drop_size) {
     const unsigned int type = header[6];
     const uint32_t length = a | (b << 8);
     int header_size = kHeaderSize;
-    if (type >= kRecyclableFullType && type <= kRecyclableLastType) {
+    if ((type >= kRecyclableFullType && type <= kRecyclableLastType) ||
+        type == kRecyclableSetCompressionType) {
       if (end_of_buffer_offset_ - buffer_.size() == 0) {
         recycled_ = true;
       }
@@ -397,6 +471,9 @@ unsigned int Reader::ReadPhysicalRecord(Slice* result, size_t* drop_size) {
     buffer_.remove_prefix(header_size + length);
 
     *result = Slice(header + header_size, length);
+    if (uncompress_ != nullptr && !UncompressFragment(type, result)) {
+      return kBadRecord;
+    }
     return type;
   }
 }
@@ -425,6 +502,7 @@ bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
         prospective_record_offset = physical_record_offset;
         last_record_offset_ = prospective_record_offset;
         in_fragmented_record_ = false;
+        first_record_read_ = true;
         return true;
 
       case kFirstType:
@@ -459,10 +537,21 @@ bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
           *record = Slice(*scratch);
           last_record_offset_ = prospective_record_offset;
           in_fragmented_record_ = false;
+          first_record_read_ = true;
           return true;
         }
         break;
 
+      case kSetCompressionType:
+      case kRecyclableSetCompressionType:
+        if (compression_type_record_read_ || first_record_read_) {
+          ReportCorruption(fragment.size(),
+                           "SetCompressionType not the first record");
+        } else {
+          InitCompression(fragment);
+        }
+        break;
+
       case kBadHeader:
       case kBadRecord:
       case kEof:
@@ -568,7 +657,8 @@ bool FragmentBufferedReader::TryReadFragment(
   const unsigned int type = header[6];
   const uint32_t length = a | (b << 8);
   int header_size = kHeaderSize;
-  if (type >= kRecyclableFullType && type <= kRecyclableLastType) {
+  if ((type >= kRecyclableFullType && type <= kRecyclableLastType) ||
+      type == kRecyclableSetCompressionType) {
     if (end_of_buffer_offset_ - buffer_.size() == 0) {
       recycled_ = true;
     }
@@ -622,6 +712,9 @@ bool FragmentBufferedReader::TryReadFragment(
 
   *fragment = Slice(header + header_size, length);
   *fragment_type_or_err = type;
+  if (uncompress_ != nullptr && !UncompressFragment(type, fragment)) {
+    *fragment_type_or_err = kBadRecord;
+  }
   return true;
 }
 
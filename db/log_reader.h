@@ -19,6 +19,7 @@
 
 namespace ROCKSDB_NAMESPACE {
 class Logger;
+class StreamingUncompress;
 
 namespace log {
 
@@ -128,6 +129,16 @@ class Reader {
   // Whether this is a recycled log file
   bool recycled_;
 
+  // Whether a logical record has been returned
+  bool first_record_read_;
+  // Whether the kSetCompressionType record has been read
+  bool compression_type_record_read_;
+  // Set once the log names a compression type, reused for all its records
+  std::unique_ptr<StreamingUncompress> uncompress_;
+  std::unique_ptr<char[]> uncompressed_buffer_;
+  // Uncompressed payload of the last physical record
+  std::string uncompressed_record_;
+
   // Extend record types with the following special values
   enum {
     kEof = kMaxRecordType + 1,
@@ -154,6 +165,13 @@ class Reader {
 
   void UnmarkEOFInternal();
 
+  // Handles the payload of a kSetCompressionType record
+  void InitCompression(const Slice& payload);
+
+  // Replaces the payload of a physical record of the given type with its
+  // uncompressed bytes. Returns false and reports a corruption on error.
+  bool UncompressFragment(unsigned int type, Slice* fragment);
+
   // Reports dropped bytes to the reporter.
   // buffer_ must be updated to remove the dropped bytes prior to invocation.
   void ReportCorruption(size_t bytes, const char* reason);
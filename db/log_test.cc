@@ -16,6 +16,7 @@
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/random.h"
 
@@ -45,10 +46,12 @@ static std::string RandomSkewedString(int i, Random* rnd) {
   return BigString(NumberString(i), rnd->Skewed(17));
 }
 
-// Param type is tuple<int, bool>
+// Param type is tuple<int, bool, CompressionType>
 // get<0>(tuple): non-zero if recycling log, zero if regular log
 // get<1>(tuple): true if allow retry after read EOF, false otherwise
-class LogTest : public ::testing::TestWithParam<std::tuple<int, bool>> {
+// get<2>(tuple): compression type of the writer
+class LogTest
+    : public ::testing::TestWithParam<std::tuple<int, bool, CompressionType>> {
  private:
   class StringSource : public SequentialFile {
    public:
@@ -162,10 +165,10 @@ class LogTest : public ::testing::TestWithParam<std::tuple<int, bool>> {
   std::unique_ptr<WritableFileWriter> dest_holder_;
   std::unique_ptr<SequentialFileReader> source_holder_;
   ReportCollector report_;
-  Writer writer_;
-  std::unique_ptr<Reader> reader_;
 
  protected:
+  Writer writer_;
+  std::unique_ptr<Reader> reader_;
   bool allow_retry_read_;
 
  public:
@@ -176,7 +179,8 @@ class LogTest : public ::testing::TestWithParam<std::tuple<int, bool>> {
         source_holder_(test::GetSequentialFileReader(
             new StringSource(reader_contents_, !std::get<1>(GetParam())),
             "" /* file name */)),
-        writer_(std::move(dest_holder_), 123, std::get<0>(GetParam())),
+        writer_(std::move(dest_holder_), 123, std::get<0>(GetParam()),
+                false /* manual_flush */, std::get<2>(GetParam())),
         allow_retry_read_(std::get<1>(GetParam())) {
     if (allow_retry_read_) {
       reader_.reset(new FragmentBufferedReader(
@@ -307,6 +311,22 @@ TEST_P(LogTest, Fragmentation) {
   ASSERT_EQ("EOF", Read());
 }
 
+TEST_P(LogTest, SliceParts) {
+  // Parts of a record, empty ones included, end up anywhere in the
+  // fragments, which cross block boundaries
+  const std::string medium = BigString("medium", 3 * kBlockSize / 2);
+  const std::string large = BigString("large", 3 * kBlockSize);
+  Slice parts[] = {Slice("small"), Slice(), Slice(medium), Slice(large),
+                   Slice()};
+  ASSERT_OK(writer_.AddRecord(SliceParts(parts, 5)));
+  ASSERT_OK(writer_.AddRecord(SliceParts(parts + 1, 1)));
+  ASSERT_OK(writer_.AddRecord(SliceParts(parts + 2, 2)));
+  ASSERT_EQ("small" + medium + large, Read());
+  ASSERT_EQ("", Read());
+  ASSERT_EQ(medium + large, Read());
+  ASSERT_EQ("EOF", Read());
+}
+
 TEST_P(LogTest, MarginalTrailer) {
   // Make a trailer that is exactly the same length as an empty record.
   int header_size =
@@ -699,11 +719,96 @@ TEST_P(LogTest, Recycle) {
   ASSERT_EQ("EOF", Read());
 }
 
-INSTANTIATE_TEST_CASE_P(bool, LogTest,
-                        ::testing::Values(std::make_tuple(0, false),
-                                          std::make_tuple(0, true),
-                                          std::make_tuple(1, false),
-                                          std::make_tuple(1, true)));
+INSTANTIATE_TEST_CASE_P(
+    bool, LogTest,
+    ::testing::Values(std::make_tuple(0, false, kNoCompression),
+                      std::make_tuple(0, true, kNoCompression),
+                      std::make_tuple(1, false, kNoCompression),
+                      std::make_tuple(1, true, kNoCompression)));
+
+class CompressionLogTest : public LogTest {
+ public:
+  // Compressed logs start with the compression type record
+  void SetUp() override { ASSERT_OK(writer_.AddCompressionTypeRecord()); }
+};
+
+TEST_P(CompressionLogTest, Empty) { ASSERT_EQ("EOF", Read()); }
+
+TEST_P(CompressionLogTest, ReadWrite) {
+  Write("foo");
+  Write("bar");
+  Write("");
+  Write("xxxx");
+  ASSERT_EQ("foo", Read());
+  ASSERT_EQ("bar", Read());
+  ASSERT_EQ("", Read());
+  ASSERT_EQ("xxxx", Read());
+  ASSERT_EQ("EOF", Read());
+  ASSERT_EQ("EOF", Read());  // Make sure reads at eof work
+}
+
+TEST_P(CompressionLogTest, ManyBlocks) {
+  for (int i = 0; i < 100000; i++) {
+    Write(NumberString(i));
+  }
+  for (int i = 0; i < 100000; i++) {
+    ASSERT_EQ(NumberString(i), Read());
+  }
+  ASSERT_EQ("EOF", Read());
+}
+
+TEST_P(CompressionLogTest, Fragmentation) {
+  // An incompressible record compresses into several chunks
+  Random rnd(301);
+  const std::string incompressible = rnd.RandomString(100000);
+  Write("small");
+  Write(BigString("medium", 50000));
+  Write(incompressible);
+  Write(BigString("large", 100000));
+  ASSERT_EQ("small", Read());
+  ASSERT_EQ(BigString("medium", 50000), Read());
+  ASSERT_EQ(incompressible, Read());
+  ASSERT_EQ(BigString("large", 100000), Read());
+  ASSERT_EQ("EOF", Read());
+  ASSERT_EQ(0U, DroppedBytes());
+}
+
+TEST_P(CompressionLogTest, SliceParts) {
+  const std::string large = BigString("large", 3 * kBlockSize);
+  Slice parts[] = {Slice("small"), Slice(), Slice(large)};
+  ASSERT_OK(writer_.AddRecord(SliceParts(parts, 3)));
+  ASSERT_OK(writer_.AddRecord(SliceParts(parts + 2, 1)));
+  ASSERT_EQ("small" + large, Read());
+  ASSERT_EQ(large, Read());
+  ASSERT_EQ("EOF", Read());
+}
+
+TEST_P(CompressionLogTest, SkipCorruptedRecord) {
+  if (std::get<0>(GetParam()) != 0) {
+    return;  // recycled logs treat a corruption as the end of the log
+  }
+  // Corrupting the first block drops the start of the second record. The
+  // records after it are still readable because every record is
+  // compressed on its own.
+  Random rnd(301);
+  Write("foo");
+  Write(rnd.RandomString(2 * kBlockSize));
+  Write("bar");
+  Write("baz");
+  IncrementByte(kBlockSize / 2, 1);
+  ASSERT_EQ("foo", Read());
+  ASSERT_EQ("bar", Read());
+  ASSERT_EQ("baz", Read());
+  ASSERT_EQ("EOF", Read());
+  ASSERT_GT(DroppedBytes(), 0U);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    Compression, CompressionLogTest,
+    ::testing::Combine(::testing::Values(0, 1), ::testing::Bool(),
+                       ::testing::Values(StreamingCompressionTypeSupported(kZSTD)
+                                             ? kZSTD
+                                             : kNoCompression)));
 
 class RetriableLogTest : public ::testing::TestWithParam<int> {
  private:
@@ -10,25 +10,67 @@
 #include "db/log_writer.h"
 
 #include <stdint.h>
+
+#include <algorithm>
+#include <string>
+
 #include "file/writable_file_writer.h"
 #include "rocksdb/env.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace log {
 
+namespace {
+
+// Calls fn(data, size) on each piece of the `n` bytes of `parts` that start
+// at part `*index`, offset `*offset`, and moves that position past them.
+// Stops early if fn returns false.
+template <typename Fn>
+bool ForEachPiece(const SliceParts& parts, int* index, size_t* offset,
+                  size_t n, const Fn& fn) {
+  while (n > 0) {
+    assert(*index < parts.num_parts);
+    const Slice& part = parts.parts[*index];
+    assert(*offset <= part.size());
+    const size_t len = std::min(n, part.size() - *offset);
+    if (len > 0 && !fn(part.data() + *offset, len)) {
+      return false;
+    }
+    n -= len;
+    *offset += len;
+    if (*offset == part.size()) {
+      ++*index;
+      *offset = 0;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 Writer::Writer(std::unique_ptr<WritableFileWriter>&& dest, uint64_t log_number,
-               bool recycle_log_files, bool manual_flush)
+               bool recycle_log_files, bool manual_flush,
+               CompressionType compression_type)
     : dest_(std::move(dest)),
       block_offset_(0),
       log_number_(log_number),
       recycle_log_files_(recycle_log_files),
-      manual_flush_(manual_flush) {
+      manual_flush_(manual_flush),
+      compression_type_(compression_type) {
   for (int i = 0; i <= kMaxRecordType; i++) {
     char t = static_cast<char>(i);
     type_crc_[i] = crc32c::Value(&t, 1);
   }
+  if (compression_type_ != kNoCompression) {
+    // A compressed chunk never spans more than one block
+    compress_.reset(StreamingCompress::Create(
+        compression_type_, CompressionOptions(), kBlockSize));
+    assert(compress_ != nullptr);
+    compressed_buffer_.reset(new char[kBlockSize]);
+  }
 }
 
 Writer::~Writer() {
@@ -49,13 +91,39 @@ IOStatus Writer::Close() {
 }
 
 IOStatus Writer::AddRecord(const Slice& slice) {
-  const char* ptr = slice.data();
-  size_t left = slice.size();
+  return AddRecord(SliceParts(&slice, 1));
+}
+
+IOStatus Writer::AddRecord(const SliceParts& parts) {
+  // The record is read from `payload` starting at part `part_index`, offset
+  // `part_offset`; `left` is the number of bytes still to emit.
+  SliceParts payload = parts;
+  int part_index = 0;
+  size_t part_offset = 0;
+  size_t left = 0;
+  for (int i = 0; i < parts.num_parts; i++) {
+    left += parts.parts[i].size();
+  }
 
   // Header size varies depending on whether we are recycling or not.
   const int header_size =
       recycle_log_files_ ? kRecyclableHeaderSize : kHeaderSize;
 
+  // With compression, `payload` and `left` describe the current chunk of
+  // compressed output instead of the record itself, and
+  // `compress_remaining` is non-zero while the frame has more chunks.
+  int compress_remaining = 0;
+  bool compress_start = false;
+  std::string contiguous;
+  Slice record;
+  Slice chunk;
+  if (compress_) {
+    // The compressor takes its input in one piece
+    record = parts.num_parts == 1 ? parts.parts[0] : Slice(parts, &contiguous);
+    compress_->Reset();
+    compress_start = true;
+  }
+
   // Fragment the record if necessary and emit it.  Note that if slice
   // is empty, we still want to iterate once to emit a single
   // zero-length record
@@ -83,10 +151,27 @@ IOStatus Writer::AddRecord(const Slice& slice) {
     assert(static_cast<int64_t>(kBlockSize - block_offset_) >= header_size);
 
     const size_t avail = kBlockSize - block_offset_ - header_size;
+
+    // Compress the next chunk once the previous one has been emitted
+    if (compress_ && (compress_start || left == 0)) {
+      compress_remaining = compress_->Compress(
+          record.data(), record.size(), compressed_buffer_.get(), &left);
+      if (compress_remaining < 0) {
+        s = IOStatus::IOError("Unexpected WAL compression error");
+        s.SetDataLoss(true);
+        break;
+      }
+      compress_start = false;
+      chunk = Slice(compressed_buffer_.get(), left);
+      payload = SliceParts(&chunk, 1);
+      part_index = 0;
+      part_offset = 0;
+    }
+
     const size_t fragment_length = (left < avail) ? left : avail;
 
     RecordType type;
-    const bool end = (left == fragment_length);
+    const bool end = (left == fragment_length && compress_remaining == 0);
     if (begin && end) {
       type = recycle_log_files_ ? kRecyclableFullType : kFullType;
     } else if (begin) {
@@ -97,11 +182,11 @@ IOStatus Writer::AddRecord(const Slice& slice) {
       type = recycle_log_files_ ? kRecyclableMiddleType : kMiddleType;
     }
 
-    s = EmitPhysicalRecord(type, ptr, fragment_length);
-    ptr += fragment_length;
+    s = EmitPhysicalRecord(type, payload, &part_index, &part_offset,
+                           fragment_length);
     left -= fragment_length;
     begin = false;
-  } while (s.ok() && left > 0);
+  } while (s.ok() && (left > 0 || compress_remaining > 0));
 
   if (s.ok()) {
     if (!manual_flush_) {
@@ -112,9 +197,36 @@ IOStatus Writer::AddRecord(const Slice& slice) {
   return s;
 }
 
+IOStatus Writer::AddCompressionTypeRecord() {
+  if (compression_type_ == kNoCompression) {
+    return IOStatus::OK();
+  }
+  // The record is the first one of the log, so it always fits in the block
+  assert(block_offset_ == 0);
+  char payload[4];
+  EncodeFixed32(payload, static_cast<uint32_t>(compression_type_));
+  IOStatus s = EmitPhysicalRecord(
+      recycle_log_files_ ? kRecyclableSetCompressionType : kSetCompressionType,
+      payload, sizeof(payload));
+  if (s.ok() && !manual_flush_) {
+    s = dest_->Flush();
+  }
+  return s;
+}
+
 bool Writer::TEST_BufferIsEmpty() { return dest_->TEST_BufferIsEmpty(); }
 
 IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
+  const Slice piece(ptr, n);
+  int part_index = 0;
+  size_t part_offset = 0;
+  return EmitPhysicalRecord(t, SliceParts(&piece, 1), &part_index,
+                            &part_offset, n);
+}
+
+IOStatus Writer::EmitPhysicalRecord(RecordType t, const SliceParts& parts,
+                                    int* part_index, size_t* part_offset,
+                                    size_t n) {
   assert(n <= 0xffff);  // Must fit in two bytes
 
   size_t header_size;
@@ -126,7 +238,7 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
   buf[6] = static_cast<char>(t);
 
   uint32_t crc = type_crc_[t];
-  if (t < kRecyclableFullType) {
+  if (t < kRecyclableFullType || t == kSetCompressionType) {
     // Legacy record format
     assert(block_offset_ + kHeaderSize + n <= kBlockSize);
     header_size = kHeaderSize;
@@ -145,7 +257,12 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
   }
 
   // Compute the crc of the record type and the payload.
-  crc = crc32c::Extend(crc, ptr, n);
+  int index = *part_index;
+  size_t offset = *part_offset;
+  ForEachPiece(parts, &index, &offset, n, [&](const char* data, size_t len) {
+    crc = crc32c::Extend(crc, data, len);
+    return true;
+  });
   crc = crc32c::Mask(crc);  // Adjust for storage
   TEST_SYNC_POINT_CALLBACK("LogWriter::EmitPhysicalRecord:BeforeEncodeChecksum",
                            &crc);
@@ -154,7 +271,11 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
   // Write the header and the payload
   IOStatus s = dest_->Append(Slice(buf, header_size));
   if (s.ok()) {
-    s = dest_->Append(Slice(ptr, n));
+    ForEachPiece(parts, part_index, part_offset, n,
+                 [&](const char* data, size_t len) {
+                   s = dest_->Append(Slice(data, len));
+                   return s.ok();
+                 });
   }
   block_offset_ += header_size + n;
   return s;
@@ -13,12 +13,14 @@
 #include <memory>
 
 #include "db/log_format.h"
+#include "rocksdb/compression_type.h"
 #include "rocksdb/io_status.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+class StreamingCompress;
 class WritableFileWriter;
 
 namespace log {
@@ -65,6 +67,13 @@ namespace log {
  * Same as above, with the addition of
  * Log number = 32bit log file number, so that we can distinguish between
  * records written by the most recent log writer vs a previous one.
+ *
+ * Compressed logs start with a kSetCompressionType (or
+ * kRecyclableSetCompressionType) record whose payload is the fixed32
+ * CompressionType. The payload of every later logical record is then
+ * compressed as one independent frame, which is split into fragments like
+ * an uncompressed record, so readers can drop a corrupted record and carry
+ * on with the next one.
  */
 class Writer {
  public:
@@ -73,7 +82,8 @@ class Writer {
   // "*dest" must remain live while this Writer is in use.
   explicit Writer(std::unique_ptr<WritableFileWriter>&& dest,
                   uint64_t log_number, bool recycle_log_files,
-                  bool manual_flush = false);
+                  bool manual_flush = false,
+                  CompressionType compression_type = kNoCompression);
   // No copying allowed
   Writer(const Writer&) = delete;
   void operator=(const Writer&) = delete;
@@ -82,6 +92,15 @@ class Writer {
 
   IOStatus AddRecord(const Slice& slice);
 
+  // Same as AddRecord(Slice) with the record being the concatenation of
+  // `parts`, which is never materialized: each fragment is checksummed and
+  // appended to the file buffer straight from the parts it spans.
+  IOStatus AddRecord(const SliceParts& parts);
+
+  // Writes the kSetCompressionType record if the writer compresses. Must be
+  // called before the first AddRecord().
+  IOStatus AddCompressionTypeRecord();
+
   WritableFileWriter* file() { return dest_.get(); }
   const WritableFileWriter* file() const { return dest_.get(); }
 
@@ -105,10 +124,20 @@ class Writer {
   uint32_t type_crc_[kMaxRecordType + 1];
 
   IOStatus EmitPhysicalRecord(RecordType type, const char* ptr, size_t length);
+  // Emits the `length` bytes of `parts` that start at part `*part_index`,
+  // offset `*part_offset`, and moves that position past them.
+  IOStatus EmitPhysicalRecord(RecordType type, const SliceParts& parts,
+                              int* part_index, size_t* part_offset,
+                              size_t length);
 
   // If true, it does not flush after each write. Instead it relies on the upper
   // layer to manually does the flush by calling ::WriteBuffer()
   bool manual_flush_;
+
+  CompressionType compression_type_;
+  // The compression context is reused for all records of this log
+  std::unique_ptr<StreamingCompress> compress_;
+  std::unique_ptr<char[]> compressed_buffer_;
 };
 
 }  // namespace log
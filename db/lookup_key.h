@@ -10,6 +10,7 @@
 #pragma once
 #include <string>
 #include <utility>
+#include "memory/arena.h"
 #include "rocksdb/db.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/types.h"
@@ -20,9 +21,11 @@ namespace ROCKSDB_NAMESPACE {
 class LookupKey {
  public:
   // Initialize *this for looking up user_key at a snapshot with
-  // the specified sequence number.
+  // the specified sequence number. If recycle_block, a key too long for
+  // space_ is encoded into a block from Arena::TakeRecycledBlock() if it
+  // fits.
   LookupKey(const Slice& _user_key, SequenceNumber sequence,
-            const Slice* ts = nullptr);
+            const Slice* ts = nullptr, bool recycle_block = false);
 
   ~LookupKey();
 
@@ -53,6 +56,7 @@ class LookupKey {
   const char* kstart_;
   const char* end_;
   char space_[200];  // Avoid allocation for short keys
+  bool recycled_block_;
 
   // No copying allowed
   LookupKey(const LookupKey&);
@@ -60,7 +64,11 @@ class LookupKey {
 };
 
 inline LookupKey::~LookupKey() {
-  if (start_ != space_) delete[] start_;
+  if (recycled_block_) {
+    Arena::GiveBackRecycledBlock(const_cast<char*>(start_));
+  } else if (start_ != space_) {
+    delete[] start_;
+  }
 }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -13,6 +13,9 @@
 #include <array>
 #include <limits>
 #include <memory>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "db/dbformat.h"
 #include "db/merge_context.h"
 #include "db/merge_helper.h"
@@ -36,6 +39,7 @@
 #include "table/merging_iterator.h"
 #include "util/autovector.h"
 #include "util/coding.h"
+#include "util/math.h"
 #include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -56,6 +60,8 @@ ImmutableMemTableOptions::ImmutableMemTableOptions(
       inplace_update_num_locks(mutable_cf_options.inplace_update_num_locks),
       inplace_callback(ioptions.inplace_callback),
       max_successive_merges(mutable_cf_options.max_successive_merges),
+      preaggregate_merge_operands(
+          mutable_cf_options.preaggregate_merge_operands),
       statistics(ioptions.statistics),
       merge_operator(ioptions.merge_operator),
       info_log(ioptions.info_log),
@@ -232,12 +238,69 @@ void MemTable::UpdateOldestKeyTime() {
   }
 }
 
+namespace {
+// Same order as Slice::compare()
+int CompareBytewise(const Slice& a, const Slice& b) {
+  const size_t min_len = std::min(a.size(), b.size());
+  size_t i = 0;
+#ifdef __SSE2__
+  for (; i + 16 <= min_len; i += 16) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a.data() + i));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b.data() + i));
+    // One bit per byte that differs
+    unsigned int diff =
+        static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) ^
+        0xffffu;
+    if (diff != 0) {
+      size_t pos = i + CountTrailingZeroBits(diff);
+      return static_cast<unsigned char>(a[pos]) <
+                     static_cast<unsigned char>(b[pos])
+                 ? -1
+                 : +1;
+    }
+  }
+#endif
+  int r = memcmp(a.data() + i, b.data() + i, min_len - i);
+  if (r == 0) {
+    if (a.size() < b.size()) {
+      r = -1;
+    } else if (a.size() > b.size()) {
+      r = +1;
+    }
+  }
+  return r;
+}
+}  // namespace
+
+int MemTable::KeyComparator::CompareKeySeq(const Slice& a,
+                                           const Slice& b) const {
+  if (!bytewise) {
+    return comparator.CompareKeySeq(a, b);
+  }
+  // Like InternalKeyComparator::CompareKeySeq() with the user comparator
+  // inlined
+  PERF_COUNTER_ADD(user_key_comparison_count, 1);
+  int r = CompareBytewise(ExtractUserKey(a), ExtractUserKey(b));
+  if (r == 0) {
+    const uint64_t anum =
+        DecodeFixed64(a.data() + a.size() - kNumInternalBytes) >> 8;
+    const uint64_t bnum =
+        DecodeFixed64(b.data() + b.size() - kNumInternalBytes) >> 8;
+    if (anum > bnum) {
+      r = -1;
+    } else if (anum < bnum) {
+      r = +1;
+    }
+  }
+  return r;
+}
+
 int MemTable::KeyComparator::operator()(const char* prefix_len_key1,
                                         const char* prefix_len_key2) const {
   // Internal keys are encoded as length-prefixed strings.
   Slice k1 = GetLengthPrefixedSlice(prefix_len_key1);
   Slice k2 = GetLengthPrefixedSlice(prefix_len_key2);
-  return comparator.CompareKeySeq(k1, k2);
+  return CompareKeySeq(k1, k2);
 }
 
 int MemTable::KeyComparator::operator()(const char* prefix_len_key,
@@ -245,7 +308,7 @@ int MemTable::KeyComparator::operator()(const char* prefix_len_key,
     const {
   // Internal keys are encoded as length-prefixed strings.
   Slice a = GetLengthPrefixedSlice(prefix_len_key);
-  return comparator.CompareKeySeq(a, key);
+  return CompareKeySeq(a, key);
 }
 
 void MemTableRep::InsertConcurrently(KeyHandle /*handle*/) {
@@ -483,7 +546,8 @@ MemTable::MemTableStats MemTable::ApproximateStats(const Slice& start_ikey,
 bool MemTable::Add(SequenceNumber s, ValueType type,
                    const Slice& key, /* user key */
                    const Slice& value, bool allow_concurrent,
-                   MemTablePostProcessInfo* post_process_info, void** hint) {
+                   MemTablePostProcessInfo* post_process_info, void** hint,
+                   std::vector<KeyHandle>* pending) {
   // Format of an entry is concatenation of:
   //  key_size     : varint32 of internal_key.size()
   //  key bytes    : char[internal_key.size()]
@@ -496,6 +560,7 @@ bool MemTable::Add(SequenceNumber s, ValueType type,
                                internal_key_size + VarintLength(val_size) +
                                val_size;
   char* buf = nullptr;
+  assert(pending == nullptr || type != kTypeRangeDeletion);
   std::unique_ptr<MemTableRep>& table =
       type == kTypeRangeDeletion ? range_del_table_ : table_;
   KeyHandle handle = table->Allocate(encoded_len, &buf);
@@ -513,9 +578,11 @@ bool MemTable::Add(SequenceNumber s, ValueType type,
   size_t ts_sz = GetInternalKeyComparator().user_comparator()->timestamp_size();
 
   if (!allow_concurrent) {
-    // Extract prefix for insert with hint.
-    if (insert_with_hint_prefix_extractor_ != nullptr &&
-        insert_with_hint_prefix_extractor_->InDomain(key_slice)) {
+    if (pending != nullptr) {
+      pending->push_back(handle);
+    } else if (insert_with_hint_prefix_extractor_ != nullptr &&
+               insert_with_hint_prefix_extractor_->InDomain(key_slice)) {
+      // Extract prefix for insert with hint.
       Slice prefix = insert_with_hint_prefix_extractor_->Transform(key_slice);
       bool res = table->InsertKeyWithHint(handle, &insert_hints_[prefix]);
       if (UNLIKELY(!res)) {
@@ -561,11 +628,15 @@ bool MemTable::Add(SequenceNumber s, ValueType type,
     assert(post_process_info == nullptr);
     UpdateFlushState();
   } else {
-    bool res = (hint == nullptr)
-                   ? table->InsertKeyConcurrently(handle)
-                   : table->InsertKeyWithHintConcurrently(handle, hint);
-    if (UNLIKELY(!res)) {
-      return res;
+    if (pending != nullptr) {
+      pending->push_back(handle);
+    } else {
+      bool res = (hint == nullptr)
+                     ? table->InsertKeyConcurrently(handle)
+                     : table->InsertKeyWithHintConcurrently(handle, hint);
+      if (UNLIKELY(!res)) {
+        return res;
+      }
     }
 
     assert(post_process_info != nullptr);
@@ -602,6 +673,19 @@ bool MemTable::Add(SequenceNumber s, ValueType type,
   return true;
 }
 
+bool MemTable::InsertPending(std::vector<KeyHandle>* pending,
+                             bool allow_concurrent) {
+  if (pending->empty()) {
+    return true;
+  }
+  bool res = allow_concurrent
+                 ? table_->InsertKeysConcurrently(pending->data(),
+                                                  pending->size())
+                 : table_->InsertKeys(pending->data(), pending->size());
+  pending->clear();
+  return res;
+}
+
 // Callback from MemTable::Get()
 namespace {
 
@@ -764,10 +848,17 @@ static bool SaveValue(void* arg, const char* entry) {
           *(s->found_final_value) = true;
           return false;
         }
+        if (s->inplace_update_support) {
+          // The operand may be combined inplace, see CombineMergeOperand()
+          s->mem->GetLock(s->key->user_key())->ReadLock();
+        }
         Slice v = GetLengthPrefixedSlice(key_ptr + key_length);
         *(s->merge_in_progress) = true;
         merge_context->PushOperand(
             v, s->inplace_update_support == false /* operand_pinned */);
+        if (s->inplace_update_support) {
+          s->mem->GetLock(s->key->user_key())->ReadUnlock();
+        }
         if (s->do_merge && merge_operator->ShouldMerge(
                                merge_context->GetOperandsDirectionBackward())) {
           *(s->status) = MergeHelper::TimedFullMerge(
@@ -809,7 +900,25 @@ bool MemTable::Get(const LookupKey& key, std::string* value,
     // Avoiding recording stats for speed.
     return false;
   }
-  PERF_TIMER_GUARD(get_from_memtable_time);
+  if (InstrumentationEnabled(nullptr)) {
+    return GetImpl<true>(key, value, timestamp, s, merge_context,
+                         max_covering_tombstone_seq, seq, read_opts, callback,
+                         is_blob_index, do_merge);
+  }
+  return GetImpl<false>(key, value, timestamp, s, merge_context,
+                        max_covering_tombstone_seq, seq, read_opts, callback,
+                        is_blob_index, do_merge);
+}
+
+template <bool kInstrumented>
+bool MemTable::GetImpl(const LookupKey& key, std::string* value,
+                       std::string* timestamp, Status* s,
+                       MergeContext* merge_context,
+                       SequenceNumber* max_covering_tombstone_seq,
+                       SequenceNumber* seq, const ReadOptions& read_opts,
+                       ReadCallback* callback, bool* is_blob_index,
+                       bool do_merge) {
+  PERF_TIMER_GUARD_IF(kInstrumented, get_from_memtable_time);
 
   std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
       NewRangeTombstoneIterator(read_opts,
@@ -841,11 +950,11 @@ bool MemTable::Get(const LookupKey& key, std::string* value,
 
   if (bloom_filter_ && !may_contain) {
     // iter is null if prefix bloom says the key does not exist
-    PERF_COUNTER_ADD(bloom_memtable_miss_count, 1);
+    PERF_COUNTER_ADD_IF(kInstrumented, bloom_memtable_miss_count, 1);
     *seq = kMaxSequenceNumber;
   } else {
     if (bloom_filter_) {
-      PERF_COUNTER_ADD(bloom_memtable_hit_count, 1);
+      PERF_COUNTER_ADD_IF(kInstrumented, bloom_memtable_hit_count, 1);
     }
     GetFromTable(key, *max_covering_tombstone_seq, do_merge, callback,
                  is_blob_index, value, timestamp, s, merge_context, seq,
@@ -856,7 +965,7 @@ bool MemTable::Get(const LookupKey& key, std::string* value,
   if (!found_final_value && merge_in_progress) {
     *s = Status::MergeInProgress();
   }
-  PERF_COUNTER_ADD(get_from_memtable_count, 1);
+  PERF_COUNTER_ADD_IF(kInstrumented, get_from_memtable_count, 1);
   return found_final_value;
 }
 
@@ -868,6 +977,21 @@ void MemTable::GetFromTable(const LookupKey& key,
                             MergeContext* merge_context, SequenceNumber* seq,
                             bool* found_final_value, bool* merge_in_progress) {
   Saver saver;
+  InitSaver(&saver, key, max_covering_tombstone_seq, do_merge, callback,
+            is_blob_index, value, timestamp, s, merge_context,
+            found_final_value, merge_in_progress);
+  table_->Get(key, &saver, SaveValue);
+  *seq = saver.seq;
+}
+
+void MemTable::InitSaver(void* arg, const LookupKey& key,
+                         SequenceNumber max_covering_tombstone_seq,
+                         bool do_merge, ReadCallback* callback,
+                         bool* is_blob_index, std::string* value,
+                         std::string* timestamp, Status* s,
+                         MergeContext* merge_context, bool* found_final_value,
+                         bool* merge_in_progress) {
+  Saver& saver = *static_cast<Saver*>(arg);
   saver.status = s;
   saver.found_final_value = found_final_value;
   saver.merge_in_progress = merge_in_progress;
@@ -887,8 +1011,6 @@ void MemTable::GetFromTable(const LookupKey& key,
   saver.is_blob_index = is_blob_index;
   saver.do_merge = do_merge;
   saver.allow_data_in_errors = moptions_.allow_data_in_errors;
-  table_->Get(key, &saver, SaveValue);
-  *seq = saver.seq;
 }
 
 void MemTable::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
@@ -930,10 +1052,17 @@ void MemTable::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
       idx++;
     }
   }
+  // The table lookups of the keys the bloom filter left interleave, to
+  // overlap their cache misses
+  std::array<Saver, MultiGetContext::MAX_BATCH_SIZE> savers;
+  std::array<const LookupKey*, MultiGetContext::MAX_BATCH_SIZE> lkeys;
+  std::array<void*, MultiGetContext::MAX_BATCH_SIZE> saver_args;
+  std::array<bool, MultiGetContext::MAX_BATCH_SIZE> found_final_values;
+  std::array<bool, MultiGetContext::MAX_BATCH_SIZE> merges_in_progress;
+  size_t num_keys = 0;
   for (auto iter = temp_range.begin(); iter != temp_range.end(); ++iter) {
-    SequenceNumber seq = kMaxSequenceNumber;
-    bool found_final_value{false};
-    bool merge_in_progress = iter->s->IsMergeInProgress();
+    found_final_values[num_keys] = false;
+    merges_in_progress[num_keys] = iter->s->IsMergeInProgress();
     std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
         NewRangeTombstoneIterator(
             read_options, GetInternalKeySeqno(iter->lkey->internal_key())));
@@ -942,10 +1071,23 @@ void MemTable::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
           iter->max_covering_tombstone_seq,
           range_del_iter->MaxCoveringTombstoneSeqnum(iter->lkey->user_key()));
     }
-    GetFromTable(*(iter->lkey), iter->max_covering_tombstone_seq, true,
-                 callback, is_blob, iter->value->GetSelf(), iter->timestamp,
-                 iter->s, &(iter->merge_context), &seq, &found_final_value,
-                 &merge_in_progress);
+    InitSaver(&savers[num_keys], *(iter->lkey),
+              iter->max_covering_tombstone_seq, true, callback, is_blob,
+              iter->value->GetSelf(), iter->timestamp, iter->s,
+              &(iter->merge_context), &found_final_values[num_keys],
+              &merges_in_progress[num_keys]);
+    lkeys[num_keys] = iter->lkey;
+    saver_args[num_keys] = &savers[num_keys];
+    num_keys++;
+  }
+  table_->MultiGet(num_keys, lkeys.data(), saver_args.data(), SaveValue);
+
+  size_t i = 0;
+  for (auto iter = temp_range.begin(); iter != temp_range.end(); ++iter) {
+    assert(i < num_keys);
+    const bool found_final_value = found_final_values[i];
+    const bool merge_in_progress = merges_in_progress[i];
+    i++;
 
     if (!found_final_value && merge_in_progress) {
       *(iter->s) = Status::MergeInProgress();
@@ -1107,6 +1249,61 @@ bool MemTable::UpdateCallback(SequenceNumber seq,
   return false;
 }
 
+bool MemTable::CombineMergeOperand(SequenceNumber seq, const Slice& key,
+                                   const Slice& operand) {
+  assert(moptions_.inplace_update_support);
+  if (moptions_.merge_operator == nullptr) {
+    return false;
+  }
+  LookupKey lkey(key, seq);
+  Slice memkey = lkey.memtable_key();
+
+  std::unique_ptr<MemTableRep::Iterator> iter(
+      table_->GetDynamicPrefixIterator());
+  iter->Seek(lkey.internal_key(), memkey.data());
+  if (!iter->Valid()) {
+    return false;
+  }
+  // Same entry format and checks as in UpdateCallback()
+  const char* entry = iter->key();
+  uint32_t key_length = 0;
+  const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
+  if (!comparator_.comparator.user_comparator()->Equal(
+          Slice(key_ptr, key_length - 8), lkey.user_key())) {
+    return false;
+  }
+  const uint64_t tag = DecodeFixed64(key_ptr + key_length - 8);
+  ValueType type;
+  uint64_t unused;
+  UnPackSequenceAndType(tag, &unused, &type);
+  if (type != kTypeMerge) {
+    return false;
+  }
+  Slice prev_operand = GetLengthPrefixedSlice(key_ptr + key_length);
+  uint32_t prev_size = static_cast<uint32_t>(prev_operand.size());
+
+  // Writers are serialized, so prev_operand cannot change meanwhile
+  std::string new_operand;
+  if (!moptions_.merge_operator->PartialMerge(key, prev_operand, operand,
+                                              &new_operand,
+                                              moptions_.info_log) ||
+      new_operand.size() > prev_size) {
+    return false;
+  }
+  uint32_t new_size = static_cast<uint32_t>(new_operand.size());
+
+  char* prev_buffer = const_cast<char*>(prev_operand.data());
+  WriteLock wl(GetLock(lkey.user_key()));
+  char* p = prev_buffer;
+  if (new_size < prev_size) {
+    p = EncodeVarint32(const_cast<char*>(key_ptr) + key_length, new_size);
+  }
+  memcpy(p, new_operand.data(), new_size);
+  RecordTick(moptions_.statistics, NUMBER_MERGE_OPERANDS_COMBINED);
+  UpdateFlushState();
+  return true;
+}
+
 size_t MemTable::CountSuccessiveMergeEntries(const LookupKey& key) {
   Slice memkey = key.memtable_key();
 
@@ -1151,6 +1348,15 @@ void MemTableRep::Get(const LookupKey& k, void* callback_args,
   }
 }
 
+void MemTableRep::MultiGet(size_t num_keys, const LookupKey* const* keys,
+                           void* const* callback_args,
+                           bool (*callback_func)(void* arg,
+                                                 const char* entry)) {
+  for (size_t i = 0; i < num_keys; i++) {
+    Get(*keys[i], callback_args[i], callback_func);
+  }
+}
+
 void MemTable::RefLogContainingPrepSection(uint64_t log) {
   assert(log > 0);
   auto cur = min_prep_log_referenced_.load();
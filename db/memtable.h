@@ -51,6 +51,7 @@ struct ImmutableMemTableOptions {
                                    Slice delta_value,
                                    std::string* merged_value);
   size_t max_successive_merges;
+  bool preaggregate_merge_operands;
   Statistics* statistics;
   MergeOperator* merge_operator;
   Logger* info_log;
@@ -84,11 +85,18 @@ class MemTable {
  public:
   struct KeyComparator : public MemTableRep::KeyComparator {
     const InternalKeyComparator comparator;
-    explicit KeyComparator(const InternalKeyComparator& c) : comparator(c) { }
+    // With BytewiseComparator(), user keys are compared inline, 16 bytes at a
+    // time where SSE2 is available, instead of through the virtual Compare()
+    const bool bytewise;
+    explicit KeyComparator(const InternalKeyComparator& c)
+        : comparator(c), bytewise(c.user_comparator() == BytewiseComparator()) {}
     virtual int operator()(const char* prefix_len_key1,
                            const char* prefix_len_key2) const override;
     virtual int operator()(const char* prefix_len_key,
                            const DecodedType& key) const override;
+
+   private:
+    int CompareKeySeq(const Slice& a, const Slice& b) const;
   };
 
   // MemTables are reference counted.  The initial reference count
@@ -184,10 +192,22 @@ class MemTable {
   //
   // Returns false if MemTableRepFactory::CanHandleDuplicatedKey() is true and
   // the <key, seq> already exists.
+  //
+  // If pending is not null, the entry is encoded and accounted for but its
+  // handle is appended to *pending instead of being inserted into the rep, and
+  // the entry is not visible until InsertPending(). Not for range deletions.
   bool Add(SequenceNumber seq, ValueType type, const Slice& key,
            const Slice& value, bool allow_concurrent = false,
            MemTablePostProcessInfo* post_process_info = nullptr,
-           void** hint = nullptr);
+           void** hint = nullptr, std::vector<KeyHandle>* pending = nullptr);
+
+  // Inserts the entries Add() left in *pending into the rep at once, which
+  // lets the rep sort them and insert runs of nearby keys cheaply, and clears
+  // *pending. allow_concurrent must match the Add() calls.
+  //
+  // Returns false if MemTableRepFactory::CanHandleDuplicatedKey() is true and
+  // any <key, seq> already exists.
+  bool InsertPending(std::vector<KeyHandle>* pending, bool allow_concurrent);
 
   // Used to Get value associated with key or Get Merge Operands associated
   // with key.
@@ -269,6 +289,21 @@ class MemTable {
                       const Slice& key,
                       const Slice& delta);
 
+  // If the latest entry for key is a merge operand, attempts to combine
+  // operand into it inplace, else returns false
+  // Pseudocode
+  //   if key exists in current memtable && prev_value is of type kTypeMerge
+  //     new_value = PartialMerge(prev_value, operand)
+  //     if sizeof(new_value) <= sizeof(prev_value)
+  //       update inplace
+  //       return true
+  //   return false
+  //
+  // REQUIRES: inplace_update_support, and external synchronization to
+  // prevent simultaneous operations on the same MemTable.
+  bool CombineMergeOperand(SequenceNumber seq, const Slice& key,
+                           const Slice& operand);
+
   // Returns the number of successive merge entries starting from the newest
   // entry for the key up to the last non-merge entry or last entry for the
   // key in the memtable.
@@ -301,6 +336,15 @@ class MemTable {
     return num_deletes_.load(std::memory_order_relaxed);
   }
 
+  // Replaces *entries with about target_sample_size distinct entries of the
+  // memtable picked at random, none if the memtable representation does not
+  // support sampling. See MemTableRep::UniqueRandomSample().
+  // REQUIRES: the memtable is immutable
+  void UniqueRandomSample(uint64_t target_sample_size,
+                          std::unordered_set<const char*>* entries) {
+    table_->UniqueRandomSample(num_entries(), target_sample_size, entries);
+  }
+
   uint64_t get_data_size() const {
     return data_size_.load(std::memory_order_relaxed);
   }
@@ -325,6 +369,10 @@ class MemTable {
   // operations on the same MemTable (unless this Memtable is immutable).
   bool IsEmpty() const { return first_seqno_ == 0; }
 
+  bool IsRangeDelTableEmpty() const {
+    return is_range_del_table_empty_.load(std::memory_order_relaxed);
+  }
+
   // Returns the sequence number of the first element that was inserted
   // into the memtable.
   // REQUIRES: external synchronization to prevent simultaneous
@@ -379,6 +427,10 @@ class MemTable {
     mem_tracker_.DoneAllocating();
   }
 
+  // Migrates the memory of an immutable memtable to the NUMA node. Returns
+  // the bytes moved. Readers may use the memtable meanwhile.
+  size_t MoveToNumaNode(int node) { return arena_.MoveToNumaNode(node); }
+
   // Notify the underlying storage that all data it contained has been
   // persisted.
   // REQUIRES: external synchronization to prevent simultaneous
@@ -541,12 +593,28 @@ class MemTable {
 
   void UpdateOldestKeyTime();
 
+  // Get(), with the perf context instrumentation compiled in or out
+  template <bool kInstrumented>
+  bool GetImpl(const LookupKey& key, std::string* value,
+               std::string* timestamp, Status* s, MergeContext* merge_context,
+               SequenceNumber* max_covering_tombstone_seq, SequenceNumber* seq,
+               const ReadOptions& read_opts, ReadCallback* callback,
+               bool* is_blob_index, bool do_merge);
+
   void GetFromTable(const LookupKey& key,
                     SequenceNumber max_covering_tombstone_seq, bool do_merge,
                     ReadCallback* callback, bool* is_blob_index,
                     std::string* value, std::string* timestamp, Status* s,
                     MergeContext* merge_context, SequenceNumber* seq,
                     bool* found_final_value, bool* merge_in_progress);
+
+  // Sets up the Saver arg points to for a lookup of key in table_
+  void InitSaver(void* arg, const LookupKey& key,
+                 SequenceNumber max_covering_tombstone_seq, bool do_merge,
+                 ReadCallback* callback, bool* is_blob_index,
+                 std::string* value, std::string* timestamp, Status* s,
+                 MergeContext* merge_context, bool* found_final_value,
+                 bool* merge_in_progress);
 };
 
 extern const char* EncodeKey(std::string* scratch, const Slice& target);
@@ -0,0 +1,326 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/options_advisor.h"
+
+#include <algorithm>
+
+#include "db/column_family.h"
+#include "db/db_impl/db_impl.h"
+#include "db/internal_stats.h"
+#include "logging/event_logger.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/statistics.h"
+#include "rocksdb/table.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+constexpr double OptionsAdvisor::kCacheMissRatioThreshold;
+const uint64_t OptionsAdvisor::kMinCacheLookups;
+const uint64_t OptionsAdvisor::kFreezeRuns;
+const uint32_t OptionsAdvisor::kDBScope;
+
+OptionsAdvisor::OptionsAdvisor(DBImpl* db, EventLogger* event_logger)
+    : db_(db),
+      event_logger_(event_logger),
+      apply_changes_(db->immutable_db_options().options_advisor_apply_changes),
+      max_change_factor_(std::max(
+          db->immutable_db_options().options_advisor_max_change_factor, 1.0)) {
+  // The statistics may be shared with other DBs, so only count from here
+  Statistics* stats = db->immutable_db_options().statistics.get();
+  if (stats != nullptr) {
+    last_sample_.cache_hits = stats->getTickerCount(BLOCK_CACHE_HIT);
+    last_sample_.cache_misses = stats->getTickerCount(BLOCK_CACHE_MISS);
+    last_sample_.zenfs_gc_bytes = stats->getTickerCount(ZENFS_GC_BYTES_COPIED);
+    last_sample_.bytes_written = stats->getTickerCount(FLUSH_WRITE_BYTES) +
+                                 stats->getTickerCount(COMPACT_WRITE_BYTES);
+  }
+}
+
+OptionsAdvisor::Sample OptionsAdvisor::TakeSample() {
+  Sample sample;
+  {
+    InstrumentedMutexLock l(&db_->mutex_);
+    for (auto cfd : *db_->versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped() || !cfd->initialized()) {
+        continue;
+      }
+      const InternalStats* istats = cfd->internal_stats();
+      const MutableCFOptions* mopts = cfd->GetLatestMutableCFOptions();
+      CFSample& cf = sample.cfs[cfd->GetID()];
+      cf.name = cfd->GetName();
+      cf.l0_stalls =
+          istats->GetCFStats(InternalStats::L0_FILE_COUNT_LIMIT_SLOWDOWNS) +
+          istats->GetCFStats(InternalStats::L0_FILE_COUNT_LIMIT_STOPS);
+      cf.compaction_stalls =
+          istats->GetCFStats(
+              InternalStats::LOCKED_L0_FILE_COUNT_LIMIT_SLOWDOWNS) +
+          istats->GetCFStats(InternalStats::LOCKED_L0_FILE_COUNT_LIMIT_STOPS) +
+          istats->GetCFStats(
+              InternalStats::PENDING_COMPACTION_BYTES_LIMIT_SLOWDOWNS) +
+          istats->GetCFStats(
+              InternalStats::PENDING_COMPACTION_BYTES_LIMIT_STOPS);
+      cf.level_compaction =
+          cfd->ioptions()->compaction_style == kCompactionStyleLevel;
+      cf.level0_file_num_compaction_trigger =
+          mopts->level0_file_num_compaction_trigger;
+      cf.level0_slowdown_writes_trigger = mopts->level0_slowdown_writes_trigger;
+      cf.level0_stop_writes_trigger = mopts->level0_stop_writes_trigger;
+      cf.max_bytes_for_level_base = mopts->max_bytes_for_level_base;
+      cf.l0_size_at_compaction =
+          static_cast<uint64_t>(mopts->write_buffer_size) *
+          std::max(cfd->ioptions()->min_write_buffer_number_to_merge, 1) *
+          std::max(mopts->level0_file_num_compaction_trigger, 1);
+      if (cfd->GetID() == 0) {
+        const TableFactory* table_factory = cfd->ioptions()->table_factory;
+        const auto* table_options =
+            table_factory->GetOptions<BlockBasedTableOptions>();
+        if (table_options != nullptr && !table_options->no_block_cache) {
+          sample.block_cache = table_options->block_cache;
+        }
+      }
+    }
+  }
+  sample.max_background_jobs = db_->GetDBOptions().max_background_jobs;
+
+  Statistics* stats = db_->immutable_db_options().statistics.get();
+  if (stats != nullptr) {
+    sample.cache_hits = stats->getTickerCount(BLOCK_CACHE_HIT);
+    sample.cache_misses = stats->getTickerCount(BLOCK_CACHE_MISS);
+    sample.zenfs_gc_bytes = stats->getTickerCount(ZENFS_GC_BYTES_COPIED);
+    sample.bytes_written = stats->getTickerCount(FLUSH_WRITE_BYTES) +
+                           stats->getTickerCount(COMPACT_WRITE_BYTES);
+  }
+  return sample;
+}
+
+OptionsAdvisor::Signals OptionsAdvisor::GetSignals(
+    const Sample& sample) const {
+  Signals signals;
+  for (const auto& entry : sample.cfs) {
+    const CFSample& cf = entry.second;
+    uint64_t l0_stalls = cf.l0_stalls;
+    uint64_t compaction_stalls = cf.compaction_stalls;
+    auto last = last_sample_.cfs.find(entry.first);
+    if (last != last_sample_.cfs.end()) {
+      l0_stalls -= last->second.l0_stalls;
+      compaction_stalls -= last->second.compaction_stalls;
+    }
+    signals.l0_stalls[entry.first] = l0_stalls;
+    signals.write_stalls[entry.first] = l0_stalls + compaction_stalls;
+    signals.compaction_stalls += compaction_stalls;
+  }
+  uint64_t misses = sample.cache_misses - last_sample_.cache_misses;
+  signals.cache_lookups = sample.cache_hits - last_sample_.cache_hits + misses;
+  if (signals.cache_lookups > 0) {
+    signals.cache_miss_ratio =
+        static_cast<double>(misses) / signals.cache_lookups;
+  }
+  signals.zenfs_gc_bytes = sample.zenfs_gc_bytes - last_sample_.zenfs_gc_bytes;
+  signals.bytes_written = sample.bytes_written - last_sample_.bytes_written;
+  return signals;
+}
+
+double OptionsAdvisor::SignalValue(const Change& change,
+                                   const Signals& signals) const {
+  switch (change.signal) {
+    case Signal::kWriteStalls: {
+      auto it = signals.write_stalls.find(change.cf_id);
+      return it != signals.write_stalls.end()
+                 ? static_cast<double>(it->second)
+                 : 0.0;
+    }
+    case Signal::kCompactionStalls:
+      return static_cast<double>(signals.compaction_stalls);
+    case Signal::kCacheMissRatio:
+      return signals.cache_miss_ratio;
+  }
+  return 0.0;
+}
+
+void OptionsAdvisor::Recommend(const Sample& sample, const Signals& signals,
+                               std::vector<Change>* changes) const {
+  for (const auto& entry : sample.cfs) {
+    const CFSample& cf = entry.second;
+    uint64_t l0_stalls = signals.l0_stalls.at(entry.first);
+
+    if (l0_stalls > 0 && cf.level0_slowdown_writes_trigger > 0) {
+      uint64_t trigger =
+          static_cast<uint64_t>(cf.level0_slowdown_writes_trigger);
+      Change change;
+      change.cf_id = entry.first;
+      change.cf_name = cf.name;
+      change.option = "level0_slowdown_writes_trigger";
+      change.old_value = trigger;
+      change.new_value = trigger + std::max<uint64_t>(trigger / 4, 1);
+      change.limit = static_cast<uint64_t>(
+          std::max(cf.level0_stop_writes_trigger - 1, 1));
+      change.signal = Signal::kWriteStalls;
+      change.reason = ToString(l0_stalls) + " L0 write stalls";
+      changes->push_back(change);
+    }
+
+    if (cf.level_compaction && cf.max_bytes_for_level_base > 0 &&
+        (cf.max_bytes_for_level_base * 2 < cf.l0_size_at_compaction ||
+         cf.max_bytes_for_level_base > cf.l0_size_at_compaction * 2)) {
+      Change change;
+      change.cf_id = entry.first;
+      change.cf_name = cf.name;
+      change.option = "max_bytes_for_level_base";
+      change.old_value = cf.max_bytes_for_level_base;
+      change.new_value = cf.l0_size_at_compaction;
+      change.limit = UINT64_MAX;
+      change.signal = Signal::kWriteStalls;
+      change.reason = "L0 compacted at " +
+                      ToString(cf.l0_size_at_compaction) + " bytes";
+      changes->push_back(change);
+    }
+  }
+
+  if (signals.compaction_stalls > 0 && sample.max_background_jobs > 0) {
+    uint64_t jobs = static_cast<uint64_t>(sample.max_background_jobs);
+    Change change;
+    change.cf_id = kDBScope;
+    change.option = "max_background_jobs";
+    change.old_value = jobs;
+    change.new_value = jobs + 1;
+    change.limit = UINT64_MAX;
+    change.signal = Signal::kCompactionStalls;
+    change.reason = ToString(signals.compaction_stalls) +
+                    " write stalls on compaction";
+    changes->push_back(change);
+  }
+
+  if (sample.block_cache != nullptr &&
+      signals.cache_lookups >= kMinCacheLookups &&
+      signals.cache_miss_ratio > kCacheMissRatioThreshold) {
+    uint64_t capacity = sample.block_cache->GetCapacity();
+    if (sample.block_cache->GetUsage() >= capacity / 10 * 9) {
+      Change change;
+      change.cf_id = kDBScope;
+      change.option = "block_cache_capacity";
+      change.old_value = capacity;
+      change.new_value = capacity + std::max<uint64_t>(capacity / 8, 1);
+      change.limit = UINT64_MAX;
+      change.signal = Signal::kCacheMissRatio;
+      change.reason =
+          "block cache full with miss ratio " +
+          ToString(static_cast<int>(signals.cache_miss_ratio * 100)) + "%";
+      changes->push_back(change);
+    }
+  }
+}
+
+bool OptionsAdvisor::Bound(Change* change) {
+  uint64_t initial =
+      initial_values_.emplace(Key(*change), change->old_value).first->second;
+  uint64_t low = std::max<uint64_t>(
+      static_cast<uint64_t>(static_cast<double>(initial) / max_change_factor_),
+      1);
+  double high = static_cast<double>(initial) * max_change_factor_;
+  uint64_t limit = change->limit;
+  if (high < static_cast<double>(limit)) {
+    limit = static_cast<uint64_t>(high);
+  }
+  change->new_value = std::min(std::max(change->new_value, low), limit);
+  return change->new_value != change->old_value;
+}
+
+Status OptionsAdvisor::Apply(const Change& change, uint64_t value) {
+  if (change.option == "block_cache_capacity") {
+    block_cache_->SetCapacity(static_cast<size_t>(value));
+    return Status::OK();
+  }
+  std::unordered_map<std::string, std::string> options{
+      {change.option, ToString(value)}};
+  if (change.cf_id == kDBScope) {
+    return db_->SetDBOptions(options);
+  }
+  std::unique_ptr<ColumnFamilyHandle> cfh =
+      db_->GetColumnFamilyHandleUnlocked(change.cf_id);
+  if (cfh == nullptr) {
+    return Status::InvalidArgument("Column family dropped", change.cf_name);
+  }
+  return db_->SetOptions(cfh.get(), options);
+}
+
+void OptionsAdvisor::LogEvent(const Change& change, uint64_t old_value,
+                              uint64_t new_value, const char* action,
+                              const std::string& reason) {
+  auto stream = event_logger_->Log();
+  stream << "event"
+         << "options_advisor"
+         << "action" << action;
+  if (change.cf_id != kDBScope) {
+    stream << "cf_name" << change.cf_name.c_str();
+  }
+  stream << "option" << change.option.c_str() << "old_value" << old_value
+         << "new_value" << new_value << "reason" << reason.c_str();
+}
+
+void OptionsAdvisor::Run() {
+  runs_++;
+  Sample sample = TakeSample();
+  Signals signals = GetSignals(sample);
+  block_cache_ = sample.block_cache;
+
+  // Roll back the changes that made things worse
+  for (const Change& change : applied_) {
+    double value = SignalValue(change, signals);
+    if (value <= change.signal_value) {
+      continue;
+    }
+    Status s = Apply(change, change.old_value);
+    LogEvent(change, change.new_value, change.old_value,
+             s.ok() ? "rolled_back" : "rollback_failed",
+             s.ok() ? "signal up from " + ToString(change.signal_value) +
+                          " to " + ToString(value)
+                    : s.ToString());
+    frozen_until_[Key(change)] = runs_ + kFreezeRuns;
+  }
+  applied_.clear();
+
+  std::vector<Change> changes;
+  Recommend(sample, signals, &changes);
+  for (Change& change : changes) {
+    auto frozen = frozen_until_.find(Key(change));
+    if (frozen != frozen_until_.end()) {
+      if (runs_ <= frozen->second) {
+        continue;
+      }
+      frozen_until_.erase(frozen);
+    }
+    if (!Bound(&change)) {
+      continue;
+    }
+    if (change.option == "max_background_jobs" && signals.zenfs_gc_bytes > 0 &&
+        signals.zenfs_gc_bytes * 2 >= signals.bytes_written) {
+      LogEvent(change, change.old_value, change.new_value, "held_back",
+               "ZenFS GC copied " + ToString(signals.zenfs_gc_bytes) +
+                   " bytes for " + ToString(signals.bytes_written) +
+                   " written");
+      continue;
+    }
+    if (!apply_changes_) {
+      LogEvent(change, change.old_value, change.new_value, "recommended",
+               change.reason);
+      continue;
+    }
+    Status s = Apply(change, change.new_value);
+    if (s.ok()) {
+      change.signal_value = SignalValue(change, signals);
+      applied_.push_back(change);
+      LogEvent(change, change.old_value, change.new_value, "applied",
+               change.reason);
+    } else {
+      LogEvent(change, change.old_value, change.new_value, "apply_failed",
+               s.ToString());
+    }
+  }
+  last_sample_ = std::move(sample);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
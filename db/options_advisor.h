@@ -0,0 +1,155 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Cache;
+class DBImpl;
+class EventLogger;
+
+// Tunes the options of a DB online, from the statistics sampled every
+// options_advisor_period_sec:
+//
+// * L0 write stalls in a column family raise its
+//   level0_slowdown_writes_trigger, below level0_stop_writes_trigger.
+// * A max_bytes_for_level_base far from the size of L0 when compacted,
+//   write_buffer_size * min_write_buffer_number_to_merge *
+//   level0_file_num_compaction_trigger, is moved to it, with level style
+//   compaction.
+// * Write stalls while compaction can not keep up, on pending compaction
+//   bytes or on L0 files with an L0 compaction running, raise
+//   max_background_jobs, unless ZenFS garbage collection already copies as
+//   much as half the bytes written, as more compactions would only add to it.
+// * A full block cache of the default column family with a miss ratio above
+//   kCacheMissRatioThreshold grows.
+//
+// Each change is logged as an "options_advisor" event, and with
+// options_advisor_apply_changes applied. The options stay within
+// options_advisor_max_change_factor of their values when first sampled. An
+// applied change is rolled back when the signal it was made for, the write
+// stalls or the cache miss ratio, got worse over the next period, and the
+// option is then left alone for kFreezeRuns periods.
+//
+// Not thread-safe, only run by the periodic work scheduler.
+class OptionsAdvisor {
+ public:
+  static constexpr double kCacheMissRatioThreshold = 0.1;
+  // Fewer block cache lookups in a period do not give a miss ratio
+  static const uint64_t kMinCacheLookups = 1000;
+  static const uint64_t kFreezeRuns = 10;
+
+  OptionsAdvisor(DBImpl* db, EventLogger* event_logger);
+
+  // No copying allowed
+  OptionsAdvisor(const OptionsAdvisor&) = delete;
+  void operator=(const OptionsAdvisor&) = delete;
+
+  // REQUIRES: DB mutex not held
+  void Run();
+
+ private:
+  // A change to a column family option, or to a DB wide one with
+  // kDBScope as the column family ID
+  static const uint32_t kDBScope = UINT32_MAX;
+
+  enum class Signal {
+    kWriteStalls,
+    kCompactionStalls,
+    kCacheMissRatio,
+  };
+
+  struct CFSample {
+    std::string name;
+    uint64_t l0_stalls = 0;
+    uint64_t compaction_stalls = 0;
+    bool level_compaction = false;
+    int level0_file_num_compaction_trigger = 0;
+    int level0_slowdown_writes_trigger = 0;
+    int level0_stop_writes_trigger = 0;
+    uint64_t max_bytes_for_level_base = 0;
+    uint64_t l0_size_at_compaction = 0;
+  };
+
+  // The counters are cumulative
+  struct Sample {
+    std::map<uint32_t, CFSample> cfs;
+    int max_background_jobs = 0;
+    std::shared_ptr<Cache> block_cache;
+    uint64_t cache_hits = 0;
+    uint64_t cache_misses = 0;
+    uint64_t zenfs_gc_bytes = 0;
+    uint64_t bytes_written = 0;
+  };
+
+  // Over the last period
+  struct Signals {
+    std::map<uint32_t, uint64_t> l0_stalls;
+    std::map<uint32_t, uint64_t> write_stalls;
+    uint64_t compaction_stalls = 0;
+    uint64_t cache_lookups = 0;
+    double cache_miss_ratio = 0.0;
+    uint64_t zenfs_gc_bytes = 0;
+    uint64_t bytes_written = 0;
+  };
+
+  struct Change {
+    uint32_t cf_id;
+    std::string cf_name;
+    std::string option;
+    uint64_t old_value;
+    uint64_t new_value;
+    // The upper bound besides the change factor
+    uint64_t limit;
+    Signal signal;
+    std::string reason;
+    // Of signal, when the change was made
+    double signal_value = 0.0;
+  };
+
+  Sample TakeSample();
+  Signals GetSignals(const Sample& sample) const;
+  double SignalValue(const Change& change, const Signals& signals) const;
+  void Recommend(const Sample& sample, const Signals& signals,
+                 std::vector<Change>* changes) const;
+
+  // Clamps change->new_value to the bounds. Returns false if that leaves
+  // the option as it is.
+  bool Bound(Change* change);
+
+  Status Apply(const Change& change, uint64_t value);
+  void LogEvent(const Change& change, uint64_t old_value, uint64_t new_value,
+                const char* action, const std::string& reason);
+
+  static std::string Key(const Change& change) {
+    return change.cf_name + "." + change.option;
+  }
+
+  DBImpl* const db_;
+  EventLogger* const event_logger_;
+  const bool apply_changes_;
+  const double max_change_factor_;
+  Sample last_sample_;
+  std::shared_ptr<Cache> block_cache_;
+  // Applied in the last run, to check for rollback
+  std::vector<Change> applied_;
+  // The values of the options when first sampled, by Key()
+  std::map<std::string, uint64_t> initial_values_;
+  // The run up to which an option rolled back is left alone, by Key()
+  std::map<std::string, uint64_t> frozen_until_;
+  uint64_t runs_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -33,9 +33,14 @@ class OutputValidator {
     return GetHash() == other_validator.GetHash();
   }
 
- private:
   uint64_t GetHash() const { return paranoid_hash_; }
 
+  // Sets the hash of a file whose keys were added elsewhere, e.g. by a
+  // CompactionService, for CompareValidator()
+  void SetHash(uint64_t hash) { paranoid_hash_ = hash; }
+
+ private:
+
   const InternalKeyComparator& icmp_;
   std::string prev_key_;
   uint64_t paranoid_hash_ = 0;
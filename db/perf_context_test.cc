@@ -17,6 +17,8 @@
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/perf_context.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/span_tracer.h"
+#include "rocksdb/statistics.h"
 #include "test_util/testharness.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
@@ -945,6 +947,146 @@ TEST_F(PerfContextTest, CPUTimer) {
     ASSERT_EQ(count, get_perf_context()->iter_seek_cpu_nanos);
   }
 }
+
+TEST_F(PerfContextTest, SpanTracerRingBuffer) {
+  SpanTracerOptions tracer_options;
+  tracer_options.capacity = 4;
+  tracer_options.sample_one_in = 2;
+  std::shared_ptr<SpanTracer> tracer = NewSpanTracer(tracer_options);
+  ASSERT_TRUE(tracer->ShouldSample(4));
+  ASSERT_FALSE(tracer->ShouldSample(5));
+
+  for (uint64_t i = 1; i <= 10; i++) {
+    SpanEvent event;
+    event.trace_id = i;
+    event.name = "step";
+    event.start_nanos = i * 1000;
+    event.duration_nanos = 1500;
+    tracer->Record(event);
+  }
+  // Only the newest spans are kept, oldest first
+  std::vector<SpanEvent> spans;
+  tracer->GetSpans(&spans);
+  ASSERT_EQ(4, spans.size());
+  for (size_t i = 0; i < spans.size(); i++) {
+    ASSERT_EQ(7 + i, spans[i].trace_id);
+    ASSERT_EQ(std::string("step"), spans[i].name);
+  }
+
+  std::string trace;
+  ASSERT_OK(tracer->ExportChromeTrace(&trace));
+  ASSERT_EQ(0, trace.find("{\"traceEvents\":["));
+  ASSERT_NE(std::string::npos,
+            trace.find("\"name\":\"step\",\"cat\":\"rocksdb\",\"ph\":\"X\","
+                       "\"ts\":10.000,\"dur\":1.500"));
+  ASSERT_NE(std::string::npos, trace.find("\"trace_id\":\"10\""));
+  ASSERT_EQ(std::string::npos, trace.find("\"trace_id\":\"6\""));
+}
+
+TEST_F(PerfContextTest, SpanTracerGet) {
+  DestroyDB(kDbName, Options());
+  std::shared_ptr<SpanTracer> tracer = NewSpanTracer();
+  Options options;
+  options.create_if_missing = true;
+  options.span_tracer = tracer;
+  DB* db_ptr;
+  ASSERT_OK(DB::Open(options, kDbName, &db_ptr));
+  std::unique_ptr<DB> db(db_ptr);
+  // Spans are recorded whatever the perf level
+  SetPerfLevel(PerfLevel::kDisable);
+
+  WriteOptions write_options;
+  ASSERT_OK(db->Put(write_options, "k1", "v1"));
+  write_options.trace_id = 7;
+  ASSERT_OK(db->Put(write_options, "k2", "v2"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+
+  get_perf_context()->Reset();
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "k1", &value));
+  ReadOptions read_options;
+  read_options.trace_id = 8;
+  ASSERT_OK(db->Get(read_options, "k2", &value));
+  ASSERT_EQ("v2", value);
+
+  std::vector<SpanEvent> spans;
+  tracer->GetSpans(&spans);
+  const SpanEvent* write = nullptr;
+  const SpanEvent* get = nullptr;
+  for (const auto& span : spans) {
+    if (std::string(span.name) == "Write") {
+      write = &span;
+    } else if (std::string(span.name) == "Get") {
+      get = &span;
+    }
+  }
+  ASSERT_NE(nullptr, write);
+  ASSERT_EQ(7, write->trace_id);
+  ASSERT_NE(nullptr, get);
+  ASSERT_EQ(8, get->trace_id);
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  // The steps of the Get are recorded within its span
+  bool found_file_lookup = false;
+  for (const auto& span : spans) {
+    if (span.trace_id != 8 || &span == get) {
+      continue;
+    }
+    ASSERT_GE(span.start_nanos, get->start_nanos);
+    ASSERT_LE(span.start_nanos + span.duration_nanos,
+              get->start_nanos + get->duration_nanos);
+    if (std::string(span.name) == "get_from_output_files_time") {
+      found_file_lookup = true;
+    }
+  }
+  ASSERT_TRUE(found_file_lookup);
+#endif  // ROCKSDB_SUPPORT_THREAD_LOCAL
+  ASSERT_EQ(0, get_perf_context()->get_from_output_files_time);
+}
+
+TEST_F(PerfContextTest, GetInstrumentationPolicy) {
+  DestroyDB(kDbName, Options());
+  Options options;
+  options.create_if_missing = true;
+  options.statistics = CreateDBStatistics();
+  DB* db_ptr;
+  ASSERT_OK(DB::Open(options, kDbName, &db_ptr));
+  std::unique_ptr<DB> db(db_ptr);
+  ASSERT_OK(db->Put(WriteOptions(), "k1", "v1"));
+  std::string value;
+
+  // Without perf context, the statistics are still recorded
+  SetPerfLevel(PerfLevel::kDisable);
+  get_perf_context()->Reset();
+  ASSERT_OK(db->Get(ReadOptions(), "k1", &value));
+  ASSERT_EQ("v1", value);
+  ASSERT_EQ(0, get_perf_context()->get_from_memtable_count);
+  ASSERT_EQ(0, get_perf_context()->get_read_bytes);
+  ASSERT_EQ(1, options.statistics->getTickerCount(MEMTABLE_HIT));
+  ASSERT_EQ(2, options.statistics->getTickerCount(BYTES_READ));
+
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  SetPerfLevel(PerfLevel::kEnableCount);
+  ASSERT_OK(db->Get(ReadOptions(), "k1", &value));
+  ASSERT_EQ(1, get_perf_context()->get_from_memtable_count);
+  ASSERT_EQ(2, get_perf_context()->get_read_bytes);
+  SetPerfLevel(PerfLevel::kDisable);
+#endif  // ROCKSDB_SUPPORT_THREAD_LOCAL
+
+  // Neither statistics nor perf context
+  db.reset();
+  options.statistics.reset();
+  ASSERT_OK(DB::Open(options, kDbName, &db_ptr));
+  db.reset(db_ptr);
+  get_perf_context()->Reset();
+  ASSERT_OK(db->Get(ReadOptions(), "k1", &value));
+  ASSERT_EQ("v1", value);
+  ASSERT_OK(db->Flush(FlushOptions()));
+  ASSERT_OK(db->Get(ReadOptions(), "k1", &value));
+  ASSERT_EQ("v1", value);
+  ASSERT_TRUE(db->Get(ReadOptions(), "k2", &value).IsNotFound());
+  ASSERT_EQ(0, get_perf_context()->get_from_memtable_count);
+  ASSERT_EQ(0, get_perf_context()->get_read_bytes);
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -12,12 +12,15 @@
 namespace ROCKSDB_NAMESPACE {
 
 PeriodicWorkScheduler::PeriodicWorkScheduler(Env* env) {
-  timer = std::unique_ptr<Timer>(new Timer(env));
+  timer = std::unique_ptr<TimerWheel>(new TimerWheel(env));
 }
 
 void PeriodicWorkScheduler::Register(DBImpl* dbi,
                                      unsigned int stats_dump_period_sec,
-                                     unsigned int stats_persist_period_sec) {
+                                     unsigned int stats_persist_period_sec,
+                                     unsigned int
+                                         block_cache_warmup_save_period_sec,
+                                     unsigned int options_advisor_period_sec) {
   static std::atomic<uint64_t> initial_delay(0);
   timer->Start();
   if (stats_dump_period_sec > 0) {
@@ -34,6 +37,22 @@ void PeriodicWorkScheduler::Register(DBImpl* dbi,
             static_cast<uint64_t>(stats_persist_period_sec) * kMicrosInSecond,
         static_cast<uint64_t>(stats_persist_period_sec) * kMicrosInSecond);
   }
+  if (block_cache_warmup_save_period_sec > 0) {
+    timer->Add([dbi]() { dbi->SaveBlockCacheWarmup(); },
+               GetTaskName(dbi, "save_bcw"),
+               static_cast<uint64_t>(block_cache_warmup_save_period_sec) *
+                   kMicrosInSecond,
+               static_cast<uint64_t>(block_cache_warmup_save_period_sec) *
+                   kMicrosInSecond);
+  }
+  if (options_advisor_period_sec > 0) {
+    timer->Add([dbi]() { dbi->RunOptionsAdvisor(); },
+               GetTaskName(dbi, "opt_adv"),
+               static_cast<uint64_t>(options_advisor_period_sec) *
+                   kMicrosInSecond,
+               static_cast<uint64_t>(options_advisor_period_sec) *
+                   kMicrosInSecond);
+  }
   timer->Add([dbi]() { dbi->FlushInfoLog(); },
              GetTaskName(dbi, "flush_info_log"),
              initial_delay.fetch_add(1) % kDefaultFlushInfoLogPeriodSec *
@@ -45,6 +64,8 @@ void PeriodicWorkScheduler::Unregister(DBImpl* dbi) {
   timer->Cancel(GetTaskName(dbi, "dump_st"));
   timer->Cancel(GetTaskName(dbi, "pst_st"));
   timer->Cancel(GetTaskName(dbi, "flush_info_log"));
+  timer->Cancel(GetTaskName(dbi, "save_bcw"));
+  timer->Cancel(GetTaskName(dbi, "opt_adv"));
   if (!timer->HasPendingTask()) {
     timer->Shutdown();
   }
@@ -80,7 +101,7 @@ PeriodicWorkTestScheduler* PeriodicWorkTestScheduler::Default(Env* env) {
     if (scheduler.timer.get() != nullptr &&
         scheduler.timer->TEST_GetPendingTaskNum() == 0) {
       scheduler.timer->Shutdown();
-      scheduler.timer.reset(new Timer(env));
+      scheduler.timer.reset(new TimerWheel(env));
     }
   }
   return &scheduler;
@@ -8,17 +8,19 @@
 #ifndef ROCKSDB_LITE
 
 #include "db/db_impl/db_impl.h"
-#include "util/timer.h"
+#include "util/timer_wheel.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 // PeriodicWorkScheduler is a singleton object, which is scheduling/running
-// DumpStats(), PersistStats(), and FlushInfoLog() for all DB instances. All DB
-// instances use the same object from `Default()`.
+// DumpStats(), PersistStats(), FlushInfoLog(), SaveBlockCacheWarmup() and
+// RunOptionsAdvisor() for all DB instances. All DB instances use the same
+// object from `Default()`.
 //
-// Internally, it uses a single threaded timer object to run the periodic work
-// functions. Timer thread will always be started since the info log flushing
-// cannot be disabled.
+// Internally, it uses a single threaded timer wheel to run the periodic work
+// functions, so that registering and unregistering the DB instances of a
+// process takes constant time. Timer thread will always be started since the
+// info log flushing cannot be disabled.
 class PeriodicWorkScheduler {
  public:
   static PeriodicWorkScheduler* Default();
@@ -30,7 +32,9 @@ class PeriodicWorkScheduler {
   PeriodicWorkScheduler& operator=(PeriodicWorkScheduler&&) = delete;
 
   void Register(DBImpl* dbi, unsigned int stats_dump_period_sec,
-                unsigned int stats_persist_period_sec);
+                unsigned int stats_persist_period_sec,
+                unsigned int block_cache_warmup_save_period_sec = 0,
+                unsigned int options_advisor_period_sec = 0);
 
   void Unregister(DBImpl* dbi);
 
@@ -41,7 +45,7 @@ class PeriodicWorkScheduler {
   static const uint64_t kDefaultFlushInfoLogPeriodSec = 10;
 
  protected:
-  std::unique_ptr<Timer> timer;
+  std::unique_ptr<TimerWheel> timer;
 
   explicit PeriodicWorkScheduler(Env* env);
 
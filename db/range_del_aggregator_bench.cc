@@ -54,12 +54,20 @@ DEFINE_int32(should_deletes_per_run, 1, "number of ShouldDelete calls per run");
 DEFINE_int32(add_tombstones_per_run, 1,
              "number of AddTombstones calls per run");
 
+DEFINE_bool(max_covering_lookups, false,
+            "also time point lookups of the max covering tombstone seqnum, "
+            "once per tombstone list as in one table file each, and once in "
+            "all lists merged as in a version's range tombstone index");
+
 namespace {
 
 struct Stats {
   uint64_t time_add_tombstones = 0;
   uint64_t time_first_should_delete = 0;
   uint64_t time_rest_should_delete = 0;
+  uint64_t time_per_list_max_covering = 0;
+  uint64_t time_merged_max_covering = 0;
+  uint64_t time_merge_lists = 0;
 };
 
 std::ostream& operator<<(std::ostream& os, const Stats& s) {
@@ -80,6 +88,19 @@ std::ostream& operator<<(std::ostream& os, const Stats& s) {
        << " us\n";
   }
 
+  if (FLAGS_max_covering_lookups) {
+    os << std::setw(25) << "MergeLists: "
+       << s.time_merge_lists / (FLAGS_num_runs * 1.0e3) << " us\n";
+    os << std::setw(25) << "MaxCovering (per list): "
+       << s.time_per_list_max_covering /
+              (FLAGS_should_deletes_per_run * FLAGS_num_runs * 1.0e3)
+       << " us\n";
+    os << std::setw(25) << "MaxCovering (merged): "
+       << s.time_merged_max_covering /
+              (FLAGS_should_deletes_per_run * FLAGS_num_runs * 1.0e3)
+       << " us\n";
+  }
+
   os.copyfmt(fmt_holder);
   return os;
 }
@@ -247,6 +268,48 @@ int main(int argc, char** argv) {
         stats.time_rest_should_delete += call_time;
       }
     }
+
+    if (FLAGS_max_covering_lookups) {
+      std::vector<ROCKSDB_NAMESPACE::PersistentRangeTombstone> all_tombstones;
+      for (const auto& persistent_range_tombstones :
+           all_persistent_range_tombstones) {
+        all_tombstones.insert(all_tombstones.end(),
+                              persistent_range_tombstones.begin(),
+                              persistent_range_tombstones.end());
+      }
+      ROCKSDB_NAMESPACE::StopWatchNano stop_watch_merge(
+          ROCKSDB_NAMESPACE::Env::Default(), true /* auto_start */);
+      ROCKSDB_NAMESPACE::FragmentedRangeTombstoneList merged_list(
+          ROCKSDB_NAMESPACE::MakeRangeDelIterator(all_tombstones), icmp);
+      stats.time_merge_lists += stop_watch_merge.ElapsedNanos();
+
+      for (int j = 0; j < FLAGS_should_deletes_per_run; j++) {
+        std::string key_string = ROCKSDB_NAMESPACE::Key(first_key + j);
+        ROCKSDB_NAMESPACE::SequenceNumber per_list_seq = 0;
+        ROCKSDB_NAMESPACE::StopWatchNano stop_watch_per_list(
+            ROCKSDB_NAMESPACE::Env::Default(), true /* auto_start */);
+        for (const auto& list : fragmented_range_tombstone_lists) {
+          if (list == nullptr) {
+            continue;
+          }
+          ROCKSDB_NAMESPACE::FragmentedRangeTombstoneIterator iter(
+              list.get(), icmp, ROCKSDB_NAMESPACE::kMaxSequenceNumber);
+          per_list_seq = std::max(per_list_seq,
+                                  iter.MaxCoveringTombstoneSeqnum(key_string));
+        }
+        stats.time_per_list_max_covering += stop_watch_per_list.ElapsedNanos();
+
+        ROCKSDB_NAMESPACE::StopWatchNano stop_watch_merged(
+            ROCKSDB_NAMESPACE::Env::Default(), true /* auto_start */);
+        ROCKSDB_NAMESPACE::FragmentedRangeTombstoneIterator iter(
+            &merged_list, icmp, ROCKSDB_NAMESPACE::kMaxSequenceNumber);
+        ROCKSDB_NAMESPACE::SequenceNumber merged_seq =
+            iter.MaxCoveringTombstoneSeqnum(key_string);
+        stats.time_merged_max_covering += stop_watch_merged.ElapsedNanos();
+        assert(merged_seq == per_list_seq);
+        (void)merged_seq;
+      }
+    }
   }
 
   std::cout << "=========================\n"
@@ -38,6 +38,9 @@
 //
 // If we are unable to scan the file, then we ignore the table.
 //
+// The tables are scanned, and the logs converted, in parallel by up to
+// max_file_opening_threads threads, each log into memtables of its own.
+//
 // (d) Write Descriptor
 //
 // We generate descriptor contents:
@@ -61,7 +64,12 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <atomic>
 #include <cinttypes>
+#include <functional>
+#include <map>
+#include <mutex>
+
 #include "db/builder.h"
 #include "db/db_impl/db_impl.h"
 #include "db/dbformat.h"
@@ -69,24 +77,74 @@
 #include "db/log_writer.h"
 #include "db/memtable.h"
 #include "db/table_cache.h"
+#include "db/table_properties_collector.h"
 #include "db/version_edit.h"
 #include "db/write_batch_internal.h"
 #include "env/composite_env_wrapper.h"
 #include "file/filename.h"
 #include "file/writable_file_writer.h"
 #include "options/cf_options.h"
+#include "port/port.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
 #include "rocksdb/write_buffer_manager.h"
 #include "table/scoped_arena_iterator.h"
+#include "util/mutexlock.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 namespace {
 
+// The memtables a log is converted into, one per column family
+class RepairMemTables : public ColumnFamilyMemTables {
+ public:
+  explicit RepairMemTables(ColumnFamilySet* column_family_set) {
+    for (auto* cfd : *column_family_set) {
+      MemTable* mem = cfd->ConstructNewMemtable(
+          *cfd->GetLatestMutableCFOptions(), kMaxSequenceNumber);
+      mem->Ref();
+      mems_[cfd->GetID()] = {cfd, mem};
+    }
+  }
+
+  ~RepairMemTables() override {
+    for (auto& entry : mems_) {
+      delete entry.second.second->Unref();
+    }
+  }
+
+  bool Seek(uint32_t column_family_id) override {
+    auto it = mems_.find(column_family_id);
+    current_ = it != mems_.end() ? &it->second : nullptr;
+    return current_ != nullptr;
+  }
+
+  uint64_t GetLogNumber() const override { return 0; }
+
+  MemTable* GetMemTable() const override {
+    assert(current_ != nullptr);
+    return current_->second;
+  }
+
+  ColumnFamilyHandle* GetColumnFamilyHandle() override { return nullptr; }
+
+  ColumnFamilyData* current() override {
+    return current_ != nullptr ? current_->first : nullptr;
+  }
+
+  const std::map<uint32_t, std::pair<ColumnFamilyData*, MemTable*>>& mems()
+      const {
+    return mems_;
+  }
+
+ private:
+  std::map<uint32_t, std::pair<ColumnFamilyData*, MemTable*>> mems_;
+  const std::pair<ColumnFamilyData*, MemTable*>* current_ = nullptr;
+};
+
 class Repairer {
  public:
   Repairer(const std::string& dbname, const DBOptions& db_options,
@@ -264,7 +322,12 @@ class Repairer {
   std::vector<FileDescriptor> table_fds_;
   std::vector<uint64_t> logs_;
   std::vector<TableInfo> tables_;
-  uint64_t next_file_number_;
+  std::atomic<uint64_t> next_file_number_;
+  // Serializes the lookup and creation of the column families of the tables
+  // scanned in parallel
+  port::Mutex cf_mutex_;
+  // Of the iterators scanning the tables, which read every block once
+  static const size_t kScanReadaheadSize = 4 << 20;
   // Lock over the persistent DB state. Non-nullptr iff successfully
   // acquired.
   FileLock* db_lock_;
@@ -330,21 +393,48 @@ class Repairer {
     return Status::OK();
   }
 
+  // Runs func(i) for each i in [0, n) on up to max_file_opening_threads
+  // threads
+  void RunInParallel(size_t n, const std::function<void(size_t)>& func) {
+    std::atomic<size_t> next(0);
+    std::function<void()> worker([&]() {
+      for (size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+        func(i);
+      }
+    });
+    const size_t max_threads = static_cast<size_t>(
+        std::max(db_options_.max_file_opening_threads, 1));
+    std::vector<port::Thread> threads;
+    for (size_t i = 1; i < std::min(n, max_threads); i++) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
   void ConvertLogFilesToTables() {
-    for (size_t i = 0; i < logs_.size(); i++) {
+    std::vector<std::vector<FileDescriptor>> log_table_fds(logs_.size());
+    RunInParallel(logs_.size(), [&](size_t i) {
       // we should use LogFileName(wal_dir, logs_[i]) here. user might uses wal_dir option.
       std::string logname = LogFileName(db_options_.wal_dir, logs_[i]);
-      Status status = ConvertLogToTable(logs_[i]);
+      Status status = ConvertLogToTable(logs_[i], &log_table_fds[i]);
       if (!status.ok()) {
         ROCKS_LOG_WARN(db_options_.info_log,
                        "Log #%" PRIu64 ": ignoring conversion error: %s",
                        logs_[i], status.ToString().c_str());
       }
       ArchiveFile(logname);
+    });
+    for (const auto& fds : log_table_fds) {
+      table_fds_.insert(table_fds_.end(), fds.begin(), fds.end());
     }
   }
 
-  Status ConvertLogToTable(uint64_t log) {
+  // Appends the tables written to table_fds. Thread-safe.
+  Status ConvertLogToTable(uint64_t log,
+                           std::vector<FileDescriptor>* table_fds) {
     struct LogReporter : public log::Reader::Reporter {
       Env* env;
       std::shared_ptr<Logger> info_log;
@@ -380,11 +470,7 @@ class Repairer {
                        true /*enable checksum*/, log);
 
     // Initialize per-column family memtables
-    for (auto* cfd : *vset_.GetColumnFamilySet()) {
-      cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
-                             kMaxSequenceNumber);
-    }
-    auto cf_mems = new ColumnFamilyMemTablesImpl(vset_.GetColumnFamilySet());
+    RepairMemTables cf_mems(vset_.GetColumnFamilySet());
 
     // Read all the records and add to a memtable
     std::string scratch;
@@ -400,7 +486,7 @@ class Repairer {
       Status record_status = WriteBatchInternal::SetContents(&batch, record);
       if (record_status.ok()) {
         record_status =
-            WriteBatchInternal::InsertInto(&batch, cf_mems, nullptr, nullptr);
+            WriteBatchInternal::InsertInto(&batch, &cf_mems, nullptr, nullptr);
       }
       if (record_status.ok()) {
         counter += WriteBatchInternal::Count(&batch);
@@ -411,10 +497,11 @@ class Repairer {
     }
 
     // Dump a table for each column family with entries in this log file.
-    for (auto* cfd : *vset_.GetColumnFamilySet()) {
+    for (const auto& entry : cf_mems.mems()) {
       // Do not record a version edit for this conversion to a Table
       // since ExtractMetaData() will also generate edits.
-      MemTable* mem = cfd->mem();
+      ColumnFamilyData* cfd = entry.second.first;
+      MemTable* mem = entry.second.second;
       if (mem->IsEmpty()) {
         continue;
       }
@@ -461,21 +548,25 @@ class Repairer {
                      status.ToString().c_str());
       if (status.ok()) {
         if (meta.fd.GetFileSize() > 0) {
-          table_fds_.push_back(meta.fd);
+          table_fds->push_back(meta.fd);
         }
       } else {
         break;
       }
     }
-    delete cf_mems;
     return status;
   }
 
   void ExtractMetaData() {
+    std::vector<TableInfo> infos(table_fds_.size());
+    std::vector<Status> statuses(table_fds_.size());
+    RunInParallel(table_fds_.size(), [&](size_t i) {
+      infos[i].meta.fd = table_fds_[i];
+      statuses[i] = ScanTable(&infos[i]);
+    });
     for (size_t i = 0; i < table_fds_.size(); i++) {
-      TableInfo t;
-      t.meta.fd = table_fds_[i];
-      Status status = ScanTable(&t);
+      const TableInfo& t = infos[i];
+      const Status& status = statuses[i];
       if (!status.ok()) {
         std::string fname = TableFileName(
             db_options_.db_paths, t.meta.fd.GetNumber(), t.meta.fd.GetPathId());
@@ -491,6 +582,47 @@ class Repairer {
     }
   }
 
+  // Sets the column family of t, from its properties, adding it to vset_ if
+  // new.
+  // REQUIRES: cf_mutex_ held
+  Status FindColumnFamily(TableInfo* t, const TableProperties& props,
+                          ColumnFamilyData** cfd) {
+    cf_mutex_.AssertHeld();
+    t->column_family_id = static_cast<uint32_t>(props.column_family_id);
+    if (t->column_family_id ==
+        TablePropertiesCollectorFactory::Context::kUnknownColumnFamily) {
+      ROCKS_LOG_WARN(
+          db_options_.info_log,
+          "Table #%" PRIu64
+          ": column family unknown (probably due to legacy format); "
+          "adding to default column family id 0.",
+          t->meta.fd.GetNumber());
+      t->column_family_id = 0;
+    }
+
+    if (vset_.GetColumnFamilySet()->GetColumnFamily(t->column_family_id) ==
+        nullptr) {
+      Status status =
+          AddColumnFamily(props.column_family_name, t->column_family_id);
+      if (!status.ok()) {
+        return status;
+      }
+    }
+    *cfd = vset_.GetColumnFamilySet()->GetColumnFamily(t->column_family_id);
+    if ((*cfd)->GetName() != props.column_family_name) {
+      ROCKS_LOG_ERROR(
+          db_options_.info_log,
+          "Table #%" PRIu64
+          ": inconsistent column family name '%s'; expected '%s' for column "
+          "family id %" PRIu32 ".",
+          t->meta.fd.GetNumber(), props.column_family_name.c_str(),
+          (*cfd)->GetName().c_str(), t->column_family_id);
+      return Status::Corruption(dbname_, "inconsistent column family name");
+    }
+    return Status::OK();
+  }
+
+  // Thread-safe
   Status ScanTable(TableInfo* t) {
     std::string fname = TableFileName(
         db_options_.db_paths, t->meta.fd.GetNumber(), t->meta.fd.GetPathId());
@@ -504,43 +636,22 @@ class Repairer {
       status = table_cache_->GetTableProperties(env_options_, icmp_, t->meta.fd,
                                                 &props);
     }
+    ColumnFamilyData* cfd = nullptr;
     if (status.ok()) {
-      t->column_family_id = static_cast<uint32_t>(props->column_family_id);
-      if (t->column_family_id ==
-          TablePropertiesCollectorFactory::Context::kUnknownColumnFamily) {
-        ROCKS_LOG_WARN(
-            db_options_.info_log,
-            "Table #%" PRIu64
-            ": column family unknown (probably due to legacy format); "
-            "adding to default column family id 0.",
-            t->meta.fd.GetNumber());
-        t->column_family_id = 0;
-      }
-
-      if (vset_.GetColumnFamilySet()->GetColumnFamily(t->column_family_id) ==
-          nullptr) {
-        status =
-            AddColumnFamily(props->column_family_name, t->column_family_id);
-      }
-      t->meta.oldest_ancester_time = props->creation_time;
+      MutexLock l(&cf_mutex_);
+      status = FindColumnFamily(t, *props, &cfd);
     }
-    ColumnFamilyData* cfd = nullptr;
     if (status.ok()) {
-      cfd = vset_.GetColumnFamilySet()->GetColumnFamily(t->column_family_id);
-      if (cfd->GetName() != props->column_family_name) {
-        ROCKS_LOG_ERROR(
-            db_options_.info_log,
-            "Table #%" PRIu64
-            ": inconsistent column family name '%s'; expected '%s' for column "
-            "family id %" PRIu32 ".",
-            t->meta.fd.GetNumber(), props->column_family_name.c_str(),
-            cfd->GetName().c_str(), t->column_family_id);
-        status = Status::Corruption(dbname_, "inconsistent column family name");
-      }
+      t->meta.oldest_ancester_time = props->creation_time;
+      GetTimestampRange(props->user_collected_properties,
+                        &t->meta.min_timestamp, &t->meta.max_timestamp);
     }
     if (status.ok()) {
       ReadOptions ropts;
       ropts.total_order_seek = true;
+      // Every key is read once
+      ropts.fill_cache = false;
+      ropts.readahead_size = kScanReadaheadSize;
       InternalIterator* iter = table_cache_->NewIterator(
           ropts, env_options_, cfd->internal_comparator(), t->meta,
           nullptr /* range_del_agg */,
@@ -609,7 +720,8 @@ class Repairer {
             table->meta.fd.largest_seqno, table->meta.marked_for_compaction,
             table->meta.oldest_blob_file_number,
             table->meta.oldest_ancester_time, table->meta.file_creation_time,
-            table->meta.file_checksum, table->meta.file_checksum_func_name);
+            table->meta.file_checksum, table->meta.file_checksum_func_name,
+            table->meta.min_timestamp, table->meta.max_timestamp);
       }
       assert(next_file_number_ > 0);
       vset_.MarkFileNumberUsed(next_file_number_ - 1);
@@ -288,6 +288,45 @@ TEST_F(RepairTest, RepairMultipleColumnFamilies) {
   }
 }
 
+TEST_F(RepairTest, RepairInParallel) {
+  // Several WALs, each converted into tables of several column families,
+  // and several tables of the default column family, repaired by several
+  // threads.
+  const int kNumCfs = 3;
+  const int kNumRounds = 4;
+  Options options = CurrentOptions();
+  options.max_file_opening_threads = 4;
+  DestroyAndReopen(options);
+  CreateAndReopenWithCF({"pikachu1", "pikachu2"}, options);
+  for (int r = 0; r < kNumRounds; ++r) {
+    for (int i = 0; i < kNumCfs; ++i) {
+      ASSERT_OK(Put(i, "key" + ToString(r), "val" + ToString(r)));
+    }
+    // A new WAL for each round, and the older ones kept for the column
+    // families left unflushed
+    ASSERT_OK(Flush(0));
+  }
+  VectorLogPtr wal_files;
+  ASSERT_OK(dbfull()->GetSortedWalFiles(wal_files));
+  ASSERT_GT(wal_files.size(), 1);
+
+  std::string manifest_path =
+      DescriptorFileName(dbname_, dbfull()->TEST_Current_Manifest_FileNo());
+  Close();
+  ASSERT_OK(env_->DeleteFile(manifest_path));
+
+  ASSERT_OK(RepairDB(dbname_, options));
+
+  ReopenWithColumnFamilies({"default", "pikachu1", "pikachu2"}, options);
+  ASSERT_OK(dbfull()->GetSortedWalFiles(wal_files));
+  ASSERT_EQ(wal_files.size(), 0);
+  for (int i = 0; i < kNumCfs; ++i) {
+    for (int r = 0; r < kNumRounds; ++r) {
+      ASSERT_EQ(Get(i, "key" + ToString(r)), "val" + ToString(r));
+    }
+  }
+}
+
 TEST_F(RepairTest, RepairColumnFamilyOptions) {
   // Verify repair logic uses correct ColumnFamilyOptions when repairing a
   // database with different options for column families.
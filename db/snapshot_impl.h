@@ -8,15 +8,21 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <vector>
 
+#include "db/dbformat.h"
+#include "port/port.h"
 #include "rocksdb/db.h"
+#include "util/core_local.h"
+#include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 class SnapshotList;
 
-// Snapshots are kept in a doubly-linked list in the DB.
+// Snapshots are kept in doubly-linked lists in the DB, one per core.
 // Each SnapshotImpl corresponds to a particular sequence number.
 class SnapshotImpl : public Snapshot {
  public:
@@ -37,52 +43,87 @@ class SnapshotImpl : public Snapshot {
 
   SnapshotList* list_;                 // just for sanity checks
 
+  // Index of the shard of list_ holding the snapshot
+  size_t shard_;
+
   int64_t unix_time_;
 
   // Will this snapshot be used by a Transaction to do write-conflict checking?
   bool is_write_conflict_boundary_;
 };
 
+// The snapshots of a DB, spread over per-core shards so that taking and
+// releasing snapshots neither need the DB mutex nor contend with each other.
+// Each shard is a list guarded by a spin lock. The sequence number of a new
+// snapshot is read while holding the lock of its shard, so every shard is
+// sorted by sequence number, and a snapshot missed by a scan of the shards
+// has a sequence number at least as large as the last sequence number when
+// the scan started. Flushes and compactions collect the snapshots after
+// picking their input, whose data such a snapshot sees as the latest one.
 class SnapshotList {
  public:
-  SnapshotList() {
-    list_.prev_ = &list_;
-    list_.next_ = &list_;
-    list_.number_ = 0xFFFFFFFFL;      // placeholder marker, for debugging
-    // Set all the variables to make UBSAN happy.
-    list_.list_ = nullptr;
-    list_.unix_time_ = 0;
-    list_.is_write_conflict_boundary_ = false;
-    count_ = 0;
+  SnapshotList() : count_(0) {
+    for (size_t i = 0; i < shards_.Size(); i++) {
+      Shard* shard = shards_.AccessAtCore(i);
+      SnapshotImpl& list = shard->list;
+      list.prev_ = &list;
+      list.next_ = &list;
+      list.number_ = 0xFFFFFFFFL;      // placeholder marker, for debugging
+      // Set all the variables to make UBSAN happy.
+      list.list_ = nullptr;
+      list.shard_ = i;
+      list.unix_time_ = 0;
+      list.is_write_conflict_boundary_ = false;
+      shard->oldest.store(kMaxSequenceNumber, std::memory_order_relaxed);
+    }
   }
 
   // No copy-construct.
   SnapshotList(const SnapshotList&) = delete;
 
-  bool empty() const { return list_.next_ == &list_; }
-  SnapshotImpl* oldest() const { assert(!empty()); return list_.next_; }
-  SnapshotImpl* newest() const { assert(!empty()); return list_.prev_; }
+  bool empty() const { return count() == 0; }
 
-  SnapshotImpl* New(SnapshotImpl* s, SequenceNumber seq, uint64_t unix_time,
-                    bool is_write_conflict_boundary) {
-    s->number_ = seq;
+  // Adds s to the shard of the current core, with the sequence number
+  // returned by get_seq, which is called with the shard locked.
+  template <typename GetSequence>
+  SnapshotImpl* New(SnapshotImpl* s, const GetSequence& get_seq,
+                    uint64_t unix_time, bool is_write_conflict_boundary) {
+    auto shard_and_index = shards_.AccessElementAndIndex();
+    Shard* shard = shard_and_index.first;
     s->unix_time_ = unix_time;
     s->is_write_conflict_boundary_ = is_write_conflict_boundary;
     s->list_ = this;
-    s->next_ = &list_;
-    s->prev_ = list_.prev_;
-    s->prev_->next_ = s;
-    s->next_->prev_ = s;
-    count_++;
+    s->shard_ = shard_and_index.second;
+    {
+      std::lock_guard<SpinMutex> l(shard->mutex);
+      s->number_ = get_seq();
+      SnapshotImpl& list = shard->list;
+      s->next_ = &list;
+      s->prev_ = list.prev_;
+      s->prev_->next_ = s;
+      s->next_->prev_ = s;
+      if (list.next_ == s) {
+        shard->oldest.store(s->number_, std::memory_order_relaxed);
+      }
+    }
+    count_.fetch_add(1, std::memory_order_relaxed);
     return s;
   }
 
   // Do not responsible to free the object.
   void Delete(const SnapshotImpl* s) {
     assert(s->list_ == this);
-    s->prev_->next_ = s->next_;
-    s->next_->prev_ = s->prev_;
-    count_--;
+    Shard* shard = shards_.AccessAtCore(s->shard_);
+    {
+      std::lock_guard<SpinMutex> l(shard->mutex);
+      s->prev_->next_ = s->next_;
+      s->next_->prev_ = s->prev_;
+      const SnapshotImpl& list = shard->list;
+      shard->oldest.store(
+          list.next_ == &list ? kMaxSequenceNumber : list.next_->number_,
+          std::memory_order_relaxed);
+    }
+    count_.fetch_sub(1, std::memory_order_relaxed);
   }
 
   // retrieve all snapshot numbers up until max_seq. They are sorted in
@@ -106,62 +147,106 @@ class SnapshotList {
       *oldest_write_conflict_snapshot = kMaxSequenceNumber;
     }
 
-    if (empty()) {
-      return;
-    }
-    const SnapshotImpl* s = &list_;
-    while (s->next_ != &list_) {
-      if (s->next_->number_ > max_seq) {
-        break;
-      }
-      // Avoid duplicates
-      if (ret.empty() || ret.back() != s->next_->number_) {
-        ret.push_back(s->next_->number_);
-      }
-
-      if (oldest_write_conflict_snapshot != nullptr &&
-          *oldest_write_conflict_snapshot == kMaxSequenceNumber &&
-          s->next_->is_write_conflict_boundary_) {
-        // If this is the first write-conflict boundary snapshot in the list,
-        // it is the oldest
-        *oldest_write_conflict_snapshot = s->next_->number_;
+    for (size_t i = 0; i < shards_.Size(); i++) {
+      Shard* shard = shards_.AccessAtCore(i);
+      std::lock_guard<SpinMutex> l(shard->mutex);
+      const SnapshotImpl& list = shard->list;
+      for (const SnapshotImpl* s = list.next_; s != &list; s = s->next_) {
+        if (s->number_ > max_seq) {
+          break;
+        }
+        // Avoid duplicates within the shard
+        if (ret.empty() || ret.back() != s->number_) {
+          ret.push_back(s->number_);
+        }
+        if (oldest_write_conflict_snapshot != nullptr &&
+            s->is_write_conflict_boundary_) {
+          *oldest_write_conflict_snapshot =
+              std::min(*oldest_write_conflict_snapshot, s->number_);
+        }
       }
-
-      s = s->next_;
     }
-    return;
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
   }
 
   // get the sequence number of the most recent snapshot
   SequenceNumber GetNewest() {
-    if (empty()) {
-      return 0;
+    SequenceNumber newest = 0;
+    for (size_t i = 0; i < shards_.Size(); i++) {
+      Shard* shard = shards_.AccessAtCore(i);
+      std::lock_guard<SpinMutex> l(shard->mutex);
+      const SnapshotImpl& list = shard->list;
+      if (list.prev_ != &list) {
+        newest = std::max(newest, list.prev_->number_);
+      }
     }
-    return newest()->number_;
+    return newest;
   }
 
   int64_t GetOldestSnapshotTime() const {
-    if (empty()) {
-      return 0;
-    } else {
-      return oldest()->unix_time_;
+    SequenceNumber oldest = kMaxSequenceNumber;
+    int64_t unix_time = 0;
+    for (size_t i = 0; i < shards_.Size(); i++) {
+      Shard* shard = shards_.AccessAtCore(i);
+      std::lock_guard<SpinMutex> l(shard->mutex);
+      const SnapshotImpl& list = shard->list;
+      if (list.next_ != &list && list.next_->number_ < oldest) {
+        oldest = list.next_->number_;
+        unix_time = list.next_->unix_time_;
+      }
     }
+    return unix_time;
   }
 
+  // Returns the sequence number of the oldest snapshot, or 0 without
+  // snapshots. The oldest snapshot of each shard is read without locking
+  // it, so snapshots taken or released concurrently may be missed.
   int64_t GetOldestSnapshotSequence() const {
-    if (empty()) {
-      return 0;
-    } else {
-      return oldest()->GetSequenceNumber();
+    SequenceNumber oldest = kMaxSequenceNumber;
+    for (size_t i = 0; i < shards_.Size(); i++) {
+      oldest = std::min(
+          oldest, shards_.AccessAtCore(i)->oldest.load(
+                      std::memory_order_relaxed));
+    }
+    return oldest == kMaxSequenceNumber ? 0 : oldest;
+  }
+
+  // Returns the smallest of last_seq and the sequence numbers of the
+  // snapshots. When last_seq is the last sequence number read before the
+  // call, snapshots taken concurrently and later have larger sequence
+  // numbers, so the results of successive calls never decrease.
+  SequenceNumber GetOldestSequence(SequenceNumber last_seq) const {
+    SequenceNumber oldest = last_seq;
+    for (size_t i = 0; i < shards_.Size(); i++) {
+      Shard* shard = shards_.AccessAtCore(i);
+      std::lock_guard<SpinMutex> l(shard->mutex);
+      const SnapshotImpl& list = shard->list;
+      if (list.next_ != &list) {
+        oldest = std::min(oldest, list.next_->number_);
+      }
     }
+    return oldest;
   }
 
-  uint64_t count() const { return count_; }
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
 
  private:
-  // Dummy head of doubly-linked list of snapshots
-  SnapshotImpl list_;
-  uint64_t count_;
+  // Alignment attributes expand to nothing depending on the platform
+  struct ALIGN_AS(CACHE_LINE_SIZE) Shard {
+    SpinMutex mutex;
+    // Dummy head of doubly-linked list of snapshots
+    SnapshotImpl list;
+    // Sequence number of the first snapshot of the list, or
+    // kMaxSequenceNumber, readable without the lock
+    std::atomic<SequenceNumber> oldest;
+
+    void* operator new[](size_t s) { return port::cacheline_aligned_alloc(s); }
+    void operator delete[](void* p) { port::cacheline_aligned_free(p); }
+  };
+
+  CoreLocalArray<Shard> shards_;
+  std::atomic<uint64_t> count_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
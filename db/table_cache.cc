@@ -9,9 +9,12 @@
 
 #include "db/table_cache.h"
 
+#include <array>
+
 #include "db/dbformat.h"
 #include "db/range_tombstone_fragmenter.h"
 #include "db/snapshot_impl.h"
+#include "db/table_metadata_checkpoint.h"
 #include "db/version_edit.h"
 #include "file/file_util.h"
 #include "file/filename.h"
@@ -75,7 +78,9 @@ TableCache::TableCache(const ImmutableCFOptions& ioptions,
       immortal_tables_(false),
       block_cache_tracer_(block_cache_tracer),
       loader_mutex_(kLoadConcurency, GetSliceNPHash64),
-      io_tracer_(io_tracer) {
+      io_tracer_(io_tracer),
+      metadata_checkpoint_(nullptr),
+      block_cache_warmup_(nullptr) {
   if (ioptions_.row_cache) {
     // If the same cache is shared by multiple instances, we need to
     // disambiguate its entries.
@@ -131,15 +136,20 @@ Status TableCache::GetTableReader(
             std::move(file), fname, ioptions_.env, io_tracer_,
             record_read_stats ? ioptions_.statistics : nullptr, SST_READ_MICROS,
             file_read_hist, ioptions_.rate_limiter, ioptions_.listeners));
+    TableReaderOptions reader_options(
+        ioptions_, prefix_extractor, file_options, internal_comparator,
+        skip_filters, immortal_tables_, false /* force_direct_prefetch */,
+        level, fd.largest_seqno, block_cache_tracer_,
+        max_file_size_for_l0_meta_pin);
+    std::string tail;
+    if (metadata_checkpoint_ != nullptr &&
+        metadata_checkpoint_->Take(fd.GetNumber(), fd.GetFileSize(), &tail)) {
+      reader_options.prefetched_tail = tail;
+    }
+    reader_options.block_cache_warmup = block_cache_warmup_;
     s = ioptions_.table_factory->NewTableReader(
-        ro,
-        TableReaderOptions(ioptions_, prefix_extractor, file_options,
-                           internal_comparator, skip_filters, immortal_tables_,
-                           false /* force_direct_prefetch */, level,
-                           fd.largest_seqno, block_cache_tracer_,
-                           max_file_size_for_l0_meta_pin),
-        std::move(file_reader), fd.GetFileSize(), table_reader,
-        prefetch_index_and_filter_in_cache);
+        ro, reader_options, std::move(file_reader), fd.GetFileSize(),
+        table_reader, prefetch_index_and_filter_in_cache);
     TEST_SYNC_POINT("TableCache::GetTableReader:0");
   }
   return s;
@@ -355,33 +365,58 @@ bool TableCache::GetFromRowCache(const Slice& user_key, IterKey& row_cache_key,
   row_cache_key.TrimAppend(prefix_size, user_key.data(), user_key.size());
   if (auto row_handle =
           ioptions_.row_cache->Lookup(row_cache_key.GetUserKey())) {
-    // Cleanable routine to release the cache entry
-    Cleanable value_pinner;
-    auto release_cache_entry_func = [](void* cache_to_clean,
-                                       void* cache_handle) {
-      ((Cache*)cache_to_clean)->Release((Cache::Handle*)cache_handle);
-    };
-    auto found_row_cache_entry =
-        static_cast<const std::string*>(ioptions_.row_cache->Value(row_handle));
-    // If it comes here value is located on the cache.
-    // found_row_cache_entry points to the value on cache,
-    // and value_pinner has cleanup procedure for the cached entry.
-    // After replayGetContextLog() returns, get_context.pinnable_slice_
-    // will point to cache entry buffer (or a copy based on that) and
-    // cleanup routine under value_pinner will be delegated to
-    // get_context.pinnable_slice_. Cache entry is released when
-    // get_context.pinnable_slice_ is reset.
-    value_pinner.RegisterCleanup(release_cache_entry_func,
-                                 ioptions_.row_cache.get(), row_handle);
-    replayGetContextLog(*found_row_cache_entry, user_key, get_context,
-                        &value_pinner);
-    RecordTick(ioptions_.statistics, ROW_CACHE_HIT);
+    ReplayFromRowCache(row_handle, user_key, get_context);
     found = true;
   } else {
     RecordTick(ioptions_.statistics, ROW_CACHE_MISS);
   }
   return found;
 }
+
+void TableCache::ReplayFromRowCache(Cache::Handle* row_handle,
+                                    const Slice& user_key,
+                                    GetContext* get_context) {
+  // Cleanable routine to release the cache entry
+  Cleanable value_pinner;
+  auto release_cache_entry_func = [](void* cache_to_clean,
+                                     void* cache_handle) {
+    ((Cache*)cache_to_clean)->Release((Cache::Handle*)cache_handle);
+  };
+  auto found_row_cache_entry =
+      static_cast<const std::string*>(ioptions_.row_cache->Value(row_handle));
+  // If it comes here value is located on the cache.
+  // found_row_cache_entry points to the value on cache,
+  // and value_pinner has cleanup procedure for the cached entry.
+  // After replayGetContextLog() returns, get_context.pinnable_slice_
+  // will point to cache entry buffer (or a copy based on that) and
+  // cleanup routine under value_pinner will be delegated to
+  // get_context.pinnable_slice_. Cache entry is released when
+  // get_context.pinnable_slice_ is reset. An empty entry is a negative
+  // one, the key not being in the file, and replays nothing.
+  value_pinner.RegisterCleanup(release_cache_entry_func,
+                               ioptions_.row_cache.get(), row_handle);
+  replayGetContextLog(*found_row_cache_entry, user_key, get_context,
+                      &value_pinner);
+  RecordTick(ioptions_.statistics, ROW_CACHE_HIT);
+}
+
+bool TableCache::IsNegativeRowCacheEntry(TableReader* t,
+                                         const GetContext* get_context) {
+  if (!ioptions_.row_cache_negative_entries || t == nullptr) {
+    return false;
+  }
+  // MarkKeyMayExist() leaves the state found with an empty log, and what a
+  // read callback hides may become visible later
+  if ((get_context->State() != GetContext::kNotFound &&
+       get_context->State() != GetContext::kMerge) ||
+      get_context->has_callback()) {
+    return false;
+  }
+  // A row cache hit skips the range tombstones of the file, which could
+  // cover the keys of older files
+  auto props = t->GetTableProperties();
+  return props != nullptr && props->num_range_deletions == 0;
+}
 #endif  // ROCKSDB_LITE
 
 Status TableCache::Get(const ReadOptions& options,
@@ -451,8 +486,11 @@ Status TableCache::Get(const ReadOptions& options,
   }
 
 #ifndef ROCKSDB_LITE
-  // Put the replay log in row cache only if something was found.
-  if (!done && s.ok() && row_cache_entry && !row_cache_entry->empty()) {
+  // Put the replay log in row cache only if something was found, or as a
+  // negative entry if the key is not in the file.
+  if (!done && s.ok() && row_cache_entry &&
+      (!row_cache_entry->empty() ||
+       IsNegativeRowCacheEntry(t, get_context))) {
     size_t charge =
         row_cache_key.Size() + row_cache_entry->size() + sizeof(std::string);
     void* row_ptr = new std::string(std::move(*row_cache_entry));
@@ -500,16 +538,38 @@ Status TableCache::MultiGet(const ReadOptions& options,
                             row_cache_key);
     row_cache_key_prefix_size = row_cache_key.Size();
 
+    // Looks up all of the keys at once, each shard of the row cache being
+    // locked once
+    std::string row_cache_keys;
+    autovector<size_t, MultiGetContext::MAX_BATCH_SIZE + 1> key_offsets;
     for (auto miter = table_range.begin(); miter != table_range.end();
          ++miter) {
-      const Slice& user_key = miter->ukey;
-      ;
+      key_offsets.push_back(row_cache_keys.size());
+      row_cache_keys.append(row_cache_key.GetUserKey().data(),
+                            row_cache_key_prefix_size);
+      row_cache_keys.append(miter->ukey.data(), miter->ukey.size());
+    }
+    key_offsets.push_back(row_cache_keys.size());
+    size_t num_keys = key_offsets.size() - 1;
+    std::array<Slice, MultiGetContext::MAX_BATCH_SIZE> keys;
+    std::array<Cache::Handle*, MultiGetContext::MAX_BATCH_SIZE> row_handles;
+    for (size_t i = 0; i < num_keys; ++i) {
+      keys[i] = Slice(row_cache_keys.data() + key_offsets[i],
+                      key_offsets[i + 1] - key_offsets[i]);
+    }
+    ioptions_.row_cache->MultiLookup(keys.data(), num_keys,
+                                     row_handles.data());
+
+    size_t i = 0;
+    for (auto miter = table_range.begin(); miter != table_range.end();
+         ++miter, ++i) {
       GetContext* get_context = miter->get_context;
 
-      if (GetFromRowCache(user_key, row_cache_key, row_cache_key_prefix_size,
-                          get_context)) {
+      if (row_handles[i] != nullptr) {
+        ReplayFromRowCache(row_handles[i], miter->ukey, get_context);
         table_range.SkipKey(miter);
       } else {
+        RecordTick(ioptions_.statistics, ROW_CACHE_MISS);
         row_cache_entries.emplace_back();
         get_context->SetReplayLog(&(row_cache_entries.back()));
       }
@@ -574,8 +634,11 @@ Status TableCache::MultiGet(const ReadOptions& options,
       // Compute row cache key.
       row_cache_key.TrimAppend(row_cache_key_prefix_size, user_key.data(),
                                user_key.size());
-      // Put the replay log in row cache only if something was found.
-      if (s.ok() && !row_cache_entry.empty()) {
+      // Put the replay log in row cache only if something was found, or as
+      // a negative entry if the key is not in the file.
+      if (s.ok() && miter->s->ok() &&
+          (!row_cache_entry.empty() ||
+           IsNegativeRowCacheEntry(t, get_context))) {
         size_t charge =
             row_cache_key.Size() + row_cache_entry.size() + sizeof(std::string);
         void* row_ptr = new std::string(std::move(row_cache_entry));
@@ -701,4 +764,27 @@ uint64_t TableCache::ApproximateSize(
 
   return result;
 }
+
+Status TableCache::ApproximateKeyAnchors(
+    const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+    const FileDescriptor& fd, std::vector<TableReader::Anchor>* anchors) {
+  Status s;
+  TableReader* table_reader = fd.table_reader;
+  Cache::Handle* table_handle = nullptr;
+  if (table_reader == nullptr) {
+    s = FindTable(ro, file_options_, internal_comparator, fd, &table_handle,
+                  nullptr /* prefix_extractor */, false /* no_io */,
+                  false /* record_read_stats */);
+    if (s.ok()) {
+      table_reader = GetTableReaderFromHandle(table_handle);
+    }
+  }
+  if (s.ok()) {
+    s = table_reader->ApproximateKeyAnchors(ro, anchors);
+  }
+  if (table_handle != nullptr) {
+    ReleaseHandle(table_handle);
+  }
+  return s;
+}
 }  // namespace ROCKSDB_NAMESPACE
@@ -32,6 +32,8 @@ class Arena;
 struct FileDescriptor;
 class GetContext;
 class HistogramImpl;
+class BlockCacheWarmup;
+class TableMetadataCheckpoint;
 
 // Manages caching for TableReader objects for a column family. The actual
 // cache is allocated separately and passed to the constructor. TableCache
@@ -178,6 +180,13 @@ class TableCache {
                            const InternalKeyComparator& internal_comparator,
                            const SliceTransform* prefix_extractor = nullptr);
 
+  // Appends user keys sampled from the file represented by fd to *anchors,
+  // see TableReader::ApproximateKeyAnchors().
+  Status ApproximateKeyAnchors(const ReadOptions& ro,
+                               const InternalKeyComparator& internal_comparator,
+                               const FileDescriptor& fd,
+                               std::vector<TableReader::Anchor>* anchors);
+
   // Release the handle from a cache
   void ReleaseHandle(Cache::Handle* handle);
 
@@ -195,6 +204,17 @@ class TableCache {
     }
   }
 
+  // The tables are opened from the metadata saved at the last DB close, if
+  // it has theirs
+  void SetMetadataCheckpoint(TableMetadataCheckpoint* checkpoint) {
+    metadata_checkpoint_ = checkpoint;
+  }
+
+  // The tables record the data blocks read through the block cache
+  void SetBlockCacheWarmup(BlockCacheWarmup* block_cache_warmup) {
+    block_cache_warmup_ = block_cache_warmup;
+  }
+
  private:
   // Build a table reader
   Status GetTableReader(const ReadOptions& ro, const FileOptions& file_options,
@@ -220,6 +240,15 @@ class TableCache {
   bool GetFromRowCache(const Slice& user_key, IterKey& row_cache_key,
                        size_t prefix_size, GetContext* get_context);
 
+  // Replays the row cache entry of row_handle into get_context, which
+  // releases the handle once done with the value
+  void ReplayFromRowCache(Cache::Handle* row_handle, const Slice& user_key,
+                          GetContext* get_context);
+
+  // Whether a lookup in table t, which left an empty replay log in
+  // get_context, may be kept as a negative row cache entry
+  bool IsNegativeRowCacheEntry(TableReader* t, const GetContext* get_context);
+
   const ImmutableCFOptions& ioptions_;
   const FileOptions& file_options_;
   Cache* const cache_;
@@ -228,6 +257,8 @@ class TableCache {
   BlockCacheTracer* const block_cache_tracer_;
   Striped<port::Mutex, Slice> loader_mutex_;
   std::shared_ptr<IOTracer> io_tracer_;
+  TableMetadataCheckpoint* metadata_checkpoint_;
+  BlockCacheWarmup* block_cache_warmup_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
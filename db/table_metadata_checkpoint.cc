@@ -0,0 +1,114 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/table_metadata_checkpoint.h"
+
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// The file is
+//   fixed32: kMagic
+//   varint64: number of tails
+//   for each tail:
+//     varint64: file number
+//     varint64: file size
+//     length prefixed: tail
+//   fixed32: masked crc32c of all of the above
+const uint32_t kMagic = 0x544d4331;  // "TMC1"
+}  // namespace
+
+Status TableMetadataCheckpoint::Load(FileSystem* fs,
+                                     const std::string& fname) {
+  Clear();
+  std::string data;
+  Status s = ReadFileToString(fs, fname, &data);
+  if (!s.ok()) {
+    return s;
+  }
+  if (data.size() < 2 * sizeof(uint32_t)) {
+    return Status::Corruption("Truncated table metadata checkpoint", fname);
+  }
+  const size_t body_size = data.size() - sizeof(uint32_t);
+  const uint32_t expected_crc =
+      crc32c::Unmask(DecodeFixed32(data.data() + body_size));
+  if (crc32c::Value(data.data(), body_size) != expected_crc) {
+    return Status::Corruption("Table metadata checkpoint checksum mismatch",
+                              fname);
+  }
+
+  Slice input(data.data(), body_size);
+  uint64_t num_tails = 0;
+  if (DecodeFixed32(input.data()) != kMagic) {
+    return Status::Corruption("Bad table metadata checkpoint magic", fname);
+  }
+  input.remove_prefix(sizeof(uint32_t));
+  std::unordered_map<uint64_t, FileTail> tails;
+  bool ok = GetVarint64(&input, &num_tails);
+  for (uint64_t i = 0; ok && i < num_tails; i++) {
+    FileTail file_tail;
+    Slice tail;
+    ok = GetVarint64(&input, &file_tail.file_number) &&
+         GetVarint64(&input, &file_tail.file_size) &&
+         GetLengthPrefixedSlice(&input, &tail) &&
+         tail.size() <= file_tail.file_size;
+    if (ok) {
+      file_tail.tail = tail.ToString();
+      tails[file_tail.file_number] = std::move(file_tail);
+    }
+  }
+  if (!ok || !input.empty()) {
+    return Status::Corruption("Bad table metadata checkpoint record", fname);
+  }
+
+  MutexLock l(&mutex_);
+  tails_ = std::move(tails);
+  return Status::OK();
+}
+
+Status TableMetadataCheckpoint::Save(FileSystem* fs, const std::string& fname,
+                                     const std::vector<FileTail>& tails) {
+  std::string data;
+  PutFixed32(&data, kMagic);
+  PutVarint64(&data, tails.size());
+  for (const auto& file_tail : tails) {
+    PutVarint64(&data, file_tail.file_number);
+    PutVarint64(&data, file_tail.file_size);
+    PutLengthPrefixedSlice(&data, file_tail.tail);
+  }
+  PutFixed32(&data, crc32c::Mask(crc32c::Value(data.data(), data.size())));
+  // A file cut short by a crash does not check out, and is not used
+  return WriteStringToFile(fs, data, fname, true /* should_sync */);
+}
+
+bool TableMetadataCheckpoint::Take(uint64_t file_number, uint64_t file_size,
+                                   std::string* tail) {
+  MutexLock l(&mutex_);
+  auto it = tails_.find(file_number);
+  if (it == tails_.end()) {
+    return false;
+  }
+  bool found = it->second.file_size == file_size;
+  if (found) {
+    *tail = std::move(it->second.tail);
+  }
+  tails_.erase(it);
+  return found;
+}
+
+void TableMetadataCheckpoint::Clear() {
+  MutexLock l(&mutex_);
+  tails_.clear();
+}
+
+size_t TableMetadataCheckpoint::NumTails() {
+  MutexLock l(&mutex_);
+  return tails_.size();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,69 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The metadata of table files saved at DB close, for the next DB::Open() to
+// read the tables with instead of their files. The metadata of a file is
+// its tail: the bytes from the first meta block read when the table was
+// opened to the end of the file. For a block-based table, this is the
+// footer, the metaindex, properties and range deletion blocks, and the
+// index and filter blocks or their top-level partitions as far as they
+// were read at open, all checked against their checksums when parsed.
+//
+// The tails are kept by file number and size in a single file of the DB
+// directory, which is deleted once read so that it only ever describes
+// the table files as of the last close.
+class TableMetadataCheckpoint {
+ public:
+  struct FileTail {
+    uint64_t file_number;
+    uint64_t file_size;
+    std::string tail;
+  };
+
+  TableMetadataCheckpoint() {}
+
+  // No copying allowed
+  TableMetadataCheckpoint(const TableMetadataCheckpoint&) = delete;
+  void operator=(const TableMetadataCheckpoint&) = delete;
+
+  // Reads the tails saved in fname, replacing the ones held. Returns
+  // NotFound if there is no such file, and Corruption if it does not check
+  // out, in which case no tail is held.
+  Status Load(FileSystem* fs, const std::string& fname);
+
+  // Saves the tails in fname
+  static Status Save(FileSystem* fs, const std::string& fname,
+                     const std::vector<FileTail>& tails);
+
+  // Moves the tail of the file into *tail and returns true if it is held.
+  // A tail is handed out once, to the first reader of the file.
+  bool Take(uint64_t file_number, uint64_t file_size, std::string* tail);
+
+  // Drops the tails not taken
+  void Clear();
+
+  size_t NumTails();
+
+ private:
+  port::Mutex mutex_;
+  // By file number
+  std::unordered_map<uint64_t, FileTail> tails_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -59,6 +59,61 @@ UserKeyTablePropertiesCollector::GetReadableProperties() const {
   return collector_->GetReadableProperties();
 }
 
+const char* TimestampTablePropertiesCollector::kMinTimestamp =
+    "rocksdb.timestamp.min";
+const char* TimestampTablePropertiesCollector::kMaxTimestamp =
+    "rocksdb.timestamp.max";
+
+Status TimestampTablePropertiesCollector::InternalAdd(
+    const Slice& key, const Slice& /* value */, uint64_t /* file_size */) {
+  size_t ts_sz = ucmp_->timestamp_size();
+  if (key.size() < kNumInternalBytes + ts_sz) {
+    return Status::Corruption("Internal key too small for a timestamp");
+  }
+  Slice user_key = ExtractUserKey(key);
+  Slice ts(user_key.data() + user_key.size() - ts_sz, ts_sz);
+  if (min_timestamp_.empty()) {
+    min_timestamp_.assign(ts.data(), ts.size());
+    max_timestamp_.assign(ts.data(), ts.size());
+  } else if (ucmp_->CompareTimestamp(ts, min_timestamp_) < 0) {
+    min_timestamp_.assign(ts.data(), ts.size());
+  } else if (ucmp_->CompareTimestamp(ts, max_timestamp_) > 0) {
+    max_timestamp_.assign(ts.data(), ts.size());
+  }
+  return Status::OK();
+}
+
+Status TimestampTablePropertiesCollector::Finish(
+    UserCollectedProperties* properties) {
+  if (!min_timestamp_.empty()) {
+    properties->insert({kMinTimestamp, min_timestamp_});
+    properties->insert({kMaxTimestamp, max_timestamp_});
+  }
+  return Status::OK();
+}
+
+UserCollectedProperties
+TimestampTablePropertiesCollector::GetReadableProperties() const {
+  if (min_timestamp_.empty()) {
+    return {};
+  }
+  return {{kMinTimestamp, Slice(min_timestamp_).ToString(true)},
+          {kMaxTimestamp, Slice(max_timestamp_).ToString(true)}};
+}
+
+bool GetTimestampRange(const UserCollectedProperties& props,
+                       std::string* min_timestamp,
+                       std::string* max_timestamp) {
+  auto min_pos = props.find(TimestampTablePropertiesCollector::kMinTimestamp);
+  auto max_pos = props.find(TimestampTablePropertiesCollector::kMaxTimestamp);
+  if (min_pos == props.end() || max_pos == props.end()) {
+    return false;
+  }
+  *min_timestamp = min_pos->second;
+  *max_timestamp = max_pos->second;
+  return true;
+}
+
 uint64_t GetDeletedKeys(
     const UserCollectedProperties& props) {
   bool property_present_ignored;
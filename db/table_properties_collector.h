@@ -6,6 +6,7 @@
 // This file defines a collection of statistics collectors.
 #pragma once
 
+#include "rocksdb/comparator.h"
 #include "rocksdb/table_properties.h"
 
 #include <memory>
@@ -104,4 +105,62 @@ class UserKeyTablePropertiesCollectorFactory
   std::shared_ptr<TablePropertiesCollectorFactory> user_collector_factory_;
 };
 
+// Records the smallest and the largest user-defined timestamp of the keys of
+// a table, by the comparator's CompareTimestamp(), so that reads at an older
+// timestamp can skip it. Only used when the comparator has timestamps.
+class TimestampTablePropertiesCollector : public IntTblPropCollector {
+ public:
+  static const char* kMinTimestamp;
+  static const char* kMaxTimestamp;
+
+  explicit TimestampTablePropertiesCollector(const Comparator* ucmp)
+      : ucmp_(ucmp) {}
+
+  Status InternalAdd(const Slice& key, const Slice& value,
+                     uint64_t file_size) override;
+
+  void BlockAdd(uint64_t /* blockRawBytes */,
+                uint64_t /* blockCompressedBytesFast */,
+                uint64_t /* blockCompressedBytesSlow */) override {}
+
+  Status Finish(UserCollectedProperties* properties) override;
+
+  const char* Name() const override {
+    return "TimestampTablePropertiesCollector";
+  }
+
+  UserCollectedProperties GetReadableProperties() const override;
+
+ private:
+  const Comparator* ucmp_;
+  std::string min_timestamp_;
+  std::string max_timestamp_;
+};
+
+class TimestampTablePropertiesCollectorFactory
+    : public IntTblPropCollectorFactory {
+ public:
+  explicit TimestampTablePropertiesCollectorFactory(const Comparator* ucmp)
+      : ucmp_(ucmp) {}
+
+  IntTblPropCollector* CreateIntTblPropCollector(
+      uint32_t /* column_family_id */) override {
+    return new TimestampTablePropertiesCollector(ucmp_);
+  }
+
+  const char* Name() const override {
+    return "TimestampTablePropertiesCollectorFactory";
+  }
+
+ private:
+  const Comparator* ucmp_;
+};
+
+// Sets *min_timestamp and *max_timestamp to the range recorded by
+// TimestampTablePropertiesCollector, and returns false, leaving them
+// untouched, if there is none.
+extern bool GetTimestampRange(const UserCollectedProperties& props,
+                              std::string* min_timestamp,
+                              std::string* max_timestamp);
+
 }  // namespace ROCKSDB_NAMESPACE
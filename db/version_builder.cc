@@ -840,6 +840,13 @@ class VersionBuilder::Rep {
       return s;
     }
 
+    size_t num_files = 0;
+    for (int level = 0; level < num_levels_; level++) {
+      num_files += base_vstorage_->LevelFiles(level).size() +
+                   levels_[level].added_files.size();
+    }
+    vstorage->ReserveFileLocations(num_files);
+
     for (int level = 0; level < num_levels_; level++) {
       const auto& cmp = (level == 0) ? level_zero_cmp_ : level_nonzero_cmp_;
       // Merge the set of added files with the set of pre-existing files.
@@ -849,6 +856,16 @@ class VersionBuilder::Rep {
       vstorage->Reserve(level,
                         base_files.size() + unordered_added_files.size());
 
+      // The edits leave most levels as they were. Take their files without
+      // looking each of them up in the added and deleted sets.
+      if (unordered_added_files.empty() &&
+          levels_[level].deleted_files.empty()) {
+        for (FileMetaData* f : base_files) {
+          vstorage->AddFile(level, f);
+        }
+        continue;
+      }
+
       // Sort added files for the level.
       std::vector<FileMetaData*> added_files;
       added_files.reserve(unordered_added_files.size());
@@ -185,6 +185,12 @@ bool VersionEdit::EncodeTo(std::string* dst) const {
     PutVarint32(dst, NewFileCustomTag::kFileChecksumFuncName);
     PutLengthPrefixedSlice(dst, Slice(f.file_checksum_func_name));
 
+    if (!f.min_timestamp.empty()) {
+      PutVarint32(dst, NewFileCustomTag::kMinTimestamp);
+      PutLengthPrefixedSlice(dst, Slice(f.min_timestamp));
+      PutVarint32(dst, NewFileCustomTag::kMaxTimestamp);
+      PutLengthPrefixedSlice(dst, Slice(f.max_timestamp));
+    }
     if (f.fd.GetPathId() != 0) {
       PutVarint32(dst, NewFileCustomTag::kPathId);
       char p = static_cast<char>(f.fd.GetPathId());
@@ -331,6 +337,12 @@ const char* VersionEdit::DecodeNewFile4From(Slice* input) {
         case kFileChecksumFuncName:
           f.file_checksum_func_name = field.ToString();
           break;
+        case kMinTimestamp:
+          f.min_timestamp = field.ToString();
+          break;
+        case kMaxTimestamp:
+          f.max_timestamp = field.ToString();
+          break;
         case kNeedCompaction:
           if (field.size() != 1) {
             return "need_compaction field wrong size";
@@ -708,6 +720,12 @@ std::string VersionEdit::DebugString(bool hex_key) const {
     r.append(f.file_checksum);
     r.append(" file_checksum_func_name: ");
     r.append(f.file_checksum_func_name);
+    if (!f.min_timestamp.empty()) {
+      r.append(" timestamps: ");
+      r.append(Slice(f.min_timestamp).ToString(true));
+      r.append(" .. ");
+      r.append(Slice(f.max_timestamp).ToString(true));
+    }
   }
 
   for (const auto& blob_file_addition : blob_file_additions_) {
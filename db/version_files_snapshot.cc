@@ -0,0 +1,106 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/version_files_snapshot.h"
+
+#include <algorithm>
+
+#include "db/version_set.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Whether level_files are files, in the same order and compaction state.
+// The other fields follow from the file numbers.
+bool SameFiles(const std::vector<VersionFilesSnapshot::File>& level_files,
+               const std::vector<FileMetaData*>& files) {
+  if (level_files.size() != files.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < files.size(); i++) {
+    if (level_files[i].number != files[i]->fd.GetNumber() ||
+        level_files[i].being_compacted != files[i]->being_compacted) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+VersionFilesSnapshot::VersionFilesSnapshot(const InternalKeyComparator* icmp,
+                                           const VersionStorageInfo& vstorage,
+                                           const VersionFilesSnapshot* prev)
+    : icmp_(icmp), levels_(vstorage.num_levels()) {
+  for (int level = 0; level < vstorage.num_levels(); level++) {
+    const auto& files = vstorage.LevelFiles(level);
+    if (prev != nullptr && level < prev->num_levels() &&
+        SameFiles(*prev->levels_[level], files)) {
+      levels_[level] = prev->levels_[level];
+      continue;
+    }
+    std::shared_ptr<std::vector<File>> level_files =
+        std::make_shared<std::vector<File>>();
+    level_files->reserve(files.size());
+    for (const FileMetaData* f : files) {
+      level_files->push_back({f->fd.GetNumber(), f->fd.GetFileSize(),
+                              f->smallest, f->largest, f->being_compacted});
+    }
+    levels_[level] = std::move(level_files);
+  }
+}
+
+void VersionFilesSnapshot::GetOverlappingFiles(
+    int level, const InternalKey& smallest, const InternalKey& largest,
+    std::vector<const File*>* files) const {
+  if (level < 0 || level >= num_levels()) {
+    return;
+  }
+  const Comparator* ucmp = icmp_->user_comparator();
+  const std::vector<File>& level_files = *levels_[level];
+  Slice begin = smallest.user_key();
+  Slice end = largest.user_key();
+
+  if (level == 0) {
+    // Starts over whenever a file grows the range, skipping the files
+    // already taken
+    std::vector<bool> taken(level_files.size(), false);
+    for (size_t i = 0; i < level_files.size();) {
+      const File& f = level_files[i];
+      if (taken[i] || ucmp->Compare(f.largest.user_key(), begin) < 0 ||
+          ucmp->Compare(f.smallest.user_key(), end) > 0) {
+        i++;
+        continue;
+      }
+      taken[i] = true;
+      files->push_back(&f);
+      bool grown = false;
+      if (ucmp->Compare(f.smallest.user_key(), begin) < 0) {
+        begin = f.smallest.user_key();
+        grown = true;
+      }
+      if (ucmp->Compare(f.largest.user_key(), end) > 0) {
+        end = f.largest.user_key();
+        grown = true;
+      }
+      i = grown ? 0 : i + 1;
+    }
+    return;
+  }
+
+  auto it = std::lower_bound(level_files.begin(), level_files.end(), begin,
+                             [ucmp](const File& f, const Slice& key) {
+                               return ucmp->Compare(f.largest.user_key(),
+                                                    key) < 0;
+                             });
+  for (; it != level_files.end() &&
+         ucmp->Compare(it->smallest.user_key(), end) <= 0;
+       ++it) {
+    files->push_back(&*it);
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
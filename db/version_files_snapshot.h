@@ -0,0 +1,67 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "db/dbformat.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class VersionStorageInfo;
+
+// An immutable copy of the table files of the current Version of a column
+// family. The column family publishes a new one whenever its current Version
+// changes or files start or stop being compacted, and readers hold it by
+// shared_ptr, so they need neither the DB mutex nor a reference to the
+// Version. Meant for the components below the DB, such as the file system,
+// that must not take the DB mutex. The file lists of the levels a new
+// snapshot leaves as they were are shared with the previous one rather
+// than copied.
+class VersionFilesSnapshot {
+ public:
+  struct File {
+    uint64_t number;
+    uint64_t size;
+    InternalKey smallest;
+    InternalKey largest;
+    bool being_compacted;
+  };
+
+  // prev, if not nullptr, is the snapshot this one replaces.
+  // REQUIRES: DB mutex held
+  VersionFilesSnapshot(const InternalKeyComparator* icmp,
+                       const VersionStorageInfo& vstorage,
+                       const VersionFilesSnapshot* prev);
+
+  // No copying allowed
+  VersionFilesSnapshot(const VersionFilesSnapshot&) = delete;
+  void operator=(const VersionFilesSnapshot&) = delete;
+
+  // Outlives the snapshot as long as the column family is not dropped
+  const InternalKeyComparator* icmp() const { return icmp_; }
+
+  int num_levels() const { return static_cast<int>(levels_.size()); }
+
+  // Sorted by smallest key, but for L0, which is newest first
+  const std::vector<File>& LevelFiles(int level) const {
+    return *levels_[level];
+  }
+
+  // Appends to *files the files of level overlapping [smallest, largest] by
+  // user key. As VersionStorageInfo::GetOverlappingInputs(), the range is
+  // grown by the L0 files it overlaps.
+  void GetOverlappingFiles(int level, const InternalKey& smallest,
+                           const InternalKey& largest,
+                           std::vector<const File*>* files) const;
+
+ private:
+  const InternalKeyComparator* const icmp_;
+  std::vector<std::shared_ptr<const std::vector<File>>> levels_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -25,6 +25,7 @@
 #include "db/blob/blob_file_cache.h"
 #include "db/blob/blob_file_reader.h"
 #include "db/blob/blob_index.h"
+#include "db/blob/blob_value_cache.h"
 #include "db/internal_stats.h"
 #include "db/log_reader.h"
 #include "db/log_writer.h"
@@ -60,11 +61,20 @@
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 #include "util/user_comparator_wrapper.h"
+#include "util/vector_iterator.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 namespace {
 
+// Whether all the keys of the file are newer than read_ts, so that a read at
+// it does not see any of them. Files without recorded timestamps are read.
+bool NewerThanReadTimestamp(const Comparator* ucmp, const FileMetaData& f,
+                            const Slice* read_ts) {
+  return read_ts != nullptr && !f.min_timestamp.empty() &&
+         ucmp->CompareTimestamp(f.min_timestamp, *read_ts) > 0;
+}
+
 // Find File in LevelFilesBrief data structure
 // Within an index range defined by left and right
 int FindFileInRange(const InternalKeyComparator& icmp,
@@ -528,10 +538,16 @@ class FilePickerMultiGet {
     return file_hit;
   }
 
-  FdWithKeyRange* GetNextFile() {
+  // Returns the next file that contains keys of the batch. With
+  // stop_at_level_end, returns nullptr instead of moving on to the next level
+  // once the current one has no more such files; the next call then moves on.
+  FdWithKeyRange* GetNextFile(bool stop_at_level_end = false) {
     while (!search_ended_) {
       // Start searching next level.
       if (batch_iter_ == current_level_range_.end()) {
+        if (stop_at_level_end) {
+          return nullptr;
+        }
         search_ended_ = !PrepareNextLevel();
         continue;
       } else {
@@ -564,6 +580,11 @@ class FilePickerMultiGet {
       bool is_last_key_in_file;
       if (!GetNextFileInLevelWithKeys(&next_file_range, &curr_file_index, &f,
                                       &is_last_key_in_file)) {
+        // All the keys of the level have been looked at
+        assert(batch_iter_ == current_level_range_.end());
+        if (stop_at_level_end) {
+          return nullptr;
+        }
         search_ended_ = !PrepareNextLevel();
       } else {
         if (is_last_key_in_file) {
@@ -602,6 +623,11 @@ class FilePickerMultiGet {
 
   const MultiGetRange& CurrentFileRange() { return current_file_range_; }
 
+  // Returns true if the last key of the most recent hit file may also be in
+  // the next file of the level. The next file must then not be looked up
+  // before the results of this one are known.
+  bool MaybeRepeatKey() const { return maybe_repeat_key_; }
+
  private:
   unsigned int num_levels_;
   unsigned int curr_level_;
@@ -755,6 +781,24 @@ class FilePickerMultiGet {
     return false;
   }
 };
+
+// The lookup of the keys of a MultiGet batch in one SST file
+struct SstMultiGetLookup {
+  FdWithKeyRange* f;
+  MultiGetRange file_range;
+  unsigned int level;
+  bool is_last_in_level;
+  Status s;
+  uint64_t nanos;
+
+  SstMultiGetLookup(FdWithKeyRange* _f, const MultiGetRange& _file_range,
+                    unsigned int _level, bool _is_last_in_level)
+      : f(_f),
+        file_range(_file_range),
+        level(_level),
+        is_last_in_level(_is_last_in_level),
+        nanos(0) {}
+};
 }  // anonymous namespace
 
 VersionStorageInfo::~VersionStorageInfo() { delete[] files_; }
@@ -888,7 +932,8 @@ class LevelIterator final : public InternalIterator {
                 bool skip_filters, int level, RangeDelAggregator* range_del_agg,
                 const std::vector<AtomicCompactionUnitBoundary>*
                     compaction_boundaries = nullptr,
-                bool allow_unprepared_value = false)
+                bool allow_unprepared_value = false,
+                size_t max_file_size_for_l0_meta_pin = 0)
       : table_cache_(table_cache),
         read_options_(read_options),
         file_options_(file_options),
@@ -901,6 +946,7 @@ class LevelIterator final : public InternalIterator {
         caller_(caller),
         skip_filters_(skip_filters),
         allow_unprepared_value_(allow_unprepared_value),
+        max_file_size_for_l0_meta_pin_(max_file_size_for_l0_meta_pin),
         file_index_(flevel_->num_files),
         level_(level),
         range_del_agg_(range_del_agg),
@@ -988,12 +1034,36 @@ class LevelIterator final : public InternalIterator {
                *read_options_.iterate_upper_bound, /*b_has_ts=*/false) >= 0;
   }
 
+  // Whether all the keys of the file are below iterate_lower_bound
+  bool FileBeforeLowerBound(size_t file_index) {
+    assert(file_index < flevel_->num_files);
+    return read_options_.iterate_lower_bound != nullptr &&
+           user_comparator_.CompareWithoutTimestamp(
+               ExtractUserKey(flevel_->files[file_index].largest_key),
+               /*a_has_ts=*/true, *read_options_.iterate_lower_bound,
+               /*b_has_ts=*/false) < 0;
+  }
+
+  // Positions at a file out of the iterate bounds without opening it. The
+  // iterator is not valid then.
+  void PruneFile(size_t file_index) {
+    file_index_ = file_index;
+    SetFileIterator(nullptr);
+    PERF_COUNTER_ADD(iter_bound_pruned_file_count, 1);
+  }
+
   InternalIterator* NewFileIterator() {
     assert(file_index_ < flevel_->num_files);
     auto file_meta = flevel_->files[file_index_];
     if (should_sample_) {
       sample_file_read_inc(file_meta.file_metadata);
     }
+    if (NewerThanReadTimestamp(icomparator_.user_comparator(),
+                               *file_meta.file_metadata,
+                               read_options_.timestamp)) {
+      PERF_COUNTER_ADD(timestamp_pruned_file_count, 1);
+      return NewEmptyInternalIterator<Slice>();
+    }
 
     const InternalKey* smallest_compaction_key = nullptr;
     const InternalKey* largest_compaction_key = nullptr;
@@ -1007,7 +1077,7 @@ class LevelIterator final : public InternalIterator {
         range_del_agg_, prefix_extractor_,
         nullptr /* don't need reference to table */, file_read_hist_, caller_,
         /*arena=*/nullptr, skip_filters_, level_,
-        /*max_file_size_for_l0_meta_pin=*/0, smallest_compaction_key,
+        max_file_size_for_l0_meta_pin_, smallest_compaction_key,
         largest_compaction_key, allow_unprepared_value_);
   }
 
@@ -1042,6 +1112,7 @@ class LevelIterator final : public InternalIterator {
   TableReaderCaller caller_;
   bool skip_filters_;
   bool allow_unprepared_value_;
+  size_t max_file_size_for_l0_meta_pin_;
   bool may_be_out_of_lower_bound_ = true;
   size_t file_index_;
   int level_;
@@ -1071,6 +1142,11 @@ void LevelIterator::Seek(const Slice& target) {
   if (need_to_reseek) {
     TEST_SYNC_POINT("LevelIterator::Seek:BeforeFindFile");
     size_t new_file_index = FindFile(icomparator_, *flevel_, target);
+    if (new_file_index < flevel_->num_files &&
+        KeyReachedUpperBound(file_smallest_key(new_file_index))) {
+      PruneFile(new_file_index);
+      return;
+    }
     InitFileIterator(new_file_index);
   }
 
@@ -1112,6 +1188,10 @@ void LevelIterator::SeekForPrev(const Slice& target) {
   if (new_file_index >= flevel_->num_files) {
     new_file_index = flevel_->num_files - 1;
   }
+  if (FileBeforeLowerBound(new_file_index)) {
+    PruneFile(new_file_index);
+    return;
+  }
 
   InitFileIterator(new_file_index);
   if (file_iter_.iter() != nullptr) {
@@ -1122,6 +1202,10 @@ void LevelIterator::SeekForPrev(const Slice& target) {
 }
 
 void LevelIterator::SeekToFirst() {
+  if (KeyReachedUpperBound(file_smallest_key(0))) {
+    PruneFile(0);
+    return;
+  }
   InitFileIterator(0);
   if (file_iter_.iter() != nullptr) {
     file_iter_.SeekToFirst();
@@ -1131,6 +1215,10 @@ void LevelIterator::SeekToFirst() {
 }
 
 void LevelIterator::SeekToLast() {
+  if (FileBeforeLowerBound(flevel_->num_files - 1)) {
+    PruneFile(flevel_->num_files - 1);
+    return;
+  }
   InitFileIterator(flevel_->num_files - 1);
   if (file_iter_.iter() != nullptr) {
     file_iter_.SeekToLast();
@@ -1184,6 +1272,7 @@ bool LevelIterator::SkipEmptyFileForward() {
     }
     if (KeyReachedUpperBound(file_smallest_key(file_index_ + 1))) {
       SetFileIterator(nullptr);
+      PERF_COUNTER_ADD(iter_bound_pruned_file_count, 1);
       break;
     }
     InitFileIterator(file_index_ + 1);
@@ -1203,6 +1292,11 @@ void LevelIterator::SkipEmptyFileBackward() {
       SetFileIterator(nullptr);
       return;
     }
+    if (FileBeforeLowerBound(file_index_ - 1)) {
+      SetFileIterator(nullptr);
+      PERF_COUNTER_ADD(iter_bound_pruned_file_count, 1);
+      return;
+    }
     InitFileIterator(file_index_ - 1);
     if (file_iter_.iter() != nullptr) {
       file_iter_.SeekToLast();
@@ -1608,6 +1702,30 @@ void Version::AddIteratorsForLevel(const ReadOptions& read_options,
     // Merge all level zero files together since they may overlap
     for (size_t i = 0; i < storage_info_.LevelFilesBrief(0).num_files; i++) {
       const auto& file = storage_info_.LevelFilesBrief(0).files[i];
+      if (NewerThanReadTimestamp(user_comparator(), *file.file_metadata,
+                                 read_options.timestamp)) {
+        PERF_COUNTER_ADD(timestamp_pruned_file_count, 1);
+        continue;
+      }
+      if (read_options.iterate_lower_bound != nullptr ||
+          read_options.iterate_upper_bound != nullptr) {
+        // A level iterator of the one file opens it only when seeking
+        // within the bounds, and past its smallest key
+        auto* flevel = new (arena->AllocateAligned(sizeof(LevelFilesBrief)))
+            LevelFilesBrief();
+        flevel->num_files = 1;
+        flevel->files = storage_info_.LevelFilesBrief(0).files + i;
+        auto* mem = arena->AllocateAligned(sizeof(LevelIterator));
+        merge_iter_builder->AddIterator(new (mem) LevelIterator(
+            cfd_->table_cache(), read_options, soptions,
+            cfd_->internal_comparator(), flevel,
+            mutable_cf_options_.prefix_extractor.get(),
+            /*should_sample=*/false, cfd_->internal_stats()->GetFileReadHist(0),
+            TableReaderCaller::kUserIterator, /*skip_filters=*/false,
+            /*level=*/0, range_del_agg, /*compaction_boundaries=*/nullptr,
+            allow_unprepared_value, max_file_size_for_l0_meta_pin_));
+        continue;
+      }
       merge_iter_builder->AddIterator(cfd_->table_cache()->NewIterator(
           read_options, soptions, cfd_->internal_comparator(),
           *file.file_metadata, range_del_agg,
@@ -1761,6 +1879,7 @@ Version::Version(ColumnFamilyData* column_family_data, VersionSet* vset,
                                        : cfd_->ioptions()->statistics),
       table_cache_((cfd_ == nullptr) ? nullptr : cfd_->table_cache()),
       blob_file_cache_(cfd_ ? cfd_->blob_file_cache() : nullptr),
+      blob_cache_(cfd_ ? cfd_->ioptions()->blob_cache.get() : nullptr),
       merge_operator_((cfd_ == nullptr) ? nullptr
                                         : cfd_->ioptions()->merge_operator),
       storage_info_(
@@ -1788,10 +1907,6 @@ Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
                         PinnableSlice* value) const {
   assert(value);
 
-  if (read_options.read_tier == kBlockCacheTier) {
-    return Status::Incomplete("Cannot read blob: no disk I/O allowed");
-  }
-
   BlobIndex blob_index;
 
   {
@@ -1805,10 +1920,24 @@ Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
     return Status::Corruption("Unexpected TTL/inlined blob index");
   }
 
-  const auto& blob_files = storage_info_.GetBlobFiles();
-
   const uint64_t blob_file_number = blob_index.file_number();
 
+  std::string cache_key;
+  if (blob_cache_) {
+    cache_key = BlobValueCache::GetKey(vset_->blob_cache_key_prefix(),
+                                       blob_file_number, blob_index.offset());
+    if (BlobValueCache::Lookup(blob_cache_, cache_key, db_statistics_,
+                               value)) {
+      return Status::OK();
+    }
+  }
+
+  if (read_options.read_tier == kBlockCacheTier) {
+    return Status::Incomplete("Cannot read blob: no disk I/O allowed");
+  }
+
+  const auto& blob_files = storage_info_.GetBlobFiles();
+
   const auto it = blob_files.find(blob_file_number);
   if (it == blob_files.end()) {
     return Status::Corruption("Invalid blob file number");
@@ -1830,9 +1959,156 @@ Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
       read_options, user_key, blob_index.offset(), blob_index.size(),
       blob_index.compression(), value);
 
+  if (s.ok() && blob_cache_ && read_options.fill_cache) {
+    BlobValueCache::Insert(blob_cache_, cache_key, *value, db_statistics_);
+  }
+
   return s;
 }
 
+void Version::MultiGetBlob(const ReadOptions& read_options,
+                           MultiGetRange* range,
+                           BlobReadRequests* blob_rqs) const {
+  assert(range);
+  assert(blob_rqs);
+
+  const auto& blob_files = storage_info_.GetBlobFiles();
+
+  for (auto& pair : *blob_rqs) {
+    const uint64_t blob_file_number = pair.first;
+    auto& key_rqs = pair.second;
+
+    std::vector<BlobFileReader::BlobReadRequest> read_reqs;
+    read_reqs.reserve(key_rqs.size());
+
+    for (auto& key_rq : key_rqs) {
+      const BlobIndex& blob_index = key_rq.first;
+      KeyContext* const key_context = key_rq.second;
+      assert(key_context);
+
+      if (blob_index.HasTTL() || blob_index.IsInlined()) {
+        *key_context->s =
+            Status::Corruption("Unexpected TTL/inlined blob index");
+        continue;
+      }
+
+      if (blob_cache_ &&
+          BlobValueCache::Lookup(
+              blob_cache_,
+              BlobValueCache::GetKey(vset_->blob_cache_key_prefix(),
+                                     blob_file_number, blob_index.offset()),
+              db_statistics_, key_context->value)) {
+        range->AddValueSize(key_context->value->size());
+        continue;
+      }
+
+      read_reqs.push_back({&key_context->ukey, blob_index.offset(),
+                           blob_index.size(), blob_index.compression(),
+                           key_context->value, key_context->s});
+    }
+
+    if (read_reqs.empty()) {
+      continue;
+    }
+
+    Status s;
+    CacheHandleGuard<BlobFileReader> blob_file_reader;
+
+    if (read_options.read_tier == kBlockCacheTier) {
+      s = Status::Incomplete("Cannot read blob: no disk I/O allowed");
+    } else if (blob_files.find(blob_file_number) == blob_files.end()) {
+      s = Status::Corruption("Invalid blob file number");
+    } else {
+      assert(blob_file_cache_);
+      s = blob_file_cache_->GetBlobFileReader(blob_file_number,
+                                              &blob_file_reader);
+    }
+
+    if (!s.ok()) {
+      for (const auto& read_req : read_reqs) {
+        *read_req.status = s;
+      }
+      continue;
+    }
+
+    std::sort(read_reqs.begin(), read_reqs.end(),
+              [](const BlobFileReader::BlobReadRequest& lhs,
+                 const BlobFileReader::BlobReadRequest& rhs) {
+                return lhs.offset < rhs.offset;
+              });
+
+    assert(blob_file_reader.GetValue());
+    blob_file_reader.GetValue()->MultiGetBlob(read_options, &read_reqs);
+
+    for (const auto& read_req : read_reqs) {
+      if (!read_req.status->ok()) {
+        continue;
+      }
+
+      range->AddValueSize(read_req.value->size());
+
+      if (blob_cache_ && read_options.fill_cache) {
+        BlobValueCache::Insert(
+            blob_cache_,
+            BlobValueCache::GetKey(vset_->blob_cache_key_prefix(),
+                                   blob_file_number, read_req.offset),
+            *read_req.value, db_statistics_);
+      }
+    }
+  }
+
+  blob_rqs->clear();
+}
+
+bool Version::MayHaveCoveringRangeTombstone(const ReadOptions& read_options,
+                                            const Slice& user_key) {
+  std::call_once(range_tombstone_index_once_,
+                 [this]() { BuildRangeTombstoneIndex(); });
+  if (range_tombstone_index_ == nullptr) {
+    return true;
+  }
+  if (range_tombstone_index_->empty()) {
+    return false;
+  }
+  // Same visibility as the tombstone iterators of the table readers
+  SequenceNumber snapshot = kMaxSequenceNumber;
+  if (read_options.snapshot != nullptr) {
+    snapshot = read_options.snapshot->GetSequenceNumber();
+  }
+  FragmentedRangeTombstoneIterator iter(range_tombstone_index_.get(),
+                                        *internal_comparator(), snapshot);
+  return iter.MaxCoveringTombstoneSeqnum(user_key) > 0;
+}
+
+void Version::BuildRangeTombstoneIndex() {
+  ReadOptions read_options;
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (int level = 0; level < storage_info_.num_non_empty_levels(); level++) {
+    for (const FileMetaData* file : storage_info_.LevelFiles(level)) {
+      TableReader* table_reader = file->fd.table_reader;
+      if (table_reader == nullptr) {
+        // Reading the tombstones of a table that is not open would cost the
+        // triggering lookup I/O
+        return;
+      }
+      std::unique_ptr<FragmentedRangeTombstoneIterator> iter(
+          table_reader->NewRangeTombstoneIterator(read_options));
+      if (iter == nullptr) {
+        continue;
+      }
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        keys.emplace_back(iter->key().data(), iter->key().size());
+        values.emplace_back(iter->value().data(), iter->value().size());
+      }
+    }
+  }
+  std::unique_ptr<InternalIterator> unfragmented(new VectorIterator(
+      std::move(keys), std::move(values), internal_comparator()));
+  range_tombstone_index_.reset(new FragmentedRangeTombstoneList(
+      std::move(unfragmented), *internal_comparator()));
+}
+
 void Version::Get(const ReadOptions& read_options, const LookupKey& k,
                   PinnableSlice* value, std::string* timestamp, Status* status,
                   MergeContext* merge_context,
@@ -1862,13 +2138,21 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
   bool is_blob_index = false;
   bool* const is_blob_to_use = is_blob ? is_blob : &is_blob_index;
 
+  // Without a range tombstone covering the key in any table, the tables need
+  // not be searched for one
+  SequenceNumber* const table_max_covering_tombstone_seq =
+      read_options.ignore_range_deletions ||
+              MayHaveCoveringRangeTombstone(read_options, user_key)
+          ? max_covering_tombstone_seq
+          : nullptr;
+
   GetContext get_context(
       user_comparator(), merge_operator_, info_log_, db_statistics_,
       status->ok() ? GetContext::kNotFound : GetContext::kMerge, user_key,
       do_merge ? value : nullptr, do_merge ? timestamp : nullptr, value_found,
-      merge_context, do_merge, max_covering_tombstone_seq, this->env_, seq,
-      merge_operator_ ? &pinned_iters_mgr : nullptr, callback, is_blob_to_use,
-      tracing_get_id);
+      merge_context, do_merge, table_max_covering_tombstone_seq, this->env_,
+      seq, merge_operator_ ? &pinned_iters_mgr : nullptr, callback,
+      is_blob_to_use, tracing_get_id);
 
   // Pin blocks that we read to hold merge operands
   if (merge_operator_) {
@@ -1887,6 +2171,12 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
       // stop here.
       break;
     }
+    if (NewerThanReadTimestamp(user_comparator(), *f->file_metadata,
+                               read_options.timestamp)) {
+      PERF_COUNTER_ADD(timestamp_pruned_file_count, 1);
+      f = fp.GetNextFile();
+      continue;
+    }
     if (get_context.sample()) {
       sample_file_read_inc(f->file_metadata);
     }
@@ -2019,8 +2309,8 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
         iter->s->ok() ? GetContext::kNotFound : GetContext::kMerge, iter->ukey,
         iter->value, iter->timestamp, nullptr, &(iter->merge_context), true,
         &iter->max_covering_tombstone_seq, this->env_, nullptr,
-        merge_operator_ ? &pinned_iters_mgr : nullptr, callback, is_blob,
-        tracing_mget_id);
+        merge_operator_ ? &pinned_iters_mgr : nullptr, callback,
+        is_blob ? is_blob : &iter->is_blob_index, tracing_mget_id);
     // MergeInProgress status, if set, has been transferred to the get_context
     // state, so we set status to ok here. From now on, the iter status will
     // be used for IO errors, and get_context state will be used for any
@@ -2045,135 +2335,231 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
   uint64_t num_data_read = 0;
   uint64_t num_sst_read = 0;
 
-  while (f != nullptr) {
-    MultiGetRange file_range = fp.CurrentFileRange();
-    bool timer_enabled =
-        GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex &&
-        get_perf_context()->per_level_perf_context_enabled;
+  // Blob references are resolved after the SST lookups, so that the blobs
+  // living in the same blob file can be read together. Like in Get(), this
+  // is only done for the integrated BlobDB implementation.
+  BlobReadRequests blob_rqs;
+
+  // The files of a level other than L0 hold disjoint key ranges, so each key
+  // is looked up in at most one of them, and their lookups can be issued
+  // concurrently. The results are still processed file by file in order.
+  // Merge operands pin blocks through a shared PinnedIteratorsManager, and
+  // the callback and is_blob are shared by all the keys, so those cases stay
+  // sequential.
+  const bool parallel_lookup =
+      read_options.optimize_multiget_for_io && merge_operator_ == nullptr &&
+      callback == nullptr && is_blob == nullptr &&
+      env_->GetBackgroundThreads(Env::Priority::USER) > 0;
+  const bool timer_enabled =
+      GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex &&
+      get_perf_context()->per_level_perf_context_enabled;
+  auto lookup_file = [&](SstMultiGetLookup* lookup) {
+    if (NewerThanReadTimestamp(user_comparator(), *lookup->f->file_metadata,
+                               read_options.timestamp)) {
+      PERF_COUNTER_ADD(timestamp_pruned_file_count, 1);
+      lookup->s = Status::OK();
+      return;
+    }
     StopWatchNano timer(env_, timer_enabled /* auto_start */);
-    s = table_cache_->MultiGet(
-        read_options, *internal_comparator(), *f->file_metadata, &file_range,
-        mutable_cf_options_.prefix_extractor.get(),
-        cfd_->internal_stats()->GetFileReadHist(fp.GetHitFileLevel()),
-        IsFilterSkipped(static_cast<int>(fp.GetHitFileLevel()),
-                        fp.IsHitFileLastInLevel()),
-        fp.GetHitFileLevel());
-    // TODO: examine the behavior for corrupted key
+    lookup->s = table_cache_->MultiGet(
+        read_options, *internal_comparator(), *lookup->f->file_metadata,
+        &lookup->file_range, mutable_cf_options_.prefix_extractor.get(),
+        cfd_->internal_stats()->GetFileReadHist(lookup->level),
+        IsFilterSkipped(static_cast<int>(lookup->level),
+                        lookup->is_last_in_level),
+        lookup->level);
     if (timer_enabled) {
-      PERF_COUNTER_BY_LEVEL_ADD(get_from_table_nanos, timer.ElapsedNanos(),
-                                fp.GetHitFileLevel());
+      lookup->nanos = timer.ElapsedNanos();
     }
-    if (!s.ok()) {
-      // TODO: Set status for individual keys appropriately
-      for (auto iter = file_range.begin(); iter != file_range.end(); ++iter) {
-        *iter->s = s;
-        file_range.MarkKeyDone(iter);
+  };
+
+  while (f != nullptr) {
+    autovector<SstMultiGetLookup, 4> lookups;
+    lookups.emplace_back(f, fp.CurrentFileRange(), fp.GetHitFileLevel(),
+                         fp.IsHitFileLastInLevel());
+    if (parallel_lookup && fp.GetHitFileLevel() > 0) {
+      while (!fp.MaybeRepeatKey() &&
+             (f = fp.GetNextFile(/*stop_at_level_end=*/true)) != nullptr) {
+        lookups.emplace_back(f, fp.CurrentFileRange(), fp.GetHitFileLevel(),
+                             fp.IsHitFileLastInLevel());
+      }
+    }
+
+    if (lookups.size() > 1) {
+      port::Mutex mu;
+      port::CondVar cv(&mu);
+      size_t pending = lookups.size() - 1;
+      std::vector<std::function<void()>> jobs;
+      jobs.reserve(pending);
+      for (size_t i = 1; i < lookups.size(); ++i) {
+        jobs.emplace_back([&, i]() {
+          TEST_SYNC_POINT("Version::MultiGet:ParallelLookup");
+          lookup_file(&lookups[i]);
+          MutexLock l(&mu);
+          if (--pending == 0) {
+            cv.Signal();
+          }
+        });
       }
-      return;
-    }
-    uint64_t batch_size = 0;
-    for (auto iter = file_range.begin(); s.ok() && iter != file_range.end();
-         ++iter) {
-      GetContext& get_context = *iter->get_context;
-      Status* status = iter->s;
-      // The Status in the KeyContext takes precedence over GetContext state
-      // Status may be an error if there were any IO errors in the table
-      // reader. We never expect Status to be NotFound(), as that is
-      // determined by get_context
-      assert(!status->IsNotFound());
-      if (!status->ok()) {
-        file_range.MarkKeyDone(iter);
-        continue;
+      for (auto& job : jobs) {
+        env_->Schedule(
+            [](void* arg) { (*static_cast<std::function<void()>*>(arg))(); },
+            &job, Env::Priority::USER);
       }
-
-      if (get_context.sample()) {
-        sample_file_read_inc(f->file_metadata);
+      lookup_file(&lookups[0]);
+      MutexLock l(&mu);
+      while (pending > 0) {
+        cv.Wait();
       }
-      batch_size++;
-      num_index_read += get_context.get_context_stats_.num_index_read;
-      num_filter_read += get_context.get_context_stats_.num_filter_read;
-      num_data_read += get_context.get_context_stats_.num_data_read;
-      num_sst_read += get_context.get_context_stats_.num_sst_read;
+    } else {
+      lookup_file(&lookups[0]);
+    }
 
-      // report the counters before returning
-      if (get_context.State() != GetContext::kNotFound &&
-          get_context.State() != GetContext::kMerge &&
-          db_statistics_ != nullptr) {
-        get_context.ReportCounters();
-      } else {
-        if (iter->max_covering_tombstone_seq > 0) {
-          // The remaining files we look at will only contain covered keys, so
-          // we stop here for this key
-          file_picker_range.SkipKey(iter);
-        }
+    for (auto& lookup : lookups) {
+      MultiGetRange& file_range = lookup.file_range;
+      const unsigned int hit_file_level = lookup.level;
+      s = lookup.s;
+      // TODO: examine the behavior for corrupted key
+      if (timer_enabled) {
+        PERF_COUNTER_BY_LEVEL_ADD(get_from_table_nanos, lookup.nanos,
+                                  hit_file_level);
       }
-      switch (get_context.State()) {
-        case GetContext::kNotFound:
-          // Keep searching in other files
-          break;
-        case GetContext::kMerge:
-          // TODO: update per-level perfcontext user_key_return_count for kMerge
-          break;
-        case GetContext::kFound:
-          if (fp.GetHitFileLevel() == 0) {
-            RecordTick(db_statistics_, GET_HIT_L0);
-          } else if (fp.GetHitFileLevel() == 1) {
-            RecordTick(db_statistics_, GET_HIT_L1);
-          } else if (fp.GetHitFileLevel() >= 2) {
-            RecordTick(db_statistics_, GET_HIT_L2_AND_UP);
-          }
-          PERF_COUNTER_BY_LEVEL_ADD(user_key_return_count, 1,
-                                    fp.GetHitFileLevel());
-          file_range.AddValueSize(iter->value->size());
-          file_range.MarkKeyDone(iter);
-          if (file_range.GetValueSize() > read_options.value_size_soft_limit) {
-            s = Status::Aborted();
-            break;
-          }
-          continue;
-        case GetContext::kDeleted:
-          // Use empty error message for speed
-          *status = Status::NotFound();
-          file_range.MarkKeyDone(iter);
-          continue;
-        case GetContext::kCorrupt:
-          *status =
-              Status::Corruption("corrupted key for ", iter->lkey->user_key());
+      if (!s.ok()) {
+        // TODO: Set status for individual keys appropriately
+        for (auto iter = file_range.begin(); iter != file_range.end();
+             ++iter) {
+          *iter->s = s;
           file_range.MarkKeyDone(iter);
-          continue;
-        case GetContext::kUnexpectedBlobIndex:
-          ROCKS_LOG_ERROR(info_log_, "Encounter unexpected blob index.");
-          *status = Status::NotSupported(
-              "Encounter unexpected blob index. Please open DB with "
-              "ROCKSDB_NAMESPACE::blob_db::BlobDB instead.");
+        }
+        MultiGetBlob(read_options, range, &blob_rqs);
+        return;
+      }
+      uint64_t batch_size = 0;
+      for (auto iter = file_range.begin(); s.ok() && iter != file_range.end();
+           ++iter) {
+        GetContext& get_context = *iter->get_context;
+        Status* status = iter->s;
+        // The Status in the KeyContext takes precedence over GetContext state
+        // Status may be an error if there were any IO errors in the table
+        // reader. We never expect Status to be NotFound(), as that is
+        // determined by get_context
+        assert(!status->IsNotFound());
+        if (!status->ok()) {
           file_range.MarkKeyDone(iter);
           continue;
+        }
+
+        if (get_context.sample()) {
+          sample_file_read_inc(lookup.f->file_metadata);
+        }
+        batch_size++;
+        num_index_read += get_context.get_context_stats_.num_index_read;
+        num_filter_read += get_context.get_context_stats_.num_filter_read;
+        num_data_read += get_context.get_context_stats_.num_data_read;
+        num_sst_read += get_context.get_context_stats_.num_sst_read;
+
+        // report the counters before returning
+        if (get_context.State() != GetContext::kNotFound &&
+            get_context.State() != GetContext::kMerge &&
+            db_statistics_ != nullptr) {
+          get_context.ReportCounters();
+        } else {
+          if (iter->max_covering_tombstone_seq > 0) {
+            // The remaining files we look at will only contain covered keys,
+            // so we stop here for this key
+            file_picker_range.SkipKey(iter);
+          }
+        }
+        switch (get_context.State()) {
+          case GetContext::kNotFound:
+            // Keep searching in other files
+            break;
+          case GetContext::kMerge:
+            // TODO: update per-level perfcontext user_key_return_count for
+            // kMerge
+            break;
+          case GetContext::kFound:
+            if (hit_file_level == 0) {
+              RecordTick(db_statistics_, GET_HIT_L0);
+            } else if (hit_file_level == 1) {
+              RecordTick(db_statistics_, GET_HIT_L1);
+            } else if (hit_file_level >= 2) {
+              RecordTick(db_statistics_, GET_HIT_L2_AND_UP);
+            }
+            PERF_COUNTER_BY_LEVEL_ADD(user_key_return_count, 1,
+                                      hit_file_level);
+            file_range.MarkKeyDone(iter);
+
+            if (iter->is_blob_index) {
+              if (iter->value) {
+                BlobIndex blob_index;
+                *status = blob_index.DecodeFrom(*iter->value);
+                if (status->ok()) {
+                  blob_rqs[blob_index.file_number()].emplace_back(
+                      blob_index, &*iter);
+                }
+              }
+              // The size of the blob is accounted for once it is retrieved
+              continue;
+            }
+
+            file_range.AddValueSize(iter->value->size());
+            if (file_range.GetValueSize() >
+                read_options.value_size_soft_limit) {
+              s = Status::Aborted();
+              break;
+            }
+            continue;
+          case GetContext::kDeleted:
+            // Use empty error message for speed
+            *status = Status::NotFound();
+            file_range.MarkKeyDone(iter);
+            continue;
+          case GetContext::kCorrupt:
+            *status = Status::Corruption("corrupted key for ",
+                                         iter->lkey->user_key());
+            file_range.MarkKeyDone(iter);
+            continue;
+          case GetContext::kUnexpectedBlobIndex:
+            ROCKS_LOG_ERROR(info_log_, "Encounter unexpected blob index.");
+            *status = Status::NotSupported(
+                "Encounter unexpected blob index. Please open DB with "
+                "ROCKSDB_NAMESPACE::blob_db::BlobDB instead.");
+            file_range.MarkKeyDone(iter);
+            continue;
+        }
       }
-    }
 
-    // Report MultiGet stats per level.
-    if (fp.IsHitFileLastInLevel()) {
-      // Dump the stats if this is the last file of this level and reset for
-      // next level.
-      RecordInHistogram(db_statistics_,
-                        NUM_INDEX_AND_FILTER_BLOCKS_READ_PER_LEVEL,
-                        num_index_read + num_filter_read);
-      RecordInHistogram(db_statistics_, NUM_DATA_BLOCKS_READ_PER_LEVEL,
-                        num_data_read);
-      RecordInHistogram(db_statistics_, NUM_SST_READ_PER_LEVEL, num_sst_read);
-      num_filter_read = 0;
-      num_index_read = 0;
-      num_data_read = 0;
-      num_sst_read = 0;
+      // Report MultiGet stats per level.
+      if (lookup.is_last_in_level) {
+        // Dump the stats if this is the last file of this level and reset for
+        // next level.
+        RecordInHistogram(db_statistics_,
+                          NUM_INDEX_AND_FILTER_BLOCKS_READ_PER_LEVEL,
+                          num_index_read + num_filter_read);
+        RecordInHistogram(db_statistics_, NUM_DATA_BLOCKS_READ_PER_LEVEL,
+                          num_data_read);
+        RecordInHistogram(db_statistics_, NUM_SST_READ_PER_LEVEL,
+                          num_sst_read);
+        num_filter_read = 0;
+        num_index_read = 0;
+        num_data_read = 0;
+        num_sst_read = 0;
+      }
+
+      RecordInHistogram(db_statistics_, SST_BATCH_SIZE, batch_size);
+      if (!s.ok() || file_picker_range.empty()) {
+        break;
+      }
     }
-
-    RecordInHistogram(db_statistics_, SST_BATCH_SIZE, batch_size);
     if (!s.ok() || file_picker_range.empty()) {
       break;
     }
     f = fp.GetNextFile();
   }
 
+  MultiGetBlob(read_options, range, &blob_rqs);
+
   // Process any left over keys
   for (auto iter = range->begin(); s.ok() && iter != range->end(); ++iter) {
     GetContext& get_context = *iter->get_context;
@@ -2328,9 +2714,11 @@ void Version::UpdateAccumulatedStats(bool update_stats) {
           // already been read, so MaybeInitializeFileMetaData() won't incur
           // any I/O cost. "max_open_files=-1" means that the table cache passed
           // to the VersionSet and then to the ColumnFamilySet has a size of
-          // TableCache::kInfiniteCapacity
+          // TableCache::kInfiniteCapacity. Unless the files are opened
+          // lazily, in which case the file may not have been read yet.
           if (vset_->GetColumnFamilySet()->get_table_cache()->GetCapacity() ==
-              TableCache::kInfiniteCapacity) {
+                  TableCache::kInfiniteCapacity &&
+              file_meta->fd.table_reader != nullptr) {
             continue;
           }
           if (++init_count >= kMaxInitCount) {
@@ -2569,6 +2957,9 @@ void VersionStorageInfo::ComputeCompactionScore(
               score);
         }
 
+      } else if (compaction_style_ == kCompactionStyleUniversal) {
+        score = static_cast<double>(num_sorted_runs) /
+                UniversalCompactionTrigger(mutable_cf_options);
       } else {
         score = static_cast<double>(num_sorted_runs) /
                 mutable_cf_options.level0_file_num_compaction_trigger;
@@ -2878,6 +3269,57 @@ void SortFileByOverlappingRatio(
                      file_to_order[f2.file->fd.GetNumber()];
             });
 }
+
+// Sort `temp` in descending order of the sampled reads of a file times the
+// number of files such a read may check: the file, the L0 files it overlaps
+// if it is in L0, and one file in each lower level that has an overlapping
+// file. Ties are broken in favor of larger files.
+void SortFileByReadHotness(const InternalKeyComparator& icmp,
+                           const std::vector<FileMetaData*>* files, int level,
+                           int num_levels, std::vector<Fsize>* temp) {
+  const Comparator* ucmp = icmp.user_comparator();
+  std::unordered_map<uint64_t, uint64_t> file_to_order;
+
+  for (auto* file : files[level]) {
+    const Slice smallest = file->smallest.user_key();
+    const Slice largest = file->largest.user_key();
+    uint64_t read_amp = 1;
+    if (level == 0) {
+      for (auto* other : files[0]) {
+        if (other != file &&
+            ucmp->Compare(other->largest.user_key(), smallest) >= 0 &&
+            ucmp->Compare(other->smallest.user_key(), largest) <= 0) {
+          read_amp++;
+        }
+      }
+    }
+    for (int lower = std::max(level + 1, 1); lower < num_levels; lower++) {
+      const std::vector<FileMetaData*>& lower_files = files[lower];
+      auto it = std::lower_bound(
+          lower_files.begin(), lower_files.end(), smallest,
+          [&](const FileMetaData* f, const Slice& key) {
+            return ucmp->Compare(f->largest.user_key(), key) < 0;
+          });
+      if (it != lower_files.end() &&
+          ucmp->Compare((*it)->smallest.user_key(), largest) <= 0) {
+        read_amp++;
+      }
+    }
+    file_to_order[file->fd.GetNumber()] =
+        file->stats.num_reads_sampled.load(std::memory_order_relaxed) *
+        read_amp;
+  }
+
+  std::sort(temp->begin(), temp->end(),
+            [&](const Fsize& f1, const Fsize& f2) -> bool {
+              uint64_t order1 = file_to_order[f1.file->fd.GetNumber()];
+              uint64_t order2 = file_to_order[f2.file->fd.GetNumber()];
+              if (order1 != order2) {
+                return order1 > order2;
+              }
+              return CompareCompensatedSizeDescending(f1, f2);
+            });
+}
 }  // namespace
 
 void VersionStorageInfo::UpdateFilesByCompactionPri(
@@ -2929,6 +3371,10 @@ void VersionStorageInfo::UpdateFilesByCompactionPri(
         SortFileByOverlappingRatio(*internal_comparator_, files_[level],
                                    files_[level + 1], &temp);
         break;
+      case kByReadHotness:
+        SortFileByReadHotness(*internal_comparator_, files_, level,
+                              num_levels(), &temp);
+        break;
       default:
         assert(false);
     }
@@ -3764,7 +4210,8 @@ VersionSet::VersionSet(const std::string& dbname,
       manifest_file_size_(0),
       file_options_(storage_options),
       block_cache_tracer_(block_cache_tracer),
-      io_tracer_(io_tracer) {}
+      io_tracer_(io_tracer),
+      blob_cache_key_prefix_(BlobValueCache::NewKeyPrefix()) {}
 
 VersionSet::~VersionSet() {
   // we need to delete column_family_set_ because its destructor depends on
@@ -4837,18 +5284,22 @@ Status VersionSet::Recover(
       auto builder = builders_iter->second->version_builder();
 
       // unlimited table cache. Pre-load table handle now.
-      // Need to do it out of the mutex.
-      s = builder->LoadTableHandlers(
-          cfd->internal_stats(), db_options_->max_file_opening_threads,
-          false /* prefetch_index_and_filter_in_cache */,
-          true /* is_initial_load */,
-          cfd->GetLatestMutableCFOptions()->prefix_extractor.get(),
-          MaxFileSizeForL0MetaPin(*cfd->GetLatestMutableCFOptions()));
-      if (!s.ok()) {
-        if (db_options_->paranoid_checks) {
-          return s;
+      // Need to do it out of the mutex. With lazy_open_table_files, the
+      // tables are opened on their first access and by DBImpl in the
+      // background instead.
+      if (read_only || !db_options_->lazy_open_table_files) {
+        s = builder->LoadTableHandlers(
+            cfd->internal_stats(), db_options_->max_file_opening_threads,
+            false /* prefetch_index_and_filter_in_cache */,
+            true /* is_initial_load */,
+            cfd->GetLatestMutableCFOptions()->prefix_extractor.get(),
+            MaxFileSizeForL0MetaPin(*cfd->GetLatestMutableCFOptions()));
+        if (!s.ok()) {
+          if (db_options_->paranoid_checks) {
+            return s;
+          }
+          s = Status::OK();
         }
-        s = Status::OK();
       }
 
       Version* v = new Version(cfd, this, file_options_,
@@ -5558,7 +6009,8 @@ Status VersionSet::WriteCurrentStateToManifest(
                        f->fd.smallest_seqno, f->fd.largest_seqno,
                        f->marked_for_compaction, f->oldest_blob_file_number,
                        f->oldest_ancester_time, f->file_creation_time,
-                       f->file_checksum, f->file_checksum_func_name);
+                       f->file_checksum, f->file_checksum_func_name,
+                       f->min_timestamp, f->max_timestamp);
         }
       }
 
@@ -5872,15 +6324,16 @@ InternalIterator* VersionSet::MakeInputIterator(
   // Level-0 files have to be merged together.  For other levels,
   // we will make a concatenating iterator per level.
   // TODO(opt): use concatenating iterator for level-0 if there is no overlap
-  const size_t space = (c->level() == 0 ? c->input_levels(0)->num_files +
-                                              c->num_input_levels() - 1
-                                        : c->num_input_levels());
+  const size_t space =
+      (c->level() == 0 ? c->input_levels_to_read(0)->num_files +
+                             c->num_input_levels() - 1
+                       : c->num_input_levels());
   InternalIterator** list = new InternalIterator* [space];
   size_t num = 0;
   for (size_t which = 0; which < c->num_input_levels(); which++) {
-    if (c->input_levels(which)->num_files != 0) {
+    if (c->input_levels_to_read(which)->num_files != 0) {
       if (c->level(which) == 0) {
-        const LevelFilesBrief* flevel = c->input_levels(which);
+        const LevelFilesBrief* flevel = c->input_levels_to_read(which);
         for (size_t i = 0; i < flevel->num_files; i++) {
           list[num++] = cfd->table_cache()->NewIterator(
               read_options, file_options_compactions,
@@ -5900,13 +6353,13 @@ InternalIterator* VersionSet::MakeInputIterator(
         // Create concatenating iterator for the files from this level
         list[num++] = new LevelIterator(
             cfd->table_cache(), read_options, file_options_compactions,
-            cfd->internal_comparator(), c->input_levels(which),
+            cfd->internal_comparator(), c->input_levels_to_read(which),
             c->mutable_cf_options()->prefix_extractor.get(),
             /*should_sample=*/false,
             /*no per level latency histogram=*/nullptr,
             TableReaderCaller::kCompaction, /*skip_filters=*/false,
             /*level=*/static_cast<int>(c->level(which)), range_del_agg,
-            c->boundaries(which));
+            c->boundaries_to_read(which));
       }
     }
   }
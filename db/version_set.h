@@ -24,6 +24,7 @@
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -31,6 +32,7 @@
 
 #include "cache/cache_helpers.h"
 #include "db/blob/blob_file_meta.h"
+#include "db/blob/blob_index.h"
 #include "db/column_family.h"
 #include "db/compaction/compaction.h"
 #include "db/compaction/compaction_picker.h"
@@ -121,6 +123,8 @@ class VersionStorageInfo {
 
   void Reserve(int level, size_t size) { files_[level].reserve(size); }
 
+  void ReserveFileLocations(size_t size) { file_locations_.reserve(size); }
+
   void AddFile(int level, FileMetaData* f);
 
   void AddBlobFile(std::shared_ptr<BlobFileMetaData> blob_file_meta);
@@ -763,6 +767,23 @@ class Version {
 
   const MutableCFOptions& GetMutableCFOptions() { return mutable_cf_options_; }
 
+  // Interprets *value as a blob reference, and (assuming the corresponding
+  // blob file is part of this Version) retrieves the blob and saves it in
+  // *value, replacing the blob reference.
+  // REQUIRES: *value stores an encoded blob reference
+  Status GetBlob(const ReadOptions& read_options, const Slice& user_key,
+                 PinnableSlice* value) const;
+
+  // Blob references found by MultiGet, grouped by blob file number
+  using BlobReadRequests =
+      std::map<uint64_t, std::vector<std::pair<BlobIndex, KeyContext*>>>;
+
+  // Retrieves the blobs in *blob_rqs with one batched read per blob file and
+  // saves them in the values of the corresponding keys, replacing the blob
+  // references. The status of each key is updated on failure.
+  void MultiGetBlob(const ReadOptions& read_options, MultiGetRange* range,
+                    BlobReadRequests* blob_rqs) const;
+
   //Used only for ZenFS experiment
   const Comparator* User_comparator() const {
       return storage_info_.user_comparator_;
@@ -781,13 +802,6 @@ class Version {
     return storage_info_.user_comparator_;
   }
 
-  // Interprets *value as a blob reference, and (assuming the corresponding
-  // blob file is part of this Version) retrieves the blob and saves it in
-  // *value, replacing the blob reference.
-  // REQUIRES: *value stores an encoded blob reference
-  Status GetBlob(const ReadOptions& read_options, const Slice& user_key,
-                 PinnableSlice* value) const;
-
   // Returns true if the filter blocks in the specified level will not be
   // checked during read operations. In certain cases (trivial move or preload),
   // the filter block may already be cached, but we still do not access it such
@@ -808,11 +822,21 @@ class Version {
   // first.
   void UpdateFilesByCompactionPri();
 
+  // Returns false if no range tombstone in the table files of this version
+  // that is visible to read_options covers user_key, and true if one may.
+  bool MayHaveCoveringRangeTombstone(const ReadOptions& read_options,
+                                     const Slice& user_key);
+
+  // Merges the range tombstones of all table files into
+  // range_tombstone_index_, if all their table readers are held open.
+  void BuildRangeTombstoneIndex();
+
   ColumnFamilyData* cfd_;  // ColumnFamilyData to which this Version belongs
   Logger* info_log_;
   Statistics* db_statistics_;
   TableCache* table_cache_;
   BlobFileCache* blob_file_cache_;
+  Cache* blob_cache_;
   const MergeOperator* merge_operator_;
 
   VersionStorageInfo storage_info_;
@@ -830,6 +854,15 @@ class Version {
   uint64_t version_number_;
   std::shared_ptr<IOTracer> io_tracer_;
 
+  // The range tombstones of all table files, fragmented across files, so a
+  // point lookup finds out with one search whether any table on its path
+  // needs to be checked for a covering tombstone. Tombstones are not
+  // truncated to the boundaries of their files, so the index may report
+  // keys as covered that no table lookup would. Built by the first lookup
+  // on the version; nullptr if the tombstones could not be read without I/O.
+  std::once_flag range_tombstone_index_once_;
+  std::unique_ptr<FragmentedRangeTombstoneList> range_tombstone_index_;
+
   Version(ColumnFamilyData* cfd, VersionSet* vset, const FileOptions& file_opt,
           MutableCFOptions mutable_cf_options,
           const std::shared_ptr<IOTracer>& io_tracer,
@@ -1058,6 +1091,11 @@ class VersionSet {
   // Allocate and return a new file number
   uint64_t NewFileNumber() { return next_file_number_.fetch_add(1); }
 
+  // Key prefix of the blobs of this DB in the blob cache
+  const std::string& blob_cache_key_prefix() const {
+    return blob_cache_key_prefix_;
+  }
+
   // Fetch And Add n new file number
   uint64_t FetchAddFileNumber(uint64_t n) {
     return next_file_number_.fetch_add(n);
@@ -1356,6 +1394,8 @@ class VersionSet {
 
   std::shared_ptr<IOTracer> io_tracer_;
 
+  const std::string blob_cache_key_prefix_;
+
  private:
   // REQUIRES db mutex at beginning. may release and re-acquire db mutex
   Status ProcessManifestWrites(std::deque<ManifestWriter>& writers,
@@ -237,6 +237,49 @@ class TimestampAssigner : public WriteBatch::Handler {
 };
 const std::vector<Slice> TimestampAssigner::kEmptyTimestampList;
 
+// Appends a record of a length prefixed key, padded with ts_sz zeroes, and a
+// length prefixed value. The size of the record is computed first, so that
+// rep grows once and the fields are encoded in place, instead of an append,
+// and a capacity check, per field.
+void AppendKeyValueRecord(std::string* rep, ValueType type,
+                          uint32_t column_family_id, const SliceParts& key,
+                          size_t ts_sz, const SliceParts& value) {
+  size_t key_size = ts_sz;
+  for (int i = 0; i < key.num_parts; ++i) {
+    key_size += key.parts[i].size();
+  }
+  size_t value_size = 0;
+  for (int i = 0; i < value.num_parts; ++i) {
+    value_size += value.parts[i].size();
+  }
+  size_t record_size = 1 + VarintLength(key_size) + key_size +
+                       VarintLength(value_size) + value_size;
+  if (column_family_id != 0) {
+    record_size += VarintLength(column_family_id);
+  }
+
+  size_t offset = rep->size();
+  // Zero fills, which leaves the timestamp padding in place
+  rep->resize(offset + record_size);
+  char* p = &(*rep)[offset];
+  *p++ = static_cast<char>(type);
+  if (column_family_id != 0) {
+    p = EncodeVarint32(p, column_family_id);
+  }
+  p = EncodeVarint32(p, static_cast<uint32_t>(key_size));
+  for (int i = 0; i < key.num_parts; ++i) {
+    memcpy(p, key.parts[i].data(), key.parts[i].size());
+    p += key.parts[i].size();
+  }
+  p += ts_sz;
+  p = EncodeVarint32(p, static_cast<uint32_t>(value_size));
+  for (int i = 0; i < value.num_parts; ++i) {
+    memcpy(p, value.parts[i].data(), value.parts[i].size());
+    p += value.parts[i].size();
+  }
+  assert(p == rep->data() + rep->size());
+}
+
 }  // anon namespace
 
 struct SavePoints {
@@ -334,6 +377,18 @@ void WriteBatch::Clear() {
   wal_term_point_.clear();
 }
 
+void WriteBatch::AdoptBuffer(std::string&& buffer) {
+  rep_ = std::move(buffer);
+  Clear();
+}
+
+std::string WriteBatch::ReleaseBuffer() {
+  std::string buffer;
+  buffer.swap(rep_);
+  Clear();
+  return buffer;
+}
+
 uint32_t WriteBatch::Count() const { return WriteBatchInternal::Count(this); }
 
 uint32_t WriteBatch::ComputeContentFlags() const {
@@ -771,21 +826,10 @@ Status WriteBatchInternal::Put(WriteBatch* b, uint32_t column_family_id,
 
   LocalSavePoint save(b);
   WriteBatchInternal::SetCount(b, WriteBatchInternal::Count(b) + 1);
-  if (column_family_id == 0) {
-    b->rep_.push_back(static_cast<char>(kTypeValue));
-  } else {
-    b->rep_.push_back(static_cast<char>(kTypeColumnFamilyValue));
-    PutVarint32(&b->rep_, column_family_id);
-  }
-  if (0 == b->timestamp_size_) {
-    PutLengthPrefixedSlice(&b->rep_, key);
-  } else {
-    PutVarint32(&b->rep_,
-                static_cast<uint32_t>(key.size() + b->timestamp_size_));
-    b->rep_.append(key.data(), key.size());
-    b->rep_.append(b->timestamp_size_, '\0');
-  }
-  PutLengthPrefixedSlice(&b->rep_, value);
+  AppendKeyValueRecord(
+      &b->rep_, column_family_id == 0 ? kTypeValue : kTypeColumnFamilyValue,
+      column_family_id, SliceParts(&key, 1), b->timestamp_size_,
+      SliceParts(&value, 1));
   b->content_flags_.store(
       b->content_flags_.load(std::memory_order_relaxed) | ContentFlags::HAS_PUT,
       std::memory_order_relaxed);
@@ -827,18 +871,9 @@ Status WriteBatchInternal::Put(WriteBatch* b, uint32_t column_family_id,
 
   LocalSavePoint save(b);
   WriteBatchInternal::SetCount(b, WriteBatchInternal::Count(b) + 1);
-  if (column_family_id == 0) {
-    b->rep_.push_back(static_cast<char>(kTypeValue));
-  } else {
-    b->rep_.push_back(static_cast<char>(kTypeColumnFamilyValue));
-    PutVarint32(&b->rep_, column_family_id);
-  }
-  if (0 == b->timestamp_size_) {
-    PutLengthPrefixedSliceParts(&b->rep_, key);
-  } else {
-    PutLengthPrefixedSlicePartsWithPadding(&b->rep_, key, b->timestamp_size_);
-  }
-  PutLengthPrefixedSliceParts(&b->rep_, value);
+  AppendKeyValueRecord(
+      &b->rep_, column_family_id == 0 ? kTypeValue : kTypeColumnFamilyValue,
+      column_family_id, key, b->timestamp_size_, value);
   b->content_flags_.store(
       b->content_flags_.load(std::memory_order_relaxed) | ContentFlags::HAS_PUT,
       std::memory_order_relaxed);
@@ -1250,6 +1285,11 @@ class MemTableInserter : public WriteBatch::Handler {
   using HintMapType = std::aligned_storage<sizeof(HintMap)>::type;
   HintMapType hint_;
 
+  // Entries encoded into each memtable but not inserted into its rep yet, see
+  // set_batch_inserts()
+  bool batch_inserts_;
+  std::vector<std::pair<MemTable*, std::vector<KeyHandle>>> pending_inserts_;
+
   HintMap& GetHintMap() {
     assert(hint_per_batch_);
     if (!hint_created_) {
@@ -1318,11 +1358,13 @@ class MemTableInserter : public WriteBatch::Handler {
         duplicate_detector_(),
         dup_dectector_on_(false),
         hint_per_batch_(hint_per_batch),
-        hint_created_(false) {
+        hint_created_(false),
+        batch_inserts_(false) {
     assert(cf_mems_);
   }
 
   ~MemTableInserter() override {
+    assert(pending_inserts_.empty());
     if (dup_dectector_on_) {
       reinterpret_cast<DuplicateDetector*>
         (&duplicate_detector_)->~DuplicateDetector();
@@ -1361,6 +1403,28 @@ class MemTableInserter : public WriteBatch::Handler {
 
   void set_log_number_ref(uint64_t log) { log_number_ref_ = log; }
 
+  // With batch_inserts, the entries of the batch are only encoded into each
+  // memtable, and InsertPending() later inserts them into its rep in one
+  // sorted batch, so that the rep does not search from scratch for every key.
+  // Not used with seq_per_batch, which relies on every insert to detect
+  // duplicate keys, nor for memtables that are read while a batch is inserted,
+  // for in-place updates and successive merges.
+  void set_batch_inserts(bool batch_inserts) {
+    batch_inserts_ = batch_inserts && !seq_per_batch_;
+  }
+
+  // Inserts the entries left pending by set_batch_inserts()
+  void InsertPending() {
+    for (auto& pending : pending_inserts_) {
+      bool mem_res __attribute__((__unused__));
+      mem_res = pending.first->InsertPending(&pending.second,
+                                             concurrent_memtable_writes_);
+      // Without seq_per_batch every entry has its own sequence number
+      assert(mem_res);
+    }
+    pending_inserts_.clear();
+  }
+
   SequenceNumber sequence() const { return sequence_; }
 
   void PostProcess() {
@@ -1448,7 +1512,8 @@ class MemTableInserter : public WriteBatch::Handler {
       bool mem_res =
           mem->Add(sequence_, value_type, key, value,
                    concurrent_memtable_writes_, get_post_process_info(mem),
-                   hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+                   hint_per_batch_ ? &GetHintMap()[mem] : nullptr,
+                   get_pending_inserts(mem));
       if (UNLIKELY(!mem_res)) {
         assert(seq_per_batch_);
         ret_status = Status::TryAgain("key+seq exists");
@@ -1531,10 +1596,11 @@ class MemTableInserter : public WriteBatch::Handler {
                     const Slice& value, ValueType delete_type) {
     Status ret_status;
     MemTable* mem = cf_mems_->GetMemTable();
-    bool mem_res =
-        mem->Add(sequence_, delete_type, key, value,
-                 concurrent_memtable_writes_, get_post_process_info(mem),
-                 hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+    bool mem_res = mem->Add(
+        sequence_, delete_type, key, value, concurrent_memtable_writes_,
+        get_post_process_info(mem),
+        hint_per_batch_ ? &GetHintMap()[mem] : nullptr,
+        delete_type != kTypeRangeDeletion ? get_pending_inserts(mem) : nullptr);
     if (UNLIKELY(!mem_res)) {
       assert(seq_per_batch_);
       ret_status = Status::TryAgain("key+seq exists");
@@ -1719,11 +1785,21 @@ class MemTableInserter : public WriteBatch::Handler {
     assert(!concurrent_memtable_writes_ ||
            moptions->max_successive_merges == 0);
 
+    // In-place updates rule out snapshots, so no reader can need the latest
+    // operand without this one. With a sequence number per batch, the latest
+    // operand may belong to a prepared transaction that is rolled back.
+    bool combined = false;
+    if (moptions->preaggregate_merge_operands &&
+        moptions->inplace_update_support && !seq_per_batch_) {
+      assert(!concurrent_memtable_writes_);
+      combined = mem->CombineMergeOperand(sequence_, key, value);
+    }
+
     // If we pass DB through and options.max_successive_merges is hit
     // during recovery, Get() will be issued which will try to acquire
     // DB mutex and cause deadlock, as DB mutex is already held.
     // So we disable merge in recovery
-    if (moptions->max_successive_merges > 0 && db_ != nullptr &&
+    if (!combined && moptions->max_successive_merges > 0 && db_ != nullptr &&
         recovering_log_number_ == 0) {
       assert(!concurrent_memtable_writes_);
       LookupKey lkey(key, sequence_);
@@ -1782,11 +1858,12 @@ class MemTableInserter : public WriteBatch::Handler {
       }
     }
 
-    if (!perform_merge) {
+    if (!combined && !perform_merge) {
       // Add merge operator to memtable
-      bool mem_res =
-          mem->Add(sequence_, kTypeMerge, key, value,
-                   concurrent_memtable_writes_, get_post_process_info(mem));
+      bool mem_res = mem->Add(sequence_, kTypeMerge, key, value,
+                              concurrent_memtable_writes_,
+                              get_post_process_info(mem), nullptr /* hint */,
+                              get_pending_inserts(mem));
       if (UNLIKELY(!mem_res)) {
         assert(seq_per_batch_);
         ret_status = Status::TryAgain("key+seq exists");
@@ -2002,8 +2079,33 @@ class MemTableInserter : public WriteBatch::Handler {
     }
     return &GetPostMap()[mem];
   }
+
+  // Returns where mem->Add() should leave the entry, or nullptr if it should
+  // be inserted right away
+  std::vector<KeyHandle>* get_pending_inserts(MemTable* mem) {
+    if (!batch_inserts_) {
+      return nullptr;
+    }
+    auto* moptions = mem->GetImmutableMemTableOptions();
+    if (moptions->inplace_update_support ||
+        moptions->max_successive_merges > 0) {
+      return nullptr;
+    }
+    for (auto& pending : pending_inserts_) {
+      if (pending.first == mem) {
+        return &pending.second;
+      }
+    }
+    pending_inserts_.emplace_back(mem, std::vector<KeyHandle>());
+    return &pending_inserts_.back().second;
+  }
 };
 
+// Batches with at least this many entries are inserted into each memtable as
+// one sorted batch, see MemTableInserter::set_batch_inserts(). Below it the
+// sort does not pay for itself.
+static const size_t kMinCountForBatchInserts = 16;
+
 // This function can only be called in these conditions:
 // 1) During Recovery()
 // 2) During Write(), in a single-threaded write thread
@@ -2020,6 +2122,13 @@ Status WriteBatchInternal::InsertInto(
       ignore_missing_column_families, recovery_log_number, db,
       concurrent_memtable_writes, nullptr /*has_valid_writes*/, seq_per_batch,
       batch_per_txn);
+  size_t count = 0;
+  for (auto w : write_group) {
+    if (!w->CallbackFailed() && w->ShouldWriteToMemtable()) {
+      count += static_cast<size_t>(Count(w->batch));
+    }
+  }
+  inserter.set_batch_inserts(count >= kMinCountForBatchInserts);
   for (auto w : write_group) {
     if (w->CallbackFailed()) {
       continue;
@@ -2034,11 +2143,13 @@ Status WriteBatchInternal::InsertInto(
     inserter.set_log_number_ref(w->log_ref);
     w->status = w->batch->Iterate(&inserter);
     if (!w->status.ok()) {
+      inserter.InsertPending();
       return w->status;
     }
     assert(!seq_per_batch || w->batch_cnt != 0);
     assert(!seq_per_batch || inserter.sequence() - w->sequence == w->batch_cnt);
   }
+  inserter.InsertPending();
   return Status::OK();
 }
 
@@ -2060,7 +2171,10 @@ Status WriteBatchInternal::InsertInto(
       batch_per_txn, hint_per_batch);
   SetSequence(writer->batch, sequence);
   inserter.set_log_number_ref(writer->log_ref);
+  inserter.set_batch_inserts(static_cast<size_t>(Count(writer->batch)) >=
+                             kMinCountForBatchInserts);
   Status s = writer->batch->Iterate(&inserter);
+  inserter.InsertPending();
   assert(!seq_per_batch || batch_cnt != 0);
   assert(!seq_per_batch || inserter.sequence() - sequence == batch_cnt);
   if (concurrent_memtable_writes) {
@@ -2081,7 +2195,10 @@ Status WriteBatchInternal::InsertInto(
                             ignore_missing_column_families, log_number, db,
                             concurrent_memtable_writes, has_valid_writes,
                             seq_per_batch, batch_per_txn);
+  inserter.set_batch_inserts(static_cast<size_t>(Count(batch)) >=
+                             kMinCountForBatchInserts);
   Status s = batch->Iterate(&inserter);
+  inserter.InsertPending();
   if (next_seq != nullptr) {
     *next_seq = inserter.sequence();
   }
@@ -880,6 +880,37 @@ TEST_F(WriteBatchTest, MemoryLimitTest) {
   ASSERT_TRUE(s.IsMemoryLimit());
 }
 
+TEST_F(WriteBatchTest, ReuseBuffer) {
+  WriteBatch batch;
+  batch.Reserve(1024);
+  size_t capacity = batch.Data().capacity();
+  ASSERT_GE(capacity, 1024u);
+  ASSERT_OK(batch.Put("foo", "bar"));
+  ASSERT_OK(batch.Delete("box"));
+  ASSERT_EQ(capacity, batch.Data().capacity());
+
+  std::string rep = batch.Data();
+  std::string buffer = batch.ReleaseBuffer();
+  ASSERT_EQ(rep, buffer);
+  ASSERT_EQ(0u, batch.Count());
+  ASSERT_EQ(WriteBatchInternal::kHeader, batch.GetDataSize());
+
+  // Another batch takes the memory, but not the contents
+  const char* data = buffer.data();
+  WriteBatch batch2;
+  batch2.AdoptBuffer(std::move(buffer));
+  ASSERT_EQ(data, batch2.Data().data());
+  ASSERT_EQ(0u, batch2.Count());
+  ASSERT_EQ(WriteBatchInternal::kHeader, batch2.GetDataSize());
+  ASSERT_OK(batch2.Put("baz", "boo"));
+  batch2.Clear();
+  ASSERT_EQ(data, batch2.Data().data());
+  ASSERT_OK(batch2.Put("foo", "bar"));
+  ASSERT_EQ(data, batch2.Data().data());
+  WriteBatchInternal::SetSequence(&batch2, 100);
+  ASSERT_EQ("Put(foo, bar)@100", PrintContents(&batch2));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
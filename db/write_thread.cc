@@ -7,6 +7,7 @@
 #include <chrono>
 #include <thread>
 #include "db/column_family.h"
+#include "monitoring/lock_profiler.h"
 #include "monitoring/perf_context_imp.h"
 #include "port/port.h"
 #include "test_util/sync_point.h"
@@ -29,7 +30,11 @@ WriteThread::WriteThread(const ImmutableDBOptions& db_options)
       last_sequence_(0),
       write_stall_dummy_(),
       stall_mu_(),
-      stall_cv_(&stall_mu_) {}
+      stall_cv_(&stall_mu_),
+      released_wal_tickets_(0),
+      exited_wal_tickets_(0),
+      wal_order_mu_(),
+      wal_order_cv_(&wal_order_mu_) {}
 
 uint8_t WriteThread::BlockingAwaitState(Writer* w, uint8_t goal_mask) {
   // We're going to block.  Lazily create the mutex.  We guarantee
@@ -376,10 +381,15 @@ void WriteThread::EndWriteStall() {
 }
 
 static WriteThread::AdaptationContext jbg_ctx("JoinBatchGroup");
-void WriteThread::JoinBatchGroup(Writer* w) {
+void WriteThread::JoinBatchGroup(Writer* w, const char* file, int line) {
   TEST_SYNC_POINT_CALLBACK("WriteThread::JoinBatchGroup:Start", w);
   assert(w->batch != nullptr);
 
+  // The write queue is profiled as a lock waited on until the writer leads
+  // or joins a group
+  const bool sampled = ShouldSampleLock();
+  const uint64_t start_nanos = sampled ? LockProfilerNowNanos() : 0;
+
   bool linked_as_leader = LinkOne(w, &newest_writer_);
 
   if (linked_as_leader) {
@@ -408,6 +418,10 @@ void WriteThread::JoinBatchGroup(Writer* w) {
                &jbg_ctx);
     TEST_SYNC_POINT_CALLBACK("WriteThread::JoinBatchGroup:DoneWaiting", w);
   }
+  if (sampled) {
+    RecordLockSample(this, "WriteThread::newest_writer_", file, line,
+                     LockProfilerNowNanos() - start_nanos, 0 /* hold_nanos */);
+  }
 }
 
 size_t WriteThread::EnterAsBatchGroupLeader(Writer* leader,
@@ -643,6 +657,10 @@ void WriteThread::ExitAsBatchGroupLeader(WriteGroup& write_group,
   }
 
   if (enable_pipelined_write_) {
+    if (write_group.released) {
+      AwaitReleasedGroups(write_group);
+    }
+
     // Notify writers don't write to memtable to exit.
     for (Writer* w = last_writer; w != leader;) {
       Writer* next = w->link_older;
@@ -656,6 +674,26 @@ void WriteThread::ExitAsBatchGroupLeader(WriteGroup& write_group,
       CompleteLeader(write_group);
     }
 
+    if (write_group.released) {
+      // The next leader is already running, groups released after us wait
+      // for exited_wal_tickets_ before linking to memtable writer queue.
+      if (write_group.size > 0) {
+        if (LinkGroup(write_group, &newest_memtable_writer_)) {
+          SetState(write_group.leader, STATE_MEMTABLE_WRITER_LEADER);
+        }
+      }
+      {
+        MutexLock lock(&wal_order_mu_);
+        exited_wal_tickets_++;
+        wal_order_cv_.SignalAll();
+      }
+      AwaitState(leader,
+                 STATE_MEMTABLE_WRITER_LEADER | STATE_PARALLEL_MEMTABLE_WRITER |
+                     STATE_COMPLETED,
+                 &eabgl_ctx);
+      return;
+    }
+
     Writer* next_leader = nullptr;
 
     // Look for next leader before we call LinkGroup. If there isn't
@@ -751,6 +789,34 @@ void WriteThread::ExitAsBatchGroupLeader(WriteGroup& write_group,
   }
 }
 
+void WriteThread::ReleaseBatchGroupLeader(WriteGroup& write_group) {
+  assert(enable_pipelined_write_);
+  assert(!write_group.released);
+  Writer* last_writer = write_group.last_writer;
+  write_group.released = true;
+  write_group.wal_ticket = released_wal_tickets_++;
+
+  // Same leader handoff as the non-pipelined ExitAsBatchGroupLeader, the
+  // group itself stays linked through link_older until it exits.
+  Writer* head = newest_writer_.load(std::memory_order_acquire);
+  if (head != last_writer ||
+      !newest_writer_.compare_exchange_strong(head, nullptr)) {
+    assert(head != last_writer);
+    CreateMissingNewerLinks(head);
+    assert(last_writer->link_newer->link_older == last_writer);
+    last_writer->link_newer->link_older = nullptr;
+    SetState(last_writer->link_newer, STATE_GROUP_LEADER);
+  }
+}
+
+void WriteThread::AwaitReleasedGroups(const WriteGroup& write_group) {
+  assert(write_group.released);
+  MutexLock lock(&wal_order_mu_);
+  while (exited_wal_tickets_ != write_group.wal_ticket) {
+    wal_order_cv_.Wait();
+  }
+}
+
 static WriteThread::AdaptationContext eu_ctx("EnterUnbatched");
 void WriteThread::EnterUnbatched(Writer* w, InstrumentedMutex* mu) {
   assert(w != nullptr && w->batch == nullptr);
@@ -782,6 +848,12 @@ void WriteThread::ExitUnbatched(Writer* w) {
 static WriteThread::AdaptationContext wfmw_ctx("WaitForMemTableWriters");
 void WriteThread::WaitForMemTableWriters() {
   assert(enable_pipelined_write_);
+  {
+    MutexLock lock(&wal_order_mu_);
+    while (exited_wal_tickets_ != released_wal_tickets_) {
+      wal_order_cv_.Wait();
+    }
+  }
   if (newest_memtable_writer_.load() == nullptr) {
     return;
   }
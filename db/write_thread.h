@@ -18,6 +18,7 @@
 #include "db/pre_release_callback.h"
 #include "db/write_callback.h"
 #include "monitoring/instrumented_mutex.h"
+#include "monitoring/lock_profiler.h"
 #include "rocksdb/options.h"
 #include "rocksdb/status.h"
 #include "rocksdb/types.h"
@@ -82,6 +83,10 @@ class WriteThread {
     Status status;
     std::atomic<size_t> running;
     size_t size = 0;
+    // Set by ReleaseBatchGroupLeader, the group then exits the WAL stage in
+    // the order of wal_ticket.
+    bool released = false;
+    uint64_t wal_ticket = 0;
 
     struct Iterator {
       Writer* writer;
@@ -276,7 +281,9 @@ class WriteThread {
   // it will block.
   //
   // Writer* w:        Writer to be executed as part of a batch group
-  void JoinBatchGroup(Writer* w);
+  // file, line:       The call site, for the lock profiler
+  void JoinBatchGroup(Writer* w, const char* file = ROCKSDB_LOCK_SITE_FILE,
+                      int line = ROCKSDB_LOCK_SITE_LINE);
 
   // Constructs a write batch group led by leader, which should be a
   // Writer passed to JoinBatchGroup on the current thread.
@@ -296,6 +303,18 @@ class WriteThread {
   // Exit batch group on behalf of batch group leader.
   void ExitAsBatchGroupFollower(Writer* w);
 
+  // Pipelined write only. Wakes up the next leader before the group has done
+  // its WAL write, so that the next group can write its WAL concurrently.
+  // The group keeps its place in the memtable writer queue: the leader still
+  // calls ExitAsBatchGroupLeader, which waits for the groups released before.
+  //
+  // WriteGroup* write_group: the write group
+  void ReleaseBatchGroupLeader(WriteGroup& write_group);
+
+  // Waits until all groups released before write_group have called
+  // ExitAsBatchGroupLeader.
+  void AwaitReleasedGroups(const WriteGroup& write_group);
+
   // Constructs a write batch group led by leader from newest_memtable_writers_
   // list. The leader should either write memtable for the whole group and
   // call ExitAsMemTableWriter, or launch parallel memtable write through
@@ -333,8 +352,8 @@ class WriteThread {
   // writers.
   void ExitUnbatched(Writer* w);
 
-  // Wait for all parallel memtable writers to finish, in case pipelined
-  // write is enabled.
+  // Wait for all released groups and parallel memtable writers to finish, in
+  // case pipelined write is enabled.
   void WaitForMemTableWriters();
 
   SequenceNumber UpdateLastSequence(SequenceNumber sequence) {
@@ -390,6 +409,13 @@ class WriteThread {
   port::Mutex stall_mu_;
   port::CondVar stall_cv_;
 
+  // Tickets of released groups. released_wal_tickets_ is only accessed by the
+  // WAL stage leader, exited_wal_tickets_ is protected by wal_order_mu_.
+  uint64_t released_wal_tickets_;
+  uint64_t exited_wal_tickets_;
+  port::Mutex wal_order_mu_;
+  port::CondVar wal_order_cv_;
+
   // Waits for w->state & goal_mask using w->StateMutex().  Returns
   // the state that satisfies goal_mask.
   uint8_t BlockingAwaitState(Writer* w, uint8_t goal_mask);
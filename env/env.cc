@@ -450,6 +450,7 @@ EnvOptions Env::OptimizeForCompactionTableWrite(
   EnvOptions optimized_env_options(env_options);
   optimized_env_options.use_direct_writes =
       db_options.use_direct_io_for_flush_and_compaction;
+  optimized_env_options.async_flush = db_options.async_table_file_flush;
   return optimized_env_options;
 }
 
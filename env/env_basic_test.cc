@@ -9,11 +9,13 @@
 #include <string>
 #include <vector>
 
+#include "env/env_encryption_ctr.h"
 #include "env/mock_env.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/env.h"
 #include "rocksdb/env_encryption.h"
 #include "test_util/testharness.h"
+#include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -115,6 +117,25 @@ INSTANTIATE_TEST_CASE_P(EncryptedEnv, EnvBasicTestWithParam,
                         ::testing::Values(ctr_encrypt_env.get()));
 INSTANTIATE_TEST_CASE_P(EncryptedEnv, EnvMoreTestWithParam,
                         ::testing::Values(ctr_encrypt_env.get()));
+
+static Env* NewAESEncryptedEnv(Env* base) {
+  std::shared_ptr<EncryptionProvider> provider;
+  EXPECT_OK(EncryptionProvider::CreateFromString(ConfigOptions(), "CTR",
+                                                 &provider));
+  EXPECT_OK(provider->AddCipher("",
+                                "AES:000102030405060708090A0B0C0D0E0F"
+                                "101112131415161718191A1B1C1D1E1F",
+                                0, true));
+  std::unique_ptr<Env> encrypted(NewEncryptedEnv(base, provider));
+  return new NormalizingEnvWrapper(std::move(encrypted));
+}
+
+static std::unique_ptr<Env> aes_encrypt_env(
+    NewAESEncryptedEnv(Env::Default()));
+INSTANTIATE_TEST_CASE_P(AESEncryptedEnv, EnvBasicTestWithParam,
+                        ::testing::Values(aes_encrypt_env.get()));
+INSTANTIATE_TEST_CASE_P(AESEncryptedEnv, EnvMoreTestWithParam,
+                        ::testing::Values(aes_encrypt_env.get()));
 #endif  // ROCKSDB_LITE
 
 #ifndef ROCKSDB_LITE
@@ -374,6 +395,98 @@ TEST_P(EnvMoreTestWithParam, GetChildren) {
   ASSERT_EQ(0U, children.size());
 }
 
+
+#ifndef ROCKSDB_LITE
+TEST(EnvEncryptionTest, AESKnownAnswer) {
+  // Examples of FIPS-197 appendix C
+  const std::string plaintext = "00112233445566778899AABBCCDDEEFF";
+  const std::vector<std::pair<std::string, std::string>> vectors = {
+      {"000102030405060708090A0B0C0D0E0F",
+       "69C4E0D86A7B0430D8CDB78070B4C55A"},
+      {"000102030405060708090A0B0C0D0E0F1011121314151617",
+       "DDA97CA4864CDFE06EAF70A0EC0D7191"},
+      {"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F",
+       "8EA2B7CA516745BFEAFC49904B496089"},
+  };
+  for (const auto& v : vectors) {
+    std::shared_ptr<BlockCipher> cipher;
+    ASSERT_OK(
+        BlockCipher::CreateFromString(ConfigOptions(), "AES:" + v.first,
+                                      &cipher));
+    ASSERT_EQ(16, cipher->BlockSize());
+    std::string block;
+    ASSERT_TRUE(Slice(plaintext).DecodeHex(&block));
+    ASSERT_OK(cipher->Encrypt(&block[0]));
+    ASSERT_EQ(v.second, Slice(block).ToString(true));
+    ASSERT_OK(cipher->Decrypt(&block[0]));
+    ASSERT_EQ(plaintext, Slice(block).ToString(true));
+
+    // Several blocks at once, as CTRCipherStream encrypts them
+    std::string blocks;
+    for (int i = 0; i < 19; i++) {
+      blocks += block;
+    }
+    ASSERT_OK(cipher->EncryptBlocks(&blocks[0], 19));
+    for (int i = 0; i < 19; i++) {
+      ASSERT_EQ(v.second, Slice(blocks.data() + 16 * i, 16).ToString(true));
+    }
+  }
+
+  std::shared_ptr<BlockCipher> cipher;
+  ASSERT_TRUE(BlockCipher::CreateFromString(ConfigOptions(), "AES:0011",
+                                            &cipher)
+                  .IsInvalidArgument());
+  ASSERT_TRUE(
+      BlockCipher::CreateFromString(ConfigOptions(), "AES", &cipher)
+          .IsInvalidArgument());
+}
+
+TEST(EnvEncryptionTest, CTRBatches) {
+  std::shared_ptr<BlockCipher> cipher =
+      BlockCipher::NewAESCipher(std::string(32, 'k'));
+  ASSERT_NE(nullptr, cipher);
+  const std::string iv(16, 'i');
+  const uint64_t initial_counter = 12345;
+  std::string data(3 * 4096 + 100, '\0');
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<char>(i * 7);
+  }
+
+  // Key stream of each block, encrypted one by one
+  std::string expected = data;
+  for (size_t i = 0; i * 16 < expected.size(); i++) {
+    char counter_block[16];
+    memcpy(counter_block, iv.data(), 16);
+    EncodeFixed64(counter_block, initial_counter + i);
+    ASSERT_OK(cipher->Encrypt(counter_block));
+    for (size_t j = 0; j < 16 && i * 16 + j < expected.size(); j++) {
+      expected[i * 16 + j] ^= counter_block[j];
+    }
+  }
+
+  CTRCipherStream stream(cipher, iv.data(), initial_counter);
+  std::string encrypted = data;
+  ASSERT_OK(stream.Encrypt(0, &encrypted[0], encrypted.size()));
+  ASSERT_EQ(expected, encrypted);
+
+  // Unaligned pieces of the data
+  encrypted = data;
+  size_t offset = 0;
+  for (size_t len : {5, 11, 16, 4096, 4097, 33, 3000}) {
+    len = std::min(len, encrypted.size() - offset);
+    ASSERT_OK(stream.Encrypt(offset, &encrypted[offset], len));
+    offset += len;
+  }
+  ASSERT_OK(stream.Encrypt(offset, &encrypted[offset],
+                           encrypted.size() - offset));
+  ASSERT_EQ(expected, encrypted);
+
+  ASSERT_OK(stream.Decrypt(17, &encrypted[17], encrypted.size() - 17));
+  ASSERT_OK(stream.Decrypt(0, &encrypted[0], 17));
+  ASSERT_EQ(data, encrypted);
+}
+#endif  // ROCKSDB_LITE
+
 }  // namespace ROCKSDB_NAMESPACE
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -26,6 +26,7 @@ namespace ROCKSDB_NAMESPACE {
 
 #ifndef ROCKSDB_LITE
 static constexpr char kROT13CipherName[] = "ROT13";
+static constexpr char kAESCipherName[] = "AES";
 static constexpr char kCTRProviderName[] = "CTR";
 
 Status BlockCipher::CreateFromString(const ConfigOptions& /*config_options*/,
@@ -44,6 +45,19 @@ Status BlockCipher::CreateFromString(const ConfigOptions& /*config_options*/,
       result->reset(new ROT13BlockCipher(32));
     }
     return Status::OK();
+  } else if (id == kAESCipherName) {
+    std::string key;
+    if (colon == std::string::npos ||
+        !Slice(value.substr(colon + 1)).DecodeHex(&key)) {
+      return Status::InvalidArgument("AES cipher needs a hex encoded key ",
+                                     value);
+    }
+    *result = NewAESCipher(key);
+    if (!*result) {
+      return Status::InvalidArgument("Invalid AES key length ",
+                                     ToString(key.size()));
+    }
+    return Status::OK();
   } else {
     return Status::NotSupported("Could not find cipher ", value);
   }
@@ -71,6 +85,25 @@ Status EncryptionProvider::CreateFromString(
   return status;
 }
 
+std::shared_ptr<BlockCipher> BlockCipher::NewAESCipher(
+    const std::string& key) {
+  if (key.size() != 16 && key.size() != 24 && key.size() != 32) {
+    return nullptr;
+  }
+  return std::make_shared<AESBlockCipher>(key);
+}
+
+Status BlockCipher::EncryptBlocks(char* data, size_t num_blocks) {
+  size_t block_size = BlockSize();
+  for (size_t i = 0; i < num_blocks; i++) {
+    Status s = Encrypt(data + i * block_size);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
 std::shared_ptr<EncryptionProvider> EncryptionProvider::NewCTRProvider(
     const std::shared_ptr<BlockCipher>& cipher) {
   return std::make_shared<CTREncryptionProvider>(cipher);
@@ -967,6 +1000,66 @@ Status ROT13BlockCipher::Encrypt(char* data) {
 // Length of data is equal to BlockSize().
 Status ROT13BlockCipher::Decrypt(char* data) { return Encrypt(data); }
 
+const char* AESBlockCipher::Name() const { return kAESCipherName; }
+
+// Encrypt data at the file offset. The counter blocks of up to 4KB of data
+// are built and encrypted at once, and XORed with the data.
+Status CTRCipherStream::Encrypt(uint64_t fileOffset, char* data,
+                                size_t dataSize) {
+  static const size_t kBatchBytes = 4096;
+  const size_t blockSize = cipher_->BlockSize();
+  uint64_t blockIndex = fileOffset / blockSize;
+  size_t blockOffset = fileOffset % blockSize;
+  const size_t batchBlocks = std::max<size_t>(1, kBatchBytes / blockSize);
+
+  char stackBuffer[kBatchBytes];
+  std::unique_ptr<char[]> heapBuffer;
+  char* keystream = stackBuffer;
+  if (batchBlocks * blockSize > kBatchBytes) {
+    heapBuffer.reset(new char[batchBlocks * blockSize]);
+    keystream = heapBuffer.get();
+  }
+
+  while (dataSize > 0) {
+    size_t numBlocks = std::min(
+        batchBlocks, (blockOffset + dataSize + blockSize - 1) / blockSize);
+    // Create nonce + counter of every block
+    for (size_t i = 0; i < numBlocks; i++) {
+      char* counterBlock = keystream + i * blockSize;
+      memcpy(counterBlock, iv_.data(), blockSize);
+      EncodeFixed64(counterBlock, blockIndex + i + initialCounter_);
+    }
+    auto status = cipher_->EncryptBlocks(keystream, numBlocks);
+    if (!status.ok()) {
+      return status;
+    }
+    // XOR data with ciphertext.
+    size_t n = std::min(dataSize, numBlocks * blockSize - blockOffset);
+    const char* key = keystream + blockOffset;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+      uint64_t d, k;
+      memcpy(&d, data + i, sizeof(d));
+      memcpy(&k, key + i, sizeof(k));
+      d ^= k;
+      memcpy(data + i, &d, sizeof(d));
+    }
+    for (; i < n; i++) {
+      data[i] = data[i] ^ key[i];
+    }
+    data += n;
+    dataSize -= n;
+    blockIndex += numBlocks;
+    blockOffset = 0;
+  }
+  return Status::OK();
+}
+
+Status CTRCipherStream::Decrypt(uint64_t fileOffset, char* data,
+                                size_t dataSize) {
+  return Encrypt(fileOffset, data, dataSize);
+}
+
 // Allocate scratch space which is passed to EncryptBlock/DecryptBlock.
 void CTRCipherStream::AllocateScratch(std::string& scratch) {
   auto blockSize = cipher_->BlockSize();
@@ -0,0 +1,335 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include <cassert>
+#include <cstring>
+
+#include "env/env_encryption_ctr.h"
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(IOS_CROSS_COMPILE)
+#define ROCKSDB_AES_NI
+#include <cpuid.h>
+#include <wmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRYPTO)
+#define ROCKSDB_AES_ARMV8
+#include <arm_neon.h>
+#endif
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+inline uint8_t Times2(uint8_t x) {
+  return static_cast<uint8_t>((x << 1) ^ ((x & 0x80) ? 0x1b : 0));
+}
+
+// Multiplication in GF(2^8), for the inverse MixColumns
+inline uint8_t Multiply(uint8_t x, uint8_t y) {
+  uint8_t r = 0;
+  while (y != 0) {
+    if (y & 1) {
+      r ^= x;
+    }
+    x = Times2(x);
+    y >>= 1;
+  }
+  return r;
+}
+
+inline uint32_t RotateRight(uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+inline uint32_t LoadBigEndian(const char* p) {
+  const uint8_t* b = reinterpret_cast<const uint8_t*>(p);
+  return (static_cast<uint32_t>(b[0]) << 24) |
+         (static_cast<uint32_t>(b[1]) << 16) |
+         (static_cast<uint32_t>(b[2]) << 8) | static_cast<uint32_t>(b[3]);
+}
+
+inline void StoreBigEndian(char* p, uint32_t x) {
+  p[0] = static_cast<char>(x >> 24);
+  p[1] = static_cast<char>(x >> 16);
+  p[2] = static_cast<char>(x >> 8);
+  p[3] = static_cast<char>(x);
+}
+
+// The S-boxes, and the tables combining SubBytes, ShiftRows and MixColumns
+// of the encryption rounds
+struct AESTables {
+  uint8_t sbox[256];
+  uint8_t inv_sbox[256];
+  uint32_t te[4][256];
+
+  AESTables() {
+    // Walks GF(2^8) by powers of 3 and their inverses
+    uint8_t p = 1;
+    uint8_t q = 1;
+    do {
+      p = static_cast<uint8_t>(p ^ Times2(p));
+      q = static_cast<uint8_t>(q ^ (q << 1));
+      q = static_cast<uint8_t>(q ^ (q << 2));
+      q = static_cast<uint8_t>(q ^ (q << 4));
+      if (q & 0x80) {
+        q ^= 0x09;
+      }
+      uint8_t x = q;
+      for (int i = 1; i <= 4; i++) {
+        x ^= static_cast<uint8_t>((q << i) | (q >> (8 - i)));
+      }
+      sbox[p] = x ^ 0x63;
+    } while (p != 1);
+    sbox[0] = 0x63;
+
+    for (int i = 0; i < 256; i++) {
+      uint8_t s = sbox[i];
+      inv_sbox[s] = static_cast<uint8_t>(i);
+      uint8_t s2 = Times2(s);
+      uint32_t t = (static_cast<uint32_t>(s2) << 24) |
+                   (static_cast<uint32_t>(s) << 16) |
+                   (static_cast<uint32_t>(s) << 8) |
+                   static_cast<uint32_t>(s2 ^ s);
+      for (int j = 0; j < 4; j++) {
+        te[j][i] = j == 0 ? t : RotateRight(t, 8 * j);
+      }
+    }
+  }
+};
+
+const AESTables& Tables() {
+  static const AESTables tables;
+  return tables;
+}
+
+#ifdef ROCKSDB_AES_NI
+bool HasAESNI() {
+  unsigned int eax, ebx, ecx = 0, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  return (ecx & (1U << 25)) != 0;  // AES is in bit 25
+}
+
+// Encrypts 8 blocks per iteration, so that the latency of the AESENC
+// instructions of a block is hidden by those of the other blocks.
+__attribute__((__target__("aes,sse2"))) void EncryptBlocksAESNI(
+    const uint8_t* round_keys, int rounds, char* data, size_t num_blocks) {
+  __m128i keys[15];
+  for (int r = 0; r <= rounds; r++) {
+    keys[r] = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(round_keys + 16 * r));
+  }
+  __m128i* blocks = reinterpret_cast<__m128i*>(data);
+  size_t i = 0;
+  for (; i + 8 <= num_blocks; i += 8) {
+    __m128i b[8];
+    for (int j = 0; j < 8; j++) {
+      b[j] = _mm_xor_si128(_mm_loadu_si128(blocks + i + j), keys[0]);
+    }
+    for (int r = 1; r < rounds; r++) {
+      for (int j = 0; j < 8; j++) {
+        b[j] = _mm_aesenc_si128(b[j], keys[r]);
+      }
+    }
+    for (int j = 0; j < 8; j++) {
+      _mm_storeu_si128(blocks + i + j,
+                       _mm_aesenclast_si128(b[j], keys[rounds]));
+    }
+  }
+  for (; i < num_blocks; i++) {
+    __m128i b = _mm_xor_si128(_mm_loadu_si128(blocks + i), keys[0]);
+    for (int r = 1; r < rounds; r++) {
+      b = _mm_aesenc_si128(b, keys[r]);
+    }
+    _mm_storeu_si128(blocks + i, _mm_aesenclast_si128(b, keys[rounds]));
+  }
+}
+#endif  // ROCKSDB_AES_NI
+
+#ifdef ROCKSDB_AES_ARMV8
+// AESE does AddRoundKey before SubBytes and ShiftRows, so the last round key
+// is XORed separately. Encrypts 4 blocks per iteration.
+void EncryptBlocksARMv8(const uint8_t* round_keys, int rounds, char* data,
+                        size_t num_blocks) {
+  uint8x16_t keys[15];
+  for (int r = 0; r <= rounds; r++) {
+    keys[r] = vld1q_u8(round_keys + 16 * r);
+  }
+  uint8_t* blocks = reinterpret_cast<uint8_t*>(data);
+  size_t i = 0;
+  for (; i + 4 <= num_blocks; i += 4) {
+    uint8x16_t b[4];
+    for (int j = 0; j < 4; j++) {
+      b[j] = vld1q_u8(blocks + 16 * (i + j));
+    }
+    for (int r = 0; r < rounds - 1; r++) {
+      for (int j = 0; j < 4; j++) {
+        b[j] = vaesmcq_u8(vaeseq_u8(b[j], keys[r]));
+      }
+    }
+    for (int j = 0; j < 4; j++) {
+      b[j] = veorq_u8(vaeseq_u8(b[j], keys[rounds - 1]), keys[rounds]);
+      vst1q_u8(blocks + 16 * (i + j), b[j]);
+    }
+  }
+  for (; i < num_blocks; i++) {
+    uint8x16_t b = vld1q_u8(blocks + 16 * i);
+    for (int r = 0; r < rounds - 1; r++) {
+      b = vaesmcq_u8(vaeseq_u8(b, keys[r]));
+    }
+    b = veorq_u8(vaeseq_u8(b, keys[rounds - 1]), keys[rounds]);
+    vst1q_u8(blocks + 16 * i, b);
+  }
+}
+#endif  // ROCKSDB_AES_ARMV8
+
+}  // namespace
+
+AESBlockCipher::AESBlockCipher(const Slice& key) {
+  assert(key.size() == 16 || key.size() == 24 || key.size() == 32);
+  const AESTables& tables = Tables();
+  const int nk = static_cast<int>(key.size() / 4);
+  rounds_ = nk + 6;
+  const int num_words = 4 * (rounds_ + 1);
+
+  // Key expansion of FIPS-197
+  uint8_t rcon = 1;
+  for (int i = 0; i < num_words; i++) {
+    if (i < nk) {
+      round_keys_[i] = LoadBigEndian(key.data() + 4 * i);
+      continue;
+    }
+    uint32_t t = round_keys_[i - 1];
+    if (i % nk == 0 || (nk > 6 && i % nk == 4)) {
+      if (i % nk == 0) {
+        t = (t << 8) | (t >> 24);
+      }
+      t = (static_cast<uint32_t>(tables.sbox[t >> 24]) << 24) |
+          (static_cast<uint32_t>(tables.sbox[(t >> 16) & 0xff]) << 16) |
+          (static_cast<uint32_t>(tables.sbox[(t >> 8) & 0xff]) << 8) |
+          static_cast<uint32_t>(tables.sbox[t & 0xff]);
+      if (i % nk == 0) {
+        t ^= static_cast<uint32_t>(rcon) << 24;
+        rcon = Times2(rcon);
+      }
+    }
+    round_keys_[i] = round_keys_[i - nk] ^ t;
+  }
+  for (int i = 0; i < num_words; i++) {
+    StoreBigEndian(reinterpret_cast<char*>(round_key_bytes_) + 4 * i,
+                   round_keys_[i]);
+  }
+}
+
+bool AESBlockCipher::HardwareAccelerated() {
+#if defined(ROCKSDB_AES_NI)
+  static const bool has_aes_ni = HasAESNI();
+  return has_aes_ni;
+#elif defined(ROCKSDB_AES_ARMV8)
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Encrypt a block of data.
+// Length of data is equal to BlockSize().
+Status AESBlockCipher::Encrypt(char* data) { return EncryptBlocks(data, 1); }
+
+Status AESBlockCipher::EncryptBlocks(char* data, size_t num_blocks) {
+#if defined(ROCKSDB_AES_NI)
+  if (HardwareAccelerated()) {
+    EncryptBlocksAESNI(round_key_bytes_, rounds_, data, num_blocks);
+    return Status::OK();
+  }
+#elif defined(ROCKSDB_AES_ARMV8)
+  EncryptBlocksARMv8(round_key_bytes_, rounds_, data, num_blocks);
+  return Status::OK();
+#endif
+  const AESTables& t = Tables();
+  for (size_t b = 0; b < num_blocks; b++, data += kBlockSize) {
+    const uint32_t* rk = round_keys_;
+    uint32_t s0 = LoadBigEndian(data) ^ rk[0];
+    uint32_t s1 = LoadBigEndian(data + 4) ^ rk[1];
+    uint32_t s2 = LoadBigEndian(data + 8) ^ rk[2];
+    uint32_t s3 = LoadBigEndian(data + 12) ^ rk[3];
+    for (int r = 1; r < rounds_; r++) {
+      rk += 4;
+      uint32_t t0 = t.te[0][s0 >> 24] ^ t.te[1][(s1 >> 16) & 0xff] ^
+                    t.te[2][(s2 >> 8) & 0xff] ^ t.te[3][s3 & 0xff] ^ rk[0];
+      uint32_t t1 = t.te[0][s1 >> 24] ^ t.te[1][(s2 >> 16) & 0xff] ^
+                    t.te[2][(s3 >> 8) & 0xff] ^ t.te[3][s0 & 0xff] ^ rk[1];
+      uint32_t t2 = t.te[0][s2 >> 24] ^ t.te[1][(s3 >> 16) & 0xff] ^
+                    t.te[2][(s0 >> 8) & 0xff] ^ t.te[3][s1 & 0xff] ^ rk[2];
+      uint32_t t3 = t.te[0][s3 >> 24] ^ t.te[1][(s0 >> 16) & 0xff] ^
+                    t.te[2][(s1 >> 8) & 0xff] ^ t.te[3][s2 & 0xff] ^ rk[3];
+      s0 = t0;
+      s1 = t1;
+      s2 = t2;
+      s3 = t3;
+    }
+    rk += 4;
+    // The last round has no MixColumns
+    const uint32_t s[4] = {s0, s1, s2, s3};
+    for (int c = 0; c < 4; c++) {
+      uint32_t out =
+          (static_cast<uint32_t>(t.sbox[s[c] >> 24]) << 24) |
+          (static_cast<uint32_t>(t.sbox[(s[(c + 1) % 4] >> 16) & 0xff])
+           << 16) |
+          (static_cast<uint32_t>(t.sbox[(s[(c + 2) % 4] >> 8) & 0xff])
+           << 8) |
+          static_cast<uint32_t>(t.sbox[s[(c + 3) % 4] & 0xff]);
+      StoreBigEndian(data + 4 * c, out ^ rk[c]);
+    }
+  }
+  return Status::OK();
+}
+
+// Decrypt a block of data.
+// Length of data is equal to BlockSize().
+// CTR mode never decrypts blocks, so this follows the inverse cipher of
+// FIPS-197 byte by byte.
+Status AESBlockCipher::Decrypt(char* data) {
+  const AESTables& t = Tables();
+  uint8_t* state = reinterpret_cast<uint8_t*>(data);
+  for (int r = rounds_; r >= 0; r--) {
+    const uint8_t* rk = round_key_bytes_ + 16 * r;
+    if (r != rounds_) {
+      // InvShiftRows and InvSubBytes
+      uint8_t shifted[16];
+      for (int c = 0; c < 4; c++) {
+        for (int row = 0; row < 4; row++) {
+          shifted[row + 4 * ((c + row) % 4)] = t.inv_sbox[state[row + 4 * c]];
+        }
+      }
+      memcpy(state, shifted, sizeof(shifted));
+    }
+    for (int i = 0; i < 16; i++) {
+      state[i] ^= rk[i];
+    }
+    if (r != rounds_ && r != 0) {
+      // InvMixColumns
+      for (int c = 0; c < 4; c++) {
+        uint8_t* col = state + 4 * c;
+        uint8_t a0 = col[0], a1 = col[1], a2 = col[2], a3 = col[3];
+        col[0] = Multiply(a0, 14) ^ Multiply(a1, 11) ^ Multiply(a2, 13) ^
+                 Multiply(a3, 9);
+        col[1] = Multiply(a0, 9) ^ Multiply(a1, 14) ^ Multiply(a2, 11) ^
+                 Multiply(a3, 13);
+        col[2] = Multiply(a0, 13) ^ Multiply(a1, 9) ^ Multiply(a2, 14) ^
+                 Multiply(a3, 11);
+        col[3] = Multiply(a0, 11) ^ Multiply(a1, 13) ^ Multiply(a2, 9) ^
+                 Multiply(a3, 14);
+      }
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
@@ -35,6 +35,34 @@ class ROT13BlockCipher : public BlockCipher {
   Status Decrypt(char* data) override;
 };
 
+// Implements a BlockCipher using AES, with a 128, 192 or 256-bit key.
+// EncryptBlocks pipelines several blocks through the AES-NI instructions on
+// x86-64 CPUs supporting them, or the ARMv8 cryptography extension when
+// compiled for it, and otherwise uses a table based implementation.
+class AESBlockCipher : public BlockCipher {
+ public:
+  static const size_t kBlockSize = 16;
+
+  // REQUIRES: key.size() is 16, 24 or 32
+  explicit AESBlockCipher(const Slice& key);
+  virtual ~AESBlockCipher() {}
+  const char* Name() const override;
+  size_t BlockSize() override { return kBlockSize; }
+
+  Status Encrypt(char* data) override;
+  Status Decrypt(char* data) override;
+  Status EncryptBlocks(char* data, size_t num_blocks) override;
+
+  // Whether EncryptBlocks uses the CPU instructions for AES
+  static bool HardwareAccelerated();
+
+ private:
+  int rounds_;
+  // Encryption round keys, as big-endian words and as bytes
+  uint32_t round_keys_[60];
+  uint8_t round_key_bytes_[240];
+};
+
 // CTRCipherStream implements BlockAccessCipherStream using an
 // Counter operations mode.
 // See https://en.wikipedia.org/wiki/Block_cipher_mode_of_operation
@@ -56,6 +84,13 @@ class CTRCipherStream final : public BlockAccessCipherStream {
   // BlockSize returns the size of each block supported by this cipher stream.
   size_t BlockSize() override { return cipher_->BlockSize(); }
 
+  // Encrypt data at the file offset, the counter blocks of up to 4KB of data
+  // being encrypted by one BlockCipher::EncryptBlocks call.
+  Status Encrypt(uint64_t fileOffset, char* data, size_t dataSize) override;
+
+  // For CTR decryption & encryption are the same
+  Status Decrypt(uint64_t fileOffset, char* data, size_t dataSize) override;
+
  protected:
   // Allocate scratch space which is passed to EncryptBlock/DecryptBlock.
   void AllocateScratch(std::string&) override;
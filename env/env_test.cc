@@ -35,6 +35,7 @@
 #include "port/malloc.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
+#include "rocksdb/statistics.h"
 #include "test_util/sync_point.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
@@ -1264,6 +1265,75 @@ TEST_P(EnvPosixTestWithParam, MultiRead) {
   }
 }
 
+TEST_P(EnvPosixTestWithParam, ReadAsync) {
+  EnvOptions soptions;
+  std::string fname = test::PerThreadDBPath(env_, "testfile");
+
+  const size_t kSectorSize = 4096;
+  const size_t kNumSectors = 8;
+
+  // Create file.
+  {
+    std::unique_ptr<WritableFile> wfile;
+    ASSERT_OK(env_->NewWritableFile(fname, &wfile, soptions));
+    for (size_t i = 0; i < kNumSectors; ++i) {
+      auto data = NewAligned(kSectorSize * 8, static_cast<char>(i + 1));
+      Slice slice(data.get(), kSectorSize);
+      ASSERT_OK(wfile->Append(slice));
+    }
+    ASSERT_OK(wfile->Close());
+  }
+
+  std::shared_ptr<FileSystem> fs = env_->GetFileSystem();
+  std::unique_ptr<FSRandomAccessFile> file;
+  ASSERT_OK(fs->NewRandomAccessFile(fname, FileOptions(soptions), &file,
+                                    nullptr));
+
+  // Three sectors per request, the last one reaching past the end of the file
+  std::vector<FSReadRequest> reqs(3);
+  std::vector<FSReadRequest> results(reqs.size());
+  std::vector<int> num_callbacks(reqs.size(), 0);
+  std::vector<std::unique_ptr<char, Deleter>> data;
+  std::vector<void*> io_handles;
+  std::vector<IOHandleDeleter> del_fns;
+  for (size_t i = 0; i < reqs.size(); ++i) {
+    reqs[i].offset = i * 3 * kSectorSize;
+    reqs[i].len = 3 * kSectorSize;
+    data.emplace_back(NewAligned(3 * kSectorSize, 0));
+    reqs[i].scratch = data.back().get();
+    void* io_handle = nullptr;
+    IOHandleDeleter del_fn;
+    ASSERT_OK(file->ReadAsync(
+        reqs[i], IOOptions(),
+        [&](const FSReadRequest& req, void* cb_arg) {
+          size_t idx = reinterpret_cast<size_t>(cb_arg);
+          results[idx] = req;
+          num_callbacks[idx]++;
+        },
+        reinterpret_cast<void*>(i), &io_handle, &del_fn, nullptr));
+    if (io_handle != nullptr) {
+      io_handles.push_back(io_handle);
+      del_fns.push_back(del_fn);
+    }
+  }
+  ASSERT_OK(fs->Poll(io_handles, io_handles.size()));
+  for (size_t i = 0; i < io_handles.size(); ++i) {
+    del_fns[i](io_handles[i]);
+  }
+
+  for (size_t i = 0; i < reqs.size(); ++i) {
+    ASSERT_EQ(1, num_callbacks[i]);
+    ASSERT_OK(results[i].status);
+    size_t num_sectors = std::min(kNumSectors - i * 3, size_t{3});
+    ASSERT_EQ(num_sectors * kSectorSize, results[i].result.size());
+    for (size_t j = 0; j < num_sectors; ++j) {
+      auto buf = NewAligned(kSectorSize, static_cast<char>(i * 3 + j + 1));
+      ASSERT_EQ(0, memcmp(results[i].result.data() + j * kSectorSize,
+                          buf.get(), kSectorSize));
+    }
+  }
+}
+
 TEST_F(EnvPosixTest, MultiReadNonAlignedLargeNum) {
   // In this test we don't do aligned read, wo it doesn't work for
   // direct I/O case.
@@ -2051,6 +2121,108 @@ TEST_F(EnvTest, Close) {
   delete env;
 }
 
+TEST_F(EnvTest, WorkStealingEnvPriorities) {
+  WorkStealingEnvOptions options;
+  options.statistics = CreateDBStatistics();
+  std::unique_ptr<Env> env(NewWorkStealingEnv(Env::Default(), options));
+  env->SetBackgroundThreads(1, Env::LOW);
+  env->SetBackgroundThreads(0, Env::HIGH);
+  ASSERT_EQ(1, env->GetBackgroundThreads(Env::LOW));
+  ASSERT_EQ(0, env->GetBackgroundThreads(Env::HIGH));
+
+  // Blocks the only thread
+  test::SleepingBackgroundTask sleeping_task;
+  env->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task,
+                Env::Priority::LOW);
+  sleeping_task.WaitUntilSleeping();
+
+  struct Job {
+    port::Mutex* mu;
+    std::string* order;
+    char name;
+  };
+  port::Mutex mu;
+  std::string order;
+  auto run = [](void* arg) {
+    Job* job = reinterpret_cast<Job*>(arg);
+    MutexLock l(job->mu);
+    job->order->push_back(job->name);
+  };
+  Job bottom{&mu, &order, 'B'};
+  Job low{&mu, &order, 'L'};
+  Job high{&mu, &order, 'H'};
+  Job unscheduled{&mu, &order, 'U'};
+  env->Schedule(run, &bottom, Env::Priority::BOTTOM);
+  env->Schedule(run, &low, Env::Priority::LOW);
+  env->Schedule(run, &unscheduled, Env::Priority::LOW, &unscheduled);
+  env->Schedule(run, &high, Env::Priority::HIGH);
+  ASSERT_EQ(1U, env->GetThreadPoolQueueLen(Env::Priority::BOTTOM));
+  ASSERT_EQ(2U, env->GetThreadPoolQueueLen(Env::Priority::LOW));
+  ASSERT_EQ(1U, env->GetThreadPoolQueueLen(Env::Priority::HIGH));
+
+  // Jobs are unscheduled by priority
+  ASSERT_EQ(0, env->UnSchedule(&unscheduled, Env::Priority::HIGH));
+  ASSERT_EQ(1, env->UnSchedule(&unscheduled, Env::Priority::LOW));
+
+  // The queued jobs run by priority
+  sleeping_task.WakeUp();
+  sleeping_task.WaitUntilDone();
+  for (int i = 0; i < kDelayMicros; i++) {
+    {
+      MutexLock l(&mu);
+      if (order.size() == 3) {
+        break;
+      }
+    }
+    Env::Default()->SleepForMicroseconds(1);
+  }
+  {
+    MutexLock l(&mu);
+    ASSERT_EQ("HLB", order);
+  }
+
+  HistogramData data;
+  options.statistics->histogramData(HIGH_PRI_POOL_QUEUEING_MICROS, &data);
+  ASSERT_EQ(1U, data.count);
+  options.statistics->histogramData(LOW_PRI_POOL_QUEUEING_MICROS, &data);
+  ASSERT_EQ(2U, data.count);
+  options.statistics->histogramData(BOTTOM_PRI_POOL_QUEUEING_MICROS, &data);
+  ASSERT_EQ(1U, data.count);
+}
+
+TEST_F(EnvTest, WorkStealingEnvSteals) {
+  std::unique_ptr<Env> env(
+      NewWorkStealingEnv(Env::Default(), WorkStealingEnvOptions()));
+  env->SetBackgroundThreads(4, Env::LOW);
+
+  // A job that queues jobs on its own worker and waits for them, which
+  // only completes if the other workers take them
+  const int kNumChildren = 16;
+  std::atomic<int> children_done(0);
+  std::atomic<bool> parent_done(false);
+  auto child = [](void* arg) {
+    reinterpret_cast<std::atomic<int>*>(arg)->fetch_add(1);
+  };
+  std::function<void()> parent = [&]() {
+    for (int i = 0; i < kNumChildren; i++) {
+      env->Schedule(child, &children_done, Env::Priority::LOW);
+    }
+    for (int i = 0; i < kDelayMicros && children_done.load() < kNumChildren;
+         i++) {
+      Env::Default()->SleepForMicroseconds(10);
+    }
+    parent_done.store(true);
+  };
+  env->Schedule(
+      [](void* arg) { (*reinterpret_cast<std::function<void()>*>(arg))(); },
+      &parent, Env::Priority::LOW);
+  for (int i = 0; i < kDelayMicros && !parent_done.load(); i++) {
+    Env::Default()->SleepForMicroseconds(10);
+  }
+  ASSERT_TRUE(parent_done.load());
+  ASSERT_EQ(kNumChildren, children_done.load());
+}
+
 INSTANTIATE_TEST_CASE_P(DefaultEnvWithoutDirectIO, EnvPosixTestWithParam,
                         ::testing::Values(std::pair<Env*, bool>(Env::Default(),
                                                                 false)));
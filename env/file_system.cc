@@ -46,6 +46,25 @@ void FileSystem::GetExtentInfo(const uint64_t fileno, const int ext_no, int& zon
     extent_length = 0;
     extent_start = 0;
 }
+//dummy for ZenFS
+void FileSystem::GetFileExtents(const std::vector<uint64_t>& /*fnos*/,
+                                std::vector<ZonedFileExtent>* /*extents*/) {}
+//dummy for ZenFS
+bool FileSystem::GetProperty(const std::string& /*property*/,
+                             std::string* /*value*/) {
+  return false;
+}
+//dummy for ZenFS
+uint64_t FileSystem::GetZoneFreeBytes(const std::vector<uint64_t>& /*fnos*/) {
+  return 0;
+}
+//dummy for ZenFS
+uint64_t FileSystem::GetZoneCapacity(int /*level*/, uint64_t* max_capacity) {
+  *max_capacity = 0;
+  return 0;
+}
+
+int FileSystem::GetStorageTier(int /*level*/) { return 0; }
 
 IOStatus FileSystem::ReuseWritableFile(const std::string& fname,
                                        const std::string& old_fname,
@@ -93,6 +112,7 @@ FileOptions FileSystem::OptimizeForCompactionTableWrite(
   FileOptions optimized_file_options(file_options);
   optimized_file_options.use_direct_writes =
       db_options.use_direct_io_for_flush_and_compaction;
+  optimized_file_options.async_flush = db_options.async_table_file_flush;
   return optimized_file_options;
 }
 
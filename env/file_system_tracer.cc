@@ -203,9 +203,19 @@ IOStatus FSSequentialFileTracingWrapper::Read(size_t n,
   timer.Start();
   IOStatus s = target()->Read(n, options, result, scratch, dbg);
   uint64_t elapsed = timer.ElapsedNanos();
-  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOLen, __func__,
-                          elapsed, s.ToString(), result->size());
+  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOFileNameLenAndOffset,
+                          __func__, elapsed, s.ToString(), file_name_,
+                          result->size(), read_offset_);
   io_tracer_->WriteIOOp(io_record);
+  read_offset_ += result->size();
+  return s;
+}
+
+IOStatus FSSequentialFileTracingWrapper::Skip(uint64_t n) {
+  IOStatus s = target()->Skip(n);
+  if (s.ok()) {
+    read_offset_ += n;
+  }
   return s;
 }
 
@@ -229,9 +239,9 @@ IOStatus FSSequentialFileTracingWrapper::PositionedRead(
   IOStatus s =
       target()->PositionedRead(offset, n, options, result, scratch, dbg);
   uint64_t elapsed = timer.ElapsedNanos();
-  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOLenAndOffset,
-                          __func__, elapsed, s.ToString(), result->size(),
-                          offset);
+  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOFileNameLenAndOffset,
+                          __func__, elapsed, s.ToString(), file_name_,
+                          result->size(), offset);
   io_tracer_->WriteIOOp(io_record);
   return s;
 }
@@ -244,8 +254,9 @@ IOStatus FSRandomAccessFileTracingWrapper::Read(uint64_t offset, size_t n,
   timer.Start();
   IOStatus s = target()->Read(offset, n, options, result, scratch, dbg);
   uint64_t elapsed = timer.ElapsedNanos();
-  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOLenAndOffset,
-                          __func__, elapsed, s.ToString(), n, offset);
+  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOFileNameLenAndOffset,
+                          __func__, elapsed, s.ToString(), file_name_, n,
+                          offset);
   io_tracer_->WriteIOOp(io_record);
   return s;
 }
@@ -260,9 +271,10 @@ IOStatus FSRandomAccessFileTracingWrapper::MultiRead(FSReadRequest* reqs,
   uint64_t elapsed = timer.ElapsedNanos();
   uint64_t latency = elapsed;
   for (size_t i = 0; i < num_reqs; i++) {
-    IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOLenAndOffset,
-                            __func__, latency, reqs[i].status.ToString(),
-                            reqs[i].len, reqs[i].offset);
+    IOTraceRecord io_record(
+        env_->NowNanos(), TraceType::kIOFileNameLenAndOffset, __func__,
+        latency, reqs[i].status.ToString(), file_name_, reqs[i].len,
+        reqs[i].offset);
     io_tracer_->WriteIOOp(io_record);
   }
   return s;
@@ -275,8 +287,9 @@ IOStatus FSRandomAccessFileTracingWrapper::Prefetch(uint64_t offset, size_t n,
   timer.Start();
   IOStatus s = target()->Prefetch(offset, n, options, dbg);
   uint64_t elapsed = timer.ElapsedNanos();
-  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOLenAndOffset,
-                          __func__, elapsed, s.ToString(), n, offset);
+  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOFileNameLenAndOffset,
+                          __func__, elapsed, s.ToString(), file_name_, n,
+                          offset);
   io_tracer_->WriteIOOp(io_record);
   return s;
 }
@@ -301,9 +314,11 @@ IOStatus FSWritableFileTracingWrapper::Append(const Slice& data,
   timer.Start();
   IOStatus s = target()->Append(data, options, dbg);
   uint64_t elapsed = timer.ElapsedNanos();
-  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOLen, __func__,
-                          elapsed, s.ToString(), data.size());
+  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOFileNameLenAndOffset,
+                          __func__, elapsed, s.ToString(), file_name_,
+                          data.size(), append_offset_);
   io_tracer_->WriteIOOp(io_record);
+  append_offset_ += data.size();
   return s;
 }
 
@@ -313,9 +328,11 @@ IOStatus FSWritableFileTracingWrapper::PositionedAppend(
   StopWatchNano timer(env_);
   timer.Start();
   IOStatus s = target()->PositionedAppend(data, offset, options, dbg);
+  append_offset_ = offset + data.size();
   uint64_t elapsed = timer.ElapsedNanos();
-  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOLenAndOffset,
-                          __func__, elapsed, s.ToString(), data.size(), offset);
+  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOFileNameLenAndOffset,
+                          __func__, elapsed, s.ToString(), file_name_,
+                          data.size(), offset);
   io_tracer_->WriteIOOp(io_record);
   return s;
 }
@@ -326,6 +343,7 @@ IOStatus FSWritableFileTracingWrapper::Truncate(uint64_t size,
   StopWatchNano timer(env_);
   timer.Start();
   IOStatus s = target()->Truncate(size, options, dbg);
+  append_offset_ = size;
   uint64_t elapsed = timer.ElapsedNanos();
   IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOLen, __func__,
                           elapsed, s.ToString(), size);
@@ -378,8 +396,9 @@ IOStatus FSRandomRWFileTracingWrapper::Write(uint64_t offset, const Slice& data,
   timer.Start();
   IOStatus s = target()->Write(offset, data, options, dbg);
   uint64_t elapsed = timer.ElapsedNanos();
-  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOLenAndOffset,
-                          __func__, elapsed, s.ToString(), data.size(), offset);
+  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOFileNameLenAndOffset,
+                          __func__, elapsed, s.ToString(), file_name_,
+                          data.size(), offset);
   io_tracer_->WriteIOOp(io_record);
   return s;
 }
@@ -392,8 +411,9 @@ IOStatus FSRandomRWFileTracingWrapper::Read(uint64_t offset, size_t n,
   timer.Start();
   IOStatus s = target()->Read(offset, n, options, result, scratch, dbg);
   uint64_t elapsed = timer.ElapsedNanos();
-  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOLenAndOffset,
-                          __func__, elapsed, s.ToString(), n, offset);
+  IOTraceRecord io_record(env_->NowNanos(), TraceType::kIOFileNameLenAndOffset,
+                          __func__, elapsed, s.ToString(), file_name_, n,
+                          offset);
   io_tracer_->WriteIOOp(io_record);
   return s;
 }
@@ -0,0 +1,227 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "env/fs_hedged.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "monitoring/histogram.h"
+#include "monitoring/statistics.h"
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/threadpool.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// A read and its hedge. Shared with the jobs of the thread pool, which may
+// still run the loser after the read returned.
+struct HedgedRead {
+  HedgedRead(uint64_t _offset, size_t _n, const IOOptions& _options)
+      : offset(_offset), n(_n), options(_options), cv(&mu) {}
+
+  struct Attempt {
+    std::unique_ptr<char[]> buf;
+    Slice result;
+    IOStatus status;
+  };
+
+  const uint64_t offset;
+  const size_t n;
+  const IOOptions options;
+  port::Mutex mu;
+  port::CondVar cv;
+  // Set when the read returned: the attempts not started are cancelled
+  bool finished = false;
+  int issued = 0;
+  int completed = 0;
+  // The first attempt to complete successfully, or -1
+  int winner = -1;
+  Attempt attempts[2];
+};
+
+struct HedgedReadState {
+  explicit HedgedReadState(const HedgedReadOptions& _options)
+      : options(_options),
+        env(Env::Default()),
+        pool(NewThreadPool(std::max(_options.num_threads, 1))),
+        latencies(std::make_shared<HistogramImpl>()) {}
+
+  ~HedgedReadState() { pool->JoinAllThreads(); }
+
+  const HedgedReadOptions options;
+  Env* const env;
+  std::unique_ptr<ThreadPool> pool;
+  // Of the reads of all the files
+  std::shared_ptr<HistogramImpl> latencies;
+};
+
+void RunAttempt(const std::shared_ptr<HedgedRead>& read, int i,
+                const std::shared_ptr<FSRandomAccessFile>& file,
+                const std::shared_ptr<HistogramImpl>& file_latencies,
+                const std::shared_ptr<HistogramImpl>& latencies, Env* env,
+                Statistics* stats) {
+  {
+    MutexLock l(&read->mu);
+    if (read->finished) {
+      read->completed++;
+      RecordTick(stats, HEDGED_READ_CANCELLED);
+      return;
+    }
+  }
+  HedgedRead::Attempt& attempt = read->attempts[i];
+  attempt.buf.reset(new char[read->n]);
+  const uint64_t start = env->NowMicros();
+  attempt.status = file->Read(read->offset, read->n, read->options,
+                              &attempt.result, attempt.buf.get(), nullptr);
+  if (attempt.status.ok()) {
+    const uint64_t micros = env->NowMicros() - start;
+    file_latencies->Add(micros);
+    latencies->Add(micros);
+  }
+  MutexLock l(&read->mu);
+  read->completed++;
+  if (attempt.status.ok() && read->winner < 0) {
+    read->winner = i;
+  }
+  read->cv.SignalAll();
+}
+
+class HedgedRandomAccessFile : public FSRandomAccessFileWrapper {
+ public:
+  HedgedRandomAccessFile(const std::shared_ptr<HedgedReadState>& state,
+                         std::unique_ptr<FSRandomAccessFile>&& file,
+                         std::unique_ptr<FSRandomAccessFile>&& replica)
+      : FSRandomAccessFileWrapper(file.get()),
+        state_(state),
+        file_(std::move(file)),
+        replica_(std::move(replica)),
+        latencies_(std::make_shared<HistogramImpl>()) {}
+
+  IOStatus Read(uint64_t offset, size_t n, const IOOptions& options,
+                Slice* result, char* scratch,
+                IODebugContext* dbg) const override {
+    if (n == 0 || file_->use_direct_io()) {
+      return file_->Read(offset, n, options, result, scratch, dbg);
+    }
+    Statistics* stats = state_->options.statistics.get();
+    auto read = std::make_shared<HedgedRead>(offset, n, options);
+    const uint64_t deadline = state_->env->NowMicros() + HedgeDelayMicros();
+    MutexLock l(&read->mu);
+    Issue(read, 0, file_);
+    while (read->winner < 0 && read->completed < read->issued) {
+      if (read->issued == 1) {
+        if (read->cv.TimedWait(deadline) && read->completed == 0) {
+          Issue(read, 1, replica_ != nullptr ? replica_ : file_);
+          RecordTick(stats, HEDGED_READS);
+        }
+      } else {
+        read->cv.Wait();
+      }
+    }
+    read->finished = true;
+
+    const int i = read->winner >= 0 ? read->winner : 0;
+    const HedgedRead::Attempt& attempt = read->attempts[i];
+    if (!attempt.status.ok()) {
+      return attempt.status;
+    }
+    if (i == 1) {
+      RecordTick(stats, HEDGED_READ_WINS);
+    }
+    memcpy(scratch, attempt.result.data(), attempt.result.size());
+    *result = Slice(scratch, attempt.result.size());
+    return IOStatus::OK();
+  }
+
+ private:
+  uint64_t HedgeDelayMicros() const {
+    const HedgedReadOptions& opts = state_->options;
+    const HistogramImpl* latencies = nullptr;
+    if (latencies_->num() >= opts.min_samples) {
+      latencies = latencies_.get();
+    } else if (state_->latencies->num() >= opts.min_samples) {
+      latencies = state_->latencies.get();
+    }
+    if (latencies == nullptr) {
+      return opts.max_delay_us;
+    }
+    const uint64_t delay =
+        static_cast<uint64_t>(latencies->Percentile(opts.delay_percentile));
+    return std::min(std::max(delay, opts.min_delay_us), opts.max_delay_us);
+  }
+
+  // REQUIRES: read->mu held
+  void Issue(const std::shared_ptr<HedgedRead>& read, int i,
+             const std::shared_ptr<FSRandomAccessFile>& file) const {
+    read->issued++;
+    std::shared_ptr<HistogramImpl> file_latencies = latencies_;
+    std::shared_ptr<HistogramImpl> latencies = state_->latencies;
+    Env* env = state_->env;
+    Statistics* stats = state_->options.statistics.get();
+    // The jobs do not hold the state, as the last reference to it must not
+    // be dropped on a thread of its pool
+    state_->pool->SubmitJob(
+        [read, i, file, file_latencies, latencies, env, stats]() {
+          RunAttempt(read, i, file, file_latencies, latencies, env, stats);
+        });
+  }
+
+  std::shared_ptr<HedgedReadState> state_;
+  std::shared_ptr<FSRandomAccessFile> file_;
+  std::shared_ptr<FSRandomAccessFile> replica_;
+  std::shared_ptr<HistogramImpl> latencies_;
+};
+
+class HedgedReadFileSystem : public FileSystemWrapper {
+ public:
+  HedgedReadFileSystem(const std::shared_ptr<FileSystem>& fs,
+                       const HedgedReadOptions& options)
+      : FileSystemWrapper(fs),
+        state_(std::make_shared<HedgedReadState>(options)) {}
+
+  const char* Name() const override { return "HedgedReadFileSystem"; }
+
+  IOStatus NewRandomAccessFile(const std::string& f,
+                               const FileOptions& file_opts,
+                               std::unique_ptr<FSRandomAccessFile>* r,
+                               IODebugContext* dbg) override {
+    std::unique_ptr<FSRandomAccessFile> file;
+    IOStatus s = target()->NewRandomAccessFile(f, file_opts, &file, dbg);
+    if (!s.ok()) {
+      return s;
+    }
+    // Without a replica, the hedges go to the file itself
+    std::unique_ptr<FSRandomAccessFile> replica;
+    if (state_->options.replica_fs != nullptr) {
+      state_->options.replica_fs
+          ->NewRandomAccessFile(f, file_opts, &replica, dbg)
+          .PermitUncheckedError();
+    }
+    r->reset(new HedgedRandomAccessFile(state_, std::move(file),
+                                        std::move(replica)));
+    return s;
+  }
+
+ private:
+  std::shared_ptr<HedgedReadState> state_;
+};
+
+}  // namespace
+
+std::shared_ptr<FileSystem> NewHedgedReadFileSystem(
+    const std::shared_ptr<FileSystem>& fs, const HedgedReadOptions& options) {
+  return std::make_shared<HedgedReadFileSystem>(fs, options);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
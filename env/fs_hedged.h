@@ -0,0 +1,50 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <memory>
+
+#include "rocksdb/file_system.h"
+#include "rocksdb/statistics.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct HedgedReadOptions {
+  // The file system holding replicas of the files, under the same paths, the
+  // hedges go to. When nullptr, a hedge is a second request to the file
+  // system wrapped, e.g. to another datanode of a remote file system.
+  std::shared_ptr<FileSystem> replica_fs;
+
+  // A read is hedged when it takes longer than this percentile of the read
+  // latencies of its file, or of all the files until its own has
+  // min_samples reads, bounded to [min_delay_us, max_delay_us]. Before
+  // there are min_samples reads in all, the delay is max_delay_us.
+  double delay_percentile = 95.0;
+  uint64_t min_samples = 32;
+  uint64_t min_delay_us = 1000;
+  uint64_t max_delay_us = 100000;
+
+  // Threads running the reads and their hedges
+  int num_threads = 16;
+
+  // For the HEDGED_READ* tickers
+  std::shared_ptr<Statistics> statistics;
+};
+
+// Returns a FileSystem hedging the reads of the random access files of fs,
+// which are issued on a thread pool: a read still running after the hedge
+// delay is issued a second time, to the replica or to fs, and the first to
+// complete successfully wins. A hedge is cancelled when the read completes
+// before it starts, and otherwise its result is dropped. Reads of files
+// opened for direct I/O are not hedged.
+std::shared_ptr<FileSystem> NewHedgedReadFileSystem(
+    const std::shared_ptr<FileSystem>& fs, const HedgedReadOptions& options);
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
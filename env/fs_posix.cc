@@ -265,7 +265,8 @@ class PosixFileSystem : public FileSystem {
           options
 #if defined(ROCKSDB_IOURING_PRESENT)
           ,
-          thread_local_io_urings_.get()
+          thread_local_io_urings_.get(),
+          thread_local_async_read_io_urings_.get()
 #endif
               ));
     }
@@ -904,6 +905,17 @@ class PosixFileSystem : public FileSystem {
     return io_s;
   }
 
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t /*min_completions*/) override {
+#if defined(ROCKSDB_IOURING_PRESENT)
+    return PollIOUring(io_handles);
+#else
+    // ReadAsync() completes reads before returning without io_uring
+    (void)io_handles;
+    return IOStatus::OK();
+#endif
+  }
+
   FileOptions OptimizeForLogWrite(const FileOptions& file_options,
                                  const DBOptions& db_options) const override {
     FileOptions optimized = file_options;
@@ -974,6 +986,8 @@ class PosixFileSystem : public FileSystem {
 #if defined(ROCKSDB_IOURING_PRESENT)
   // io_uring instance
   std::unique_ptr<ThreadLocalPtr> thread_local_io_urings_;
+  // io_uring instance for PosixRandomAccessFile::ReadAsync()
+  std::unique_ptr<ThreadLocalPtr> thread_local_async_read_io_urings_;
 #endif
 
   size_t page_size_;
@@ -1035,6 +1049,8 @@ PosixFileSystem::PosixFileSystem()
   struct io_uring* new_io_uring = CreateIOUring();
   if (new_io_uring != nullptr) {
     thread_local_io_urings_.reset(new ThreadLocalPtr(DeleteIOUring));
+    thread_local_async_read_io_urings_.reset(
+        new ThreadLocalPtr(DeleteIOUring));
     delete new_io_uring;
   }
 #endif
@@ -1071,9 +1087,12 @@ static FactoryFunc<FileSystem> zenfs_filesystem_reg =
           Status s;
 
           devID.replace(0, strlen("zenfs://"), "");
+          /* zenfs://ro:dev:... mounts read-only, next to a primary */
+          bool readonly = devID.rfind("ro:", 0) == 0;
+          if (readonly) devID.replace(0, strlen("ro:"), "");
           if (devID.rfind("dev:") == 0) {
             devID.replace(0, strlen("dev:"), "");
-            s = NewZenFS(&fs, devID);
+            s = NewZenFS(&fs, devID, readonly);
             if (!s.ok()) {
               *errmsg = s.ToString();
             }
@@ -1085,7 +1104,7 @@ static FactoryFunc<FileSystem> zenfs_filesystem_reg =
             if (zenFileSystems.find(devID) == zenFileSystems.end()) {
               *errmsg = "UUID not found";
             } else {
-              s = NewZenFS(&fs, zenFileSystems[devID]);
+              s = NewZenFS(&fs, zenFileSystems[devID], readonly);
               if (!s.ok()) {
                 *errmsg = s.ToString();
               }
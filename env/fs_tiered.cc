@@ -0,0 +1,532 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "env/fs_tiered.h"
+
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "file/filename.h"
+#include "port/port.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Syncs a directory on both file systems
+class TieredDirectory : public FSDirectory {
+ public:
+  TieredDirectory(std::unique_ptr<FSDirectory>&& fast,
+                  std::unique_ptr<FSDirectory>&& slow)
+      : fast_(std::move(fast)), slow_(std::move(slow)) {}
+
+  IOStatus Fsync(const IOOptions& options, IODebugContext* dbg) override {
+    IOStatus s = fast_->Fsync(options, dbg);
+    if (s.ok()) {
+      s = slow_->Fsync(options, dbg);
+    }
+    return s;
+  }
+
+  size_t GetUniqueId(char* id, size_t max_size) const override {
+    return slow_->GetUniqueId(id, max_size);
+  }
+
+ private:
+  std::unique_ptr<FSDirectory> fast_;
+  std::unique_ptr<FSDirectory> slow_;
+};
+
+// The slow file system is the target of the wrapper, which covers the calls
+// not naming a file. The tier of a file is kept from its creation, and
+// found by looking it up on the fast file system for the files of a
+// previous run.
+class TieredFileSystem : public FileSystemWrapper {
+ public:
+  TieredFileSystem(const std::shared_ptr<FileSystem>& fast_fs,
+                   const std::string& fast_root,
+                   const std::shared_ptr<FileSystem>& slow_fs,
+                   int max_fast_level)
+      : FileSystemWrapper(slow_fs),
+        fast_(fast_fs),
+        fast_root_(fast_root),
+        max_fast_level_(max_fast_level) {}
+
+  const char* Name() const override { return "TieredFileSystem"; }
+
+  IOStatus NewSequentialFile(const std::string& f,
+                             const FileOptions& file_opts,
+                             std::unique_ptr<FSSequentialFile>* r,
+                             IODebugContext* dbg) override {
+    if (OnFast(f, file_opts.io_options, dbg)) {
+      return fast_->NewSequentialFile(FastPath(f), file_opts, r, dbg);
+    }
+    return target()->NewSequentialFile(f, file_opts, r, dbg);
+  }
+
+  IOStatus NewRandomAccessFile(const std::string& f,
+                               const FileOptions& file_opts,
+                               std::unique_ptr<FSRandomAccessFile>* r,
+                               IODebugContext* dbg) override {
+    if (OnFast(f, file_opts.io_options, dbg)) {
+      return fast_->NewRandomAccessFile(FastPath(f), file_opts, r, dbg);
+    }
+    return target()->NewRandomAccessFile(f, file_opts, r, dbg);
+  }
+
+  IOStatus NewWritableFile(const std::string& f, const FileOptions& file_opts,
+                           std::unique_ptr<FSWritableFile>* r,
+                           IODebugContext* dbg) override {
+    bool on_fast = CreateOnFast(f, file_opts);
+    IOStatus s =
+        on_fast ? fast_->NewWritableFile(FastPath(f), file_opts, r, dbg)
+                : target()->NewWritableFile(f, file_opts, r, dbg);
+    if (s.ok()) {
+      Remember(f, on_fast);
+    }
+    return s;
+  }
+
+  IOStatus ReopenWritableFile(const std::string& fname,
+                              const FileOptions& file_opts,
+                              std::unique_ptr<FSWritableFile>* result,
+                              IODebugContext* dbg) override {
+    if (OnFast(fname, file_opts.io_options, dbg)) {
+      return fast_->ReopenWritableFile(FastPath(fname), file_opts, result,
+                                       dbg);
+    }
+    return target()->ReopenWritableFile(fname, file_opts, result, dbg);
+  }
+
+  IOStatus ReuseWritableFile(const std::string& fname,
+                             const std::string& old_fname,
+                             const FileOptions& file_opts,
+                             std::unique_ptr<FSWritableFile>* r,
+                             IODebugContext* dbg) override {
+    bool on_fast = OnFast(old_fname, file_opts.io_options, dbg);
+    IOStatus s = on_fast ? fast_->ReuseWritableFile(FastPath(fname),
+                                                    FastPath(old_fname),
+                                                    file_opts, r, dbg)
+                         : target()->ReuseWritableFile(fname, old_fname,
+                                                       file_opts, r, dbg);
+    if (s.ok()) {
+      Forget(old_fname);
+      Remember(fname, on_fast);
+    }
+    return s;
+  }
+
+  IOStatus NewRandomRWFile(const std::string& fname,
+                           const FileOptions& file_opts,
+                           std::unique_ptr<FSRandomRWFile>* result,
+                           IODebugContext* dbg) override {
+    if (OnFast(fname, file_opts.io_options, dbg)) {
+      return fast_->NewRandomRWFile(FastPath(fname), file_opts, result, dbg);
+    }
+    return target()->NewRandomRWFile(fname, file_opts, result, dbg);
+  }
+
+  IOStatus NewMemoryMappedFileBuffer(
+      const std::string& fname,
+      std::unique_ptr<MemoryMappedFileBuffer>* result) override {
+    if (OnFast(fname, IOOptions(), nullptr)) {
+      return fast_->NewMemoryMappedFileBuffer(FastPath(fname), result);
+    }
+    return target()->NewMemoryMappedFileBuffer(fname, result);
+  }
+
+  IOStatus NewDirectory(const std::string& name, const IOOptions& io_opts,
+                        std::unique_ptr<FSDirectory>* result,
+                        IODebugContext* dbg) override {
+    std::unique_ptr<FSDirectory> fast_dir;
+    std::unique_ptr<FSDirectory> slow_dir;
+    IOStatus s = fast_->NewDirectory(FastPath(name), io_opts, &fast_dir, dbg);
+    if (s.ok()) {
+      s = target()->NewDirectory(name, io_opts, &slow_dir, dbg);
+    }
+    if (s.ok()) {
+      result->reset(
+          new TieredDirectory(std::move(fast_dir), std::move(slow_dir)));
+    }
+    return s;
+  }
+
+  IOStatus FileExists(const std::string& f, const IOOptions& io_opts,
+                      IODebugContext* dbg) override {
+    if (OnFast(f, io_opts, dbg)) {
+      return fast_->FileExists(FastPath(f), io_opts, dbg);
+    }
+    return target()->FileExists(f, io_opts, dbg);
+  }
+
+  IOStatus GetChildren(const std::string& dir, const IOOptions& io_opts,
+                       std::vector<std::string>* r,
+                       IODebugContext* dbg) override {
+    std::vector<std::string> fast_children;
+    IOStatus fast_s = fast_->GetChildren(FastPath(dir), io_opts,
+                                         &fast_children, dbg);
+    if (!fast_s.ok() && !fast_s.IsNotFound()) {
+      return fast_s;
+    }
+    IOStatus s = target()->GetChildren(dir, io_opts, r, dbg);
+    if (!s.ok() && !(s.IsNotFound() && fast_s.ok())) {
+      return s;
+    }
+    std::set<std::string> children(r->begin(), r->end());
+    children.insert(fast_children.begin(), fast_children.end());
+    r->assign(children.begin(), children.end());
+    return IOStatus::OK();
+  }
+
+  IOStatus GetChildrenFileAttributes(const std::string& dir,
+                                     const IOOptions& options,
+                                     std::vector<FileAttributes>* result,
+                                     IODebugContext* dbg) override {
+    std::vector<FileAttributes> fast_attrs;
+    IOStatus fast_s = fast_->GetChildrenFileAttributes(FastPath(dir), options,
+                                                       &fast_attrs, dbg);
+    if (!fast_s.ok() && !fast_s.IsNotFound()) {
+      return fast_s;
+    }
+    IOStatus s =
+        target()->GetChildrenFileAttributes(dir, options, result, dbg);
+    if (!s.ok() && !(s.IsNotFound() && fast_s.ok())) {
+      return s;
+    }
+    std::set<std::string> names;
+    for (const auto& attr : *result) {
+      names.insert(attr.name);
+    }
+    for (const auto& attr : fast_attrs) {
+      if (names.insert(attr.name).second) {
+        result->push_back(attr);
+      }
+    }
+    return IOStatus::OK();
+  }
+
+  IOStatus DeleteFile(const std::string& f, const IOOptions& options,
+                      IODebugContext* dbg) override {
+    IOStatus s = OnFast(f, options, dbg)
+                     ? fast_->DeleteFile(FastPath(f), options, dbg)
+                     : target()->DeleteFile(f, options, dbg);
+    if (s.ok()) {
+      Forget(f);
+    }
+    return s;
+  }
+
+  // Each file system deletes its files in one batch, or one by one if it
+  // cannot
+  IOStatus DeleteFiles(const std::vector<std::string>& fnames,
+                       const IOOptions& options,
+                       std::vector<IOStatus>* statuses,
+                       IODebugContext* dbg) override {
+    std::vector<std::string> tier_fnames[2];
+    std::vector<size_t> tier_indexes[2];
+    for (size_t i = 0; i < fnames.size(); i++) {
+      int tier = OnFast(fnames[i], options, dbg) ? 0 : 1;
+      tier_fnames[tier].push_back(tier == 0 ? FastPath(fnames[i])
+                                            : fnames[i]);
+      tier_indexes[tier].push_back(i);
+    }
+    statuses->assign(fnames.size(), IOStatus::OK());
+    FileSystem* tier_fs[2] = {fast_.get(), target()};
+    for (int tier = 0; tier < 2; tier++) {
+      if (tier_fnames[tier].empty()) {
+        continue;
+      }
+      std::vector<IOStatus> tier_statuses;
+      IOStatus s = tier_fs[tier]->DeleteFiles(tier_fnames[tier], options,
+                                              &tier_statuses, dbg);
+      if (s.IsNotSupported()) {
+        tier_statuses.clear();
+        for (const auto& fname : tier_fnames[tier]) {
+          tier_statuses.push_back(
+              tier_fs[tier]->DeleteFile(fname, options, dbg));
+        }
+      } else if (!s.ok()) {
+        return s;
+      }
+      for (size_t j = 0; j < tier_indexes[tier].size(); j++) {
+        size_t i = tier_indexes[tier][j];
+        (*statuses)[i] = tier_statuses[j];
+        if (tier_statuses[j].ok()) {
+          Forget(fnames[i]);
+        }
+      }
+    }
+    return IOStatus::OK();
+  }
+
+  IOStatus Truncate(const std::string& fname, size_t size,
+                    const IOOptions& options, IODebugContext* dbg) override {
+    if (OnFast(fname, options, dbg)) {
+      return fast_->Truncate(FastPath(fname), size, options, dbg);
+    }
+    return target()->Truncate(fname, size, options, dbg);
+  }
+
+  IOStatus CreateDir(const std::string& d, const IOOptions& options,
+                     IODebugContext* dbg) override {
+    IOStatus s = target()->CreateDir(d, options, dbg);
+    if (s.ok()) {
+      s = CreateFastDir(d, options, dbg);
+    }
+    return s;
+  }
+
+  IOStatus CreateDirIfMissing(const std::string& d, const IOOptions& options,
+                              IODebugContext* dbg) override {
+    IOStatus s = target()->CreateDirIfMissing(d, options, dbg);
+    if (s.ok()) {
+      s = CreateFastDir(d, options, dbg);
+    }
+    return s;
+  }
+
+  IOStatus DeleteDir(const std::string& d, const IOOptions& options,
+                     IODebugContext* dbg) override {
+    IOStatus s = fast_->DeleteDir(FastPath(d), options, dbg);
+    if (!s.ok() && !s.IsNotFound()) {
+      return s;
+    }
+    return target()->DeleteDir(d, options, dbg);
+  }
+
+  IOStatus GetFileSize(const std::string& f, const IOOptions& options,
+                       uint64_t* s, IODebugContext* dbg) override {
+    if (OnFast(f, options, dbg)) {
+      return fast_->GetFileSize(FastPath(f), options, s, dbg);
+    }
+    return target()->GetFileSize(f, options, s, dbg);
+  }
+
+  IOStatus GetFileModificationTime(const std::string& fname,
+                                   const IOOptions& options,
+                                   uint64_t* file_mtime,
+                                   IODebugContext* dbg) override {
+    if (OnFast(fname, options, dbg)) {
+      return fast_->GetFileModificationTime(FastPath(fname), options,
+                                            file_mtime, dbg);
+    }
+    return target()->GetFileModificationTime(fname, options, file_mtime, dbg);
+  }
+
+  // A file stays on its tier. A file of the target name on the other tier,
+  // e.g. a CURRENT file of a previous configuration, is deleted.
+  IOStatus RenameFile(const std::string& s, const std::string& t,
+                      const IOOptions& options, IODebugContext* dbg) override {
+    bool on_fast = OnFast(s, options, dbg);
+    IOStatus st = on_fast ? fast_->RenameFile(FastPath(s), FastPath(t),
+                                              options, dbg)
+                          : target()->RenameFile(s, t, options, dbg);
+    if (!st.ok()) {
+      return st;
+    }
+    if (on_fast) {
+      target()->DeleteFile(t, options, dbg).PermitUncheckedError();
+    } else {
+      fast_->DeleteFile(FastPath(t), options, dbg).PermitUncheckedError();
+    }
+    Forget(s);
+    Remember(t, on_fast);
+    return st;
+  }
+
+  IOStatus LinkFile(const std::string& s, const std::string& t,
+                    const IOOptions& options, IODebugContext* dbg) override {
+    bool on_fast = OnFast(s, options, dbg);
+    IOStatus st =
+        on_fast ? fast_->LinkFile(FastPath(s), FastPath(t), options, dbg)
+                : target()->LinkFile(s, t, options, dbg);
+    if (st.ok()) {
+      Remember(t, on_fast);
+    }
+    return st;
+  }
+
+  IOStatus NumFileLinks(const std::string& fname, const IOOptions& options,
+                        uint64_t* count, IODebugContext* dbg) override {
+    if (OnFast(fname, options, dbg)) {
+      return fast_->NumFileLinks(FastPath(fname), options, count, dbg);
+    }
+    return target()->NumFileLinks(fname, options, count, dbg);
+  }
+
+  IOStatus AreFilesSame(const std::string& first, const std::string& second,
+                        const IOOptions& options, bool* res,
+                        IODebugContext* dbg) override {
+    bool on_fast = OnFast(first, options, dbg);
+    if (on_fast != OnFast(second, options, dbg)) {
+      *res = false;
+      return IOStatus::OK();
+    }
+    if (on_fast) {
+      return fast_->AreFilesSame(FastPath(first), FastPath(second), options,
+                                 res, dbg);
+    }
+    return target()->AreFilesSame(first, second, options, res, dbg);
+  }
+
+  IOStatus LockFile(const std::string& f, const IOOptions& options,
+                    FileLock** l, IODebugContext* dbg) override {
+    return fast_->LockFile(FastPath(f), options, l, dbg);
+  }
+
+  IOStatus UnlockFile(FileLock* l, const IOOptions& options,
+                      IODebugContext* dbg) override {
+    return fast_->UnlockFile(l, options, dbg);
+  }
+
+  IOStatus NewLogger(const std::string& fname, const IOOptions& options,
+                     std::shared_ptr<Logger>* result,
+                     IODebugContext* dbg) override {
+    Remember(fname, true);
+    return fast_->NewLogger(FastPath(fname), options, result, dbg);
+  }
+
+  // The zoned file system extensions are for the slow tier
+  void SetDBPointer(DBImpl* db) override {
+    FileSystem::SetDBPointer(db);
+    fast_->SetDBPointer(db);
+    target()->SetDBPointer(db);
+  }
+  int GetZonedFileExtentNum(const uint64_t fileno) override {
+    return target()->GetZonedFileExtentNum(fileno);
+  }
+  void GetExtentInfo(const uint64_t fileno, const int ext_no, int& zone_id,
+                     uint32_t& extent_length,
+                     uint32_t& extent_start) override {
+    target()->GetExtentInfo(fileno, ext_no, zone_id, extent_length,
+                            extent_start);
+  }
+  void GetFileExtents(const std::vector<uint64_t>& fnos,
+                      std::vector<ZonedFileExtent>* extents) override {
+    target()->GetFileExtents(fnos, extents);
+  }
+  bool GetProperty(const std::string& property, std::string* value) override {
+    return target()->GetProperty(property, value);
+  }
+  uint64_t GetZoneFreeBytes(const std::vector<uint64_t>& fnos) override {
+    return target()->GetZoneFreeBytes(fnos);
+  }
+  uint64_t GetZoneCapacity(int level, uint64_t* max_capacity) override {
+    if (level <= max_fast_level_) {
+      return fast_->GetZoneCapacity(level, max_capacity);
+    }
+    return target()->GetZoneCapacity(level, max_capacity);
+  }
+
+  int GetStorageTier(int level) override {
+    return level <= max_fast_level_ ? 0 : 1;
+  }
+
+ private:
+  std::string FastPath(const std::string& f) const {
+    if (fast_root_.empty()) {
+      return f;
+    }
+    if (!f.empty() && f[0] == '/') {
+      return fast_root_ + f;
+    }
+    return fast_root_ + "/" + f;
+  }
+
+  // Creates the directory on the fast file system, with the parents under
+  // fast_root missing there
+  IOStatus CreateFastDir(const std::string& d, const IOOptions& options,
+                         IODebugContext* dbg) {
+    const std::string path = FastPath(d);
+    for (size_t pos = fast_root_.size(); pos != std::string::npos;) {
+      pos = path.find('/', pos + 1);
+      if (pos == std::string::npos || pos + 1 == path.size()) {
+        break;
+      }
+      IOStatus s =
+          fast_->CreateDirIfMissing(path.substr(0, pos), options, dbg);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    return fast_->CreateDirIfMissing(path, options, dbg);
+  }
+
+  bool CreateOnFast(const std::string& f, const FileOptions& file_opts) const {
+    uint64_t number;
+    FileType type;
+    size_t slash = f.find_last_of('/');
+    if (!ParseFileName(slash == std::string::npos ? f : f.substr(slash + 1),
+                       &number, &type)) {
+      return true;
+    }
+    switch (type) {
+      case kTableFile: {
+        int level = file_opts.placement_hint.level;
+        return level >= 0 && level <= max_fast_level_;
+      }
+      case kBlobFile:
+        return false;
+      default:
+        return true;
+    }
+  }
+
+  bool OnFast(const std::string& f, const IOOptions& options,
+              IODebugContext* dbg) {
+    {
+      MutexLock l(&mutex_);
+      auto it = on_fast_.find(f);
+      if (it != on_fast_.end()) {
+        return it->second;
+      }
+    }
+    // Files not found on either tier are not remembered, they may be
+    // created later
+    if (fast_->FileExists(FastPath(f), options, dbg).ok()) {
+      Remember(f, true);
+      return true;
+    }
+    if (target()->FileExists(f, options, dbg).ok()) {
+      Remember(f, false);
+    }
+    return false;
+  }
+
+  void Remember(const std::string& f, bool on_fast) {
+    MutexLock l(&mutex_);
+    on_fast_[f] = on_fast;
+  }
+
+  void Forget(const std::string& f) {
+    MutexLock l(&mutex_);
+    on_fast_.erase(f);
+  }
+
+  const std::shared_ptr<FileSystem> fast_;
+  const std::string fast_root_;
+  const int max_fast_level_;
+
+  port::Mutex mutex_;
+  std::unordered_map<std::string, bool> on_fast_;
+};
+
+}  // namespace
+
+std::shared_ptr<FileSystem> NewTieredFileSystem(
+    const std::shared_ptr<FileSystem>& fast_fs, const std::string& fast_root,
+    const std::shared_ptr<FileSystem>& slow_fs, int max_fast_level) {
+  return std::make_shared<TieredFileSystem>(fast_fs, fast_root, slow_fs,
+                                            max_fast_level);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
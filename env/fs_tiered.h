@@ -0,0 +1,33 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/file_system.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Returns a FileSystem putting the WAL, the metadata files and the table
+// files of the levels up to max_fast_level on fast_fs, e.g. a POSIX file
+// system on a low latency NVMe device, and the table files of the deeper
+// levels and the blob files on slow_fs, e.g. ZenFS. Files are placed when
+// they are created, by the level of FileOptions::placement_hint, so a
+// compaction into a deeper level moves the data to slow_fs. Table files
+// of unknown level, e.g. ingested ones, go to slow_fs.
+//
+// Paths are those of slow_fs. On fast_fs, they are prefixed by fast_root,
+// unless it is empty. Directories are created on both file systems.
+std::shared_ptr<FileSystem> NewTieredFileSystem(
+    const std::shared_ptr<FileSystem>& fast_fs, const std::string& fast_root,
+    const std::shared_ptr<FileSystem>& slow_fs, int max_fast_level);
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
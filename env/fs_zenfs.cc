@@ -15,6 +15,7 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -23,6 +24,18 @@
 
 #define DEFAULT_ZENV_LOG_PATH "/tmp/"
 
+/* A checkpoint is written in the background once the records appended
+ * since the last snapshot exceed both the minimum size and the ratio
+ * times the snapshot size, so replay is bounded by the live file count */
+#define ZENFS_META_CHECKPOINT_MIN_SIZE (64 * 1024 * 1024)
+#define ZENFS_META_CHECKPOINT_RATIO (4)
+#define ZENFS_META_CHECKPOINT_INTERVAL_S (30)
+/* How often a read-only mount applies the records of the primary */
+#define ZENFS_META_TAIL_INTERVAL_MS (100)
+
+/* Upper bound of a group committed batch of metadata records */
+#define ZENFS_META_BATCH_MAX_SIZE (1024 * 1024)
+
 namespace ROCKSDB_NAMESPACE {
 
 IOStatus ZenMetaLog::AddRecord(const Slice& slice) {
@@ -54,18 +67,50 @@ IOStatus ZenMetaLog::AddRecord(const Slice& slice) {
   EncodeFixed32(buffer + sizeof(uint32_t), record_sz);
   memcpy(buffer + sizeof(uint32_t) * 2, data, record_sz);
 
+  /* File syncs wait for the record, charge it like a flush */
+  zbd_->RequestIO(phys_sz, Env::IO_HIGH, RateLimiter::OpType::kWrite);
   s = zone_->Append(buffer, phys_sz);
+  if (s.ok()) zbd_->NotifyMetaLogWrite(phys_sz);
 
   free(buffer);
   return s;
 }
 
+/* Refills the read-ahead buffer starting at read_pos_ */
+IOStatus ZenMetaLog::ReadAhead() {
+  /* The log stays in one zone, so in one device */
+  ZbdDevice* dev = zone_->dev_;
+  uint64_t end = std::min(zone_->wp_.load(), zone_->start_ + zone_->max_capacity_);
+  size_t to_read = std::min((uint64_t)ZENFS_META_READAHEAD_SIZE, end - read_pos_);
+  size_t read = 0;
+  int ret;
+
+  if (ra_buf_.size() < ZENFS_META_READAHEAD_SIZE)
+    ra_buf_.resize(ZENFS_META_READAHEAD_SIZE);
+
+  ra_start_ = read_pos_;
+  ra_len_ = 0;
+
+  while (read < to_read) {
+    ret = pread(dev->read_f_, &ra_buf_[read], to_read - read,
+                dev->Offset(ra_start_ + read));
+
+    if (ret == -1 && errno == EINTR) continue;
+    if (ret < 0) return IOStatus::IOError("Read failed");
+    if (ret == 0) break;
+
+    read += ret;
+  }
+
+  ra_len_ = read;
+  return IOStatus::OK();
+}
+
 IOStatus ZenMetaLog::Read(Slice* slice) {
-  int f = zbd_->GetReadFD();
   const char* data = slice->data();
   size_t read = 0;
   size_t to_read = slice->size();
-  int ret;
+  IOStatus s;
 
   if (read_pos_ >= zone_->wp_) {
     // EOF
@@ -78,13 +123,18 @@ IOStatus ZenMetaLog::Read(Slice* slice) {
   }
 
   while (read < to_read) {
-    ret = pread(f, (void*)(data + read), to_read - read, read_pos_);
+    if (read_pos_ < ra_start_ || read_pos_ >= ra_start_ + ra_len_) {
+      s = ReadAhead();
+      if (!s.ok()) return s;
+      if (ra_len_ == 0) return IOStatus::IOError("Read beyond write pointer");
+    }
 
-    if (ret == -1 && errno == EINTR) continue;
-    if (ret < 0) return IOStatus::IOError("Read failed");
+    size_t off = read_pos_ - ra_start_;
+    size_t n = std::min(to_read - read, ra_len_ - off);
+    memcpy((void*)(data + read), ra_buf_.data() + off, n);
 
-    read += ret;
-    read_pos_ += ret;
+    read += n;
+    read_pos_ += n;
   }
 
   return IOStatus::OK();
@@ -144,18 +194,54 @@ ZenFS::ZenFS(ZonedBlockDevice* zbd, std::shared_ptr<FileSystem> aux_fs,
 
   Info(logger_, "ZenFS initializing");
   next_file_id_ = 1;
+  meta_checkpoint_exit_ = false;
+  meta_log_bytes_ = 0;
+  meta_snapshot_bytes_ = 0;
+  meta_roll_seq_ = 0;
+  meta_checkpoint_active_ = false;
+  meta_queue_leader_ = false;
+  readonly_ = false;
   metadata_writer_.zenFS = this;
   zbd_->SetFsPtr(this);
+
+#if defined(ROCKSDB_IOURING_PRESENT)
+  /* Only set up thread local io_urings if the platform supports it */
+  struct io_uring* new_io_uring = CreateIOUring();
+  if (new_io_uring != nullptr) {
+    thread_local_io_urings_.reset(new ThreadLocalPtr(DeleteIOUring));
+    thread_local_async_read_io_urings_.reset(
+        new ThreadLocalPtr(DeleteIOUring));
+    delete new_io_uring;
+  }
+#endif
+}
+
+IOStatus ZenFS::Poll(std::vector<void*>& io_handles,
+                     size_t /*min_completions*/) {
+#if defined(ROCKSDB_IOURING_PRESENT)
+  return ZoneFile::PollAsyncReads(io_handles);
+#else
+  /* Without io_uring ReadAsync() completes reads before returning */
+  (void)io_handles;
+  return IOStatus::OK();
+#endif
 }
 
 ZenFS::~ZenFS() {
   Status s;
   Info(logger_, "ZenFS shutting down");
+  StopMetaCheckpointWorker();
+  /* Zone cleaning moves file extents, stop it before the files go away */
+  zbd_->StopGCWorker();
+  zbd_->StopSweepWorker();
+  zbd_->StopZoneStatsWorker();
   zbd_->LogZoneUsage();
   LogFiles();
 
   meta_log_.reset(nullptr);
   ClearFiles();
+  for (const auto zoneFile : retired_files_) delete zoneFile;
+  retired_files_.clear();
   delete zbd_;
 }
 
@@ -164,56 +250,124 @@ void ZenFS::SetDBPointer(DBImpl* db){
     zbd_->SetDBPointer(db);
 }
 
+bool ZenFS::GetProperty(const std::string& property, std::string* value) {
+  return zbd_->GetProperty(property, value);
+}
+
+/* The published extent table is a consistent view of the file, even while
+ * it is appended to or its extents are migrated */
+std::shared_ptr<const ZoneExtentTable> ZenFS::GetSSTExtentTable(uint64_t fno) {
+  std::shared_ptr<const ZoneExtentTable> table;
+
+  files_mtx_.lock();
+  auto it = files_by_fno_.find(fno);
+  if (it != files_by_fno_.end()) table = it->second->GetExtentTable();
+  files_mtx_.unlock();
+
+  return table;
+}
+
 int ZenFS::GetZonedFileExtentNum(const uint64_t fileno){
-    zbd_->zone_cleaning_mtx.lock();
-    std::map<std::string, ZoneFile*>::iterator it;
-    //TODO::Wait until current file append or ZC is done.
-    for (it = files_.begin(); it != files_.end(); it++) {
-        ZoneFile* zFile = it->second;
-        std::string fname = zFile->GetFilename();
-        std::string fname_wo_path = fname.substr(fname.size() - 10);
-        std::string fno = fname_wo_path.substr(0, 6);
-
-        if((uint64_t)(std::stoul(fno)) == fileno){
-            while(zFile->is_appending_.load() == true) { } 
-            
-            zbd_->zone_cleaning_mtx.unlock();
-            return zFile->GetExtents().size();
-        }
-    }
-    zbd_->zone_cleaning_mtx.unlock();
-    return -1;
+    std::shared_ptr<const ZoneExtentTable> table = GetSSTExtentTable(fileno);
+    if (!table) return -1;
+    return table->size();
 }
 
 void ZenFS::GetExtentInfo(const uint64_t fileno, const int ext_no, int& zone_id, uint32_t& extent_length, uint32_t& extent_start) {
-    zbd_->zone_cleaning_mtx.lock();
-    std::map<std::string, ZoneFile*>::iterator it;
-    for (it = files_.begin(); it != files_.end(); it++) {
-        ZoneFile* zFile = it->second;
-        std::string fname = zFile->GetFilename();
-        std::string fname_wo_path = fname.substr(fname.size() - 10);
-        std::string fno = fname_wo_path.substr(0, 6);
-        
-        if((uint64_t)(std::stoul(fno)) == fileno){
-
-            while(zFile->is_appending_.load() == true) { }       
-            
-            auto extents = zFile->GetExtents();
-            for(size_t i = 0; i < extents.size(); i++){
-                if(i == (size_t)ext_no){
-                    auto cur_extent = extents[i];  
-                    zone_id = cur_extent->zone_->zone_id_;
-                    extent_length = cur_extent->length_;
-                    extent_start = cur_extent->start_;
-                    zbd_->zone_cleaning_mtx.unlock();
-                    return;
-                }
-            }
+    std::shared_ptr<const ZoneExtentTable> table = GetSSTExtentTable(fileno);
+    if (!table || ext_no < 0 || (size_t)ext_no >= table->size()) return;
+
+    const ZoneExtentTable::Entry& e = (*table)[ext_no];
+    Zone* zone = zbd_->GetIOZone(e.start_);
+    zone_id = zone ? zone->zone_id_ : -1;
+    extent_length = e.length_;
+    extent_start = e.start_;
+}
 
-        }
+void ZenFS::GetFileExtents(const std::vector<uint64_t>& fnos,
+                           std::vector<ZonedFileExtent>* extents) {
+  std::vector<std::shared_ptr<const ZoneExtentTable>> tables;
+
+  tables.reserve(fnos.size());
+  files_mtx_.lock();
+  for (uint64_t fno : fnos) {
+    auto it = files_by_fno_.find(fno);
+    tables.push_back(it != files_by_fno_.end() ? it->second->GetExtentTable()
+                                               : nullptr);
+  }
+  files_mtx_.unlock();
+
+  for (size_t i = 0; i < fnos.size(); i++) {
+    if (!tables[i]) continue;
+    for (size_t j = 0; j < tables[i]->size(); j++) {
+      const ZoneExtentTable::Entry& e = (*tables[i])[j];
+      Zone* zone = zbd_->GetIOZone(e.start_);
+      extents->push_back(ZonedFileExtent{fnos[i], zone ? zone->zone_id_ : -1,
+                                         e.start_, e.length_});
+    }
+  }
+}
+
+void ZenFS::GetFileLayouts(const std::string& dir,
+                           std::vector<ZenFSFileLayout>* layouts) {
+  std::vector<std::pair<ZoneFile*, std::shared_ptr<const ZoneExtentTable>>>
+      files;
+
+  files_mtx_.lock();
+  for (auto it = files_.lower_bound(dir); it != files_.end(); it++) {
+    if (it->first.compare(0, dir.length(), dir) != 0) break;
+    files.emplace_back(it->second, it->second->GetExtentTable());
+    layouts->push_back(
+        ZenFSFileLayout{it->first, it->second->GetFileSize(), {}});
+  }
+  files_mtx_.unlock();
+
+  for (size_t i = 0; i < files.size(); i++) {
+    const std::shared_ptr<const ZoneExtentTable>& table = files[i].second;
+    if (!table) continue;
+    uint64_t id = files[i].first->GetID();
+    for (size_t j = 0; j < table->size(); j++) {
+      const ZoneExtentTable::Entry& e = (*table)[j];
+      Zone* zone = zbd_->GetIOZone(e.start_);
+      (*layouts)[i].extents_.push_back(
+          ZonedFileExtent{id, zone ? zone->zone_id_ : -1, e.start_, e.length_});
     }
-    zbd_->zone_cleaning_mtx.unlock();
-} 
+  }
+}
+
+/* A zone whose valid data all belongs to fnos is freed by a reset, otherwise
+ * the share of its valid data owned by fnos is credited */
+uint64_t ZenFS::GetZoneFreeBytes(const std::vector<uint64_t>& fnos) {
+  std::vector<ZonedFileExtent> extents;
+  std::map<Zone*, uint64_t> owned;
+  uint64_t freed = 0;
+
+  uint32_t block_sz = zbd_->GetBlockSize();
+
+  GetFileExtents(fnos, &extents);
+  for (const auto& e : extents) {
+    Zone* zone = zbd_->GetIOZone(e.start);
+    if (zone == nullptr) continue;
+    /* valid_bytes_ counts block aligned extents */
+    owned[zone] += (e.length + block_sz - 1) / block_sz * block_sz;
+  }
+
+  for (const auto& o : owned) {
+    Zone* zone = o.first;
+    uint64_t valid = zone->valid_bytes_.load();
+    uint64_t written = zone->wp_ - zone->start_;
+
+    if (valid == 0 || o.second >= valid)
+      freed += written;
+    else
+      freed += written * o.second / valid;
+  }
+  return freed;
+}
+
+uint64_t ZenFS::GetZoneCapacity(int level, uint64_t* max_capacity) {
+  return zbd_->GetPlacementCapacity(level, max_capacity);
+}
 
 void ZenFS::LogFiles() {
   std::map<std::string, ZoneFile*>::iterator it;
@@ -222,6 +376,7 @@ void ZenFS::LogFiles() {
   Info(logger_, "  Files:\n");
   for (it = files_.begin(); it != files_.end(); it++) {
     ZoneFile* zFile = it->second;
+    if (it->first != zFile->GetFilename()) continue; /* a link name */
     std::vector<ZoneExtent*> extents = zFile->GetExtents();
 
     Info(logger_, "    %-45s sz: %lu lh: %d", it->first.c_str(),
@@ -242,14 +397,44 @@ void ZenFS::LogFiles() {
 
 void ZenFS::ClearFiles() {
   std::map<std::string, ZoneFile*>::iterator it;
-  for (it = files_.begin(); it != files_.end(); it++) delete it->second;
+  for (it = files_.begin(); it != files_.end(); it++) {
+    if (it->first == it->second->GetFilename()) delete it->second;
+  }
   files_.clear();
+  files_by_fno_.clear();
+}
+
+/* files_mtx_ should be locked before the function is called. Every name
+ * of the file, see LinkFile(), maps to it */
+void ZenFS::InsertFile(ZoneFile* zoneFile) {
+  files_.insert(std::make_pair(zoneFile->GetFilename(), zoneFile));
+  for (const auto& name : zoneFile->GetLinkFiles())
+    files_.insert(std::make_pair(name, zoneFile));
+  if (zoneFile->is_sst_) files_by_fno_[zoneFile->fno_] = zoneFile;
+}
+
+/* files_mtx_ should be locked before the function is called. Erases every
+ * name of the file fname is a name of */
+void ZenFS::EraseFile(const std::string& fname) {
+  auto it = files_.find(fname);
+  if (it == files_.end()) return;
+
+  ZoneFile* zoneFile = it->second;
+  if (zoneFile->is_sst_) {
+    auto f = files_by_fno_.find(zoneFile->fno_);
+    if (f != files_by_fno_.end() && f->second == zoneFile)
+      files_by_fno_.erase(f);
+  }
+  files_.erase(zoneFile->GetFilename());
+  for (const auto& name : zoneFile->GetLinkFiles()) files_.erase(name);
 }
 
 IOStatus ZenFS::WriteSnapshot(ZenMetaLog* meta_log) {
   IOStatus s;
   std::string snapshot;
 
+  /* Queued records were encoded before the snapshot and are part of it */
+  std::lock_guard<std::mutex> lock(meta_queue_mtx_);
   EncodeSnapshotTo(&snapshot);
   s = meta_log->AddRecord(snapshot);
   if (s.ok()) {
@@ -257,14 +442,19 @@ IOStatus ZenFS::WriteSnapshot(ZenMetaLog* meta_log) {
       ZoneFile* zoneFile = it->second;
       zoneFile->MetadataSynced();
     }
+    meta_log_bytes_ = 0;
+    meta_snapshot_bytes_ = snapshot.size();
   }
+  CompleteQueuedRecords(meta_queue_.size(), s);
   return s;
 }
 
 IOStatus ZenFS::WriteEndRecord(ZenMetaLog* meta_log) {
   std::string endRecord;
 
-  PutFixed32(&endRecord, kCompleteFilesSnapshot);
+  /* Every record carries a data slice, RecoverFrom expects one */
+  PutFixed32(&endRecord, kEndRecord);
+  PutLengthPrefixedSlice(&endRecord, Slice());
   return meta_log->AddRecord(endRecord);
 }
 
@@ -291,6 +481,7 @@ IOStatus ZenFS::RollMetaZone() {
   if (old_meta_zone->GetCapacityLeft()) old_meta_zone->Finish();
 
   meta_log_.reset(new_meta_log);
+  meta_roll_seq_++;
 
   std::string super_string;
   superblock_->EncodeTo(&super_string);
@@ -333,42 +524,300 @@ IOStatus ZenFS::PersistSnapshot(ZenMetaLog* meta_writer) {
   return s;
 }
 
-IOStatus ZenFS::PersistRecord(std::string record) {
+/* meta_queue_mtx_ should be locked before the function is called */
+void ZenFS::CompleteQueuedRecords(size_t n, IOStatus s) {
+  for (size_t i = 0; i < n; i++) {
+    MetaRecordWaiter* w = meta_queue_.front();
+    meta_queue_.pop_front();
+    w->status_ = s;
+    w->done_ = true;
+  }
+  if (n) meta_queue_cv_.notify_all();
+}
+
+/* Writes the queued records in one meta log append, a single record is
+ * written as is. Records stay queued if the meta zone is full.
+ * metadata_sync_mtx_ should be locked before the function is called */
+IOStatus ZenFS::WriteQueuedRecords() {
+  std::string batch;
+  std::string record;
+  size_t n = 0;
   IOStatus s;
 
-  metadata_sync_mtx_.lock();
+  meta_queue_mtx_.lock();
+  for (const auto w : meta_queue_) {
+    if (n > 0 && batch.size() + w->record_.size() > ZENFS_META_BATCH_MAX_SIZE)
+      break;
+    PutLengthPrefixedSlice(&batch, Slice(w->record_));
+    n++;
+  }
+  if (n == 1) record = meta_queue_.front()->record_;
+  meta_queue_mtx_.unlock();
+
+  if (n == 0) return IOStatus::OK();
+  if (n > 1) {
+    PutFixed32(&record, kRecordBatch);
+    PutLengthPrefixedSlice(&record, Slice(batch));
+  }
+
   s = meta_log_->AddRecord(record);
-  if (s == IOStatus::NoSpace()) {
-    Info(logger_, "Current meta zone full, rolling to next meta zone");
-    s = RollMetaZone();
-    /* After a successfull roll, a complete snapshot has been persisted
-     * - no need to write the record update */
+  if (s == IOStatus::NoSpace()) return s;
+
+  if (s.ok()) {
+    if (meta_checkpoint_active_) meta_checkpoint_tail_.push_back(record);
+    meta_log_bytes_ += record.size();
   }
-  metadata_sync_mtx_.unlock();
+
+  /* Only metadata_sync_mtx_ holders remove records, the first n are ours */
+  meta_queue_mtx_.lock();
+  CompleteQueuedRecords(n, s);
+  meta_queue_mtx_.unlock();
 
   return s;
 }
 
-IOStatus ZenFS::SyncFileMetadata(ZoneFile* zoneFile) {
-  std::string fileRecord;
-  std::string output;
+/* The record of w must be queued, waits until it is persisted */
+IOStatus ZenFS::PersistRecord(MetaRecordWaiter* w) {
+  std::unique_lock<std::mutex> lk(meta_queue_mtx_);
+
+  while (!w->done_) {
+    if (meta_queue_leader_) {
+      meta_queue_cv_.wait(lk);
+      continue;
+    }
 
+    meta_queue_leader_ = true;
+    lk.unlock();
+
+    bool checkpoint = false;
+    metadata_sync_mtx_.lock();
+    IOStatus s = WriteQueuedRecords();
+    checkpoint = NeedsMetaCheckpoint();
+    metadata_sync_mtx_.unlock();
+
+    if (s == IOStatus::NoSpace()) {
+      Info(logger_, "Current meta zone full, rolling to next meta zone");
+      files_mtx_.lock();
+      metadata_sync_mtx_.lock();
+      /* After a successfull roll, a complete snapshot has been persisted
+       * - no need to write the queued records */
+      s = RollMetaZone();
+      if (!s.ok()) {
+        meta_queue_mtx_.lock();
+        CompleteQueuedRecords(meta_queue_.size(), s);
+        meta_queue_mtx_.unlock();
+      }
+      metadata_sync_mtx_.unlock();
+      files_mtx_.unlock();
+    }
+
+    if (checkpoint) meta_checkpoint_cv_.notify_one();
+
+    lk.lock();
+    meta_queue_leader_ = false;
+    meta_queue_cv_.notify_all();
+  }
+
+  return w->status_;
+}
+
+/* metadata_sync_mtx_ should be locked before the function is called */
+bool ZenFS::NeedsMetaCheckpoint() {
+  uint64_t limit = std::max((uint64_t)ZENFS_META_CHECKPOINT_MIN_SIZE,
+                            ZENFS_META_CHECKPOINT_RATIO * meta_snapshot_bytes_);
+  return !meta_checkpoint_active_ && meta_log_bytes_ >= limit;
+}
+
+/* Writes a snapshot to a fresh meta zone without holding off metadata syncs.
+ * Syncs keep going to the current zone while the snapshot is written and are
+ * queued in meta_checkpoint_tail_, then appended to the new zone before the
+ * commit record. The new zone has the newer superblock, so recovery ignores
+ * it until the commit record is in place. */
+IOStatus ZenFS::MetaCheckpoint() {
+  std::unique_ptr<ZenMetaLog> new_log;
+  std::string super_string;
+  std::string snapshot;
+  uint64_t roll_seq;
+  uint64_t tail_bytes = 0;
+  Zone* new_meta_zone;
   IOStatus s;
 
   files_mtx_.lock();
+  metadata_sync_mtx_.lock();
+  if (!NeedsMetaCheckpoint()) {
+    metadata_sync_mtx_.unlock();
+    files_mtx_.unlock();
+    return IOStatus::OK();
+  }
 
-  PutFixed32(&output, kFileUpdate);
-  zoneFile->EncodeUpdateTo(&fileRecord);
-  PutLengthPrefixedSlice(&output, Slice(fileRecord));
+  new_meta_zone = zbd_->AllocateMetaZone();
+  if (!new_meta_zone) {
+    metadata_sync_mtx_.unlock();
+    files_mtx_.unlock();
+    return IOStatus::NoSpace("Out of metadata zones");
+  }
+
+  /* Queued records have to reach the current zone, it stays the valid one
+   * until the checkpoint commits */
+  while (true) {
+    meta_queue_mtx_.lock();
+    if (meta_queue_.empty()) break;
+    meta_queue_mtx_.unlock();
+
+    s = WriteQueuedRecords();
+    if (s == IOStatus::NoSpace()) {
+      s = RollMetaZone();
+      if (!s.ok()) {
+        meta_queue_mtx_.lock();
+        CompleteQueuedRecords(meta_queue_.size(), s);
+        meta_queue_mtx_.unlock();
+      }
+      metadata_sync_mtx_.unlock();
+      files_mtx_.unlock();
+      return s;
+    }
+  }
+
+  Info(logger_, "Checkpointing to metazone %d\n",
+       (int)new_meta_zone->GetZoneNr());
+  new_log.reset(new ZenMetaLog(zbd_, new_meta_zone));
+  superblock_->EncodeTo(&super_string);
+  EncodeSnapshotTo(&snapshot, kCheckpointSnapshot);
+  /* Updates from here on are relative to the snapshot */
+  for (auto it = files_.begin(); it != files_.end(); it++)
+    it->second->MetadataSynced();
+  meta_queue_mtx_.unlock();
+  roll_seq = meta_roll_seq_;
+  meta_checkpoint_tail_.clear();
+  meta_checkpoint_active_ = true;
+  metadata_sync_mtx_.unlock();
+  files_mtx_.unlock();
+
+  s = new_log->AddRecord(super_string);
+  if (s.ok()) s = new_log->AddRecord(snapshot);
+
+  files_mtx_.lock();
+  metadata_sync_mtx_.lock();
+  meta_checkpoint_active_ = false;
+
+  if (meta_roll_seq_ != roll_seq) {
+    /* The current zone filled up and rolled with a complete snapshot */
+    meta_checkpoint_tail_.clear();
+    new_log.reset();
+    metadata_sync_mtx_.unlock();
+    files_mtx_.unlock();
+    return IOStatus::OK();
+  }
+
+  for (const auto& record : meta_checkpoint_tail_) {
+    if (!s.ok()) break;
+    s = new_log->AddRecord(record);
+    tail_bytes += record.size();
+  }
+  meta_checkpoint_tail_.clear();
+
+  if (s.ok()) {
+    std::string commit;
+
+    PutFixed32(&commit, kCheckpointCommit);
+    PutLengthPrefixedSlice(&commit, Slice());
+    s = new_log->AddRecord(commit);
+  }
+
+  if (s.ok()) {
+    Zone* old_meta_zone = meta_log_->GetZone();
 
-  s = PersistRecord(output);
-  if (s.ok()) zoneFile->MetadataSynced();
+    meta_log_ = std::move(new_log);
+    meta_roll_seq_++;
+    meta_log_bytes_ = tail_bytes;
+    meta_snapshot_bytes_ = snapshot.size();
+    old_meta_zone->Reset();
+  } else {
+    /* The updates since the snapshot are still in the current zone,
+     * fall back to a blocking roll */
+    Warn(logger_, "Meta checkpoint failed: %s, rolling meta zone",
+         s.ToString().c_str());
+    new_log.reset();
+    s = RollMetaZone();
+  }
 
+  metadata_sync_mtx_.unlock();
   files_mtx_.unlock();
 
   return s;
 }
 
+void ZenFS::MetaCheckpointWorker() {
+  std::unique_lock<std::mutex> lk(meta_checkpoint_mtx_);
+
+  while (!meta_checkpoint_exit_) {
+    meta_checkpoint_cv_.wait_for(
+        lk, std::chrono::seconds(ZENFS_META_CHECKPOINT_INTERVAL_S));
+    if (meta_checkpoint_exit_) break;
+    lk.unlock();
+
+    IOStatus s = MetaCheckpoint();
+    if (!s.ok())
+      Error(logger_, "Meta checkpoint failed: %s", s.ToString().c_str());
+
+    lk.lock();
+  }
+}
+
+void ZenFS::MetaTailWorker() {
+  std::unique_lock<std::mutex> lk(meta_checkpoint_mtx_);
+
+  while (!meta_checkpoint_exit_) {
+    meta_checkpoint_cv_.wait_for(
+        lk, std::chrono::milliseconds(ZENFS_META_TAIL_INTERVAL_MS));
+    if (meta_checkpoint_exit_) break;
+    lk.unlock();
+
+    IOStatus s = TailMetadata();
+    if (!s.ok())
+      Warn(logger_, "Metadata tail failed: %s", s.ToString().c_str());
+
+    lk.lock();
+  }
+}
+
+void ZenFS::StartMetaCheckpointWorker() {
+  if (meta_checkpoint_worker_) return;
+  meta_checkpoint_exit_ = false;
+  meta_checkpoint_worker_.reset(new std::thread(
+      readonly_ ? &ZenFS::MetaTailWorker : &ZenFS::MetaCheckpointWorker,
+      this));
+}
+
+void ZenFS::StopMetaCheckpointWorker() {
+  if (!meta_checkpoint_worker_) return;
+  {
+    std::lock_guard<std::mutex> lock(meta_checkpoint_mtx_);
+    meta_checkpoint_exit_ = true;
+  }
+  meta_checkpoint_cv_.notify_all();
+  meta_checkpoint_worker_->join();
+  meta_checkpoint_worker_.reset();
+}
+
+IOStatus ZenFS::SyncFileMetadata(ZoneFile* zoneFile) {
+  std::string fileRecord;
+  MetaRecordWaiter w;
+
+  /* The extents are marked synced once queued so a concurrent sync of the
+   * same file does not record them twice. A failure to persist the queue
+   * leaves the file system in need of a remount anyway. */
+  meta_queue_mtx_.lock();
+  PutFixed32(&w.record_, kFileUpdate);
+  zoneFile->EncodeUpdateTo(&fileRecord);
+  PutLengthPrefixedSlice(&w.record_, Slice(fileRecord));
+  zoneFile->MetadataSynced();
+  meta_queue_.push_back(&w);
+  meta_queue_mtx_.unlock();
+
+  return PersistRecord(&w);
+}
+
 ZoneFile* ZenFS::GetFile(std::string fname) {
   ZoneFile* zoneFile = nullptr;
   files_mtx_.lock();
@@ -376,6 +825,14 @@ ZoneFile* ZenFS::GetFile(std::string fname) {
     zoneFile = files_[fname];
   }
   files_mtx_.unlock();
+
+  /* The primary may have created the file since the last tail */
+  if (zoneFile == nullptr && readonly_ && TailMetadata().ok()) {
+    files_mtx_.lock();
+    auto it = files_.find(fname);
+    if (it != files_.end()) zoneFile = it->second;
+    files_mtx_.unlock();
+  }
   return zoneFile;
 }
 
@@ -385,15 +842,43 @@ IOStatus ZenFS::DeleteFile(std::string fname) {
 
   zoneFile = GetFile(fname);
   files_mtx_.lock();
+  if (zoneFile != nullptr && zoneFile->GetNrLinks() > 1) {
+    /* Only the name goes, the data stays with the other names */
+    EraseFile(fname);
+    zoneFile->RemoveLinkName(fname);
+    InsertFile(zoneFile);
+    files_mtx_.unlock();
+
+    s = SyncFileMetadata(zoneFile);
+    if (!s.ok()) {
+      files_mtx_.lock();
+      zoneFile->AddLinkName(fname);
+      files_.insert(std::make_pair(fname, zoneFile));
+      files_mtx_.unlock();
+    }
+    return s;
+  }
   if (zoneFile != nullptr) {
-    std::string record;
+    MetaRecordWaiter w;
 
+    /* Leave files_ while the record is persisted, snapshots taken in the
+     * meantime must not contain the file */
     zoneFile = files_[fname];
-    EncodeFileDeletionTo(zoneFile, &record);
-    s = PersistRecord(record);
+    meta_queue_mtx_.lock();
+    EncodeFileDeletionTo(zoneFile, &w.record_);
+    meta_queue_.push_back(&w);
+    meta_queue_mtx_.unlock();
+    EraseFile(fname);
+    files_mtx_.unlock();
+
+    s = PersistRecord(&w);
+
+    files_mtx_.lock();
     if (s.ok()) {
-      files_.erase(fname);
+      zbd_->ObserveSSTDeath(zoneFile);
       delete (zoneFile);
+    } else {
+      InsertFile(zoneFile);
     }
   }
   files_mtx_.unlock();
@@ -404,11 +889,15 @@ IOStatus ZenFS::NewSequentialFile(const std::string& fname,
                                   const FileOptions& file_opts,
                                   std::unique_ptr<FSSequentialFile>* result,
                                   IODebugContext* /*dbg*/) {
-  ZoneFile* zoneFile = GetFile(fname);
+  ZoneFile* zoneFile;
 
   Debug(logger_, "New sequential file: %s direct: %d\n", fname.c_str(),
         file_opts.use_direct_reads);
 
+  /* Logs and manifests are read up to what the metadata records */
+  if (readonly_) TailMetadata();
+  zoneFile = GetFile(fname);
+
   if (zoneFile == nullptr) {
     return IOStatus::IOError("File does not exist!\n");
   }
@@ -430,7 +919,13 @@ IOStatus ZenFS::NewRandomAccessFile(const std::string& fname,
     return IOStatus::NotFound("File does not exist\n");
   }
 
-  result->reset(new ZonedRandomAccessFile(files_[fname], file_opts));
+  result->reset(new ZonedRandomAccessFile(
+      zoneFile, file_opts
+#if defined(ROCKSDB_IOURING_PRESENT)
+      ,
+      thread_local_io_urings_.get(), thread_local_async_read_io_urings_.get()
+#endif
+      ));
   return IOStatus::OK();
 }
 
@@ -444,6 +939,8 @@ IOStatus ZenFS::NewWritableFile(const std::string& fname,
   Debug(logger_, "New writable file: %s direct: %d\n", fname.c_str(),
         file_opts.use_direct_writes);
 
+  if (readonly_) return IOStatus::NotSupported("Read-only ZenFS mount");
+
   if (GetFile(fname) != nullptr) {
     s = DeleteFile(fname);
     if (!s.ok()) return s;
@@ -452,10 +949,19 @@ IOStatus ZenFS::NewWritableFile(const std::string& fname,
   zoneFile = new ZoneFile(zbd_, fname, next_file_id_++);
 
   files_mtx_.lock();
-  files_.insert(std::make_pair(fname.c_str(), zoneFile));
+  InsertFile(zoneFile);
   files_mtx_.unlock();
 
-  result->reset(new ZonedWritableFile(zbd_, true, zoneFile, &metadata_writer_));
+  ZonedWritableFile* writable_file =
+      new ZonedWritableFile(zbd_, true, zoneFile, &metadata_writer_);
+  result->reset(writable_file);
+
+  const FilePlacementHint& hint = file_opts.placement_hint;
+  if (hint.level >= 0 && !hint.smallest.empty() && !hint.largest.empty())
+    writable_file->SetPlacementHint(hint.smallest, hint.largest, hint.level);
+  if (hint.level == 0 &&
+      hint.column_family_id != std::numeric_limits<uint32_t>::max())
+    writable_file->SetL0Stream(hint.column_family_id, hint.key_range);
 
   return s;
 }
@@ -494,6 +1000,7 @@ IOStatus ZenFS::GetChildren(const std::string& dir, const IOOptions& options,
 
   Debug(logger_, "GetChildren: %s \n", dir.c_str());
 
+  if (readonly_) TailMetadata();
   target()->GetChildren(ToAuxPath(dir), options, &auxfiles, dbg);
   for (const auto f : auxfiles) {
     if (f != "." && f != "..") result->push_back(f);
@@ -523,6 +1030,7 @@ IOStatus ZenFS::DeleteFile(const std::string& fname, const IOOptions& options,
   if (GetFile(fname) == nullptr) {
     return target()->DeleteFile(ToAuxPath(fname), options, dbg);
   }
+  if (readonly_) return IOStatus::NotSupported("Read-only ZenFS mount");
 
   s = DeleteFile(fname);
   zbd_->LogZoneStats();
@@ -530,6 +1038,78 @@ IOStatus ZenFS::DeleteFile(const std::string& fname, const IOOptions& options,
   return s;
 }
 
+IOStatus ZenFS::DeleteFiles(const std::vector<std::string>& fnames,
+                            const IOOptions& options,
+                            std::vector<IOStatus>* statuses,
+                            IODebugContext* dbg) {
+  /* A batch of deletions and the files it takes out of files_ */
+  struct DeletionBatch {
+    MetaRecordWaiter w;
+    std::string records;
+    std::vector<size_t> idx;
+    std::vector<ZoneFile*> files;
+  };
+  std::vector<std::unique_ptr<DeletionBatch>> batches;
+  std::vector<size_t> others;
+
+  Debug(logger_, "Delete %zu files\n", fnames.size());
+  statuses->assign(fnames.size(), IOStatus::OK());
+
+  files_mtx_.lock();
+  for (size_t i = 0; i < fnames.size(); i++) {
+    auto it = files_.find(fnames[i]);
+    /* Aux files and files with other names are deleted one by one */
+    if (readonly_ || it == files_.end() || it->second->GetNrLinks() > 1) {
+      others.push_back(i);
+      continue;
+    }
+    if (batches.empty() ||
+        batches.back()->records.size() > ZENFS_META_BATCH_MAX_SIZE) {
+      batches.emplace_back(new DeletionBatch());
+    }
+    DeletionBatch* b = batches.back().get();
+    std::string record;
+    EncodeFileDeletionTo(it->second, &record);
+    PutLengthPrefixedSlice(&b->records, Slice(record));
+    b->idx.push_back(i);
+    b->files.push_back(it->second);
+    /* Leave files_ while the record is persisted, snapshots taken in the
+     * meantime must not contain the file */
+    EraseFile(fnames[i]);
+  }
+  meta_queue_mtx_.lock();
+  for (auto& b : batches) {
+    PutFixed32(&b->w.record_, kRecordBatch);
+    PutLengthPrefixedSlice(&b->w.record_, Slice(b->records));
+    meta_queue_.push_back(&b->w);
+  }
+  meta_queue_mtx_.unlock();
+  files_mtx_.unlock();
+
+  /* The first wait writes all the batches queued by then */
+  for (auto& b : batches) {
+    IOStatus s = PersistRecord(&b->w);
+    files_mtx_.lock();
+    for (size_t j = 0; j < b->files.size(); j++) {
+      if (s.ok()) {
+        zbd_->ObserveSSTDeath(b->files[j]);
+        delete b->files[j];
+      } else {
+        InsertFile(b->files[j]);
+        (*statuses)[b->idx[j]] = s;
+      }
+    }
+    files_mtx_.unlock();
+  }
+
+  for (const size_t i : others) {
+    (*statuses)[i] = DeleteFile(fnames[i], options, dbg);
+  }
+  if (!batches.empty()) zbd_->LogZoneStats();
+
+  return IOStatus::OK();
+}
+
 IOStatus ZenFS::GetFileSize(const std::string& f, const IOOptions& /*options*/,
                             uint64_t* size, IODebugContext* /*dbg*/) {
   ZoneFile* zoneFile;
@@ -557,31 +1137,125 @@ IOStatus ZenFS::RenameFile(const std::string& f, const std::string& t,
   Debug(logger_, "Rename file: %s to : %s\n", f.c_str(), t.c_str());
 
   zoneFile = GetFile(f);
-  if (zoneFile != nullptr) {
+  if (zoneFile != nullptr && readonly_) {
+    s = IOStatus::NotSupported("Read-only ZenFS mount");
+  } else if (zoneFile != nullptr) {
     s = DeleteFile(t);
     if (s.ok()) {
       files_mtx_.lock();
-      files_.erase(f);
-      zoneFile->Rename(t);
-      files_.insert(std::make_pair(t, zoneFile));
+      EraseFile(f);
+      zoneFile->RenameName(f, t);
+      InsertFile(zoneFile);
       files_mtx_.unlock();
 
       s = SyncFileMetadata(zoneFile);
     }
   } else {
     s = target()->RenameFile(ToAuxPath(f), ToAuxPath(t), options, dbg);
+    if (s.ok()) s = RenameChildren(f, t, options, dbg);
+  }
+
+  return s;
+}
+
+IOStatus ZenFS::RenameChildren(const std::string& f, const std::string& t,
+                               const IOOptions& options, IODebugContext* dbg) {
+  std::string prefix = f + "/";
+  std::vector<std::string> children;
+  IOStatus s;
+
+  files_mtx_.lock();
+  for (auto it = files_.lower_bound(prefix); it != files_.end(); it++) {
+    if (it->first.compare(0, prefix.length(), prefix) != 0) break;
+    children.push_back(it->first);
+  }
+  files_mtx_.unlock();
+
+  for (const auto& child : children) {
+    s = RenameFile(child, t + child.substr(f.length()), options, dbg);
+    if (!s.ok()) break;
+  }
+  return s;
+}
+
+IOStatus ZenFS::LinkFile(const std::string& src, const std::string& target,
+                         const IOOptions& options, IODebugContext* dbg) {
+  ZoneFile* zoneFile;
+  IOStatus s;
+
+  Debug(logger_, "Link file: %s to : %s\n", src.c_str(), target.c_str());
+
+  zoneFile = GetFile(src);
+  if (zoneFile == nullptr) {
+    return this->target()->LinkFile(ToAuxPath(src), ToAuxPath(target),
+                                    options, dbg);
+  }
+  if (readonly_) return IOStatus::NotSupported("Read-only ZenFS mount");
+
+  files_mtx_.lock();
+  if (files_.find(target) != files_.end()) {
+    files_mtx_.unlock();
+    return IOStatus::IOError("File already exists: " + target);
   }
+  /* A file still being written has extents to come, copy it instead */
+  if (zoneFile->GetActiveZone() != nullptr || zoneFile->is_appending_) {
+    files_mtx_.unlock();
+    return IOStatus::NotSupported("Linking a file open for writing");
+  }
+  zoneFile->AddLinkName(target);
+  files_.insert(std::make_pair(target, zoneFile));
+  files_mtx_.unlock();
 
+  s = SyncFileMetadata(zoneFile);
+  if (!s.ok()) {
+    files_mtx_.lock();
+    EraseFile(target);
+    zoneFile->RemoveLinkName(target);
+    InsertFile(zoneFile);
+    files_mtx_.unlock();
+  }
   return s;
 }
 
-void ZenFS::EncodeSnapshotTo(std::string* output) {
+IOStatus ZenFS::NumFileLinks(const std::string& fname,
+                             const IOOptions& options, uint64_t* count,
+                             IODebugContext* dbg) {
+  ZoneFile* zoneFile;
+
+  files_mtx_.lock();
+  auto it = files_.find(fname);
+  zoneFile = it == files_.end() ? nullptr : it->second;
+  if (zoneFile != nullptr) *count = zoneFile->GetNrLinks();
+  files_mtx_.unlock();
+
+  if (zoneFile == nullptr)
+    return target()->NumFileLinks(ToAuxPath(fname), options, count, dbg);
+  return IOStatus::OK();
+}
+
+IOStatus ZenFS::AreFilesSame(const std::string& first,
+                             const std::string& second,
+                             const IOOptions& options, bool* res,
+                             IODebugContext* dbg) {
+  ZoneFile* first_file = GetFile(first);
+  ZoneFile* second_file = GetFile(second);
+
+  if (first_file == nullptr && second_file == nullptr)
+    return target()->AreFilesSame(ToAuxPath(first), ToAuxPath(second),
+                                  options, res, dbg);
+
+  *res = first_file == second_file;
+  return IOStatus::OK();
+}
+
+void ZenFS::EncodeSnapshotTo(std::string* output, uint32_t tag) {
   std::map<std::string, ZoneFile*>::iterator it;
   std::string files_string;
-  PutFixed32(output, kCompleteFilesSnapshot);
+  PutFixed32(output, tag);
   for (it = files_.begin(); it != files_.end(); it++) {
     std::string file_string;
     ZoneFile* zFile = it->second;
+    if (it->first != zFile->GetFilename()) continue; /* a link name */
 
     zFile->EncodeSnapshotTo(&file_string);
     PutLengthPrefixedSlice(&files_string, Slice(file_string));
@@ -604,25 +1278,19 @@ Status ZenFS::DecodeFileUpdateFrom(Slice* slice) {
   for (auto it = files_.begin(); it != files_.end(); it++) {
     ZoneFile* zFile = it->second;
     if (id == zFile->GetID()) {
-      std::string oldName = zFile->GetFilename();
-
+      /* The update may rename the file and with that its file number */
+      EraseFile(zFile->GetFilename());
       s = zFile->MergeUpdate(update);
       delete update;
+      InsertFile(zFile);
 
-      if (!s.ok()) return s;
-
-      if (zFile->GetFilename() != oldName) {
-        files_.erase(oldName);
-        files_.insert(std::make_pair(zFile->GetFilename(), zFile));
-      }
-
-      return Status::OK();
+      return s;
     }
   }
 
   /* The update is a new file */
-  assert(GetFile(update->GetFilename()) == nullptr);
-  files_.insert(std::make_pair(update->GetFilename(), update));
+  assert(files_.find(update->GetFilename()) == files_.end());
+  InsertFile(update);
 
   return Status::OK();
 }
@@ -637,7 +1305,7 @@ Status ZenFS::DecodeSnapshotFrom(Slice* input) {
     Status s = zoneFile->DecodeFrom(&slice);
     if (!s.ok()) return s;
 
-    files_.insert(std::make_pair(zoneFile->GetFilename(), zoneFile));
+    InsertFile(zoneFile);
   }
 
   return Status::OK();
@@ -672,14 +1340,50 @@ Status ZenFS::DecodeFileDeletionFrom(Slice* input) {
   if (zoneFile->GetID() != fileID)
     return Status::Corruption("Zone file deletion: file ID missmatch");
 
-  files_.erase(fileName);
-  delete zoneFile;
+  EraseFile(fileName);
+  RetireFile(zoneFile);
+
+  return Status::OK();
+}
+
+/* Deletes a file gone from the metadata, unless open files of a read-only
+ * mount may still read it */
+void ZenFS::RetireFile(ZoneFile* zoneFile) {
+  if (readonly_)
+    retired_files_.push_back(zoneFile);
+  else
+    delete zoneFile;
+}
+
+Status ZenFS::DecodeRecordBatchFrom(Slice* input) {
+  Slice record;
+  Slice data;
+  uint32_t tag;
+  Status s;
+
+  while (GetLengthPrefixedSlice(input, &record)) {
+    if (!GetFixed32(&record, &tag) || !GetLengthPrefixedSlice(&record, &data))
+      return Status::Corruption("ZenFS", "Invalid record in batch");
+
+    switch (tag) {
+      case kFileUpdate:
+        s = DecodeFileUpdateFrom(&data);
+        break;
+      case kFileDeletion:
+        s = DecodeFileDeletionFrom(&data);
+        break;
+      default:
+        return Status::Corruption("ZenFS", "Unexpected tag in batch");
+    }
+    if (!s.ok()) return s;
+  }
 
   return Status::OK();
 }
 
 Status ZenFS::RecoverFrom(ZenMetaLog* log) {
   bool at_least_one_snapshot = false;
+  bool pending_checkpoint = false;
   std::string scratch;
   uint32_t tag = 0;
   Slice record;
@@ -688,8 +1392,17 @@ Status ZenFS::RecoverFrom(ZenMetaLog* log) {
   bool done = false;
 
   while (!done) {
+    uint64_t pos = log->GetReadPos();
     IOStatus rs = log->ReadRecord(&record, &scratch);
+    if (!rs.ok() && readonly_ && at_least_one_snapshot) {
+      /* The primary may still be writing the record, it is tailed later */
+      log->SetReadPos(pos);
+      break;
+    }
     if (!rs.ok()) {
+      /* Torn write of a checkpoint that never committed */
+      if (pending_checkpoint && !at_least_one_snapshot)
+        return Status::NotFound("ZenFS", "Uncommitted checkpoint");
       Error(logger_, "Read recovery record failed with error: %s",
             rs.ToString().c_str());
       return Status::Corruption("ZenFS", "Metadata corruption");
@@ -712,6 +1425,21 @@ Status ZenFS::RecoverFrom(ZenMetaLog* log) {
         at_least_one_snapshot = true;
         break;
 
+      case kCheckpointSnapshot:
+        ClearFiles();
+        s = DecodeSnapshotFrom(&data);
+        if (!s.ok()) {
+          Warn(logger_, "Could not decode checkpoint snapshot: %s",
+               s.ToString().c_str());
+          return s;
+        }
+        pending_checkpoint = true;
+        break;
+
+      case kCheckpointCommit:
+        if (pending_checkpoint) at_least_one_snapshot = true;
+        break;
+
       case kFileUpdate:
         s = DecodeFileUpdateFrom(&data);
         if (!s.ok()) {
@@ -730,6 +1458,15 @@ Status ZenFS::RecoverFrom(ZenMetaLog* log) {
         }
         break;
 
+      case kRecordBatch:
+        s = DecodeRecordBatchFrom(&data);
+        if (!s.ok()) {
+          Warn(logger_, "Could not decode record batch: %s",
+               s.ToString().c_str());
+          return s;
+        }
+        break;
+
       case kEndRecord:
         done = true;
         break;
@@ -746,9 +1483,167 @@ Status ZenFS::RecoverFrom(ZenMetaLog* log) {
     return Status::NotFound("ZenFS", "No snapshot found");
 }
 
+/* metadata_sync_mtx_ should be locked before the function is called. The
+ * files keep their ZoneFile, so open files read the extents of the new
+ * snapshot */
+IOStatus ZenFS::SwitchMetaLog(std::unique_ptr<ZenMetaLog>& log,
+                              std::unique_ptr<Superblock>& super_block) {
+  std::map<std::string, ZoneFile*> old_files;
+  std::unordered_map<uint64_t, ZoneFile*> old_files_by_fno;
+  std::unordered_map<uint64_t, ZoneFile*> old_files_by_id;
+  std::vector<ZoneFile*> recovered;
+  Status s;
+
+  files_mtx_.lock();
+  old_files.swap(files_);
+  old_files_by_fno.swap(files_by_fno_);
+  s = RecoverFrom(log.get());
+  if (!s.ok()) {
+    /* E.g. a checkpoint the primary has not committed yet, the current
+     * zone stays valid until it has */
+    ClearFiles();
+    files_.swap(old_files);
+    files_by_fno_.swap(old_files_by_fno);
+    files_mtx_.unlock();
+    Debug(logger_, "Not following meta zone %d: %s",
+          (int)log->GetZone()->GetZoneNr(), s.ToString().c_str());
+    return IOStatus::OK();
+  }
+
+  for (auto it = old_files.begin(); it != old_files.end(); it++) {
+    if (it->first == it->second->GetFilename())
+      old_files_by_id[it->second->GetID()] = it->second;
+  }
+  for (auto it = files_.begin(); it != files_.end(); it++) {
+    if (it->first == it->second->GetFilename())
+      recovered.push_back(it->second);
+  }
+  files_.clear();
+  files_by_fno_.clear();
+  for (ZoneFile* zoneFile : recovered) {
+    auto old = old_files_by_id.find(zoneFile->GetID());
+    if (old != old_files_by_id.end()) {
+      ZoneFile* snapshot = zoneFile;
+      zoneFile = old->second;
+      old_files_by_id.erase(old);
+      zoneFile->ReplaceWith(snapshot);
+      retired_files_.push_back(snapshot);
+    }
+    InsertFile(zoneFile);
+  }
+  for (const auto& old : old_files_by_id) retired_files_.push_back(old.second);
+  files_mtx_.unlock();
+
+  Info(logger_, "Following meta zone %d, superblock sequence %d",
+       (int)log->GetZone()->GetZoneNr(), (int)super_block->GetSeq());
+  meta_log_ = std::move(log);
+  superblock_ = std::move(super_block);
+  meta_tail_wps_.clear();
+  return IOStatus::OK();
+}
+
+/* metadata_sync_mtx_ should be locked before the function is called. The
+ * primary writes a superblock with a higher sequence to the zone it rolls
+ * or checkpoints to, and resets the old zone once the new one is valid */
+IOStatus ZenFS::FollowMetaRoll() {
+  for (const auto z : zbd_->GetMetaZones()) {
+    std::unique_ptr<ZenMetaLog> log;
+    std::unique_ptr<Superblock> super_block;
+    std::string scratch;
+    Slice super_record;
+
+    if (z == meta_log_->GetZone()) continue;
+
+    IOStatus s = z->UpdateWp();
+    if (!s.ok()) return s;
+
+    /* Only a zone written to since it was last checked can be newer */
+    uint64_t wp = z->wp_;
+    auto it = meta_tail_wps_.find(z);
+    if (wp == z->start_ || (it != meta_tail_wps_.end() && it->second == wp))
+      continue;
+    meta_tail_wps_[z] = wp;
+
+    log.reset(new ZenMetaLog(zbd_, z));
+    if (!log->ReadRecord(&super_record, &scratch).ok()) continue;
+    if (super_record.size() == 0) continue;
+
+    super_block.reset(new Superblock());
+    if (!super_block->DecodeFrom(&super_record).ok()) continue;
+    if (super_block->GetSeq() <= superblock_->GetSeq()) continue;
+
+    return SwitchMetaLog(log, super_block);
+  }
+
+  return IOStatus::OK();
+}
+
+IOStatus ZenFS::TailMetadata() {
+  std::string scratch;
+  Slice record;
+  Slice data;
+  uint32_t tag;
+  IOStatus s;
+
+  if (!readonly_) return IOStatus::OK();
+
+  std::lock_guard<std::mutex> lock(metadata_sync_mtx_);
+  s = FollowMetaRoll();
+  if (!s.ok()) return s;
+
+  s = meta_log_->GetZone()->UpdateWp();
+  if (!s.ok()) return s;
+
+  while (true) {
+    uint64_t pos = meta_log_->GetReadPos();
+    Status ds;
+
+    s = meta_log_->ReadRecord(&record, &scratch);
+    if (!s.ok()) {
+      /* The primary may not have written all of the record yet */
+      meta_log_->SetReadPos(pos);
+      return s;
+    }
+
+    /* Caught up with the primary */
+    if (!GetFixed32(&record, &tag)) break;
+
+    if (!GetLengthPrefixedSlice(&record, &data))
+      return IOStatus::Corruption("ZenFS", "No metadata record data");
+
+    files_mtx_.lock();
+    switch (tag) {
+      case kFileUpdate:
+        ds = DecodeFileUpdateFrom(&data);
+        break;
+      case kFileDeletion:
+        ds = DecodeFileDeletionFrom(&data);
+        break;
+      case kRecordBatch:
+        ds = DecodeRecordBatchFrom(&data);
+        break;
+      case kEndRecord:
+        /* The primary rolled, FollowMetaRoll() picks up the new zone */
+        break;
+      default:
+        ds = Status::Corruption("ZenFS", "Unexpected tag");
+    }
+    files_mtx_.unlock();
+
+    if (!ds.ok()) {
+      Error(logger_, "Failed to apply metadata record: %s",
+            ds.ToString().c_str());
+      return IOStatus::Corruption(ds.ToString());
+    }
+    if (tag == kEndRecord) break;
+  }
+
+  return IOStatus::OK();
+}
+
 #define ZENV_URI_PATTERN "zenfs://"
 
-Status ZenFS::Mount() {
+Status ZenFS::Mount(bool readonly) {
   std::vector<Zone*> metazones = zbd_->GetMetaZones();
   std::vector<std::unique_ptr<Superblock>> valid_superblocks;
   std::vector<std::unique_ptr<ZenMetaLog>> valid_logs;
@@ -757,6 +1652,8 @@ Status ZenFS::Mount() {
 
   Status s;
 
+  readonly_ = readonly;
+
   /* We need a minimum of two non-offline meta data zones */
   if (metazones.size() < 2) {
     Error(logger_,
@@ -830,8 +1727,57 @@ Status ZenFS::Mount() {
   }
 
   Info(logger_, "Recovered from zone: %d", (int)valid_zones[r]->GetZoneNr());
+
+  /* WALs that were open with data syncs, before the sweep may reset their
+   * tail zones. A read-only mount sees their data once the primary records
+   * it, or it would be added twice */
+  for (auto it = files_.begin(); !readonly_ && it != files_.end(); it++) {
+    ZoneFile* zoneFile = it->second;
+
+    if (it->first != zoneFile->GetFilename() || !zoneFile->NeedsRecovery())
+      continue;
+    s = zoneFile->RecoverSyncedData();
+    if (!s.ok()) {
+      Error(logger_, "Failed to recover %s: %s", it->first.c_str(),
+            s.ToString().c_str());
+      return s;
+    }
+    Info(logger_, "Recovered %lu bytes of %s from its zones",
+         zoneFile->GetFileSize(), it->first.c_str());
+  }
+
+  /* Placement state is not kept for files merged from updates or
+   * discarded snapshots, rebuild it from the recovered files */
+  zbd_->sst_zone_mtx_.lock();
+  zbd_->sst_to_zone_.clear();
+  zbd_->sst_zone_mtx_.unlock();
+  zbd_->files_mtx_.lock();
+  zbd_->files_.clear();
+  zbd_->files_mtx_.unlock();
+  for (auto it = files_.begin(); it != files_.end(); it++) {
+    if (it->first == it->second->GetFilename()) zbd_->RegisterSST(it->second);
+  }
+  /* Zone counters were rebuilt from the recovered extents */
+  zbd_->AccountAllZones();
   superblock_ = std::move(valid_superblocks[r]);
   zbd_->SetFinishTreshold(superblock_->GetFinishTreshold());
+  zbd_->SetStreamingBufferSize((uint64_t)superblock_->GetStreamingBufferMB() *
+                               1024 * 1024);
+  zbd_->SetGCPolicy(superblock_->GetGCPolicy());
+  zbd_->SetStripeWidth(superblock_->GetStripeWidth());
+  zbd_->SetReadCacheSize((uint64_t)superblock_->GetReadCacheMB() * 1024 * 1024);
+  zbd_->SetBufferPoolSize((uint64_t)superblock_->GetBufferPoolMB() * 1024 *
+                          1024);
+  zbd_->SetWALDataSync(superblock_->GetWALDataSync() != 0);
+
+  if (readonly_) {
+    /* The aux directory and the zones are the primary's */
+    Info(logger_, "Read-only mount of meta zone %d, superblock sequence %d",
+         (int)meta_log_->GetZone()->GetZoneNr(), (int)superblock_->GetSeq());
+    StartMetaCheckpointWorker();
+    LogFiles();
+    return Status::OK();
+  }
 
   IOOptions foo;
   IODebugContext bar;
@@ -856,17 +1802,32 @@ Status ZenFS::Mount() {
 
   Info(logger_, "Superblock sequence %d", (int)superblock_->GetSeq());
   Info(logger_, "Finish threshold %u", superblock_->GetFinishTreshold());
+  Info(logger_, "Streaming buffer %u MB", superblock_->GetStreamingBufferMB());
+  Info(logger_, "Zone cleaning policy %u", superblock_->GetGCPolicy());
+  Info(logger_, "Stripe width %u", zbd_->GetStripeWidth());
+  Info(logger_, "Read cache %u MB", superblock_->GetReadCacheMB());
+  Info(logger_, "Buffer pool %u MB", superblock_->GetBufferPoolMB());
+  Info(logger_, "WAL data sync %u", superblock_->GetWALDataSync());
   Info(logger_, "Filesystem mount OK");
-  Info(logger_, "Resetting unused IO Zones..");
-  zbd_->ResetUnusedIOZones();
-  Info(logger_, "  Done");
+  /* Reset in the background, the sweep worker refills the WAL ring once
+   * zones are empty */
+  zbd_->DeferResetUnusedIOZones();
+
+  zbd_->StartSweepWorker();
+  zbd_->StartGCWorker();
+  zbd_->StartZoneStatsWorker();
+  zbd_->KickSweepWorker();
+  StartMetaCheckpointWorker();
 
   LogFiles();
 
   return Status::OK();
 }
 
-Status ZenFS::MkFS(std::string aux_fs_path, uint32_t finish_threshold) {
+Status ZenFS::MkFS(std::string aux_fs_path, uint32_t finish_threshold,
+                   uint32_t streaming_buffer_mb, uint32_t gc_policy,
+                   uint32_t stripe_width, uint32_t read_cache_mb,
+                   uint32_t buffer_pool_mb, uint32_t wal_data_sync) {
   std::vector<Zone*> metazones = zbd_->GetMetaZones();
   std::unique_ptr<ZenMetaLog> log;
   Zone* meta_zone = nullptr;
@@ -878,7 +1839,9 @@ Status ZenFS::MkFS(std::string aux_fs_path, uint32_t finish_threshold) {
   }
 
   ClearFiles();
-  zbd_->ResetUnusedIOZones();
+  /* Only the meta zones are reset here, the io zones hold no files any more
+   * and are reset by the sweep of the next mount */
+  zbd_->DeferResetUnusedIOZones();
 
   for (const auto mz : metazones) {
     if (mz->Reset().ok()) {
@@ -894,7 +1857,10 @@ Status ZenFS::MkFS(std::string aux_fs_path, uint32_t finish_threshold) {
 
   log.reset(new ZenMetaLog(zbd_, meta_zone));
 
-  Superblock* super = new Superblock(zbd_, aux_fs_path, finish_threshold);
+  Superblock* super = new Superblock(zbd_, aux_fs_path, finish_threshold,
+                                     streaming_buffer_mb, gc_policy,
+                                     stripe_width, read_cache_mb,
+                                     buffer_pool_mb, wal_data_sync);
   std::string super_string;
   super->EncodeTo(&super_string);
 
@@ -920,13 +1886,15 @@ static std::string GetLogFilename(std::string bdev) {
   char buf[40];
 
   std::strftime(buf, sizeof(buf), "%Y-%m-%d_%H:%M:%S.log", log_start);
+  /* Emulated device names are paths */
+  std::replace(bdev.begin(), bdev.end(), '/', '_');
   ss << DEFAULT_ZENV_LOG_PATH << std::string("zenfs_") << bdev << "_" << buf;
 
   return ss.str();
 }
 #endif
 
-Status NewZenFS(FileSystem** fs, const std::string& bdevname) {
+Status NewZenFS(FileSystem** fs, const std::string& bdevname, bool readonly) {
   std::shared_ptr<Logger> logger;
   Status s;
 
@@ -940,7 +1908,7 @@ Status NewZenFS(FileSystem** fs, const std::string& bdevname) {
 #endif
 
   ZonedBlockDevice* zbd = new ZonedBlockDevice(bdevname, logger);
-  IOStatus zbd_status = zbd->Open();
+  IOStatus zbd_status = zbd->Open(readonly);
   if (!zbd_status.ok()) {
     Error(logger, "Failed to open zoned block device: %s",
           zbd_status.ToString().c_str());
@@ -948,7 +1916,7 @@ Status NewZenFS(FileSystem** fs, const std::string& bdevname) {
   }
 
   ZenFS* zenFS = new ZenFS(zbd, FileSystem::Default(), logger);
-  s = zenFS->Mount();
+  s = zenFS->Mount(readonly);
   if (!s.ok()) {
     delete zenFS;
     return s;
@@ -1012,7 +1980,8 @@ std::map<std::string, std::string> ListZenFileSystems() {
 #include "rocksdb/env.h"
 
 namespace ROCKSDB_NAMESPACE {
-Status NewZenFS(FileSystem** /*fs*/, const std::string& /*bdevname*/) {
+Status NewZenFS(FileSystem** /*fs*/, const std::string& /*bdevname*/,
+                bool /*readonly*/) {
   return Status::NotSupported("Not built with ZenFS support\n");
 }
 std::map<std::string, std::string> ListZenFileSystems() {
@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <deque>
+#include <unordered_map>
+
 #include "env/io_zenfs.h"
 #include "env/zbd_zenfs.h"
 #include "rocksdb/env.h"
@@ -30,7 +33,13 @@ class Superblock {
   uint32_t nr_zones_ = 0;
   char aux_fs_path_[256] = {0};
   uint32_t finish_treshold_ = 0;
-  char reserved_[187] = {0};
+  uint32_t streaming_buffer_mb_ = 0; /* 0: stage whole SSTs before placement */
+  uint32_t gc_policy_ = 0;           /* ZoneGCPolicy */
+  uint32_t stripe_width_ = 0;        /* 0 or 1: no striping */
+  uint32_t read_cache_mb_ = 0;       /* 0: no read cache */
+  uint32_t buffer_pool_mb_ = 0;      /* 0: ZENFS_BUFFER_POOL_SIZE */
+  uint32_t wal_data_sync_ = 0;       /* 1: WAL syncs persist no metadata */
+  char reserved_[163] = {0};
 
  public:
   const uint32_t MAGIC = 0x5a454e46; /* ZENF */
@@ -43,7 +52,10 @@ class Superblock {
   /* Create a superblock for a filesystem covering the entire zoned block device
    */
   Superblock(ZonedBlockDevice* zbd, std::string aux_fs_path = "",
-             uint32_t finish_threshold = 0) {
+             uint32_t finish_threshold = 0, uint32_t streaming_buffer_mb = 0,
+             uint32_t gc_policy = 0, uint32_t stripe_width = 0,
+             uint32_t read_cache_mb = 0, uint32_t buffer_pool_mb = 0,
+             uint32_t wal_data_sync = 0) {
     std::string uuid = Env::Default()->GenerateUniqueId();
     int uuid_len =
         std::min(uuid.length(),
@@ -53,6 +65,12 @@ class Superblock {
     version_ = CURRENT_VERSION;
     flags_ = DEFAULT_FLAGS;
     finish_treshold_ = finish_threshold;
+    streaming_buffer_mb_ = streaming_buffer_mb;
+    gc_policy_ = gc_policy;
+    stripe_width_ = stripe_width;
+    read_cache_mb_ = read_cache_mb;
+    buffer_pool_mb_ = buffer_pool_mb;
+    wal_data_sync_ = wal_data_sync;
 
     block_size_ = zbd->GetBlockSize();
     zone_size_ = zbd->GetZoneSize() / block_size_;
@@ -80,6 +98,12 @@ class Superblock {
     GetFixed32(input, &finish_treshold_);
     memcpy(&aux_fs_path_, input->data(), sizeof(aux_fs_path_));
     input->remove_prefix(sizeof(aux_fs_path_));
+    GetFixed32(input, &streaming_buffer_mb_);
+    GetFixed32(input, &gc_policy_);
+    GetFixed32(input, &stripe_width_);
+    GetFixed32(input, &read_cache_mb_);
+    GetFixed32(input, &buffer_pool_mb_);
+    GetFixed32(input, &wal_data_sync_);
     memcpy(&reserved_, input->data(), sizeof(reserved_));
     input->remove_prefix(sizeof(reserved_));
     assert(input->size() == 0);
@@ -105,6 +129,12 @@ class Superblock {
     PutFixed32(output, nr_zones_);
     PutFixed32(output, finish_treshold_);
     output->append(aux_fs_path_, sizeof(aux_fs_path_));
+    PutFixed32(output, streaming_buffer_mb_);
+    PutFixed32(output, gc_policy_);
+    PutFixed32(output, stripe_width_);
+    PutFixed32(output, read_cache_mb_);
+    PutFixed32(output, buffer_pool_mb_);
+    PutFixed32(output, wal_data_sync_);
     output->append(reserved_, sizeof(reserved_));
     assert(output->length() == ENCODED_SIZE);
   }
@@ -126,15 +156,30 @@ class Superblock {
   uint32_t GetSeq() { return sequence_; }
   std::string GetAuxFsPath() { return std::string(aux_fs_path_); }
   uint32_t GetFinishTreshold() { return finish_treshold_; }
+  uint32_t GetStreamingBufferMB() { return streaming_buffer_mb_; }
+  uint32_t GetGCPolicy() { return gc_policy_; }
+  uint32_t GetStripeWidth() { return stripe_width_; }
+  uint32_t GetReadCacheMB() { return read_cache_mb_; }
+  uint32_t GetBufferPoolMB() { return buffer_pool_mb_; }
+  uint32_t GetWALDataSync() { return wal_data_sync_; }
   std::string GetUUID() { return std::string(uuid_); }
 };
 
+/* Metadata zones are replayed sequentially on mount, read them in large
+ * chunks instead of one record at a time */
+#define ZENFS_META_READAHEAD_SIZE (4 * 1024 * 1024)
+
 class ZenMetaLog {
   uint64_t read_pos_;
   Zone* zone_;
   ZonedBlockDevice* zbd_;
   size_t bs_;
 
+  /* Device range [ra_start_, ra_start_ + ra_len_) cached in ra_buf_ */
+  std::string ra_buf_;
+  uint64_t ra_start_;
+  size_t ra_len_;
+
   /* Every meta log record is prefixed with a CRC(32 bits) and record length (32
    * bits) */
   const size_t zMetaHeaderSize = sizeof(uint32_t) * 2;
@@ -146,6 +191,8 @@ class ZenMetaLog {
     zone_->open_for_write_ = true;
     bs_ = zbd_->GetBlockSize();
     read_pos_ = zone->start_;
+    ra_start_ = zone->start_;
+    ra_len_ = 0;
   }
 
   virtual ~ZenMetaLog() { zone_->open_for_write_ = false; }
@@ -155,16 +202,37 @@ class ZenMetaLog {
 
   Zone* GetZone() { return zone_; };
 
+  /* Where the next record is read from. Reset to reread a record the
+   * writer of the zone had not completed yet */
+  uint64_t GetReadPos() { return read_pos_; }
+  void SetReadPos(uint64_t pos) { read_pos_ = pos; }
+
  private:
   IOStatus Read(Slice* slice);
+  IOStatus ReadAhead();
+};
+
+/* A file and where its data lives, see ZenFS::GetFileLayouts() */
+struct ZenFSFileLayout {
+  std::string filename_;
+  uint64_t size_;
+  std::vector<ZonedFileExtent> extents_;
 };
 
 class ZenFS : public FileSystemWrapper {
   ZonedBlockDevice* zbd_;
   std::map<std::string, ZoneFile*> files_;
-  std::mutex files_mtx_;
+  /* SSTs in files_ by file number, protected by files_mtx_ */
+  std::unordered_map<uint64_t, ZoneFile*> files_by_fno_;
+  ProfiledStdMutex files_mtx_{"ZenFS::files_mtx_"};
   std::shared_ptr<Logger> logger_;
   std::atomic<uint64_t> next_file_id_;
+#if defined(ROCKSDB_IOURING_PRESENT)
+  /* io_uring instances used by ZonedRandomAccessFile::MultiRead */
+  std::unique_ptr<ThreadLocalPtr> thread_local_io_urings_;
+  /* and by ZonedRandomAccessFile::ReadAsync */
+  std::unique_ptr<ThreadLocalPtr> thread_local_async_read_io_urings_;
+#endif
 
   DBImpl* db_ptr_;
 
@@ -173,6 +241,42 @@ class ZenFS : public FileSystemWrapper {
   std::mutex metadata_sync_mtx_;
   std::unique_ptr<Superblock> superblock_;
 
+  /* Mounted read-only, see Mount() */
+  bool readonly_;
+  /* Files of a read-only mount that were deleted or replaced while open
+   * files may still read them, freed on unmount */
+  std::vector<ZoneFile*> retired_files_;
+  /* Write pointers of the other meta zones when they were last checked for
+   * a newer superblock, protected by metadata_sync_mtx_ */
+  std::map<Zone*, uint64_t> meta_tail_wps_;
+
+  /* Background meta log checkpointing, see MetaCheckpoint(), or tailing of
+   * a read-only mount, see TailMetadata() */
+  std::unique_ptr<std::thread> meta_checkpoint_worker_;
+  std::mutex meta_checkpoint_mtx_;
+  std::condition_variable meta_checkpoint_cv_;
+  bool meta_checkpoint_exit_;
+  /* Protected by metadata_sync_mtx_ */
+  uint64_t meta_log_bytes_;      /* record bytes since the last snapshot */
+  uint64_t meta_snapshot_bytes_; /* size of the last snapshot */
+  uint64_t meta_roll_seq_;       /* bumped whenever meta_log_ changes */
+  bool meta_checkpoint_active_;
+  std::vector<std::string> meta_checkpoint_tail_;
+
+  /* Group commit of metadata records. Records are encoded and queued under
+   * meta_queue_mtx_, which orders them against snapshots, and whichever
+   * waiter becomes leader writes all queued records as one batch */
+  struct MetaRecordWaiter {
+    std::string record_;
+    IOStatus status_;
+    bool done_;
+    MetaRecordWaiter() : done_(false) {}
+  };
+  std::deque<MetaRecordWaiter*> meta_queue_;
+  std::mutex meta_queue_mtx_;
+  std::condition_variable meta_queue_cv_;
+  bool meta_queue_leader_;
+
   std::shared_ptr<Logger> GetLogger() { return logger_; }
 
   struct MetadataWriter : public ZonedWritableFile::MetadataWriter {
@@ -191,28 +295,56 @@ class ZenFS : public FileSystemWrapper {
     kFileUpdate = 2,
     kFileDeletion = 3,
     kEndRecord = 4,
+    /* Only valid for recovery once followed by kCheckpointCommit */
+    kCheckpointSnapshot = 5,
+    kCheckpointCommit = 6,
+    /* Length prefixed kFileUpdate/kFileDeletion records */
+    kRecordBatch = 7,
   };
 
   void SetDBPointer(DBImpl* db);
   int GetZonedFileExtentNum(const uint64_t fileno);
   void GetExtentInfo(const uint64_t fileno, const int ext_no, int& zone_id, uint32_t& extent_length, uint32_t& extent_start); 
+  void GetFileExtents(const std::vector<uint64_t>& fnos,
+                      std::vector<ZonedFileExtent>* extents);
+  bool GetProperty(const std::string& property, std::string* value);
+  uint64_t GetZoneFreeBytes(const std::vector<uint64_t>& fnos);
+  uint64_t GetZoneCapacity(int level, uint64_t* max_capacity);
+  std::shared_ptr<const ZoneExtentTable> GetSSTExtentTable(uint64_t fno);
   void LogFiles();
   void ClearFiles();
+  void InsertFile(ZoneFile* zoneFile);
+  void EraseFile(const std::string& fname);
   IOStatus WriteSnapshot(ZenMetaLog* meta_log);
   IOStatus WriteEndRecord(ZenMetaLog* meta_log);
   IOStatus RollMetaZone();
   IOStatus PersistSnapshot(ZenMetaLog* meta_writer);
-  IOStatus PersistRecord(std::string record);
+  IOStatus PersistRecord(MetaRecordWaiter* w);
+  IOStatus WriteQueuedRecords();
+  void CompleteQueuedRecords(size_t n, IOStatus s);
+  bool NeedsMetaCheckpoint();
+  IOStatus MetaCheckpoint();
+  void MetaCheckpointWorker();
+  void MetaTailWorker();
+  void StartMetaCheckpointWorker();
+  void StopMetaCheckpointWorker();
   IOStatus SyncFileMetadata(ZoneFile* zoneFile);
 
-  void EncodeSnapshotTo(std::string* output);
+  void EncodeSnapshotTo(std::string* output,
+                        uint32_t tag = kCompleteFilesSnapshot);
   void EncodeFileDeletionTo(ZoneFile* zoneFile, std::string* output);
 
   Status DecodeSnapshotFrom(Slice* input);
   Status DecodeFileUpdateFrom(Slice* slice);
   Status DecodeFileDeletionFrom(Slice* slice);
+  Status DecodeRecordBatchFrom(Slice* slice);
 
   Status RecoverFrom(ZenMetaLog* log);
+  /* Moves a read-only mount to a newer meta zone the primary rolled to */
+  IOStatus FollowMetaRoll();
+  IOStatus SwitchMetaLog(std::unique_ptr<ZenMetaLog>& log,
+                         std::unique_ptr<Superblock>& super_block);
+  void RetireFile(ZoneFile* zoneFile);
 
   std::string ToAuxPath(std::string path) {
     return superblock_->GetAuxFsPath() + path;
@@ -226,19 +358,41 @@ class ZenFS : public FileSystemWrapper {
 
   ZoneFile* GetFile(std::string fname);
   IOStatus DeleteFile(std::string fname);
+  /* Renames the zone files under directory f, which was renamed to t */
+  IOStatus RenameChildren(const std::string& f, const std::string& t,
+                          const IOOptions& options, IODebugContext* dbg);
 
  public:
   explicit ZenFS(ZonedBlockDevice* zbd, std::shared_ptr<FileSystem> aux_fs,
                  std::shared_ptr<Logger> logger);
   virtual ~ZenFS();
 
-  Status Mount();
-  Status MkFS(std::string aux_fs_path, uint32_t finish_threshold);
+  /* A read-only mount leaves the device to the process that mounted it
+   * for writing, the primary. It writes no metadata and resets no zones,
+   * and follows the files the primary creates, appends to and deletes by
+   * tailing its meta zone. Files can only be opened for reading */
+  Status Mount(bool readonly = false);
+  Status MkFS(std::string aux_fs_path, uint32_t finish_threshold,
+              uint32_t streaming_buffer_mb = 0, uint32_t gc_policy = 0,
+              uint32_t stripe_width = 0, uint32_t read_cache_mb = 0,
+              uint32_t buffer_pool_mb = 0, uint32_t wal_data_sync = 0);
 
   const char* Name() const override {
     return "ZenFS - The Zoned-enabled File System";
   }
 
+  /* Applies the metadata records the primary wrote since the last call to
+   * a read-only mount. Done in the background every
+   * ZENFS_META_TAIL_INTERVAL_MS and when a file is not found, call it to
+   * see the latest files now, e.g. before
+   * DB::TryCatchUpWithPrimary() */
+  IOStatus TailMetadata();
+
+  /* Layout of every file under dir, for tools that inspect a file system
+   * without opening a database. Extents hold the file id in fno */
+  void GetFileLayouts(const std::string& dir,
+                      std::vector<ZenFSFileLayout>* layouts);
+
   MetadataWriter* GetMetaWriter(){return &metadata_writer_;};
   virtual IOStatus NewSequentialFile(const std::string& fname,
                                      const FileOptions& file_opts,
@@ -266,6 +420,12 @@ class ZenFS : public FileSystemWrapper {
   virtual IOStatus DeleteFile(const std::string& fname,
                               const IOOptions& options,
                               IODebugContext* dbg) override;
+  /* Records the deletions in as few meta log records as fit, instead of
+   * one record, and one wait for it, per file */
+  virtual IOStatus DeleteFiles(const std::vector<std::string>& fnames,
+                               const IOOptions& options,
+                               std::vector<IOStatus>* statuses,
+                               IODebugContext* dbg) override;
   IOStatus GetFileSize(const std::string& f, const IOOptions& options,
                        uint64_t* size, IODebugContext* dbg) override;
   IOStatus RenameFile(const std::string& f, const std::string& t,
@@ -285,6 +445,10 @@ class ZenFS : public FileSystemWrapper {
     return target()->IsDirectory(ToAuxPath(path), options, is_dir, dbg);
   }
 
+  /* All random access files are zone files, whose reads it waits for */
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t min_completions) override;
+
   IOStatus NewDirectory(const std::string& name, const IOOptions& io_opts,
                         std::unique_ptr<FSDirectory>* result,
                         IODebugContext* dbg) override {
@@ -388,30 +552,21 @@ class ZenFS : public FileSystemWrapper {
         "GetFileModificationTime is not implemented in ZenFS");
   }
 
-  virtual IOStatus LinkFile(const std::string& /*src*/,
-                            const std::string& /*target*/,
-                            const IOOptions& /*options*/,
-                            IODebugContext* /*dbg*/) {
-    return IOStatus::NotSupported("LinkFile is not supported in ZenFS");
-  }
-
-  virtual IOStatus NumFileLinks(const std::string& /*fname*/,
-                                const IOOptions& /*options*/,
-                                uint64_t* /*count*/, IODebugContext* /*dbg*/) {
-    return IOStatus::NotSupported(
-        "Getting number of file links is not supported in ZenFS");
-  }
-
-  virtual IOStatus AreFilesSame(const std::string& /*first*/,
-                                const std::string& /*second*/,
-                                const IOOptions& /*options*/, bool* /*res*/,
-                                IODebugContext* /*dbg*/) {
-    return IOStatus::NotSupported("AreFilesSame is not supported in ZenFS");
-  }
+  /* A link is a further name of a zone file, sharing its extents. Only the
+   * metadata is written, so checkpoints link table files instead of copying
+   * them. The data goes with the last name */
+  IOStatus LinkFile(const std::string& src, const std::string& target,
+                    const IOOptions& options, IODebugContext* dbg) override;
+  IOStatus NumFileLinks(const std::string& fname, const IOOptions& options,
+                        uint64_t* count, IODebugContext* dbg) override;
+  IOStatus AreFilesSame(const std::string& first, const std::string& second,
+                        const IOOptions& options, bool* res,
+                        IODebugContext* dbg) override;
 };
 #endif  // !defined(ROCKSDB_LITE) && defined(OS_LINUX) && defined(LIBZBD)
 
-Status NewZenFS(FileSystem** fs, const std::string& bdevname);
+Status NewZenFS(FileSystem** fs, const std::string& bdevname,
+                bool readonly = false);
 std::map<std::string, std::string> ListZenFileSystems();
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -545,7 +545,8 @@ PosixRandomAccessFile::PosixRandomAccessFile(
     const EnvOptions& options
 #if defined(ROCKSDB_IOURING_PRESENT)
     ,
-    ThreadLocalPtr* thread_local_io_urings
+    ThreadLocalPtr* thread_local_io_urings,
+    ThreadLocalPtr* thread_local_async_read_io_urings
 #endif
     )
     : filename_(fname),
@@ -554,7 +555,8 @@ PosixRandomAccessFile::PosixRandomAccessFile(
       logical_sector_size_(logical_block_size)
 #if defined(ROCKSDB_IOURING_PRESENT)
       ,
-      thread_local_io_urings_(thread_local_io_urings)
+      thread_local_io_urings_(thread_local_io_urings),
+      thread_local_async_read_io_urings_(thread_local_async_read_io_urings)
 #endif
 {
   assert(!options.use_direct_reads || !options.use_mmap_reads);
@@ -771,6 +773,129 @@ IOStatus PosixRandomAccessFile::Prefetch(uint64_t offset, size_t n,
   return s;
 }
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+namespace {
+// Fills in the request of a finished async read, res being the result of its
+// io_uring read, and invokes the callback
+void FinishAsyncRead(PosixIOHandle* handle, int res) {
+  FSReadRequest& req = handle->req;
+  size_t read = 0;
+  if (res < 0) {
+    req.status = IOError("While async pread offset " + ToString(req.offset) +
+                             " len " + ToString(req.len),
+                         *handle->filename, -res);
+  } else {
+    read = static_cast<size_t>(res);
+    // Complete short reads synchronously like Read() does. Direct reads not
+    // filling sectors only happen at the end of the file.
+    while (read > 0 && read < req.len &&
+           (handle->direct_io_alignment == 0 ||
+            read % handle->direct_io_alignment == 0)) {
+      ssize_t r = pread(handle->fd, req.scratch + read, req.len - read,
+                        static_cast<off_t>(req.offset + read));
+      if (r == -1 && errno == EINTR) {
+        continue;
+      }
+      if (r < 0) {
+        req.status =
+            IOError("While pread offset " + ToString(req.offset + read) +
+                        " len " + ToString(req.len - read),
+                    *handle->filename, errno);
+        read = 0;
+        break;
+      }
+      if (r == 0) {
+        break;
+      }
+      read += r;
+    }
+  }
+  req.result = Slice(req.scratch, read);
+  handle->is_finished = true;
+  handle->cb(req, handle->cb_arg);
+}
+}  // namespace
+
+IOStatus PollIOUring(std::vector<void*>& io_handles) {
+  for (void* io_handle : io_handles) {
+    PosixIOHandle* handle = static_cast<PosixIOHandle*>(io_handle);
+    while (!handle->is_finished) {
+      // Also submits reads whose submission failed in ReadAsync()
+      int ret = io_uring_submit_and_wait(handle->iu, 1);
+      if (ret == -EINTR) {
+        continue;
+      }
+      if (ret < 0) {
+        return IOStatus::IOError("io_uring_submit_and_wait() returns " +
+                                 ToString(ret));
+      }
+      struct io_uring_cqe* cqe = nullptr;
+      if (io_uring_peek_cqe(handle->iu, &cqe) != 0 || cqe == nullptr) {
+        continue;
+      }
+      PosixIOHandle* finished =
+          static_cast<PosixIOHandle*>(io_uring_cqe_get_data(cqe));
+      int res = cqe->res;
+      io_uring_cqe_seen(handle->iu, cqe);
+      FinishAsyncRead(finished, res);
+    }
+  }
+  return IOStatus::OK();
+}
+#endif  // defined(ROCKSDB_IOURING_PRESENT)
+
+IOStatus PosixRandomAccessFile::ReadAsync(
+    FSReadRequest& req, const IOOptions& opts,
+    std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) {
+  if (use_direct_io()) {
+    assert(IsSectorAligned(req.offset, GetRequiredBufferAlignment()));
+    assert(IsSectorAligned(req.len, GetRequiredBufferAlignment()));
+    assert(IsSectorAligned(req.scratch, GetRequiredBufferAlignment()));
+  }
+
+#if defined(ROCKSDB_IOURING_PRESENT)
+  struct io_uring* iu = nullptr;
+  if (thread_local_async_read_io_urings_) {
+    iu = static_cast<struct io_uring*>(
+        thread_local_async_read_io_urings_->Get());
+    if (iu == nullptr) {
+      iu = CreateIOUring();
+      if (iu != nullptr) {
+        thread_local_async_read_io_urings_->Reset(iu);
+      }
+    }
+  }
+
+  // Without io_uring, or with a full submission queue, fall back to a
+  // synchronous read
+  struct io_uring_sqe* sqe = iu != nullptr ? io_uring_get_sqe(iu) : nullptr;
+  if (sqe != nullptr) {
+    PosixIOHandle* handle = new PosixIOHandle();
+    handle->iu = iu;
+    handle->iov.iov_base = req.scratch;
+    handle->iov.iov_len = req.len;
+    handle->req = req;
+    handle->cb = cb;
+    handle->cb_arg = cb_arg;
+    handle->fd = fd_;
+    handle->filename = &filename_;
+    handle->direct_io_alignment =
+        use_direct_io() ? GetRequiredBufferAlignment() : 0;
+    handle->is_finished = false;
+    io_uring_prep_readv(sqe, fd_, &handle->iov, 1, req.offset);
+    io_uring_sqe_set_data(sqe, handle);
+    // If this fails, the read stays queued and Poll() submits it
+    io_uring_submit(iu);
+    *io_handle = handle;
+    *del_fn = [](void* h) { delete static_cast<PosixIOHandle*>(h); };
+    return IOStatus::OK();
+  }
+#endif
+  return FSRandomAccessFile::ReadAsync(req, opts, cb, cb_arg, io_handle, del_fn,
+                                       dbg);
+}
+
 #if defined(OS_LINUX) || defined(OS_MACOSX) || defined(OS_AIX)
 size_t PosixRandomAccessFile::GetUniqueId(char* id, size_t max_size) const {
   return PosixHelper::GetUniqueIdFromFile(fd_, id, max_size);
@@ -1148,6 +1273,11 @@ PosixWritableFile::PosixWritableFile(const std::string& fname, int fd,
 #ifdef ROCKSDB_RANGESYNC_PRESENT
   sync_file_range_supported_ = IsSyncFileRangeSupported(fd_);
 #endif  // ROCKSDB_RANGESYNC_PRESENT
+#if defined(ROCKSDB_IOURING_PRESENT)
+  async_write_io_uring_ = nullptr;
+  async_writes_ = 0;
+  async_written_ = false;
+#endif
   assert(!options.use_mmap_writes);
 }
 
@@ -1156,6 +1286,12 @@ PosixWritableFile::~PosixWritableFile() {
     IOStatus s = PosixWritableFile::Close(IOOptions(), nullptr);
     s.PermitUncheckedError();
   }
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (async_write_io_uring_ != nullptr) {
+    io_uring_queue_exit(async_write_io_uring_);
+    DeleteIOUring(async_write_io_uring_);
+  }
+#endif
 }
 
 IOStatus PosixWritableFile::Append(const Slice& data, const IOOptions& /*opts*/,
@@ -1194,6 +1330,116 @@ IOStatus PosixWritableFile::PositionedAppend(const Slice& data, uint64_t offset,
   return IOStatus::OK();
 }
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+namespace {
+// The io_uring user data of a write started by
+// PosixWritableFile::AppendAsync()
+struct PosixAsyncWrite {
+  struct iovec iov;
+  uint64_t offset;
+};
+}  // namespace
+#endif
+
+IOStatus PosixWritableFile::AppendAsync(const Slice& data,
+                                        const IOOptions& opts,
+                                        IODebugContext* dbg) {
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (!use_direct_io() && async_write_io_uring_ == nullptr) {
+    async_write_io_uring_ = CreateIOUring();
+  }
+  struct io_uring* iu = async_write_io_uring_;
+  if (iu != nullptr) {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(iu);
+    if (sqe == nullptr) {
+      IOStatus s = WaitAsync(opts, dbg);
+      if (!s.ok()) {
+        return s;
+      }
+      sqe = io_uring_get_sqe(iu);
+    }
+    if (sqe != nullptr) {
+      PosixAsyncWrite* write = new PosixAsyncWrite();
+      write->iov.iov_base = const_cast<char*>(data.data());
+      write->iov.iov_len = data.size();
+      write->offset = filesize_;
+      io_uring_prep_writev(sqe, fd_, &write->iov, 1, write->offset);
+      io_uring_sqe_set_data(sqe, write);
+      async_writes_++;
+      async_written_ = true;
+      filesize_ += data.size();
+      // If this fails, the write stays queued and WaitAsync() submits it
+      int ret = io_uring_submit(iu);
+      if (ret < 0) {
+        return IOError("While submitting async write to file", filename_,
+                       -ret);
+      }
+      return IOStatus::OK();
+    }
+  }
+#endif
+  return Append(data, opts, dbg);
+}
+
+IOStatus PosixWritableFile::WaitAsync(const IOOptions& /*opts*/,
+                                      IODebugContext* /*dbg*/) {
+  IOStatus s;
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (async_writes_ > 0) {
+    int ret = io_uring_submit(async_write_io_uring_);
+    if (ret < 0) {
+      return IOError("While submitting async writes to file", filename_,
+                     -ret);
+    }
+  }
+  while (async_writes_ > 0) {
+    struct io_uring_cqe* cqe = nullptr;
+    int ret = io_uring_wait_cqe(async_write_io_uring_, &cqe);
+    if (ret == -EINTR || ret == -EAGAIN) {
+      continue;
+    }
+    if (ret < 0) {
+      // The writes can not be reaped, so their buffers are not safe to reuse
+      // before the file is closed
+      return IOError("While waiting for async writes to file", filename_,
+                     -ret);
+    }
+    PosixAsyncWrite* write =
+        static_cast<PosixAsyncWrite*>(io_uring_cqe_get_data(cqe));
+    int res = cqe->res;
+    io_uring_cqe_seen(async_write_io_uring_, cqe);
+    async_writes_--;
+
+    // Finish a short write synchronously
+    size_t written = res > 0 ? static_cast<size_t>(res) : 0;
+    if (res < 0 && res != -EAGAIN && res != -EINTR) {
+      if (s.ok()) {
+        s = IOError("While async write to file at offset " +
+                        ToString(write->offset),
+                    filename_, -res);
+      }
+    } else if (written < write->iov.iov_len && s.ok()) {
+      if (!PosixPositionedWrite(
+              fd_, static_cast<char*>(write->iov.iov_base) + written,
+              write->iov.iov_len - written,
+              static_cast<off_t>(write->offset + written))) {
+        s = IOError("While pwrite to file at offset " +
+                        ToString(write->offset + written),
+                    filename_, errno);
+      }
+    }
+    delete write;
+  }
+  if (async_written_ && s.ok()) {
+    if (lseek(fd_, static_cast<off_t>(filesize_), SEEK_SET) < 0) {
+      s = IOError("While seeking to the end of file", filename_, errno);
+    }
+    async_written_ = false;
+  }
+#endif
+  return s;
+}
+
 IOStatus PosixWritableFile::Truncate(uint64_t size, const IOOptions& /*opts*/,
                                      IODebugContext* /*dbg*/) {
   IOStatus s;
@@ -1207,9 +1453,9 @@ IOStatus PosixWritableFile::Truncate(uint64_t size, const IOOptions& /*opts*/,
   return s;
 }
 
-IOStatus PosixWritableFile::Close(const IOOptions& /*opts*/,
-                                  IODebugContext* /*dbg*/) {
-  IOStatus s;
+IOStatus PosixWritableFile::Close(const IOOptions& opts,
+                                  IODebugContext* dbg) {
+  IOStatus s = WaitAsync(opts, dbg);
 
   size_t block_size;
   size_t last_allocated_block;
@@ -167,6 +167,26 @@ inline struct io_uring* CreateIOUring() {
   }
   return new_io_uring;
 }
+
+// A read started by PosixRandomAccessFile::ReadAsync(). It is the io_uring
+// user data of the read and the I/O handle returned to the caller.
+struct PosixIOHandle {
+  struct io_uring* iu;
+  struct iovec iov;
+  FSReadRequest req;
+  std::function<void(const FSReadRequest&, void*)> cb;
+  void* cb_arg;
+  int fd;
+  const std::string* filename;
+  // Required alignment of direct reads, 0 for buffered reads
+  size_t direct_io_alignment;
+  bool is_finished;
+};
+
+// Waits until the reads of all io_handles, which are PosixIOHandles, have
+// completed. Completions of other reads of the same io_uring instances met
+// on the way are processed too.
+IOStatus PollIOUring(std::vector<void*>& io_handles);
 #endif  // defined(ROCKSDB_IOURING_PRESENT)
 
 class PosixRandomAccessFile : public FSRandomAccessFile {
@@ -177,6 +197,9 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
   size_t logical_sector_size_;
 #if defined(ROCKSDB_IOURING_PRESENT)
   ThreadLocalPtr* thread_local_io_urings_;
+  // Separate instances for ReadAsync(), as MultiRead() expects to reap only
+  // completions of its own requests
+  ThreadLocalPtr* thread_local_async_read_io_urings_;
 #endif
 
  public:
@@ -185,7 +208,8 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
                         const EnvOptions& options
 #if defined(ROCKSDB_IOURING_PRESENT)
                         ,
-                        ThreadLocalPtr* thread_local_io_urings
+                        ThreadLocalPtr* thread_local_io_urings,
+                        ThreadLocalPtr* thread_local_async_read_io_urings
 #endif
   );
   virtual ~PosixRandomAccessFile();
@@ -201,6 +225,11 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
   virtual IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& opts,
                             IODebugContext* dbg) override;
 
+  virtual IOStatus ReadAsync(
+      FSReadRequest& req, const IOOptions& opts,
+      std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+      void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) override;
+
 #if defined(OS_LINUX) || defined(OS_MACOSX) || defined(OS_AIX)
   virtual size_t GetUniqueId(char* id, size_t max_size) const override;
 #endif
@@ -228,6 +257,15 @@ class PosixWritableFile : public FSWritableFile {
   // support it, so we need to do a dynamic check too.
   bool sync_file_range_supported_;
 #endif  // ROCKSDB_RANGESYNC_PRESENT
+#if defined(ROCKSDB_IOURING_PRESENT)
+  // Of AppendAsync(), created on first use
+  struct io_uring* async_write_io_uring_;
+  // Submitted by AppendAsync() and not reaped yet
+  size_t async_writes_;
+  // The async writes are positional, so the file offset Append() writes at
+  // must be moved to the end of the file after them
+  bool async_written_;
+#endif
 
  public:
   explicit PosixWritableFile(const std::string& fname, int fd,
@@ -255,6 +293,10 @@ class PosixWritableFile : public FSWritableFile {
       IODebugContext* dbg) override {
     return PositionedAppend(data, offset, opts, dbg);
   }
+  virtual IOStatus AppendAsync(const Slice& data, const IOOptions& opts,
+                               IODebugContext* dbg) override;
+  virtual IOStatus WaitAsync(const IOOptions& opts,
+                             IODebugContext* dbg) override;
   virtual IOStatus Flush(const IOOptions& opts, IODebugContext* dbg) override;
   virtual IOStatus Sync(const IOOptions& opts, IODebugContext* dbg) override;
   virtual IOStatus Fsync(const IOOptions& opts, IODebugContext* dbg) override;
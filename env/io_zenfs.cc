@@ -17,18 +17,51 @@
 #include <string.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <climits>
+#include <future>
+#include <limits>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "monitoring/iostats_context_imp.h"
+#include "monitoring/span_tracer_imp.h"
+#include "monitoring/statistics.h"
 #include "rocksdb/env.h"
+#include "util/autovector.h"
 #include "util/coding.h"
+#include "util/crc32c.h"
 #include "zbd_zenfs.h"
 
 #include <iostream>
 
+/* Sequential reads in a row before ZoneReadAhead starts reading ahead, and
+ * its first and largest window */
+#define ZENFS_READAHEAD_TRIGGER (2)
+#define ZENFS_READAHEAD_MIN_SIZE (512 * 1024)
+#define ZENFS_READAHEAD_MAX_SIZE (8 * 1024 * 1024)
+
+/* Blob files of a level created in the same window with values of the same
+ * size class (a factor of 4 apart) form a generation, which gets zones of its
+ * own. Generation buckets have the top bit set, FIFO time buckets do not */
+#define ZENFS_BLOB_GENERATION_SECONDS (600)
+#define ZENFS_BLOB_BUCKET_FLAG (1ull << 63)
+/* L0 files of a column family and key range, see SetL0Stream() */
+#define ZENFS_L0_BUCKET_FLAG (1ull << 62)
+
+/* A sealed WAL tail ends its last block with a trailer of the magic, the
+ * data size, the file ID, the file data position the tail is written at
+ * next, 4 reserved bytes and the checksum of the data and the trailer */
+#define ZENFS_TAIL_MAGIC (0x5a54524c) /* ZTRL */
+#define ZENFS_TAIL_TRAILER_SIZE (32)
+/* The tail zone is searched backwards in reads of this size on mount */
+#define ZENFS_TAIL_SCAN_SIZE (1024 * 1024)
+
 namespace ROCKSDB_NAMESPACE {
 
 Status ZoneExtent::DecodeFrom(Slice* input) {
@@ -45,14 +78,96 @@ void ZoneExtent::EncodeTo(std::string* output) {
   PutFixed32(output, length_);
 }
 
+ZoneExtentTable::ZoneExtentTable(const std::vector<ZoneExtent*>& extents) {
+  uint64_t file_offset = 0;
+
+  entries_.reserve(extents.size());
+  file_offsets_.reserve(extents.size());
+  for (const auto extent : extents) {
+    Entry entry;
+    entry.extent_ = extent;
+    entry.start_ = extent->start_;
+    entry.length_ = extent->length_;
+    entries_.push_back(entry);
+    file_offsets_.push_back(file_offset);
+    file_offset += extent->length_;
+  }
+}
+
+void ZoneExtentTable::AddSynced(uint64_t start, uint32_t length) {
+  Entry entry;
+  entry.extent_ = nullptr;
+  entry.start_ = start;
+  entry.length_ = length;
+  file_offsets_.push_back(
+      entries_.empty() ? 0 : file_offsets_.back() + entries_.back().length_);
+  entries_.push_back(entry);
+}
+
+int ZoneExtentTable::Find(uint64_t file_offset) const {
+  auto it = std::upper_bound(file_offsets_.begin(), file_offsets_.end(),
+                             file_offset);
+  if (it == file_offsets_.begin()) return -1;
+
+  size_t i = (it - file_offsets_.begin()) - 1;
+  if (file_offset >= file_offsets_[i] + entries_[i].length_) return -1;
+  return static_cast<int>(i);
+}
+
 enum ZoneFileTag : uint32_t {
   kFileID = 1,
   kFileName = 2,
   kFileSize = 3,
   kWriteLifeTimeHint = 4,
   kExtent = 5,
+  kPlacement = 6,
+  kTimeBucket = 7,
+  kCreateTime = 8,
+  kLinkFileName = 9,
+  kSyncStart = 10,
+  kSyncTail = 11,
+  /* New length of the last extent of the previous record of the file */
+  kExtentLength = 12,
 };
 
+/* Level and key range of an SST, so zone placement survives a remount */
+void ZoneFile::EncodePlacementTo(std::string* output) {
+  PutFixed32(output, (uint32_t)level_);
+  PutLengthPrefixedSlice(output, smallest_.Encode());
+  PutLengthPrefixedSlice(output, largest_.Encode());
+}
+
+Status ZoneFile::DecodePlacementFrom(Slice* input) {
+  uint32_t level;
+  Slice smallest, largest;
+
+  if (!GetFixed32(input, &level) || !GetLengthPrefixedSlice(input, &smallest) ||
+      !GetLengthPrefixedSlice(input, &largest))
+    return Status::Corruption("ZoneFile", "Invalid placement");
+
+  level_ = (int)level;
+  smallest_.DecodeFrom(smallest);
+  largest_.DecodeFrom(largest);
+  return Status::OK();
+}
+
+void ZoneFile::ParseFileNumber() {
+  size_t base = filename_.find_last_of('/');
+  std::string fname = filename_.substr(base == std::string::npos ? 0 : base + 1);
+  size_t dot = fname.size() > 4 ? fname.size() - 4 : 0;
+
+  is_sst_ = false;
+  is_wal_ = fname.size() > 4 && fname.compare(dot, 4, ".log") == 0;
+  is_blob_ = fname.size() > 5 && fname.compare(fname.size() - 5, 5, ".blob") == 0;
+  fno_ = 0;
+  if (dot == 0 || fname.compare(dot, 4, ".sst") != 0) return;
+  for (size_t i = 0; i < dot; i++)
+    if (fname[i] < '0' || fname[i] > '9') return;
+
+  fno_ = std::stoull(fname.substr(0, dot));
+  is_sst_ = true;
+}
+
 void ZoneFile::EncodeTo(std::string* output, uint32_t extent_start) {
   PutFixed32(output, kFileID);
   PutFixed64(output, file_id_);
@@ -63,6 +178,38 @@ void ZoneFile::EncodeTo(std::string* output, uint32_t extent_start) {
   PutFixed32(output, kFileSize);
   PutFixed64(output, fileSize);
 
+  PutFixed32(output, kWriteLifeTimeHint);
+  PutFixed32(output, (uint32_t)lifetime_);
+
+  if (is_sst_ && level_ != 100 && smallest_.Valid() && largest_.Valid()) {
+    std::string placement_str;
+
+    PutFixed32(output, kPlacement);
+    EncodePlacementTo(&placement_str);
+    PutLengthPrefixedSlice(output, Slice(placement_str));
+  }
+
+  if (time_bucket_) {
+    PutFixed32(output, kTimeBucket);
+    PutFixed64(output, time_bucket_);
+  }
+
+  if (create_time_) {
+    PutFixed32(output, kCreateTime);
+    PutFixed64(output, create_time_);
+  }
+
+  for (const auto& name : linkfiles_) {
+    PutFixed32(output, kLinkFileName);
+    PutLengthPrefixedSlice(output, Slice(name));
+  }
+
+  if (extent_start > 0 && extent_start <= extents_.size() &&
+      extents_[extent_start - 1]->length_ != synced_extent_length_) {
+    PutFixed32(output, kExtentLength);
+    PutFixed32(output, extents_[extent_start - 1]->length_);
+  }
+
   for (uint32_t i = extent_start; i < extents_.size(); i++) {
     std::string extent_str;
 
@@ -71,8 +218,16 @@ void ZoneFile::EncodeTo(std::string* output, uint32_t extent_start) {
     PutLengthPrefixedSlice(output, Slice(extent_str));
   }
 
-  /* We're not encoding active zone and extent start
-   * as files will always be read-only after mount */
+  /* The active zone and extent start are only encoded for a WAL with data
+   * syncs, other files will always be read-only after mount */
+  if (data_sync_ && active_zone_) {
+    PutFixed32(output, kSyncStart);
+    PutFixed64(output, extent_start_);
+    if (tail_zone_) {
+      PutFixed32(output, kSyncTail);
+      PutFixed64(output, tail_zone_->start_);
+    }
+  }
 }
 
 Status ZoneFile::DecodeFrom(Slice* input) {
@@ -85,6 +240,7 @@ Status ZoneFile::DecodeFrom(Slice* input) {
   while (true) {
     Slice slice;
     ZoneExtent* extent;
+    uint32_t lt;
     Status s;
 
     if (!GetFixed32(input, &tag)) break;
@@ -96,11 +252,48 @@ Status ZoneFile::DecodeFrom(Slice* input) {
         filename_ = slice.ToString();
         if (filename_.length() == 0)
           return Status::Corruption("ZoneFile", "Zero length filename");
+        ParseFileNumber();
         break;
       case kFileSize:
         if (!GetFixed64(input, &fileSize))
           return Status::Corruption("ZoneFile", "Missing file size");
         break;
+      case kWriteLifeTimeHint:
+        if (!GetFixed32(input, &lt))
+          return Status::Corruption("ZoneFile", "Missing life time hint");
+        lifetime_ = (Env::WriteLifeTimeHint)lt;
+        break;
+      case kPlacement:
+        if (!GetLengthPrefixedSlice(input, &slice))
+          return Status::Corruption("ZoneFile", "Missing placement");
+        s = DecodePlacementFrom(&slice);
+        if (!s.ok()) return s;
+        break;
+      case kTimeBucket:
+        if (!GetFixed64(input, &time_bucket_))
+          return Status::Corruption("ZoneFile", "Missing time bucket");
+        break;
+      case kCreateTime:
+        if (!GetFixed64(input, &create_time_))
+          return Status::Corruption("ZoneFile", "Missing create time");
+        break;
+      case kLinkFileName:
+        if (!GetLengthPrefixedSlice(input, &slice) || slice.size() == 0)
+          return Status::Corruption("ZoneFile", "Invalid link filename");
+        linkfiles_.push_back(slice.ToString());
+        break;
+      case kSyncStart:
+        if (!GetFixed64(input, &sync_start_))
+          return Status::Corruption("ZoneFile", "Missing sync start");
+        break;
+      case kSyncTail:
+        if (!GetFixed64(input, &sync_tail_))
+          return Status::Corruption("ZoneFile", "Missing sync tail");
+        break;
+      case kExtentLength:
+        if (!GetFixed32(input, &last_extent_length_))
+          return Status::Corruption("ZoneFile", "Missing extent length");
+        break;
       case kExtent:
         extent = new ZoneExtent(0, 0, nullptr);
         GetLengthPrefixedSlice(input, &slice);
@@ -113,15 +306,19 @@ Status ZoneFile::DecodeFrom(Slice* input) {
         if (!extent->zone_)
           return Status::Corruption("ZoneFile", "Invalid zone extent");
         extent->zone_->used_capacity_ += extent->length_;
+        /* Encoded before the extents */
+        if (time_bucket_) extent->zone_->time_bucket_ = time_bucket_;
         extents_.push_back(extent);
         fprintf(stderr, "Push Extent info in ZoneFile::DecodeFrom\n");
-        extent->zone_->PushExtentInfo(new ZoneExtentInfo(extent, this, true, extent->length_,extent->start_, extent->zone_, filename_, this->lifetime_, this->level_));
+        extent->zone_->PushExtentInfo(
+            zbd_->GetExtentInfoPool()->New(extent, this, extent->length_));
         break;
       default:
         return Status::Corruption("ZoneFile", "Unexpected tag");
     }
   }
 
+  PublishExtents();
   MetadataSynced();
   return Status::OK();
 }
@@ -132,7 +329,34 @@ Status ZoneFile::MergeUpdate(ZoneFile* update) {
     return Status::Corruption("ZoneFile update", "ID missmatch");
 
   Rename(update->GetFilename());
+  linkfiles_ = update->linkfiles_;
   SetFileSize(update->GetFileSize());
+  ParseFileNumber();
+
+  lifetime_ = update->GetWriteLifeTimeHint();
+  if (update->time_bucket_) time_bucket_ = update->time_bucket_;
+  if (update->create_time_) create_time_ = update->create_time_;
+  if (update->level_ != 100) {
+    level_ = update->level_;
+    smallest_ = update->smallest_;
+    largest_ = update->largest_;
+  }
+  /* Cleared by the update of a closed file */
+  sync_start_ = update->sync_start_;
+  sync_tail_ = update->sync_tail_;
+
+  /* Appended to in place since the last update */
+  if (update->last_extent_length_) {
+    if (extents_.empty() ||
+        update->last_extent_length_ < extents_.back()->length_)
+      return Status::Corruption("ZoneFile update", "Invalid extent length");
+
+    ZoneExtent* last = extents_.back();
+    uint32_t grown = update->last_extent_length_ - last->length_;
+    last->length_ = update->last_extent_length_;
+    last->zone_->used_capacity_ += grown;
+    if (last->info_) last->zone_->GrowExtentInfo(last->info_, grown);
+  }
 
   std::vector<ZoneExtent*> update_extents = update->GetExtents();
   
@@ -143,12 +367,38 @@ Status ZoneFile::MergeUpdate(ZoneFile* update) {
     ZoneExtent* new_extent = new ZoneExtent(extent->start_,extent->length_, zone);
 
     extents_.push_back(new_extent);
-    fprintf(stderr, "Push Extent info in ZoneFile::MergeUpdate\n");
-    ZoneExtentInfo* new_extent_info = new ZoneExtentInfo(new_extent, this, true, extent->length_, new_extent->start_, new_extent->zone_, filename_, this->lifetime_, this->level_);
+    ZoneExtentInfo* new_extent_info =
+        zbd_->GetExtentInfoPool()->New(new_extent, this, extent->length_);
     zone->PushExtentInfo(new_extent_info);
 
   }
 
+  PublishExtents();
+  MetadataSynced();
+  return Status::OK();
+}
+
+Status ZoneFile::ReplaceWith(ZoneFile* snapshot) {
+  if (file_id_ != snapshot->GetID())
+    return Status::Corruption("ZoneFile snapshot", "ID missmatch");
+
+  Rename(snapshot->GetFilename());
+  linkfiles_ = snapshot->linkfiles_;
+  ParseFileNumber();
+
+  lifetime_ = snapshot->GetWriteLifeTimeHint();
+  time_bucket_ = snapshot->time_bucket_;
+  create_time_ = snapshot->create_time_;
+  level_ = snapshot->level_;
+  smallest_ = snapshot->smallest_;
+  largest_ = snapshot->largest_;
+  sync_start_ = snapshot->sync_start_;
+  sync_tail_ = snapshot->sync_tail_;
+
+  /* The size follows the extents, reads never go past the extent table */
+  extents_.swap(snapshot->extents_);
+  PublishExtents();
+  SetFileSize(snapshot->GetFileSize());
   MetadataSynced();
   return Status::OK();
 }
@@ -164,26 +414,58 @@ ZoneFile::ZoneFile(ZonedBlockDevice* zbd, std::string filename,
       filename_(filename),
       file_id_(file_id),
       nr_synced_extents_(0),
+      synced_extent_length_(0),
+      last_extent_length_(0),
+      data_sync_(false),
+      synced_length_(0),
+      tail_zone_(nullptr),
+      tail_start_(0),
+      tail_length_(0),
+      sync_zone_(nullptr),
+      sync_tail_zone_(nullptr),
+      sync_start_(0),
+      sync_tail_(0),
+      staged_sz_(0),
+      staged_pad_(0),
       level_(100),
       is_appending_(false),
       marked_for_del_(false),
       should_flush_full_buffer_(false),
+      streaming_(false),
+      is_blob_(false),
+      time_bucket_(0),
+      create_time_(0),
+      predicted_death_(0),
       extent_writer(false),
       extent_reader(0){
-        std::string fname_wo_path = filename_.substr(filename_.size() - 10);
-        if (fname_wo_path.substr(fname_wo_path.size() -3) == "sst") {
-            std::string fnostr = fname_wo_path.substr(0, 6);
-            fno_ = std::stoull(fnostr); 
-            is_sst_ = true;
-        } else {
-            is_sst_ = false;
-        }
+        extent_table_ = std::make_shared<const ZoneExtentTable>();
+        ParseFileNumber();
       }
 
 std::string ZoneFile::GetFilename() { return filename_; }
 
 void ZoneFile::Rename(std::string name) { filename_ = name; }
 
+void ZoneFile::RemoveLinkName(const std::string& name) {
+  assert(GetNrLinks() > 1);
+  if (name == filename_) {
+    filename_ = linkfiles_.front();
+    linkfiles_.erase(linkfiles_.begin());
+    ParseFileNumber();
+    return;
+  }
+  auto it = std::find(linkfiles_.begin(), linkfiles_.end(), name);
+  if (it != linkfiles_.end()) linkfiles_.erase(it);
+}
+
+void ZoneFile::RenameName(const std::string& from, const std::string& to) {
+  if (from == filename_) {
+    Rename(to);
+    return;
+  }
+  std::replace(linkfiles_.begin(), linkfiles_.end(), from, to);
+}
+
 uint64_t ZoneFile::GetFileSize() { return fileSize; }
 void ZoneFile::SetFileSize(uint64_t sz) { fileSize = sz; }
 
@@ -208,6 +490,8 @@ ZoneFile::~ZoneFile() {
     }
     zbd_->files_mtx_.unlock();
 
+    zbd_->RemoveSSTRange(fno_);
+
   }  
 
   for (auto e = std::begin(extents_); e != std::end(extents_); ++e) {
@@ -221,6 +505,7 @@ ZoneFile::~ZoneFile() {
     delete *e;
   }
   zbd_->zone_cleaning_mtx.unlock();
+  ReleaseStagedChunks();
   CloseWR();
 }
 
@@ -229,34 +514,66 @@ void ZoneFile::CloseWR() {
     active_zone_->CloseWR();
     active_zone_ = NULL;
   }
+  for (const auto z : stripes_) z->CloseWR();
+  stripes_.clear();
+  if (tail_zone_) {
+    zbd_->ReleaseWALTail(tail_zone_);
+    tail_zone_ = nullptr;
+  }
 }
 
 ZoneExtent* ZoneFile::GetExtent(uint64_t file_offset, uint64_t* dev_offset) {
-  ExtentReadLock();
-  for (unsigned int i = 0; i < extents_.size(); i++) {
-    if (file_offset < extents_[i]->length_) {
-      *dev_offset = extents_[i]->start_ + file_offset;
-      ExtentReadUnlock();
-      return extents_[i];
-    } else {
-      file_offset -= extents_[i]->length_;
-    }
-  }
-  ExtentReadUnlock();
-  return NULL;
+  std::shared_ptr<const ZoneExtentTable> table = GetExtentTable();
+  int i = table->Find(file_offset);
+
+  if (i < 0) return NULL;
+  *dev_offset = (*table)[i].start_ + (file_offset - table->FileOffset(i));
+  return (*table)[i].extent_;
+}
+
+void ZoneFile::PublishExtents() {
+  /* Zone cleaning waits for the last reader of a replaced table */
+  ZonedBlockDevice* zbd = zbd_;
+  ZoneExtentTable* extent_table = new ZoneExtentTable(extents_);
+  if (synced_length_) extent_table->AddSynced(extent_start_, synced_length_);
+  if (tail_length_) extent_table->AddSynced(tail_start_, tail_length_);
+  std::shared_ptr<const ZoneExtentTable> table(
+      extent_table, [zbd](const ZoneExtentTable* t) {
+        delete t;
+        zbd->ExtentTableFreed();
+      });
+  std::atomic_store(&extent_table_, table);
+}
+
+std::shared_ptr<const ZoneExtentTable> ZoneFile::UpdateExtents(
+    std::vector<ZoneExtent*>& a) {
+  std::shared_ptr<const ZoneExtentTable> old_table = GetExtentTable();
+
+  extents_ = a;
+  PublishExtents();
+  return old_table;
+}
+
+/* hops is the number of extent boundaries crossed by a single read */
+static void RecordExtentHops(Statistics* stats, uint64_t hops) {
+  IOSTATS_ADD_IF_POSITIVE(zenfs_extent_hops, hops);
+  if (!stats) return;
+  RecordInHistogram(stats, ZENFS_EXTENT_HOPS_PER_READ, hops);
+  if (hops) RecordTick(stats, ZENFS_READ_EXTENT_HOPS, hops);
 }
 
 IOStatus ZoneFile::PositionedRead(uint64_t offset, size_t n, Slice* result,
-                                  char* scratch, bool direct) {
-  int f = zbd_->GetReadFD();
-  int f_direct = zbd_->GetReadDirectFD();
+                                  char* scratch, bool direct,
+                                  ZoneIOClass io_class) {
+  ZbdDevice* dev;
   char* ptr;
   uint64_t r_off;
   size_t r_sz;
   ssize_t r = 0;
   size_t read = 0;
-  ZoneExtent* extent;
+  int extent;
   uint64_t extent_end;
+  uint64_t hops = 0;
   IOStatus s;
 
   if (offset >= fileSize) {
@@ -264,14 +581,23 @@ IOStatus ZoneFile::PositionedRead(uint64_t offset, size_t n, Slice* result,
     return IOStatus::OK();
   }
 
-  r_off = 0;
-  extent = GetExtent(offset, &r_off);
-  if (!extent) {
+  /* Hold on to one snapshot of the extent list for the whole read */
+  std::shared_ptr<const ZoneExtentTable> table = GetExtentTable();
+  extent = table->Find(offset);
+  if (extent < 0) {
     /* read start beyond end of (synced) file data*/
     *result = Slice(scratch, 0);
     return s;
   }
-  extent_end = extent->start_ + extent->length_;
+  r_off = (*table)[extent].start_ + (offset - table->FileOffset(extent));
+  extent_end = (*table)[extent].start_ + (*table)[extent].length_;
+  /* Extents written back to back in a zone are read with one pread */
+  while (extent + 1 < (int)table->size() &&
+         (*table)[extent + 1].start_ == extent_end &&
+         extent_end % zbd_->GetZoneSize() != 0) {
+    extent++;
+    extent_end += (*table)[extent].length_;
+  }
 
   /* Limit read size to end of file */
   if ((offset + n) > fileSize)
@@ -286,20 +612,36 @@ IOStatus ZoneFile::PositionedRead(uint64_t offset, size_t n, Slice* result,
 
     if ((pread_sz + r_off) > extent_end) pread_sz = extent_end - r_off;
 
-    if (direct) {
-      assert((uint64_t)ptr % GetBlockSize() == 0);
-      assert(pread_sz % GetBlockSize() == 0);
-      assert(r_off % GetBlockSize() == 0);
-      r = pread(f_direct, ptr, pread_sz, r_off);
+    uint32_t seq = 0;
+    if (zbd_->ReadCacheLookup(r_off, pread_sz, ptr, &seq)) {
+      r = pread_sz;
     } else {
-      r = pread(f, ptr, pread_sz, r_off);
-    }
+      /* An extent never crosses a zone, so it is on one device */
+      dev = zbd_->GetDevice(r_off);
+      {
+        /* Traced requests get a span per extent read */
+        SpanTimer span_timer("zenfs_extent_read");
+        ZoneIOScope io(zbd_, io_class);
+        if (direct) {
+          assert((uint64_t)ptr % GetBlockSize() == 0);
+          assert(pread_sz % GetBlockSize() == 0);
+          assert(r_off % GetBlockSize() == 0);
+          r = pread(dev->read_direct_f_, ptr, pread_sz, dev->Offset(r_off));
+        } else {
+          r = pread(dev->read_f_, ptr, pread_sz, dev->Offset(r_off));
+        }
+      }
 
-    if (r <= 0) {
-      if (r == -1 && errno == EINTR) {
-        continue;
+      if (r <= 0) {
+        if (r == -1 && errno == EINTR) {
+          continue;
+        }
+        break;
       }
-      break;
+
+      if (dev->emu_) dev->emu_->Read((size_t)r);
+      if ((size_t)r == pread_sz)
+        zbd_->ReadCacheInsert(r_off, ptr, pread_sz, seq);
     }
 
     pread_sz = (size_t)r;
@@ -309,16 +651,24 @@ IOStatus ZoneFile::PositionedRead(uint64_t offset, size_t n, Slice* result,
     r_off += pread_sz;
 
     if (read != r_sz && r_off == extent_end) {
-      extent = GetExtent(offset + read, &r_off);
-      if (!extent) {
+      extent++;
+      if (extent >= (int)table->size()) {
         /* read beyond end of (synced) file data */
         break;
       }
-      r_off = extent->start_;
-      extent_end = extent->start_ + extent->length_;
+      r_off = (*table)[extent].start_;
+      extent_end = (*table)[extent].start_ + (*table)[extent].length_;
+      while (extent + 1 < (int)table->size() &&
+             (*table)[extent + 1].start_ == extent_end &&
+             extent_end % zbd_->GetZoneSize() != 0) {
+        extent++;
+        extent_end += (*table)[extent].length_;
+      }
       assert(((size_t)r_off % zbd_->GetBlockSize()) == 0);
+      hops++;
     }
   }
+  RecordExtentHops(zbd_->GetStatistics(), hops);
 
   if (r < 0) {
     s = IOStatus::IOError("pread error\n");
@@ -329,6 +679,302 @@ IOStatus ZoneFile::PositionedRead(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+/* Read exactly n bytes, used to complete short io_uring reads */
+static ssize_t PReadFully(int fd, char* buf, size_t n, uint64_t offset) {
+  size_t read = 0;
+
+  while (read < n) {
+    ssize_t r = pread(fd, buf + read, n - read, offset + read);
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) return r;
+    read += r;
+  }
+  return read;
+}
+
+IOStatus ZoneFile::MultiRead(FSReadRequest* reqs, size_t num_reqs,
+                             bool direct, struct io_uring* iu) {
+  /* A device read covering the part of one request that lives in one
+   * extent. Requests crossing extent boundaries turn into several of these */
+  struct ExtentReadRequest {
+    FSReadRequest* req;
+    struct iovec iov;
+    ZbdDevice* dev;
+    uint64_t dev_offset;
+  };
+
+  autovector<ExtentReadRequest, 32> ext_reqs;
+  autovector<size_t, 32> req_sz;
+  std::shared_ptr<const ZoneExtentTable> table = GetExtentTable();
+
+  for (size_t i = 0; i < num_reqs; i++) {
+    FSReadRequest* req = &reqs[i];
+    size_t r_sz = 0;
+    size_t mapped = 0;
+
+    req->status = IOStatus::OK();
+
+    /* Limit read size to end of file */
+    if (req->offset < fileSize) {
+      r_sz = req->len;
+      if ((req->offset + r_sz) > fileSize) r_sz = fileSize - req->offset;
+    }
+
+    int e = (r_sz > 0) ? table->Find(req->offset) : -1;
+    size_t first = ext_reqs.size();
+    while (e >= 0 && mapped < r_sz && e < (int)table->size()) {
+      const ZoneExtentTable::Entry& extent = (*table)[e];
+      uint64_t extent_off = req->offset + mapped - table->FileOffset(e);
+      size_t chunk =
+          std::min<uint64_t>(r_sz - mapped, extent.length_ - extent_off);
+      ExtentReadRequest ext_req;
+
+      if (direct) {
+        assert(((extent.start_ + extent_off) % GetBlockSize()) == 0);
+      }
+
+      ext_req.req = req;
+      ext_req.iov.iov_base = req->scratch + mapped;
+      ext_req.iov.iov_len = chunk;
+      ext_req.dev = zbd_->GetDevice(extent.start_);
+      ext_req.dev_offset = ext_req.dev->Offset(extent.start_ + extent_off);
+      ext_reqs.push_back(ext_req);
+
+      mapped += chunk;
+      e++;
+    }
+    if (mapped)
+      RecordExtentHops(zbd_->GetStatistics(), ext_reqs.size() - first - 1);
+
+    /* Data beyond the last synced extent reads as end of file */
+    req_sz.push_back(mapped);
+  }
+
+  size_t reqs_off = 0;
+  while (reqs_off < ext_reqs.size()) {
+    size_t this_reqs = ext_reqs.size() - reqs_off;
+
+    /* If requests exceed depth, split it into batches */
+    if (this_reqs > kIoUringDepth) this_reqs = kIoUringDepth;
+
+    for (size_t i = 0; i < this_reqs; i++) {
+      ExtentReadRequest* ext_req = &ext_reqs[reqs_off + i];
+      struct io_uring_sqe* sqe = io_uring_get_sqe(iu);
+
+      int f = direct ? ext_req->dev->read_direct_f_ : ext_req->dev->read_f_;
+      io_uring_prep_readv(sqe, f, &ext_req->iov, 1, ext_req->dev_offset);
+      io_uring_sqe_set_data(sqe, ext_req);
+    }
+
+    ssize_t ret =
+        io_uring_submit_and_wait(iu, static_cast<unsigned int>(this_reqs));
+    if (ret < 0 || static_cast<size_t>(ret) != this_reqs) {
+      for (size_t i = 0; i < num_reqs; i++) {
+        reqs[i].result = Slice(reqs[i].scratch, 0);
+        reqs[i].status = IOStatus::IOError("io_uring submit failed\n");
+      }
+      return IOStatus::IOError("io_uring submit failed\n");
+    }
+
+    for (size_t i = 0; i < this_reqs; i++) {
+      struct io_uring_cqe* cqe;
+      ExtentReadRequest* ext_req;
+
+      ret = io_uring_wait_cqe(iu, &cqe);
+      assert(!ret);
+
+      ext_req = static_cast<ExtentReadRequest*>(io_uring_cqe_get_data(cqe));
+      if (cqe->res < 0) {
+        ext_req->req->status = IOStatus::IOError("pread error\n");
+      } else if (static_cast<size_t>(cqe->res) < ext_req->iov.iov_len) {
+        /* Short read, complete the remainder synchronously */
+        size_t done = static_cast<size_t>(cqe->res);
+        int f = direct ? ext_req->dev->read_direct_f_ : ext_req->dev->read_f_;
+        ssize_t r = PReadFully(f, (char*)ext_req->iov.iov_base + done,
+                               ext_req->iov.iov_len - done,
+                               ext_req->dev_offset + done);
+        if (r < 0 || static_cast<size_t>(r) != ext_req->iov.iov_len - done)
+          ext_req->req->status = IOStatus::IOError("pread error\n");
+      }
+      io_uring_cqe_seen(iu, cqe);
+    }
+    for (const auto& dev : zbd_->GetDevices()) {
+      if (!dev->emu_) continue;
+      /* The batch is in flight at once, one latency per device for it */
+      uint64_t batch_sz = 0;
+      for (size_t i = 0; i < this_reqs; i++)
+        if (ext_reqs[reqs_off + i].dev == dev.get())
+          batch_sz += ext_reqs[reqs_off + i].iov.iov_len;
+      if (batch_sz) dev->emu_->Read(batch_sz);
+    }
+    reqs_off += this_reqs;
+  }
+
+  for (size_t i = 0; i < num_reqs; i++) {
+    if (reqs[i].status.ok())
+      reqs[i].result = Slice(reqs[i].scratch, req_sz[i]);
+    else
+      reqs[i].result = Slice(reqs[i].scratch, 0);
+  }
+
+  return IOStatus::OK();
+}
+
+namespace {
+/* A read started by ZoneFile::ReadAsync(), with one device read for the
+ * part of the request in each extent it spans */
+struct ZenFSIOHandle {
+  struct ExtentRead {
+    ZenFSIOHandle* handle;
+    struct iovec iov;
+    ZbdDevice* dev;
+    int fd;
+    uint64_t dev_offset;
+  };
+
+  struct io_uring* iu;
+  FSReadRequest req;
+  std::function<void(const FSReadRequest&, void*)> cb;
+  void* cb_arg;
+  /* Bytes of the request mapped to extents */
+  size_t mapped;
+  std::vector<ExtentRead> ext_reads;
+  size_t pending;
+};
+
+void FinishExtentRead(ZenFSIOHandle::ExtentRead* ext_read, int res) {
+  ZenFSIOHandle* handle = ext_read->handle;
+  FSReadRequest& req = handle->req;
+
+  if (res < 0) {
+    req.status = IOStatus::IOError("pread error\n");
+  } else if (static_cast<size_t>(res) < ext_read->iov.iov_len) {
+    /* Short read, complete the remainder synchronously */
+    size_t done = static_cast<size_t>(res);
+    ssize_t r = PReadFully(ext_read->fd, (char*)ext_read->iov.iov_base + done,
+                           ext_read->iov.iov_len - done,
+                           ext_read->dev_offset + done);
+    if (r < 0 || static_cast<size_t>(r) != ext_read->iov.iov_len - done)
+      req.status = IOStatus::IOError("pread error\n");
+  }
+  if (ext_read->dev->emu_) ext_read->dev->emu_->Read(ext_read->iov.iov_len);
+
+  if (--handle->pending == 0) {
+    req.result = Slice(req.scratch, req.status.ok() ? handle->mapped : 0);
+    handle->cb(req, handle->cb_arg);
+  }
+}
+}  // namespace
+
+IOStatus ZoneFile::ReadAsync(
+    FSReadRequest& req, bool direct, struct io_uring* iu,
+    std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn) {
+  std::shared_ptr<const ZoneExtentTable> table = GetExtentTable();
+  std::unique_ptr<ZenFSIOHandle> handle(new ZenFSIOHandle());
+  size_t r_sz = 0;
+  size_t mapped = 0;
+
+  /* Limit read size to end of file */
+  if (req.offset < fileSize) {
+    r_sz = req.len;
+    if ((req.offset + r_sz) > fileSize) r_sz = fileSize - req.offset;
+  }
+
+  int e = (r_sz > 0) ? table->Find(req.offset) : -1;
+  while (e >= 0 && mapped < r_sz && e < (int)table->size()) {
+    const ZoneExtentTable::Entry& extent = (*table)[e];
+    uint64_t extent_off = req.offset + mapped - table->FileOffset(e);
+    size_t chunk =
+        std::min<uint64_t>(r_sz - mapped, extent.length_ - extent_off);
+    ZenFSIOHandle::ExtentRead ext_read;
+
+    if (direct) {
+      assert(((extent.start_ + extent_off) % GetBlockSize()) == 0);
+    }
+
+    ext_read.handle = handle.get();
+    ext_read.iov.iov_base = req.scratch + mapped;
+    ext_read.iov.iov_len = chunk;
+    ext_read.dev = zbd_->GetDevice(extent.start_);
+    ext_read.fd = direct ? ext_read.dev->read_direct_f_ : ext_read.dev->read_f_;
+    ext_read.dev_offset = ext_read.dev->Offset(extent.start_ + extent_off);
+    handle->ext_reads.push_back(ext_read);
+
+    mapped += chunk;
+    e++;
+  }
+
+  if (handle->ext_reads.empty()) {
+    /* Data beyond the last synced extent reads as end of file */
+    req.status = IOStatus::OK();
+    req.result = Slice(req.scratch, 0);
+    cb(req, cb_arg);
+    return IOStatus::OK();
+  }
+
+  autovector<struct io_uring_sqe*, 8> sqes;
+  for (size_t i = 0; i < handle->ext_reads.size(); i++) {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(iu);
+    if (sqe == nullptr) {
+      /* The entries already taken get submitted later, make them no-ops */
+      for (auto* taken : sqes) {
+        io_uring_prep_nop(taken);
+        io_uring_sqe_set_data(taken, nullptr);
+      }
+      return IOStatus::Busy("io_uring submission queue full\n");
+    }
+    sqes.push_back(sqe);
+  }
+  RecordExtentHops(zbd_->GetStatistics(), handle->ext_reads.size() - 1);
+
+  handle->iu = iu;
+  handle->req = req;
+  handle->req.status = IOStatus::OK();
+  handle->cb = cb;
+  handle->cb_arg = cb_arg;
+  handle->mapped = mapped;
+  handle->pending = handle->ext_reads.size();
+  for (size_t i = 0; i < sqes.size(); i++) {
+    ZenFSIOHandle::ExtentRead* ext_read = &handle->ext_reads[i];
+    io_uring_prep_readv(sqes[i], ext_read->fd, &ext_read->iov, 1,
+                        ext_read->dev_offset);
+    io_uring_sqe_set_data(sqes[i], ext_read);
+  }
+  /* If this fails, PollAsyncReads() submits the reads */
+  io_uring_submit(iu);
+
+  *io_handle = handle.release();
+  *del_fn = [](void* h) { delete static_cast<ZenFSIOHandle*>(h); };
+  return IOStatus::OK();
+}
+
+IOStatus ZoneFile::PollAsyncReads(std::vector<void*>& io_handles) {
+  for (void* io_handle : io_handles) {
+    ZenFSIOHandle* handle = static_cast<ZenFSIOHandle*>(io_handle);
+
+    while (handle->pending > 0) {
+      struct io_uring_cqe* cqe = nullptr;
+      int ret = io_uring_submit_and_wait(handle->iu, 1);
+
+      if (ret == -EINTR) continue;
+      if (ret < 0) return IOStatus::IOError("io_uring submit failed\n");
+      if (io_uring_peek_cqe(handle->iu, &cqe) != 0 || cqe == nullptr)
+        continue;
+
+      /* Completions of other handles on this instance are reaped too */
+      auto* ext_read =
+          static_cast<ZenFSIOHandle::ExtentRead*>(io_uring_cqe_get_data(cqe));
+      int res = cqe->res;
+      io_uring_cqe_seen(handle->iu, cqe);
+      if (ext_read) FinishExtentRead(ext_read, res);
+    }
+  }
+  return IOStatus::OK();
+}
+#endif  // defined(ROCKSDB_IOURING_PRESENT)
+
 void ZoneFile::PushExtent() {
   uint64_t length;
   assert(fileSize >= extent_filepos_);
@@ -342,29 +988,52 @@ void ZoneFile::PushExtent() {
     return;  
   }
   assert(length <= (active_zone_->wp_ - extent_start_));
+  /* Covered by the extent now */
+  synced_length_ = 0;
+  AddExtent(active_zone_, extent_start_, length);
+  extent_start_ = active_zone_->wp_;
+  extent_filepos_ = fileSize;
+  active_zone_->is_append.store(false);
+}
+
+void ZoneFile::AddExtent(Zone* zone, uint64_t start, uint64_t length) {
   ExtentWriteLock();
 
-  ZoneExtent * new_extent = new ZoneExtent(extent_start_, length, active_zone_); 
+  /* Only if no padding or data of another extent sits in between, and the
+   * extent is still the file's own in the zone */
+  ZoneExtent* last = extents_.empty() ? nullptr : extents_.back();
+  if (last && last->zone_ == zone && last->start_ + last->length_ == start &&
+      last->length_ + length <= std::numeric_limits<uint32_t>::max() &&
+      last->info_ && last->info_->extent_ == last) {
+    last->length_ += length;
+    PublishExtents();
+    zone->GrowExtentInfo(last->info_, length);
+
+    ExtentWriteUnlock();
+    zone->used_capacity_ += length;
+    zone->Account();
+    zbd_->NotifyExtentAppended(length);
+    return;
+  }
+
+  ZoneExtent * new_extent = new ZoneExtent(start, length, zone); 
   extents_.push_back(new_extent);
+  PublishExtents();
   //(ZC) Add inforamtion about currently written extent into the Zone. So that make it easier to track validity of the extents in zone in processing Zone Cleaning
   if (is_sst_) {
-    auto search = zbd_->sst_to_zone_.find(fno_);
-    if (search == zbd_->sst_to_zone_.end()){
-      zbd_->sst_zone_mtx_.lock();
-      zbd_->sst_to_zone_.insert(std::pair<uint64_t, std::vector<int> >(fno_, {active_zone_->zone_id_}));
-    } else {
-      zbd_->sst_zone_mtx_.lock();
-      zbd_->sst_to_zone_[fno_].push_back(active_zone_->zone_id_);
-    }
+    zbd_->sst_zone_mtx_.lock();
+    std::vector<int>& zids = zbd_->sst_to_zone_[fno_];
+    if (std::find(zids.begin(), zids.end(), zone->zone_id_) == zids.end())
+      zids.push_back(zone->zone_id_);
     zbd_->sst_zone_mtx_.unlock();
   }
-  active_zone_->PushExtentInfo(new ZoneExtentInfo(new_extent, this, true, length, new_extent->start_, new_extent->zone_, filename_, this->lifetime_, this->level_));
+  zone->PushExtentInfo(
+      zbd_->GetExtentInfoPool()->New(new_extent, this, length));
 
   ExtentWriteUnlock();
-  active_zone_->used_capacity_ += length;
-  extent_start_ = active_zone_->wp_;
-  extent_filepos_ = fileSize;
-  active_zone_->is_append.store(false);
+  zone->used_capacity_ += length;
+  zone->Account();
+  zbd_->NotifyExtentAppended(length);
 }
 
 void ZoneFile::ExtentReadLock(){
@@ -408,44 +1077,60 @@ void ZoneFile::ExtentWriteUnlock(){
  extent_cv.notify_one();
 }
 
+/* Copies the data into pooled staging chunks, this is the only copy the
+ * data goes through before it is written to the zone */
 IOStatus ZoneFile::FullBuffer(void* data, int data_size, int valid_size) {
-    Buffer * buf = new Buffer(data, data_size, valid_size, GetBlockSize());
-    full_buffer_.push_back(buf);
+  AlignedChunkPool* pool = zbd_->GetBufferPool();
+  uint32_t chunk_sz = pool->GetChunkSize();
+  char* src = (char*)data;
+  uint32_t left = data_size;
 
-    return IOStatus::OK();
+  while (left) {
+    if (full_buffer_.empty() || full_buffer_.back().size_ == chunk_sz) {
+      StagedChunk chunk;
+      chunk.data_ = pool->Allocate();
+      chunk.size_ = 0;
+      if (chunk.data_ == nullptr)
+        return IOStatus::IOError("failed allocating staging buffer\n");
+      full_buffer_.push_back(chunk);
+    }
+
+    StagedChunk& chunk = full_buffer_.back();
+    uint32_t n = std::min(left, chunk_sz - chunk.size_);
+    memcpy(chunk.data_ + chunk.size_, src, n);
+    chunk.size_ += n;
+    src += n;
+    left -= n;
+  }
+  staged_sz_ += data_size;
+  staged_pad_ += data_size - valid_size;
+
+  return IOStatus::OK();
 }
 
-/* Assumes that data and size are block aligned */
-IOStatus ZoneFile::AppendBuffer() {
-  
-  char * data;
-  uint32_t data_size = 0;
-  int valid_size = 0;
-  uint32_t buf_offset = 0;
+void ZoneFile::ReleaseStagedChunks() {
+  AlignedChunkPool* pool = zbd_->GetBufferPool();
 
-  for(const auto& b : full_buffer_) {
-    data_size += b->buffer_size_;
-    valid_size += b->valid_size_;
-  }
-  
-  int ret = posix_memalign((void**)&data, GetBlockSize(), data_size);
-  if (ret) {
-    fprintf(stderr, "failed allocating alignment write buffer\n");
-    exit(1);
-  }
-  assert(data != NULL);
+  for (auto& c : full_buffer_) pool->Release(c.data_);
+  full_buffer_.clear();
+  staged_sz_ = 0;
+  staged_pad_ = 0;
+}
 
-  for(const auto& b : full_buffer_) {
-    memcpy(data + buf_offset, b->buffer_, b->buffer_size_);
-    buf_offset += b->buffer_size_;
-  }
-  
-  uint32_t left = data_size;
-  uint32_t wr_size, offset = 0;
+/* Writes the staged chunks straight from the pool with gathering appends.
+ * Assumes that each chunk size is block aligned */
+IOStatus ZoneFile::AppendBuffer() {
+  uint64_t left = 0;
+  size_t ci = 0;
+  uint32_t chunk_off = 0;
   IOStatus s;
 
+  if (zbd_->GetStripeWidth() > 1) return AppendBufferStriped();
+
+  for (const auto& c : full_buffer_) left += c.size_;
+
   if (active_zone_ == NULL) {
-    active_zone_ = zbd_->AllocateZone(lifetime_, smallest_, largest_, level_);
+    active_zone_ = AllocateDataZone();
 
     if(!active_zone_) {
        return IOStatus::NoSpace("Zone allocation failure\n");
@@ -458,7 +1143,7 @@ IOStatus ZoneFile::AppendBuffer() {
     if (active_zone_->capacity_ == 0) {
       PushExtent(); 
       active_zone_->CloseWR();
-      active_zone_ = zbd_->AllocateZone(lifetime_, smallest_, largest_, level_);
+      active_zone_ = AllocateDataZone();
       if(!active_zone_) {
          return IOStatus::NoSpace("Zone allocation failure\n");
       }
@@ -466,29 +1151,134 @@ IOStatus ZoneFile::AppendBuffer() {
       extent_filepos_ = fileSize;
     }
 
-    wr_size = left;
-    if (wr_size > active_zone_->capacity_) wr_size = active_zone_->capacity_;
-    s = active_zone_->Append((char*)data + offset, wr_size);
+    /* Gather as many staged chunks as fit in the active zone */
+    autovector<struct iovec, 64> iov;
+    uint64_t wr_size = 0;
+    while (ci < full_buffer_.size() && wr_size < active_zone_->capacity_ &&
+           iov.size() < IOV_MAX) {
+      StagedChunk& c = full_buffer_[ci];
+      uint64_t take = std::min<uint64_t>(c.size_ - chunk_off,
+                                         active_zone_->capacity_ - wr_size);
+      struct iovec v;
+      v.iov_base = c.data_ + chunk_off;
+      v.iov_len = take;
+      iov.push_back(v);
+
+      wr_size += take;
+      chunk_off += take;
+      if (chunk_off == c.size_) {
+        ci++;
+        chunk_off = 0;
+      }
+    }
 
+    s = active_zone_->Append(&iov[0], iov.size());
     if (!s.ok()){ 
         return s;
     }
 
     fileSize += wr_size;
     left -= wr_size;
-    offset += wr_size;
   }
-  fileSize -= (data_size - valid_size);
-  
-  delete data;
-  
-  for(auto& b : full_buffer_) {
-    delete b->buffer_;
+  fileSize -= staged_pad_;
+
+  ReleaseStagedChunks();
+  return IOStatus::OK();
+}
+/* Every staged chunk becomes an extent in the next stripe, so all stripes
+ * are written in parallel. Extra stripes are only opened while below the
+ * open zone limit, placement picks them like any other zone for the file
+ * and so keeps them near the overlapping SSTs */
+IOStatus ZoneFile::AppendBufferStriped() {
+  uint32_t width = zbd_->GetStripeWidth();
+  size_t ci = 0;
+  uint32_t chunk_off = 0;
+  IOStatus s;
+
+  while (ci < full_buffer_.size()) {
+    while (stripes_.size() < width) {
+      Zone* z = AllocateDataZone(stripes_.empty());
+      if (!z) break;
+      stripes_.push_back(z);
+    }
+    if (stripes_.empty()) return IOStatus::NoSpace("Zone allocation failure\n");
+
+    std::vector<Zone*> zones;
+    std::vector<struct iovec> iovs;
+    std::vector<uint64_t> starts;
+    for (const auto z : stripes_) {
+      if (ci == full_buffer_.size()) break;
+      if (z->capacity_ == 0) continue;
+
+      StagedChunk& c = full_buffer_[ci];
+      uint64_t take = std::min<uint64_t>(c.size_ - chunk_off, z->capacity_);
+      struct iovec v;
+      v.iov_base = c.data_ + chunk_off;
+      v.iov_len = take;
+      zones.push_back(z);
+      iovs.push_back(v);
+      starts.push_back(z->wp_);
+
+      chunk_off += take;
+      if (chunk_off == c.size_) {
+        ci++;
+        chunk_off = 0;
+      }
+    }
+
+    if (!zones.empty()) {
+      s = zbd_->AppendStripes(zones, iovs);
+      if (!s.ok()) return s;
+    }
+
+    for (size_t i = 0; i < zones.size(); i++) {
+      uint64_t length = iovs[i].iov_len;
+      /* Padding only trails the last staged chunk */
+      if (ci == full_buffer_.size() && i == zones.size() - 1)
+        length -= staged_pad_;
+      if (length) AddExtent(zones[i], starts[i], length);
+      fileSize += length;
+    }
+
+    for (auto it = stripes_.begin(); it != stripes_.end();) {
+      if ((*it)->capacity_ == 0) {
+        (*it)->CloseWR();
+        it = stripes_.erase(it);
+      } else {
+        it++;
+      }
+    }
   }
-  
-  full_buffer_.clear();  
+
+  ReleaseStagedChunks();
+  return IOStatus::OK();
+}
+
+Zone* ZoneFile::AllocateDataZone(bool may_wait) {
+  if (is_wal_) return zbd_->AllocateWALZone(lifetime_);
+  ZoneAdmission admission = ZonedBlockDevice::AdmissionForLevel(level_);
+  if (time_bucket_)
+    return zbd_->AllocateBucketZone(time_bucket_, lifetime_, may_wait,
+                                    admission);
+  return zbd_->AllocateZone(lifetime_, smallest_, largest_, level_, may_wait,
+                            predicted_death_, admission);
+}
+
+IOStatus ZoneFile::EnsureActiveZone() {
+  if (active_zone_ && active_zone_->capacity_ > 0) return IOStatus::OK();
+
+  if (active_zone_) {
+    PushExtent();
+    active_zone_->CloseWR();
+  }
+  active_zone_ = AllocateDataZone();
+  if (!active_zone_) return IOStatus::NoSpace("Zone allocation failure\n");
+
+  extent_start_ = active_zone_->wp_;
+  extent_filepos_ = fileSize;
   return IOStatus::OK();
 }
+
 /* Assumes that data and size are block aligned */
 IOStatus ZoneFile::Append(void* data, int data_size, int valid_size) {
   
@@ -497,34 +1287,24 @@ IOStatus ZoneFile::Append(void* data, int data_size, int valid_size) {
         FullBuffer(data, data_size, valid_size);
         return AppendBuffer();
       } else {
-        return FullBuffer(data, data_size, valid_size);
+        IOStatus s = FullBuffer(data, data_size, valid_size);
+        /* The zone is picked from the hint, no need to wait for Finish() */
+        if (s.ok() && streaming_ &&
+            staged_sz_ >= zbd_->GetStreamingBufferSize())
+          return AppendBuffer();
+        return s;
       }
   } 
   uint32_t left = data_size;
   uint32_t wr_size, offset = 0;
   IOStatus s;
 
-  if (active_zone_ == NULL) {
-    active_zone_ = zbd_->AllocateZone(lifetime_, smallest_, largest_, level_);
-
-    if(!active_zone_) {
-       return IOStatus::NoSpace("Zone allocation failure\n");
-    }
-    extent_start_ = active_zone_->wp_;
-    extent_filepos_ = fileSize;
-  }
+  /* The data starts with the tail again */
+  if (tail_zone_) DropTail();
 
   while (left) {
-    if (active_zone_->capacity_ == 0) {
-      PushExtent(); 
-      active_zone_->CloseWR();
-      active_zone_ = zbd_->AllocateZone(lifetime_, smallest_, largest_, level_);
-      if(!active_zone_) {
-         return IOStatus::NoSpace("Zone allocation failure\n");
-      }
-      extent_start_ = active_zone_->wp_;
-      extent_filepos_ = fileSize;
-    }
+    s = EnsureActiveZone();
+    if (!s.ok()) return s;
 
     wr_size = left;
     if (wr_size > active_zone_->capacity_) wr_size = active_zone_->capacity_;
@@ -542,6 +1322,158 @@ IOStatus ZoneFile::Append(void* data, int data_size, int valid_size) {
   return IOStatus::OK();
 }
 
+static uint32_t TailChecksum(const char* data, uint32_t size,
+                             const char* trailer) {
+  uint32_t crc = crc32c::Value(data, size);
+  crc = crc32c::Extend(crc, trailer, ZENFS_TAIL_TRAILER_SIZE - 4);
+  return crc32c::Mask(crc);
+}
+
+IOStatus ZoneFile::SyncTail(char* data, uint32_t size) {
+  uint32_t block_sz = GetBlockSize();
+  Zone* zone = nullptr;
+  uint64_t start = 0;
+  IOStatus s;
+
+  assert(size < block_sz);
+  /* The tail is written to the active zone next */
+  s = EnsureActiveZone();
+  if (!s.ok()) return s;
+
+  if (size) {
+    uint32_t sealed_sz =
+        (size + ZENFS_TAIL_TRAILER_SIZE + block_sz - 1) / block_sz * block_sz;
+    char* trailer = data + sealed_sz - ZENFS_TAIL_TRAILER_SIZE;
+
+    memset(data + size, 0, sealed_sz - size);
+    EncodeFixed32(trailer, ZENFS_TAIL_MAGIC);
+    EncodeFixed32(trailer + 4, size);
+    EncodeFixed64(trailer + 8, file_id_);
+    EncodeFixed64(trailer + 16, active_zone_->wp_);
+    EncodeFixed32(trailer + 28, TailChecksum(data, size, trailer));
+    s = zbd_->AppendWALTail(data, sealed_sz, &zone, &start);
+    if (!s.ok()) return s;
+  }
+
+  Zone* old_tail_zone = tail_zone_;
+  ExtentWriteLock();
+  fileSize = fileSize - tail_length_ + size;
+  synced_length_ = fileSize - size - extent_filepos_;
+  tail_zone_ = zone;
+  tail_start_ = start;
+  tail_length_ = size;
+  PublishExtents();
+  ExtentWriteUnlock();
+  if (old_tail_zone) zbd_->ReleaseWALTail(old_tail_zone);
+  return IOStatus::OK();
+}
+
+void ZoneFile::DropTail() {
+  Zone* old_tail_zone = tail_zone_;
+
+  ExtentWriteLock();
+  fileSize -= tail_length_;
+  tail_zone_ = nullptr;
+  tail_length_ = 0;
+  PublishExtents();
+  ExtentWriteUnlock();
+  zbd_->ReleaseWALTail(old_tail_zone);
+}
+
+void ZoneFile::AddRecoveredExtent(Zone* zone, uint64_t start,
+                                  uint64_t length) {
+  ZoneExtent* extent = new ZoneExtent(start, length, zone);
+
+  zone->used_capacity_ += length;
+  extents_.push_back(extent);
+  zone->PushExtentInfo(
+      zbd_->GetExtentInfoPool()->New(extent, this, extent->length_));
+}
+
+IOStatus ZoneFile::FindTail(Zone* zone, uint64_t pos, uint64_t* start,
+                            uint32_t* size) {
+  /* The zone is in one device */
+  ZbdDevice* dev = zone->dev_;
+  uint32_t block_sz = GetBlockSize();
+  std::string buf(ZENFS_TAIL_SCAN_SIZE + block_sz, 0);
+  uint64_t hi = zone->wp_;
+
+  *size = 0;
+  while (hi > zone->start_) {
+    uint64_t lo = hi - std::min<uint64_t>(hi - zone->start_,
+                                          ZENFS_TAIL_SCAN_SIZE);
+    /* One block more, for a tail of two blocks ending at lo + block_sz */
+    uint64_t read_lo = lo > zone->start_ ? lo - block_sz : lo;
+    size_t read = 0;
+
+    while (read < hi - read_lo) {
+      ssize_t r = pread(dev->read_f_, &buf[read], hi - read_lo - read,
+                        dev->Offset(read_lo + read));
+      if (r == -1 && errno == EINTR) continue;
+      if (r <= 0) return IOStatus::IOError("Failed to read WAL tail zone");
+      read += r;
+    }
+
+    for (uint64_t end = hi; end > lo; end -= block_sz) {
+      const char* trailer =
+          buf.data() + (end - read_lo) - ZENFS_TAIL_TRAILER_SIZE;
+      uint32_t tail_sz = DecodeFixed32(trailer + 4);
+      uint64_t sealed_sz = (uint64_t)tail_sz + ZENFS_TAIL_TRAILER_SIZE;
+
+      if (DecodeFixed32(trailer) != ZENFS_TAIL_MAGIC ||
+          DecodeFixed64(trailer + 8) != file_id_ || tail_sz >= block_sz)
+        continue;
+      sealed_sz = (sealed_sz + block_sz - 1) / block_sz * block_sz;
+      if (end - sealed_sz < read_lo) continue;
+
+      const char* data = buf.data() + (end - sealed_sz - read_lo);
+      if (DecodeFixed32(trailer + 28) != TailChecksum(data, tail_sz, trailer))
+        continue;
+
+      /* The newest tail, stale once data was written at its position */
+      if (DecodeFixed64(trailer + 16) == pos) {
+        *start = end - sealed_sz;
+        *size = tail_sz;
+      }
+      return IOStatus::OK();
+    }
+    hi = lo;
+  }
+  return IOStatus::OK();
+}
+
+Status ZoneFile::RecoverSyncedData() {
+  Zone* zone = zbd_->GetIOZone(sync_start_);
+  uint64_t end;
+
+  if (!zone || sync_start_ % GetBlockSize())
+    return Status::Corruption("ZoneFile", "Invalid sync start");
+
+  /* The zone was written by this file only from sync_start_ on, in whole
+   * blocks */
+  end = zone->wp_;
+  if (end > sync_start_)
+    AddRecoveredExtent(zone, sync_start_, end - sync_start_);
+
+  if (sync_tail_) {
+    Zone* tail_zone = zbd_->GetIOZone(sync_tail_);
+    uint64_t start = 0;
+    uint32_t size = 0;
+
+    if (!tail_zone) return Status::Corruption("ZoneFile", "Invalid sync tail");
+    IOStatus s = FindTail(tail_zone, end, &start, &size);
+    if (!s.ok()) return s;
+    if (size) AddRecoveredExtent(tail_zone, start, size);
+  }
+
+  fileSize = 0;
+  for (const auto extent : extents_) fileSize += extent->length_;
+  sync_start_ = 0;
+  sync_tail_ = 0;
+  PublishExtents();
+  return Status::OK();
+}
+
 IOStatus ZoneFile::SetWriteLifeTimeHint(Env::WriteLifeTimeHint lifetime) {
   lifetime_ = lifetime;
   return IOStatus::OK();
@@ -555,25 +1487,26 @@ ZonedWritableFile::ZonedWritableFile(ZonedBlockDevice* zbd, bool _buffered,
 
   buffered = _buffered;
   block_sz = zbd->GetBlockSize();
-  buffer_sz = block_sz * 256;
+  buffer_pool_ = zbd->GetBufferPool();
+  buffer_sz = buffer_pool_->GetChunkSize();
   buffer_pos = 0;
 
   zoneFile_ = zoneFile;
 
   if (buffered) {
-    int ret = posix_memalign((void**)&buffer, block_sz, buffer_sz);
-
-    if (ret) buffer = nullptr;
-
+    buffer = buffer_pool_->Allocate();
     assert(buffer != nullptr);
   }
 
   metadata_writer_ = metadata_writer;
+  data_sync_ = buffered && zoneFile->is_wal_ && zbd->GetWALDataSync();
+  synced_sz_ = 0;
+  zoneFile->SetDataSync(data_sync_);
 }
 
 ZonedWritableFile::~ZonedWritableFile() {
   zoneFile_->CloseWR();
-  if (buffered) free(buffer);
+  if (buffered && buffer != nullptr) buffer_pool_->Release(buffer);
 };
 
 ZonedWritableFile::MetadataWriter::~MetadataWriter() {}
@@ -587,6 +1520,11 @@ IOStatus ZonedWritableFile::Truncate(uint64_t size,
 
 IOStatus ZonedWritableFile::Fsync(const IOOptions& /*options*/,
                                   IODebugContext* /*dbg*/) {
+  if (data_sync_) return DataSync(false);
+  return FullSync();
+}
+
+IOStatus ZonedWritableFile::FullSync() {
   IOStatus s;
   ShouldFlushFullBuffer();
   zoneFile_->is_appending_.store(true);
@@ -614,19 +1552,50 @@ IOStatus ZonedWritableFile::Flush(const IOOptions& /*options*/,
 IOStatus ZonedWritableFile::RangeSync(uint64_t offset, uint64_t nbytes,
                                       const IOOptions& options,
                                       IODebugContext* dbg) {
-  if (wp < offset + nbytes) return Fsync(options, dbg);
+  if (wp < offset + nbytes)
+    return data_sync_ ? DataSync(true) : Fsync(options, dbg);
 
   return IOStatus::OK();
 }
 
-IOStatus ZonedWritableFile::Close(const IOOptions& options,
-                                  IODebugContext* dbg) {
-  Fsync(options, dbg);
+IOStatus ZonedWritableFile::Close(const IOOptions& /*options*/,
+                                  IODebugContext* /*dbg*/) {
+  /* The metadata of a closed file holds all of its extents */
+  zoneFile_->SetDataSync(false);
+  FullSync();
   zoneFile_->CloseWR();
 
   return IOStatus::OK();
 }
 
+IOStatus ZonedWritableFile::DataSync(bool only_blocks) {
+  uint32_t tail, blocks_sz;
+  IOStatus s;
+
+  zoneFile_->is_appending_.store(true);
+  buffer_mtx_.lock();
+  tail = buffer_pos % block_sz;
+  blocks_sz = buffer_pos - tail;
+  if (blocks_sz) {
+    s = zoneFile_->Append(buffer, blocks_sz, blocks_sz);
+    if (s.ok()) {
+      wp += blocks_sz;
+      memmove(buffer, buffer + blocks_sz, tail);
+      buffer_pos = tail;
+    }
+  }
+  /* Nothing written since the last sync */
+  if (s.ok() && !only_blocks && wp + buffer_pos != synced_sz_) {
+    s = zoneFile_->SyncTail(buffer, tail);
+    if (s.ok()) synced_sz_ = wp + buffer_pos;
+  }
+  buffer_mtx_.unlock();
+  zoneFile_->is_appending_.store(false);
+
+  if (!s.ok() || only_blocks || !zoneFile_->SyncStartChanged()) return s;
+  return metadata_writer_->Persist(zoneFile_);
+}
+
 IOStatus ZonedWritableFile::FlushBuffer() {
   uint32_t align, pad_sz = 0, wr_sz;
   IOStatus s;
@@ -656,8 +1625,6 @@ IOStatus ZonedWritableFile::BufferedWrite(const Slice& slice) {
   char* data = (char*)slice.data();
   uint32_t tobuffer;
   int blocks, aligned_sz;
-  int ret;
-  void* alignbuf;
   IOStatus s;
 
   if (buffer_pos || data_left <= buffer_left) {
@@ -685,15 +1652,19 @@ IOStatus ZonedWritableFile::BufferedWrite(const Slice& slice) {
     blocks = data_left / block_sz;
     aligned_sz = block_sz * blocks;
 
-    ret = posix_memalign(&alignbuf, block_sz, aligned_sz);
-    if (ret) {
-      return IOStatus::IOError("failed allocating alignment write buffer\n");
+    if (zoneFile_->is_sst_) {
+      /* SST data is copied into aligned staging chunks anyway */
+      s = zoneFile_->Append(data, aligned_sz, aligned_sz);
+    } else {
+      /* The write buffer is empty here, bounce the data through it rather
+       * than allocating an aligned copy of the whole append */
+      aligned_sz = data_left / buffer_sz * buffer_sz;
+      for (int done = 0; done < aligned_sz && s.ok(); done += buffer_sz) {
+        memcpy(buffer, data + done, buffer_sz);
+        s = zoneFile_->Append(buffer, buffer_sz, buffer_sz);
+      }
     }
 
-    memcpy(alignbuf, data, aligned_sz);
-    s = zoneFile_->Append(alignbuf, aligned_sz, aligned_sz);
-    free(alignbuf);
-
     if (!s.ok()) return s;
 
     wp += aligned_sz;
@@ -758,21 +1729,248 @@ void ZonedWritableFile::ShouldFlushFullBuffer() {
   zoneFile_->should_flush_full_buffer_ = true;
 }
 
+void ZoneFile::PredictDeath() {
+  if (!create_time_) create_time_ = (uint64_t)time(NULL);
+  uint64_t lifetime = zbd_->PredictSSTLifetime(level_, smallest_, largest_);
+  predicted_death_ = lifetime ? create_time_ + lifetime : 0;
+}
+
 void ZonedWritableFile::SetMinMaxKeyAndLevel(const Slice& s, const Slice& l, const int level) {
   zoneFile_->smallest_.DecodeFrom(s);
   zoneFile_->largest_.DecodeFrom(l);
   zoneFile_->level_ = level;
+  zoneFile_->PredictDeath();
   zoneFile_->get_zbd()->files_mtx_.lock();
   zoneFile_->get_zbd()->files_.insert(std::pair<uint64_t, ZoneFile*>(zoneFile_->fno_, zoneFile_));
   zoneFile_->get_zbd()->files_mtx_.unlock();
+  zoneFile_->get_zbd()->AddSSTRange(zoneFile_->fno_, level, zoneFile_->smallest_,
+                                    zoneFile_->largest_);
+}
+
+void ZonedWritableFile::SetPlacementHint(const Slice& smallest,
+                                         const Slice& largest,
+                                         const int level) {
+  if (!zoneFile_->is_sst_ || zoneFile_->get_zbd()->GetStreamingBufferSize() == 0)
+    return;
+
+  /* The real key range replaces the hint in SetMinMaxKeyAndLevel */
+  zoneFile_->smallest_.DecodeFrom(smallest);
+  zoneFile_->largest_.DecodeFrom(largest);
+  zoneFile_->level_ = level;
+  zoneFile_->streaming_ = true;
+  zoneFile_->PredictDeath();
+}
+
+void ZonedWritableFile::SetTimeBucket(uint64_t bucket) {
+  if (zoneFile_->is_sst_) zoneFile_->time_bucket_ = bucket;
+}
+
+void ZonedWritableFile::SetL0Stream(uint32_t column_family_id,
+                                    uint32_t key_range) {
+  if (!zoneFile_->is_sst_) return;
+  zoneFile_->time_bucket_ = ZENFS_L0_BUCKET_FLAG |
+                            ((uint64_t)column_family_id << 24) |
+                            (key_range & ((1u << 24) - 1));
+}
+
+void ZonedWritableFile::SetBlobFileHint(int level, uint64_t creation_time,
+                                        uint64_t value_size) {
+  if (!zoneFile_->is_blob_) return;
+
+  uint64_t size_class = 0;
+  while (size_class < 63 && (value_size >> (size_class + 1)) > 0) size_class++;
+  size_class /= 2;
+
+  uint64_t window = creation_time / ZENFS_BLOB_GENERATION_SECONDS;
+  zoneFile_->create_time_ = creation_time;
+  zoneFile_->time_bucket_ = ZENFS_BLOB_BUCKET_FLAG |
+                            ((uint64_t)(level & 0xff) << 48) |
+                            ((size_class & 0xff) << 40) |
+                            (window & ((1ull << 40) - 1));
+}
+
+ZoneReadAhead::ZoneReadAhead(ZoneFile* zoneFile, bool direct,
+                             size_t min_read_sz)
+    : zoneFile_(zoneFile), direct_(direct), min_read_sz_(min_read_sz) {}
+
+ZoneReadAhead::~ZoneReadAhead() {
+  std::unique_lock<std::mutex> lk(mtx_);
+  ReleaseBuffers(&lk);
+}
+
+void ZoneReadAhead::Complete(Buffer* b, std::unique_lock<std::mutex>* lk) {
+  std::shared_future<size_t> read = b->read_;
+  uint64_t seq = b->seq_;
+
+  lk->unlock();
+  size_t len = read.get();
+  lk->lock();
+
+  /* Someone else may have completed it and started another read */
+  if (b->pending_ && b->seq_ == seq) {
+    b->len_ = len;
+    b->pending_ = false;
+  }
+}
+
+ZoneReadAhead::Buffer* ZoneReadAhead::Covering(
+    uint64_t offset, std::unique_lock<std::mutex>* lk) {
+  while (true) {
+    Buffer* found = nullptr;
+
+    for (auto& b : bufs_) {
+      size_t len = b.pending_ ? b.size_ : b.len_;
+      if (b.data_ && offset >= b.offset_ && offset < b.offset_ + len)
+        found = &b;
+    }
+    if (!found || !found->pending_) return found;
+    Complete(found, lk);
+  }
 }
 
-IOStatus ZonedSequentialFile::Read(size_t n, const IOOptions& /*options*/,
+void ZoneReadAhead::StartRead(uint64_t offset, size_t n, ZoneIOClass io_class,
+                              std::unique_lock<std::mutex>* /*lk*/) {
+  uint32_t bs = zoneFile_->GetBlockSize();
+  uint64_t end = zoneFile_->GetFileSize();
+  Buffer* b = nullptr;
+
+  /* Direct reads can not cover the unaligned tail of the file, the last
+   * bytes are read by the caller */
+  offset = offset / bs * bs;
+  if (direct_) end = end / bs * bs;
+  n = std::min(n, (size_t)ZENFS_READAHEAD_MAX_SIZE);
+  if (offset + n < end) end = offset + n;
+  if (end <= offset) return;
+
+  for (auto& c : bufs_) {
+    size_t len = c.pending_ ? c.size_ : c.len_;
+    if (offset >= c.offset_ && offset < c.offset_ + len) return;
+    /* Idle and holding nothing the stream still needs */
+    if (!b && !c.pending_ && c.offset_ + c.len_ <= next_offset_) b = &c;
+  }
+  if (!b) return;
+
+  size_t sz = end - offset;
+  if (b->cap_ < sz) {
+    free(b->data_);
+    b->data_ = nullptr;
+    b->cap_ = 0;
+    b->len_ = 0;
+    if (posix_memalign((void**)&b->data_, bs, sz)) {
+      b->data_ = nullptr;
+      return;
+    }
+    b->cap_ = sz;
+  }
+
+  ZoneFile* zoneFile = zoneFile_;
+  char* data = b->data_;
+  bool direct = direct_;
+
+  b->offset_ = offset;
+  b->size_ = sz;
+  b->len_ = 0;
+  b->pending_ = true;
+  b->seq_++;
+  b->read_ = std::async(std::launch::async, [zoneFile, data, offset, sz,
+                                             direct, io_class]() -> size_t {
+               Slice result;
+               IOStatus s = zoneFile->PositionedRead(offset, sz, &result, data,
+                                                     direct, io_class);
+               return s.ok() ? result.size() : 0;
+             }).share();
+}
+
+void ZoneReadAhead::ReleaseBuffers(std::unique_lock<std::mutex>* lk) {
+  for (auto& b : bufs_) {
+    while (b.pending_) Complete(&b, lk);
+    free(b.data_);
+    b.data_ = nullptr;
+    b.cap_ = 0;
+    b.offset_ = 0;
+    b.size_ = 0;
+    b.len_ = 0;
+  }
+}
+
+void ZoneReadAhead::Prefetch(uint64_t offset, size_t n, ZoneIOClass io_class) {
+  std::unique_lock<std::mutex> lk(mtx_);
+  StartRead(offset, n, io_class, &lk);
+}
+
+IOStatus ZoneReadAhead::Read(uint64_t offset, size_t n, Slice* result,
+                             char* scratch, ZoneIOClass io_class) {
+  if (n < min_read_sz_)
+    return zoneFile_->PositionedRead(offset, n, result, scratch, direct_,
+                                     io_class);
+
+  std::unique_lock<std::mutex> lk(mtx_);
+  uint64_t file_sz = zoneFile_->GetFileSize();
+  size_t copied = 0;
+  IOStatus s;
+
+  if (offset == next_offset_) {
+    hits_++;
+  } else {
+    hits_ = 0;
+    window_ = ZENFS_READAHEAD_MIN_SIZE;
+  }
+  next_offset_ = offset + n;
+
+  while (copied < n) {
+    Buffer* b = Covering(offset + copied, &lk);
+    if (!b) break;
+
+    size_t len = std::min((size_t)(b->offset_ + b->len_ - (offset + copied)),
+                          n - copied);
+    memcpy(scratch + copied, b->data_ + (offset + copied - b->offset_), len);
+    copied += len;
+  }
+  if (copied < n && direct_ &&
+      (offset + copied) % zoneFile_->GetBlockSize() != 0)
+    copied = 0;
+
+  if (hits_ >= ZENFS_READAHEAD_TRIGGER) {
+    if (next_offset_ >= file_sz) {
+      /* The stream is done, do not hold on to the buffers */
+      ReleaseBuffers(&lk);
+    } else {
+      uint64_t ahead = next_offset_;
+
+      for (int i = 0; i < 2; i++) {
+        for (const auto& b : bufs_) {
+          size_t len = b.pending_ ? b.size_ : b.len_;
+          if (b.data_ && ahead >= b.offset_ && ahead < b.offset_ + len)
+            ahead = b.offset_ + len;
+        }
+      }
+      StartRead(ahead, std::max(window_, n), io_class, &lk);
+      window_ = std::min(window_ * 2, (size_t)ZENFS_READAHEAD_MAX_SIZE);
+    }
+  }
+  lk.unlock();
+
+  if (copied < n && offset + copied < file_sz) {
+    Slice rest;
+    s = zoneFile_->PositionedRead(offset + copied, n - copied, &rest,
+                                  scratch + copied, direct_, io_class);
+    if (!s.ok()) {
+      *result = Slice(scratch, 0);
+      return s;
+    }
+    copied += rest.size();
+  }
+  *result = Slice(scratch, copied);
+  return s;
+}
+
+IOStatus ZonedSequentialFile::Read(size_t n, const IOOptions& options,
                                    Slice* result, char* scratch,
                                    IODebugContext* /*dbg*/) {
   IOStatus s;
 
-  s = zoneFile_->PositionedRead(rp, n, result, scratch, direct_);
+  s = readahead_.Read(rp, n, result, scratch,
+                      ZonedBlockDevice::IOClassFor(options));
   if (s.ok()) rp += result->size();
 
   return s;
@@ -786,17 +1984,77 @@ IOStatus ZonedSequentialFile::Skip(uint64_t n) {
 }
 
 IOStatus ZonedSequentialFile::PositionedRead(uint64_t offset, size_t n,
-                                             const IOOptions& /*options*/,
+                                             const IOOptions& options,
                                              Slice* result, char* scratch,
                                              IODebugContext* /*dbg*/) {
-  return zoneFile_->PositionedRead(offset, n, result, scratch, direct_);
+  return readahead_.Read(offset, n, result, scratch,
+                         ZonedBlockDevice::IOClassFor(options));
 }
 
 IOStatus ZonedRandomAccessFile::Read(uint64_t offset, size_t n,
-                                     const IOOptions& /*options*/,
+                                     const IOOptions& options,
                                      Slice* result, char* scratch,
                                      IODebugContext* /*dbg*/) const {
-  return zoneFile_->PositionedRead(offset, n, result, scratch, direct_);
+  return readahead_->Read(offset, n, result, scratch,
+                          ZonedBlockDevice::IOClassFor(options));
+}
+
+IOStatus ZonedRandomAccessFile::MultiRead(FSReadRequest* reqs,
+                                          size_t num_reqs,
+                                          const IOOptions& options,
+                                          IODebugContext* dbg) {
+#if defined(ROCKSDB_IOURING_PRESENT)
+  struct io_uring* iu = nullptr;
+  if (thread_local_io_urings_) {
+    iu = static_cast<struct io_uring*>(thread_local_io_urings_->Get());
+    if (iu == nullptr) {
+      iu = CreateIOUring();
+      if (iu != nullptr) {
+        thread_local_io_urings_->Reset(iu);
+      }
+    }
+  }
+
+  /* Init failed, platform doesn't support io_uring. Fall back to
+   * serialized reads */
+  if (iu == nullptr) {
+    return FSRandomAccessFile::MultiRead(reqs, num_reqs, options, dbg);
+  }
+
+  /* The batch is in flight at once, admitted as one I/O */
+  ZoneIOScope io(zoneFile_->get_zbd(), ZonedBlockDevice::IOClassFor(options));
+  return zoneFile_->MultiRead(reqs, num_reqs, direct_, iu);
+#else
+  return FSRandomAccessFile::MultiRead(reqs, num_reqs, options, dbg);
+#endif
+}
+
+IOStatus ZonedRandomAccessFile::ReadAsync(
+    FSReadRequest& req, const IOOptions& opts,
+    std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) {
+#if defined(ROCKSDB_IOURING_PRESENT)
+  struct io_uring* iu = nullptr;
+  if (thread_local_async_read_io_urings_) {
+    iu = static_cast<struct io_uring*>(
+        thread_local_async_read_io_urings_->Get());
+    if (iu == nullptr) {
+      iu = CreateIOUring();
+      if (iu != nullptr) {
+        thread_local_async_read_io_urings_->Reset(iu);
+      }
+    }
+  }
+
+  if (iu != nullptr) {
+    IOStatus s = zoneFile_->ReadAsync(req, direct_, iu, cb, cb_arg, io_handle,
+                                      del_fn);
+    if (!s.IsBusy()) return s;
+  }
+#endif
+  /* No io_uring or a full submission queue, read synchronously */
+  return FSRandomAccessFile::ReadAsync(req, opts, cb, cb_arg, io_handle, del_fn,
+                                       dbg);
 }
 
 size_t ZoneFile::GetUniqueId(char* id, size_t max_size) {
@@ -806,7 +2064,7 @@ size_t ZoneFile::GetUniqueId(char* id, size_t max_size) {
   }
 
   struct stat buf;
-  int fd = zbd_->GetReadFD();
+  int fd = zbd_->GetDevices()[0]->read_f_;
   int result = fstat(fd, &buf);
   if (result == -1) {
     return 0;
@@ -15,52 +15,62 @@
 #include <unistd.h>
 
 #include <atomic>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "env/io_posix.h"
 #include "rocksdb/file_system.h"
+#include "util/thread_local.h"
 #include "zbd_zenfs.h"
 #include "db/version_edit.h"
 
 namespace ROCKSDB_NAMESPACE {
 
-class Buffer {
- public:
-  int buffer_size_;
-  int valid_size_;
-  char* buffer_;
-
-  explicit Buffer(void* data, int data_size, int valid_size, uint32_t block_size)
-      :buffer_size_(data_size),
-       valid_size_(valid_size)
-       {
-          int ret = posix_memalign((void**)&buffer_, block_size, data_size);
-          if (ret) {
-            fprintf(stderr, "failed allocating alignment write buffer\n");
-            exit(1);
-          }
-          memcpy(buffer_, data, buffer_size_);
-       };
-
-  ~Buffer(){
-    delete (char*)buffer_;
-  }
-
-};
-
 class ZoneExtent {
  public:
   uint64_t start_;
   uint32_t length_;
   Zone* zone_;
+  ZoneExtentInfo* info_; /* record in zone_, set by Zone::PushExtentInfo() */
 
   explicit ZoneExtent(uint64_t start, uint32_t length, Zone* zone);
   Status DecodeFrom(Slice* input);
   void EncodeTo(std::string* output);
 };
 
+/* Immutable snapshot of the extent list of a file. A new table is published
+ * every time the extent list changes, so readers can map file offsets to
+ * device offsets with a binary search and without taking the extent lock */
+class ZoneExtentTable {
+ public:
+  struct Entry {
+    ZoneExtent* extent_; /* nullptr for data synced without an extent */
+    uint64_t start_;
+    uint32_t length_;
+  };
+
+  ZoneExtentTable() {}
+  explicit ZoneExtentTable(const std::vector<ZoneExtent*>& extents);
+  /* Adds data following the extents, see ZoneFile::SyncTail() */
+  void AddSynced(uint64_t start, uint32_t length);
+
+  /* Index of the extent holding file_offset, or -1 if beyond the last one */
+  int Find(uint64_t file_offset) const;
+
+  size_t size() const { return entries_.size(); }
+  const Entry& operator[](size_t i) const { return entries_[i]; }
+  /* File offset of the first byte stored in extent i */
+  uint64_t FileOffset(size_t i) const { return file_offsets_[i]; }
+
+ private:
+  std::vector<Entry> entries_;
+  std::vector<uint64_t> file_offsets_;
+};
+
 class ZoneFile {
  protected:
   ZonedBlockDevice* zbd_;
@@ -72,10 +82,66 @@ class ZoneFile {
   Env::WriteLifeTimeHint lifetime_;
   uint64_t fileSize;
   std::string filename_;
+  /* Further names of the file, see ZenFS::LinkFile() */
+  std::vector<std::string> linkfiles_;
   uint64_t file_id_;
   uint32_t nr_synced_extents_;
+  /* Length of the last synced extent when it was synced. Appends that
+   * extend it are recorded as its new length, see AddExtent() */
+  uint32_t synced_extent_length_;
+  /* Decoded new length of the last extent of the file, 0 if unchanged */
+  uint32_t last_extent_length_;
+
+  /* A WAL synced without metadata updates is read from the extents, the
+   * synced_length_ bytes from extent_start_ on and its tail, the last
+   * partial block kept in the write buffer and written sealed to the WAL
+   * tail zone, see SyncTail(). The metadata is only persisted when the file
+   * moves to another zone or tail zone and points RecoverSyncedData() to
+   * the data not in an extent */
+  bool data_sync_;
+  uint64_t synced_length_;
+  Zone* tail_zone_;
+  uint64_t tail_start_;
+  uint32_t tail_length_;
+  /* The zones of the persisted metadata */
+  Zone* sync_zone_;
+  Zone* sync_tail_zone_;
+  /* Decoded, 0 if none, the first zone holds no file data */
+  uint64_t sync_start_;
+  uint64_t sync_tail_;
+  /* Allocates the first zone, or the next one if the active zone is full */
+  IOStatus EnsureActiveZone();
+  void DropTail();
+  void AddRecoveredExtent(Zone* zone, uint64_t start, uint64_t length);
+  /* Finds the newest tail of the file in zone, if it was written at
+   * file data position pos, size is 0 otherwise */
+  IOStatus FindTail(Zone* zone, uint64_t pos, uint64_t* start,
+                    uint32_t* size);
   /*Append to Zone only After Finish() is called from table builer*/
-  std::vector<Buffer*> full_buffer_;
+  struct StagedChunk {
+    char* data_;  /* from ZonedBlockDevice::GetBufferPool() */
+    uint32_t size_;
+  };
+  std::vector<StagedChunk> full_buffer_;
+  uint64_t staged_sz_;
+  uint64_t staged_pad_; /* padding bytes in the staged data */
+  void ReleaseStagedChunks();
+
+  /* Open zones of a striped SST, written round robin one staged chunk per
+   * zone, see ZonedBlockDevice::GetStripeWidth() */
+  std::vector<Zone*> stripes_;
+  IOStatus AppendBufferStriped();
+  /* Data that follows the last extent in its zone extends that extent */
+  void AddExtent(Zone* zone, uint64_t start, uint64_t length);
+
+  /* Published with std::atomic_store, read with std::atomic_load */
+  std::shared_ptr<const ZoneExtentTable> extent_table_;
+  void PublishExtents();
+
+  /* Sets is_sst_, is_wal_, is_blob_ and fno_ from filename_ */
+  void ParseFileNumber();
+  void EncodePlacementTo(std::string* output);
+  Status DecodePlacementFrom(Slice* input);
 
  public:
   InternalKey smallest_;
@@ -85,8 +151,22 @@ class ZoneFile {
   std::atomic<bool> is_appending_;
   std::atomic<bool> marked_for_del_;
   bool should_flush_full_buffer_;
+  /* Placed from a key range hint, staged data is bounded by
+   * ZonedBlockDevice::GetStreamingBufferSize() */
+  bool streaming_;
   bool is_sst_;
+  bool is_wal_; /* allocates from the WAL zone ring */
+  bool is_blob_; /* integrated BlobDB blob file */
+  /* Zones shared only by files of the same bucket: a FIFO creation time
+   * bucket or a blob file generation, 0 if none */
+  uint64_t time_bucket_;
+  uint64_t create_time_; /* when the SST got its key range, 0 if unknown */
+  /* From ZonedBlockDevice::PredictSSTLifetime(), 0 if unknown */
+  uint64_t predicted_death_;
+  void PredictDeath();
   uint64_t fno_;
+  /* Returns nullptr instead of waiting when may_wait is false */
+  Zone* AllocateDataZone(bool may_wait = true);
 
   std::mutex extent_mtx_;
   std::atomic<bool> extent_writer;
@@ -108,6 +188,14 @@ class ZoneFile {
   IOStatus SetWriteLifeTimeHint(Env::WriteLifeTimeHint lifetime);
   std::string GetFilename();
   void Rename(std::string name);
+  const std::vector<std::string>& GetLinkFiles() { return linkfiles_; }
+  uint32_t GetNrLinks() { return 1 + (uint32_t)linkfiles_.size(); }
+  void AddLinkName(const std::string& name) { linkfiles_.push_back(name); }
+  /* Removes a name of a file that has more than one, the first link name
+   * takes the place of the file name if that is removed */
+  void RemoveLinkName(const std::string& name);
+  /* Renames the file name or link name from to to */
+  void RenameName(const std::string& from, const std::string& to);
   uint64_t GetFileSize();
   void SetFileSize(uint64_t sz);
 
@@ -115,11 +203,48 @@ class ZoneFile {
   std::vector<ZoneExtent*> GetExtents() { return extents_; }
   Env::WriteLifeTimeHint GetWriteLifeTimeHint() { return lifetime_; }
 
+  /* Device reads are scheduled as io_class, see
+   * ZonedBlockDevice::BeginIO() */
   IOStatus PositionedRead(uint64_t offset, size_t n, Slice* result,
-                          char* scratch, bool direct);
+                          char* scratch, bool direct,
+                          ZoneIOClass io_class = kIOForeground);
+#if defined(ROCKSDB_IOURING_PRESENT)
+  /* Translates every request through the extent list and submits all
+   * resulting device reads to the io_uring instance in one batch */
+  IOStatus MultiRead(FSReadRequest* reqs, size_t num_reqs, bool direct,
+                     struct io_uring* iu);
+  /* Submits the device reads of req to the io_uring instance without waiting
+   * for them, see FSRandomAccessFile::ReadAsync(). Returns Busy if the
+   * submission queue is full */
+  IOStatus ReadAsync(FSReadRequest& req, bool direct, struct io_uring* iu,
+                     std::function<void(const FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn);
+  /* Waits for reads started by ReadAsync(), see FileSystem::Poll() */
+  static IOStatus PollAsyncReads(std::vector<void*>& io_handles);
+#endif
   ZoneExtent* GetExtent(uint64_t file_offset, uint64_t* dev_offset);
+  std::shared_ptr<const ZoneExtentTable> GetExtentTable() const {
+    return std::atomic_load(&extent_table_);
+  }
   void PushExtent();
 
+  void SetDataSync(bool on) { data_sync_ = on; }
+  /* Makes the data appended so far readable as synced, and writes the size
+   * bytes at data, less than a block, sealed to the WAL tail zone. The
+   * next append starts with the same bytes again. data must have room for
+   * two blocks */
+  IOStatus SyncTail(char* data, uint32_t size);
+  /* The next data sync has to persist the metadata, the file moved to a
+   * zone or tail zone the metadata does not point to */
+  bool SyncStartChanged() {
+    return data_sync_ && (sync_zone_ != active_zone_ ||
+                          (tail_zone_ && sync_tail_zone_ != tail_zone_));
+  }
+  /* Rebuilds the extents of a WAL that was open with data syncs from the
+   * write pointer of its zone and the tail zone */
+  Status RecoverSyncedData();
+  bool NeedsRecovery() { return sync_start_ != 0; }
+
   void ExtentReadLock();
   void ExtentReadUnlock();
 
@@ -131,15 +256,25 @@ class ZoneFile {
     EncodeTo(output, nr_synced_extents_);
   };
   void EncodeSnapshotTo(std::string* output) { EncodeTo(output, 0); };
-  void MetadataSynced() { nr_synced_extents_ = extents_.size(); };
+  void MetadataSynced() {
+    nr_synced_extents_ = extents_.size();
+    synced_extent_length_ = extents_.empty() ? 0 : extents_.back()->length_;
+    sync_zone_ = data_sync_ ? active_zone_ : nullptr;
+    sync_tail_zone_ = data_sync_ ? tail_zone_ : nullptr;
+  };
 
   Status DecodeFrom(Slice* input);
   Status MergeUpdate(ZoneFile* update);
+  /* Takes the names, size and extents of snapshot, a newer record of the
+   * same file, and leaves it the replaced extents. Readers of the replaced
+   * extent table may still use them, so snapshot has to outlive those */
+  Status ReplaceWith(ZoneFile* snapshot);
 
   std::vector<ZoneExtent*>& GetExtentsList(){return extents_;};
-  void UpdateExtents(std::vector<ZoneExtent*>& a){
-      extents_ = a;
-  };
+  /* Swap in a new extent list. Returns the old extent table, the zones
+   * it points to must not be reset while readers still hold it */
+  std::shared_ptr<const ZoneExtentTable> UpdateExtents(
+      std::vector<ZoneExtent*>& a);
   uint64_t GetID() { return file_id_; }
   size_t GetUniqueId(char* id, size_t max_size);
 
@@ -195,12 +330,30 @@ class ZonedWritableFile : public FSWritableFile {
   void SetWriteLifeTimeHint(Env::WriteLifeTimeHint hint) override;
   void ShouldFlushFullBuffer();
   void SetMinMaxKeyAndLevel(const Slice&, const Slice&, const int);
+  void SetPlacementHint(const Slice& smallest, const Slice& largest,
+                        const int level) override;
+  void SetTimeBucket(uint64_t bucket) override;
+  /* Gives the L0 files of a column family and key range zones of their
+   * own, which empty together once L0->L1 compaction picks the range. A
+   * FIFO time bucket set later replaces the stream */
+  void SetL0Stream(uint32_t column_family_id, uint32_t key_range);
+  void SetBlobFileHint(int level, uint64_t creation_time,
+                       uint64_t value_size) override;
  private:
   IOStatus BufferedWrite(const Slice& data);
   IOStatus FlushBuffer();
+  /* Pads the buffer, closes the extent and persists the metadata */
+  IOStatus FullSync();
+  /* Writes the whole blocks of the buffer and the rest sealed to the WAL
+   * tail zone, the metadata is only persisted when the file moved to
+   * another zone. With only_blocks the rest stays buffered */
+  IOStatus DataSync(bool only_blocks);
 
   bool buffered;
-  char* buffer;
+  bool data_sync_; /* a buffered WAL on a file system with WAL data sync */
+  uint64_t synced_sz_; /* file size at the last data sync */
+  char* buffer; /* one chunk of buffer_pool_ */
+  AlignedChunkPool* buffer_pool_;
   size_t buffer_sz;
   uint32_t block_sz;
   uint32_t buffer_pos;
@@ -213,15 +366,71 @@ class ZonedWritableFile : public FSWritableFile {
   std::mutex buffer_mtx_;
 };
 
+/* Random access reads smaller than this never start or extend a ZenFS
+ * read-ahead stream */
+#define ZENFS_READAHEAD_MIN_READ_SIZE (64 * 1024)
+
+/* Adaptive read-ahead of a ZoneFile. Reads of at least min_read_sz that
+ * start where the previous one ended are a stream, once it is long enough
+ * the following window is read in the background into one of two buffers
+ * while the caller consumes the other. The window grows with the stream up
+ * to ZENFS_READAHEAD_MAX_SIZE, smaller reads pass through untouched so
+ * point lookups do not break a compaction stream on the same file */
+class ZoneReadAhead {
+ public:
+  ZoneReadAhead(ZoneFile* zoneFile, bool direct, size_t min_read_sz);
+  ~ZoneReadAhead();
+
+  /* Same contract as ZoneFile::PositionedRead(), the read-ahead it starts
+   * is scheduled as io_class too */
+  IOStatus Read(uint64_t offset, size_t n, Slice* result, char* scratch,
+                ZoneIOClass io_class);
+  /* Reads [offset, offset + n) in the background */
+  void Prefetch(uint64_t offset, size_t n, ZoneIOClass io_class);
+
+ private:
+  struct Buffer {
+    char* data_ = nullptr;
+    size_t cap_ = 0;
+    uint64_t offset_ = 0;
+    size_t size_ = 0;  /* bytes requested */
+    size_t len_ = 0;   /* valid bytes once the read completed */
+    bool pending_ = false;
+    uint64_t seq_ = 0; /* bumped on every read started */
+    std::shared_future<size_t> read_;
+  };
+
+  ZoneFile* zoneFile_;
+  const bool direct_;
+  const size_t min_read_sz_;
+  std::mutex mtx_; /* Protects everything below */
+  Buffer bufs_[2];
+  uint64_t next_offset_ = 0; /* where a sequential read would start */
+  uint32_t hits_ = 0;        /* sequential reads in a row */
+  size_t window_ = 0;
+
+  /* mtx_ should be locked before the functions are called, waiting for a
+   * background read unlocks it meanwhile */
+  void Complete(Buffer* b, std::unique_lock<std::mutex>* lk);
+  Buffer* Covering(uint64_t offset, std::unique_lock<std::mutex>* lk);
+  void StartRead(uint64_t offset, size_t n, ZoneIOClass io_class,
+                 std::unique_lock<std::mutex>* lk);
+  void ReleaseBuffers(std::unique_lock<std::mutex>* lk);
+};
+
 class ZonedSequentialFile : public FSSequentialFile {
  private:
   ZoneFile* zoneFile_;
   uint64_t rp;
   bool direct_;
+  ZoneReadAhead readahead_;
 
  public:
   explicit ZonedSequentialFile(ZoneFile* zoneFile, const FileOptions& file_opts)
-      : zoneFile_(zoneFile), rp(0), direct_(file_opts.use_direct_reads) {}
+      : zoneFile_(zoneFile),
+        rp(0),
+        direct_(file_opts.use_direct_reads),
+        readahead_(zoneFile, direct_, 0) {}
 
   IOStatus Read(size_t n, const IOOptions& options, Slice* result,
                 char* scratch, IODebugContext* dbg) override;
@@ -247,25 +456,49 @@ class ZonedRandomAccessFile : public FSRandomAccessFile {
  private:
   ZoneFile* zoneFile_;
   bool direct_;
+  /* Only follows large reads, like those of a FilePrefetchBuffer */
+  std::unique_ptr<ZoneReadAhead> readahead_;
+#if defined(ROCKSDB_IOURING_PRESENT)
+  ThreadLocalPtr* thread_local_io_urings_;
+  ThreadLocalPtr* thread_local_async_read_io_urings_;
+#endif
 
  public:
-  explicit ZonedRandomAccessFile(ZoneFile* zoneFile,
-                                 const FileOptions& file_opts)
-      : zoneFile_(zoneFile), direct_(file_opts.use_direct_reads) {}
+  explicit ZonedRandomAccessFile(
+      ZoneFile* zoneFile, const FileOptions& file_opts
+#if defined(ROCKSDB_IOURING_PRESENT)
+      ,
+      ThreadLocalPtr* thread_local_io_urings,
+      ThreadLocalPtr* thread_local_async_read_io_urings
+#endif
+      )
+      : zoneFile_(zoneFile),
+        direct_(file_opts.use_direct_reads),
+        readahead_(new ZoneReadAhead(zoneFile, direct_,
+                                     ZENFS_READAHEAD_MIN_READ_SIZE))
+#if defined(ROCKSDB_IOURING_PRESENT)
+        ,
+        thread_local_io_urings_(thread_local_io_urings),
+        thread_local_async_read_io_urings_(thread_local_async_read_io_urings)
+#endif
+  {
+  }
 
   IOStatus Read(uint64_t offset, size_t n, const IOOptions& options,
                 Slice* result, char* scratch,
                 IODebugContext* dbg) const override;
 
-  IOStatus MultiRead(FSReadRequest* /*reqs*/, size_t /*num_reqs*/,
-                     const IOOptions& /*options*/,
-                     IODebugContext* /*dbg*/) override {
-    return IOStatus::IOError("Not implemented");
-  }
+  IOStatus MultiRead(FSReadRequest* reqs, size_t num_reqs,
+                     const IOOptions& options, IODebugContext* dbg) override;
+
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& opts,
+                     std::function<void(const FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                     IODebugContext* dbg) override;
 
-  IOStatus Prefetch(uint64_t /*offset*/, size_t /*n*/,
-                    const IOOptions& /*options*/,
+  IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& options,
                     IODebugContext* /*dbg*/) override {
+    readahead_->Prefetch(offset, n, ZonedBlockDevice::IOClassFor(options));
     return IOStatus::OK();
   }
 
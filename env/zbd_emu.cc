@@ -0,0 +1,405 @@
+// Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#if !defined(ROCKSDB_LITE) && !defined(OS_WIN) && defined(LIBZBD)
+
+#include "zbd_emu.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#define KB (1024)
+#define MB (1024 * KB)
+
+#define ZENFS_EMU_MAGIC (0x5a454e4653454d55ULL)
+
+/* Geometry of a new emulated device */
+#define ZENFS_EMU_NR_ZONES (64)
+#define ZENFS_EMU_ZONE_SIZE_MB (64)
+#define ZENFS_EMU_BLOCK_SIZE (4096)
+#define ZENFS_EMU_MAX_OPEN (14)
+#define ZENFS_EMU_MAX_ACTIVE (14)
+
+namespace ROCKSDB_NAMESPACE {
+
+bool ZoneEmulator::IsEmulated(const std::string& name) {
+  return name.rfind("emu:", 0) == 0;
+}
+
+ZoneEmulator::ZoneEmulator(const std::string& name) {
+  std::string spec = name.substr(strlen("emu:"));
+  size_t q = spec.find('?');
+
+  path_ = spec.substr(0, q);
+  if (q != std::string::npos) options_ = spec.substr(q + 1);
+  memset(&geometry_, 0, sizeof(geometry_));
+}
+
+ZoneEmulator::~ZoneEmulator() {
+  if (state_map_) {
+    msync(state_map_, state_map_sz_, MS_SYNC);
+    munmap(state_map_, state_map_sz_);
+  }
+  if (state_f_ >= 0) close(state_f_);
+}
+
+IOStatus ZoneEmulator::ParseOptions() {
+  uint64_t zone_size_mb = ZENFS_EMU_ZONE_SIZE_MB;
+  uint64_t zone_capacity_mb = 0;
+  size_t pos = 0;
+
+  geometry_.magic_ = ZENFS_EMU_MAGIC;
+  geometry_.nr_zones_ = ZENFS_EMU_NR_ZONES;
+  geometry_.block_size_ = ZENFS_EMU_BLOCK_SIZE;
+  geometry_.max_open_ = ZENFS_EMU_MAX_OPEN;
+  geometry_.max_active_ = ZENFS_EMU_MAX_ACTIVE;
+
+  while (pos < options_.size()) {
+    size_t end = options_.find('&', pos);
+    if (end == std::string::npos) end = options_.size();
+    std::string opt = options_.substr(pos, end - pos);
+    pos = end + 1;
+
+    size_t eq = opt.find('=');
+    if (eq == std::string::npos)
+      return IOStatus::InvalidArgument("Malformed emulator option: " + opt);
+    std::string key = opt.substr(0, eq);
+    uint64_t val = strtoull(opt.c_str() + eq + 1, nullptr, 10);
+
+    if (key == "nr_zones")
+      geometry_.nr_zones_ = val;
+    else if (key == "zone_size_mb")
+      zone_size_mb = val;
+    else if (key == "zone_capacity_mb")
+      zone_capacity_mb = val;
+    else if (key == "block_size")
+      geometry_.block_size_ = val;
+    else if (key == "max_open")
+      geometry_.max_open_ = val;
+    else if (key == "max_active")
+      geometry_.max_active_ = val;
+    else if (key == "write_lat_us")
+      write_lat_us_ = val;
+    else if (key == "write_mbps")
+      write_mbps_ = val;
+    else if (key == "read_lat_us")
+      read_lat_us_ = val;
+    else if (key == "read_mbps")
+      read_mbps_ = val;
+    else if (key == "reset_lat_us")
+      reset_lat_us_ = val;
+    else if (key == "finish_lat_us")
+      finish_lat_us_ = val;
+    else
+      return IOStatus::InvalidArgument("Unknown emulator option: " + key);
+  }
+
+  geometry_.zone_size_ = zone_size_mb * MB;
+  geometry_.zone_capacity_ =
+      zone_capacity_mb ? zone_capacity_mb * MB : geometry_.zone_size_;
+
+  if (geometry_.nr_zones_ == 0 || geometry_.zone_size_ == 0 ||
+      geometry_.block_size_ == 0 ||
+      (geometry_.zone_size_ % geometry_.block_size_) != 0 ||
+      geometry_.zone_capacity_ > geometry_.zone_size_ ||
+      (geometry_.zone_capacity_ % geometry_.block_size_) != 0)
+    return IOStatus::InvalidArgument("Invalid emulated zone geometry");
+
+  return IOStatus::OK();
+}
+
+IOStatus ZoneEmulator::MapState(bool create) {
+  std::string state_path = path_ + ".zones";
+  struct stat st;
+  bool exists = stat(state_path.c_str(), &st) == 0 && st.st_size > 0;
+
+  if (!exists && !create)
+    return IOStatus::InvalidArgument("No emulated zoned device at " + path_);
+
+  state_f_ = open(state_path.c_str(), create ? O_RDWR | O_CREAT : O_RDONLY,
+                  0644);
+  if (state_f_ < 0)
+    return IOStatus::IOError("Failed to open emulated zone state " +
+                             state_path);
+
+  if (exists) {
+    Header header;
+    if (pread(state_f_, &header, sizeof(header), 0) != sizeof(header) ||
+        header.magic_ != ZENFS_EMU_MAGIC)
+      return IOStatus::Corruption("Invalid emulated zone state " + state_path);
+    /* The geometry is fixed once the device exists */
+    geometry_ = header;
+  }
+
+  state_map_sz_ = sizeof(Header) + geometry_.nr_zones_ * sizeof(ZoneState);
+  if (!exists) {
+    if (ftruncate(state_f_, state_map_sz_))
+      return IOStatus::IOError("Failed to size emulated zone state");
+    int data_f = open(path_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (data_f < 0)
+      return IOStatus::IOError("Failed to create emulated device " + path_);
+    int ret = ftruncate(data_f, geometry_.nr_zones_ * geometry_.zone_size_);
+    close(data_f);
+    if (ret) return IOStatus::IOError("Failed to size emulated device");
+  }
+
+  state_map_ = mmap(nullptr, state_map_sz_,
+                    create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED,
+                    state_f_, 0);
+  if (state_map_ == MAP_FAILED) {
+    state_map_ = nullptr;
+    return IOStatus::IOError("Failed to map emulated zone state");
+  }
+  zones_ = reinterpret_cast<ZoneState*>(static_cast<char*>(state_map_) +
+                                        sizeof(Header));
+
+  if (!exists) {
+    memcpy(state_map_, &geometry_, sizeof(Header));
+    for (uint64_t i = 0; i < geometry_.nr_zones_; i++) {
+      zones_[i].wp_ = i * geometry_.zone_size_;
+      zones_[i].cond_ = ZBD_ZONE_COND_EMPTY;
+    }
+  }
+
+  for (uint64_t i = 0; i < geometry_.nr_zones_; i++) {
+    ZoneState* z = &zones_[i];
+    /* Open zones do not survive a restart of the device */
+    if (create && (z->cond_ == ZBD_ZONE_COND_IMP_OPEN ||
+                   z->cond_ == ZBD_ZONE_COND_EXP_OPEN))
+      z->cond_ = ZBD_ZONE_COND_CLOSED;
+    if (z->cond_ == ZBD_ZONE_COND_CLOSED) nr_active_++;
+  }
+
+  return IOStatus::OK();
+}
+
+static int OpenDataFile(const std::string& path, int flags) {
+  int fd = open(path.c_str(), flags);
+  /* tmpfs and some other file systems do not support direct IO */
+  if (fd < 0 && errno == EINVAL && (flags & O_DIRECT))
+    fd = open(path.c_str(), flags & ~O_DIRECT);
+  return fd;
+}
+
+IOStatus ZoneEmulator::Open(bool readonly, struct zbd_info* info, int* read_f,
+                            int* read_direct_f, int* write_f) {
+  IOStatus s = ParseOptions();
+  if (!s.ok()) return s;
+
+  s = MapState(!readonly);
+  if (!s.ok()) return s;
+
+  *read_f = OpenDataFile(path_, O_RDONLY);
+  *read_direct_f = OpenDataFile(path_, O_RDONLY | O_DIRECT);
+  *write_f = readonly ? -1 : OpenDataFile(path_, O_WRONLY | O_DIRECT);
+  if (*read_f < 0 || *read_direct_f < 0 || (!readonly && *write_f < 0))
+    return IOStatus::InvalidArgument("Failed to open emulated device " +
+                                     path_);
+
+  memset(info, 0, sizeof(*info));
+  info->nr_sectors = geometry_.nr_zones_ * geometry_.zone_size_ / 512;
+  info->nr_lblocks = geometry_.nr_zones_ * geometry_.zone_size_ /
+                     geometry_.block_size_;
+  info->nr_pblocks = info->nr_lblocks;
+  info->zone_size = geometry_.zone_size_;
+  info->zone_sectors = geometry_.zone_size_ / 512;
+  info->lblock_size = geometry_.block_size_;
+  info->pblock_size = geometry_.block_size_;
+  info->nr_zones = geometry_.nr_zones_;
+  info->max_nr_open_zones = geometry_.max_open_;
+  info->max_nr_active_zones = geometry_.max_active_;
+  info->model = ZBD_DM_HOST_MANAGED;
+
+  return IOStatus::OK();
+}
+
+ZoneEmulator::ZoneState* ZoneEmulator::GetZone(uint64_t ofst) {
+  uint64_t idx = ofst / geometry_.zone_size_;
+  if (idx >= geometry_.nr_zones_) return nullptr;
+  return &zones_[idx];
+}
+
+void ZoneEmulator::FillZone(uint64_t idx, struct zbd_zone* z) {
+  memset(z, 0, sizeof(*z));
+  z->start = idx * geometry_.zone_size_;
+  z->len = geometry_.zone_size_;
+  z->capacity = geometry_.zone_capacity_;
+  z->wp = zones_[idx].wp_;
+  z->type = ZBD_ZONE_TYPE_SWR;
+  z->cond = zones_[idx].cond_;
+}
+
+template <typename Op>
+int ZoneEmulator::ForEachZone(uint64_t ofst, uint64_t len, Op op) {
+  uint64_t first = ofst / geometry_.zone_size_;
+  uint64_t end = (ofst + len + geometry_.zone_size_ - 1) / geometry_.zone_size_;
+
+  if ((ofst % geometry_.zone_size_) != 0 || end > geometry_.nr_zones_) {
+    errno = EINVAL;
+    return -1;
+  }
+  for (uint64_t i = first; i < end; i++) op(i, &zones_[i]);
+  return 0;
+}
+
+/* mtx_ should be locked before the function is called */
+void ZoneEmulator::SetCond(ZoneState* z, uint32_t cond) {
+  auto is_open = [](uint32_t c) {
+    return c == ZBD_ZONE_COND_IMP_OPEN || c == ZBD_ZONE_COND_EXP_OPEN;
+  };
+  auto is_active = [&](uint32_t c) {
+    return is_open(c) || c == ZBD_ZONE_COND_CLOSED;
+  };
+
+  if (is_open(z->cond_)) nr_open_--;
+  if (is_active(z->cond_)) nr_active_--;
+  z->cond_ = cond;
+  if (is_open(z->cond_)) nr_open_++;
+  if (is_active(z->cond_)) nr_active_++;
+}
+
+int ZoneEmulator::ListZones(uint64_t ofst, uint64_t len,
+                            struct zbd_zone** zones, unsigned int* nr_zones) {
+  uint64_t first = ofst / geometry_.zone_size_;
+  uint64_t end = std::min<uint64_t>(
+      (ofst + len + geometry_.zone_size_ - 1) / geometry_.zone_size_,
+      geometry_.nr_zones_);
+
+  *nr_zones = 0;
+  *zones = nullptr;
+  if (end <= first) return 0;
+
+  *zones = static_cast<struct zbd_zone*>(
+      calloc(end - first, sizeof(struct zbd_zone)));
+  if (*zones == nullptr) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (uint64_t i = first; i < end; i++) FillZone(i, &(*zones)[i - first]);
+  *nr_zones = end - first;
+  return 0;
+}
+
+int ZoneEmulator::ReportZones(uint64_t ofst, uint64_t len,
+                              struct zbd_zone* zones, unsigned int* nr_zones) {
+  uint64_t first = ofst / geometry_.zone_size_;
+  uint64_t end = std::min<uint64_t>(
+      (ofst + len + geometry_.zone_size_ - 1) / geometry_.zone_size_,
+      geometry_.nr_zones_);
+  unsigned int n = 0;
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (uint64_t i = first; i < end && n < *nr_zones; i++)
+    FillZone(i, &zones[n++]);
+  *nr_zones = n;
+  return 0;
+}
+
+int ZoneEmulator::ResetZones(uint64_t ofst, uint64_t len) {
+  int ret;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ret = ForEachZone(ofst, len, [this](uint64_t i, ZoneState* z) {
+      SetCond(z, ZBD_ZONE_COND_EMPTY);
+      z->wp_ = i * geometry_.zone_size_;
+    });
+  }
+  if (!ret) Delay(reset_lat_us_, 0, 0);
+  return ret;
+}
+
+int ZoneEmulator::FinishZones(uint64_t ofst, uint64_t len) {
+  int ret;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ret = ForEachZone(ofst, len, [this](uint64_t i, ZoneState* z) {
+      SetCond(z, ZBD_ZONE_COND_FULL);
+      z->wp_ = (i + 1) * geometry_.zone_size_;
+    });
+  }
+  if (!ret) Delay(finish_lat_us_, 0, 0);
+  return ret;
+}
+
+int ZoneEmulator::CloseZones(uint64_t ofst, uint64_t len) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return ForEachZone(ofst, len, [this](uint64_t i, ZoneState* z) {
+    if (z->cond_ != ZBD_ZONE_COND_IMP_OPEN &&
+        z->cond_ != ZBD_ZONE_COND_EXP_OPEN)
+      return;
+    if (z->wp_ == i * geometry_.zone_size_)
+      SetCond(z, ZBD_ZONE_COND_EMPTY);
+    else
+      SetCond(z, ZBD_ZONE_COND_CLOSED);
+  });
+}
+
+int ZoneEmulator::Write(uint64_t ofst, uint64_t len) {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ZoneState* z = GetZone(ofst);
+    if (z == nullptr) {
+      errno = EINVAL;
+      return -1;
+    }
+
+    uint64_t start = (z - zones_) * geometry_.zone_size_;
+    if (z->cond_ == ZBD_ZONE_COND_FULL || ofst != z->wp_ ||
+        z->wp_ + len > start + geometry_.zone_capacity_) {
+      errno = EIO;
+      return -1;
+    }
+
+    if (z->cond_ == ZBD_ZONE_COND_EMPTY || z->cond_ == ZBD_ZONE_COND_CLOSED) {
+      if (z->cond_ == ZBD_ZONE_COND_EMPTY && geometry_.max_active_ &&
+          nr_active_ >= geometry_.max_active_) {
+        errno = EIO;
+        return -1;
+      }
+      if (geometry_.max_open_ && nr_open_ >= geometry_.max_open_) {
+        /* Make room by closing an implicitly opened zone, like a device */
+        ZoneState* victim = nullptr;
+        for (uint64_t i = 0; i < geometry_.nr_zones_ && !victim; i++)
+          if (zones_[i].cond_ == ZBD_ZONE_COND_IMP_OPEN) victim = &zones_[i];
+        if (victim == nullptr) {
+          errno = EIO;
+          return -1;
+        }
+        SetCond(victim, ZBD_ZONE_COND_CLOSED);
+      }
+      SetCond(z, ZBD_ZONE_COND_IMP_OPEN);
+    }
+
+    z->wp_ += len;
+    if (z->wp_ == start + geometry_.zone_capacity_)
+      SetCond(z, ZBD_ZONE_COND_FULL);
+  }
+
+  Delay(write_lat_us_, write_mbps_, len);
+  return 0;
+}
+
+void ZoneEmulator::Read(uint64_t len) { Delay(read_lat_us_, read_mbps_, len); }
+
+/* mbps is in 10^6 bytes per second, so bytes / mbps is in microseconds */
+void ZoneEmulator::Delay(uint64_t lat_us, uint64_t mbps, uint64_t bytes) {
+  uint64_t us = lat_us + (mbps ? bytes / mbps : 0);
+  if (us) std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !defined(ROCKSDB_LITE) && !defined(OS_WIN) && defined(LIBZBD)
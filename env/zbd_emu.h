@@ -0,0 +1,115 @@
+// Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#if !defined(ROCKSDB_LITE) && defined(OS_LINUX) && defined(LIBZBD)
+
+#include <libzbd/zbd.h>
+#include <stdint.h>
+
+#include <mutex>
+#include <string>
+
+#include "rocksdb/io_status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+/* Host managed zoned block device emulated on top of a regular file, for
+ * benchmarking without a zoned device.
+ *
+ * The device name is "emu:<path>[?<option>=<value>&...]". Zone data lives in
+ * <path>, the geometry and zone states in <path>.zones, so a file system
+ * created on an emulated device can be mounted again. Geometry options
+ * (defaults in zbd_emu.cc) only apply when the device is created:
+ *
+ *   nr_zones, zone_size_mb, zone_capacity_mb, block_size, max_open,
+ *   max_active (0 means unlimited)
+ *
+ * Latency options apply to every open of the device:
+ *
+ *   write_lat_us, write_mbps, read_lat_us, read_mbps, reset_lat_us,
+ *   finish_lat_us
+ *
+ * Writes must start at the zone write pointer and stay within the zone
+ * capacity. Zones are implicitly opened by writes and the open and active
+ * zone limits are enforced like a device would. Placing <path> on tmpfs
+ * keeps the device in memory. */
+class ZoneEmulator {
+ public:
+  static bool IsEmulated(const std::string& name);
+
+  explicit ZoneEmulator(const std::string& name);
+  ~ZoneEmulator();
+
+  /* Creates the device if it does not exist yet, fills info and returns
+   * descriptors for the data file like zbd_open() would */
+  IOStatus Open(bool readonly, struct zbd_info* info, int* read_f,
+                int* read_direct_f, int* write_f);
+
+  /* Same contract as the libzbd calls, return 0 on success */
+  int ListZones(uint64_t ofst, uint64_t len, struct zbd_zone** zones,
+                unsigned int* nr_zones);
+  int ReportZones(uint64_t ofst, uint64_t len, struct zbd_zone* zones,
+                  unsigned int* nr_zones);
+  int ResetZones(uint64_t ofst, uint64_t len);
+  int FinishZones(uint64_t ofst, uint64_t len);
+  int CloseZones(uint64_t ofst, uint64_t len);
+
+  /* Checks a write of len bytes at ofst against the zone state and moves
+   * the write pointer, must be called before the data is written */
+  int Write(uint64_t ofst, uint64_t len);
+  /* Models the latency of a read of len bytes */
+  void Read(uint64_t len);
+
+ private:
+  struct Header {
+    uint64_t magic_;
+    uint64_t nr_zones_;
+    uint64_t zone_size_;
+    uint64_t zone_capacity_;
+    uint32_t block_size_;
+    uint32_t max_open_;
+    uint32_t max_active_;
+    uint32_t pad_;
+  };
+  struct ZoneState {
+    uint64_t wp_;
+    uint32_t cond_;
+    uint32_t pad_;
+  };
+
+  std::string path_;
+  std::string options_;
+  Header geometry_;
+  uint64_t write_lat_us_ = 0;
+  uint64_t write_mbps_ = 0;
+  uint64_t read_lat_us_ = 0;
+  uint64_t read_mbps_ = 0;
+  uint64_t reset_lat_us_ = 0;
+  uint64_t finish_lat_us_ = 0;
+
+  int state_f_ = -1;
+  void* state_map_ = nullptr;
+  size_t state_map_sz_ = 0;
+  std::mutex mtx_; /* Protects the zone states and counters below */
+  ZoneState* zones_ = nullptr;
+  uint32_t nr_open_ = 0;
+  uint32_t nr_active_ = 0;
+
+  IOStatus ParseOptions();
+  IOStatus MapState(bool create);
+  ZoneState* GetZone(uint64_t ofst);
+  void FillZone(uint64_t idx, struct zbd_zone* z);
+  /* States are taken from the zones covering [ofst, ofst + len) */
+  template <typename Op>
+  int ForEachZone(uint64_t ofst, uint64_t len, Op op);
+  void SetCond(ZoneState* z, uint32_t cond);
+  static void Delay(uint64_t lat_us, uint64_t mbps, uint64_t bytes);
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !defined(ROCKSDB_LITE) && defined(OS_LINUX) && defined(LIBZBD)
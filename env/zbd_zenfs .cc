@@ -1,1728 +1,3652 @@
-// Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
-// Copyright (c) 2019-present, Western Digital Corporation
-//  This source code is licensed under both the GPLv2 (found in the
-//  COPYING file in the root directory) and Apache 2.0 License
-//  (found in the LICENSE.Apache file in the root directory).
-
-#if !defined(ROCKSDB_LITE) && !defined(OS_WIN) && defined(LIBZBD)
-
-#include "zbd_zenfs.h"
-#include "fs_zenfs.h"
-#include "exp.h"
-
-#include <stdlib.h>
-#include <fstream>
-
-#include <assert.h>
-#include <errno.h>
-#include <fcntl.h>
-#include <libzbd/zbd.h>
-#include <linux/blkzoned.h>
-#include <stdlib.h>
-#include <string.h>
-#include <sys/ioctl.h>
-#include <unistd.h>
-
-#include <string>
-#include <utility>
-#include <vector>
-#include <set>
-
-#include "io_zenfs.h"
-#include "rocksdb/env.h"
-#include "db/version_set.h"
-#include "db/dbformat.h"
-
-#define KB (1024)
-#define MB (1024 * KB)
-
-using std::cout;
-using std::endl;
-using std::fixed;
-
-/* Number of reserved zones for metadata
- * Two non-offline meta zones are needed to be able
- * to roll the metadata log safely. One extra
- * is allocated to cover for one zone going offline.
- */
-#define ZENFS_META_ZONES (3)
-
-/* Minimum of number of zones that makes sense */
-#define ZENFS_MIN_ZONES (32)
-
-/* Reserved Zone for Zone Cleaning, Set as 5 since there are five types of lietime in Rocksdb*/
-#define RESERVED_ZONE_FOR_CLEANING (10)
-
-namespace ROCKSDB_NAMESPACE {
-
-Zone::Zone(ZonedBlockDevice *zbd, struct zbd_zone *z, const uint32_t id)
-    : zbd_(zbd),
-      zone_id_(id),
-      start_(zbd_zone_start(z)),
-      max_capacity_(zbd_zone_capacity(z)),
-      wp_(zbd_zone_wp(z)),
-      open_for_write_(false),
-      is_append(false){
-  lifetime_ = Env::WLTH_NOT_SET;
-  secondary_lifetime_ = Env::WLTH_NOT_SET;
-  used_capacity_ = 0;
-  capacity_ = 0;
-  if (!(zbd_zone_full(z) || zbd_zone_offline(z) || zbd_zone_rdonly(z)))
-    capacity_ = zbd_zone_capacity(z) - (zbd_zone_wp(z) - zbd_zone_start(z));
-}
-
-bool Zone::IsUsed() { return (used_capacity_ > 0) || open_for_write_; }
-uint64_t Zone::GetCapacityLeft() { return capacity_; }
-bool Zone::IsFull() { return (capacity_ == 0); }
-bool Zone::IsEmpty() { return (wp_ == start_); }
-uint64_t Zone::GetZoneNr() { return start_ / zbd_->GetZoneSize(); }
-
-uint64_t ZonedBlockDevice::GetTotalWritten() {
-  uint64_t total = 0;
-  for (const auto z : io_zones) {
-    z->zone_df_lock_.lock();
-    total += (z->wp_ - z->start_);
-    z->zone_df_lock_.unlock();
-  }
-  return total;
-}
-
-uint64_t ZonedBlockDevice::GetReclaimableSpace() {
-  uint64_t reclaimable = 0;
-  for (const auto z : io_zones) {
-    if (z->IsFull()) reclaimable += (z->max_capacity_ - z->used_capacity_);
-  }
-  return reclaimable;
-}
-
-uint64_t ZonedBlockDevice::GetUsedSpace() {
-  uint64_t used = 0;
-  for (const auto z : io_zones) {
-    used += z->used_capacity_;
-  }
-  return used;
-}
-
-uint64_t ZonedBlockDevice::GetFreeSpace() {
-  uint64_t free = 0;
-  for (const auto z : io_zones) {
-    free += z->capacity_;
-  }
-  return free;
-}
-
-
-void Zone::CloseWR() {
-
-  assert(open_for_write_);
-  open_for_write_ = false;
-  if (Close().ok()) {
-    zbd_->NotifyIOZoneClosed();
-  }
-  if (capacity_ == 0) zbd_->NotifyIOZoneFull();
-}
-
-IOStatus Zone::Reset() {
-  size_t zone_sz = zbd_->GetZoneSize();
-  int fd = zbd_->GetWriteFD();
-  unsigned int report = 1;
-  struct zbd_zone z;
-  int ret;
-
-  assert(!IsUsed());
-
-  ret = zbd_reset_zones(fd, start_, zone_sz);
-  if (ret) return IOStatus::IOError("Zone reset failed\n");
-
-  ret = zbd_report_zones(fd, start_, zone_sz, ZBD_RO_ALL, &z, &report);
-
-  if (ret || (report != 1)) return IOStatus::IOError("Zone report failed\n");
-
-  if (zbd_zone_offline(&z))
-    capacity_ = 0;
-  else
-    max_capacity_ = capacity_ = zbd_zone_capacity(&z);
-
-  wp_ = start_;
-  lifetime_ = Env::WLTH_NOT_SET;
-
-  for(auto ext : extent_info_){
-    delete ext;
-  }
-  extent_info_.clear();
-  return IOStatus::OK();
-}
-
-IOStatus Zone::Finish() {
-  size_t zone_sz = zbd_->GetZoneSize();
-  int fd = zbd_->GetWriteFD();
-  int ret;
-
-  assert(!open_for_write_);
-
-  ret = zbd_finish_zones(fd, start_, zone_sz);
-  if (ret) return IOStatus::IOError("Zone finish failed\n");
-
-  capacity_ = 0;
-  wp_ = start_ + zone_sz;
-
-  return IOStatus::OK();
-}
-
-IOStatus Zone::Close() {
-  size_t zone_sz = zbd_->GetZoneSize();
-  int fd = zbd_->GetWriteFD();
-  int ret;
-
-  assert(!open_for_write_);
-
-  if (!(IsEmpty() || IsFull())) {
-    ret = zbd_close_zones(fd, start_, zone_sz);
-    if (ret) return IOStatus::IOError("Zone close failed\n");
-  }
-
-  return IOStatus::OK();
-}
-
-IOStatus Zone::Append(char *data, uint32_t size) {
-  char *ptr = data;
-  uint32_t left = size;
-  int fd = zbd_->GetWriteFD();
-  int ret = -1;
-
-  if (capacity_ < size)
-    return IOStatus::NoSpace("Not enough capacity for append");
-
-  assert((size % zbd_->GetBlockSize()) == 0);
-
-  while (left) {
-    ret = pwrite(fd, ptr, size, wp_);
-    if (ret < 0){
-        return IOStatus::IOError("Write failed in Zone Append");
-    }
-    ptr += ret;
-    zone_df_lock_.lock();
-    wp_ += ret;
-    zone_df_lock_.unlock();
-    capacity_ -= ret;
-    left -= ret;
-  }
-  return IOStatus::OK();
-}
-
-void Zone::Invalidate(ZoneExtent* extent) {
-
-  bool found = false;
-  if (extent == nullptr) {
-    fprintf(stderr, "Try to invalidate extent which is nullptr!\n");
-  }
-  for(const auto ex : extent_info_) {
-      if(ex->valid_){
-          if (ex->extent_ == extent) {
-              if (found) {
-                  fprintf(stderr, "Duplicate Extent in Invalidate (%p == %p)\n", ex->extent_, extent);
-              }
-              ex->invalidate();
-              found = true;
-          }
-      }
-  }
-  if (!found) {
-    fprintf(stderr, "Failed to Find extent in the zone\n");
-  }
-}
-
-void Zone::UpdateSecondaryLifeTime(Env::WriteLifeTimeHint lt, uint64_t length) {
-
-  uint64_t total_length = 0;
-  double slt = 0;
-  for (const auto e : extent_info_) {
-    total_length += e->length_;
-  }
-  for(const auto e : extent_info_) {
-    double weigth = (((double)e->length_)/(total_length));
-    slt += (weigth * (double)(e->lt_));
-  }
-  double w = (((double)length)/(total_length));
-  slt += (w * (double)(lt));
-  secondary_lifetime_ = slt;
-}
-
-ZoneExtent::ZoneExtent(uint64_t start, uint32_t length, Zone *zone)
-    : start_(start), length_(length), zone_(zone) {}
-
-Zone *ZonedBlockDevice::GetIOZone(uint64_t offset) {
-  for (const auto z : io_zones)
-    if (z->start_ <= offset && offset < (z->start_ + zone_sz_)) return z;
-  return nullptr;
-}
-
-ZonedBlockDevice::ZonedBlockDevice(std::string bdevname,
-                                   std::shared_ptr<Logger> logger)
-    : filename_("/dev/" + bdevname), logger_(logger), db_ptr_(nullptr) {
-  Info(logger_, "New Zoned Block Device: %s", filename_.c_str());
-  zc_in_progress_.store(false);
-  WR_DATA.store(0);
-  LAST_WR_DATA.store(100);
-  num_zc_cnt = 0;
-  num_reset_cnt = 0;
-};
-
-void ZonedBlockDevice::SetDBPointer(DBImpl* db) {
-    db_ptr_ = db;
-}
-
-IOStatus ZonedBlockDevice::Open(bool readonly) {
-  struct zbd_zone *zone_rep;
-  unsigned int reported_zones;
-  size_t addr_space_sz;
-  zbd_info info;
-  Status s;
-  uint64_t i = 0;
-  uint64_t m = 0;
-  uint64_t r = 0;
-  int ret;
-  uint32_t zone_cnt = 0;
-  read_f_ = zbd_open(filename_.c_str(), O_RDONLY, &info);
-  if (read_f_ < 0) {
-    return IOStatus::InvalidArgument("Failed to open zoned block device");
-  }
-
-  read_direct_f_ = zbd_open(filename_.c_str(), O_RDONLY, &info);
-  if (read_f_ < 0) {
-    return IOStatus::InvalidArgument("Failed to open zoned block device");
-  }
-
-  if (readonly) {
-    write_f_ = -1;
-  } else {
-    write_f_ = zbd_open(filename_.c_str(), O_WRONLY | O_DIRECT, &info);
-    if (write_f_ < 0) {
-      return IOStatus::InvalidArgument("Failed to open zoned block device");
-    }
-  }
-
-  if (info.model != ZBD_DM_HOST_MANAGED) {
-    return IOStatus::NotSupported("Not a host managed block device");
-  }
-
-  if (info.nr_zones < ZENFS_MIN_ZONES) {
-    return IOStatus::NotSupported(
-        "To few zones on zoned block device (32 required)");
-  }
-
-  block_sz_ = info.pblock_size;
-  zone_sz_ = info.zone_size;
-  nr_zones_ = info.nr_zones;
-
-  /* We need one open zone for meta data writes, the rest can be used for files
-   */
-  if (info.max_nr_active_zones == 0)
-    max_nr_active_io_zones_ = info.nr_zones;
-  else
-    max_nr_active_io_zones_ = info.max_nr_active_zones - 1;
-
-  if (info.max_nr_open_zones == 0)
-    max_nr_open_io_zones_ = info.nr_zones;
-  else
-    max_nr_open_io_zones_ = info.max_nr_open_zones - 1;
-  
-  Info(logger_, "Zone block device nr zones: %u max active: %u max open: %u \n",
-       info.nr_zones, info.max_nr_active_zones, info.max_nr_open_zones);
-
-  addr_space_sz = (uint64_t)nr_zones_ * zone_sz_;
-
-  ret = zbd_list_zones(read_f_, 0, addr_space_sz, ZBD_RO_ALL, &zone_rep,
-                       &reported_zones);
-
-  if (ret || reported_zones != nr_zones_) {
-    Error(logger_, "Failed to list zones, err: %d", ret);
-    return IOStatus::IOError("Failed to list zones");
-  }
-
-  while (m < ZENFS_META_ZONES && i < reported_zones) {
-    struct zbd_zone *z = &zone_rep[i++];
-    /* Only use sequential write required zones */
-    if (zbd_zone_type(z) == ZBD_ZONE_TYPE_SWR) {
-      if (!zbd_zone_offline(z)) {
-        Zone* new_zone = new Zone(this, z, zone_cnt);
-        meta_zones.push_back(new_zone);
-        id_to_zone_.insert(std::pair<int,Zone*>(zone_cnt, new_zone));
-        zone_cnt++;
-      }
-      m++;
-    }
-  }
- 
-  //(TODO)::Should reserved zone be treated as active_io_zones_?
-  while(r <= RESERVED_ZONE_FOR_CLEANING && i < reported_zones) {
-    struct zbd_zone *z = &zone_rep[i++];
-    /* Only use sequential write required zones */
-    if (zbd_zone_type(z) == ZBD_ZONE_TYPE_SWR) {
-      if (!zbd_zone_offline(z)) {
-        Zone* new_zone = new Zone(this, z, zone_cnt);
-        reserved_zones.push_back(new_zone);
-        id_to_zone_.insert(std::pair<int,Zone*>(zone_cnt, new_zone));
-        zone_cnt++;
-      }
-      r++;
-    }
-  }
-    
-  active_io_zones_ = 0;
-  open_io_zones_ = 0;
-
-  for (; i < reported_zones; i++) {
-    struct zbd_zone *z = &zone_rep[i];
-    /* Only use sequential write required zones */
-    if (zbd_zone_type(z) == ZBD_ZONE_TYPE_SWR) {
-      if (!zbd_zone_offline(z)) {
-        Zone *newZone = new Zone(this, z, zone_cnt);
-        io_zones.push_back(newZone);
-        id_to_zone_.insert(std::pair<int,Zone*>(zone_cnt, newZone));
-        zone_cnt++;
-
-        if (zbd_zone_imp_open(z) || zbd_zone_exp_open(z) ||
-            zbd_zone_closed(z)) {
-          active_io_zones_++;
-          if (zbd_zone_imp_open(z) || zbd_zone_exp_open(z)) {
-            if (!readonly) {
-              newZone->Close();
-            }
-          }
-        }
-      }
-    }
-  }
-
-  free(zone_rep);
-  start_time_ = time(NULL);
-
-  return IOStatus::OK();
-}
-
-void ZonedBlockDevice::NotifyIOZoneFull() {
-  const std::lock_guard<std::mutex> lock(zone_resources_mtx_);
-  active_io_zones_--;
-  zone_resources_.notify_one();
-}
-
-void ZonedBlockDevice::NotifyIOZoneClosed() {
-  const std::lock_guard<std::mutex> lock(zone_resources_mtx_);
-  open_io_zones_--;
-  zone_resources_.notify_one();
-}
-
-
-void ZonedBlockDevice::LogZoneStats() {
-  uint64_t used_capacity = 0;
-  uint64_t reclaimable_capacity = 0;
-  uint64_t reclaimables_max_capacity = 0;
-  uint64_t active = 0;
-  io_zones_mtx.lock();
-
-  for (const auto z : io_zones) {
-    used_capacity += z->used_capacity_;
-
-    if (z->used_capacity_) {
-      reclaimable_capacity += z->max_capacity_ - z->used_capacity_;
-      reclaimables_max_capacity += z->max_capacity_;
-    }
-
-    if (!(z->IsFull() || z->IsEmpty())) active++;
-  }
-
-  if (reclaimables_max_capacity == 0) reclaimables_max_capacity = 1;
-
-  Info(logger_,
-       "[Zonestats:time(s),used_cap(MB),reclaimable_cap(MB), "
-       "avg_reclaimable(%%), active(#), active_zones(#), open_zones(#)] %ld "
-       "%lu %lu %lu %lu %ld %ld\n",
-       time(NULL) - start_time_, used_capacity / MB, reclaimable_capacity / MB,
-       100 * reclaimable_capacity / reclaimables_max_capacity, active,
-       active_io_zones_.load(), open_io_zones_.load());
-
-  io_zones_mtx.unlock();
-}
-
-void ZonedBlockDevice::LogZoneUsage() {
-  for (const auto z : io_zones) {
-    int64_t used = z->used_capacity_;
-
-    if (used > 0) {
-      Debug(logger_, "Zone 0x%lX used capacity: %ld bytes (%ld MB)\n",
-            z->start_, used, used / MB);
-    }
-  }
-}
-
-ZonedBlockDevice::~ZonedBlockDevice() {
-  
-  for (const auto z : meta_zones) {
-    delete z;
-  }
-
-  for (const auto z : io_zones) {
-    delete z;
-  }
-  zbd_close(read_f_);
-  zbd_close(read_direct_f_);
-  zbd_close(write_f_);
-}
-
-#define LIFETIME_DIFF_NOT_GOOD (100)
-
-unsigned int GetLifeTimeDiff(Env::WriteLifeTimeHint zone_lifetime,
-                             Env::WriteLifeTimeHint file_lifetime) {
-  assert(file_lifetime <= Env::WLTH_EXTREME);
-
-  if ((file_lifetime == Env::WLTH_NOT_SET) ||
-      (file_lifetime == Env::WLTH_NONE)) {
-    if (file_lifetime == zone_lifetime) {
-      return 0;
-    } else {
-      return LIFETIME_DIFF_NOT_GOOD;
-    }
-  }
-
-  if (zone_lifetime > file_lifetime) return zone_lifetime - file_lifetime;
-
-  return LIFETIME_DIFF_NOT_GOOD;
-}
-
-double GetSLifeTimeDiff(const Zone* zone, double zone_secondary_lifetime,
-                             Env::WriteLifeTimeHint file_lifetime) {
-  assert(file_lifetime <= Env::WLTH_EXTREME);
-  uint64_t total_length = 0;
-  uint64_t expected_length = 0;
-  double slt = 0;
-
-  for(const auto e : zone->extent_info_) {
-      total_length += e->length_;
-  }
-
-  expected_length = (total_length / (zone->extent_info_.size()));
-  total_length += expected_length;
-  
-  for(const auto e : zone->extent_info_) {
-      double weigth = (((double)e->length_)/(total_length));
-      slt += (weigth * (double)(e->lt_));
-  }
-  
-  double w = (((double)expected_length)/(total_length));
-  slt += (w * (double)(file_lifetime));
-
-  if (zone_secondary_lifetime >= slt){
-    return zone_secondary_lifetime - slt;
-  }    
-  
-  return slt - zone_secondary_lifetime;
-}
-
-Zone *ZonedBlockDevice::AllocateMetaZone() {
-  for (const auto z : meta_zones) {
-    /* If the zone is not used, reset and use it */
-    if (!z->IsUsed()) {
-      if (!z->IsEmpty()) {
-        if (!z->Reset().ok()) {
-          Warn(logger_, "Failed resetting zone!");
-          continue;
-        }
-      }
-      return z;
-    }
-  }
-  return nullptr;
-}
-
-void ZonedBlockDevice::ResetUnusedIOZones() {
-  const std::lock_guard<std::mutex> lock(zone_resources_mtx_);
-  /* Reset any unused zones */
-  for (const auto z : io_zones) {
-    if (!z->IsUsed() && !z->IsEmpty()) {
-      if (!z->IsFull()) active_io_zones_--;
-      if (!z->Reset().ok()) Warn(logger_, "Failed reseting zone");
-    }
-  }
-}
-/*(TODO)
-void ZonedBlockDevice::PickZoneWithCompactionVictim(std::vector<Zone*>& candidates) {
- io_zones_mtx should be locked before the function is called 
-
-    std::vector<uint64_t> fno_list;
-    db_ptr_->GetCompactionArgs(fno_list);
-}
-*/
-void ZonedBlockDevice::PickZoneWithOnlyInvalid(std::vector<Zone*>& candidates) {
-/* io_zones_mtx should be locked before the function is called */
-    for (const auto z : io_zones) {
-       if ((!z->IsUsed()) && (!z->IsEmpty()) && (!z->IsFull()) ) {
-         candidates.push_back(z);
-       }
-    }
-}
-void ZonedBlockDevice::SortZone(){
-
-  while (!allocate_queue_.empty()) {
-     AllocVictimZone* a = allocate_queue_.top();
-     allocate_queue_.pop();
-     delete a;
-  }
-  for (const auto z : io_zones) {
-   if(z->IsFull() || z->open_for_write_) continue;
-
-   uint64_t valid_extent_length = 0;
-   uint64_t invalid_extent_length = 0;
-   
-   for (auto ext_info: z->extent_info_) {
-    if (ext_info->valid_) {
-      uint64_t cur_length = (uint64_t)ext_info->length_;
-      uint64_t align = (uint64_t)(cur_length % block_sz_);
-      uint64_t pad = 0;
-      if (align) {
-        pad = block_sz_ - align;
-      }
-      valid_extent_length += (cur_length + pad);
-    } else {
-      uint64_t cur_length = (uint64_t)ext_info->length_;
-      uint64_t align = (uint64_t)(cur_length % block_sz_);
-      uint64_t pad = 0;
-      if (align) {
-        pad = block_sz_ - align;
-      }
-      invalid_extent_length += (cur_length + pad);
-    }
-   }
-   //Insert into queue with sorting by its invalid ratio. 
-   ///Higher the invalid ratio, Higher the priority.
-   allocate_queue_.push(new AllocVictimZone(z, invalid_extent_length, valid_extent_length));
- }
- //assert(!allocate_queue_.empty());
-};
-
-Zone* ZonedBlockDevice::AllocateZoneWithSameLevelFiles(const std::vector<uint64_t>& fno_list, const InternalKey smallest, const InternalKey largest) {
-   
-    Zone* allocated_zone = nullptr;
-    const InternalKeyComparator* icmp = db_ptr_->GetDefaultICMP();
-    int l_idx, r_idx;
-
-
-    if (fno_list.empty()) {//ûͬļ
-      return allocated_zone;
-    }
-
-
-    if (fno_list.size() == 1) {//ֻһͬļ
-     sst_zone_mtx_.lock();
-     auto zids = sst_to_zone_.find(fno_list[0])->second;//ļŲļŶӦzone
-     for (int zid : zids) {
-       Zone* z = id_to_zone_.find(zid)->second;//ͨzoneҵzone
-       if (!z->open_for_write_ && !z->IsFull() && !z->open_for_write_) {
-         allocated_zone = z;//ûҲдͷzone
-       }
-     }
-     sst_zone_mtx_.unlock();
-     return allocated_zone;
-    }
-
-    //Find the case.
-    //case(1) cur SSTable has smallest key.
-    //case(2) cur SSTable has largest key.
-    //case(3) cur SSTable has middle key.
-
-    int idx;
-    files_mtx_.lock();
-    for (idx = 0; idx < (int)fno_list.size(); idx++) {//ļб
-        InternalKey s, l;
-        s = files_.find(fno_list[idx])->second->smallest_;//ͨļűzonefileõС
-        l = files_.find(fno_list[idx])->second->largest_;
-        int res = icmp->Compare(largest,s);
- 
-        if (res <= 0) {
-          assert(icmp->Compare(smallest,l) <= 0);
-          break;
-        }
-    }
-    files_mtx_.unlock();
-    l_idx = idx - 1;
-    r_idx = idx;
-
-    if ( l_idx < 0 ) { // case(1)дļͬ㼶ļkeyС
-     for (uint64_t fno : fno_list) {
-      sst_zone_mtx_.lock();
-      auto zids = sst_to_zone_.find(fno)->second;
-      for (int zid : zids) {
-       Zone* z = id_to_zone_.find(zid)->second;
-       if (!z->open_for_write_ && !z->IsFull()) {
-         allocated_zone = z;//ҵһдͬļд
-         break;
-       }
-      }
-      sst_zone_mtx_.unlock();
-      if (allocated_zone) break;
-     }   
-    } else if (r_idx == (int)fno_list.size()) { // case(2)
-     for (auto it = fno_list.rbegin(); it != fno_list.rend(); ++it) {//list
-       sst_zone_mtx_.lock();
-       auto zids = sst_to_zone_.find(*it)->second;
-       for (int zid : zids) {
-         Zone* z = id_to_zone_.find(zid)->second;
-         if (!z->open_for_write_ && !z->IsFull()) {
-           allocated_zone = z;
-           break;
-         }
-       }
-       sst_zone_mtx_.unlock();
-       if (allocated_zone) break;
-     }       
-    } else {
-     while ((l_idx >=0) && (r_idx < (int)fno_list.size())) {
-       if (l_idx >=0) {
-         sst_zone_mtx_.lock();
-         auto zids = sst_to_zone_.find(l_idx)->second;
-         for (int zid : zids) {
-           Zone* z = id_to_zone_.find(zid)->second;
-           if (!z->open_for_write_ && !z->IsFull()) {
-            allocated_zone = z;
-            break;
-           }
-         }
-         sst_zone_mtx_.unlock();
-         l_idx--;
-         if(allocated_zone) break;
-       }
-       if (r_idx < (int)fno_list.size()) {
-         sst_zone_mtx_.lock();
-         auto zids = sst_to_zone_.find(r_idx)->second;
-         for (int zid : zids) {
-           Zone* z = id_to_zone_.find(zid)->second;
-           if (!z->open_for_write_ && !z->IsFull()) {
-            allocated_zone = z;
-            break;
-           }
-         }
-         sst_zone_mtx_.unlock();
-         r_idx++;
-         if (allocated_zone) break;
-       }
-     }
-    }
-    return allocated_zone;
-}
-
-Zone* ZonedBlockDevice::AllocateMostL0Files(const std::set<int>& zone_list) {
-
-    uint64_t max = 0;
-    Zone* z = nullptr;
-
-    if (zone_list.empty()) 
-      return z;
-
-    for (const auto z_id : zone_list) {
-      Zone* zone = id_to_zone_.find(z_id)->second;
-      uint64_t length = 0;
-      
-      if (!zone->open_for_write_ && !zone->IsFull()) {
-        for (const auto& ext : zone->extent_info_) {
-          if (ext->level_ == 0 && ext->valid_) {
-              length += ext->length_;    
-          }
-        }
-        if (length >= max){ 
-          max = length;
-          z = zone;
-        }
-      }
-    }
-    return z;
-}
-
-void ZonedBlockDevice::SameLevelFileList(const int level, std::vector<uint64_t>& fno_list){
-    fno_list.clear();
-    db_ptr_->SameLevelFileList(level, fno_list);
-}
-
-void ZonedBlockDevice::AdjacentFileList(const InternalKey& s, const InternalKey& l, const int level, std::vector<uint64_t>& fno_list){
-    if(level == 100) return;
-    db_ptr_->AdjacentFileList(s, l, level, fno_list);
-}
-void ZonedBlockDevice::AllFile(const InternalKey& s, const InternalKey& l,std::vector<uint64_t>& fno_list) {//ȡȫ㼶ļ
-   fno_list.clear();
-   int levelnum = db_ptr_->Getlevel();
-   for (int level = 0; level < levelnum; ++level) {
-     std::vector<uint64_t> temp_list;
-     SameLevelFileList(level, temp_list);
-     fno_list.insert(fno_list.end(), temp_list.begin(), temp_list.end());
-    }
-}
-uint64_t ZonedBlockDevice::hexToUint64(const std::string& hex) {
-  uint64_t result = 0;
-  std::stringstream ss;
-  ss << std::hex << hex;
-  ss >> result;
-  return result;
-}
-uint64_t ZonedBlockDevice::HexString(ParsedInternalKey* result) {
-  std::string newstring = result.UserkeyString();
-  return hexToUint64(newstring);
-
-
-}
-Zone* ZonedBlockDevice::AllocateZone(Env::WriteLifeTimeHint file_lifetime,
-                                     InternalKey smallest, InternalKey largest,
-                                     int level) {
-
-  Zone *allocated_zone = nullptr;
-  unsigned int best_diff = LIFETIME_DIFF_NOT_GOOD;
-  Status s;
-  
-  io_zones_mtx.lock();
-  /* Make sure we are below the zone open limit */
-  {
-    std::unique_lock<std::mutex> lk(zone_resources_mtx_);
-    zone_resources_.wait(lk, [this] {
-      if (open_io_zones_.load() < max_nr_open_io_zones_) return true;
-      return false;
-    });
-  }
-  
-  /* Sort Zone by follows rules
-   * (1) has more valid data
-   * (2) has less invalid data */
-  SortZone();
-  /* Reset any unused zones and finish used zones under capacity treshold*/
-  for (const auto z : io_zones) {
-    if (z->open_for_write_ || z->IsEmpty() || (z->IsFull() && z->IsUsed()))
-      continue;
-    
-    if (!z->IsUsed())  {
-      if (!z->IsFull()) active_io_zones_--;
-      bool all_invalid = true;
-      
-      for (auto exinfo : z->extent_info_) {
-        if (exinfo->valid_ == true) {
-          all_invalid = false;
-        }
-      }
-      assert(all_invalid);
-      s = z->Reset();
-
-      if (!s.ok()) {
-        Debug(logger_, "Failed resetting zone !");
-      }
-      continue;
-    }
-    
-    if ((z->capacity_ < (z->max_capacity_ * finish_threshold_ / 100))) {
-      /* If there is less than finish_threshold_% remaining capacity in a
-       * non-open-zone, finish the zone */
-      s = z->Finish();
-      if (!s.ok()) {
-        Debug(logger_, "Failed finishing zone");
-      }
-      active_io_zones_--;
-    }
-  }
-#ifndef LAZY
-  {
-    uint64_t free = GetFreeSpace();
-    size_t nr_zones = io_zones.size();
-    uint64_t total = (nr_zones * io_zones[0]->max_capacity_);
-    //fprintf(stderr, "total : %zu , free : %zu\n", total, free);
-    double free_ratio = (((double)free / total) * 100);
-
-    bool trigger_zc = free_ratio <= 25.0f;
-   
-    if (trigger_zc) {
-      uint64_t num_zone_to_reset;
-      if (free_ratio > 25.0f) {
-          num_zone_to_reset = nr_zones / 15;   
-      } else if (free_ratio > 20.0f) {
-          num_zone_to_reset = nr_zones / 10;       
-      } else {
-          num_zone_to_reset = nr_zones / 5;       
-      }
-      while (!gc_queue_.empty()){
-        auto a = gc_queue_.top();
-        delete a;
-        gc_queue_.pop();
-      }
-    for (auto z : io_zones) {
-        uint64_t valid_extent_length = 0;
-        uint64_t invalid_extent_length = 0;
-        std::vector<ZoneExtentInfo *> invalid_list;
-        std::vector<ZoneExtentInfo *> valid_list;
-        for(auto ext_info: z->extent_info_) {
-          
-          //    Busy wait til Append request to the zone completed.
-          //    No need to check the condition in the loop 
-          //    since zone is allocated to one file at each time.
-            
-            while(z->is_append.load()){ }
-            
-            if(ext_info->valid_) {
-                uint64_t cur_length = (uint64_t)ext_info->length_;
-                uint64_t align = (uint64_t)(cur_length % block_sz_);
-                uint64_t pad = 0;
-                if(align){
-                    pad = block_sz_ - align;
-                }
-                valid_extent_length += (cur_length + pad);
-                valid_list.push_back(ext_info);
-            }else {
-                uint64_t cur_length = (uint64_t)ext_info->length_;
-                uint64_t align = (uint64_t)(cur_length % block_sz_);
-                uint64_t pad = 0;
-                if(align){
-                    pad = block_sz_ - align;
-                }
-                invalid_extent_length += (cur_length + pad);
-                invalid_list.push_back(ext_info);
-            }
-        }
-        //Insert into queue with sorting by its invalid ratio. 
-        //Higher the invalid ratio, Higher the priority.
-        if (invalid_extent_length > 0 && !z->open_for_write_) {
-          gc_queue_.push(new GCVictimZone(z, invalid_extent_length));
-        }
-    }
-   ZoneCleaning(num_zone_to_reset);
-  }
- }
-#endif
-
-  if (sst_to_zone_.empty()) {//ûsstzone
-    if (active_io_zones_.load() < max_nr_active_io_zones_) {
-      for (const auto z : io_zones) {//ֱһյzoneԭдzoneз
-        if ((!z->open_for_write_) && z->IsEmpty()) {
-          z->lifetime_ = file_lifetime;
-          allocated_zone = z;
-          active_io_zones_++;
-          break;
-        }
-      }
-    }
-  }
-  if (allocated_zone) {
-    assert(!allocated_zone->open_for_write_);
-    allocated_zone->open_for_write_ = true;
-    open_io_zones_++;
-    io_zones_mtx.unlock();
-    return allocated_zone;
-  }
-  assert(!allocated_zone);
-
-  // There's valid SSTables in Zones
-  // Find zone where the files located at adjacent level and having overlapping keys
-  std::vector<uint64_t> fno_list;
-  std::vector<Zone*> candidates;
-  //AdjacentFileList(smallest, largest, level, fno_list);//fnolistõ²㼶صlist
-  GetAllOverlappingFiles(smallest, largest,fno_list)//ȡвصļ
-      if (!fno_list.empty()) {
-    std::vector<std::pair<uint64_t, double>> overlap_ratios;
-    double maxoverlap = 0.0
-    int idx;
-    files_mtx_.lock();
-    for (idx = 0; idx < (int)fno_list.size(); idx++) {
-      InternalKey s, l,max,min,overmin,overmax;
-      s = files_.find(fno_list[idx])->second->smallest_;
-      l = files_.find(fno_list[idx])->second->largest_;
-      if (icmp->Compare(l, largest) <= 0) {
-        max = largest;
-        overmax = l;
-      } else {
-        max = l;
-        overmax = largest;
-      }
-      if (icmp->Compare(s, smallest) <= 0) {
-        min = s;
-        overmin = smallest;
-      } else {
-        min = smallest;
-        overmin = s;
-      }
-      ParsedInternalKey fullmax, fullmin, fullovermax, fullovermin;
-      ParseInternalKey(max, &fullmax);
-      ParseInternalKey(min, &fullmin);
-      ParseInternalKey(overmax, &fullovermax);
-      ParseInternalKey(overmin, &fullovermin);
-      uint64_t num_max, num_min, num_overmax, num_overmin;
-      num_max = HexString(fullmax);
-      num_min = HexString(fullmin);
-      num_overmax = HexString(fullovermax);
-      num_overmin = HexString(fullovermin);
-      double radio = (num_overmax - num_overmin) / (numm_max - num_min);
-      overlap_ratios.emplace_back(fno_list[idx], ratio);
-      
-    }
-    files_mtx_.unlock();
-
-    // ʽ
-    std::sort(overlap_ratios.begin(), overlap_ratios.end(),
-              [](const std::pair<uint64_t, double>& a,
-                 const std::pair<uint64_t, double>& b) {
-                return a.second > b.second;
-              });
-
-    //  fno_list ˳
-    fno_list.clear();
-    for (const auto& entry : overlap_ratios) {
-      fno_list.push_back(entry.first);
-    }
-      }
-   if (!fno_list.empty()) {  //صļбΪ
-    // There are SSTables with overlapped keys and adjacent level.
-    // (1) Find the Zone where the SSTables are written
-    std::set<int> zone_list;
-    sst_zone_mtx_.lock();
-    for (uint64_t fno : fno_list) {
-      auto z = sst_to_zone_.find(fno);
-      if (z != sst_to_zone_.end()) {
-        for (int zone_id : z->second) {
-          zone_list.insert(zone_id);  //zoneᵽzonelist
-        }
-      }
-    }
-    sst_zone_mtx_.unlock();
-
-    // (2) Pick the Zones with free space as candidates
-    for (const auto z : io_zones) {
-      auto search = zone_list.find(z->zone_id_);
-      if (search != zone_list.end()) {
-        if (!z->IsFull() && !z->open_for_write_) {
-          candidates.push_back(z);  //zoneΪѡ
-        }
-      }
-    } 
-     
-    if (!candidates.empty()) {
-      uint64_t alloc_inval_data = 0;
-      double maxoverlap_ratio = 0;
-      for (const auto z : candidates) {
-        uint64_t inval_data = 0;
-        for (const auto ext :z->extent_info_) {  //ÿһ_zone extent
-          if (!ext->valid_) {
-            inval_data += ext->length_;
-          } 
-            }
-        if (!z->open_for_write_) {
-          allocated_zone = z;
-          alloc_inval_data = inval_data;
-          break;
-          }
-          
-          }
-          }
-        
-      
-  } else if (fno_list.empty() && (level==0 || level==100 )) {
-
-   /* (1) There is no matching files being overlapped with current file
-        ->(TODO)Find the file within the same level which has smallest key diff*/
-    std::set<int> zone_list;
-    // L0 files are often compacted altogether.
-    // Allocate to the zone where other L0 or L1 files are located.
-    SameLevelFileList(0, fno_list);
-
-    sst_zone_mtx_.lock();
-    for (uint64_t fno : fno_list) {
-      auto z = sst_to_zone_.find(fno);
-      if (z != sst_to_zone_.end()) {
-        for (int zone_id : z->second) {
-          zone_list.insert(zone_id);
-        }
-      }
-    }
-    sst_zone_mtx_.unlock();
-    //Allocate Zones with most the number of L0 files
-    allocated_zone = AllocateMostL0Files(zone_list);
-  }
-
-  //Find the Empty Zone First
-  if (!allocated_zone) {
-    if (active_io_zones_.load() < max_nr_active_io_zones_) {
-      for (const auto z : io_zones) {
-       if ((!z->open_for_write_) && z->IsEmpty()) {
-        z->lifetime_ = file_lifetime;
-        allocated_zone = z;
-        active_io_zones_++;
-        break;
-       }
-      }
-    }
-  }
-
-  if (allocated_zone){
-    assert(!allocated_zone->open_for_write_);
-    allocated_zone->open_for_write_ = true;
-    open_io_zones_++;
-    io_zones_mtx.unlock();
-    LogZoneStats();
-    return allocated_zone;
-  }
-
-  if (!allocated_zone) {
-    SameLevelFileList(level, fno_list);
-    allocated_zone = AllocateZoneWithSameLevelFiles(fno_list, smallest, largest);
-  }
-
-  if (allocated_zone) {
-    assert(!allocated_zone->open_for_write_);
-    allocated_zone->open_for_write_ = true;
-    open_io_zones_++;
-    io_zones_mtx.unlock();
-    return allocated_zone;
-  }
-  
-  /* Try to fill an already open zone(with the best life time diff) */
-  for (const auto z : io_zones) {
-    if ((!z->open_for_write_) && (z->used_capacity_ > 0) && !z->IsFull()) {
-      unsigned int diff = GetLifeTimeDiff(z->lifetime_, file_lifetime);
-      if (diff <= best_diff) {
-        allocated_zone = z;
-        best_diff = diff;
-      }
-    }
-  }
-
-  if (allocated_zone) {
-    assert(!allocated_zone->open_for_write_);
-    allocated_zone->open_for_write_ = true;
-    open_io_zones_++;
-    io_zones_mtx.unlock();
-    return allocated_zone;
-  }
-
-#ifndef LAZY
-  if (!allocated_zone) {
-   while (!gc_queue_.empty()){
-      auto a = gc_queue_.top();
-      delete a;
-      gc_queue_.pop();
-   }
-  //Trigger GC for reclaim free space in the Device.
-  //(Step 1) Classify all active zones by its invalid data ratio.
-    uint64_t total_invalid = 0;
-    for (auto z : io_zones) {
-        uint64_t valid_extent_length = 0;
-        uint64_t invalid_extent_length = 0;
-        std::vector<ZoneExtentInfo *> invalid_list;
-        std::vector<ZoneExtentInfo *> valid_list;
-        for(auto ext_info: z->extent_info_) {
-            /*
-              Busy wait til Append request to the zone completed.
-              No need to check the condition in the loop 
-              since zone is allocated to one file at each time.
-            */
-            while(z->is_append.load()){ }
-            
-            if(ext_info->valid_) {
-                uint64_t cur_length = (uint64_t)ext_info->length_;
-                uint64_t align = (uint64_t)(cur_length % block_sz_);
-                uint64_t pad = 0;
-                if(align){
-                    pad = block_sz_ - align;
-                }
-                valid_extent_length += (cur_length + pad);
-                valid_list.push_back(ext_info);
-            }else {
-                uint64_t cur_length = (uint64_t)ext_info->length_;
-                uint64_t align = (uint64_t)(cur_length % block_sz_);
-                uint64_t pad = 0;
-                if(align){
-                    pad = block_sz_ - align;
-                }
-                invalid_extent_length += (cur_length + pad);
-                total_invalid += invalid_extent_length;
-                invalid_list.push_back(ext_info);
-            }
-        }
-        //Insert into queue with sorting by its invalid ratio. 
-        //Higher the invalid ratio, Higher the priority.
-        if (invalid_extent_length > 0 && !z->open_for_write_) {
-          gc_queue_.push(new GCVictimZone(z, invalid_extent_length));
-        }
-    }
-  uint64_t num_zone_to_reset;
-  if (total_invalid  < io_zones[0]->max_capacity_ ){
-    num_zone_to_reset = 0;
-  } else {
-    num_zone_to_reset = RESERVED_ZONE_FOR_CLEANING;
-  }
-  ZoneCleaning(num_zone_to_reset);
-  }
-
-  fno_list.clear();
-  candidates.clear();
-  //AdjacentFileList(smallest, largest, level, fno_list);
-  GetAllOverlappingFiles(smallest, largest,
-                         fno_list)  //ȡвصļ
-      if (!fno_list.empty()) {
-    std::vector<std::pair<uint64_t, double>> overlap_ratios;
-    double maxoverlap = 0.0 int idx;
-    files_mtx_.lock();
-    for (idx = 0; idx < (int)fno_list.size(); idx++) {
-      InternalKey s, l, max, min, overmin, overmax;
-      s = files_.find(fno_list[idx])->second->smallest_;
-      l = files_.find(fno_list[idx])->second->largest_;
-      if (icmp->Compare(l, largest) <= 0) {
-        max = largest;
-        overmax = l;
-      } else {
-        max = l;
-        overmax = largest;
-      }
-      if (icmp->Compare(s, smallest) <= 0) {
-        min = s;
-        overmin = smallest;
-      } else {
-        min = smallest;
-        overmin = s;
-      }
-      ParsedInternalKey fullmax, fullmin, fullovermax, fullovermin;
-      ParseInternalKey(max, &fullmax);
-      ParseInternalKey(min, &fullmin);
-      ParseInternalKey(overmax, &fullovermax);
-      ParseInternalKey(overmin, &fullovermin);
-      uint64_t num_max, num_min, num_overmax, num_overmin;
-      num_max = HexString(fullmax);
-      num_min = HexString(fullmin);
-      num_overmax = HexString(fullovermax);
-      num_overmin = HexString(fullovermin);
-      double radio = (num_overmax - num_overmin) / (numm_max - num_min);
-      overlap_ratios.emplace_back(fno_list[idx], ratio);
-    }
-    files_mtx_.unlock();
-
-    // ʽ
-    std::sort(overlap_ratios.begin(), overlap_ratios.end(),
-              [](const std::pair<uint64_t, double>& a,
-                 const std::pair<uint64_t, double>& b) {
-                return a.second > b.second;
-              });
-
-    //  fno_list ˳
-    fno_list.clear();
-    for (const auto& entry : overlap_ratios) {
-      fno_list.push_back(entry.first);
-    }
-  }
-  if (!fno_list.empty()) {  //صļбΪ
-    // There are SSTables with overlapped keys and adjacent level.
-    // (1) Find the Zone where the SSTables are written
-    std::set<int> zone_list;
-    sst_zone_mtx_.lock();
-    for (uint64_t fno : fno_list) {
-      auto z = sst_to_zone_.find(fno);
-      if (z != sst_to_zone_.end()) {
-        for (int zone_id : z->second) {
-          zone_list.insert(zone_id);  //zoneᵽzonelist
-        }
-      }
-    }
-    sst_zone_mtx_.unlock();
-
-    // (2) Pick the Zones with free space as candidates
-    for (const auto z : io_zones) {
-      auto search = zone_list.find(z->zone_id_);
-      if (search != zone_list.end()) {
-        if (!z->IsFull() && !z->open_for_write_) {
-          candidates.push_back(z);  //zoneΪѡ
-        }
-      }
-    }
-
-    if (!candidates.empty()) {
-      uint64_t alloc_inval_data = 0;
-      double maxoverlap_ratio = 0;
-      for (const auto z : candidates) {
-        uint64_t inval_data = 0;
-        for (const auto ext :
-             z->extent_info_) {  //ÿһ_zone extent
-          if (!ext->valid_) {
-            inval_data += ext->length_;
-          }
-        }
-        if (!z->open_for_write_) {
-          allocated_zone = z;
-          alloc_inval_data = inval_data;
-          break;
-        }
-      }
-    }
-  } 
-  /* if (!fno_list.empty()) {
-   // There are SSTables with overlapped keys and adjacent level.
-      //(1) Find the Zone where the SSTables are written 
-    std::set<int> zone_list;
-    sst_zone_mtx_.lock();
-    for (uint64_t fno : fno_list) {
-      auto z = sst_to_zone_.find(fno);
-      if (z != sst_to_zone_.end()) {
-        for (int zone_id : z->second) {
-          zone_list.insert(zone_id);
-        }
-      }
-    }
-    sst_zone_mtx_.unlock();
-    // (2) Pick the Zones with free space as candidates
-    for (const auto z : io_zones) {
-      auto search = zone_list.find(z->zone_id_);
-      if (search != zone_list.end()){
-        if (!z->IsFull() && !z->open_for_write_) {
-          candidates.push_back(z);
-        }
-      }
-    }
-    if (!candidates.empty()) {
-
-      // There is at least one zone having free space 
-      // If there's more than one zone, pick the zone with most data with overlapped SST
-      uint64_t overlapped_data = 0;
-      uint64_t alloc_inval_data = 0;
-      for (const auto z : candidates) {
-        uint64_t data_amount = 0;
-        uint64_t inval_data = 0;
-        for (const auto ext : z->extent_info_) {
-           if (!ext->valid_) {
-             inval_data += ext->length_;
-           } else if (ext->valid_ && ext->zone_file_->is_sst_) {
-             uint64_t cur_fno = ext->zone_file_->fno_;
-             for (uint64_t fno : fno_list) {
-                if (cur_fno == fno ) {
-                   data_amount += ext->length_; 
-                }
-             }
-           }
-           if (data_amount > overlapped_data && !z->open_for_write_) {
-             allocated_zone = z;
-             alloc_inval_data = inval_data;
-           } else if ((data_amount == overlapped_data) && (alloc_inval_data > inval_data) && !z->open_for_write_ ) {
-             allocated_zone = z;
-             alloc_inval_data = inval_data;
-           }
-        }
-      }
-    }  
-  }*/ else if (fno_list.empty() && (level == 0 || level==100)) {
-    /* (1) There is no matching files being overlapped with current file
-        ->(TODO)Find the file within the same level which has smallest key diff*/
-    std::set<int> zone_list;
-    // L0 files are often compacted altogether.
-    // Allocate to the zone where other L0 or L1 files are located.
-    SameLevelFileList(0, fno_list);
-    sst_zone_mtx_.lock();
-    for (uint64_t fno : fno_list) {
-      auto z = sst_to_zone_.find(fno);
-      if (z != sst_to_zone_.end()) {
-        for (int zone_id : z->second) {
-          zone_list.insert(zone_id);
-        }
-      }
-    }
-    sst_zone_mtx_.unlock();
-    //Allocate Zones with most the number of L0 files
-    allocated_zone = AllocateMostL0Files(zone_list);
-  }
-  //Find the Empty Zone First
-  if (!allocated_zone) {
-    if (active_io_zones_.load() < max_nr_active_io_zones_) {
-      for (const auto z : io_zones) {
-       if ((!z->open_for_write_) && z->IsEmpty()) {
-        z->lifetime_ = file_lifetime;
-        allocated_zone = z;
-        active_io_zones_++;
-        break;
-       }
-      }
-    }
-  }
-  if (allocated_zone){
-    assert(!allocated_zone->open_for_write_);
-    allocated_zone->open_for_write_ = true;
-    open_io_zones_++;
-    io_zones_mtx.unlock();
-    return allocated_zone;
-  }
-  
-  if (!allocated_zone && level != 100) {
-    SameLevelFileList(level, fno_list);
-    allocated_zone = AllocateZoneWithSameLevelFiles(fno_list, smallest, largest);
-  }
-
-  if (allocated_zone) {
-    assert(!allocated_zone->open_for_write_);
-    allocated_zone->open_for_write_ = true;
-    open_io_zones_++;
-    io_zones_mtx.unlock();
-    return allocated_zone;
-  }
-  
-  /* Try to fill an already open zone(with the best life time diff) */
-  for (const auto z : io_zones) {
-    if ((!z->open_for_write_) && (z->used_capacity_ > 0) && !z->IsFull()) {
-      unsigned int diff = GetLifeTimeDiff(z->lifetime_, file_lifetime);
-      if (diff <= best_diff) {
-        allocated_zone = z;
-        best_diff = diff;
-      }
-    }
-  }
-
-  if (allocated_zone) {
-    assert(!allocated_zone->open_for_write_);
-    allocated_zone->open_for_write_ = true;
-    open_io_zones_++;
-    io_zones_mtx.unlock();
-    return allocated_zone;
-  }
-#endif
-  io_zones_mtx.unlock();
-  LogZoneStats();
-
-  return allocated_zone;
-}
-
-std::string ZonedBlockDevice::GetFilename() { return filename_; }
-uint32_t ZonedBlockDevice::GetBlockSize() { return block_sz_; }
-
-Zone *ZonedBlockDevice::AllocateZoneForCleaning() {
-
-  Zone *allocated_zone = nullptr;
-  Status s;
-
-  /* Make sure we are below the zone open limit */
-  {
-    std::unique_lock<std::mutex> lk(zone_resources_mtx_);
-    zone_resources_.wait(lk, [this] {
-      if (open_io_zones_.load() < max_nr_open_io_zones_) return true;
-      return false;
-    });
-  }
-
-  allocated_zone = reserved_zones[0];
-
-  if (!allocated_zone) {
-      printZoneStatus(reserved_zones);
-      fprintf(stderr, "Allocate Zone Failed While Running Zone Cleaning!\n");
-      exit(1);
-  }
-  assert(!allocated_zone->open_for_write_);
-  allocated_zone->open_for_write_ = true;
-  open_io_zones_++;
-
-  return allocated_zone;
-}
-
-void ZonedBlockDevice::printZoneStatus(const std::vector<Zone *>& zones){
-
-    for (auto z : zones) {
-        
-        fprintf(stderr, "start : %ld\n", z->start_);
-        fprintf(stderr, "wp_ : %ld\n", z->wp_);
-        fprintf(stderr, "capacity_ : %ld\n", z->capacity_);
-        fprintf(stderr, "used_capacity_ : %ld\n", z->used_capacity_.load());
-
-        if(z->open_for_write_) {
-            fprintf(stderr, "open_for_write_ : true\n");
-        }else{
-            fprintf(stderr, "open_for_write_ : false\n");
-        }
-        
-        if(z->IsUsed()) {
-            fprintf(stderr, "is_used : true\n");
-        }else{
-            fprintf(stderr, "is_used : false\n");
-        }
-
-        if(z->IsFull()) {
-            fprintf(stderr, "is_full : true\n");
-        }else{
-            fprintf(stderr, "is_full : false\n");
-        }
-
-        if(z->IsEmpty()) {
-            fprintf(stderr, "is_empty : true\n");
-        }else{
-            fprintf(stderr, "is_empty : false\n");
-        }
-        fprintf(stderr, "\n\n");
-    }
-}
-
-/*
- ZoneCleaning
- (1) Select zone with most invalid data.
- (2) Process until every invalid data gets cleaned from zone.
-*/
-int ZonedBlockDevice::ZoneCleaning(int nr_reset) {
-
-    zone_cleaning_mtx.lock();
-    int reseted = 0;
-
-    if (nr_reset == 0){
-       for (auto it = reserved_zones.begin(); it != reserved_zones.end(); ){
-          io_zones.push_back(*it);
-          reserved_zones.erase(it);
-          break;
-       }
-      zone_cleaning_mtx.unlock();
-      return 0;
-    }
-
-#ifdef EXPERIMENT
-    uint64_t copied_data = 0;
-#endif
-    Zone* allocated_zone = nullptr;
-    while(!gc_queue_.empty()){
-        //Process until every invalid data gets cleaned from zone.
-        Zone* cur_victim = gc_queue_.top()->get_zone_ptr();
-        int victim_zone_id = cur_victim->zone_id_;
-        assert(cur_victim);
-
-        //PrintVictimInformation(cur_victim, true);
-
-        //Find the valid extents in currently selected zone.
-        //Should recognize which file each extent belongs to.
-        std::vector<ZoneExtentInfo *> valid_extents_info;
-
-        for (auto exinfo : cur_victim->extent_info_){
-           if (exinfo->valid_ == true) {
-             valid_extents_info.push_back(exinfo);
-           }
-        }
-        
-        //(1) Find which ZoneFile current extents belongs to.
-        //(2) Check Each lifetime of file to which each extent belongs to.    
-        for(ZoneExtentInfo* ext_info : valid_extents_info) {
-            //Extract All the inforamtion from Extents inforamtion structure
-            assert(cur_victim == ext_info->extent_->zone_);
-            ZoneExtent* zone_extent = ext_info->extent_;
-            ZoneFile* zone_file = ext_info->zone_file_;
-            
-            zone_file->ExtentWriteLock();
-
-            assert(zone_extent && zone_file);
-
-            //extract the contents of the current extent
-            uint32_t valid_size = zone_extent->length_; 
-            uint32_t data_size = valid_size;
-            uint32_t pad_sz = 0;
-            uint32_t align = valid_size % block_sz_;
-
-            if (align) {
-              uint32_t block_nr = (valid_size / block_sz_) + 1;
-              data_size = block_sz_ * block_nr;
-              pad_sz = block_sz_ - align; 
-            }
-
-            char* buff;
-            int ret = posix_memalign((void**)&buff, GetBlockSize(), data_size);
-
-            if(ret) {
-              fprintf(stderr, "Zone Cleaning : failed allocating alignment write buffer\n");
-            }
-
-            int f = GetReadFD();
-            int f_direct = GetReadDirectFD();
-            ssize_t r = 0;
-            uint64_t r_off = zone_extent->start_;
-
-            r = pread(f, buff, zone_extent->length_, r_off);
-            
-            if (r < 0) {
-              r = pread(f_direct, buff, zone_extent->length_, r_off);
-            }
-            assert(r >= 0);
-            
-            if (pad_sz > 0) {
-              memset((char*)buff + valid_size, 0x0, pad_sz); 
-            }
-
-            //allocate Zone and write contents.
-            allocated_zone = AllocateZoneForCleaning();
-            assert(allocated_zone);
-
-            //Copy contents to new zone.
-            {
-                IOStatus s;
-                uint32_t left = data_size;
-                uint32_t wr_size, offset = 0;
-                uint32_t new_extent_length = 0;
-                std::vector<ZoneExtent *> new_zone_extents;
-
-                while (left) { 
-                    assert(allocated_zone);                   
-                    if(left <= allocated_zone->capacity_){
-
-                    //There'are enough room for write original extent
-                        s = allocated_zone->Append((char*)buff + offset, left);
-#ifdef EXPERIMENT
-                        copied_data += (uint64_t)left;
-#endif
-                        allocated_zone->used_capacity_ += left;
-
-                        ZoneExtent * new_extent = new ZoneExtent((allocated_zone->wp_ - left), /*Extent length*/left-pad_sz, allocated_zone);
-                        ZoneExtentInfo * new_extent_info = new ZoneExtentInfo(new_extent, zone_file ,true, left-pad_sz, new_extent->start_, allocated_zone, zone_file->GetFilename(), zone_file->GetWriteLifeTimeHint(), zone_file->level_);
-                        allocated_zone->PushExtentInfo(new_extent_info);
-                        new_zone_extents.push_back(new_extent);
-                        
-                        allocated_zone->open_for_write_ = false;
-                        open_io_zones_--;
-                        
-                        sst_zone_mtx_.lock();
-                        if (zone_file->is_sst_) { 
-                          std::vector<int> fz = sst_to_zone_[zone_file->fno_];
-                          for (auto it = fz.begin(); it != fz.end(); it++) {
-                             if (*it == victim_zone_id ) {
-                               fz.erase(it);
-                               break;
-                             } 
-                          }
-                          sst_to_zone_[zone_file->fno_].push_back(allocated_zone->zone_id_);
-                        }
-                        sst_zone_mtx_.unlock();
-
-                        new_extent_length +=left-pad_sz;
-                        break; /*left = 0*/
-                    } else {  
-                        wr_size = allocated_zone->capacity_;
-                        s = allocated_zone->Append((char*)buff + offset, wr_size);
-                        assert(s.ok()); 
-#ifdef EXPERIMENT
-                        copied_data += (uint64_t)wr_size;
-#endif
-                        allocated_zone->used_capacity_ += wr_size;
-
-                        left -= wr_size;
-                        offset += wr_size;
-                        assert(allocated_zone->capacity_ == 0); 
-
-                        ZoneExtent * new_extent = new ZoneExtent((allocated_zone->wp_ - wr_size), /*Extent length*/wr_size, allocated_zone);
-
-                        ZoneExtentInfo * new_extent_info = new ZoneExtentInfo(new_extent, zone_file ,true, wr_size,new_extent->start_, allocated_zone, zone_file->GetFilename(), zone_file->GetWriteLifeTimeHint(), zone_file->level_);
-                        allocated_zone->PushExtentInfo(new_extent_info);    
-                        
-                        new_extent_length += wr_size;
-                        new_zone_extents.push_back(new_extent);
-
-                        sst_zone_mtx_.lock();
-                        if (zone_file->is_sst_) {
-                          std::vector<int> fz = sst_to_zone_[zone_file->fno_];
-                          for (auto it = fz.begin(); it != fz.end(); it++) {
-                             if (*it == victim_zone_id ) {
-                               fz.erase(it);
-                               break;
-                             } 
-                          }
-                          sst_to_zone_[zone_file->fno_].push_back(allocated_zone->zone_id_);
-                        }
-                        sst_zone_mtx_.unlock();
-                        //update and notify resource status
-                        allocated_zone->open_for_write_ = false;
-                        open_io_zones_--;
- 
-                        allocated_zone->Finish();
-                        active_io_zones_--;
-    
-                        for (auto it = reserved_zones.begin(); it != reserved_zones.end(); ){
-                          Zone * zz = (*it);
-                          if (allocated_zone == zz){
-                             io_zones.push_back(*it);
-                             reserved_zones.erase(it);
-                             break;
-                          }
-                          ++it;
-                        }
-                        //newly allocate new zone for write
-                        allocated_zone = AllocateZoneForCleaning();
-                        assert(allocated_zone);
-                    }
-                }//end of while.
-           
-                assert(new_extent_length == valid_size);
-                assert(cur_victim->used_capacity_ >= zone_extent->length_); 
-                cur_victim->used_capacity_ -= zone_extent->length_; 
-                //update extent information of the file.
-                //Replace origin extent information with newly made extent list.
-                std::vector<ZoneExtent *> origin_extents_ = zone_file->GetExtentsList();
-                std::vector<ZoneExtent *> replace_extents_;
-
-                for (auto ze : origin_extents_) {
-                  if (zone_extent == ze) {
-                    for (auto new_ze : new_zone_extents) {
-                      replace_extents_.push_back(new_ze);
-                    }
-                  } else {
-                    replace_extents_.push_back(ze);
-                  }
-                }
-                zone_file->UpdateExtents(replace_extents_);
-                zone_file->ExtentWriteUnlock();
-            }            
-            free(buff);
-        }
-        assert(!cur_victim->open_for_write_);
-        cur_victim->used_capacity_.store(0);
-        cur_victim->Reset();
-        active_io_zones_--;
-        reseted++;
-        for (auto it = io_zones.begin(); it != io_zones.end(); it++){
-          if ((*it)->zone_id_ == cur_victim->zone_id_) {
-            if (reserved_zones.size() < RESERVED_ZONE_FOR_CLEANING){
-              io_zones.erase(it);
-              reserved_zones.push_back(cur_victim);
-            }
-            break;
-          }
-        }
-        gc_queue_.pop();
-        if (reseted >= nr_reset) break;
-    }
-#ifdef EXPERIMENT
-    fprintf(stdout, "Total Copied Data in ZC : %lu\n", copied_data);
-#endif
-
-    for ( auto it = reserved_zones.begin(); it !=reserved_zones.end(); ){
-        if ( !((*it)->IsEmpty()) || ((*it)->IsUsed())) {
-            io_zones.push_back(*it);
-            reserved_zones.erase(it);
-        } else {
-            ++it;
-        }
-    }
-    if (reserved_zones.size() < RESERVED_ZONE_FOR_CLEANING) {
-      for ( auto it = io_zones.begin(); it !=io_zones.end(); ){
-       if ( ((*it)->IsEmpty()) && !((*it)->open_for_write_)) {
-            reserved_zones.push_back(*it);
-            io_zones.erase(it);
-        } else {
-            ++it;
-        }
-
-       if(reserved_zones.size() == RESERVED_ZONE_FOR_CLEANING) 
-         break;
-      }
-    }
-
-    if (reserved_zones.size() > RESERVED_ZONE_FOR_CLEANING) {
-
-      for ( auto it = reserved_zones.begin(); it !=reserved_zones.end(); ){
-        if ( reserved_zones.size() != RESERVED_ZONE_FOR_CLEANING) {
-            assert((*it)->IsEmpty() && !((*it)->open_for_write_));
-            io_zones.push_back(*it);
-            reserved_zones.erase(it);
-        } else {
-            ++it;
-        }
-      }
-    }
-    for (auto it = reserved_zones.begin(); it != reserved_zones.end(); it++){
-        (*it)->used_capacity_.store(0);
-    }
-    zone_cleaning_mtx.unlock();
-    return 1;
-}//ZoneCleaning();
-}  // namespace ROCKSDB_NAMESPACE
-
-#endif  // !defined(ROCKSDB_LITE) && !defined(OS_WIN) && defined(LIBZBD)
+// Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
+// Copyright (c) 2019-present, Western Digital Corporation
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#if !defined(ROCKSDB_LITE) && !defined(OS_WIN) && defined(LIBZBD)
+
+#include "zbd_zenfs.h"
+#include "fs_zenfs.h"
+#include "exp.h"
+
+#include <stdlib.h>
+#include <fstream>
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <libzbd/zbd.h>
+#include <linux/blkzoned.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <set>
+
+#include "io_zenfs.h"
+#include "monitoring/iostats_context_imp.h"
+#include "monitoring/statistics.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/env.h"
+#include "db/version_set.h"
+#include "db/dbformat.h"
+#include "util/coding.h"
+
+#define KB (1024)
+#define MB (1024 * KB)
+
+using std::cout;
+using std::endl;
+using std::fixed;
+
+/* Number of reserved zones for metadata
+ * Two non-offline meta zones are needed to be able
+ * to roll the metadata log safely. One extra
+ * is allocated to cover for one zone going offline.
+ */
+#define ZENFS_META_ZONES (3)
+
+/* Minimum of number of zones that makes sense */
+#define ZENFS_MIN_ZONES (32)
+
+/* Appends larger than one chunk are split and submitted asynchronously,
+ * keeping up to ZENFS_APPEND_QUEUE_DEPTH writes in flight per writer. The
+ * block layer (mq-deadline zone write locking) keeps writes to a zone in
+ * submission order */
+#define ZENFS_APPEND_CHUNK_SIZE (256 * KB)
+#define ZENFS_APPEND_QUEUE_DEPTH (8)
+
+/* SST data is staged in pooled chunks until the file is placed, file write
+ * buffers come from the same pool. Its budget is set by the superblock,
+ * ZENFS_BUFFER_POOL_SIZE if that has none */
+#define ZENFS_STAGING_CHUNK_SIZE (1 * MB)
+#define ZENFS_BUFFER_POOL_SIZE (256 * MB)
+/* Back pooled chunks by transparent huge pages, needs chunk sizes in
+ * multiples of ZENFS_HUGE_PAGE_SIZE */
+#define ZENFS_BUFFER_POOL_HUGE_PAGES (false)
+#define ZENFS_HUGE_PAGE_SIZE (2 * MB)
+
+/* Background zone cleaning starts when free space drops to
+ * ZENFS_GC_START_FREE_RATIO % and stops at ZENFS_GC_STOP_FREE_RATIO % */
+#define ZENFS_GC_START_FREE_RATIO (25)
+#define ZENFS_GC_STOP_FREE_RATIO (30)
+#define ZENFS_GC_ZONES_PER_ROUND (1)
+
+/* Empty zones kept ready for WAL files and open zones reserved for them */
+#define ZENFS_WAL_RING_ZONES (2)
+#define ZENFS_WAL_OPEN_ZONES (2)
+/* Bandwidth background cleaning may use for copying valid data */
+#define ZENFS_GC_RATE_LIMIT_MB_S (256)
+#define ZENFS_GC_POLL_INTERVAL_MS (100)
+
+/* Besides the finish threshold, the sweep finishes closed zones with less
+ * than ZENFS_AUTO_FINISH_CAPACITY_PCT % capacity left while fewer than
+ * ZENFS_AUTO_FINISH_ACTIVE_SLACK active zones are left */
+#define ZENFS_AUTO_FINISH_CAPACITY_PCT (25)
+#define ZENFS_AUTO_FINISH_ACTIVE_SLACK (2)
+
+/* A writer queued for an open zone slot longer than this is served before
+ * writers of lower admission classes */
+#define ZENFS_ADMISSION_STARVATION_MS (1000)
+
+/* Device I/Os in flight at most for compaction reads and zone cleaning, and
+ * how long they yield to I/Os of a lower class, see BeginIO() */
+#define ZENFS_IO_DEPTH_COMPACTION (8)
+#define ZENFS_IO_DEPTH_GC (2)
+#define ZENFS_IO_YIELD_US (2000)
+
+/* Zone resets and finishes are issued by a background worker, adjacent
+ * zones of a device in one range command of at most this many zones */
+#define ZENFS_SWEEP_MAX_RANGE (64)
+#define ZENFS_SWEEP_POLL_INTERVAL_MS (50)
+
+/* Zone cleaning coalesces adjacent valid extents into reads of up to this
+ * size, a single larger extent is still read at once */
+#define ZENFS_GC_MAX_READ_SIZE (8 * MB)
+
+/* Zone stats history sampling period and memory budget */
+#define ZENFS_ZONE_STATS_PERIOD_S (60)
+#define ZENFS_ZONE_STATS_HISTORY_SIZE (4 * MB)
+
+/* Partially written zones with less remaining capacity are not offered as
+ * placement targets to SST partitioning, see GetPlacementCapacity() */
+#define ZENFS_MIN_PLACEMENT_CAPACITY_PCT (5)
+
+/* Zoned block devices a file system can span */
+#define ZENFS_MAX_DEVICES (64)
+
+/* Deleted SSTs remembered per level by the lifetime predictor, and the
+ * weight of a new lifetime in the level moving average */
+#define ZENFS_LIFETIME_SAMPLES (256)
+#define ZENFS_LIFETIME_AVG_WEIGHT (0.05)
+/* A partially written zone only gets a file predicted to die within this
+ * share of the file's predicted lifetime of the zone's data */
+#define ZENFS_LIFETIME_MATCH_PCT (50)
+
+/* Reads of up to this size are cached, larger ones are compaction and
+ * scan streams that would only flush the read cache */
+#define ZENFS_READ_CACHE_MAX_READ_SIZE (256 * KB)
+#define ZENFS_READ_CACHE_SHARD_BITS (6)
+/* A zone is hot once it had this many reads and this multiple of the
+ * average zone's reads, very hot zones are cached with high priority */
+#define ZENFS_READ_CACHE_MIN_HEAT (8)
+#define ZENFS_READ_CACHE_HOT_FACTOR (2)
+#define ZENFS_READ_CACHE_VERY_HOT_FACTOR (8)
+/* Zone read heat is halved once the zones had this many reads in total */
+#define ZENFS_READ_HEAT_DECAY_READS (1 << 20)
+
+/* Zones reserved for Zone Cleaning, a quarter of the active zone limit
+ * within these bounds. They are its destinations, one per class of data
+ * while there are enough. */
+#define RESERVED_ZONE_FOR_CLEANING (10)
+#define ZENFS_GC_MIN_RESERVED_ZONES (2)
+/* Zone cleaning keeps data predicted to die within this many seconds apart
+ * from the rest */
+#define ZENFS_GC_SHORT_LIFETIME_S (600)
+
+namespace ROCKSDB_NAMESPACE {
+
+Zone::Zone(ZonedBlockDevice *zbd, ZbdDevice *dev, struct zbd_zone *z,
+           const uint32_t id)
+    : zbd_(zbd),
+      dev_(dev),
+      zone_id_(id),
+      start_(dev->base_ + zbd_zone_start(z)),
+      max_capacity_(zbd_zone_capacity(z)),
+      wp_(dev->base_ + zbd_zone_wp(z)),
+      open_for_write_(false),
+      is_append(false),
+      wal_zone_(false),
+      level_mask_(0),
+      time_bucket_(0),
+      predicted_death_(0),
+      predicted_bytes_(0),
+      active_(false){
+  lifetime_ = Env::WLTH_NOT_SET;
+  secondary_lifetime_ = Env::WLTH_NOT_SET;
+  used_capacity_ = 0;
+  valid_bytes_ = 0;
+  invalid_bytes_ = 0;
+  last_write_time_ = time(NULL);
+  capacity_ = 0;
+  if (!(zbd_zone_full(z) || zbd_zone_offline(z) || zbd_zone_rdonly(z)))
+    capacity_ = zbd_zone_capacity(z) - (zbd_zone_wp(z) - zbd_zone_start(z));
+}
+
+static uint64_t BlockAlignedLength(uint64_t length, uint32_t block_sz) {
+  uint64_t align = length % block_sz;
+  return align ? length + (block_sz - align) : length;
+}
+
+void ZoneBucket::Push(Zone *z) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (member_[z->zone_id_]) return;
+  member_[z->zone_id_] = true;
+  zones_.push_back(z);
+}
+
+void ZoneBucket::Drain(std::vector<Zone *> *out) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (const auto z : zones_) {
+    member_[z->zone_id_] = false;
+    out->push_back(z);
+  }
+  zones_.clear();
+}
+
+SSTRangeIndex::~SSTRangeIndex() {
+  for (const auto &l : levels_) Destroy(l.second);
+}
+
+void SSTRangeIndex::Destroy(Node *t) {
+  if (!t) return;
+  Destroy(t->left_);
+  Destroy(t->right_);
+  delete t;
+}
+
+void SSTRangeIndex::SetComparator(const InternalKeyComparator *icmp) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  icmp_ = icmp;
+  if (!icmp_) return;
+
+  for (const auto &p : pending_)
+    InsertLocked(p.first, p.second.level_, p.second.smallest_,
+                 p.second.largest_);
+  pending_.clear();
+}
+
+bool SSTRangeIndex::HasComparator() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return icmp_ != nullptr;
+}
+
+bool SSTRangeIndex::Less(const Node *a, const Node *b) {
+  int c = icmp_->Compare(a->smallest_, b->smallest_);
+  if (c != 0) return c < 0;
+  return a->fno_ < b->fno_;
+}
+
+void SSTRangeIndex::Update(Node *t) {
+  t->max_largest_ = t->largest_;
+  if (t->left_ && icmp_->Compare(t->left_->max_largest_, t->max_largest_) > 0)
+    t->max_largest_ = t->left_->max_largest_;
+  if (t->right_ && icmp_->Compare(t->right_->max_largest_, t->max_largest_) > 0)
+    t->max_largest_ = t->right_->max_largest_;
+}
+
+/* l gets the nodes ordered before key, r the rest */
+void SSTRangeIndex::Split(Node *t, const Node *key, Node **l, Node **r) {
+  if (!t) {
+    *l = *r = nullptr;
+    return;
+  }
+  if (Less(t, key)) {
+    Split(t->right_, key, &t->right_, r);
+    *l = t;
+  } else {
+    Split(t->left_, key, l, &t->left_);
+    *r = t;
+  }
+  Update(t);
+}
+
+SSTRangeIndex::Node *SSTRangeIndex::Merge(Node *l, Node *r) {
+  if (!l) return r;
+  if (!r) return l;
+  if (l->priority_ > r->priority_) {
+    l->right_ = Merge(l->right_, r);
+    Update(l);
+    return l;
+  }
+  r->left_ = Merge(l, r->left_);
+  Update(r);
+  return r;
+}
+
+SSTRangeIndex::Node *SSTRangeIndex::Erase(Node *t, const Node *key,
+                                          Node **erased) {
+  if (!t) return nullptr;
+  if (t == key) {
+    *erased = t;
+    return Merge(t->left_, t->right_);
+  }
+  if (Less(key, t))
+    t->left_ = Erase(t->left_, key, erased);
+  else
+    t->right_ = Erase(t->right_, key, erased);
+  Update(t);
+  return t;
+}
+
+void SSTRangeIndex::Collect(Node *t, const InternalKey *smallest,
+                            const InternalKey *largest,
+                            std::vector<uint64_t> *fno_list) {
+  if (!t) return;
+  /* Nothing in this subtree reaches the range */
+  if (smallest && icmp_->Compare(t->max_largest_, *smallest) < 0) return;
+  Collect(t->left_, smallest, largest, fno_list);
+  /* This node and the right subtree start after the range */
+  if (largest && icmp_->Compare(t->smallest_, *largest) > 0) return;
+  if (!smallest || icmp_->Compare(t->largest_, *smallest) >= 0)
+    fno_list->push_back(t->fno_);
+  Collect(t->right_, smallest, largest, fno_list);
+}
+
+void SSTRangeIndex::Insert(uint64_t fno, int level, const InternalKey &smallest,
+                           const InternalKey &largest) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (!icmp_) {
+    PendingRange &p = pending_[fno];
+    p.level_ = level;
+    p.smallest_ = smallest;
+    p.largest_ = largest;
+    return;
+  }
+  InsertLocked(fno, level, smallest, largest);
+}
+
+/* mtx_ should be locked and icmp_ set before the function is called */
+void SSTRangeIndex::InsertLocked(uint64_t fno, int level,
+                                 const InternalKey &smallest,
+                                 const InternalKey &largest) {
+  auto old = by_fno_.find(fno);
+  if (old != by_fno_.end()) {
+    Node *erased = nullptr;
+    Node *&old_root = levels_[old->second.first];
+    old_root = Erase(old_root, old->second.second, &erased);
+    delete erased;
+    by_fno_.erase(old);
+  }
+
+  Node *n = new Node();
+  n->smallest_ = smallest;
+  n->largest_ = largest;
+  n->max_largest_ = largest;
+  n->fno_ = fno;
+  n->priority_ = Random::GetTLSInstance()->Next();
+  n->left_ = n->right_ = nullptr;
+
+  Node *&root = levels_[level];
+  Node *l, *r;
+  Split(root, n, &l, &r);
+  root = Merge(Merge(l, n), r);
+  by_fno_[fno] = std::make_pair(level, n);
+}
+
+void SSTRangeIndex::Remove(uint64_t fno) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  pending_.erase(fno);
+  auto it = by_fno_.find(fno);
+  if (it == by_fno_.end()) return;
+
+  Node *erased = nullptr;
+  Node *&root = levels_[it->second.first];
+  root = Erase(root, it->second.second, &erased);
+  assert(erased == it->second.second);
+  delete erased;
+  by_fno_.erase(it);
+}
+
+void SSTRangeIndex::Overlapping(int level, const InternalKey &smallest,
+                                const InternalKey &largest,
+                                std::vector<uint64_t> *fno_list) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = levels_.find(level);
+  if (it == levels_.end()) return;
+  Collect(it->second, &smallest, &largest, fno_list);
+}
+
+void SSTRangeIndex::LevelFiles(int level, std::vector<uint64_t> *fno_list) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = levels_.find(level);
+  if (it == levels_.end()) return;
+  Collect(it->second, nullptr, nullptr, fno_list);
+}
+
+void LifetimePredictor::SetComparator(const InternalKeyComparator *icmp) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  icmp_ = icmp;
+}
+
+void LifetimePredictor::Observe(int level, const InternalKey &smallest,
+                                const InternalKey &largest,
+                                uint64_t lifetime) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  LevelSamples &l = levels_[level];
+
+  if (l.samples_.empty() && l.avg_ == 0)
+    l.avg_ = (double)lifetime;
+  else
+    l.avg_ += ZENFS_LIFETIME_AVG_WEIGHT * ((double)lifetime - l.avg_);
+
+  /* Without a comparator only the level average is of use */
+  if (!icmp_) return;
+  l.samples_.push_back(Sample{smallest, largest, lifetime});
+  if (l.samples_.size() > ZENFS_LIFETIME_SAMPLES) l.samples_.pop_front();
+}
+
+uint64_t LifetimePredictor::Predict(int level, const InternalKey &smallest,
+                                    const InternalKey &largest) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = levels_.find(level);
+  if (it == levels_.end()) return 0;
+
+  const LevelSamples &l = it->second;
+  double sum = 0;
+  uint64_t nr = 0;
+
+  if (icmp_ && smallest.Valid() && largest.Valid()) {
+    for (const auto &s : l.samples_) {
+      if (icmp_->Compare(s.smallest_, largest) > 0 ||
+          icmp_->Compare(s.largest_, smallest) < 0)
+        continue;
+      sum += (double)s.lifetime_;
+      nr++;
+    }
+  }
+  if (nr == 0) return (uint64_t)l.avg_;
+  return (uint64_t)(sum / nr);
+}
+
+bool Zone::IsUsed() { return (used_capacity_ > 0) || open_for_write_; }
+uint64_t Zone::GetCapacityLeft() { return capacity_; }
+bool Zone::IsFull() { return (capacity_ == 0); }
+bool Zone::IsEmpty() { return (wp_ == start_); }
+uint64_t Zone::GetZoneNr() { return start_ / zbd_->GetZoneSize(); }
+
+uint64_t ZonedBlockDevice::GetTotalWritten() {
+  uint64_t total = 0;
+  for (const auto z : io_zones) {
+    if (IsReservedZone(z)) continue;
+    z->zone_df_lock_.lock();
+    total += (z->wp_ - z->start_);
+    z->zone_df_lock_.unlock();
+  }
+  return total;
+}
+
+void Zone::Account() {
+  if (!accounted_) return;
+  std::lock_guard<std::mutex> lock(account_mtx_);
+  ZoneSpace now;
+  uint64_t cap = capacity_.load();
+  uint64_t written = max_capacity_ > cap ? max_capacity_ - cap : 0;
+  long used = used_capacity_.load();
+
+  now.counted_ = true;
+  now.free_ = cap;
+  now.valid_ = used > 0 ? std::min<uint64_t>(used, written) : 0;
+  now.invalid_ = written - now.valid_;
+  if (reserved_.load()) {
+    now.state_ = kSpaceReserved;
+  } else if (stale_.load()) {
+    now.state_ = kSpaceEmpty;
+    now.free_ = max_capacity_;
+    now.valid_ = 0;
+    now.invalid_ = 0;
+  } else if (open_for_write_.load()) {
+    now.state_ = kSpaceOpen;
+  } else if (wp_.load() == start_) {
+    now.state_ = kSpaceEmpty;
+  } else if (cap == 0) {
+    now.state_ = kSpaceFull;
+  } else {
+    now.state_ = kSpacePartial;
+  }
+
+  zbd_->MoveSpace(space_, now);
+  space_ = now;
+}
+
+void ZonedBlockDevice::MoveSpace(const ZoneSpace &from, const ZoneSpace &to) {
+  if (from.counted_) {
+    space_zones_[from.state_]--;
+    space_free_[from.state_] -= from.free_;
+    space_valid_[from.state_] -= from.valid_;
+    space_invalid_[from.state_] -= from.invalid_;
+  }
+  space_zones_[to.state_]++;
+  space_free_[to.state_] += to.free_;
+  space_valid_[to.state_] += to.valid_;
+  space_invalid_[to.state_] += to.invalid_;
+}
+
+void ZonedBlockDevice::AccountAllZones() {
+  for (const auto z : io_zones) z->Account();
+}
+
+uint64_t ZonedBlockDevice::GetStateFreeSpace(ZoneSpaceState state) {
+  return std::max<int64_t>(space_free_[state].load(), 0);
+}
+
+uint64_t ZonedBlockDevice::GetStateValidSpace(ZoneSpaceState state) {
+  return std::max<int64_t>(space_valid_[state].load(), 0);
+}
+
+uint64_t ZonedBlockDevice::GetStateInvalidSpace(ZoneSpaceState state) {
+  return std::max<int64_t>(space_invalid_[state].load(), 0);
+}
+
+void ZonedBlockDevice::NotifyExtentAppended(uint64_t bytes) {
+  extents_appended_++;
+  extent_bytes_appended_ += bytes;
+}
+
+uint64_t ZonedBlockDevice::GetReclaimableSpace() {
+  return GetStateInvalidSpace(kSpaceFull);
+}
+
+/* Advisory, read without the allocation locks like the space counters */
+uint64_t ZonedBlockDevice::GetPlacementCapacity(int level,
+                                                uint64_t *max_capacity) {
+  uint32_t bit = (level >= 0 && level < 31) ? (1u << level) : (1u << 31);
+  uint64_t best = 0;
+
+  *max_capacity = 0;
+  for (const auto z : io_zones) {
+    if (z->max_capacity_ > *max_capacity) *max_capacity = z->max_capacity_;
+    if (z->wal_zone_ || z->time_bucket_ || z->open_for_write_ ||
+        IsReservedZone(z) || z->IsEmpty() || z->IsFull())
+      continue;
+    if (!(z->level_mask_.load() & bit)) continue;
+    if (z->capacity_ < z->max_capacity_ * ZENFS_MIN_PLACEMENT_CAPACITY_PCT / 100 ||
+        z->capacity_ < z->max_capacity_ * finish_threshold_ / 100)
+      continue;
+    if (z->capacity_ > best) best = z->capacity_;
+  }
+
+  return best ? best : *max_capacity;
+}
+
+uint64_t ZonedBlockDevice::GetUsedSpace() {
+  uint64_t used = 0;
+  for (uint32_t s = 0; s < kNumZoneSpaceStates; s++)
+    if (s != kSpaceReserved) used += GetStateValidSpace((ZoneSpaceState)s);
+  return used;
+}
+
+uint64_t ZonedBlockDevice::GetFreeSpace() {
+  uint64_t free = 0;
+  for (uint32_t s = 0; s < kNumZoneSpaceStates; s++)
+    if (s != kSpaceReserved) free += GetStateFreeSpace((ZoneSpaceState)s);
+  return free;
+}
+
+
+void Zone::CloseWR() {
+
+  assert(open_for_write_);
+  open_for_write_ = false;
+  if (Close().ok()) {
+    if (wal_zone_)
+      zbd_->NotifyWALZoneClosed();
+    else
+      zbd_->NotifyIOZoneClosed();
+  }
+  wal_zone_ = false;
+  if (capacity_ == 0) {
+    SetActive(false);
+    zbd_->NotifyIOZoneFull();
+  }
+
+  if (IsEmpty()) zbd_->AddEmptyZone(this);
+  zbd_->AddSweepZone(this);
+}
+
+void Zone::SetActive(bool active) {
+  if (active_ == active) return;
+  active_ = active;
+  if (active)
+    dev_->active_zones_++;
+  else
+    dev_->active_zones_--;
+}
+
+/* Resets the *nr zones in [ofst, ofst + len) of dev and reports them into
+ * zones */
+static IOStatus ResetZoneRange(ZbdDevice *dev, uint64_t ofst, uint64_t len,
+                               struct zbd_zone *zones, unsigned int *nr) {
+  ZoneEmulator *emu = dev->emu_.get();
+  unsigned int expected = *nr;
+  int ret;
+
+  if (emu)
+    ret = emu->ResetZones(ofst, len);
+  else
+    ret = zbd_reset_zones(dev->write_f_, ofst, len);
+  if (ret) return IOStatus::IOError("Zone reset failed\n");
+
+  if (emu)
+    ret = emu->ReportZones(ofst, len, zones, nr);
+  else
+    ret = zbd_report_zones(dev->write_f_, ofst, len, ZBD_RO_ALL, zones, nr);
+
+  if (ret || (*nr != expected)) return IOStatus::IOError("Zone report failed\n");
+  return IOStatus::OK();
+}
+
+static IOStatus FinishZoneRange(ZbdDevice *dev, uint64_t ofst, uint64_t len) {
+  ZoneEmulator *emu = dev->emu_.get();
+  int ret;
+
+  if (emu)
+    ret = emu->FinishZones(ofst, len);
+  else
+    ret = zbd_finish_zones(dev->write_f_, ofst, len);
+  if (ret) return IOStatus::IOError("Zone finish failed\n");
+  return IOStatus::OK();
+}
+
+IOStatus Zone::Reset() {
+  unsigned int report = 1;
+  struct zbd_zone z;
+
+  /* The caller may hold the zone claimed */
+  assert(used_capacity_ == 0);
+
+  IOStatus s = ResetZoneRange(dev_, dev_->Offset(start_), zbd_->GetZoneSize(),
+                              &z, &report);
+  if (!s.ok()) return s;
+
+  ResetDone(&z);
+  return IOStatus::OK();
+}
+
+IOStatus Zone::UpdateWp() {
+  ZoneEmulator *emu = dev_->emu_.get();
+  unsigned int report = 1;
+  struct zbd_zone z;
+  int ret;
+
+  if (emu)
+    ret = emu->ReportZones(dev_->Offset(start_), zbd_->GetZoneSize(), &z,
+                           &report);
+  else
+    ret = zbd_report_zones(dev_->read_f_, dev_->Offset(start_),
+                           zbd_->GetZoneSize(), ZBD_RO_ALL, &z, &report);
+  if (ret || report != 1) return IOStatus::IOError("Zone report failed\n");
+
+  wp_ = dev_->base_ + zbd_zone_wp(&z);
+  return IOStatus::OK();
+}
+
+void Zone::ResetDone(const struct zbd_zone *z) {
+  if (zbd_zone_offline(z))
+    capacity_ = 0;
+  else
+    max_capacity_ = capacity_ = zbd_zone_capacity(z);
+
+  wp_ = start_;
+  lifetime_ = Env::WLTH_NOT_SET;
+  predicted_death_ = 0;
+  predicted_bytes_ = 0;
+
+  for(auto ext : extent_info_){
+    zbd_->GetExtentInfoPool()->Free(ext);
+  }
+  extent_info_.clear();
+  valid_bytes_ = 0;
+  invalid_bytes_ = 0;
+  level_mask_ = 0;
+  time_bucket_ = 0;
+  read_heat_ = 0;
+  reset_seq_++;
+  SetActive(false);
+  stale_ = false;
+  Account();
+  zbd_->NotifyZoneReset();
+}
+
+IOStatus Zone::Finish() {
+  assert(!open_for_write_);
+
+  IOStatus s =
+      FinishZoneRange(dev_, dev_->Offset(start_), zbd_->GetZoneSize());
+  if (!s.ok()) return s;
+
+  FinishDone();
+  return IOStatus::OK();
+}
+
+void Zone::FinishDone() {
+  capacity_ = 0;
+  wp_ = start_ + zbd_->GetZoneSize();
+  SetActive(false);
+  Account();
+  zbd_->NotifyZoneFinish();
+}
+
+IOStatus Zone::Close() {
+  size_t zone_sz = zbd_->GetZoneSize();
+  int fd = dev_->write_f_;
+  int ret;
+
+  assert(!open_for_write_);
+
+  if (!(IsEmpty() || IsFull())) {
+    ZoneEmulator *emu = dev_->emu_.get();
+    if (emu)
+      ret = emu->CloseZones(dev_->Offset(start_), zone_sz);
+    else
+      ret = zbd_close_zones(fd, dev_->Offset(start_), zone_sz);
+    if (ret) return IOStatus::IOError("Zone close failed\n");
+  }
+
+  return IOStatus::OK();
+}
+
+IOStatus Zone::Append(char *data, uint32_t size) {
+  struct iovec iov;
+
+  iov.iov_base = data;
+  iov.iov_len = size;
+  return Append(&iov, 1);
+}
+
+IOStatus Zone::Append(const struct iovec *iov, int iovcnt) {
+  std::vector<struct iovec> left(iov, iov + iovcnt);
+  int fd = dev_->write_f_;
+  uint64_t size = 0;
+  int idx = 0;
+  ssize_t ret = -1;
+
+  for (int i = 0; i < iovcnt; i++) size += iov[i].iov_len;
+
+  if (capacity_ < size)
+    return IOStatus::NoSpace("Not enough capacity for append");
+
+  assert((size % zbd_->GetBlockSize()) == 0);
+
+  ZoneEmulator *emu = dev_->emu_.get();
+  if (emu && emu->Write(dev_->Offset(wp_), size))
+    return IOStatus::IOError("Write failed in Zone Append");
+
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (size > ZENFS_APPEND_CHUNK_SIZE) {
+    struct io_uring *iu = zbd_->GetThreadLocalIOUring();
+    if (iu != nullptr) return AsyncAppend(iov, iovcnt, iu);
+  }
+#endif
+
+  while (idx < iovcnt) {
+    ret = pwritev(fd, &left[idx], std::min(iovcnt - idx, IOV_MAX),
+                  dev_->Offset(wp_));
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      return IOStatus::IOError("Write failed in Zone Append");
+    }
+    zone_df_lock_.lock();
+    wp_ += ret;
+    zone_df_lock_.unlock();
+    capacity_ -= ret;
+    zbd_->NotifyBytesWritten(ret);
+    Account();
+
+    /* Skip over what has been written */
+    while (ret > 0 && idx < iovcnt) {
+      if ((size_t)ret >= left[idx].iov_len) {
+        ret -= left[idx].iov_len;
+        idx++;
+      } else {
+        left[idx].iov_base = (char *)left[idx].iov_base + ret;
+        left[idx].iov_len -= ret;
+        ret = 0;
+      }
+    }
+  }
+  return IOStatus::OK();
+}
+
+#if defined(ROCKSDB_IOURING_PRESENT)
+IOStatus Zone::AsyncAppend(const struct iovec *iov, int iovcnt,
+                           struct io_uring *iu) {
+  int fd = dev_->write_f_;
+  std::vector<struct iovec> chunks;
+  std::vector<uint64_t> offsets; /* device offsets */
+  uint64_t pos = dev_->Offset(wp_);
+
+  /* Split the gather list into chunks of at most ZENFS_APPEND_CHUNK_SIZE */
+  for (int i = 0; i < iovcnt; i++) {
+    size_t off = 0;
+    while (off < iov[i].iov_len) {
+      struct iovec chunk;
+      chunk.iov_base = (char *)iov[i].iov_base + off;
+      chunk.iov_len = std::min<size_t>(ZENFS_APPEND_CHUNK_SIZE,
+                                       iov[i].iov_len - off);
+      chunks.push_back(chunk);
+      offsets.push_back(pos);
+      off += chunk.iov_len;
+      pos += chunk.iov_len;
+    }
+  }
+
+  uint32_t nr_chunks = chunks.size();
+  std::vector<bool> done(nr_chunks, false);
+  uint32_t submitted = 0, in_flight = 0;
+  uint32_t persisted = 0; /* chunks written back to back from start */
+  bool failed = false;
+
+  while (in_flight > 0 || (!failed && submitted < nr_chunks)) {
+    while (!failed && submitted < nr_chunks &&
+           in_flight < ZENFS_APPEND_QUEUE_DEPTH) {
+      struct io_uring_sqe *sqe = io_uring_get_sqe(iu);
+      if (sqe == nullptr) break;
+      io_uring_prep_writev(sqe, fd, &chunks[submitted], 1,
+                           offsets[submitted]);
+      io_uring_sqe_set_data(sqe, (void *)(uintptr_t)submitted);
+      submitted++;
+      in_flight++;
+    }
+
+    bool submit_failed = false;
+    int ret = io_uring_submit_and_wait(iu, 1);
+    if (ret < 0 && ret != -EINTR) {
+      /* Stop submitting, but reap everything already in flight */
+      failed = submit_failed = true;
+    }
+
+    struct io_uring_cqe *cqe;
+    while (in_flight > 0 &&
+           (submit_failed ? io_uring_wait_cqe(iu, &cqe)
+                          : io_uring_peek_cqe(iu, &cqe)) == 0) {
+      uint32_t i = (uint32_t)(uintptr_t)io_uring_cqe_get_data(cqe);
+      if (cqe->res < 0 || (size_t)cqe->res != chunks[i].iov_len)
+        failed = true;
+      else
+        done[i] = true;
+      io_uring_cqe_seen(iu, cqe);
+      in_flight--;
+    }
+
+    /* Only move the write pointer over data that is written without holes */
+    uint64_t advance = 0;
+    while (persisted < nr_chunks && done[persisted]) {
+      advance += chunks[persisted].iov_len;
+      persisted++;
+    }
+    if (advance) {
+      zone_df_lock_.lock();
+      wp_ += advance;
+      zone_df_lock_.unlock();
+      capacity_ -= advance;
+      zbd_->NotifyBytesWritten(advance);
+      Account();
+    }
+
+    if (submit_failed) break;
+  }
+
+  if (failed || persisted != nr_chunks)
+    return IOStatus::IOError("Write failed in Zone Append");
+
+  return IOStatus::OK();
+}
+#endif
+
+void Zone::Invalidate(ZoneExtent* extent) {
+
+  if (extent == nullptr) {
+    fprintf(stderr, "Try to invalidate extent which is nullptr!\n");
+    return;
+  }
+  ZoneExtentInfo* ex = extent->info_;
+  if (ex == nullptr || ex->extent_ != extent) {
+    fprintf(stderr, "Failed to Find extent in the zone\n");
+  } else if (ex->valid_) {
+    ex->invalidate();
+    uint64_t len = BlockAlignedLength(ex->length_, zbd_->GetBlockSize());
+    valid_bytes_ -= len;
+    invalid_bytes_ += len;
+  }
+  Account();
+  /* Last valid data is gone, the zone can be reset */
+  if (used_capacity_ == 0) zbd_->AddSweepZone(this);
+}
+
+void Zone::PushExtentInfo(ZoneExtentInfo* extent_info) {
+  uint64_t len = BlockAlignedLength(extent_info->length_, zbd_->GetBlockSize());
+  if (extent_info->valid_)
+    valid_bytes_ += len;
+  else
+    invalid_bytes_ += len;
+  last_write_time_ = time(NULL);
+  if (extent_info->level_ >= 0 && extent_info->level_ < 31)
+    level_mask_ |= 1u << extent_info->level_;
+  else
+    level_mask_ |= 1u << 31;
+
+  uint64_t death = extent_info->zone_file_
+                       ? extent_info->zone_file_->predicted_death_
+                       : 0;
+  if (death) {
+    predicted_bytes_ += len;
+    double avg = (double)predicted_death_;
+    avg += ((double)death - avg) * len / predicted_bytes_;
+    predicted_death_ = (uint64_t)avg;
+  }
+  if (extent_info->extent_) extent_info->extent_->info_ = extent_info;
+  extent_info_.push_back(extent_info);
+}
+
+void Zone::GrowExtentInfo(ZoneExtentInfo* extent_info, uint32_t length) {
+  /* The extent ended on a block boundary, so did its share of the zone */
+  uint64_t len = BlockAlignedLength(length, zbd_->GetBlockSize());
+  extent_info->length_ += length;
+  if (extent_info->valid_)
+    valid_bytes_ += len;
+  else
+    invalid_bytes_ += len;
+  last_write_time_ = time(NULL);
+
+  uint64_t death = extent_info->zone_file_
+                       ? extent_info->zone_file_->predicted_death_
+                       : 0;
+  if (death) {
+    predicted_bytes_ += len;
+    double avg = (double)predicted_death_;
+    avg += ((double)death - avg) * len / predicted_bytes_;
+    predicted_death_ = (uint64_t)avg;
+  }
+}
+
+void Zone::UpdateSecondaryLifeTime(Env::WriteLifeTimeHint lt, uint64_t length) {
+
+  uint64_t total_length = 0;
+  double slt = 0;
+  for (const auto e : extent_info_) {
+    total_length += e->length_;
+  }
+  for(const auto e : extent_info_) {
+    double weigth = (((double)e->length_)/(total_length));
+    slt += (weigth * (double)(e->lt_));
+  }
+  double w = (((double)length)/(total_length));
+  slt += (w * (double)(lt));
+  secondary_lifetime_ = slt;
+}
+
+/* Records per slab of an ExtentInfoPool */
+#define ZENFS_EXTENT_INFO_SLAB (4096)
+
+ZoneExtentInfo *ExtentInfoPool::New(ZoneExtent *extent, ZoneFile *zone_file,
+                                    uint32_t length) {
+  ZoneExtentInfo *info;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (free_.empty()) {
+      slabs_.emplace_back(new ZoneExtentInfo[ZENFS_EXTENT_INFO_SLAB]);
+      ZoneExtentInfo *slab = slabs_.back().get();
+      free_.reserve(free_.size() + ZENFS_EXTENT_INFO_SLAB);
+      for (size_t i = ZENFS_EXTENT_INFO_SLAB; i > 0; i--)
+        free_.push_back(&slab[i - 1]);
+    }
+    info = free_.back();
+    free_.pop_back();
+  }
+
+  info->extent_ = extent;
+  info->zone_file_ = zone_file;
+  info->start_ = extent->start_;
+  info->length_ = length;
+  info->level_ = (int16_t)zone_file->level_;
+  info->lt_ = (uint8_t)zone_file->GetWriteLifeTimeHint();
+  info->valid_ = true;
+  return info;
+}
+
+void ExtentInfoPool::Free(ZoneExtentInfo *info) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  free_.push_back(info);
+}
+
+ZoneExtent::ZoneExtent(uint64_t start, uint32_t length, Zone *zone)
+    : start_(start), length_(length), zone_(zone), info_(nullptr) {}
+
+AlignedChunkPool::AlignedChunkPool(size_t chunk_size, size_t alignment,
+                                   size_t budget, bool huge_pages)
+    : chunk_size_(chunk_size),
+      alignment_(huge_pages && chunk_size % ZENFS_HUGE_PAGE_SIZE == 0
+                     ? std::max<size_t>(alignment, ZENFS_HUGE_PAGE_SIZE)
+                     : alignment),
+      huge_pages_(huge_pages && chunk_size % ZENFS_HUGE_PAGE_SIZE == 0),
+      budget_(budget),
+      charged_(0) {}
+
+std::shared_ptr<AlignedChunkPool> AlignedChunkPool::GetShared(
+    size_t chunk_size, size_t alignment) {
+  static std::mutex mtx;
+  static std::map<std::pair<size_t, size_t>, std::weak_ptr<AlignedChunkPool>>
+      pools;
+  std::lock_guard<std::mutex> lock(mtx);
+
+  std::weak_ptr<AlignedChunkPool> &w = pools[{chunk_size, alignment}];
+  std::shared_ptr<AlignedChunkPool> pool = w.lock();
+  if (!pool) {
+    pool = std::make_shared<AlignedChunkPool>(chunk_size, alignment,
+                                              ZENFS_BUFFER_POOL_SIZE,
+                                              ZENFS_BUFFER_POOL_HUGE_PAGES);
+    w = pool;
+  }
+  return pool;
+}
+
+char *AlignedChunkPool::Allocate() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!free_.empty()) {
+      char *c = free_.back();
+      free_.pop_back();
+      return c;
+    }
+    charged_ += chunk_size_;
+  }
+
+  char *c = nullptr;
+  if (posix_memalign((void **)&c, alignment_, chunk_size_)) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    charged_ -= chunk_size_;
+    return nullptr;
+  }
+  if (huge_pages_) madvise(c, chunk_size_, MADV_HUGEPAGE);
+  return c;
+}
+
+void AlignedChunkPool::Release(char *c) {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (charged_ <= budget_) {
+      free_.push_back(c);
+      return;
+    }
+    charged_ -= chunk_size_;
+  }
+  free(c);
+}
+
+void AlignedChunkPool::SetBudget(size_t budget) {
+  std::vector<char *> trimmed;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    budget_ = budget;
+    while (charged_ > budget_ && !free_.empty()) {
+      trimmed.push_back(free_.back());
+      free_.pop_back();
+      charged_ -= chunk_size_;
+    }
+  }
+  for (auto c : trimmed) free(c);
+}
+
+Zone *ZonedBlockDevice::GetIOZone(uint64_t offset) {
+  uint64_t nr = offset / zone_sz_;
+  if (nr >= zone_map_.size()) return nullptr;
+  return zone_map_[nr];
+}
+
+double ZonedBlockDevice::GetFreeRatio() {
+  uint64_t total = 0;
+  uint64_t free = 0;
+  for (const auto z : io_zones) {
+    if (IsReservedZone(z)) continue;
+    total += z->max_capacity_;
+    free += z->capacity_;
+  }
+  if (total == 0) return 0;
+  return ((double)free / total) * 100;
+}
+
+void ZonedBlockDevice::StartGCWorker() {
+#ifndef LAZY
+  if (devs_[0]->write_f_ < 0 || gc_worker_) return;
+  gc_worker_exit_ = false;
+  gc_worker_.reset(new std::thread(&ZonedBlockDevice::GCWorker, this));
+#endif
+}
+
+void ZonedBlockDevice::StopGCWorker() {
+  if (!gc_worker_) return;
+  {
+    std::lock_guard<std::mutex> lock(gc_worker_mtx_);
+    gc_worker_exit_ = true;
+  }
+  gc_worker_cv_.notify_all();
+  gc_worker_->join();
+  gc_worker_.reset();
+}
+
+void ZonedBlockDevice::KickGCWorker() { gc_worker_cv_.notify_one(); }
+
+void ZonedBlockDevice::StartSweepWorker() {
+  if (devs_[0]->write_f_ < 0 || sweep_worker_) return;
+  sweep_worker_exit_ = false;
+  sweep_worker_.reset(new std::thread(&ZonedBlockDevice::SweepWorker, this));
+}
+
+void ZonedBlockDevice::StopSweepWorker() {
+  if (!sweep_worker_) return;
+  {
+    std::lock_guard<std::mutex> lock(sweep_worker_mtx_);
+    sweep_worker_exit_ = true;
+  }
+  sweep_worker_cv_.notify_all();
+  sweep_worker_->join();
+  sweep_worker_.reset();
+}
+
+void ZonedBlockDevice::KickSweepWorker() {
+  {
+    std::lock_guard<std::mutex> lock(sweep_worker_mtx_);
+    sweep_requested_++;
+  }
+  sweep_worker_cv_.notify_one();
+}
+
+void ZonedBlockDevice::WaitSweep() {
+  if (!sweep_worker_) return;
+  std::unique_lock<std::mutex> lk(sweep_worker_mtx_);
+  uint64_t target = ++sweep_requested_;
+  sweep_worker_cv_.notify_one();
+  sweep_done_cv_.wait(lk, [this, target] {
+    return sweep_done_ >= target || sweep_worker_exit_;
+  });
+}
+
+void ZonedBlockDevice::SweepWorker() {
+  std::unique_lock<std::mutex> lk(sweep_worker_mtx_);
+
+  while (!sweep_worker_exit_) {
+    sweep_worker_cv_.wait_for(
+        lk, std::chrono::milliseconds(ZENFS_SWEEP_POLL_INTERVAL_MS), [this] {
+          return sweep_worker_exit_ || sweep_done_ != sweep_requested_;
+        });
+    if (sweep_worker_exit_) break;
+    uint64_t requested = sweep_requested_;
+    lk.unlock();
+
+    io_zones_mtx.lock();
+    SweepIOZones(true);
+    RefillWALRingLocked();
+    io_zones_mtx.unlock();
+
+    lk.lock();
+    sweep_done_ = requested;
+    sweep_done_cv_.notify_all();
+  }
+  sweep_done_cv_.notify_all();
+}
+
+void ZonedBlockDevice::StartZoneStatsWorker() {
+  if (devs_[0]->write_f_ < 0 || zone_stats_worker_) return;
+  zone_stats_worker_exit_ = false;
+  zone_stats_worker_.reset(
+      new std::thread(&ZonedBlockDevice::ZoneStatsWorker, this));
+}
+
+void ZonedBlockDevice::StopZoneStatsWorker() {
+  if (!zone_stats_worker_) return;
+  {
+    std::lock_guard<std::mutex> lock(zone_stats_worker_mtx_);
+    zone_stats_worker_exit_ = true;
+  }
+  zone_stats_worker_cv_.notify_all();
+  zone_stats_worker_->join();
+  zone_stats_worker_.reset();
+}
+
+void ZonedBlockDevice::ZoneStatsWorker() {
+  std::unique_lock<std::mutex> lk(zone_stats_worker_mtx_);
+
+  while (!zone_stats_worker_exit_) {
+    lk.unlock();
+    SampleZoneStats();
+    lk.lock();
+    zone_stats_worker_cv_.wait_for(
+        lk, std::chrono::seconds(ZENFS_ZONE_STATS_PERIOD_S),
+        [this] { return zone_stats_worker_exit_; });
+  }
+}
+
+void ZonedBlockDevice::SampleZoneStats() {
+  ZoneStatsSample sample;
+
+  sample.time_ = time(NULL);
+  sample.gc_copied_bytes_ = gc_copied_bytes_.load();
+  for (int i = 0; i < kNumZonePlacements; i++)
+    sample.placements_[i] = placements_[i].load();
+
+  sample.written_bytes_ = GetTotalWritten();
+  sample.zones_.reserve(io_zones.size());
+  for (const auto z : io_zones) {
+    sample.zones_.push_back({z->zone_id_, z->valid_bytes_.load(),
+                             z->invalid_bytes_.load(),
+                             z->level_mask_.load()});
+  }
+
+  uint64_t size =
+      sizeof(sample) + sample.zones_.size() * sizeof(ZoneStatsSample::ZoneStat);
+
+  std::lock_guard<std::mutex> lock(zone_stats_mtx_);
+  zone_stats_history_.push_back(std::move(sample));
+  zone_stats_history_size_ += size;
+  while (zone_stats_history_size_ > ZENFS_ZONE_STATS_HISTORY_SIZE &&
+         zone_stats_history_.size() > 1) {
+    const ZoneStatsSample &oldest = zone_stats_history_.front();
+    zone_stats_history_size_ -=
+        sizeof(oldest) +
+        oldest.zones_.size() * sizeof(ZoneStatsSample::ZoneStat);
+    zone_stats_history_.pop_front();
+  }
+}
+
+void ZonedBlockDevice::GetZoneStatsHistory(
+    uint64_t start_time, uint64_t end_time,
+    std::vector<ZoneStatsSample> *samples) {
+  std::lock_guard<std::mutex> lock(zone_stats_mtx_);
+  for (const auto &sample : zone_stats_history_) {
+    if (sample.time_ >= start_time && sample.time_ < end_time)
+      samples->push_back(sample);
+  }
+}
+
+void ZonedBlockDevice::GCWorker() {
+  std::unique_lock<std::mutex> lk(gc_worker_mtx_);
+
+  while (!gc_worker_exit_) {
+    gc_worker_cv_.wait_for(lk,
+                           std::chrono::milliseconds(ZENFS_GC_POLL_INTERVAL_MS));
+    if (gc_worker_exit_) break;
+    lk.unlock();
+
+    io_zones_mtx.lock();
+    SweepIOZonesOrKick();
+    RefillWALRingLocked();
+    io_zones_mtx.unlock();
+    bool start = GetFreeRatio() <= ZENFS_GC_START_FREE_RATIO;
+
+    auto round_start = std::chrono::steady_clock::now();
+    uint64_t copied_start = gc_copied_bytes_.load();
+
+    while (start) {
+      double free_ratio = GetFreeRatio();
+      if (free_ratio >= ZENFS_GC_STOP_FREE_RATIO) break;
+
+      if (ZoneCleaning(ZENFS_GC_ZONES_PER_ROUND) == 0) break;
+
+      /* 1 MB/s is one byte per microsecond. Copies are paced by the DB's
+       * rate limiter instead if it has one, so cleaning takes whatever
+       * budget the foreground leaves unused */
+      std::chrono::microseconds budget(0);
+      if (!std::atomic_load(&rate_limiter_))
+        budget = std::chrono::microseconds(
+            (gc_copied_bytes_.load() - copied_start) /
+            ZENFS_GC_RATE_LIMIT_MB_S);
+      auto elapsed = std::chrono::steady_clock::now() - round_start;
+
+      lk.lock();
+      if (elapsed < budget)
+        gc_worker_cv_.wait_for(lk, budget - elapsed,
+                               [this] { return gc_worker_exit_; });
+      bool exit = gc_worker_exit_;
+      lk.unlock();
+      if (exit) break;
+    }
+    lk.lock();
+  }
+}
+
+bool ZonedBlockDevice::ClaimZone(Zone *z) {
+  if (!z->Acquire()) return false;
+  /* Zone cleaning may have reserved it since it was picked, stale zones
+   * must be reset first */
+  if (IsReservedZone(z) || z->stale_) {
+    z->Release();
+    return false;
+  }
+  return true;
+}
+
+void ZonedBlockDevice::SetReservedZone(Zone *z, bool reserved) {
+/* reserved_zones_mtx_ should be locked before the function is called */
+  if (z->reserved_ == reserved) return;
+  z->reserved_ = reserved;
+  z->Account();
+  if (reserved) {
+    reserved_zones.push_back(z);
+    return;
+  }
+  reserved_zones.erase(
+      std::find(reserved_zones.begin(), reserved_zones.end(), z));
+  for (auto it = gc_dest_zones_.begin(); it != gc_dest_zones_.end();) {
+    if (it->second == z)
+      it = gc_dest_zones_.erase(it);
+    else
+      ++it;
+  }
+}
+
+ZonedBlockDevice::ZonedBlockDevice(std::string bdevname,
+                                   std::shared_ptr<Logger> logger)
+    : filename_(bdevname), logger_(logger), db_ptr_(nullptr) {
+  size_t pos = 0;
+  while (pos <= bdevname.size()) {
+    size_t end = bdevname.find(',', pos);
+    if (end == std::string::npos) end = bdevname.size();
+    std::string name = bdevname.substr(pos, end - pos);
+    pos = end + 1;
+    if (name.empty()) continue;
+
+    std::unique_ptr<ZbdDevice> dev(new ZbdDevice());
+    if (ZoneEmulator::IsEmulated(name)) {
+      dev->filename_ = name;
+      dev->emu_.reset(new ZoneEmulator(name));
+    } else {
+      dev->filename_ = "/dev/" + name;
+    }
+    Info(logger_, "New Zoned Block Device: %s", dev->filename_.c_str());
+    devs_.push_back(std::move(dev));
+  }
+  if (devs_.empty()) devs_.emplace_back(new ZbdDevice());
+  zc_in_progress_.store(false);
+  WR_DATA.store(0);
+  LAST_WR_DATA.store(100);
+  num_zc_cnt = 0;
+  num_reset_cnt = 0;
+  gc_worker_exit_ = false;
+  gc_copied_bytes_.store(0);
+  for (auto &p : placements_) p.store(0);
+  for (auto &w : admission_waits_) w.store(0);
+  for (uint32_t s = 0; s < kNumZoneSpaceStates; s++) {
+    space_zones_[s].store(0);
+    space_free_[s].store(0);
+    space_valid_[s].store(0);
+    space_invalid_[s].store(0);
+  }
+  for (auto &w : admission_wait_micros_) w.store(0);
+  for (uint32_t i = 0; i < kNumIOClasses; i++) {
+    io_in_flight_[i].store(0);
+    io_queued_[i].store(0);
+    io_waits_[i].store(0);
+  }
+};
+
+void ZonedBlockDevice::SetDBPointer(DBImpl* db) {
+    db_ptr_ = db;
+    stats_ = db->immutable_db_options().statistics;
+    std::atomic_store(&rate_limiter_,
+                      db->immutable_db_options().rate_limiter);
+}
+
+void ZonedBlockDevice::RequestIO(uint64_t bytes, Env::IOPriority pri,
+                                 RateLimiter::OpType op_type) {
+  std::shared_ptr<RateLimiter> limiter = std::atomic_load(&rate_limiter_);
+  if (!limiter || !limiter->IsRateLimited(op_type)) return;
+
+  /* Larger requests must be split into bursts */
+  uint64_t burst = std::max<int64_t>(limiter->GetSingleBurstBytes(), 1);
+  while (bytes) {
+    uint64_t n = std::min(bytes, burst);
+    limiter->Request(n, pri, GetStatistics(), op_type);
+    bytes -= n;
+  }
+}
+
+void ZonedBlockDevice::NotifyZoneReset() {
+  zone_resets_++;
+  RecordTick(GetStatistics(), ZENFS_ZONE_RESETS);
+}
+
+void ZonedBlockDevice::NotifyZoneFinish() {
+  zone_finishes_++;
+  RecordTick(GetStatistics(), ZENFS_ZONE_FINISHES);
+}
+
+void ZonedBlockDevice::NotifyMetaLogWrite(uint64_t bytes) {
+  meta_log_bytes_ += bytes;
+  RecordTick(GetStatistics(), ZENFS_META_LOG_BYTES, bytes);
+}
+
+bool ZonedBlockDevice::GetProperty(const std::string &property,
+                                   std::string *value) {
+  const std::string prefix = DB::Properties::kZenFSPrefix;
+
+  /* Counters only, read without the allocation locks */
+  std::vector<std::pair<std::string, uint64_t>> props = {
+      {"open-zones", open_io_zones_.load()},
+      {"active-zones", active_io_zones_.load()},
+      {"free-space", GetFreeSpace()},
+      {"used-space", GetUsedSpace()},
+      {"reclaimable-space", GetReclaimableSpace()},
+      {"bytes-written", bytes_written_.load()},
+      {"gc-bytes-copied", gc_copied_bytes_.load()},
+      {"gc-extents-migrated", gc_extents_migrated_.load()},
+      {"zone-resets", zone_resets_.load()},
+      {"zone-finishes", zone_finishes_.load()},
+      {"meta-log-bytes", meta_log_bytes_.load()},
+      {"read-cache-hits", read_cache_hits_.load()},
+      {"read-cache-misses", read_cache_misses_.load()},
+      {"placement-overlap", placements_[kPlacementOverlap].load()},
+      {"placement-l0", placements_[kPlacementL0].load()},
+      {"placement-same-level", placements_[kPlacementSameLevel].load()},
+      {"placement-lifetime", placements_[kPlacementLifetime].load()},
+      {"placement-empty", placements_[kPlacementEmpty].load()},
+      {"placement-time-bucket", placements_[kPlacementTimeBucket].load()},
+      {"placement-predicted", placements_[kPlacementPredicted].load()},
+      {"io-waits-compaction", io_waits_[kIOCompaction].load()},
+      {"io-waits-gc", io_waits_[kIOGC].load()},
+      {"admission-waits-wal", admission_waits_[kAdmitWAL].load()},
+      {"admission-waits-flush", admission_waits_[kAdmitFlush].load()},
+      {"admission-waits-l0-compaction",
+       admission_waits_[kAdmitL0Compaction].load()},
+      {"admission-waits-compaction", admission_waits_[kAdmitCompaction].load()},
+      {"admission-wait-micros-wal", admission_wait_micros_[kAdmitWAL].load()},
+      {"admission-wait-micros-flush",
+       admission_wait_micros_[kAdmitFlush].load()},
+      {"admission-wait-micros-l0-compaction",
+       admission_wait_micros_[kAdmitL0Compaction].load()},
+      {"admission-wait-micros-compaction",
+       admission_wait_micros_[kAdmitCompaction].load()},
+  };
+
+  static const char *state_names[kNumZoneSpaceStates] = {
+      "empty", "open", "partial", "full", "reserved"};
+  for (uint32_t st = 0; st < kNumZoneSpaceStates; st++) {
+    ZoneSpaceState state = (ZoneSpaceState)st;
+    std::string name = std::string("space-") + state_names[st];
+    props.emplace_back(name + "-zones",
+                       std::max<int64_t>(space_zones_[st].load(), 0));
+    props.emplace_back(name + "-free", GetStateFreeSpace(state));
+    props.emplace_back(name + "-valid", GetStateValidSpace(state));
+    props.emplace_back(name + "-invalid", GetStateInvalidSpace(state));
+  }
+  props.emplace_back("stranded-space", GetStrandedSpace());
+
+  if (property == prefix + "stats") {
+    value->clear();
+    for (const auto &p : props)
+      value->append(prefix + p.first + ": " + std::to_string(p.second) + "\n");
+    return true;
+  }
+  for (const auto &p : props) {
+    if (property == prefix + p.first) {
+      *value = std::to_string(p.second);
+      return true;
+    }
+  }
+  return false;
+}
+
+#if defined(ROCKSDB_IOURING_PRESENT)
+struct io_uring *ZonedBlockDevice::GetThreadLocalIOUring() {
+  struct io_uring *iu = nullptr;
+
+  if (!thread_local_io_urings_) return nullptr;
+
+  iu = static_cast<struct io_uring *>(thread_local_io_urings_->Get());
+  if (iu == nullptr) {
+    iu = CreateIOUring();
+    if (iu != nullptr) thread_local_io_urings_->Reset(iu);
+  }
+  return iu;
+}
+#endif
+
+/* Opens one device of the file system, fills info like zbd_open() would */
+static IOStatus OpenZbdDevice(ZbdDevice *dev, bool readonly,
+                              struct zbd_info *info) {
+  if (dev->emu_)
+    return dev->emu_->Open(readonly, info, &dev->read_f_, &dev->read_direct_f_,
+                           &dev->write_f_);
+
+  dev->read_f_ = zbd_open(dev->filename_.c_str(), O_RDONLY, info);
+  if (dev->read_f_ < 0) {
+    return IOStatus::InvalidArgument("Failed to open zoned block device");
+  }
+
+  dev->read_direct_f_ =
+      zbd_open(dev->filename_.c_str(), O_RDONLY | O_DIRECT, info);
+  if (dev->read_direct_f_ < 0) {
+    return IOStatus::InvalidArgument("Failed to open zoned block device");
+  }
+
+  if (!readonly) {
+    dev->write_f_ = zbd_open(dev->filename_.c_str(), O_WRONLY | O_DIRECT, info);
+    if (dev->write_f_ < 0) {
+      return IOStatus::InvalidArgument("Failed to open zoned block device");
+    }
+  }
+  return IOStatus::OK();
+}
+
+IOStatus ZonedBlockDevice::Open(bool readonly) {
+  std::vector<struct zbd_zone> zone_rep;
+  std::vector<ZbdDevice *> zone_dev; /* device of each zone in zone_rep */
+  unsigned int reported_zones;
+  zbd_info info;
+  Status s;
+  uint64_t i = 0;
+  uint64_t m = 0;
+  uint64_t r = 0;
+  int ret;
+  uint32_t zone_cnt = 0;
+  unsigned int max_open = 0;
+
+  if (devs_.size() > ZENFS_MAX_DEVICES)
+    return IOStatus::NotSupported("Too many zoned block devices");
+
+  nr_zones_ = 0;
+  max_nr_active_io_zones_ = 0;
+  for (auto &dev : devs_) {
+    struct zbd_zone *dev_rep;
+    IOStatus open_status = OpenZbdDevice(dev.get(), readonly, &info);
+    if (!open_status.ok()) return open_status;
+
+    if (info.model != ZBD_DM_HOST_MANAGED) {
+      return IOStatus::NotSupported("Not a host managed block device");
+    }
+
+    if (info.nr_zones < ZENFS_MIN_ZONES) {
+      return IOStatus::NotSupported(
+          "To few zones on zoned block device (32 required)");
+    }
+
+    if (dev == devs_[0]) {
+      block_sz_ = info.pblock_size;
+      zone_sz_ = info.zone_size;
+    } else if (block_sz_ != info.pblock_size || zone_sz_ != info.zone_size) {
+      return IOStatus::NotSupported(
+          "Zoned block devices differ in zone or block size");
+    }
+
+    dev->base_ = (uint64_t)nr_zones_ * zone_sz_;
+    dev->size_ = (uint64_t)info.nr_zones * zone_sz_;
+    nr_zones_ += info.nr_zones;
+
+    /* We need one open zone for meta data writes on the first device, the
+     * rest can be used for files */
+    unsigned int meta = (dev == devs_[0]) ? 1 : 0;
+    if (info.max_nr_active_zones == 0) {
+      dev->max_nr_active_zones_ = 0;
+      max_nr_active_io_zones_ += info.nr_zones;
+    } else {
+      dev->max_nr_active_zones_ = info.max_nr_active_zones - meta;
+      max_nr_active_io_zones_ += dev->max_nr_active_zones_;
+    }
+
+    if (info.max_nr_open_zones == 0)
+      max_open += info.nr_zones;
+    else
+      max_open += info.max_nr_open_zones - meta;
+
+    Info(logger_,
+         "Zone block device %s nr zones: %u max active: %u max open: %u \n",
+         dev->filename_.c_str(), info.nr_zones, info.max_nr_active_zones,
+         info.max_nr_open_zones);
+
+    if (dev->emu_)
+      ret = dev->emu_->ListZones(0, dev->size_, &dev_rep, &reported_zones);
+    else
+      ret = zbd_list_zones(dev->read_f_, 0, dev->size_, ZBD_RO_ALL, &dev_rep,
+                           &reported_zones);
+
+    if (ret || reported_zones != info.nr_zones) {
+      Error(logger_, "Failed to list zones, err: %d", ret);
+      return IOStatus::IOError("Failed to list zones");
+    }
+    zone_rep.insert(zone_rep.end(), dev_rep, dev_rep + reported_zones);
+    zone_dev.insert(zone_dev.end(), reported_zones, dev.get());
+    free(dev_rep);
+  }
+  reported_zones = zone_rep.size();
+
+  if (!readonly) {
+#if defined(ROCKSDB_IOURING_PRESENT)
+    /* Appends stay synchronous if io_uring is not supported */
+    struct io_uring *new_io_uring = CreateIOUring();
+    if (new_io_uring != nullptr) {
+      thread_local_io_urings_.reset(new ThreadLocalPtr(DeleteIOUring));
+      delete new_io_uring;
+    }
+#endif
+  }
+
+  buffer_pool_ =
+      AlignedChunkPool::GetShared(ZENFS_STAGING_CHUNK_SIZE, block_sz_);
+
+  max_nr_open_io_zones_ = max_open;
+
+  /* Keep the WAL ring off the SST open zone budget if the device allows */
+  if (max_nr_open_io_zones_ > 2 * ZENFS_WAL_OPEN_ZONES) {
+    max_nr_open_wal_zones_ = ZENFS_WAL_OPEN_ZONES;
+    max_nr_open_io_zones_ -= ZENFS_WAL_OPEN_ZONES;
+  }
+
+  zone_map_.assign(nr_zones_, nullptr);
+
+  while (m < ZENFS_META_ZONES && i < reported_zones) {
+    struct zbd_zone *z = &zone_rep[i];
+    ZbdDevice *dev = zone_dev[i++];
+    /* Only use sequential write required zones */
+    if (zbd_zone_type(z) == ZBD_ZONE_TYPE_SWR) {
+      if (!zbd_zone_offline(z)) {
+        Zone* new_zone = new Zone(this, dev, z, zone_cnt);
+        meta_zones.push_back(new_zone);
+        id_to_zone_.insert(std::pair<int,Zone*>(zone_cnt, new_zone));
+        zone_cnt++;
+      }
+      m++;
+    }
+  }
+ 
+  /* Zone cleaning destinations are active zones too */
+  nr_reserved_zones_ = std::max(
+      (unsigned int)ZENFS_GC_MIN_RESERVED_ZONES,
+      std::min((unsigned int)RESERVED_ZONE_FOR_CLEANING,
+               max_nr_active_io_zones_ / 4));
+
+  //(TODO)::Should reserved zone be treated as active_io_zones_?
+  while(r <= nr_reserved_zones_ && i < reported_zones) {
+    struct zbd_zone *z = &zone_rep[i];
+    ZbdDevice *dev = zone_dev[i++];
+    /* Only use sequential write required zones */
+    if (zbd_zone_type(z) == ZBD_ZONE_TYPE_SWR) {
+      if (!zbd_zone_offline(z)) {
+        Zone* new_zone = new Zone(this, dev, z, zone_cnt);
+        io_zones.push_back(new_zone);
+        new_zone->reserved_ = true;
+        reserved_zones.push_back(new_zone);
+        id_to_zone_.insert(std::pair<int,Zone*>(zone_cnt, new_zone));
+        zone_map_[new_zone->GetZoneNr()] = new_zone;
+        zone_cnt++;
+      }
+      r++;
+    }
+  }
+    
+  active_io_zones_ = 0;
+  open_io_zones_ = 0;
+
+  for (; i < reported_zones; i++) {
+    struct zbd_zone *z = &zone_rep[i];
+    /* Only use sequential write required zones */
+    if (zbd_zone_type(z) == ZBD_ZONE_TYPE_SWR) {
+      if (!zbd_zone_offline(z)) {
+        Zone *newZone = new Zone(this, zone_dev[i], z, zone_cnt);
+        io_zones.push_back(newZone);
+        id_to_zone_.insert(std::pair<int,Zone*>(zone_cnt, newZone));
+        zone_map_[newZone->GetZoneNr()] = newZone;
+        zone_cnt++;
+
+        if (zbd_zone_imp_open(z) || zbd_zone_exp_open(z) ||
+            zbd_zone_closed(z)) {
+          active_io_zones_++;
+          newZone->SetActive(true);
+          if (zbd_zone_imp_open(z) || zbd_zone_exp_open(z)) {
+            if (!readonly) {
+              newZone->Close();
+            }
+          }
+        }
+      }
+    }
+  }
+
+  start_time_ = time(NULL);
+
+  for (auto &dev : devs_) dev->empty_zones_.Init(zone_cnt);
+  sweep_zones_.Init(zone_cnt);
+  sweep_batch_.reserve(zone_cnt);
+  for (const auto z : io_zones) z->accounted_ = true;
+  AccountAllZones();
+  RebuildZoneBuckets();
+
+  return IOStatus::OK();
+}
+
+void ZonedBlockDevice::NotifyIOZoneFull() {
+  const std::lock_guard<std::mutex> lock(zone_resources_mtx_);
+  active_io_zones_--;
+}
+
+void ZonedBlockDevice::NotifyIOZoneClosed() { ReleaseOpenZone(); }
+
+bool ZonedBlockDevice::ReserveOpenZone(bool may_wait,
+                                       ZoneAdmission admission) {
+  std::unique_lock<std::mutex> lk(zone_resources_mtx_);
+  bool queued = false;
+
+  for (const auto &q : admission_queues_) queued = queued || !q.empty();
+  /* Slots are taken before a zone is picked, so concurrent allocations can
+   * not overshoot the limit. A free slot is not taken from queued writers */
+  if (!queued && open_io_zones_.load() < max_nr_open_io_zones_) {
+    open_io_zones_++;
+    return true;
+  }
+  if (!may_wait) return false;
+
+  AdmissionWaiter w;
+  w.since_ = std::chrono::steady_clock::now();
+  admission_queues_[admission].push_back(&w);
+  GrantOpenZones();
+  w.cv_.wait(lk, [&w] { return w.granted_; });
+  lk.unlock();
+
+  uint64_t waited = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - w.since_)
+                        .count();
+  admission_waits_[admission]++;
+  admission_wait_micros_[admission] += waited;
+  Statistics *stats = GetStatistics();
+  if (stats) RecordInHistogram(stats, ZENFS_ZONE_ADMISSION_MICROS, waited);
+  return true;
+}
+
+uint64_t ZonedBlockDevice::BeginIO(ZoneIOClass io_class) {
+  static const uint32_t depths[kNumIOClasses] = {
+      0, ZENFS_IO_DEPTH_COMPACTION, ZENFS_IO_DEPTH_GC};
+  auto now = std::chrono::steady_clock::now();
+  uint64_t start = std::chrono::duration_cast<std::chrono::microseconds>(
+                       now.time_since_epoch())
+                       .count();
+
+  if (io_class == kIOForeground) {
+    io_in_flight_[kIOForeground]++;
+    return start;
+  }
+
+  std::unique_lock<std::mutex> lk(io_sched_mtx_);
+  auto yield_until = now + std::chrono::microseconds(ZENFS_IO_YIELD_US);
+  bool waited = false;
+  io_queued_[io_class]++;
+  for (;;) {
+    bool yield = false;
+    for (uint32_t c = 0; c < io_class; c++)
+      yield = yield || io_in_flight_[c].load() || io_queued_[c].load();
+    if (yield && std::chrono::steady_clock::now() >= yield_until)
+      yield = false;
+    if (!yield && io_in_flight_[io_class].load() < depths[io_class]) break;
+
+    waited = true;
+    if (yield)
+      io_sched_cv_.wait_until(lk, yield_until);
+    else
+      io_sched_cv_.wait(lk);
+  }
+  io_queued_[io_class]--;
+  io_in_flight_[io_class]++;
+  if (waited) io_waits_[io_class]++;
+  return start;
+}
+
+void ZonedBlockDevice::EndIO(ZoneIOClass io_class, uint64_t start) {
+  static const Histograms histograms[kNumIOClasses] = {
+      ZENFS_FOREGROUND_READ_MICROS, ZENFS_COMPACTION_READ_MICROS,
+      ZENFS_GC_IO_MICROS};
+
+  /* A foreground I/O only wakes the queued ones when it was the last */
+  if (io_in_flight_[io_class].fetch_sub(1) == 1 ||
+      io_class != kIOForeground) {
+    bool queued = false;
+    for (const auto &q : io_queued_) queued = queued || q.load();
+    if (queued) {
+      const std::lock_guard<std::mutex> lock(io_sched_mtx_);
+      io_sched_cv_.notify_all();
+    }
+  }
+
+  Statistics *stats = GetStatistics();
+  if (stats) {
+    uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                       .count();
+    RecordInHistogram(stats, histograms[io_class], now - start);
+  }
+}
+
+void ZonedBlockDevice::ReleaseOpenZone() {
+  const std::lock_guard<std::mutex> lock(zone_resources_mtx_);
+  open_io_zones_--;
+  GrantOpenZones();
+}
+
+void ZonedBlockDevice::GrantOpenZones() {
+  auto now = std::chrono::steady_clock::now();
+  auto bound = std::chrono::milliseconds(ZENFS_ADMISSION_STARVATION_MS);
+
+  while (open_io_zones_.load() < max_nr_open_io_zones_) {
+    std::deque<AdmissionWaiter *> *pick = nullptr;
+
+    /* The longest waiting starved writer, else the lowest class */
+    for (auto &q : admission_queues_) {
+      if (q.empty() || now - q.front()->since_ < bound) continue;
+      if (!pick || q.front()->since_ < pick->front()->since_) pick = &q;
+    }
+    for (auto &q : admission_queues_) {
+      if (pick) break;
+      if (!q.empty()) pick = &q;
+    }
+    if (!pick) return;
+
+    AdmissionWaiter *w = pick->front();
+    pick->pop_front();
+    open_io_zones_++;
+    w->granted_ = true;
+    w->cv_.notify_one();
+  }
+}
+
+void ZonedBlockDevice::NotifyWALZoneClosed() {
+  const std::lock_guard<std::mutex> lock(wal_ring_mtx_);
+  wal_open_zones_--;
+}
+
+/* Takes a ready zone without io_zones_mtx or the open zone wait, the SST
+ * allocator is only used when the ring ran dry */
+Zone *ZonedBlockDevice::AllocateWALZone(Env::WriteLifeTimeHint file_lifetime) {
+  Zone *z = nullptr;
+
+  wal_ring_mtx_.lock();
+  if (!wal_ring_.empty() && wal_open_zones_ < max_nr_open_wal_zones_) {
+    z = wal_ring_.front();
+    wal_ring_.pop_front();
+    z->lifetime_ = file_lifetime;
+    z->wal_zone_ = true;
+    wal_open_zones_++;
+  }
+  wal_ring_mtx_.unlock();
+
+#ifndef LAZY
+  KickGCWorker();
+#endif
+  if (z) return z;
+
+  return AllocateZone(file_lifetime, InternalKey(), InternalKey(), 100, true,
+                      0, kAdmitWAL);
+}
+
+IOStatus ZonedBlockDevice::AppendWALTail(char *data, uint32_t size,
+                                         Zone **zone, uint64_t *start) {
+  std::lock_guard<std::mutex> lock(wal_tail_mtx_);
+  IOStatus s;
+
+  if (wal_tail_zone_ && wal_tail_zone_->capacity_ < size) {
+    /* Stays claimed until the tails in it are released */
+    if (wal_tail_refs_.find(wal_tail_zone_) == wal_tail_refs_.end())
+      wal_tail_zone_->CloseWR();
+    wal_tail_zone_ = nullptr;
+  }
+  if (!wal_tail_zone_) {
+    wal_tail_zone_ = AllocateWALZone(Env::WLTH_SHORT);
+    if (!wal_tail_zone_) return IOStatus::NoSpace("Zone allocation failure\n");
+  }
+
+  *start = wal_tail_zone_->wp_;
+  s = wal_tail_zone_->Append(data, size);
+  if (!s.ok()) return s;
+
+  *zone = wal_tail_zone_;
+  wal_tail_refs_[wal_tail_zone_]++;
+  return IOStatus::OK();
+}
+
+void ZonedBlockDevice::ReleaseWALTail(Zone *zone) {
+  std::lock_guard<std::mutex> lock(wal_tail_mtx_);
+  auto it = wal_tail_refs_.find(zone);
+
+  assert(it != wal_tail_refs_.end());
+  if (it == wal_tail_refs_.end() || --it->second > 0) return;
+  wal_tail_refs_.erase(it);
+  /* Holds no file data, the sweep resets it */
+  if (zone != wal_tail_zone_) zone->CloseWR();
+}
+
+void ZonedBlockDevice::RefillWALRing() {
+  io_zones_mtx.lock();
+  SweepIOZones();
+  RefillWALRingLocked();
+  io_zones_mtx.unlock();
+}
+
+/* io_zones_mtx should be locked before the function is called */
+void ZonedBlockDevice::RefillWALRingLocked() {
+  if (max_nr_open_wal_zones_ == 0) return;
+
+  std::lock_guard<std::mutex> lock(wal_ring_mtx_);
+  while (wal_ring_.size() < ZENFS_WAL_RING_ZONES) {
+    /* Stays claimed, away from the allocator and zone cleaning */
+    Zone *z = AllocateEmptyZone(Env::WLTH_SHORT);
+    if (!z) break;
+    wal_ring_.push_back(z);
+  }
+}
+
+
+void ZonedBlockDevice::LogZoneStats() {
+  uint64_t used_capacity = GetUsedSpace();
+  uint64_t reclaimable_capacity = 0;
+  uint64_t written = 0;
+  uint64_t active = 0;
+
+  /* From the space accounts, no zone scan */
+  for (uint32_t s = 0; s < kNumZoneSpaceStates; s++) {
+    if (s == kSpaceReserved) continue;
+    reclaimable_capacity += GetStateInvalidSpace((ZoneSpaceState)s);
+    written += GetStateValidSpace((ZoneSpaceState)s) +
+               GetStateInvalidSpace((ZoneSpaceState)s);
+  }
+  active = std::max<int64_t>(space_zones_[kSpaceOpen].load(), 0) +
+           std::max<int64_t>(space_zones_[kSpacePartial].load(), 0);
+
+  if (written == 0) written = 1;
+
+  Info(logger_,
+       "[Zonestats:time(s),used_cap(MB),reclaimable_cap(MB), "
+       "avg_reclaimable(%%), stranded_cap(MB), active(#), active_zones(#), "
+       "open_zones(#)] %ld %lu %lu %lu %lu %lu %ld %ld\n",
+       time(NULL) - start_time_, used_capacity / MB, reclaimable_capacity / MB,
+       100 * reclaimable_capacity / written, GetStrandedSpace() / MB, active,
+       active_io_zones_.load(), open_io_zones_.load());
+}
+
+void ZonedBlockDevice::LogZoneUsage() {
+  for (const auto z : io_zones) {
+    int64_t used = z->used_capacity_;
+
+    if (used > 0) {
+      Debug(logger_, "Zone 0x%lX used capacity: %ld bytes (%ld MB)\n",
+            z->start_, used, used / MB);
+    }
+  }
+}
+
+ZonedBlockDevice::~ZonedBlockDevice() {
+  StopGCWorker();
+  StopSweepWorker();
+  StopZoneStatsWorker();
+
+  for (auto &buf : gc_bufs_) free(buf.data_);
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (gc_io_uring_ != nullptr) {
+    io_uring_queue_exit(gc_io_uring_);
+    DeleteIOUring(gc_io_uring_);
+  }
+#endif
+  
+  for (const auto z : meta_zones) {
+    delete z;
+  }
+
+  for (const auto z : io_zones) {
+    delete z;
+  }
+  for (const auto &dev : devs_) {
+    for (int f : {dev->read_f_, dev->read_direct_f_, dev->write_f_}) {
+      if (f < 0) continue;
+      if (dev->emu_)
+        close(f);
+      else
+        zbd_close(f);
+    }
+  }
+}
+
+#define LIFETIME_DIFF_NOT_GOOD (100)
+
+unsigned int GetLifeTimeDiff(Env::WriteLifeTimeHint zone_lifetime,
+                             Env::WriteLifeTimeHint file_lifetime) {
+  assert(file_lifetime <= Env::WLTH_EXTREME);
+
+  if ((file_lifetime == Env::WLTH_NOT_SET) ||
+      (file_lifetime == Env::WLTH_NONE)) {
+    if (file_lifetime == zone_lifetime) {
+      return 0;
+    } else {
+      return LIFETIME_DIFF_NOT_GOOD;
+    }
+  }
+
+  if (zone_lifetime > file_lifetime) return zone_lifetime - file_lifetime;
+
+  return LIFETIME_DIFF_NOT_GOOD;
+}
+
+double GetSLifeTimeDiff(const Zone* zone, double zone_secondary_lifetime,
+                             Env::WriteLifeTimeHint file_lifetime) {
+  assert(file_lifetime <= Env::WLTH_EXTREME);
+  uint64_t total_length = 0;
+  uint64_t expected_length = 0;
+  double slt = 0;
+
+  for(const auto e : zone->extent_info_) {
+      total_length += e->length_;
+  }
+
+  expected_length = (total_length / (zone->extent_info_.size()));
+  total_length += expected_length;
+  
+  for(const auto e : zone->extent_info_) {
+      double weigth = (((double)e->length_)/(total_length));
+      slt += (weigth * (double)(e->lt_));
+  }
+  
+  double w = (((double)expected_length)/(total_length));
+  slt += (w * (double)(file_lifetime));
+
+  if (zone_secondary_lifetime >= slt){
+    return zone_secondary_lifetime - slt;
+  }    
+  
+  return slt - zone_secondary_lifetime;
+}
+
+Zone *ZonedBlockDevice::AllocateMetaZone() {
+  for (const auto z : meta_zones) {
+    /* If the zone is not used, reset and use it */
+    if (!z->IsUsed()) {
+      if (!z->IsEmpty()) {
+        if (!z->Reset().ok()) {
+          Warn(logger_, "Failed resetting zone!");
+          continue;
+        }
+      }
+      return z;
+    }
+  }
+  return nullptr;
+}
+
+void ZonedBlockDevice::ResetUnusedIOZones() {
+  const std::lock_guard<std::mutex> lock(zone_resources_mtx_);
+  std::vector<Zone *> resets;
+  std::vector<Zone *> done;
+
+  /* Reset any unused zones */
+  for (const auto z : io_zones) {
+    if (IsReservedZone(z)) continue;
+    if (!z->IsUsed() && !z->IsEmpty()) {
+      if (!z->IsFull()) active_io_zones_--;
+      resets.push_back(z);
+    }
+  }
+  ResetZones(resets, &done);
+  if (done.size() != resets.size()) Warn(logger_, "Failed reseting zone");
+  for (const auto z : done) AddEmptyZone(z);
+}
+
+void ZonedBlockDevice::DeferResetUnusedIOZones() {
+  for (const auto z : io_zones) {
+    if (IsReservedZone(z) || z->IsUsed() || z->IsEmpty()) continue;
+    z->stale_ = true;
+    z->Account();
+    AddSweepZone(z);
+  }
+}
+
+/* Length of the run of zones starting at zones[i] which are adjacent on one
+ * device, zones must be sorted by start */
+static size_t ZoneRangeLength(const std::vector<Zone *> &zones, size_t i,
+                              uint64_t zone_sz) {
+  size_t n = 1;
+  while (i + n < zones.size() && n < ZENFS_SWEEP_MAX_RANGE &&
+         zones[i + n]->dev_ == zones[i]->dev_ &&
+         zones[i + n]->start_ == zones[i + n - 1]->start_ + zone_sz)
+    n++;
+  return n;
+}
+
+static bool ZoneStartLess(const Zone *a, const Zone *b) {
+  return a->start_ < b->start_;
+}
+
+void ZonedBlockDevice::ResetZones(std::vector<Zone *> &zones,
+                                  std::vector<Zone *> *done) {
+  uint64_t zone_sz = GetZoneSize();
+  std::vector<struct zbd_zone> report;
+
+  std::sort(zones.begin(), zones.end(), ZoneStartLess);
+  for (size_t i = 0; i < zones.size();) {
+    size_t n = ZoneRangeLength(zones, i, zone_sz);
+    ZbdDevice *dev = zones[i]->dev_;
+    unsigned int nr = n;
+
+    report.resize(n);
+    IOStatus s = ResetZoneRange(dev, dev->Offset(zones[i]->start_),
+                                n * zone_sz, report.data(), &nr);
+    for (size_t k = 0; k < n; k++) {
+      Zone *z = zones[i + k];
+      if (!s.ok()) {
+        /* Retry the zones of a failed range one by one */
+        nr = 1;
+        if (n == 1 || !ResetZoneRange(dev, dev->Offset(z->start_), zone_sz,
+                                      &report[k], &nr)
+                           .ok())
+          continue;
+      }
+      z->ResetDone(&report[k]);
+      done->push_back(z);
+    }
+    i += n;
+  }
+}
+
+void ZonedBlockDevice::FinishZones(std::vector<Zone *> &zones,
+                                   std::vector<Zone *> *done) {
+  uint64_t zone_sz = GetZoneSize();
+
+  std::sort(zones.begin(), zones.end(), ZoneStartLess);
+  for (size_t i = 0; i < zones.size();) {
+    size_t n = ZoneRangeLength(zones, i, zone_sz);
+    ZbdDevice *dev = zones[i]->dev_;
+
+    IOStatus s =
+        FinishZoneRange(dev, dev->Offset(zones[i]->start_), n * zone_sz);
+    for (size_t k = 0; k < n; k++) {
+      Zone *z = zones[i + k];
+      if (!s.ok() &&
+          (n == 1 ||
+           !FinishZoneRange(dev, dev->Offset(z->start_), zone_sz).ok()))
+        continue;
+      z->FinishDone();
+      done->push_back(z);
+    }
+    i += n;
+  }
+}
+/*(TODO)
+void ZonedBlockDevice::PickZoneWithCompactionVictim(std::vector<Zone*>& candidates) {
+ io_zones_mtx should be locked before the function is called 
+
+    std::vector<uint64_t> fno_list;
+    db_ptr_->GetCompactionArgs(fno_list);
+}
+*/
+void ZonedBlockDevice::PickZoneWithOnlyInvalid(std::vector<Zone*>& candidates) {
+    for (const auto z : io_zones) {
+       if (!IsReservedZone(z) && (!z->IsUsed()) && (!z->IsEmpty()) &&
+           (!z->IsFull())) {
+         candidates.push_back(z);
+       }
+    }
+}
+Zone *ZonedBlockDevice::AllocateEmptyZone(Env::WriteLifeTimeHint file_lifetime) {
+  /* Counted up front, concurrent allocations can not overshoot the limit */
+  if (active_io_zones_.fetch_add(1) >= max_nr_active_io_zones_) {
+    active_io_zones_--;
+    return nullptr;
+  }
+
+  /* Spread new zones over the devices so files, WAL zones and stripes are
+   * written in parallel: the device with the fewest active zones goes first,
+   * ties are broken round robin */
+  uint64_t tried = 0;
+  Zone *z = nullptr;
+  size_t nr_devs = devs_.size();
+  size_t picked = 0;
+  while (!z) {
+    ZbdDevice *dev = nullptr;
+    for (size_t k = 0; k < nr_devs; k++) {
+      size_t d = (next_dev_ + k) % nr_devs;
+      if ((tried & (1ull << d)) || !devs_[d]->HasActiveRoom()) continue;
+      if (!dev || devs_[d]->active_zones_.load() < dev->active_zones_.load()) {
+        dev = devs_[d].get();
+        picked = d;
+      }
+    }
+    if (!dev) break;
+    tried |= 1ull << picked;
+    z = dev->empty_zones_.Pop([this](Zone *zone) {
+      if (!zone->IsEmpty() || !ClaimZone(zone)) return false;
+      /* Written by someone who claimed it between the check and the claim */
+      if (zone->IsEmpty()) return true;
+      zone->Release();
+      return false;
+    });
+  }
+  if (z) {
+    next_dev_ = (picked + 1) % nr_devs;
+    z->lifetime_ = file_lifetime;
+    z->SetActive(true);
+  } else {
+    active_io_zones_--;
+  }
+  return z;
+}
+
+bool ZonedBlockDevice::ShouldFinish(Zone *z) {
+  uint64_t cap = z->capacity_;
+  uint64_t nr = extents_appended_.load();
+
+  /* Less than finish_threshold_% remaining capacity */
+  if (cap < z->max_capacity_ * finish_threshold_ / 100) return true;
+  /* Too small for the average extent, the space is stranded anyway */
+  if (nr && cap < extent_bytes_appended_.load() / nr) return true;
+  /* Close to the active zone limit, trade a little stranded space for an
+   * active zone */
+  if (active_io_zones_.load() + ZENFS_AUTO_FINISH_ACTIVE_SLACK >=
+          (long)max_nr_active_io_zones_ &&
+      cap < z->max_capacity_ * ZENFS_AUTO_FINISH_CAPACITY_PCT / 100)
+    return true;
+  return false;
+}
+
+void ZonedBlockDevice::SweepIOZones(bool unlock_for_io) {
+/* io_zones_mtx should be locked before the function is called */
+  std::vector<Zone *> resets;
+  std::vector<Zone *> finishes;
+  std::vector<Zone *> done;
+  long released = 0;
+
+  /* Reset unused zones and finish used zones under capacity treshold. Only
+   * zones which were closed or lost valid data since the last sweep can
+   * qualify */
+  sweep_zones_.Drain(&sweep_batch_);
+  for (const auto z : sweep_batch_) {
+    if (IsReservedZone(z)) continue;
+    if (z->open_for_write_ || z->IsEmpty() || (z->IsFull() && z->IsUsed()))
+      continue;
+    /* Claimed like zones open for write, so allocation and zone cleaning
+     * leave it alone until the command completed */
+    if (!z->Acquire()) continue;
+
+    if (z->used_capacity_ == 0)  {
+      if (!z->IsFull()) released++;
+      assert(z->valid_bytes_.load() == 0);
+      resets.push_back(z);
+      continue;
+    }
+
+    if (ShouldFinish(z)) {
+      finishes.push_back(z);
+      released++;
+      continue;
+    }
+    z->Release();
+  }
+  sweep_batch_.clear();
+  if (resets.empty() && finishes.empty()) return;
+
+  if (unlock_for_io) io_zones_mtx.unlock();
+
+  FinishZones(finishes, &done);
+  if (done.size() != finishes.size()) Debug(logger_, "Failed finishing zone");
+  done.clear();
+  ResetZones(resets, &done);
+  if (done.size() != resets.size()) Debug(logger_, "Failed resetting zone !");
+
+  if (unlock_for_io) io_zones_mtx.lock();
+  for (const auto z : finishes) z->Release();
+  for (const auto z : resets) z->Release();
+  for (const auto z : done) AddEmptyZone(z);
+  active_io_zones_ -= released;
+}
+
+void ZonedBlockDevice::SweepIOZonesOrKick() {
+/* io_zones_mtx should be locked before the function is called */
+  if (sweep_worker_)
+    KickSweepWorker();
+  else
+    SweepIOZones();
+}
+
+void ZonedBlockDevice::RebuildZoneBuckets() {
+  /* Used after zones moved in or out of reserved_zones */
+  for (const auto z : io_zones) {
+    if (IsReservedZone(z)) continue;
+    if (!z->open_for_write_ && z->IsEmpty()) AddEmptyZone(z);
+    AddSweepZone(z);
+  }
+}
+
+Zone* ZonedBlockDevice::AllocateZoneWithSameLevelFiles(const std::vector<uint64_t>& fno_list, const InternalKey smallest, const InternalKey largest) {
+   
+    Zone* allocated_zone = nullptr;
+    const InternalKeyComparator* icmp = db_ptr_->GetDefaultICMP();
+    int l_idx, r_idx;
+
+
+    if (fno_list.empty()) {//ûͬļ
+      return allocated_zone;
+    }
+
+
+    if (fno_list.size() == 1) {//ֻһͬļ
+     sst_zone_mtx_.lock();
+     auto zids = sst_to_zone_.find(fno_list[0])->second;//ļŲļŶӦzone
+     /* The last zone of the file that is free to write */
+     for (auto it = zids.rbegin(); it != zids.rend(); ++it) {
+       Zone* z = id_to_zone_.find(*it)->second;//ͨzoneҵzone
+       if (!z->open_for_write_ && !z->IsFull() && !z->time_bucket_ &&
+           ClaimZone(z)) {
+         allocated_zone = z;//ûҲдͷzone
+         break;
+       }
+     }
+     sst_zone_mtx_.unlock();
+     return allocated_zone;
+    }
+
+    //Find the case.
+    //case(1) cur SSTable has smallest key.
+    //case(2) cur SSTable has largest key.
+    //case(3) cur SSTable has middle key.
+
+    int idx;
+    files_mtx_.lock();
+    for (idx = 0; idx < (int)fno_list.size(); idx++) {//ļб
+        InternalKey s, l;
+        s = files_.find(fno_list[idx])->second->smallest_;//ͨļűzonefileõС
+        l = files_.find(fno_list[idx])->second->largest_;
+        int res = icmp->Compare(largest,s);
+ 
+        if (res <= 0) {
+          assert(icmp->Compare(smallest,l) <= 0);
+          break;
+        }
+    }
+    files_mtx_.unlock();
+    l_idx = idx - 1;
+    r_idx = idx;
+
+    if ( l_idx < 0 ) { // case(1)дļͬ㼶ļkeyС
+     for (uint64_t fno : fno_list) {
+      sst_zone_mtx_.lock();
+      auto zids = sst_to_zone_.find(fno)->second;
+      for (int zid : zids) {
+       Zone* z = id_to_zone_.find(zid)->second;
+       if (!z->open_for_write_ && !z->IsFull() && !z->time_bucket_ &&
+           ClaimZone(z)) {
+         allocated_zone = z;//ҵһдͬļд
+         break;
+       }
+      }
+      sst_zone_mtx_.unlock();
+      if (allocated_zone) break;
+     }   
+    } else if (r_idx == (int)fno_list.size()) { // case(2)
+     for (auto it = fno_list.rbegin(); it != fno_list.rend(); ++it) {//list
+       sst_zone_mtx_.lock();
+       auto zids = sst_to_zone_.find(*it)->second;
+       for (int zid : zids) {
+         Zone* z = id_to_zone_.find(zid)->second;
+         if (!z->open_for_write_ && !z->IsFull() && !z->time_bucket_ &&
+             ClaimZone(z)) {
+           allocated_zone = z;
+           break;
+         }
+       }
+       sst_zone_mtx_.unlock();
+       if (allocated_zone) break;
+     }       
+    } else {
+     while ((l_idx >=0) && (r_idx < (int)fno_list.size())) {
+       if (l_idx >=0) {
+         sst_zone_mtx_.lock();
+         auto zids = sst_to_zone_.find(l_idx)->second;
+         for (int zid : zids) {
+           Zone* z = id_to_zone_.find(zid)->second;
+           if (!z->open_for_write_ && !z->IsFull() && !z->time_bucket_ &&
+               ClaimZone(z)) {
+            allocated_zone = z;
+            break;
+           }
+         }
+         sst_zone_mtx_.unlock();
+         l_idx--;
+         if(allocated_zone) break;
+       }
+       if (r_idx < (int)fno_list.size()) {
+         sst_zone_mtx_.lock();
+         auto zids = sst_to_zone_.find(r_idx)->second;
+         for (int zid : zids) {
+           Zone* z = id_to_zone_.find(zid)->second;
+           if (!z->open_for_write_ && !z->IsFull() && !z->time_bucket_ &&
+               ClaimZone(z)) {
+            allocated_zone = z;
+            break;
+           }
+         }
+         sst_zone_mtx_.unlock();
+         r_idx++;
+         if (allocated_zone) break;
+       }
+     }
+    }
+    return allocated_zone;
+}
+
+Zone* ZonedBlockDevice::AllocateMostL0Files(const std::set<int>& zone_list) {
+
+    uint64_t max = 0;
+    Zone* z = nullptr;
+
+    if (zone_list.empty()) 
+      return z;
+
+    for (const auto z_id : zone_list) {
+      Zone* zone = id_to_zone_.find(z_id)->second;
+      uint64_t length = 0;
+      
+      /* Claimed while its extents are counted, the best one is kept */
+      if (!zone->open_for_write_ && !zone->IsFull() && !zone->time_bucket_ &&
+          ClaimZone(zone)) {
+        for (const auto& ext : zone->extent_info_) {
+          if (ext->level_ == 0 && ext->valid_) {
+              length += ext->length_;    
+          }
+        }
+        if (length >= max){ 
+          max = length;
+          if (z) z->Release();
+          z = zone;
+        } else {
+          zone->Release();
+        }
+      }
+    }
+    return z;
+}
+
+void ZonedBlockDevice::SameLevelFileList(const int level, std::vector<uint64_t>& fno_list){
+    fno_list.clear();
+    if (!LoadSSTComparator()) return;
+    sst_index_.LevelFiles(level, &fno_list);
+}
+
+void ZonedBlockDevice::AdjacentFileList(const InternalKey& s, const InternalKey& l, const int level, std::vector<uint64_t>& fno_list){
+    if(level == 100) return;
+    if (!LoadSSTComparator()) return;
+    sst_index_.Overlapping(level + 1, s, l, &fno_list);
+    /* L0 files are compacted together with the other L0 files */
+    sst_index_.Overlapping(level != 0 ? level - 1 : 0, s, l, &fno_list);
+}
+
+void ZonedBlockDevice::AddSSTRange(uint64_t fno, int level,
+                                   const InternalKey& smallest,
+                                   const InternalKey& largest) {
+  LoadSSTComparator();
+  sst_index_.Insert(fno, level, smallest, largest);
+}
+
+bool ZonedBlockDevice::LoadSSTComparator() {
+  if (sst_index_.HasComparator()) return true;
+  if (db_ptr_ == nullptr) return false;
+
+  const InternalKeyComparator* icmp = db_ptr_->GetDefaultICMP();
+  if (icmp == nullptr) return false;
+  sst_index_.SetComparator(icmp);
+  lifetime_predictor_.SetComparator(icmp);
+  return true;
+}
+
+uint64_t ZonedBlockDevice::PredictSSTLifetime(int level,
+                                              const InternalKey& smallest,
+                                              const InternalKey& largest) {
+  if (level == 100) return 0;
+  LoadSSTComparator();
+  return lifetime_predictor_.Predict(level, smallest, largest);
+}
+
+void ZonedBlockDevice::ObserveSSTDeath(ZoneFile* zone_file) {
+  uint64_t now = (uint64_t)time(NULL);
+
+  if (!zone_file->is_sst_ || zone_file->level_ == 100 ||
+      !zone_file->create_time_ || zone_file->create_time_ > now)
+    return;
+  LoadSSTComparator();
+  lifetime_predictor_.Observe(zone_file->level_, zone_file->smallest_,
+                              zone_file->largest_,
+                              now - zone_file->create_time_);
+}
+
+void ZonedBlockDevice::RegisterSST(ZoneFile* zone_file) {
+  if (!zone_file->is_sst_) return;
+
+  std::vector<int> zids;
+  for (ZoneExtent* extent : zone_file->GetExtents()) {
+    int zid = extent->zone_->zone_id_;
+    if (std::find(zids.begin(), zids.end(), zid) == zids.end())
+      zids.push_back(zid);
+  }
+
+  sst_zone_mtx_.lock();
+  sst_to_zone_[zone_file->fno_] = zids;
+  sst_zone_mtx_.unlock();
+
+  if (zone_file->level_ == 100) return;
+
+  files_mtx_.lock();
+  files_[zone_file->fno_] = zone_file;
+  files_mtx_.unlock();
+  AddSSTRange(zone_file->fno_, zone_file->level_, zone_file->smallest_,
+              zone_file->largest_);
+}
+
+/* Orders keys between lo and hi, which share their first prefix_len
+ * bytes, by the next eight bytes. Only meaningful for the bytewise
+ * comparator, under which all the keys between lo and hi share the prefix */
+static double ProjectKey(const Slice& key, size_t prefix_len) {
+  uint64_t v = 0;
+  for (size_t i = prefix_len; i < prefix_len + 8; i++) {
+    v = (v << 8) | (i < key.size() ? static_cast<unsigned char>(key[i]) : 0);
+  }
+  return static_cast<double>(v);
+}
+
+/* Estimates the part of the file [fs, fl] within [s, l] by user key. Only
+ * the comparator is used, but for the bytewise one, whose keys are also
+ * projected on numbers to interpolate partial overlaps. */
+static double EstimateOverlapFraction(const Comparator* ucmp, const Slice& fs,
+                                      const Slice& fl, const Slice& s,
+                                      const Slice& l) {
+  if (ucmp->Compare(fl, s) < 0 || ucmp->Compare(fs, l) > 0) return 0;
+  const Slice& lo = ucmp->Compare(s, fs) > 0 ? s : fs;
+  const Slice& hi = ucmp->Compare(l, fl) < 0 ? l : fl;
+  if (ucmp->Compare(lo, fs) == 0 && ucmp->Compare(hi, fl) == 0) return 1;
+  if (ucmp != BytewiseComparator()) return 0.5;
+
+  size_t prefix_len = fs.difference_offset(fl);
+  double range = ProjectKey(fl, prefix_len) - ProjectKey(fs, prefix_len);
+  if (range <= 0) return 1;
+  return (ProjectKey(hi, prefix_len) - ProjectKey(lo, prefix_len)) / range;
+}
+
+Zone* ZonedBlockDevice::AllocateZoneWithOverlappingFiles(
+    const std::vector<uint64_t>& fno_list, const InternalKey& smallest,
+    const InternalKey& largest) {
+  const InternalKeyComparator* icmp = db_ptr_->GetDefaultICMP();
+  const Comparator* ucmp = icmp->user_comparator();
+  const Slice s = smallest.user_key();
+  const Slice l = largest.user_key();
+
+  // (1) Estimate the bytes of each file within the key range of the new one
+  std::map<uint64_t, double> overlap_bytes;
+  files_mtx_.lock();
+  for (uint64_t fno : fno_list) {
+    auto f = files_.find(fno);
+    if (f == files_.end()) continue;
+    ZoneFile* zf = f->second;
+    overlap_bytes[fno] =
+        zf->GetFileSize() *
+        EstimateOverlapFraction(ucmp, zf->smallest_.user_key(),
+                                zf->largest_.user_key(), s, l);
+  }
+  files_mtx_.unlock();
+
+  // (2) Credit them to the Zones where the SSTables are written
+  std::map<int, double> zone_score;
+  sst_zone_mtx_.lock();
+  for (const auto& o : overlap_bytes) {
+    auto z = sst_to_zone_.find(o.first);
+    if (z == sst_to_zone_.end() || z->second.empty()) continue;
+    for (int zone_id : z->second) {
+      zone_score[zone_id] += o.second / z->second.size();
+    }
+  }
+  sst_zone_mtx_.unlock();
+
+  // (3) Pick the Zone with free space holding the most of the key range
+  std::vector<std::pair<double, int>> candidates;
+  for (const auto& zs : zone_score) {
+    candidates.emplace_back(zs.second, zs.first);
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const std::pair<double, int>& a,
+                      const std::pair<double, int>& b) {
+                     return a.first > b.first;
+                   });
+  for (const auto& c : candidates) {
+    auto search = id_to_zone_.find(c.second);
+    if (search == id_to_zone_.end()) continue;
+    Zone* z = search->second;
+    if (!z->IsFull() && !z->open_for_write_ && !z->time_bucket_ &&
+        ClaimZone(z)) {
+      return z;
+    }
+  }
+  return nullptr;
+}
+
+ZoneAdmission ZonedBlockDevice::AdmissionForLevel(int level) {
+  if (level == 0 || level == 100) return kAdmitFlush;
+  if (level == 1) return kAdmitL0Compaction;
+  return kAdmitCompaction;
+}
+
+Zone* ZonedBlockDevice::AllocateZone(Env::WriteLifeTimeHint file_lifetime,
+                                     InternalKey smallest, InternalKey largest,
+                                     int level, bool may_wait,
+                                     uint64_t predicted_death,
+                                     ZoneAdmission admission) {
+  auto start = std::chrono::steady_clock::now();
+  ZonePlacement placement = kPlacementEmpty;
+  Zone *z = AllocateZoneInternal(file_lifetime, smallest, largest, level,
+                                 may_wait, predicted_death, admission,
+                                 &placement);
+  uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  Statistics *stats = GetStatistics();
+
+  if (z) placements_[placement]++;
+  IOSTATS_ADD(zenfs_zone_alloc_nanos, elapsed);
+  if (stats) {
+    RecordInHistogram(stats, ZENFS_ZONE_ALLOCATION_MICROS, elapsed / 1000);
+    RecordInHistogram(stats, ZENFS_OPEN_ZONES, open_io_zones_.load());
+    RecordInHistogram(stats, ZENFS_ACTIVE_ZONES, active_io_zones_.load());
+  }
+  return z;
+}
+
+Zone* ZonedBlockDevice::AllocateZoneInternal(Env::WriteLifeTimeHint file_lifetime,
+                                     InternalKey smallest, InternalKey largest,
+                                     int level, bool may_wait,
+                                     uint64_t predicted_death,
+                                     ZoneAdmission admission,
+                                     ZonePlacement *placement) {
+
+  Zone *allocated_zone = nullptr;
+  Status s;
+
+  /* Make sure we are below the zone open limit. The zone is picked without
+   * io_zones_mtx and claimed with ClaimZone(), so concurrent writers
+   * allocate in parallel */
+  if (!ReserveOpenZone(may_wait, admission)) return nullptr;
+
+  io_zones_mtx.lock();
+  SweepIOZonesOrKick();
+  RefillWALRingLocked();
+  io_zones_mtx.unlock();
+#ifndef LAZY
+  /* Zone cleaning runs in the background, just make sure it is awake */
+  if (GetFreeRatio() <= ZENFS_GC_START_FREE_RATIO) KickGCWorker();
+#endif
+
+  sst_zone_mtx_.lock();
+  bool no_ssts = sst_to_zone_.empty();
+  sst_zone_mtx_.unlock();
+  if (no_ssts) {//ûsstzone
+    allocated_zone = AllocateEmptyZone(file_lifetime);
+  }
+  if (allocated_zone) return allocated_zone;
+
+  // There's valid SSTables in Zones
+  // Find zone where the files located at adjacent level and having overlapping keys
+  std::vector<uint64_t> fno_list;
+  AdjacentFileList(smallest, largest, level, fno_list);
+  if (!fno_list.empty()) {
+    // There are SSTables with overlapped keys and adjacent level.
+    allocated_zone =
+        AllocateZoneWithOverlappingFiles(fno_list, smallest, largest);
+    if (allocated_zone) *placement = kPlacementOverlap;
+  } else if (level == 0 || level == 100) {
+
+   /* (1) There is no matching files being overlapped with current file
+        ->(TODO)Find the file within the same level which has smallest key diff*/
+    std::set<int> zone_list;
+    // L0 files are often compacted altogether.
+    // Allocate to the zone where other L0 or L1 files are located.
+    SameLevelFileList(0, fno_list);
+
+    sst_zone_mtx_.lock();
+    for (uint64_t fno : fno_list) {
+      auto z = sst_to_zone_.find(fno);
+      if (z != sst_to_zone_.end()) {
+        for (int zone_id : z->second) {
+          zone_list.insert(zone_id);
+        }
+      }
+    }
+    sst_zone_mtx_.unlock();
+    //Allocate Zones with most the number of L0 files
+    allocated_zone = AllocateMostL0Files(zone_list);
+    if (allocated_zone) *placement = kPlacementL0;
+  }
+
+  //Find the Empty Zone First
+  if (!allocated_zone) {
+    allocated_zone = AllocateEmptyZone(file_lifetime);
+    if (allocated_zone) LogZoneStats();
+  }
+  if (allocated_zone) return allocated_zone;
+
+  SameLevelFileList(level, fno_list);
+  allocated_zone = AllocateZoneWithSameLevelFiles(fno_list, smallest, largest);
+  if (allocated_zone) {
+    *placement = kPlacementSameLevel;
+    return allocated_zone;
+  }
+
+  /* Try to fill an already open zone(with the best life time diff) */
+  allocated_zone =
+      AllocateZoneWithLifetime(file_lifetime, predicted_death, placement);
+  if (allocated_zone) return allocated_zone;
+
+  if (!may_wait) {
+    ReleaseOpenZone();
+    return nullptr;
+  }
+
+#ifndef LAZY
+  //Out of zones, reclaim free space in the Device before giving up.
+  uint64_t total_invalid = 0;
+  for (auto z : io_zones) {
+    if (!IsReservedZone(z)) total_invalid += z->invalid_bytes_.load();
+  }
+  uint64_t num_zone_to_reset;
+  if (total_invalid < io_zones[0]->max_capacity_) {
+    num_zone_to_reset = 0;
+  } else {
+    num_zone_to_reset = nr_reserved_zones_;
+  }
+  /* Zone cleaning takes open zone slots itself */
+  ReleaseOpenZone();
+  /* Zones swept in the background may have become empty meanwhile */
+  WaitSweep();
+  ZoneCleaning(num_zone_to_reset, Env::IO_HIGH);
+  ReserveOpenZone(true, admission);
+
+  fno_list.clear();
+  AdjacentFileList(smallest, largest, level, fno_list);
+  if (!fno_list.empty()) {
+    // There are SSTables with overlapped keys and adjacent level.
+    allocated_zone =
+        AllocateZoneWithOverlappingFiles(fno_list, smallest, largest);
+    if (allocated_zone) *placement = kPlacementOverlap;
+  } else if (level == 0 || level == 100) {
+    /* (1) There is no matching files being overlapped with current file
+        ->(TODO)Find the file within the same level which has smallest key diff*/
+    std::set<int> zone_list;
+    // L0 files are often compacted altogether.
+    // Allocate to the zone where other L0 or L1 files are located.
+    SameLevelFileList(0, fno_list);
+    sst_zone_mtx_.lock();
+    for (uint64_t fno : fno_list) {
+      auto z = sst_to_zone_.find(fno);
+      if (z != sst_to_zone_.end()) {
+        for (int zone_id : z->second) {
+          zone_list.insert(zone_id);
+        }
+      }
+    }
+    sst_zone_mtx_.unlock();
+    //Allocate Zones with most the number of L0 files
+    allocated_zone = AllocateMostL0Files(zone_list);
+    if (allocated_zone) *placement = kPlacementL0;
+  }
+  //Find the Empty Zone First
+  if (!allocated_zone) {
+    allocated_zone = AllocateEmptyZone(file_lifetime);
+  }
+  if (allocated_zone) return allocated_zone;
+
+  if (level != 100) {
+    SameLevelFileList(level, fno_list);
+    allocated_zone = AllocateZoneWithSameLevelFiles(fno_list, smallest, largest);
+    if (allocated_zone) {
+      *placement = kPlacementSameLevel;
+      return allocated_zone;
+    }
+  }
+
+  /* Try to fill an already open zone(with the best life time diff) */
+  allocated_zone =
+      AllocateZoneWithLifetime(file_lifetime, predicted_death, placement);
+  if (allocated_zone) return allocated_zone;
+#endif
+  ReleaseOpenZone();
+  LogZoneStats();
+
+  return allocated_zone;
+}
+
+Zone *ZonedBlockDevice::AllocateZoneWithLifetime(
+    Env::WriteLifeTimeHint file_lifetime, uint64_t predicted_death,
+    ZonePlacement *placement) {
+  Zone *allocated_zone = nullptr;
+  unsigned int best_diff = LIFETIME_DIFF_NOT_GOOD;
+  uint64_t now = (uint64_t)time(NULL);
+
+  if (predicted_death > now) {
+    uint64_t max_diff = (predicted_death - now) * ZENFS_LIFETIME_MATCH_PCT / 100;
+
+    /* Picked without a lock, rescan if another allocation claimed it */
+    do {
+      uint64_t best_death_diff = UINT64_MAX;
+      allocated_zone = nullptr;
+      for (const auto z : io_zones) {
+        if (z->open_for_write_ || IsReservedZone(z) ||
+            z->used_capacity_ == 0 || z->IsFull() || z->time_bucket_ ||
+            !z->predicted_death_)
+          continue;
+        uint64_t diff = z->predicted_death_ > predicted_death
+                            ? z->predicted_death_ - predicted_death
+                            : predicted_death - z->predicted_death_;
+        if (diff <= max_diff && diff < best_death_diff) {
+          allocated_zone = z;
+          best_death_diff = diff;
+        }
+      }
+    } while (allocated_zone && !ClaimZone(allocated_zone));
+    if (allocated_zone) {
+      *placement = kPlacementPredicted;
+      return allocated_zone;
+    }
+  }
+
+  do {
+    best_diff = LIFETIME_DIFF_NOT_GOOD;
+    allocated_zone = nullptr;
+    for (const auto z : io_zones) {
+      if ((!z->open_for_write_) && !IsReservedZone(z) &&
+          (z->used_capacity_ > 0) && !z->IsFull() && !z->time_bucket_) {
+        unsigned int diff = GetLifeTimeDiff(z->lifetime_, file_lifetime);
+        if (diff <= best_diff) {
+          allocated_zone = z;
+          best_diff = diff;
+        }
+      }
+    }
+  } while (allocated_zone && !ClaimZone(allocated_zone));
+  if (allocated_zone) *placement = kPlacementLifetime;
+  return allocated_zone;
+}
+
+Zone *ZonedBlockDevice::AllocateBucketZone(uint64_t bucket,
+                                            Env::WriteLifeTimeHint file_lifetime,
+                                            bool may_wait,
+                                            ZoneAdmission admission) {
+  auto start = std::chrono::steady_clock::now();
+  Zone *allocated_zone = nullptr;
+
+  if (!ReserveOpenZone(may_wait, admission)) return nullptr;
+
+  io_zones_mtx.lock();
+  SweepIOZonesOrKick();
+  RefillWALRingLocked();
+  io_zones_mtx.unlock();
+#ifndef LAZY
+  if (GetFreeRatio() <= ZENFS_GC_START_FREE_RATIO) KickGCWorker();
+#endif
+
+  for (const auto z : io_zones) {
+    if (z->time_bucket_ == bucket && !z->open_for_write_ && !z->IsFull() &&
+        ClaimZone(z)) {
+      allocated_zone = z;
+      break;
+    }
+  }
+  if (allocated_zone) {
+    placements_[kPlacementTimeBucket]++;
+  } else {
+    allocated_zone = AllocateEmptyZone(file_lifetime);
+    if (allocated_zone) {
+      allocated_zone->time_bucket_ = bucket;
+      placements_[kPlacementEmpty]++;
+    }
+  }
+
+  if (!allocated_zone) ReleaseOpenZone();
+
+  if (!allocated_zone && may_wait) {
+    /* Out of empty zones, share one with other files rather than fail */
+    return AllocateZone(file_lifetime, InternalKey(), InternalKey(), 0, true,
+                        0, admission);
+  }
+
+  IOSTATS_ADD(zenfs_zone_alloc_nanos,
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count());
+  return allocated_zone;
+}
+
+void ZonedBlockDevice::SetStripeWidth(uint32_t width) {
+  stripe_width_ = std::max(1u, std::min(width, max_nr_open_io_zones_));
+}
+
+void ZonedBlockDevice::SetBufferPoolSize(uint64_t sz) {
+  buffer_pool_->SetBudget(sz ? sz : ZENFS_BUFFER_POOL_SIZE);
+}
+
+void ZonedBlockDevice::SetReadCacheSize(uint64_t sz) {
+  if (sz == 0) {
+    read_cache_.reset();
+    return;
+  }
+  read_cache_ = NewLRUCache(sz, ZENFS_READ_CACHE_SHARD_BITS, false, 0.5);
+}
+
+static void EncodeReadCacheKey(char *key, const Zone *z, uint32_t seq,
+                               uint64_t addr, size_t n) {
+  EncodeFixed32(key, (uint32_t)z->zone_id_);
+  EncodeFixed32(key + 4, seq);
+  EncodeFixed64(key + 8, addr);
+  EncodeFixed32(key + 16, (uint32_t)n);
+}
+
+void ZonedBlockDevice::DecayReadHeat() {
+  std::unique_lock<std::mutex> lock(read_heat_mtx_, std::try_to_lock);
+  if (!lock.owns_lock()) return;
+
+  uint64_t total = 0;
+  for (const auto z : io_zones) {
+    uint64_t heat = z->read_heat_.load() / 2;
+    z->read_heat_ = heat;
+    total += heat;
+  }
+  read_heat_total_ = total;
+}
+
+bool ZonedBlockDevice::ReadCacheLookup(uint64_t addr, size_t n, char *dst,
+                                       uint32_t *seq) {
+  if (!read_cache_ || n > ZENFS_READ_CACHE_MAX_READ_SIZE) return false;
+
+  Zone *z = GetIOZone(addr);
+  if (!z) return false;
+
+  z->read_heat_++;
+  if (++read_heat_total_ >= ZENFS_READ_HEAT_DECAY_READS) DecayReadHeat();
+  *seq = z->reset_seq_.load();
+
+  char key[20];
+  EncodeReadCacheKey(key, z, *seq, addr, n);
+  Cache::Handle *h = read_cache_->Lookup(Slice(key, sizeof(key)));
+  if (!h) {
+    read_cache_misses_++;
+    RecordTick(GetStatistics(), ZENFS_READ_CACHE_MISS);
+    return false;
+  }
+
+  memcpy(dst, static_cast<std::string *>(read_cache_->Value(h))->data(), n);
+  read_cache_->Release(h);
+  read_cache_hits_++;
+  RecordTick(GetStatistics(), ZENFS_READ_CACHE_HIT);
+  return true;
+}
+
+void ZonedBlockDevice::ReadCacheInsert(uint64_t addr, const char *data,
+                                       size_t n, uint32_t seq) {
+  if (!read_cache_ || n > ZENFS_READ_CACHE_MAX_READ_SIZE) return;
+
+  Zone *z = GetIOZone(addr);
+  /* The zone was reset while the data was read */
+  if (!z || z->reset_seq_.load() != seq) return;
+
+  uint64_t heat = z->read_heat_.load();
+  uint64_t avg = read_heat_total_.load() /
+                 std::max((size_t)1, io_zones.size());
+  if (heat < ZENFS_READ_CACHE_MIN_HEAT || heat < ZENFS_READ_CACHE_HOT_FACTOR * avg)
+    return;
+
+  char key[20];
+  EncodeReadCacheKey(key, z, seq, addr, n);
+  read_cache_->Insert(Slice(key, sizeof(key)), new std::string(data, n), n,
+                      [](const Slice & /*key*/, void *value) {
+                        delete static_cast<std::string *>(value);
+                      },
+                      nullptr,
+                      heat >= ZENFS_READ_CACHE_VERY_HOT_FACTOR * avg
+                          ? Cache::Priority::HIGH
+                          : Cache::Priority::LOW);
+}
+
+IOStatus ZonedBlockDevice::AppendStripes(const std::vector<Zone*>& zones,
+                                         const std::vector<struct iovec>& iovs) {
+  IOStatus s;
+
+#if defined(ROCKSDB_IOURING_PRESENT)
+  /* All writes are in flight at once, zone write locking only serializes
+   * writes within a zone */
+  /* Emulated zones check every write in Zone::Append() */
+  bool emulated = false;
+  for (const auto z : zones) emulated |= (z->dev_->emu_ != nullptr);
+  struct io_uring* iu = emulated ? nullptr : GetThreadLocalIOUring();
+  if (iu != nullptr && zones.size() > 1) {
+    uint32_t nr = zones.size();
+    std::vector<bool> done(nr, false);
+    uint32_t submitted = 0, in_flight = 0;
+    bool failed = false;
+
+    while (in_flight > 0 || (!failed && submitted < nr)) {
+      while (!failed && submitted < nr) {
+        struct io_uring_sqe* sqe = io_uring_get_sqe(iu);
+        if (sqe == nullptr) break;
+        ZbdDevice* dev = zones[submitted]->dev_;
+        io_uring_prep_writev(sqe, dev->write_f_, &iovs[submitted], 1,
+                             dev->Offset(zones[submitted]->wp_));
+        io_uring_sqe_set_data(sqe, (void*)(uintptr_t)submitted);
+        submitted++;
+        in_flight++;
+      }
+
+      bool submit_failed = false;
+      int ret = io_uring_submit_and_wait(iu, 1);
+      if (ret < 0 && ret != -EINTR) failed = submit_failed = true;
+
+      struct io_uring_cqe* cqe;
+      while (in_flight > 0 &&
+             (submit_failed ? io_uring_wait_cqe(iu, &cqe)
+                            : io_uring_peek_cqe(iu, &cqe)) == 0) {
+        uint32_t i = (uint32_t)(uintptr_t)io_uring_cqe_get_data(cqe);
+        if (cqe->res < 0 || (size_t)cqe->res != iovs[i].iov_len)
+          failed = true;
+        else
+          done[i] = true;
+        io_uring_cqe_seen(iu, cqe);
+        in_flight--;
+      }
+
+      if (submit_failed) break;
+    }
+
+    for (uint32_t i = 0; i < nr; i++) {
+      if (!done[i]) continue;
+      zones[i]->zone_df_lock_.lock();
+      zones[i]->wp_ += iovs[i].iov_len;
+      zones[i]->zone_df_lock_.unlock();
+      zones[i]->capacity_ -= iovs[i].iov_len;
+      NotifyBytesWritten(iovs[i].iov_len);
+      zones[i]->Account();
+    }
+
+    if (failed || submitted != nr)
+      return IOStatus::IOError("Write failed in striped append\n");
+    return IOStatus::OK();
+  }
+#endif
+
+  for (size_t i = 0; i < zones.size(); i++) {
+    s = zones[i]->Append(&iovs[i], 1);
+    if (!s.ok()) return s;
+  }
+  return s;
+}
+
+std::string ZonedBlockDevice::GetFilename() { return filename_; }
+uint32_t ZonedBlockDevice::GetBlockSize() { return block_sz_; }
+
+int ZonedBlockDevice::GCDestClass(ZoneFile *zone_file) {
+  int group;
+  int lifetime = 0;
+
+  if (!zone_file->is_sst_ || zone_file->level_ == 100) {
+    group = 0; /* WAL, blob and other files */
+  } else if (zone_file->level_ <= 1) {
+    group = 1;
+  } else if (db_ptr_ == nullptr ||
+             zone_file->level_ < db_ptr_->Getlevel() - 1) {
+    group = 2;
+  } else {
+    group = 3; /* The last level */
+  }
+
+  uint64_t now = (uint64_t)time(NULL);
+  if (zone_file->predicted_death_ > now)
+    lifetime = zone_file->predicted_death_ - now < ZENFS_GC_SHORT_LIFETIME_S
+                   ? 1
+                   : 2;
+  return group * 3 + lifetime;
+}
+
+Zone *ZonedBlockDevice::GCDestWithAdjacentFile(ZoneFile *zone_file) {
+  std::vector<uint64_t> fno_list;
+  std::set<int> dest_ids;
+
+  if (!zone_file->is_sst_ || zone_file->smallest_.size() == 0) return nullptr;
+  reserved_zones_mtx_.lock();
+  for (const auto &d : gc_dest_zones_) dest_ids.insert(d.second->zone_id_);
+  reserved_zones_mtx_.unlock();
+  if (dest_ids.empty()) return nullptr;
+
+  AdjacentFileList(zone_file->smallest_, zone_file->largest_,
+                   zone_file->level_, fno_list);
+  int zone_id = -1;
+  sst_zone_mtx_.lock();
+  for (const auto fno : fno_list) {
+    auto it = sst_to_zone_.find(fno);
+    if (it == sst_to_zone_.end()) continue;
+    for (const auto zid : it->second) {
+      if (dest_ids.count(zid)) {
+        zone_id = zid;
+        break;
+      }
+    }
+    if (zone_id >= 0) break;
+  }
+  sst_zone_mtx_.unlock();
+  auto it = id_to_zone_.find(zone_id);
+  return it != id_to_zone_.end() ? it->second : nullptr;
+}
+
+Zone *ZonedBlockDevice::AllocateZoneForCleaning(ZoneFile *zone_file) {
+
+  Zone *allocated_zone = nullptr;
+  Status s;
+  int cls = GCDestClass(zone_file);
+  Zone *adjacent = GCDestWithAdjacentFile(zone_file);
+
+  /* Make sure we are below the zone open limit */
+  ReserveOpenZone(true);
+
+  reserved_zones_mtx_.lock();
+  auto dest = gc_dest_zones_.find(cls);
+  if (dest != gc_dest_zones_.end()) {
+    allocated_zone = dest->second;
+  } else if (adjacent != nullptr && IsReservedZone(adjacent)) {
+    /* Next to its neighbours rather than with its class */
+    allocated_zone = adjacent;
+  } else {
+    /* A reserved zone no class appends to yet, else share one, of the
+     * same level group if possible */
+    for (const auto z : reserved_zones) {
+      bool in_use = false;
+      for (const auto &d : gc_dest_zones_) in_use |= d.second == z;
+      if (!in_use) {
+        allocated_zone = z;
+        gc_dest_zones_[cls] = z;
+        break;
+      }
+    }
+    for (const auto &d : gc_dest_zones_) {
+      if (allocated_zone) break;
+      if (d.first / 3 == cls / 3) allocated_zone = d.second;
+    }
+    if (!allocated_zone && !gc_dest_zones_.empty())
+      allocated_zone = gc_dest_zones_.begin()->second;
+  }
+
+  if (!allocated_zone || !allocated_zone->Acquire()) {
+      printZoneStatus(reserved_zones);
+      fprintf(stderr, "Allocate Zone Failed While Running Zone Cleaning!\n");
+      exit(1);
+  }
+  reserved_zones_mtx_.unlock();
+
+  return allocated_zone;
+}
+
+void ZonedBlockDevice::printZoneStatus(const std::vector<Zone *>& zones){
+
+    for (auto z : zones) {
+        
+        fprintf(stderr, "start : %ld\n", z->start_);
+        fprintf(stderr, "wp_ : %ld\n", z->wp_.load());
+        fprintf(stderr, "capacity_ : %ld\n", z->capacity_.load());
+        fprintf(stderr, "used_capacity_ : %ld\n", z->used_capacity_.load());
+
+        if(z->open_for_write_) {
+            fprintf(stderr, "open_for_write_ : true\n");
+        }else{
+            fprintf(stderr, "open_for_write_ : false\n");
+        }
+        
+        if(z->IsUsed()) {
+            fprintf(stderr, "is_used : true\n");
+        }else{
+            fprintf(stderr, "is_used : false\n");
+        }
+
+        if(z->IsFull()) {
+            fprintf(stderr, "is_full : true\n");
+        }else{
+            fprintf(stderr, "is_full : false\n");
+        }
+
+        if(z->IsEmpty()) {
+            fprintf(stderr, "is_empty : true\n");
+        }else{
+            fprintf(stderr, "is_empty : false\n");
+        }
+        fprintf(stderr, "\n\n");
+    }
+}
+
+/*
+ ZoneCleaning
+ (1) Select zone with most invalid data.
+ (2) Process until every invalid data gets cleaned from zone.
+*/
+double ZonedBlockDevice::GCScore(Zone *z, time_t now,
+                                 const std::set<uint64_t>& compacting) {
+    double invalid = (double)z->invalid_bytes_.load();
+    double valid = (double)z->valid_bytes_.load();
+
+    /* A time bucket zone is reset once its last file expires, copying it
+     * is only worth it when nothing else is left */
+    if (z->time_bucket_ && valid > 0) return -valid;
+
+    if (gc_policy_ == kGCGreedy) return invalid;
+
+    /* +1 so zones written this second still get an order */
+    double age = (double)(now - z->last_write_time_ + 1);
+    double score = age * invalid / (valid + block_sz_);
+
+    if (gc_policy_ == kGCCompactionAware && valid > 0) {
+      uint64_t doomed = 0;
+      for (const auto ext : z->extent_info_) {
+        if (!ext->valid_ || !ext->zone_file_->is_sst_) continue;
+        if (ext->level_ == 0 || compacting.count(ext->zone_file_->fno_))
+          doomed += BlockAlignedLength(ext->length_, block_sz_);
+      }
+      /* Copying it now would mostly move data compaction drops anyway.
+       * Rank it behind all other candidates, least valid data first */
+      if (doomed * 2 > valid) return -valid;
+    }
+    return score;
+}
+
+void ZonedBlockDevice::PickGCVictims(int nr_victims, std::vector<Zone *>& victims) {
+/* io_zones_mtx should be locked before the function is called */
+    std::set<uint64_t> compacting;
+    if (gc_policy_ == kGCCompactionAware && db_ptr_ != nullptr)
+      db_ptr_->BeingCompactedFileList(compacting);
+
+    time_t now = time(NULL);
+    for (auto z : io_zones) {
+        //Insert into queue with sorting by the policy's score.
+        //Higher the score, Higher the priority.
+        //Claimed while scored, the score may walk the zone extents.
+        if (z->invalid_bytes_.load() > 0 && !z->open_for_write_ &&
+            !IsReservedZone(z) && z->Acquire()) {
+          gc_queue_.push(new GCVictimZone(z, GCScore(z, now, compacting)));
+          z->Release();
+        }
+    }
+    while (!gc_queue_.empty()) {
+      auto a = gc_queue_.top();
+      /* Busy until cleaned, not counted as an open zone */
+      if ((int)victims.size() < nr_victims && ClaimZone(a->get_zone_ptr())) {
+        victims.push_back(a->get_zone_ptr());
+      }
+      delete a;
+      gc_queue_.pop();
+    }
+}
+
+static IOStatus GCPRead(int fd, char *buf, uint64_t size, uint64_t offset) {
+  uint64_t done = 0;
+  while (done < size) {
+    ssize_t r = pread(fd, buf + done, size - done, offset + done);
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) return IOStatus::IOError("Zone Cleaning : read failed\n");
+    done += r;
+  }
+  return IOStatus::OK();
+}
+
+IOStatus ZonedBlockDevice::StartGCRead(GCBuffer *buf, const GCRun &run) {
+  uint64_t size = run.end_ - run.start_;
+  ZbdDevice *dev = GetDevice(run.start_);
+
+  if (buf->size_ < size) {
+    free(buf->data_);
+    buf->data_ = nullptr;
+    buf->size_ = 0;
+    if (posix_memalign((void **)&buf->data_, block_sz_, size)) {
+      buf->data_ = nullptr;
+      return IOStatus::IOError(
+          "Zone Cleaning : failed allocating alignment read buffer\n");
+    }
+    buf->size_ = size;
+  }
+
+#if defined(ROCKSDB_IOURING_PRESENT)
+  /* Not the thread local ring, appends reap every completion on those */
+  if (gc_io_uring_ == nullptr) gc_io_uring_ = CreateIOUring();
+  if (gc_io_uring_ != nullptr) {
+    struct io_uring_sqe *sqe = io_uring_get_sqe(gc_io_uring_);
+    if (sqe != nullptr) {
+      buf->iov_.iov_base = buf->data_;
+      buf->iov_.iov_len = size;
+      io_uring_prep_readv(sqe, dev->read_direct_f_, &buf->iov_, 1,
+                          dev->Offset(run.start_));
+      /* Admitted until reaped by FinishGCRead() or WaitGCRead() */
+      buf->io_start_ = BeginIO(kIOGC);
+      if (io_uring_submit(gc_io_uring_) != 1) {
+        EndIO(kIOGC, buf->io_start_);
+        return IOStatus::IOError("Zone Cleaning : read submit failed\n");
+      }
+      buf->in_flight_ = true;
+      return IOStatus::OK();
+    }
+  }
+#endif
+  ZoneIOScope io(this, kIOGC);
+  return GCPRead(dev->read_direct_f_, buf->data_, size, dev->Offset(run.start_));
+}
+
+IOStatus ZonedBlockDevice::FinishGCRead(GCBuffer *buf, const GCRun &run) {
+  /* A run never leaves its victim zone, so it is on one device */
+  ZbdDevice *dev = GetDevice(run.start_);
+  if (dev->emu_) dev->emu_->Read(run.end_ - run.start_);
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (buf->in_flight_) {
+    uint64_t size = run.end_ - run.start_;
+    struct io_uring_cqe *cqe;
+    int ret = io_uring_wait_cqe(gc_io_uring_, &cqe);
+    if (ret) return IOStatus::IOError("Zone Cleaning : read wait failed\n");
+    ssize_t r = cqe->res;
+    io_uring_cqe_seen(gc_io_uring_, cqe);
+    buf->in_flight_ = false;
+    EndIO(kIOGC, buf->io_start_);
+    if (r < 0) return IOStatus::IOError("Zone Cleaning : read failed\n");
+    if ((uint64_t)r < size)
+      return GCPRead(dev->read_direct_f_, buf->data_ + r, size - r,
+                     dev->Offset(run.start_) + r);
+  }
+#else
+  (void)buf;
+  (void)run;
+#endif
+  return IOStatus::OK();
+}
+
+void ZonedBlockDevice::WaitGCRead(GCBuffer *buf) {
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (buf->in_flight_) {
+    struct io_uring_cqe *cqe;
+    if (io_uring_wait_cqe(gc_io_uring_, &cqe) == 0)
+      io_uring_cqe_seen(gc_io_uring_, cqe);
+    buf->in_flight_ = false;
+    EndIO(kIOGC, buf->io_start_);
+  }
+#else
+  (void)buf;
+#endif
+}
+
+void ZonedBlockDevice::MoveSSTZone(ZoneFile *zone_file, int from, int to) {
+  if (!zone_file->is_sst_) return;
+
+  sst_zone_mtx_.lock();
+  std::vector<int> &fz = sst_to_zone_[zone_file->fno_];
+  for (auto it = fz.begin(); it != fz.end(); it++) {
+    if (*it == from) {
+      fz.erase(it);
+      break;
+    }
+  }
+  if (std::find(fz.begin(), fz.end(), to) == fz.end()) fz.push_back(to);
+  sst_zone_mtx_.unlock();
+}
+
+void ZonedBlockDevice::ExtentTableFreed() {
+  /* Under the lock, so FreeRetired() cannot miss the notification */
+  std::lock_guard<std::mutex> lk(extent_table_mtx_);
+  extent_table_cv_.notify_all();
+}
+
+void ZonedBlockDevice::FreeRetired(GCRetired* retired) {
+  {
+    std::unique_lock<std::mutex> lk(extent_table_mtx_);
+    extent_table_cv_.wait(lk, [retired] {
+      for (const auto& t : retired->tables_)
+        if (!t.expired()) return false;
+      return true;
+    });
+  }
+  for (auto ze : retired->extents_) delete ze;
+  retired->tables_.clear();
+  retired->extents_.clear();
+}
+
+IOStatus ZonedBlockDevice::MigrateExtent(ZoneExtentInfo* ext_info, char* buff,
+                                         Zone* cur_victim,
+                                         GCRetired* retired) {
+/* zone_cleaning_mtx should be locked before the function is called. The
+ * extent is copied without the extent lock of the file, which is only
+ * taken to swap in the copy: readers keep reading the original from the
+ * victim meanwhile, and the file can neither be deleted (that takes
+ * zone_cleaning_mtx) nor lose the extent (only zone cleaning does that) */
+    ZoneExtent* zone_extent = ext_info->extent_;
+    ZoneFile* zone_file = ext_info->zone_file_;
+    int victim_zone_id = cur_victim->zone_id_;
+    Zone* allocated_zone = nullptr;
+
+    assert(zone_extent && zone_file);
+
+    uint32_t valid_size = zone_extent->length_;
+    uint32_t data_size = BlockAlignedLength(valid_size, block_sz_);
+    uint32_t pad_sz = data_size - valid_size;
+
+    if (pad_sz > 0) {
+      memset((char*)buff + valid_size, 0x0, pad_sz);
+    }
+
+    //allocate Zone and write contents.
+    allocated_zone = AllocateZoneForCleaning(zone_file);
+    assert(allocated_zone);
+
+    //Copy contents to new zone.
+    IOStatus s;
+    {
+        ZoneIOScope io(this, kIOGC);
+        uint32_t left = data_size;
+        uint32_t wr_size, offset = 0;
+        uint32_t new_extent_length = 0;
+        std::vector<ZoneExtent *> new_zone_extents;
+
+        while (left) { 
+            assert(allocated_zone);                   
+            if(left <= allocated_zone->capacity_){
+
+            //There'are enough room for write original extent
+                s = allocated_zone->Append((char*)buff + offset, left);
+                if (!s.ok()) break;
+                allocated_zone->used_capacity_ += left;
+
+                ZoneExtent * new_extent = new ZoneExtent((allocated_zone->wp_ - left), /*Extent length*/left-pad_sz, allocated_zone);
+                ZoneExtentInfo * new_extent_info = extent_info_pool_.New(new_extent, zone_file, left-pad_sz);
+                allocated_zone->PushExtentInfo(new_extent_info);
+                new_zone_extents.push_back(new_extent);
+                
+                allocated_zone->Release();
+                ReleaseOpenZone();
+                
+                MoveSSTZone(zone_file, victim_zone_id, allocated_zone->zone_id_);
+
+                new_extent_length +=left-pad_sz;
+                break; /*left = 0*/
+            } else {  
+                wr_size = allocated_zone->capacity_;
+                s = allocated_zone->Append((char*)buff + offset, wr_size);
+                if (!s.ok()) break;
+                allocated_zone->used_capacity_ += wr_size;
+
+                left -= wr_size;
+                offset += wr_size;
+                assert(allocated_zone->capacity_ == 0); 
+
+                ZoneExtent * new_extent = new ZoneExtent((allocated_zone->wp_ - wr_size), /*Extent length*/wr_size, allocated_zone);
+
+                ZoneExtentInfo * new_extent_info = extent_info_pool_.New(new_extent, zone_file, wr_size);
+                allocated_zone->PushExtentInfo(new_extent_info);    
+                
+                new_extent_length += wr_size;
+                new_zone_extents.push_back(new_extent);
+
+                MoveSSTZone(zone_file, victim_zone_id, allocated_zone->zone_id_);
+                //update and notify resource status
+                allocated_zone->Release();
+                ReleaseOpenZone();
+
+                allocated_zone->Finish();
+                active_io_zones_--;
+
+                reserved_zones_mtx_.lock();
+                SetReservedZone(allocated_zone, false);
+                reserved_zones_mtx_.unlock();
+                //newly allocate new zone for write
+                allocated_zone = AllocateZoneForCleaning(zone_file);
+                assert(allocated_zone);
+            }
+        }//end of while.
+
+        if (!s.ok()) {
+          /* The data stays valid in the victim, drop the partial copy */
+          allocated_zone->Release();
+          ReleaseOpenZone();
+          for (auto new_ze : new_zone_extents) {
+            new_ze->zone_->used_capacity_ -= new_ze->length_;
+            new_ze->zone_->Invalidate(new_ze);
+            delete new_ze;
+          }
+          return s;
+        }
+   
+        assert(new_extent_length == valid_size);
+        assert(cur_victim->used_capacity_ >= zone_extent->length_); 
+        cur_victim->used_capacity_ -= zone_extent->length_; 
+        cur_victim->Account();
+        //update extent information of the file.
+        //Replace origin extent information with newly made extent list.
+        zone_file->ExtentWriteLock();
+        std::vector<ZoneExtent *> origin_extents_ = zone_file->GetExtentsList();
+        std::vector<ZoneExtent *> replace_extents_;
+
+        for (auto ze : origin_extents_) {
+          if (zone_extent == ze) {
+            for (auto new_ze : new_zone_extents) {
+              replace_extents_.push_back(new_ze);
+            }
+          } else {
+            replace_extents_.push_back(ze);
+          }
+        }
+        retired->tables_.push_back(zone_file->UpdateExtents(replace_extents_));
+        zone_file->ExtentWriteUnlock();
+        /* Reads may still be on the old extent, it is freed before the
+         * victim is reset. The victim record goes away with the reset */
+        retired->extents_.push_back(zone_extent);
+        uint64_t len = BlockAlignedLength(ext_info->length_, block_sz_);
+        cur_victim->valid_bytes_ -= len;
+        cur_victim->invalid_bytes_ += len;
+        ext_info->valid_ = false;
+        ext_info->extent_ = nullptr;
+    }
+    gc_copied_bytes_ += data_size;
+    gc_extents_migrated_++;
+    RecordTick(GetStatistics(), ZENFS_GC_BYTES_COPIED, data_size);
+    RecordTick(GetStatistics(), ZENFS_GC_EXTENTS_MIGRATED);
+    return s;
+}
+
+int ZonedBlockDevice::ZoneCleaning(int nr_reset, Env::IOPriority io_pri) {
+
+/* io_zones_mtx should not be held, it is taken to pick the victims */
+    zone_cleaning_mtx.lock();
+    int reseted = 0;
+
+    if (nr_reset == 0){
+      reserved_zones_mtx_.lock();
+      if (!reserved_zones.empty()) SetReservedZone(reserved_zones[0], false);
+      reserved_zones_mtx_.unlock();
+      RebuildZoneBuckets();
+      zone_cleaning_mtx.unlock();
+      return 0;
+    }
+
+    std::vector<Zone *> victims;
+    io_zones_mtx.lock();
+    PickGCVictims(nr_reset, victims);
+    io_zones_mtx.unlock();
+
+#ifdef EXPERIMENT
+    uint64_t copied_start = gc_copied_bytes_.load();
+#endif
+    for (Zone* cur_victim : victims) {
+        //Process until every invalid data gets cleaned from zone.
+        assert(cur_victim);
+
+        //Find the valid extents in currently selected zone, in disk order.
+        std::vector<ZoneExtentInfo *> valid_extents_info;
+
+        for (auto exinfo : cur_victim->extent_info_){
+           if (exinfo->valid_ == true) {
+             valid_extents_info.push_back(exinfo);
+           }
+        }
+        std::sort(valid_extents_info.begin(), valid_extents_info.end(),
+                  [](const ZoneExtentInfo *a, const ZoneExtentInfo *b) {
+                    return a->start_ < b->start_;
+                  });
+
+        //Coalesce back to back extents into runs read with a single I/O.
+        std::vector<GCRun> runs;
+        for (size_t i = 0; i < valid_extents_info.size(); i++) {
+          ZoneExtentInfo *ext_info = valid_extents_info[i];
+          uint64_t end = ext_info->start_ +
+                         BlockAlignedLength(ext_info->length_, block_sz_);
+          if (!runs.empty() && runs.back().end_ == ext_info->start_ &&
+              end - runs.back().start_ <= ZENFS_GC_MAX_READ_SIZE) {
+            runs.back().end_ = end;
+            runs.back().last_ = i + 1;
+          } else {
+            runs.push_back({ext_info->start_, end, i, i + 1});
+          }
+        }
+
+        //Read the next run while the current one is written out.
+        IOStatus s;
+        GCRetired retired;
+        if (!runs.empty()) {
+          RequestIO(runs[0].end_ - runs[0].start_, io_pri,
+                    RateLimiter::OpType::kRead);
+          s = StartGCRead(&gc_bufs_[0], runs[0]);
+        }
+        for (size_t r = 0; s.ok() && r < runs.size(); r++) {
+          GCBuffer *cur = &gc_bufs_[r % 2];
+          s = FinishGCRead(cur, runs[r]);
+          if (!s.ok()) break;
+          if (r + 1 < runs.size()) {
+            RequestIO(runs[r + 1].end_ - runs[r + 1].start_, io_pri,
+                      RateLimiter::OpType::kRead);
+            s = StartGCRead(&gc_bufs_[(r + 1) % 2], runs[r + 1]);
+            if (!s.ok()) break;
+          }
+          RequestIO(runs[r].end_ - runs[r].start_, io_pri,
+                    RateLimiter::OpType::kWrite);
+          for (size_t i = runs[r].first_; s.ok() && i < runs[r].last_; i++) {
+            ZoneExtentInfo *ext_info = valid_extents_info[i];
+            assert(cur_victim == ext_info->extent_->zone_);
+            s = MigrateExtent(ext_info, cur->data_ + (ext_info->start_ - runs[r].start_),
+                              cur_victim, &retired);
+          }
+        }
+        /* One wait per victim for the reads still on its extents */
+        FreeRetired(&retired);
+        if (!s.ok()) {
+          /* Valid data is left in the victim, it must not be reset */
+          fprintf(stderr, "Zone Cleaning : failed migrating zone %d: %s\n",
+                  cur_victim->zone_id_, s.ToString().c_str());
+          /* Drop a read that may still be in flight into the other buffer */
+          for (auto &buf : gc_bufs_) WaitGCRead(&buf);
+          cur_victim->Release();
+          AddSweepZone(cur_victim);
+          continue;
+        }
+        /* Picked victims stay claimed through the reset, so allocation
+         * leaves them alone */
+        assert(cur_victim->open_for_write_);
+        cur_victim->used_capacity_.store(0);
+        cur_victim->Reset();
+        active_io_zones_--;
+        reseted++;
+        reserved_zones_mtx_.lock();
+        if (reserved_zones.size() < nr_reserved_zones_)
+          SetReservedZone(cur_victim, true);
+        reserved_zones_mtx_.unlock();
+        cur_victim->Release();
+    }
+#ifdef EXPERIMENT
+    fprintf(stdout, "Total Copied Data in ZC : %lu\n",
+            gc_copied_bytes_.load() - copied_start);
+#endif
+
+    reserved_zones_mtx_.lock();
+    for (size_t i = 0; i < reserved_zones.size(); ){
+        Zone *z = reserved_zones[i];
+        if (!z->IsEmpty() || z->IsUsed()) {
+            SetReservedZone(z, false);
+        } else {
+            ++i;
+        }
+    }
+    if (reserved_zones.size() < nr_reserved_zones_) {
+      for (const auto z : io_zones) {
+       if(reserved_zones.size() == nr_reserved_zones_)
+         break;
+       /* Claimed so an allocation which already picked it backs off */
+       if (IsReservedZone(z) || !z->IsEmpty() || !z->Acquire()) continue;
+       if (z->IsEmpty()) SetReservedZone(z, true);
+       z->Release();
+      }
+    }
+
+    while (reserved_zones.size() > nr_reserved_zones_) {
+      assert(reserved_zones[0]->IsEmpty() &&
+             !reserved_zones[0]->open_for_write_);
+      SetReservedZone(reserved_zones[0], false);
+    }
+    for (const auto z : reserved_zones) {
+        z->used_capacity_.store(0);
+        z->Account();
+    }
+    reserved_zones_mtx_.unlock();
+    RebuildZoneBuckets();
+    zone_cleaning_mtx.unlock();
+    return reseted;
+}//ZoneCleaning();
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !defined(ROCKSDB_LITE) && !defined(OS_WIN) && defined(LIBZBD)
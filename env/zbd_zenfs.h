@@ -12,11 +12,13 @@
 #include <libzbd/zbd.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/uio.h>
 #include <time.h>
 #include <unistd.h>
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <string>
 #include <utility>
@@ -24,13 +26,22 @@
 #include <queue>
 #include <functional>
 #include <map>
+#include <set>
 #include <chrono>
+#include <thread>
 
 #include <iostream>
 #include "db/db_impl/db_impl.h"
+#include "env/io_posix.h"
+#include "monitoring/lock_profiler.h"
+#include "rocksdb/cache.h"
 #include "rocksdb/env.h"
 #include "rocksdb/io_status.h"
+#include "rocksdb/rate_limiter.h"
 #include "db/version_edit.h"
+#include "util/random.h"
+#include "util/thread_local.h"
+#include "zbd_emu.h"
 
 namespace ROCKSDB_NAMESPACE {
 class ZenFS;
@@ -39,33 +50,23 @@ class Zone;
 class ZoneFile;
 class ZonedBlockDevice;
 class ZoneExtent;
+class ZoneExtentTable;
 
 //(ZC)::class and struct added for Zone Cleaning 
+/* Record of an extent written to a zone, kept in the zone until it is
+ * reset. Records come from an ExtentInfoPool and the extent points back at
+ * its record through ZoneExtent::info_, so invalidation does not search the
+ * zone. The file is referenced, not its name */
 struct ZoneExtentInfo {
 
   ZoneExtent* extent_;
   ZoneFile* zone_file_;
-  bool valid_;
-  uint32_t length_;
   uint64_t start_;
-  Zone* zone_;
-  std::string fname_;
-  Env::WriteLifeTimeHint lt_;
-  int level_;
-
-  explicit ZoneExtentInfo(ZoneExtent* extent, ZoneFile* zone_file, bool valid, 
-                          uint64_t length, uint64_t start, Zone* zone, std::string fname, 
-                          Env::WriteLifeTimeHint lt, int level)
-      : extent_(extent),
-        zone_file_(zone_file), 
-        valid_(valid), 
-        length_(length), 
-        start_(start), 
-        zone_(zone), 
-        fname_(fname), 
-        lt_(lt),
-        level_(level){ };
-  
+  uint32_t length_;
+  int16_t level_;
+  uint8_t lt_; /* Env::WriteLifeTimeHint */
+  bool valid_;
+
   void invalidate() {
     assert(extent_ != nullptr);
     if (!valid_) {
@@ -75,71 +76,329 @@ struct ZoneExtentInfo {
   };
 };
 
+/* Hands out ZoneExtentInfo records from slabs and recycles them, instead
+ * of one heap allocation per extent */
+class ExtentInfoPool {
+ public:
+  /* Valid record of length bytes of extent, taking the level and lifetime
+   * hint of zone_file */
+  ZoneExtentInfo *New(ZoneExtent *extent, ZoneFile *zone_file,
+                      uint32_t length);
+  void Free(ZoneExtentInfo *info);
+
+ private:
+  std::mutex mtx_;
+  std::vector<std::unique_ptr<ZoneExtentInfo[]>> slabs_;
+  std::vector<ZoneExtentInfo *> free_;
+};
+
+/* How zone cleaning orders its victims */
+enum ZoneGCPolicy : uint32_t {
+  kGCGreedy = 0,      /* most invalid data first */
+  kGCCostBenefit = 1, /* age * invalid / valid, cheap and cold zones first */
+  /* Cost-benefit, but zones whose valid data is mostly about to be
+   * rewritten by compaction (L0 files or files being compacted) go last */
+  kGCCompactionAware = 2,
+};
+
+/* Which AllocateZone() rule picked the zone of a file */
+enum ZonePlacement : uint32_t {
+  kPlacementOverlap = 0,   /* overlapping keys in an adjacent level */
+  kPlacementL0 = 1,        /* zone holding the most L0 files */
+  kPlacementSameLevel = 2, /* closest keys in the same level */
+  kPlacementLifetime = 3,  /* open zone with the best lifetime diff */
+  kPlacementEmpty = 4,
+  kPlacementTimeBucket = 5, /* zone of the file's FIFO time bucket */
+  kPlacementPredicted = 6, /* open zone with the closest predicted death */
+  kNumZonePlacements = 7,
+};
+
+/* Class of a writer waiting for an open io zone slot. Slots are handed to
+ * the lowest class first, see ZonedBlockDevice::GrantOpenZones() */
+enum ZoneAdmission : uint32_t {
+  kAdmitWAL = 0,
+  kAdmitFlush = 1, /* L0 SSTs, zone cleaning and files without a level */
+  kAdmitL0Compaction = 2, /* L1 SSTs, written by L0->L1 compactions */
+  kAdmitCompaction = 3,
+  kNumZoneAdmissions = 4,
+};
+
+/* Class of a device I/O, see ZonedBlockDevice::BeginIO(). Foreground reads
+ * go first, the other classes yield to them and to each other in order */
+enum ZoneIOClass : uint32_t {
+  kIOForeground = 0, /* reads at IOPriority::kIOHigh, user reads */
+  kIOCompaction = 1, /* other reads, compaction inputs and prefetches */
+  kIOGC = 2,         /* zone cleaning reads and copies */
+  kNumIOClasses = 3,
+};
+
+/* State an io zone is accounted under, see Zone::Account() */
+enum ZoneSpaceState : uint32_t {
+  kSpaceEmpty = 0,
+  kSpaceOpen = 1,    /* claimed by a writer, zone cleaning or the sweep */
+  kSpacePartial = 2, /* partially written and closed, its free bytes are
+                      * stranded until the zone is picked again */
+  kSpaceFull = 3,
+  kSpaceReserved = 4, /* set aside for zone cleaning */
+  kNumZoneSpaceStates = 5,
+};
+
+/* Space of one zone as last applied to the device accounts */
+struct ZoneSpace {
+  uint32_t state_ = kSpaceEmpty;
+  bool counted_ = false;
+  uint64_t free_ = 0;
+  uint64_t valid_ = 0;
+  uint64_t invalid_ = 0; /* written and no longer valid, or padding */
+};
+
+/* One sample of the zone stats history */
+struct ZoneStatsSample {
+  struct ZoneStat {
+    int zone_id_;
+    uint64_t valid_bytes_;
+    uint64_t invalid_bytes_;
+    uint32_t level_mask_; /* see Zone::level_mask_ */
+  };
+
+  uint64_t time_; /* seconds since the epoch */
+  uint64_t written_bytes_;
+  uint64_t gc_copied_bytes_;
+  uint64_t placements_[kNumZonePlacements];
+  std::vector<ZoneStat> zones_;
+};
+
 class GCVictimZone {
 
   public:
-   GCVictimZone(Zone* zone, uint64_t invalid_bytes)
+   GCVictimZone(Zone* zone, double score)
     : zone_(zone),
-      invalid_bytes_(invalid_bytes){};
+      score_(score){};
 
-  uint64_t get_inval_bytes() const {return invalid_bytes_;};
+  double get_score() const {return score_;};
   Zone * get_zone_ptr() const {return zone_;};
 
   private:
     Zone *zone_;
-    uint64_t invalid_bytes_;
+    double score_;
 };
 
 class InvalComp{
   public:
    bool operator()(const GCVictimZone *a, const GCVictimZone* b){
-    return a->get_inval_bytes() < b->get_inval_bytes();
+    return a->get_score() < b->get_score();
    };
 };
 
-class AllocVictimZone {
+/* Zones waiting in one allocation state (e.g. empty). Zones are pushed when
+ * their state may have changed and checked again by the consumer, so stale
+ * entries are harmless. Storage is sized once, Push/Pop never allocate */
+class ZoneBucket {
+ public:
+  void Init(uint32_t nr_zones) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    zones_.clear();
+    zones_.reserve(nr_zones);
+    member_.assign(nr_zones, false);
+  }
 
-  public:
-   AllocVictimZone(Zone* zone, uint64_t invalid_bytes, uint64_t valid_bytes)
-    : zone_(zone),
-      invalid_bytes_(invalid_bytes),
-      valid_bytes_(valid_bytes){};
+  void Push(Zone *z);
 
-  uint64_t get_inval_bytes() const {return invalid_bytes_;};
-  uint64_t get_valid_bytes() const {return valid_bytes_;};
-  Zone * get_zone_ptr() const {return zone_;};
+  /* Returns the most recently pushed zone satisfying pred, dropping the
+   * ones that do not. nullptr if there is none */
+  template <typename Pred>
+  Zone *Pop(Pred pred);
 
-  private:
-    Zone *zone_;
-    uint64_t invalid_bytes_;
-    uint64_t valid_bytes_;
+  /* Moves all zones to out, which should be reserved to the number of zones
+   */
+  void Drain(std::vector<Zone *> *out);
+
+ private:
+  std::mutex mtx_;
+  std::vector<Zone *> zones_;
+  std::vector<bool> member_; /* indexed by zone id */
 };
 
-class InvalValComp{
-  public:
-   bool operator()(const AllocVictimZone *a, const AllocVictimZone* b) {
-    if (a->get_valid_bytes() > b->get_valid_bytes()) {
-      /* Give higher priority zone with more invalid data */
-      return true; 
-    } else if (a->get_valid_bytes() == b->get_valid_bytes()) {
-      return a->get_inval_bytes() < b->get_inval_bytes();
-    } 
-    return false;
-   };
+/* Recycles block aligned, fixed size chunks. Used to stage SST data until the
+ * file can be placed and as the write buffers of files, without an
+ * allocation per block. Every chunk the pool allocated, handed out or
+ * cached, is charged to the budget and released chunks are only kept while
+ * the charge is within it, so the pool never blocks a writer. With
+ * huge_pages chunks in multiples of 2 MB are 2 MB aligned and advised to be
+ * backed by transparent huge pages */
+class AlignedChunkPool {
+ public:
+  AlignedChunkPool(size_t chunk_size, size_t alignment, size_t budget,
+                   bool huge_pages = false);
+  ~AlignedChunkPool() {
+    for (auto c : free_) free(c);
+  }
+
+  /* Pool shared by all devices of the process using the same chunk size and
+   * alignment, created on first use */
+  static std::shared_ptr<AlignedChunkPool> GetShared(size_t chunk_size,
+                                                     size_t alignment);
+
+  /* Returns nullptr if the allocation failed */
+  char *Allocate();
+  void Release(char *c);
+  /* Cached chunks beyond the new budget are freed */
+  void SetBudget(size_t budget);
+
+  size_t GetChunkSize() const { return chunk_size_; }
+  size_t GetCharged() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return charged_;
+  }
+
+ private:
+  const size_t chunk_size_;
+  const size_t alignment_;
+  const bool huge_pages_;
+  std::mutex mtx_;
+  size_t budget_;  /* protected by mtx_ */
+  size_t charged_; /* protected by mtx_ */
+  std::vector<char *> free_;
+};
+
+/* One of the zoned block devices a file system spans. The zones of all
+ * devices share one address space, in the order the devices were given, and
+ * I/O translates addresses with Offset() */
+struct ZbdDevice {
+  std::string filename_;
+  std::unique_ptr<ZoneEmulator> emu_; /* set for an "emu:" device */
+  int read_f_ = -1;
+  int read_direct_f_ = -1;
+  int write_f_ = -1;
+  uint64_t base_ = 0; /* address of the first zone */
+  uint64_t size_ = 0;
+  unsigned int max_nr_active_zones_ = 0; /* io zones, 0 means unlimited */
+  /* Written io zones that are neither full nor reset, see Zone::active_ */
+  std::atomic<unsigned int> active_zones_{0};
+  ZoneBucket empty_zones_; /* empty io zones not open for write */
+
+  uint64_t Offset(uint64_t addr) const { return addr - base_; }
+  bool HasActiveRoom() const {
+    return max_nr_active_zones_ == 0 ||
+           active_zones_.load() < max_nr_active_zones_;
+  }
+};
+
+/* Key ranges of the live SSTs, by the level they were written for. Each level
+ * is a treap ordered by smallest key and augmented with the largest key of
+ * the subtree, so overlap queries take O(log n + k) without asking the
+ * version set */
+class SSTRangeIndex {
+ public:
+  SSTRangeIndex() : icmp_(nullptr) {}
+  ~SSTRangeIndex();
+
+  /* The comparator is only known once the DB is open, ranges inserted
+   * before that are kept aside and indexed by SetComparator */
+  void SetComparator(const InternalKeyComparator *icmp);
+  bool HasComparator();
+
+  void Insert(uint64_t fno, int level, const InternalKey &smallest,
+              const InternalKey &largest);
+  void Remove(uint64_t fno);
+
+  /* Appends files of level overlapping [smallest, largest] in key order */
+  void Overlapping(int level, const InternalKey &smallest,
+                   const InternalKey &largest, std::vector<uint64_t> *fno_list);
+  /* Appends all files of level in key order */
+  void LevelFiles(int level, std::vector<uint64_t> *fno_list);
+
+ private:
+  struct Node {
+    InternalKey smallest_;
+    InternalKey largest_;
+    InternalKey max_largest_; /* largest key in this subtree */
+    uint64_t fno_;
+    uint32_t priority_;
+    Node *left_;
+    Node *right_;
+  };
+
+  bool Less(const Node *a, const Node *b);
+  void Update(Node *t);
+  void Split(Node *t, const Node *key, Node **l, Node **r);
+  Node *Merge(Node *l, Node *r);
+  Node *Erase(Node *t, const Node *key, Node **erased);
+  void Collect(Node *t, const InternalKey *smallest, const InternalKey *largest,
+               std::vector<uint64_t> *fno_list);
+  void Destroy(Node *t);
+  void InsertLocked(uint64_t fno, int level, const InternalKey &smallest,
+                    const InternalKey &largest);
+
+  struct PendingRange {
+    int level_;
+    InternalKey smallest_;
+    InternalKey largest_;
+  };
+
+  std::mutex mtx_;
+  const InternalKeyComparator *icmp_;
+  std::map<int, Node *> levels_;
+  std::map<uint64_t, std::pair<int, Node *>> by_fno_;
+  std::map<uint64_t, PendingRange> pending_;
+};
+
+/* Observed SST lifetimes by level and key range, fed by SST creation and
+ * deletion times. Each level keeps the most recently deleted files, a new
+ * file is predicted to live as long as those of its level whose key range
+ * overlapped its own, or as the level average when none did. Hot key
+ * ranges are compacted sooner, so they get shorter predictions than cold
+ * ones of the same level */
+class LifetimePredictor {
+ public:
+  LifetimePredictor() : icmp_(nullptr) {}
+
+  void SetComparator(const InternalKeyComparator *icmp);
+  void Observe(int level, const InternalKey &smallest,
+               const InternalKey &largest, uint64_t lifetime);
+  /* Seconds, 0 if nothing was observed for the level yet */
+  uint64_t Predict(int level, const InternalKey &smallest,
+                   const InternalKey &largest);
+
+ private:
+  struct Sample {
+    InternalKey smallest_;
+    InternalKey largest_;
+    uint64_t lifetime_;
+  };
+  struct LevelSamples {
+    std::deque<Sample> samples_;
+    double avg_ = 0; /* moving average of all lifetimes of the level */
+  };
+
+  std::mutex mtx_;
+  const InternalKeyComparator *icmp_;
+  std::map<int, LevelSamples> levels_;
 };
 
 class Zone {
   ZonedBlockDevice *zbd_;
  public:
-  explicit Zone(ZonedBlockDevice *zbd, struct zbd_zone *z, const uint32_t id);
+  /* z is as reported by dev, addresses are translated to the zbd space */
+  explicit Zone(ZonedBlockDevice *zbd, ZbdDevice *dev, struct zbd_zone *z,
+                const uint32_t id);
+
+  ZbdDevice *const dev_;
 
   std::mutex zone_del_mtx_;
   const int zone_id_; /* increment from 0 */
   uint64_t start_;
-  uint64_t capacity_; /* remaining capacity */
+  /* Zone state read without io_zones_mtx by allocation and the stats */
+  std::atomic<uint64_t> capacity_; /* remaining capacity */
   uint64_t max_capacity_;
-  uint64_t wp_;
-  bool open_for_write_;
+  std::atomic<uint64_t> wp_;
+  /* Claimed with Acquire() by writers, zone cleaning and the sweep */
+  std::atomic<bool> open_for_write_;
+  /* Set aside for zone cleaning, see ZonedBlockDevice::reserved_zones */
+  std::atomic<bool> reserved_{false};
+  /* Holds no file data but was not reset yet, accounted as empty and left
+   * alone by allocation until the sweep resets it */
+  std::atomic<bool> stale_{false};
   std::atomic<bool> is_append; /*hold when append*/
   Env::WriteLifeTimeHint lifetime_;
 /* weighted average is used only when Allocated for ZC 
@@ -147,13 +406,69 @@ class Zone {
  * (Corner Case) : All zone has no invalid data but cannot allocate since rough lifetime estimation*/
   double secondary_lifetime_;
   std::atomic<long> used_capacity_;
+  /* Block aligned length of valid and invalidated extents in extent_info_ */
+  std::atomic<uint64_t> valid_bytes_;
+  std::atomic<uint64_t> invalid_bytes_;
+  time_t last_write_time_; /* when the last extent was added */
+  bool wal_zone_; /* handed out by AllocateWALZone(), counted as a WAL zone */
+  /* Levels written since the last reset, bit 31 for files without a level */
+  std::atomic<uint32_t> level_mask_;
+  /* FIFO time bucket owning the zone since the last reset, 0 if none. Such
+   * zones are only written by files of that bucket */
+  std::atomic<uint64_t> time_bucket_;
+  /* Average predicted death time of the data written since the last reset,
+   * weighted by the bytes of files with a prediction, 0 if none has one */
+  uint64_t predicted_death_;
+  uint64_t predicted_bytes_;
+  /* Device reads of the zone, halved now and then to follow the workload */
+  std::atomic<uint64_t> read_heat_{0};
+  /* Bumped on reset, so read cache entries of the old data go stale */
+  std::atomic<uint32_t> reset_seq_{0};
+  /* Counted in dev_->active_zones_ from the first allocation after a reset
+   * until the zone is full, finished or reset */
+  bool active_;
+  void SetActive(bool active);
   std::mutex zone_df_lock_;
 
+  /* Claims the zone, false if a writer, zone cleaning or the sweep has it */
+  bool Acquire() {
+    bool expected = false;
+    if (!open_for_write_.compare_exchange_strong(expected, true)) return false;
+    Account();
+    return true;
+  }
+  void Release() {
+    open_for_write_ = false;
+    Account();
+  }
+
+  /* Moves the share of the zone in the device space accounts to its current
+   * state and counters. Called after they change, the accounts are exact
+   * once the last caller returned. Only io zones are accounted */
+  void Account();
+  bool accounted_ = false; /* set once the zone is an io zone */
+  std::mutex account_mtx_;
+  ZoneSpace space_; /* protected by account_mtx_ */
+
   IOStatus Reset();
   IOStatus Finish();
   IOStatus Close();
+  /* Zone state updates once the device reset or finished the zone, z is
+   * the zone as reported after the reset */
+  void ResetDone(const struct zbd_zone *z);
+  void FinishDone();
+  /* Reads the write pointer back from the device, for zones written by
+   * another process, see ZenFS::TailMetadata() */
+  IOStatus UpdateWp();
 
   IOStatus Append(char *data, uint32_t size);
+  /* Gathering append, used to write staged chunks without copying them */
+  IOStatus Append(const struct iovec *iov, int iovcnt);
+#if defined(ROCKSDB_IOURING_PRESENT)
+  /* Keeps up to ZENFS_APPEND_QUEUE_DEPTH chunked writes in flight */
+  IOStatus AsyncAppend(const struct iovec *iov, int iovcnt,
+                       struct io_uring *iu);
+#endif
   bool IsUsed();
   bool IsFull();
   bool IsEmpty();
@@ -162,52 +477,294 @@ class Zone {
   //list of extents lives in here.
   std::vector<ZoneExtentInfo *> extent_info_;
   void CloseWR(); /* Done writing */
+  /* O(1) through ZoneExtent::info_ */
   void Invalidate(ZoneExtent* extent);
  
-  void PushExtentInfo(ZoneExtentInfo* extent_info) { 
-    extent_info_.push_back(extent_info);
-  };
+  void PushExtentInfo(ZoneExtentInfo* extent_info);
+  /* The extent of extent_info grew by length bytes */
+  void GrowExtentInfo(ZoneExtentInfo* extent_info, uint32_t length);
 
   void UpdateSecondaryLifeTime(Env::WriteLifeTimeHint lt, uint64_t length);
 };
 
+template <typename Pred>
+Zone *ZoneBucket::Pop(Pred pred) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  while (!zones_.empty()) {
+    Zone *z = zones_.back();
+    zones_.pop_back();
+    member_[z->zone_id_] = false;
+    if (pred(z)) return z;
+  }
+  return nullptr;
+}
+
 class ZonedBlockDevice {
  private:
   std::priority_queue<GCVictimZone *, std::vector<GCVictimZone *>, InvalComp > gc_queue_;
-  std::priority_queue<AllocVictimZone *, std::vector<AllocVictimZone *>, InvalValComp > allocate_queue_;
+  /* Io zones which may need a reset or finish, handled by the sweep worker
+   * or on zone allocation when it is not running */
+  ZoneBucket sweep_zones_;
+  std::vector<Zone *> sweep_batch_;
   std::string filename_;
   uint32_t block_sz_;
   uint32_t zone_sz_;
   uint32_t nr_zones_;
+  /* All data zones, fixed after Open() so allocation and the stats walk it
+   * without a lock. Zones are claimed through Zone::Acquire() */
   std::vector<Zone *> io_zones;
-  std::mutex io_zones_mtx;
+  /* Serializes the sweep, the WAL ring refill and zone cleaning victim
+   * picks, zone allocation does not take it */
+  ProfiledStdMutex io_zones_mtx{"ZonedBlockDevice::io_zones_mtx"};
 
   bool tracker_exit;
   std::vector<Zone *> meta_zones;
-  std::vector<Zone *> reserved_zones; // reserved for a Zone Cleaning
-  int read_f_;
-  int read_direct_f_;
-  int write_f_;
+  /* Data zones (io and reserved) by zone number, NULL for meta zones */
+  std::vector<Zone *> zone_map_;
+  /* Io zones reserved for a Zone Cleaning, flagged with Zone::reserved_ */
+  std::vector<Zone *> reserved_zones;
+  std::mutex reserved_zones_mtx_; /* Protects reserved_zones and the flags */
+  /* Size of reserved_zones, set from the active zone limit at Open() */
+  unsigned int nr_reserved_zones_ = 0;
+  /* The reserved zones zone cleaning appends to, by GCDestClass(), guarded
+   * by reserved_zones_mtx_. Unreserving a zone drops it from here. */
+  std::map<int, Zone *> gc_dest_zones_;
+  /* reserved_zones_mtx_ should be locked before the function is called */
+  void SetReservedZone(Zone *z, bool reserved);
+  /* Level group and lifetime class of a file, data of different classes
+   * goes to different zones when zone cleaning moves it */
+  int GCDestClass(ZoneFile *zone_file);
+  /* The zone cleaning destination holding data of files next to
+   * zone_file in the key space, by the CAZA overlap index, if any */
+  Zone *GCDestWithAdjacentFile(ZoneFile *zone_file);
+  /* Devices in address order, the meta zones live on the first one */
+  std::vector<std::unique_ptr<ZbdDevice>> devs_;
+  /* round robin start for empty zone allocation */
+  std::atomic<uint32_t> next_dev_{0};
   time_t start_time_;
   std::shared_ptr<Logger> logger_;
   uint32_t finish_threshold_ = 0;
+  uint64_t streaming_buffer_sz_ = 0;
+  uint32_t gc_policy_ = kGCGreedy;
+  uint32_t stripe_width_ = 1; /* open zones per SST writer */
+  bool wal_data_sync_ = false;
 
   std::atomic<long> active_io_zones_;
   std::atomic<long> open_io_zones_;
-  std::condition_variable zone_resources_;
   std::mutex zone_resources_mtx_; /* Protects active/open io zones */
+  /* Writer queued for an open io zone slot, woken once granted one */
+  struct AdmissionWaiter {
+    std::condition_variable cv_;
+    std::chrono::steady_clock::time_point since_;
+    bool granted_ = false;
+  };
+  /* FIFO per class, protected by zone_resources_mtx_ */
+  std::deque<AdmissionWaiter *> admission_queues_[kNumZoneAdmissions];
+  std::atomic<uint64_t> admission_waits_[kNumZoneAdmissions];
+  std::atomic<uint64_t> admission_wait_micros_[kNumZoneAdmissions];
+
+  /* Device I/Os in flight and queued by class, see BeginIO(). Foreground
+   * I/Os only touch the atomics, the others wait on io_sched_cv_ with
+   * io_sched_mtx_ held */
+  std::mutex io_sched_mtx_;
+  std::condition_variable io_sched_cv_;
+  std::atomic<uint32_t> io_in_flight_[kNumIOClasses];
+  std::atomic<uint32_t> io_queued_[kNumIOClasses];
+  std::atomic<uint64_t> io_waits_[kNumIOClasses];
+  /* Takes an open io zone slot for an allocation, false if none is left
+   * and may_wait is not set. Writers that find no free slot queue by
+   * admission class */
+  bool ReserveOpenZone(bool may_wait, ZoneAdmission admission = kAdmitFlush);
+  void ReleaseOpenZone();
+  /* Hands free slots to queued writers, the lowest class first unless a
+   * writer waited longer than ZENFS_ADMISSION_STARVATION_MS.
+   * zone_resources_mtx_ should be locked before the function is called */
+  void GrantOpenZones();
 
   unsigned int max_nr_active_io_zones_;
   unsigned int max_nr_open_io_zones_;
   ZenFS* fs;
 
+  /* Empty zones set aside for WAL files, refilled in the background so WAL
+   * writers do not contend with SST allocation */
+  std::deque<Zone *> wal_ring_;
+  std::mutex wal_ring_mtx_;
+  unsigned int wal_open_zones_ = 0;        /* protected by wal_ring_mtx_ */
+  unsigned int max_nr_open_wal_zones_ = 0; /* taken off the io zone limit */
+  void RefillWALRingLocked();
+
+  /* Zone the sealed partial blocks of WALs with data sync are written to,
+   * shared by all of them. A tail zone stays claimed while it holds the
+   * tail of a file not appended to since */
+  Zone *wal_tail_zone_ = nullptr;
+  std::map<Zone *, uint32_t> wal_tail_refs_;
+  std::mutex wal_tail_mtx_; /* Protects the two above */
+
+#if defined(ROCKSDB_IOURING_PRESENT)
+  /* io_uring instances used by writers for asynchronous zone appends */
+  std::unique_ptr<ThreadLocalPtr> thread_local_io_urings_;
+#endif
+  /* Staging chunks and file write buffers, see AlignedChunkPool */
+  std::shared_ptr<AlignedChunkPool> buffer_pool_;
+  ExtentInfoPool extent_info_pool_;
+
+  /* Background zone cleaning */
+  std::unique_ptr<std::thread> gc_worker_;
+  std::mutex gc_worker_mtx_;
+  std::condition_variable gc_worker_cv_;
+  bool gc_worker_exit_;
+  std::atomic<uint64_t> gc_copied_bytes_;
+
+  /* Background zone resets and finishes, see SweepIOZones() */
+  std::unique_ptr<std::thread> sweep_worker_;
+  std::mutex sweep_worker_mtx_;
+  std::condition_variable sweep_worker_cv_;
+  std::condition_variable sweep_done_cv_;
+  bool sweep_worker_exit_ = false;
+  uint64_t sweep_requested_ = 0; /* protected by sweep_worker_mtx_ */
+  uint64_t sweep_done_ = 0;      /* protected by sweep_worker_mtx_ */
+
+  /* Space of the io zones by ZoneSpaceState, maintained by Zone::Account()
+   * so the space counters and properties are read without a zone scan */
+  std::atomic<int64_t> space_zones_[kNumZoneSpaceStates];
+  std::atomic<int64_t> space_free_[kNumZoneSpaceStates];
+  std::atomic<int64_t> space_valid_[kNumZoneSpaceStates];
+  std::atomic<int64_t> space_invalid_[kNumZoneSpaceStates];
+  /* Extents appended, the average extent size drives zone finishing */
+  std::atomic<uint64_t> extents_appended_{0};
+  std::atomic<uint64_t> extent_bytes_appended_{0};
+  /* Whether the sweep should finish the partially written zone z */
+  bool ShouldFinish(Zone *z);
+
+  /* Exported through Statistics and the rocksdb.zenfs.* properties */
+  std::shared_ptr<Statistics> stats_;
+  /* The DB's rate limiter, also charged with zone cleaning copies and meta
+   * log appends. Set with std::atomic_store, read with std::atomic_load */
+  std::shared_ptr<RateLimiter> rate_limiter_;
+  std::atomic<uint64_t> gc_extents_migrated_{0};
+  std::atomic<uint64_t> zone_resets_{0};
+  std::atomic<uint64_t> zone_finishes_{0};
+  std::atomic<uint64_t> meta_log_bytes_{0};
+  /* Bytes appended to the io zones, zone cleaning copies included */
+  std::atomic<uint64_t> bytes_written_{0};
+  std::atomic<uint64_t> read_cache_hits_{0};
+  std::atomic<uint64_t> read_cache_misses_{0};
+
+  /* DRAM cache of small reads from hot zones, keyed by zone, reset
+   * sequence and device offset, see ReadCacheLookup() */
+  std::shared_ptr<Cache> read_cache_;
+  std::atomic<uint64_t> read_heat_total_{0};
+  std::mutex read_heat_mtx_; /* Held by DecayReadHeat() */
+  void DecayReadHeat();
+  std::atomic<uint64_t> placements_[kNumZonePlacements];
+
+  Zone *AllocateZoneInternal(Env::WriteLifeTimeHint, InternalKey, InternalKey,
+                             int, bool may_wait, uint64_t predicted_death,
+                             ZoneAdmission admission,
+                             ZonePlacement *placement);
+  /* Partially written zone whose data is predicted to die closest to
+   * predicted_death, or else the one with the best lifetime hint diff */
+  Zone *AllocateZoneWithLifetime(Env::WriteLifeTimeHint file_lifetime,
+                                 uint64_t predicted_death,
+                                 ZonePlacement *placement);
+
+  /* Zone stats history, oldest sample first */
+  std::deque<ZoneStatsSample> zone_stats_history_;
+  uint64_t zone_stats_history_size_ = 0; /* estimated bytes */
+  std::mutex zone_stats_mtx_;
+  std::unique_ptr<std::thread> zone_stats_worker_;
+  std::mutex zone_stats_worker_mtx_;
+  std::condition_variable zone_stats_worker_cv_;
+  bool zone_stats_worker_exit_ = false;
+  void ZoneStatsWorker();
+  void SampleZoneStats();
+
+  /* Reused by zone cleaning, grown to the largest read so far */
+  struct GCBuffer {
+    char *data_ = nullptr;
+    uint64_t size_ = 0;
+    struct iovec iov_;
+    bool in_flight_ = false;
+    uint64_t io_start_ = 0; /* of the read in flight, for EndIO() */
+  };
+  /* Valid extents [first_, last_) of a victim, back to back on disk */
+  struct GCRun {
+    uint64_t start_;
+    uint64_t end_;
+    size_t first_;
+    size_t last_;
+  };
+  GCBuffer gc_bufs_[2];
+#if defined(ROCKSDB_IOURING_PRESENT)
+  struct io_uring *gc_io_uring_ = nullptr;
+#endif
+
+  void GCWorker();
+  void SweepWorker();
+  /* Resets or finishes the zones, runs of zones adjacent on a device in one
+   * range command, and appends those that succeeded to done */
+  void ResetZones(std::vector<Zone *> &zones, std::vector<Zone *> *done);
+  void FinishZones(std::vector<Zone *> &zones, std::vector<Zone *> *done);
+  void PickGCVictims(int nr_victims, std::vector<Zone *>& victims);
+  IOStatus StartGCRead(GCBuffer *buf, const GCRun &run);
+  IOStatus FinishGCRead(GCBuffer *buf, const GCRun &run);
+  void WaitGCRead(GCBuffer *buf);
+  /* Extent tables and extents replaced by zone cleaning, freed once no
+   * reader holds the tables any more */
+  struct GCRetired {
+    std::vector<std::weak_ptr<const ZoneExtentTable>> tables_;
+    std::vector<ZoneExtent *> extents_;
+  };
+  IOStatus MigrateExtent(ZoneExtentInfo *ext_info, char *buff,
+                         Zone *cur_victim, GCRetired *retired);
+  /* Waits until the reads still on the retired extent tables are done */
+  void FreeRetired(GCRetired *retired);
+  void MoveSSTZone(ZoneFile *zone_file, int from, int to);
+  double GCScore(Zone *z, time_t now, const std::set<uint64_t>& compacting);
+
  public:
   std::atomic<int> append_cnt;
   int num_zc_cnt;
   int num_reset_cnt;
   DBImpl* db_ptr_;
   void SetDBPointer(DBImpl* db);
+  Statistics *GetStatistics() { return stats_.get(); }
+  /* Admits a device I/O of io_class and returns its start for EndIO().
+   * Foreground I/Os go at once. Others wait while their class has its
+   * ZENFS_IO_DEPTH_* I/Os in flight, and for at most ZENFS_IO_YIELD_US while
+   * I/Os of a lower class are in flight or queued */
+  uint64_t BeginIO(ZoneIOClass io_class);
+  /* Records the latency of the I/O, queueing included, by class */
+  void EndIO(ZoneIOClass io_class, uint64_t start);
+  static ZoneIOClass IOClassFor(const IOOptions &options) {
+    return options.prio == IOPriority::kIOHigh ? kIOForeground
+                                               : kIOCompaction;
+  }
+  /* Blocks until the rate limiter grants bytes of I/O, if there is one */
+  void RequestIO(uint64_t bytes, Env::IOPriority pri,
+                 RateLimiter::OpType op_type);
+  void NotifyZoneReset();
+  void NotifyZoneFinish();
+  void NotifyMetaLogWrite(uint64_t bytes);
+  void NotifyExtentAppended(uint64_t bytes);
+  void NotifyBytesWritten(uint64_t bytes) { bytes_written_ += bytes; }
+  /* Applies the delta between the old and new space of a zone */
+  void MoveSpace(const ZoneSpace &from, const ZoneSpace &to);
+  /* Accounts every io zone again, after recovery rebuilt their counters */
+  void AccountAllZones();
+  /* Space accounted under state, O(1) */
+  uint64_t GetStateFreeSpace(ZoneSpaceState state);
+  uint64_t GetStateValidSpace(ZoneSpaceState state);
+  uint64_t GetStateInvalidSpace(ZoneSpaceState state);
+  /* Free bytes of partially written, closed zones */
+  uint64_t GetStrandedSpace() { return GetStateFreeSpace(kSpacePartial); }
+  /* Fills value for a rocksdb.zenfs.* property, false if it is unknown */
+  bool GetProperty(const std::string &property, std::string *value);
   std::mutex zone_cleaning_mtx;
+  /* Notified whenever an extent table is freed, see FreeRetired() */
+  std::mutex extent_table_mtx_;
+  std::condition_variable extent_table_cv_;
+  void ExtentTableFreed();
   std::vector<ZoneFile *> del_pending;
   std::atomic<bool> zc_in_progress_;
   std::mutex append_mtx_;
@@ -216,11 +773,16 @@ class ZonedBlockDevice {
   std::atomic<unsigned long long> LAST_WR_DATA;
 
   std::map<uint64_t, ZoneFile*> files_;
-  std::mutex files_mtx_;
+  ProfiledStdMutex files_mtx_{"ZonedBlockDevice::files_mtx_"};
   
   std::map<uint64_t, std::vector<int>> sst_to_zone_;
   std::map<int, Zone*> id_to_zone_;
+  SSTRangeIndex sst_index_;
+  LifetimePredictor lifetime_predictor_;
 
+  /* bdevname is a device name under /dev or an "emu:" device, several can
+   * be given separated by ',' to span them. The same devices must be given
+   * in the same order on every mount */
   explicit ZonedBlockDevice(std::string bdevname,
                             std::shared_ptr<Logger> logger);
   virtual ~ZonedBlockDevice();
@@ -228,47 +790,167 @@ class ZonedBlockDevice {
   uint64_t GetUsedSpace();
   uint64_t GetTotalWritten();
   uint64_t GetReclaimableSpace();
+  /* Remaining capacity of the zone an SST of level is expected to be placed
+   * in, a partially written zone holding the level or else an empty zone */
+  uint64_t GetPlacementCapacity(int level, uint64_t *max_capacity);
 
   void printZoneStatus(const std::vector<Zone *>&);
   void SetFsPtr(ZenFS* fss) {fs = fss;}
   IOStatus Open(bool readonly = false);
 
   Zone *GetIOZone(uint64_t offset);
-  void SortZone();
+  bool IsReservedZone(Zone *z) { return z->reserved_.load(); }
+  /* Zone::Acquire() for allocation, which must not get reserved zones */
+  bool ClaimZone(Zone *z);
+  void AddEmptyZone(Zone *z) { z->dev_->empty_zones_.Push(z); }
+  void AddSweepZone(Zone *z) { sweep_zones_.Push(z); }
+  /* The Allocate* helpers return the zone claimed */
+  Zone *AllocateEmptyZone(Env::WriteLifeTimeHint file_lifetime);
+  /* With unlock_for_io io_zones_mtx is released while the zones are reset
+   * and finished */
+  void SweepIOZones(bool unlock_for_io = false);
+  /* Hands the sweep to the worker if it runs, sweeps in place otherwise */
+  void SweepIOZonesOrKick();
+  void RebuildZoneBuckets();
   //void PickZoneWithCompactionVictim(std::vector<Zone*>&);
   void PickZoneWithOnlyInvalid(std::vector<Zone*>&);
   Zone * AllocateMostL0Files(const std::set<int>&);
   Zone * AllocateZoneWithSameLevelFiles(const std::vector<uint64_t>&, const InternalKey, const InternalKey);
+  /* Picks the zone holding the most bytes of the files in the key range */
+  Zone * AllocateZoneWithOverlappingFiles(const std::vector<uint64_t>&,
+                                          const InternalKey&,
+                                          const InternalKey&);
   void SameLevelFileList(const int, std::vector<uint64_t>&);
   void AdjacentFileList(const InternalKey&, const InternalKey&, const int, std::vector<uint64_t>&);
-  void AllFile(const InternalKey &s, const InternalKey &l,std::vector<uint64_t> &fno_list);
-  uint64_t hexToUint64(const std::string &hex);
-  uint64_t HexString(ParsedInternalKey *result);
-  Zone *AllocateZone(Env::WriteLifeTimeHint, InternalKey, InternalKey, int);
-  Zone *AllocateZoneForCleaning();
+  void AddSSTRange(uint64_t fno, int level, const InternalKey &smallest,
+                   const InternalKey &largest);
+  void RemoveSSTRange(uint64_t fno) { sst_index_.Remove(fno); }
+  bool LoadSSTComparator();
+  /* Rebuilds the placement state of a file recovered from the metadata log */
+  void RegisterSST(ZoneFile *zone_file);
+  /* Returns nullptr instead of waiting for the open zone limit or cleaning
+   * when may_wait is false */
+  Zone *AllocateZone(Env::WriteLifeTimeHint, InternalKey, InternalKey, int,
+                     bool may_wait = true, uint64_t predicted_death = 0,
+                     ZoneAdmission admission = kAdmitFlush);
+  /* Admission class of a file written at level, 100 for no level */
+  static ZoneAdmission AdmissionForLevel(int level);
+  /* Predicted lifetime in seconds of an SST of level with the key range,
+   * 0 if unknown */
+  uint64_t PredictSSTLifetime(int level, const InternalKey &smallest,
+                              const InternalKey &largest);
+  /* Feeds the lifetime of an SST being deleted to the predictor */
+  void ObserveSSTDeath(ZoneFile *zone_file);
+  Zone *AllocateZoneForCleaning(ZoneFile *zone_file);
+  Zone *AllocateWALZone(Env::WriteLifeTimeHint file_lifetime);
+  /* Zone of a FIFO time bucket, an empty zone is claimed for the bucket when
+   * none of its zones has capacity left */
+  Zone *AllocateBucketZone(uint64_t bucket,
+                           Env::WriteLifeTimeHint file_lifetime,
+                           bool may_wait = true,
+                           ZoneAdmission admission = kAdmitFlush);
+  void RefillWALRing();
+  void NotifyWALZoneClosed();
+  /* Writes the size bytes at data, a sealed WAL tail, to the WAL tail zone
+   * and sets *zone and *start to where. The tail holds on to the zone until
+   * passed to ReleaseWALTail() */
+  IOStatus AppendWALTail(char *data, uint32_t size, Zone **zone,
+                         uint64_t *start);
+  void ReleaseWALTail(Zone *zone);
   Zone *AllocateMetaZone();
 
   std::string GetFilename();
   uint32_t GetBlockSize();
 
   void ResetUnusedIOZones();
+  /* Marks unused io zones stale and queues them for the sweep, which resets
+   * them in range commands in the background */
+  void DeferResetUnusedIOZones();
   void LogZoneStats();
   void LogZoneUsage();
   
-  int GetReadFD() { return read_f_; }
-  int GetReadDirectFD() { return read_direct_f_; }
-  int GetWriteFD() { return write_f_; }
-
+#if defined(ROCKSDB_IOURING_PRESENT)
+  struct io_uring *GetThreadLocalIOUring();
+#endif
+
+  AlignedChunkPool *GetBufferPool() { return buffer_pool_.get(); }
+  /* Budget of the buffer pool shared with the other devices of the process,
+   * 0 restores the default */
+  void SetBufferPoolSize(uint64_t sz);
+  ExtentInfoPool *GetExtentInfoPool() { return &extent_info_pool_; }
+
+  /* Device holding addr */
+  ZbdDevice *GetDevice(uint64_t addr) {
+    for (size_t i = devs_.size() - 1; i > 0; i--)
+      if (addr >= devs_[i]->base_) return devs_[i].get();
+    return devs_[0].get();
+  }
+  const std::vector<std::unique_ptr<ZbdDevice>> &GetDevices() { return devs_; }
+
+  const std::vector<Zone *> &GetIOZones() { return io_zones; }
   uint32_t GetZoneSize() { return zone_sz_; }
   uint32_t GetNrZones() { return nr_zones_; }
   std::vector<Zone *> GetMetaZones() { return meta_zones; }
 
   void SetFinishTreshold(uint32_t threshold) { finish_threshold_ = threshold; }
+  /* Max staged bytes of an SST with a placement hint, 0 disables streaming */
+  void SetStreamingBufferSize(uint64_t sz) { streaming_buffer_sz_ = sz; }
+  uint64_t GetStreamingBufferSize() { return streaming_buffer_sz_; }
+  void SetGCPolicy(uint32_t policy) { gc_policy_ = policy; }
+  void SetStripeWidth(uint32_t width);
+  uint32_t GetStripeWidth() { return stripe_width_; }
+  /* WAL syncs write data only, see ZonedWritableFile::DataSync() */
+  void SetWALDataSync(bool on) { wal_data_sync_ = on; }
+  bool GetWALDataSync() { return wal_data_sync_; }
+  /* 0 disables the read cache */
+  void SetReadCacheSize(uint64_t sz);
+  /* Copies a cached read of n bytes at addr into dst and returns true, or
+   * returns false and the sequence to pass to ReadCacheInsert() */
+  bool ReadCacheLookup(uint64_t addr, size_t n, char *dst, uint32_t *seq);
+  /* Offers a completed device read, kept if its zone is hot enough */
+  void ReadCacheInsert(uint64_t addr, const char *data, size_t n,
+                       uint32_t seq);
+  /* Writes iovs[i] at the write pointer of zones[i], the zones must differ */
+  IOStatus AppendStripes(const std::vector<Zone *> &zones,
+                         const std::vector<struct iovec> &iovs);
 
   void NotifyIOZoneFull();
   void NotifyIOZoneClosed();
 
-  int ZoneCleaning(int);
+  /* Returns the number of zones cleaned. Copies are charged to the rate
+   * limiter at io_pri, IO_HIGH when a writer waits for the cleaning */
+  int ZoneCleaning(int, Env::IOPriority io_pri = Env::IO_LOW);
+  double GetFreeRatio();
+  void StartGCWorker();
+  void StopGCWorker();
+  void KickGCWorker();
+  void StartSweepWorker();
+  void StopSweepWorker();
+  void KickSweepWorker();
+  /* Returns once the zones queued for a sweep so far were swept, must be
+   * called without io_zones_mtx held */
+  void WaitSweep();
+  void StartZoneStatsWorker();
+  void StopZoneStatsWorker();
+  /* Appends the samples taken in [start_time, end_time) */
+  void GetZoneStatsHistory(uint64_t start_time, uint64_t end_time,
+                           std::vector<ZoneStatsSample> *samples);
+};
+
+/* A device I/O admitted by ZonedBlockDevice::BeginIO() until destroyed */
+class ZoneIOScope {
+ public:
+  ZoneIOScope(ZonedBlockDevice *zbd, ZoneIOClass io_class)
+      : zbd_(zbd), io_class_(io_class), start_(zbd->BeginIO(io_class)) {}
+  ~ZoneIOScope() { zbd_->EndIO(io_class_, start_); }
+
+  ZoneIOScope(const ZoneIOScope &) = delete;
+  ZoneIOScope &operator=(const ZoneIOScope &) = delete;
+
+ private:
+  ZonedBlockDevice *zbd_;
+  ZoneIOClass io_class_;
+  uint64_t start_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
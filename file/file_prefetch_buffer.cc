@@ -21,6 +21,11 @@
 #include "util/rate_limiter.h"
 
 namespace ROCKSDB_NAMESPACE {
+FilePrefetchBuffer::~FilePrefetchBuffer() {
+  // The background read must not outlive async_buffer_
+  PollAsyncRead();
+}
+
 Status FilePrefetchBuffer::Prefetch(const IOOptions& opts,
                                     RandomAccessFileReader* reader,
                                     uint64_t offset, size_t n,
@@ -107,6 +112,14 @@ Status FilePrefetchBuffer::Prefetch(const IOOptions& opts,
   return s;
 }
 
+void FilePrefetchBuffer::Fill(uint64_t offset, const Slice& data) {
+  PollAsyncRead();
+  buffer_.Alignment(1);
+  buffer_.AllocateNewBuffer(data.size());
+  buffer_.Append(data.data(), data.size());
+  buffer_offset_ = offset;
+}
+
 bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
                                           uint64_t offset, size_t n,
                                           Slice* result, bool for_compaction) {
@@ -126,7 +139,9 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
       assert(file_reader_ != nullptr);
       assert(max_readahead_size_ >= readahead_size_);
       Status s;
-      if (for_compaction) {
+      if (async_io_) {
+        s = PrefetchFromAsyncBuffer(opts, offset, n, for_compaction);
+      } else if (for_compaction) {
         s = Prefetch(opts, file_reader_, offset, std::max(n, readahead_size_),
                      for_compaction);
       } else {
@@ -139,7 +154,10 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
 #endif
         return false;
       }
-      readahead_size_ = std::min(max_readahead_size_, readahead_size_ * 2);
+      if (!async_io_) {
+        // With async_io, the readahead size grows with the background reads
+        readahead_size_ = std::min(max_readahead_size_, readahead_size_ * 2);
+      }
     } else {
       return false;
     }
@@ -147,6 +165,117 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
 
   uint64_t offset_in_buffer = offset - buffer_offset_;
   *result = Slice(buffer_.BufferStart() + offset_in_buffer, n);
+  if (async_io_ && readahead_size_ > 0) {
+    ScheduleAsyncRead(opts);
+  }
   return true;
 }
+
+Status FilePrefetchBuffer::PrefetchFromAsyncBuffer(const IOOptions& opts,
+                                                   uint64_t offset, size_t n,
+                                                   bool for_compaction) {
+  PollAsyncRead();
+  uint64_t async_buffer_end =
+      async_buffer_offset_ + async_buffer_.CurrentSize();
+  if (async_buffer_.CurrentSize() > 0 && offset + n <= async_buffer_end) {
+    if (offset >= async_buffer_offset_) {
+      // All requested bytes were read in the background
+      std::swap(buffer_, async_buffer_);
+      std::swap(buffer_offset_, async_buffer_offset_);
+      return Status::OK();
+    }
+    uint64_t buffer_end = buffer_offset_ + buffer_.CurrentSize();
+    if (offset >= buffer_offset_ && offset < buffer_end &&
+        buffer_end == async_buffer_offset_) {
+      // The requested bytes start in buffer_ and end in async_buffer_. Keep
+      // the tail of buffer_ from offset and append async_buffer_ to it.
+      size_t chunk_offset_in_buffer = Rounddown(
+          static_cast<size_t>(offset - buffer_offset_), buffer_.Alignment());
+      size_t chunk_len = buffer_.CurrentSize() - chunk_offset_in_buffer;
+      size_t new_size = chunk_len + async_buffer_.CurrentSize();
+      if (buffer_.Capacity() < new_size) {
+        buffer_.AllocateNewBuffer(new_size, true /* copy_data */,
+                                  chunk_offset_in_buffer, chunk_len);
+      } else {
+        buffer_.RefitTail(chunk_offset_in_buffer, chunk_len);
+      }
+      buffer_.Append(async_buffer_.BufferStart(), async_buffer_.CurrentSize());
+      buffer_offset_ += chunk_offset_in_buffer;
+      async_buffer_.Size(0);
+      return Status::OK();
+    }
+  }
+  return Prefetch(opts, file_reader_, offset, n + readahead_size_,
+                  for_compaction);
+}
+
+void FilePrefetchBuffer::ScheduleAsyncRead(const IOOptions& opts) {
+  uint64_t offset = buffer_offset_ + buffer_.CurrentSize();
+  if (async_read_in_progress_ || offset == async_buffer_offset_) {
+    return;
+  }
+  size_t alignment = file_reader_->file()->GetRequiredBufferAlignment();
+  if (buffer_.CurrentSize() == 0 || offset % alignment != 0) {
+    // Only a read reaching the end of the file leaves buffer_ unaligned
+    return;
+  }
+  TEST_SYNC_POINT("FilePrefetchBuffer::ScheduleAsyncRead:Start");
+
+  size_t read_len = Roundup(readahead_size_, alignment);
+  async_buffer_.Alignment(alignment);
+  if (async_buffer_.Capacity() < read_len) {
+    async_buffer_.AllocateNewBuffer(read_len);
+  }
+  async_buffer_.Size(0);
+  async_buffer_offset_ = offset;
+
+  FSReadRequest req;
+  req.offset = offset;
+  req.len = read_len;
+  req.scratch = async_buffer_.BufferStart();
+  async_read_in_progress_ = true;
+  IOStatus s = file_reader_->ReadAsync(
+      req, opts,
+      [this](const FSReadRequest& read_req, void* /*cb_arg*/) {
+        PrefetchAsyncCallback(read_req);
+      },
+      nullptr, &io_handle_, &del_fn_);
+  if (!s.ok()) {
+    // The bytes will be read synchronously when needed
+    async_read_in_progress_ = false;
+    return;
+  }
+  readahead_size_ = std::min(max_readahead_size_, readahead_size_ * 2);
+}
+
+void FilePrefetchBuffer::PollAsyncRead() {
+  if (!async_read_in_progress_) {
+    return;
+  }
+  if (io_handle_ != nullptr) {
+    std::vector<void*> io_handles{io_handle_};
+    IOStatus s = fs_->Poll(io_handles, 1);
+    if (s.ok()) {
+      del_fn_(io_handle_);
+    } else {
+      // The read may still complete, so neither its handle nor its buffer
+      // can be released.
+      async_buffer_.Release();
+      async_io_ = false;
+    }
+    io_handle_ = nullptr;
+  }
+  async_read_in_progress_ = false;
+}
+
+void FilePrefetchBuffer::PrefetchAsyncCallback(const FSReadRequest& req) {
+  if (!req.status.ok()) {
+    async_buffer_.Size(0);
+    return;
+  }
+  if (req.result.data() != req.scratch) {
+    memcpy(async_buffer_.BufferStart(), req.result.data(), req.result.size());
+  }
+  async_buffer_.Size(req.result.size());
+}
 }  // namespace ROCKSDB_NAMESPACE
@@ -15,6 +15,7 @@
 #include "file/random_access_file_reader.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
+#include "rocksdb/file_system.h"
 #include "rocksdb/options.h"
 #include "util/aligned_buffer.h"
 
@@ -38,6 +39,11 @@ class FilePrefetchBuffer {
   //   for the minimum offset if track_min_offset = true.
   // track_min_offset : Track the minimum offset ever read and collect stats on
   //   it. Used for adaptable readahead of the file footer/metadata.
+  // async_io : with readahead, read the readahead_size bytes following the
+  //   buffer in the background with ReadAsync(), into a second buffer, while
+  //   the data in the buffer is being consumed.
+  // fs : the file system of file_reader, which waits for the background
+  //   reads. Required with async_io.
   //
   // Automatic readhead is enabled for a file if file_reader, readahead_size,
   // and max_readahead_size are passed in.
@@ -47,14 +53,26 @@ class FilePrefetchBuffer {
   // `Prefetch` to load data into the buffer.
   FilePrefetchBuffer(RandomAccessFileReader* file_reader = nullptr,
                      size_t readadhead_size = 0, size_t max_readahead_size = 0,
-                     bool enable = true, bool track_min_offset = false)
+                     bool enable = true, bool track_min_offset = false,
+                     bool async_io = false, FileSystem* fs = nullptr)
       : buffer_offset_(0),
         file_reader_(file_reader),
         readahead_size_(readadhead_size),
         max_readahead_size_(max_readahead_size),
         min_offset_read_(port::kMaxSizet),
         enable_(enable),
-        track_min_offset_(track_min_offset) {}
+        track_min_offset_(track_min_offset),
+        async_io_(async_io && file_reader != nullptr && fs != nullptr),
+        fs_(fs),
+        async_buffer_offset_(port::kMaxUint64),
+        async_read_in_progress_(false),
+        io_handle_(nullptr) {}
+
+  ~FilePrefetchBuffer();
+
+  // No copying allowed, a background read may refer to this object
+  FilePrefetchBuffer(const FilePrefetchBuffer&) = delete;
+  FilePrefetchBuffer& operator=(const FilePrefetchBuffer&) = delete;
 
   // Load data into the buffer from a file.
   // reader : the file reader.
@@ -64,6 +82,11 @@ class FilePrefetchBuffer {
   Status Prefetch(const IOOptions& opts, RandomAccessFileReader* reader,
                   uint64_t offset, size_t n, bool for_compaction = false);
 
+  // Load data into the buffer from memory, replacing what it holds.
+  // offset : the file offset of data.
+  // data   : the bytes of the file at offset.
+  void Fill(uint64_t offset, const Slice& data);
+
   // Tries returning the data for a file raed from this buffer, if that data is
   // in the buffer.
   // It handles tracking the minimum read offset if track_min_offset = true.
@@ -82,6 +105,17 @@ class FilePrefetchBuffer {
   size_t min_offset_read() const { return min_offset_read_; }
 
  private:
+  // With async_io, makes buffer_ hold [offset, offset + n), using the data
+  // read in the background when it has the requested bytes.
+  Status PrefetchFromAsyncBuffer(const IOOptions& opts, uint64_t offset,
+                                 size_t n, bool for_compaction);
+  // Starts reading the bytes following buffer_ into async_buffer_, unless
+  // they are already there or being read.
+  void ScheduleAsyncRead(const IOOptions& opts);
+  // Waits for the background read, if any.
+  void PollAsyncRead();
+  void PrefetchAsyncCallback(const FSReadRequest& req);
+
   AlignedBuffer buffer_;
   uint64_t buffer_offset_;
   RandomAccessFileReader* file_reader_;
@@ -95,5 +129,15 @@ class FilePrefetchBuffer {
   // If true, track minimum `offset` ever passed to TryReadFromCache(), which
   // can be fetched from min_offset_read().
   bool track_min_offset_;
+
+  bool async_io_;
+  FileSystem* fs_;
+  // Holds the bytes read in the background, starting at async_buffer_offset_
+  AlignedBuffer async_buffer_;
+  uint64_t async_buffer_offset_;
+  bool async_read_in_progress_;
+  // Handle of the background read when it did not complete in ReadAsync()
+  void* io_handle_;
+  IOHandleDeleter del_fn_;
 };
 }  // namespace ROCKSDB_NAMESPACE
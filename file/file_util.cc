@@ -13,6 +13,7 @@
 #include "file/sst_file_manager_impl.h"
 #include "file/writable_file_writer.h"
 #include "rocksdb/env.h"
+#include "rocksdb/rate_limiter.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -237,4 +238,76 @@ Status DestroyDir(Env* env, const std::string& dir) {
   return s;
 }
 
+namespace {
+class ReadRateLimitedRandomAccessFile : public FSRandomAccessFileWrapper {
+ public:
+  ReadRateLimitedRandomAccessFile(std::unique_ptr<FSRandomAccessFile>&& file,
+                                  RateLimiter* rate_limiter)
+      : FSRandomAccessFileWrapper(file.get()),
+        file_(std::move(file)),
+        rate_limiter_(rate_limiter) {}
+
+  IOStatus Read(uint64_t offset, size_t n, const IOOptions& options,
+                Slice* result, char* scratch,
+                IODebugContext* dbg) const override {
+    RequestTokens(n);
+    return target()->Read(offset, n, options, result, scratch, dbg);
+  }
+
+  IOStatus MultiRead(FSReadRequest* reqs, size_t num_reqs,
+                     const IOOptions& options, IODebugContext* dbg) override {
+    size_t bytes = 0;
+    for (size_t i = 0; i < num_reqs; i++) {
+      bytes += reqs[i].len;
+    }
+    RequestTokens(bytes);
+    return target()->MultiRead(reqs, num_reqs, options, dbg);
+  }
+
+ private:
+  void RequestTokens(size_t bytes) const {
+    const size_t burst = static_cast<size_t>(
+        std::max<int64_t>(rate_limiter_->GetSingleBurstBytes(), 1));
+    while (bytes > 0) {
+      size_t chunk = std::min(bytes, burst);
+      rate_limiter_->Request(static_cast<int64_t>(chunk), Env::IO_LOW,
+                             nullptr /* stats */, RateLimiter::OpType::kRead);
+      bytes -= chunk;
+    }
+  }
+
+  std::unique_ptr<FSRandomAccessFile> file_;
+  RateLimiter* rate_limiter_;
+};
+
+class ReadRateLimitedFileSystem : public FileSystemWrapper {
+ public:
+  ReadRateLimitedFileSystem(const std::shared_ptr<FileSystem>& base,
+                            const std::shared_ptr<RateLimiter>& rate_limiter)
+      : FileSystemWrapper(base), rate_limiter_(rate_limiter) {}
+
+  IOStatus NewRandomAccessFile(const std::string& fname,
+                               const FileOptions& file_opts,
+                               std::unique_ptr<FSRandomAccessFile>* result,
+                               IODebugContext* dbg) override {
+    std::unique_ptr<FSRandomAccessFile> file;
+    IOStatus s = target()->NewRandomAccessFile(fname, file_opts, &file, dbg);
+    if (s.ok()) {
+      result->reset(new ReadRateLimitedRandomAccessFile(std::move(file),
+                                                        rate_limiter_.get()));
+    }
+    return s;
+  }
+
+ private:
+  std::shared_ptr<RateLimiter> rate_limiter_;
+};
+}  // namespace
+
+std::shared_ptr<FileSystem> NewReadRateLimitedFileSystem(
+    const std::shared_ptr<FileSystem>& base,
+    const std::shared_ptr<RateLimiter>& rate_limiter) {
+  return std::make_shared<ReadRateLimitedFileSystem>(base, rate_limiter);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
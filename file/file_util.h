@@ -40,6 +40,14 @@ extern IOStatus GenerateOneFileChecksum(
     size_t verify_checksums_readahead_size, bool allow_mmap_reads,
     std::shared_ptr<IOTracer>& io_tracer);
 
+// Returns a file system whose random access files take tokens of
+// rate_limiter, with IO_LOW priority, before each read, to bound the reads
+// of scans over whole files such as checksum verification. Only limits if
+// rate_limiter limits reads, see RateLimiter::Mode.
+extern std::shared_ptr<FileSystem> NewReadRateLimitedFileSystem(
+    const std::shared_ptr<FileSystem>& base,
+    const std::shared_ptr<RateLimiter>& rate_limiter);
+
 inline IOStatus PrepareIOFromReadOptions(const ReadOptions& ro, Env* env,
                                          IOOptions& opts) {
   if (!env) {
@@ -240,10 +240,20 @@ std::string IdentityFileName(const std::string& dbname) {
   return dbname + "/IDENTITY";
 }
 
+std::string TableMetadataFileName(const std::string& dbname) {
+  return dbname + "/TABLE_METADATA";
+}
+
+std::string BlockCacheWarmupFileName(const std::string& dbname) {
+  return dbname + "/BLOCK_CACHE_WARMUP";
+}
+
 // Owned filenames have the form:
 //    dbname/IDENTITY
 //    dbname/CURRENT
 //    dbname/LOCK
+//    dbname/TABLE_METADATA
+//    dbname/BLOCK_CACHE_WARMUP
 //    dbname/<info_log_name_prefix>
 //    dbname/<info_log_name_prefix>.old.[0-9]+
 //    dbname/MANIFEST-[0-9]+
@@ -272,6 +282,12 @@ bool ParseFileName(const std::string& fname, uint64_t* number,
   } else if (rest == "CURRENT") {
     *number = 0;
     *type = kCurrentFile;
+  } else if (rest == "TABLE_METADATA") {
+    *number = 0;
+    *type = kTableMetadataFile;
+  } else if (rest == "BLOCK_CACHE_WARMUP") {
+    *number = 0;
+    *type = kBlockCacheWarmupFile;
   } else if (rest == "LOCK") {
     *number = 0;
     *type = kDBLockFile;
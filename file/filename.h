@@ -144,6 +144,13 @@ extern std::string MetaDatabaseName(const std::string& dbname,
 // either from a backup-image or empty
 extern std::string IdentityFileName(const std::string& dbname);
 
+// Return the name of the file of the table metadata saved at DB close
+extern std::string TableMetadataFileName(const std::string& dbname);
+
+// Return the name of the file of the data blocks to warm the block cache up
+// with at DB open
+extern std::string BlockCacheWarmupFileName(const std::string& dbname);
+
 // If filename is a rocksdb file, store the type of the file in *type.
 // The number encoded in the filename is stored in *number.  If the
 // filename was successfully parsed, returns true.  Else return false.
@@ -13,11 +13,13 @@ class MockFS;
 class MockRandomAccessFile : public FSRandomAccessFileWrapper {
  public:
   MockRandomAccessFile(std::unique_ptr<FSRandomAccessFile>& file,
-                       bool support_prefetch, std::atomic_int& prefetch_count)
+                       bool support_prefetch, std::atomic_int& prefetch_count,
+                       std::atomic_int& read_async_count)
       : FSRandomAccessFileWrapper(file.get()),
         file_(std::move(file)),
         support_prefetch_(support_prefetch),
-        prefetch_count_(prefetch_count) {}
+        prefetch_count_(prefetch_count),
+        read_async_count_(read_async_count) {}
 
   IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& options,
                     IODebugContext* dbg) override {
@@ -29,10 +31,19 @@ class MockRandomAccessFile : public FSRandomAccessFileWrapper {
     }
   }
 
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& opts,
+                     std::function<void(const FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                     IODebugContext* dbg) override {
+    read_async_count_.fetch_add(1);
+    return target()->ReadAsync(req, opts, cb, cb_arg, io_handle, del_fn, dbg);
+  }
+
  private:
   std::unique_ptr<FSRandomAccessFile> file_;
   const bool support_prefetch_;
   std::atomic_int& prefetch_count_;
+  std::atomic_int& read_async_count_;
 };
 
 class MockFS : public FileSystemWrapper {
@@ -48,8 +59,8 @@ class MockFS : public FileSystemWrapper {
     std::unique_ptr<FSRandomAccessFile> file;
     IOStatus s;
     s = target()->NewRandomAccessFile(fname, opts, &file, dbg);
-    result->reset(
-        new MockRandomAccessFile(file, support_prefetch_, prefetch_count_));
+    result->reset(new MockRandomAccessFile(file, support_prefetch_,
+                                           prefetch_count_, read_async_count_));
     return s;
   }
 
@@ -57,9 +68,14 @@ class MockFS : public FileSystemWrapper {
 
   bool IsPrefetchCalled() { return prefetch_count_ > 0; }
 
+  void ClearReadAsyncCount() { read_async_count_ = 0; }
+
+  int GetReadAsyncCount() { return read_async_count_; }
+
  private:
   const bool support_prefetch_;
   std::atomic_int prefetch_count_{0};
+  std::atomic_int read_async_count_{0};
 };
 
 class PrefetchTest
@@ -173,6 +189,82 @@ TEST_P(PrefetchTest, Basic) {
   Close();
 }
 
+TEST_P(PrefetchTest, AsyncIo) {
+  // First param is if the mockFS support_prefetch or not
+  bool support_prefetch = std::get<0>(GetParam());
+
+  // Second param is if directIO is enabled or not
+  bool use_direct_io = std::get<1>(GetParam());
+  const int kNumKeys = 10000;
+  std::shared_ptr<MockFS> fs =
+      std::make_shared<MockFS>(env_->GetFileSystem(), support_prefetch);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.disable_auto_compactions = true;
+  options.env = env.get();
+  if (use_direct_io) {
+    options.use_direct_reads = true;
+    options.use_direct_io_for_flush_and_compaction = true;
+  }
+  // Every data block read of the scans goes to the file
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Status s = TryReopen(options);
+  if (use_direct_io && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  Random rnd(309);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(BuildKey(i), rnd.RandomString(100)));
+  }
+  ASSERT_OK(Flush());
+
+  for (size_t readahead_size : {size_t{0}, size_t{64 * 1024}}) {
+    std::vector<std::pair<std::string, std::string>> expected;
+    {
+      ReadOptions ro;
+      ro.readahead_size = readahead_size;
+      auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ro));
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        expected.emplace_back(iter->key().ToString(), iter->value().ToString());
+      }
+      ASSERT_OK(iter->status());
+    }
+    ASSERT_EQ(kNumKeys, static_cast<int>(expected.size()));
+    ASSERT_EQ(0, fs->GetReadAsyncCount());
+
+    // The background readahead returns the same data, and the file system
+    // readahead is not used.
+    fs->ClearPrefetchCount();
+    {
+      ReadOptions ro;
+      ro.readahead_size = readahead_size;
+      ro.async_io = true;
+      auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ro));
+      size_t i = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+        ASSERT_LT(i, expected.size());
+        ASSERT_EQ(expected[i].first, iter->key().ToString());
+        ASSERT_EQ(expected[i].second, iter->value().ToString());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(expected.size(), i);
+    }
+    ASSERT_GT(fs->GetReadAsyncCount(), 0);
+    ASSERT_FALSE(fs->IsPrefetchCalled());
+    fs->ClearReadAsyncCount();
+  }
+  Close();
+}
+
 INSTANTIATE_TEST_CASE_P(PrefetchTest, PrefetchTest,
                         ::testing::Combine(::testing::Bool(),
                                            ::testing::Bool()));
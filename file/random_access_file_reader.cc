@@ -30,6 +30,10 @@ Status RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
 
   TEST_SYNC_POINT_CALLBACK("RandomAccessFileReader::Read", nullptr);
   Status s;
+  // Compaction reads reach the file system at low priority and the others
+  // at high, so that it can serve user reads first
+  IOOptions io_opts = opts;
+  io_opts.prio = for_compaction ? IOPriority::kIOLow : IOPriority::kIOHigh;
   uint64_t elapsed = 0;
   {
     StopWatch sw(env_, stats_, hist_type_,
@@ -74,8 +78,8 @@ Status RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
           // one iteration of this loop, so we don't need to check and adjust
           // the opts.timeout before calling file_->Read
           assert(!opts.timeout.count() || allowed == read_size);
-          s = file_->Read(aligned_offset + buf.CurrentSize(), allowed, opts,
-                          &tmp, buf.Destination(), nullptr);
+          s = file_->Read(aligned_offset + buf.CurrentSize(), allowed,
+                          io_opts, &tmp, buf.Destination(), nullptr);
         }
         if (ShouldNotifyListeners()) {
           auto finish_ts = FileOperationInfo::FinishNow();
@@ -134,7 +138,7 @@ Status RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
           // one iteration of this loop, so we don't need to check and adjust
           // the opts.timeout before calling file_->Read
           assert(!opts.timeout.count() || allowed == n);
-          s = file_->Read(offset + pos, allowed, opts, &tmp_result,
+          s = file_->Read(offset + pos, allowed, io_opts, &tmp_result,
                           scratch + pos, nullptr);
         }
 #ifndef ROCKSDB_LITE
@@ -260,7 +264,10 @@ Status RandomAccessFileReader::MultiRead(const IOOptions& opts,
 
     {
       IOSTATS_CPU_TIMER_GUARD(cpu_read_nanos, env_);
-      s = file_->MultiRead(fs_reqs, num_fs_reqs, opts, nullptr);
+      // Only user reads are batched
+      IOOptions io_opts = opts;
+      io_opts.prio = IOPriority::kIOHigh;
+      s = file_->MultiRead(fs_reqs, num_fs_reqs, io_opts, nullptr);
     }
 
 #ifndef ROCKSDB_LITE
@@ -304,4 +311,23 @@ Status RandomAccessFileReader::MultiRead(const IOOptions& opts,
   return s;
 }
 
+IOStatus RandomAccessFileReader::ReadAsync(
+    FSReadRequest& req, const IOOptions& opts,
+    std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn) {
+  if (use_direct_io()) {
+    size_t alignment = file_->GetRequiredBufferAlignment();
+    assert(req.offset % alignment == 0);
+    assert(req.len % alignment == 0);
+    assert(reinterpret_cast<uintptr_t>(req.scratch) % alignment == 0);
+    (void)alignment;
+  }
+  auto read_async_callback = [cb](const FSReadRequest& read_req, void* arg) {
+    IOSTATS_ADD_IF_POSITIVE(bytes_read, read_req.result.size());
+    cb(read_req, arg);
+  };
+  return file_->ReadAsync(req, opts, read_async_callback, cb_arg, io_handle,
+                          del_fn, nullptr);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
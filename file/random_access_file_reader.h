@@ -82,7 +82,7 @@ class RandomAccessFileReader {
       HistogramImpl* file_read_hist = nullptr,
       RateLimiter* rate_limiter = nullptr,
       const std::vector<std::shared_ptr<EventListener>>& listeners = {})
-      : file_(std::move(raf), io_tracer),
+      : file_(std::move(raf), io_tracer, _file_name),
         file_name_(std::move(_file_name)),
         env_(_env),
         stats_(stats),
@@ -131,6 +131,13 @@ class RandomAccessFileReader {
     return file_->Prefetch(offset, n, IOOptions(), nullptr);
   }
 
+  // Starts reading req.len bytes at req.offset into req.scratch, see
+  // FSRandomAccessFile::ReadAsync(). Unlike Read(), the request must already
+  // be aligned in direct IO mode. IO stats are updated on completion.
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& opts,
+                     std::function<void(const FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn);
+
   FSRandomAccessFile* file() { return file_.get(); }
 
   const std::string& file_name() const { return file_name_; }
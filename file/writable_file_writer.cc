@@ -59,7 +59,7 @@ IOStatus WritableFileWriter::Append(const Slice& data) {
   // Flush only when buffered I/O
   if (!use_direct_io() && (buf_.Capacity() - buf_.CurrentSize()) < left) {
     if (buf_.CurrentSize() > 0) {
-      s = Flush();
+      s = async_flush_ ? WriteBufferedAsync() : Flush();
       if (!s.ok()) {
         return s;
       }
@@ -86,7 +86,10 @@ IOStatus WritableFileWriter::Append(const Slice& data) {
   } else {
     // Writing directly to file bypassing the buffer
     assert(buf_.CurrentSize() == 0);
-    s = WriteBuffered(src, left);
+    s = WaitAsync();
+    if (s.ok()) {
+      s = WriteBuffered(src, left);
+    }
   }
 
   TEST_KILL_RANDOM("WritableFileWriter::Append:1", rocksdb_kill_odds);
@@ -211,9 +214,12 @@ IOStatus WritableFileWriter::Close() {
 // write out the cached data to the OS cache or storage if direct I/O
 // enabled
 IOStatus WritableFileWriter::Flush() {
-  IOStatus s;
   TEST_KILL_RANDOM("WritableFileWriter::Flush:0",
                    rocksdb_kill_odds * REDUCE_ODDS2);
+  IOStatus s = WaitAsync();
+  if (!s.ok()) {
+    return s;
+  }
 
   if (buf_.CurrentSize() > 0) {
     if (use_direct_io()) {
@@ -250,6 +256,11 @@ IOStatus WritableFileWriter::Flush() {
     return s;
   }
 
+  return MaybeRangeSync(filesize_);
+}
+
+IOStatus WritableFileWriter::MaybeRangeSync(uint64_t written) {
+  IOStatus s;
   // sync OS cache to disk for every bytes_per_sync_
   // TODO: give log file and sst file different options (log
   // files could be potentially cached in OS for their whole
@@ -265,8 +276,8 @@ IOStatus WritableFileWriter::Flush() {
     const uint64_t kBytesNotSyncRange =
         1024 * 1024;                                // recent 1MB is not synced.
     const uint64_t kBytesAlignWhenSync = 4 * 1024;  // Align 4KB.
-    if (filesize_ > kBytesNotSyncRange) {
-      uint64_t offset_sync_to = filesize_ - kBytesNotSyncRange;
+    if (written > kBytesNotSyncRange) {
+      uint64_t offset_sync_to = written - kBytesNotSyncRange;
       offset_sync_to -= offset_sync_to % kBytesAlignWhenSync;
       assert(offset_sync_to >= last_sync_size_);
       if (offset_sync_to > 0 &&
@@ -432,6 +443,84 @@ IOStatus WritableFileWriter::WriteBuffered(const char* data, size_t size) {
   return s;
 }
 
+// Starts writing the full buffer and swaps in the other one, so the caller
+// can fill it while the write is in progress. The rate limiter is charged
+// for the whole buffer before the write is submitted.
+IOStatus WritableFileWriter::WriteBufferedAsync() {
+  assert(!use_direct_io());
+  IOStatus s = WaitAsync();
+  if (!s.ok()) {
+    return s;
+  }
+  // Everything but the buffer is written now
+  s = MaybeRangeSync(filesize_ - buf_.CurrentSize());
+  if (!s.ok()) {
+    return s;
+  }
+
+  const char* src = buf_.BufferStart();
+  size_t size = buf_.CurrentSize();
+  if (rate_limiter_ != nullptr) {
+    size_t left = size;
+    while (left > 0) {
+      left -= rate_limiter_->RequestToken(
+          left, 0 /* alignment */, writable_file_->GetIOPriority(), stats_,
+          RateLimiter::OpType::kWrite);
+    }
+  }
+
+  {
+    IOSTATS_TIMER_GUARD(write_nanos);
+    TEST_SYNC_POINT("WritableFileWriter::WriteBufferedAsync:BeforeAppend");
+#ifndef ROCKSDB_LITE
+    async_offset_ = filesize_ - size;
+    if (ShouldNotifyListeners()) {
+      async_start_ts_ = FileOperationInfo::StartNow();
+    }
+#endif
+    auto prev_perf_level = GetPerfLevel();
+    IOSTATS_CPU_TIMER_GUARD(cpu_write_nanos, env_);
+    s = writable_file_->AppendAsync(Slice(src, size), IOOptions(), nullptr);
+    SetPerfLevel(prev_perf_level);
+  }
+  // Even a failed write may still be in progress
+  async_pending_ = true;
+  if (!s.ok()) {
+    return s;
+  }
+  IOSTATS_ADD(bytes_written, size);
+
+  AlignedBuffer full(std::move(buf_));
+  buf_ = std::move(async_buf_);
+  async_buf_ = std::move(full);
+  if (buf_.Capacity() < async_buf_.Capacity()) {
+    buf_.AllocateNewBuffer(async_buf_.Capacity());
+  }
+  buf_.Size(0);
+  return s;
+}
+
+IOStatus WritableFileWriter::WaitAsync() {
+  if (!async_pending_) {
+    return IOStatus::OK();
+  }
+  IOStatus s;
+  {
+    IOSTATS_TIMER_GUARD(write_nanos);
+    s = writable_file_->WaitAsync(IOOptions(), nullptr);
+  }
+  async_pending_ = false;
+#ifndef ROCKSDB_LITE
+  if (ShouldNotifyListeners()) {
+    auto finish_ts = std::chrono::steady_clock::now();
+    NotifyOnFileWriteFinish(async_offset_, async_buf_.CurrentSize(),
+                            async_start_ts_, finish_ts, s);
+  }
+#endif
+  async_buf_.Size(0);
+  return s;
+}
+
 void WritableFileWriter::UpdateFileChecksum(const Slice& data) {
   if (checksum_generator_ != nullptr) {
     checksum_generator_->Update(data.data(), data.size());
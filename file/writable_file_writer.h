@@ -33,6 +33,9 @@ class Statistics;
 // - Flush and Sync the data to the underlying filesystem.
 // - Notify any interested listeners on the completion of a write.
 // - Update IO stats.
+// - With FileOptions::async_flush, write a full buffer asynchronously while
+//   filling a second one. The write is waited for by the next buffer write,
+//   and by Flush(), Sync() and Close().
 class WritableFileWriter {
  private:
 #ifndef ROCKSDB_LITE
@@ -141,6 +144,15 @@ class WritableFileWriter {
   std::vector<std::shared_ptr<EventListener>> listeners_;
   std::unique_ptr<FileChecksumGenerator> checksum_generator_;
   bool checksum_finalized_;
+  const bool async_flush_;
+  // The buffer being written by FSWritableFile::AppendAsync() while
+  // async_pending_
+  AlignedBuffer async_buf_;
+  bool async_pending_;
+#ifndef ROCKSDB_LITE
+  uint64_t async_offset_;
+  FileOperationInfo::StartTimePoint async_start_ts_;
+#endif  // ROCKSDB_LITE
 
  public:
   WritableFileWriter(
@@ -151,7 +163,7 @@ class WritableFileWriter {
       const std::vector<std::shared_ptr<EventListener>>& listeners = {},
       FileChecksumGenFactory* file_checksum_gen_factory = nullptr)
       : file_name_(_file_name),
-        writable_file_(std::move(file), io_tracer),
+        writable_file_(std::move(file), io_tracer, _file_name),
         env_(env),
         buf_(),
         max_buffer_size_(options.writable_file_max_buffer_size),
@@ -166,12 +178,17 @@ class WritableFileWriter {
         stats_(stats),
         listeners_(),
         checksum_generator_(nullptr),
-        checksum_finalized_(false) {
+        checksum_finalized_(false),
+        async_flush_(options.async_flush && !options.use_direct_writes),
+        async_buf_(),
+        async_pending_(false) {
     TEST_SYNC_POINT_CALLBACK("WritableFileWriter::WritableFileWriter:0",
                              reinterpret_cast<void*>(max_buffer_size_));
     buf_.Alignment(writable_file_->GetRequiredBufferAlignment());
     buf_.AllocateNewBuffer(std::min((size_t)65536, max_buffer_size_));
+    async_buf_.Alignment(buf_.Alignment());
 #ifndef ROCKSDB_LITE
+    async_offset_ = 0;
     std::for_each(listeners.begin(), listeners.end(),
                   [this](const std::shared_ptr<EventListener>& e) {
                     if (e->ShouldBeNotifiedOnFileIO()) {
@@ -248,6 +265,14 @@ class WritableFileWriter {
 #endif  // !ROCKSDB_LITE
   // Normal write
   IOStatus WriteBuffered(const char* data, size_t size);
+  // Starts writing the full buffer with FSWritableFile::AppendAsync(), and
+  // continues in the other buffer
+  IOStatus WriteBufferedAsync();
+  // Waits for the write started by WriteBufferedAsync(), if any
+  IOStatus WaitAsync();
+  // RangeSync()s every bytes_per_sync_ of the first written bytes, but the
+  // last 1MB
+  IOStatus MaybeRangeSync(uint64_t written);
   IOStatus RangeSync(uint64_t offset, uint64_t nbytes);
   IOStatus SyncInternal(bool use_fsync);
 };
@@ -16,6 +16,7 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class Cache;
 class Slice;
 class SliceTransform;
 class TablePropertiesCollectorFactory;
@@ -54,6 +55,10 @@ enum CompactionPri : char {
   // and its size is the smallest. It in many cases can optimize write
   // amplification.
   kMinOverlappingRatio = 0x3,
+  // First compact files that are read the most times the number of files a
+  // read of their key range has to check, from the sampled read counts of
+  // the files. Try this if reads concentrate on a few key ranges.
+  kByReadHotness = 0x4,
 };
 
 struct CompactionOptionsFIFO {
@@ -70,6 +75,14 @@ struct CompactionOptionsFIFO {
   // Default: false;
   bool allow_compaction = false;
 
+  // On a zoned FileSystem, table files whose creation time falls into the same
+  // window of this many seconds are written to zones of their own. Files
+  // expire oldest first, so the zones of a window are reset once its last
+  // file is dropped and never need zone cleaning. Intra-L0 compactions only
+  // merge files of the same window. 0 disables the grouping.
+  // Default: 0
+  uint64_t zone_time_bucket_seconds = 0;
+
   CompactionOptionsFIFO() : max_table_files_size(1 * 1024 * 1024 * 1024) {}
   CompactionOptionsFIFO(uint64_t _max_table_files_size, bool _allow_compaction)
       : max_table_files_size(_max_table_files_size),
@@ -117,6 +130,18 @@ struct CompressionOptions {
   // Default: 0.
   uint32_t zstd_max_train_bytes;
 
+  // If nonzero, the dictionary is not created per SST file, but shared by the
+  // files of the column family. It is trained from data blocks sampled as
+  // files are written, and trained again whenever this many bytes of data
+  // blocks were written since. The files started before the first training
+  // are not compressed with a dictionary. Data blocks are then compressed and
+  // written as the file is built, without buffering the whole file.
+  //
+  // This option is valid only when BlockBasedTable is used.
+  //
+  // Default: 0.
+  uint64_t shared_dict_retrain_bytes;
+
   // Number of threads for parallel compression.
   // Parallel compression is enabled only if threads > 1.
   // THE FEATURE IS STILL EXPERIMENTAL
@@ -149,6 +174,7 @@ struct CompressionOptions {
         strategy(0),
         max_dict_bytes(0),
         zstd_max_train_bytes(0),
+        shared_dict_retrain_bytes(0),
         parallel_threads(1),
         enabled(false) {}
   CompressionOptions(int wbits, int _lev, int _strategy, int _max_dict_bytes,
@@ -159,6 +185,7 @@ struct CompressionOptions {
         strategy(_strategy),
         max_dict_bytes(_max_dict_bytes),
         zstd_max_train_bytes(_zstd_max_train_bytes),
+        shared_dict_retrain_bytes(0),
         parallel_threads(_parallel_threads),
         enabled(_enabled) {}
 };
@@ -554,6 +581,37 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   uint64_t hard_pending_compaction_bytes_limit = 256 * 1073741824ull;
 
+  // If true, writes are slowed down gradually before a slowdown trigger is
+  // hit instead of running at full speed until then. Every time the LSM tree
+  // changes, a feedback controller compares the number of L0 files and the
+  // estimated pending compaction bytes, projected by how fast compaction debt
+  // has been growing, against the targets below. Past a target it sets a
+  // delayed write rate derived from the recent flush throughput, lower the
+  // further and the longer the targets are exceeded. A slowdown trigger that
+  // is hit later starts from that rate.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool smooth_write_stall = false;
+
+  // Number of L0 files smooth_write_stall steers towards. 0 picks the
+  // midpoint between level0_file_num_compaction_trigger and
+  // level0_slowdown_writes_trigger.
+  //
+  // Default: 0
+  //
+  // Dynamically changeable through SetOptions() API
+  int smooth_write_stall_target_l0_files = 0;
+
+  // Estimated pending compaction bytes smooth_write_stall steers towards. 0
+  // picks half of soft_pending_compaction_bytes_limit.
+  //
+  // Default: 0
+  //
+  // Dynamically changeable through SetOptions() API
+  uint64_t smooth_write_stall_target_pending_compaction_bytes = 0;
+
   // The compaction style. Default: kCompactionStyleLevel
   CompactionStyle compaction_style = kCompactionStyleLevel;
 
@@ -626,6 +684,23 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t max_successive_merges = 0;
 
+  // When a merge operand is added to the memtable and the latest entry of the
+  // key in the memtable is a merge operand too, combine the two with
+  // MergeOperator::PartialMerge() and store the result in place of the latest
+  // entry, rather than adding a new one. This bounds the operand chains that
+  // reads and flushes have to merge, e.g. for counters with an associative
+  // merge operator. The new operand is still written to the WAL.
+  //
+  // Applicable only when inplace_update_support is true, which rules out
+  // snapshots that could need the operands as they were, and only when the
+  // combined operand is no larger than the latest one; otherwise the operand
+  // is added as usual.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool preaggregate_merge_operands = false;
+
   // This flag specifies that the implementation should optimize the filters
   // mainly for cases where keys are found rather than also optimize for keys
   // missed. This would be used in cases where the application knows that
@@ -642,6 +717,15 @@ struct AdvancedColumnFamilyOptions {
   // Default: false
   bool optimize_filters_for_hits = false;
 
+  // Number of leveled compaction candidates (L1 and up) compared by how much
+  // zone space their compaction would free on a zoned FileSystem, see
+  // FileSystem::GetZoneFreeBytes(). The candidate freeing the most zone space
+  // per compacted byte is picked, ties go to compaction_pri order. 0 picks
+  // by compaction_pri only.
+  //
+  // Default: 0
+  size_t zone_aware_compaction_window = 0;
+
   // During flush or compaction, check whether keys inserted to output files
   // are in order.
   //
@@ -727,6 +811,20 @@ struct AdvancedColumnFamilyOptions {
   // data is left uncompressed (unless compression is also requested).
   uint64_t sample_for_compression = 0;
 
+  // The most SST files a flush writes in parallel. The key space of the
+  // flushed memtables is split into as many ranges, from a sample of their
+  // keys, each written to its own L0 file by its own thread, so a flush of
+  // large write buffers keeps up with bursts of writes. Flushes are split
+  // into at most one range per target_file_size_base of memtable data, and
+  // not at all when the memtables hold range deletions, the memtable
+  // representation cannot sample its keys, or the comparator has
+  // timestamps.
+  //
+  // Default: 1 (one file per flush)
+  //
+  // Dynamically changeable through SetOptions() API
+  uint32_t max_flush_partitions = 1;
+
   // UNDER CONSTRUCTION -- DO NOT USE
   // When set, large values (blobs) are written to separate blob files, and
   // only pointers to them are stored in SST files. This can reduce write
@@ -752,6 +850,21 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through the SetOptions() API
   uint64_t min_blob_size = 0;
 
+  // UNDER CONSTRUCTION -- DO NOT USE
+  // The LSM tree level from which on large values are written to blob files.
+  // Flushes and compactions with an output level below it keep all values
+  // inline in the SST files, so that short-lived values which are
+  // overwritten or deleted before reaching that level never get a blob file
+  // indirection, at the price of rewriting the long-lived ones until they
+  // get there. Blobs relocated by garbage collection into a lower level are
+  // inlined as well. Note that enable_blob_files has to be set in order for
+  // this option to have any effect.
+  //
+  // Default: 0 (all flushes and compactions write blob files)
+  //
+  // Dynamically changeable through the SetOptions() API
+  int blob_file_starting_level = 0;
+
   // UNDER CONSTRUCTION -- DO NOT USE
   // The size limit for blob files. When writing blob files, a new file is
   // opened once this limit is reached. Note that enable_blob_files has to be
@@ -772,6 +885,50 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through the SetOptions() API
   CompressionType blob_compression_type = kNoCompression;
 
+  // UNDER CONSTRUCTION -- DO NOT USE
+  // When set, compactions relocate the valid blobs they encounter in the
+  // oldest blob files to new blob files, so the old files can be dropped once
+  // all their blobs have been moved. See also the option
+  // blob_garbage_collection_age_cutoff below. Note that enable_blob_files has
+  // to be set in order for this option to have any effect.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through the SetOptions() API
+  bool enable_blob_garbage_collection = false;
+
+  // UNDER CONSTRUCTION -- DO NOT USE
+  // The fraction of blob files (counted from the oldest) whose blobs are
+  // relocated by compactions when enable_blob_garbage_collection is set. It
+  // has to be in the range [0.0, 1.0]; higher values relocate more blobs,
+  // trading write amplification for space amplification.
+  //
+  // Default: 0.25
+  //
+  // Dynamically changeable through the SetOptions() API
+  double blob_garbage_collection_age_cutoff = 0.25;
+
+  // UNDER CONSTRUCTION -- DO NOT USE
+  // A cache for uncompressed blob values. Blobs read from blob files are
+  // added to it unless ReadOptions::fill_cache is false, see also
+  // prepopulate_blob_cache. Passing the block cache here makes blobs and
+  // blocks share the same capacity budget. Note that enable_blob_files has to
+  // be set in order for this option to have any effect.
+  //
+  // Default: nullptr (disabled)
+  //
+  // Not dynamically changeable, change it requires db restart.
+  std::shared_ptr<Cache> blob_cache = nullptr;
+
+  // UNDER CONSTRUCTION -- DO NOT USE
+  // When set, blobs written by flushes are also added to blob_cache, which
+  // suits workloads reading recently written large values.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through the SetOptions() API
+  bool prepopulate_blob_cache = false;
+
   // Create ColumnFamilyOptions with default values for all fields
   AdvancedColumnFamilyOptions();
   // Create ColumnFamilyOptions from Options
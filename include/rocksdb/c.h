@@ -113,6 +113,7 @@ typedef struct rocksdb_sstfilewriter_t   rocksdb_sstfilewriter_t;
 typedef struct rocksdb_ratelimiter_t     rocksdb_ratelimiter_t;
 typedef struct rocksdb_perfcontext_t     rocksdb_perfcontext_t;
 typedef struct rocksdb_pinnableslice_t rocksdb_pinnableslice_t;
+typedef struct rocksdb_pinned_values_t rocksdb_pinned_values_t;
 typedef struct rocksdb_transactiondb_options_t rocksdb_transactiondb_options_t;
 typedef struct rocksdb_transactiondb_t rocksdb_transactiondb_t;
 typedef struct rocksdb_transaction_options_t rocksdb_transaction_options_t;
@@ -436,6 +437,43 @@ extern ROCKSDB_LIBRARY_API void rocksdb_multi_get_cf(
     const size_t* keys_list_sizes, char** values_list,
     size_t* values_list_sizes, char** errs);
 
+// Batched MultiGet of num_keys keys of one column family, for bindings
+// that pay a cost per call and per allocation. The keys are back to back
+// in keys: key i spans key_offsets[i] to key_offsets[i + 1], so key_offsets
+// has num_keys + 1 entries. errs must be num_keys in length, and each
+// non-NULL errs entry is a malloc()ed, null terminated string, as for
+// rocksdb_multi_get. sorted_input tells that the keys are in order.
+//
+// This one copies the values found back to back into values, an arena of
+// values_size bytes allocated by the caller, in the order of the keys, up
+// to the first value that does not fit. It returns the number n of keys
+// done, and value i, for i < n, spans value_offsets[i] to
+// value_offsets[i + 1] (so value_offsets needs num_keys + 1 entries).
+// found[i] is 0 for a key not found, or whose lookup failed, with an empty
+// value. If n < num_keys, the arena was too small, and the rest of the keys
+// can be passed to another call.
+extern ROCKSDB_LIBRARY_API size_t rocksdb_batched_multi_get_cf_into(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    rocksdb_column_family_handle_t* column_family, size_t num_keys,
+    const char* keys, const size_t* key_offsets, unsigned char sorted_input,
+    char* values, size_t values_size, size_t* value_offsets,
+    unsigned char* found, char** errs);
+
+// This one copies no values: they stay pinned in the block cache or
+// memtable until the returned handle is destroyed, and are read from it
+// with rocksdb_pinned_values_get.
+extern ROCKSDB_LIBRARY_API rocksdb_pinned_values_t*
+rocksdb_batched_multi_get_cf_pinned(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    rocksdb_column_family_handle_t* column_family, size_t num_keys,
+    const char* keys, const size_t* key_offsets, unsigned char sorted_input,
+    char** errs);
+// The value of key index, or NULL if it was not found or its lookup failed
+extern ROCKSDB_LIBRARY_API const char* rocksdb_pinned_values_get(
+    const rocksdb_pinned_values_t* values, size_t index, size_t* vlen);
+extern ROCKSDB_LIBRARY_API void rocksdb_pinned_values_destroy(
+    rocksdb_pinned_values_t* values);
+
 // The value is only allocated (using malloc) and returned if it is found and
 // value_found isn't NULL. In that case the user is responsible for freeing it.
 extern ROCKSDB_LIBRARY_API unsigned char rocksdb_key_may_exist(
@@ -606,6 +644,19 @@ extern ROCKSDB_LIBRARY_API void rocksdb_writebatch_putv_cf(
     int num_keys, const char* const* keys_list, const size_t* keys_list_sizes,
     int num_values, const char* const* values_list,
     const size_t* values_list_sizes);
+// Puts num_entries entries in one call. The keys and values are back to
+// back in keys and values: entry i has the key from key_offsets[i] to
+// key_offsets[i + 1] and the value from value_offsets[i] to
+// value_offsets[i + 1], so both offset arrays have num_entries + 1 entries.
+extern ROCKSDB_LIBRARY_API void rocksdb_writebatch_put_packed_cf(
+    rocksdb_writebatch_t* b, rocksdb_column_family_handle_t* column_family,
+    size_t num_entries, const char* keys, const size_t* key_offsets,
+    const char* values, const size_t* value_offsets);
+// Appends the records of rep, the contents of another write batch as
+// returned by rocksdb_writebatch_data (or encoded the same way), in one
+// call. Fails if rep is not a write batch.
+extern ROCKSDB_LIBRARY_API void rocksdb_writebatch_append_data(
+    rocksdb_writebatch_t* b, const char* rep, size_t size, char** errptr);
 extern ROCKSDB_LIBRARY_API void rocksdb_writebatch_merge(rocksdb_writebatch_t*,
                                                          const char* key,
                                                          size_t klen,
@@ -33,6 +33,7 @@
 namespace ROCKSDB_NAMESPACE {
 
 class Cache;
+class SecondaryCache;
 struct ConfigOptions;
 
 extern const bool kDefaultToAdaptiveMutex;
@@ -87,6 +88,20 @@ struct LRUCacheOptions {
   CacheMetadataChargePolicy metadata_charge_policy =
       kDefaultCacheMetadataChargePolicy;
 
+  // If set, entries inserted with Cache::InsertWithHelper() are demoted to
+  // this cache when they are evicted, and Cache::LookupWithHelper() promotes
+  // them back on a miss. See rocksdb/secondary_cache.h.
+  std::shared_ptr<SecondaryCache> secondary_cache;
+
+  // If true, a TinyLFU admission filter guards the cache against scans. Each
+  // shard keeps a small frequency sketch of recent lookups, and a new
+  // low-priority entry that would evict others is only admitted if its key
+  // was accessed more often than the key of the entry it would evict first.
+  // Entries that are used once, such as the blocks of a long range scan or a
+  // compaction, then no longer flush the frequently used ones. High-priority
+  // entries are always admitted.
+  bool tiny_lfu_admission = false;
+
   LRUCacheOptions() {}
   LRUCacheOptions(size_t _capacity, int _num_shard_bits,
                   bool _strict_capacity_limit, double _high_pri_pool_ratio,
@@ -167,6 +182,19 @@ class Cache {
   // Opaque handle to an entry stored in the cache.
   struct Handle {};
 
+  // Callbacks that move an entry between its in-memory form and the flat form
+  // kept by a secondary cache.
+  struct CacheItemHelper {
+    // Returns the flat form of value. The slice must stay valid until the
+    // deleter is called on value.
+    Slice (*save_to)(void* value);
+    // Rebuilds a value from its flat form and sets *charge, or returns
+    // nullptr on failure.
+    void* (*create)(const Slice& contents, void* create_context,
+                    size_t* charge);
+    void (*deleter)(const Slice& key, void* value);
+  };
+
   // The type of the Cache
   virtual const char* Name() const = 0;
 
@@ -199,6 +227,37 @@ class Cache {
   // function.
   virtual Handle* Lookup(const Slice& key, Statistics* stats = nullptr) = 0;
 
+  // Looks up num_keys keys at once, setting handles[i] as Lookup(keys[i])
+  // would. Sharded caches take the lock of each shard once for all of the
+  // keys it holds.
+  virtual void MultiLookup(const Slice* keys, size_t num_keys,
+                           Handle** handles, Statistics* stats = nullptr) {
+    for (size_t i = 0; i < num_keys; ++i) {
+      handles[i] = Lookup(keys[i], stats);
+    }
+  }
+
+  // Like Insert(), but the entry may be demoted to a secondary cache when it
+  // is evicted. helper->deleter is used as the deleter. Caches without a
+  // secondary tier treat this as a plain Insert().
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle = nullptr,
+                                  Priority priority = Priority::LOW) {
+    return Insert(key, value, charge, helper->deleter, handle, priority);
+  }
+
+  // Like Lookup(), but on a miss the entry is looked up in the secondary
+  // cache, if any, rebuilt with helper->create(contents, create_context) and
+  // inserted with the given priority before being returned.
+  virtual Handle* LookupWithHelper(const Slice& key,
+                                   const CacheItemHelper* /*helper*/,
+                                   void* /*create_context*/,
+                                   Priority /*priority*/ = Priority::LOW,
+                                   Statistics* stats = nullptr) {
+    return Lookup(key, stats);
+  }
+
   // Increments the reference count for the handle if it refers to an entry in
   // the cache. Returns true if refcount was incremented; otherwise, returns
   // false.
@@ -14,10 +14,10 @@
 #include <vector>
 
 #include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/slice.h"
 
 namespace ROCKSDB_NAMESPACE {
 
-class Slice;
 class SliceTransform;
 
 // Context information of a compaction run
@@ -62,6 +62,18 @@ class CompactionFilter {
     uint32_t column_family_id;
   };
 
+  // A key-value of a FilterBatch() call. key, value_type and existing_value
+  // are the arguments FilterV2() would get, and decision, new_value and
+  // skip_until its results.
+  struct BatchEntry {
+    Slice key;
+    ValueType value_type = ValueType::kValue;
+    Slice existing_value;
+    Decision decision = Decision::kKeep;
+    std::string new_value;
+    std::string skip_until;
+  };
+
   virtual ~CompactionFilter() {}
 
   // The compaction process invokes this
@@ -179,6 +191,34 @@ class CompactionFilter {
     return Decision::kKeep;
   }
 
+  // The number of input entries a compaction reads ahead to pass their
+  // key-values to FilterBatch() at once, e.g. for the filter to batch its
+  // lookups in an external index. 0, the default, calls FilterV2() on each
+  // key-value as the compaction reaches it.
+  //
+  // The entries read ahead are copied. Compactions of a DB with a snapshot
+  // checker, i.e. a WritePrepared or WriteUnprepared TransactionDB, and the
+  // merge operands still call FilterV2() on each key-value.
+  virtual size_t FilterBatchSize() const { return 0; }
+
+  // Called instead of FilterV2() on the key-values of up to
+  // FilterBatchSize() consecutive input entries, in key order. Sets the
+  // decision of each entry, with its new_value or skip_until, as FilterV2()
+  // would return it. The default calls FilterV2() on each entry.
+  //
+  // Since the entries are read ahead, the compaction may not use all the
+  // decisions: the entries after a kRemoveAndSkipUntil in the same batch
+  // are still passed, as are those after the end of a subcompaction, or
+  // after the compaction is shut down.
+  virtual void FilterBatch(int level, BatchEntry* entries, size_t n) const {
+    for (size_t i = 0; i < n; i++) {
+      BatchEntry& entry = entries[i];
+      entry.decision =
+          FilterV2(level, entry.key, entry.value_type, entry.existing_value,
+                   &entry.new_value, &entry.skip_until);
+    }
+  }
+
   // Internal (BlobDB) use only. Do not override in application code.
   virtual BlobDecision PrepareBlobOutput(const Slice& /* key */,
                                          const Slice& /* existing_value */,
@@ -94,5 +94,10 @@ struct CompactionJobStats {
 
   // number of single-deletes which meet something other than a put
   uint64_t num_single_del_mismatch;
+
+  // number of blobs and their bytes moved to new blob files (or inlined) by
+  // blob garbage collection
+  uint64_t num_blobs_relocated;
+  uint64_t total_blob_bytes_relocated;
 };
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,77 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "rocksdb/compression_type.h"
+#include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct CompressionOptions;
+
+// A Compressor compresses the blocks of block-based tables in place of the
+// built-in compression libraries, e.g. by offloading it to a hardware
+// accelerator. See `BlockBasedTableOptions::compressor`.
+//
+// It produces the raw stream of the compression library for the type, e.g. a
+// raw deflate stream with `CompressionOptions::window_bits` for
+// kZlibCompression or an LZ4 block for kLZ4Compression, which the table
+// builder frames as the built-in compression would. The blocks are thus read
+// back with the built-in decompression.
+//
+// Blocks compressed with a dictionary, blocks of tables with a format_version
+// below 2, and blocks the Compressor fails on are compressed in software.
+class Compressor {
+ public:
+  // A block to compress as part of a batch
+  struct Block {
+    // The uncompressed contents
+    Slice input;
+    // The compressed contents are appended to it
+    std::string* output = nullptr;
+    // Set to non-OK if the block could not be compressed
+    Status status;
+  };
+
+  virtual ~Compressor() {}
+
+  // The name of the compressor, for logging
+  virtual const char* Name() const = 0;
+
+  // Returns whether blocks can be compressed with the type
+  virtual bool Supports(CompressionType type) const = 0;
+
+  // Compresses input with the type and options, appending the compressed
+  // contents to output. Can be called from multiple threads at once.
+  virtual Status Compress(CompressionType type, const CompressionOptions& opts,
+                          const Slice& input, std::string* output) = 0;
+
+  // Compresses a batch of blocks with the type and options, setting the
+  // status of each, then calls done, possibly from another thread. The
+  // blocks are left alone until done is called. When the table builder
+  // compresses in parallel (see `CompressionOptions::parallel_threads`), the
+  // blocks waiting to be compressed are submitted together this way.
+  //
+  // The default implementation compresses the blocks one by one with
+  // Compress() before returning.
+  virtual void CompressAsync(CompressionType type,
+                             const CompressionOptions& opts,
+                             std::vector<Block>* blocks,
+                             std::function<void()> done) {
+    for (auto& block : *blocks) {
+      block.status = Compress(type, opts, block.input, block.output);
+    }
+    done();
+  }
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -221,6 +222,20 @@ class DB {
       const std::vector<ColumnFamilyDescriptor>& column_families,
       std::vector<ColumnFamilyHandle*>* handles, DB** dbptr);
 
+  // Runs a compaction job that a CompactionService received from the DB at
+  // `name`, usually on another host. The DB is opened as a secondary
+  // instance, and the compaction output files are written into
+  // output_directory, which also holds the info log. The files are not
+  // installed into the DB; the serialized result, which lists them, is
+  // returned in output for the service to hand back to the DB. Once the
+  // DB is open, output is filled in even when the compaction fails.
+  // Not supported in ROCKSDB_LITE, in which case, the function will
+  // return Status::NotSupported.
+  static Status OpenAndCompact(
+      const std::string& name, const std::string& output_directory,
+      const std::string& input, std::string* output,
+      const CompactionServiceOptionsOverride& override_options);
+
   // Open DB with column families.
   // db_options specify database specific options
   // column_families is the vector of all column families in the database,
@@ -397,6 +412,21 @@ class DB {
   // Note: consider setting options.sync = true.
   virtual Status Write(const WriteOptions& options, WriteBatch* updates) = 0;
 
+  // Asynchronous version of Write(). The write is queued and done by a thread
+  // of the DB, see DBOptions::max_async_write_threads, in the same group
+  // commit as concurrent Write() calls. callback is called with the status of
+  // the write from that thread once the write is in the WAL and memtables,
+  // or right away if it could not be queued. updates, and options.timestamp
+  // if set, must stay alive until callback is called. callback must not
+  // block for long since it holds up the thread's next write, and must not
+  // close the DB. Closing the DB finishes the queued writes first.
+  //
+  // The default implementation calls Write() and then callback.
+  virtual void WriteAsync(const WriteOptions& options, WriteBatch* updates,
+                          std::function<void(const Status&)> callback) {
+    callback(Write(options, updates));
+  }
+
   // If the database contains an entry for "key" store the
   // corresponding value in *value and return OK.
   //
@@ -790,6 +820,11 @@ class DB {
     //      running compactions.
     static const std::string kNumRunningCompactions;
 
+    //  "rocksdb.num-table-files-pending-open" - returns the number of table
+    //      files left to open in the background after DB::Open() with
+    //      lazy_open_table_files.
+    static const std::string kNumTableFilesPendingOpen;
+
     //  "rocksdb.background-errors" - returns accumulated number of background
     //      errors.
     static const std::string kBackgroundErrors;
@@ -900,6 +935,18 @@ class DB {
     //      specified level "N" at the target column family.
     static const std::string kAggregatedTablePropertiesAtLevel;
 
+    //  "rocksdb.key-distribution" - returns a histogram of the user keys of
+    //      the live SST files of the target column family, sampled from their
+    //      index blocks: one line per bucket with its bytes, their share of
+    //      the total and the largest user key of the bucket in hex. The
+    //      buckets hold about as many bytes each, as the ranges of the
+    //      subcompactions and of the L0 file placement hints do.
+    static const std::string kKeyDistribution;
+
+    //  "rocksdb.key-distribution-at-level<N>", same as the previous one but
+    //      only for the files of level "N".
+    static const std::string kKeyDistributionAtLevel;
+
     //  "rocksdb.actual-delayed-write-rate" - returns the current actual delayed
     //      write rate. 0 means no delay.
     static const std::string kActualDelayedWriteRate;
@@ -924,9 +971,33 @@ class DB {
     //      entries being pinned.
     static const std::string kBlockCachePinnedUsage;
 
+    //  "rocksdb.block-cache-allocator-stats" - returns the memory usage and
+    //      fragmentation of the MemoryAllocator of the block cache, if it
+    //      reports them, see MemoryAllocator::GetProperty().
+    static const std::string kBlockCacheAllocatorStats;
+
     // "rocksdb.options-statistics" - returns multi-line string
     //      of options.statistics
     static const std::string kOptionsStatistics;
+
+    //  "rocksdb.write-stall-attribution" - returns a multi-line string
+    //      describing the latest write stalls of the column family, and the
+    //      one going on if any: their cause, the work queued when they
+    //      started, the bytes written while they lasted, and the flushes
+    //      and compactions which ran meanwhile.
+    static const std::string kWriteStallAttribution;
+
+    //  "rocksdb.zenfs.<name>" - returns a zoned FileSystem property, one of
+    //      open-zones, active-zones, free-space, used-space,
+    //      reclaimable-space, bytes-written (to the io zones, zone cleaning
+    //      copies included), gc-bytes-copied, gc-extents-migrated,
+    //      zone-resets, zone-finishes, meta-log-bytes, read-cache-hits,
+    //      read-cache-misses and the number of zones placed by each rule:
+    //      placement-overlap, placement-l0, placement-same-level,
+    //      placement-lifetime, placement-empty, placement-time-bucket and
+    //      placement-predicted.
+    //      "rocksdb.zenfs.stats" returns all of them as a multi-line string.
+    static const std::string kZenFSPrefix;
   };
 #endif /* ROCKSDB_LITE */
 
@@ -977,6 +1048,7 @@ class DB {
   //  "rocksdb.estimate-pending-compaction-bytes"
   //  "rocksdb.num-running-compactions"
   //  "rocksdb.num-running-flushes"
+  //  "rocksdb.num-table-files-pending-open"
   //  "rocksdb.actual-delayed-write-rate"
   //  "rocksdb.is-write-stopped"
   //  "rocksdb.estimate-oldest-key-time"
@@ -1447,6 +1519,16 @@ class DB {
 
   virtual Status VerifyChecksum() { return VerifyChecksum(ReadOptions()); }
 
+  // Like VerifyChecksum(read_options), with the files verified in parallel
+  // and the reads bounded as set by verify_options. The table reads do not
+  // fill the block cache. Returns the first error found, after which the
+  // other threads stop.
+  virtual Status VerifyChecksum(const ReadOptions& /*read_options*/,
+                                const VerifyChecksumOptions& /*options*/) {
+    return Status::NotSupported(
+        "VerifyChecksum() with VerifyChecksumOptions is not supported");
+  }
+
   // AddFile() is deprecated, please use IngestExternalFile()
   ROCKSDB_DEPRECATED_FUNC virtual Status AddFile(
       ColumnFamilyHandle* column_family,
@@ -1646,6 +1728,20 @@ class DB {
   virtual Status TryCatchUpWithPrimary() {
     return Status::NotSupported("Supported only by secondary instance");
   }
+
+  // Make the secondary instance catch up with the primary in a background
+  // thread, as TryCatchUpWithPrimary() does, as soon as the primary writes
+  // to its MANIFEST or WAL files, and at least every max_wait_us. Where the
+  // files are not in the local file system, or off Linux, the thread does
+  // not get notified of the writes, and catches up every max_wait_us.
+  // The thread runs until StopCatchingUpWithPrimary() or the DB is closed.
+  virtual Status StartCatchingUpWithPrimary(uint64_t /*max_wait_us*/) {
+    return Status::NotSupported("Supported only by secondary instance");
+  }
+
+  virtual Status StopCatchingUpWithPrimary() {
+    return Status::NotSupported("Supported only by secondary instance");
+  }
 #endif  // !ROCKSDB_LITE
 };
 
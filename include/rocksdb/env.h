@@ -58,6 +58,7 @@ class RateLimiter;
 class ThreadStatusUpdater;
 struct ThreadStatus;
 class FileSystem;
+class Statistics;
 
 const size_t kDefaultPageSize = 4 * 1024;
 
@@ -134,6 +135,11 @@ struct EnvOptions {
   // See DBOptions doc
   size_t writable_file_max_buffer_size = 1024 * 1024;
 
+  // If true, a WritableFileWriter writes its full buffers with
+  // FSWritableFile::AppendAsync() while filling a second one.
+  // See DBOptions::async_table_file_flush
+  bool async_flush = false;
+
   // If not nullptr, write rate limiting is enabled for flush and compaction
   RateLimiter* rate_limiter = nullptr;
 };
@@ -1651,6 +1657,32 @@ Status NewHdfsEnv(Env** hdfs_env, const std::string& fsname);
 // This is a factory method for TimedEnv defined in utilities/env_timed.cc.
 Env* NewTimedEnv(Env* base_env);
 
+// Options for NewWorkStealingEnv()
+struct WorkStealingEnvOptions {
+  // Pin each worker thread to a NUMA node, spreading the workers evenly over
+  // the nodes, so that background jobs keep to the memory of one socket.
+  // Only has an effect in builds with NUMA support.
+  bool pin_to_numa_nodes = false;
+
+  // If set, the time background jobs wait in the queues is reported to the
+  // HIGH_PRI_POOL_QUEUEING_MICROS, LOW_PRI_POOL_QUEUEING_MICROS and
+  // BOTTOM_PRI_POOL_QUEUEING_MICROS histograms.
+  std::shared_ptr<Statistics> statistics;
+};
+
+// Returns a new environment that runs the jobs scheduled in the HIGH, LOW and
+// BOTTOM thread pools on one work-stealing pool, and delegates everything
+// else, including the USER pool, to base_env. The pool has as many workers
+// as the three pools together, each with a queue of its own that the others
+// steal from when idle, and always runs HIGH jobs (flushes) before queued LOW
+// ones (compactions), and those before BOTTOM ones. The number of jobs of a
+// priority running at once is not limited by its thread count, which the
+// DB's own limits on background jobs take care of. Lowering the IO or CPU
+// priority of the pools is not supported.
+// This is a factory method for WorkStealingEnv defined in
+// utilities/env_work_stealing.cc.
+Env* NewWorkStealingEnv(Env* base_env, const WorkStealingEnvOptions& options);
+
 // Returns an instance of logger that can be used for storing informational
 // messages.
 // This is a factory method for EnvLogger declared in logging/env_logging.h
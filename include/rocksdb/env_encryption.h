@@ -71,6 +71,8 @@ class BlockCipher {
   // @param value  The value might be:
   //   - ROT13         Create a ROT13 Cipher
   //   - ROT13:nn      Create a ROT13 Cipher with block size of nn
+  //   - AES:hex       Create an AES Cipher with the hex encoded 128, 192 or
+  //                   256-bit key
   // @param result The new cipher object
   // @return OK if the cipher was sucessfully created
   // @return NotFound if an invalid name was specified in the value
@@ -84,6 +86,12 @@ class BlockCipher {
   // production!!!
   static std::shared_ptr<BlockCipher> NewROT13Cipher(size_t block_size);
 
+  // Short-cut method to create an AES BlockCipher, using the AES-NI or the
+  // ARMv8 cryptography instructions when available. The key must be 16, 24
+  // or 32 bytes long, for AES-128, AES-192 or AES-256. Returns nullptr for
+  // other key lengths.
+  static std::shared_ptr<BlockCipher> NewAESCipher(const std::string& key);
+
   virtual const char* Name() const = 0;
   // BlockSize returns the size of each block supported by this cipher stream.
   virtual size_t BlockSize() = 0;
@@ -95,6 +103,12 @@ class BlockCipher {
   // Decrypt a block of data.
   // Length of data is equal to BlockSize().
   virtual Status Decrypt(char* data) = 0;
+
+  // Encrypt num_blocks consecutive blocks of data, independently of each
+  // other. Length of data is equal to num_blocks * BlockSize().
+  // CTRCipherStream encrypts its counter blocks in batches through this
+  // method, which ciphers can override to process several blocks at once.
+  virtual Status EncryptBlocks(char* data, size_t num_blocks);
 };
 
 // The encryption provider is used to create a cipher stream for a specific
@@ -94,11 +94,36 @@ struct IOOptions {
 // File scope options that control how a file is opened/created and accessed
 // while its open. We may add more options here in the future such as
 // redundancy level, media to use etc.
+// What is known about a new table file when it is created, before any of
+// its data is written
+struct FilePlacementHint {
+  // The level the file is written to, or -1 if unknown
+  int level = -1;
+  // The encoded internal keys the keys of the file are expected to fall
+  // between, or empty if unknown
+  std::string smallest;
+  std::string largest;
+  // The expected size of the file in bytes, or 0 if unknown
+  uint64_t expected_size = 0;
+  // Set by flushes to the column family of the file, and to the coarse key
+  // range of L1 the file falls in. L0->L1 compactions of different column
+  // families and key ranges run at different times, so their L0 files are
+  // best kept apart. The column family is UINT32_MAX if unknown
+  uint32_t column_family_id = std::numeric_limits<uint32_t>::max();
+  uint32_t key_range = 0;
+};
+
 struct FileOptions : EnvOptions {
   // Embedded IOOptions to control the parameters for any IOs that need
   // to be issued for the file open/creation
   IOOptions io_options;
 
+  // Set by flushes and compactions when they create a table file with
+  // NewWritableFile(), so that the file system can place the file when it
+  // is opened, e.g. next to files of a similar key range and lifetime,
+  // rather than wait for the data
+  FilePlacementHint placement_hint;
+
   FileOptions() : EnvOptions() {}
 
   FileOptions(const DBOptions& opts)
@@ -108,7 +133,9 @@ struct FileOptions : EnvOptions {
     : EnvOptions(opts) {}
 
   FileOptions(const FileOptions& opts)
-    : EnvOptions(opts), io_options(opts.io_options) {}
+    : EnvOptions(opts),
+      io_options(opts.io_options),
+      placement_hint(opts.placement_hint) {}
 
   FileOptions& operator=(const FileOptions& opts) = default;
 };
@@ -142,6 +169,15 @@ struct IODebugContext {
   }
 };
 
+// Location of one extent of a file on a zoned device, see
+// FileSystem::GetFileExtents()
+struct ZonedFileExtent {
+  uint64_t fno;
+  int zone_id;
+  uint64_t start;
+  uint64_t length;
+};
+
 // The FileSystem, FSSequentialFile, FSRandomAccessFile, FSWritableFile,
 // FSRandomRWFileclass, and FSDIrectory classes define the interface between
 // RocksDB and storage systems, such as Posix filesystems,
@@ -168,6 +204,22 @@ class FileSystem {
   virtual void SetDBPointer(DBImpl* db);
   virtual int GetZonedFileExtentNum(const uint64_t);
   virtual void GetExtentInfo(const uint64_t, const int, int&, uint32_t&, uint32_t&);
+  // Appends the extents of the given SST file numbers, in file order
+  virtual void GetFileExtents(const std::vector<uint64_t>&,
+                              std::vector<ZonedFileExtent>*);
+  // Fills value for a "rocksdb.zenfs.*" property, see DB::Properties
+  virtual bool GetProperty(const std::string& property, std::string* value);
+  // Zone space that stops needing a copy in zone cleaning once the given SST
+  // files are deleted, 0 if the FileSystem is not zoned
+  virtual uint64_t GetZoneFreeBytes(const std::vector<uint64_t>& fnos);
+  // Remaining capacity of the zone the next SST file of the given level is
+  // expected to be written to, with the capacity of an empty zone in
+  // max_capacity. Both are 0 if the FileSystem is not zoned
+  virtual uint64_t GetZoneCapacity(int level, uint64_t* max_capacity);
+  // Storage tier the table files of the given level are written to, 0 if
+  // the FileSystem has a single one. Compactions between the levels of
+  // different tiers rewrite the files rather than move them.
+  virtual int GetStorageTier(int level);
 
   virtual ~FileSystem();
 
@@ -379,6 +431,20 @@ class FileSystem {
                               const IOOptions& options,
                               IODebugContext* dbg) = 0;
 
+  // Delete the named files, for file systems that can do it for less than
+  // deleting them one at a time. Sets (*statuses)[i] to the status of the
+  // deletion of fnames[i].
+  //
+  // The default implementation returns NotSupported without deleting
+  // anything, and the caller is to delete the files one at a time.
+  virtual IOStatus DeleteFiles(const std::vector<std::string>& /*fnames*/,
+                               const IOOptions& /*options*/,
+                               std::vector<IOStatus>* /*statuses*/,
+                               IODebugContext* /*dbg*/) {
+    return IOStatus::NotSupported(
+        "DeleteFiles is not supported for this FileSystem");
+  }
+
   // Truncate the named file to the specified size.
   virtual IOStatus Truncate(const std::string& /*fname*/, size_t /*size*/,
                             const IOOptions& /*options*/,
@@ -538,6 +604,20 @@ class FileSystem {
                                const IOOptions& options, bool* is_dir,
                                IODebugContext* /*dgb*/) = 0;
 
+  // Waits for the completion of reads started by
+  // FSRandomAccessFile::ReadAsync() on files of this file system. io_handles
+  // are the handles returned by ReadAsync(). The callback of every read in
+  // io_handles has been invoked once this returns OK. min_completions is a
+  // hint for implementations able to return early; callers currently always
+  // wait for all handles.
+  //
+  // The default implementation does nothing, as the default ReadAsync()
+  // completes the read before returning.
+  virtual IOStatus Poll(std::vector<void*>& /*io_handles*/,
+                        size_t /*min_completions*/) {
+    return IOStatus::OK();
+  }
+
   // If you're adding methods here, remember to add them to EnvWrapper too.
 
  private:
@@ -619,6 +699,9 @@ struct FSReadRequest {
   IOStatus status;
 };
 
+// Releases an I/O handle returned by FSRandomAccessFile::ReadAsync()
+using IOHandleDeleter = std::function<void(void*)>;
+
 // A file abstraction for randomly reading the contents of a file.
 class FSRandomAccessFile {
  public:
@@ -667,6 +750,31 @@ class FSRandomAccessFile {
     return IOStatus::OK();
   }
 
+  // Starts reading req.len bytes at req.offset into req.scratch and returns
+  // without waiting for the data. Once the read completes, cb is invoked with
+  // the request, its result and status filled in, and with cb_arg. The
+  // callback runs either before ReadAsync() returns or from
+  // FileSystem::Poll(); the same direct IO alignment rules as Read() apply.
+  //
+  // If the read is still in flight when ReadAsync() returns, *io_handle is
+  // set to a handle to pass to FileSystem::Poll() and *del_fn to the function
+  // releasing it, which must be called after the read completed. Otherwise
+  // *io_handle is left untouched. req.scratch must stay alive until the read
+  // completed. A non-OK return means the read was not started and cb will
+  // not be invoked.
+  //
+  // The default implementation reads synchronously.
+  virtual IOStatus ReadAsync(
+      FSReadRequest& req, const IOOptions& opts,
+      std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+      void** /*io_handle*/, IOHandleDeleter* /*del_fn*/,
+      IODebugContext* dbg) {
+    req.status =
+        Read(req.offset, req.len, opts, &(req.result), req.scratch, dbg);
+    cb(req, cb_arg);
+    return IOStatus::OK();
+  }
+
   // Tries to get an unique ID for this file that will be the same each time
   // the file is opened (and will stay the same while the file is open).
   // Furthermore, it tries to make this ID at most "max_size" bytes. If such an
@@ -745,6 +853,22 @@ class FSWritableFile {
       int c = level;
       c++;
   };
+  // (ZenFS) Expected internal key range and output level of a table file,
+  // known before any data is written (e.g. the compaction's input range).
+  // Lets zoned file systems place the file before the table is finished.
+  // Prefer FileOptions::placement_hint, which is known at open time.
+  virtual void SetPlacementHint(const Slice& /*smallest*/,
+                                const Slice& /*largest*/, const int /*level*/) {}
+  // (ZenFS) Creation time window of a FIFO table file, see
+  // CompactionOptionsFIFO::zone_time_bucket_seconds. Files of the same
+  // non-zero bucket share zones with no other files.
+  virtual void SetTimeBucket(uint64_t /*bucket*/) {}
+  // (ZenFS) Output level, creation time (seconds since the epoch) and a
+  // typical value size of a blob file. Blob files of the same level, time
+  // window and value size class share zones with no other files, so the
+  // zones can be reset as a whole once the generation is obsolete.
+  virtual void SetBlobFileHint(int /*level*/, uint64_t /*creation_time*/,
+                               uint64_t /*value_size*/) {}
   // Append data to the end of the file
   // Note: A WriteabelFile object must support either Append or
   // PositionedAppend, so the users cannot mix the two.
@@ -800,6 +924,25 @@ class FSWritableFile {
     return IOStatus::NotSupported("PositionedAppend");
   }
 
+  // Starts appending data to the end of the file, and may return before it
+  // is written. data must stay valid and unchanged until WaitAsync()
+  // returns, and no other write, flush, sync or close of the file may be
+  // issued before then. Several AppendAsync() calls may be outstanding,
+  // they are written in order. An error of the write itself may only be
+  // returned by WaitAsync().
+  // The default implementation appends synchronously.
+  virtual IOStatus AppendAsync(const Slice& data, const IOOptions& options,
+                               IODebugContext* dbg) {
+    return Append(data, options, dbg);
+  }
+
+  // Waits for the outstanding AppendAsync() calls to complete, and returns
+  // the first error of their writes.
+  virtual IOStatus WaitAsync(const IOOptions& /*options*/,
+                             IODebugContext* /*dbg*/) {
+    return IOStatus::OK();
+  }
+
   // Truncate is necessary to trim the file to the correct size
   // before closing. It is not always possible to keep track of the file
   // size due to whole pages writes. The behavior is undefined if called
@@ -1138,6 +1281,12 @@ class FileSystemWrapper : public FileSystem {
                       IODebugContext* dbg) override {
     return target_->DeleteFile(f, options, dbg);
   }
+  IOStatus DeleteFiles(const std::vector<std::string>& fnames,
+                       const IOOptions& options,
+                       std::vector<IOStatus>* statuses,
+                       IODebugContext* dbg) override {
+    return target_->DeleteFiles(fnames, options, statuses, dbg);
+  }
   IOStatus Truncate(const std::string& fname, size_t size,
                     const IOOptions& options, IODebugContext* dbg) override {
     return target_->Truncate(fname, size, options, dbg);
@@ -1252,6 +1401,10 @@ class FileSystemWrapper : public FileSystem {
                        bool* is_dir, IODebugContext* dbg) override {
     return target_->IsDirectory(path, options, is_dir, dbg);
   }
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t min_completions) override {
+    return target_->Poll(io_handles, min_completions);
+  }
 
  private:
   std::shared_ptr<FileSystem> target_;
@@ -1304,6 +1457,12 @@ class FSRandomAccessFileWrapper : public FSRandomAccessFile {
                     IODebugContext* dbg) override {
     return target_->Prefetch(offset, n, options, dbg);
   }
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& opts,
+                     std::function<void(const FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                     IODebugContext* dbg) override {
+    return target_->ReadAsync(req, opts, cb, cb_arg, io_handle, del_fn, dbg);
+  }
   size_t GetUniqueId(char* id, size_t max_size) const override {
     return target_->GetUniqueId(id, max_size);
   };
@@ -1346,6 +1505,13 @@ class FSWritableFileWrapper : public FSWritableFile {
     return target_->PositionedAppend(data, offset, options, verification_info,
                                      dbg);
   }
+  IOStatus AppendAsync(const Slice& data, const IOOptions& options,
+                       IODebugContext* dbg) override {
+    return target_->AppendAsync(data, options, dbg);
+  }
+  IOStatus WaitAsync(const IOOptions& options, IODebugContext* dbg) override {
+    return target_->WaitAsync(options, dbg);
+  }
   IOStatus Truncate(uint64_t size, const IOOptions& options,
                     IODebugContext* dbg) override {
     return target_->Truncate(size, options, dbg);
@@ -108,6 +108,10 @@ struct FilterBuildingContext {
 
   // An optional logger for reporting errors, warnings, etc.
   Logger* info_log = nullptr;
+
+  // Number of threads the builder may use to construct one filter, from
+  // CompressionOptions::parallel_threads of the table being built.
+  uint32_t parallel_threads = 1;
 };
 
 // We add a new format of filter block called full filter block
@@ -136,6 +140,9 @@ class FilterPolicy {
   //   "bloomfilter:[bits_per_key]:[use_block_based_builder]",
   //   e.g. ""bloomfilter:4:true"
   //   The above string is equivalent to calling NewBloomFilterPolicy(4, true).
+  // For Ribbon filters, value may be of the form
+  //   "ribbonfilter:[bloom_equivalent_bits_per_key]", e.g. "ribbonfilter:10",
+  //   equivalent to calling NewExperimentalRibbonFilterPolicy(10).
   static Status CreateFromString(const ConfigOptions& config_options,
                                  const std::string& value,
                                  std::shared_ptr<const FilterPolicy>* result);
@@ -212,4 +219,20 @@ class FilterPolicy {
 // trailing spaces in keys.
 extern const FilterPolicy* NewBloomFilterPolicy(
     double bits_per_key, bool use_block_based_builder = false);
+
+// Return a new filter policy that builds Ribbon filters for full and
+// partitioned filter blocks, with about the same FP rate as a Bloom filter
+// with bloom_equivalent_bits_per_key but about 30% less space, in exchange
+// for more CPU and temporary memory to construct. Queries are about as fast.
+//
+// Construction of one filter is spread over up to
+// CompressionOptions::parallel_threads threads when the filter is large
+// enough, and its temporary memory is charged to the block cache with
+// BlockBasedTableOptions::reserve_table_builder_memory.
+//
+// Ribbon filters are read by the same (built-in Bloom) FilterPolicy, so
+// they can be mixed with Bloom filters in a DB. Versions that predate them
+// treat them as always matching, which is safe but makes them useless.
+extern const FilterPolicy* NewExperimentalRibbonFilterPolicy(
+    double bloom_equivalent_bits_per_key);
 }  // namespace ROCKSDB_NAMESPACE
@@ -48,6 +48,10 @@ struct IOStatsContext {
   uint64_t cpu_write_nanos;
   // CPU time spent in read() and pread()
   uint64_t cpu_read_nanos;
+  // time spent picking a zone for a ZenFS file.
+  uint64_t zenfs_zone_alloc_nanos;
+  // number of extent boundaries crossed by ZenFS reads.
+  uint64_t zenfs_extent_hops;
 };
 
 // Get Thread-local IOStatsContext object pointer
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include "rocksdb/cleanable.h"
 #include "rocksdb/slice.h"
@@ -68,6 +69,18 @@ class Iterator : public Cleanable {
   // REQUIRES: Valid()
   virtual void Next() = 0;
 
+  // Passes the entries from the current one on to callback, moving past
+  // each, as Next() would, until max_entries entries, or entries of
+  // max_bytes of keys and values or more, have been passed, or the iterator
+  // is no longer Valid(). Returns the number of entries passed. The slices
+  // are only valid during the callback. Cheaper than as many calls to
+  // key(), value() and Next() for iterators of the DB, which do it in one
+  // go, for scans with short values.
+  virtual size_t NextBatch(
+      size_t max_entries, size_t max_bytes,
+      const std::function<void(const Slice& key, const Slice& value)>&
+          callback);
+
   // Moves to the previous entry in the source.  After this call, Valid() is
   // true iff the iterator was not positioned at the first entry in source.
   // Currently incompatible with user timestamp.
@@ -135,6 +135,13 @@ enum class WriteStallCondition {
   kStopped,
 };
 
+enum class WriteStallCause {
+  kNone,
+  kMemtableLimit,
+  kL0FileCountLimit,
+  kPendingCompactionBytes,
+};
+
 struct WriteStallInfo {
   // the name of the column family
   std::string cf_name;
@@ -145,6 +152,46 @@ struct WriteStallInfo {
   } condition;
 };
 
+// A flush or compaction of the column family which ran during a write stall
+struct WriteStallBlockingJobInfo {
+  // the id of the flush or compaction job
+  int job_id = 0;
+  // true for a flush, false for a compaction
+  bool is_flush = false;
+  // the level the job writes to
+  int output_level = 0;
+  // how long the job ran, until it finished or, if it still runs, until the
+  // end of the stall
+  uint64_t run_micros = 0;
+  // false if the job still runs when the stall ends
+  bool finished = false;
+  // the bytes the job wrote, if it finished
+  uint64_t bytes_written = 0;
+};
+
+struct WriteStallIntervalInfo {
+  // the name of the column family
+  std::string cf_name;
+  // the worst condition during the stall, kDelayed or kStopped
+  WriteStallCondition condition = WriteStallCondition::kNormal;
+  // what caused the stall when it started
+  WriteStallCause cause = WriteStallCause::kNone;
+  // when the stall started, from Env::NowMicros(), and how long it lasted
+  uint64_t start_micros = 0;
+  uint64_t duration_micros = 0;
+  // the work queued when the stall started
+  int num_unflushed_memtables = 0;
+  int num_l0_files = 0;
+  uint64_t pending_compaction_bytes = 0;
+  // the bytes written by the flushes and compactions of the column family
+  // which finished during the stall, from which the write throughput of the
+  // device during the stall can be told
+  uint64_t bytes_written = 0;
+  // the flushes and compactions of the column family which ran during the
+  // stall, in the order they started
+  std::vector<WriteStallBlockingJobInfo> blocking_jobs;
+};
+
 #ifndef ROCKSDB_LITE
 
 struct TableFileDeletionInfo {
@@ -491,6 +538,12 @@ class EventListener {
   // returns.  Otherwise, RocksDB may be blocked.
   virtual void OnStallConditionsChanged(const WriteStallInfo& /*info*/) {}
 
+  // A callback function for RocksDB which will be called whenever a write
+  // stall of a column family ends, with the flushes and compactions that ran
+  // while it lasted. Like OnStallConditionsChanged(), it should return
+  // quickly, or RocksDB may be blocked.
+  virtual void OnWriteStallInterval(const WriteStallIntervalInfo& /*info*/) {}
+
   // A callback function for RocksDB which will be called whenever a file read
   // operation finishes.
   virtual void OnFileReadFinish(const FileOperationInfo& /* info */) {}
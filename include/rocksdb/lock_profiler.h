@@ -0,0 +1,58 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The contention on a lock instance from one acquire site, over the sampled
+// acquisitions
+struct LockContentionStats {
+  // The name of the lock, e.g. "DBImpl::mutex_"
+  std::string lock_name;
+  // The address of the lock instance, telling apart the locks of a name
+  uint64_t lock_id = 0;
+  // Where the lock was acquired, as "dir/file.cc:line"
+  std::string acquire_site;
+
+  uint64_t sampled_acquisitions = 0;
+  // The time spent waiting for the lock
+  uint64_t total_wait_nanos = 0;
+  uint64_t max_wait_nanos = 0;
+  // The time the lock was held from the site, up to its release or to a
+  // condition variable wait on it
+  uint64_t total_hold_nanos = 0;
+  uint64_t max_hold_nanos = 0;
+};
+
+// The lock profiler samples the acquisitions of the DB mutex, the write
+// queue of WriteThread, the LRU cache shard mutexes and the ZenFS zone and
+// file mutexes in the process, and accumulates their wait and hold times
+// per lock instance and acquire site. For the write queue, which is not a
+// mutex, the wait is the time a writer waits to lead or join a write group
+// and no hold time is recorded.
+//
+// Samples one in sample_one_in of the acquisitions; 0, the default, turns
+// profiling off. A lock not sampled costs a relaxed atomic load, or a
+// thread-local random number while profiling is on.
+extern void SetLockProfilingSampleOneIn(uint32_t sample_one_in);
+
+// Returns the contention per lock instance and acquire site, the most
+// waited on first. The stats of the locks destroyed are kept.
+extern void GetLockContentionStats(std::vector<LockContentionStats>* stats);
+
+// Returns the first max_entries of GetLockContentionStats() as a table
+extern std::string LockContentionStatsToString(size_t max_entries = 20);
+
+extern void ResetLockContentionStats();
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -8,6 +8,7 @@
 #include "rocksdb/status.h"
 
 #include <memory>
+#include <string>
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -34,6 +35,24 @@ class MemoryAllocator {
     // default implementation just returns the allocation size
     return allocation_size;
   }
+
+  // Properties of GetProperty(), which allocators may support:
+  // Bytes of the live allocations
+  static const std::string kAllocatedProperty;
+  // Bytes of the pages holding the live allocations. Its excess over the
+  // allocated bytes is the fragmentation of the allocator.
+  static const std::string kActiveProperty;
+  // Bytes of physical memory held by the allocator
+  static const std::string kResidentProperty;
+  // A one line summary of the above, with the fragmentation ratio
+  static const std::string kStatsProperty;
+
+  // Sets *value to the property, and returns whether the allocator supports
+  // it. The default supports none.
+  virtual bool GetProperty(const std::string& /*property*/,
+                           std::string* /*value*/) const {
+    return false;
+  }
 };
 
 struct JemallocAllocatorOptions {
@@ -51,6 +70,21 @@ struct JemallocAllocatorOptions {
   // Upper bound of allocation size to use tcache, if limit_tcache_size=true.
   // When used with block cache, it is recommneded to set it to block_size.
   size_t tcache_size_upper_bound = 16 * 1024;
+
+  // Number of arenas the allocations are spread over, by the CPU of the
+  // allocating thread. With many threads filling a block cache, e.g.
+  // compactions, reads and decompressions, the tcache misses contend on
+  // the lock of a single arena; setting it to the number of CPUs gives each
+  // CPU its own arena, at the cost of the memory each arena keeps unused.
+  size_t num_arenas = 1;
+
+  // If non-zero, allocations larger than it are rounded up to a multiple of
+  // it. The blocks of a block cache vary slightly in size around block_size,
+  // and fall in several jemalloc size classes whose freed extents do not
+  // serve each other. Rounding them to fewer size classes cuts that extent
+  // fragmentation, for an internal fragmentation below the granularity per
+  // block. When used with block cache, 4KB is a good start.
+  size_t size_class_granularity = 0;
 };
 
 // Generate memory allocators which allocates through Jemalloc and utilize
@@ -60,7 +94,8 @@ struct JemallocAllocatorOptions {
 //
 // Implementation details:
 // The JemallocNodumpAllocator creates a delicated jemalloc arena, and all
-// allocations of the JemallocNodumpAllocator is through the same arena.
+// allocations of the JemallocNodumpAllocator is through the same arena, or
+// through the arena of the current CPU with num_arenas > 1.
 // The memory allocator hooks memory allocation of the arena, and call
 // madvice() with MADV_DONTDUMP flag to exclude the piece of memory from
 // core dump. Side benefit of using single arena would be reduce of jemalloc
@@ -70,6 +105,9 @@ struct JemallocAllocatorOptions {
 // (thread-local cache) is enabled to cache unused allocations for future use.
 // The tcache normally incur 0.5M extra memory usage per-thread. The usage
 // can be reduce by limitting allocation sizes to cache.
+//
+// The allocator supports all MemoryAllocator properties, summed over its
+// arenas, if jemalloc keeps statistics.
 extern Status NewJemallocNodumpAllocator(
     JemallocAllocatorOptions& options,
     std::shared_ptr<MemoryAllocator>* memory_allocator);
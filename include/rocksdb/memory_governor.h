@@ -0,0 +1,106 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// MemoryGovernor owns one memory budget, which it splits between the write
+// buffers of a WriteBufferManager and a block cache, moving memory to the
+// one under pressure.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Cache;
+class Env;
+class Logger;
+class Statistics;
+class WriteBufferManager;
+
+struct MemoryGovernorOptions {
+  // Bytes split between the write buffers and the block cache.
+  size_t total_budget = 0;
+
+  // The cache whose capacity is the block cache share. It should also hold
+  // the other memory to govern, e.g. the index and filter blocks with
+  // BlockBasedTableOptions::cache_index_and_filter_blocks, or the blob
+  // values by sharing it as the blob_cache.
+  std::shared_ptr<Cache> block_cache;
+
+  // An enabled manager, whose buffer size is the write buffer share. When it
+  // costs the memtables to a cache, that cache must be block_cache, whose
+  // capacity then stays total_budget since it holds the memtables too.
+  std::shared_ptr<WriteBufferManager> write_buffer_manager;
+
+  // The write buffer share starts at initial_write_buffer_ratio of the
+  // budget and stays within [min_write_buffer_ratio,
+  // max_write_buffer_ratio] of it. Each rebalance moves at most step_ratio
+  // of the budget.
+  double initial_write_buffer_ratio = 0.25;
+  double min_write_buffer_ratio = 0.05;
+  double max_write_buffer_ratio = 0.5;
+  double step_ratio = 0.05;
+
+  // The write buffers are under pressure when writes stalled since the
+  // last rebalance, or when their usage is above write_pressure_ratio of
+  // their share. The block cache is under pressure when its usage is above
+  // cache_pressure_ratio of its share and its miss ratio since the last
+  // rebalance is above miss_ratio_threshold.
+  double write_pressure_ratio = 0.9;
+  double cache_pressure_ratio = 0.9;
+  double miss_ratio_threshold = 0.1;
+
+  // The statistics of the DBs using the budget, which give the block cache
+  // misses and the write stalls, and get the MEMORY_GOVERNOR_* tickers.
+  // Without them, the pressures are only judged by usage.
+  std::shared_ptr<Statistics> statistics;
+
+  // Seconds between rebalances, run on a thread of the governor. 0 leaves
+  // the calls to Rebalance() to the user.
+  unsigned int rebalance_period_sec = 10;
+
+  Env* env = nullptr;
+  std::shared_ptr<Logger> info_log;
+};
+
+struct MemoryGovernorStats {
+  size_t write_buffer_share = 0;
+  size_t block_cache_share = 0;
+  size_t write_buffer_usage = 0;
+  size_t block_cache_usage = 0;
+  // Miss ratio of the block cache over the last rebalance period
+  double block_cache_miss_ratio = 0.0;
+  uint64_t rebalances = 0;
+  uint64_t moves_to_write_buffer = 0;
+  uint64_t moves_to_block_cache = 0;
+};
+
+// All MemoryGovernor public functions are thread-safe.
+class MemoryGovernor {
+ public:
+  virtual ~MemoryGovernor() {}
+
+  // Compares the pressures on the write buffers and the block cache since
+  // the last call, and moves up to step_ratio of the budget to the one
+  // under pressure, if the other is not.
+  virtual void Rebalance() = 0;
+
+  // Changes the budget, keeping the ratio of the write buffer share.
+  virtual void SetTotalBudget(size_t total_budget) = 0;
+
+  virtual void GetStats(MemoryGovernorStats* stats) const = 0;
+};
+
+// Returns nullptr if the options lack a budget, a block cache or an enabled
+// write buffer manager, or if the ratios are out of order. Applies the
+// initial shares, and starts the rebalance thread if
+// rebalance_period_sec > 0.
+extern MemoryGovernor* NewMemoryGovernor(const MemoryGovernorOptions& options);
+
+}  // namespace ROCKSDB_NAMESPACE
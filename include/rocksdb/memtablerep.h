@@ -40,6 +40,7 @@
 #include <stdlib.h>
 #include <memory>
 #include <stdexcept>
+#include <unordered_set>
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -157,6 +158,29 @@ class MemTableRep {
     return true;
   }
 
+  // Inserts handles[0, n) as if by InsertKey(). The order of the keys in
+  // handles is unspecified, so a rep may sort them and reuse its search
+  // state from one key to the next; handles may be reordered.
+  // Returns false if MemTableRepFactory::CanHandleDuplicatedKey() is true and
+  // any <key, seq> already exists. The other keys are still inserted.
+  virtual bool InsertKeys(KeyHandle* handles, size_t n) {
+    bool res = true;
+    for (size_t i = 0; i < n; i++) {
+      res = InsertKey(handles[i]) && res;
+    }
+    return res;
+  }
+
+  // Same as ::InsertKeys, but allow concurrent writes like
+  // InsertKeyConcurrently()
+  virtual bool InsertKeysConcurrently(KeyHandle* handles, size_t n) {
+    bool res = true;
+    for (size_t i = 0; i < n; i++) {
+      res = InsertKeyConcurrently(handles[i]) && res;
+    }
+    return res;
+  }
+
   // Returns true iff an entry that compares equal to key is in the collection.
   virtual bool Contains(const char* key) const = 0;
 
@@ -189,11 +213,33 @@ class MemTableRep {
   virtual void Get(const LookupKey& k, void* callback_args,
                    bool (*callback_func)(void* arg, const char* entry));
 
+  // Get() of each of the num_keys keys, with callback_args[i] for keys[i].
+  // The callbacks of a key are called one after the other, but the lookups
+  // of the keys may interleave, to overlap their cache misses.
+  //
+  // Default: Get() of each key in turn.
+  virtual void MultiGet(size_t num_keys, const LookupKey* const* keys,
+                        void* const* callback_args,
+                        bool (*callback_func)(void* arg, const char* entry));
+
   virtual uint64_t ApproximateNumEntries(const Slice& /*start_ikey*/,
                                          const Slice& /*end_key*/) {
     return 0;
   }
 
+  // Replaces *entries with about target_sample_size distinct entries picked
+  // at random among the num_entries of the memtable, e.g. to split its key
+  // space into ranges of similar sizes. The sample may be somewhat smaller
+  // or larger than asked for.
+  //
+  // Default: leaves *entries empty, the representation not supporting
+  // sampling
+  virtual void UniqueRandomSample(uint64_t /*num_entries*/,
+                                  uint64_t /*target_sample_size*/,
+                                  std::unordered_set<const char*>* entries) {
+    entries->clear();
+  }
+
   // Report an approximation of how much memory has been used other than memory
   // that was allocated through the allocator.  Safe to call from any thread.
   virtual size_t ApproximateMemoryUsage() = 0;
@@ -308,9 +354,17 @@ class MemTableRepFactory {
 //     search from the previously visited record (doing at most 'lookahead'
 //     steps). This is an optimization for the access pattern including many
 //     seeks with consecutive keys.
+//   prefix_index_buckets: If non-zero, and with a prefix extractor, the
+//     first key of each prefix is kept in a hash table of this many
+//     buckets, for a prefix seek to the start of a prefix to go straight to
+//     it instead of searching the list. Only prefix seeks use it, not the
+//     total order ones. Should be at least the number of prefixes in a
+//     memtable, for few of them to collide.
 class SkipListFactory : public MemTableRepFactory {
  public:
-  explicit SkipListFactory(size_t lookahead = 0) : lookahead_(lookahead) {}
+  explicit SkipListFactory(size_t lookahead = 0,
+                           size_t prefix_index_buckets = 0)
+      : lookahead_(lookahead), prefix_index_buckets_(prefix_index_buckets) {}
 
   using MemTableRepFactory::CreateMemTableRep;
   virtual MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&,
@@ -324,6 +378,7 @@ class SkipListFactory : public MemTableRepFactory {
 
  private:
   const size_t lookahead_;
+  const size_t prefix_index_buckets_;
 };
 
 #ifndef ROCKSDB_LITE
@@ -349,6 +404,24 @@ class VectorRepFactory : public MemTableRepFactory {
   virtual const char* Name() const override { return "VectorRepFactory"; }
 };
 
+// This creates MemTableReps that are backed by a B+tree. Like the skip list,
+// it supports concurrent inserts and lock-free reads, but a lookup visits a
+// few nodes of several keys each instead of one node per level, which makes
+// inserts and point lookups more cache friendly. Iterators copy a leaf at a
+// time. Prefix extractors and insert hints are ignored.
+class BTreeRepFactory : public MemTableRepFactory {
+ public:
+  using MemTableRepFactory::CreateMemTableRep;
+  virtual MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&,
+                                         Allocator*, const SliceTransform*,
+                                         Logger* logger) override;
+  virtual const char* Name() const override { return "BTreeRepFactory"; }
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+};
+
 // This class contains a fixed array of buckets, each
 // pointing to a skiplist (null if the bucket is empty).
 // bucket_count: number of fixed array buckets
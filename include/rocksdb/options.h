@@ -43,6 +43,7 @@ class ConcurrentTaskLimiter;
 class Env;
 enum InfoLogLevel : unsigned char;
 class SstFileManager;
+class SpanTracer;
 class FilterPolicy;
 class Logger;
 class MergeOperator;
@@ -351,6 +352,45 @@ struct DbPath {
 
 static const std::string kHostnameForDbHostId = "__hostname__";
 
+enum class CompactionServiceJobStatus : char {
+  kSuccess,
+  kFailure,
+  // The service does not run the job; the DB runs it itself instead
+  kUseLocal,
+};
+
+// CompactionService runs the compactions of a DB somewhere else, e.g. on
+// another host that can read and write the DB's files. The DB hands each
+// compaction job to Start() as a serialized input and then waits for its
+// serialized result with WaitForComplete(). The worker runs the job with
+// DB::OpenAndCompact(), which writes the output files into a directory of
+// its own; the DB then moves them into the DB and installs them.
+//
+// A compaction with several subcompactions starts one job per
+// subcompaction, from several threads. job_id is unique among the jobs of
+// the DB in flight.
+//
+// Exceptions MUST NOT propagate out of overridden functions into RocksDB,
+// because RocksDB is not exception-safe. This could cause undefined behavior
+// including data loss, unreported corruption, deadlocks, and more.
+class CompactionService {
+ public:
+  virtual ~CompactionService() {}
+
+  // Returns the name of this compaction service.
+  virtual const char* Name() const = 0;
+
+  // Starts the compaction job described by compaction_service_input, which
+  // is to be passed to DB::OpenAndCompact().
+  virtual CompactionServiceJobStatus Start(
+      const std::string& compaction_service_input, uint64_t job_id) = 0;
+
+  // Waits for the job to finish and returns the result that
+  // DB::OpenAndCompact() produced for it in compaction_service_result.
+  virtual CompactionServiceJobStatus WaitForComplete(
+      uint64_t job_id, std::string* compaction_service_result) = 0;
+};
+
 struct DBOptions {
   // The function recovers options to the option as in version 4.6.
   DBOptions* OldDefaults(int rocksdb_major_version = 4,
@@ -461,9 +501,87 @@ struct DBOptions {
 
   // If max_open_files is -1, DB will open all files on DB::Open(). You can
   // use this option to increase the number of threads used to open the files.
+  // RepairDB() scans the table files, and converts the WAL files, with this
+  // many threads as well.
   // Default: 16
   int max_file_opening_threads = 16;
 
+  // If true, DB::Open() does not open the table files, which are opened on
+  // their first access instead. If max_open_files is -1, the files are then
+  // opened in the background after DB::Open(), the files of L0 first and
+  // of the last level last, by up to max_file_opening_threads threads.
+  // "rocksdb.num-table-files-pending-open" tells how many are left. Errors
+  // of the files, even with paranoid_checks, surface on their first read
+  // and are logged by the background opening, instead of failing
+  // DB::Open().
+  //
+  // The table readers opened this way stay in the table cache, but are not
+  // pinned to the file metadata as the ones opened by DB::Open() are: each
+  // read looks them up in the table cache, FIFO compaction ttl only
+  // expires the files written since DB::Open(), and
+  // GetCreationTimeOfOldestFile() is not supported. Read-only and secondary
+  // instances ignore this option.
+  //
+  // Default: false
+  bool lazy_open_table_files = false;
+
+  // If non-zero, DB close saves the metadata of the open table files, up to
+  // this many bytes, for the next DB::Open() to open them with instead of
+  // reading their footers, properties, index and filter blocks again. The
+  // metadata of a block-based table is the part of the file read to open
+  // it, saved in the TABLE_METADATA file of the DB directory, which the
+  // next DB::Open() reads and deletes. The files of L0 are saved first and
+  // those of the last level last.
+  //
+  // Saving reads the metadata from the files again at close.
+  //
+  // Default: 0 (disabled)
+  uint64_t max_table_metadata_checkpoint_size = 0;
+
+  // If non-zero, the data blocks read through the block cache are recorded,
+  // and the most recently read ones, up to max_block_cache_warmup_size
+  // bytes, are saved to the BLOCK_CACHE_WARMUP file of the DB directory
+  // every this many seconds and at close. DB::Open() then reads the blocks
+  // saved back into the block cache in the background, while serving, in
+  // batches of sorted reads per file at low I/O priority, through
+  // rate_limiter if set. The blocks of the files deleted since are skipped.
+  //
+  // Default: 0 (disabled)
+  unsigned int block_cache_warmup_save_period_sec = 0;
+
+  // The most bytes of data blocks saved for warming the block cache up, see
+  // block_cache_warmup_save_period_sec. About the block cache capacity is a
+  // good value. Half as many bytes of blocks are recorded in memory at most.
+  //
+  // Default: 1GB
+  uint64_t max_block_cache_warmup_size = 1 << 30;
+
+  // If non-zero, an options advisor samples the write stalls of the column
+  // families, and the block cache and ZenFS tickers of statistics (ZenFS
+  // reports to the Statistics it is given, which should be this one), every
+  // this many seconds. It recommends changes to
+  // level0_slowdown_writes_trigger, max_bytes_for_level_base,
+  // max_background_jobs and the block cache capacity, each logged as an
+  // "options_advisor" event to the info log.
+  //
+  // Default: 0 (disabled)
+  unsigned int options_advisor_period_sec = 0;
+
+  // Whether the options advisor applies its recommendations, through
+  // SetOptions(), SetDBOptions() and Cache::SetCapacity(), rather than only
+  // logging them. A change is rolled back when the signal it was made for
+  // got worse over the next period, and the option is then left alone for
+  // a while.
+  //
+  // Default: false
+  bool options_advisor_apply_changes = false;
+
+  // The options advisor keeps each option within this factor of its value
+  // when first sampled, in both directions. Must be at least 1.
+  //
+  // Default: 4.0
+  double options_advisor_max_change_factor = 4.0;
+
   // Once write-ahead logs exceed this size, we will start forcing the flush of
   // column families whose memtables are backed by the oldest live WAL file
   // (i.e. the ones that are causing all the space amplification). If set to 0
@@ -580,6 +698,16 @@ struct DBOptions {
   // Dynamically changeable through SetDBOptions() API.
   uint32_t max_subcompactions = 1;
 
+  // If true, each (sub)compaction runs as a pipeline: its input blocks are
+  // read ahead asynchronously, the input is merged on a thread of its own, and
+  // the output files are built and written on the compaction thread, so that
+  // reading, merging and writing overlap. Read-ahead also requires
+  // compaction_readahead_size > 0. Compactions whose input contains range
+  // deletions are not pipelined.
+  //
+  // Default: false
+  bool enable_pipelined_compaction = false;
+
   // NOT SUPPORTED ANYMORE: RocksDB automatically decides this based on the
   // value of max_background_jobs. For backwards compatibility we will set
   // `max_background_jobs = max_background_compactions + max_background_flushes`
@@ -690,6 +818,15 @@ struct DBOptions {
   // Not supported in ROCKSDB_LITE mode!
   bool use_direct_io_for_flush_and_compaction = false;
 
+  // If true, background flush and compaction write their output files from
+  // two buffers of writable_file_max_buffer_size: when one fills, it is
+  // written asynchronously while the other is filled, and the writes are
+  // only waited for on Sync() and Close(). The file system must implement
+  // FSWritableFile::AppendAsync(), or the writes stay synchronous. Ignored
+  // with use_direct_io_for_flush_and_compaction.
+  // Default: false
+  bool async_table_file_flush = false;
+
   // If false, fallocate() calls are bypassed
   bool allow_fallocate = true;
 
@@ -923,6 +1060,32 @@ struct DBOptions {
   // Default: false
   bool enable_pipelined_write = false;
 
+  // Number of WAL files written concurrently when enable_pipelined_write is
+  // true. With more than one stream, a WAL write group hands the WAL stage to
+  // the next group before it appends and each group appends to the next
+  // stream in turn, so groups on different streams do their WAL I/O in
+  // parallel instead of waiting for the single log file. Groups still enter
+  // the memtable stage and are acknowledged in sequence order, and a synced
+  // write syncs every stream of the current log. Recovery replays the
+  // batches of all streams in sequence order and drops batches past a gap in
+  // the sequence, which can only be left by writes that were never synced.
+  //
+  // Requires enable_pipelined_write, and is incompatible with
+  // manual_wal_flush, recycle_log_file_num, allow_2pc and GetUpdatesSince().
+  // A DB written with more than one stream must not be reopened with a
+  // single stream before its WAL files are obsolete.
+  //
+  // Default: 1
+  size_t wal_streams = 1;
+
+  // Maximum number of threads the DB starts to run DB::WriteAsync() requests.
+  // They are started on the first requests and kept until the DB is closed.
+  // Each runs one write at a time, so this bounds how many async writes join
+  // a write group together.
+  //
+  // Default: 2
+  int max_async_write_threads = 2;
+
   // Setting unordered_write to true trades higher write throughput with
   // relaxing the immutability guarantee of snapshots. This violates the
   // repeatability one expects from ::Get from a snapshot, as well as
@@ -1024,6 +1187,27 @@ struct DBOptions {
   // Not supported in ROCKSDB_LITE mode!
   std::shared_ptr<Cache> row_cache = nullptr;
 
+  // If true, the row cache also keeps the lookups of keys that a table file
+  // does not contain, so that looking such a key up again in the file, e.g.
+  // a key absent from the DB but passing the bloom filter, does not read the
+  // index and data blocks again. Entries are keyed by file number, so they
+  // go unused once the file is deleted. The lookups in files with range
+  // deletions are not kept.
+  // Default: false
+  bool row_cache_negative_entries = false;
+
+  // If >= 0, the memory of a memtable is migrated to this NUMA node when the
+  // memtable becomes immutable, keeping the active memtables in local DRAM
+  // while those waiting for flush, or kept after it with
+  // max_write_buffer_size_to_maintain, live on a larger and slower tier, e.g.
+  // CXL or persistent memory exposed as a memory-only node by the DAX KMEM
+  // driver. The migration is done by the thread switching the memtable,
+  // without the DB mutex held. Only supported on Linux; elsewhere the
+  // memtables stay where they are.
+  // See the IMMUTABLE_MEMTABLE_BYTES_MIGRATED ticker.
+  // Default: -1
+  int immutable_memtable_numa_node = -1;
+
 #ifndef ROCKSDB_LITE
   // A filter object supplied to be invoked while processing write-ahead-logs
   // (WALs) during recovery. The filter provides a way to inspect log
@@ -1099,6 +1283,15 @@ struct DBOptions {
   // file.
   bool manual_wal_flush = false;
 
+  // Compresses the records written to the WAL. The compression context is
+  // kept for the life of a log file, but every record is compressed on its
+  // own so that all WALRecoveryMode values keep working. Only kZSTD is
+  // supported, older versions cannot read WAL files written with
+  // compression.
+  //
+  // Default: kNoCompression
+  CompressionType wal_compression = kNoCompression;
+
   // If true, RocksDB supports flushing multiple column families and committing
   // their results atomically to MANIFEST. Note that it is not
   // necessary to set atomic_flush to true if WAL is always enabled since WAL
@@ -1139,6 +1332,17 @@ struct DBOptions {
   // Default: 0
   size_t log_readahead_size = 0;
 
+  // The number of threads replaying the WAL files in DB::Open(). With more
+  // than one, a thread reads and checksums each WAL ahead of the replay, and
+  // the batches read are inserted into the memtables by up to this many
+  // threads at once. Concurrent inserts need allow_concurrent_memtable_write
+  // and are not used with allow_2pc, wal_streams > 1, transaction DBs that
+  // write prepared data, or max_successive_merges > 0. If a batch fails to
+  // be inserted, the batches inserted along with it stay in the memtables.
+  //
+  // Default: 1
+  int wal_recovery_threads = 1;
+
   // If user does NOT provide the checksum generator factory, the file checksum
   // will NOT be used. A new file checksum generator object will be created
   // when a SST file is created. Therefore, each created FileChecksumGenerator
@@ -1196,6 +1400,20 @@ struct DBOptions {
   //
   // Default: hostname
   std::string db_host_id = kHostnameForDbHostId;
+
+  // If set, compactions are run by this service instead of on the DB's
+  // background threads, see CompactionService. Compactions that write blob
+  // files are still run by the DB. Not supported in ROCKSDB_LITE.
+  //
+  // Default: nullptr
+  std::shared_ptr<CompactionService> compaction_service = nullptr;
+
+  // If set, the reads and writes with a trace id in their ReadOptions or
+  // WriteOptions record the time spent in each of their steps in the
+  // tracer, if it samples them. See SpanTracer.
+  //
+  // Default: nullptr
+  std::shared_ptr<SpanTracer> span_tracer = nullptr;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1426,6 +1644,57 @@ struct ReadOptions {
   // Default: std::numeric_limits<uint64_t>::max()
   uint64_t value_size_soft_limit;
 
+  // If true, the readahead of iterators over block based tables is done in
+  // the background: while the iterator consumes the prefetched data, the
+  // next readahead window is read with FSRandomAccessFile::ReadAsync(), so
+  // I/O overlaps with processing instead of alternating with it. This
+  // applies to auto-readahead as well as to readahead_size, but not to
+  // compaction reads. File systems without native support for ReadAsync()
+  // fall back to synchronous reads.
+  // Default: false
+  bool async_io;
+
+  // If true, MultiGet looks up the keys of a batch that fall in different
+  // SST files of the same level (other than L0) in parallel, so the reads of
+  // those files overlap instead of adding up. The lookups run on the Env's
+  // USER priority thread pool, which has no threads unless they are added
+  // with Env::SetBackgroundThreads(n, Env::Priority::USER); without them,
+  // or for column families with a merge operator, the files are looked up
+  // one after the other.
+  // Default: false
+  bool optimize_multiget_for_io;
+
+  // If non-zero and DBOptions::span_tracer samples it, Get and MultiGet
+  // record the time spent in each of their steps, e.g. memtable lookups,
+  // filter and index reads, block cache misses and file reads, as spans
+  // with this id. Requests of one end-to-end operation can share an id.
+  // Default: 0
+  uint64_t trace_id;
+
+  // If true, the memory blocks of the arena of an iterator, and the buffer
+  // Get() encodes a key of more than about 200 bytes into, are taken from a
+  // small pool of blocks kept by each thread, and given back to it once the
+  // iterator is destroyed or Get() returns, instead of being allocated and
+  // freed every time. Worth it for workloads creating many short-lived
+  // iterators. Each thread keeps up to 64KB in its pool until it exits.
+  // See PerfContext::arena_block_recycle_hit_count.
+  // Default: false
+  bool recycle_arena_blocks;
+
+  // If true and snapshot is nullptr, the iterator is not destroyed when
+  // deleted but kept in a pool of the deleting thread, and the next
+  // NewIterator() of that thread on the same column family with the same
+  // options takes it back, refreshed to the latest sequence number. When
+  // the super version of the column family did not change in between, and
+  // its memtable has no range deletions, that only costs a re-seek;
+  // otherwise the iterator is rebuilt. Each thread keeps up to 4
+  // iterators, which pin their super version, i.e. memtables and table
+  // files, until taken back, evicted or the DB is closed. Only for DBs
+  // opened with DB::Open(), without transactions.
+  // See PerfContext::iterator_recycle_hit_count.
+  // Default: false
+  bool recycle_iterator;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
@@ -1498,6 +1767,12 @@ struct WriteOptions {
   // and the API is subject to change.
   const Slice* timestamp;
 
+  // If non-zero and DBOptions::span_tracer samples it, the write records the
+  // time spent in each of its steps as spans with this id. See
+  // ReadOptions::trace_id.
+  // Default: 0
+  uint64_t trace_id;
+
   WriteOptions()
       : sync(false),
         disableWAL(false),
@@ -1505,7 +1780,8 @@ struct WriteOptions {
         no_slowdown(false),
         low_pri(false),
         memtable_insert_hint_per_batch(false),
-        timestamp(nullptr) {}
+        timestamp(nullptr),
+        trace_id(0) {}
 };
 
 // Options that control flush operations
@@ -1593,6 +1869,14 @@ struct IngestExternalFileOptions {
   bool move_files = false;
   // If set to true, ingestion falls back to copy when move fails.
   bool failed_move_fall_back_to_copy = true;
+  // If set to true together with move_files, a file that cannot be hard
+  // linked into the DB because the file system does not support links, e.g.
+  // ZenFS, is renamed into the DB instead of being copied. The file is no
+  // longer at its original path afterwards, unless the ingestion fails, in
+  // which case it is renamed back. The file is not synced again, so it must
+  // have been synced before, as SstFileWriter::Finish() does. Takes precedence
+  // over failed_move_fall_back_to_copy.
+  bool failed_move_fall_back_to_rename = false;
   // If set to false, an ingested file keys could appear in existing snapshots
   // that where created before the file was ingested.
   bool snapshot_consistency = true;
@@ -1703,4 +1987,52 @@ struct SizeApproximationOptions {
   double files_size_error_margin = -1.0;
 };
 
+// Options used with DB::VerifyChecksum()
+struct VerifyChecksumOptions {
+  // Files are verified on up to this many threads, the calling thread
+  // included, each file by one thread.
+  int max_threads = 1;
+
+  // Readahead of the sequential reads of each file. 0 keeps
+  // ReadOptions::readahead_size for the table files, and the default
+  // readahead for the others.
+  size_t readahead_size = 4 << 20;
+
+  // If set, the reads of all threads take tokens from it, with IO_LOW
+  // priority. It only limits reads if created with RateLimiter::Mode
+  // kReadsOnly or kAllIo, and may be shared, e.g. between the verifications
+  // of several DBs.
+  std::shared_ptr<RateLimiter> rate_limiter = nullptr;
+
+  // Also verifies the blob files of the column families, reading every
+  // record and checking its CRCs.
+  bool verify_blob_files = false;
+
+  // Also recomputes the full file checksums of the table files, and of the
+  // blob files with verify_blob_files, and compares them with the ones
+  // recorded in the MANIFEST. Requires DBOptions::file_checksum_gen_factory.
+  // Files with no recorded checksum, e.g. written before the factory was
+  // set, are skipped. This reads each file once more.
+  bool verify_file_checksums = false;
+};
+
+// The options of the DB and column family that DB::OpenAndCompact() cannot
+// get from the compaction input, because they are objects rather than
+// values. They must match the ones the DB was opened with. The column family
+// options, the comparator in particular, are also used for the default
+// column family.
+struct CompactionServiceOptionsOverride {
+  Env* env = Env::Default();
+  std::shared_ptr<FileChecksumGenFactory> file_checksum_gen_factory = nullptr;
+
+  const Comparator* comparator = BytewiseComparator();
+  std::shared_ptr<MergeOperator> merge_operator = nullptr;
+  const CompactionFilter* compaction_filter = nullptr;
+  std::shared_ptr<CompactionFilterFactory> compaction_filter_factory = nullptr;
+  std::shared_ptr<const SliceTransform> prefix_extractor = nullptr;
+  // If unset, the table factory is configured from the compaction input
+  std::shared_ptr<TableFactory> table_factory = nullptr;
+  std::shared_ptr<SstPartitionerFactory> sst_partitioner_factory = nullptr;
+};
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,84 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/options.h"
+#include "rocksdb/sst_file_writer.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class DB;
+
+// ParallelSstFileWriter builds the sst files of a bulk load on several
+// threads, to be added to the database together with Ingest().
+//
+// The entries come as a sorted stream, through Put(), Merge() and Delete(),
+// which is cut into files of about target_file_size bytes that are built
+// concurrently, and/or as pre-partitioned key ranges, through AddPartition(),
+// each of which is built into a file of its own. The key ranges of the
+// partitions and of the stream must not overlap, so that the files can be
+// ingested at once.
+//
+// Each file is built by a SstFileWriter with the given options, so e.g.
+// `CompressionOptions::parallel_threads` also applies within a file.
+//
+// The methods must be called from a single thread.
+class ParallelSstFileWriter {
+ public:
+  // The files are named <file_prefix><number>.sst. User can pass
+  // `column_family` to specify that the files will be ingested into this
+  // column_family, see SstFileWriter.
+  ParallelSstFileWriter(const EnvOptions& env_options, const Options& options,
+                        const std::string& file_prefix, int num_threads,
+                        uint64_t target_file_size = 64 << 20,
+                        ColumnFamilyHandle* column_family = nullptr);
+
+  // Waits for the files being built. Unless Finish() succeeded, the files
+  // built are deleted.
+  ~ParallelSstFileWriter();
+
+  // Add a Put key with value to the stream
+  // REQUIRES: key is after any previously added key according to comparator.
+  Status Put(const Slice& user_key, const Slice& value);
+
+  // Add a Merge key with value to the stream
+  // REQUIRES: key is after any previously added key according to comparator.
+  Status Merge(const Slice& user_key, const Slice& value);
+
+  // Add a deletion key to the stream
+  // REQUIRES: key is after any previously added key according to comparator.
+  Status Delete(const Slice& user_key);
+
+  // Adds a key range to be built into a file of its own: fill is called on
+  // a build thread with a SstFileWriter opened on the file, to which it adds
+  // the entries of the range in order. The range must not be empty.
+  Status AddPartition(std::function<Status(SstFileWriter*)> fill);
+
+  // Waits for all the files to be built. If file_infos is not nullptr, it is
+  // set to the information about the files, sorted by smallest key.
+  Status Finish(std::vector<ExternalSstFileInfo>* file_infos = nullptr);
+
+  // Ingests the files built by a successful Finish() into db with a single
+  // IngestExternalFile() call, which adds them atomically with one global
+  // sequence number.
+  Status Ingest(DB* db, const IngestExternalFileOptions& ingest_options);
+
+ private:
+  struct Rep;
+  std::unique_ptr<Rep> rep_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !ROCKSDB_LITE
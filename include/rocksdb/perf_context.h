@@ -221,6 +221,25 @@ struct PerfContext {
   uint64_t iter_prev_cpu_nanos;
   uint64_t iter_seek_cpu_nanos;
 
+  // Number of arena blocks taken from the pool of the thread, and allocated
+  // because it was empty, with ReadOptions::recycle_arena_blocks
+  uint64_t arena_block_recycle_hit_count;
+  uint64_t arena_block_recycle_miss_count;
+
+  // Number of iterators taken back from the pool of the thread, and created
+  // because none matched, with ReadOptions::recycle_iterator
+  uint64_t iterator_recycle_hit_count;
+  uint64_t iterator_recycle_miss_count;
+
+  // Number of table files iterators did not open, or moved on from without
+  // opening the next one, as they are out of iterate_lower_bound and
+  // iterate_upper_bound
+  uint64_t iter_bound_pruned_file_count;
+
+  // Number of table files reads with ReadOptions::timestamp skipped, as all
+  // their keys are newer than it
+  uint64_t timestamp_pruned_file_count;
+
   // Time spent in encrypting data. Populated when EncryptedEnv is used.
   uint64_t encrypt_data_nanos;
   // Time spent in decrypting data. Populated when EncryptedEnv is used.
@@ -70,4 +70,14 @@ Status NewPersistentCache(Env* const env, const std::string& path,
                           const std::shared_ptr<Logger>& log,
                           const bool optimized_for_nvm,
                           std::shared_ptr<PersistentCache>* cache);
+
+// Factory method to create a new persistent cache for zoned block devices,
+// such as a ZenFS file system. The cache is written sequentially as a log
+// of segments of zone_size bytes, set to the zone capacity for each to fill
+// a zone, and evicted a segment at a time, the least recently read first.
+Status NewZonedPersistentCache(Env* const env, const std::string& path,
+                               const uint64_t size,
+                               const std::shared_ptr<Logger>& log,
+                               const uint32_t zone_size,
+                               std::shared_ptr<PersistentCache>* cache);
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,106 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#include "rocksdb/compression_type.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class MemoryAllocator;
+class PersistentCache;
+class Statistics;
+
+// SecondaryCache
+//
+// A second tier below an in-memory Cache. Entries evicted from the primary
+// cache are handed to the secondary cache in a flat form, and a later lookup
+// that misses the primary cache can rebuild the entry from the secondary
+// cache instead of reading and decompressing it from storage again. See
+// LRUCacheOptions::secondary_cache and Cache::CacheItemHelper.
+class SecondaryCache {
+ public:
+  virtual ~SecondaryCache() {}
+
+  virtual const char* Name() const = 0;
+
+  // Stores a copy of value under key. Called on the eviction path of the
+  // primary cache, so implementations should not block; they may do the
+  // actual work in the background or drop the entry.
+  virtual Status Insert(const Slice& key, const Slice& value) = 0;
+
+  // If the cache has an entry for key, stores its value in *value and returns
+  // OK. Returns NotFound otherwise.
+  virtual Status Lookup(const Slice& key, std::string* value) = 0;
+
+  // Drops the entry for key, if any. Called once the entry has been promoted
+  // back into the primary cache.
+  virtual void Erase(const Slice& key) = 0;
+
+  virtual std::string GetPrintableOptions() const { return ""; }
+};
+
+struct CompressedSecondaryCacheOptions {
+  // Bytes of compressed entries to keep in memory. Ignored when
+  // persistent_cache is set.
+  size_t capacity = 0;
+
+  // Shard bits of the in-memory LRU cache holding the entries. -1 picks a
+  // value from capacity like NewLRUCache does.
+  int num_shard_bits = -1;
+
+  // If set, entries are stored in this persistent cache (for example the
+  // BlockCacheTier returned by NewPersistentCache on a local NVMe or pmem
+  // device) instead of in memory. The persistent cache must not outlive the
+  // keys it was given, which holds for NewPersistentCache as it starts empty.
+  std::shared_ptr<PersistentCache> persistent_cache;
+
+  // Compression applied to entries before they are stored. Entries that do
+  // not compress are stored as is.
+  CompressionType compression_type = kLZ4Compression;
+
+  // Entries are compressed and stored by a background thread. Inserts that
+  // would grow the backlog of that thread past this many bytes are dropped.
+  size_t max_pending_bytes = 64 << 20;
+};
+
+// Creates a secondary cache that keeps entries compressed, either in memory
+// or in a persistent cache. Returns nullptr if the compression type is not
+// supported in this build.
+extern std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts);
+
+struct SlowMemorySecondaryCacheOptions {
+  // Bytes of entries to keep.
+  size_t capacity = 0;
+
+  // Shard bits of the LRU cache holding the entries. -1 picks a value from
+  // capacity like NewLRUCache does.
+  int num_shard_bits = -1;
+
+  // Allocates the memory of the entries, e.g. a MemkindKmemAllocator to keep
+  // them on CXL or persistent memory exposed as system memory by the DAX
+  // KMEM driver. If null, they are allocated with new[].
+  std::shared_ptr<MemoryAllocator> memory_allocator;
+
+  // If set, gets the SLOW_MEMORY_CACHE_* tickers.
+  std::shared_ptr<Statistics> statistics;
+};
+
+// Creates a secondary cache that extends a DRAM block cache with a larger,
+// slower and cheaper memory tier. Used as LRUCacheOptions::secondary_cache,
+// the blocks evicted from the low priority end of the LRU list are copied
+// to the slow tier, and promoted back to DRAM by the next lookup missing
+// the primary cache.
+extern std::shared_ptr<SecondaryCache> NewSlowMemorySecondaryCache(
+    const SlowMemorySecondaryCacheOptions& opts);
+
+}  // namespace ROCKSDB_NAMESPACE
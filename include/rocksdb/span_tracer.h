@@ -0,0 +1,75 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A timed step of a traced request, e.g. a block read of a Get
+struct SpanEvent {
+  // The trace id of the request, from ReadOptions or WriteOptions
+  uint64_t trace_id = 0;
+  // The operation ("Get", "MultiGet", "Write") for the span covering the
+  // whole request, otherwise the PerfContext or IOStatsContext metric the
+  // step is timed into, e.g. "block_read_time" or "read_nanos". Points to a
+  // string literal.
+  const char* name = nullptr;
+  // The start time and the duration in nanoseconds, from Env::NowNanos()
+  uint64_t start_nanos = 0;
+  uint64_t duration_nanos = 0;
+  // The thread which ran the step, from Env::GetThreadID()
+  uint64_t thread_id = 0;
+};
+
+struct SpanTracerOptions {
+  // The number of spans kept. Once the buffer is full, new spans overwrite
+  // the oldest ones.
+  size_t capacity = 64 * 1024;
+
+  // Traces one in sample_one_in of the requests with a trace id, those with
+  // trace_id % sample_one_in == 0, so that all the requests sharing an id
+  // are sampled together. 1 traces every request with a trace id.
+  uint64_t sample_one_in = 1;
+};
+
+// SpanTracer records the time a DB spends in each step of sampled requests,
+// for requests with a non-zero trace id in their ReadOptions or WriteOptions
+// (see DBOptions::span_tracer). The steps are timed where PerfContext and
+// IOStatsContext time them, whatever the PerfLevel of the thread, and
+// recorded in a lock-free ring buffer, so tracing one request does not slow
+// down the others.
+class SpanTracer {
+ public:
+  virtual ~SpanTracer() {}
+
+  // Whether to trace the request with the id
+  virtual bool ShouldSample(uint64_t trace_id) const = 0;
+
+  // Records a span. Thread-safe.
+  virtual void Record(const SpanEvent& event) = 0;
+
+  // Returns the spans kept in the buffer, oldest first. Spans being
+  // overwritten while this runs are left out. Thread-safe.
+  virtual void GetSpans(std::vector<SpanEvent>* spans) const = 0;
+
+  // Writes the spans kept in the buffer in the Chrome trace event format
+  // (JSON, viewable in chrome://tracing or Perfetto), with the trace id of
+  // each span in its args. Thread-safe.
+  virtual Status ExportChromeTrace(std::string* output) const = 0;
+};
+
+// Returns a SpanTracer with a ring buffer of options.capacity spans
+extern std::shared_ptr<SpanTracer> NewSpanTracer(
+    const SpanTracerOptions& options = SpanTracerOptions());
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -85,14 +85,19 @@ class SstFileWriter {
   // If invalidate_page_cache is set to true, SstFileWriter will give the OS a
   // hint that this file pages is not needed every time we write 1MB to the
   // file. To use the rate limiter an io_priority smaller than IO_TOTAL can be
-  // passed.
+  // passed. write_hint is passed to the file system for the placement of the
+  // file, e.g. the hint of the level the file is to be ingested into when
+  // it is written to ZenFS and moved into the DB by
+  // IngestExternalFileOptions::failed_move_fall_back_to_rename.
   SstFileWriter(const EnvOptions& env_options, const Options& options,
                 ColumnFamilyHandle* column_family = nullptr,
                 bool invalidate_page_cache = true,
                 Env::IOPriority io_priority = Env::IOPriority::IO_TOTAL,
-                bool skip_filters = false)
+                bool skip_filters = false,
+                Env::WriteLifeTimeHint write_hint = Env::WLTH_NOT_SET)
       : SstFileWriter(env_options, options, options.comparator, column_family,
-                      invalidate_page_cache, io_priority, skip_filters) {}
+                      invalidate_page_cache, io_priority, skip_filters,
+                      write_hint) {}
 
   // Deprecated API
   SstFileWriter(const EnvOptions& env_options, const Options& options,
@@ -100,7 +105,8 @@ class SstFileWriter {
                 ColumnFamilyHandle* column_family = nullptr,
                 bool invalidate_page_cache = true,
                 Env::IOPriority io_priority = Env::IOPriority::IO_TOTAL,
-                bool skip_filters = false);
+                bool skip_filters = false,
+                Env::WriteLifeTimeHint write_hint = Env::WLTH_NOT_SET);
 
   ~SstFileWriter();
 
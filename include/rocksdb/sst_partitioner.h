@@ -14,6 +14,7 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class FileSystem;
 class Slice;
 
 enum PartitionerResult : char {
@@ -132,4 +133,67 @@ class SstPartitionerFixedPrefixFactory : public SstPartitionerFactory {
 extern std::shared_ptr<SstPartitionerFactory>
 NewSstPartitionerFixedPrefixFactory(size_t prefix_len);
 
+/*
+ * Zone capacity partitioner. On a zoned FileSystem it splits the output SST
+ * files so that they fill the remaining capacity of the zone they are expected
+ * to be placed in (FileSystem::GetZoneCapacity()), and then whole empty zones,
+ * instead of straddling zone boundaries. reserve_pct percent of each zone is
+ * left for the index, filter and footer written after the last key. Files
+ * still end at the target file size when that comes first. It never splits on
+ * a FileSystem that is not zoned.
+ */
+class SstPartitionerZoneCapacity : public SstPartitioner {
+ public:
+  SstPartitionerZoneCapacity(uint64_t remaining, uint64_t max_capacity,
+                             uint32_t reserve_pct)
+      : remaining_(remaining),
+        max_capacity_(max_capacity),
+        reserve_pct_(reserve_pct) {}
+
+  virtual ~SstPartitionerZoneCapacity() override {}
+
+  const char* Name() const override { return "SstPartitionerZoneCapacity"; }
+
+  PartitionerResult ShouldPartition(const PartitionerRequest& request) override;
+
+  bool CanDoTrivialMove(const Slice& smallest_user_key,
+                        const Slice& largest_user_key) override;
+
+ private:
+  // Accounts a finished output file of size bytes against the current zone
+  void Consume(uint64_t size);
+
+  uint64_t remaining_;
+  uint64_t max_capacity_;
+  uint32_t reserve_pct_;
+  uint64_t last_size_ = 0;
+};
+
+/*
+ * Factory for zone capacity partitioner.
+ */
+class SstPartitionerZoneCapacityFactory : public SstPartitionerFactory {
+ public:
+  SstPartitionerZoneCapacityFactory(std::shared_ptr<FileSystem> fs,
+                                    uint32_t reserve_pct)
+      : fs_(fs), reserve_pct_(reserve_pct) {}
+
+  virtual ~SstPartitionerZoneCapacityFactory() {}
+
+  const char* Name() const override {
+    return "SstPartitionerZoneCapacityFactory";
+  }
+
+  std::unique_ptr<SstPartitioner> CreatePartitioner(
+      const SstPartitioner::Context& context) const override;
+
+ private:
+  std::shared_ptr<FileSystem> fs_;
+  uint32_t reserve_pct_;
+};
+
+extern std::shared_ptr<SstPartitionerFactory>
+NewSstPartitionerZoneCapacityFactory(std::shared_ptr<FileSystem> fs,
+                                     uint32_t reserve_pct = 2);
+
 }  // namespace ROCKSDB_NAMESPACE
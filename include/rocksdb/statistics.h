@@ -374,6 +374,73 @@ enum Tickers : uint32_t {
   // # of files deleted immediately by sst file manger through delete scheduler.
   FILES_DELETED_IMMEDIATELY,
 
+  // ZenFS zoned storage, recorded once the DB statistics reach the
+  // FileSystem.
+  // # of zones reset and finished.
+  ZENFS_ZONE_RESETS,
+  ZENFS_ZONE_FINISHES,
+  // # of bytes and extents moved by zone cleaning.
+  ZENFS_GC_BYTES_COPIED,
+  ZENFS_GC_EXTENTS_MIGRATED,
+  // # of bytes written to the metadata log.
+  ZENFS_META_LOG_BYTES,
+  // # of times a read crossed into the next extent of a file.
+  ZENFS_READ_EXTENT_HOPS,
+  // # of small device reads served from and missed in the read cache.
+  ZENFS_READ_CACHE_HIT,
+  ZENFS_READ_CACHE_MISS,
+
+  // Blob cache, see AdvancedColumnFamilyOptions::blob_cache.
+  // # of blob lookups served from and missed in the blob cache.
+  BLOB_DB_CACHE_HIT,
+  BLOB_DB_CACHE_MISS,
+  // # of blobs added to the blob cache, and of failed insertions.
+  BLOB_DB_CACHE_ADD,
+  BLOB_DB_CACHE_ADD_FAILURES,
+  // # of bytes read from and added to the blob cache.
+  BLOB_DB_CACHE_BYTES_READ,
+  BLOB_DB_CACHE_BYTES_WRITE,
+
+  // # of merge operands combined into the latest operand of their key in the
+  // memtable, see AdvancedColumnFamilyOptions::preaggregate_merge_operands.
+  NUMBER_MERGE_OPERANDS_COMBINED,
+
+  // # of table files opened from the metadata saved at the last DB close,
+  // see DBOptions::max_table_metadata_checkpoint_size.
+  TABLE_OPEN_PREFETCHED_TAIL_HIT,
+
+  // # of data blocks read into the block cache after DB::Open(), see
+  // DBOptions::block_cache_warmup_save_period_sec.
+  BLOCK_CACHE_WARMUP_BLOCKS,
+
+  // # of times a MemoryGovernor moved memory to the write buffers and to the
+  // block cache, and # of bytes it moved.
+  MEMORY_GOVERNOR_MOVES_TO_WRITE_BUFFER,
+  MEMORY_GOVERNOR_MOVES_TO_BLOCK_CACHE,
+  MEMORY_GOVERNOR_BYTES_MOVED,
+
+  // # of MEMTABLE_HIT served by immutable memtables, and # of bytes of
+  // immutable memtables migrated to DBOptions::immutable_memtable_numa_node.
+  IMMUTABLE_MEMTABLE_HIT,
+  IMMUTABLE_MEMTABLE_BYTES_MIGRATED,
+
+  // # of lookups that hit and missed a slow memory secondary cache, and # of
+  // entries added to it. See NewSlowMemorySecondaryCache().
+  SLOW_MEMORY_CACHE_HIT,
+  SLOW_MEMORY_CACHE_MISS,
+  SLOW_MEMORY_CACHE_ADD,
+
+  // # of compaction input files, and their bytes, dropped without being read
+  // because range tombstones of the compaction deleted all their keys.
+  COMPACTION_RANGE_DEL_DROP_FILES,
+  COMPACTION_RANGE_DEL_DROP_FILE_BYTES,
+
+  // # of reads the hedged read file system issued a second time, of those
+  // the hedge completed first, and of hedges cancelled before they started.
+  HEDGED_READS,
+  HEDGED_READ_WINS,
+  HEDGED_READ_CANCELLED,
+
   TICKER_ENUM_MAX
 };
 
@@ -472,6 +539,27 @@ enum Histograms : uint32_t {
   // Num of sst files read from file system per level.
   NUM_SST_READ_PER_LEVEL,
 
+  // ZenFS zone allocation latency and the open/active zone counts sampled
+  // at each allocation.
+  ZENFS_ZONE_ALLOCATION_MICROS,
+  ZENFS_OPEN_ZONES,
+  ZENFS_ACTIVE_ZONES,
+  // Extent hops of a single ZenFS read.
+  ZENFS_EXTENT_HOPS_PER_READ,
+  // Time a ZenFS writer queued for an open zone slot.
+  ZENFS_ZONE_ADMISSION_MICROS,
+  // Latency of ZenFS device I/O by scheduling class, queueing included:
+  // foreground reads, compaction reads and zone cleaning reads and copies.
+  ZENFS_FOREGROUND_READ_MICROS,
+  ZENFS_COMPACTION_READ_MICROS,
+  ZENFS_GC_IO_MICROS,
+
+  // Time background jobs of each priority waited in the queue of a
+  // work-stealing Env, see NewWorkStealingEnv().
+  HIGH_PRI_POOL_QUEUEING_MICROS,
+  LOW_PRI_POOL_QUEUEING_MICROS,
+  BOTTOM_PRI_POOL_QUEUEING_MICROS,
+
   HISTOGRAM_ENUM_MAX,
 };
 
@@ -589,4 +677,13 @@ class Statistics {
 // Create a concrete DBStatistics object
 std::shared_ptr<Statistics> CreateDBStatistics();
 
+// Create a concrete DBStatistics object whose histograms have HDR-style
+// buckets: values below 2^(hdr_precision_bits + 1) are recorded exactly, and
+// larger ones to a relative precision of 2^-hdr_precision_bits, so that e.g.
+// P99.99 is resolved as finely as the median. hdr_precision_bits must be in
+// [1, 10]; each histogram takes (65 - hdr_precision_bits) <<
+// hdr_precision_bits 8-byte counters per core, e.g. 15KB for 5 bits.
+std::shared_ptr<Statistics> CreateDBStatisticsWithHdrHistograms(
+    int hdr_precision_bits);
+
 }  // namespace ROCKSDB_NAMESPACE
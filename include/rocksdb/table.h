@@ -21,6 +21,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/configurable.h"
 #include "rocksdb/env.h"
@@ -31,6 +32,7 @@ namespace ROCKSDB_NAMESPACE {
 
 // -- Block-based Table
 class Cache;
+class Compressor;
 class FilterPolicy;
 class FlushBlockPolicyFactory;
 class PersistentCache;
@@ -49,6 +51,10 @@ enum ChecksumType : char {
   kCRC32c = 0x1,
   kxxHash = 0x2,
   kxxHash64 = 0x3,
+  // XXH3, using the SIMD instructions (SSE2, AVX2 or NEON) the build targets.
+  // Requires format_version >= 1, like any checksum other than kCRC32c, and
+  // is not readable by releases that predate it.
+  kXXH3 = 0x4,
 };
 
 // `PinningTier` is used to specify which tier of block-based tables should
@@ -204,6 +210,13 @@ struct BlockBasedTableOptions {
     // Makes the index significantly bigger (2x or more), especially when keys
     // are long.
     kBinarySearchWithFirstKey = 0x03,
+
+    // Stores the separator keys in a succinct (LOUDS-Sparse) trie and the
+    // block handles in bit-packed arrays. The index is usually several times
+    // smaller than kBinarySearch when keys share long prefixes, and it is
+    // searched in place without being decoded. Requires the bytewise
+    // comparator; tables of other comparators get a kBinarySearch index.
+    kSuccinctTrieSearch = 0x04,
   };
 
   IndexType index_type = kBinarySearch;
@@ -220,6 +233,14 @@ struct BlockBasedTableOptions {
   // kDataBlockBinaryAndHash.
   double data_block_hash_table_util_ratio = 0.75;
 
+  // If true, data blocks up to 64KiB also store the first 8 bytes of each
+  // restart key, so that seeks within a block can rule out most restart
+  // intervals by comparing integers before decoding and comparing any key.
+  // Costs 8 bytes per restart point. Only used with BytewiseComparator.
+  //
+  // Blocks written with this option cannot be read by older versions.
+  bool data_block_restart_key_prefixes = false;
+
   // This option is now deprecated. No matter what value it is set to,
   // it will behave as if hash_index_allow_collision=true.
   bool hash_index_allow_collision = true;
@@ -234,6 +255,18 @@ struct BlockBasedTableOptions {
   // point to a nullptr object.
   bool no_block_cache = false;
 
+  // If true and the table files are read with `Options::allow_mmap_reads`,
+  // the data blocks of table files written without compression are used in
+  // place in the mapping: they are neither looked up in nor inserted into
+  // the block cache, so they take no copy and no block cache charge. Index,
+  // filter and other meta blocks are cached as usual. Meant for read-only
+  // DBs whose files are memory-resident, where copying blocks into the block
+  // cache duplicates the page cache. Tables with compressed blocks are read
+  // as usual.
+  //
+  // Default: false
+  bool serve_data_blocks_from_mmap = false;
+
   // If non-NULL use the specified cache for blocks.
   // If NULL, rocksdb will automatically create and use an 8MB internal cache.
   std::shared_ptr<Cache> block_cache = nullptr;
@@ -248,6 +281,11 @@ struct BlockBasedTableOptions {
   //       same type of object there.
   std::shared_ptr<Cache> block_cache_compressed = nullptr;
 
+  // If non-NULL, compresses the blocks of new files with the types it
+  // supports in place of the built-in compression, e.g. to offload it to a
+  // hardware accelerator. See rocksdb/compressor.h.
+  std::shared_ptr<Compressor> compressor = nullptr;
+
   // Approximate size of user data packed per block.  Note that the
   // block size specified here corresponds to uncompressed data.  The
   // actual size of the unit read from disk may be smaller if
@@ -267,6 +305,33 @@ struct BlockBasedTableOptions {
   // value will be silently overwritten with 1.
   int block_restart_interval = 16;
 
+  // Per-level block_size and block_restart_interval of the files written by
+  // flushes and compactions: the i-th element applies to the files of level
+  // i, and the last one to the levels below. When empty, block_size and
+  // block_restart_interval apply to all levels. Files whose level is unknown,
+  // e.g. those of SstFileWriter, always use block_size and
+  // block_restart_interval.
+  //
+  // E.g. point-read upper levels may use small blocks while the last level,
+  // mostly scanned, uses large blocks with sparser restart points.
+  std::vector<size_t> block_size_per_level;
+  std::vector<int> block_restart_interval_per_level;
+
+  // If true, the block size of the files written at a level is picked from
+  // the reads served by the files of the level since the table factory was
+  // created: levels read by point lookups use the level's block size (see
+  // block_size_per_level), levels read by scans use max_auto_tuned_block_size
+  // and levels read by both a size in between, growing with the fraction of
+  // scans. Column families sharing the table factory share the counts.
+  //
+  // Default: false
+  bool auto_tune_block_size = false;
+
+  // The largest block size picked by auto_tune_block_size
+  //
+  // Default: 64KB
+  size_t max_auto_tuned_block_size = 64 * 1024;
+
   // Same as block_restart_interval but used for the index block.
   int index_block_restart_interval = 1;
 
@@ -322,6 +387,16 @@ struct BlockBasedTableOptions {
   // unless malloc_usable_size is buggy or broken.
   bool optimize_filters_for_memory = false;
 
+  // If true and block_cache is set, memory that a filter builder holds
+  // temporarily while constructing a filter is charged to the block cache
+  // with dummy entries. Currently only Ribbon filters (see
+  // NewExperimentalRibbonFilterPolicy) do so, for their key hashes and
+  // banding. If the block cache cannot take the charge (strict capacity
+  // limit), the filter is built as a Bloom filter, which needs less.
+  //
+  // Default: false
+  bool reserve_table_builder_memory = false;
+
   // Use delta encoding to compress keys in blocks.
   // ReadOptions::pin_data requires this option to be disabled.
   //
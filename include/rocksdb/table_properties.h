@@ -61,6 +61,7 @@ struct TablePropertiesNames {
   static const std::string kCreationTime;
   static const std::string kOldestKeyTime;
   static const std::string kFileCreationTime;
+  static const std::string kCompressionDictId;
 };
 
 extern const std::string kPropertiesBlock;
@@ -195,6 +196,10 @@ struct TableProperties {
   uint64_t oldest_key_time = 0;
   // Actual SST file creation time. 0 means unknown.
   uint64_t file_creation_time = 0;
+  // ID of the compression dictionary shared with other SST files of the
+  // column family, see `CompressionOptions::shared_dict_retrain_bytes`. 0
+  // means the dictionary, if any, is specific to this file.
+  uint64_t compression_dict_id = 0;
 
   // DB identity
   // db_id is an identifier generated the first time the DB is created
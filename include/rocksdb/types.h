@@ -32,7 +32,9 @@ enum FileType {
   kMetaDatabase,
   kIdentityFile,
   kOptionsFile,
-  kBlobFile
+  kBlobFile,
+  kTableMetadataFile,
+  kBlockCacheWarmupFile
 };
 
 // User-oriented representation of internal key types.
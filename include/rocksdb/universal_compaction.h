@@ -72,6 +72,35 @@ class CompactionOptionsUniversal {
   // Default: false
   bool allow_trivial_move;
 
+  // If non-zero, sorted runs are compacted by lazy leveling rather than by
+  // size ratio: the sorted runs other than the oldest one are tiered, and the
+  // oldest one is leveled. A sorted run belongs to tier k if its size is at
+  // least write_buffer_size * runs_per_tier^k and less than
+  // write_buffer_size * runs_per_tier^(k+1). Once runs_per_tier consecutive
+  // sorted runs are in the same tier, they are merged into one sorted run of
+  // the next tier, or, if that is the tier just below the oldest sorted run,
+  // into the oldest sorted run. This trades some space amplification for
+  // less write amplification than leveling on the upper levels.
+  // level0_file_num_compaction_trigger still bounds the total number of
+  // sorted runs, so it should be larger than runs_per_tier.
+  // Values below 2 other than 0 are treated as 2.
+  // Default: 0
+  unsigned int runs_per_tier;
+
+  // If true, a compaction to reduce the size amplification merges the
+  // second oldest sorted run into the oldest one a key range slice at a time,
+  // when both are levels other than L0, rather than all the sorted runs at
+  // once. Each slice is a compaction of its own, of about
+  // max_compaction_bytes / 2 of the second oldest sorted run with the files
+  // of the oldest one it overlaps, which may use subcompactions, and its
+  // inputs are deleted once it is done. This bounds the temporary space and
+  // the duration of the compactions. The slices with the fewest bytes of the
+  // oldest sorted run per byte of the second oldest one are picked first,
+  // and a full compaction is picked when no slice is cheaper than 1.8 times
+  // the ratio of a full one.
+  // Default: false
+  bool incremental;
+
   // Default set of parameters
   CompactionOptionsUniversal()
       : size_ratio(1),
@@ -80,7 +109,9 @@ class CompactionOptionsUniversal {
         max_size_amplification_percent(200),
         compression_size_percent(-1),
         stop_style(kCompactionStopStyleTotalSize),
-        allow_trivial_move(false) {}
+        allow_trivial_move(false),
+        runs_per_tier(0),
+        incremental(false) {}
 };
 
 }  // namespace ROCKSDB_NAMESPACE
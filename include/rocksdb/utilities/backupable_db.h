@@ -109,6 +109,13 @@ struct BackupableDBOptions {
   // Default: 1
   int max_background_operations;
 
+  // If nonzero, RestoreDBFromBackup() copies each file through two buffers
+  // of this size, reading the next one while the other one is checksummed
+  // and written. restore_rate_limit then paces the whole restore in pieces
+  // of its burst size instead of limiting the reads to that size.
+  // Default: 0 (one buffer, read and written in turn)
+  size_t restore_buffer_size;
+
   // During backup user can get callback every time next
   // callback_trigger_interval_size bytes being copied.
   // Default: 4194304
@@ -223,6 +230,7 @@ struct BackupableDBOptions {
         restore_rate_limit(_restore_rate_limit),
         share_files_with_checksum(false),
         max_background_operations(_max_background_operations),
+        restore_buffer_size(0),
         callback_trigger_interval_size(_callback_trigger_interval_size),
         max_valid_backups_to_open(_max_valid_backups_to_open),
         share_files_with_checksum_naming(_share_files_with_checksum_naming) {
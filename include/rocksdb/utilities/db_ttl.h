@@ -64,6 +64,19 @@ class DBWithTTL : public StackableDB {
 
   virtual void SetTtl(ColumnFamilyHandle* h, int32_t ttl) = 0;
 
+  // Drops the table files of column_family all of whose values have
+  // expired, as told by the oldest and newest timestamps recorded in their
+  // table properties, without reading them. A file is only dropped from the
+  // last level, or as the oldest file of level 0 if all files are there,
+  // so that no older value of its keys shows again.
+  //
+  // The files not dropped, but of whose values at least
+  // compact_expired_ratio are estimated to have expired, are compacted by
+  // themselves so that the expired values are removed. Values of
+  // compact_expired_ratio above 1 compact no files.
+  virtual Status DropExpiredFiles(ColumnFamilyHandle* column_family,
+                                  double compact_expired_ratio = 1.0) = 0;
+
  protected:
   explicit DBWithTTL(DB* db) : StackableDB(db) {}
 };
@@ -0,0 +1,78 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A scan of a whole column family, or of a key range of it, on several
+// threads, for exports and analytics jobs to read at the speed of the
+// device rather than of one iterator.
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <functional>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class DB;
+class ColumnFamilyHandle;
+class Snapshot;
+
+struct ParallelScanOptions {
+  // Number of threads scanning partitions
+  int num_threads = 4;
+
+  // Number of key ranges to split the scan into. The ranges are cut at the
+  // smallest keys of the table files of the level holding the most data,
+  // for about as many bytes of table files in each. There may be fewer if
+  // there are not enough files. 0 for four per thread.
+  size_t num_partitions = 0;
+
+  // Bytes of keys and values to gather before passing them to the callback
+  size_t batch_size = 1 << 20;
+
+  // As ReadOptions::readahead_size. Scans read sequentially, and are best
+  // off with large reads.
+  size_t readahead_size = 4 << 20;
+
+  // As ReadOptions::fill_cache. A scan would otherwise evict the blocks of
+  // the other reads from the block cache.
+  bool fill_cache = false;
+
+  // If set, the scan covers only the keys >= lower_bound and < upper_bound.
+  // Must outlive the scan.
+  const Slice* lower_bound = nullptr;
+  const Slice* upper_bound = nullptr;
+
+  // The snapshot to scan. If nullptr, the scan takes one of its own, so the
+  // partitions are always consistent with each other.
+  const Snapshot* snapshot = nullptr;
+};
+
+// A batch of entries of a partition, in key order. The slices are only
+// valid until the callback returns.
+struct ParallelScanBatch {
+  // The partitions are numbered in key order from 0
+  size_t partition;
+  std::vector<Slice> keys;
+  std::vector<Slice> values;
+};
+
+// Called on the scanning threads, concurrently for different partitions,
+// and in order for the batches of a partition. A non-ok status stops the
+// scan, and ParallelScan() returns it.
+typedef std::function<Status(const ParallelScanBatch&)> ParallelScanCallback;
+
+// Scans column_family on options.num_threads threads, passing the entries
+// to callback in batches. Returns once the scan is done, with the first
+// error of the iterators or of the callback.
+Status ParallelScan(DB* db, ColumnFamilyHandle* column_family,
+                    const ParallelScanOptions& options,
+                    const ParallelScanCallback& callback);
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // !ROCKSDB_LITE
@@ -147,6 +147,12 @@ class StackableDB : public DB {
     return db_->VerifyChecksum(options);
   }
 
+  virtual Status VerifyChecksum(
+      const ReadOptions& options,
+      const VerifyChecksumOptions& verify_options) override {
+    return db_->VerifyChecksum(options, verify_options);
+  }
+
   using DB::KeyMayExist;
   virtual bool KeyMayExist(const ReadOptions& options,
                            ColumnFamilyHandle* column_family, const Slice& key,
@@ -180,6 +186,12 @@ class StackableDB : public DB {
     return db_->Write(opts, updates);
   }
 
+  virtual void WriteAsync(
+      const WriteOptions& opts, WriteBatch* updates,
+      std::function<void(const Status&)> callback) override {
+    db_->WriteAsync(opts, updates, std::move(callback));
+  }
+
   using DB::NewIterator;
   virtual Iterator* NewIterator(const ReadOptions& opts,
                                 ColumnFamilyHandle* column_family) override {
@@ -489,6 +501,14 @@ class StackableDB : public DB {
   Status TryCatchUpWithPrimary() override {
     return db_->TryCatchUpWithPrimary();
   }
+
+  Status StartCatchingUpWithPrimary(uint64_t max_wait_us) override {
+    return db_->StartCatchingUpWithPrimary(max_wait_us);
+  }
+
+  Status StopCatchingUpWithPrimary() override {
+    return db_->StopCatchingUpWithPrimary();
+  }
 #endif  // ROCKSDB_LITE
 
  protected:
@@ -48,6 +48,16 @@ struct TransactionDBOptions {
   // mutex.
   size_t num_stripes = 16;
 
+  // If true, the transactions waiting for the lock of a key wait in a FIFO
+  // queue of that key, and unlocking the key only wakes up the head of the
+  // queue: the first transaction if it wants an exclusive lock, or all the
+  // ones wanting a shared lock before the next exclusive one. A transaction
+  // upgrading its shared lock to an exclusive one keeps the shared lock while
+  // it waits, ahead of the other transactions. This avoids the thundering
+  // herd of hot keys, where unlocking any key wakes up all the transactions
+  // waiting for a key of the same stripe, to retry.
+  bool per_key_lock_wait_queues = false;
+
   // If positive, specifies the default wait timeout in milliseconds when
   // a transaction attempts to lock a key if not specified by
   // TransactionOptions::lock_timeout.
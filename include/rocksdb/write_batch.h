@@ -153,9 +153,23 @@ class WriteBatch : public WriteBatchBase {
   Status PutLogData(const Slice& blob) override;
 
   using WriteBatchBase::Clear;
-  // Clear all updates buffered in this batch.
+  // Clear all updates buffered in this batch. The memory of the batch is
+  // kept for the updates that follow.
   void Clear() override;
 
+  // Makes room for bytes more of updates, so that adding them does not grow
+  // the batch.
+  void Reserve(size_t bytes) { rep_.reserve(rep_.size() + bytes); }
+
+  // Clears the batch and backs it with the memory of buffer, whose contents
+  // are dropped, e.g. a buffer taken from a pool, or released by another
+  // batch.
+  void AdoptBuffer(std::string&& buffer);
+
+  // Returns the memory of the batch with its contents, as Data(), and
+  // clears the batch, e.g. to keep the buffer in a pool for a later batch.
+  std::string ReleaseBuffer();
+
   // Records the state of the batch for future calls to RollbackToSavePoint().
   // May be called multiple times to set multiple save points.
   void SetSavePoint() override;
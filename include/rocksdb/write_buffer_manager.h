@@ -14,6 +14,8 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include "rocksdb/cache.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -32,27 +34,35 @@ class WriteBufferManager {
 
   ~WriteBufferManager();
 
-  bool enabled() const { return buffer_size_ != 0; }
+  bool enabled() const { return enabled_; }
 
   bool cost_to_cache() const { return cache_rep_ != nullptr; }
 
-  // Only valid if enabled()
-  size_t memory_usage() const {
-    return memory_used_.load(std::memory_order_relaxed);
+  // Only valid if enabled(). Sums the per-core accounts, so the value is
+  // exact once concurrent ReserveMem() and FreeMem() calls have returned.
+  size_t memory_usage() const;
+  size_t mutable_memtable_memory_usage() const;
+  size_t buffer_size() const {
+    return buffer_size_.load(std::memory_order_relaxed);
   }
-  size_t mutable_memtable_memory_usage() const {
-    return memory_active_.load(std::memory_order_relaxed);
-  }
-  size_t buffer_size() const { return buffer_size_; }
 
-  // Should only be called from write thread
+  // Changes the memory limit of an enabled manager, e.g. as a
+  // MemoryGovernor moves memory between the write buffers and the block
+  // cache. new_size must not be 0. Lowering the limit under the current
+  // usage makes the next writes flush memtables.
+  void SetBufferSize(size_t new_size);
+
+  // Should only be called from write thread. Only reads the aggregated
+  // counters, which lag the per-core accounts by at most buffer_size() / 1024.
   bool ShouldFlush() const {
     if (enabled()) {
-      if (mutable_memtable_memory_usage() > mutable_limit_) {
+      size_t buffer_size = buffer_size_.load(std::memory_order_relaxed);
+      if (aggregated_active() >
+          mutable_limit_.load(std::memory_order_relaxed)) {
         return true;
       }
-      if (memory_usage() >= buffer_size_ &&
-          mutable_memtable_memory_usage() >= buffer_size_ / 2) {
+      if (aggregated_used() >= buffer_size &&
+          aggregated_active() >= buffer_size / 2) {
         // If the memory exceeds the buffer size, we trigger more aggressive
         // flush. But if already more than half memory is being flushed,
         // triggering more flush may not help. We will hold it instead.
@@ -63,39 +73,51 @@ class WriteBufferManager {
   }
 
   void ReserveMem(size_t mem) {
-    if (cache_rep_ != nullptr) {
-      ReserveMemWithCache(mem);
-    } else if (enabled()) {
-      memory_used_.fetch_add(mem, std::memory_order_relaxed);
-    }
-    if (enabled()) {
-      memory_active_.fetch_add(mem, std::memory_order_relaxed);
+    if (cache_rep_ != nullptr || enabled()) {
+      UpdateMem(static_cast<int64_t>(mem),
+                enabled() ? static_cast<int64_t>(mem) : 0);
     }
   }
   // We are in the process of freeing `mem` bytes, so it is not considered
   // when checking the soft limit.
   void ScheduleFreeMem(size_t mem) {
     if (enabled()) {
-      memory_active_.fetch_sub(mem, std::memory_order_relaxed);
+      UpdateMem(0, -static_cast<int64_t>(mem));
     }
   }
   void FreeMem(size_t mem) {
-    if (cache_rep_ != nullptr) {
-      FreeMemWithCache(mem);
-    } else if (enabled()) {
-      memory_used_.fetch_sub(mem, std::memory_order_relaxed);
+    if (cache_rep_ != nullptr || enabled()) {
+      UpdateMem(-static_cast<int64_t>(mem), 0);
     }
   }
 
  private:
-  const size_t buffer_size_;
-  const size_t mutable_limit_;
-  std::atomic<size_t> memory_used_;
+  const bool enabled_;
+  std::atomic<size_t> buffer_size_;
+  std::atomic<size_t> mutable_limit_;
+  // Aggregated counters. Updates are first accounted in a per-core delta and
+  // only folded in here once the delta exceeds core_slack_ bytes, so that
+  // writers on different cores don't bounce the same cache line.
+  std::atomic<int64_t> memory_used_;
   // Memory that hasn't been scheduled to free.
-  std::atomic<size_t> memory_active_;
+  std::atomic<int64_t> memory_active_;
+  struct CoreDeltas;
+  std::unique_ptr<CoreDeltas> core_deltas_;
+  // Zero means every update goes straight to the aggregated counters
+  int64_t core_slack_;
   struct CacheRep;
   std::unique_ptr<CacheRep> cache_rep_;
 
+  size_t aggregated_used() const {
+    int64_t used = memory_used_.load(std::memory_order_relaxed);
+    return used > 0 ? static_cast<size_t>(used) : 0;
+  }
+  size_t aggregated_active() const {
+    int64_t active = memory_active_.load(std::memory_order_relaxed);
+    return active > 0 ? static_cast<size_t>(active) : 0;
+  }
+
+  void UpdateMem(int64_t used_delta, int64_t active_delta);
   void ReserveMemWithCache(size_t mem);
   void FreeMemWithCache(size_t mem);
 };
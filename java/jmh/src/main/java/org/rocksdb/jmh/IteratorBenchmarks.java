@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+ *  This source code is licensed under both the GPLv2 (found in the
+ *  COPYING file in the root directory) and Apache 2.0 License
+ *  (found in the LICENSE.Apache file in the root directory).
+ */
+package org.rocksdb.jmh;
+
+import org.openjdk.jmh.annotations.*;
+import org.rocksdb.*;
+import org.rocksdb.util.FileUtils;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.file.Files;
+import java.nio.file.Path;
+
+import static org.rocksdb.util.KVUtils.ba;
+
+@State(Scope.Benchmark)
+public class IteratorBenchmarks {
+
+  @Param("100000")
+  int keyCount;
+
+  @Param({
+      "10",
+      "100",
+      "1000"
+  })
+  int batchSize;
+
+  Path dbDir;
+  Options options;
+  RocksDB db;
+
+  @Setup(Level.Trial)
+  public void setup() throws IOException, RocksDBException {
+    RocksDB.loadLibrary();
+
+    dbDir = Files.createTempDirectory("rocksjava-iterator-benchmarks");
+
+    options = new Options()
+        .setCreateIfMissing(true);
+    db = RocksDB.open(options, dbDir.toAbsolutePath().toString());
+
+    for (int i = 0; i < keyCount; i++) {
+      db.put(ba("key" + i), ba("value" + i));
+    }
+
+    try (final FlushOptions flushOptions = new FlushOptions()
+            .setWaitForFlush(true)) {
+      db.flush(flushOptions);
+    }
+  }
+
+  @TearDown(Level.Trial)
+  public void cleanup() throws IOException {
+    db.close();
+    options.close();
+    FileUtils.delete(dbDir);
+  }
+
+  /**
+   * The direct buffers of a thread for {@link #scanDirect()}.
+   */
+  @State(Scope.Thread)
+  public static class DirectBuffers {
+    ByteBuffer keys;
+    ByteBuffer values;
+    int[] keyLengths;
+    int[] valueLengths;
+
+    @Setup(Level.Trial)
+    public void setup(final IteratorBenchmarks benchmarks) {
+      keys = ByteBuffer.allocateDirect(benchmarks.batchSize * 16);
+      values = ByteBuffer.allocateDirect(benchmarks.batchSize * 16);
+      keyLengths = new int[benchmarks.batchSize];
+      valueLengths = new int[benchmarks.batchSize];
+    }
+  }
+
+  @Benchmark
+  public long scan() {
+    long bytes = 0;
+    try (final RocksIterator iterator = db.newIterator()) {
+      for (iterator.seekToFirst(); iterator.isValid(); iterator.next()) {
+        bytes += iterator.key().length + iterator.value().length;
+      }
+    }
+    return bytes;
+  }
+
+  @Benchmark
+  public long scanDirect(final DirectBuffers buffers) throws RocksDBException {
+    long bytes = 0;
+    try (final RocksIterator iterator = db.newIterator()) {
+      iterator.seekToFirst();
+      while (true) {
+        buffers.keys.clear();
+        buffers.values.clear();
+        if (iterator.readEntries(buffers.keys, buffers.keyLengths,
+            buffers.values, buffers.valueLengths) == 0) {
+          break;
+        }
+        bytes += buffers.keys.limit() + buffers.values.limit();
+      }
+    }
+    return bytes;
+  }
+}
@@ -11,6 +11,7 @@ import org.rocksdb.*;
 import org.rocksdb.util.FileUtils;
 
 import java.io.IOException;
+import java.nio.ByteBuffer;
 import java.nio.file.Files;
 import java.nio.file.Path;
 import java.util.ArrayList;
@@ -49,6 +50,7 @@ public class MultiGetBenchmarks {
   ColumnFamilyHandle[] cfHandles;
   RocksDB db;
   private final AtomicInteger keyIndex = new AtomicInteger();
+  ReadOptions readOptions;
 
   @Setup(Level.Trial)
   public void setup() throws IOException, RocksDBException {
@@ -93,10 +95,32 @@ public class MultiGetBenchmarks {
             .setWaitForFlush(true)) {
       db.flush(flushOptions);
     }
+    readOptions = new ReadOptions();
+  }
+
+  /**
+   * The direct buffers of a thread for {@link #multiGetDirect10()}, sized
+   * for the keys and values of {@link org.rocksdb.util.KVUtils#keys}.
+   */
+  @State(Scope.Thread)
+  public static class DirectBuffers {
+    ByteBuffer keys;
+    ByteBuffer values;
+    int[] keyLengths;
+    int[] valueLengths;
+
+    @Setup(Level.Trial)
+    public void setup(final MultiGetBenchmarks benchmarks) {
+      keys = ByteBuffer.allocateDirect(benchmarks.multiGetSize * 16);
+      values = ByteBuffer.allocateDirect(benchmarks.multiGetSize * 16);
+      keyLengths = new int[benchmarks.multiGetSize];
+      valueLengths = new int[benchmarks.multiGetSize];
+    }
   }
 
   @TearDown(Level.Trial)
   public void cleanup() throws IOException {
+    readOptions.close();
     for (final ColumnFamilyHandle cfHandle : cfHandles) {
       cfHandle.close();
     }
@@ -155,4 +179,19 @@ public class MultiGetBenchmarks {
     final List<byte[]> keys = keys(fromKeyIdx, fromKeyIdx + multiGetSize);
     return db.multiGetAsList(keys);
   }
+
+  @Benchmark
+  public int multiGetDirect10(final DirectBuffers buffers) throws RocksDBException {
+    final int fromKeyIdx = next(multiGetSize, keyCount);
+    buffers.keys.clear();
+    for (int i = 0; i < multiGetSize; i++) {
+      final byte[] key = ba("key" + (fromKeyIdx + i));
+      buffers.keys.put(key);
+      buffers.keyLengths[i] = key.length;
+    }
+    buffers.keys.flip();
+    buffers.values.clear();
+    return db.multiGet(readOptions, buffers.keys, buffers.keyLengths,
+        buffers.values, buffers.valueLengths);
+  }
 }
@@ -267,3 +267,73 @@ jint Java_org_rocksdb_RocksIterator_valueDirect0(JNIEnv* env, jobject /*jobj*/,
   return ROCKSDB_NAMESPACE::JniUtil::copyToDirect(env, value_slice, jtarget,
                                                   jtarget_off, jtarget_len);
 }
+
+/*
+ * Class:     org_rocksdb_RocksIterator
+ * Method:    readEntriesDirect0
+ * Signature: (JLjava/nio/ByteBuffer;II[ILjava/nio/ByteBuffer;II[I)I
+ */
+jint Java_org_rocksdb_RocksIterator_readEntriesDirect0(
+    JNIEnv* env, jobject /*jobj*/, jlong handle, jobject jkeys,
+    jint jkeys_off, jint jkeys_len, jintArray jkey_lens, jobject jvalues,
+    jint jvalues_off, jint jvalues_len, jintArray jvalue_lens) {
+  auto* it = reinterpret_cast<ROCKSDB_NAMESPACE::Iterator*>(handle);
+
+  char* keys = reinterpret_cast<char*>(env->GetDirectBufferAddress(jkeys));
+  if (keys == nullptr ||
+      env->GetDirectBufferCapacity(jkeys) < (jkeys_off + jkeys_len)) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+        env, "Invalid keys argument");
+    return 0;
+  }
+  char* values = reinterpret_cast<char*>(env->GetDirectBufferAddress(jvalues));
+  if (values == nullptr ||
+      env->GetDirectBufferCapacity(jvalues) < (jvalues_off + jvalues_len)) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+        env, "Invalid values argument");
+    return 0;
+  }
+  keys += jkeys_off;
+  values += jvalues_off;
+
+  const jsize max_entries = std::min(env->GetArrayLength(jkey_lens),
+                                     env->GetArrayLength(jvalue_lens));
+  std::vector<jint> key_lens;
+  std::vector<jint> value_lens;
+  jint keys_used = 0;
+  jint values_used = 0;
+  for (; it->Valid() && static_cast<jsize>(key_lens.size()) < max_entries;
+       it->Next()) {
+    ROCKSDB_NAMESPACE::Slice key = it->key();
+    ROCKSDB_NAMESPACE::Slice value = it->value();
+    const jint key_len = static_cast<jint>(key.size());
+    const jint value_len = static_cast<jint>(value.size());
+    if (key_len > jkeys_len - keys_used ||
+        value_len > jvalues_len - values_used) {
+      break;
+    }
+    memcpy(keys + keys_used, key.data(), key_len);
+    memcpy(values + values_used, value.data(), value_len);
+    key_lens.push_back(key_len);
+    value_lens.push_back(value_len);
+    keys_used += key_len;
+    values_used += value_len;
+  }
+  if (!it->Valid() && !it->status().ok()) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(env, it->status());
+    return 0;
+  }
+
+  const jsize num_entries = static_cast<jsize>(key_lens.size());
+  env->SetIntArrayRegion(jkey_lens, 0, num_entries, key_lens.data());
+  if (env->ExceptionCheck()) {
+    // exception thrown: ArrayIndexOutOfBoundsException
+    return 0;
+  }
+  env->SetIntArrayRegion(jvalue_lens, 0, num_entries, value_lens.data());
+  if (env->ExceptionCheck()) {
+    // exception thrown: ArrayIndexOutOfBoundsException
+    return 0;
+  }
+  return num_entries;
+}
@@ -1887,6 +1887,99 @@ jobjectArray Java_org_rocksdb_RocksDB_multiGet__JJ_3_3B_3I_3I_3J(
       jkey_offs, jkey_lens, jcolumn_family_handles);
 }
 
+/*
+ * Class:     org_rocksdb_RocksDB
+ * Method:    multiGetDirect
+ * Signature: (JJLjava/nio/ByteBuffer;II[ILjava/nio/ByteBuffer;II[IJ)I
+ */
+jint Java_org_rocksdb_RocksDB_multiGetDirect(
+    JNIEnv* env, jobject /*jdb*/, jlong jdb_handle, jlong jropt_handle,
+    jobject jkeys, jint jkeys_off, jint jkeys_len, jintArray jkey_lens,
+    jobject jvalues, jint jvalues_off, jint jvalues_len,
+    jintArray jvalue_lens, jlong jcf_handle) {
+  auto* db = reinterpret_cast<ROCKSDB_NAMESPACE::DB*>(jdb_handle);
+  auto* ro_opt =
+      reinterpret_cast<ROCKSDB_NAMESPACE::ReadOptions*>(jropt_handle);
+  auto* cf_handle =
+      reinterpret_cast<ROCKSDB_NAMESPACE::ColumnFamilyHandle*>(jcf_handle);
+
+  char* keys = reinterpret_cast<char*>(env->GetDirectBufferAddress(jkeys));
+  if (keys == nullptr ||
+      env->GetDirectBufferCapacity(jkeys) < (jkeys_off + jkeys_len)) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+        env, "Invalid keys argument");
+    return 0;
+  }
+  char* values = reinterpret_cast<char*>(env->GetDirectBufferAddress(jvalues));
+  if (values == nullptr ||
+      env->GetDirectBufferCapacity(jvalues) < (jvalues_off + jvalues_len)) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+        env, "Invalid values argument");
+    return 0;
+  }
+  keys += jkeys_off;
+  values += jvalues_off;
+
+  const jsize num_keys = env->GetArrayLength(jkey_lens);
+  std::vector<jint> key_lens(num_keys);
+  env->GetIntArrayRegion(jkey_lens, 0, num_keys, key_lens.data());
+  if (env->ExceptionCheck()) {
+    // exception thrown: ArrayIndexOutOfBoundsException
+    return 0;
+  }
+
+  // The keys are sliced out of the buffer, and the values pinned where they
+  // are found, so that each value is copied once, into the buffer
+  std::vector<ROCKSDB_NAMESPACE::Slice> key_slices;
+  key_slices.reserve(num_keys);
+  jint keys_used = 0;
+  for (jsize i = 0; i < num_keys; i++) {
+    if (key_lens[i] < 0 || key_lens[i] > jkeys_len - keys_used) {
+      ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+          env, "Invalid keys argument. The key lengths exceed the buffer.");
+      return 0;
+    }
+    key_slices.emplace_back(keys + keys_used, key_lens[i]);
+    keys_used += key_lens[i];
+  }
+  std::vector<ROCKSDB_NAMESPACE::PinnableSlice> value_slices(num_keys);
+  std::vector<ROCKSDB_NAMESPACE::Status> statuses(num_keys);
+  db->MultiGet(ro_opt == nullptr ? ROCKSDB_NAMESPACE::ReadOptions() : *ro_opt,
+               cf_handle == nullptr ? db->DefaultColumnFamily() : cf_handle,
+               static_cast<size_t>(num_keys), key_slices.data(),
+               value_slices.data(), statuses.data());
+
+  // Copy out the values of the keys in order, as many as fit
+  std::vector<jint> value_lens;
+  value_lens.reserve(num_keys);
+  jint values_used = 0;
+  for (jsize i = 0; i < num_keys; i++) {
+    if (statuses[i].IsNotFound()) {
+      value_lens.push_back(-1);  // RocksDB.NOT_FOUND
+      continue;
+    }
+    if (!statuses[i].ok()) {
+      ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(env, statuses[i]);
+      return 0;
+    }
+    const jint value_len = static_cast<jint>(value_slices[i].size());
+    if (value_len > jvalues_len - values_used) {
+      break;
+    }
+    memcpy(values + values_used, value_slices[i].data(), value_len);
+    value_lens.push_back(value_len);
+    values_used += value_len;
+  }
+
+  const jsize num_copied = static_cast<jsize>(value_lens.size());
+  env->SetIntArrayRegion(jvalue_lens, 0, num_copied, value_lens.data());
+  if (env->ExceptionCheck()) {
+    // exception thrown: ArrayIndexOutOfBoundsException
+    return 0;
+  }
+  return num_copied;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // ROCKSDB_NAMESPACE::DB::KeyMayExist
 bool key_may_exist_helper(JNIEnv* env, jlong jdb_handle, jlong jcf_handle,
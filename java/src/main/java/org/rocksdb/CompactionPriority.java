@@ -33,7 +33,14 @@ public enum CompactionPriority {
    * and its size is the smallest. It in many cases can optimize write
    * amplification.
    */
-  MinOverlappingRatio((byte)0x3);
+  MinOverlappingRatio((byte)0x3),
+
+  /**
+   * First compact files that are read the most times the number of files a
+   * read of their key range has to check, from the sampled read counts of
+   * the files. Try this if reads concentrate on a few key ranges.
+   */
+  ByReadHotness((byte)0x4);
 
 
   private final byte value;
@@ -2544,6 +2544,94 @@ public class RocksDB extends RocksObject {
         keysArray, keyOffsets, keyLengths, cfHandles));
   }
 
+  /**
+   * Gets the values of a batch of keys without copying the keys or values
+   * through Java arrays. The keys are read from, and the values written to,
+   * direct buffers, back to back.
+   *
+   * The values are written in the order of the keys, up to the first one
+   * that does not fit in {@code values}, and the number of keys whose
+   * values were written (or not found) is returned. If it is less than the
+   * number of keys, {@code values} was too small, and the rest of the keys
+   * can be passed to another call.
+   *
+   * @param opt {@link org.rocksdb.ReadOptions} instance.
+   * @param keys the keys, back to back, from the position of the buffer.
+   *     The position is moved past the keys whose values were written.
+   *     Supports direct buffer only.
+   * @param keyLengths the lengths of the keys.
+   * @param values the out-value to receive the values, back to back, from
+   *     the position of the buffer. Limit is set to the end of the values
+   *     written. Supports direct buffer only.
+   * @param valueLengths the out-value to receive the length of each value
+   *     written, or RocksDB.NOT_FOUND if the key was not found. It must be
+   *     at least as long as {@code keyLengths}.
+   * @return the number of keys whose values were written or not found.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   */
+  public int multiGet(final ReadOptions opt, final ByteBuffer keys,
+      final int[] keyLengths, final ByteBuffer values, final int[] valueLengths)
+      throws RocksDBException {
+    return multiGetDirect(opt, keys, keyLengths, values, valueLengths, 0);
+  }
+
+  /**
+   * Gets the values of a batch of keys of a column family without copying
+   * the keys or values through Java arrays. See
+   * {@link #multiGet(ReadOptions, ByteBuffer, int[], ByteBuffer, int[])}.
+   *
+   * @param columnFamilyHandle {@link org.rocksdb.ColumnFamilyHandle}
+   *     instance
+   * @param opt {@link org.rocksdb.ReadOptions} instance.
+   * @param keys the keys, back to back, from the position of the buffer.
+   *     The position is moved past the keys whose values were written.
+   *     Supports direct buffer only.
+   * @param keyLengths the lengths of the keys.
+   * @param values the out-value to receive the values, back to back, from
+   *     the position of the buffer. Limit is set to the end of the values
+   *     written. Supports direct buffer only.
+   * @param valueLengths the out-value to receive the length of each value
+   *     written, or RocksDB.NOT_FOUND if the key was not found. It must be
+   *     at least as long as {@code keyLengths}.
+   * @return the number of keys whose values were written or not found.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   */
+  public int multiGet(final ColumnFamilyHandle columnFamilyHandle,
+      final ReadOptions opt, final ByteBuffer keys, final int[] keyLengths,
+      final ByteBuffer values, final int[] valueLengths)
+      throws RocksDBException {
+    return multiGetDirect(opt, keys, keyLengths, values, valueLengths,
+        columnFamilyHandle.nativeHandle_);
+  }
+
+  private int multiGetDirect(final ReadOptions opt, final ByteBuffer keys,
+      final int[] keyLengths, final ByteBuffer values, final int[] valueLengths,
+      final long cfHandle) throws RocksDBException {
+    assert keys.isDirect() && values.isDirect();
+    if (valueLengths.length < keyLengths.length) {
+      throw new IllegalArgumentException(
+          "There must be a value length for each key.");
+    }
+    final int count = multiGetDirect(nativeHandle_, opt.nativeHandle_, keys,
+        keys.position(), keys.remaining(), keyLengths, values,
+        values.position(), values.remaining(), valueLengths, cfHandle);
+    int keysSize = 0;
+    int valuesSize = 0;
+    for (int i = 0; i < count; i++) {
+      keysSize += keyLengths[i];
+      if (valueLengths[i] != NOT_FOUND) {
+        valuesSize += valueLengths[i];
+      }
+    }
+    keys.position(keys.position() + keysSize);
+    values.limit(values.position() + valuesSize);
+    return count;
+  }
+
   /**
    * If the key definitely does not exist in the database, then this method
    * returns null, else it returns an instance of KeyMayExistResult
@@ -4659,6 +4747,9 @@ public class RocksDB extends RocksObject {
   private native int getDirect(long handle, long readOptHandle, ByteBuffer key, int keyOffset,
       int keyLength, ByteBuffer value, int valueOffset, int valueLength, long cfHandle)
       throws RocksDBException;
+  private native int multiGetDirect(long handle, long readOptHandle, ByteBuffer keys,
+      int keysOffset, int keysLength, int[] keyLengths, ByteBuffer values, int valuesOffset,
+      int valuesLength, int[] valueLengths, long cfHandle) throws RocksDBException;
   private native void deleteDirect(long handle, long optHandle, ByteBuffer key, int keyOffset,
       int keyLength, long cfHandle) throws RocksDBException;
   private native long getLongProperty(final long nativeHandle,
@@ -96,6 +96,47 @@ public class RocksIterator extends AbstractRocksIterator<RocksDB> {
     return result;
   }
 
+  /**
+   * <p>Copies the entries from the current one on into the buffers, the
+   * keys and values back to back, and moves the iterator past them. It
+   * stops at the end of the iteration, after {@code keyLengths.length}
+   * entries, or at the first entry that does not fit in the buffers, which
+   * becomes the current one.</p>
+   *
+   * <p>One call copies a batch of entries, with no Java arrays allocated
+   * for them.</p>
+   *
+   * @param keys the out-value to receive the keys, from the position of the
+   *     buffer. Limit is set to the end of the keys. Supports direct buffer
+   *     only.
+   * @param keyLengths the out-value to receive the lengths of the keys.
+   * @param values the out-value to receive the values, from the position of
+   *     the buffer. Limit is set to the end of the values. Supports direct
+   *     buffer only.
+   * @param valueLengths the out-value to receive the lengths of the values.
+   *     It must be as long as {@code keyLengths}.
+   * @return the number of entries copied. It is 0 at the end of the
+   *     iteration, or if the current entry does not fit in the buffers.
+   *
+   * @throws RocksDBException thrown if the iteration failed.
+   */
+  public int readEntries(final ByteBuffer keys, final int[] keyLengths,
+      final ByteBuffer values, final int[] valueLengths) throws RocksDBException {
+    assert (isOwningHandle() && keys.isDirect() && values.isDirect());
+    final int count = readEntriesDirect0(nativeHandle_, keys, keys.position(),
+        keys.remaining(), keyLengths, values, values.position(), values.remaining(),
+        valueLengths);
+    int keysSize = 0;
+    int valuesSize = 0;
+    for (int i = 0; i < count; i++) {
+      keysSize += keyLengths[i];
+      valuesSize += valueLengths[i];
+    }
+    keys.limit(keys.position() + keysSize);
+    values.limit(values.position() + valuesSize);
+    return count;
+  }
+
   @Override protected final native void disposeInternal(final long handle);
   @Override final native boolean isValid0(long handle);
   @Override final native void seekToFirst0(long handle);
@@ -116,4 +157,7 @@ public class RocksIterator extends AbstractRocksIterator<RocksDB> {
   private native byte[] value0(long handle);
   private native int keyDirect0(long handle, ByteBuffer buffer, int bufferOffset, int bufferLen);
   private native int valueDirect0(long handle, ByteBuffer buffer, int bufferOffset, int bufferLen);
+  private native int readEntriesDirect0(long handle, ByteBuffer keys, int keysOffset,
+      int keysLength, int[] keyLengths, ByteBuffer values, int valuesOffset, int valuesLength,
+      int[] valueLengths) throws RocksDBException;
 }
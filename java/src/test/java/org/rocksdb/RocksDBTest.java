@@ -468,6 +468,41 @@ public class RocksDBTest {
     }
   }
 
+  @Test
+  public void multiGetDirect() throws RocksDBException {
+    try (final RocksDB db = RocksDB.open(dbFolder.getRoot().getAbsolutePath());
+         final ReadOptions rOpt = new ReadOptions()) {
+      db.put("key1".getBytes(), "value".getBytes());
+      db.put("key3".getBytes(), "12345678".getBytes());
+
+      final ByteBuffer keys = ByteBuffer.allocateDirect(12);
+      keys.put("key1key2key3".getBytes()).flip();
+      final int[] keyLengths = {4, 4, 4};
+      final int[] valueLengths = new int[3];
+      ByteBuffer values = ByteBuffer.allocateDirect(16);
+      assertThat(db.multiGet(rOpt, keys, keyLengths, values, valueLengths))
+          .isEqualTo(3);
+      assertThat(valueLengths).containsExactly(5, RocksDB.NOT_FOUND, 8);
+      assertThat(keys.position()).isEqualTo(12);
+      assertThat(values.position()).isEqualTo(0);
+      assertThat(values.limit()).isEqualTo(13);
+      byte[] tmp = new byte[13];
+      values.get(tmp);
+      assertThat(tmp).isEqualTo("value12345678".getBytes());
+
+      // The second value does not fit, so only the first key is done
+      keys.position(0);
+      values = ByteBuffer.allocateDirect(10);
+      assertThat(db.multiGet(db.getDefaultColumnFamily(), rOpt, keys,
+          keyLengths, values, valueLengths)).isEqualTo(2);
+      assertThat(keys.position()).isEqualTo(8);
+      assertThat(values.limit()).isEqualTo(5);
+      tmp = new byte[5];
+      values.get(tmp);
+      assertThat(tmp).isEqualTo("value".getBytes());
+    }
+  }
+
   @Test
   public void merge() throws RocksDBException {
     try (final StringAppendOperator stringAppendOperator = new StringAppendOperator();
@@ -221,4 +221,52 @@ public class RocksIteratorTest {
       }
     }
   }
+
+  @Test
+  public void readEntries() throws RocksDBException {
+    try (final Options options = new Options().setCreateIfMissing(true);
+         final RocksDB db = RocksDB.open(options,
+             dbFolder.getRoot().getAbsolutePath())) {
+      db.put("key1".getBytes(), "value1".getBytes());
+      db.put("key2".getBytes(), "value2".getBytes());
+      db.put("key3".getBytes(), "value3".getBytes());
+
+      try (final RocksIterator iterator = db.newIterator()) {
+        iterator.seekToFirst();
+        final int[] keyLengths = new int[2];
+        final int[] valueLengths = new int[2];
+        ByteBuffer keys = ByteBuffer.allocateDirect(16);
+        ByteBuffer values = ByteBuffer.allocateDirect(16);
+        assertThat(iterator.readEntries(keys, keyLengths, values, valueLengths))
+            .isEqualTo(2);
+        assertThat(keyLengths).containsExactly(4, 4);
+        assertThat(valueLengths).containsExactly(6, 6);
+        assertThat(keys.limit()).isEqualTo(8);
+        assertThat(values.limit()).isEqualTo(12);
+        byte[] tmp = new byte[8];
+        keys.get(tmp);
+        assertThat(tmp).isEqualTo("key1key2".getBytes());
+        tmp = new byte[12];
+        values.get(tmp);
+        assertThat(tmp).isEqualTo("value1value2".getBytes());
+        assertThat(iterator.isValid()).isTrue();
+        assertThat(iterator.key()).isEqualTo("key3".getBytes());
+
+        // The value does not fit, so the iterator stays put
+        keys.clear();
+        values = ByteBuffer.allocateDirect(4);
+        assertThat(iterator.readEntries(keys, keyLengths, values, valueLengths))
+            .isEqualTo(0);
+        assertThat(iterator.key()).isEqualTo("key3".getBytes());
+
+        keys.clear();
+        values = ByteBuffer.allocateDirect(16);
+        assertThat(iterator.readEntries(keys, keyLengths, values, valueLengths))
+            .isEqualTo(1);
+        assertThat(iterator.isValid()).isFalse();
+        assertThat(iterator.readEntries(keys, keyLengths, values, valueLengths))
+            .isEqualTo(0);
+      }
+    }
+  }
 }
@@ -13,10 +13,12 @@
 #endif
 #include <algorithm>
 #include "logging/logging.h"
+#include "monitoring/perf_context_imp.h"
 #include "port/malloc.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
 #include "test_util/sync_point.h"
+#include "util/thread_local.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -29,6 +31,36 @@ const size_t Arena::kMinBlockSize = 4096;
 const size_t Arena::kMaxBlockSize = 2u << 30;
 static const int kAlignUnit = alignof(max_align_t);
 
+namespace {
+// Enough for the arenas of a few iterators of a thread
+const size_t kMaxRecycledBlocks = 16;
+
+struct RecycledBlocks {
+  char* blocks[kMaxRecycledBlocks];
+  size_t num_blocks = 0;
+};
+
+void DeleteRecycledBlocks(void* ptr) {
+  auto recycled = static_cast<RecycledBlocks*>(ptr);
+  for (size_t i = 0; i < recycled->num_blocks; i++) {
+    delete[] recycled->blocks[i];
+  }
+  delete recycled;
+}
+
+RecycledBlocks* GetRecycledBlocks() {
+  // Never destroyed, for threads exiting after static destruction
+  static ThreadLocalPtr* recycled_blocks =
+      new ThreadLocalPtr(&DeleteRecycledBlocks);
+  auto recycled = static_cast<RecycledBlocks*>(recycled_blocks->Get());
+  if (recycled == nullptr) {
+    recycled = new RecycledBlocks();
+    recycled_blocks->Reset(recycled);
+  }
+  return recycled;
+}
+}  // namespace
+
 size_t OptimizeBlockSize(size_t block_size) {
   // Make sure block_size is in optimal range
   block_size = std::max(Arena::kMinBlockSize, block_size);
@@ -72,6 +104,9 @@ Arena::~Arena() {
   for (const auto& block : blocks_) {
     delete[] block;
   }
+  for (const auto& block : recycled_blocks_) {
+    GiveBackRecycledBlock(block);
+  }
 
 #ifdef MAP_HUGETLB
   for (const auto& mmap_info : huge_blocks_) {
@@ -198,6 +233,25 @@ char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
   return result;
 }
 
+char* Arena::TakeRecycledBlock() {
+  RecycledBlocks* recycled = GetRecycledBlocks();
+  if (recycled->num_blocks == 0) {
+    PERF_COUNTER_ADD(arena_block_recycle_miss_count, 1);
+    return new char[kMinBlockSize];
+  }
+  PERF_COUNTER_ADD(arena_block_recycle_hit_count, 1);
+  return recycled->blocks[--recycled->num_blocks];
+}
+
+void Arena::GiveBackRecycledBlock(char* block) {
+  RecycledBlocks* recycled = GetRecycledBlocks();
+  if (recycled->num_blocks == kMaxRecycledBlocks) {
+    delete[] block;
+    return;
+  }
+  recycled->blocks[recycled->num_blocks++] = block;
+}
+
 char* Arena::AllocateNewBlock(size_t block_bytes) {
   // Reserve space in `blocks_` before allocating memory via new.
   // Use `emplace_back()` instead of `reserve()` to let std::vector manage its
@@ -207,9 +261,14 @@ char* Arena::AllocateNewBlock(size_t block_bytes) {
   //   yet.
   // - If `new` throws, no memory leaks because the vector will be cleaned up
   //   via RAII.
-  blocks_.emplace_back(nullptr);
+  const bool recycle = recycle_blocks_ && block_bytes == kMinBlockSize;
+  Blocks& blocks = recycle ? recycled_blocks_ : blocks_;
+  if (!recycle) {
+    block_sizes_.emplace_back(block_bytes);
+  }
+  blocks.emplace_back(nullptr);
 
-  char* block = new char[block_bytes];
+  char* block = recycle ? TakeRecycledBlock() : new char[block_bytes];
   size_t allocated_size;
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
   allocated_size = malloc_usable_size(block);
@@ -226,8 +285,31 @@ char* Arena::AllocateNewBlock(size_t block_bytes) {
   if (tracker_ != nullptr) {
     tracker_->Allocate(allocated_size);
   }
-  blocks_.back() = block;
+  blocks.back() = block;
   return block;
 }
 
+size_t Arena::MoveToNumaNode(int node) {
+  size_t moved = 0;
+  for (size_t i = 0; i < blocks_.size(); i++) {
+    if (port::MoveMemoryToNumaNode(blocks_[i], block_sizes_[i], node)) {
+      moved += block_sizes_[i];
+    }
+  }
+  for (const auto& block : recycled_blocks_) {
+    if (port::MoveMemoryToNumaNode(block, kMinBlockSize, node)) {
+      moved += kMinBlockSize;
+    }
+  }
+#ifdef MAP_HUGETLB
+  for (const auto& mmap_info : huge_blocks_) {
+    if (mmap_info.addr_ != nullptr &&
+        port::MoveMemoryToNumaNode(mmap_info.addr_, mmap_info.length_, node)) {
+      moved += mmap_info.length_;
+    }
+  }
+#endif  // MAP_HUGETLB
+  return moved;
+}
+
 }  // namespace ROCKSDB_NAMESPACE
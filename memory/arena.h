@@ -42,6 +42,23 @@ class Arena : public Allocator {
                  AllocTracker* tracker = nullptr, size_t huge_page_size = 0);
   ~Arena();
 
+  // If true, the blocks of kMinBlockSize the arena allocates are taken from
+  // a small pool of blocks kept by the thread, and given back to the pool of
+  // the thread destroying the arena. This saves short-lived arenas, e.g.
+  // those of iterators, a malloc() and free() per block. Only to be called
+  // before the first block is allocated.
+  void SetRecycleBlocks(bool recycle_blocks) {
+    assert(IsInInlineBlock());
+    recycle_blocks_ = recycle_blocks && kBlockSize == kMinBlockSize;
+  }
+
+  // Returns a block of kMinBlockSize bytes from the pool of the thread, or
+  // a new one if the pool is empty
+  static char* TakeRecycledBlock();
+  // Gives a block from TakeRecycledBlock() back to the pool of the thread,
+  // or frees it if the pool is full
+  static void GiveBackRecycledBlock(char* block);
+
   char* Allocate(size_t bytes) override;
 
   // huge_page_size: if >0, will try to allocate from huage page TLB.
@@ -63,7 +80,8 @@ class Arena : public Allocator {
   // by the arena (exclude the space allocated but not yet used for future
   // allocations).
   size_t ApproximateMemoryUsage() const {
-    return blocks_memory_ + blocks_.capacity() * sizeof(char*) -
+    return blocks_memory_ +
+           (blocks_.capacity() + recycled_blocks_.capacity()) * sizeof(char*) -
            alloc_bytes_remaining_;
   }
 
@@ -78,9 +96,15 @@ class Arena : public Allocator {
   size_t BlockSize() const override { return kBlockSize; }
 
   bool IsInInlineBlock() const {
-    return blocks_.empty();
+    return blocks_.empty() && recycled_blocks_.empty();
   }
 
+  // Migrates the blocks allocated so far to the NUMA node, with
+  // port::MoveMemoryToNumaNode(). Returns the bytes moved. Only meant for
+  // arenas that will not allocate any more, e.g. those of immutable
+  // memtables.
+  size_t MoveToNumaNode(int node);
+
  private:
   char inline_block_[kInlineSize] __attribute__((__aligned__(alignof(max_align_t))));
   // Number of bytes allocated in one block
@@ -88,6 +112,8 @@ class Arena : public Allocator {
   // Array of new[] allocated memory blocks
   typedef std::vector<char*> Blocks;
   Blocks blocks_;
+  // Size of each block in blocks_
+  std::vector<size_t> block_sizes_;
 
   struct MmapInfo {
     void* addr_;
@@ -97,6 +123,9 @@ class Arena : public Allocator {
   };
   std::vector<MmapInfo> huge_blocks_;
   size_t irregular_block_num = 0;
+  // Like blocks_, but given back with GiveBackRecycledBlock()
+  Blocks recycled_blocks_;
+  bool recycle_blocks_ = false;
 
   // Stats for current active block.
   // For each block, we allocate aligned memory chucks from one end and
@@ -8,6 +8,8 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "memory/arena.h"
+#include "rocksdb/perf_context.h"
+#include "rocksdb/perf_level.h"
 #include "test_util/testharness.h"
 #include "util/random.h"
 
@@ -196,6 +198,38 @@ TEST_F(ArenaTest, Simple) {
   SimpleTest(0);
   SimpleTest(kHugePageSize);
 }
+
+TEST_F(ArenaTest, RecycleBlocks) {
+  const uint64_t kNumBlocks = 4;
+  const size_t kAllocSize = Arena::kMinBlockSize / 4;
+  SetPerfLevel(kEnableCount);
+  get_perf_context()->Reset();
+  for (int round = 0; round < 2; round++) {
+    Arena arena;
+    arena.SetRecycleBlocks(true);
+    // The inline block first, then kNumBlocks blocks
+    const size_t num_allocs = (Arena::kInlineSize + kNumBlocks *
+                               Arena::kMinBlockSize) / kAllocSize;
+    for (size_t i = 0; i < num_allocs; i++) {
+      char* p = arena.Allocate(kAllocSize);
+      memset(p, static_cast<int>(i), kAllocSize);
+    }
+    ASSERT_FALSE(arena.IsInInlineBlock());
+  }
+  ASSERT_EQ(kNumBlocks, get_perf_context()->arena_block_recycle_miss_count);
+  ASSERT_EQ(kNumBlocks, get_perf_context()->arena_block_recycle_hit_count);
+
+  // Irregular blocks are not recycled
+  {
+    Arena arena;
+    arena.SetRecycleBlocks(true);
+    arena.Allocate(Arena::kInlineSize);
+    arena.Allocate(2 * Arena::kMinBlockSize);
+    ASSERT_EQ(1U, arena.IrregularBlockNum());
+  }
+  ASSERT_EQ(kNumBlocks, get_perf_context()->arena_block_recycle_miss_count);
+  SetPerfLevel(kDisable);
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -87,6 +87,12 @@ class ConcurrentArena : public Allocator {
 
   size_t BlockSize() const override { return arena_.BlockSize(); }
 
+  // See Arena::MoveToNumaNode()
+  size_t MoveToNumaNode(int node) {
+    std::lock_guard<SpinMutex> lock(arena_mutex_);
+    return arena_.MoveToNumaNode(node);
+  }
+
  private:
   struct Shard {
     char padding[40] ROCKSDB_FIELD_UNUSED;
@@ -5,6 +5,7 @@
 
 #include "memory/jemalloc_nodump_allocator.h"
 
+#include <cinttypes>
 #include <string>
 #include <thread>
 
@@ -14,17 +15,25 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+const std::string MemoryAllocator::kAllocatedProperty = "allocated";
+const std::string MemoryAllocator::kActiveProperty = "active";
+const std::string MemoryAllocator::kResidentProperty = "resident";
+const std::string MemoryAllocator::kStatsProperty = "stats";
+
 #ifdef ROCKSDB_JEMALLOC_NODUMP_ALLOCATOR
 
 std::atomic<extent_alloc_t*> JemallocNodumpAllocator::original_alloc_{nullptr};
 
 JemallocNodumpAllocator::JemallocNodumpAllocator(
     JemallocAllocatorOptions& options,
-    std::unique_ptr<extent_hooks_t>&& arena_hooks, unsigned arena_index)
+    std::vector<std::unique_ptr<extent_hooks_t>>&& arena_hooks,
+    std::vector<unsigned>&& arena_indexes)
     : options_(options),
       arena_hooks_(std::move(arena_hooks)),
-      arena_index_(arena_index),
-      tcache_(&JemallocNodumpAllocator::DestroyThreadSpecificCache) {}
+      arena_indexes_(std::move(arena_indexes)),
+      tcache_(&JemallocNodumpAllocator::DestroyThreadSpecificCache) {
+  assert(!arena_indexes_.empty());
+}
 
 int JemallocNodumpAllocator::GetThreadSpecificCache(size_t size) {
   // We always enable tcache. The only corner case is when there are a ton of
@@ -52,8 +61,12 @@ int JemallocNodumpAllocator::GetThreadSpecificCache(size_t size) {
 }
 
 void* JemallocNodumpAllocator::Allocate(size_t size) {
+  size_t granularity = options_.size_class_granularity;
+  if (granularity > 0 && size > granularity) {
+    size = (size + granularity - 1) / granularity * granularity;
+  }
   int tcache_flag = GetThreadSpecificCache(size);
-  return mallocx(size, MALLOCX_ARENA(arena_index_) | tcache_flag);
+  return mallocx(size, MALLOCX_ARENA(GetArenaIndex()) | tcache_flag);
 }
 
 void JemallocNodumpAllocator::Deallocate(void* p) {
@@ -89,6 +102,52 @@ void* JemallocNodumpAllocator::Alloc(extent_hooks_t* extent, void* new_addr,
   return result;
 }
 
+Status JemallocNodumpAllocator::CreateArena(
+    unsigned* arena_index, std::unique_ptr<extent_hooks_t>* hooks) {
+  // Create arena.
+  size_t arena_index_size = sizeof(*arena_index);
+  int ret =
+      mallctl("arenas.create", arena_index, &arena_index_size, nullptr, 0);
+  if (ret != 0) {
+    return Status::Incomplete("Failed to create jemalloc arena, error code: " +
+                              ToString(ret));
+  }
+  assert(*arena_index != 0);
+
+  // Read existing hooks.
+  std::string key = "arena." + ToString(*arena_index) + ".extent_hooks";
+  extent_hooks_t* existing_hooks;
+  size_t hooks_size = sizeof(existing_hooks);
+  ret = mallctl(key.c_str(), &existing_hooks, &hooks_size, nullptr, 0);
+  if (ret != 0) {
+    DestroyArena(*arena_index);
+    return Status::Incomplete("Failed to read existing hooks, error code: " +
+                              ToString(ret));
+  }
+
+  // Store existing alloc.
+  extent_alloc_t* original_alloc = existing_hooks->alloc;
+  extent_alloc_t* expected = nullptr;
+  bool success =
+      original_alloc_.compare_exchange_strong(expected, original_alloc);
+  if (!success && original_alloc != expected) {
+    DestroyArena(*arena_index);
+    return Status::Incomplete("Original alloc conflict.");
+  }
+
+  // Set the custom hook.
+  hooks->reset(new extent_hooks_t(*existing_hooks));
+  (*hooks)->alloc = &JemallocNodumpAllocator::Alloc;
+  extent_hooks_t* hooks_ptr = hooks->get();
+  ret = mallctl(key.c_str(), nullptr, nullptr, &hooks_ptr, sizeof(hooks_ptr));
+  if (ret != 0) {
+    DestroyArena(*arena_index);
+    return Status::Incomplete("Failed to set custom hook, error code: " +
+                              ToString(ret));
+  }
+  return Status::OK();
+}
+
 Status JemallocNodumpAllocator::DestroyArena(unsigned arena_index) {
   assert(arena_index != 0);
   std::string key = "arena." + ToString(arena_index) + ".destroy";
@@ -118,15 +177,79 @@ JemallocNodumpAllocator::~JemallocNodumpAllocator() {
   for (void* tcache_index : tcache_list) {
     DestroyThreadSpecificCache(tcache_index);
   }
-  // Destroy arena. Silently ignore error.
-  Status s __attribute__((__unused__)) = DestroyArena(arena_index_);
-  assert(s.ok());
+  // Destroy arenas. Silently ignore error.
+  for (unsigned arena_index : arena_indexes_) {
+    Status s __attribute__((__unused__)) = DestroyArena(arena_index);
+    assert(s.ok());
+  }
 }
 
 size_t JemallocNodumpAllocator::UsableSize(void* p,
                                            size_t /*allocation_size*/) const {
   return malloc_usable_size(static_cast<void*>(p));
 }
+
+bool JemallocNodumpAllocator::GetArenaStats(size_t* allocated, size_t* active,
+                                            size_t* resident) const {
+  // The statistics are a snapshot taken when the epoch advances
+  uint64_t epoch = 1;
+  size_t epoch_size = sizeof(epoch);
+  if (mallctl("epoch", &epoch, &epoch_size, &epoch, epoch_size) != 0) {
+    return false;
+  }
+  size_t page_size = 0;
+  size_t value_size = sizeof(page_size);
+  if (mallctl("arenas.page", &page_size, &value_size, nullptr, 0) != 0) {
+    return false;
+  }
+  *allocated = *active = *resident = 0;
+  for (unsigned arena_index : arena_indexes_) {
+    std::string prefix = "stats.arenas." + ToString(arena_index) + ".";
+    size_t small = 0, large = 0, pactive = 0, arena_resident = 0;
+    value_size = sizeof(size_t);
+    if (mallctl((prefix + "small.allocated").c_str(), &small, &value_size,
+                nullptr, 0) != 0 ||
+        mallctl((prefix + "large.allocated").c_str(), &large, &value_size,
+                nullptr, 0) != 0 ||
+        mallctl((prefix + "pactive").c_str(), &pactive, &value_size, nullptr,
+                0) != 0 ||
+        mallctl((prefix + "resident").c_str(), &arena_resident, &value_size,
+                nullptr, 0) != 0) {
+      return false;
+    }
+    *allocated += small + large;
+    *active += pactive * page_size;
+    *resident += arena_resident;
+  }
+  return true;
+}
+
+bool JemallocNodumpAllocator::GetProperty(const std::string& property,
+                                          std::string* value) const {
+  size_t allocated, active, resident;
+  if (!GetArenaStats(&allocated, &active, &resident)) {
+    return false;
+  }
+  if (property == kAllocatedProperty) {
+    *value = ToString(allocated);
+  } else if (property == kActiveProperty) {
+    *value = ToString(active);
+  } else if (property == kResidentProperty) {
+    *value = ToString(resident);
+  } else if (property == kStatsProperty) {
+    char buf[200];
+    snprintf(buf, sizeof(buf),
+             "arenas: %" ROCKSDB_PRIszt " allocated: %" ROCKSDB_PRIszt
+             " active: %" ROCKSDB_PRIszt " resident: %" ROCKSDB_PRIszt
+             " fragmentation: %.1f%%",
+             arena_indexes_.size(), allocated, active, resident,
+             active > allocated ? 100.0 * (active - allocated) / active : 0.0);
+    *value = buf;
+  } else {
+    return false;
+  }
+  return true;
+}
 #endif  // ROCKSDB_JEMALLOC_NODUMP_ALLOCATOR
 
 Status NewJemallocNodumpAllocator(
@@ -152,53 +275,29 @@ Status NewJemallocNodumpAllocator(
         "tcache_size_lower_bound larger or equal to tcache_size_upper_bound.");
   }
 
-  // Create arena.
-  unsigned arena_index = 0;
-  size_t arena_index_size = sizeof(arena_index);
-  int ret =
-      mallctl("arenas.create", &arena_index, &arena_index_size, nullptr, 0);
-  if (ret != 0) {
-    return Status::Incomplete("Failed to create jemalloc arena, error code: " +
-                              ToString(ret));
-  }
-  assert(arena_index != 0);
-
-  // Read existing hooks.
-  std::string key = "arena." + ToString(arena_index) + ".extent_hooks";
-  extent_hooks_t* hooks;
-  size_t hooks_size = sizeof(hooks);
-  ret = mallctl(key.c_str(), &hooks, &hooks_size, nullptr, 0);
-  if (ret != 0) {
-    JemallocNodumpAllocator::DestroyArena(arena_index);
-    return Status::Incomplete("Failed to read existing hooks, error code: " +
-                              ToString(ret));
-  }
-
-  // Store existing alloc.
-  extent_alloc_t* original_alloc = hooks->alloc;
-  extent_alloc_t* expected = nullptr;
-  bool success =
-      JemallocNodumpAllocator::original_alloc_.compare_exchange_strong(
-          expected, original_alloc);
-  if (!success && original_alloc != expected) {
-    JemallocNodumpAllocator::DestroyArena(arena_index);
-    return Status::Incomplete("Original alloc conflict.");
+  if (options.num_arenas == 0) {
+    return Status::InvalidArgument("num_arenas must be positive.");
   }
 
-  // Set the custom hook.
-  std::unique_ptr<extent_hooks_t> new_hooks(new extent_hooks_t(*hooks));
-  new_hooks->alloc = &JemallocNodumpAllocator::Alloc;
-  extent_hooks_t* hooks_ptr = new_hooks.get();
-  ret = mallctl(key.c_str(), nullptr, nullptr, &hooks_ptr, sizeof(hooks_ptr));
-  if (ret != 0) {
-    JemallocNodumpAllocator::DestroyArena(arena_index);
-    return Status::Incomplete("Failed to set custom hook, error code: " +
-                              ToString(ret));
+  std::vector<std::unique_ptr<extent_hooks_t>> arena_hooks;
+  std::vector<unsigned> arena_indexes;
+  for (size_t i = 0; i < options.num_arenas; i++) {
+    unsigned arena_index = 0;
+    std::unique_ptr<extent_hooks_t> hooks;
+    Status s = JemallocNodumpAllocator::CreateArena(&arena_index, &hooks);
+    if (!s.ok()) {
+      for (unsigned created : arena_indexes) {
+        JemallocNodumpAllocator::DestroyArena(created);
+      }
+      return s;
+    }
+    arena_hooks.push_back(std::move(hooks));
+    arena_indexes.push_back(arena_index);
   }
 
   // Create cache allocator.
-  memory_allocator->reset(
-      new JemallocNodumpAllocator(options, std::move(new_hooks), arena_index));
+  memory_allocator->reset(new JemallocNodumpAllocator(
+      options, std::move(arena_hooks), std::move(arena_indexes)));
   return Status::OK();
 #endif  // ROCKSDB_JEMALLOC_NODUMP_ALLOCATOR
 }
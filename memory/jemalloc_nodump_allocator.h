@@ -6,6 +6,7 @@
 #pragma once
 
 #include <atomic>
+#include <string>
 #include <vector>
 
 #include "port/jemalloc_helper.h"
@@ -24,15 +25,18 @@ namespace ROCKSDB_NAMESPACE {
 
 class JemallocNodumpAllocator : public MemoryAllocator {
  public:
-  JemallocNodumpAllocator(JemallocAllocatorOptions& options,
-                          std::unique_ptr<extent_hooks_t>&& arena_hooks,
-                          unsigned arena_index);
+  JemallocNodumpAllocator(
+      JemallocAllocatorOptions& options,
+      std::vector<std::unique_ptr<extent_hooks_t>>&& arena_hooks,
+      std::vector<unsigned>&& arena_indexes);
   ~JemallocNodumpAllocator();
 
   const char* Name() const override { return "JemallocNodumpAllocator"; }
   void* Allocate(size_t size) override;
   void Deallocate(void* p) override;
   size_t UsableSize(void* p, size_t allocation_size) const override;
+  bool GetProperty(const std::string& property,
+                   std::string* value) const override;
 
  private:
   friend Status NewJemallocNodumpAllocator(
@@ -44,6 +48,11 @@ class JemallocNodumpAllocator : public MemoryAllocator {
                      size_t alignment, bool* zero, bool* commit,
                      unsigned arena_ind);
 
+  // Create an arena whose alloc hook is Alloc(). The hooks have to outlive
+  // it.
+  static Status CreateArena(unsigned* arena_index,
+                            std::unique_ptr<extent_hooks_t>* hooks);
+
   // Destroy arena on destruction of the allocator, or on failure.
   static Status DestroyArena(unsigned arena_index);
 
@@ -54,6 +63,20 @@ class JemallocNodumpAllocator : public MemoryAllocator {
   // either MALLOCX_TCACHE_NONE or MALLOCX_TCACHE(tc).
   int GetThreadSpecificCache(size_t size);
 
+  // The arena of the current CPU
+  unsigned GetArenaIndex() const {
+    if (arena_indexes_.size() == 1) {
+      return arena_indexes_[0];
+    }
+    int cpu = port::PhysicalCoreID();
+    return arena_indexes_[cpu < 0 ? 0 : cpu % arena_indexes_.size()];
+  }
+
+  // Sums the statistics of the arenas, in bytes. Returns false if jemalloc
+  // keeps no statistics.
+  bool GetArenaStats(size_t* allocated, size_t* active,
+                     size_t* resident) const;
+
   // A function pointer to jemalloc default alloc. Use atomic to make sure
   // NewJemallocNodumpAllocator is thread-safe.
   //
@@ -64,10 +87,10 @@ class JemallocNodumpAllocator : public MemoryAllocator {
   const JemallocAllocatorOptions options_;
 
   // Custom hooks has to outlive corresponding arena.
-  const std::unique_ptr<extent_hooks_t> arena_hooks_;
+  const std::vector<std::unique_ptr<extent_hooks_t>> arena_hooks_;
 
-  // Arena index.
-  const unsigned arena_index_;
+  // Arena indexes, one per CPU group
+  const std::vector<unsigned> arena_indexes_;
 
   // Hold thread-local tcache index.
   ThreadLocalPtr tcache_;
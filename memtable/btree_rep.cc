@@ -0,0 +1,584 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#ifndef ROCKSDB_LITE
+#include <atomic>
+
+#include "db/memtable.h"
+#include "memory/allocator.h"
+#include "memory/arena.h"
+#include "port/port.h"
+#include "rocksdb/memtablerep.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+
+// A B+tree of memtable keys. Inserts may run concurrently and reads never
+// block, through optimistic lock coupling: every node carries a version that
+// a writer locks and bumps, and readers read nodes without locking and retry
+// when the version changed under them. Nodes are allocated from the
+// memtable's allocator and are never freed or merged, so a reader may look
+// at a stale node at any time, and keys only ever move right, to a new node
+// linked after the one they leave.
+//
+// Invariant: keys[i] of an inner node is the first key of the leftmost leaf
+// under children[i + 1]. The first key of a leaf never changes, except for
+// the leftmost leaf.
+class BTreeRep : public MemTableRep {
+ public:
+  BTreeRep(const MemTableRep::KeyComparator& compare, Allocator* allocator)
+      : MemTableRep(allocator), cmp_(compare), root_(NewLeaf()) {}
+
+  void Insert(KeyHandle handle) override {
+    InsertKeyInternal(static_cast<const char*>(handle));
+  }
+
+  bool InsertKey(KeyHandle handle) override {
+    return InsertKeyInternal(static_cast<const char*>(handle));
+  }
+
+  bool InsertKeyWithHint(KeyHandle handle, void** /*hint*/) override {
+    return InsertKeyInternal(static_cast<const char*>(handle));
+  }
+
+  void InsertConcurrently(KeyHandle handle) override { Insert(handle); }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    return InsertKeyInternal(static_cast<const char*>(handle));
+  }
+
+  bool InsertKeyWithHintConcurrently(KeyHandle handle,
+                                     void** /*hint*/) override {
+    return InsertKeyInternal(static_cast<const char*>(handle));
+  }
+
+  bool Contains(const char* key) const override {
+    Iterator iter(this);
+    iter.Seek(Slice(), key);
+    return iter.Valid() && cmp_(iter.key(), key) == 0;
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override {
+    Iterator iter(this);
+    for (iter.Seek(Slice(), k.memtable_key().data());
+         iter.Valid() && callback_func(callback_args, iter.key());
+         iter.Next()) {
+    }
+  }
+
+  ~BTreeRep() override {}
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    void* mem = arena ? arena->AllocateAligned(sizeof(BTreeRep::Iterator))
+                      : operator new(sizeof(BTreeRep::Iterator));
+    return new (mem) BTreeRep::Iterator(this);
+  }
+
+ private:
+  // Node sizes are picked so that a node spans four cache lines
+  static const int kLeafKeys = 29;
+  static const int kInnerKeys = 14;
+
+  struct Node {
+    explicit Node(bool _leaf) : version(0), count(0), leaf(_leaf) {}
+    // Bit 1 is the write lock, the bits above count the modifications
+    std::atomic<uint64_t> version;
+    std::atomic<int> count;
+    const bool leaf;
+  };
+
+  struct Leaf : public Node {
+    Leaf() : Node(true), next(nullptr) {
+      for (auto& key : keys) {
+        key.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+    std::atomic<Leaf*> next;
+    std::atomic<const char*> keys[kLeafKeys];
+  };
+
+  struct Inner : public Node {
+    Inner() : Node(false) {
+      for (auto& key : keys) {
+        key.store(nullptr, std::memory_order_relaxed);
+      }
+      for (auto& child : children) {
+        child.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+    std::atomic<const char*> keys[kInnerKeys];
+    std::atomic<Node*> children[kInnerKeys + 1];
+  };
+
+  // A consistent copy of a leaf, what iterators read from
+  struct LeafSnapshot {
+    const char* keys[kLeafKeys];
+    int count = 0;
+    Leaf* next = nullptr;
+  };
+
+  enum class Descent {
+    // To the leaf that holds the first key >= target
+    kGreaterOrEqual,
+    // To the leaf that holds the last key < target
+    kLess,
+    kFirst,
+    kLast,
+  };
+
+  static bool IsLocked(uint64_t version) { return (version & 2) != 0; }
+
+  // Waits for n to be unlocked and returns its version
+  static uint64_t ReadLock(const Node* n) {
+    uint64_t version = n->version.load(std::memory_order_acquire);
+    while (IsLocked(version)) {
+      port::AsmVolatilePause();
+      version = n->version.load(std::memory_order_acquire);
+    }
+    return version;
+  }
+
+  // Returns true if n did not change since ReadLock returned version
+  static bool Validate(const Node* n, uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return n->version.load(std::memory_order_relaxed) == version;
+  }
+
+  // Write locks n if it did not change since ReadLock returned version
+  static bool UpgradeLock(Node* n, uint64_t version) {
+    return n->version.compare_exchange_strong(version, version + 2,
+                                              std::memory_order_acq_rel);
+  }
+
+  static void Unlock(Node* n) {
+    n->version.fetch_add(2, std::memory_order_release);
+  }
+
+  template <class T>
+  T* NewNode() {
+    // Align to the cache line so that no node straddles one more than needed
+    char* mem = allocator_->AllocateAligned(sizeof(T) + CACHE_LINE_SIZE - 1);
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(mem) + CACHE_LINE_SIZE -
+                         1) & ~static_cast<uintptr_t>(CACHE_LINE_SIZE - 1);
+    return new (reinterpret_cast<void*>(aligned)) T();
+  }
+
+  Leaf* NewLeaf() { return NewNode<Leaf>(); }
+
+  // Returns the index of the first of keys[0, count) that is > target if
+  // inclusive, or >= target otherwise. Returns -1 if an optimistic read found
+  // a slot not written yet.
+  int Search(const std::atomic<const char*>* keys, int count,
+             const char* target, bool inclusive) const {
+    int lo = 0;
+    int hi = count;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      const char* key = keys[mid].load(std::memory_order_acquire);
+      if (key == nullptr) {
+        return -1;
+      }
+      int c = cmp_(key, target);
+      if (c < 0 || (inclusive && c == 0)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  int ChildIndex(const Inner* inner, int count, const char* target,
+                 Descent descent) const {
+    switch (descent) {
+      case Descent::kGreaterOrEqual:
+        return Search(inner->keys, count, target, true /* inclusive */);
+      case Descent::kLess:
+        return Search(inner->keys, count, target, false /* inclusive */);
+      case Descent::kFirst:
+        return 0;
+      case Descent::kLast:
+        return count;
+    }
+    return -1;
+  }
+
+  // Returns the leaf to start the search for target at, see Descent. The leaf
+  // may have split since, the keys it lost are in the leaves after it.
+  Leaf* FindLeaf(const char* target, Descent descent) const {
+    while (true) {
+      Node* node = root_.load(std::memory_order_acquire);
+      uint64_t version = ReadLock(node);
+      bool restart = node != root_.load(std::memory_order_acquire);
+      while (!restart && !node->leaf) {
+        const Inner* inner = static_cast<const Inner*>(node);
+        int count = inner->count.load(std::memory_order_relaxed);
+        int index = ChildIndex(inner, count, target, descent);
+        Node* child = index < 0 ? nullptr
+                                : inner->children[index].load(
+                                      std::memory_order_acquire);
+        if (child == nullptr || !Validate(inner, version)) {
+          restart = true;
+          break;
+        }
+        uint64_t child_version = ReadLock(child);
+        // The child may have split before it was read locked
+        if (!Validate(inner, version)) {
+          restart = true;
+          break;
+        }
+        node = child;
+        version = child_version;
+      }
+      if (!restart) {
+        return static_cast<Leaf*>(node);
+      }
+    }
+  }
+
+  void LoadLeaf(const Leaf* leaf, LeafSnapshot* snapshot) const {
+    while (true) {
+      uint64_t version = ReadLock(leaf);
+      int count = leaf->count.load(std::memory_order_relaxed);
+      bool complete = true;
+      for (int i = 0; i < count; i++) {
+        snapshot->keys[i] = leaf->keys[i].load(std::memory_order_acquire);
+        complete = complete && snapshot->keys[i] != nullptr;
+      }
+      snapshot->next = leaf->next.load(std::memory_order_acquire);
+      snapshot->count = count;
+      if (complete && Validate(leaf, version)) {
+        return;
+      }
+    }
+  }
+
+  bool InsertKeyInternal(const char* key) {
+    while (true) {
+      int result = TryInsert(key);
+      if (result >= 0) {
+        return result > 0;
+      }
+    }
+  }
+
+  // Returns 1 if key was inserted, 0 if it was already present and -1 if the
+  // insert has to be retried
+  int TryInsert(const char* key) {
+    Node* node = root_.load(std::memory_order_acquire);
+    uint64_t version = ReadLock(node);
+    if (node != root_.load(std::memory_order_acquire)) {
+      // The root split, node only covers part of the keys now
+      return -1;
+    }
+    Inner* parent = nullptr;
+    uint64_t parent_version = 0;
+
+    while (!node->leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      int count = inner->count.load(std::memory_order_relaxed);
+      if (count == kInnerKeys) {
+        // Full inner nodes are split on the way down, so the parent of a
+        // node that splits always has room for the new separator
+        if (!LockForSplit(parent, parent_version, inner, version)) {
+          return -1;
+        }
+        const char* separator;
+        Inner* right = SplitInner(inner, &separator);
+        AddChild(parent, inner, separator, right);
+        return -1;
+      }
+      int index = ChildIndex(inner, count, key, Descent::kGreaterOrEqual);
+      Node* child =
+          index < 0 ? nullptr
+                    : inner->children[index].load(std::memory_order_acquire);
+      if (child == nullptr || !Validate(inner, version)) {
+        return -1;
+      }
+      uint64_t child_version = ReadLock(child);
+      // The child may have split before it was read locked, and no longer
+      // cover key
+      if (!Validate(inner, version)) {
+        return -1;
+      }
+      parent = inner;
+      parent_version = version;
+      node = child;
+      version = child_version;
+    }
+
+    Leaf* leaf = static_cast<Leaf*>(node);
+    if (leaf->count.load(std::memory_order_relaxed) == kLeafKeys) {
+      if (!LockForSplit(parent, parent_version, leaf, version)) {
+        return -1;
+      }
+      const char* separator;
+      Leaf* right = SplitLeaf(leaf, &separator);
+      AddChild(parent, leaf, separator, right);
+      return -1;
+    }
+    if (!UpgradeLock(leaf, version)) {
+      return -1;
+    }
+    int count = leaf->count.load(std::memory_order_relaxed);
+    int pos = Search(leaf->keys, count, key, false /* inclusive */);
+    assert(pos >= 0);
+    if (pos < count &&
+        cmp_(leaf->keys[pos].load(std::memory_order_relaxed), key) == 0) {
+      Unlock(leaf);
+      return 0;
+    }
+    for (int i = count; i > pos; i--) {
+      leaf->keys[i].store(leaf->keys[i - 1].load(std::memory_order_relaxed),
+                          std::memory_order_release);
+    }
+    leaf->keys[pos].store(key, std::memory_order_release);
+    leaf->count.store(count + 1, std::memory_order_relaxed);
+    Unlock(leaf);
+    return 1;
+  }
+
+  // Write locks the node to split and its parent, if any. Without a parent
+  // the node is the root: a root that split since would have a new version.
+  bool LockForSplit(Inner* parent, uint64_t parent_version, Node* node,
+                    uint64_t version) {
+    if (parent != nullptr && !UpgradeLock(parent, parent_version)) {
+      return false;
+    }
+    if (!UpgradeLock(node, version)) {
+      if (parent != nullptr) {
+        Unlock(parent);
+      }
+      return false;
+    }
+    assert(parent != nullptr || root_.load(std::memory_order_relaxed) == node);
+    return true;
+  }
+
+  // Moves the upper half of leaf to a new leaf linked after it.
+  // REQUIRES: leaf is write locked
+  Leaf* SplitLeaf(Leaf* leaf, const char** separator) {
+    Leaf* right = NewLeaf();
+    int count = leaf->count.load(std::memory_order_relaxed);
+    int half = count / 2;
+    for (int i = half; i < count; i++) {
+      right->keys[i - half].store(leaf->keys[i].load(std::memory_order_relaxed),
+                                  std::memory_order_release);
+    }
+    right->count.store(count - half, std::memory_order_relaxed);
+    right->next.store(leaf->next.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+    leaf->next.store(right, std::memory_order_release);
+    leaf->count.store(half, std::memory_order_relaxed);
+    *separator = right->keys[0].load(std::memory_order_relaxed);
+    return right;
+  }
+
+  // Moves the keys and children after the middle key of inner to a new inner
+  // node. The middle key becomes the separator.
+  // REQUIRES: inner is write locked
+  Inner* SplitInner(Inner* inner, const char** separator) {
+    Inner* right = NewNode<Inner>();
+    int count = inner->count.load(std::memory_order_relaxed);
+    int mid = count / 2;
+    *separator = inner->keys[mid].load(std::memory_order_relaxed);
+    for (int i = mid + 1; i < count; i++) {
+      right->keys[i - mid - 1].store(
+          inner->keys[i].load(std::memory_order_relaxed),
+          std::memory_order_release);
+    }
+    for (int i = mid + 1; i <= count; i++) {
+      right->children[i - mid - 1].store(
+          inner->children[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    right->count.store(count - mid - 1, std::memory_order_relaxed);
+    inner->count.store(mid, std::memory_order_relaxed);
+    return right;
+  }
+
+  // Links right, split off left, into parent, or into a new root if left was
+  // the root, and unlocks both.
+  // REQUIRES: left and parent are write locked, parent is not full
+  void AddChild(Inner* parent, Node* left, const char* separator,
+                Node* right) {
+    if (parent == nullptr) {
+      Inner* root = NewNode<Inner>();
+      root->keys[0].store(separator, std::memory_order_release);
+      root->children[0].store(left, std::memory_order_relaxed);
+      root->children[1].store(right, std::memory_order_relaxed);
+      root->count.store(1, std::memory_order_relaxed);
+      root_.store(root, std::memory_order_release);
+      Unlock(left);
+      return;
+    }
+    int count = parent->count.load(std::memory_order_relaxed);
+    assert(count < kInnerKeys);
+    int pos = Search(parent->keys, count, separator, true /* inclusive */);
+    assert(pos >= 0);
+    for (int i = count; i > pos; i--) {
+      parent->keys[i].store(parent->keys[i - 1].load(std::memory_order_relaxed),
+                            std::memory_order_release);
+      parent->children[i + 1].store(
+          parent->children[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    parent->keys[pos].store(separator, std::memory_order_release);
+    parent->children[pos + 1].store(right, std::memory_order_release);
+    parent->count.store(count + 1, std::memory_order_relaxed);
+    Unlock(left);
+    Unlock(parent);
+  }
+
+ public:
+  // Iterates over consistent copies of the leaves, so it never blocks
+  // writers. Keys inserted after a leaf was copied may be missed.
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(const BTreeRep* rep) : rep_(rep), pos_(0) {}
+
+    ~Iterator() override {}
+
+    bool Valid() const override { return pos_ >= 0 && pos_ < leaf_.count; }
+
+    const char* key() const override {
+      assert(Valid());
+      return leaf_.keys[pos_];
+    }
+
+    void Next() override {
+      assert(Valid());
+      pos_++;
+      SkipExhaustedLeaves();
+    }
+
+    void Prev() override {
+      assert(Valid());
+      if (pos_ > 0) {
+        pos_--;
+        return;
+      }
+      SeekLessThan(leaf_.keys[pos_]);
+    }
+
+    void Seek(const Slice& internal_key, const char* memtable_key) override {
+      const char* target = memtable_key != nullptr
+                               ? memtable_key
+                               : EncodeKey(&tmp_, internal_key);
+      rep_->LoadLeaf(rep_->FindLeaf(target, Descent::kGreaterOrEqual), &leaf_);
+      pos_ = rep_->Search(leaf_, target, false /* inclusive */);
+      SkipExhaustedLeaves();
+    }
+
+    void SeekForPrev(const Slice& internal_key,
+                     const char* memtable_key) override {
+      const char* target = memtable_key != nullptr
+                               ? memtable_key
+                               : EncodeKey(&tmp_, internal_key);
+      rep_->LoadLeaf(rep_->FindLeaf(target, Descent::kGreaterOrEqual), &leaf_);
+      pos_ = rep_->Search(leaf_, target, true /* inclusive */) - 1;
+      FollowSplitsBelow(target, true /* inclusive */);
+    }
+
+    void SeekToFirst() override {
+      rep_->LoadLeaf(rep_->FindLeaf(nullptr, Descent::kFirst), &leaf_);
+      pos_ = 0;
+      SkipExhaustedLeaves();
+    }
+
+    void SeekToLast() override {
+      rep_->LoadLeaf(rep_->FindLeaf(nullptr, Descent::kLast), &leaf_);
+      LeafSnapshot next;
+      while (leaf_.next != nullptr) {
+        rep_->LoadLeaf(leaf_.next, &next);
+        if (next.count == 0) {
+          break;
+        }
+        leaf_ = next;
+      }
+      pos_ = leaf_.count > 0 ? leaf_.count - 1 : 0;
+    }
+
+   private:
+    // Moves on to the next non-empty leaf if pos_ is past the current one
+    void SkipExhaustedLeaves() {
+      while (pos_ >= leaf_.count && leaf_.next != nullptr) {
+        rep_->LoadLeaf(leaf_.next, &leaf_);
+        pos_ = 0;
+      }
+    }
+
+    // Positions at the last key < target
+    void SeekLessThan(const char* target) {
+      rep_->LoadLeaf(rep_->FindLeaf(target, Descent::kLess), &leaf_);
+      pos_ = rep_->Search(leaf_, target, false /* inclusive */) - 1;
+      FollowSplitsBelow(target, false /* inclusive */);
+    }
+
+    // Moves to a later leaf while its first key is still below target, for
+    // when the leaf split after it was found. Then pos_ is the last key
+    // below target, or the iterator is invalid if there is none.
+    void FollowSplitsBelow(const char* target, bool inclusive) {
+      LeafSnapshot next;
+      while (leaf_.next != nullptr) {
+        rep_->LoadLeaf(leaf_.next, &next);
+        int below = rep_->Search(next, target, inclusive);
+        if (below == 0) {
+          break;
+        }
+        leaf_ = next;
+        pos_ = below - 1;
+      }
+      if (pos_ < 0) {
+        // Only the leftmost leaf can start past target
+        leaf_.count = 0;
+        leaf_.next = nullptr;
+        pos_ = 0;
+      }
+    }
+
+    const BTreeRep* rep_;
+    LeafSnapshot leaf_;
+    int pos_;
+    std::string tmp_;  // For passing to EncodeKey
+  };
+
+ private:
+  // Search() over a snapshot, which never has unwritten slots
+  int Search(const LeafSnapshot& leaf, const char* target,
+             bool inclusive) const {
+    int lo = 0;
+    int hi = leaf.count;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      int c = cmp_(leaf.keys[mid], target);
+      if (c < 0 || (inclusive && c == 0)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  const MemTableRep::KeyComparator& cmp_;
+  std::atomic<Node*> root_;
+};
+}  // namespace
+
+MemTableRep* BTreeRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* /*transform*/, Logger* /*logger*/) {
+  return new BTreeRep(compare, allocator);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,222 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "memory/concurrent_arena.h"
+#include "rocksdb/memtablerep.h"
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Our test B+tree stores 8-byte unsigned integers
+typedef uint64_t Key;
+
+static Key Decode(const char* key) {
+  Key rv;
+  memcpy(&rv, key, sizeof(Key));
+  return rv;
+}
+
+class TestComparator : public MemTableRep::KeyComparator {
+ public:
+  int operator()(const char* a, const char* b) const override {
+    return Compare(Decode(a), Decode(b));
+  }
+
+  int operator()(const char* a, const Slice& b) const override {
+    return Compare(Decode(a), Decode(b.data()));
+  }
+
+ private:
+  static int Compare(Key a, Key b) { return a < b ? -1 : (a > b ? +1 : 0); }
+};
+
+class BTreeRepTest : public testing::Test {
+ public:
+  BTreeRepTest() {
+    BTreeRepFactory factory;
+    rep_.reset(factory.CreateMemTableRep(cmp_, &arena_, nullptr, nullptr));
+  }
+
+  // Allocates key the way MemTable does
+  char* NewKey(Key key) {
+    char* buf;
+    rep_->Allocate(sizeof(Key), &buf);
+    memcpy(buf, &key, sizeof(Key));
+    return buf;
+  }
+
+  bool Insert(Key key) { return rep_->InsertKey(NewKey(key)); }
+
+  bool InsertConcurrently(Key key) {
+    return rep_->InsertKeyConcurrently(NewKey(key));
+  }
+
+  bool Contains(Key key) { return rep_->Contains(NewKey(key)); }
+
+  // Checks the iterator against model at every key and between keys
+  void Verify(const std::set<Key>& model, Key max_key) {
+    std::unique_ptr<MemTableRep::Iterator> iter(rep_->GetIterator());
+
+    iter->SeekToFirst();
+    for (Key key : model) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(key, Decode(iter->key()));
+      iter->Next();
+    }
+    ASSERT_FALSE(iter->Valid());
+
+    iter->SeekToLast();
+    for (auto it = model.rbegin(); it != model.rend(); ++it) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(*it, Decode(iter->key()));
+      iter->Prev();
+    }
+    ASSERT_FALSE(iter->Valid());
+
+    for (Key target = 0; target <= max_key; target++) {
+      const char* encoded = NewKey(target);
+      iter->Seek(Slice(), encoded);
+      auto lower = model.lower_bound(target);
+      if (lower == model.end()) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(*lower, Decode(iter->key()));
+      }
+
+      iter->SeekForPrev(Slice(), encoded);
+      auto upper = model.upper_bound(target);
+      if (upper == model.begin()) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(*std::prev(upper), Decode(iter->key()));
+      }
+
+      ASSERT_EQ(model.count(target) > 0, rep_->Contains(encoded));
+    }
+  }
+
+ protected:
+  ConcurrentArena arena_;
+  TestComparator cmp_;
+  std::unique_ptr<MemTableRep> rep_;
+};
+
+TEST_F(BTreeRepTest, Empty) {
+  std::unique_ptr<MemTableRep::Iterator> iter(rep_->GetIterator());
+  iter->SeekToFirst();
+  ASSERT_FALSE(iter->Valid());
+  iter->SeekToLast();
+  ASSERT_FALSE(iter->Valid());
+  iter->Seek(Slice(), NewKey(100));
+  ASSERT_FALSE(iter->Valid());
+  iter->SeekForPrev(Slice(), NewKey(100));
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_FALSE(Contains(10));
+}
+
+TEST_F(BTreeRepTest, InsertAndLookup) {
+  const Key kMaxKey = 5000;
+  Random rnd(301);
+  std::set<Key> model;
+  for (int i = 0; i < 3000; i++) {
+    Key key = rnd.Next() % kMaxKey;
+    ASSERT_EQ(model.insert(key).second, Insert(key));
+  }
+  Verify(model, kMaxKey);
+}
+
+TEST_F(BTreeRepTest, SequentialInserts) {
+  const Key kNumKeys = 10000;
+  std::set<Key> model;
+  // Ascending and descending inserts split the rightmost and leftmost leaves
+  for (Key key = kNumKeys; key < 2 * kNumKeys; key++) {
+    ASSERT_TRUE(Insert(2 * key));
+    model.insert(2 * key);
+  }
+  for (Key key = kNumKeys; key > 0; key--) {
+    ASSERT_TRUE(Insert(2 * key + 1));
+    model.insert(2 * key + 1);
+  }
+  Verify(model, 4 * kNumKeys);
+}
+
+TEST_F(BTreeRepTest, ConcurrentInsert) {
+  const int kNumThreads = 4;
+  const Key kKeysPerThread = 20000;
+  std::atomic<bool> done(false);
+
+  // A reader checks that it always sees keys in order while writers insert
+  std::thread reader([&]() {
+    std::unique_ptr<MemTableRep::Iterator> iter(rep_->GetIterator());
+    while (!done.load()) {
+      iter->SeekToFirst();
+      Key prev = 0;
+      bool first = true;
+      for (; iter->Valid(); iter->Next()) {
+        Key key = Decode(iter->key());
+        ASSERT_TRUE(first || prev < key);
+        prev = key;
+        first = false;
+      }
+    }
+  });
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kNumThreads; t++) {
+    writers.emplace_back([&, t]() {
+      // Interleaved keys so that the threads contend for the same leaves
+      for (Key i = 0; i < kKeysPerThread; i++) {
+        ASSERT_TRUE(InsertConcurrently(i * kNumThreads + t));
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  done.store(true);
+  reader.join();
+
+  std::set<Key> model;
+  for (Key key = 0; key < kKeysPerThread * kNumThreads; key++) {
+    model.insert(key);
+  }
+  ASSERT_FALSE(InsertConcurrently(7));
+  std::unique_ptr<MemTableRep::Iterator> iter(rep_->GetIterator());
+  iter->SeekToFirst();
+  for (Key key : model) {
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key, Decode(iter->key()));
+    iter->Next();
+  }
+  ASSERT_FALSE(iter->Valid());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "SKIPPED as BTreeRep is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
@@ -46,6 +46,7 @@
 #include <algorithm>
 #include <atomic>
 #include <type_traits>
+#include <vector>
 #include "memory/allocator.h"
 #include "port/likely.h"
 #include "port/port.h"
@@ -117,6 +118,19 @@ class InlineSkipList {
   // Like Insert, but external synchronization is not required.
   bool InsertConcurrently(const char* key);
 
+  // Inserts n keys allocated by AllocateKey. The keys are sorted first and
+  // inserted through one splice, so each key is searched for from the one
+  // before it rather than from the head. For a batch of clustered keys that
+  // is close to the cost of sequential inserts. keys is sorted in place.
+  // Returns false if any key was already in the list, the others are still
+  // inserted.
+  //
+  // REQUIRES: no concurrent calls to any of inserts.
+  bool InsertBatch(const char** keys, size_t n);
+
+  // Like InsertBatch, but external synchronization is not required.
+  bool InsertBatchConcurrently(const char** keys, size_t n);
+
   // Inserts a node into the skip list.  key must have been allocated by
   // AllocateKey and then filled in by the caller.  If UseCAS is true,
   // then external synchronization is not required, otherwise this method
@@ -138,9 +152,20 @@ class InlineSkipList {
   // Returns true iff an entry that compares equal to key is in the list.
   bool Contains(const char* key) const;
 
+  // Sets entries[i] to the earliest entry >= keys[i], or nullptr, for each
+  // of the n keys. The searches advance in lockstep, each prefetching the
+  // node it reads next while the others take a step, so that their cache
+  // misses overlap instead of following one another.
+  void FindGreaterOrEqualBatch(size_t n, const char* const* keys,
+                               const char** entries) const;
+
   // Return estimated number of entries smaller than `key`.
   uint64_t EstimateCount(const char* key) const;
 
+  // Returns an entry picked at random, nullptr if the list is empty. Not
+  // exactly uniform, the entries of the levels above weighing more.
+  const char* FindRandomEntry() const;
+
   // Validate correctness of the skip-list.
   void TEST_Validate() const;
 
@@ -177,6 +202,10 @@ class InlineSkipList {
     // Retreat to the last entry with a key <= target
     void SeekForPrev(const char* target);
 
+    // Position at the entry of key, which must have been inserted into the
+    // list, without searching for it
+    void SeekToKey(const char* key);
+
     // Position at the first entry in list.
     // Final state of iterator is Valid() iff list is not empty.
     void SeekToFirst();
@@ -266,6 +295,10 @@ class InlineSkipList {
   // lowest_level (inclusive).
   void RecomputeSpliceLevels(const DecodedKey& key, Splice* splice,
                              int recompute_level);
+
+  // Sorts keys and inserts them in order through splice
+  template <bool UseCAS>
+  bool InsertSorted(const char** keys, size_t n, Splice* splice);
 };
 
 // Implementation details follow
@@ -400,6 +433,11 @@ inline void InlineSkipList<Comparator>::Iterator::Seek(const char* target) {
   node_ = list_->FindGreaterOrEqual(target);
 }
 
+template <class Comparator>
+inline void InlineSkipList<Comparator>::Iterator::SeekToKey(const char* key) {
+  node_ = reinterpret_cast<Node*>(const_cast<char*>(key)) - 1;
+}
+
 template <class Comparator>
 inline void InlineSkipList<Comparator>::Iterator::SeekForPrev(
     const char* target) {
@@ -473,6 +511,10 @@ InlineSkipList<Comparator>::FindGreaterOrEqual(const char* key) const {
     Node* next = x->Next(level);
     if (next != nullptr) {
       PREFETCH(next->Next(level), 0, 1);
+      // If next is before key, the search goes down a level from it later
+      if (level > 0) {
+        PREFETCH(next->Next(level - 1), 0, 1);
+      }
     }
     // Make sure the lists are sorted
     assert(x == head_ || next == nullptr || KeyIsAfterNode(next->Key(), x));
@@ -516,6 +558,9 @@ InlineSkipList<Comparator>::FindLessThan(const char* key, Node** prev,
     Node* next = x->Next(level);
     if (next != nullptr) {
       PREFETCH(next->Next(level), 0, 1);
+      if (level > bottom_level) {
+        PREFETCH(next->Next(level - 1), 0, 1);
+      }
     }
     assert(x == head_ || next == nullptr || KeyIsAfterNode(next->Key(), x));
     assert(x == head_ || KeyIsAfterNode(key_decoded, x));
@@ -558,6 +603,89 @@ InlineSkipList<Comparator>::FindLast() const {
   }
 }
 
+template <class Comparator>
+void InlineSkipList<Comparator>::FindGreaterOrEqualBatch(
+    size_t n, const char* const* keys, const char** entries) const {
+  // The same steps as FindGreaterOrEqual(), for up to kGroupSize searches
+  // at a time
+  static const size_t kGroupSize = 32;
+  struct Search {
+    Node* x;
+    // x->Next(level), prefetched
+    Node* next;
+    Node* last_bigger;
+    int level;
+    DecodedKey key;
+  };
+  Search searches[kGroupSize];
+  size_t active[kGroupSize];
+  for (size_t start = 0; start < n; start += kGroupSize) {
+    const size_t group_size = std::min(kGroupSize, n - start);
+    const int top_level = GetMaxHeight() - 1;
+    Node* const top_next = head_->Next(top_level);
+    for (size_t i = 0; i < group_size; i++) {
+      searches[i] = {head_, top_next, nullptr, top_level,
+                     compare_.decode_key(keys[start + i])};
+      active[i] = i;
+    }
+    size_t num_active = group_size;
+    while (num_active > 0) {
+      for (size_t a = 0; a < num_active;) {
+        const size_t i = active[a];
+        Search& s = searches[i];
+        Node* next = s.next;
+        int cmp = (next == nullptr || next == s.last_bigger)
+                      ? 1
+                      : compare_(next->Key(), s.key);
+        if (cmp == 0 || (cmp > 0 && s.level == 0)) {
+          entries[start + i] = next == nullptr ? nullptr : next->Key();
+          active[a] = active[--num_active];
+          continue;
+        }
+        if (cmp < 0) {
+          // Keep searching in this list
+          s.x = next;
+        } else {
+          // Switch to next list
+          s.last_bigger = next;
+          s.level--;
+        }
+        s.next = s.x->Next(s.level);
+        if (s.next != nullptr && s.next != s.last_bigger) {
+          PREFETCH(s.next->Key(), 0, 1);
+        }
+        a++;
+      }
+    }
+  }
+}
+
+template <class Comparator>
+const char* InlineSkipList<Comparator>::FindRandomEntry() const {
+  // Descends the levels, each time picking at random one of the nodes of
+  // the level between the node picked on the level above and the one after
+  // it, the head standing for the entries before the first node
+  Node* x = head_;
+  Node* limit = nullptr;
+  std::vector<Node*> level_nodes;
+  Random* rnd = Random::GetTLSInstance();
+  for (int level = GetMaxHeight() - 1; level >= 0; level--) {
+    level_nodes.clear();
+    for (Node* n = x; n != limit; n = n->Next(level)) {
+      level_nodes.push_back(n);
+    }
+    size_t i = rnd->Next() % level_nodes.size();
+    x = level_nodes[i];
+    if (i + 1 < level_nodes.size()) {
+      limit = level_nodes[i + 1];
+    }
+  }
+  if (x == head_) {
+    x = head_->Next(0);
+  }
+  return x == nullptr ? nullptr : x->Key();
+}
+
 template <class Comparator>
 uint64_t InlineSkipList<Comparator>::EstimateCount(const char* key) const {
   uint64_t count = 0;
@@ -678,6 +806,42 @@ bool InlineSkipList<Comparator>::InsertConcurrently(const char* key) {
   return Insert<true>(key, &splice, false);
 }
 
+template <class Comparator>
+bool InlineSkipList<Comparator>::InsertBatch(const char** keys, size_t n) {
+  return InsertSorted<false>(keys, n, seq_splice_);
+}
+
+template <class Comparator>
+bool InlineSkipList<Comparator>::InsertBatchConcurrently(const char** keys,
+                                                         size_t n) {
+  Node* prev[kMaxPossibleHeight];
+  Node* next[kMaxPossibleHeight];
+  Splice splice;
+  splice.prev_ = prev;
+  splice.next_ = next;
+  return InsertSorted<true>(keys, n, &splice);
+}
+
+template <class Comparator>
+template <bool UseCAS>
+bool InlineSkipList<Comparator>::InsertSorted(const char** keys, size_t n,
+                                              Splice* splice) {
+  auto less = [this](const char* a, const char* b) {
+    return compare_(a, b) < 0;
+  };
+  // Batches are often sorted already, which is cheaper to check than to sort
+  if (!std::is_sorted(keys, keys + n, less)) {
+    std::sort(keys, keys + n, less);
+  }
+  bool res = true;
+  for (size_t i = 0; i < n; i++) {
+    // A partial splice fix walks up only as far as the distance to the
+    // previous key, which is what makes a sorted batch cheap
+    res = Insert<UseCAS>(keys[i], splice, true) && res;
+  }
+  return res;
+}
+
 template <class Comparator>
 bool InlineSkipList<Comparator>::InsertWithHint(const char* key, void** hint) {
   assert(hint != nullptr);
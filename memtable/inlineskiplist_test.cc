@@ -10,6 +10,7 @@
 #include "memtable/inlineskiplist.h"
 #include <set>
 #include <unordered_set>
+#include <vector>
 #include "memory/concurrent_arena.h"
 #include "rocksdb/env.h"
 #include "test_util/testharness.h"
@@ -78,6 +79,24 @@ class InlineSkipTest : public testing::Test {
     return res;
   }
 
+  // Inserts keys as one batch. Does not record them, see AddKeys().
+  bool InsertBatch(TestInlineSkipList* list, const std::vector<Key>& keys,
+                   bool concurrently) {
+    std::vector<const char*> bufs;
+    for (Key key : keys) {
+      char* buf = list->AllocateKey(sizeof(Key));
+      memcpy(buf, &key, sizeof(Key));
+      bufs.push_back(buf);
+    }
+    return concurrently
+               ? list->InsertBatchConcurrently(bufs.data(), bufs.size())
+               : list->InsertBatch(bufs.data(), bufs.size());
+  }
+
+  void AddKeys(const std::vector<Key>& keys) {
+    keys_.insert(keys.begin(), keys.end());
+  }
+
   void Validate(TestInlineSkipList* list) {
     // Check keys exist.
     for (Key key : keys_) {
@@ -309,6 +328,111 @@ TEST_F(InlineSkipTest, InsertWithHint_CompatibleWithInsertWithoutHint) {
   Validate(&list);
 }
 
+TEST_F(InlineSkipTest, InsertBatch) {
+  const int kBatches = 200;
+  const int kBatchSize = 100;
+  Random rnd(301);
+  Arena arena;
+  TestComparator cmp;
+  TestInlineSkipList list(cmp, &arena);
+  for (int b = 0; b < kBatches; b++) {
+    // A run of keys with some random keys in it, and the front of it shuffled,
+    // mixed with single inserts
+    Key base = rnd.Next();
+    std::vector<Key> keys;
+    for (int i = 0; i < kBatchSize; i++) {
+      keys.push_back((base << 16) + i);
+    }
+    for (int i = 0; i < kBatchSize / 10; i++) {
+      keys[rnd.Uniform(kBatchSize)] = (static_cast<Key>(rnd.Next()) << 32) + b;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    for (size_t i = 1; i < keys.size() / 10; i++) {
+      std::swap(keys[i], keys[rnd.Uniform(static_cast<int>(i) + 1)]);
+    }
+    ASSERT_TRUE(InsertBatch(&list, keys, false /* concurrently */));
+    AddKeys(keys);
+    Insert(&list, (static_cast<Key>(rnd.Next()) << 32) + kBatches + b);
+  }
+  Validate(&list);
+}
+
+TEST_F(InlineSkipTest, FindGreaterOrEqualBatch) {
+  const int N = 2000;
+  const int R = 5000;
+  Random rnd(1000);
+  std::set<Key> keys;
+  Arena arena;
+  TestComparator cmp;
+  TestInlineSkipList list(cmp, &arena);
+  for (int i = 0; i < N; i++) {
+    Key key = rnd.Next() % R;
+    if (keys.insert(key).second) {
+      Insert(&list, key);
+    }
+  }
+
+  // Batches over the group size, with keys in no order, before, after and
+  // between the entries, and repeated
+  std::vector<Key> targets;
+  for (int i = 0; i < 100; i++) {
+    targets.push_back(rnd.Next() % (R + 10));
+  }
+  targets.push_back(0);
+  targets.push_back(targets[0]);
+  std::vector<const char*> encoded;
+  for (const Key& target : targets) {
+    encoded.push_back(Encode(&target));
+  }
+  std::vector<const char*> entries(targets.size());
+  list.FindGreaterOrEqualBatch(targets.size(), encoded.data(), entries.data());
+  for (size_t i = 0; i < targets.size(); i++) {
+    auto it = keys.lower_bound(targets[i]);
+    if (it == keys.end()) {
+      ASSERT_EQ(nullptr, entries[i]);
+    } else {
+      ASSERT_NE(nullptr, entries[i]);
+      ASSERT_EQ(*it, Decode(entries[i]));
+    }
+  }
+}
+
+TEST_F(InlineSkipTest, InsertBatchConcurrently) {
+  const int kThreads = 4;
+  const int kBatches = 100;
+  const int kBatchSize = 100;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  TestInlineSkipList list(cmp, &arena);
+  std::vector<std::vector<Key>> keys(kThreads);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      Random rnd(t + 1);
+      for (int b = 0; b < kBatches; b++) {
+        // Interleaved with the batches of the other threads
+        std::vector<Key> batch;
+        for (int i = 0; i < kBatchSize; i++) {
+          batch.push_back(((b * kBatchSize + i) * kThreads + t) << 8);
+        }
+        for (int i = 1; i < kBatchSize; i++) {
+          std::swap(batch[i], batch[rnd.Uniform(i + 1)]);
+        }
+        ASSERT_TRUE(InsertBatch(&list, batch, true /* concurrently */));
+        keys[t].insert(keys[t].end(), batch.begin(), batch.end());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& thread_keys : keys) {
+    AddKeys(thread_keys);
+  }
+  Validate(&list);
+}
+
 #ifndef ROCKSDB_VALGRIND_RUN
 // We want to make sure that with a single writer and multiple
 // concurrent readers (with no synchronization other than when a
@@ -0,0 +1,203 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/memory_governor.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "logging/logging.h"
+#include "monitoring/statistics.h"
+#include "port/port.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/env.h"
+#include "rocksdb/write_buffer_manager.h"
+#include "util/mutexlock.h"
+#include "util/timer.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+class MemoryGovernorImpl : public MemoryGovernor {
+ public:
+  explicit MemoryGovernorImpl(const MemoryGovernorOptions& options)
+      : options_(options),
+        total_budget_(options.total_budget),
+        write_buffer_share_(Share(options.initial_write_buffer_ratio)) {
+    Statistics* stats = options_.statistics.get();
+    if (stats != nullptr) {
+      last_hits_ = stats->getTickerCount(BLOCK_CACHE_HIT);
+      last_misses_ = stats->getTickerCount(BLOCK_CACHE_MISS);
+      last_stall_micros_ = stats->getTickerCount(STALL_MICROS);
+    }
+    MutexLock l(&mutex_);
+    Apply();
+  }
+
+  ~MemoryGovernorImpl() override {
+    if (timer_ != nullptr) {
+      timer_->Shutdown();
+    }
+  }
+
+  void StartRebalancing() {
+    if (options_.rebalance_period_sec == 0) {
+      return;
+    }
+    Env* env = options_.env != nullptr ? options_.env : Env::Default();
+    uint64_t period_us = options_.rebalance_period_sec * uint64_t{1000000};
+    timer_.reset(new Timer(env));
+    timer_->Add([this]() { Rebalance(); }, "MemoryGovernor::Rebalance",
+                period_us, period_us);
+    timer_->Start();
+  }
+
+  void Rebalance() override {
+    MutexLock l(&mutex_);
+    WriteBufferManager* wbm = options_.write_buffer_manager.get();
+    Statistics* stats = options_.statistics.get();
+
+    double miss_ratio = 0.0;
+    bool stalled = false;
+    if (stats != nullptr) {
+      uint64_t hits = stats->getTickerCount(BLOCK_CACHE_HIT);
+      uint64_t misses = stats->getTickerCount(BLOCK_CACHE_MISS);
+      uint64_t stall_micros = stats->getTickerCount(STALL_MICROS);
+      uint64_t lookups = (hits - last_hits_) + (misses - last_misses_);
+      if (lookups > 0) {
+        miss_ratio = static_cast<double>(misses - last_misses_) / lookups;
+      }
+      stalled = stall_micros > last_stall_micros_;
+      last_hits_ = hits;
+      last_misses_ = misses;
+      last_stall_micros_ = stall_micros;
+    }
+
+    size_t write_buffer_usage = wbm->memory_usage();
+    size_t cache_share = total_budget_ - write_buffer_share_;
+    size_t cache_usage = BlockCacheUsage(write_buffer_usage);
+    bool write_pressure =
+        stalled || write_buffer_usage > Scale(write_buffer_share_,
+                                              options_.write_pressure_ratio);
+    bool cache_pressure =
+        cache_usage >= Scale(cache_share, options_.cache_pressure_ratio) &&
+        (stats == nullptr || miss_ratio > options_.miss_ratio_threshold);
+
+    size_t step = Share(options_.step_ratio);
+    size_t share = write_buffer_share_;
+    // A write stall costs more than block cache misses
+    if (write_pressure && (!cache_pressure || stalled)) {
+      share = std::min(share + step, Share(options_.max_write_buffer_ratio));
+    } else if (cache_pressure && !write_pressure) {
+      size_t min_share = Share(options_.min_write_buffer_ratio);
+      share = share > min_share + step ? share - step : min_share;
+    }
+
+    stats_.rebalances++;
+    stats_.block_cache_miss_ratio = miss_ratio;
+    if (share != write_buffer_share_) {
+      bool to_write_buffer = share > write_buffer_share_;
+      size_t moved = to_write_buffer ? share - write_buffer_share_
+                                     : write_buffer_share_ - share;
+      if (to_write_buffer) {
+        stats_.moves_to_write_buffer++;
+        RecordTick(stats, MEMORY_GOVERNOR_MOVES_TO_WRITE_BUFFER);
+      } else {
+        stats_.moves_to_block_cache++;
+        RecordTick(stats, MEMORY_GOVERNOR_MOVES_TO_BLOCK_CACHE);
+      }
+      RecordTick(stats, MEMORY_GOVERNOR_BYTES_MOVED, moved);
+      ROCKS_LOG_INFO(options_.info_log.get(),
+                     "[MemoryGovernor] Moved %" ROCKSDB_PRIszt
+                     " bytes to the %s, write buffer usage %" ROCKSDB_PRIszt
+                     "/%" ROCKSDB_PRIszt ", block cache usage %" ROCKSDB_PRIszt
+                     "/%" ROCKSDB_PRIszt ", miss ratio %.3f%s",
+                     moved, to_write_buffer ? "write buffers" : "block cache",
+                     write_buffer_usage, write_buffer_share_, cache_usage,
+                     cache_share, miss_ratio,
+                     stalled ? ", writes stalled" : "");
+      write_buffer_share_ = share;
+      Apply();
+    }
+  }
+
+  void SetTotalBudget(size_t total_budget) override {
+    if (total_budget == 0) {
+      return;
+    }
+    MutexLock l(&mutex_);
+    double ratio = static_cast<double>(write_buffer_share_) / total_budget_;
+    total_budget_ = total_budget;
+    write_buffer_share_ = Share(ratio);
+    Apply();
+  }
+
+  void GetStats(MemoryGovernorStats* stats) const override {
+    MutexLock l(&mutex_);
+    *stats = stats_;
+    stats->write_buffer_share = write_buffer_share_;
+    stats->block_cache_share = total_budget_ - write_buffer_share_;
+    stats->write_buffer_usage =
+        options_.write_buffer_manager->memory_usage();
+    stats->block_cache_usage = BlockCacheUsage(stats->write_buffer_usage);
+  }
+
+ private:
+  static size_t Scale(size_t size, double ratio) {
+    return static_cast<size_t>(static_cast<double>(size) * ratio);
+  }
+
+  size_t Share(double ratio) const { return Scale(total_budget_, ratio); }
+
+  // The blocks in the cache, without the memtables it may be charged for
+  size_t BlockCacheUsage(size_t write_buffer_usage) const {
+    size_t usage = options_.block_cache->GetUsage();
+    if (options_.write_buffer_manager->cost_to_cache()) {
+      usage -= std::min(usage, write_buffer_usage);
+    }
+    return usage;
+  }
+
+  // Sets the shares to the write buffer manager and the block cache.
+  // REQUIRES: mutex_ held
+  void Apply() {
+    WriteBufferManager* wbm = options_.write_buffer_manager.get();
+    wbm->SetBufferSize(std::max<size_t>(write_buffer_share_, 1));
+    // A cache the memtables are charged to holds both shares
+    options_.block_cache->SetCapacity(
+        wbm->cost_to_cache() ? total_budget_
+                             : total_budget_ - write_buffer_share_);
+  }
+
+  const MemoryGovernorOptions options_;
+  mutable port::Mutex mutex_;
+  size_t total_budget_;
+  size_t write_buffer_share_;
+  uint64_t last_hits_ = 0;
+  uint64_t last_misses_ = 0;
+  uint64_t last_stall_micros_ = 0;
+  MemoryGovernorStats stats_;
+  std::unique_ptr<Timer> timer_;
+};
+}  // namespace
+
+MemoryGovernor* NewMemoryGovernor(const MemoryGovernorOptions& options) {
+  if (options.total_budget == 0 || options.block_cache == nullptr ||
+      options.write_buffer_manager == nullptr ||
+      !options.write_buffer_manager->enabled()) {
+    return nullptr;
+  }
+  if (!(options.min_write_buffer_ratio > 0.0 &&
+        options.min_write_buffer_ratio <= options.initial_write_buffer_ratio &&
+        options.initial_write_buffer_ratio <= options.max_write_buffer_ratio &&
+        options.max_write_buffer_ratio < 1.0 && options.step_ratio > 0.0)) {
+    return nullptr;
+  }
+  MemoryGovernorImpl* governor = new MemoryGovernorImpl(options);
+  governor->StartRebalancing();
+  return governor;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -3,29 +3,58 @@
 //  COPYING file in the root directory) and Apache 2.0 License
 //  (found in the LICENSE.Apache file in the root directory).
 //
+#include <array>
+#include <atomic>
+#include <cmath>
+
 #include "db/memtable.h"
 #include "memory/arena.h"
 #include "memtable/inlineskiplist.h"
 #include "rocksdb/memtablerep.h"
+#include "rocksdb/slice_transform.h"
+#include "util/hash.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace {
 class SkipListRep : public MemTableRep {
-  InlineSkipList<const MemTableRep::KeyComparator&> skip_list_;
+  typedef InlineSkipList<const MemTableRep::KeyComparator&> SkipList;
+
+  SkipList skip_list_;
   const MemTableRep::KeyComparator& cmp_;
   const SliceTransform* transform_;
   const size_t lookahead_;
+  // The first key of each prefix by prefix hash, for prefix seeks to start
+  // from instead of searching the list. A bucket keeps the prefix of the
+  // first key inserted into it; the other prefixes hashed to it are not
+  // indexed. nullptr if there is no index.
+  std::atomic<const char*>* prefix_index_ = nullptr;
+  const size_t prefix_index_buckets_;
+  // Set if keys may be missing from the index, when a batch of keys fails
+  // to be inserted without telling which keys were
+  std::atomic<bool> prefix_index_stale_{false};
 
   friend class LookaheadIterator;
 public:
  explicit SkipListRep(const MemTableRep::KeyComparator& compare,
                       Allocator* allocator, const SliceTransform* transform,
-                      const size_t lookahead)
+                      const size_t lookahead,
+                      const size_t prefix_index_buckets)
      : MemTableRep(allocator),
        skip_list_(compare, allocator),
        cmp_(compare),
        transform_(transform),
-       lookahead_(lookahead) {}
+       lookahead_(lookahead),
+       prefix_index_buckets_(transform != nullptr ? prefix_index_buckets
+                                                  : 0) {
+   if (prefix_index_buckets_ > 0) {
+     char* mem = allocator->AllocateAligned(sizeof(std::atomic<const char*>) *
+                                            prefix_index_buckets_);
+     prefix_index_ = reinterpret_cast<std::atomic<const char*>*>(mem);
+     for (size_t i = 0; i < prefix_index_buckets_; i++) {
+       new (&prefix_index_[i]) std::atomic<const char*>(nullptr);
+     }
+   }
+ }
 
  KeyHandle Allocate(const size_t len, char** buf) override {
    *buf = skip_list_.AllocateKey(len);
@@ -35,36 +64,120 @@ public:
   // Insert key into the list.
   // REQUIRES: nothing that compares equal to key is currently in the list.
  void Insert(KeyHandle handle) override {
-   skip_list_.Insert(static_cast<char*>(handle));
+   InsertKey(handle);
  }
 
  bool InsertKey(KeyHandle handle) override {
-   return skip_list_.Insert(static_cast<char*>(handle));
+   return Indexed(skip_list_.Insert(static_cast<char*>(handle)), handle);
  }
 
  void InsertWithHint(KeyHandle handle, void** hint) override {
-   skip_list_.InsertWithHint(static_cast<char*>(handle), hint);
+   InsertKeyWithHint(handle, hint);
  }
 
  bool InsertKeyWithHint(KeyHandle handle, void** hint) override {
-   return skip_list_.InsertWithHint(static_cast<char*>(handle), hint);
+   return Indexed(
+       skip_list_.InsertWithHint(static_cast<char*>(handle), hint), handle);
  }
 
  void InsertWithHintConcurrently(KeyHandle handle, void** hint) override {
-   skip_list_.InsertWithHintConcurrently(static_cast<char*>(handle), hint);
+   InsertKeyWithHintConcurrently(handle, hint);
  }
 
  bool InsertKeyWithHintConcurrently(KeyHandle handle, void** hint) override {
-   return skip_list_.InsertWithHintConcurrently(static_cast<char*>(handle),
-                                                hint);
+   return Indexed(skip_list_.InsertWithHintConcurrently(
+                      static_cast<char*>(handle), hint),
+                  handle);
  }
 
  void InsertConcurrently(KeyHandle handle) override {
-   skip_list_.InsertConcurrently(static_cast<char*>(handle));
+   InsertKeyConcurrently(handle);
  }
 
  bool InsertKeyConcurrently(KeyHandle handle) override {
-   return skip_list_.InsertConcurrently(static_cast<char*>(handle));
+   return Indexed(skip_list_.InsertConcurrently(static_cast<char*>(handle)),
+                  handle);
+ }
+
+ bool InsertKeys(KeyHandle* handles, size_t n) override {
+   return IndexedBatch(skip_list_.InsertBatch(ToKeys(handles), n), handles,
+                       n);
+ }
+
+ bool InsertKeysConcurrently(KeyHandle* handles, size_t n) override {
+   return IndexedBatch(
+       skip_list_.InsertBatchConcurrently(ToKeys(handles), n), handles, n);
+ }
+
+ // Adds the key just inserted, if it was, to the prefix index. Must be done
+ // before the insert returns, as the sequence number of the key is
+ // published only then, for no reader to miss it.
+ bool Indexed(bool inserted, KeyHandle handle) {
+   if (inserted && prefix_index_ != nullptr) {
+     AddToPrefixIndex(static_cast<const char*>(handle));
+   }
+   return inserted;
+ }
+
+ bool IndexedBatch(bool inserted, KeyHandle* handles, size_t n) {
+   if (prefix_index_ != nullptr) {
+     if (inserted) {
+       for (size_t i = 0; i < n; i++) {
+         AddToPrefixIndex(static_cast<const char*>(handles[i]));
+       }
+     } else {
+       prefix_index_stale_.store(true, std::memory_order_relaxed);
+     }
+   }
+   return inserted;
+ }
+
+ void AddToPrefixIndex(const char* key) {
+   Slice user_key = UserKey(key);
+   if (!transform_->InDomain(user_key)) {
+     return;
+   }
+   Slice prefix = transform_->Transform(user_key);
+   auto& bucket = prefix_index_[GetSliceHash(prefix) % prefix_index_buckets_];
+   const char* first = bucket.load(std::memory_order_acquire);
+   // A failed exchange reloads first, for the checks to be redone
+   while (first == nullptr ||
+          (cmp_(key, first) < 0 &&
+           transform_->Transform(UserKey(first)) == prefix)) {
+     if (bucket.compare_exchange_weak(first, key, std::memory_order_release,
+                                      std::memory_order_acquire)) {
+       break;
+     }
+   }
+ }
+
+ // Positions iter at the first entry >= target if it is the first key of
+ // the prefix of target. Only for prefix seeks, which need not find the
+ // keys outside of the prefix.
+ bool SeekPrefixIndex(const char* target, SkipList::Iterator* iter) const {
+   if (prefix_index_ == nullptr ||
+       prefix_index_stale_.load(std::memory_order_relaxed)) {
+     return false;
+   }
+   Slice user_key = UserKey(target);
+   if (!transform_->InDomain(user_key)) {
+     return false;
+   }
+   Slice prefix = transform_->Transform(user_key);
+   const char* first =
+       prefix_index_[GetSliceHash(prefix) % prefix_index_buckets_].load(
+           std::memory_order_acquire);
+   if (first == nullptr || cmp_(first, target) < 0 ||
+       transform_->Transform(UserKey(first)) != prefix) {
+     return false;
+   }
+   iter->SeekToKey(first);
+   return true;
+ }
+
+ // Handles are the keys themselves, sorted in place by the skip list
+ static const char** ToKeys(KeyHandle* handles) {
+   return const_cast<const char**>(reinterpret_cast<char**>(handles));
  }
 
   // Returns true iff an entry that compares equal to key is in the list.
@@ -86,6 +199,67 @@ public:
    }
  }
 
+ void MultiGet(size_t num_keys, const LookupKey* const* keys,
+               void* const* callback_args,
+               bool (*callback_func)(void* arg, const char* entry)) override {
+   static const size_t kBatchSize = MultiGetContext::MAX_BATCH_SIZE;
+   std::array<const char*, kBatchSize> targets;
+   std::array<const char*, kBatchSize> entries;
+   SkipList::Iterator iter(&skip_list_);
+   for (size_t start = 0; start < num_keys; start += kBatchSize) {
+     const size_t n = std::min(kBatchSize, num_keys - start);
+     for (size_t i = 0; i < n; i++) {
+       targets[i] = keys[start + i]->memtable_key().data();
+     }
+     skip_list_.FindGreaterOrEqualBatch(n, targets.data(), entries.data());
+     for (size_t i = 0; i < n; i++) {
+       if (entries[i] == nullptr) {
+         continue;
+       }
+       for (iter.SeekToKey(entries[i]);
+            iter.Valid() && callback_func(callback_args[start + i], iter.key());
+            iter.Next()) {
+       }
+     }
+   }
+ }
+
+  void UniqueRandomSample(uint64_t num_entries, uint64_t target_sample_size,
+                          std::unordered_set<const char*>* entries) override {
+    entries->clear();
+    if (num_entries == 0 || target_sample_size == 0) {
+      return;
+    }
+    if (target_sample_size >
+        static_cast<uint64_t>(std::sqrt(static_cast<double>(num_entries)))) {
+      // Large samples are cheaper to take in one scan, each entry picked
+      // with the probability of the samples still to take among the entries
+      // left
+      Random* rnd = Random::GetTLSInstance();
+      SkipListRep::Iterator iter(&skip_list_);
+      uint64_t left = num_entries;
+      uint64_t to_take = target_sample_size;
+      for (iter.SeekToFirst(); iter.Valid() && to_take > 0 && left > 0;
+           iter.Next(), left--) {
+        if (rnd->Next() % left < to_take) {
+          entries->insert(iter.key());
+          to_take--;
+        }
+      }
+    } else {
+      // Small ones in random descents of the list, with a few retries for
+      // the entries already picked
+      for (uint64_t i = 0; i < target_sample_size; i++) {
+        for (int attempt = 0; attempt < 5; attempt++) {
+          const char* entry = skip_list_.FindRandomEntry();
+          if (entry == nullptr || entries->insert(entry).second) {
+            break;
+          }
+        }
+      }
+    }
+  }
+
   uint64_t ApproximateNumEntries(const Slice& start_ikey,
                                  const Slice& end_ikey) override {
     std::string tmp;
@@ -100,13 +274,16 @@ public:
   // Iteration over the contents of a skip list
   class Iterator : public MemTableRep::Iterator {
     InlineSkipList<const MemTableRep::KeyComparator&>::Iterator iter_;
+    // For prefix seeks with the prefix index, nullptr otherwise
+    const SkipListRep* prefix_rep_;
 
    public:
     // Initialize an iterator over the specified list.
     // The returned iterator is not valid.
     explicit Iterator(
-        const InlineSkipList<const MemTableRep::KeyComparator&>* list)
-        : iter_(list) {}
+        const InlineSkipList<const MemTableRep::KeyComparator&>* list,
+        const SkipListRep* prefix_rep = nullptr)
+        : iter_(list), prefix_rep_(prefix_rep) {}
 
     ~Iterator() override {}
 
@@ -127,10 +304,12 @@ public:
 
     // Advance to the first entry with a key >= target
     void Seek(const Slice& user_key, const char* memtable_key) override {
-      if (memtable_key != nullptr) {
-        iter_.Seek(memtable_key);
-      } else {
-        iter_.Seek(EncodeKey(&tmp_, user_key));
+      const char* encoded_key = (memtable_key != nullptr)
+                                    ? memtable_key
+                                    : EncodeKey(&tmp_, user_key);
+      if (prefix_rep_ == nullptr ||
+          !prefix_rep_->SeekPrefixIndex(encoded_key, &iter_)) {
+        iter_.Seek(encoded_key);
       }
     }
 
@@ -161,8 +340,12 @@ public:
   // the target key hasn't been found.
   class LookaheadIterator : public MemTableRep::Iterator {
    public:
-    explicit LookaheadIterator(const SkipListRep& rep) :
-        rep_(rep), iter_(&rep_.skip_list_), prev_(iter_) {}
+    explicit LookaheadIterator(const SkipListRep& rep,
+                               bool use_prefix_index = false)
+        : rep_(rep),
+          use_prefix_index_(use_prefix_index),
+          iter_(&rep_.skip_list_),
+          prev_(iter_) {}
 
     ~LookaheadIterator() override {}
 
@@ -223,7 +406,9 @@ public:
         }
       }
 
-      iter_.Seek(encoded_key);
+      if (!use_prefix_index_ || !rep_.SeekPrefixIndex(encoded_key, &iter_)) {
+        iter_.Seek(encoded_key);
+      }
       prev_ = iter_;
     }
 
@@ -251,21 +436,33 @@ public:
 
    private:
     const SkipListRep& rep_;
+    const bool use_prefix_index_;
     InlineSkipList<const MemTableRep::KeyComparator&>::Iterator iter_;
     InlineSkipList<const MemTableRep::KeyComparator&>::Iterator prev_;
   };
 
   MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    return NewIterator(arena, false /* use_prefix_index */);
+  }
+
+  MemTableRep::Iterator* GetDynamicPrefixIterator(
+      Arena* arena = nullptr) override {
+    return NewIterator(arena, prefix_index_ != nullptr);
+  }
+
+  MemTableRep::Iterator* NewIterator(Arena* arena, bool use_prefix_index) {
     if (lookahead_ > 0) {
       void *mem =
         arena ? arena->AllocateAligned(sizeof(SkipListRep::LookaheadIterator))
               : operator new(sizeof(SkipListRep::LookaheadIterator));
-      return new (mem) SkipListRep::LookaheadIterator(*this);
+      return new (mem)
+          SkipListRep::LookaheadIterator(*this, use_prefix_index);
     } else {
       void *mem =
         arena ? arena->AllocateAligned(sizeof(SkipListRep::Iterator))
               : operator new(sizeof(SkipListRep::Iterator));
-      return new (mem) SkipListRep::Iterator(&skip_list_);
+      return new (mem) SkipListRep::Iterator(
+          &skip_list_, use_prefix_index ? this : nullptr);
     }
   }
 };
@@ -274,7 +471,8 @@ public:
 MemTableRep* SkipListFactory::CreateMemTableRep(
     const MemTableRep::KeyComparator& compare, Allocator* allocator,
     const SliceTransform* transform, Logger* /*logger*/) {
-  return new SkipListRep(compare, allocator, transform, lookahead_);
+  return new SkipListRep(compare, allocator, transform, lookahead_,
+                         prefix_index_buckets_);
 }
 
 }  // namespace ROCKSDB_NAMESPACE
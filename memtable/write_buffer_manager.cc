@@ -8,10 +8,66 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "rocksdb/write_buffer_manager.h"
+#include <algorithm>
 #include <mutex>
+#include "port/port.h"
 #include "util/coding.h"
+#include "util/core_local.h"
+
+// Only generate field unused warning for padding array, or build under
+// GCC 4.8.1 will fail.
+#ifdef __clang__
+#define ROCKSDB_FIELD_UNUSED __attribute__((__unused__))
+#else
+#define ROCKSDB_FIELD_UNUSED
+#endif  // __clang__
 
 namespace ROCKSDB_NAMESPACE {
+namespace {
+// The aggregated counters lag the per-core deltas by at most
+// buffer_size / kCoreSlackDivisor in total, and each core by at most
+// kMaxCoreSlack.
+const size_t kCoreSlackDivisor = 1024;
+const size_t kMaxCoreSlack = 1024 * 1024;
+}  // namespace
+
+struct WriteBufferManager::CoreDeltas {
+  struct ALIGN_AS(CACHE_LINE_SIZE) Delta {
+    std::atomic<int64_t> used{0};
+    std::atomic<int64_t> active{0};
+#ifndef HAVE_ALIGNED_NEW
+    char padding[CACHE_LINE_SIZE - 2 * sizeof(std::atomic<int64_t>)]
+        ROCKSDB_FIELD_UNUSED;
+#endif
+    void* operator new(size_t s) { return port::cacheline_aligned_alloc(s); }
+    void* operator new[](size_t s) { return port::cacheline_aligned_alloc(s); }
+    void operator delete(void* p) { port::cacheline_aligned_free(p); }
+    void operator delete[](void* p) { port::cacheline_aligned_free(p); }
+  };
+
+  CoreLocalArray<Delta> deltas;
+
+  // Adds `delta` to the core-local `*counter` and returns what should be
+  // folded into the aggregated counter: nothing while the core-local value
+  // stays within `slack`, otherwise everything accumulated so far.
+  static int64_t Accumulate(std::atomic<int64_t>* counter, int64_t delta,
+                            int64_t slack) {
+    int64_t local = counter->fetch_add(delta, std::memory_order_relaxed) + delta;
+    if (local <= slack && local >= -slack) {
+      return 0;
+    }
+    return counter->exchange(0, std::memory_order_relaxed);
+  }
+
+  int64_t Sum(std::atomic<int64_t> Delta::*counter) const {
+    int64_t sum = 0;
+    for (size_t i = 0; i < deltas.Size(); ++i) {
+      sum += (deltas.AccessAtCore(i)->*counter).load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+};
+
 #ifndef ROCKSDB_LITE
 namespace {
 const size_t kSizeDummyEntry = 256 * 1024;
@@ -50,10 +106,15 @@ struct WriteBufferManager::CacheRep {};
 
 WriteBufferManager::WriteBufferManager(size_t _buffer_size,
                                        std::shared_ptr<Cache> cache)
-    : buffer_size_(_buffer_size),
-      mutable_limit_(buffer_size_ * 7 / 8),
+    : enabled_(_buffer_size != 0),
+      buffer_size_(_buffer_size),
+      mutable_limit_(_buffer_size * 7 / 8),
       memory_used_(0),
       memory_active_(0),
+      core_deltas_(new CoreDeltas()),
+      core_slack_(static_cast<int64_t>(
+          std::min(kMaxCoreSlack, _buffer_size / kCoreSlackDivisor /
+                                      core_deltas_->deltas.Size()))),
       cache_rep_(nullptr) {
 #ifndef ROCKSDB_LITE
   if (cache) {
@@ -77,6 +138,55 @@ WriteBufferManager::~WriteBufferManager() {
 #endif  // ROCKSDB_LITE
 }
 
+size_t WriteBufferManager::memory_usage() const {
+  int64_t used = memory_used_.load(std::memory_order_relaxed) +
+                 core_deltas_->Sum(&CoreDeltas::Delta::used);
+  return used > 0 ? static_cast<size_t>(used) : 0;
+}
+
+size_t WriteBufferManager::mutable_memtable_memory_usage() const {
+  int64_t active = memory_active_.load(std::memory_order_relaxed) +
+                   core_deltas_->Sum(&CoreDeltas::Delta::active);
+  return active > 0 ? static_cast<size_t>(active) : 0;
+}
+
+void WriteBufferManager::SetBufferSize(size_t new_size) {
+  assert(enabled());
+  assert(new_size != 0);
+  buffer_size_.store(new_size, std::memory_order_relaxed);
+  mutable_limit_.store(new_size * 7 / 8, std::memory_order_relaxed);
+}
+
+void WriteBufferManager::UpdateMem(int64_t used_delta, int64_t active_delta) {
+  if (core_slack_ > 0) {
+    auto* delta = core_deltas_->deltas.Access();
+    if (used_delta != 0) {
+      used_delta =
+          CoreDeltas::Accumulate(&delta->used, used_delta, core_slack_);
+    }
+    if (active_delta != 0) {
+      active_delta =
+          CoreDeltas::Accumulate(&delta->active, active_delta, core_slack_);
+    }
+  }
+  if (used_delta > 0) {
+    if (cache_rep_ != nullptr) {
+      ReserveMemWithCache(static_cast<size_t>(used_delta));
+    } else {
+      memory_used_.fetch_add(used_delta, std::memory_order_relaxed);
+    }
+  } else if (used_delta < 0) {
+    if (cache_rep_ != nullptr) {
+      FreeMemWithCache(static_cast<size_t>(-used_delta));
+    } else {
+      memory_used_.fetch_add(used_delta, std::memory_order_relaxed);
+    }
+  }
+  if (active_delta != 0) {
+    memory_active_.fetch_add(active_delta, std::memory_order_relaxed);
+  }
+}
+
 // Should only be called from write thread
 void WriteBufferManager::ReserveMemWithCache(size_t mem) {
 #ifndef ROCKSDB_LITE
@@ -85,9 +195,11 @@ void WriteBufferManager::ReserveMemWithCache(size_t mem) {
   // lock-free solution if it ends up with a performance bottleneck.
   std::lock_guard<std::mutex> lock(cache_rep_->cache_mutex_);
 
-  size_t new_mem_used = memory_used_.load(std::memory_order_relaxed) + mem;
+  int64_t new_mem_used =
+      memory_used_.load(std::memory_order_relaxed) + static_cast<int64_t>(mem);
   memory_used_.store(new_mem_used, std::memory_order_relaxed);
-  while (new_mem_used > cache_rep_->cache_allocated_size_) {
+  while (new_mem_used >
+         static_cast<int64_t>(cache_rep_->cache_allocated_size_.load())) {
     // Expand size by at least 256KB.
     // Add a dummy record to the cache
     Cache::Handle* handle = nullptr;
@@ -116,8 +228,12 @@ void WriteBufferManager::FreeMemWithCache(size_t mem) {
   // Use a mutex to protect various data structures. Can be optimized to a
   // lock-free solution if it ends up with a performance bottleneck.
   std::lock_guard<std::mutex> lock(cache_rep_->cache_mutex_);
-  size_t new_mem_used = memory_used_.load(std::memory_order_relaxed) - mem;
-  memory_used_.store(new_mem_used, std::memory_order_relaxed);
+  int64_t used =
+      memory_used_.load(std::memory_order_relaxed) - static_cast<int64_t>(mem);
+  memory_used_.store(used, std::memory_order_relaxed);
+  // The per-core deltas still hold the reservations that make up for a
+  // negative aggregate
+  size_t new_mem_used = used > 0 ? static_cast<size_t>(used) : 0;
   // Gradually shrink memory costed in the block cache if the actual
   // usage is less than 3/4 of what we reserve from the block cache.
   // We do this because:
@@ -8,6 +8,11 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "rocksdb/write_buffer_manager.h"
+#include <functional>
+#include <thread>
+#include <vector>
+#include "rocksdb/memory_governor.h"
+#include "rocksdb/statistics.h"
 #include "test_util/testharness.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -50,6 +55,54 @@ TEST_F(WriteBufferManagerTest, ShouldFlush) {
   ASSERT_FALSE(wbf->ShouldFlush());
 }
 
+TEST_F(WriteBufferManagerTest, ConcurrentSmallUpdates) {
+  // A write buffer manager of size 64MB, so the aggregated counters used by
+  // ShouldFlush() may lag by up to 64KB
+  const size_t kBufferSize = 64 * 1024 * 1024;
+  const size_t kChunk = 1024;
+  const int kNumThreads = 8;
+  const size_t kTotal = 60 * 1024 * 1024;
+  const size_t kChunksPerThread = kTotal / kChunk / kNumThreads;
+  WriteBufferManager wbf(kBufferSize);
+
+  auto run = [&](std::function<void()> fn) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back(fn);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  };
+
+  // 60MB in 1KB chunks crosses the 56MB mutable limit
+  run([&]() {
+    for (size_t i = 0; i < kChunksPerThread; i++) {
+      wbf.ReserveMem(kChunk);
+    }
+  });
+  ASSERT_EQ(kTotal, wbf.memory_usage());
+  ASSERT_EQ(kTotal, wbf.mutable_memtable_memory_usage());
+  ASSERT_TRUE(wbf.ShouldFlush());
+
+  run([&]() {
+    for (size_t i = 0; i < kChunksPerThread; i++) {
+      wbf.ScheduleFreeMem(kChunk);
+    }
+  });
+  ASSERT_EQ(kTotal, wbf.memory_usage());
+  ASSERT_EQ(0U, wbf.mutable_memtable_memory_usage());
+  ASSERT_FALSE(wbf.ShouldFlush());
+
+  run([&]() {
+    for (size_t i = 0; i < kChunksPerThread; i++) {
+      wbf.FreeMem(kChunk);
+    }
+  });
+  ASSERT_EQ(0U, wbf.memory_usage());
+  ASSERT_FALSE(wbf.ShouldFlush());
+}
+
 TEST_F(WriteBufferManagerTest, CacheCost) {
   LRUCacheOptions co;
   // 1GB cache
@@ -175,6 +228,129 @@ TEST_F(WriteBufferManagerTest, CacheFull) {
   ASSERT_LT(cache->GetPinnedUsage(), 20 * 1024 * 1024);
 }
 
+
+TEST_F(WriteBufferManagerTest, SetBufferSize) {
+  WriteBufferManager wbf(10 * 1024 * 1024);
+  wbf.ReserveMem(8 * 1024 * 1024);
+  ASSERT_FALSE(wbf.ShouldFlush());
+  // 8MB is above the mutable limit of a 8MB buffer
+  wbf.SetBufferSize(8 * 1024 * 1024);
+  ASSERT_EQ(8 * 1024 * 1024, wbf.buffer_size());
+  ASSERT_TRUE(wbf.ShouldFlush());
+  wbf.SetBufferSize(20 * 1024 * 1024);
+  ASSERT_FALSE(wbf.ShouldFlush());
+  wbf.FreeMem(8 * 1024 * 1024);
+}
+
+namespace {
+void DeleteNothing(const Slice& /*key*/, void* /*value*/) {}
+}  // namespace
+
+TEST_F(WriteBufferManagerTest, MemoryGovernor) {
+  const size_t kMB = 1024 * 1024;
+  std::shared_ptr<Cache> cache =
+      NewLRUCache(kMB, 0, false, 0.5, nullptr, kDefaultToAdaptiveMutex,
+                  kDontChargeCacheMetadata);
+  std::shared_ptr<WriteBufferManager> wbm(new WriteBufferManager(kMB));
+  std::shared_ptr<Statistics> statistics = CreateDBStatistics();
+
+  MemoryGovernorOptions options;
+  options.total_budget = 100 * kMB;
+  options.block_cache = cache;
+  options.write_buffer_manager = wbm;
+  options.statistics = statistics;
+  options.rebalance_period_sec = 0;
+  options.min_write_buffer_ratio = 0.2;
+  std::unique_ptr<MemoryGovernor> governor(NewMemoryGovernor(options));
+  ASSERT_NE(governor, nullptr);
+  ASSERT_EQ(25 * kMB, wbm->buffer_size());
+  ASSERT_EQ(75 * kMB, cache->GetCapacity());
+
+  // Nothing under pressure
+  governor->Rebalance();
+  ASSERT_EQ(25 * kMB, wbm->buffer_size());
+
+  // Memtables near their share get 5% of the budget
+  wbm->ReserveMem(24 * kMB);
+  governor->Rebalance();
+  ASSERT_EQ(30 * kMB, wbm->buffer_size());
+  ASSERT_EQ(70 * kMB, cache->GetCapacity());
+  ASSERT_EQ(1, statistics->getTickerCount(
+                   MEMORY_GOVERNOR_MOVES_TO_WRITE_BUFFER));
+  ASSERT_EQ(5 * kMB,
+            statistics->getTickerCount(MEMORY_GOVERNOR_BYTES_MOVED));
+  wbm->FreeMem(24 * kMB);
+
+  // A full block cache with misses gets it back, down to the minimum share
+  for (int i = 0; i < 70; i++) {
+    std::string key = "block" + std::to_string(i);
+    ASSERT_OK(cache->Insert(key, nullptr, kMB, &DeleteNothing));
+  }
+  statistics->recordTick(BLOCK_CACHE_HIT, 50);
+  statistics->recordTick(BLOCK_CACHE_MISS, 50);
+  governor->Rebalance();
+  ASSERT_EQ(25 * kMB, wbm->buffer_size());
+  ASSERT_EQ(75 * kMB, cache->GetCapacity());
+  ASSERT_EQ(1, statistics->getTickerCount(
+                   MEMORY_GOVERNOR_MOVES_TO_BLOCK_CACHE));
+  for (int i = 70; i < 75; i++) {
+    std::string key = "block" + std::to_string(i);
+    ASSERT_OK(cache->Insert(key, nullptr, kMB, &DeleteNothing));
+  }
+  statistics->recordTick(BLOCK_CACHE_MISS, 50);
+  governor->Rebalance();
+  ASSERT_EQ(20 * kMB, wbm->buffer_size());
+  // Without new misses the block cache is not under pressure
+  governor->Rebalance();
+  ASSERT_EQ(20 * kMB, wbm->buffer_size());
+
+  MemoryGovernorStats stats;
+  governor->GetStats(&stats);
+  ASSERT_EQ(20 * kMB, stats.write_buffer_share);
+  ASSERT_EQ(80 * kMB, stats.block_cache_share);
+  ASSERT_EQ(75 * kMB, stats.block_cache_usage);
+  ASSERT_EQ(5, stats.rebalances);
+  ASSERT_EQ(1, stats.moves_to_write_buffer);
+  ASSERT_EQ(2, stats.moves_to_block_cache);
+
+  // The write buffer ratio is kept across budget changes
+  governor->SetTotalBudget(200 * kMB);
+  ASSERT_EQ(40 * kMB, wbm->buffer_size());
+  ASSERT_EQ(160 * kMB, cache->GetCapacity());
+}
+
+TEST_F(WriteBufferManagerTest, MemoryGovernorWithCacheCost) {
+  const size_t kMB = 1024 * 1024;
+  std::shared_ptr<Cache> cache =
+      NewLRUCache(kMB, 0, false, 0.5, nullptr, kDefaultToAdaptiveMutex,
+                  kDontChargeCacheMetadata);
+  std::shared_ptr<WriteBufferManager> wbm(new WriteBufferManager(kMB, cache));
+
+  MemoryGovernorOptions options;
+  options.total_budget = 100 * kMB;
+  options.block_cache = cache;
+  options.write_buffer_manager = wbm;
+  options.rebalance_period_sec = 0;
+  std::unique_ptr<MemoryGovernor> governor(NewMemoryGovernor(options));
+  ASSERT_NE(governor, nullptr);
+  // The memtables are charged to the cache, which holds the whole budget
+  ASSERT_EQ(25 * kMB, wbm->buffer_size());
+  ASSERT_EQ(100 * kMB, cache->GetCapacity());
+
+  wbm->ReserveMem(24 * kMB);
+  governor->Rebalance();
+  ASSERT_EQ(30 * kMB, wbm->buffer_size());
+  ASSERT_EQ(100 * kMB, cache->GetCapacity());
+  MemoryGovernorStats stats;
+  governor->GetStats(&stats);
+  ASSERT_EQ(0, stats.block_cache_usage);
+  wbm->FreeMem(24 * kMB);
+
+  // A disabled write buffer manager cannot be governed
+  options.write_buffer_manager.reset(new WriteBufferManager(0, cache));
+  governor.reset(NewMemoryGovernor(options));
+  ASSERT_EQ(governor, nullptr);
+}
 #endif  // ROCKSDB_LITE
 }  // namespace ROCKSDB_NAMESPACE
 
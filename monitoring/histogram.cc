@@ -10,12 +10,14 @@
 #include "monitoring/histogram.h"
 
 #include <stdio.h>
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
 #include <cmath>
 
 #include "port/port.h"
 #include "util/cast_util.h"
+#include "util/math.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -61,12 +63,55 @@ namespace {
   const HistogramBucketMapper bucketMapper;
 }
 
+const int HistogramStat::kMinHdrPrecisionBits;
+const int HistogramStat::kMaxHdrPrecisionBits;
+
 HistogramStat::HistogramStat()
-  : num_buckets_(bucketMapper.BucketCount()) {
+    : hdr_precision_bits_(0), num_buckets_(bucketMapper.BucketCount()) {
   assert(num_buckets_ == sizeof(buckets_) / sizeof(*buckets_));
   Clear();
 }
 
+void HistogramStat::UseHdrBuckets(int precision_bits) {
+  assert(precision_bits >= kMinHdrPrecisionBits &&
+         precision_bits <= kMaxHdrPrecisionBits);
+  precision_bits = std::min(std::max(precision_bits, kMinHdrPrecisionBits),
+                            kMaxHdrPrecisionBits);
+  hdr_precision_bits_ = precision_bits;
+  num_buckets_ = static_cast<uint64_t>(65 - precision_bits) << precision_bits;
+  hdr_buckets_.reset(
+      new std::atomic_uint_fast64_t[static_cast<size_t>(num_buckets_)]);
+  Clear();
+}
+
+size_t HistogramStat::IndexForValue(uint64_t value) const {
+  if (!hdr_buckets_) {
+    return bucketMapper.IndexForValue(value);
+  }
+  // Values of [2^(p + e), 2^(p + e + 1)) share buckets 2^e wide, the ones
+  // below 2^(p + 1) have one each
+  const int p = hdr_precision_bits_;
+  if (value < (uint64_t{2} << p)) {
+    return static_cast<size_t>(value);
+  }
+  const int e = FloorLog2(value) - p;
+  return static_cast<size_t>((static_cast<uint64_t>(e) << p) + (value >> e));
+}
+
+uint64_t HistogramStat::BucketLimit(size_t b) const {
+  if (!hdr_buckets_) {
+    return bucketMapper.BucketLimit(b);
+  }
+  const int p = hdr_precision_bits_;
+  if (b < (size_t{2} << p)) {
+    return b;
+  }
+  const int e = static_cast<int>(b >> p) - 1;
+  const uint64_t m = b - (static_cast<uint64_t>(e) << p);
+  // Wraps around to the largest value for the last bucket
+  return ((m + 1) << e) - 1;
+}
+
 void HistogramStat::Clear() {
   min_.store(bucketMapper.LastValue(), std::memory_order_relaxed);
   max_.store(0, std::memory_order_relaxed);
@@ -74,7 +119,7 @@ void HistogramStat::Clear() {
   sum_.store(0, std::memory_order_relaxed);
   sum_squares_.store(0, std::memory_order_relaxed);
   for (unsigned int b = 0; b < num_buckets_; b++) {
-    buckets_[b].store(0, std::memory_order_relaxed);
+    bucket(b).store(0, std::memory_order_relaxed);
   }
 };
 
@@ -84,10 +129,10 @@ void HistogramStat::Add(uint64_t value) {
   // This function is designed to be lock free, as it's in the critical path
   // of any operation. Each individual value is atomic and the order of updates
   // by concurrent threads is tolerable.
-  const size_t index = bucketMapper.IndexForValue(value);
+  const size_t index = IndexForValue(value);
   assert(index < num_buckets_);
-  buckets_[index].store(buckets_[index].load(std::memory_order_relaxed) + 1,
-                        std::memory_order_relaxed);
+  std::atomic_uint_fast64_t& b = bucket(index);
+  b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 
   uint64_t old_min = min();
   if (value < old_min) {
@@ -125,8 +170,18 @@ void HistogramStat::Merge(const HistogramStat& other) {
   num_.fetch_add(other.num(), std::memory_order_relaxed);
   sum_.fetch_add(other.sum(), std::memory_order_relaxed);
   sum_squares_.fetch_add(other.sum_squares(), std::memory_order_relaxed);
-  for (unsigned int b = 0; b < num_buckets_; b++) {
-    buckets_[b].fetch_add(other.bucket_at(b), std::memory_order_relaxed);
+  if (hdr_precision_bits_ == other.hdr_precision_bits_) {
+    for (unsigned int b = 0; b < num_buckets_; b++) {
+      bucket(b).fetch_add(other.bucket_at(b), std::memory_order_relaxed);
+    }
+  } else {
+    for (unsigned int b = 0; b < other.num_buckets_; b++) {
+      const uint64_t count = other.bucket_at(b);
+      if (count > 0) {
+        bucket(IndexForValue(other.BucketLimit(b)))
+            .fetch_add(count, std::memory_order_relaxed);
+      }
+    }
   }
 }
 
@@ -142,8 +197,8 @@ double HistogramStat::Percentile(double p) const {
     cumulative_sum += bucket_value;
     if (cumulative_sum >= threshold) {
       // Scale linearly within this bucket
-      uint64_t left_point = (b == 0) ? 0 : bucketMapper.BucketLimit(b-1);
-      uint64_t right_point = bucketMapper.BucketLimit(b);
+      uint64_t left_point = (b == 0) ? 0 : BucketLimit(b - 1);
+      uint64_t right_point = BucketLimit(b);
       uint64_t left_sum = cumulative_sum - bucket_value;
       uint64_t right_sum = cumulative_sum;
       double pos = 0;
@@ -208,8 +263,8 @@ std::string HistogramStat::ToString() const {
     snprintf(buf, sizeof(buf),
              "%c %7" PRIu64 ", %7" PRIu64 " ] %8" PRIu64 " %7.3f%% %7.3f%% ",
              (b == 0) ? '[' : '(',
-             (b == 0) ? 0 : bucketMapper.BucketLimit(b-1),  // left
-              bucketMapper.BucketLimit(b),  // right
+             (b == 0) ? 0 : BucketLimit(b - 1),  // left
+             BucketLimit(b),                     // right
               bucket_value,                   // count
              (mult * bucket_value),           // percentage
              (mult * cumulative_sum));       // cumulative percentage
@@ -236,6 +291,18 @@ void HistogramStat::Data(HistogramData * const data) const {
   data->min = static_cast<double>(min());
 }
 
+HistogramImpl::HistogramImpl(int hdr_precision_bits) {
+  if (hdr_precision_bits != 0) {
+    stats_.UseHdrBuckets(hdr_precision_bits);
+  }
+  Clear();
+}
+
+void HistogramImpl::UseHdrBuckets(int precision_bits) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.UseHdrBuckets(precision_bits);
+}
+
 void HistogramImpl::Clear() {
   std::lock_guard<std::mutex> lock(mutex_);
   stats_.Clear();
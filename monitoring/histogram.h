@@ -11,10 +11,11 @@
 #include "rocksdb/statistics.h"
 
 #include <cassert>
-#include <string>
-#include <vector>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <vector>
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -58,9 +59,25 @@ struct HistogramStat {
   HistogramStat(const HistogramStat&) = delete;
   HistogramStat& operator=(const HistogramStat&) = delete;
 
+  // The allowed range of precision_bits for UseHdrBuckets()
+  static const int kMinHdrPrecisionBits = 1;
+  static const int kMaxHdrPrecisionBits = 10;
+
+  // Switches to HDR-style buckets: every value below 2^(precision_bits + 1)
+  // gets a bucket of its own, and larger values buckets 2^-precision_bits of
+  // their magnitude wide, so that percentiles are resolved to that relative
+  // precision at any magnitude. Takes (65 - precision_bits) << precision_bits
+  // buckets, allocated here, instead of the 109 fixed ones. Clears the
+  // histogram.
+  // REQUIRES: no concurrent access
+  void UseHdrBuckets(int precision_bits);
+  int hdr_precision_bits() const { return hdr_precision_bits_; }
+
   void Clear();
   bool Empty() const;
   void Add(uint64_t value);
+  // Histograms with different buckets are merged by adding the counts of
+  // the buckets of other to the buckets of their upper limits.
   void Merge(const HistogramStat& other);
 
   inline uint64_t min() const { return min_.load(std::memory_order_relaxed); }
@@ -71,9 +88,21 @@ struct HistogramStat {
     return sum_squares_.load(std::memory_order_relaxed);
   }
   inline uint64_t bucket_at(size_t b) const {
-    return buckets_[b].load(std::memory_order_relaxed);
+    return bucket(b).load(std::memory_order_relaxed);
+  }
+  inline std::atomic_uint_fast64_t& bucket(size_t b) {
+    assert(b < num_buckets_);
+    return hdr_buckets_ ? hdr_buckets_[b] : buckets_[b];
+  }
+  inline const std::atomic_uint_fast64_t& bucket(size_t b) const {
+    assert(b < num_buckets_);
+    return hdr_buckets_ ? hdr_buckets_[b] : buckets_[b];
   }
 
+  size_t IndexForValue(uint64_t value) const;
+  // The largest value of bucket b
+  uint64_t BucketLimit(size_t b) const;
+
   double Median() const;
   double Percentile(double p) const;
   double Average() const;
@@ -90,7 +119,11 @@ struct HistogramStat {
   std::atomic_uint_fast64_t sum_;
   std::atomic_uint_fast64_t sum_squares_;
   std::atomic_uint_fast64_t buckets_[109]; // 109==BucketMapper::BucketCount()
-  const uint64_t num_buckets_;
+  // The HDR-style buckets, used instead of buckets_ when set by
+  // UseHdrBuckets()
+  std::unique_ptr<std::atomic_uint_fast64_t[]> hdr_buckets_;
+  int hdr_precision_bits_;
+  uint64_t num_buckets_;
 };
 
 class Histogram {
@@ -118,6 +151,9 @@ public:
 class HistogramImpl : public Histogram {
  public:
   HistogramImpl() { Clear(); }
+  // With HDR-style buckets of the precision if hdr_precision_bits is not 0,
+  // see HistogramStat::UseHdrBuckets()
+  explicit HistogramImpl(int hdr_precision_bits);
 
   HistogramImpl(const HistogramImpl&) = delete;
   HistogramImpl& operator=(const HistogramImpl&) = delete;
@@ -141,6 +177,10 @@ class HistogramImpl : public Histogram {
 
   virtual ~HistogramImpl() {}
 
+  // See HistogramStat::UseHdrBuckets()
+  void UseHdrBuckets(int precision_bits);
+  int hdr_precision_bits() const { return stats_.hdr_precision_bits(); }
+
  private:
   HistogramStat stats_;
   std::mutex mutex_;
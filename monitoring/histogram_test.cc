@@ -7,7 +7,9 @@
 
 #include "monitoring/histogram.h"
 #include "monitoring/histogram_windowing.h"
+#include "port/port.h"
 #include "test_util/testharness.h"
+#include "util/random.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -213,6 +215,64 @@ TEST_F(HistogramTest, HistogramWindowingMerge) {
   ASSERT_EQ(histogramWindowing.max(), 5);
 }
 
+TEST_F(HistogramTest, HdrBuckets) {
+  for (int bits = HistogramStat::kMinHdrPrecisionBits;
+       bits <= HistogramStat::kMaxHdrPrecisionBits; bits++) {
+    HistogramStat stat;
+    stat.UseHdrBuckets(bits);
+    ASSERT_EQ(stat.BucketLimit(static_cast<size_t>(stat.num_buckets_ - 1)),
+              port::kMaxUint64);
+    ASSERT_EQ(stat.IndexForValue(port::kMaxUint64), stat.num_buckets_ - 1);
+
+    Random64 rnd(301);
+    for (int i = 0; i < 10000; i++) {
+      // Values of all magnitudes
+      const uint64_t value = rnd.Next() >> rnd.Uniform(64);
+      const size_t b = stat.IndexForValue(value);
+      ASSERT_LT(b, stat.num_buckets_);
+      ASSERT_GE(stat.BucketLimit(b), value);
+      const uint64_t low = b == 0 ? 0 : stat.BucketLimit(b - 1) + 1;
+      ASSERT_LE(low, value);
+      // The bucket is at most 2^-bits of the value wide
+      ASSERT_LE(stat.BucketLimit(b) - low, value >> bits);
+    }
+  }
+}
+
+TEST_F(HistogramTest, HdrHistogram) {
+  HistogramImpl histogram(7);
+  BasicOperation(histogram);
+
+  HistogramImpl merged(7);
+  HistogramImpl other(7);
+  MergeHistogram(merged, other);
+
+  HistogramImpl empty(7);
+  EmptyHistogram(empty);
+  ClearHistogram(empty);
+
+  HistogramWindowingImpl histogramWindowing(3, 60000000, 0, 7);
+  BasicOperation(histogramWindowing);
+
+  // Large values get percentiles within the precision, where the default
+  // buckets are about 1.5 times apart
+  HistogramImpl precise(7);
+  HistogramImpl coarse;
+  for (uint64_t value = 1000000; value <= 2000000; value += 1000) {
+    precise.Add(value);
+    coarse.Add(value);
+  }
+  ASSERT_LE(fabs(precise.Percentile(10) - 1100000), 1100000 >> 7);
+  ASSERT_GT(fabs(coarse.Percentile(10) - 1100000), 1100000 >> 7);
+  ASSERT_LE(fabs(precise.Percentile(90) - 1900000), 1900000 >> 7);
+
+  // Histograms with different buckets can be merged
+  precise.Merge(coarse);
+  ASSERT_EQ(2002, precise.num());
+  ASSERT_EQ(1000000, precise.min());
+  ASSERT_EQ(2000000, precise.max());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
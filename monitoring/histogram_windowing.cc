@@ -24,12 +24,19 @@ HistogramWindowingImpl::HistogramWindowingImpl() {
 HistogramWindowingImpl::HistogramWindowingImpl(
     uint64_t num_windows,
     uint64_t micros_per_window,
-    uint64_t min_num_per_window) :
+    uint64_t min_num_per_window,
+    int hdr_precision_bits) :
       num_windows_(num_windows),
       micros_per_window_(micros_per_window),
       min_num_per_window_(min_num_per_window) {
   env_ = Env::Default();
   window_stats_.reset(new HistogramStat[static_cast<size_t>(num_windows_)]);
+  if (hdr_precision_bits != 0) {
+    stats_.UseHdrBuckets(hdr_precision_bits);
+    for (size_t i = 0; i < num_windows_; i++) {
+      window_stats_[i].UseHdrBuckets(hdr_precision_bits);
+    }
+  }
   Clear();
 }
 
@@ -73,7 +80,7 @@ void HistogramWindowingImpl::Merge(const HistogramWindowingImpl& other) {
   std::lock_guard<std::mutex> lock(mutex_);
   stats_.Merge(other.stats_);
 
-  if (stats_.num_buckets_ != other.stats_.num_buckets_ ||
+  if (stats_.hdr_precision_bits() != other.stats_.hdr_precision_bits() ||
       micros_per_window_ != other.micros_per_window_) {
     return;
   }
@@ -156,7 +163,7 @@ void HistogramWindowingImpl::SwapHistoryBucket() {
 
     if (!stats_to_drop.Empty()) {
       for (size_t b = 0; b < stats_.num_buckets_; b++){
-        stats_.buckets_[b].fetch_sub(
+        stats_.bucket(b).fetch_sub(
             stats_to_drop.bucket_at(b), std::memory_order_relaxed);
       }
 
@@ -18,9 +18,12 @@ class HistogramWindowingImpl : public Histogram
 {
 public:
   HistogramWindowingImpl();
+  // With HDR-style buckets of the precision if hdr_precision_bits is not 0,
+  // see HistogramStat::UseHdrBuckets()
   HistogramWindowingImpl(uint64_t num_windows,
                          uint64_t micros_per_window,
-                         uint64_t min_num_per_window);
+                         uint64_t min_num_per_window,
+                         int hdr_precision_bits = 0);
 
   HistogramWindowingImpl(const HistogramWindowingImpl&) = delete;
   HistogramWindowingImpl& operator=(const HistogramWindowingImpl&) = delete;
@@ -22,11 +22,15 @@ Statistics* stats_for_report(Env* env, Statistics* stats) {
 #endif  // NPERF_CONTEXT
 }  // namespace
 
-void InstrumentedMutex::Lock() {
+void InstrumentedMutex::Lock(const char* file, int line) {
   PERF_CONDITIONAL_TIMER_FOR_MUTEX_GUARD(
       db_mutex_lock_nanos, stats_code_ == DB_MUTEX_WAIT_MICROS,
       stats_for_report(env_, stats_), stats_code_);
-  LockInternal();
+  if (name_ != nullptr) {
+    profile_.Acquire(file, line, [this]() { LockInternal(); });
+  } else {
+    LockInternal();
+  }
 }
 
 void InstrumentedMutex::LockInternal() {
@@ -37,6 +41,7 @@ void InstrumentedMutex::LockInternal() {
 }
 
 void InstrumentedCondVar::Wait() {
+  instrumented_mutex_->EndProfiledHold();
   PERF_CONDITIONAL_TIMER_FOR_MUTEX_GUARD(
       db_condition_wait_nanos, stats_code_ == DB_MUTEX_WAIT_MICROS,
       stats_for_report(env_, stats_), stats_code_);
@@ -51,6 +56,7 @@ void InstrumentedCondVar::WaitInternal() {
 }
 
 bool InstrumentedCondVar::TimedWait(uint64_t abs_time_us) {
+  instrumented_mutex_->EndProfiledHold();
   PERF_CONDITIONAL_TIMER_FOR_MUTEX_GUARD(
       db_condition_wait_nanos, stats_code_ == DB_MUTEX_WAIT_MICROS,
       stats_for_report(env_, stats_), stats_code_);
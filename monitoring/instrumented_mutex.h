@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "monitoring/lock_profiler.h"
 #include "monitoring/statistics.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
@@ -16,23 +17,29 @@ namespace ROCKSDB_NAMESPACE {
 class InstrumentedCondVar;
 
 // A wrapper class for port::Mutex that provides additional layer
-// for collecting stats and instrumentation.
+// for collecting stats and instrumentation. A named mutex is profiled by
+// the lock profiler under its name.
 class InstrumentedMutex {
  public:
   explicit InstrumentedMutex(bool adaptive = false)
       : mutex_(adaptive), stats_(nullptr), env_(nullptr),
-        stats_code_(0) {}
+        stats_code_(0), name_(nullptr) {}
 
   InstrumentedMutex(
       Statistics* stats, Env* env,
-      int stats_code, bool adaptive = false)
+      int stats_code, bool adaptive = false, const char* name = nullptr)
       : mutex_(adaptive), stats_(stats), env_(env),
-        stats_code_(stats_code) {}
+        stats_code_(stats_code), name_(name) {}
 
-  void Lock();
+  void Lock(const char* file = ROCKSDB_LOCK_SITE_FILE,
+            int line = ROCKSDB_LOCK_SITE_LINE);
 
   void Unlock() {
-    mutex_.Unlock();
+    if (name_ != nullptr) {
+      profile_.Release(this, name_, [this]() { mutex_.Unlock(); });
+    } else {
+      mutex_.Unlock();
+    }
   }
 
   void AssertHeld() {
@@ -41,19 +48,30 @@ class InstrumentedMutex {
 
  private:
   void LockInternal();
+  // Ends the sampled hold, if any, as the mutex is released to wait
+  void EndProfiledHold() {
+    if (name_ != nullptr) {
+      profile_.Release(this, name_, []() {});
+    }
+  }
   friend class InstrumentedCondVar;
   port::Mutex mutex_;
   Statistics* stats_;
   Env* env_;
   int stats_code_;
+  const char* const name_;
+  LockProfile profile_;
 };
 
 // A wrapper class for port::Mutex that provides additional layer
 // for collecting stats and instrumentation.
 class InstrumentedMutexLock {
  public:
-  explicit InstrumentedMutexLock(InstrumentedMutex* mutex) : mutex_(mutex) {
-    mutex_->Lock();
+  explicit InstrumentedMutexLock(InstrumentedMutex* mutex,
+                                 const char* file = ROCKSDB_LOCK_SITE_FILE,
+                                 int line = ROCKSDB_LOCK_SITE_LINE)
+      : mutex_(mutex) {
+    mutex_->Lock(file, line);
   }
 
   ~InstrumentedMutexLock() {
@@ -69,7 +87,8 @@ class InstrumentedMutexLock {
 class InstrumentedCondVar {
  public:
   explicit InstrumentedCondVar(InstrumentedMutex* instrumented_mutex)
-      : cond_(&(instrumented_mutex->mutex_)),
+      : instrumented_mutex_(instrumented_mutex),
+        cond_(&(instrumented_mutex->mutex_)),
         stats_(instrumented_mutex->stats_),
         env_(instrumented_mutex->env_),
         stats_code_(instrumented_mutex->stats_code_) {}
@@ -89,6 +108,7 @@ class InstrumentedCondVar {
  private:
   void WaitInternal();
   bool TimedWaitInternal(uint64_t abs_time_us);
+  InstrumentedMutex* const instrumented_mutex_;
   port::CondVar cond_;
   Statistics* stats_;
   Env* env_;
@@ -33,8 +33,10 @@ extern __thread IOStatsContext iostats_context;
 #define IOSTATS(metric) (iostats_context.metric)
 
 // Declare and set start time of the timer
-#define IOSTATS_TIMER_GUARD(metric)                                     \
-  PerfStepTimer iostats_step_timer_##metric(&(iostats_context.metric)); \
+#define IOSTATS_TIMER_GUARD(metric)                               \
+  PerfStepTimer iostats_step_timer_##metric(                      \
+      &(iostats_context.metric), nullptr, false,                  \
+      PerfLevel::kEnableTimeExceptForMutex, nullptr, 0, #metric); \
   iostats_step_timer_##metric.Start();
 
 // Declare and set start time of the timer
@@ -0,0 +1,169 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/lock_profiler.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+#include "rocksdb/env.h"
+#include "util/hash.h"
+#include "util/random.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+std::atomic<uint32_t> lock_profiling_sample_one_in(0);
+
+bool ShouldSampleLockSlow(uint32_t sample_one_in) {
+  return sample_one_in == 1 ||
+         Random::GetTLSInstance()->OneIn(static_cast<int>(sample_one_in));
+}
+
+uint64_t LockProfilerNowNanos() { return Env::Default()->NowNanos(); }
+
+namespace {
+// The samples of a lock instance from an acquire site
+struct SiteSamples {
+  const char* lock_name = nullptr;
+  uint64_t count = 0;
+  uint64_t total_wait_nanos = 0;
+  uint64_t max_wait_nanos = 0;
+  uint64_t total_hold_nanos = 0;
+  uint64_t max_hold_nanos = 0;
+};
+
+// The samples by lock instance and acquire site, sharded by lock instance
+class LockProfiler {
+ public:
+  void Record(const void* lock, const char* lock_name, const char* file,
+              int line, uint64_t wait_nanos, uint64_t hold_nanos) {
+    Shard& shard = shards_[ShardOf(lock)];
+    std::lock_guard<std::mutex> guard(shard.mu);
+    SiteSamples& samples = shard.sites[Key(lock, file, line)];
+    samples.lock_name = lock_name;
+    samples.count++;
+    samples.total_wait_nanos += wait_nanos;
+    samples.max_wait_nanos = std::max(samples.max_wait_nanos, wait_nanos);
+    samples.total_hold_nanos += hold_nanos;
+    samples.max_hold_nanos = std::max(samples.max_hold_nanos, hold_nanos);
+  }
+
+  void Get(std::vector<LockContentionStats>* stats) {
+    stats->clear();
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> guard(shard.mu);
+      for (const auto& site : shard.sites) {
+        LockContentionStats s;
+        s.lock_name = site.second.lock_name;
+        s.lock_id = reinterpret_cast<uintptr_t>(std::get<0>(site.first));
+        s.acquire_site = SiteName(std::get<1>(site.first),
+                                  std::get<2>(site.first));
+        s.sampled_acquisitions = site.second.count;
+        s.total_wait_nanos = site.second.total_wait_nanos;
+        s.max_wait_nanos = site.second.max_wait_nanos;
+        s.total_hold_nanos = site.second.total_hold_nanos;
+        s.max_hold_nanos = site.second.max_hold_nanos;
+        stats->push_back(std::move(s));
+      }
+    }
+    std::sort(stats->begin(), stats->end(),
+              [](const LockContentionStats& a, const LockContentionStats& b) {
+                return a.total_wait_nanos > b.total_wait_nanos;
+              });
+  }
+
+  void Reset() {
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> guard(shard.mu);
+      shard.sites.clear();
+    }
+  }
+
+ private:
+  typedef std::tuple<const void*, const char*, int> Key;
+
+  static const int kNumShards = 16;
+
+  struct Shard {
+    std::mutex mu;
+    std::map<Key, SiteSamples> sites;
+  };
+
+  static int ShardOf(const void* lock) {
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(lock);
+    return static_cast<int>(
+        Hash(reinterpret_cast<const char*>(&addr), sizeof(addr), 0) %
+        kNumShards);
+  }
+
+  // The last directory and the file name of the path, with the line
+  static std::string SiteName(const char* file, int line) {
+    const char* name = file;
+    const char* last = strrchr(file, '/');
+    if (last != nullptr) {
+      name = last;
+      while (name > file && name[-1] != '/') {
+        name--;
+      }
+    }
+    return std::string(name) + ":" + ToString(line);
+  }
+
+  Shard shards_[kNumShards];
+};
+
+LockProfiler* GetLockProfiler() {
+  // Never destroyed, as locks may be released during static destruction
+  static LockProfiler* profiler = new LockProfiler();
+  return profiler;
+}
+}  // namespace
+
+void RecordLockSample(const void* lock, const char* lock_name,
+                      const char* file, int line, uint64_t wait_nanos,
+                      uint64_t hold_nanos) {
+  GetLockProfiler()->Record(lock, lock_name, file, line, wait_nanos,
+                            hold_nanos);
+}
+
+void SetLockProfilingSampleOneIn(uint32_t sample_one_in) {
+  lock_profiling_sample_one_in.store(sample_one_in, std::memory_order_relaxed);
+}
+
+void GetLockContentionStats(std::vector<LockContentionStats>* stats) {
+  GetLockProfiler()->Get(stats);
+}
+
+std::string LockContentionStatsToString(size_t max_entries) {
+  std::vector<LockContentionStats> stats;
+  GetLockContentionStats(&stats);
+  std::string out;
+  char buf[512];
+  snprintf(buf, sizeof(buf), "%-28s %-18s %-40s %10s %12s %12s %12s %12s\n",
+           "Lock", "Instance", "Site", "Samples", "Wait(us)", "MaxWait(us)",
+           "Hold(us)", "MaxHold(us)");
+  out.append(buf);
+  for (size_t i = 0; i < stats.size() && i < max_entries; i++) {
+    const LockContentionStats& s = stats[i];
+    snprintf(buf, sizeof(buf),
+             "%-28s 0x%-16" PRIx64 " %-40s %10" PRIu64 " %12.1f %12.1f "
+             "%12.1f %12.1f\n",
+             s.lock_name.c_str(), s.lock_id, s.acquire_site.c_str(),
+             s.sampled_acquisitions, s.total_wait_nanos / 1000.0,
+             s.max_wait_nanos / 1000.0, s.total_hold_nanos / 1000.0,
+             s.max_hold_nanos / 1000.0);
+    out.append(buf);
+  }
+  return out;
+}
+
+void ResetLockContentionStats() { GetLockProfiler()->Reset(); }
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,158 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+#include "port/port.h"
+#include "rocksdb/lock_profiler.h"
+
+// The call site of a function, as default arguments of it
+#if defined(__clang__)
+#if __has_builtin(__builtin_FILE) && __has_builtin(__builtin_LINE)
+#define ROCKSDB_LOCK_SITE_FILE __builtin_FILE()
+#define ROCKSDB_LOCK_SITE_LINE __builtin_LINE()
+#endif
+#elif defined(__GNUC__)
+#define ROCKSDB_LOCK_SITE_FILE __builtin_FILE()
+#define ROCKSDB_LOCK_SITE_LINE __builtin_LINE()
+#endif
+#ifndef ROCKSDB_LOCK_SITE_FILE
+#define ROCKSDB_LOCK_SITE_FILE "unknown"
+#define ROCKSDB_LOCK_SITE_LINE 0
+#endif
+
+namespace ROCKSDB_NAMESPACE {
+
+extern std::atomic<uint32_t> lock_profiling_sample_one_in;
+
+extern bool ShouldSampleLockSlow(uint32_t sample_one_in);
+
+// Whether to profile an acquisition of a lock
+inline bool ShouldSampleLock() {
+  const uint32_t sample_one_in =
+      lock_profiling_sample_one_in.load(std::memory_order_relaxed);
+  return sample_one_in != 0 && ShouldSampleLockSlow(sample_one_in);
+}
+
+extern uint64_t LockProfilerNowNanos();
+
+extern void RecordLockSample(const void* lock, const char* lock_name,
+                             const char* file, int line, uint64_t wait_nanos,
+                             uint64_t hold_nanos);
+
+// The profile of the current acquisition of a lock, kept by its holder
+class LockProfile {
+ public:
+  LockProfile()
+      : hold_start_nanos_(0), wait_nanos_(0), file_(nullptr), line_(0) {}
+
+  // Acquires the lock with acquire(), and times the wait and the hold if
+  // the acquisition is sampled
+  template <typename AcquireFn>
+  void Acquire(const char* file, int line, AcquireFn acquire) {
+    if (!ShouldSampleLock()) {
+      acquire();
+      return;
+    }
+    const uint64_t start_nanos = LockProfilerNowNanos();
+    acquire();
+    hold_start_nanos_ = LockProfilerNowNanos();
+    wait_nanos_ = hold_start_nanos_ - start_nanos;
+    file_ = file;
+    line_ = line;
+  }
+
+  // Releases the lock with release(), recording the sample if any
+  template <typename ReleaseFn>
+  void Release(const void* lock, const char* lock_name, ReleaseFn release) {
+    if (hold_start_nanos_ == 0) {
+      release();
+      return;
+    }
+    const uint64_t hold_nanos = LockProfilerNowNanos() - hold_start_nanos_;
+    const uint64_t wait_nanos = wait_nanos_;
+    const char* file = file_;
+    const int line = line_;
+    hold_start_nanos_ = 0;
+    release();
+    RecordLockSample(lock, lock_name, file, line, wait_nanos, hold_nanos);
+  }
+
+ private:
+  // Non-zero while a sampled acquisition holds the lock
+  uint64_t hold_start_nanos_;
+  uint64_t wait_nanos_;
+  const char* file_;
+  int line_;
+};
+
+// A port::Mutex whose acquisitions are profiled under its name
+class ProfiledPortMutex {
+ public:
+  explicit ProfiledPortMutex(const char* name, bool adaptive = false)
+      : mutex_(adaptive), name_(name) {}
+
+  void Lock(const char* file = ROCKSDB_LOCK_SITE_FILE,
+            int line = ROCKSDB_LOCK_SITE_LINE) {
+    profile_.Acquire(file, line, [this]() { mutex_.Lock(); });
+  }
+
+  void Unlock() {
+    profile_.Release(this, name_, [this]() { mutex_.Unlock(); });
+  }
+
+  void AssertHeld() { mutex_.AssertHeld(); }
+
+ private:
+  port::Mutex mutex_;
+  const char* const name_;
+  LockProfile profile_;
+};
+
+class ProfiledMutexLock {
+ public:
+  explicit ProfiledMutexLock(ProfiledPortMutex* mu,
+                             const char* file = ROCKSDB_LOCK_SITE_FILE,
+                             int line = ROCKSDB_LOCK_SITE_LINE)
+      : mu_(mu) {
+    mu_->Lock(file, line);
+  }
+  ~ProfiledMutexLock() { mu_->Unlock(); }
+
+  // No copying allowed
+  ProfiledMutexLock(const ProfiledMutexLock&) = delete;
+  void operator=(const ProfiledMutexLock&) = delete;
+
+ private:
+  ProfiledPortMutex* const mu_;
+};
+
+// A std::mutex whose acquisitions are profiled under its name. Lockable,
+// but not with std::condition_variable.
+class ProfiledStdMutex {
+ public:
+  explicit ProfiledStdMutex(const char* name) : name_(name) {}
+
+  void lock(const char* file = ROCKSDB_LOCK_SITE_FILE,
+            int line = ROCKSDB_LOCK_SITE_LINE) {
+    profile_.Acquire(file, line, [this]() { mutex_.lock(); });
+  }
+
+  bool try_lock() { return mutex_.try_lock(); }
+
+  void unlock() {
+    profile_.Release(this, name_, [this]() { mutex_.unlock(); });
+  }
+
+ private:
+  std::mutex mutex_;
+  const char* const name_;
+  LockProfile profile_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -123,6 +123,12 @@ PerfContext::PerfContext(const PerfContext& other) {
   iter_next_cpu_nanos = other.iter_next_cpu_nanos;
   iter_prev_cpu_nanos = other.iter_prev_cpu_nanos;
   iter_seek_cpu_nanos = other.iter_seek_cpu_nanos;
+  arena_block_recycle_hit_count = other.arena_block_recycle_hit_count;
+  arena_block_recycle_miss_count = other.arena_block_recycle_miss_count;
+  iterator_recycle_hit_count = other.iterator_recycle_hit_count;
+  iterator_recycle_miss_count = other.iterator_recycle_miss_count;
+  iter_bound_pruned_file_count = other.iter_bound_pruned_file_count;
+  timestamp_pruned_file_count = other.timestamp_pruned_file_count;
   if (per_level_perf_context_enabled && level_to_perf_context != nullptr) {
     ClearPerLevelPerfContext();
   }
@@ -220,6 +226,12 @@ PerfContext::PerfContext(PerfContext&& other) noexcept {
   iter_next_cpu_nanos = other.iter_next_cpu_nanos;
   iter_prev_cpu_nanos = other.iter_prev_cpu_nanos;
   iter_seek_cpu_nanos = other.iter_seek_cpu_nanos;
+  arena_block_recycle_hit_count = other.arena_block_recycle_hit_count;
+  arena_block_recycle_miss_count = other.arena_block_recycle_miss_count;
+  iterator_recycle_hit_count = other.iterator_recycle_hit_count;
+  iterator_recycle_miss_count = other.iterator_recycle_miss_count;
+  iter_bound_pruned_file_count = other.iter_bound_pruned_file_count;
+  timestamp_pruned_file_count = other.timestamp_pruned_file_count;
   if (per_level_perf_context_enabled && level_to_perf_context != nullptr) {
     ClearPerLevelPerfContext();
   }
@@ -319,6 +331,12 @@ PerfContext& PerfContext::operator=(const PerfContext& other) {
   iter_next_cpu_nanos = other.iter_next_cpu_nanos;
   iter_prev_cpu_nanos = other.iter_prev_cpu_nanos;
   iter_seek_cpu_nanos = other.iter_seek_cpu_nanos;
+  arena_block_recycle_hit_count = other.arena_block_recycle_hit_count;
+  arena_block_recycle_miss_count = other.arena_block_recycle_miss_count;
+  iterator_recycle_hit_count = other.iterator_recycle_hit_count;
+  iterator_recycle_miss_count = other.iterator_recycle_miss_count;
+  iter_bound_pruned_file_count = other.iter_bound_pruned_file_count;
+  timestamp_pruned_file_count = other.timestamp_pruned_file_count;
   if (per_level_perf_context_enabled && level_to_perf_context != nullptr) {
     ClearPerLevelPerfContext();
   }
@@ -413,6 +431,12 @@ void PerfContext::Reset() {
   iter_next_cpu_nanos = 0;
   iter_prev_cpu_nanos = 0;
   iter_seek_cpu_nanos = 0;
+  arena_block_recycle_hit_count = 0;
+  arena_block_recycle_miss_count = 0;
+  iterator_recycle_hit_count = 0;
+  iterator_recycle_miss_count = 0;
+  iter_bound_pruned_file_count = 0;
+  timestamp_pruned_file_count = 0;
   if (per_level_perf_context_enabled && level_to_perf_context) {
     for (auto& kv : *level_to_perf_context) {
       kv.second.Reset();
@@ -531,6 +555,12 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const {
   PERF_CONTEXT_OUTPUT(iter_next_cpu_nanos);
   PERF_CONTEXT_OUTPUT(iter_prev_cpu_nanos);
   PERF_CONTEXT_OUTPUT(iter_seek_cpu_nanos);
+  PERF_CONTEXT_OUTPUT(arena_block_recycle_hit_count);
+  PERF_CONTEXT_OUTPUT(arena_block_recycle_miss_count);
+  PERF_CONTEXT_OUTPUT(iterator_recycle_hit_count);
+  PERF_CONTEXT_OUTPUT(iterator_recycle_miss_count);
+  PERF_CONTEXT_OUTPUT(iter_bound_pruned_file_count);
+  PERF_CONTEXT_OUTPUT(timestamp_pruned_file_count);
   PERF_CONTEXT_BY_LEVEL_OUTPUT_ONE_COUNTER(bloom_filter_useful);
   PERF_CONTEXT_BY_LEVEL_OUTPUT_ONE_COUNTER(bloom_filter_full_positive);
   PERF_CONTEXT_BY_LEVEL_OUTPUT_ONE_COUNTER(bloom_filter_full_true_positive);
@@ -20,6 +20,26 @@ extern thread_local PerfContext perf_context;
 #endif
 #endif
 
+// Whether the perf context, the statistics or a traced request may record
+// anything on this thread. The hottest read paths are templated on it, as
+// in
+//
+//   return InstrumentationEnabled(stats) ? GetImpl<true>(...)
+//                                        : GetImpl<false>(...);
+//
+// so that an instance without instrumentation checks neither perf_level nor
+// the statistics per step. Their timers and counters use the _IF macros
+// below, and their statistics calls a Statistics* that is nullptr unless
+// instrumented.
+inline bool InstrumentationEnabled(const Statistics* stats) {
+#if defined(NPERF_CONTEXT)
+  return stats != nullptr || GetActiveSpan() != nullptr;
+#else
+  return stats != nullptr || perf_level > PerfLevel::kDisable ||
+         GetActiveSpan() != nullptr;
+#endif
+}
+
 #if defined(NPERF_CONTEXT)
 
 #define PERF_TIMER_STOP(metric)
@@ -32,6 +52,10 @@ extern thread_local PerfContext perf_context;
 #define PERF_TIMER_MEASURE(metric)
 #define PERF_COUNTER_ADD(metric, value)
 #define PERF_COUNTER_BY_LEVEL_ADD(metric, value, level)
+#define PERF_TIMER_GUARD_IF(instrumented, metric)
+#define PERF_CPU_TIMER_GUARD_IF(instrumented, metric, env)
+#define PERF_COUNTER_ADD_IF(instrumented, metric, value)
+#define PERF_COUNTER_BY_LEVEL_ADD_IF(instrumented, metric, value, level)
 
 #else
 
@@ -42,12 +66,16 @@ extern thread_local PerfContext perf_context;
 
 // Declare and set start time of the timer
 #define PERF_TIMER_GUARD(metric)                                  \
-  PerfStepTimer perf_step_timer_##metric(&(perf_context.metric)); \
+  PerfStepTimer perf_step_timer_##metric(                         \
+      &(perf_context.metric), nullptr, false,                     \
+      PerfLevel::kEnableTimeExceptForMutex, nullptr, 0, #metric); \
   perf_step_timer_##metric.Start();
 
 // Declare and set start time of the timer
-#define PERF_TIMER_GUARD_WITH_ENV(metric, env)                         \
-  PerfStepTimer perf_step_timer_##metric(&(perf_context.metric), env); \
+#define PERF_TIMER_GUARD_WITH_ENV(metric, env)                    \
+  PerfStepTimer perf_step_timer_##metric(                         \
+      &(perf_context.metric), env, false,                         \
+      PerfLevel::kEnableTimeExceptForMutex, nullptr, 0, #metric); \
   perf_step_timer_##metric.Start();
 
 // Declare and set start time of the timer
@@ -61,7 +89,7 @@ extern thread_local PerfContext perf_context;
                                                ticker_type)                    \
   PerfStepTimer perf_step_timer_##metric(&(perf_context.metric), nullptr,      \
                                          false, PerfLevel::kEnableTime, stats, \
-                                         ticker_type);                         \
+                                         ticker_type, #metric);                \
   if (condition) {                                                             \
     perf_step_timer_##metric.Start();                                          \
   }
@@ -92,6 +120,32 @@ extern thread_local PerfContext perf_context;
     }                                                                        \
   }                                                                          \
 
+// As PERF_TIMER_GUARD, compiled out unless instrumented
+#define PERF_TIMER_GUARD_IF(instrumented, metric)                 \
+  PerfStepTimerIf<instrumented> perf_step_timer_##metric(         \
+      &(perf_context.metric), nullptr, false,                     \
+      PerfLevel::kEnableTimeExceptForMutex, nullptr, 0, #metric); \
+  perf_step_timer_##metric.Start();
+
+// As PERF_CPU_TIMER_GUARD, compiled out unless instrumented
+#define PERF_CPU_TIMER_GUARD_IF(instrumented, metric, env)       \
+  PerfStepTimerIf<instrumented> perf_step_timer_##metric(        \
+      &(perf_context.metric), env, true,                         \
+      PerfLevel::kEnableTimeAndCPUTimeExceptForMutex);           \
+  perf_step_timer_##metric.Start();
+
+// As PERF_COUNTER_ADD, compiled out unless instrumented
+#define PERF_COUNTER_ADD_IF(instrumented, metric, value) \
+  if (instrumented) {                                    \
+    PERF_COUNTER_ADD(metric, value)                      \
+  }
+
+// As PERF_COUNTER_BY_LEVEL_ADD, compiled out unless instrumented
+#define PERF_COUNTER_BY_LEVEL_ADD_IF(instrumented, metric, value, level) \
+  if (instrumented) {                                                    \
+    PERF_COUNTER_BY_LEVEL_ADD(metric, value, level)                      \
+  }
+
 #endif
 
 }  // namespace ROCKSDB_NAMESPACE
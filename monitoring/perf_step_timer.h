@@ -4,34 +4,45 @@
 //  (found in the LICENSE.Apache file in the root directory).
 //
 #pragma once
+#include <type_traits>
+
 #include "monitoring/perf_level_imp.h"
+#include "monitoring/span_tracer_imp.h"
 #include "rocksdb/env.h"
 #include "util/stop_watch.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+// Times a step into a metric. When the thread traces a request (see
+// SpanScope), a timer with a span name also records a span for the step,
+// whatever the PerfLevel.
 class PerfStepTimer {
  public:
   explicit PerfStepTimer(
       uint64_t* metric, Env* env = nullptr, bool use_cpu_time = false,
       PerfLevel enable_level = PerfLevel::kEnableTimeExceptForMutex,
-      Statistics* statistics = nullptr, uint32_t ticker_type = 0)
+      Statistics* statistics = nullptr, uint32_t ticker_type = 0,
+      const char* span_name = nullptr)
       : perf_counter_enabled_(perf_level >= enable_level),
         use_cpu_time_(use_cpu_time),
-        env_((perf_counter_enabled_ || statistics != nullptr)
+        span_((span_name != nullptr && !use_cpu_time) ? GetActiveSpan()
+                                                      : nullptr),
+        env_((perf_counter_enabled_ || statistics != nullptr ||
+              span_ != nullptr)
                  ? ((env != nullptr) ? env : Env::Default())
                  : nullptr),
         start_(0),
         metric_(metric),
         statistics_(statistics),
-        ticker_type_(ticker_type) {}
+        ticker_type_(ticker_type),
+        span_name_(span_name) {}
 
   ~PerfStepTimer() {
     Stop();
   }
 
   void Start() {
-    if (perf_counter_enabled_ || statistics_ != nullptr) {
+    if (perf_counter_enabled_ || statistics_ != nullptr || span_ != nullptr) {
       start_ = time_now();
     }
   }
@@ -47,17 +58,26 @@ class PerfStepTimer {
   void Measure() {
     if (start_) {
       uint64_t now = time_now();
-      *metric_ += now - start_;
+      if (perf_counter_enabled_) {
+        *metric_ += now - start_;
+      }
+      if (span_ != nullptr) {
+        RecordSpan(span_, span_name_, start_, now);
+      }
       start_ = now;
     }
   }
 
   void Stop() {
     if (start_) {
-      uint64_t duration = time_now() - start_;
+      uint64_t now = time_now();
+      uint64_t duration = now - start_;
       if (perf_counter_enabled_) {
         *metric_ += duration;
       }
+      if (span_ != nullptr) {
+        RecordSpan(span_, span_name_, start_, now);
+      }
 
       if (statistics_ != nullptr) {
         RecordTick(statistics_, ticker_type_, duration);
@@ -69,11 +89,35 @@ class PerfStepTimer {
  private:
   const bool perf_counter_enabled_;
   const bool use_cpu_time_;
+  const ActiveSpan* const span_;
   Env* const env_;
   uint64_t start_;
   uint64_t* metric_;
   Statistics* statistics_;
   uint32_t ticker_type_;
+  const char* const span_name_;
 };
 
+// Stands in for a PerfStepTimer in the instances of a hot path compiled
+// without instrumentation (see InstrumentationEnabled()).
+class NoopPerfStepTimer {
+ public:
+  explicit NoopPerfStepTimer(uint64_t* /*metric*/, Env* /*env*/ = nullptr,
+                             bool /*use_cpu_time*/ = false,
+                             PerfLevel /*enable_level*/ =
+                                 PerfLevel::kEnableTimeExceptForMutex,
+                             Statistics* /*statistics*/ = nullptr,
+                             uint32_t /*ticker_type*/ = 0,
+                             const char* /*span_name*/ = nullptr) {}
+
+  void Start() {}
+  void Measure() {}
+  void Stop() {}
+};
+
+template <bool kInstrumented>
+using PerfStepTimerIf =
+    typename std::conditional<kInstrumented, PerfStepTimer,
+                              NoopPerfStepTimer>::type;
+
 }  // namespace ROCKSDB_NAMESPACE
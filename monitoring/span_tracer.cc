@@ -0,0 +1,149 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+
+#include "monitoring/span_tracer_imp.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+__thread ActiveSpan* active_span = nullptr;
+#endif
+
+void SpanScope::Begin(SpanTracer* tracer, uint64_t trace_id, const char* name,
+                      Env* env) {
+  traced_ = true;
+  env_ = env != nullptr ? env : Env::Default();
+  span_.tracer = tracer;
+  span_.trace_id = trace_id;
+  span_.thread_id = env_->GetThreadID();
+  name_ = name;
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  prev_span_ = active_span;
+  active_span = &span_;
+#else
+  prev_span_ = nullptr;
+#endif
+  start_nanos_ = env_->NowNanos();
+}
+
+void SpanScope::End() {
+  RecordSpan(&span_, name_, start_nanos_, env_->NowNanos());
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  active_span = prev_span_;
+#endif
+}
+
+namespace {
+// A ring buffer of spans. Each slot is guarded by a sequence number, odd
+// while the slot is written and 2 * (position + 1) once the span at that
+// position of the stream is in it, so that readers can skip the slots
+// which are rewritten under them without taking a lock.
+class RingBufferSpanTracer : public SpanTracer {
+ public:
+  explicit RingBufferSpanTracer(const SpanTracerOptions& options)
+      : capacity_(std::max<size_t>(options.capacity, 1)),
+        sample_one_in_(std::max<uint64_t>(options.sample_one_in, 1)),
+        slots_(new Slot[capacity_]),
+        next_(0) {}
+
+  bool ShouldSample(uint64_t trace_id) const override {
+    return trace_id % sample_one_in_ == 0;
+  }
+
+  void Record(const SpanEvent& event) override {
+    const uint64_t pos = next_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[pos % capacity_];
+    uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+    // A writer lapped by the others drops its span rather than waiting
+    if ((seq & 1) != 0 || seq >= WrittenSeq(pos) ||
+        !slot.seq.compare_exchange_strong(seq, WrittenSeq(pos) - 1,
+                                          std::memory_order_relaxed)) {
+      return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.trace_id.store(event.trace_id, std::memory_order_relaxed);
+    slot.name.store(event.name, std::memory_order_relaxed);
+    slot.start_nanos.store(event.start_nanos, std::memory_order_relaxed);
+    slot.duration_nanos.store(event.duration_nanos, std::memory_order_relaxed);
+    slot.thread_id.store(event.thread_id, std::memory_order_relaxed);
+    slot.seq.store(WrittenSeq(pos), std::memory_order_release);
+  }
+
+  void GetSpans(std::vector<SpanEvent>* spans) const override {
+    spans->clear();
+    const uint64_t end = next_.load(std::memory_order_acquire);
+    const uint64_t begin = end > capacity_ ? end - capacity_ : 0;
+    for (uint64_t pos = begin; pos < end; pos++) {
+      const Slot& slot = slots_[pos % capacity_];
+      const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+      if (seq != WrittenSeq(pos)) {
+        continue;
+      }
+      SpanEvent event;
+      event.trace_id = slot.trace_id.load(std::memory_order_relaxed);
+      event.name = slot.name.load(std::memory_order_relaxed);
+      event.start_nanos = slot.start_nanos.load(std::memory_order_relaxed);
+      event.duration_nanos =
+          slot.duration_nanos.load(std::memory_order_relaxed);
+      event.thread_id = slot.thread_id.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.seq.load(std::memory_order_relaxed) == seq) {
+        spans->push_back(event);
+      }
+    }
+  }
+
+  Status ExportChromeTrace(std::string* output) const override {
+    std::vector<SpanEvent> spans;
+    GetSpans(&spans);
+    output->assign("{\"traceEvents\":[");
+    char buf[512];
+    for (size_t i = 0; i < spans.size(); i++) {
+      const SpanEvent& event = spans[i];
+      // Timestamps are in microseconds; the trace id is a string as JSON
+      // numbers may not hold 64 bits
+      snprintf(buf, sizeof(buf),
+               "%s\n{\"name\":\"%s\",\"cat\":\"rocksdb\",\"ph\":\"X\","
+               "\"ts\":%" PRIu64 ".%03" PRIu64 ",\"dur\":%" PRIu64
+               ".%03" PRIu64 ",\"pid\":0,\"tid\":%" PRIu64
+               ",\"args\":{\"trace_id\":\"%" PRIu64 "\"}}",
+               i == 0 ? "" : ",", event.name, event.start_nanos / 1000,
+               event.start_nanos % 1000, event.duration_nanos / 1000,
+               event.duration_nanos % 1000, event.thread_id, event.trace_id);
+      output->append(buf);
+    }
+    output->append("\n]}\n");
+    return Status::OK();
+  }
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<uint64_t> trace_id{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> start_nanos{0};
+    std::atomic<uint64_t> duration_nanos{0};
+    std::atomic<uint64_t> thread_id{0};
+  };
+
+  static uint64_t WrittenSeq(uint64_t pos) { return 2 * (pos + 1); }
+
+  const size_t capacity_;
+  const uint64_t sample_one_in_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> next_;
+};
+}  // namespace
+
+std::shared_ptr<SpanTracer> NewSpanTracer(const SpanTracerOptions& options) {
+  return std::make_shared<RingBufferSpanTracer>(options);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
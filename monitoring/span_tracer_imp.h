@@ -0,0 +1,111 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/span_tracer.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The request traced on a thread
+struct ActiveSpan {
+  SpanTracer* tracer;
+  uint64_t trace_id;
+  uint64_t thread_id;
+};
+
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+extern __thread ActiveSpan* active_span;
+#endif
+
+// Returns the request traced on the current thread, if any
+inline ActiveSpan* GetActiveSpan() {
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  return active_span;
+#else
+  return nullptr;
+#endif
+}
+
+inline void RecordSpan(const ActiveSpan* span, const char* name,
+                       uint64_t start_nanos, uint64_t end_nanos) {
+  SpanEvent event;
+  event.trace_id = span->trace_id;
+  event.name = name;
+  event.start_nanos = start_nanos;
+  event.duration_nanos = end_nanos > start_nanos ? end_nanos - start_nanos : 0;
+  event.thread_id = span->thread_id;
+  span->tracer->Record(event);
+}
+
+// Traces an operation of a request on the current thread while in scope,
+// if the tracer samples it: records a span for the whole operation, and
+// has the PerfStepTimers of the thread record theirs.
+class SpanScope {
+ public:
+  SpanScope(SpanTracer* tracer, uint64_t trace_id, const char* name, Env* env)
+      : traced_(false) {
+    if (tracer != nullptr && trace_id != 0 && tracer->ShouldSample(trace_id)) {
+      Begin(tracer, trace_id, name, env);
+    }
+  }
+
+  ~SpanScope() {
+    if (traced_) {
+      End();
+    }
+  }
+
+  // No copying allowed
+  SpanScope(const SpanScope&) = delete;
+  SpanScope& operator=(const SpanScope&) = delete;
+
+ private:
+  void Begin(SpanTracer* tracer, uint64_t trace_id, const char* name,
+             Env* env);
+  void End();
+
+  bool traced_;
+  ActiveSpan span_;
+  ActiveSpan* prev_span_;
+  const char* name_;
+  Env* env_;
+  uint64_t start_nanos_;
+};
+
+// Records a span for its scope if the current thread traces a request, for
+// steps not timed by a PerfStepTimer
+class SpanTimer {
+ public:
+  explicit SpanTimer(const char* name, Env* env = nullptr)
+      : span_(GetActiveSpan()), name_(name), env_(env), start_nanos_(0) {
+    if (span_ != nullptr) {
+      if (env_ == nullptr) {
+        env_ = Env::Default();
+      }
+      start_nanos_ = env_->NowNanos();
+    }
+  }
+
+  ~SpanTimer() {
+    if (span_ != nullptr) {
+      RecordSpan(span_, name_, start_nanos_, env_->NowNanos());
+    }
+  }
+
+  // No copying allowed
+  SpanTimer(const SpanTimer&) = delete;
+  SpanTimer& operator=(const SpanTimer&) = delete;
+
+ private:
+  const ActiveSpan* const span_;
+  const char* const name_;
+  Env* env_;
+  uint64_t start_nanos_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
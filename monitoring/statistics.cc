@@ -192,6 +192,41 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
      "rocksdb.block.cache.compression.dict.add.redundant"},
     {FILES_MARKED_TRASH, "rocksdb.files.marked.trash"},
     {FILES_DELETED_IMMEDIATELY, "rocksdb.files.deleted.immediately"},
+    {ZENFS_ZONE_RESETS, "rocksdb.zenfs.zone.resets"},
+    {ZENFS_ZONE_FINISHES, "rocksdb.zenfs.zone.finishes"},
+    {ZENFS_GC_BYTES_COPIED, "rocksdb.zenfs.gc.bytes.copied"},
+    {ZENFS_GC_EXTENTS_MIGRATED, "rocksdb.zenfs.gc.extents.migrated"},
+    {ZENFS_META_LOG_BYTES, "rocksdb.zenfs.meta.log.bytes"},
+    {ZENFS_READ_EXTENT_HOPS, "rocksdb.zenfs.read.extent.hops"},
+    {ZENFS_READ_CACHE_HIT, "rocksdb.zenfs.read.cache.hit"},
+    {ZENFS_READ_CACHE_MISS, "rocksdb.zenfs.read.cache.miss"},
+    {BLOB_DB_CACHE_HIT, "rocksdb.blobdb.cache.hit"},
+    {BLOB_DB_CACHE_MISS, "rocksdb.blobdb.cache.miss"},
+    {BLOB_DB_CACHE_ADD, "rocksdb.blobdb.cache.add"},
+    {BLOB_DB_CACHE_ADD_FAILURES, "rocksdb.blobdb.cache.add.failures"},
+    {BLOB_DB_CACHE_BYTES_READ, "rocksdb.blobdb.cache.bytes.read"},
+    {BLOB_DB_CACHE_BYTES_WRITE, "rocksdb.blobdb.cache.bytes.write"},
+    {NUMBER_MERGE_OPERANDS_COMBINED, "rocksdb.number.merge.operands.combined"},
+    {TABLE_OPEN_PREFETCHED_TAIL_HIT, "rocksdb.table.open.prefetched.tail.hit"},
+    {BLOCK_CACHE_WARMUP_BLOCKS, "rocksdb.block.cache.warmup.blocks"},
+    {MEMORY_GOVERNOR_MOVES_TO_WRITE_BUFFER,
+     "rocksdb.memory.governor.moves.to.write.buffer"},
+    {MEMORY_GOVERNOR_MOVES_TO_BLOCK_CACHE,
+     "rocksdb.memory.governor.moves.to.block.cache"},
+    {MEMORY_GOVERNOR_BYTES_MOVED, "rocksdb.memory.governor.bytes.moved"},
+    {IMMUTABLE_MEMTABLE_HIT, "rocksdb.immutable.memtable.hit"},
+    {IMMUTABLE_MEMTABLE_BYTES_MIGRATED,
+     "rocksdb.immutable.memtable.bytes.migrated"},
+    {SLOW_MEMORY_CACHE_HIT, "rocksdb.slow.memory.cache.hit"},
+    {SLOW_MEMORY_CACHE_MISS, "rocksdb.slow.memory.cache.miss"},
+    {SLOW_MEMORY_CACHE_ADD, "rocksdb.slow.memory.cache.add"},
+    {COMPACTION_RANGE_DEL_DROP_FILES,
+     "rocksdb.compaction.range.del.drop.files"},
+    {COMPACTION_RANGE_DEL_DROP_FILE_BYTES,
+     "rocksdb.compaction.range.del.drop.file.bytes"},
+    {HEDGED_READS, "rocksdb.hedged.reads"},
+    {HEDGED_READ_WINS, "rocksdb.hedged.read.wins"},
+    {HEDGED_READ_CANCELLED, "rocksdb.hedged.read.cancelled"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -247,14 +282,41 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
      "rocksdb.num.index.and.filter.blocks.read.per.level"},
     {NUM_DATA_BLOCKS_READ_PER_LEVEL, "rocksdb.num.data.blocks.read.per.level"},
     {NUM_SST_READ_PER_LEVEL, "rocksdb.num.sst.read.per.level"},
+    {ZENFS_ZONE_ALLOCATION_MICROS, "rocksdb.zenfs.zone.allocation.micros"},
+    {ZENFS_OPEN_ZONES, "rocksdb.zenfs.open.zones"},
+    {ZENFS_ACTIVE_ZONES, "rocksdb.zenfs.active.zones"},
+    {ZENFS_EXTENT_HOPS_PER_READ, "rocksdb.zenfs.extent.hops.per.read"},
+    {ZENFS_ZONE_ADMISSION_MICROS, "rocksdb.zenfs.zone.admission.micros"},
+    {ZENFS_FOREGROUND_READ_MICROS, "rocksdb.zenfs.foreground.read.micros"},
+    {ZENFS_COMPACTION_READ_MICROS, "rocksdb.zenfs.compaction.read.micros"},
+    {ZENFS_GC_IO_MICROS, "rocksdb.zenfs.gc.io.micros"},
+    {HIGH_PRI_POOL_QUEUEING_MICROS, "rocksdb.high.pri.pool.queueing.micros"},
+    {LOW_PRI_POOL_QUEUEING_MICROS, "rocksdb.low.pri.pool.queueing.micros"},
+    {BOTTOM_PRI_POOL_QUEUEING_MICROS,
+     "rocksdb.bottom.pri.pool.queueing.micros"},
 };
 
 std::shared_ptr<Statistics> CreateDBStatistics() {
   return std::make_shared<StatisticsImpl>(nullptr);
 }
 
-StatisticsImpl::StatisticsImpl(std::shared_ptr<Statistics> stats)
-    : stats_(std::move(stats)) {}
+std::shared_ptr<Statistics> CreateDBStatisticsWithHdrHistograms(
+    int hdr_precision_bits) {
+  return std::make_shared<StatisticsImpl>(nullptr, hdr_precision_bits);
+}
+
+StatisticsImpl::StatisticsImpl(std::shared_ptr<Statistics> stats,
+                               int hdr_precision_bits)
+    : stats_(std::move(stats)), hdr_precision_bits_(hdr_precision_bits) {
+  if (hdr_precision_bits_ != 0) {
+    for (size_t core_idx = 0; core_idx < per_core_stats_.Size(); ++core_idx) {
+      for (uint32_t i = 0; i < INTERNAL_HISTOGRAM_ENUM_MAX; ++i) {
+        per_core_stats_.AccessAtCore(core_idx)->histograms_[i].UseHdrBuckets(
+            hdr_precision_bits_);
+      }
+    }
+  }
+}
 
 StatisticsImpl::~StatisticsImpl() {}
 
@@ -281,7 +343,8 @@ void StatisticsImpl::histogramData(uint32_t histogramType,
 std::unique_ptr<HistogramImpl> StatisticsImpl::getHistogramImplLocked(
     uint32_t histogramType) const {
   assert(histogramType < HISTOGRAM_ENUM_MAX);
-  std::unique_ptr<HistogramImpl> res_hist(new HistogramImpl());
+  std::unique_ptr<HistogramImpl> res_hist(
+      new HistogramImpl(hdr_precision_bits_));
   for (size_t core_idx = 0; core_idx < per_core_stats_.Size(); ++core_idx) {
     res_hist->Merge(
         per_core_stats_.AccessAtCore(core_idx)->histograms_[histogramType]);
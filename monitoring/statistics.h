@@ -42,7 +42,10 @@ enum HistogramsInternal : uint32_t {
 
 class StatisticsImpl : public Statistics {
  public:
-  StatisticsImpl(std::shared_ptr<Statistics> stats);
+  // Uses HDR-style histogram buckets of the precision if hdr_precision_bits
+  // is not 0, see HistogramStat::UseHdrBuckets()
+  StatisticsImpl(std::shared_ptr<Statistics> stats,
+                 int hdr_precision_bits = 0);
   virtual ~StatisticsImpl();
 
   virtual uint64_t getTickerCount(uint32_t ticker_type) const override;
@@ -71,6 +74,7 @@ class StatisticsImpl : public Statistics {
  private:
   // If non-nullptr, forwards updates to the object pointed to by `stats_`.
   std::shared_ptr<Statistics> stats_;
+  const int hdr_precision_bits_;
   // Synchronizes anything that operates across other cores' local data,
   // such that operations like Reset() can be performed atomically.
   mutable port::Mutex aggregate_lock_;
@@ -4,6 +4,8 @@
 //  (found in the LICENSE.Apache file in the root directory).
 //
 
+#include <cmath>
+
 #include "port/stack_trace.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
@@ -38,6 +40,22 @@ TEST_F(StatisticsTest, SanityHistograms) {
   }
 }
 
+TEST_F(StatisticsTest, HdrHistograms) {
+  std::shared_ptr<Statistics> stats = CreateDBStatisticsWithHdrHistograms(7);
+  for (uint64_t value = 1000000; value <= 2000000; value += 1000) {
+    stats->recordInHistogram(DB_GET, value);
+  }
+  HistogramData data;
+  stats->histogramData(DB_GET, &data);
+  ASSERT_EQ(1001, data.count);
+  ASSERT_LE(std::fabs(data.median - 1500000), 1500000 >> 7);
+  ASSERT_LE(std::fabs(data.percentile95 - 1950000), 1950000 >> 7);
+
+  ASSERT_OK(stats->Reset());
+  stats->histogramData(DB_GET, &data);
+  ASSERT_EQ(0, data.count);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
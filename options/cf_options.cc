@@ -154,6 +154,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct CompressionOptions, zstd_max_train_bytes),
           OptionType::kUInt32T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"shared_dict_retrain_bytes",
+         {offsetof(struct CompressionOptions, shared_dict_retrain_bytes),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"parallel_threads",
          {offsetof(struct CompressionOptions, parallel_threads),
           OptionType::kUInt32T, OptionVerificationType::kNormal,
@@ -176,6 +180,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct CompactionOptionsFIFO, allow_compaction),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"zone_time_bucket_seconds",
+         {offsetof(struct CompactionOptionsFIFO, zone_time_bucket_seconds),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
 };
 
 static std::unordered_map<std::string, OptionTypeInfo>
@@ -207,6 +215,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
           OptionTypeFlags::kMutable}},
         {"allow_trivial_move",
          {offsetof(class CompactionOptionsUniversal, allow_trivial_move),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"runs_per_tier",
+         {offsetof(class CompactionOptionsUniversal, runs_per_tier),
+          OptionType::kUInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"incremental",
+         {offsetof(class CompactionOptionsUniversal, incremental),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}}};
 
@@ -244,6 +260,20 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    hard_pending_compaction_bytes_limit),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"smooth_write_stall",
+         {offsetof(struct MutableCFOptions, smooth_write_stall),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"smooth_write_stall_target_l0_files",
+         {offsetof(struct MutableCFOptions,
+                   smooth_write_stall_target_l0_files),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"smooth_write_stall_target_pending_compaction_bytes",
+         {offsetof(struct MutableCFOptions,
+                   smooth_write_stall_target_pending_compaction_bytes),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"hard_rate_limit",
          {0, OptionType::kDouble, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -295,6 +325,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, max_successive_merges),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"preaggregate_merge_operands",
+         {offsetof(struct MutableCFOptions, preaggregate_merge_operands),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"memtable_huge_page_size",
          {offsetof(struct MutableCFOptions, memtable_huge_page_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
@@ -400,6 +434,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, min_blob_size),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"blob_file_starting_level",
+         {offsetof(struct MutableCFOptions, blob_file_starting_level),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"blob_file_size",
          {offsetof(struct MutableCFOptions, blob_file_size),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
@@ -408,10 +446,27 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, blob_compression_type),
           OptionType::kCompressionType, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"enable_blob_garbage_collection",
+         {offsetof(struct MutableCFOptions, enable_blob_garbage_collection),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"blob_garbage_collection_age_cutoff",
+         {offsetof(struct MutableCFOptions,
+                   blob_garbage_collection_age_cutoff),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"prepopulate_blob_cache",
+         {offsetof(struct MutableCFOptions, prepopulate_blob_cache),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"sample_for_compression",
          {offsetof(struct MutableCFOptions, sample_for_compression),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"max_flush_partitions",
+         {offsetof(struct MutableCFOptions, max_flush_partitions),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"bottommost_compression",
          {offsetof(struct MutableCFOptions, bottommost_compression),
           OptionType::kCompressionType, OptionVerificationType::kNormal,
@@ -489,6 +544,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offset_of(&ColumnFamilyOptions::optimize_filters_for_hits),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"zone_aware_compaction_window",
+         {offset_of(&ColumnFamilyOptions::zone_aware_compaction_window),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"force_consistency_checks",
          {offset_of(&ColumnFamilyOptions::force_consistency_checks),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -842,11 +901,14 @@ ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
           db_options.new_table_reader_for_compaction_inputs),
       num_levels(cf_options.num_levels),
       optimize_filters_for_hits(cf_options.optimize_filters_for_hits),
+      zone_aware_compaction_window(cf_options.zone_aware_compaction_window),
       force_consistency_checks(cf_options.force_consistency_checks),
       allow_ingest_behind(db_options.allow_ingest_behind),
       preserve_deletes(db_options.preserve_deletes),
       listeners(db_options.listeners),
       row_cache(db_options.row_cache),
+      row_cache_negative_entries(db_options.row_cache_negative_entries),
+      blob_cache(cf_options.blob_cache),
       memtable_insert_with_hint_prefix_extractor(
           cf_options.memtable_insert_with_hint_prefix_extractor.get()),
       cf_paths(cf_options.cf_paths),
@@ -896,6 +958,19 @@ size_t MaxFileSizeForL0MetaPin(const MutableCFOptions& cf_options) {
   return cf_options.write_buffer_size / 2 * 3;
 }
 
+int UniversalCompactionTrigger(const MutableCFOptions& cf_options) {
+  unsigned int runs_per_tier =
+      cf_options.compaction_options_universal.runs_per_tier;
+  if (runs_per_tier == 0) {
+    return cf_options.level0_file_num_compaction_trigger;
+  }
+  // A full tier plus the oldest sorted run
+  int tier_trigger =
+      static_cast<int>(std::min(std::max(runs_per_tier, 2U), 1U << 30)) + 1;
+  return std::min(cf_options.level0_file_num_compaction_trigger,
+                  tier_trigger);
+}
+
 void MutableCFOptions::RefreshDerivedOptions(int num_levels,
                                              CompactionStyle compaction_style) {
   max_file_size.resize(num_levels);
@@ -931,6 +1006,8 @@ void MutableCFOptions::Dump(Logger* log) const {
   ROCKS_LOG_INFO(log,
                  "                    max_successive_merges: %" ROCKSDB_PRIszt,
                  max_successive_merges);
+  ROCKS_LOG_INFO(log, "              preaggregate_merge_operands: %d",
+                 preaggregate_merge_operands);
   ROCKS_LOG_INFO(log,
                  "                 inplace_update_num_locks: %" ROCKSDB_PRIszt,
                  inplace_update_num_locks);
@@ -943,6 +1020,13 @@ void MutableCFOptions::Dump(Logger* log) const {
                  soft_pending_compaction_bytes_limit);
   ROCKS_LOG_INFO(log, "      hard_pending_compaction_bytes_limit: %" PRIu64,
                  hard_pending_compaction_bytes_limit);
+  ROCKS_LOG_INFO(log, "                       smooth_write_stall: %d",
+                 smooth_write_stall);
+  ROCKS_LOG_INFO(log, "       smooth_write_stall_target_l0_files: %d",
+                 smooth_write_stall_target_l0_files);
+  ROCKS_LOG_INFO(log,
+                 "smooth_write_stall_target_pending_compaction_bytes: %" PRIu64,
+                 smooth_write_stall_target_pending_compaction_bytes);
   ROCKS_LOG_INFO(log, "       level0_file_num_compaction_trigger: %d",
                  level0_file_num_compaction_trigger);
   ROCKS_LOG_INFO(log, "           level0_slowdown_writes_trigger: %d",
@@ -987,6 +1071,8 @@ void MutableCFOptions::Dump(Logger* log) const {
                  report_bg_io_stats);
   ROCKS_LOG_INFO(log, "                              compression: %d",
                  static_cast<int>(compression));
+  ROCKS_LOG_INFO(log, "                     max_flush_partitions: %" PRIu32,
+                 max_flush_partitions);
 
   // Universal Compaction Options
   ROCKS_LOG_INFO(log, "compaction_options_universal.size_ratio : %d",
@@ -1006,22 +1092,37 @@ void MutableCFOptions::Dump(Logger* log) const {
   ROCKS_LOG_INFO(
       log, "compaction_options_universal.allow_trivial_move : %d",
       static_cast<int>(compaction_options_universal.allow_trivial_move));
+  ROCKS_LOG_INFO(log, "compaction_options_universal.runs_per_tier : %u",
+                 compaction_options_universal.runs_per_tier);
+  ROCKS_LOG_INFO(log, "compaction_options_universal.incremental : %d",
+                 static_cast<int>(compaction_options_universal.incremental));
 
   // FIFO Compaction Options
   ROCKS_LOG_INFO(log, "compaction_options_fifo.max_table_files_size : %" PRIu64,
                  compaction_options_fifo.max_table_files_size);
   ROCKS_LOG_INFO(log, "compaction_options_fifo.allow_compaction : %d",
                  compaction_options_fifo.allow_compaction);
+  ROCKS_LOG_INFO(log,
+                 "compaction_options_fifo.zone_time_bucket_seconds : %" PRIu64,
+                 compaction_options_fifo.zone_time_bucket_seconds);
 
   // Blob file related options
   ROCKS_LOG_INFO(log, "                        enable_blob_files: %s",
                  enable_blob_files ? "true" : "false");
   ROCKS_LOG_INFO(log, "                            min_blob_size: %" PRIu64,
                  min_blob_size);
+  ROCKS_LOG_INFO(log, "                 blob_file_starting_level: %d",
+                 blob_file_starting_level);
   ROCKS_LOG_INFO(log, "                           blob_file_size: %" PRIu64,
                  blob_file_size);
   ROCKS_LOG_INFO(log, "                    blob_compression_type: %s",
                  CompressionTypeToString(blob_compression_type).c_str());
+  ROCKS_LOG_INFO(log, "           enable_blob_garbage_collection: %s",
+                 enable_blob_garbage_collection ? "true" : "false");
+  ROCKS_LOG_INFO(log, "       blob_garbage_collection_age_cutoff: %f",
+                 blob_garbage_collection_age_cutoff);
+  ROCKS_LOG_INFO(log, "                   prepopulate_blob_cache: %s",
+                 prepopulate_blob_cache ? "true" : "false");
 }
 
 MutableCFOptions::MutableCFOptions(const Options& options)
@@ -101,6 +101,8 @@ struct ImmutableCFOptions {
 
   bool optimize_filters_for_hits;
 
+  size_t zone_aware_compaction_window;
+
   bool force_consistency_checks;
 
   bool allow_ingest_behind;
@@ -113,6 +115,10 @@ struct ImmutableCFOptions {
 
   std::shared_ptr<Cache> row_cache;
 
+  bool row_cache_negative_entries;
+
+  std::shared_ptr<Cache> blob_cache;
+
   const SliceTransform* memtable_insert_with_hint_prefix_extractor;
 
   std::vector<DbPath> cf_paths;
@@ -139,6 +145,7 @@ struct MutableCFOptions {
         memtable_whole_key_filtering(options.memtable_whole_key_filtering),
         memtable_huge_page_size(options.memtable_huge_page_size),
         max_successive_merges(options.max_successive_merges),
+        preaggregate_merge_operands(options.preaggregate_merge_operands),
         inplace_update_num_locks(options.inplace_update_num_locks),
         prefix_extractor(options.prefix_extractor),
         disable_auto_compactions(options.disable_auto_compactions),
@@ -146,6 +153,11 @@ struct MutableCFOptions {
             options.soft_pending_compaction_bytes_limit),
         hard_pending_compaction_bytes_limit(
             options.hard_pending_compaction_bytes_limit),
+        smooth_write_stall(options.smooth_write_stall),
+        smooth_write_stall_target_l0_files(
+            options.smooth_write_stall_target_l0_files),
+        smooth_write_stall_target_pending_compaction_bytes(
+            options.smooth_write_stall_target_pending_compaction_bytes),
         level0_file_num_compaction_trigger(
             options.level0_file_num_compaction_trigger),
         level0_slowdown_writes_trigger(options.level0_slowdown_writes_trigger),
@@ -163,8 +175,13 @@ struct MutableCFOptions {
         compaction_options_universal(options.compaction_options_universal),
         enable_blob_files(options.enable_blob_files),
         min_blob_size(options.min_blob_size),
+        blob_file_starting_level(options.blob_file_starting_level),
         blob_file_size(options.blob_file_size),
         blob_compression_type(options.blob_compression_type),
+        enable_blob_garbage_collection(options.enable_blob_garbage_collection),
+        blob_garbage_collection_age_cutoff(
+            options.blob_garbage_collection_age_cutoff),
+        prepopulate_blob_cache(options.prepopulate_blob_cache),
         max_sequential_skip_in_iterations(
             options.max_sequential_skip_in_iterations),
         check_flush_compaction_key_order(
@@ -176,7 +193,8 @@ struct MutableCFOptions {
         compression_opts(options.compression_opts),
         bottommost_compression_opts(options.bottommost_compression_opts),
         sample_for_compression(
-            options.sample_for_compression) {  // TODO: is 0 fine here?
+            options.sample_for_compression),  // TODO: is 0 fine here?
+        max_flush_partitions(options.max_flush_partitions) {
     RefreshDerivedOptions(options.num_levels, options.compaction_style);
   }
 
@@ -188,11 +206,15 @@ struct MutableCFOptions {
         memtable_whole_key_filtering(false),
         memtable_huge_page_size(0),
         max_successive_merges(0),
+        preaggregate_merge_operands(false),
         inplace_update_num_locks(0),
         prefix_extractor(nullptr),
         disable_auto_compactions(false),
         soft_pending_compaction_bytes_limit(0),
         hard_pending_compaction_bytes_limit(0),
+        smooth_write_stall(false),
+        smooth_write_stall_target_l0_files(0),
+        smooth_write_stall_target_pending_compaction_bytes(0),
         level0_file_num_compaction_trigger(0),
         level0_slowdown_writes_trigger(0),
         level0_stop_writes_trigger(0),
@@ -206,15 +228,20 @@ struct MutableCFOptions {
         compaction_options_fifo(),
         enable_blob_files(false),
         min_blob_size(0),
+        blob_file_starting_level(0),
         blob_file_size(0),
         blob_compression_type(kNoCompression),
+        enable_blob_garbage_collection(false),
+        blob_garbage_collection_age_cutoff(0.0),
+        prepopulate_blob_cache(false),
         max_sequential_skip_in_iterations(0),
         check_flush_compaction_key_order(true),
         paranoid_file_checks(false),
         report_bg_io_stats(false),
         compression(Snappy_Supported() ? kSnappyCompression : kNoCompression),
         bottommost_compression(kDisableCompressionOption),
-        sample_for_compression(0) {}
+        sample_for_compression(0),
+        max_flush_partitions(1) {}
 
   explicit MutableCFOptions(const Options& options);
 
@@ -243,6 +270,7 @@ struct MutableCFOptions {
   bool memtable_whole_key_filtering;
   size_t memtable_huge_page_size;
   size_t max_successive_merges;
+  bool preaggregate_merge_operands;
   size_t inplace_update_num_locks;
   std::shared_ptr<const SliceTransform> prefix_extractor;
 
@@ -250,6 +278,9 @@ struct MutableCFOptions {
   bool disable_auto_compactions;
   uint64_t soft_pending_compaction_bytes_limit;
   uint64_t hard_pending_compaction_bytes_limit;
+  bool smooth_write_stall;
+  int smooth_write_stall_target_l0_files;
+  uint64_t smooth_write_stall_target_pending_compaction_bytes;
   int level0_file_num_compaction_trigger;
   int level0_slowdown_writes_trigger;
   int level0_stop_writes_trigger;
@@ -267,8 +298,12 @@ struct MutableCFOptions {
   // Blob file related options
   bool enable_blob_files;
   uint64_t min_blob_size;
+  int blob_file_starting_level;
   uint64_t blob_file_size;
   CompressionType blob_compression_type;
+  bool enable_blob_garbage_collection;
+  double blob_garbage_collection_age_cutoff;
+  bool prepopulate_blob_cache;
 
   // Misc options
   uint64_t max_sequential_skip_in_iterations;
@@ -281,6 +316,7 @@ struct MutableCFOptions {
   CompressionOptions bottommost_compression_opts;
 
   uint64_t sample_for_compression;
+  uint32_t max_flush_partitions;
 
   // Derived options
   // Per-level target file size.
@@ -298,4 +334,9 @@ uint64_t MaxFileSizeForLevel(const MutableCFOptions& cf_options,
 // `pin_l0_filter_and_index_blocks_in_cache` is set.
 size_t MaxFileSizeForL0MetaPin(const MutableCFOptions& cf_options);
 
+// Get the number of sorted runs at which universal compaction looks for work.
+// With lazy leveling, a tier may fill up before
+// `level0_file_num_compaction_trigger` is reached.
+int UniversalCompactionTrigger(const MutableCFOptions& cf_options);
+
 }  // namespace ROCKSDB_NAMESPACE
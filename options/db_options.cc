@@ -19,6 +19,7 @@
 #include "rocksdb/sst_file_manager.h"
 #include "rocksdb/utilities/options_type.h"
 #include "rocksdb/wal_filter.h"
+#include "util/compression.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -165,6 +166,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    use_direct_io_for_flush_and_compaction),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"async_table_file_flush",
+         {offsetof(struct ImmutableDBOptions, async_table_file_flush),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"allow_2pc",
          {offsetof(struct ImmutableDBOptions, allow_2pc), OptionType::kBoolean,
           OptionVerificationType::kNormal, OptionTypeFlags::kNone}},
@@ -235,6 +240,37 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, max_file_opening_threads),
           OptionType::kInt, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"lazy_open_table_files",
+         {offsetof(struct ImmutableDBOptions, lazy_open_table_files),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"max_table_metadata_checkpoint_size",
+         {offsetof(struct ImmutableDBOptions,
+                   max_table_metadata_checkpoint_size),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"block_cache_warmup_save_period_sec",
+         {offsetof(struct ImmutableDBOptions,
+                   block_cache_warmup_save_period_sec),
+          OptionType::kUInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"max_block_cache_warmup_size",
+         {offsetof(struct ImmutableDBOptions, max_block_cache_warmup_size),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"options_advisor_period_sec",
+         {offsetof(struct ImmutableDBOptions, options_advisor_period_sec),
+          OptionType::kUInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"options_advisor_apply_changes",
+         {offsetof(struct ImmutableDBOptions, options_advisor_apply_changes),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"options_advisor_max_change_factor",
+         {offsetof(struct ImmutableDBOptions,
+                   options_advisor_max_change_factor),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"table_cache_numshardbits",
          {offsetof(struct ImmutableDBOptions, table_cache_numshardbits),
           OptionType::kInt, OptionVerificationType::kNormal,
@@ -293,6 +329,13 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, enable_pipelined_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"wal_streams",
+         {offsetof(struct ImmutableDBOptions, wal_streams), OptionType::kSizeT,
+          OptionVerificationType::kNormal, OptionTypeFlags::kNone}},
+        {"max_async_write_threads",
+         {offsetof(struct ImmutableDBOptions, max_async_write_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"unordered_write",
          {offsetof(struct ImmutableDBOptions, unordered_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -354,6 +397,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, two_write_queues),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"wal_compression",
+         {offsetof(struct ImmutableDBOptions, wal_compression),
+          OptionType::kCompressionType, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"manual_wal_flush",
          {offsetof(struct ImmutableDBOptions, manual_wal_flush),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -369,6 +416,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, avoid_unnecessary_blocking_io),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"row_cache_negative_entries",
+         {offsetof(struct ImmutableDBOptions, row_cache_negative_entries),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"immutable_memtable_numa_node",
+         {offsetof(struct ImmutableDBOptions, immutable_memtable_numa_node),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"write_dbid_to_manifest",
          {offsetof(struct ImmutableDBOptions, write_dbid_to_manifest),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -377,6 +432,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, log_readahead_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"wal_recovery_threads",
+         {offsetof(struct ImmutableDBOptions, wal_recovery_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"best_efforts_recovery",
          {offsetof(struct ImmutableDBOptions, best_efforts_recovery),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -392,6 +451,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"db_host_id",
          {offsetof(struct ImmutableDBOptions, db_host_id), OptionType::kString,
           OptionVerificationType::kNormal, OptionTypeFlags::kCompareNever}},
+        {"enable_pipelined_compaction",
+         {offsetof(struct ImmutableDBOptions, enable_pipelined_compaction),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         // The following properties were handled as special cases in ParseOption
         // This means that the properties could be read from the options file
         // but never written to the file or compared to each other.
@@ -514,6 +577,16 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       info_log(options.info_log),
       info_log_level(options.info_log_level),
       max_file_opening_threads(options.max_file_opening_threads),
+      lazy_open_table_files(options.lazy_open_table_files),
+      max_table_metadata_checkpoint_size(
+          options.max_table_metadata_checkpoint_size),
+      block_cache_warmup_save_period_sec(
+          options.block_cache_warmup_save_period_sec),
+      max_block_cache_warmup_size(options.max_block_cache_warmup_size),
+      options_advisor_period_sec(options.options_advisor_period_sec),
+      options_advisor_apply_changes(options.options_advisor_apply_changes),
+      options_advisor_max_change_factor(
+          options.options_advisor_max_change_factor),
       statistics(options.statistics),
       use_fsync(options.use_fsync),
       db_paths(options.db_paths),
@@ -535,6 +608,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       use_direct_reads(options.use_direct_reads),
       use_direct_io_for_flush_and_compaction(
           options.use_direct_io_for_flush_and_compaction),
+      async_table_file_flush(options.async_table_file_flush),
       allow_fallocate(options.allow_fallocate),
       is_fd_close_on_exec(options.is_fd_close_on_exec),
       advise_random_on_open(options.advise_random_on_open),
@@ -548,6 +622,8 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       listeners(options.listeners),
       enable_thread_tracking(options.enable_thread_tracking),
       enable_pipelined_write(options.enable_pipelined_write),
+      wal_streams(options.wal_streams),
+      max_async_write_threads(options.max_async_write_threads),
       unordered_write(options.unordered_write),
       allow_concurrent_memtable_write(options.allow_concurrent_memtable_write),
       enable_write_thread_adaptive_yield(
@@ -560,6 +636,8 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       wal_recovery_mode(options.wal_recovery_mode),
       allow_2pc(options.allow_2pc),
       row_cache(options.row_cache),
+      row_cache_negative_entries(options.row_cache_negative_entries),
+      immutable_memtable_numa_node(options.immutable_memtable_numa_node),
 #ifndef ROCKSDB_LITE
       wal_filter(options.wal_filter),
 #endif  // ROCKSDB_LITE
@@ -570,17 +648,22 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       preserve_deletes(options.preserve_deletes),
       two_write_queues(options.two_write_queues),
       manual_wal_flush(options.manual_wal_flush),
+      wal_compression(options.wal_compression),
       atomic_flush(options.atomic_flush),
       avoid_unnecessary_blocking_io(options.avoid_unnecessary_blocking_io),
       persist_stats_to_disk(options.persist_stats_to_disk),
       write_dbid_to_manifest(options.write_dbid_to_manifest),
       log_readahead_size(options.log_readahead_size),
+      wal_recovery_threads(options.wal_recovery_threads),
       file_checksum_gen_factory(options.file_checksum_gen_factory),
       best_efforts_recovery(options.best_efforts_recovery),
       max_bgerror_resume_count(options.max_bgerror_resume_count),
       bgerror_resume_retry_interval(options.bgerror_resume_retry_interval),
       allow_data_in_errors(options.allow_data_in_errors),
-      db_host_id(options.db_host_id) {
+      db_host_id(options.db_host_id),
+      compaction_service(options.compaction_service),
+      enable_pipelined_compaction(options.enable_pipelined_compaction),
+      span_tracer(options.span_tracer) {
 }
 
 void ImmutableDBOptions::Dump(Logger* log) const {
@@ -602,6 +685,22 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    info_log.get());
   ROCKS_LOG_HEADER(log, "               Options.max_file_opening_threads: %d",
                    max_file_opening_threads);
+  ROCKS_LOG_HEADER(log, "                  Options.lazy_open_table_files: %d",
+                   lazy_open_table_files);
+  ROCKS_LOG_HEADER(log,
+                   "     Options.max_table_metadata_checkpoint_size: %" PRIu64,
+                   max_table_metadata_checkpoint_size);
+  ROCKS_LOG_HEADER(log, "     Options.block_cache_warmup_save_period_sec: %u",
+                   block_cache_warmup_save_period_sec);
+  ROCKS_LOG_HEADER(log,
+                   "            Options.max_block_cache_warmup_size: %" PRIu64,
+                   max_block_cache_warmup_size);
+  ROCKS_LOG_HEADER(log, "             Options.options_advisor_period_sec: %u",
+                   options_advisor_period_sec);
+  ROCKS_LOG_HEADER(log, "          Options.options_advisor_apply_changes: %d",
+                   options_advisor_apply_changes);
+  ROCKS_LOG_HEADER(log, "      Options.options_advisor_max_change_factor: %f",
+                   options_advisor_max_change_factor);
   ROCKS_LOG_HEADER(log, "                             Options.statistics: %p",
                    statistics.get());
   ROCKS_LOG_HEADER(log, "                              Options.use_fsync: %d",
@@ -633,6 +732,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    "                       "
                    "Options.use_direct_io_for_flush_and_compaction: %d",
                    use_direct_io_for_flush_and_compaction);
+  ROCKS_LOG_HEADER(log, "                 Options.async_table_file_flush: %d",
+                   async_table_file_flush);
   ROCKS_LOG_HEADER(log, "         Options.create_missing_column_families: %d",
                    create_missing_column_families);
   ROCKS_LOG_HEADER(log, "                             Options.db_log_dir: %s",
@@ -683,6 +784,11 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    enable_thread_tracking);
   ROCKS_LOG_HEADER(log, "                 Options.enable_pipelined_write: %d",
                    enable_pipelined_write);
+  ROCKS_LOG_HEADER(
+      log, "                            Options.wal_streams: %" ROCKSDB_PRIszt,
+      wal_streams);
+  ROCKS_LOG_HEADER(log, "                Options.max_async_write_threads: %d",
+                   max_async_write_threads);
   ROCKS_LOG_HEADER(log, "                 Options.unordered_write: %d",
                    unordered_write);
   ROCKS_LOG_HEADER(log, "        Options.allow_concurrent_memtable_write: %d",
@@ -704,6 +810,10 @@ void ImmutableDBOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "                              Options.row_cache: None");
   }
+  ROCKS_LOG_HEADER(log, "             Options.row_cache_negative_entries: %d",
+                   row_cache_negative_entries);
+  ROCKS_LOG_HEADER(log, "           Options.immutable_memtable_numa_node: %d",
+                   immutable_memtable_numa_node);
 #ifndef ROCKSDB_LITE
   ROCKS_LOG_HEADER(log, "                             Options.wal_filter: %s",
                    wal_filter ? wal_filter->Name() : "None");
@@ -719,6 +829,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    two_write_queues);
   ROCKS_LOG_HEADER(log, "            Options.manual_wal_flush: %d",
                    manual_wal_flush);
+  ROCKS_LOG_HEADER(log, "             Options.wal_compression: %s",
+                   CompressionTypeToString(wal_compression).c_str());
   ROCKS_LOG_HEADER(log, "            Options.atomic_flush: %d", atomic_flush);
   ROCKS_LOG_HEADER(log,
                    "            Options.avoid_unnecessary_blocking_io: %d",
@@ -730,6 +842,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(
       log, "                Options.log_readahead_size: %" ROCKSDB_PRIszt,
       log_readahead_size);
+  ROCKS_LOG_HEADER(log, "                Options.wal_recovery_threads: %d",
+                   wal_recovery_threads);
   ROCKS_LOG_HEADER(log, "                Options.file_checksum_gen_factory: %s",
                    file_checksum_gen_factory ? file_checksum_gen_factory->Name()
                                              : kUnknownFileChecksumFuncName);
@@ -744,6 +858,12 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    allow_data_in_errors);
   ROCKS_LOG_HEADER(log, "            Options.db_host_id: %s",
                    db_host_id.c_str());
+  ROCKS_LOG_HEADER(log, "            Options.compaction_service: %s",
+                   compaction_service ? compaction_service->Name() : "None");
+  ROCKS_LOG_HEADER(log, "            Options.enable_pipelined_compaction: %d",
+                   enable_pipelined_compaction);
+  ROCKS_LOG_HEADER(log, "            Options.span_tracer: %p",
+                   span_tracer.get());
 }
 
 MutableDBOptions::MutableDBOptions()
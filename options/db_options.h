@@ -31,6 +31,13 @@ struct ImmutableDBOptions {
   std::shared_ptr<Logger> info_log;
   InfoLogLevel info_log_level;
   int max_file_opening_threads;
+  bool lazy_open_table_files;
+  uint64_t max_table_metadata_checkpoint_size;
+  unsigned int block_cache_warmup_save_period_sec;
+  uint64_t max_block_cache_warmup_size;
+  unsigned int options_advisor_period_sec;
+  bool options_advisor_apply_changes;
+  double options_advisor_max_change_factor;
   std::shared_ptr<Statistics> statistics;
   bool use_fsync;
   std::vector<DbPath> db_paths;
@@ -50,6 +57,7 @@ struct ImmutableDBOptions {
   bool allow_mmap_writes;
   bool use_direct_reads;
   bool use_direct_io_for_flush_and_compaction;
+  bool async_table_file_flush;
   bool allow_fallocate;
   bool is_fd_close_on_exec;
   bool advise_random_on_open;
@@ -62,6 +70,8 @@ struct ImmutableDBOptions {
   std::vector<std::shared_ptr<EventListener>> listeners;
   bool enable_thread_tracking;
   bool enable_pipelined_write;
+  size_t wal_streams;
+  int max_async_write_threads;
   bool unordered_write;
   bool allow_concurrent_memtable_write;
   bool enable_write_thread_adaptive_yield;
@@ -72,6 +82,8 @@ struct ImmutableDBOptions {
   WALRecoveryMode wal_recovery_mode;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
+  bool row_cache_negative_entries;
+  int immutable_memtable_numa_node;
 #ifndef ROCKSDB_LITE
   WalFilter* wal_filter;
 #endif  // ROCKSDB_LITE
@@ -82,17 +94,22 @@ struct ImmutableDBOptions {
   bool preserve_deletes;
   bool two_write_queues;
   bool manual_wal_flush;
+  CompressionType wal_compression;
   bool atomic_flush;
   bool avoid_unnecessary_blocking_io;
   bool persist_stats_to_disk;
   bool write_dbid_to_manifest;
   size_t log_readahead_size;
+  int wal_recovery_threads;
   std::shared_ptr<FileChecksumGenFactory> file_checksum_gen_factory;
   bool best_efforts_recovery;
   int max_bgerror_resume_count;
   uint64_t bgerror_resume_retry_interval;
   bool allow_data_in_errors;
   std::string db_host_id;
+  std::shared_ptr<CompactionService> compaction_service;
+  bool enable_pipelined_compaction;
+  std::shared_ptr<SpanTracer> span_tracer;
 };
 
 struct MutableDBOptions {
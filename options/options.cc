@@ -72,6 +72,11 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
           options.soft_pending_compaction_bytes_limit),
       hard_pending_compaction_bytes_limit(
           options.hard_pending_compaction_bytes_limit),
+      smooth_write_stall(options.smooth_write_stall),
+      smooth_write_stall_target_l0_files(
+          options.smooth_write_stall_target_l0_files),
+      smooth_write_stall_target_pending_compaction_bytes(
+          options.smooth_write_stall_target_pending_compaction_bytes),
       compaction_style(options.compaction_style),
       compaction_pri(options.compaction_pri),
       compaction_options_universal(options.compaction_options_universal),
@@ -82,17 +87,26 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       table_properties_collector_factories(
           options.table_properties_collector_factories),
       max_successive_merges(options.max_successive_merges),
+      preaggregate_merge_operands(options.preaggregate_merge_operands),
       optimize_filters_for_hits(options.optimize_filters_for_hits),
+      zone_aware_compaction_window(options.zone_aware_compaction_window),
       paranoid_file_checks(options.paranoid_file_checks),
       force_consistency_checks(options.force_consistency_checks),
       report_bg_io_stats(options.report_bg_io_stats),
       ttl(options.ttl),
       periodic_compaction_seconds(options.periodic_compaction_seconds),
       sample_for_compression(options.sample_for_compression),
+      max_flush_partitions(options.max_flush_partitions),
       enable_blob_files(options.enable_blob_files),
       min_blob_size(options.min_blob_size),
+      blob_file_starting_level(options.blob_file_starting_level),
       blob_file_size(options.blob_file_size),
-      blob_compression_type(options.blob_compression_type) {
+      blob_compression_type(options.blob_compression_type),
+      enable_blob_garbage_collection(options.enable_blob_garbage_collection),
+      blob_garbage_collection_age_cutoff(
+          options.blob_garbage_collection_age_cutoff),
+      blob_cache(options.blob_cache),
+      prepopulate_blob_cache(options.prepopulate_blob_cache) {
   assert(memtable_factory.get() != nullptr);
   if (max_bytes_for_level_multiplier_additional.size() <
       static_cast<unsigned int>(num_levels)) {
@@ -190,6 +204,11 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
         "        Options.bottommost_compression_opts.zstd_max_train_bytes: "
         "%" PRIu32,
         bottommost_compression_opts.zstd_max_train_bytes);
+    ROCKS_LOG_HEADER(
+        log,
+        "   Options.bottommost_compression_opts.shared_dict_retrain_bytes: "
+        "%" PRIu64,
+        bottommost_compression_opts.shared_dict_retrain_bytes);
     ROCKS_LOG_HEADER(
         log,
         "        Options.bottommost_compression_opts.parallel_threads: "
@@ -212,6 +231,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      "        Options.compression_opts.zstd_max_train_bytes: "
                      "%" PRIu32,
                      compression_opts.zstd_max_train_bytes);
+    ROCKS_LOG_HEADER(log,
+                     "   Options.compression_opts.shared_dict_retrain_bytes: "
+                     "%" PRIu64,
+                     compression_opts.shared_dict_retrain_bytes);
     ROCKS_LOG_HEADER(log,
                      "        Options.compression_opts.parallel_threads: "
                      "%" PRIu32,
@@ -260,6 +283,14 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "  Options.hard_pending_compaction_bytes_limit: %" PRIu64,
                      hard_pending_compaction_bytes_limit);
+    ROCKS_LOG_HEADER(log, "                   Options.smooth_write_stall: %d",
+                     smooth_write_stall);
+    ROCKS_LOG_HEADER(log, "   Options.smooth_write_stall_target_l0_files: %d",
+                     smooth_write_stall_target_l0_files);
+    ROCKS_LOG_HEADER(
+        log,
+        "  Options.smooth_write_stall_target_pending_compaction_bytes: %" PRIu64,
+        smooth_write_stall_target_pending_compaction_bytes);
     ROCKS_LOG_HEADER(log, "      Options.rate_limit_delay_max_milliseconds: %u",
                      rate_limit_delay_max_milliseconds);
     ROCKS_LOG_HEADER(log, "               Options.disable_auto_compactions: %d",
@@ -321,12 +352,22 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "Options.compaction_options_universal.stop_style: %s",
                      str_compaction_stop_style.c_str());
+    ROCKS_LOG_HEADER(log,
+                     "Options.compaction_options_universal.runs_per_tier: %u",
+                     compaction_options_universal.runs_per_tier);
+    ROCKS_LOG_HEADER(log,
+                     "Options.compaction_options_universal.incremental: %d",
+                     compaction_options_universal.incremental);
     ROCKS_LOG_HEADER(
         log, "Options.compaction_options_fifo.max_table_files_size: %" PRIu64,
         compaction_options_fifo.max_table_files_size);
     ROCKS_LOG_HEADER(log,
                      "Options.compaction_options_fifo.allow_compaction: %d",
                      compaction_options_fifo.allow_compaction);
+    ROCKS_LOG_HEADER(
+        log,
+        "Options.compaction_options_fifo.zone_time_bucket_seconds: %" PRIu64,
+        compaction_options_fifo.zone_time_bucket_seconds);
     std::ostringstream collector_info;
     for (const auto& collector_factory : table_properties_collector_factories) {
       collector_info << collector_factory->ToString() << ';';
@@ -359,9 +400,16 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
         log,
         "                   Options.max_successive_merges: %" ROCKSDB_PRIszt,
         max_successive_merges);
+    ROCKS_LOG_HEADER(log,
+                     "             Options.preaggregate_merge_operands: %d",
+                     preaggregate_merge_operands);
     ROCKS_LOG_HEADER(log,
                      "               Options.optimize_filters_for_hits: %d",
                      optimize_filters_for_hits);
+    ROCKS_LOG_HEADER(
+        log,
+        "            Options.zone_aware_compaction_window: %" ROCKSDB_PRIszt,
+        zone_aware_compaction_window);
     ROCKS_LOG_HEADER(log, "               Options.paranoid_file_checks: %d",
                      paranoid_file_checks);
     ROCKS_LOG_HEADER(log, "               Options.force_consistency_checks: %d",
@@ -373,16 +421,35 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "         Options.periodic_compaction_seconds: %" PRIu64,
                      periodic_compaction_seconds);
+    ROCKS_LOG_HEADER(log,
+                     "                Options.max_flush_partitions: %" PRIu32,
+                     max_flush_partitions);
     ROCKS_LOG_HEADER(log, "                   Options.enable_blob_files: %s",
                      enable_blob_files ? "true" : "false");
     ROCKS_LOG_HEADER(log,
                      "                       Options.min_blob_size: %" PRIu64,
                      min_blob_size);
+    ROCKS_LOG_HEADER(log, "            Options.blob_file_starting_level: %d",
+                     blob_file_starting_level);
     ROCKS_LOG_HEADER(log,
                      "                      Options.blob_file_size: %" PRIu64,
                      blob_file_size);
     ROCKS_LOG_HEADER(log, "               Options.blob_compression_type: %s",
                      CompressionTypeToString(blob_compression_type).c_str());
+    ROCKS_LOG_HEADER(log, "      Options.enable_blob_garbage_collection: %s",
+                     enable_blob_garbage_collection ? "true" : "false");
+    ROCKS_LOG_HEADER(log, "  Options.blob_garbage_collection_age_cutoff: %f",
+                     blob_garbage_collection_age_cutoff);
+    if (blob_cache) {
+      ROCKS_LOG_HEADER(log,
+                       "                          Options.blob_cache: %s, "
+                       "capacity %" ROCKSDB_PRIszt,
+                       blob_cache->Name(), blob_cache->GetCapacity());
+    } else {
+      ROCKS_LOG_HEADER(log, "                          Options.blob_cache: None");
+    }
+    ROCKS_LOG_HEADER(log, "              Options.prepopulate_blob_cache: %s",
+                     prepopulate_blob_cache ? "true" : "false");
 }  // ColumnFamilyOptions::Dump
 
 void Options::Dump(Logger* log) const {
@@ -628,7 +695,12 @@ ReadOptions::ReadOptions()
       iter_start_ts(nullptr),
       deadline(std::chrono::microseconds::zero()),
       io_timeout(std::chrono::microseconds::zero()),
-      value_size_soft_limit(std::numeric_limits<uint64_t>::max()) {}
+      value_size_soft_limit(std::numeric_limits<uint64_t>::max()),
+      async_io(false),
+      optimize_multiget_for_io(false),
+      trace_id(0),
+      recycle_arena_blocks(false),
+      recycle_iterator(false) {}
 
 ReadOptions::ReadOptions(bool cksum, bool cache)
     : snapshot(nullptr),
@@ -652,6 +724,11 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       iter_start_ts(nullptr),
       deadline(std::chrono::microseconds::zero()),
       io_timeout(std::chrono::microseconds::zero()),
-      value_size_soft_limit(std::numeric_limits<uint64_t>::max()) {}
+      value_size_soft_limit(std::numeric_limits<uint64_t>::max()),
+      async_io(false),
+      optimize_multiget_for_io(false),
+      trace_id(0),
+      recycle_arena_blocks(false),
+      recycle_iterator(false) {}
 
 }  // namespace ROCKSDB_NAMESPACE
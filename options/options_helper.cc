@@ -61,6 +61,19 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.max_open_files = mutable_db_options.max_open_files;
   options.max_file_opening_threads =
       immutable_db_options.max_file_opening_threads;
+  options.lazy_open_table_files = immutable_db_options.lazy_open_table_files;
+  options.max_table_metadata_checkpoint_size =
+      immutable_db_options.max_table_metadata_checkpoint_size;
+  options.block_cache_warmup_save_period_sec =
+      immutable_db_options.block_cache_warmup_save_period_sec;
+  options.max_block_cache_warmup_size =
+      immutable_db_options.max_block_cache_warmup_size;
+  options.options_advisor_period_sec =
+      immutable_db_options.options_advisor_period_sec;
+  options.options_advisor_apply_changes =
+      immutable_db_options.options_advisor_apply_changes;
+  options.options_advisor_max_change_factor =
+      immutable_db_options.options_advisor_max_change_factor;
   options.max_total_wal_size = mutable_db_options.max_total_wal_size;
   options.statistics = immutable_db_options.statistics;
   options.use_fsync = immutable_db_options.use_fsync;
@@ -95,6 +108,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.use_direct_reads = immutable_db_options.use_direct_reads;
   options.use_direct_io_for_flush_and_compaction =
       immutable_db_options.use_direct_io_for_flush_and_compaction;
+  options.async_table_file_flush = immutable_db_options.async_table_file_flush;
   options.allow_fallocate = immutable_db_options.allow_fallocate;
   options.is_fd_close_on_exec = immutable_db_options.is_fd_close_on_exec;
   options.stats_dump_period_sec = mutable_db_options.stats_dump_period_sec;
@@ -121,6 +135,9 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.enable_thread_tracking = immutable_db_options.enable_thread_tracking;
   options.delayed_write_rate = mutable_db_options.delayed_write_rate;
   options.enable_pipelined_write = immutable_db_options.enable_pipelined_write;
+  options.wal_streams = immutable_db_options.wal_streams;
+  options.max_async_write_threads =
+      immutable_db_options.max_async_write_threads;
   options.unordered_write = immutable_db_options.unordered_write;
   options.allow_concurrent_memtable_write =
       immutable_db_options.allow_concurrent_memtable_write;
@@ -139,6 +156,10 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
+  options.row_cache_negative_entries =
+      immutable_db_options.row_cache_negative_entries;
+  options.immutable_memtable_numa_node =
+      immutable_db_options.immutable_memtable_numa_node;
 #ifndef ROCKSDB_LITE
   options.wal_filter = immutable_db_options.wal_filter;
 #endif  // ROCKSDB_LITE
@@ -155,10 +176,12 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.preserve_deletes;
   options.two_write_queues = immutable_db_options.two_write_queues;
   options.manual_wal_flush = immutable_db_options.manual_wal_flush;
+  options.wal_compression = immutable_db_options.wal_compression;
   options.atomic_flush = immutable_db_options.atomic_flush;
   options.avoid_unnecessary_blocking_io =
       immutable_db_options.avoid_unnecessary_blocking_io;
   options.log_readahead_size = immutable_db_options.log_readahead_size;
+  options.wal_recovery_threads = immutable_db_options.wal_recovery_threads;
   options.file_checksum_gen_factory =
       immutable_db_options.file_checksum_gen_factory;
   options.best_efforts_recovery = immutable_db_options.best_efforts_recovery;
@@ -167,6 +190,10 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.bgerror_resume_retry_interval =
       immutable_db_options.bgerror_resume_retry_interval;
   options.db_host_id = immutable_db_options.db_host_id;
+  options.compaction_service = immutable_db_options.compaction_service;
+  options.enable_pipelined_compaction =
+      immutable_db_options.enable_pipelined_compaction;
+  options.span_tracer = immutable_db_options.span_tracer;
   return options;
 }
 
@@ -185,6 +212,8 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
       mutable_cf_options.memtable_whole_key_filtering;
   cf_opts.memtable_huge_page_size = mutable_cf_options.memtable_huge_page_size;
   cf_opts.max_successive_merges = mutable_cf_options.max_successive_merges;
+  cf_opts.preaggregate_merge_operands =
+      mutable_cf_options.preaggregate_merge_operands;
   cf_opts.inplace_update_num_locks =
       mutable_cf_options.inplace_update_num_locks;
   cf_opts.prefix_extractor = mutable_cf_options.prefix_extractor;
@@ -196,6 +225,11 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
       mutable_cf_options.soft_pending_compaction_bytes_limit;
   cf_opts.hard_pending_compaction_bytes_limit =
       mutable_cf_options.hard_pending_compaction_bytes_limit;
+  cf_opts.smooth_write_stall = mutable_cf_options.smooth_write_stall;
+  cf_opts.smooth_write_stall_target_l0_files =
+      mutable_cf_options.smooth_write_stall_target_l0_files;
+  cf_opts.smooth_write_stall_target_pending_compaction_bytes =
+      mutable_cf_options.smooth_write_stall_target_pending_compaction_bytes;
   cf_opts.level0_file_num_compaction_trigger =
       mutable_cf_options.level0_file_num_compaction_trigger;
   cf_opts.level0_slowdown_writes_trigger =
@@ -227,8 +261,15 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
   // Blob file related options
   cf_opts.enable_blob_files = mutable_cf_options.enable_blob_files;
   cf_opts.min_blob_size = mutable_cf_options.min_blob_size;
+  cf_opts.blob_file_starting_level =
+      mutable_cf_options.blob_file_starting_level;
   cf_opts.blob_file_size = mutable_cf_options.blob_file_size;
   cf_opts.blob_compression_type = mutable_cf_options.blob_compression_type;
+  cf_opts.enable_blob_garbage_collection =
+      mutable_cf_options.enable_blob_garbage_collection;
+  cf_opts.blob_garbage_collection_age_cutoff =
+      mutable_cf_options.blob_garbage_collection_age_cutoff;
+  cf_opts.prepopulate_blob_cache = mutable_cf_options.prepopulate_blob_cache;
 
   // Misc options
   cf_opts.max_sequential_skip_in_iterations =
@@ -243,6 +284,7 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
   cf_opts.bottommost_compression_opts =
       mutable_cf_options.bottommost_compression_opts;
   cf_opts.sample_for_compression = mutable_cf_options.sample_for_compression;
+  cf_opts.max_flush_partitions = mutable_cf_options.max_flush_partitions;
 
   cf_opts.table_factory = options.table_factory;
   // TODO(yhchiang): find some way to handle the following derived options
@@ -262,7 +304,8 @@ std::map<CompactionPri, std::string> OptionsHelper::compaction_pri_to_string = {
     {kByCompensatedSize, "kByCompensatedSize"},
     {kOldestLargestSeqFirst, "kOldestLargestSeqFirst"},
     {kOldestSmallestSeqFirst, "kOldestSmallestSeqFirst"},
-    {kMinOverlappingRatio, "kMinOverlappingRatio"}};
+    {kMinOverlappingRatio, "kMinOverlappingRatio"},
+    {kByReadHotness, "kByReadHotness"}};
 
 std::map<CompactionStopStyle, std::string>
     OptionsHelper::compaction_stop_style_to_string = {
@@ -273,7 +316,8 @@ std::unordered_map<std::string, ChecksumType>
     OptionsHelper::checksum_type_string_map = {{"kNoChecksum", kNoChecksum},
                                                {"kCRC32c", kCRC32c},
                                                {"kxxHash", kxxHash},
-                                               {"kxxHash64", kxxHash64}};
+                                               {"kxxHash64", kxxHash64},
+                                               {"kXXH3", kXXH3}};
 
 std::unordered_map<std::string, CompressionType>
     OptionsHelper::compression_type_string_map = {
@@ -880,7 +924,8 @@ std::unordered_map<std::string, CompactionPri>
         {"kByCompensatedSize", kByCompensatedSize},
         {"kOldestLargestSeqFirst", kOldestLargestSeqFirst},
         {"kOldestSmallestSeqFirst", kOldestSmallestSeqFirst},
-        {"kMinOverlappingRatio", kMinOverlappingRatio}};
+        {"kMinOverlappingRatio", kMinOverlappingRatio},
+        {"kByReadHotness", kByReadHotness}};
 
 std::unordered_map<std::string, CompactionStopStyle>
     OptionsHelper::compaction_stop_style_string_map = {
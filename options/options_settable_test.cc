@@ -114,6 +114,13 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
        sizeof(std::shared_ptr<PersistentCache>)},
       {offsetof(struct BlockBasedTableOptions, block_cache_compressed),
        sizeof(std::shared_ptr<Cache>)},
+      {offsetof(struct BlockBasedTableOptions, compressor),
+       sizeof(std::shared_ptr<Compressor>)},
+      {offsetof(struct BlockBasedTableOptions, block_size_per_level),
+       sizeof(std::vector<size_t>)},
+      {offsetof(struct BlockBasedTableOptions,
+                block_restart_interval_per_level),
+       sizeof(std::vector<int>)},
       {offsetof(struct BlockBasedTableOptions, filter_policy),
        sizeof(std::shared_ptr<const FilterPolicy>)},
   };
@@ -167,12 +174,18 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "data_block_index_type=kDataBlockBinaryAndHash;"
       "index_shortening=kNoShortening;"
       "data_block_hash_table_util_ratio=0.75;"
+      "data_block_restart_key_prefixes=false;"
       "checksum=kxxHash;hash_index_allow_collision=1;no_block_cache=1;"
+      "serve_data_blocks_from_mmap=true;"
       "block_cache=1M;block_cache_compressed=1k;block_size=1024;"
       "block_size_deviation=8;block_restart_interval=4; "
+      "block_size_per_level=4096:16384;"
+      "block_restart_interval_per_level=16:32;"
+      "auto_tune_block_size=true;max_auto_tuned_block_size=32768;"
       "metadata_block_size=1024;"
       "partition_filters=false;"
       "optimize_filters_for_memory=true;"
+      "reserve_table_builder_memory=true;"
       "index_block_restart_interval=4;"
       "filter_policy=bloomfilter:4:true;whole_key_filtering=1;"
       "format_version=1;"
@@ -227,6 +240,10 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
       {offsetof(struct DBOptions, file_checksum_gen_factory),
        sizeof(std::shared_ptr<FileChecksumGenFactory>)},
       {offsetof(struct DBOptions, db_host_id), sizeof(std::string)},
+      {offsetof(struct DBOptions, compaction_service),
+       sizeof(std::shared_ptr<CompactionService>)},
+      {offsetof(struct DBOptions, span_tracer),
+       sizeof(std::shared_ptr<SpanTracer>)},
   };
 
   char* options_ptr = new char[sizeof(DBOptions)];
@@ -266,6 +283,13 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "table_cache_numshardbits=28;"
                              "max_open_files=72;"
                              "max_file_opening_threads=35;"
+                             "lazy_open_table_files=false;"
+                             "max_table_metadata_checkpoint_size=1048576;"
+                             "block_cache_warmup_save_period_sec=600;"
+                             "max_block_cache_warmup_size=1073741824;"
+                             "options_advisor_period_sec=600;"
+                             "options_advisor_apply_changes=false;"
+                             "options_advisor_max_change_factor=4.0;"
                              "max_background_jobs=8;"
                              "base_background_compactions=3;"
                              "max_background_compactions=33;"
@@ -304,11 +328,14 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "allow_mmap_reads=false;"
                              "use_direct_reads=false;"
                              "use_direct_io_for_flush_and_compaction=false;"
+                             "async_table_file_flush=false;"
                              "max_log_file_size=4607;"
                              "random_access_max_buffer_size=1048576;"
                              "advise_random_on_open=true;"
                              "fail_if_options_file_error=false;"
                              "enable_pipelined_write=false;"
+                             "wal_streams=1;"
+                             "max_async_write_threads=2;"
                              "unordered_write=false;"
                              "allow_concurrent_memtable_write=true;"
                              "wal_recovery_mode=kPointInTimeRecovery;"
@@ -326,12 +353,17 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "concurrent_prepare=false;"
                              "two_write_queues=false;"
                              "manual_wal_flush=false;"
+                             "wal_compression=kZSTD;"
                              "seq_per_batch=false;"
                              "atomic_flush=false;"
                              "avoid_unnecessary_blocking_io=false;"
+                             "row_cache_negative_entries=false;"
+                             "immutable_memtable_numa_node=-1;"
                              "log_readahead_size=0;"
+                             "wal_recovery_threads=4;"
                              "write_dbid_to_manifest=false;"
                              "best_efforts_recovery=false;"
+                             "enable_pipelined_compaction=false;"
                              "max_bgerror_resume_count=2;"
                              "bgerror_resume_retry_interval=1000000"
                              "db_host_id=hostname",
@@ -380,6 +412,8 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
        sizeof(std::shared_ptr<MemTableRepFactory>)},
       {offset_of(&ColumnFamilyOptions::table_properties_collector_factories),
        sizeof(ColumnFamilyOptions::TablePropertiesCollectorFactories)},
+      {offset_of(&ColumnFamilyOptions::blob_cache),
+       sizeof(std::shared_ptr<Cache>)},
       {offset_of(&ColumnFamilyOptions::comparator), sizeof(Comparator*)},
       {offset_of(&ColumnFamilyOptions::merge_operator),
        sizeof(std::shared_ptr<MergeOperator>)},
@@ -459,6 +493,7 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "target_file_size_base=4294976376;"
       "memtable_huge_page_size=2557;"
       "max_successive_merges=5497;"
+      "preaggregate_merge_operands=true;"
       "max_sequential_skip_in_iterations=4294971408;"
       "arena_block_size=1893;"
       "target_file_size_multiplier=35;"
@@ -469,8 +504,12 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "max_bytes_for_level_multiplier=60;"
       "memtable_factory=SkipListFactory;"
       "compression=kNoCompression;"
-      "compression_opts=5:6:7:8:9:true;"
-      "bottommost_compression_opts=4:5:6:7:8:true;"
+      "compression_opts={window_bits=5;level=6;strategy=7;max_dict_bytes=8;"
+      "zstd_max_train_bytes=9;shared_dict_retrain_bytes=10;"
+      "parallel_threads=1;enabled=true};"
+      "bottommost_compression_opts={window_bits=4;level=5;strategy=6;"
+      "max_dict_bytes=7;zstd_max_train_bytes=8;shared_dict_retrain_bytes=9;"
+      "parallel_threads=1;enabled=true};"
       "bottommost_compression=kDisableCompressionOption;"
       "level0_stop_writes_trigger=33;"
       "num_levels=99;"
@@ -490,22 +529,31 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "force_consistency_checks=true;"
       "inplace_update_num_locks=7429;"
       "optimize_filters_for_hits=false;"
+      "zone_aware_compaction_window=8;"
       "level_compaction_dynamic_level_bytes=false;"
       "inplace_update_support=false;"
       "compaction_style=kCompactionStyleFIFO;"
       "compaction_pri=kMinOverlappingRatio;"
       "hard_pending_compaction_bytes_limit=0;"
+      "smooth_write_stall=true;"
+      "smooth_write_stall_target_l0_files=6;"
+      "smooth_write_stall_target_pending_compaction_bytes=1024;"
       "disable_auto_compactions=false;"
       "report_bg_io_stats=true;"
       "ttl=60;"
       "periodic_compaction_seconds=3600;"
       "sample_for_compression=0;"
+      "max_flush_partitions=4;"
       "enable_blob_files=true;"
       "min_blob_size=256;"
+      "blob_file_starting_level=1;"
       "blob_file_size=1000000;"
       "blob_compression_type=kBZip2Compression;"
+      "enable_blob_garbage_collection=true;"
+      "blob_garbage_collection_age_cutoff=0.5;"
+      "prepopulate_blob_cache=true;"
       "compaction_options_fifo={max_table_files_size=3;allow_"
-      "compaction=false;};",
+      "compaction=false;zone_time_bucket_seconds=3600;};",
       new_options));
 
   ASSERT_EQ(unset_bytes_base,
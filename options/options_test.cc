@@ -79,6 +79,9 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
       {"soft_rate_limit", "1.1"},
       {"hard_rate_limit", "2.1"},
       {"hard_pending_compaction_bytes_limit", "211"},
+      {"smooth_write_stall", "true"},
+      {"smooth_write_stall_target_l0_files", "7"},
+      {"smooth_write_stall_target_pending_compaction_bytes", "105"},
       {"arena_block_size", "22"},
       {"disable_auto_compactions", "true"},
       {"compaction_style", "kCompactionStyleLevel"},
@@ -95,13 +98,19 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
       {"memtable_huge_page_size", "28"},
       {"bloom_locality", "29"},
       {"max_successive_merges", "30"},
+      {"preaggregate_merge_operands", "true"},
       {"min_partial_merge_operands", "31"},
       {"prefix_extractor", "fixed:31"},
       {"optimize_filters_for_hits", "true"},
       {"enable_blob_files", "true"},
       {"min_blob_size", "1K"},
+      {"blob_file_starting_level", "1"},
+      {"max_flush_partitions", "4"},
       {"blob_file_size", "1G"},
       {"blob_compression_type", "kZSTD"},
+      {"enable_blob_garbage_collection", "true"},
+      {"blob_garbage_collection_age_cutoff", "0.5"},
+      {"prepopulate_blob_cache", "true"},
   };
 
   std::unordered_map<std::string, std::string> db_options_map = {
@@ -208,6 +217,10 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.max_bytes_for_level_multiplier_additional[2], 18);
   ASSERT_EQ(new_cf_opt.max_compaction_bytes, 21);
   ASSERT_EQ(new_cf_opt.hard_pending_compaction_bytes_limit, 211);
+  ASSERT_EQ(new_cf_opt.smooth_write_stall, true);
+  ASSERT_EQ(new_cf_opt.smooth_write_stall_target_l0_files, 7);
+  ASSERT_EQ(new_cf_opt.smooth_write_stall_target_pending_compaction_bytes,
+            105U);
   ASSERT_EQ(new_cf_opt.arena_block_size, 22U);
   ASSERT_EQ(new_cf_opt.disable_auto_compactions, true);
   ASSERT_EQ(new_cf_opt.compaction_style, kCompactionStyleLevel);
@@ -223,14 +236,20 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.memtable_huge_page_size, 28U);
   ASSERT_EQ(new_cf_opt.bloom_locality, 29U);
   ASSERT_EQ(new_cf_opt.max_successive_merges, 30U);
+  ASSERT_EQ(new_cf_opt.preaggregate_merge_operands, true);
   ASSERT_TRUE(new_cf_opt.prefix_extractor != nullptr);
   ASSERT_EQ(new_cf_opt.optimize_filters_for_hits, true);
   ASSERT_EQ(std::string(new_cf_opt.prefix_extractor->Name()),
             "rocksdb.FixedPrefix.31");
   ASSERT_EQ(new_cf_opt.enable_blob_files, true);
   ASSERT_EQ(new_cf_opt.min_blob_size, 1ULL << 10);
+  ASSERT_EQ(new_cf_opt.blob_file_starting_level, 1);
+  ASSERT_EQ(new_cf_opt.max_flush_partitions, 4U);
   ASSERT_EQ(new_cf_opt.blob_file_size, 1ULL << 30);
   ASSERT_EQ(new_cf_opt.blob_compression_type, kZSTD);
+  ASSERT_EQ(new_cf_opt.enable_blob_garbage_collection, true);
+  ASSERT_EQ(new_cf_opt.blob_garbage_collection_age_cutoff, 0.5);
+  ASSERT_EQ(new_cf_opt.prepopulate_blob_cache, true);
 
   cf_options_map["write_buffer_size"] = "hello";
   ASSERT_NOK(GetColumnFamilyOptionsFromMap(exact, base_cf_opt, cf_options_map,
@@ -652,7 +671,8 @@ TEST_F(OptionsTest, CompressionOptionsFromString) {
   ASSERT_OK(GetColumnFamilyOptionsFromString(
       config_options, ColumnFamilyOptions(),
       "compression_opts={window_bits=5; level=6; strategy=7; max_dict_bytes=8;"
-      "zstd_max_train_bytes=9;parallel_threads=10;enabled=true}; "
+      "zstd_max_train_bytes=9;shared_dict_retrain_bytes=11;"
+      "parallel_threads=10;enabled=true}; "
       "bottommost_compression_opts={window_bits=4; level=5; strategy=6;"
       " max_dict_bytes=7;zstd_max_train_bytes=8;parallel_threads=9;"
       "enabled=false}; ",
@@ -662,6 +682,7 @@ TEST_F(OptionsTest, CompressionOptionsFromString) {
   ASSERT_EQ(new_cf_opt.compression_opts.strategy, 7);
   ASSERT_EQ(new_cf_opt.compression_opts.max_dict_bytes, 8u);
   ASSERT_EQ(new_cf_opt.compression_opts.zstd_max_train_bytes, 9u);
+  ASSERT_EQ(new_cf_opt.compression_opts.shared_dict_retrain_bytes, 11u);
   ASSERT_EQ(new_cf_opt.compression_opts.parallel_threads, 10u);
   ASSERT_EQ(new_cf_opt.compression_opts.enabled, true);
   ASSERT_EQ(new_cf_opt.bottommost_compression_opts.window_bits, 4);
@@ -1071,6 +1092,9 @@ TEST_F(OptionsTest, GetMemTableRepFactoryFromString) {
   ASSERT_EQ(std::string(new_mem_factory->Name()), "SkipListFactory");
   ASSERT_NOK(GetMemTableRepFactoryFromString("skip_list:16:invalid_opt",
                                              &new_mem_factory));
+  ASSERT_OK(GetMemTableRepFactoryFromString("skip_list:16:1024",
+                                            &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()), "SkipListFactory");
 
   ASSERT_OK(GetMemTableRepFactoryFromString("prefix_hash", &new_mem_factory));
   ASSERT_OK(GetMemTableRepFactoryFromString("prefix_hash:1000",
@@ -1093,6 +1117,10 @@ TEST_F(OptionsTest, GetMemTableRepFactoryFromString) {
   ASSERT_NOK(GetMemTableRepFactoryFromString("vector:1024:invalid_opt",
                                              &new_mem_factory));
 
+  ASSERT_OK(GetMemTableRepFactoryFromString("btree", &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()), "BTreeRepFactory");
+  ASSERT_NOK(GetMemTableRepFactoryFromString("btree:1", &new_mem_factory));
+
   ASSERT_NOK(GetMemTableRepFactoryFromString("cuckoo", &new_mem_factory));
   // CuckooHash memtable is already removed.
   ASSERT_NOK(GetMemTableRepFactoryFromString("cuckoo:1024", &new_mem_factory));
@@ -1626,6 +1654,9 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
       {"soft_rate_limit", "1.1"},
       {"hard_rate_limit", "2.1"},
       {"hard_pending_compaction_bytes_limit", "211"},
+      {"smooth_write_stall", "true"},
+      {"smooth_write_stall_target_l0_files", "7"},
+      {"smooth_write_stall_target_pending_compaction_bytes", "105"},
       {"arena_block_size", "22"},
       {"disable_auto_compactions", "true"},
       {"compaction_style", "kCompactionStyleLevel"},
@@ -1642,13 +1673,19 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
       {"memtable_huge_page_size", "28"},
       {"bloom_locality", "29"},
       {"max_successive_merges", "30"},
+      {"preaggregate_merge_operands", "true"},
       {"min_partial_merge_operands", "31"},
       {"prefix_extractor", "fixed:31"},
       {"optimize_filters_for_hits", "true"},
       {"enable_blob_files", "true"},
       {"min_blob_size", "1K"},
+      {"blob_file_starting_level", "1"},
+      {"max_flush_partitions", "4"},
       {"blob_file_size", "1G"},
       {"blob_compression_type", "kZSTD"},
+      {"enable_blob_garbage_collection", "true"},
+      {"blob_garbage_collection_age_cutoff", "0.5"},
+      {"prepopulate_blob_cache", "true"},
   };
 
   std::unordered_map<std::string, std::string> db_options_map = {
@@ -1747,6 +1784,10 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.max_bytes_for_level_multiplier_additional[2], 18);
   ASSERT_EQ(new_cf_opt.max_compaction_bytes, 21);
   ASSERT_EQ(new_cf_opt.hard_pending_compaction_bytes_limit, 211);
+  ASSERT_EQ(new_cf_opt.smooth_write_stall, true);
+  ASSERT_EQ(new_cf_opt.smooth_write_stall_target_l0_files, 7);
+  ASSERT_EQ(new_cf_opt.smooth_write_stall_target_pending_compaction_bytes,
+            105U);
   ASSERT_EQ(new_cf_opt.arena_block_size, 22U);
   ASSERT_EQ(new_cf_opt.disable_auto_compactions, true);
   ASSERT_EQ(new_cf_opt.compaction_style, kCompactionStyleLevel);
@@ -1762,14 +1803,20 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.memtable_huge_page_size, 28U);
   ASSERT_EQ(new_cf_opt.bloom_locality, 29U);
   ASSERT_EQ(new_cf_opt.max_successive_merges, 30U);
+  ASSERT_EQ(new_cf_opt.preaggregate_merge_operands, true);
   ASSERT_TRUE(new_cf_opt.prefix_extractor != nullptr);
   ASSERT_EQ(new_cf_opt.optimize_filters_for_hits, true);
   ASSERT_EQ(std::string(new_cf_opt.prefix_extractor->Name()),
             "rocksdb.FixedPrefix.31");
   ASSERT_EQ(new_cf_opt.enable_blob_files, true);
   ASSERT_EQ(new_cf_opt.min_blob_size, 1ULL << 10);
+  ASSERT_EQ(new_cf_opt.blob_file_starting_level, 1);
+  ASSERT_EQ(new_cf_opt.max_flush_partitions, 4U);
   ASSERT_EQ(new_cf_opt.blob_file_size, 1ULL << 30);
   ASSERT_EQ(new_cf_opt.blob_compression_type, kZSTD);
+  ASSERT_EQ(new_cf_opt.enable_blob_garbage_collection, true);
+  ASSERT_EQ(new_cf_opt.blob_garbage_collection_age_cutoff, 0.5);
+  ASSERT_EQ(new_cf_opt.prepopulate_blob_cache, true);
 
   cf_options_map["write_buffer_size"] = "hello";
   ASSERT_NOK(GetColumnFamilyOptionsFromMap(
@@ -262,6 +262,35 @@ void SetCpuPriority(ThreadId id, CpuPriority priority) {
 #endif
 }
 
+bool MoveMemoryToNumaNode(void* addr, size_t size, int node) {
+#if defined(OS_LINUX) && defined(SYS_mbind)
+  // From <numaif.h>, to not depend on libnuma
+  const int kMpolBind = 2;
+  const unsigned kMpolMfMove = 1 << 1;
+  const size_t kBitsPerWord = sizeof(unsigned long) * 8;
+  if (node < 0 || node >= 1024) {
+    return false;
+  }
+  uintptr_t begin = reinterpret_cast<uintptr_t>(addr);
+  uintptr_t end = begin + size;
+  begin = (begin + kPageSize - 1) & ~(kPageSize - 1);
+  end &= ~(kPageSize - 1);
+  if (begin >= end) {
+    return true;
+  }
+  unsigned long nodemask[1024 / kBitsPerWord] = {};
+  nodemask[node / kBitsPerWord] = 1UL << (node % kBitsPerWord);
+  // The kernel reads one bit less than maxnode
+  return syscall(SYS_mbind, begin, end - begin, kMpolBind, nodemask,
+                 node + 2, kMpolMfMove) == 0;
+#else
+  (void)addr;
+  (void)size;
+  (void)node;
+  return false;
+#endif
+}
+
 }  // namespace port
 }  // namespace ROCKSDB_NAMESPACE
 
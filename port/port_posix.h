@@ -219,5 +219,10 @@ using ThreadId = pid_t;
 
 extern void SetCpuPriority(ThreadId id, CpuPriority priority);
 
+// Migrates the whole pages within [addr, addr + size) to the NUMA node, e.g.
+// a memory-only node of CXL or DAX KMEM memory, keeping their addresses.
+// Returns false if that is not supported or fails.
+extern bool MoveMemoryToNumaNode(void* addr, size_t size, int node);
+
 } // namespace port
 }  // namespace ROCKSDB_NAMESPACE
@@ -277,6 +277,13 @@ void SetCpuPriority(ThreadId id, CpuPriority priority) {
   (void)priority;
 }
 
+bool MoveMemoryToNumaNode(void* addr, size_t size, int node) {
+  (void)addr;
+  (void)size;
+  (void)node;
+  return false;
+}
+
 }  // namespace port
 }  // namespace ROCKSDB_NAMESPACE
 
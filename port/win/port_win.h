@@ -291,6 +291,9 @@ static inline void AsmVolatilePause() {
 
 extern int PhysicalCoreID();
 
+// Not supported, returns false
+extern bool MoveMemoryToNumaNode(void* addr, size_t size, int node);
+
 // For Thread Local Storage abstraction
 typedef DWORD pthread_key_t;
 
@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# Workloads which keep zone cleaning busy, each phase reporting the ZenFS
+# write amplification, the zone cleaning copies, the zone resets and the
+# zone placements every second to report_<phase>.csv.
+
+# Need to check device name through lsblk.
+DEV=nullb1
+# Keys written by the fill, sized for about 80% of the device
+NUM=55000000
+# Seconds each update phase runs
+DURATION=600
+
+# We need the deadline io scheduler to gurantee write ordering
+echo deadline > /sys/class/block/$DEV/queue/scheduler
+
+./zenfs mkfs --zbd=$DEV --aux_path=/mnt/db --finish_threshold=5 --force
+
+COMMON="--fs_uri=zenfs://dev:$DEV \
+     -db=./db \
+     --num=$NUM \
+     -write_buffer_size=67108864 \
+     --threads=4 \
+     -disable_wal=true \
+     -report_interval_seconds=1 \
+     --report_zenfs_stats \
+     --key_size=16 \
+     --value_size=128 \
+     -max_background_compactions=10 \
+     -max_background_flushes=10 \
+     -compression_ratio=1 \
+     -use_direct_io_for_flush_and_compaction \
+     -target_file_size_multiplier=1"
+
+run() {
+  PHASE=$1
+  shift
+  ./db_bench $COMMON --report_file=report_$PHASE.csv "$@" \
+       > result_$PHASE.txt
+}
+
+# Fill to high utilization
+run fill --benchmarks=fillrandom,stats
+# Uniform overwrites
+run overwrite --benchmarks=overwrite,stats --use_existing_db \
+     --duration=$DURATION
+# Skewed overwrites, most of them to few hot keys
+run zipf --benchmarks=overwrite,stats --use_existing_db \
+     --duration=$DURATION --write_zipf_theta=0.99
+# Overwrites of mixed value sizes
+run mixed --benchmarks=overwrite,stats --use_existing_db \
+     --duration=$DURATION --value_size_distribution_type=uniform \
+     --value_size_min=64 --value_size_max=4096
+# Time series writes, the oldest entries deleted as new ones come
+run timeseries --benchmarks=timeseries,stats --use_existing_db \
+     --duration=$DURATION --expire_style=delete --time_range=100000 \
+     --num_deletion_threads=1
@@ -2,8 +2,10 @@
 LIB_SOURCES =                                                   \
   cache/cache.cc                                                \
   cache/clock_cache.cc                                          \
+  cache/compressed_secondary_cache.cc                           \
   cache/lru_cache.cc                                            \
   cache/sharded_cache.cc                                        \
+  cache/slow_memory_secondary_cache.cc                          \
   db/arena_wrapped_db_iter.cc                                   \
   db/blob/blob_file_addition.cc                                 \
   db/blob/blob_file_builder.cc                                  \
@@ -14,6 +16,8 @@ LIB_SOURCES =                                                   \
   db/blob/blob_log_format.cc                                    \
   db/blob/blob_log_sequential_reader.cc                         \
   db/blob/blob_log_writer.cc                                    \
+  db/blob/blob_value_cache.cc                                   \
+  db/block_cache_warmup.cc                                      \
   db/builder.cc                                                 \
   db/c.cc                                                       \
   db/column_family.cc                                           \
@@ -25,6 +29,7 @@ LIB_SOURCES =                                                   \
   db/compaction/compaction_picker_fifo.cc                       \
   db/compaction/compaction_picker_level.cc                      \
   db/compaction/compaction_picker_universal.cc                  \
+  db/compaction/pipelined_compaction_iterator.cc                \
   db/compaction/sst_partitioner.cc                              \
   db/convenience.cc                                             \
   db/db_filesnapshot.cc                                         \
@@ -36,6 +41,7 @@ LIB_SOURCES =                                                   \
   db/db_impl/db_impl_open.cc                                    \
   db/db_impl/db_impl_readonly.cc                                \
   db/db_impl/db_impl_secondary.cc                               \
+  db/db_impl/primary_change_watcher.cc                          \
   db/db_impl/db_impl_write.cc                                   \
   db/db_info_dumper.cc                                          \
   db/db_iter.cc                                                 \
@@ -50,6 +56,7 @@ LIB_SOURCES =                                                   \
   db/forward_iterator.cc                                        \
   db/import_column_family_job.cc                                \
   db/internal_stats.cc                                          \
+  db/key_distribution.cc                                        \
   db/logs_with_prep_tracker.cc                                  \
   db/log_reader.cc                                              \
   db/log_writer.cc                                              \
@@ -58,6 +65,7 @@ LIB_SOURCES =                                                   \
   db/memtable_list.cc                                           \
   db/merge_helper.cc                                            \
   db/merge_operator.cc                                          \
+  db/options_advisor.cc                                         \
   db/output_validator.cc                                        \
   db/periodic_work_scheduler.cc                                 \
   db/range_del_aggregator.cc                                    \
@@ -65,12 +73,14 @@ LIB_SOURCES =                                                   \
   db/repair.cc                                                  \
   db/snapshot_impl.cc                                           \
   db/table_cache.cc                                             \
+  db/table_metadata_checkpoint.cc                               \
   db/table_properties_collector.cc                              \
   db/transaction_log_impl.cc                                    \
   db/trim_history_scheduler.cc                                  \
   db/version_builder.cc                                         \
   db/version_edit.cc                                            \
   db/version_edit_handler.cc                                    \
+  db/version_files_snapshot.cc                                  \
   db/version_set.cc                                             \
   db/wal_edit.cc                                                \
   db/wal_manager.cc                                             \
@@ -81,15 +91,19 @@ LIB_SOURCES =                                                   \
   env/env.cc                                                    \
   env/env_chroot.cc                                             \
   env/env_encryption.cc                                         \
+  env/env_encryption_aes.cc                                     \
   env/env_hdfs.cc                                               \
   env/env_posix.cc                                              \
   env/file_system.cc                                            \
   env/fs_posix.cc                                               \
   env/file_system_tracer.cc                                     \
+  env/fs_hedged.cc                                              \
+  env/fs_tiered.cc                                              \
   env/io_posix.cc                                               \
   env/fs_zenfs.cc                                               \
   env/io_zenfs.cc                                               \
   env/zbd_zenfs.cc                                              \
+  env/zbd_emu.cc                                                \
   env/mock_env.cc                                               \
   file/delete_scheduler.cc                                      \
   file/file_prefetch_buffer.cc                                  \
@@ -109,19 +123,23 @@ LIB_SOURCES =                                                   \
   memory/jemalloc_nodump_allocator.cc                           \
   memory/memkind_kmem_allocator.cc                              \
   memtable/alloc_tracker.cc                                     \
+  memtable/btree_rep.cc                                         \
   memtable/hash_linklist_rep.cc                                 \
   memtable/hash_skiplist_rep.cc                                 \
   memtable/skiplistrep.cc                                       \
   memtable/vectorrep.cc                                         \
+  memtable/memory_governor.cc                                   \
   memtable/write_buffer_manager.cc                              \
   monitoring/histogram.cc                                       \
   monitoring/histogram_windowing.cc                             \
   monitoring/in_memory_stats_history.cc                         \
   monitoring/instrumented_mutex.cc                              \
   monitoring/iostats_context.cc                                 \
+  monitoring/lock_profiler.cc                                   \
   monitoring/perf_context.cc                                    \
   monitoring/perf_level.cc                                      \
   monitoring/persistent_stats_history.cc                        \
+  monitoring/span_tracer.cc                                     \
   monitoring/statistics.cc                                      \
   monitoring/thread_status_impl.cc                              \
   monitoring/thread_status_updater.cc                           \
@@ -153,6 +171,8 @@ LIB_SOURCES =                                                   \
   table/block_based/block_builder.cc                            \
   table/block_based/block_prefetcher.cc                         \
   table/block_based/block_prefix_index.cc                       \
+  table/block_based/block_size_tuner.cc                         \
+  table/block_based/compression_dict_registry.cc                \
   table/block_based/data_block_hash_index.cc                    \
   table/block_based/data_block_footer.cc                        \
   table/block_based/filter_block_reader_common.cc               \
@@ -167,6 +187,8 @@ LIB_SOURCES =                                                   \
   table/block_based/partitioned_index_iterator.cc               \
   table/block_based/partitioned_index_reader.cc                 \
   table/block_based/reader_common.cc                            \
+  table/block_based/succinct_trie.cc                            \
+  table/block_based/succinct_trie_index_reader.cc               \
   table/block_based/uncompression_dict_reader.cc                \
   table/block_fetcher.cc                                        \
   table/cuckoo/cuckoo_table_builder.cc                          \
@@ -183,6 +205,7 @@ LIB_SOURCES =                                                   \
   table/plain/plain_table_factory.cc                            \
   table/plain/plain_table_index.cc                              \
   table/plain/plain_table_key_coding.cc                         \
+  table/parallel_sst_file_writer.cc                             \
   table/plain/plain_table_reader.cc                             \
   table/sst_file_dumper.cc                                      \
   table/sst_file_reader.cc                                      \
@@ -201,6 +224,7 @@ LIB_SOURCES =                                                   \
   util/coding.cc                                                \
   util/compaction_job_stats_impl.cc                             \
   util/comparator.cc                                            \
+  util/compression.cc                                           \
   util/compression_context_cache.cc                             \
   util/concurrent_task_limiter_impl.cc                          \
   util/crc32c.cc                                                \
@@ -215,6 +239,7 @@ LIB_SOURCES =                                                   \
   util/string_util.cc                                           \
   util/thread_local.cc                                          \
   util/threadpool_imp.cc                                        \
+  util/work_stealing_thread_pool.cc                             \
   util/xxhash.cc                                                \
   utilities/backupable/backupable_db.cc                         \
   utilities/blob_db/blob_compaction_filter.cc                   \
@@ -231,6 +256,7 @@ LIB_SOURCES =                                                   \
   utilities/debug.cc                                            \
   utilities/env_mirror.cc                                       \
   utilities/env_timed.cc                                        \
+  utilities/env_work_stealing.cc                                \
   utilities/fault_injection_env.cc                              \
   utilities/fault_injection_fs.cc                               \
   utilities/leveldb_options/leveldb_options.cc                  \
@@ -245,11 +271,13 @@ LIB_SOURCES =                                                   \
   utilities/object_registry.cc                                  \
   utilities/option_change_migration/option_change_migration.cc  \
   utilities/options/options_util.cc                             \
+  utilities/parallel_scan/parallel_scan.cc                      \
   utilities/persistent_cache/block_cache_tier.cc                \
   utilities/persistent_cache/block_cache_tier_file.cc           \
   utilities/persistent_cache/block_cache_tier_metadata.cc       \
   utilities/persistent_cache/persistent_cache_tier.cc           \
   utilities/persistent_cache/volatile_tier_impl.cc              \
+  utilities/persistent_cache/zone_cache_tier.cc                 \
   utilities/simulator_cache/cache_simulator.cc                  \
   utilities/simulator_cache/sim_cache.cc                        \
   utilities/table_properties_collectors/compact_on_deletion_collector.cc \
@@ -257,6 +285,7 @@ LIB_SOURCES =                                                   \
   utilities/transactions/lock/lock_manager.cc                   \
   utilities/transactions/lock/point/point_lock_tracker.cc       \
   utilities/transactions/lock/point/point_lock_manager.cc       \
+  utilities/transactions/old_commit_map.cc                      \
   utilities/transactions/optimistic_transaction.cc              \
   utilities/transactions/optimistic_transaction_db_impl.cc      \
   utilities/transactions/pessimistic_transaction.cc             \
@@ -374,6 +403,7 @@ TEST_MAIN_SOURCES =                                                     \
   db/compaction/compaction_job_test.cc                                  \
   db/compaction/compaction_job_stats_test.cc                            \
   db/compaction/compaction_picker_test.cc                               \
+  db/compaction/compaction_service_test.cc                              \
   db/comparator_db_test.cc                                              \
   db/corruption_test.cc                                                 \
   db/cuckoo_table_db_test.cc                                            \
@@ -456,6 +486,7 @@ TEST_MAIN_SOURCES =                                                     \
   logging/event_logger_test.cc                                          \
   memory/arena_test.cc                                                  \
   memory/memkind_kmem_allocator_test.cc                                 \
+  memtable/btree_rep_test.cc                                            \
   memtable/inlineskiplist_test.cc                                       \
   memtable/skiplist_test.cc                                             \
   memtable/write_buffer_manager_test.cc                                 \
@@ -472,6 +503,7 @@ TEST_MAIN_SOURCES =                                                     \
   table/block_based/data_block_hash_index_test.cc                       \
   table/block_based/full_filter_block_test.cc                           \
   table/block_based/partitioned_filter_block_test.cc                    \
+  table/block_based/succinct_trie_test.cc                               \
   table/cleanable_test.cc                                               \
   table/cuckoo/cuckoo_table_builder_test.cc                             \
   table/cuckoo/cuckoo_table_reader_test.cc                              \
@@ -506,6 +538,7 @@ TEST_MAIN_SOURCES =                                                     \
   util/slice_transform_test.cc                                          \
   util/timer_queue_test.cc                                              \
   util/timer_test.cc                                                    \
+  util/timer_wheel_test.cc                                              \
   util/thread_list_test.cc                                              \
   util/thread_local_test.cc                                             \
   util/work_queue_test.cc                                               \
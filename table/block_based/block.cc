@@ -127,7 +127,118 @@ struct DecodeKeyV4 {
   }
 };
 
-void DataBlockIter::NextImpl() { ParseNextDataKey<DecodeEntry>(); }
+void DataBlockIter::NextImpl() {
+  if (bulk_decode_ && NextDecodedEntry()) {
+    return;
+  }
+  ParseNextDataKey<DecodeEntry>();
+}
+
+bool DataBlockIter::NextDecodedEntry() {
+  uint32_t next = NextEntryOffset();
+  if (next >= restarts_) {
+    return false;
+  }
+  if (decoded_idx_ + 1 < decoded_entries_.size() &&
+      decoded_entries_[decoded_idx_ + 1].offset == next) {
+    decoded_idx_++;
+  } else {
+    // The next entry either starts the next restart interval, or is in the
+    // one of the current entry, e.g. after a Seek()
+    uint32_t index = restart_index_;
+    if (index + 1 < num_restarts_ && GetRestartPoint(index + 1) <= next) {
+      index++;
+    }
+    if (!DecodeRestartInterval(index)) {
+      return false;
+    }
+    size_t i = 0;
+    while (i < decoded_entries_.size() && decoded_entries_[i].offset != next) {
+      i++;
+    }
+    if (i == decoded_entries_.size()) {
+      return false;
+    }
+    decoded_idx_ = i;
+  }
+
+  const DecodedEntry& entry = decoded_entries_[decoded_idx_];
+  current_ = entry.offset;
+  restart_index_ = decoded_restart_index_;
+  if (entry.key_in_block) {
+    raw_key_.SetKey(Slice(data_ + entry.key_offset, entry.key_size),
+                    false /* copy */);
+    raw_key_transient_ = false;
+  } else {
+    raw_key_.SetKey(
+        Slice(decoded_keys_.data() + entry.key_offset, entry.key_size),
+        false /* copy */);
+    raw_key_transient_ = true;
+  }
+  value_ = entry.value;
+  return true;
+}
+
+bool DataBlockIter::DecodeRestartInterval(uint32_t index) {
+  assert(index < num_restarts_);
+  const char* p = data_ + GetRestartPoint(index);
+  const char* limit = data_ + (index + 1 < num_restarts_
+                                   ? GetRestartPoint(index + 1)
+                                   : restarts_);
+  decoded_entries_.clear();
+  decoded_restart_index_ = index;
+
+  // First decode the entries, with key_offset at the key delta in the block
+  // for all of them, so that decoded_keys_, which raw_key_ may point to, is
+  // only changed once they all turn out to be valid
+  size_t keys_size = 0;
+  uint32_t prev_key_size = 0;
+  while (p < limit) {
+    uint32_t shared, non_shared, value_length;
+    const char* key_ptr = CheckAndDecodeEntry()(p, limit, &shared, &non_shared,
+                                                &value_length);
+    if (key_ptr == nullptr || shared > prev_key_size) {
+      decoded_entries_.clear();
+      return false;
+    }
+    DecodedEntry entry;
+    entry.offset = static_cast<uint32_t>(p - data_);
+    entry.key_offset = static_cast<uint32_t>(key_ptr - data_);
+    entry.key_size = shared + non_shared;
+    entry.key_in_block = shared == 0;
+    entry.value = Slice(key_ptr + non_shared, value_length);
+    decoded_entries_.push_back(entry);
+    if (shared != 0) {
+      keys_size += entry.key_size;
+    }
+    prev_key_size = entry.key_size;
+    p = entry.value.data() + value_length;
+  }
+
+  // Then rebuild the delta encoded keys one after the other, each from the
+  // prefix of the previous key and its delta
+  decoded_keys_.resize(keys_size);
+  char* keys = &decoded_keys_[0];
+  uint32_t keys_offset = 0;
+  const char* prev_key = nullptr;
+  for (DecodedEntry& entry : decoded_entries_) {
+    const char* delta = data_ + entry.key_offset;
+    if (!entry.key_in_block) {
+      uint32_t non_shared =
+          static_cast<uint32_t>(entry.value.data() - delta);
+      uint32_t shared = entry.key_size - non_shared;
+      char* key = keys + keys_offset;
+      memcpy(key, prev_key, shared);
+      memcpy(key + shared, delta, non_shared);
+      entry.key_offset = keys_offset;
+      keys_offset += entry.key_size;
+      prev_key = key;
+    } else {
+      prev_key = delta;
+    }
+  }
+  return true;
+}
 
 void DataBlockIter::NextOrReportImpl() {
   ParseNextDataKey<CheckAndDecodeEntry>();
@@ -188,6 +299,7 @@ void DataBlockIter::PrevImpl() {
     // `raw_key_` point into Prev cache as it is a transient outside buffer
     // (i.e., keys in it are not actually pinned).
     raw_key_.SetKey(current_key, raw_key_cached /* copy */);
+    raw_key_transient_ = false;
     value_ = current_prev_entry.value;
 
     return;
@@ -274,11 +386,8 @@ void DataBlockIter::SeekImpl(const Slice& target) {
 //    than the seek_user_key, or the block ends with a matching user_key but
 //    with a smaller [ type | seqno ] (i.e. a larger seqno, or the same seqno
 //    but larger type).
-bool DataBlockIter::SeekForGetImpl(const Slice& target) {
+bool DataBlockIter::SeekForGetImpl(const Slice& target, uint8_t entry) {
   Slice target_user_key = ExtractUserKey(target);
-  uint32_t map_offset = restarts_ + num_restarts_ * sizeof(uint32_t);
-  uint8_t entry =
-      data_block_hash_index_->Lookup(data_, map_offset, target_user_key);
 
   if (entry == kCollision) {
     // HashSeek not effective, falling back
@@ -370,6 +479,41 @@ bool DataBlockIter::SeekForGetImpl(const Slice& target) {
   return true;
 }
 
+bool DataBlockIter::ProbeHashIndex(const Slice* targets, size_t n,
+                                   uint8_t* hash_entries) {
+  if (data_block_hash_index_ == nullptr) {
+    return false;
+  }
+  const uint32_t map_offset = restarts_ + num_restarts_ * sizeof(uint32_t);
+  const size_t kProbeBatch = 32;
+  uint16_t buckets[kProbeBatch];
+  for (size_t begin = 0; begin < n; begin += kProbeBatch) {
+    size_t end = std::min(n, begin + kProbeBatch);
+    for (size_t i = begin; i < end; i++) {
+      buckets[i - begin] =
+          data_block_hash_index_->GetBucket(ExtractUserKey(targets[i]));
+      PREFETCH(data_ + map_offset + buckets[i - begin], 0 /* rw */,
+               3 /* locality */);
+    }
+    for (size_t i = begin; i < end; i++) {
+      uint8_t entry = data_block_hash_index_->LookupBucket(data_, map_offset,
+                                                           buckets[i - begin]);
+      hash_entries[i] = entry;
+      if (entry < num_restarts_) {
+        PREFETCH(data_ + restarts_ + entry * sizeof(uint32_t), 0 /* rw */,
+                 3 /* locality */);
+      }
+    }
+    for (size_t i = begin; i < end; i++) {
+      if (hash_entries[i] < num_restarts_) {
+        PREFETCH(data_ + GetRestartPoint(hash_entries[i]), 0 /* rw */,
+                 3 /* locality */);
+      }
+    }
+  }
+  return true;
+}
+
 void IndexBlockIter::SeekImpl(const Slice& target) {
   TEST_SYNC_POINT("IndexBlockIter::Seek:0");
   PERF_TIMER_GUARD(block_seek_nanos);
@@ -510,6 +654,7 @@ bool DataBlockIter::ParseNextDataKey(const char* limit) {
     CorruptionError();
     return false;
   } else {
+    raw_key_transient_ = false;
     if (shared == 0) {
       // If this key doesn't share any bytes with prev key then we don't need
       // to decode it and can use its address in the block directly.
@@ -704,6 +849,16 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   // - Any restart keys after index `right` are strictly greater than the target
   //   key.
   int64_t left = -1, right = num_restarts_ - 1;
+  if (restart_prefixes_ != nullptr && !raw_key_.IsUserKey()) {
+    // Restart keys with a smaller prefix than the target are smaller than it
+    // and those with a larger prefix are larger, so only the keys sharing the
+    // prefix of the target are left to compare.
+    uint32_t num_less, num_less_or_equal;
+    CountRestartPrefixes(RestartKeyPrefix(ExtractUserKey(target)), &num_less,
+                         &num_less_or_equal);
+    left = static_cast<int64_t>(num_less) - 1;
+    right = static_cast<int64_t>(num_less_or_equal) - 1;
+  }
   while (left != right) {
     // The `mid` is computed by rounding up so it lands in (`left`, `right`].
     int64_t mid = left + (right - left + 1) / 2;
@@ -743,6 +898,49 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   return true;
 }
 
+template <class TValue>
+void BlockIter<TValue>::CountRestartPrefixes(
+    uint64_t target_prefix, uint32_t* num_less,
+    uint32_t* num_less_or_equal) const {
+  assert(restart_prefixes_ != nullptr);
+  const char* prefixes = restart_prefixes_;
+  const uint32_t n = num_restarts_;
+  if (n <= 64) {
+    // A data block has few restarts, and a plain count over all of them has
+    // no branches to mispredict and is vectorized by the compiler.
+    uint32_t less = 0, less_or_equal = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      uint64_t prefix = DecodeFixed64(prefixes + i * sizeof(uint64_t));
+      less += prefix < target_prefix;
+      less_or_equal += prefix <= target_prefix;
+    }
+    *num_less = less;
+    *num_less_or_equal = less_or_equal;
+    return;
+  }
+  // The prefixes are sorted, so search for both bounds, picking the next half
+  // with a conditional move rather than a branch.
+  uint32_t less = 0, less_or_equal = 0;
+  for (uint32_t len = n; len > 1;) {
+    uint32_t half = len / 2;
+    less += DecodeFixed64(prefixes + (less + half) * sizeof(uint64_t)) <
+                    target_prefix
+                ? half
+                : 0;
+    less_or_equal +=
+        DecodeFixed64(prefixes + (less_or_equal + half) * sizeof(uint64_t)) <=
+                target_prefix
+            ? half
+            : 0;
+    len -= half;
+  }
+  less += DecodeFixed64(prefixes + less * sizeof(uint64_t)) < target_prefix;
+  less_or_equal += DecodeFixed64(prefixes + less_or_equal * sizeof(uint64_t)) <=
+                   target_prefix;
+  *num_less = less;
+  *num_less_or_equal = less_or_equal;
+}
+
 // Compare target key and the block key of the block of `block_index`.
 // Return -1 if error.
 int IndexBlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
@@ -893,6 +1091,19 @@ uint32_t Block::NumRestarts() const {
   return num_restarts;
 }
 
+bool Block::HasRestartPrefixes() const {
+  assert(size_ >= 2 * sizeof(uint32_t));
+  if (size_ > kMaxBlockSizeSupportedByHashIndex) {
+    // The check is for the same reason as that in NumRestarts()
+    return false;
+  }
+  uint32_t block_footer = DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  bool has_restart_prefixes = false;
+  UnPackIndexTypeAndNumRestarts(block_footer, nullptr, nullptr,
+                                &has_restart_prefixes);
+  return has_restart_prefixes;
+}
+
 BlockBasedTableOptions::DataBlockIndexType Block::IndexType() const {
   assert(size_ >= 2 * sizeof(uint32_t));
   if (size_ > kMaxBlockSizeSupportedByHashIndex) {
@@ -918,7 +1129,8 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
       data_(contents_.data.data()),
       size_(contents_.data.size()),
       restart_offset_(0),
-      num_restarts_(0) {
+      num_restarts_(0),
+      restart_prefixes_(nullptr) {
   TEST_SYNC_POINT("Block::Block:0");
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
@@ -962,6 +1174,18 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
       default:
         size_ = 0;  // Error marker
     }
+    if (size_ != 0 && HasRestartPrefixes()) {
+      // The prefixes sit between the restart array and what follows it
+      uint32_t prefixes_size =
+          num_restarts_ * static_cast<uint32_t>(sizeof(uint64_t));
+      if (restart_offset_ < prefixes_size) {
+        size_ = 0;
+      } else {
+        restart_offset_ -= prefixes_size;
+        restart_prefixes_ =
+            data_ + restart_offset_ + num_restarts_ * sizeof(uint32_t);
+      }
+    }
   }
   if (read_amp_bytes_per_bit != 0 && statistics && size_ != 0) {
     read_amp_bitmap_.reset(new BlockReadAmpBitmap(
@@ -991,7 +1215,8 @@ DataBlockIter* Block::NewDataIterator(const Comparator* raw_ucmp,
     ret_iter->Initialize(
         raw_ucmp, data_, restart_offset_, num_restarts_, global_seqno,
         read_amp_bitmap_.get(), block_contents_pinned,
-        data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr);
+        data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr,
+        restart_prefixes_);
     if (read_amp_bitmap_) {
       if (read_amp_bitmap_->GetStatistics() != stats) {
         // DB changed the Statistics pointer, we need to notify read_amp_bitmap_
@@ -168,6 +168,10 @@ class Block {
 
   BlockBasedTableOptions::DataBlockIndexType IndexType() const;
 
+  // Whether the block stores the RestartKeyPrefix() of its restart keys. See
+  // BlockBuilder.
+  bool HasRestartPrefixes() const;
+
   // raw_ucmp is a raw (i.e., not wrapped by `UserComparatorWrapper`) user key
   // comparator.
   //
@@ -225,6 +229,8 @@ class Block {
   size_t size_;              // contents_.data.size()
   uint32_t restart_offset_;  // Offset in data_ of restart array
   uint32_t num_restarts_;
+  // fixed64[num_restarts_] following the restart array, or nullptr
+  const char* restart_prefixes_;
   std::unique_ptr<BlockReadAmpBitmap> read_amp_bitmap_;
   DataBlockHashIndex data_block_hash_index_;
 };
@@ -258,6 +264,7 @@ class BlockIter : public InternalIteratorBase<TValue> {
     assert(num_restarts > 0);  // Ensure the param is valid
 
     raw_ucmp_ = raw_ucmp;
+    raw_ucmp_builtin_ = GetBuiltinComparator(raw_ucmp);
     data_ = data;
     restarts_ = restarts;
     num_restarts_ = num_restarts;
@@ -266,6 +273,8 @@ class BlockIter : public InternalIteratorBase<TValue> {
     global_seqno_ = global_seqno;
     block_contents_pinned_ = block_contents_pinned;
     cache_handle_ = nullptr;
+    restart_prefixes_ = nullptr;
+    raw_key_transient_ = false;
   }
 
   // Makes Valid() return false, status() return `s`, and Seek()/Prev()/etc do
@@ -367,6 +376,9 @@ class BlockIter : public InternalIteratorBase<TValue> {
   uint32_t current_;
   // Raw key from block.
   IterKey raw_key_;
+  // raw_key_ points to a buffer of the iterator that is reused once it
+  // moves, so the key is not pinned with the block
+  bool raw_key_transient_;
   // Buffer for key data when global seqno assignment is enabled.
   IterKey key_buf_;
   Slice value_;
@@ -379,6 +391,9 @@ class BlockIter : public InternalIteratorBase<TValue> {
   // e.g. PinnableSlice, the pointer to the bytes will still be valid.
   bool block_contents_pinned_;
   SequenceNumber global_seqno_;
+  // RestartKeyPrefix() of the restart keys, if the block stores them and the
+  // keys are internal keys ordered by BytewiseComparator
+  const char* restart_prefixes_;
 
   virtual void SeekToFirstImpl() = 0;
   virtual void SeekToLastImpl() = 0;
@@ -388,10 +403,12 @@ class BlockIter : public InternalIteratorBase<TValue> {
   virtual void PrevImpl() = 0;
 
   InternalKeyComparator icmp() {
-    return InternalKeyComparator(raw_ucmp_, false /* named */);
+    return InternalKeyComparator(raw_ucmp_, raw_ucmp_builtin_);
   }
 
-  UserComparatorWrapper ucmp() { return UserComparatorWrapper(raw_ucmp_); }
+  UserComparatorWrapper ucmp() {
+    return UserComparatorWrapper(raw_ucmp_, raw_ucmp_builtin_);
+  }
 
   // Must be called every time a key is found that needs to be returned to user,
   // and may be called when no key is found (as a no-op). Updates `key_`,
@@ -404,10 +421,10 @@ class BlockIter : public InternalIteratorBase<TValue> {
     if (raw_key_.IsUserKey()) {
       assert(global_seqno_ == kDisableGlobalSequenceNumber);
       key_ = raw_key_.GetUserKey();
-      key_pinned_ = raw_key_.IsKeyPinned();
+      key_pinned_ = raw_key_.IsKeyPinned() && !raw_key_transient_;
     } else if (global_seqno_ == kDisableGlobalSequenceNumber) {
       key_ = raw_key_.GetInternalKey();
-      key_pinned_ = raw_key_.IsKeyPinned();
+      key_pinned_ = raw_key_.IsKeyPinned() && !raw_key_transient_;
     } else {
       key_buf_.SetInternalKey(raw_key_.GetUserKey(), global_seqno_,
                               ExtractValueType(raw_key_.GetInternalKey()));
@@ -432,6 +449,7 @@ class BlockIter : public InternalIteratorBase<TValue> {
 
  private:
   const Comparator* raw_ucmp_;
+  BuiltinComparator raw_ucmp_builtin_;
   // Store the cache handle, if the block is cached. We need this since the
   // only other place the handle is stored is as an argument to the Cleanable
   // function callback, which is hard to retrieve. When multiple value
@@ -453,6 +471,7 @@ class BlockIter : public InternalIteratorBase<TValue> {
 
   void SeekToRestartPoint(uint32_t index) {
     raw_key_.Clear();
+    raw_key_transient_ = false;
     restart_index_ = index;
     // current_ will be fixed by ParseNextKey();
 
@@ -470,6 +489,11 @@ class BlockIter : public InternalIteratorBase<TValue> {
 
   void FindKeyAfterBinarySeek(const Slice& target, uint32_t index,
                               bool is_index_key_result);
+
+  // Counts the restart prefixes smaller than, and not larger than,
+  // target_prefix. REQUIRES: restart_prefixes_ != nullptr
+  void CountRestartPrefixes(uint64_t target_prefix, uint32_t* num_less,
+                            uint32_t* num_less_or_equal) const;
 };
 
 class DataBlockIter final : public BlockIter<Slice> {
@@ -479,23 +503,28 @@ class DataBlockIter final : public BlockIter<Slice> {
   DataBlockIter(const Comparator* raw_ucmp, const char* data, uint32_t restarts,
                 uint32_t num_restarts, SequenceNumber global_seqno,
                 BlockReadAmpBitmap* read_amp_bitmap, bool block_contents_pinned,
-                DataBlockHashIndex* data_block_hash_index)
+                DataBlockHashIndex* data_block_hash_index,
+                const char* restart_prefixes = nullptr)
       : DataBlockIter() {
     Initialize(raw_ucmp, data, restarts, num_restarts, global_seqno,
-               read_amp_bitmap, block_contents_pinned, data_block_hash_index);
+               read_amp_bitmap, block_contents_pinned, data_block_hash_index,
+               restart_prefixes);
   }
   void Initialize(const Comparator* raw_ucmp, const char* data,
                   uint32_t restarts, uint32_t num_restarts,
                   SequenceNumber global_seqno,
                   BlockReadAmpBitmap* read_amp_bitmap,
                   bool block_contents_pinned,
-                  DataBlockHashIndex* data_block_hash_index) {
+                  DataBlockHashIndex* data_block_hash_index,
+                  const char* restart_prefixes = nullptr) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts, global_seqno,
                    block_contents_pinned);
     raw_key_.SetIsUserKey(false);
     read_amp_bitmap_ = read_amp_bitmap;
     last_bitmap_offset_ = current_ + 1;
     data_block_hash_index_ = data_block_hash_index;
+    restart_prefixes_ = restart_prefixes;
+    bulk_decode_ = block_contents_pinned;
   }
 
   Slice value() const override {
@@ -515,11 +544,29 @@ class DataBlockIter final : public BlockIter<Slice> {
       UpdateKey();
       return true;
     }
-    bool res = SeekForGetImpl(target);
+    uint32_t map_offset = restarts_ + num_restarts_ * sizeof(uint32_t);
+    bool res = SeekForGetImpl(
+        target, data_block_hash_index_->Lookup(data_, map_offset,
+                                               ExtractUserKey(target)));
+    UpdateKey();
+    return res;
+  }
+
+  // SeekForGet() with the hash index entry of target returned by
+  // ProbeHashIndex()
+  inline bool SeekForGet(const Slice& target, uint8_t hash_entry) {
+    assert(data_block_hash_index_);
+    bool res = SeekForGetImpl(target, hash_entry);
     UpdateKey();
     return res;
   }
 
+  // Looks up the hash index entries of n targets for SeekForGet(). The
+  // buckets of all targets are prefetched before any is read, and then the
+  // restart points they map to, so that the cache misses of the batch
+  // overlap. Returns false if the block has no hash index.
+  bool ProbeHashIndex(const Slice* targets, size_t n, uint8_t* hash_entries);
+
   // Try to advance to the next entry in the block. If there is data corruption
   // or error, report it to the caller instead of aborting the process. May
   // incur higher CPU overhead because we need to perform check on every entry.
@@ -542,6 +589,8 @@ class DataBlockIter final : public BlockIter<Slice> {
     prev_entries_keys_buff_.clear();
     prev_entries_.clear();
     prev_entries_idx_ = -1;
+    decoded_entries_.clear();
+    decoded_idx_ = 0;
   }
 
  protected:
@@ -581,12 +630,42 @@ class DataBlockIter final : public BlockIter<Slice> {
   std::vector<CachedPrevEntry> prev_entries_;
   int32_t prev_entries_idx_ = -1;
 
+  // With bulk_decode_, Next() decodes all the entries of a restart interval
+  // at once, with their keys rebuilt one after the other in decoded_keys_,
+  // and then steps through them
+  struct DecodedEntry {
+    // offset of entry in block
+    uint32_t offset;
+    // offset of key in data_ if key_in_block, else in decoded_keys_
+    uint32_t key_offset;
+    uint32_t key_size;
+    // The key is not delta encoded
+    bool key_in_block;
+    // value slice pointing to data in block
+    Slice value;
+  };
+  bool bulk_decode_ = false;
+  std::string decoded_keys_;
+  std::vector<DecodedEntry> decoded_entries_;
+  // Restart interval of decoded_entries_
+  uint32_t decoded_restart_index_ = 0;
+  // Entry of decoded_entries_ the iterator is at, if its offset is current_
+  size_t decoded_idx_ = 0;
+
   DataBlockHashIndex* data_block_hash_index_;
 
   template <typename DecodeEntryFunc>
   inline bool ParseNextDataKey(const char* limit = nullptr);
 
-  bool SeekForGetImpl(const Slice& target);
+  // Moves to the entry after current_ from decoded_entries_, decoding its
+  // restart interval first if needed. Returns false if the entry can not be
+  // decoded that way, e.g. at the end of the block or on a corrupted entry.
+  bool NextDecodedEntry();
+  // Decodes the entries of restart interval `index` into decoded_entries_.
+  // Leaves decoded_entries_ empty and returns false on a corrupted entry.
+  bool DecodeRestartInterval(uint32_t index);
+
+  bool SeekForGetImpl(const Slice& target, uint8_t entry);
   void NextOrReportImpl();
   void SeekToFirstOrReportImpl();
 };
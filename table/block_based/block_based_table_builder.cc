@@ -36,6 +36,7 @@
 #include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_based_table_reader.h"
 #include "table/block_based/block_builder.h"
+#include "table/block_based/compression_dict_registry.h"
 #include "table/block_based/filter_block.h"
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
@@ -106,6 +107,17 @@ bool GoodCompressionRatio(size_t compressed_size, size_t raw_size) {
   return compressed_size < raw_size - (raw_size / 8u);
 }
 
+// Starts the output of a Compressor with what the built-in compression of
+// compress_format_version 2 writes before the compressed stream
+void PutCompressorOutputHeader(CompressionType type, const Slice& raw,
+                               std::string* output) {
+  output->clear();
+  if (type != kSnappyCompression && type != kXpressCompression) {
+    compression::PutDecompressedSizeInfo(output,
+                                         static_cast<uint32_t>(raw.size()));
+  }
+}
+
 }  // namespace
 
 // format_version is the block format as defined in include/rocksdb/table.h
@@ -253,6 +265,8 @@ struct BlockBasedTableBuilder::Rep {
   const MutableCFOptions moptions;
   const BlockBasedTableOptions table_options;
   const InternalKeyComparator& internal_comparator;
+  // table_options.index_type, unless unsupported by the comparator
+  const BlockBasedTableOptions::IndexType index_type;
   WritableFileWriter* file;
   std::atomic<uint64_t> offset;
   size_t alignment;
@@ -276,6 +290,14 @@ struct BlockBasedTableBuilder::Rep {
   uint64_t sample_for_compression;
   CompressionOptions compression_opts;
   std::unique_ptr<CompressionDict> compression_dict;
+  // Set when the compression dictionary is shared by the files of the column
+  // family, see `CompressionOptions::shared_dict_retrain_bytes`
+  CompressionDictRegistry* compression_dict_registry;
+  // Data blocks sampled to train the next shared dictionary from
+  std::string shared_dict_samples;
+  std::vector<size_t> shared_dict_sample_lens;
+  // table_options.compressor, if it supports compression_type
+  Compressor* compressor;
   std::vector<std::unique_ptr<CompressionContext>> compression_ctxs;
   std::vector<std::unique_ptr<UncompressionContext>> verify_ctxs;
   std::unique_ptr<UncompressionDict> verify_dict;
@@ -328,6 +350,7 @@ struct BlockBasedTableBuilder::Rep {
   uint64_t oldest_key_time = 0;
   const uint64_t target_file_size;
   uint64_t file_creation_time = 0;
+  Random64 shared_dict_rnd;
 
   // DB IDs
   const std::string db_id;
@@ -413,11 +436,18 @@ struct BlockBasedTableBuilder::Rep {
       const int _level_at_creation, const std::string& _column_family_name,
       const uint64_t _creation_time, const uint64_t _oldest_key_time,
       const uint64_t _target_file_size, const uint64_t _file_creation_time,
-      const std::string& _db_id, const std::string& _db_session_id)
+      const std::string& _db_id, const std::string& _db_session_id,
+      CompressionDictRegistry* _compression_dict_registry)
       : ioptions(_ioptions),
         moptions(_moptions),
         table_options(table_opt),
         internal_comparator(icomparator),
+        index_type(table_opt.index_type ==
+                               BlockBasedTableOptions::kSuccinctTrieSearch &&
+                           icomparator.user_comparator() !=
+                               BytewiseComparator()
+                       ? BlockBasedTableOptions::kBinarySearch
+                       : table_opt.index_type),
         file(f),
         offset(0),
         alignment(table_options.block_align
@@ -430,18 +460,33 @@ struct BlockBasedTableBuilder::Rep {
                            ->CanKeysWithDifferentByteContentsBeEqual()
                        ? BlockBasedTableOptions::kDataBlockBinarySearch
                        : table_options.data_block_index_type,
-                   table_options.data_block_hash_table_util_ratio),
+                   table_options.data_block_hash_table_util_ratio,
+                   table_options.data_block_restart_key_prefixes &&
+                       icomparator.user_comparator() == BytewiseComparator()),
         range_del_block(1 /* block_restart_interval */),
         internal_prefix_transform(_moptions.prefix_extractor.get()),
         compression_type(_compression_type),
         sample_for_compression(_sample_for_compression),
         compression_opts(_compression_opts),
         compression_dict(),
+        compression_dict_registry(
+            _compression_opts.max_dict_bytes > 0 &&
+                    _compression_opts.shared_dict_retrain_bytes > 0
+                ? _compression_dict_registry
+                : nullptr),
+        compressor(table_opt.compressor != nullptr &&
+                           table_opt.format_version >= 2 &&
+                           _compression_type != kNoCompression &&
+                           table_opt.compressor->Supports(_compression_type)
+                       ? table_opt.compressor.get()
+                       : nullptr),
         compression_ctxs(_compression_opts.parallel_threads),
         verify_ctxs(_compression_opts.parallel_threads),
         verify_dict(),
-        state((_compression_opts.max_dict_bytes > 0) ? State::kBuffered
-                                                     : State::kUnbuffered),
+        state((_compression_opts.max_dict_bytes > 0 &&
+               compression_dict_registry == nullptr)
+                  ? State::kBuffered
+                  : State::kUnbuffered),
         use_delta_encoding_for_index_values(table_opt.format_version >= 4 &&
                                             !table_opt.block_align),
         compressed_cache_key_prefix_size(0),
@@ -455,6 +500,7 @@ struct BlockBasedTableBuilder::Rep {
         oldest_key_time(_oldest_key_time),
         target_file_size(_target_file_size),
         file_creation_time(_file_creation_time),
+        shared_dict_rnd(_file_creation_time ^ _column_family_id),
         db_id(_db_id),
         db_session_id(_db_session_id),
         db_host_id(ioptions.db_host_id),
@@ -463,6 +509,19 @@ struct BlockBasedTableBuilder::Rep {
     for (uint32_t i = 0; i < compression_opts.parallel_threads; i++) {
       compression_ctxs[i].reset(new CompressionContext(compression_type));
     }
+    if (compression_dict_registry != nullptr) {
+      // The dictionary is fixed for the whole file, so blocks can be
+      // compressed right away
+      auto dict = compression_dict_registry->GetDict(column_family_id);
+      if (dict != nullptr) {
+        compression_dict.reset(new CompressionDict(
+            dict->raw, compression_type, compression_opts.level));
+        verify_dict.reset(new UncompressionDict(
+            dict->raw, compression_type == kZSTD ||
+                           compression_type == kZSTDNotFinalCompression));
+        props.compression_dict_id = dict->id;
+      }
+    }
     if (table_options.index_type ==
         BlockBasedTableOptions::kTwoLevelIndexSearch) {
       p_index_builder_ = PartitionedIndexBuilder::CreateIndexBuilder(
@@ -471,9 +530,8 @@ struct BlockBasedTableBuilder::Rep {
       index_builder.reset(p_index_builder_);
     } else {
       index_builder.reset(IndexBuilder::CreateIndexBuilder(
-          table_options.index_type, &internal_comparator,
-          &this->internal_prefix_transform, use_delta_encoding_for_index_values,
-          table_options));
+          index_type, &internal_comparator, &this->internal_prefix_transform,
+          use_delta_encoding_for_index_values, table_options));
     }
     if (skip_filters) {
       filter_builder = nullptr;
@@ -483,6 +541,7 @@ struct BlockBasedTableBuilder::Rep {
       context.compaction_style = ioptions.compaction_style;
       context.level_at_creation = level_at_creation;
       context.info_log = ioptions.info_log;
+      context.parallel_threads = compression_opts.parallel_threads;
       filter_builder.reset(CreateFilterBlockBuilder(
           ioptions, moptions, context, use_delta_encoding_for_index_values,
           p_index_builder_));
@@ -493,7 +552,7 @@ struct BlockBasedTableBuilder::Rep {
     }
     table_properties_collectors.emplace_back(
         new BlockBasedTablePropertiesCollector(
-            table_options.index_type, table_options.whole_key_filtering,
+            index_type, table_options.whole_key_filtering,
             _moptions.prefix_extractor != nullptr));
     if (table_options.verify_compression) {
       for (uint32_t i = 0; i < compression_opts.parallel_threads; i++) {
@@ -840,7 +899,8 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
     const std::string& column_family_name, const int level_at_creation,
     const uint64_t creation_time, const uint64_t oldest_key_time,
     const uint64_t target_file_size, const uint64_t file_creation_time,
-    const std::string& db_id, const std::string& db_session_id) {
+    const std::string& db_id, const std::string& db_session_id,
+    CompressionDictRegistry* compression_dict_registry) {
   BlockBasedTableOptions sanitized_table_options(table_options);
   int_tbl_prop_collector_factories_ = int_tbl_prop_collector_factories;
   if (sanitized_table_options.format_version == 0 &&
@@ -860,7 +920,8 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
       int_tbl_prop_collector_factories, column_family_id, file,
       compression_type, sample_for_compression, compression_opts, skip_filters,
       level_at_creation, column_family_name, creation_time, oldest_key_time,
-      target_file_size, file_creation_time, db_id, db_session_id);
+      target_file_size, file_creation_time, db_id, db_session_id,
+      compression_dict_registry);
 
   if (rep_->filter_builder != nullptr) {
     rep_->filter_builder->StartBlock(0);
@@ -991,7 +1052,7 @@ void BlockBasedTableBuilder::Flush() {
   if (r->data_block.empty()) return;
   if (r->IsParallelCompressionEnabled() &&
       r->state == Rep::State::kUnbuffered) {
-    r->data_block.Finish();
+    MaybeSampleForSharedDict(r->data_block.Finish());
     ParallelCompressionRep::BlockRep* block_rep = r->pc_rep->PrepareBlock(
         r->compression_type, r->first_key_in_next_block, &(r->data_block));
     assert(block_rep != nullptr);
@@ -1023,6 +1084,9 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
     r->data_begin_offset += r->data_block_and_keys_buffers.back().first.size();
     return;
   }
+  if (is_data_block) {
+    MaybeSampleForSharedDict(raw_block_contents);
+  }
   Status compress_status;
   CompressAndVerifyBlock(raw_block_contents, is_data_block,
                          *(r->compression_ctxs[0]), r->verify_ctxs[0].get(),
@@ -1043,26 +1107,124 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   }
 }
 
+void BlockBasedTableBuilder::MaybeSampleForSharedDict(
+    const Slice& raw_block_contents) {
+  Rep* r = rep_;
+  if (r->compression_dict_registry == nullptr) {
+    return;
+  }
+  // Sampling every block with this probability collects about the sample
+  // bytes of the column family per retraining period
+  const size_t kSampleBytes =
+      CompressionDictRegistry::SampleBytes(r->compression_opts);
+  const uint64_t retrain_bytes = r->compression_opts.shared_dict_retrain_bytes;
+  if (r->shared_dict_rnd.Uniform(retrain_bytes) < kSampleBytes) {
+    size_t copy_len = std::min(kSampleBytes, raw_block_contents.size());
+    r->shared_dict_samples.append(raw_block_contents.data(), copy_len);
+    r->shared_dict_sample_lens.push_back(copy_len);
+  }
+}
+
 void BlockBasedTableBuilder::BGWorkCompression(
     const CompressionContext& compression_ctx,
     UncompressionContext* verify_ctx) {
   ParallelCompressionRep::BlockRep* block_rep = nullptr;
+  std::vector<ParallelCompressionRep::BlockRep*> batch;
+  std::vector<Compressor::Block> offloaded;
   while (rep_->pc_rep->compress_queue.pop(block_rep)) {
     assert(block_rep != nullptr);
-    CompressAndVerifyBlock(block_rep->contents, true, /* is_data_block*/
-                           compression_ctx, verify_ctx,
-                           block_rep->compressed_data.get(),
-                           &block_rep->compressed_contents,
-                           &(block_rep->compression_type), &block_rep->status);
-    block_rep->slot->Fill(block_rep);
+    batch.assign(1, block_rep);
+    offloaded.clear();
+    if (UseCompressor(true /* is_data_block */)) {
+      // Submit the blocks waiting to be compressed together
+      while (rep_->pc_rep->compress_queue.tryPop(block_rep)) {
+        batch.push_back(block_rep);
+      }
+      offloaded.resize(batch.size());
+      for (size_t i = 0; i < batch.size(); i++) {
+        offloaded[i].input = batch[i]->contents;
+        offloaded[i].output = batch[i]->compressed_data.get();
+        offloaded[i].status = Status::OK();
+      }
+      OffloadCompression(&offloaded);
+    }
+    for (size_t i = 0; i < batch.size(); i++) {
+      block_rep = batch[i];
+      CompressAndVerifyBlock(
+          block_rep->contents, true, /* is_data_block*/
+          compression_ctx, verify_ctx, block_rep->compressed_data.get(),
+          &block_rep->compressed_contents, &(block_rep->compression_type),
+          &block_rep->status, offloaded.empty() ? nullptr : &offloaded[i]);
+      block_rep->slot->Fill(block_rep);
+    }
+  }
+}
+
+void BlockBasedTableBuilder::OffloadCompression(
+    std::vector<Compressor::Block>* offloaded) {
+  Rep* r = rep_;
+  for (auto& block : *offloaded) {
+    PutCompressorOutputHeader(r->compression_type, block.input, block.output);
+  }
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  r->compressor->CompressAsync(r->compression_type, r->compression_opts,
+                               offloaded, [&]() {
+                                 std::lock_guard<std::mutex> lock(mutex);
+                                 done = true;
+                                 cv.notify_one();
+                               });
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [&] { return done; });
+}
+
+bool BlockBasedTableBuilder::UseCompressor(bool is_data_block) const {
+  const Rep* r = rep_;
+  // Compressors do not take dictionaries
+  return r->compressor != nullptr &&
+         (!is_data_block || r->compression_dict == nullptr ||
+          r->compression_dict->GetRawDict().empty());
+}
+
+bool BlockBasedTableBuilder::CompressWithCompressor(
+    const Slice& raw_block_contents, const Compressor::Block* offloaded,
+    std::string* compressed_output, Slice* block_contents,
+    CompressionType* type) {
+  Rep* r = rep_;
+  Status s;
+  if (offloaded != nullptr) {
+    assert(offloaded->output == compressed_output);
+    s = offloaded->status;
+  } else {
+    PutCompressorOutputHeader(*type, raw_block_contents, compressed_output);
+    s = r->compressor->Compress(*type, r->compression_opts, raw_block_contents,
+                                compressed_output);
+  }
+  if (!s.ok()) {
+    ROCKS_LOG_DEBUG(r->ioptions.info_log,
+                    "Compressor %s failed, compressing in software: %s",
+                    r->compressor->Name(), s.ToString().c_str());
+    compressed_output->clear();
+    return false;
+  }
+  // Like CompressBlock(), keep the block uncompressed if it does not pay
+  if (!GoodCompressionRatio(compressed_output->size(),
+                            raw_block_contents.size())) {
+    *type = kNoCompression;
+    *block_contents = raw_block_contents;
+  } else {
+    *block_contents = *compressed_output;
   }
+  return true;
 }
 
 void BlockBasedTableBuilder::CompressAndVerifyBlock(
     const Slice& raw_block_contents, bool is_data_block,
     const CompressionContext& compression_ctx, UncompressionContext* verify_ctx,
     std::string* compressed_output, Slice* block_contents,
-    CompressionType* type, Status* out_status) {
+    CompressionType* type, Status* out_status,
+    const Compressor::Block* offloaded) {
   // File format contains a sequence of blocks where each block has:
   //    block_data: uint8[n]
   //    type: uint8
@@ -1095,10 +1257,14 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
 
     std::string sampled_output_fast;
     std::string sampled_output_slow;
-    *block_contents = CompressBlock(
-        raw_block_contents, compression_info, type,
-        r->table_options.format_version, is_data_block /* do_sample */,
-        compressed_output, &sampled_output_fast, &sampled_output_slow);
+    if (!UseCompressor(is_data_block) ||
+        !CompressWithCompressor(raw_block_contents, offloaded,
+                                compressed_output, block_contents, type)) {
+      *block_contents = CompressBlock(
+          raw_block_contents, compression_info, type,
+          r->table_options.format_version, is_data_block /* do_sample */,
+          compressed_output, &sampled_output_fast, &sampled_output_slow);
+    }
 
     // notify collectors on block add
     NotifyCollectTableCollectorsOnBlockAdd(
@@ -1213,6 +1379,13 @@ void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
         XXH64_freeState(state);
         break;
       }
+      case kXXH3: {
+        checksum = Lower32of64(
+            XXH3p_64bits(block_contents.data(), block_contents.size()));
+        // Extend to cover compression type
+        checksum = ModifyChecksumForCompressionType(checksum, trailer[0]);
+        break;
+      }
       default:
         assert(false);
         break;
@@ -1767,6 +1940,11 @@ Status BlockBasedTableBuilder::Finish() {
 //    r->file->ShouldFlushFullBuffer();
     r->file->SetMinMaxKeyAndLevel(r->smallest, r->largest, r->level_at_creation);
   }
+  if (ok() && r->compression_dict_registry != nullptr) {
+    r->compression_dict_registry->AddSamples(
+        r->column_family_id, r->compression_opts, r->props.data_size,
+        r->shared_dict_samples, r->shared_dict_sample_lens);
+  }
   r->state = Rep::State::kClosed;
   r->SetStatus(r->CopyIOStatus());
   Status ret_status = r->CopyStatus();
@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "db/version_edit.h"
+#include "rocksdb/compressor.h"
 #include "rocksdb/flush_block_policy.h"
 #include "rocksdb/listener.h"
 #include "rocksdb/options.h"
@@ -27,6 +28,7 @@ namespace ROCKSDB_NAMESPACE {
 
 class BlockBuilder;
 class BlockHandle;
+class CompressionDictRegistry;
 class WritableFile;
 struct BlockBasedTableOptions;
 
@@ -52,7 +54,8 @@ class BlockBasedTableBuilder : public TableBuilder {
       const uint64_t creation_time = 0, const uint64_t oldest_key_time = 0,
       const uint64_t target_file_size = 0,
       const uint64_t file_creation_time = 0, const std::string& db_id = "",
-      const std::string& db_session_id = "");
+      const std::string& db_session_id = "",
+      CompressionDictRegistry* compression_dict_registry = nullptr);
 
   // No copying allowed
   BlockBasedTableBuilder(const BlockBasedTableBuilder&) = delete;
@@ -117,6 +120,10 @@ class BlockBasedTableBuilder : public TableBuilder {
   // REQUIRES: `rep_->state == kBuffered`
   void EnterUnbuffered();
 
+  // Samples an uncompressed data block to train the shared compression
+  // dictionary of the column family from, if it is shared
+  void MaybeSampleForSharedDict(const Slice& raw_block_contents);
+
   // Call block's Finish() method
   // and then write the compressed block contents to file.
   void WriteBlock(BlockBuilder* block, BlockHandle* handle, bool is_data_block);
@@ -173,7 +180,24 @@ class BlockBasedTableBuilder : public TableBuilder {
                               std::string* compressed_output,
                               Slice* result_block_contents,
                               CompressionType* result_compression_type,
-                              Status* out_status);
+                              Status* out_status,
+                              const Compressor::Block* offloaded = nullptr);
+
+  // Whether blocks are compressed with `BlockBasedTableOptions::compressor`
+  bool UseCompressor(bool is_data_block) const;
+
+  // Compresses the block with `BlockBasedTableOptions::compressor`, unless
+  // offloaded holds the result already. Returns false if the compressor
+  // failed, so the block must be compressed in software.
+  bool CompressWithCompressor(const Slice& raw_block_contents,
+                              const Compressor::Block* offloaded,
+                              std::string* compressed_output,
+                              Slice* result_block_contents,
+                              CompressionType* result_compression_type);
+
+  // Submits a batch of data blocks to `BlockBasedTableOptions::compressor` at
+  // once and waits for them to be compressed
+  void OffloadCompression(std::vector<Compressor::Block>* offloaded);
 
   // Get compressed blocks from BGWorkCompression and write them into SST
   void BGWorkWriteRawBlock();
@@ -177,7 +177,9 @@ static std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
         {"kTwoLevelIndexSearch",
          BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch},
         {"kBinarySearchWithFirstKey",
-         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey}};
+         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey},
+        {"kSuccinctTrieSearch",
+         BlockBasedTableOptions::IndexType::kSuccinctTrieSearch}};
 
 static std::unordered_map<std::string,
                           BlockBasedTableOptions::DataBlockIndexType>
@@ -261,6 +263,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    data_block_hash_table_util_ratio),
           OptionType::kDouble, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"data_block_restart_key_prefixes",
+         {offsetof(struct BlockBasedTableOptions,
+                   data_block_restart_key_prefixes),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"checksum",
          {offsetof(struct BlockBasedTableOptions, checksum),
           OptionType::kChecksumType, OptionVerificationType::kNormal,
@@ -269,6 +276,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct BlockBasedTableOptions, no_block_cache),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"serve_data_blocks_from_mmap",
+         {offsetof(struct BlockBasedTableOptions, serve_data_blocks_from_mmap),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"block_size",
          {offsetof(struct BlockBasedTableOptions, block_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
@@ -281,6 +292,25 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct BlockBasedTableOptions, block_restart_interval),
           OptionType::kInt, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"block_size_per_level",
+         OptionTypeInfo::Vector<size_t>(
+             offsetof(struct BlockBasedTableOptions, block_size_per_level),
+             OptionVerificationType::kNormal, OptionTypeFlags::kNone,
+             {0, OptionType::kSizeT})},
+        {"block_restart_interval_per_level",
+         OptionTypeInfo::Vector<int>(
+             offsetof(struct BlockBasedTableOptions,
+                      block_restart_interval_per_level),
+             OptionVerificationType::kNormal, OptionTypeFlags::kNone,
+             {0, OptionType::kInt})},
+        {"auto_tune_block_size",
+         {offsetof(struct BlockBasedTableOptions, auto_tune_block_size),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"max_auto_tuned_block_size",
+         {offsetof(struct BlockBasedTableOptions, max_auto_tuned_block_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"index_block_restart_interval",
          {offsetof(struct BlockBasedTableOptions, index_block_restart_interval),
           OptionType::kInt, OptionVerificationType::kNormal,
@@ -300,6 +330,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct BlockBasedTableOptions, optimize_filters_for_memory),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"reserve_table_builder_memory",
+         {offsetof(struct BlockBasedTableOptions,
+                   reserve_table_builder_memory),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"filter_policy",
          {offsetof(struct BlockBasedTableOptions, filter_policy),
           OptionType::kUnknown, OptionVerificationType::kByNameAllowFromNull,
@@ -434,6 +469,11 @@ void BlockBasedTableFactory::InitializeOptions() {
   if (table_options_.block_restart_interval < 1) {
     table_options_.block_restart_interval = 1;
   }
+  for (auto& interval : table_options_.block_restart_interval_per_level) {
+    if (interval < 1) {
+      interval = 1;
+    }
+  }
   if (table_options_.index_block_restart_interval < 1) {
     table_options_.index_block_restart_interval = 1;
   }
@@ -469,15 +509,47 @@ Status BlockBasedTableFactory::NewTableReader(
       table_reader_options.largest_seqno,
       table_reader_options.force_direct_prefetch, &tail_prefetch_stats_,
       table_reader_options.block_cache_tracer,
-      table_reader_options.max_file_size_for_l0_meta_pin);
+      table_reader_options.max_file_size_for_l0_meta_pin,
+      table_options_.auto_tune_block_size ? &block_size_tuner_ : nullptr,
+      table_reader_options.prefetched_tail,
+      table_reader_options.block_cache_warmup);
+}
+
+namespace {
+template <typename T>
+T GetPerLevel(const std::vector<T>& per_level, int level, T default_value) {
+  if (level < 0 || per_level.empty()) {
+    return default_value;
+  }
+  return per_level[std::min(static_cast<size_t>(level), per_level.size() - 1)];
 }
+}  // namespace
 
 TableBuilder* BlockBasedTableFactory::NewTableBuilder(
     const TableBuilderOptions& table_builder_options, uint32_t column_family_id,
     WritableFileWriter* file) const {
+  const int level = table_builder_options.level;
+  // The block geometry of the level, if it differs from the default one
+  std::unique_ptr<BlockBasedTableOptions> level_options;
+  if (level >= 0 && (!table_options_.block_size_per_level.empty() ||
+                     !table_options_.block_restart_interval_per_level.empty() ||
+                     table_options_.auto_tune_block_size)) {
+    level_options.reset(new BlockBasedTableOptions(table_options_));
+    level_options->block_size = GetPerLevel(
+        table_options_.block_size_per_level, level, table_options_.block_size);
+    level_options->block_restart_interval =
+        GetPerLevel(table_options_.block_restart_interval_per_level, level,
+                    table_options_.block_restart_interval);
+    if (table_options_.auto_tune_block_size) {
+      level_options->block_size = block_size_tuner_.PickBlockSize(
+          level, level_options->block_size,
+          table_options_.max_auto_tuned_block_size);
+    }
+  }
   auto table_builder = new BlockBasedTableBuilder(
       table_builder_options.ioptions, table_builder_options.moptions,
-      table_options_, table_builder_options.internal_comparator,
+      level_options ? *level_options : table_options_,
+      table_builder_options.internal_comparator,
       table_builder_options.int_tbl_prop_collector_factories, column_family_id,
       file, table_builder_options.compression_type,
       table_builder_options.sample_for_compression,
@@ -488,7 +560,7 @@ TableBuilder* BlockBasedTableFactory::NewTableBuilder(
       table_builder_options.oldest_key_time,
       table_builder_options.target_file_size,
       table_builder_options.file_creation_time, table_builder_options.db_id,
-      table_builder_options.db_session_id);
+      table_builder_options.db_session_id, &compression_dict_registry_);
 
   return table_builder;
 }
@@ -584,6 +656,9 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  data_block_hash_table_util_ratio: %lf\n",
            table_options_.data_block_hash_table_util_ratio);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  data_block_restart_key_prefixes: %d\n",
+           table_options_.data_block_restart_key_prefixes);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  hash_index_allow_collision: %d\n",
            table_options_.hash_index_allow_collision);
   ret.append(buffer);
@@ -592,6 +667,9 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  no_block_cache: %d\n",
            table_options_.no_block_cache);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  serve_data_blocks_from_mmap: %d\n",
+           table_options_.serve_data_blocks_from_mmap);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  block_cache: %p\n",
            static_cast<void*>(table_options_.block_cache.get()));
   ret.append(buffer);
@@ -619,6 +697,10 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
     ret.append("  block_cache_compressed_options:\n");
     ret.append(table_options_.block_cache_compressed->GetPrintableOptions());
   }
+  snprintf(buffer, kBufferSize, "  compressor: %s\n",
+           table_options_.compressor ? table_options_.compressor->Name()
+                                     : "nullptr");
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  persistent_cache: %p\n",
            static_cast<void*>(table_options_.persistent_cache.get()));
   ret.append(buffer);
@@ -636,6 +718,24 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  block_restart_interval: %d\n",
            table_options_.block_restart_interval);
   ret.append(buffer);
+  ret.append("  block_size_per_level:");
+  for (size_t block_size : table_options_.block_size_per_level) {
+    snprintf(buffer, kBufferSize, " %" ROCKSDB_PRIszt, block_size);
+    ret.append(buffer);
+  }
+  ret.append("\n  block_restart_interval_per_level:");
+  for (int interval : table_options_.block_restart_interval_per_level) {
+    snprintf(buffer, kBufferSize, " %d", interval);
+    ret.append(buffer);
+  }
+  ret.append("\n");
+  snprintf(buffer, kBufferSize, "  auto_tune_block_size: %d\n",
+           table_options_.auto_tune_block_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize,
+           "  max_auto_tuned_block_size: %" ROCKSDB_PRIszt "\n",
+           table_options_.max_auto_tuned_block_size);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  index_block_restart_interval: %d\n",
            table_options_.index_block_restart_interval);
   ret.append(buffer);
@@ -645,6 +745,9 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  partition_filters: %d\n",
            table_options_.partition_filters);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  reserve_table_builder_memory: %d\n",
+           table_options_.reserve_table_builder_memory);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  use_delta_encoding: %d\n",
            table_options_.use_delta_encoding);
   ret.append(buffer);
@@ -16,6 +16,8 @@
 #include "db/dbformat.h"
 #include "rocksdb/flush_block_policy.h"
 #include "rocksdb/table.h"
+#include "table/block_based/block_size_tuner.h"
+#include "table/block_based/compression_dict_registry.h"
 
 namespace ROCKSDB_NAMESPACE {
 struct ConfigOptions;
@@ -83,6 +85,8 @@ class BlockBasedTableFactory : public TableFactory {
  private:
   BlockBasedTableOptions table_options_;
   mutable TailPrefetchStats tail_prefetch_stats_;
+  mutable CompressionDictRegistry compression_dict_registry_;
+  mutable BlockSizeTuner block_size_tuner_;
 };
 
 extern const std::string kHashIndexPrefixesBlock;
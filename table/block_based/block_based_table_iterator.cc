@@ -14,6 +14,7 @@ void BlockBasedTableIterator::Seek(const Slice& target) { SeekImpl(&target); }
 void BlockBasedTableIterator::SeekToFirst() { SeekImpl(nullptr); }
 
 void BlockBasedTableIterator::SeekImpl(const Slice* target) {
+  RecordScan();
   is_out_of_bound_ = false;
   is_at_first_key_from_index_ = false;
   if (target && !CheckPrefixMayMatch(*target, IterDirection::kForward)) {
@@ -100,6 +101,7 @@ void BlockBasedTableIterator::SeekImpl(const Slice* target) {
 }
 
 void BlockBasedTableIterator::SeekForPrev(const Slice& target) {
+  RecordScan();
   is_out_of_bound_ = false;
   is_at_first_key_from_index_ = false;
   // For now totally disable prefix seek in auto prefix mode because we don't
@@ -160,6 +162,7 @@ void BlockBasedTableIterator::SeekForPrev(const Slice& target) {
 }
 
 void BlockBasedTableIterator::SeekToLast() {
+  RecordScan();
   is_out_of_bound_ = false;
   is_at_first_key_from_index_ = false;
   SavePrevIndexValue();
@@ -232,9 +235,9 @@ void BlockBasedTableIterator::InitDataBlock() {
     //   Enabled after 2 sequential IOs when ReadOptions.readahead_size == 0.
     // Explicit user requested readahead:
     //   Enabled from the very first IO when ReadOptions.readahead_size is set.
-    block_prefetcher_.PrefetchIfNeeded(rep, data_block_handle,
-                                       read_options_.readahead_size,
-                                       is_for_compaction);
+    block_prefetcher_.PrefetchIfNeeded(
+        rep, data_block_handle, read_options_.readahead_size,
+        is_for_compaction, read_options_.async_io);
 
     Status s;
     table_->NewDataBlockIterator<DataBlockIter>(
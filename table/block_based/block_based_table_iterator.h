@@ -11,6 +11,7 @@
 
 #include "table/block_based/block_based_table_reader_impl.h"
 #include "table/block_based/block_prefetcher.h"
+#include "table/block_based/block_size_tuner.h"
 #include "table/block_based/reader_common.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -218,6 +219,15 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
   void InitDataBlock();
   bool MaterializeCurrentBlock();
   void FindKeyForward();
+  // Counts a seek of a user iterator as a scan of the table's level, see
+  // BlockBasedTableOptions::auto_tune_block_size
+  void RecordScan() {
+    const BlockBasedTable::Rep* rep = table_->get_rep();
+    if (rep->block_size_tuner != nullptr &&
+        lookup_context_.caller == TableReaderCaller::kUserIterator) {
+      rep->block_size_tuner->RecordScan(rep->level);
+    }
+  }
   void FindBlockForward();
   void FindKeyBackward();
   void CheckOutOfBound();
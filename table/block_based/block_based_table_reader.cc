@@ -17,6 +17,7 @@
 
 #include "cache/sharded_cache.h"
 
+#include "db/block_cache_warmup.h"
 #include "db/dbformat.h"
 #include "db/pinned_iterators_manager.h"
 #include "file/file_prefetch_buffer.h"
@@ -45,6 +46,7 @@
 #include "table/block_based/hash_index_reader.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/block_based/partitioned_index_reader.h"
+#include "table/block_based/succinct_trie_index_reader.h"
 #include "table/block_fetcher.h"
 #include "table/format.h"
 #include "table/get_context.h"
@@ -82,6 +84,42 @@ BlockBasedTable::~BlockBasedTable() {
 
 std::atomic<uint64_t> BlockBasedTable::next_cache_key_id_(0);
 
+namespace {
+// Lets data blocks evicted from the block cache be demoted to its secondary
+// cache, if it has one, and rebuilt from there on a later miss.
+struct DataBlockCreateContext {
+  size_t read_amp_bytes_per_bit;
+  Statistics* statistics;
+  MemoryAllocator* memory_allocator;
+};
+
+Slice SaveDataBlock(void* value) {
+  const Block* block = static_cast<Block*>(value);
+  return Slice(block->data(), block->size());
+}
+
+void* CreateDataBlock(const Slice& contents, void* create_context,
+                      size_t* charge) {
+  const DataBlockCreateContext* context =
+      static_cast<DataBlockCreateContext*>(create_context);
+  CacheAllocationPtr buf =
+      AllocateBlock(contents.size(), context->memory_allocator);
+  memcpy(buf.get(), contents.data(), contents.size());
+  Block* block =
+      new Block(BlockContents(std::move(buf), contents.size()),
+                context->read_amp_bytes_per_bit, context->statistics);
+  *charge = block->ApproximateMemoryUsage();
+  return block;
+}
+
+void DeleteDataBlock(const Slice& /*key*/, void* value) {
+  delete static_cast<Block*>(value);
+}
+
+const Cache::CacheItemHelper kDataBlockCacheHelper = {
+    &SaveDataBlock, &CreateDataBlock, &DeleteDataBlock};
+}  // namespace
+
 template <typename TBlocklike>
 class BlocklikeTraits;
 
@@ -99,6 +137,11 @@ class BlocklikeTraits<BlockContents> {
   static uint32_t GetNumRestarts(const BlockContents& /* contents */) {
     return 0;
   }
+
+  static const Cache::CacheItemHelper* GetCacheItemHelper(
+      BlockType /* block_type */) {
+    return nullptr;
+  }
 };
 
 template <>
@@ -115,6 +158,11 @@ class BlocklikeTraits<ParsedFullFilterBlock> {
   static uint32_t GetNumRestarts(const ParsedFullFilterBlock& /* block */) {
     return 0;
   }
+
+  static const Cache::CacheItemHelper* GetCacheItemHelper(
+      BlockType /* block_type */) {
+    return nullptr;
+  }
 };
 
 template <>
@@ -129,6 +177,11 @@ class BlocklikeTraits<Block> {
   static uint32_t GetNumRestarts(const Block& block) {
     return block.NumRestarts();
   }
+
+  static const Cache::CacheItemHelper* GetCacheItemHelper(
+      BlockType block_type) {
+    return block_type == BlockType::kData ? &kDataBlockCacheHelper : nullptr;
+  }
 };
 
 template <>
@@ -146,6 +199,11 @@ class BlocklikeTraits<UncompressionDict> {
   static uint32_t GetNumRestarts(const UncompressionDict& /* dict */) {
     return 0;
   }
+
+  static const Cache::CacheItemHelper* GetCacheItemHelper(
+      BlockType /* block_type */) {
+    return nullptr;
+  }
 };
 
 namespace {
@@ -189,6 +247,24 @@ void DeleteCachedEntry(const Slice& /*key*/, void* value) {
   delete entry;
 }
 
+// Insert a block into the block cache, letting the cache demote it to its
+// secondary cache on eviction if the block type supports that.
+template <typename TBlocklike>
+Status InsertBlockToCache(Cache* block_cache, const Slice& key,
+                          TBlocklike* block, BlockType block_type,
+                          size_t charge, Cache::Handle** cache_handle,
+                          Cache::Priority priority) {
+  const Cache::CacheItemHelper* helper =
+      BlocklikeTraits<TBlocklike>::GetCacheItemHelper(block_type);
+  if (helper != nullptr) {
+    return block_cache->InsertWithHelper(key, block, helper, charge,
+                                         cache_handle, priority);
+  }
+  return block_cache->Insert(key, block, charge,
+                             &DeleteCachedEntry<TBlocklike>, cache_handle,
+                             priority);
+}
+
 // Release the cached entry and decrement its ref count.
 // Do not force erase
 void ReleaseCachedEntry(void* arg, void* h) {
@@ -433,8 +509,16 @@ void BlockBasedTable::UpdateCacheInsertionMetrics(BlockType block_type,
 
 Cache::Handle* BlockBasedTable::GetEntryFromCache(
     Cache* block_cache, const Slice& key, BlockType block_type,
-    GetContext* get_context) const {
-  auto cache_handle = block_cache->Lookup(key, rep_->ioptions.statistics);
+    GetContext* get_context, const Cache::CacheItemHelper* helper,
+    void* create_context) const {
+  Cache::Handle* cache_handle;
+  if (helper != nullptr) {
+    cache_handle = block_cache->LookupWithHelper(key, helper, create_context,
+                                                 Cache::Priority::LOW,
+                                                 rep_->ioptions.statistics);
+  } else {
+    cache_handle = block_cache->Lookup(key, rep_->ioptions.statistics);
+  }
 
   if (cache_handle != nullptr) {
     UpdateCacheHitMetrics(block_type, get_context,
@@ -588,7 +672,8 @@ Status BlockBasedTable::Open(
     const SequenceNumber largest_seqno, const bool force_direct_prefetch,
     TailPrefetchStats* tail_prefetch_stats,
     BlockCacheTracer* const block_cache_tracer,
-    size_t max_file_size_for_l0_meta_pin) {
+    size_t max_file_size_for_l0_meta_pin, BlockSizeTuner* block_size_tuner,
+    const Slice& prefetched_tail, BlockCacheWarmup* block_cache_warmup) {
   table_reader->reset();
 
   Status s;
@@ -608,7 +693,18 @@ Status BlockBasedTable::Open(
   const bool prefetch_all = prefetch_index_and_filter_in_cache || level == 0;
   const bool preload_all = !table_options.cache_index_and_filter_blocks;
 
-  if (!ioptions.allow_mmap_reads) {
+  if (ioptions.allow_mmap_reads) {
+    // Should not prefetch for mmap mode.
+    prefetch_buffer.reset(new FilePrefetchBuffer(
+        nullptr, 0, 0, false /* enable */, true /* track_min_offset */));
+  } else if (!prefetched_tail.empty() && prefetched_tail.size() <= file_size) {
+    // The metadata blocks read below are verified against their checksums
+    // as if read from the file, which is read for whatever the tail lacks
+    prefetch_buffer.reset(new FilePrefetchBuffer(
+        nullptr, 0, 0, true /* enable */, true /* track_min_offset */));
+    prefetch_buffer->Fill(file_size - prefetched_tail.size(), prefetched_tail);
+    RecordTick(ioptions.statistics, TABLE_OPEN_PREFETCHED_TAIL_HIT);
+  } else {
     s = PrefetchTail(ro, file.get(), file_size, force_direct_prefetch,
                      tail_prefetch_stats, prefetch_all, preload_all,
                      &prefetch_buffer);
@@ -616,10 +712,6 @@ Status BlockBasedTable::Open(
     if (!s.ok()) {
       return s;
     }
-  } else {
-    // Should not prefetch for mmap mode.
-    prefetch_buffer.reset(new FilePrefetchBuffer(
-        nullptr, 0, 0, false /* enable */, true /* track_min_offset */));
   }
 
   // Read in the following order:
@@ -655,6 +747,11 @@ Status BlockBasedTable::Open(
                                       file_size, level, immortal_table);
   rep->file = std::move(file);
   rep->footer = footer;
+  rep->block_size_tuner = block_size_tuner;
+  if (block_cache_warmup != nullptr) {
+    rep->block_cache_warmup = block_cache_warmup;
+    rep->file_number = TableFileNameToNumber(rep->file->file_name());
+  }
   rep->hash_index_allow_collision = table_options.hash_index_allow_collision;
   // We need to wrap data with internal_prefix_transform to make sure it can
   // handle prefix correctly.
@@ -713,6 +810,8 @@ Status BlockBasedTable::Open(
       tail_prefetch_stats->RecordEffectiveSize(
           static_cast<size_t>(file_size) - prefetch_buffer->min_offset_read());
     }
+    rep->tail_start_offset =
+        std::min<uint64_t>(prefetch_buffer->min_offset_read(), file_size);
 
     *table_reader = std::move(new_table);
   }
@@ -856,6 +955,9 @@ Status BlockBasedTable::ReadPropertiesBlock(
                CompressionTypeToString(kZSTD) ||
            rep_->table_properties->compression_name ==
                CompressionTypeToString(kZSTDNotFinalCompression));
+      rep_->data_blocks_from_mmap =
+          rep_->table_options.serve_data_blocks_from_mmap &&
+          rep_->ioptions.allow_mmap_reads && !rep_->blocks_maybe_compressed;
     }
   } else {
     ROCKS_LOG_ERROR(rep_->ioptions.info_log,
@@ -1194,8 +1296,13 @@ Status BlockBasedTable::GetDataBlockFromCache(
 
   // Lookup uncompressed cache first
   if (block_cache != nullptr) {
-    auto cache_handle = GetEntryFromCache(block_cache, block_cache_key,
-                                          block_type, get_context);
+    DataBlockCreateContext create_context{
+        read_amp_bytes_per_bit, rep_->ioptions.statistics,
+        GetMemoryAllocator(rep_->table_options)};
+    auto cache_handle = GetEntryFromCache(
+        block_cache, block_cache_key, block_type, get_context,
+        BlocklikeTraits<TBlocklike>::GetCacheItemHelper(block_type),
+        &create_context);
     if (cache_handle != nullptr) {
       block->SetCachedValue(
           reinterpret_cast<TBlocklike*>(block_cache->Value(cache_handle)),
@@ -1252,8 +1359,9 @@ Status BlockBasedTable::GetDataBlockFromCache(
         read_options.fill_cache) {
       size_t charge = block_holder->ApproximateMemoryUsage();
       Cache::Handle* cache_handle = nullptr;
-      s = block_cache->Insert(block_cache_key, block_holder.get(), charge,
-                              &DeleteCachedEntry<TBlocklike>, &cache_handle);
+      s = InsertBlockToCache(block_cache, block_cache_key, block_holder.get(),
+                             block_type, charge, &cache_handle,
+                             Cache::Priority::LOW);
       if (s.ok()) {
         assert(cache_handle != nullptr);
         block->SetCachedValue(block_holder.release(), block_cache,
@@ -1357,9 +1465,8 @@ Status BlockBasedTable::PutDataBlockToCache(
   if (block_cache != nullptr && block_holder->own_bytes()) {
     size_t charge = block_holder->ApproximateMemoryUsage();
     Cache::Handle* cache_handle = nullptr;
-    s = block_cache->Insert(block_cache_key, block_holder.get(), charge,
-                            &DeleteCachedEntry<TBlocklike>, &cache_handle,
-                            priority);
+    s = InsertBlockToCache(block_cache, block_cache_key, block_holder.get(),
+                           block_type, charge, &cache_handle, priority);
     if (s.ok()) {
       assert(cache_handle != nullptr);
       cached_block->SetCachedValue(block_holder.release(), block_cache,
@@ -1551,6 +1658,12 @@ Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
     }
   }
 
+  if (rep_->block_cache_warmup != nullptr && block_type == BlockType::kData &&
+      block_entry->GetCacheHandle() != nullptr) {
+    rep_->block_cache_warmup->Record(rep_->file_number, handle.offset(),
+                                     handle.size(), is_cache_hit);
+  }
+
   // Fill lookup_context.
   if (block_cache_tracer_ && block_cache_tracer_->is_tracing_enabled() &&
       lookup_context) {
@@ -1902,7 +2015,9 @@ Status BlockBasedTable::RetrieveBlock(
   assert(block_entry->IsEmpty());
 
   Status s;
-  if (use_cache) {
+  // Uncompressed data blocks of a memory-mapped file are used in place
+  if (use_cache &&
+      !(block_type == BlockType::kData && rep_->data_blocks_from_mmap)) {
     s = MaybeReadBlockAndLoadToCache(prefetch_buffer, ro, handle,
                                      uncompression_dict, block_entry,
                                      block_type, get_context, lookup_context,
@@ -2280,10 +2395,27 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
                             GetContext* get_context,
                             const SliceTransform* prefix_extractor,
                             bool skip_filters) {
+  if (InstrumentationEnabled(rep_->ioptions.statistics)) {
+    return GetImpl<true>(read_options, key, get_context, prefix_extractor,
+                         skip_filters);
+  }
+  return GetImpl<false>(read_options, key, get_context, prefix_extractor,
+                        skip_filters);
+}
+
+template <bool kInstrumented>
+Status BlockBasedTable::GetImpl(const ReadOptions& read_options,
+                                const Slice& key, GetContext* get_context,
+                                const SliceTransform* prefix_extractor,
+                                bool skip_filters) {
   assert(key.size() >= 8);  // key must be internal key
   assert(get_context != nullptr);
+  Statistics* const stats = kInstrumented ? rep_->ioptions.statistics : nullptr;
   Status s;
   const bool no_io = read_options.read_tier == kBlockCacheTier;
+  if (rep_->block_size_tuner != nullptr) {
+    rep_->block_size_tuner->RecordPointLookups(rep_->level, 1);
+  }
 
   FilterBlockReader* const filter =
       !skip_filters ? rep_->filter.get() : nullptr;
@@ -2306,8 +2438,9 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
                             get_context, &lookup_context);
   TEST_SYNC_POINT("BlockBasedTable::Get:AfterFilterMatch");
   if (!may_match) {
-    RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
-    PERF_COUNTER_BY_LEVEL_ADD(bloom_filter_useful, 1, rep_->level);
+    RecordTick(stats, BLOOM_FILTER_USEFUL);
+    PERF_COUNTER_BY_LEVEL_ADD_IF(kInstrumented, bloom_filter_useful, 1,
+                                 rep_->level);
   } else {
     IndexBlockIter iiter_on_stack;
     // if prefix_extractor found in block differs from options, disable
@@ -2343,8 +2476,9 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
         // Not found
         // TODO: think about interaction with Merge. If a user key cannot
         // cross one data block, we should be fine.
-        RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
-        PERF_COUNTER_BY_LEVEL_ADD(bloom_filter_useful, 1, rep_->level);
+        RecordTick(stats, BLOOM_FILTER_USEFUL);
+        PERF_COUNTER_BY_LEVEL_ADD_IF(kInstrumented, bloom_filter_useful, 1,
+                                     rep_->level);
         break;
       }
 
@@ -2448,9 +2582,10 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
       }
     }
     if (matched && filter != nullptr && !filter->IsBlockBased()) {
-      RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_FULL_TRUE_POSITIVE);
-      PERF_COUNTER_BY_LEVEL_ADD(bloom_filter_full_true_positive, 1,
-                                rep_->level);
+      RecordTick(stats, BLOOM_FILTER_FULL_TRUE_POSITIVE);
+      PERF_COUNTER_BY_LEVEL_ADD_IF(kInstrumented,
+                                   bloom_filter_full_true_positive, 1,
+                                   rep_->level);
     }
     if (s.ok() && !iiter->status().IsNotFound()) {
       s = iiter->status();
@@ -2470,6 +2605,10 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
     assert(false);
     return;  // Nothing to do
   }
+  if (rep_->block_size_tuner != nullptr) {
+    rep_->block_size_tuner->RecordPointLookups(rep_->level,
+                                               mget_range->KeysLeft());
+  }
 
   FilterBlockReader* const filter =
       !skip_filters ? rep_->filter.get() : nullptr;
@@ -2639,6 +2778,11 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
     DataBlockIter first_biter;
     DataBlockIter next_biter;
     size_t idx_in_batch = 0;
+    // The hash index entries of the keys [probe_begin, probe_end) of the
+    // batch, which all look up the block of first_biter first
+    uint8_t hash_entries[MultiGetContext::MAX_BATCH_SIZE];
+    size_t probe_begin = 0;
+    size_t probe_end = 0;
     for (auto miter = sst_file_range.begin(); miter != sst_file_range.end();
          ++miter) {
       Status s;
@@ -2647,6 +2791,7 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
       bool matched = false;  // if such user key matched a key in SST
       bool done = false;
       bool first_block = true;
+      const size_t key_idx = idx_in_batch;
       do {
         DataBlockIter* biter = nullptr;
         bool reusing_block = true;
@@ -2664,6 +2809,31 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
                 read_options, results[idx_in_batch], &first_biter,
                 statuses[idx_in_batch]);
             reusing_block = false;
+            probe_begin = probe_end = idx_in_batch;
+            if (first_biter.status().ok()) {
+              // Probe the hash index for all the keys that reuse the block
+              Slice probe_keys[MultiGetContext::MAX_BATCH_SIZE];
+              size_t num_probe_keys = 0;
+              size_t max_probe_keys = std::min<size_t>(
+                  block_handles.size(),
+                  MultiGetContext::MAX_BATCH_SIZE) - idx_in_batch;
+              for (auto it = miter; it != sst_file_range.end(); ++it) {
+                if (num_probe_keys == max_probe_keys) {
+                  break;
+                }
+                size_t j = idx_in_batch + num_probe_keys;
+                if (j > idx_in_batch && (!block_handles[j].IsNull() ||
+                                         !results[j].IsEmpty())) {
+                  break;
+                }
+                probe_keys[num_probe_keys++] = it->ikey;
+              }
+              if (num_probe_keys > 1 &&
+                  first_biter.ProbeHashIndex(probe_keys, num_probe_keys,
+                                             hash_entries + idx_in_batch)) {
+                probe_end = idx_in_batch + num_probe_keys;
+              }
+            }
           } else {
             // If handler is null and result is empty, then the status is never
             // set, which should be the initial value: ok().
@@ -2704,7 +2874,10 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
           break;
         }
 
-        bool may_exist = biter->SeekForGet(key);
+        bool may_exist =
+            first_block && key_idx >= probe_begin && key_idx < probe_end
+                ? biter->SeekForGet(key, hash_entries[key_idx])
+                : biter->SeekForGet(key);
         if (!may_exist) {
           // HashSeek cannot find the key this block and the the iter is not
           // the end of the block, i.e. cannot be in the following blocks
@@ -2866,6 +3039,156 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
   return Status::OK();
 }
 
+Status BlockBasedTable::ReadMetadataTail(std::string* tail) {
+  if (rep_->tail_start_offset >= rep_->file_size) {
+    return Status::NotSupported("No metadata was read from the file");
+  }
+  const size_t n =
+      static_cast<size_t>(rep_->file_size - rep_->tail_start_offset);
+  std::unique_ptr<char[]> scratch(new char[n]);
+  Slice result;
+  Status s = rep_->file->Read(IOOptions(), rep_->tail_start_offset, n,
+                              &result, scratch.get(), nullptr);
+  if (s.ok() && result.size() != n) {
+    s = Status::Corruption("Truncated table file tail",
+                           rep_->file->file_name());
+  }
+  if (s.ok()) {
+    tail->assign(result.data(), result.size());
+  }
+  return s;
+}
+
+Status BlockBasedTable::LoadBlocksIntoCache(
+    const ReadOptions& read_options, const std::vector<BlockHandle>& handles,
+    size_t* num_loaded) {
+  *num_loaded = 0;
+  if (rep_->table_options.block_cache == nullptr &&
+      rep_->table_options.block_cache_compressed == nullptr) {
+    return Status::NotSupported("No block cache");
+  }
+  if (rep_->data_blocks_from_mmap) {
+    return Status::NotSupported("Data blocks are read in place");
+  }
+  BlockCacheLookupContext lookup_context{TableReaderCaller::kPrefetch};
+  CachableEntry<UncompressionDict> uncompression_dict;
+  if (rep_->uncompression_dict_reader) {
+    Status s =
+        rep_->uncompression_dict_reader->GetOrReadUncompressionDictionary(
+            nullptr /* prefetch_buffer */, false /* no_io */,
+            nullptr /* get_context */, &lookup_context, &uncompression_dict);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  const UncompressionDict& dict = uncompression_dict.GetValue()
+                                      ? *uncompression_dict.GetValue()
+                                      : UncompressionDict::GetEmptyDict();
+
+  // The blocks cached already are not read
+  ReadOptions lookup_options(read_options);
+  lookup_options.read_tier = kBlockCacheTier;
+  std::vector<BlockHandle> to_read;
+  size_t total_len = 0;
+  for (const BlockHandle& handle : handles) {
+    if (handle.offset() + block_size(handle) > rep_->file_size) {
+      return Status::Corruption("Block handle beyond the end of the file",
+                                rep_->file->file_name());
+    }
+    CachableEntry<Block> block;
+    MaybeReadBlockAndLoadToCache(nullptr /* prefetch_buffer */,
+                                 lookup_options, handle, dict, &block,
+                                 BlockType::kData, nullptr /* get_context */,
+                                 &lookup_context, nullptr /* contents */)
+        .PermitUncheckedError();
+    if (block.GetValue() == nullptr) {
+      to_read.push_back(handle);
+      total_len += static_cast<size_t>(block_size(handle));
+    }
+  }
+  if (to_read.empty()) {
+    return Status::OK();
+  }
+
+  // Adjacent blocks are read together, except with direct I/O, which
+  // realigns and merges the reads itself
+  RandomAccessFileReader* file = rep_->file.get();
+  const bool direct_io = file->use_direct_io();
+  std::unique_ptr<char[]> scratch;
+  if (!direct_io) {
+    scratch.reset(new char[total_len]);
+  }
+  std::vector<FSReadRequest> read_reqs;
+  std::vector<size_t> req_idx_for_block;
+  size_t buf_offset = 0;
+  for (const BlockHandle& handle : to_read) {
+    if (!direct_io && !read_reqs.empty() &&
+        read_reqs.back().offset + read_reqs.back().len == handle.offset()) {
+      read_reqs.back().len += static_cast<size_t>(block_size(handle));
+    } else {
+      FSReadRequest req;
+      req.offset = handle.offset();
+      req.len = static_cast<size_t>(block_size(handle));
+      req.scratch = direct_io ? nullptr : scratch.get() + buf_offset;
+      read_reqs.push_back(req);
+    }
+    buf_offset += static_cast<size_t>(block_size(handle));
+    req_idx_for_block.push_back(read_reqs.size() - 1);
+  }
+
+  AlignedBuf direct_io_buf;
+  IOOptions opts;
+  Status s = PrepareIOFromReadOptions(read_options, file->env(), opts);
+  if (s.ok()) {
+    s = file->MultiRead(opts, read_reqs.data(), read_reqs.size(),
+                        &direct_io_buf);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  MemoryAllocator* memory_allocator = GetMemoryAllocator(rep_->table_options);
+  for (size_t i = 0; i < to_read.size(); i++) {
+    const BlockHandle& handle = to_read[i];
+    const FSReadRequest& req = read_reqs[req_idx_for_block[i]];
+    const size_t offset_in_req =
+        static_cast<size_t>(handle.offset() - req.offset);
+    s = req.status;
+    if (s.ok() && offset_in_req + block_size(handle) > req.result.size()) {
+      s = Status::Corruption("truncated block read from " +
+                             file->file_name() + " offset " +
+                             ToString(handle.offset()));
+    }
+    if (s.ok() && read_options.verify_checksums) {
+      s = ROCKSDB_NAMESPACE::VerifyBlockChecksum(
+          rep_->footer.checksum(), req.result.data() + offset_in_req,
+          handle.size(), file->file_name(), handle.offset());
+    }
+    if (!s.ok()) {
+      return s;
+    }
+    // Copied out of the buffer shared by the blocks, for the cache to own
+    Slice raw(req.result.data() + offset_in_req, block_size(handle));
+    BlockContents raw_block_contents(
+        CopyBufferToHeap(memory_allocator, raw), handle.size());
+#ifndef NDEBUG
+    raw_block_contents.is_raw_block = true;
+#endif
+    CachableEntry<Block> block;
+    s = MaybeReadBlockAndLoadToCache(
+        nullptr /* prefetch_buffer */, read_options, handle, dict, &block,
+        BlockType::kData, nullptr /* get_context */, &lookup_context,
+        &raw_block_contents);
+    if (!s.ok()) {
+      return s;
+    }
+    if (block.GetValue() != nullptr) {
+      (*num_loaded)++;
+    }
+  }
+  return Status::OK();
+}
+
 Status BlockBasedTable::VerifyChecksum(const ReadOptions& read_options,
                                        TableReaderCaller caller) {
   Status s;
@@ -3074,6 +3397,11 @@ Status BlockBasedTable::CreateIndexReader(
                                              use_cache, prefetch, pin,
                                              lookup_context, index_reader);
     }
+    case BlockBasedTableOptions::kSuccinctTrieSearch: {
+      return SuccinctTrieIndexReader::Create(this, ro, prefetch_buffer,
+                                             use_cache, prefetch, pin,
+                                             lookup_context, index_reader);
+    }
     case BlockBasedTableOptions::kHashSearch: {
       std::unique_ptr<Block> metaindex_guard;
       std::unique_ptr<InternalIterator> metaindex_iter_guard;
@@ -3209,6 +3537,51 @@ uint64_t BlockBasedTable::ApproximateSize(const Slice& start, const Slice& end,
                                static_cast<double>(rep_->file_size));
 }
 
+Status BlockBasedTable::ApproximateKeyAnchors(const ReadOptions& read_options,
+                                              std::vector<Anchor>* anchors) {
+  assert(anchors != nullptr);
+  BlockCacheLookupContext context(TableReaderCaller::kCompaction);
+  IndexBlockIter iiter_on_stack;
+  auto index_iter =
+      NewIndexIterator(read_options, /*disable_prefix_seek=*/true,
+                       /*input_iter=*/&iiter_on_stack, /*get_context=*/nullptr,
+                       /*lookup_context=*/&context);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (index_iter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(index_iter);
+  }
+
+  // Every index entry is the last key of a data block, or a separator after
+  // it, so take one in every num_data_blocks / kMaxNumAnchors entries, and
+  // the last one
+  uint64_t num_blocks = rep_->table_properties
+                            ? rep_->table_properties->num_data_blocks
+                            : 0;
+  uint64_t step = std::max<uint64_t>(
+      1, (num_blocks + kMaxNumAnchors - 1) / kMaxNumAnchors);
+  uint64_t prev_offset = 0;
+  uint64_t count = 0;
+  std::string last_key;
+  uint64_t last_offset = 0;
+  for (index_iter->SeekToFirst(); index_iter->Valid(); index_iter->Next()) {
+    const BlockHandle& handle = index_iter->value().handle;
+    last_offset = handle.offset() + handle.size();
+    if (++count % step == 0) {
+      anchors->emplace_back(index_iter->user_key(), last_offset - prev_offset);
+      prev_offset = last_offset;
+    } else {
+      last_key = index_iter->user_key().ToString();
+    }
+  }
+  if (!index_iter->status().ok()) {
+    return index_iter->status();
+  }
+  if (last_offset > prev_offset) {
+    anchors->emplace_back(last_key, last_offset - prev_offset);
+  }
+  return Status::OK();
+}
+
 bool BlockBasedTable::TEST_FilterBlockInCache() const {
   assert(rep_ != nullptr);
   return TEST_BlockInCache(rep_->filter_handle);
@@ -24,6 +24,8 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class BlockCacheWarmup;
+class BlockSizeTuner;
 class Cache;
 class FilterBlockReader;
 class BlockBasedFilterBlockReader;
@@ -87,6 +89,10 @@ class BlockBasedTable : public TableReader {
   //    are set.
   // @param force_direct_prefetch if true, always prefetching to RocksDB
   //    buffer, rather than calling RandomAccessFile::Prefetch().
+  // @param prefetched_tail the last bytes of the file, from an earlier
+  //    ReadMetadataTail(), to read the metadata from instead of the file.
+  // @param block_cache_warmup if not nullptr, records the data blocks read
+  //    through the block cache.
   static Status Open(const ReadOptions& ro, const ImmutableCFOptions& ioptions,
                      const EnvOptions& env_options,
                      const BlockBasedTableOptions& table_options,
@@ -102,7 +108,10 @@ class BlockBasedTable : public TableReader {
                      bool force_direct_prefetch = false,
                      TailPrefetchStats* tail_prefetch_stats = nullptr,
                      BlockCacheTracer* const block_cache_tracer = nullptr,
-                     size_t max_file_size_for_l0_meta_pin = 0);
+                     size_t max_file_size_for_l0_meta_pin = 0,
+                     BlockSizeTuner* block_size_tuner = nullptr,
+                     const Slice& prefetched_tail = Slice(),
+                     BlockCacheWarmup* block_cache_warmup = nullptr);
 
   bool PrefixMayMatch(const Slice& internal_key,
                       const ReadOptions& read_options,
@@ -158,6 +167,10 @@ class BlockBasedTable : public TableReader {
   uint64_t ApproximateSize(const Slice& start, const Slice& end,
                            TableReaderCaller caller) override;
 
+  // Samples the keys of the index, one in every few data blocks.
+  Status ApproximateKeyAnchors(const ReadOptions& read_options,
+                               std::vector<Anchor>* anchors) override;
+
   bool TEST_BlockInCache(const BlockHandle& handle) const;
 
   // Returns true if the block for the specified key is in cache.
@@ -178,6 +191,12 @@ class BlockBasedTable : public TableReader {
   Status VerifyChecksum(const ReadOptions& readOptions,
                         TableReaderCaller caller) override;
 
+  Status ReadMetadataTail(std::string* tail) override;
+
+  Status LoadBlocksIntoCache(const ReadOptions& read_options,
+                             const std::vector<BlockHandle>& handles,
+                             size_t* num_loaded) override;
+
   ~BlockBasedTable();
 
   bool TEST_FilterBlockInCache() const;
@@ -248,6 +267,8 @@ class BlockBasedTable : public TableReader {
 
   friend class PartitionIndexReader;
 
+  friend class SuccinctTrieIndexReader;
+
   friend class UncompressionDictReader;
 
  protected:
@@ -271,9 +292,13 @@ class BlockBasedTable : public TableReader {
   void UpdateCacheInsertionMetrics(BlockType block_type,
                                    GetContext* get_context, size_t usage,
                                    bool redundant) const;
-  Cache::Handle* GetEntryFromCache(Cache* block_cache, const Slice& key,
-                                   BlockType block_type,
-                                   GetContext* get_context) const;
+  // If helper is set, a miss is also looked up in the secondary cache of
+  // block_cache, rebuilding the entry with create_context.
+  Cache::Handle* GetEntryFromCache(
+      Cache* block_cache, const Slice& key, BlockType block_type,
+      GetContext* get_context,
+      const Cache::CacheItemHelper* helper = nullptr,
+      void* create_context = nullptr) const;
 
   // Either Block::NewDataIterator() or Block::NewIndexIterator().
   template <typename TBlockIter>
@@ -390,6 +415,13 @@ class BlockBasedTable : public TableReader {
                            BlockCacheLookupContext* lookup_context,
                            std::unique_ptr<IndexReader>* index_reader);
 
+  // Get(), with the statistics and perf context instrumentation compiled in
+  // or out
+  template <bool kInstrumented>
+  Status GetImpl(const ReadOptions& read_options, const Slice& key,
+                 GetContext* get_context,
+                 const SliceTransform* prefix_extractor, bool skip_filters);
+
   bool FullFilterKeyMayMatch(const ReadOptions& read_options,
                              FilterBlockReader* filter, const Slice& user_key,
                              const bool no_io,
@@ -581,6 +613,14 @@ struct BlockBasedTable::Rep {
   // Size of the table file on disk
   uint64_t file_size;
 
+  // The offset of the first byte read from the file by Open()
+  uint64_t tail_start_offset = 0;
+
+  // If not nullptr, the data blocks read through the block cache are
+  // recorded there, by the number of the file
+  BlockCacheWarmup* block_cache_warmup = nullptr;
+  uint64_t file_number = 0;
+
   // the level when the table is opened, could potentially change when trivial
   // move is involved
   int level;
@@ -595,6 +635,15 @@ struct BlockBasedTable::Rep {
   // still work, just not as quickly.
   bool blocks_definitely_zstd_compressed = false;
 
+  // If true, data blocks are read in place from the memory-mapped file and
+  // bypass the block cache. See
+  // BlockBasedTableOptions::serve_data_blocks_from_mmap.
+  bool data_blocks_from_mmap = false;
+
+  // If not nullptr, the reads of the table are counted to tune the block size
+  // of new tables
+  BlockSizeTuner* block_size_tuner = nullptr;
+
   // These describe how index is encoded.
   bool index_has_first_key = false;
   bool index_key_includes_seq = true;
@@ -626,19 +675,22 @@ struct BlockBasedTable::Rep {
   uint64_t sst_number_for_tracing() const {
     return file ? TableFileNameToNumber(file->file_name()) : UINT64_MAX;
   }
-  void CreateFilePrefetchBuffer(
-      size_t readahead_size, size_t max_readahead_size,
-      std::unique_ptr<FilePrefetchBuffer>* fpb) const {
-    fpb->reset(new FilePrefetchBuffer(file.get(), readahead_size,
-                                      max_readahead_size,
-                                      !ioptions.allow_mmap_reads /* enable */));
+  void CreateFilePrefetchBuffer(size_t readahead_size,
+                                size_t max_readahead_size,
+                                std::unique_ptr<FilePrefetchBuffer>* fpb,
+                                bool async_io = false) const {
+    fpb->reset(new FilePrefetchBuffer(
+        file.get(), readahead_size, max_readahead_size,
+        !ioptions.allow_mmap_reads /* enable */,
+        false /* track_min_offset */, async_io, ioptions.fs));
   }
 
   void CreateFilePrefetchBufferIfNotExists(
       size_t readahead_size, size_t max_readahead_size,
-      std::unique_ptr<FilePrefetchBuffer>* fpb) const {
+      std::unique_ptr<FilePrefetchBuffer>* fpb, bool async_io = false) const {
     if (!(*fpb)) {
-      CreateFilePrefetchBuffer(readahead_size, max_readahead_size, fpb);
+      CreateFilePrefetchBuffer(readahead_size, max_readahead_size, fpb,
+                               async_io);
     }
   }
 };
@@ -239,6 +239,51 @@ TEST_P(BlockBasedTableReaderTest, MultiGet) {
   }
 }
 
+// Tests that the anchors sample the table in order and cover all of it.
+TEST_P(BlockBasedTableReaderTest, ApproximateKeyAnchors) {
+  // 16 values of 256B make a block, so the table has 1000 data blocks
+  std::map<std::string, std::string> kv;
+  {
+    Random rnd(101);
+    for (uint32_t key = 0; key < 16000; key++) {
+      char k[9] = {0};
+      sprintf(k, "%08u", key);
+      kv[std::string(k)] = rnd.RandomString(256);
+    }
+  }
+
+  std::string table_name =
+      "BlockBasedTableReaderTest" + CompressionTypeToString(compression_type_);
+  CreateTable(table_name, compression_type_, kv);
+
+  std::unique_ptr<BlockBasedTable> table;
+  Options options;
+  ImmutableCFOptions ioptions(options);
+  FileOptions foptions;
+  foptions.use_direct_reads = use_direct_reads_;
+  InternalKeyComparator comparator(options.comparator);
+  NewBlockBasedTableReader(foptions, ioptions, comparator, table_name, &table);
+
+  std::vector<TableReader::Anchor> anchors;
+  ASSERT_OK(table->ApproximateKeyAnchors(ReadOptions(), &anchors));
+  ASSERT_GT(anchors.size(), TableReader::kMaxNumAnchors / 2);
+  ASSERT_LE(anchors.size(), TableReader::kMaxNumAnchors + 1);
+
+  uint64_t total_size = 0;
+  for (size_t i = 0; i < anchors.size(); i++) {
+    if (i > 0) {
+      ASSERT_LT(anchors[i - 1].user_key, anchors[i].user_key);
+    }
+    ASSERT_GT(anchors[i].range_size, 0);
+    total_size += anchors[i].range_size;
+  }
+  ASSERT_GE(anchors.back().user_key, kv.rbegin()->first);
+  uint64_t file_size = 0;
+  ASSERT_OK(Env::Default()->GetFileSize(Path(table_name), &file_size));
+  ASSERT_LE(total_size, file_size);
+  ASSERT_GT(total_size, file_size / 2);
+}
+
 class BlockBasedTableReaderTestVerifyChecksum
     : public BlockBasedTableReaderTest {
  public:
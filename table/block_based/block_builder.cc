@@ -30,6 +30,12 @@
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+//
+// Data blocks built with restart_key_prefixes and no larger than
+// kMaxBlockSizeSupportedByHashIndex also store the RestartKeyPrefix() of
+// every restart key as fixed64[num_restarts] right after the restarts, and
+// flag it in the footer. Seeks narrow down the binary search over the
+// restart points with these before decoding any key.
 
 #include "table/block_based/block_builder.h"
 
@@ -46,11 +52,12 @@ BlockBuilder::BlockBuilder(
     int block_restart_interval, bool use_delta_encoding,
     bool use_value_delta_encoding,
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    double data_block_hash_table_util_ratio)
+    double data_block_hash_table_util_ratio, bool restart_key_prefixes)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
       use_value_delta_encoding_(use_value_delta_encoding),
       restarts_(),
+      restart_key_prefixes_(restart_key_prefixes),
       counter_(0),
       finished_(false) {
   switch (index_type) {
@@ -72,6 +79,7 @@ void BlockBuilder::Reset() {
   buffer_.clear();
   restarts_.clear();
   restarts_.push_back(0);  // First restart point is at offset 0
+  restart_prefixes_.clear();
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
   counter_ = 0;
   finished_ = false;
@@ -101,6 +109,9 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key,
 
   if (counter_ >= block_restart_interval_) {
     estimate += sizeof(uint32_t);  // a new restart entry.
+    if (restart_key_prefixes_) {
+      estimate += sizeof(uint64_t);  // and its key prefix.
+    }
   }
 
   estimate += sizeof(int32_t);  // varint for shared prefix length.
@@ -121,16 +132,33 @@ Slice BlockBuilder::Finish() {
   }
 
   uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
+
+  // The prefixes are already counted in estimate_. Like the hash index, they
+  // are only flagged in the footer of blocks up to 64KiB.
+  size_t size_without_prefixes =
+      CurrentSizeEstimate() - restart_prefixes_.size() * sizeof(uint64_t);
+  bool has_restart_prefixes =
+      restart_key_prefixes_ && restart_prefixes_.size() == num_restarts &&
+      CurrentSizeEstimate() <= kMaxBlockSizeSupportedByHashIndex;
+  if (has_restart_prefixes) {
+    for (uint64_t prefix : restart_prefixes_) {
+      PutFixed64(&buffer_, prefix);
+    }
+    size_without_prefixes = CurrentSizeEstimate();
+  }
+
   BlockBasedTableOptions::DataBlockIndexType index_type =
       BlockBasedTableOptions::kDataBlockBinarySearch;
   if (data_block_hash_index_builder_.Valid() &&
-      CurrentSizeEstimate() <= kMaxBlockSizeSupportedByHashIndex) {
+      size_without_prefixes <= kMaxBlockSizeSupportedByHashIndex) {
     data_block_hash_index_builder_.Finish(buffer_);
     index_type = BlockBasedTableOptions::kDataBlockBinaryAndHash;
   }
 
-  // footer is a packed format of data_block_index_type and num_restarts
-  uint32_t block_footer = PackIndexTypeAndNumRestarts(index_type, num_restarts);
+  // footer is a packed format of data_block_index_type, the restart prefixes
+  // flag and num_restarts
+  uint32_t block_footer = PackIndexTypeAndNumRestarts(index_type, num_restarts,
+                                                      has_restart_prefixes);
 
   PutFixed32(&buffer_, block_footer);
   finished_ = true;
@@ -143,6 +171,11 @@ void BlockBuilder::Add(const Slice& key, const Slice& value,
   assert(counter_ <= block_restart_interval_);
   assert(!use_value_delta_encoding_ || delta_value);
   size_t shared = 0;  // number of bytes shared with prev key
+  if (restart_key_prefixes_ &&
+      (buffer_.empty() || counter_ >= block_restart_interval_)) {
+    restart_prefixes_.push_back(RestartKeyPrefix(ExtractUserKey(key)));
+    estimate_ += sizeof(uint64_t);
+  }
   if (counter_ >= block_restart_interval_) {
     // Restart compression
     restarts_.push_back(static_cast<uint32_t>(buffer_.size()));
@@ -12,18 +12,18 @@ namespace ROCKSDB_NAMESPACE {
 void BlockPrefetcher::PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
                                        const BlockHandle& handle,
                                        size_t readahead_size,
-                                       bool is_for_compaction) {
+                                       bool is_for_compaction, bool async_io) {
   if (is_for_compaction) {
     rep->CreateFilePrefetchBufferIfNotExists(compaction_readahead_size_,
                                              compaction_readahead_size_,
-                                             &prefetch_buffer_);
+                                             &prefetch_buffer_, async_io);
     return;
   }
 
   // Explicit user requested readahead
   if (readahead_size > 0) {
     rep->CreateFilePrefetchBufferIfNotExists(readahead_size, readahead_size,
-                                             &prefetch_buffer_);
+                                             &prefetch_buffer_, async_io);
     return;
   }
 
@@ -35,10 +35,12 @@ void BlockPrefetcher::PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
     return;
   }
 
-  if (rep->file->use_direct_io()) {
+  // The file system readahead is synchronous, so async_io needs the internal
+  // prefetch buffer too.
+  if (rep->file->use_direct_io() || async_io) {
     rep->CreateFilePrefetchBufferIfNotExists(
         BlockBasedTable::kInitAutoReadaheadSize,
-        BlockBasedTable::kMaxAutoReadaheadSize, &prefetch_buffer_);
+        BlockBasedTable::kMaxAutoReadaheadSize, &prefetch_buffer_, async_io);
     return;
   }
 
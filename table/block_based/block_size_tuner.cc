@@ -0,0 +1,40 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/block_size_tuner.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ROCKSDB_NAMESPACE {
+
+const int BlockSizeTuner::kNumLevels;
+const uint64_t BlockSizeTuner::kMinReads;
+
+size_t BlockSizeTuner::PickBlockSize(int level, size_t min_block_size,
+                                     size_t max_block_size) const {
+  if (level < 0 || max_block_size <= min_block_size) {
+    return min_block_size;
+  }
+  const Counts& counts = counts_[level < kNumLevels ? level : kNumLevels - 1];
+  const uint64_t point_lookups =
+      counts.point_lookups.load(std::memory_order_relaxed);
+  const uint64_t scans = counts.scans.load(std::memory_order_relaxed);
+  if (point_lookups + scans < kMinReads) {
+    return min_block_size;
+  }
+  const double scan_fraction =
+      static_cast<double>(scans) / static_cast<double>(point_lookups + scans);
+  const double block_size =
+      static_cast<double>(min_block_size) *
+      std::pow(static_cast<double>(max_block_size) / min_block_size,
+               scan_fraction);
+  // Rounded to 1KB, as block sizes usually are
+  const size_t rounded =
+      (static_cast<size_t>(block_size) + 512) & ~static_cast<size_t>(1023);
+  return std::min(max_block_size, std::max(min_block_size, rounded));
+}
+
+}  // namespace ROCKSDB_NAMESPACE
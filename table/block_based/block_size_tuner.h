@@ -0,0 +1,65 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// BlockSizeTuner counts the point lookups and the scans served by the tables
+// of each level, and picks from them the block size of the new tables of a
+// level when `BlockBasedTableOptions::auto_tune_block_size` is set.
+//
+// Levels read by point lookups keep small blocks, which read and cache less
+// per lookup, while levels read by scans get large blocks, which read more
+// per I/O and take less index.
+class BlockSizeTuner {
+ public:
+  // The levels from this one down are counted together
+  static const int kNumLevels = 8;
+  // Reads counted on a level before its block size is tuned
+  static const uint64_t kMinReads = 1024;
+
+  void RecordPointLookups(int level, uint64_t count) {
+    if (level >= 0) {
+      GetCounts(level).point_lookups.fetch_add(count,
+                                               std::memory_order_relaxed);
+    }
+  }
+
+  void RecordScan(int level) {
+    if (level >= 0) {
+      GetCounts(level).scans.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Returns the block size for a new table at the level: min_block_size if
+  // the level's reads are point lookups, max_block_size if they are scans,
+  // and a geometric interpolation by the fraction of scans in between.
+  // Returns min_block_size if the level is unknown or was read too little.
+  size_t PickBlockSize(int level, size_t min_block_size,
+                       size_t max_block_size) const;
+
+ private:
+  struct Counts {
+    std::atomic<uint64_t> point_lookups{0};
+    std::atomic<uint64_t> scans{0};
+  };
+
+  Counts& GetCounts(int level) {
+    return counts_[level < kNumLevels ? level : kNumLevels - 1];
+  }
+
+  std::array<Counts, kNumLevels> counts_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -124,6 +124,64 @@ TEST_F(BlockTest, SimpleTest) {
   delete iter;
 }
 
+// Next() over a pinned block decodes a restart interval at a time
+TEST_F(BlockTest, BulkDecodePinnedBlock) {
+  Random rnd(301);
+  Options options = Options();
+
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  BlockBuilder builder(16);
+  int num_records = 10000;
+
+  GenerateRandomKVs(&keys, &values, 0, num_records);
+  for (int i = 0; i < num_records; i++) {
+    builder.Add(keys[i], values[i]);
+  }
+  Slice rawblock = builder.Finish();
+  BlockContents contents;
+  contents.data = rawblock;
+  Block reader(std::move(contents));
+
+  std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+      options.comparator, kDisableGlobalSequenceNumber, nullptr /* iter */,
+      nullptr /* stats */, true /* block_contents_pinned */));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); count++, iter->Next()) {
+    ASSERT_EQ(keys[count], iter->key().ToString());
+    ASSERT_EQ(values[count], iter->value().ToString());
+    // Only the keys that are not delta encoded point into the block
+    if (count % 16 == 0) {
+      ASSERT_TRUE(iter->IsKeyPinned());
+    } else {
+      ASSERT_FALSE(iter->IsKeyPinned());
+    }
+  }
+  ASSERT_EQ(num_records, count);
+  ASSERT_OK(iter->status());
+
+  // Next() after Seek() in the middle of a restart interval, and after Prev()
+  for (int i = 0; i < 1000; i++) {
+    int index = rnd.Uniform(num_records);
+    iter->Seek(keys[index]);
+    for (int j = index; j < std::min(index + 40, num_records); j++) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(keys[j], iter->key().ToString());
+      ASSERT_EQ(values[j], iter->value().ToString());
+      iter->Next();
+    }
+    if (index > 0 && iter->Valid()) {
+      iter->Prev();
+      iter->Prev();
+      ASSERT_TRUE(iter->Valid());
+      iter->Next();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(keys[std::min(index + 40, num_records) - 1],
+                iter->key().ToString());
+    }
+  }
+}
+
 // return the block contents
 BlockContents GetBlockContents(std::unique_ptr<BlockBuilder> *builder,
                                const std::vector<std::string> &keys,
@@ -214,6 +272,131 @@ TEST_F(BlockTest, IndexHashWithSharedPrefix) {
   CheckBlockContents(std::move(contents), kMaxKey, keys, values);
 }
 
+// Seeks must land on the same keys whether or not the block stores restart
+// key prefixes.
+TEST_F(BlockTest, RestartKeyPrefixes) {
+  Random rnd(301);
+  Options options = Options();
+
+  // Short keys over a tiny alphabet, including '\0', so that many restart
+  // keys share their 8 byte prefix or are shorter than it
+  std::set<std::string> user_key_set;
+  while (user_key_set.size() < 1500) {
+    std::string key;
+    int len = rnd.Uniform(13);
+    for (int i = 0; i < len; i++) {
+      key.push_back("\0ab"[rnd.Uniform(3)]);
+    }
+    user_key_set.insert(key);
+  }
+  std::vector<std::string> user_keys(user_key_set.begin(), user_key_set.end());
+
+  for (int restart_interval : {1, 4, 16, 64}) {
+    for (auto index_type : {BlockBasedTableOptions::kDataBlockBinarySearch,
+                            BlockBasedTableOptions::kDataBlockBinaryAndHash}) {
+      std::unique_ptr<Block> blocks[2];
+      std::string buffers[2];
+      for (int with_prefixes = 0; with_prefixes < 2; with_prefixes++) {
+        BlockBuilder builder(restart_interval, true /* use_delta_encoding */,
+                             false /* use_value_delta_encoding */, index_type,
+                             0.75, with_prefixes != 0);
+        for (size_t i = 0; i < user_keys.size(); i++) {
+          InternalKey ikey(user_keys[i], 100, kTypeValue);
+          builder.Add(ikey.Encode(), std::to_string(i));
+        }
+        buffers[with_prefixes] = builder.Finish().ToString();
+        ASSERT_LE(buffers[with_prefixes].size(),
+                  kMaxBlockSizeSupportedByHashIndex);
+        BlockContents contents;
+        contents.data = buffers[with_prefixes];
+        blocks[with_prefixes].reset(new Block(std::move(contents)));
+        ASSERT_EQ(with_prefixes != 0,
+                  blocks[with_prefixes]->HasRestartPrefixes());
+      }
+      // The hash index needs at most 253 restarts
+      ASSERT_EQ(restart_interval >= 16
+                    ? index_type
+                    : BlockBasedTableOptions::kDataBlockBinarySearch,
+                blocks[1]->IndexType());
+      ASSERT_EQ(blocks[0]->IndexType(), blocks[1]->IndexType());
+
+      std::unique_ptr<DataBlockIter> iters[2];
+      for (int i = 0; i < 2; i++) {
+        iters[i].reset(blocks[i]->NewDataIterator(
+            options.comparator, kDisableGlobalSequenceNumber));
+      }
+      for (int t = 0; t < 5000; t++) {
+        std::string target;
+        if (t % 2 == 0) {
+          target = user_keys[rnd.Uniform(static_cast<int>(user_keys.size()))];
+        } else {
+          int len = rnd.Uniform(14);
+          for (int i = 0; i < len; i++) {
+            target.push_back("\0abc"[rnd.Uniform(4)]);
+          }
+        }
+        SequenceNumber seq = t % 3 == 0 ? 50 : (t % 3 == 1 ? 100 : 200);
+        InternalKey ikey(target, seq, kValueTypeForSeek);
+
+        // Reference position from the sorted user keys. The seek type sorts
+        // before kTypeValue at the same sequence number.
+        auto it = std::lower_bound(user_keys.begin(), user_keys.end(), target);
+        if (it != user_keys.end() && *it == target && seq < 100) {
+          ++it;
+        }
+        for (int i = 0; i < 2; i++) {
+          iters[i]->Seek(ikey.Encode());
+          if (it == user_keys.end()) {
+            ASSERT_FALSE(iters[i]->Valid());
+          } else {
+            ASSERT_TRUE(iters[i]->Valid());
+            ASSERT_EQ(*it, ExtractUserKey(iters[i]->key()).ToString());
+          }
+          iters[i]->SeekForPrev(ikey.Encode());
+          if (it == user_keys.begin()) {
+            ASSERT_FALSE(iters[i]->Valid());
+          } else {
+            ASSERT_TRUE(iters[i]->Valid());
+            ASSERT_EQ(*(it - 1), ExtractUserKey(iters[i]->key()).ToString());
+          }
+        }
+      }
+    }
+  }
+}
+
+// Blocks larger than 64KiB have no room in the footer to flag the prefixes
+TEST_F(BlockTest, RestartKeyPrefixesLargeBlock) {
+  Options options = Options();
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  GenerateRandomKVs(&keys, &values, 0, 1000);
+
+  BlockBuilder builder(16, true /* use_delta_encoding */,
+                       false /* use_value_delta_encoding */,
+                       BlockBasedTableOptions::kDataBlockBinarySearch, 0.75,
+                       true /* restart_key_prefixes */);
+  for (size_t i = 0; i < keys.size(); i++) {
+    builder.Add(keys[i], values[i]);
+  }
+  Slice rawblock = builder.Finish();
+  ASSERT_GT(rawblock.size(), kMaxBlockSizeSupportedByHashIndex);
+
+  BlockContents contents;
+  contents.data = rawblock;
+  Block reader(std::move(contents));
+  ASSERT_FALSE(reader.HasRestartPrefixes());
+  ASSERT_EQ((keys.size() + 15) / 16, reader.NumRestarts());
+
+  std::unique_ptr<DataBlockIter> iter(
+      reader.NewDataIterator(options.comparator, kDisableGlobalSequenceNumber));
+  for (size_t i = 0; i < keys.size(); i++) {
+    iter->Seek(keys[i]);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(values[i], iter->value().ToString());
+  }
+}
+
 // A slow and accurate version of BlockReadAmpBitmap that simply store
 // all the marked ranges in a set.
 class BlockReadAmpBitmapSlowAndAccurate {
@@ -0,0 +1,89 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/compression_dict_registry.h"
+
+#include <algorithm>
+
+#include "test_util/sync_point.h"
+#include "util/compression.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+std::shared_ptr<const CompressionDictRegistry::Dict>
+CompressionDictRegistry::GetDict(uint32_t column_family_id) const {
+  MutexLock l(&mutex_);
+  auto it = column_families_.find(column_family_id);
+  if (it == column_families_.end()) {
+    return nullptr;
+  }
+  return it->second.dict;
+}
+
+void CompressionDictRegistry::AddSamples(
+    uint32_t column_family_id, const CompressionOptions& opts,
+    uint64_t data_bytes, const std::string& samples,
+    const std::vector<size_t>& sample_lens) {
+  std::string train_samples;
+  std::vector<size_t> train_sample_lens;
+  {
+    MutexLock l(&mutex_);
+    ColumnFamilyState& cf = column_families_[column_family_id];
+    size_t pos = 0;
+    for (size_t len : sample_lens) {
+      cf.samples.emplace_back(samples, pos, len);
+      cf.sample_bytes += len;
+      pos += len;
+    }
+    // Forget the oldest samples, so the dictionary follows the data
+    const size_t kSampleBytes = SampleBytes(opts);
+    while (cf.samples.size() > 1 && cf.sample_bytes > kSampleBytes) {
+      cf.sample_bytes -= cf.samples.front().size();
+      cf.samples.pop_front();
+    }
+    cf.bytes_since_training += data_bytes;
+    if (cf.training || cf.samples.empty() ||
+        cf.bytes_since_training < opts.shared_dict_retrain_bytes) {
+      return;
+    }
+    cf.training = true;
+    cf.bytes_since_training = 0;
+    train_samples.reserve(cf.sample_bytes);
+    for (const auto& sample : cf.samples) {
+      train_samples.append(sample);
+      train_sample_lens.push_back(sample.size());
+    }
+  }
+
+  // Train without holding the mutex, as it takes a while
+  std::string raw;
+  if (opts.zstd_max_train_bytes > 0) {
+    raw = ZSTD_TrainDictionary(train_samples, train_sample_lens,
+                               opts.max_dict_bytes);
+  } else {
+    raw = std::move(train_samples);
+    raw.resize(std::min(raw.size(), static_cast<size_t>(opts.max_dict_bytes)));
+  }
+  std::shared_ptr<Dict> dict;
+  if (!raw.empty()) {
+    dict = std::make_shared<Dict>();
+    dict->id = std::max<uint64_t>(Hash64(raw.data(), raw.size()), 1);
+    dict->raw = std::move(raw);
+  }
+  TEST_SYNC_POINT_CALLBACK("CompressionDictRegistry::AddSamples:Trained",
+                           &dict);
+
+  MutexLock l(&mutex_);
+  ColumnFamilyState& cf = column_families_[column_family_id];
+  cf.training = false;
+  // Keep the previous dictionary if training failed, e.g. for lack of samples
+  if (dict != nullptr) {
+    cf.dict = std::move(dict);
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,71 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/advanced_options.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// CompressionDictRegistry holds the compression dictionaries shared by the
+// SST files of each column family, when
+// `CompressionOptions::shared_dict_retrain_bytes` is set.
+//
+// Table builders take the current dictionary of their column family when
+// they start, sample their uncompressed data blocks while writing and hand
+// the samples in when they finish. Once the given number of data bytes were
+// written since the dictionary was last trained, a new one is trained from
+// the most recent samples and replaces it for the files started afterwards.
+// Each file still stores the dictionary it was compressed with, so it can
+// be read on its own.
+class CompressionDictRegistry {
+ public:
+  struct Dict {
+    // A hash of the raw dictionary, never 0, which is recorded in the table
+    // properties so readers can share the digested dictionary
+    uint64_t id;
+    std::string raw;
+  };
+
+  // Returns the dictionary to compress new files of the column family with,
+  // or nullptr if none was trained yet
+  std::shared_ptr<const Dict> GetDict(uint32_t column_family_id) const;
+
+  // Adds the samples taken from data_bytes of data blocks written to a file
+  // of the column family, and trains a new dictionary if it is time to
+  void AddSamples(uint32_t column_family_id, const CompressionOptions& opts,
+                  uint64_t data_bytes, const std::string& samples,
+                  const std::vector<size_t>& sample_lens);
+
+  // The number of bytes of samples kept per column family to train from
+  static size_t SampleBytes(const CompressionOptions& opts) {
+    return opts.zstd_max_train_bytes > 0 ? opts.zstd_max_train_bytes
+                                         : opts.max_dict_bytes;
+  }
+
+ private:
+  struct ColumnFamilyState {
+    std::shared_ptr<const Dict> dict;
+    // The most recent samples, oldest first
+    std::deque<std::string> samples;
+    size_t sample_bytes = 0;
+    uint64_t bytes_since_training = 0;
+    bool training = false;
+  };
+
+  mutable port::Mutex mutex_;
+  std::unordered_map<uint32_t, ColumnFamilyState> column_families_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
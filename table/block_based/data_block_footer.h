@@ -9,17 +9,36 @@
 
 #pragma once
 
+#include "rocksdb/slice.h"
 #include "rocksdb/table.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+// The footer of a block no larger than kMaxBlockSizeSupportedByHashIndex
+// packs the data block index type into its MSB and whether the block carries
+// restart key prefixes (see BlockBuilder) into the next bit. Larger blocks
+// store num_restarts alone.
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    uint32_t num_restarts);
+    uint32_t num_restarts, bool has_restart_prefixes = false);
 
 void UnPackIndexTypeAndNumRestarts(
     uint32_t block_footer,
     BlockBasedTableOptions::DataBlockIndexType* index_type,
-    uint32_t* num_restarts);
+    uint32_t* num_restarts, bool* has_restart_prefixes = nullptr);
+
+// Restart key prefixes are the first 8 bytes of the user key of each restart
+// point, zero padded and read as a big-endian integer, so that comparing two
+// prefixes as integers agrees with BytewiseComparator: a smaller prefix means
+// a smaller key, and a smaller key never has a larger prefix.
+inline uint64_t RestartKeyPrefix(const Slice& user_key) {
+  uint64_t prefix = 0;
+  const size_t n = user_key.size() < 8 ? user_key.size() : 8;
+  for (size_t i = 0; i < n; i++) {
+    prefix |= static_cast<uint64_t>(static_cast<unsigned char>(user_key[i]))
+              << (56 - 8 * i);
+  }
+  return prefix;
+}
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -84,10 +84,12 @@ void DataBlockHashIndex::Initialize(const char* data, uint16_t size,
 
 uint8_t DataBlockHashIndex::Lookup(const char* data, uint32_t map_offset,
                                    const Slice& key) const {
+  return LookupBucket(data, map_offset, GetBucket(key));
+}
+
+uint16_t DataBlockHashIndex::GetBucket(const Slice& key) const {
   uint32_t hash_value = GetSliceHash(key);
-  uint16_t idx = static_cast<uint16_t>(hash_value % num_buckets_);
-  const char* bucket_table = data + map_offset;
-  return static_cast<uint8_t>(*(bucket_table + idx * sizeof(uint8_t)));
+  return static_cast<uint16_t>(hash_value % num_buckets_);
 }
 
 }  // namespace ROCKSDB_NAMESPACE
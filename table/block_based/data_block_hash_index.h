@@ -121,6 +121,14 @@ class DataBlockHashIndex {
 
   uint8_t Lookup(const char* data, uint32_t map_offset, const Slice& key) const;
 
+  // Lookup() in two steps, so that the buckets of a batch of keys can be
+  // prefetched before they are read
+  uint16_t GetBucket(const Slice& key) const;
+  uint8_t LookupBucket(const char* data, uint32_t map_offset,
+                       uint16_t bucket) const {
+    return static_cast<uint8_t>(data[map_offset + bucket * sizeof(uint8_t)]);
+  }
+
   inline bool Valid() { return num_buckets_ != 0; }
 
  private:
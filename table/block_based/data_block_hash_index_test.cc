@@ -593,6 +593,76 @@ void TestBoundary(InternalKey& ik1, std::string& v1, InternalKey& ik2,
                               moptions.prefix_extractor.get()));
 }
 
+// A batch of probes resolves like a SeekForGet() of each key
+TEST(DataBlockHashIndex, BlockTestProbeBatch) {
+  Random rnd(1019);
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+
+  BlockBuilder builder(16 /* block_restart_interval */,
+                       true /* use_delta_encoding */,
+                       false /* use_value_delta_encoding */,
+                       BlockBasedTableOptions::kDataBlockBinaryAndHash);
+  int num_records = 500;
+
+  GenerateRandomKVs(&keys, &values, 0, num_records);
+  for (int i = 0; i < num_records; i++) {
+    std::string ukey(keys[i] + "1" /* existing key marker */);
+    InternalKey ikey(ukey, 0, kTypeValue);
+    builder.Add(ikey.Encode().ToString(), values[i]);
+  }
+  Slice rawblock = builder.Finish();
+  BlockContents contents;
+  contents.data = rawblock;
+  Block reader(std::move(contents));
+  const InternalKeyComparator icmp(BytewiseComparator());
+
+  const size_t kBatchSize = 40;
+  std::vector<std::string> targets;
+  std::vector<int> indexes;
+  for (size_t i = 0; i < kBatchSize; i++) {
+    int index = rnd.Uniform(num_records);
+    // Every other key does not exist
+    std::string ukey(keys[index] + (i % 2 == 0 ? "1" : "0"));
+    targets.push_back(InternalKey(ukey, 0, kTypeValue).Encode().ToString());
+    indexes.push_back(index);
+  }
+  std::vector<Slice> target_slices(targets.begin(), targets.end());
+  std::vector<uint8_t> hash_entries(kBatchSize);
+
+  std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+      icmp.user_comparator(), kDisableGlobalSequenceNumber));
+  std::unique_ptr<DataBlockIter> ref_iter(reader.NewDataIterator(
+      icmp.user_comparator(), kDisableGlobalSequenceNumber));
+  ASSERT_TRUE(iter->ProbeHashIndex(target_slices.data(), kBatchSize,
+                                   hash_entries.data()));
+  for (size_t i = 0; i < kBatchSize; i++) {
+    bool may_exist = iter->SeekForGet(targets[i], hash_entries[i]);
+    bool ref_may_exist = ref_iter->SeekForGet(targets[i]);
+    ASSERT_EQ(ref_may_exist, may_exist);
+    ASSERT_EQ(ref_iter->Valid(), iter->Valid());
+    if (i % 2 == 0) {
+      ASSERT_TRUE(may_exist);
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(values[indexes[i]], iter->value());
+    } else if (iter->Valid()) {
+      ASSERT_EQ(ref_iter->key(), iter->key());
+    }
+  }
+
+  // Without a hash index there is nothing to probe
+  BlockBuilder plain_builder(16 /* block_restart_interval */);
+  InternalKey ikey(keys[0], 0, kTypeValue);
+  plain_builder.Add(ikey.Encode().ToString(), values[0]);
+  BlockContents plain_contents;
+  plain_contents.data = plain_builder.Finish();
+  Block plain_reader(std::move(plain_contents));
+  std::unique_ptr<DataBlockIter> plain_iter(plain_reader.NewDataIterator(
+      icmp.user_comparator(), kDisableGlobalSequenceNumber));
+  ASSERT_FALSE(plain_iter->ProbeHashIndex(target_slices.data(), 1,
+                                          hash_entries.data()));
+}
+
 TEST(DataBlockHashIndex, BlockBoundary) {
   BlockBasedTableOptions table_options;
   table_options.data_block_index_type =
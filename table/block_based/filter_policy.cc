@@ -8,18 +8,24 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include <array>
+#include <cmath>
 #include <deque>
 
 #include "rocksdb/filter_policy.h"
 
+#include "port/port.h"
+#include "rocksdb/cache.h"
 #include "rocksdb/slice.h"
 #include "table/block_based/block_based_filter_block.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/filter_policy_internal.h"
+#include "test_util/sync_point.h"
 #include "third-party/folly/folly/ConstexprMath.h"
 #include "util/bloom_impl.h"
 #include "util/coding.h"
 #include "util/hash.h"
+#include "util/math128.h"
+#include "util/ribbon_impl.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -44,7 +50,11 @@ class FastLocalBloomBitsBuilder : public BuiltinFilterBitsBuilder {
   ~FastLocalBloomBitsBuilder() override {}
 
   virtual void AddKey(const Slice& key) override {
-    uint64_t hash = GetSliceHash64(key);
+    AddHash(GetSliceHash64(key));
+  }
+
+  // For building from hashes already computed with GetSliceHash64
+  void AddHash(uint64_t hash) {
     if (hash_entries_.empty() || hash != hash_entries_.back()) {
       hash_entries_.push_back(hash);
     }
@@ -341,6 +351,501 @@ class FastLocalBloomBitsReader : public FilterBitsReader {
   const uint32_t len_bytes_;
 };
 
+// Standard128Ribbon filter over the 64-bit key hashes also used by
+// FastLocalBloom, so a build can fall back to Bloom without rehashing keys.
+// (See util/ribbon_alg.h for the algorithm.)
+struct Standard128RibbonTypesAndSettings {
+  using CoeffRow = Unsigned128;
+  using ResultRow = uint16_t;
+  using Index = uint32_t;
+  using Hash = uint64_t;
+  using Seed = uint32_t;
+  static constexpr bool kIsFilter = true;
+  static constexpr bool kFirstCoeffAlwaysOne = true;
+  static constexpr bool kUseSmash = false;
+};
+using Standard128RibbonRehasherTypesAndSettings =
+    ribbon::StandardRehasherAdapter<Standard128RibbonTypesAndSettings>;
+using Standard128RibbonBanding =
+    ribbon::StandardBanding<Standard128RibbonRehasherTypesAndSettings>;
+using Standard128RibbonHasher =
+    ribbon::StandardRehasher<Standard128RibbonTypesAndSettings>;
+
+// Slots in a block of the solution, one per coefficient bit
+constexpr uint32_t kRibbonBlockSlots = 128;
+// Bytes of one solution column of a block
+constexpr uint32_t kRibbonColumnBytes = kRibbonBlockSlots / 8;
+// Each solution column is one result bit, so up to 2^-16 FP rate
+constexpr int kMaxRibbonColumns = 16;
+// Seeds tried (stored in one byte) before falling back to Bloom
+constexpr uint32_t kMaxRibbonSeed = 63;
+// Keys per shard before sharding is worth a thread
+constexpr size_t kMinKeysPerRibbonShard = size_t{1} << 16;
+// Shard count is stored in one byte
+constexpr uint32_t kMaxRibbonShards = 255;
+// Per-shard number of blocks (4 bytes) and seed (1 byte)
+constexpr uint32_t kRibbonShardInfoBytes = 5;
+// Extra slots beyond one per key, num_keys / kRibbonOverheadDivisor +
+// kRibbonExtraSlots, for a solution to be found with the first few seeds.
+// Small systems need relatively more.
+constexpr uint64_t kRibbonOverheadDivisor = 20;
+constexpr uint64_t kRibbonExtraSlots = 16;
+
+// Size of the dummy block cache entries charging construction memory
+constexpr size_t kSizeReservationEntry = 256 * 1024;
+// Keys of the dummy entries are longer than the keys of blocks in SST files
+// so they won't conflict.
+constexpr size_t kReservationKeyPrefix = kMaxVarint64Length * 4 + 1;
+
+// Charges memory that a filter builder holds temporarily to a block cache,
+// with dummy entries the way WriteBufferManager charges memtables.
+class FilterConstructionReservation {
+ public:
+  explicit FilterConstructionReservation(std::shared_ptr<Cache> cache)
+      : cache_(std::move(cache)) {
+    memset(cache_key_, 0, kReservationKeyPrefix);
+    const void* self = this;
+    memcpy(cache_key_, &self, sizeof(self));
+  }
+
+  ~FilterConstructionReservation() { UpdateReserved(0).PermitUncheckedError(); }
+
+  // Grows or shrinks the charge to cover `bytes`. On failure (block cache
+  // full with strict_capacity_limit) the charge stays at what could be
+  // inserted.
+  Status UpdateReserved(size_t bytes) {
+    while (reserved_ < bytes) {
+      Cache::Handle* handle = nullptr;
+      Status s = cache_->Insert(GetNextCacheKey(), nullptr,
+                                kSizeReservationEntry, nullptr, &handle);
+      if (!s.ok()) {
+        return s;
+      }
+      handles_.push_back(handle);
+      reserved_ += kSizeReservationEntry;
+    }
+    while (reserved_ >= bytes + kSizeReservationEntry) {
+      cache_->Release(handles_.back(), true /* force_erase */);
+      handles_.pop_back();
+      reserved_ -= kSizeReservationEntry;
+    }
+    return Status::OK();
+  }
+
+  size_t GetReserved() const { return reserved_; }
+
+ private:
+  Slice GetNextCacheKey() {
+    char* end =
+        EncodeVarint64(cache_key_ + kReservationKeyPrefix, next_id_++);
+    return Slice(cache_key_, static_cast<size_t>(end - cache_key_));
+  }
+
+  std::shared_ptr<Cache> cache_;
+  std::vector<Cache::Handle*> handles_;
+  size_t reserved_ = 0;
+  char cache_key_[kReservationKeyPrefix + kMaxVarint64Length];
+  uint64_t next_id_ = 0;
+};
+
+// Builds a Standard128Ribbon filter with an interleaved solution: each block
+// of 128 slots is stored as num_columns 128-bit words, word c holding bit c
+// of the solution row of every slot in the block. A query then reads two
+// adjacent blocks and computes one parity per column.
+//
+// With parallel_threads > 1 and enough keys, the keys are sharded by hash
+// into independent Ribbon systems, each with its own blocks and seed, so
+// banding and back-substitution run on several threads.
+class Standard128RibbonBitsBuilder : public BuiltinFilterBitsBuilder {
+ public:
+  Standard128RibbonBitsBuilder(int num_columns, int bloom_millibits_per_key,
+                               uint32_t parallel_threads,
+                               std::shared_ptr<Cache> reservation_cache)
+      : num_columns_(num_columns),
+        parallel_threads_(std::max(parallel_threads, uint32_t{1})),
+        bloom_fallback_(bloom_millibits_per_key, nullptr) {
+    assert(num_columns_ >= 1 && num_columns_ <= kMaxRibbonColumns);
+    if (reservation_cache) {
+      reservation_.reset(
+          new FilterConstructionReservation(std::move(reservation_cache)));
+    }
+  }
+
+  // No Copy allowed
+  Standard128RibbonBitsBuilder(const Standard128RibbonBitsBuilder&) = delete;
+  void operator=(const Standard128RibbonBitsBuilder&) = delete;
+
+  ~Standard128RibbonBitsBuilder() override {}
+
+  // Number of solution columns for the same FP rate as FastLocalBloom with
+  // the given bits per key
+  static int ColumnsForBloomEquivalent(int millibits_per_key) {
+    const size_t keys = 1000000;
+    double fp_rate = FastLocalBloomImpl::EstimatedFpRate(
+        keys, keys * millibits_per_key / 8000,
+        FastLocalBloomImpl::ChooseNumProbes(millibits_per_key),
+        /*hash bits*/ 64);
+    int columns = static_cast<int>(-std::log2(fp_rate) + 0.5);
+    return std::min(std::max(columns, 1), kMaxRibbonColumns);
+  }
+
+  virtual void AddKey(const Slice& key) override {
+    uint64_t hash = GetSliceHash64(key);
+    if (hash_entries_.empty() || hash != hash_entries_.back()) {
+      hash_entries_.push_back(hash);
+      if (reservation_ &&
+          hash_entries_.size() * sizeof(uint64_t) >
+              reservation_->GetReserved()) {
+        // A failure is only surfaced (as a Bloom fallback) in Finish
+        reservation_->UpdateReserved(hash_entries_.size() * sizeof(uint64_t))
+            .PermitUncheckedError();
+      }
+    }
+  }
+
+  virtual Slice Finish(std::unique_ptr<const char[]>* buf) override {
+    const size_t num_entries = hash_entries_.size();
+    if (num_entries == 0) {
+      // Empty filter, read as always false
+      std::unique_ptr<char[]> mutable_buf(new char[5]());
+      mutable_buf[0] = static_cast<char>(-1);
+      Slice rv(mutable_buf.get(), 5);
+      *buf = std::move(mutable_buf);
+      return rv;
+    }
+
+    uint32_t num_shards = ChooseNumShards(num_entries);
+    std::vector<std::vector<uint64_t>> shard_entries;
+    std::vector<uint32_t> shard_blocks(num_shards);
+    if (num_shards == 1) {
+      shard_blocks[0] = BlocksForKeys(num_entries);
+    } else {
+      shard_entries.resize(num_shards);
+      for (auto& entries : shard_entries) {
+        entries.reserve(num_entries / num_shards + num_entries / 64);
+      }
+      while (!hash_entries_.empty()) {
+        uint64_t h = hash_entries_.front();
+        hash_entries_.pop_front();
+        shard_entries[FastRange32(Lower32of64(h), num_shards)].push_back(h);
+      }
+      for (uint32_t i = 0; i < num_shards; ++i) {
+        shard_blocks[i] = BlocksForKeys(shard_entries[i].size());
+      }
+    }
+
+    // Banding memory of all shards is live at once while building them in
+    // parallel
+    uint64_t total_blocks = 0;
+    for (uint32_t blocks : shard_blocks) {
+      total_blocks += blocks;
+    }
+    const uint64_t len = total_blocks * num_columns_ * kRibbonColumnBytes +
+                         num_shards * kRibbonShardInfoBytes + 1;
+    if (len + 5 > uint64_t{0xffffffc0} ||
+        total_blocks * kRibbonBlockSlots > uint64_t{0xffffff00}) {
+      return FinishBloomFallback(buf, &shard_entries);
+    }
+    if (reservation_) {
+      const size_t banding_bytes = static_cast<size_t>(
+          total_blocks * kRibbonBlockSlots *
+          (sizeof(Standard128RibbonTypesAndSettings::CoeffRow) +
+           sizeof(Standard128RibbonTypesAndSettings::ResultRow)));
+      Status s = reservation_->UpdateReserved(
+          num_entries * sizeof(uint64_t) + banding_bytes +
+          static_cast<size_t>(len + 5));
+      TEST_SYNC_POINT_CALLBACK(
+          "Standard128RibbonBitsBuilder::Finish:Reserved", &s);
+      if (!s.ok()) {
+        return FinishBloomFallback(buf, &shard_entries);
+      }
+    }
+
+    const uint32_t len_with_metadata = static_cast<uint32_t>(len + 5);
+    std::unique_ptr<char[]> mutable_buf(new char[len_with_metadata]());
+    std::vector<uint8_t> seeds(num_shards);
+    // Not vector<bool>, as shards are written from different threads
+    std::vector<uint8_t> solved(num_shards);
+    std::vector<char*> shard_data(num_shards);
+    char* next = mutable_buf.get();
+    for (uint32_t i = 0; i < num_shards; ++i) {
+      shard_data[i] = next;
+      next += size_t{shard_blocks[i]} * num_columns_ * kRibbonColumnBytes;
+    }
+
+    if (num_shards == 1) {
+      solved[0] = SolveShard(hash_entries_.begin(), hash_entries_.end(),
+                             shard_blocks[0], shard_data[0], &seeds[0]);
+    } else {
+      auto solve = [&](uint32_t i) {
+        solved[i] = SolveShard(shard_entries[i].begin(),
+                               shard_entries[i].end(), shard_blocks[i],
+                               shard_data[i], &seeds[i]);
+      };
+      std::vector<port::Thread> threads;
+      threads.reserve(num_shards - 1);
+      for (uint32_t i = 1; i < num_shards; ++i) {
+        threads.emplace_back(solve, i);
+      }
+      solve(0);
+      for (auto& t : threads) {
+        t.join();
+      }
+    }
+    for (uint32_t i = 0; i < num_shards; ++i) {
+      if (!solved[i]) {
+        return FinishBloomFallback(buf, &shard_entries);
+      }
+    }
+
+    // See BloomFilterPolicy::GetRibbonBitsReader re: layout
+    for (uint32_t i = 0; i < num_shards; ++i) {
+      EncodeFixed32(next, shard_blocks[i]);
+      next[4] = static_cast<char>(seeds[i]);
+      next += kRibbonShardInfoBytes;
+    }
+    *next++ = static_cast<char>(num_shards);
+    // -1 = Marker for newer Bloom implementations
+    next[0] = static_cast<char>(-1);
+    // 1 = Marker for this sub-implementation
+    next[1] = static_cast<char>(1);
+    next[2] = static_cast<char>(num_columns_);
+    // rest of metadata stays zero
+    assert(next + 5 == mutable_buf.get() + len_with_metadata);
+
+    hash_entries_.clear();
+    if (reservation_) {
+      reservation_->UpdateReserved(0).PermitUncheckedError();
+    }
+    Slice rv(mutable_buf.get(), len_with_metadata);
+    *buf = std::move(mutable_buf);
+    return rv;
+  }
+
+  int CalculateNumEntry(const uint32_t bytes) override {
+    const uint32_t block_bytes = num_columns_ * kRibbonColumnBytes;
+    const uint32_t overhead = kRibbonShardInfoBytes + 1 + 5;
+    if (bytes < overhead + block_bytes) {
+      return 0;
+    }
+    uint64_t slots =
+        uint64_t{(bytes - overhead) / block_bytes} * kRibbonBlockSlots;
+    // Invert BlocksForKeys, then correct for rounding
+    int num_entry = static_cast<int>(std::min<uint64_t>(
+        (slots - std::min<uint64_t>(slots, kRibbonExtraSlots)) *
+            kRibbonOverheadDivisor / (kRibbonOverheadDivisor + 1),
+        INT32_MAX));
+    while (num_entry > 0 && CalculateSpace(num_entry) > bytes) {
+      --num_entry;
+    }
+    return num_entry;
+  }
+
+  uint32_t CalculateSpace(const int num_entry) override {
+    if (num_entry <= 0) {
+      return 5;
+    }
+    // Assumes a single shard, as sharding depends on the build setting
+    uint64_t len = uint64_t{BlocksForKeys(static_cast<size_t>(num_entry))} *
+                       num_columns_ * kRibbonColumnBytes +
+                   kRibbonShardInfoBytes + 1 + 5;
+    return static_cast<uint32_t>(std::min(len, uint64_t{0xffffffff}));
+  }
+
+  double EstimatedFpRate(size_t keys, size_t /*bytes*/) override {
+    if (keys == 0) {
+      return 0.0;
+    }
+    return std::pow(2.0, -num_columns_);
+  }
+
+ private:
+  static uint32_t BlocksForKeys(size_t num_keys) {
+    uint64_t slots = uint64_t{num_keys} + num_keys / kRibbonOverheadDivisor +
+                     kRibbonExtraSlots;
+    return static_cast<uint32_t>(
+        std::min<uint64_t>((slots + kRibbonBlockSlots - 1) / kRibbonBlockSlots,
+                           0xffffffff));
+  }
+
+  uint32_t ChooseNumShards(size_t num_entries) const {
+    if (parallel_threads_ <= 1) {
+      return 1;
+    }
+    size_t max_shards = num_entries / kMinKeysPerRibbonShard;
+    return static_cast<uint32_t>(std::max<size_t>(
+        1, std::min<size_t>({max_shards, parallel_threads_,
+                             kMaxRibbonShards})));
+  }
+
+  // Bands the keys into num_blocks blocks, trying seeds until a solution
+  // exists, and back-substitutes the solution into `out`.
+  template <typename InputIterator>
+  bool SolveShard(InputIterator begin, InputIterator end, uint32_t num_blocks,
+                  char* out, uint8_t* seed) const {
+    Standard128RibbonBanding banding;
+    if (!banding.ResetAndFindSeedToSolve(num_blocks * kRibbonBlockSlots, begin,
+                                         end, kMaxRibbonSeed)) {
+      return false;
+    }
+    *seed = static_cast<uint8_t>(banding.GetSeed());
+    InterleavedBackSubst(&banding, out);
+    return true;
+  }
+
+  // Back-substitution straight into the interleaved layout. Going from the
+  // last slot to the first, the state of each column holds the solution
+  // bits of the next 128 slots, so once the first slot of a block is done
+  // it is exactly that block's word for the column.
+  void InterleavedBackSubst(Standard128RibbonBanding* banding,
+                            char* out) const {
+    std::array<Unsigned128, kMaxRibbonColumns> state;
+    state.fill(0);
+    const uint32_t num_slots = banding->GetNumStarts() + kRibbonBlockSlots - 1;
+    for (uint32_t i = num_slots; i > 0;) {
+      --i;
+      const Unsigned128 cr = *banding->CoeffRowPtr(i);
+      const uint16_t rr = *banding->ResultRowPtr(i);
+      for (int c = 0; c < num_columns_; ++c) {
+        Unsigned128 tmp = state[c] << 1;
+        int bit = BitParity(tmp & cr) ^ ((rr >> c) & 1);
+        state[c] = tmp | Unsigned128{static_cast<uint64_t>(bit)};
+      }
+      if (i % kRibbonBlockSlots == 0) {
+        char* block = out + size_t{i / kRibbonBlockSlots} * num_columns_ *
+                                kRibbonColumnBytes;
+        for (int c = 0; c < num_columns_; ++c) {
+          EncodeFixed128(block + c * kRibbonColumnBytes, state[c]);
+        }
+      }
+    }
+  }
+
+  Slice FinishBloomFallback(
+      std::unique_ptr<const char[]>* buf,
+      std::vector<std::vector<uint64_t>>* shard_entries) {
+    for (uint64_t h : hash_entries_) {
+      bloom_fallback_.AddHash(h);
+    }
+    hash_entries_.clear();
+    for (auto& entries : *shard_entries) {
+      for (uint64_t h : entries) {
+        bloom_fallback_.AddHash(h);
+      }
+      std::vector<uint64_t>().swap(entries);
+    }
+    if (reservation_) {
+      reservation_->UpdateReserved(0).PermitUncheckedError();
+    }
+    return bloom_fallback_.Finish(buf);
+  }
+
+  const int num_columns_;
+  const uint32_t parallel_threads_;
+  // For when no solution is found or memory can't be reserved
+  FastLocalBloomBitsBuilder bloom_fallback_;
+  // Non-null with reserve_table_builder_memory
+  std::unique_ptr<FilterConstructionReservation> reservation_;
+  // A deque avoids unnecessary copying of already-saved values
+  // and has near-minimal peak memory use.
+  std::deque<uint64_t> hash_entries_;
+};
+
+// See description in Standard128RibbonBitsBuilder
+class Standard128RibbonBitsReader : public FilterBitsReader {
+ public:
+  struct Shard {
+    const char* data;
+    uint32_t num_starts;
+    Standard128RibbonHasher hasher;
+  };
+
+  Standard128RibbonBitsReader(std::vector<Shard>&& shards, int num_columns)
+      : shards_(std::move(shards)),
+        num_shards_(static_cast<uint32_t>(shards_.size())),
+        num_columns_(num_columns) {}
+
+  // No Copy allowed
+  Standard128RibbonBitsReader(const Standard128RibbonBitsReader&) = delete;
+  void operator=(const Standard128RibbonBitsReader&) = delete;
+
+  ~Standard128RibbonBitsReader() override {}
+
+  bool MayMatch(const Slice& key) override {
+    Prepared p;
+    Prepare(GetSliceHash64(key), &p);
+    return MayMatchPrepared(p);
+  }
+
+  virtual void MayMatch(int num_keys, Slice** keys, bool* may_match) override {
+    std::array<Prepared, MultiGetContext::MAX_BATCH_SIZE> prepared;
+    for (int i = 0; i < num_keys; ++i) {
+      Prepare(GetSliceHash64(*keys[i]), &prepared[i]);
+    }
+    for (int i = 0; i < num_keys; ++i) {
+      may_match[i] = MayMatchPrepared(prepared[i]);
+    }
+  }
+
+ private:
+  struct Prepared {
+    const char* block;
+    uint32_t shift;
+    Unsigned128 cr;
+    uint16_t expected;
+  };
+
+  void Prepare(uint64_t h, Prepared* p) const {
+    const Shard& shard = shards_[num_shards_ == 1
+                                     ? 0
+                                     : FastRange32(Lower32of64(h), num_shards_)];
+    uint64_t rehashed = shard.hasher.GetHash(h);
+    uint32_t start = shard.hasher.GetStart(rehashed, shard.num_starts);
+    p->block = shard.data + size_t{start / kRibbonBlockSlots} * num_columns_ *
+                                kRibbonColumnBytes;
+    p->shift = start % kRibbonBlockSlots;
+    p->cr = shard.hasher.GetCoeffRow(rehashed);
+    p->expected = shard.hasher.GetResultRowFromHash(rehashed);
+    PREFETCH(p->block, 0 /* rw */, 1 /* locality */);
+    if (p->shift > 0) {
+      PREFETCH(p->block + num_columns_ * kRibbonColumnBytes * 2 - 1,
+               0 /* rw */, 1 /* locality */);
+    }
+  }
+
+  bool MayMatchPrepared(const Prepared& p) const {
+    // The coefficients cover slots shift..127 of this block and, unless
+    // shift is 0, slots 0..shift-1 of the next one
+    const Unsigned128 lo = p.cr << p.shift;
+    const char* next_block = p.block + num_columns_ * kRibbonColumnBytes;
+    if (p.shift == 0) {
+      for (int c = 0; c < num_columns_; ++c) {
+        int bit =
+            BitParity(DecodeFixed128(p.block + c * kRibbonColumnBytes) & lo);
+        if (bit != ((p.expected >> c) & 1)) {
+          return false;
+        }
+      }
+    } else {
+      const Unsigned128 hi = p.cr >> (kRibbonBlockSlots - p.shift);
+      for (int c = 0; c < num_columns_; ++c) {
+        int bit =
+            BitParity(DecodeFixed128(p.block + c * kRibbonColumnBytes) & lo) ^
+            BitParity(DecodeFixed128(next_block + c * kRibbonColumnBytes) &
+                      hi);
+        if (bit != ((p.expected >> c) & 1)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  const std::vector<Shard> shards_;
+  const uint32_t num_shards_;
+  const int num_columns_;
+};
+
 using LegacyBloomImpl = LegacyLocalityBloomImpl</*ExtraRotates*/ false>;
 
 class LegacyBloomBitsBuilder : public BuiltinFilterBitsBuilder {
@@ -600,6 +1105,7 @@ const std::vector<BloomFilterPolicy::Mode> BloomFilterPolicy::kAllFixedImpls = {
 const std::vector<BloomFilterPolicy::Mode> BloomFilterPolicy::kAllUserModes = {
     kDeprecatedBlock,
     kAuto,
+    kStandard128Ribbon,
 };
 
 BloomFilterPolicy::BloomFilterPolicy(double bits_per_key, Mode mode)
@@ -712,6 +1218,14 @@ FilterBitsBuilder* BloomFilterPolicy::GetBuilderWithContext(
       case kFastLocalBloom:
         return new FastLocalBloomBitsBuilder(
             millibits_per_key_, offm ? &aggregate_rounding_balance_ : nullptr);
+      case kStandard128Ribbon:
+        return new Standard128RibbonBitsBuilder(
+            Standard128RibbonBitsBuilder::ColumnsForBloomEquivalent(
+                millibits_per_key_),
+            millibits_per_key_, context.parallel_threads,
+            context.table_options.reserve_table_builder_memory
+                ? context.table_options.block_cache
+                : nullptr);
       case kLegacyBloom:
         if (whole_bits_per_key_ >= 14 && context.info_log &&
             !warned_.load(std::memory_order_relaxed)) {
@@ -841,6 +1355,8 @@ FilterBitsReader* BloomFilterPolicy::GetBloomBitsReader(
   //         len+1 +-----------------------------------+
   //               | byte for subimplementation        |
   //               |   0: FastLocalBloom               |
+  //               |   1: Standard128Ribbon (see       |
+  //               |      GetRibbonBitsReader)         |
   //               |   other: reserved                 |
   //         len+2 +-----------------------------------+
   //               | byte for block_and_probes         |
@@ -858,6 +1374,9 @@ FilterBitsReader* BloomFilterPolicy::GetBloomBitsReader(
 
   // Read more metadata (see above)
   char sub_impl_val = contents.data()[len_with_meta - 4];
+  if (sub_impl_val == 1) {
+    return GetRibbonBitsReader(contents);
+  }
   char block_and_probes = contents.data()[len_with_meta - 3];
   int log2_block_bytes = ((block_and_probes >> 5) & 7) + 6;
 
@@ -884,6 +1403,77 @@ FilterBitsReader* BloomFilterPolicy::GetBloomBitsReader(
   return new AlwaysTrueFilter();
 }
 
+// For Standard128Ribbon filters
+FilterBitsReader* BloomFilterPolicy::GetRibbonBitsReader(
+    const Slice& contents) const {
+  uint32_t len_with_meta = static_cast<uint32_t>(contents.size());
+  uint32_t len = len_with_meta - 5;
+
+  assert(len > 0);  // precondition
+
+  // Standard128Ribbon filter data:
+  //             0 +-----------------------------------+
+  //               | Shard 0 solution: num_blocks      |
+  //               |   blocks of num_columns 16-byte   |
+  //               |   words (see                      |
+  //               |   Standard128RibbonBitsBuilder)   |
+  //               | ...                               |
+  //               | Shard n-1 solution                |
+  //               +-----------------------------------+
+  //               | Per shard: four bytes for         |
+  //               |   num_blocks, byte for seed       |
+  //         len-1 +-----------------------------------+
+  //               | byte for number of shards n       |
+  //           len +-----------------------------------+
+  //               | char{-1} byte -> new Bloom filter |
+  //         len+1 +-----------------------------------+
+  //               | char{1} -> Standard128Ribbon      |
+  //         len+2 +-----------------------------------+
+  //               | byte for num_columns, 1 to 16     |
+  //         len+3 +-----------------------------------+
+  //               | two bytes reserved                |
+  // len_with_meta +-----------------------------------+
+  //
+  // A key goes to shard FastRange32(lower 32 bits of hash, n).
+
+  const char* data = contents.data();
+  int num_columns = static_cast<uint8_t>(data[len_with_meta - 3]);
+  uint16_t rest = DecodeFixed16(data + len_with_meta - 2);
+  uint32_t num_shards = static_cast<uint8_t>(data[len - 1]);
+  if (num_columns < 1 || num_columns > kMaxRibbonColumns || rest != 0 ||
+      num_shards == 0 || len < 1 + num_shards * kRibbonShardInfoBytes) {
+    // Reserved / future safe
+    return new AlwaysTrueFilter();
+  }
+
+  const char* shard_info = data + len - 1 - num_shards * kRibbonShardInfoBytes;
+  const uint64_t solution_len = static_cast<uint64_t>(shard_info - data);
+  std::vector<Standard128RibbonBitsReader::Shard> shards;
+  shards.reserve(num_shards);
+  uint64_t offset = 0;
+  for (uint32_t i = 0; i < num_shards; ++i) {
+    uint32_t num_blocks = DecodeFixed32(shard_info);
+    uint8_t seed = static_cast<uint8_t>(shard_info[4]);
+    shard_info += kRibbonShardInfoBytes;
+    uint64_t shard_len =
+        uint64_t{num_blocks} * num_columns * kRibbonColumnBytes;
+    if (num_blocks == 0 || num_blocks > 0xffffffffU / kRibbonBlockSlots ||
+        shard_len > solution_len - offset) {
+      // Corrupt
+      return new AlwaysTrueFilter();
+    }
+    shards.push_back({data + offset,
+                      num_blocks * kRibbonBlockSlots - kRibbonBlockSlots + 1,
+                      Standard128RibbonHasher(seed)});
+    offset += shard_len;
+  }
+  if (offset != solution_len) {
+    // Corrupt
+    return new AlwaysTrueFilter();
+  }
+  return new Standard128RibbonBitsReader(std::move(shards), num_columns);
+}
+
 const FilterPolicy* NewBloomFilterPolicy(double bits_per_key,
                                          bool use_block_based_builder) {
   BloomFilterPolicy::Mode m;
@@ -898,6 +1488,12 @@ const FilterPolicy* NewBloomFilterPolicy(double bits_per_key,
   return new BloomFilterPolicy(bits_per_key, m);
 }
 
+const FilterPolicy* NewExperimentalRibbonFilterPolicy(
+    double bloom_equivalent_bits_per_key) {
+  return new BloomFilterPolicy(bloom_equivalent_bits_per_key,
+                               BloomFilterPolicy::kStandard128Ribbon);
+}
+
 FilterBuildingContext::FilterBuildingContext(
     const BlockBasedTableOptions& _table_options)
     : table_options(_table_options) {}
@@ -908,6 +1504,7 @@ Status FilterPolicy::CreateFromString(
     const ConfigOptions& /*options*/, const std::string& value,
     std::shared_ptr<const FilterPolicy>* policy) {
   const std::string kBloomName = "bloomfilter:";
+  const std::string kRibbonName = "ribbonfilter:";
   if (value == kNullptrString || value == "rocksdb.BuiltinBloomFilter") {
     policy->reset();
 #ifndef ROCKSDB_LITE
@@ -924,6 +1521,11 @@ Status FilterPolicy::CreateFromString(
       policy->reset(
           NewBloomFilterPolicy(bits_per_key, use_block_based_builder));
     }
+  } else if (value.compare(0, kRibbonName.size(), kRibbonName) == 0) {
+    double bloom_equivalent_bits_per_key =
+        ParseDouble(trim(value.substr(kRibbonName.size())));
+    policy->reset(
+        NewExperimentalRibbonFilterPolicy(bloom_equivalent_bits_per_key));
   } else {
     return Status::NotFound("Invalid filter policy name ", value);
 #else
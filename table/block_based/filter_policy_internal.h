@@ -64,6 +64,10 @@ class BloomFilterPolicy : public FilterPolicy {
     // FastLocalBloomImpl.
     // NOTE: TESTING ONLY as this mode does not check format_version
     kFastLocalBloom = 2,
+    // A Ribbon filter with the FP rate of Bloom at the same bits/key setting
+    // and about 30% less space. See Standard128RibbonBitsBuilder.
+    // NOTE: user exposed through NewExperimentalRibbonFilterPolicy
+    kStandard128Ribbon = 3,
     // Automatically choose from the above (except kDeprecatedBlock) based on
     // context at build time, including compatibility with format_version.
     // NOTE: This is currently the only recommended mode that is user exposed.
@@ -147,6 +151,9 @@ class BloomFilterPolicy : public FilterPolicy {
 
   // For newer Bloom filter implementation(s)
   FilterBitsReader* GetBloomBitsReader(const Slice& contents) const;
+
+  // For Ribbon filters, a sub-implementation of the above
+  FilterBitsReader* GetRibbonBitsReader(const Slice& contents) const;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
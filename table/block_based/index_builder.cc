@@ -10,6 +10,7 @@
 #include "table/block_based/index_builder.h"
 
 #include <assert.h>
+#include <algorithm>
 #include <cinttypes>
 
 #include <list>
@@ -61,6 +62,11 @@ IndexBuilder* IndexBuilder::CreateIndexBuilder(
           table_opt.index_shortening, /* include_first_key */ true);
       break;
     }
+    case BlockBasedTableOptions::kSuccinctTrieSearch: {
+      result =
+          new SuccinctTrieIndexBuilder(comparator, table_opt.index_shortening);
+      break;
+    }
     default: {
       assert(!"Do not recognize the index type ");
       break;
@@ -69,6 +75,98 @@ IndexBuilder* IndexBuilder::CreateIndexBuilder(
   return result;
 }
 
+void SuccinctTrieIndexBuilder::AddIndexEntry(
+    std::string* last_key_in_current_block,
+    const Slice* first_key_in_next_block, const BlockHandle& block_handle) {
+  if (first_key_in_next_block != nullptr) {
+    if (shortening_mode_ !=
+        BlockBasedTableOptions::IndexShorteningMode::kNoShortening) {
+      comparator_->FindShortestSeparator(last_key_in_current_block,
+                                         *first_key_in_next_block);
+    }
+    if (!seperator_is_key_plus_seq_ &&
+        comparator_->user_comparator()->Compare(
+            ExtractUserKey(*last_key_in_current_block),
+            ExtractUserKey(*first_key_in_next_block)) == 0) {
+      seperator_is_key_plus_seq_ = true;
+    }
+  } else {
+    if (shortening_mode_ == BlockBasedTableOptions::IndexShorteningMode::
+                                kShortenSeparatorsAndSuccessor) {
+      comparator_->FindShortSuccessor(last_key_in_current_block);
+    }
+  }
+  Slice sep(*last_key_in_current_block);
+  Slice user_key = ExtractUserKey(sep);
+  // Separators never decrease, so equal user keys are adjacent
+  bool new_key = handles_.empty() || user_key != Slice(last_user_key_);
+  if (new_key) {
+    trie_builder_.Add(user_key);
+    last_user_key_.assign(user_key.data(), user_key.size());
+  }
+  run_starts_.push_back(new_key);
+  seq_and_types_.push_back(ExtractInternalKeyFooter(sep));
+  handles_.push_back(block_handle);
+}
+
+Status SuccinctTrieIndexBuilder::Finish(
+    IndexBlocks* index_blocks,
+    const BlockHandle& /*last_partition_block_handle*/) {
+  // Separators are only shared by entries when seq is part of the key
+  assert(seperator_is_key_plus_seq_ ||
+         trie_builder_.NumKeys() == handles_.size());
+  const uint32_t num_entries = static_cast<uint32_t>(handles_.size());
+  bool contiguous = true;
+  uint64_t max_size = 0;
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    max_size = std::max(max_size, handles_[i].size());
+    if (i > 0 && handles_[i].offset() != handles_[i - 1].offset() +
+                                             handles_[i - 1].size() +
+                                             kBlockTrailerSize) {
+      contiguous = false;
+    }
+  }
+  uint32_t size_width = PackedIntArray::BitsNeeded(max_size);
+  if (size_width > 32) {
+    return Status::NotSupported("Data block too large for trie index");
+  }
+  uint8_t flags = 0;
+  if (seperator_is_key_plus_seq_) {
+    flags |= kKeysIncludeSeq;
+  }
+  if (contiguous) {
+    flags |= kContiguousBlocks;
+  }
+
+  std::string trie;
+  trie_builder_.Finish(&trie);
+  index_block_.clear();
+  PutFixed32(&index_block_, num_entries);
+  PutFixed32(&index_block_, static_cast<uint32_t>(trie.size()));
+  index_block_.push_back(static_cast<char>(flags));
+  index_block_.push_back(static_cast<char>(size_width));
+  index_block_.append(trie);
+  if (seperator_is_key_plus_seq_) {
+    SuccinctBitVector::Append(run_starts_, &index_block_);
+    for (uint64_t seq_and_type : seq_and_types_) {
+      PutFixed64(&index_block_, seq_and_type);
+    }
+  }
+  std::vector<uint32_t> sizes;
+  sizes.reserve(num_entries);
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    if (!contiguous || i % kOffsetSampleInterval == 0) {
+      PutFixed64(&index_block_, handles_[i].offset());
+    }
+    sizes.push_back(static_cast<uint32_t>(handles_[i].size()));
+  }
+  PackedIntArray::Append(sizes, size_width, &index_block_);
+
+  index_blocks->index_block_contents = index_block_;
+  index_size_ = index_block_.size();
+  return Status::OK();
+}
+
 PartitionedIndexBuilder* PartitionedIndexBuilder::CreateIndexBuilder(
     const InternalKeyComparator* comparator,
     const bool use_value_delta_encoding,
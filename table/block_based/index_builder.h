@@ -15,10 +15,12 @@
 #include <list>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_builder.h"
+#include "table/block_based/succinct_trie.h"
 #include "table/format.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -353,6 +355,67 @@ class HashIndexBuilder : public IndexBuilder {
   uint64_t current_restart_index_ = 0;
 };
 
+// SuccinctTrieIndexBuilder builds the kSuccinctTrieSearch index. Separators
+// are picked like in ShortenedIndexBuilder, their user keys are stored in a
+// SuccinctTrie and the block handles in sorted order in bit-packed arrays.
+// The index block format:
+//
+// [NUM_ENTRIES: fixed32][TRIE_SIZE: fixed32][FLAGS: 1 byte]
+// [SIZE_WIDTH: 1 byte][TRIE: TRIE_SIZE bytes]
+// if FLAGS & kKeysIncludeSeq:
+//   [RUN_STARTS: SuccinctBitVector of NUM_ENTRIES bits]
+//   [SEQ_AND_TYPES: NUM_ENTRIES x fixed64]
+// if FLAGS & kContiguousBlocks:
+//   [OFFSETS: ceil(NUM_ENTRIES / kOffsetSampleInterval) x fixed64]
+// else:
+//   [OFFSETS: NUM_ENTRIES x fixed64]
+// [SIZES: PackedIntArray of SIZE_WIDTH bits]
+//
+// The trie holds distinct user keys, so entry i has the key of trie rank i.
+// Only when a user key spans data blocks do several consecutive entries share
+// a key. Then, like the key+seq format of ShortenedIndexBuilder, every entry
+// keeps the packed sequence number and type of its separator and RUN_STARTS
+// marks the first entry of each key. When the data blocks follow each other
+// without gaps, only every kOffsetSampleInterval-th offset is stored and the
+// others are derived from the block sizes.
+class SuccinctTrieIndexBuilder : public IndexBuilder {
+ public:
+  static const uint8_t kKeysIncludeSeq = 0x1;
+  static const uint8_t kContiguousBlocks = 0x2;
+  static const uint32_t kOffsetSampleInterval = 16;
+  static const size_t kHeaderSize = 10;
+
+  SuccinctTrieIndexBuilder(
+      const InternalKeyComparator* comparator,
+      BlockBasedTableOptions::IndexShorteningMode shortening_mode)
+      : IndexBuilder(comparator), shortening_mode_(shortening_mode) {}
+
+  virtual void AddIndexEntry(std::string* last_key_in_current_block,
+                             const Slice* first_key_in_next_block,
+                             const BlockHandle& block_handle) override;
+
+  using IndexBuilder::Finish;
+  virtual Status Finish(
+      IndexBlocks* index_blocks,
+      const BlockHandle& last_partition_block_handle) override;
+
+  virtual size_t IndexSize() const override { return index_size_; }
+
+  virtual bool seperator_is_key_plus_seq() override {
+    return seperator_is_key_plus_seq_;
+  }
+
+ private:
+  const BlockBasedTableOptions::IndexShorteningMode shortening_mode_;
+  SuccinctTrieBuilder trie_builder_;
+  std::string last_user_key_;
+  std::vector<bool> run_starts_;
+  std::vector<uint64_t> seq_and_types_;
+  std::vector<BlockHandle> handles_;
+  bool seperator_is_key_plus_seq_ = false;
+  std::string index_block_;
+};
+
 /**
  * IndexBuilder for two-level indexing. Internally it creates a new index for
  * each partition and Finish then in order when Finish is called on it
@@ -42,8 +42,9 @@ class MockBlockBasedTableTester {
         12345 /*file_size*/, kMockLevel, immortal_table)));
   }
 
-  FilterBitsBuilder* GetBuilder() const {
+  FilterBitsBuilder* GetBuilder(uint32_t parallel_threads = 1) const {
     FilterBuildingContext context(table_options_);
+    context.parallel_threads = parallel_threads;
     context.column_family_name = "mock_cf";
     context.compaction_style = ioptions_.compaction_style;
     context.level_at_creation = kMockLevel;
@@ -8,13 +8,17 @@
 #include <utility>
 
 #include "file/file_util.h"
+#include "file/random_access_file_reader.h"
 #include "monitoring/perf_context_imp.h"
 #include "port/malloc.h"
 #include "port/port.h"
 #include "rocksdb/filter_policy.h"
 #include "table/block_based/block.h"
 #include "table/block_based/block_based_table_reader.h"
+#include "table/block_based/reader_common.h"
+#include "test_util/sync_point.h"
 #include "util/coding.h"
+#include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -232,30 +236,40 @@ void PartitionedFilterBlockReader::PrefixesMayMatch(
            &FullFilterBlockReader::PrefixesMayMatch);
 }
 
-BlockHandle PartitionedFilterBlockReader::GetFilterPartitionHandle(
-    const CachableEntry<Block>& filter_block, const Slice& entry) const {
-  IndexBlockIter iter;
+void PartitionedFilterBlockReader::NewPartitionIndexIterator(
+    const CachableEntry<Block>& filter_block, IndexBlockIter* iter) const {
   const InternalKeyComparator* const comparator = internal_comparator();
   Statistics* kNullStats = nullptr;
   filter_block.GetValue()->NewIndexIterator(
       comparator->user_comparator(),
-      table()->get_rep()->get_global_seqno(BlockType::kFilter), &iter,
+      table()->get_rep()->get_global_seqno(BlockType::kFilter), iter,
       kNullStats, true /* total_order_seek */, false /* have_first_key */,
       index_key_includes_seq(), index_value_is_full());
-  iter.Seek(entry);
-  if (UNLIKELY(!iter.Valid())) {
+}
+
+BlockHandle PartitionedFilterBlockReader::SeekFilterPartitionHandle(
+    IndexBlockIter* iter, const Slice& entry) {
+  iter->Seek(entry);
+  if (UNLIKELY(!iter->Valid())) {
     // entry is larger than all the keys. However its prefix might still be
     // present in the last partition. If this is called by PrefixMayMatch this
     // is necessary for correct behavior. Otherwise it is unnecessary but safe.
     // Assuming this is an unlikely case for full key search, the performance
     // overhead should be negligible.
-    iter.SeekToLast();
+    iter->SeekToLast();
   }
-  assert(iter.Valid());
-  BlockHandle fltr_blk_handle = iter.value().handle;
+  assert(iter->Valid());
+  BlockHandle fltr_blk_handle = iter->value().handle;
   return fltr_blk_handle;
 }
 
+BlockHandle PartitionedFilterBlockReader::GetFilterPartitionHandle(
+    const CachableEntry<Block>& filter_block, const Slice& entry) const {
+  IndexBlockIter iter;
+  NewPartitionIndexIterator(filter_block, &iter);
+  return SeekFilterPartitionHandle(&iter, entry);
+}
+
 Status PartitionedFilterBlockReader::GetFilterPartitionBlock(
     FilePrefetchBuffer* prefetch_buffer, const BlockHandle& fltr_blk_handle,
     bool no_io, GetContext* get_context,
@@ -327,6 +341,118 @@ bool PartitionedFilterBlockReader::MayMatch(
       lookup_context);
 }
 
+void PartitionedFilterBlockReader::GetFilterPartitionBlocks(
+    const PartitionHandles& handles, bool no_io, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context, PartitionEntries* partitions,
+    PartitionStatuses* statuses) const {
+  assert(table());
+  const BlockBasedTable::Rep* const rep = table()->get_rep();
+  assert(rep);
+
+  partitions->resize(handles.size());
+  statuses->resize(handles.size());
+
+  // The batched read below bypasses the persistent cache and the mmap reads
+  // of RetrieveBlock, so leave those setups to it.
+  if (no_io || rep->ioptions.allow_mmap_reads ||
+      rep->persistent_cache_options.persistent_cache != nullptr) {
+    for (size_t i = 0; i < handles.size(); ++i) {
+      (*statuses)[i] =
+          GetFilterPartitionBlock(nullptr /* prefetch_buffer */, handles[i],
+                                  no_io, get_context, lookup_context,
+                                  &(*partitions)[i]);
+    }
+    return;
+  }
+
+  // Pinned and cached partitions first, without any I/O
+  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> missing;
+  for (size_t i = 0; i < handles.size(); ++i) {
+    (*statuses)[i] =
+        GetFilterPartitionBlock(nullptr /* prefetch_buffer */, handles[i],
+                                true /* no_io */, get_context, lookup_context,
+                                &(*partitions)[i]);
+    if ((*statuses)[i].IsIncomplete()) {
+      missing.push_back(i);
+    }
+  }
+  if (missing.empty()) {
+    return;
+  }
+
+  // Then fetch all the missing partitions with a single MultiRead
+  RandomAccessFileReader* const file = rep->file.get();
+  autovector<FSReadRequest, MultiGetContext::MAX_BATCH_SIZE> read_reqs;
+  for (size_t i : missing) {
+    FSReadRequest req;
+    req.offset = handles[i].offset();
+    req.len = static_cast<size_t>(handles[i].size()) + kBlockTrailerSize;
+    req.scratch = file->use_direct_io() ? nullptr : new char[req.len];
+    read_reqs.push_back(req);
+  }
+
+  size_t num_reads = read_reqs.size();
+  TEST_SYNC_POINT_CALLBACK(
+      "PartitionedFilterBlockReader::GetFilterPartitionBlocks:MultiRead",
+      &num_reads);
+  ReadOptions read_options;
+  AlignedBuf direct_io_buf;
+  IOOptions opts;
+  Status s = PrepareIOFromReadOptions(read_options, file->env(), opts);
+  if (s.ok()) {
+    s = file->MultiRead(opts, &read_reqs[0], read_reqs.size(),
+                        &direct_io_buf);
+  }
+
+  for (size_t j = 0; j < missing.size(); ++j) {
+    const size_t i = missing[j];
+    const BlockHandle& handle = handles[i];
+    FSReadRequest& req = read_reqs[j];
+    std::unique_ptr<char[]> buf(req.scratch);
+    Status read_status = s.ok() ? req.status : s;
+    if (read_status.ok() && req.result.size() != req.len) {
+      read_status = Status::Corruption(
+          "truncated filter partition read from " + file->file_name() +
+          " offset " + ROCKSDB_NAMESPACE::ToString(handle.offset()) +
+          ", expected " + ROCKSDB_NAMESPACE::ToString(req.len) +
+          " bytes, got " + ROCKSDB_NAMESPACE::ToString(req.result.size()));
+    }
+    if (read_status.ok() && read_options.verify_checksums) {
+      read_status = VerifyBlockChecksum(rep->footer.checksum(),
+                                        req.result.data(), handle.size(),
+                                        file->file_name(), handle.offset());
+    }
+    if (get_context) {
+      ++get_context->get_context_stats_.num_filter_read;
+    }
+    if (!read_status.ok()) {
+      (*statuses)[i] = read_status;
+      continue;
+    }
+
+    if (buf == nullptr) {
+      // Direct IO results point into the shared aligned buffer
+      buf.reset(new char[req.len]);
+      memcpy(buf.get(), req.result.data(), req.len);
+    }
+    BlockContents contents(std::move(buf), handle.size());
+#ifndef NDEBUG
+    contents.is_raw_block = true;
+#endif
+
+    CachableEntry<ParsedFullFilterBlock>* partition = &(*partitions)[i];
+    (*statuses)[i] = table()->MaybeReadBlockAndLoadToCache(
+        nullptr /* prefetch_buffer */, read_options, handle,
+        UncompressionDict::GetEmptyDict(), partition, BlockType::kFilter,
+        get_context, lookup_context, &contents);
+    if ((*statuses)[i].ok() && partition->GetValue() == nullptr) {
+      // No block cache to hold the partition
+      partition->SetOwnedValue(new ParsedFullFilterBlock(
+          rep->table_options.filter_policy.get(), std::move(contents)));
+    }
+  }
+}
+
 void PartitionedFilterBlockReader::MayMatch(
     MultiGetRange* range, const SliceTransform* prefix_extractor,
     uint64_t block_offset, bool no_io, BlockCacheLookupContext* lookup_context,
@@ -343,61 +469,49 @@ void PartitionedFilterBlockReader::MayMatch(
     return;  // Any/all may match
   }
 
-  auto start_iter_same_handle = range->begin();
-  BlockHandle prev_filter_handle = BlockHandle::NullBlockHandle();
-
-  // For all keys mapping to same partition (must be adjacent in sorted order)
-  // share block cache lookup and use full filter multiget on the partition
-  // filter.
-  for (auto iter = start_iter_same_handle; iter != range->end(); ++iter) {
-    // TODO: re-use one top-level index iterator
+  // Map every key to its partition first. The keys are sorted, so keys
+  // mapping to the same partition are adjacent and share one lookup and one
+  // full filter multiget on the partition.
+  IndexBlockIter index_iter;
+  NewPartitionIndexIterator(filter_block, &index_iter);
+  PartitionHandles handles;
+  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> first_key_index;
+  for (auto iter = range->begin(); iter != range->end(); ++iter) {
     BlockHandle this_filter_handle =
-        GetFilterPartitionHandle(filter_block, iter->ikey);
-    if (!prev_filter_handle.IsNull() &&
-        this_filter_handle != prev_filter_handle) {
-      MultiGetRange subrange(*range, start_iter_same_handle, iter);
-      MayMatchPartition(&subrange, prefix_extractor, block_offset,
-                        prev_filter_handle, no_io, lookup_context,
-                        filter_function);
-      range->AddSkipsFrom(subrange);
-      start_iter_same_handle = iter;
-    }
-    if (UNLIKELY(this_filter_handle.size() == 0)) {  // key is out of range
-      // Not reachable with current behavior of GetFilterPartitionHandle
-      assert(false);
-      range->SkipKey(iter);
-      prev_filter_handle = BlockHandle::NullBlockHandle();
-    } else {
-      prev_filter_handle = this_filter_handle;
+        SeekFilterPartitionHandle(&index_iter, iter->ikey);
+    // Not reachable with current behavior of SeekFilterPartitionHandle
+    assert(this_filter_handle.size() != 0);
+    if (handles.empty() || this_filter_handle != handles.back()) {
+      handles.push_back(this_filter_handle);
+      first_key_index.push_back(iter.index());
     }
   }
-  if (!prev_filter_handle.IsNull()) {
-    MultiGetRange subrange(*range, start_iter_same_handle, range->end());
-    MayMatchPartition(&subrange, prefix_extractor, block_offset,
-                      prev_filter_handle, no_io, lookup_context,
-                      filter_function);
-    range->AddSkipsFrom(subrange);
+  if (handles.empty()) {
+    return;
   }
-}
 
-void PartitionedFilterBlockReader::MayMatchPartition(
-    MultiGetRange* range, const SliceTransform* prefix_extractor,
-    uint64_t block_offset, BlockHandle filter_handle, bool no_io,
-    BlockCacheLookupContext* lookup_context,
-    FilterManyFunction filter_function) const {
-  CachableEntry<ParsedFullFilterBlock> filter_partition_block;
-  Status s = GetFilterPartitionBlock(
-      nullptr /* prefetch_buffer */, filter_handle, no_io,
-      range->begin()->get_context, lookup_context, &filter_partition_block);
-  if (UNLIKELY(!s.ok())) {
-    IGNORE_STATUS_IF_ERROR(s);
-    return;  // Any/all may match
+  // Get all the partitions before probing any of them, so the ones missing
+  // from the block cache are read together rather than one after another
+  PartitionEntries partitions;
+  PartitionStatuses statuses;
+  GetFilterPartitionBlocks(handles, no_io, range->begin()->get_context,
+                           lookup_context, &partitions, &statuses);
+
+  for (size_t i = 0; i < handles.size(); ++i) {
+    if (UNLIKELY(!statuses[i].ok())) {
+      IGNORE_STATUS_IF_ERROR(statuses[i]);
+      continue;  // Any/all keys of the partition may match
+    }
+    MultiGetRange subrange(
+        *range, MultiGetRange::Iterator(range, first_key_index[i]),
+        i + 1 < handles.size()
+            ? MultiGetRange::Iterator(range, first_key_index[i + 1])
+            : range->end());
+    FullFilterBlockReader filter_partition(table(), std::move(partitions[i]));
+    (filter_partition.*filter_function)(&subrange, prefix_extractor,
+                                        block_offset, no_io, lookup_context);
+    range->AddSkipsFrom(subrange);
   }
-
-  FullFilterBlockReader filter_partition(table(),
-                                         std::move(filter_partition_block));
-  (filter_partition.*filter_function)(range, prefix_extractor, block_offset,
-                                      no_io, lookup_context);
 }
 
 size_t PartitionedFilterBlockReader::ApproximateMemoryUsage() const {
@@ -437,13 +551,7 @@ Status PartitionedFilterBlockReader::CacheDependencies(const ReadOptions& ro,
   assert(filter_block.GetValue());
 
   IndexBlockIter biter;
-  const InternalKeyComparator* const comparator = internal_comparator();
-  Statistics* kNullStats = nullptr;
-  filter_block.GetValue()->NewIndexIterator(
-      comparator->user_comparator(), rep->get_global_seqno(BlockType::kFilter),
-      &biter, kNullStats, true /* total_order_seek */,
-      false /* have_first_key */, index_key_includes_seq(),
-      index_value_is_full());
+  NewPartitionIndexIterator(filter_block, &biter);
   // Index partitions are assumed to be consecuitive. Prefetch them all.
   // Read the first block offset
   biter.SeekToFirst();
@@ -99,6 +99,10 @@ class PartitionedFilterBlockReader : public FilterBlockReaderCommon<Block> {
   size_t ApproximateMemoryUsage() const override;
 
  private:
+  void NewPartitionIndexIterator(const CachableEntry<Block>& filter_block,
+                                 IndexBlockIter* iter) const;
+  static BlockHandle SeekFilterPartitionHandle(IndexBlockIter* iter,
+                                               const Slice& entry);
   BlockHandle GetFilterPartitionHandle(const CachableEntry<Block>& filter_block,
                                        const Slice& entry) const;
   Status GetFilterPartitionBlock(
@@ -125,11 +129,19 @@ class PartitionedFilterBlockReader : public FilterBlockReaderCommon<Block> {
                 uint64_t block_offset, bool no_io,
                 BlockCacheLookupContext* lookup_context,
                 FilterManyFunction filter_function) const;
-  void MayMatchPartition(MultiGetRange* range,
-                         const SliceTransform* prefix_extractor,
-                         uint64_t block_offset, BlockHandle filter_handle,
-                         bool no_io, BlockCacheLookupContext* lookup_context,
-                         FilterManyFunction filter_function) const;
+  using PartitionHandles =
+      autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>;
+  using PartitionEntries = autovector<CachableEntry<ParsedFullFilterBlock>,
+                                      MultiGetContext::MAX_BATCH_SIZE>;
+  using PartitionStatuses = autovector<Status, MultiGetContext::MAX_BATCH_SIZE>;
+  // Gets the partitions with the given handles, reading all those missing
+  // from the block cache with one MultiRead. (*statuses)[i] is the status of
+  // getting handles[i] into (*partitions)[i].
+  void GetFilterPartitionBlocks(const PartitionHandles& handles, bool no_io,
+                                GetContext* get_context,
+                                BlockCacheLookupContext* lookup_context,
+                                PartitionEntries* partitions,
+                                PartitionStatuses* statuses) const;
   Status CacheDependencies(const ReadOptions& ro, bool pin) override;
 
   const InternalKeyComparator* internal_comparator() const;
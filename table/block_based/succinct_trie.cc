@@ -0,0 +1,399 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/succinct_trie.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "util/coding.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Words covered by each entry of the rank directory
+const uint32_t kWordsPerRank = 8;
+// NUM_KEYS, NUM_LABELS, NUM_NODES and RANK_WIDTH
+const size_t kTrieHeaderSize = 13;
+
+uint32_t NumWords(uint64_t num_bits) {
+  return static_cast<uint32_t>((num_bits + 63) / 64);
+}
+}  // namespace
+
+size_t SuccinctBitVector::SerializedSize(uint32_t num_bits) {
+  uint32_t num_words = NumWords(num_bits);
+  return size_t{num_words} * 8 + (num_words / kWordsPerRank + 1) * 4;
+}
+
+void SuccinctBitVector::Append(const std::vector<bool>& bits,
+                               std::string* dst) {
+  uint32_t num_words = NumWords(bits.size());
+  std::vector<uint64_t> words(num_words, 0);
+  for (size_t i = 0; i < bits.size(); ++i) {
+    if (bits[i]) {
+      words[i / 64] |= uint64_t{1} << (i % 64);
+    }
+  }
+  for (uint64_t word : words) {
+    PutFixed64(dst, word);
+  }
+  uint32_t rank = 0;
+  for (uint32_t w = 0; w <= num_words; ++w) {
+    if (w % kWordsPerRank == 0) {
+      PutFixed32(dst, rank);
+    }
+    if (w < num_words) {
+      rank += BitsSetToOne(words[w]);
+    }
+  }
+}
+
+void SuccinctBitVector::Init(const char* data, uint32_t num_bits) {
+  num_words_ = NumWords(num_bits);
+  bits_ = data;
+  ranks_ = data + size_t{num_words_} * 8;
+}
+
+uint64_t SuccinctBitVector::Word(uint32_t w) const {
+  assert(w < num_words_);
+  return DecodeFixed64(bits_ + size_t{w} * 8);
+}
+
+uint32_t SuccinctBitVector::Rank1(uint32_t i) const {
+  uint32_t w = i / 64;
+  uint32_t block = w / kWordsPerRank;
+  uint32_t rank = DecodeFixed32(ranks_ + size_t{block} * 4);
+  for (uint32_t k = block * kWordsPerRank; k < w; ++k) {
+    rank += BitsSetToOne(Word(k));
+  }
+  if (i % 64 != 0) {
+    rank += BitsSetToOne(Word(w) & ((uint64_t{1} << (i % 64)) - 1));
+  }
+  return rank;
+}
+
+uint32_t SuccinctBitVector::Select1(uint32_t k) const {
+  assert(k > 0);
+  // Last rank directory entry with fewer than k ones before it
+  uint32_t lo = 0;
+  uint32_t hi = num_words_ / kWordsPerRank;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo + 1) / 2;
+    if (DecodeFixed32(ranks_ + size_t{mid} * 4) < k) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  uint32_t rank = DecodeFixed32(ranks_ + size_t{lo} * 4);
+  uint32_t w = lo * kWordsPerRank;
+  uint64_t word = Word(w);
+  for (;;) {
+    uint32_t count = BitsSetToOne(word);
+    if (rank + count >= k) {
+      break;
+    }
+    rank += count;
+    word = Word(++w);
+  }
+  for (uint32_t skip = k - rank - 1; skip > 0; --skip) {
+    word &= word - 1;
+  }
+  return w * 64 + CountTrailingZeroBits(word);
+}
+
+uint32_t PackedIntArray::BitsNeeded(uint64_t max_value) {
+  uint32_t width = 1;
+  while (width < 64 && (max_value >> width) != 0) {
+    ++width;
+  }
+  return width;
+}
+
+size_t PackedIntArray::SerializedSize(uint32_t num_entries, uint32_t width) {
+  return (size_t{NumWords(uint64_t{num_entries} * width)} + 1) * 8;
+}
+
+void PackedIntArray::Append(const std::vector<uint32_t>& values,
+                            uint32_t width, std::string* dst) {
+  assert(width > 0 && width <= 32);
+  std::vector<uint64_t> words(NumWords(uint64_t{values.size()} * width) + 1,
+                              0);
+  for (size_t i = 0; i < values.size(); ++i) {
+    assert(width == 32 || values[i] < (uint32_t{1} << width));
+    uint64_t bit = uint64_t{i} * width;
+    size_t w = static_cast<size_t>(bit / 64);
+    uint32_t offset = bit % 64;
+    words[w] |= uint64_t{values[i]} << offset;
+    if (offset + width > 64) {
+      words[w + 1] |= uint64_t{values[i]} >> (64 - offset);
+    }
+  }
+  for (uint64_t word : words) {
+    PutFixed64(dst, word);
+  }
+}
+
+uint32_t PackedIntArray::Get(uint32_t i) const {
+  uint64_t bit = uint64_t{i} * width_;
+  const char* p = data_ + (bit / 64) * 8;
+  uint32_t offset = bit % 64;
+  uint64_t value = DecodeFixed64(p) >> offset;
+  if (offset + width_ > 64) {
+    value |= DecodeFixed64(p + 8) << (64 - offset);
+  }
+  return static_cast<uint32_t>(value & ((uint64_t{1} << width_) - 1));
+}
+
+void SuccinctTrieBuilder::Add(const Slice& key) {
+  assert(key_offsets_.empty() ||
+         KeyAt(key_offsets_.size() - 1).compare(key) < 0);
+  key_offsets_.push_back(keys_.size());
+  keys_.append(key.data(), key.size());
+}
+
+void SuccinctTrieBuilder::Finish(std::string* dst) const {
+  const size_t num_keys = NumKeys();
+  std::string labels;
+  std::vector<bool> has_child;
+  std::vector<bool> louds;
+  std::vector<bool> prefix_key;
+  std::vector<uint32_t> leaf_ranks;
+
+  // Each queued node covers the keys [begin, end), which share their first
+  // depth bytes
+  struct NodeRange {
+    size_t begin;
+    size_t end;
+    size_t depth;
+  };
+  std::deque<NodeRange> queue;
+  if (num_keys > 0) {
+    queue.push_back({0, num_keys, 0});
+  }
+  while (!queue.empty()) {
+    NodeRange node = queue.front();
+    queue.pop_front();
+    size_t i = node.begin;
+    // Only the smallest key of a node can end at the node
+    bool is_prefix_key = KeyAt(i).size() == node.depth;
+    prefix_key.push_back(is_prefix_key);
+    if (is_prefix_key) {
+      labels.push_back('\0');
+      has_child.push_back(false);
+      louds.push_back(true);
+      leaf_ranks.push_back(static_cast<uint32_t>(i));
+      ++i;
+    }
+    while (i < node.end) {
+      char c = KeyAt(i)[node.depth];
+      size_t j = i + 1;
+      while (j < node.end && KeyAt(j)[node.depth] == c) {
+        ++j;
+      }
+      labels.push_back(c);
+      louds.push_back(i == node.begin);
+      if (j == i + 1 && KeyAt(i).size() == node.depth + 1) {
+        has_child.push_back(false);
+        leaf_ranks.push_back(static_cast<uint32_t>(i));
+      } else {
+        has_child.push_back(true);
+        queue.push_back({i, j, node.depth + 1});
+      }
+      i = j;
+    }
+  }
+  assert(leaf_ranks.size() == num_keys);
+
+  uint32_t rank_width =
+      PackedIntArray::BitsNeeded(num_keys > 0 ? num_keys - 1 : 0);
+  PutFixed32(dst, static_cast<uint32_t>(num_keys));
+  PutFixed32(dst, static_cast<uint32_t>(labels.size()));
+  PutFixed32(dst, static_cast<uint32_t>(prefix_key.size()));
+  dst->push_back(static_cast<char>(rank_width));
+  dst->append(labels);
+  SuccinctBitVector::Append(has_child, dst);
+  SuccinctBitVector::Append(louds, dst);
+  SuccinctBitVector::Append(prefix_key, dst);
+  PackedIntArray::Append(leaf_ranks, rank_width, dst);
+}
+
+Status SuccinctTrie::Init(const Slice& data) {
+  if (data.size() < kTrieHeaderSize) {
+    return Status::Corruption("Succinct trie too short");
+  }
+  num_keys_ = DecodeFixed32(data.data());
+  num_labels_ = DecodeFixed32(data.data() + 4);
+  num_nodes_ = DecodeFixed32(data.data() + 8);
+  uint32_t rank_width = static_cast<uint8_t>(data[12]);
+  bool shape_ok;
+  if (num_keys_ == 0) {
+    shape_ok = num_labels_ == 0 && num_nodes_ == 0;
+  } else {
+    shape_ok = num_nodes_ > 0 && num_labels_ >= num_nodes_ &&
+               num_labels_ >= num_keys_ && rank_width > 0 && rank_width <= 32;
+  }
+  if (!shape_ok) {
+    return Status::Corruption("Bad succinct trie header");
+  }
+  uint64_t expected = uint64_t{kTrieHeaderSize} + num_labels_ +
+                      2 * SuccinctBitVector::SerializedSize(num_labels_) +
+                      SuccinctBitVector::SerializedSize(num_nodes_) +
+                      PackedIntArray::SerializedSize(num_keys_, rank_width);
+  if (data.size() != expected) {
+    return Status::Corruption("Bad succinct trie size");
+  }
+  const char* p = data.data() + kTrieHeaderSize;
+  labels_ = p;
+  p += num_labels_;
+  has_child_.Init(p, num_labels_);
+  p += SuccinctBitVector::SerializedSize(num_labels_);
+  louds_.Init(p, num_labels_);
+  p += SuccinctBitVector::SerializedSize(num_labels_);
+  prefix_key_.Init(p, num_nodes_);
+  p += SuccinctBitVector::SerializedSize(num_nodes_);
+  leaf_ranks_.Init(p, rank_width);
+  return Status::OK();
+}
+
+void SuccinctTrie::Iterator::SeekToFirst() {
+  path_.clear();
+  if (trie_->num_keys_ > 0) {
+    DescendLeftmost(0);
+  }
+  UpdateKey();
+}
+
+void SuccinctTrie::Iterator::SeekToLast() {
+  path_.clear();
+  if (trie_->num_keys_ > 0) {
+    DescendRightmost(trie_->NodeEnd(0) - 1);
+  }
+  UpdateKey();
+}
+
+void SuccinctTrie::Iterator::Seek(const Slice& target) {
+  path_.clear();
+  if (trie_->num_keys_ == 0) {
+    UpdateKey();
+    return;
+  }
+  const uint8_t* labels = reinterpret_cast<const uint8_t*>(trie_->labels_);
+  uint32_t node = 0;
+  uint32_t pos = 0;
+  for (size_t depth = 0;; ++depth) {
+    if (depth == target.size()) {
+      // Every key below this node is >= target
+      DescendLeftmost(pos);
+      break;
+    }
+    uint32_t end = trie_->NodeEnd(node);
+    // A terminator stands for a proper prefix of target, so skip it
+    uint32_t begin = trie_->prefix_key_.Get(node) ? pos + 1 : pos;
+    uint8_t c = static_cast<uint8_t>(target[depth]);
+    uint32_t p = static_cast<uint32_t>(
+        std::lower_bound(labels + begin, labels + end, c) - labels);
+    if (p == end) {
+      // The whole node sorts before target
+      path_.push_back(end - 1);
+      Advance();
+      break;
+    }
+    if (labels[p] > c) {
+      DescendLeftmost(p);
+      break;
+    }
+    path_.push_back(p);
+    if (trie_->has_child_.Get(p)) {
+      node = trie_->ChildNode(p);
+      pos = trie_->NodeStart(node);
+      continue;
+    }
+    if (depth + 1 < target.size()) {
+      // The key ends here and is a proper prefix of target
+      Advance();
+    }
+    break;
+  }
+  UpdateKey();
+}
+
+void SuccinctTrie::Iterator::Next() {
+  assert(Valid());
+  Advance();
+  UpdateKey();
+}
+
+void SuccinctTrie::Iterator::Prev() {
+  assert(Valid());
+  Retreat();
+  UpdateKey();
+}
+
+uint32_t SuccinctTrie::Iterator::rank() const {
+  assert(Valid());
+  uint32_t pos = path_.back();
+  return trie_->leaf_ranks_.Get(pos - trie_->has_child_.Rank1(pos));
+}
+
+void SuccinctTrie::Iterator::DescendLeftmost(uint32_t pos) {
+  for (;;) {
+    path_.push_back(pos);
+    if (!trie_->has_child_.Get(pos)) {
+      break;
+    }
+    pos = trie_->NodeStart(trie_->ChildNode(pos));
+  }
+}
+
+void SuccinctTrie::Iterator::DescendRightmost(uint32_t pos) {
+  for (;;) {
+    path_.push_back(pos);
+    if (!trie_->has_child_.Get(pos)) {
+      break;
+    }
+    pos = trie_->NodeEnd(trie_->ChildNode(pos)) - 1;
+  }
+}
+
+void SuccinctTrie::Iterator::Advance() {
+  while (!path_.empty()) {
+    uint32_t pos = path_.back();
+    path_.pop_back();
+    // Next label of the same node, if any
+    if (pos + 1 < trie_->num_labels_ && !trie_->louds_.Get(pos + 1)) {
+      DescendLeftmost(pos + 1);
+      return;
+    }
+  }
+}
+
+void SuccinctTrie::Iterator::Retreat() {
+  while (!path_.empty()) {
+    uint32_t pos = path_.back();
+    path_.pop_back();
+    if (!trie_->louds_.Get(pos)) {
+      DescendRightmost(pos - 1);
+      return;
+    }
+  }
+}
+
+void SuccinctTrie::Iterator::UpdateKey() {
+  key_.clear();
+  if (path_.empty()) {
+    return;
+  }
+  for (uint32_t pos : path_) {
+    key_.push_back(trie_->labels_[pos]);
+  }
+  if (trie_->IsTerminator(path_.back())) {
+    key_.pop_back();
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
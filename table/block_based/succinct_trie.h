@@ -0,0 +1,187 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Read-only view over a serialized bit vector with rank and select support.
+// Serialized format:
+//
+// [BITS: num_words x fixed64][RANKS: (num_words / 8 + 1) x fixed32]
+//
+// RANKS[i] is the number of one bits in the first 8 * i words, so Rank1()
+// and Select1() scan at most 8 words after a directory lookup.
+class SuccinctBitVector {
+ public:
+  static size_t SerializedSize(uint32_t num_bits);
+  static void Append(const std::vector<bool>& bits, std::string* dst);
+
+  SuccinctBitVector() : bits_(nullptr), ranks_(nullptr), num_words_(0) {}
+  void Init(const char* data, uint32_t num_bits);
+
+  bool Get(uint32_t i) const {
+    return (Word(i / 64) >> (i % 64)) & 1;
+  }
+  // Number of one bits in [0, i)
+  uint32_t Rank1(uint32_t i) const;
+  // Position of the k-th one bit, counting from 1. REQUIRES: the bit exists
+  uint32_t Select1(uint32_t k) const;
+
+ private:
+  uint64_t Word(uint32_t w) const;
+
+  const char* bits_;
+  const char* ranks_;
+  uint32_t num_words_;
+};
+
+// Read-only view over an array of unsigned integers packed at a fixed bit
+// width of at most 32. Serialized format: ceil(n * width / 64) + 1 fixed64
+// words, the extra word allowing every entry to be read with two loads.
+class PackedIntArray {
+ public:
+  static uint32_t BitsNeeded(uint64_t max_value);
+  static size_t SerializedSize(uint32_t num_entries, uint32_t width);
+  static void Append(const std::vector<uint32_t>& values, uint32_t width,
+                     std::string* dst);
+
+  PackedIntArray() : data_(nullptr), width_(0) {}
+  void Init(const char* data, uint32_t width) {
+    data_ = data;
+    width_ = width;
+  }
+
+  uint32_t Get(uint32_t i) const;
+
+ private:
+  const char* data_;
+  uint32_t width_;
+};
+
+// A static set of byte strings encoded as a LOUDS-Sparse trie, as in SuRF
+// (Zhang et al., SIGMOD 2018), except that the trie is complete: every key is
+// stored in full so keys can be reconstructed and compared exactly.
+//
+// Nodes are laid out in level order. Each node contributes its outgoing edge
+// labels in sorted order, and three bit vectors describe the shape:
+//  - HAS_CHILD (one bit per label): the edge leads to another node. Otherwise
+//    the edge ends a key.
+//  - LOUDS (one bit per label): the label is the first one of its node.
+//  - PREFIX_KEY (one bit per node): the path to the node is itself a key. The
+//    node's first label is then a terminator entry that stands for that key
+//    and sorts before all other labels.
+// A label that is not HAS_CHILD is a leaf. Leaves are numbered in level order
+// and LEAF_RANKS maps each leaf to the rank of its key in sorted order.
+//
+// Serialized format:
+//
+// [NUM_KEYS: fixed32][NUM_LABELS: fixed32][NUM_NODES: fixed32]
+// [RANK_WIDTH: 1 byte][LABELS: NUM_LABELS bytes]
+// [HAS_CHILD][LOUDS][PREFIX_KEY]    (SuccinctBitVector)
+// [LEAF_RANKS]                      (PackedIntArray of RANK_WIDTH bits)
+//
+// Separator keys of an index are short and share long prefixes, which is the
+// case the trie compresses well: a key costs roughly one label byte per
+// distinguishing byte plus a few bits, instead of the full key.
+class SuccinctTrieBuilder {
+ public:
+  // REQUIRES: key is bytewise greater than every key added before
+  void Add(const Slice& key);
+
+  size_t NumKeys() const { return key_offsets_.size(); }
+
+  // Appends the encoded trie of all keys added to *dst
+  void Finish(std::string* dst) const;
+
+ private:
+  Slice KeyAt(size_t i) const {
+    size_t end =
+        i + 1 < key_offsets_.size() ? key_offsets_[i + 1] : keys_.size();
+    return Slice(keys_.data() + key_offsets_[i], end - key_offsets_[i]);
+  }
+
+  std::string keys_;
+  std::vector<size_t> key_offsets_;
+};
+
+class SuccinctTrie {
+ public:
+  SuccinctTrie()
+      : labels_(nullptr), num_keys_(0), num_labels_(0), num_nodes_(0) {}
+
+  // Points this trie at the encoded data, which must stay alive while the
+  // trie is in use. Returns Corruption if data is not a well-formed trie.
+  Status Init(const Slice& data);
+
+  uint32_t NumKeys() const { return num_keys_; }
+
+  // Iterates the keys in bytewise order, reporting each key's rank.
+  class Iterator {
+   public:
+    explicit Iterator(const SuccinctTrie* trie) : trie_(trie) {}
+
+    bool Valid() const { return !path_.empty(); }
+    void SeekToFirst();
+    void SeekToLast();
+    // Positions at the first key >= target
+    void Seek(const Slice& target);
+    void Next();
+    void Prev();
+
+    Slice key() const {
+      assert(Valid());
+      return Slice(key_);
+    }
+    // Position of key() among all keys in sorted order
+    uint32_t rank() const;
+
+   private:
+    // Append pos and then the leftmost (rightmost) path below it
+    void DescendLeftmost(uint32_t pos);
+    void DescendRightmost(uint32_t pos);
+    // Move to the leaf after (before) the subtree of the last path entry
+    void Advance();
+    void Retreat();
+    void UpdateKey();
+
+    const SuccinctTrie* trie_;
+    // Label positions from the root down to the current leaf
+    std::vector<uint32_t> path_;
+    std::string key_;
+  };
+
+ private:
+  uint32_t NodeStart(uint32_t node) const {
+    return node == 0 ? 0 : louds_.Select1(node + 1);
+  }
+  uint32_t NodeEnd(uint32_t node) const {
+    return node + 1 < num_nodes_ ? louds_.Select1(node + 2) : num_labels_;
+  }
+  uint32_t ChildNode(uint32_t pos) const { return has_child_.Rank1(pos + 1); }
+  bool IsTerminator(uint32_t pos) const {
+    return louds_.Get(pos) && prefix_key_.Get(louds_.Rank1(pos + 1) - 1);
+  }
+
+  const char* labels_;
+  SuccinctBitVector has_child_;
+  SuccinctBitVector louds_;
+  SuccinctBitVector prefix_key_;
+  PackedIntArray leaf_ranks_;
+  uint32_t num_keys_;
+  uint32_t num_labels_;
+  uint32_t num_nodes_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,317 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#include "table/block_based/succinct_trie_index_reader.h"
+
+#include "db/dbformat.h"
+#include "monitoring/perf_context_imp.h"
+#include "table/block_based/block.h"
+#include "table/block_based/index_builder.h"
+#include "table/block_based/succinct_trie.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Iterates a kSuccinctTrieSearch index block in place. See
+// SuccinctTrieIndexBuilder for the format.
+class SuccinctTrieIndexIterator : public InternalIteratorBase<IndexValue> {
+ public:
+  SuccinctTrieIndexIterator()
+      : trie_iter_(&trie_),
+        num_entries_(0),
+        flags_(0),
+        seq_and_types_(nullptr),
+        offsets_(nullptr),
+        entry_(0) {}
+
+  Status Init(const Slice& block) {
+    typedef SuccinctTrieIndexBuilder Format;
+    if (block.size() < Format::kHeaderSize) {
+      return Status::Corruption("Trie index block too short");
+    }
+    const char* p = block.data();
+    num_entries_ = DecodeFixed32(p);
+    uint32_t trie_size = DecodeFixed32(p + 4);
+    flags_ = static_cast<uint8_t>(p[8]);
+    uint32_t size_width = static_cast<uint8_t>(p[9]);
+    if (size_width == 0 || size_width > 32) {
+      return Status::Corruption("Bad trie index block header");
+    }
+    uint64_t expected = uint64_t{Format::kHeaderSize} + trie_size;
+    if (keys_include_seq()) {
+      expected += SuccinctBitVector::SerializedSize(num_entries_) +
+                  uint64_t{num_entries_} * 8;
+    }
+    uint64_t num_offsets =
+        contiguous_blocks()
+            ? (uint64_t{num_entries_} + Format::kOffsetSampleInterval - 1) /
+                  Format::kOffsetSampleInterval
+            : num_entries_;
+    expected += num_offsets * 8 +
+                PackedIntArray::SerializedSize(num_entries_, size_width);
+    if (block.size() != expected) {
+      return Status::Corruption("Bad trie index block size");
+    }
+    p += Format::kHeaderSize;
+    Status s = trie_.Init(Slice(p, trie_size));
+    if (!s.ok()) {
+      return s;
+    }
+    p += trie_size;
+    if (keys_include_seq()) {
+      run_starts_.Init(p, num_entries_);
+      p += SuccinctBitVector::SerializedSize(num_entries_);
+      seq_and_types_ = p;
+      p += size_t{num_entries_} * 8;
+      if (num_entries_ > 0 && (!run_starts_.Get(0) ||
+                               run_starts_.Rank1(num_entries_) !=
+                                   trie_.NumKeys())) {
+        return Status::Corruption("Bad trie index runs");
+      }
+    } else if (trie_.NumKeys() != num_entries_) {
+      return Status::Corruption("Bad trie index key count");
+    }
+    offsets_ = p;
+    p += num_offsets * 8;
+    sizes_.Init(p, size_width);
+    return Status::OK();
+  }
+
+  bool Valid() const override { return status_.ok() && trie_iter_.Valid(); }
+
+  void SeekToFirst() override {
+    status_ = Status::OK();
+    trie_iter_.SeekToFirst();
+    entry_ = 0;
+    UpdateKey();
+  }
+
+  void SeekToLast() override {
+    status_ = Status::OK();
+    trie_iter_.SeekToLast();
+    entry_ = num_entries_ - 1;
+    UpdateKey();
+  }
+
+  void Seek(const Slice& target) override {
+    status_ = Status::OK();
+    Slice user_key = ExtractUserKey(target);
+    trie_iter_.Seek(user_key);
+    if (!trie_iter_.Valid()) {
+      return;
+    }
+    entry_ = FirstEntryOfRank(trie_iter_.rank());
+    if (keys_include_seq() && trie_iter_.key() == user_key) {
+      // Entries of one user key are ordered by decreasing seq
+      uint64_t target_seq_and_type = ExtractInternalKeyFooter(target);
+      while (SeqAndType(entry_) > target_seq_and_type) {
+        ++entry_;
+        if (entry_ == num_entries_ || run_starts_.Get(entry_)) {
+          trie_iter_.Next();
+          break;
+        }
+      }
+    }
+    UpdateKey();
+  }
+
+  void SeekForPrev(const Slice& /*target*/) override {
+    assert(false);
+    status_ = Status::InvalidArgument(
+        "RocksDB internal error: should never call SeekForPrev() on index "
+        "blocks");
+  }
+
+  void Next() override {
+    assert(Valid());
+    ++entry_;
+    if (!keys_include_seq() || entry_ == num_entries_ ||
+        run_starts_.Get(entry_)) {
+      trie_iter_.Next();
+    }
+    UpdateKey();
+  }
+
+  void Prev() override {
+    assert(Valid());
+    if (!keys_include_seq() || run_starts_.Get(entry_)) {
+      trie_iter_.Prev();
+    }
+    if (trie_iter_.Valid()) {
+      --entry_;
+    }
+    UpdateKey();
+  }
+
+  Slice key() const override {
+    assert(Valid());
+    return keys_include_seq() ? Slice(key_buf_) : trie_iter_.key();
+  }
+
+  Slice user_key() const override {
+    assert(Valid());
+    return trie_iter_.key();
+  }
+
+  IndexValue value() const override {
+    assert(Valid());
+    return IndexValue(Handle(entry_), Slice());
+  }
+
+  Status status() const override { return status_; }
+
+ private:
+  bool keys_include_seq() const {
+    return (flags_ & SuccinctTrieIndexBuilder::kKeysIncludeSeq) != 0;
+  }
+  bool contiguous_blocks() const {
+    return (flags_ & SuccinctTrieIndexBuilder::kContiguousBlocks) != 0;
+  }
+
+  uint32_t FirstEntryOfRank(uint32_t rank) const {
+    return keys_include_seq() ? run_starts_.Select1(rank + 1) : rank;
+  }
+
+  uint64_t SeqAndType(uint32_t entry) const {
+    return DecodeFixed64(seq_and_types_ + size_t{entry} * 8);
+  }
+
+  BlockHandle Handle(uint32_t entry) const {
+    const uint32_t interval = SuccinctTrieIndexBuilder::kOffsetSampleInterval;
+    uint64_t offset;
+    if (contiguous_blocks()) {
+      offset = DecodeFixed64(offsets_ + size_t{entry / interval} * 8);
+      for (uint32_t i = entry - entry % interval; i < entry; ++i) {
+        offset += sizes_.Get(i) + kBlockTrailerSize;
+      }
+    } else {
+      offset = DecodeFixed64(offsets_ + size_t{entry} * 8);
+    }
+    return BlockHandle(offset, sizes_.Get(entry));
+  }
+
+  void UpdateKey() {
+    if (keys_include_seq() && trie_iter_.Valid()) {
+      Slice user_key = trie_iter_.key();
+      key_buf_.assign(user_key.data(), user_key.size());
+      PutFixed64(&key_buf_, SeqAndType(entry_));
+    }
+  }
+
+  SuccinctTrie trie_;
+  SuccinctTrie::Iterator trie_iter_;
+  uint32_t num_entries_;
+  uint8_t flags_;
+  SuccinctBitVector run_starts_;
+  const char* seq_and_types_;
+  const char* offsets_;
+  PackedIntArray sizes_;
+  // Entry of the current position, in sorted order
+  uint32_t entry_;
+  // Internal key of the current entry when keys include seq
+  std::string key_buf_;
+  Status status_;
+};
+}  // namespace
+
+Status SuccinctTrieIndexReader::Create(
+    const BlockBasedTable* table, const ReadOptions& ro,
+    FilePrefetchBuffer* prefetch_buffer, bool use_cache, bool prefetch,
+    bool pin, BlockCacheLookupContext* lookup_context,
+    std::unique_ptr<IndexReader>* index_reader) {
+  assert(table != nullptr);
+  assert(table->get_rep());
+  assert(!pin || prefetch);
+  assert(index_reader != nullptr);
+
+  CachableEntry<BlockContents> index_block;
+  if (prefetch || !use_cache) {
+    const Status s =
+        ReadIndexBlock(table, prefetch_buffer, ro, use_cache,
+                       /*get_context=*/nullptr, lookup_context, &index_block);
+    if (!s.ok()) {
+      return s;
+    }
+
+    if (use_cache && !pin) {
+      index_block.Reset();
+    }
+  }
+
+  index_reader->reset(
+      new SuccinctTrieIndexReader(table, std::move(index_block)));
+
+  return Status::OK();
+}
+
+Status SuccinctTrieIndexReader::ReadIndexBlock(
+    const BlockBasedTable* table, FilePrefetchBuffer* prefetch_buffer,
+    const ReadOptions& read_options, bool use_cache, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context,
+    CachableEntry<BlockContents>* index_block) {
+  PERF_TIMER_GUARD(read_index_block_nanos);
+
+  assert(table != nullptr);
+  assert(index_block != nullptr);
+  assert(index_block->IsEmpty());
+
+  const BlockBasedTable::Rep* const rep = table->get_rep();
+  assert(rep != nullptr);
+
+  return table->RetrieveBlock(
+      prefetch_buffer, read_options, rep->footer.index_handle(),
+      UncompressionDict::GetEmptyDict(), index_block, BlockType::kIndex,
+      get_context, lookup_context, /* for_compaction */ false, use_cache);
+}
+
+Status SuccinctTrieIndexReader::GetOrReadIndexBlock(
+    bool no_io, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context,
+    CachableEntry<BlockContents>* index_block) const {
+  assert(index_block != nullptr);
+
+  if (!index_block_.IsEmpty()) {
+    index_block->SetUnownedValue(index_block_.GetValue());
+    return Status::OK();
+  }
+
+  ReadOptions read_options;
+  if (no_io) {
+    read_options.read_tier = kBlockCacheTier;
+  }
+
+  return ReadIndexBlock(
+      table_, /*prefetch_buffer=*/nullptr, read_options,
+      table_->get_rep()->table_options.cache_index_and_filter_blocks,
+      get_context, lookup_context, index_block);
+}
+
+InternalIteratorBase<IndexValue>* SuccinctTrieIndexReader::NewIterator(
+    const ReadOptions& read_options, bool /* disable_prefix_seek */,
+    IndexBlockIter* iter, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context) {
+  const bool no_io = (read_options.read_tier == kBlockCacheTier);
+  CachableEntry<BlockContents> index_block;
+  Status s =
+      GetOrReadIndexBlock(no_io, get_context, lookup_context, &index_block);
+  std::unique_ptr<SuccinctTrieIndexIterator> it;
+  if (s.ok()) {
+    it.reset(new SuccinctTrieIndexIterator());
+    s = it->Init(index_block.GetValue()->data);
+  }
+  if (!s.ok()) {
+    if (iter != nullptr) {
+      iter->Invalidate(s);
+      return iter;
+    }
+
+    return NewErrorInternalIterator<IndexValue>(s);
+  }
+
+  index_block.TransferTo(it.get());
+
+  return it.release();
+}
+}  // namespace ROCKSDB_NAMESPACE
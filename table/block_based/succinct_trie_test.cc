@@ -0,0 +1,167 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/succinct_trie.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "port/stack_trace.h"
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class SuccinctTrieTest : public testing::Test {
+ protected:
+  void Build(const std::set<std::string>& keys) {
+    keys_.assign(keys.begin(), keys.end());
+    SuccinctTrieBuilder builder;
+    for (const auto& key : keys_) {
+      builder.Add(key);
+    }
+    ASSERT_EQ(keys_.size(), builder.NumKeys());
+    encoded_.clear();
+    builder.Finish(&encoded_);
+    ASSERT_OK(trie_.Init(encoded_));
+    ASSERT_EQ(keys_.size(), trie_.NumKeys());
+  }
+
+  void CheckScans() {
+    SuccinctTrie::Iterator iter(&trie_);
+    size_t rank = 0;
+    for (iter.SeekToFirst(); iter.Valid(); iter.Next(), ++rank) {
+      ASSERT_LT(rank, keys_.size());
+      ASSERT_EQ(keys_[rank], iter.key().ToString());
+      ASSERT_EQ(rank, iter.rank());
+    }
+    ASSERT_EQ(keys_.size(), rank);
+    for (iter.SeekToLast(); iter.Valid(); iter.Prev()) {
+      ASSERT_GT(rank, 0u);
+      --rank;
+      ASSERT_EQ(keys_[rank], iter.key().ToString());
+      ASSERT_EQ(rank, iter.rank());
+    }
+    ASSERT_EQ(0u, rank);
+  }
+
+  void CheckSeek(const std::string& target) {
+    SuccinctTrie::Iterator iter(&trie_);
+    iter.Seek(target);
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), target);
+    if (it == keys_.end()) {
+      ASSERT_FALSE(iter.Valid());
+      return;
+    }
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(*it, iter.key().ToString());
+    size_t rank = static_cast<size_t>(it - keys_.begin());
+    ASSERT_EQ(rank, iter.rank());
+    iter.Prev();
+    if (rank == 0) {
+      ASSERT_FALSE(iter.Valid());
+    } else {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(keys_[rank - 1], iter.key().ToString());
+    }
+  }
+
+  std::vector<std::string> keys_;
+  std::string encoded_;
+  SuccinctTrie trie_;
+};
+
+TEST_F(SuccinctTrieTest, Empty) {
+  Build({});
+  SuccinctTrie::Iterator iter(&trie_);
+  iter.SeekToFirst();
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekToLast();
+  ASSERT_FALSE(iter.Valid());
+  iter.Seek("a");
+  ASSERT_FALSE(iter.Valid());
+}
+
+TEST_F(SuccinctTrieTest, PrefixKeys) {
+  Build({"", "a", "ab", "abc", "abd", "b", std::string("b\0", 2), "bcd"});
+  CheckScans();
+  for (const std::string& target :
+       {std::string(), std::string("\0", 1), std::string("a"),
+        std::string("aa"), std::string("abb"), std::string("abcd"),
+        std::string("abz"), std::string("b"), std::string("b\0\0", 3),
+        std::string("bc"), std::string("c")}) {
+    CheckSeek(target);
+  }
+}
+
+TEST_F(SuccinctTrieTest, Random) {
+  Random rnd(301);
+  for (int round = 0; round < 500; ++round) {
+    // A small alphabet including 0x00 and 0xff gives deep shared prefixes
+    const int alphabet = 1 + rnd.Uniform(4);
+    std::set<std::string> keys;
+    const int num_keys = rnd.Uniform(60);
+    for (int i = 0; i < num_keys; ++i) {
+      std::string key;
+      const int len = rnd.Uniform(6);
+      for (int j = 0; j < len; ++j) {
+        key.push_back(static_cast<char>(rnd.Uniform(alphabet) * 85));
+      }
+      keys.insert(key);
+    }
+    Build(keys);
+    CheckScans();
+    for (int i = 0; i < 50; ++i) {
+      std::string target;
+      const int len = rnd.Uniform(7);
+      for (int j = 0; j < len; ++j) {
+        target.push_back(static_cast<char>(rnd.Uniform(alphabet + 1) * 60));
+      }
+      CheckSeek(target);
+    }
+  }
+}
+
+TEST_F(SuccinctTrieTest, SeparatorKeys) {
+  std::set<std::string> keys;
+  for (int i = 0; i < 20000; ++i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "user%08d", i * 7);
+    keys.insert(buf);
+  }
+  Build(keys);
+  CheckScans();
+  // Much smaller than the raw keys
+  ASSERT_LT(encoded_.size(), keys.size() * 6);
+  Random rnd(301);
+  for (int i = 0; i < 1000; ++i) {
+    CheckSeek(keys_[rnd.Uniform(static_cast<int>(keys_.size()))]);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "user%08d", rnd.Uniform(140000));
+    CheckSeek(buf);
+  }
+}
+
+TEST_F(SuccinctTrieTest, Corruption) {
+  Build({"abc", "abd", "b"});
+  SuccinctTrie trie;
+  ASSERT_TRUE(trie.Init(Slice(encoded_.data(), 5)).IsCorruption());
+  ASSERT_TRUE(
+      trie.Init(Slice(encoded_.data(), encoded_.size() - 1)).IsCorruption());
+  std::string bad = encoded_;
+  // NUM_LABELS
+  bad[4] = static_cast<char>(bad[4] + 1);
+  ASSERT_TRUE(trie.Init(bad).IsCorruption());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
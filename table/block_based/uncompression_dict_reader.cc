@@ -6,11 +6,19 @@
 
 #include "table/block_based/uncompression_dict_reader.h"
 #include "monitoring/perf_context_imp.h"
+#include "monitoring/statistics.h"
 #include "table/block_based/block_based_table_reader.h"
+#include "util/coding.h"
 #include "util/compression.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+void DeleteSharedUncompressionDict(const Slice& /*key*/, void* value) {
+  delete reinterpret_cast<UncompressionDict*>(value);
+}
+}  // namespace
+
 Status UncompressionDictReader::Create(
     const BlockBasedTable* table, const ReadOptions& ro,
     FilePrefetchBuffer* prefetch_buffer, bool use_cache, bool prefetch,
@@ -56,6 +64,15 @@ Status UncompressionDictReader::ReadUncompressionDictionary(
   assert(rep);
   assert(!rep->compression_dict_handle.IsNull());
 
+  const uint64_t dict_id = rep->table_properties != nullptr
+                               ? rep->table_properties->compression_dict_id
+                               : 0;
+  if (dict_id != 0 && rep->table_options.block_cache != nullptr) {
+    return ReadSharedUncompressionDictionary(
+        table, prefetch_buffer, read_options, dict_id, get_context,
+        lookup_context, uncompression_dict);
+  }
+
   const Status s = table->RetrieveBlock(
       prefetch_buffer, read_options, rep->compression_dict_handle,
       UncompressionDict::GetEmptyDict(), uncompression_dict,
@@ -73,6 +90,64 @@ Status UncompressionDictReader::ReadUncompressionDictionary(
   return s;
 }
 
+Status UncompressionDictReader::ReadSharedUncompressionDictionary(
+    const BlockBasedTable* table, FilePrefetchBuffer* prefetch_buffer,
+    const ReadOptions& read_options, uint64_t dict_id, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context,
+    CachableEntry<UncompressionDict>* uncompression_dict) {
+  const BlockBasedTable::Rep* const rep = table->get_rep();
+  Cache* const block_cache = rep->table_options.block_cache.get();
+  Statistics* const statistics = rep->ioptions.statistics;
+
+  std::string cache_key("rocksdb.shared_compression_dict.");
+  PutFixed64(&cache_key, dict_id);
+  Cache::Handle* cache_handle = block_cache->Lookup(cache_key, statistics);
+  if (cache_handle != nullptr) {
+    RecordTick(statistics, BLOCK_CACHE_COMPRESSION_DICT_HIT);
+  } else {
+    RecordTick(statistics, BLOCK_CACHE_COMPRESSION_DICT_MISS);
+    if (read_options.read_tier == kBlockCacheTier) {
+      return Status::Incomplete("no blocking io");
+    }
+
+    CachableEntry<UncompressionDict> file_dict;
+    Status s = table->RetrieveBlock(
+        prefetch_buffer, read_options, rep->compression_dict_handle,
+        UncompressionDict::GetEmptyDict(), &file_dict,
+        BlockType::kCompressionDictionary, get_context, lookup_context,
+        /* for_compaction */ false, /* use_cache */ false);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(
+          rep->ioptions.info_log,
+          "Encountered error while reading data from compression dictionary "
+          "block %s",
+          s.ToString().c_str());
+      return s;
+    }
+
+    // Copy the dictionary, as the cache entry can outlive this file
+    std::unique_ptr<UncompressionDict> dict(new UncompressionDict(
+        file_dict.GetValue()->GetRawDict().ToString(),
+        rep->blocks_definitely_zstd_compressed));
+    const size_t charge = dict->ApproximateMemoryUsage();
+    s = block_cache->Insert(cache_key, dict.get(), charge,
+                            &DeleteSharedUncompressionDict, &cache_handle);
+    if (!s.ok()) {
+      // E.g. the cache is full and its capacity limit is strict
+      uncompression_dict->SetOwnedValue(dict.release());
+      return Status::OK();
+    }
+    dict.release();
+    RecordTick(statistics, BLOCK_CACHE_COMPRESSION_DICT_ADD);
+    RecordTick(statistics, BLOCK_CACHE_COMPRESSION_DICT_BYTES_INSERT, charge);
+  }
+
+  uncompression_dict->SetCachedValue(
+      reinterpret_cast<UncompressionDict*>(block_cache->Value(cache_handle)),
+      block_cache, cache_handle);
+  return Status::OK();
+}
+
 Status UncompressionDictReader::GetOrReadUncompressionDictionary(
     FilePrefetchBuffer* prefetch_buffer, bool no_io, GetContext* get_context,
     BlockCacheLookupContext* lookup_context,
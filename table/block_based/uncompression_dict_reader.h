@@ -52,6 +52,15 @@ class UncompressionDictReader {
       BlockCacheLookupContext* lookup_context,
       CachableEntry<UncompressionDict>* uncompression_dict);
 
+  // Looks up the dictionary shared with other files of the column family in
+  // the block cache by its ID, reading it from this file on a miss, so the
+  // files share one digested dictionary
+  static Status ReadSharedUncompressionDictionary(
+      const BlockBasedTable* table, FilePrefetchBuffer* prefetch_buffer,
+      const ReadOptions& read_options, uint64_t dict_id,
+      GetContext* get_context, BlockCacheLookupContext* lookup_context,
+      CachableEntry<UncompressionDict>* uncompression_dict);
+
   const BlockBasedTable* table_;
   CachableEntry<UncompressionDict> uncompression_dict_;
 };
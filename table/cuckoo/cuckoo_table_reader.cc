@@ -11,6 +11,7 @@
 #include "table/cuckoo/cuckoo_table_reader.h"
 
 #include <algorithm>
+#include <array>
 #include <limits>
 #include <string>
 #include <utility>
@@ -51,6 +52,7 @@ CuckooTableReader::CuckooTableReader(
       cuckoo_block_bytes_minus_one_(0),
       table_size_(0),
       ucomp_(comparator),
+      bytewise_comparator_(comparator == BytewiseComparator()),
       get_slice_hash_(get_slice_hash) {
   if (!ioptions.allow_mmap_reads) {
     status_ = Status::InvalidArgument("File is not mmaped");
@@ -141,26 +143,75 @@ CuckooTableReader::CuckooTableReader(
                         &file_data_, nullptr, nullptr);
 }
 
+uint64_t CuckooTableReader::BucketOffset(const Slice& user_key,
+                                         uint32_t hash_cnt) const {
+  return bucket_length_ * CuckooHash(user_key, hash_cnt, use_module_hash_,
+                                     table_size_, identity_as_first_hash_,
+                                     get_slice_hash_);
+}
+
+void CuckooTableReader::PrefetchCuckooBlock(uint64_t offset) const {
+  uint64_t addr = reinterpret_cast<uint64_t>(file_data_.data()) + offset;
+  uint64_t end_addr = addr + cuckoo_block_bytes_minus_one_;
+  for (addr &= CACHE_LINE_MASK; addr < end_addr; addr += CACHE_LINE_SIZE) {
+    PREFETCH(reinterpret_cast<const char*>(addr), 0, 3);
+  }
+}
+
+bool CuckooTableReader::KeyEqual(const Slice& user_key,
+                                 const char* bucket) const {
+  if (bytewise_comparator_) {
+    // The keys have a fixed length, for which memcmp is vectorized
+    return memcmp(user_key.data(), bucket, user_key.size()) == 0;
+  }
+  return ucomp_->Equal(user_key, Slice(bucket, user_key.size()));
+}
+
 Status CuckooTableReader::Get(const ReadOptions& /*readOptions*/,
                               const Slice& key, GetContext* get_context,
                               const SliceTransform* /* prefix_extractor */,
                               bool /*skip_filters*/) {
   assert(key.size() == key_length_ + (is_last_level_ ? 8 : 0));
   Slice user_key = ExtractUserKey(key);
+  return Lookup(user_key, BucketOffset(user_key, 0), get_context);
+}
+
+void CuckooTableReader::MultiGet(const ReadOptions& /*readOptions*/,
+                                 const MultiGetContext::Range* mget_range,
+                                 const SliceTransform* /* prefix_extractor */,
+                                 bool /*skip_filters*/) {
+  // Computes the first bucket of every key and prefetches its cuckoo block,
+  // so that the cache misses of the batch overlap. Most keys are found there.
+  std::array<uint64_t, MultiGetContext::MAX_BATCH_SIZE> offsets;
+  size_t i = 0;
+  for (auto iter = mget_range->begin(); iter != mget_range->end();
+       ++iter, ++i) {
+    assert(iter->ikey.size() == key_length_ + (is_last_level_ ? 8 : 0));
+    offsets[i] = BucketOffset(iter->ukey, 0);
+    PrefetchCuckooBlock(offsets[i]);
+  }
+  i = 0;
+  for (auto iter = mget_range->begin(); iter != mget_range->end();
+       ++iter, ++i) {
+    *iter->s = Lookup(iter->ukey, offsets[i], iter->get_context);
+  }
+}
+
+Status CuckooTableReader::Lookup(const Slice& user_key, uint64_t first_offset,
+                                 GetContext* get_context) const {
+  Slice unused_key(unused_key_.data(), user_key.size());
   for (uint32_t hash_cnt = 0; hash_cnt < num_hash_func_; ++hash_cnt) {
-    uint64_t offset = bucket_length_ * CuckooHash(
-        user_key, hash_cnt, use_module_hash_, table_size_,
-        identity_as_first_hash_, get_slice_hash_);
+    uint64_t offset =
+        hash_cnt == 0 ? first_offset : BucketOffset(user_key, hash_cnt);
     const char* bucket = &file_data_.data()[offset];
     for (uint32_t block_idx = 0; block_idx < cuckoo_block_size_;
          ++block_idx, bucket += bucket_length_) {
-      if (ucomp_->Equal(Slice(unused_key_.data(), user_key.size()),
-                        Slice(bucket, user_key.size()))) {
+      if (KeyEqual(unused_key, bucket)) {
         return Status::OK();
       }
       // Here, we compare only the user key part as we support only one entry
       // per user key and we don't support snapshot.
-      if (ucomp_->Equal(user_key, Slice(bucket, user_key.size()))) {
+      if (KeyEqual(user_key, bucket)) {
         Slice value(bucket + key_length_, value_length_);
         if (is_last_level_) {
           // Sequence number is not stored at the last level, so we will use
@@ -187,14 +238,7 @@ Status CuckooTableReader::Get(const ReadOptions& /*readOptions*/,
 
 void CuckooTableReader::Prepare(const Slice& key) {
   // Prefetch the first Cuckoo Block.
-  Slice user_key = ExtractUserKey(key);
-  uint64_t addr = reinterpret_cast<uint64_t>(file_data_.data()) +
-    bucket_length_ * CuckooHash(user_key, 0, use_module_hash_, table_size_,
-                                identity_as_first_hash_, nullptr);
-  uint64_t end_addr = addr + cuckoo_block_bytes_minus_one_;
-  for (addr &= CACHE_LINE_MASK; addr < end_addr; addr += CACHE_LINE_SIZE) {
-    PREFETCH(reinterpret_cast<const char*>(addr), 0, 3);
-  }
+  PrefetchCuckooBlock(BucketOffset(ExtractUserKey(key), 0));
 }
 
 class CuckooTableIterator : public InternalIterator {
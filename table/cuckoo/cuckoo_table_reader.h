@@ -45,6 +45,13 @@ class CuckooTableReader: public TableReader {
              GetContext* get_context, const SliceTransform* prefix_extractor,
              bool skip_filters = false) override;
 
+  // Looks the keys up in a batch: the first cuckoo blocks of all the keys
+  // are prefetched before any is probed.
+  void MultiGet(const ReadOptions& readOptions,
+                const MultiGetContext::Range* mget_range,
+                const SliceTransform* prefix_extractor,
+                bool skip_filters = false) override;
+
   // Returns a new iterator over table contents
   // compaction_readahead_size: its value will only be used if for_compaction =
   // true
@@ -76,6 +83,15 @@ class CuckooTableReader: public TableReader {
  private:
   friend class CuckooTableIterator;
   void LoadAllKeys(std::vector<std::pair<Slice, uint32_t>>* key_to_bucket_id);
+  // The offset of the bucket that the hash_cnt-th hash function picks
+  uint64_t BucketOffset(const Slice& user_key, uint32_t hash_cnt) const;
+  void PrefetchCuckooBlock(uint64_t offset) const;
+  // Whether the bucket holds user_key
+  bool KeyEqual(const Slice& user_key, const char* bucket) const;
+  // Looks user_key up in the cuckoo blocks of its buckets, the first of
+  // which is at first_offset
+  Status Lookup(const Slice& user_key, uint64_t first_offset,
+                GetContext* get_context) const;
   std::unique_ptr<RandomAccessFileReader> file_;
   Slice file_data_;
   bool is_last_level_;
@@ -93,6 +109,7 @@ class CuckooTableReader: public TableReader {
   uint32_t cuckoo_block_bytes_minus_one_;
   uint64_t table_size_;
   const Comparator* ucomp_;
+  const bool bytewise_comparator_;
   uint64_t (*get_slice_hash_)(const Slice& s, uint32_t index,
       uint64_t max_num_buckets);
 };
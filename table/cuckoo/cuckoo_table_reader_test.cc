@@ -13,6 +13,7 @@ int main() {
 }
 #else
 
+#include <algorithm>
 #include <cinttypes>
 #include <map>
 #include <string>
@@ -24,6 +25,7 @@ int main() {
 #include "table/cuckoo/cuckoo_table_reader.h"
 #include "table/get_context.h"
 #include "table/meta_blocks.h"
+#include "table/multiget_context.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "util/gflags_compat.h"
@@ -129,7 +131,47 @@ class CuckooReaderTest : public testing::Test {
           reader.Get(ReadOptions(), Slice(keys[i]), &get_context, nullptr));
       ASSERT_STREQ(values[i].c_str(), value.data());
     }
+    CheckMultiGet(&reader, ucomp);
   }
+
+  void CheckMultiGet(CuckooTableReader* reader, const Comparator* ucomp) {
+    for (uint32_t start = 0; start < num_items;
+         start += MultiGetContext::MAX_BATCH_SIZE) {
+      const uint32_t end = std::min<uint32_t>(
+          num_items, start + MultiGetContext::MAX_BATCH_SIZE);
+      std::vector<Slice> batch_keys;
+      std::vector<PinnableSlice> batch_values(end - start);
+      std::vector<Status> statuses(end - start);
+      autovector<GetContext, MultiGetContext::MAX_BATCH_SIZE> get_context;
+      autovector<KeyContext, MultiGetContext::MAX_BATCH_SIZE> key_context;
+      autovector<KeyContext*, MultiGetContext::MAX_BATCH_SIZE> sorted_keys;
+      for (uint32_t i = start; i < end; ++i) {
+        batch_keys.emplace_back(user_keys[i]);
+      }
+      for (uint32_t i = 0; i < end - start; ++i) {
+        get_context.emplace_back(ucomp, nullptr, nullptr, nullptr,
+                                 GetContext::kNotFound, batch_keys[i],
+                                 &batch_values[i], nullptr, nullptr, true,
+                                 nullptr, nullptr);
+        key_context.emplace_back(nullptr, batch_keys[i], &batch_values[i],
+                                 nullptr, &statuses[i]);
+        key_context.back().get_context = &get_context.back();
+      }
+      for (auto& key_ctx : key_context) {
+        sorted_keys.emplace_back(&key_ctx);
+      }
+      MultiGetContext ctx(&sorted_keys, 0, sorted_keys.size(),
+                          kMaxSequenceNumber, ReadOptions());
+      MultiGetContext::Range range = ctx.GetMultiGetRange();
+      reader->MultiGet(ReadOptions(), &range, nullptr);
+      for (uint32_t i = start; i < end; ++i) {
+        ASSERT_OK(statuses[i - start]);
+        ASSERT_EQ(GetContext::kFound, get_context[i - start].State());
+        ASSERT_EQ(values[i], batch_values[i - start].ToString());
+      }
+    }
+  }
+
   void UpdateKeys(bool with_zero_seqno) {
     for (uint32_t i = 0; i < num_items; i++) {
       ParsedInternalKey ikey(user_keys[i],
@@ -225,6 +225,15 @@ inline CompressionType get_block_compression_type(const char* block_data,
   return static_cast<CompressionType>(block_data[block_size]);
 }
 
+// kXXH3 hashes the block contents in one pass and mixes the compression type
+// from the trailer into the result, rather than hashing a discontiguous
+// buffer. This is only sound because it is done once per checksum.
+inline uint32_t ModifyChecksumForCompressionType(uint32_t checksum,
+                                                 char compression_type) {
+  const uint32_t kRandomPrime = 0x6b9083d9;
+  return checksum ^ static_cast<uint8_t>(compression_type) * kRandomPrime;
+}
+
 // Represents the contents of a block read from an SST file. Depending on how
 // it's created, it may or may not own the actual block bytes. As an example,
 // BlockContents objects representing data read from mmapped files only point
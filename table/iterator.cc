@@ -95,6 +95,23 @@ void Cleanable::RegisterCleanup(CleanupFunction func, void* arg1, void* arg2) {
   c->arg2 = arg2;
 }
 
+size_t Iterator::NextBatch(
+    size_t max_entries, size_t max_bytes,
+    const std::function<void(const Slice& key, const Slice& value)>&
+        callback) {
+  size_t num_entries = 0;
+  size_t bytes = 0;
+  while (num_entries < max_entries && bytes < max_bytes && Valid()) {
+    const Slice k = key();
+    const Slice v = value();
+    callback(k, v);
+    num_entries++;
+    bytes += k.size() + v.size();
+    Next();
+  }
+  return num_entries;
+}
+
 Status Iterator::GetProperty(std::string prop_name, std::string* prop) {
   if (prop == nullptr) {
     return Status::InvalidArgument("prop is nullptr");
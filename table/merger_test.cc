@@ -172,6 +172,21 @@ TEST_F(MergerTest, SeekToLastTest) {
   }
 }
 
+// Fewer children than kLoserTreeMinChildren merge with the min heap, more
+// with the loser tree
+TEST_F(MergerTest, SeekToRandomNextAcrossLoserTreeThresholdTest) {
+  for (size_t num_iterators : {2, 15, 16, 17, 40}) {
+    all_keys_.clear();
+    Generate(num_iterators, 50, 6);
+    for (int i = 0; i < 10; ++i) {
+      SeekToRandom();
+      AssertEquivalence();
+      NextAndPrev(200);
+      Next(1000);
+    }
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -30,10 +30,159 @@ namespace ROCKSDB_NAMESPACE {
 namespace {
 typedef BinaryHeap<IteratorWrapper*, MaxIteratorComparator> MergerMaxIterHeap;
 typedef BinaryHeap<IteratorWrapper*, MinIteratorComparator> MergerMinIterHeap;
+
+// A tournament tree of losers over the valid children in the forward
+// direction. Every internal node holds the loser of the match played there,
+// so moving the winner's child forward replays the matches on the path from
+// its leaf to the root: exactly log2(n) comparisons, against up to 2log2(n)
+// for BinaryHeap::replace_top(), with no data-dependent choice of the child
+// to descend to.
+//
+// With the bytewise comparator, the first 8 bytes of each child's user key
+// are cached as an integer, so most matches are decided without calling the
+// comparator.
+//
+// Children are added with push() and the first tournament is played by
+// Build(), or by the first call to top().
+class MergerLoserTree {
+ public:
+  explicit MergerLoserTree(const InternalKeyComparator* comparator)
+      : comparator_(comparator),
+        use_prefix_(comparator->user_comparator() == BytewiseComparator()) {}
+
+  void push(IteratorWrapper* iter) {
+    leaves_.push_back({iter, Prefix(iter)});
+    size_++;
+    built_ = false;
+  }
+
+  void Build() {
+    if (built_) {
+      return;
+    }
+    const size_t n = leaves_.size();
+    if (n == 0) {
+      built_ = true;
+      return;
+    }
+    tree_.resize(n);
+    winners_.resize(n);
+    // Node i has children 2i and 2i+1; leaf j is node n+j
+    for (size_t i = n - 1; i >= 1; i--) {
+      const size_t left = 2 * i;
+      const size_t right = 2 * i + 1;
+      const size_t a = left >= n ? left - n : winners_[left];
+      const size_t b = right >= n ? right - n : winners_[right];
+      if (Less(b, a)) {
+        winners_[i] = b;
+        tree_[i] = a;
+      } else {
+        winners_[i] = a;
+        tree_[i] = b;
+      }
+    }
+    tree_[0] = n > 1 ? winners_[1] : 0;
+    built_ = true;
+  }
+
+  IteratorWrapper* top() {
+    Build();
+    assert(!empty());
+    return leaves_[tree_[0]].iter;
+  }
+
+  // The child at top() moved and is still valid
+  void replace_top(IteratorWrapper* iter) {
+    assert(built_);
+    Leaf& leaf = leaves_[tree_[0]];
+    assert(leaf.iter == iter);
+    leaf.prefix = Prefix(iter);
+    Replay(tree_[0]);
+  }
+
+  // The child at top() is no longer valid
+  void pop() {
+    assert(built_);
+    assert(!empty());
+    leaves_[tree_[0]].iter = nullptr;
+    size_--;
+    Replay(tree_[0]);
+  }
+
+  bool empty() const { return size_ == 0; }
+
+  void clear() {
+    leaves_.clear();
+    size_ = 0;
+    built_ = false;
+  }
+
+ private:
+  struct Leaf {
+    // nullptr once the child is no longer valid, which loses every match
+    IteratorWrapper* iter;
+    uint64_t prefix;
+  };
+
+  uint64_t Prefix(IteratorWrapper* iter) const {
+    if (!use_prefix_) {
+      return 0;
+    }
+    // Big-endian and zero-padded, so integer order is bytewise order
+    const Slice user_key = ExtractUserKey(iter->key());
+    const size_t len = std::min<size_t>(user_key.size(), sizeof(uint64_t));
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < len; i++) {
+      prefix = (prefix << 8) | static_cast<unsigned char>(user_key[i]);
+    }
+    return len == 0 ? 0 : prefix << (8 * (sizeof(uint64_t) - len));
+  }
+
+  // Whether the child at leaf a comes before the child at leaf b
+  bool Less(size_t a, size_t b) const {
+    const Leaf& x = leaves_[a];
+    const Leaf& y = leaves_[b];
+    if (x.iter == nullptr) {
+      return false;
+    }
+    if (y.iter == nullptr) {
+      return true;
+    }
+    if (x.prefix != y.prefix) {
+      return x.prefix < y.prefix;
+    }
+    return comparator_->Compare(x.iter->key(), y.iter->key()) < 0;
+  }
+
+  void Replay(size_t leaf) {
+    size_t winner = leaf;
+    for (size_t i = (leaves_.size() + leaf) / 2; i >= 1; i /= 2) {
+      if (Less(tree_[i], winner)) {
+        std::swap(tree_[i], winner);
+      }
+    }
+    tree_[0] = winner;
+  }
+
+  const InternalKeyComparator* comparator_;
+  const bool use_prefix_;
+  std::vector<Leaf> leaves_;
+  // tree_[0] is the leaf of the winner, tree_[i] for i >= 1 the leaf of the
+  // loser at node i
+  std::vector<size_t> tree_;
+  // The winner at each node, only used by Build()
+  std::vector<size_t> winners_;
+  size_t size_ = 0;
+  bool built_ = false;
+};
 }  // namespace
 
 const size_t kNumIterReserve = 4;
 
+// From this many children on, the forward direction merges with a loser
+// tree instead of the min heap
+const size_t kLoserTreeMinChildren = 16;
+
 class MergingIterator : public InternalIterator {
  public:
   MergingIterator(const InternalKeyComparator* comparator,
@@ -50,6 +199,9 @@ class MergingIterator : public InternalIterator {
     for (int i = 0; i < n; i++) {
       children_[i].Set(children[i]);
     }
+    if (children_.size() >= kLoserTreeMinChildren) {
+      loserTree_.reset(new MergerLoserTree(comparator_));
+    }
     for (auto& child : children_) {
       AddToMinHeapOrCheckStatus(&child);
     }
@@ -68,6 +220,18 @@ class MergingIterator : public InternalIterator {
     if (pinned_iters_mgr_) {
       iter->SetPinnedItersMgr(pinned_iters_mgr_);
     }
+    if (children_.size() >= kLoserTreeMinChildren) {
+      // The tree refers to children_, whose elements may have moved
+      ClearHeaps();
+      if (!loserTree_) {
+        loserTree_.reset(new MergerLoserTree(comparator_));
+      }
+      for (auto& child : children_) {
+        AddToMinHeapOrCheckStatus(&child);
+      }
+      current_ = CurrentForward();
+      return;
+    }
     auto new_wrapper = children_.back();
     AddToMinHeapOrCheckStatus(&new_wrapper);
     if (new_wrapper.Valid()) {
@@ -181,11 +345,19 @@ class MergingIterator : public InternalIterator {
       // replace_top() to restore the heap property.  When the same child
       // iterator yields a sequence of keys, this is cheap.
       assert(current_->status().ok());
-      minHeap_.replace_top(current_);
+      if (loserTree_) {
+        loserTree_->replace_top(current_);
+      } else {
+        minHeap_.replace_top(current_);
+      }
     } else {
       // current stopped being valid, remove it from the heap.
       considerStatus(current_->status());
-      minHeap_.pop();
+      if (loserTree_) {
+        loserTree_->pop();
+      } else {
+        minHeap_.pop();
+      }
     }
     current_ = CurrentForward();
   }
@@ -310,6 +482,8 @@ class MergingIterator : public InternalIterator {
   };
   Direction direction_;
   MergerMinIterHeap minHeap_;
+  // Replaces minHeap_ when there are at least kLoserTreeMinChildren children
+  std::unique_ptr<MergerLoserTree> loserTree_;
   bool prefix_seek_mode_;
 
   // Max heap is used for reverse iteration, which is way less common than
@@ -318,7 +492,8 @@ class MergingIterator : public InternalIterator {
   PinnedIteratorsManager* pinned_iters_mgr_;
 
   // In forward direction, process a child that is not in the min heap.
-  // If valid, add to the min heap. Otherwise, check status.
+  // If valid, add to the min heap, or the loser tree if used. Otherwise,
+  // check status.
   void AddToMinHeapOrCheckStatus(IteratorWrapper*);
 
   // In backward direction, process a child that is not in the max heap.
@@ -331,8 +506,11 @@ class MergingIterator : public InternalIterator {
   // position. Iterator should still be valid.
   void SwitchToBackward();
 
-  IteratorWrapper* CurrentForward() const {
+  IteratorWrapper* CurrentForward() {
     assert(direction_ == kForward);
+    if (loserTree_) {
+      return !loserTree_->empty() ? loserTree_->top() : nullptr;
+    }
     return !minHeap_.empty() ? minHeap_.top() : nullptr;
   }
 
@@ -346,7 +524,11 @@ class MergingIterator : public InternalIterator {
 void MergingIterator::AddToMinHeapOrCheckStatus(IteratorWrapper* child) {
   if (child->Valid()) {
     assert(child->status().ok());
-    minHeap_.push(child);
+    if (loserTree_) {
+      loserTree_->push(child);
+    } else {
+      minHeap_.push(child);
+    }
   } else {
     considerStatus(child->status());
   }
@@ -377,6 +559,11 @@ void MergingIterator::SwitchToForward() {
     AddToMinHeapOrCheckStatus(&child);
   }
   direction_ = kForward;
+  if (loserTree_) {
+    // Plays the first tournament while current_ is still the smallest child,
+    // before Next() moves it
+    loserTree_->Build();
+  }
 }
 
 void MergingIterator::SwitchToBackward() {
@@ -407,6 +594,9 @@ void MergingIterator::SwitchToBackward() {
 
 void MergingIterator::ClearHeaps() {
   minHeap_.clear();
+  if (loserTree_) {
+    loserTree_->clear();
+  }
   if (maxHeap_) {
     maxHeap_->clear();
   }
@@ -96,6 +96,9 @@ void PropertyBlockBuilder::AddTableProperty(const TableProperties& props) {
   if (props.file_creation_time > 0) {
     Add(TablePropertiesNames::kFileCreationTime, props.file_creation_time);
   }
+  if (props.compression_dict_id > 0) {
+    Add(TablePropertiesNames::kCompressionDictId, props.compression_dict_id);
+  }
   if (!props.db_id.empty()) {
     Add(TablePropertiesNames::kDbId, props.db_id);
   }
@@ -279,6 +282,8 @@ Status ReadProperties(const ReadOptions& read_options,
        &new_table_properties->oldest_key_time},
       {TablePropertiesNames::kFileCreationTime,
        &new_table_properties->file_creation_time},
+      {TablePropertiesNames::kCompressionDictId,
+       &new_table_properties->compression_dict_id},
   };
 
   std::string last_key;
@@ -32,6 +32,8 @@ struct KeyContext {
   PinnableSlice* value;
   std::string* timestamp;
   GetContext* get_context;
+  // Set if the value found is a blob reference
+  bool is_blob_index;
 
   KeyContext(ColumnFamilyHandle* col_family, const Slice& user_key,
              PinnableSlice* val, std::string* ts, Status* stat)
@@ -44,7 +46,8 @@ struct KeyContext {
         cb_arg(nullptr),
         value(val),
         timestamp(ts),
-        get_context(nullptr) {}
+        get_context(nullptr),
+        is_blob_index(false) {}
 
   KeyContext() = default;
 };
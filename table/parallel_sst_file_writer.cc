@@ -0,0 +1,346 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/parallel_sst_file_writer.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "db/dbformat.h"
+#include "port/port.h"
+#include "rocksdb/db.h"
+#include "test_util/sync_point.h"
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// A part of the stream, built into one file
+struct Chunk {
+  struct Entry {
+    ValueType type;
+    size_t key_size;
+    size_t value_size;
+  };
+  // The keys and values of the entries, one after another
+  std::string data;
+  std::vector<Entry> entries;
+};
+
+Status AddChunk(const Chunk& chunk, SstFileWriter* writer) {
+  Status s;
+  const char* p = chunk.data.data();
+  for (const auto& entry : chunk.entries) {
+    Slice key(p, entry.key_size);
+    p += entry.key_size;
+    Slice value(p, entry.value_size);
+    p += entry.value_size;
+    switch (entry.type) {
+      case kTypeValue:
+        s = writer->Put(key, value);
+        break;
+      case kTypeMerge:
+        s = writer->Merge(key, value);
+        break;
+      case kTypeDeletion:
+        s = writer->Delete(key);
+        break;
+      default:
+        assert(false);
+        s = Status::Corruption("Unexpected entry type");
+    }
+    if (!s.ok()) {
+      break;
+    }
+  }
+  return s;
+}
+}  // namespace
+
+struct ParallelSstFileWriter::Rep {
+  Rep(const EnvOptions& _env_options, const Options& _options,
+      const std::string& _file_prefix, int num_threads,
+      uint64_t _target_file_size, ColumnFamilyHandle* _cfh)
+      : env_options(_env_options),
+        options(_options),
+        file_prefix(_file_prefix),
+        target_file_size(std::max<uint64_t>(_target_file_size, 1)),
+        cfh(_cfh),
+        max_queued(static_cast<size_t>(std::max(num_threads, 1))),
+        cv(&mu) {
+    for (int i = 0; i < std::max(num_threads, 1); i++) {
+      threads.emplace_back(&Rep::BuildThread, this);
+    }
+  }
+
+  ~Rep() { StopThreads(); }
+
+  Status Add(const Slice& user_key, const Slice& value, ValueType type);
+  Status Submit(std::function<Status(SstFileWriter*)> fill);
+  // Submits the pending part of the stream, if any
+  Status SubmitChunk();
+  void BuildThread();
+  void BuildFile(const std::function<Status(SstFileWriter*)>& fill);
+  void StopThreads();
+  void DeleteFiles();
+
+  const EnvOptions env_options;
+  const Options options;
+  const std::string file_prefix;
+  const uint64_t target_file_size;
+  ColumnFamilyHandle* const cfh;
+  // The most files waiting for a build thread, which bounds the memory
+  // taken by the stream
+  const size_t max_queued;
+
+  // The part of the stream not submitted yet
+  std::unique_ptr<Chunk> chunk;
+  std::string last_key;
+  bool has_last_key = false;
+  bool finished = false;
+
+  port::Mutex mu;
+  port::CondVar cv;
+  // Protected by mu
+  std::deque<std::function<Status(SstFileWriter*)>> queue;
+  // The number of files queued or being built
+  size_t pending = 0;
+  bool stop = false;
+  Status status;
+  uint64_t next_file_number = 1;
+  std::vector<ExternalSstFileInfo> file_infos;
+
+  std::vector<port::Thread> threads;
+};
+
+Status ParallelSstFileWriter::Rep::Add(const Slice& user_key,
+                                       const Slice& value, ValueType type) {
+  if (finished) {
+    return Status::InvalidArgument("Writer is finished");
+  }
+  if (has_last_key && options.comparator->Compare(user_key, last_key) <= 0) {
+    return Status::InvalidArgument(
+        "Keys must be added in strict ascending order.");
+  }
+  if (chunk == nullptr) {
+    chunk.reset(new Chunk());
+  }
+  chunk->data.append(user_key.data(), user_key.size());
+  chunk->data.append(value.data(), value.size());
+  chunk->entries.push_back({type, user_key.size(), value.size()});
+  last_key.assign(user_key.data(), user_key.size());
+  has_last_key = true;
+  if (chunk->data.size() >= target_file_size) {
+    return SubmitChunk();
+  }
+  return Status::OK();
+}
+
+Status ParallelSstFileWriter::Rep::SubmitChunk() {
+  if (chunk == nullptr) {
+    return Status::OK();
+  }
+  std::shared_ptr<Chunk> submitted(chunk.release());
+  return Submit([submitted](SstFileWriter* writer) {
+    return AddChunk(*submitted, writer);
+  });
+}
+
+Status ParallelSstFileWriter::Rep::Submit(
+    std::function<Status(SstFileWriter*)> fill) {
+  MutexLock l(&mu);
+  while (queue.size() >= max_queued && status.ok()) {
+    cv.Wait();
+  }
+  if (!status.ok()) {
+    return status;
+  }
+  queue.push_back(std::move(fill));
+  pending++;
+  cv.SignalAll();
+  return Status::OK();
+}
+
+void ParallelSstFileWriter::Rep::BuildThread() {
+  while (true) {
+    std::function<Status(SstFileWriter*)> fill;
+    {
+      MutexLock l(&mu);
+      while (queue.empty() && !stop) {
+        cv.Wait();
+      }
+      if (queue.empty()) {
+        return;
+      }
+      fill = std::move(queue.front());
+      queue.pop_front();
+      // Makes room for the next file
+      cv.SignalAll();
+    }
+    BuildFile(fill);
+  }
+}
+
+void ParallelSstFileWriter::Rep::BuildFile(
+    const std::function<Status(SstFileWriter*)>& fill) {
+  uint64_t file_number;
+  {
+    MutexLock l(&mu);
+    file_number = next_file_number++;
+  }
+  const std::string file_path = file_prefix + ToString(file_number) + ".sst";
+
+  SstFileWriter writer(env_options, options, cfh);
+  ExternalSstFileInfo file_info;
+  Status s = writer.Open(file_path);
+  if (s.ok()) {
+    s = fill(&writer);
+  }
+  if (s.ok()) {
+    s = writer.Finish(&file_info);
+  } else {
+    options.env->DeleteFile(file_path);
+  }
+  TEST_SYNC_POINT_CALLBACK("ParallelSstFileWriter::BuildFile:Done", &s);
+
+  MutexLock l(&mu);
+  if (s.ok()) {
+    file_infos.push_back(std::move(file_info));
+  } else if (status.ok()) {
+    status = s;
+  }
+  pending--;
+  cv.SignalAll();
+}
+
+void ParallelSstFileWriter::Rep::StopThreads() {
+  {
+    MutexLock l(&mu);
+    // Files not started are dropped after an error
+    if (!status.ok()) {
+      pending -= queue.size();
+      queue.clear();
+    }
+    stop = true;
+    cv.SignalAll();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+}
+
+void ParallelSstFileWriter::Rep::DeleteFiles() {
+  for (const auto& file_info : file_infos) {
+    options.env->DeleteFile(file_info.file_path);
+  }
+  file_infos.clear();
+}
+
+ParallelSstFileWriter::ParallelSstFileWriter(const EnvOptions& env_options,
+                                             const Options& options,
+                                             const std::string& file_prefix,
+                                             int num_threads,
+                                             uint64_t target_file_size,
+                                             ColumnFamilyHandle* column_family)
+    : rep_(new Rep(env_options, options, file_prefix, num_threads,
+                   target_file_size, column_family)) {}
+
+ParallelSstFileWriter::~ParallelSstFileWriter() {
+  if (!rep_->finished) {
+    {
+      MutexLock l(&rep_->mu);
+      if (rep_->status.ok()) {
+        rep_->status = Status::Aborted("Writer is not finished");
+      }
+    }
+    rep_->StopThreads();
+    rep_->DeleteFiles();
+  }
+}
+
+Status ParallelSstFileWriter::Put(const Slice& user_key, const Slice& value) {
+  return rep_->Add(user_key, value, kTypeValue);
+}
+
+Status ParallelSstFileWriter::Merge(const Slice& user_key,
+                                    const Slice& value) {
+  return rep_->Add(user_key, value, kTypeMerge);
+}
+
+Status ParallelSstFileWriter::Delete(const Slice& user_key) {
+  return rep_->Add(user_key, Slice(), kTypeDeletion);
+}
+
+Status ParallelSstFileWriter::AddPartition(
+    std::function<Status(SstFileWriter*)> fill) {
+  if (rep_->finished) {
+    return Status::InvalidArgument("Writer is finished");
+  }
+  return rep_->Submit(std::move(fill));
+}
+
+Status ParallelSstFileWriter::Finish(
+    std::vector<ExternalSstFileInfo>* file_infos) {
+  Rep* r = rep_.get();
+  if (r->finished) {
+    return Status::InvalidArgument("Writer is finished");
+  }
+  Status s = r->SubmitChunk();
+  r->finished = true;
+  {
+    MutexLock l(&r->mu);
+    while (r->pending > 0 && r->status.ok()) {
+      r->cv.Wait();
+    }
+    if (s.ok()) {
+      s = r->status;
+    } else if (r->status.ok()) {
+      r->status = s;
+    }
+  }
+  r->StopThreads();
+  if (!s.ok()) {
+    r->DeleteFiles();
+    return s;
+  }
+
+  const Comparator* ucmp = r->options.comparator;
+  std::sort(r->file_infos.begin(), r->file_infos.end(),
+            [ucmp](const ExternalSstFileInfo& a, const ExternalSstFileInfo& b) {
+              return ucmp->Compare(a.smallest_key, b.smallest_key) < 0;
+            });
+  if (file_infos != nullptr) {
+    *file_infos = r->file_infos;
+  }
+  return s;
+}
+
+Status ParallelSstFileWriter::Ingest(
+    DB* db, const IngestExternalFileOptions& ingest_options) {
+  Rep* r = rep_.get();
+  if (!r->finished || !r->status.ok()) {
+    return Status::InvalidArgument("Writer is not finished");
+  }
+  if (r->file_infos.empty()) {
+    return Status::InvalidArgument("No files to ingest");
+  }
+  std::vector<std::string> files;
+  files.reserve(r->file_infos.size());
+  for (const auto& file_info : r->file_infos) {
+    files.push_back(file_info.file_path);
+  }
+  ColumnFamilyHandle* cfh =
+      r->cfh != nullptr ? r->cfh : db->DefaultColumnFamily();
+  Status s = db->IngestExternalFile(cfh, files, ingest_options);
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !ROCKSDB_LITE
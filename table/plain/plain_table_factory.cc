@@ -158,7 +158,12 @@ Status GetMemTableRepFactoryFromString(
   std::vector<std::string> opts_list = StringSplit(opts_str, ':');
   size_t len = opts_list.size();
 
-  if (opts_list.empty() || opts_list.size() > 2) {
+  // Only skip_list takes a second option, a number
+  if (opts_list.empty() || opts_list.size() > 3 ||
+      (opts_list.size() == 3 &&
+       ((opts_list[0] != "skip_list" && opts_list[0] != "SkipListFactory") ||
+        opts_list[2].empty() ||
+        opts_list[2].find_first_not_of("0123456789") != std::string::npos))) {
     return Status::InvalidArgument("Can't parse memtable_factory option ",
                                    opts_str);
   }
@@ -167,8 +172,12 @@ Status GetMemTableRepFactoryFromString(
 
   if (opts_list[0] == "skip_list" || opts_list[0] == "SkipListFactory") {
     // Expecting format
-    // skip_list:<lookahead>
-    if (2 == len) {
+    // skip_list:<lookahead>[:<prefix_index_buckets>]
+    if (3 == len) {
+      size_t lookahead = ParseSizeT(opts_list[1]);
+      size_t prefix_index_buckets = ParseSizeT(opts_list[2]);
+      mem_factory = new SkipListFactory(lookahead, prefix_index_buckets);
+    } else if (2 == len) {
       size_t lookahead = ParseSizeT(opts_list[1]);
       mem_factory = new SkipListFactory(lookahead);
     } else if (1 == len) {
@@ -203,6 +212,15 @@ Status GetMemTableRepFactoryFromString(
     } else if (1 == len) {
       mem_factory = new VectorRepFactory();
     }
+  } else if (opts_list[0] == "btree" || opts_list[0] == "BTreeRepFactory") {
+    // Expecting format
+    // btree
+    if (1 == len) {
+      mem_factory = new BTreeRepFactory();
+    } else {
+      return Status::InvalidArgument("btree memtable takes no options ",
+                                     opts_str);
+    }
   } else if (opts_list[0] == "cuckoo") {
     return Status::NotSupported(
         "cuckoo hash memtable is not supported anymore.");
@@ -23,6 +23,7 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class BlockCacheWarmup;
 class Slice;
 class Status;
 
@@ -84,6 +85,12 @@ struct TableReaderOptions {
   // Largest L0 file size whose meta-blocks may be pinned (can be zero when
   // unknown).
   const size_t max_file_size_for_l0_meta_pin;
+  // The last bytes of the file, if known, to read the table metadata from
+  // instead of the file. Only used by BlockBasedTable.
+  Slice prefetched_tail;
+  // If not nullptr, the data blocks read through the block cache are
+  // recorded to warm the cache up with. Only used by BlockBasedTable.
+  BlockCacheWarmup* block_cache_warmup = nullptr;
 };
 
 struct TableBuilderOptions {
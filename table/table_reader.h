@@ -22,6 +22,7 @@ class Iterator;
 struct ParsedInternalKey;
 class Slice;
 class Arena;
+class BlockHandle;
 struct ReadOptions;
 struct TableProperties;
 class GetContext;
@@ -82,6 +83,25 @@ class TableReader {
   virtual uint64_t ApproximateSize(const Slice& start, const Slice& end,
                                    TableReaderCaller caller) = 0;
 
+  // A user key of the table, with the approximate number of bytes of the
+  // table from the previous anchor (or the start of the table) to it
+  struct Anchor {
+    Anchor(const Slice& _user_key, uint64_t _range_size)
+        : user_key(_user_key.ToString()), range_size(_range_size) {}
+    std::string user_key;
+    uint64_t range_size;
+  };
+
+  // Appends to *anchors up to about kMaxNumAnchors user keys sampled from the
+  // table in ascending order, the last one not smaller than any user key of
+  // the table, so that the table can be split into ranges of about equal
+  // size. Used to pick the boundaries of subcompactions.
+  static const size_t kMaxNumAnchors = 128;
+  virtual Status ApproximateKeyAnchors(const ReadOptions& /*read_options*/,
+                                       std::vector<Anchor>* /*anchors*/) {
+    return Status::NotSupported("ApproximateKeyAnchors() not supported.");
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
@@ -142,6 +162,23 @@ class TableReader {
                                 TableReaderCaller /*caller*/) {
     return Status::NotSupported("VerifyChecksum() not supported");
   }
+
+  // Reads the last bytes of the file the table was opened from, which can
+  // be passed as TableReaderOptions::prefetched_tail to open it again
+  // without reading the file.
+  virtual Status ReadMetadataTail(std::string* /*tail*/) {
+    return Status::NotSupported("ReadMetadataTail() not supported");
+  }
+
+  // Reads the data blocks of the handles, sorted by offset, into the block
+  // cache, in one batch of reads for the blocks not cached already. Sets
+  // *num_loaded to the number of blocks inserted into the cache.
+  virtual Status LoadBlocksIntoCache(
+      const ReadOptions& /*read_options*/,
+      const std::vector<BlockHandle>& /*handles*/, size_t* num_loaded) {
+    *num_loaded = 0;
+    return Status::NotSupported("LoadBlocksIntoCache() not supported");
+  }
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -22,6 +22,7 @@ int main() {
 #include "table/block_based/block_based_table_factory.h"
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
+#include "table/multiget_context.h"
 #include "table/plain/plain_table_factory.h"
 #include "table/table_builder.h"
 #include "test_util/testharness.h"
@@ -68,12 +69,17 @@ uint64_t Now(Env* env, bool measured_by_nanosecond) {
 //
 // If for_terator=true, instead of just query one key each time, it queries
 // a range sharing the same prefix.
+//
+// If multiget_batch_size > 0, the keys are queried with MultiGet in batches
+// of that size, and the latency of a key is that of its batch divided by the
+// batch size.
 namespace {
 void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
                           ReadOptions& read_options, int num_keys1,
                           int num_keys2, int num_iter, int /*prefix_len*/,
                           bool if_query_empty_keys, bool for_iterator,
-                          bool through_db, bool measured_by_nanosecond) {
+                          bool through_db, bool measured_by_nanosecond,
+                          int multiget_batch_size) {
   ROCKSDB_NAMESPACE::InternalKeyComparator ikc(opts.comparator);
 
   std::string file_name =
@@ -155,6 +161,51 @@ void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
   std::string result;
   HistogramImpl hist;
 
+  const size_t batch_size = static_cast<size_t>(std::min<int>(
+      std::max(multiget_batch_size, 0), MultiGetContext::MAX_BATCH_SIZE));
+  std::vector<std::string> batch;
+  auto multiget = [&]() {
+    if (batch.empty()) {
+      return;
+    }
+    std::vector<Slice> user_keys;
+    for (const auto& key : batch) {
+      user_keys.push_back(through_db ? Slice(key) : ExtractUserKey(key));
+    }
+    std::vector<PinnableSlice> values(batch.size());
+    std::vector<Status> statuses(batch.size());
+    uint64_t start_time = Now(env, measured_by_nanosecond);
+    if (!through_db) {
+      std::vector<MergeContext> merge_contexts(batch.size());
+      autovector<GetContext, MultiGetContext::MAX_BATCH_SIZE> get_contexts;
+      autovector<KeyContext, MultiGetContext::MAX_BATCH_SIZE> key_contexts;
+      autovector<KeyContext*, MultiGetContext::MAX_BATCH_SIZE> sorted_keys;
+      SequenceNumber max_covering_tombstone_seq = 0;
+      for (size_t k = 0; k < batch.size(); k++) {
+        get_contexts.emplace_back(
+            ioptions.user_comparator, ioptions.merge_operator,
+            ioptions.info_log, ioptions.statistics, GetContext::kNotFound,
+            user_keys[k], &values[k], nullptr, &merge_contexts[k], true,
+            &max_covering_tombstone_seq, env);
+        key_contexts.emplace_back(nullptr, user_keys[k], &values[k], nullptr,
+                                  &statuses[k]);
+        key_contexts.back().get_context = &get_contexts.back();
+      }
+      for (auto& key_context : key_contexts) {
+        sorted_keys.emplace_back(&key_context);
+      }
+      MultiGetContext ctx(&sorted_keys, 0, sorted_keys.size(),
+                          kMaxSequenceNumber, read_options);
+      MultiGetContext::Range range = ctx.GetMultiGetRange();
+      table_reader->MultiGet(read_options, &range, nullptr);
+    } else {
+      db->MultiGet(read_options, db->DefaultColumnFamily(), batch.size(),
+                   user_keys.data(), values.data(), statuses.data());
+    }
+    hist.Add((Now(env, measured_by_nanosecond) - start_time) / batch.size());
+    batch.clear();
+  };
+
   for (int it = 0; it < num_iter; it++) {
     for (int i = 0; i < num_keys1; i++) {
       for (int j = 0; j < num_keys2; j++) {
@@ -165,7 +216,12 @@ void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
           r2 = num_keys2 * 2 - r2;
         }
 
-        if (!for_iterator) {
+        if (!for_iterator && batch_size > 0) {
+          batch.push_back(MakeKey(r1, r2, through_db));
+          if (batch.size() == batch_size) {
+            multiget();
+          }
+        } else if (!for_iterator) {
           // Query one existing key;
           std::string key = MakeKey(r1, r2, through_db);
           uint64_t start_time = Now(env, measured_by_nanosecond);
@@ -235,6 +291,7 @@ void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
       }
     }
   }
+  multiget();
 
   fprintf(
       stderr,
@@ -246,7 +303,11 @@ void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
       "===================================================="
       "\nHistogram (unit: %s): \n%s",
       opts.table_factory->Name(), num_keys1, num_keys2,
-      for_iterator ? "iterator" : (if_query_empty_keys ? "empty" : "non_empty"),
+      for_iterator
+          ? "iterator"
+          : (batch_size > 0
+                 ? (if_query_empty_keys ? "multiget_empty" : "multiget")
+                 : (if_query_empty_keys ? "empty" : "non_empty")),
       measured_by_nanosecond ? "nanosecond" : "microsecond",
       hist.ToString().c_str());
   if (!through_db) {
@@ -271,6 +332,9 @@ DEFINE_bool(through_db, false, "If enable, a DB instance will be created and "
             "the query will be against DB. Otherwise, will be directly against "
             "a table reader.");
 DEFINE_bool(mmap_read, true, "Whether use mmap read");
+DEFINE_int32(multiget_batch_size, 0,
+             "If > 0, query the keys with MultiGet in batches of this size "
+             "(at most 32) instead of one by one");
 DEFINE_string(table_factory, "block_based",
               "Table factory to use: `block_based` (default), `plain_table` or "
               "`cuckoo_hash`.");
@@ -336,7 +400,7 @@ int main(int argc, char** argv) {
     ROCKSDB_NAMESPACE::TableReaderBenchmark(
         options, env_options, ro, FLAGS_num_keys1, FLAGS_num_keys2, FLAGS_iter,
         FLAGS_prefix_len, FLAGS_query_empty, FLAGS_iterator, FLAGS_through_db,
-        measured_by_nanosecond);
+        measured_by_nanosecond, FLAGS_multiget_batch_size);
   } else {
     return 1;
   }
@@ -2142,6 +2142,12 @@ TEST_P(BlockBasedTableTest, HashIndexTest) {
   IndexTest(table_options);
 }
 
+TEST_P(BlockBasedTableTest, SuccinctTrieIndexTest) {
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.index_type = BlockBasedTableOptions::kSuccinctTrieSearch;
+  IndexTest(table_options);
+}
+
 TEST_P(BlockBasedTableTest, PartitionIndexTest) {
   const int max_index_keys = 5;
   const int est_max_index_key_value_size = 32;
@@ -3625,6 +3631,45 @@ TEST_F(GeneralTableTest, ApproximateOffsetOfCompressed) {
   }
 }
 
+TEST_F(GeneralTableTest, PooledZSTDCompression) {
+  if (!ZSTD_Supported()) {
+    fprintf(stderr, "skipping zstd compression tests\n");
+    return;
+  }
+  std::string dict;
+  for (int i = 0; i < 100; i++) {
+    dict.append("dictionary entry " + ToString(i) + ";");
+  }
+  CompressionDict dict1(dict, kZSTD, 3);
+  CompressionDict dict2(dict, kZSTD, 3);
+  CompressionDict dict3(dict, kZSTD, 4);
+#if ZSTD_VERSION_NUMBER >= 700
+  ASSERT_NE(nullptr, dict1.GetDigestedZstdCDict());
+  // Digested dictionaries are shared by dictionary and level
+  ASSERT_EQ(dict1.GetDigestedZstdCDict(), dict2.GetDigestedZstdCDict());
+  ASSERT_NE(dict1.GetDigestedZstdCDict(), dict3.GetDigestedZstdCDict());
+#endif  // ZSTD_VERSION_NUMBER >= 700
+
+  const std::string input = "dictionary entry 7;dictionary entry 42;" + dict;
+  CompressionOptions opts;
+  for (int i = 0; i < 3; i++) {
+    // Pooled contexts are reused across builders
+    CompressionContext ctx(kZSTD);
+    CompressionInfo info(opts, ctx, i == 0 ? dict1 : dict2, kZSTD,
+                         0 /* sample_for_compression */);
+    std::string compressed;
+    ASSERT_TRUE(ZSTD_Compress(info, input.data(), input.size(), &compressed));
+
+    UncompressionContext uctx(kZSTD);
+    UncompressionDict udict(dict, true /* using_zstd */);
+    UncompressionInfo uinfo(uctx, udict, kZSTD);
+    size_t uncompressed_size = 0;
+    CacheAllocationPtr uncompressed = ZSTD_Uncompress(
+        uinfo, compressed.data(), compressed.size(), &uncompressed_size);
+    ASSERT_EQ(input, std::string(uncompressed.get(), uncompressed_size));
+  }
+}
+
 #ifndef ROCKSDB_VALGRIND_RUN
 TEST_P(ParameterizedHarnessTest, RandomizedHarnessTest) {
   Random rnd(test::RandomSeed() + 5);
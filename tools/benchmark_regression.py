@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+# Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
+from __future__ import absolute_import, division, print_function, unicode_literals
+
+# Runs a suite of db_bench benchmarks several times, collecting the JSON
+# reports of --json_report_file, and compares the results with a baseline.
+#
+#   benchmark_regression.py run --db_bench=./db_bench --output=new.json
+#   benchmark_regression.py compare --baseline=base.json --current=new.json
+#   benchmark_regression.py run --db_bench=./db_bench --output=new.json \
+#       --baseline=base.json
+#
+# A metric regresses when its mean is worse than the baseline one by more
+# than --threshold percent and the difference is significant, Welch's t
+# statistic of the samples being above --min_t. The exit code is 1 when a
+# metric regresses.
+
+import argparse
+import json
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+# Each test runs its db_bench command line on a new database. Its
+# benchmarks, but those of skip, are compared.
+default_suite = [
+    {
+        "name": "fillrandom",
+        "args": ["--benchmarks=fillrandom", "--num=1000000"],
+    },
+    {
+        "name": "readrandom",
+        "args": [
+            "--benchmarks=fillseq,readrandom",
+            "--num=1000000",
+            "--reads=200000",
+        ],
+        "skip": ["fillseq"],
+    },
+    {
+        "name": "seekrandom",
+        "args": [
+            "--benchmarks=fillseq,seekrandom",
+            "--num=1000000",
+            "--reads=100000",
+            "--seek_nexts=10",
+        ],
+        "skip": ["fillseq"],
+    },
+    {
+        "name": "readwhilewriting",
+        "args": [
+            "--benchmarks=fillseq,readwhilewriting",
+            "--num=1000000",
+            "--duration=30",
+            "--threads=4",
+        ],
+        "skip": ["fillseq"],
+    },
+    {
+        "name": "ycsba",
+        "args": [
+            "--benchmarks=fillseq,ycsba",
+            "--num=1000000",
+            "--value_size=1000",
+            "--duration=30",
+            "--threads=4",
+        ],
+        "skip": ["fillseq"],
+    },
+]
+
+# The metrics compared, with whether higher values are better
+throughput_metrics = {"ops_per_sec": True, "mb_per_sec": True}
+latency_metrics = {"p50": False, "p99": False, "p99.9": False}
+
+
+def run_test(db_bench, test, extra_args, repeats):
+    samples = {}
+    for _ in range(repeats):
+        work_dir = tempfile.mkdtemp(prefix="rocksdb_bench_")
+        report = os.path.join(work_dir, "report.json")
+        cmd = (
+            [db_bench, "--db=" + os.path.join(work_dir, "db")]
+            + test["args"]
+            + extra_args
+            + ["--json_report_file=" + report]
+        )
+        print("Running " + " ".join(cmd))
+        try:
+            subprocess.check_call(cmd, stdout=subprocess.DEVNULL)
+            with open(report) as f:
+                reports = [json.loads(line) for line in f if line.strip()]
+        finally:
+            shutil.rmtree(work_dir, ignore_errors=True)
+
+        for report in reports:
+            if report["benchmark"] in test.get("skip", []):
+                continue
+            metrics = samples.setdefault(report["benchmark"], {})
+            for metric in throughput_metrics:
+                metrics.setdefault(metric, []).append(report[metric])
+            for op, latency in report.get("latency_micros", {}).items():
+                for metric in latency_metrics:
+                    metrics.setdefault(op + "." + metric, []).append(
+                        latency[metric]
+                    )
+    return samples
+
+
+def mean_and_variance(values):
+    mean = sum(values) / len(values)
+    if len(values) < 2:
+        return mean, 0.0
+    return mean, sum((v - mean) ** 2 for v in values) / (len(values) - 1)
+
+
+def welch_t(baseline, current):
+    base_mean, base_var = mean_and_variance(baseline)
+    cur_mean, cur_var = mean_and_variance(current)
+    stderr = math.sqrt(base_var / len(baseline) + cur_var / len(current))
+    if stderr == 0:
+        return float("inf") if cur_mean != base_mean else 0.0
+    return abs(cur_mean - base_mean) / stderr
+
+
+def higher_is_better(metric):
+    if metric in throughput_metrics:
+        return throughput_metrics[metric]
+    # Latencies of the operations are named <op>.<percentile>
+    return latency_metrics[metric.split(".", 1)[1]]
+
+
+def compare(baseline, current, threshold, min_t):
+    regressions = 0
+    for test in sorted(current):
+        for benchmark in sorted(current[test]):
+            base_metrics = baseline.get(test, {}).get(benchmark)
+            if base_metrics is None:
+                print("%s/%s: no baseline" % (test, benchmark))
+                continue
+            for metric in sorted(current[test][benchmark]):
+                if metric not in base_metrics:
+                    continue
+                base = base_metrics[metric]
+                cur = current[test][benchmark][metric]
+                base_mean = mean_and_variance(base)[0]
+                cur_mean = mean_and_variance(cur)[0]
+                if base_mean == 0:
+                    continue
+                change = (cur_mean - base_mean) * 100.0 / base_mean
+                worse = -change if higher_is_better(metric) else change
+                t = welch_t(base, cur)
+                status = "ok"
+                if worse > threshold and t > min_t:
+                    status = "REGRESSION"
+                    regressions += 1
+                elif -worse > threshold and t > min_t:
+                    status = "improvement"
+                print(
+                    "%-12s %s/%s %s: %.2f -> %.2f (%+.1f%%, t=%.2f)"
+                    % (status, test, benchmark, metric, base_mean, cur_mean,
+                       change, t)
+                )
+    print("%d regression(s)" % regressions)
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Runs db_bench benchmarks and compares them with a baseline"
+    )
+    parser.add_argument("command", choices=["run", "compare"])
+    parser.add_argument("--db_bench", default="./db_bench")
+    parser.add_argument(
+        "--suite", help="JSON file with a list of tests as default_suite"
+    )
+    parser.add_argument(
+        "--extra_args",
+        default="",
+        help="db_bench arguments added to those of every test, e.g. "
+        "--fs_uri=zenfs://dev:nullb1",
+    )
+    parser.add_argument("--repeats", type=int, default=3)
+    parser.add_argument("--output", help="Results of the run command")
+    parser.add_argument("--baseline", help="Results to compare with")
+    parser.add_argument("--current", help="Results compared by compare")
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=5.0,
+        help="Percent a metric must worsen by to regress",
+    )
+    parser.add_argument(
+        "--min_t",
+        type=float,
+        default=2.0,
+        help="Welch's t statistic a regression must be above",
+    )
+    args = parser.parse_args()
+
+    if args.command == "run":
+        suite = default_suite
+        if args.suite:
+            with open(args.suite) as f:
+                suite = json.load(f)
+        current = {}
+        for test in suite:
+            current[test["name"]] = run_test(
+                args.db_bench, test, args.extra_args.split(), args.repeats
+            )
+        if args.output:
+            with open(args.output, "w") as f:
+                json.dump(current, f, indent=2, sort_keys=True)
+    else:
+        if not args.current or not args.baseline:
+            parser.error("compare needs --baseline and --current")
+        with open(args.current) as f:
+            current = json.load(f)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if compare(baseline, current, args.threshold, args.min_t) > 0:
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
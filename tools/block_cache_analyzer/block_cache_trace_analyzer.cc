@@ -34,15 +34,25 @@ DEFINE_string(
     "The config file path. One cache configuration per line. The format of a "
     "cache configuration is "
     "cache_name,num_shard_bits,ghost_capacity,cache_capacity_1,...,cache_"
-    "capacity_N. Supported cache names are lru, lru_priority, lru_hybrid, and "
-    "lru_hybrid_no_insert_on_row_miss. User may also add a prefix 'ghost_' to "
-    "a cache_name to add a ghost cache in front of the real cache. "
+    "capacity_N. Supported cache names are lru, lru_tinylfu, lru_priority, "
+    "lru_hybrid, and lru_hybrid_no_insert_on_row_miss. User may also add a "
+    "prefix 'ghost_' to a cache_name to add a ghost cache in front of the "
+    "real cache. "
     "ghost_capacity and cache_capacity can be xK, xM or xG where x is a "
     "positive number.");
 DEFINE_int32(block_cache_trace_downsample_ratio, 1,
              "The trace collected accesses on one in every "
              "block_cache_trace_downsample_ratio blocks. We scale "
              "down the simulated cache size by this ratio.");
+DEFINE_int32(block_cache_sim_threads, 1,
+             "The number of threads that simulate the configured caches. The "
+             "trace is read once and its accesses are handed to all threads.");
+DEFINE_double(block_cache_sim_sampling_rate, 1.0,
+              "Simulate only the accesses to this fraction of the blocks, "
+              "selected by hashing the block key, on caches scaled down by "
+              "the same fraction. Approximates the miss ratio curves faster.");
+DEFINE_bool(block_cache_trace_use_mmap, false,
+            "Read the binary trace file through mmap.");
 DEFINE_bool(print_block_size_stats, false,
             "Print block size distribution and the distribution break down by "
             "block type and column family.");
@@ -166,7 +176,8 @@ const std::set<std::string> kGroupbyLabels{
     kGroupbyBlock,     kGroupbyColumnFamily, kGroupbySSTFile, kGroupbyLevel,
     kGroupbyBlockType, kGroupbyCaller,       kGroupbyAll};
 const std::string kSupportedCacheNames =
-    " lru ghost_lru lru_priority ghost_lru_priority lru_hybrid "
+    " lru ghost_lru lru_tinylfu ghost_lru_tinylfu lru_priority "
+    "ghost_lru_priority lru_hybrid "
     "ghost_lru_hybrid lru_hybrid_no_insert_on_row_miss "
     "ghost_lru_hybrid_no_insert_on_row_miss ";
 
@@ -1438,7 +1449,8 @@ BlockCacheTraceAnalyzer::BlockCacheTraceAnalyzer(
     const std::string& human_readable_trace_file_path,
     bool compute_reuse_distance, bool mrc_only,
     bool is_human_readable_trace_file,
-    std::unique_ptr<BlockCacheTraceSimulator>&& cache_simulator)
+    std::unique_ptr<BlockCacheTraceSimulator>&& cache_simulator,
+    bool use_mmap_reads)
     : env_(ROCKSDB_NAMESPACE::Env::Default()),
       trace_file_path_(trace_file_path),
       output_dir_(output_dir),
@@ -1446,6 +1458,7 @@ BlockCacheTraceAnalyzer::BlockCacheTraceAnalyzer(
       compute_reuse_distance_(compute_reuse_distance),
       mrc_only_(mrc_only),
       is_human_readable_trace_file_(is_human_readable_trace_file),
+      use_mmap_reads_(use_mmap_reads),
       cache_simulator_(std::move(cache_simulator)) {}
 
 void BlockCacheTraceAnalyzer::ComputeReuseDistance(
@@ -1525,7 +1538,9 @@ Status BlockCacheTraceAnalyzer::Analyze() {
     reader.reset(new BlockCacheHumanReadableTraceReader(trace_file_path_));
   } else {
     std::unique_ptr<TraceReader> trace_reader;
-    s = NewFileTraceReader(env_, EnvOptions(), trace_file_path_, &trace_reader);
+    EnvOptions env_options;
+    env_options.use_mmap_reads = use_mmap_reads_;
+    s = NewFileTraceReader(env_, env_options, trace_file_path_, &trace_reader);
     if (!s.ok()) {
       return s;
     }
@@ -1582,6 +1597,9 @@ Status BlockCacheTraceAnalyzer::Analyze() {
       time_interval++;
     }
   }
+  if (cache_simulator_) {
+    cache_simulator_->Finish();
+  }
   uint64_t now = env_->NowMicros();
   uint64_t duration = (now - start) / kMicrosInSecond;
   uint64_t trace_duration =
@@ -2120,7 +2138,9 @@ int block_cache_trace_analyzer_tool(int argc, char** argv) {
   std::unique_ptr<BlockCacheTraceSimulator> cache_simulator;
   if (!cache_configs.empty()) {
     cache_simulator.reset(new BlockCacheTraceSimulator(
-        warmup_seconds, downsample_ratio, cache_configs));
+        warmup_seconds, downsample_ratio, cache_configs,
+        FLAGS_block_cache_sim_threads > 0 ? FLAGS_block_cache_sim_threads : 1,
+        FLAGS_block_cache_sim_sampling_rate));
     Status s = cache_simulator->InitializeCaches();
     if (!s.ok()) {
       fprintf(stderr, "Cannot initialize cache simulators %s\n",
@@ -2132,7 +2152,8 @@ int block_cache_trace_analyzer_tool(int argc, char** argv) {
       FLAGS_block_cache_trace_path, FLAGS_block_cache_analysis_result_dir,
       FLAGS_human_readable_trace_file_path,
       !FLAGS_reuse_distance_labels.empty(), FLAGS_mrc_only,
-      FLAGS_is_block_cache_human_readable_trace, std::move(cache_simulator));
+      FLAGS_is_block_cache_human_readable_trace, std::move(cache_simulator),
+      FLAGS_block_cache_trace_use_mmap);
   Status s = analyzer.Analyze();
   if (!s.IsIncomplete() && !s.ok()) {
     // Read all traces.
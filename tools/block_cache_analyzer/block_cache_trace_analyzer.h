@@ -147,7 +147,8 @@ class BlockCacheTraceAnalyzer {
       const std::string& human_readable_trace_file_path,
       bool compute_reuse_distance, bool mrc_only,
       bool is_human_readable_trace_file,
-      std::unique_ptr<BlockCacheTraceSimulator>&& cache_simulator);
+      std::unique_ptr<BlockCacheTraceSimulator>&& cache_simulator,
+      bool use_mmap_reads = false);
   ~BlockCacheTraceAnalyzer() = default;
   // No copy and move.
   BlockCacheTraceAnalyzer(const BlockCacheTraceAnalyzer&) = delete;
@@ -374,6 +375,7 @@ class BlockCacheTraceAnalyzer {
   const bool compute_reuse_distance_;
   const bool mrc_only_;
   const bool is_human_readable_trace_file_;
+  const bool use_mmap_reads_;
 
   BlockCacheTraceHeader header_;
   std::unique_ptr<BlockCacheTraceSimulator> cache_simulator_;
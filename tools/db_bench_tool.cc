@@ -31,7 +31,10 @@
 #include "db/db_impl/db_impl.h"
 #include "db/malloc_stats.h"
 #include "db/version_set.h"
+#include "env/fs_hedged.h"
+#include "env/fs_tiered.h"
 #include "hdfs/env_hdfs.h"
+#include "logging/event_logger.h"
 #include "monitoring/histogram.h"
 #include "monitoring/statistics.h"
 #include "options/cf_options.h"
@@ -40,14 +43,19 @@
 #include "rocksdb/cache.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
+#include "rocksdb/env_encryption.h"
 #include "rocksdb/filter_policy.h"
+#include "rocksdb/lock_profiler.h"
+#include "rocksdb/memory_governor.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/options.h"
 #include "rocksdb/perf_context.h"
 #include "rocksdb/persistent_cache.h"
 #include "rocksdb/rate_limiter.h"
+#include "rocksdb/secondary_cache.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/sst_partitioner.h"
 #include "rocksdb/stats_history.h"
 #include "rocksdb/utilities/object_registry.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
@@ -122,6 +130,8 @@ DEFINE_string(
     "fill100K,"
     "crc32c,"
     "xxhash,"
+    "xxh3,"
+    "encrypt,"
     "compress,"
     "uncompress,"
     "acquireload,"
@@ -162,6 +172,12 @@ DEFINE_string(
     "N threads doing random reads\n"
     "\treadrandomwriterandom -- N threads doing random-read, "
     "random-write\n"
+    "\tycsba,...,ycsbf -- the YCSB core workloads A to F, on --num records "
+    "loaded by fillseq with a --value_size of --ycsb_field_count * "
+    "--ycsb_field_length, reported as YCSB does\n"
+    "\topenloop      -- N threads issuing random reads, writes and scans "
+    "at a fixed arrival rate, latencies measured from when the operations "
+    "were due\n"
     "\tupdaterandom  -- N threads doing read-modify-write for random "
     "keys\n"
     "\txorupdaterandom  -- N threads doing read-XOR-write for "
@@ -182,11 +198,16 @@ DEFINE_string(
     "merge\n"
     "\tcrc32c        -- repeated crc32c of 4K of data\n"
     "\txxhash        -- repeated xxHash of 4K of data\n"
+    "\txxh3          -- repeated XXH3 of block_size bytes of data\n"
+    "\tencrypt       -- repeated encryption of block_size bytes of data, "
+    "as encrypted files do, with --encryption_cipher\n"
     "\tacquireload   -- load N*1000 times\n"
     "\tfillseekseq   -- write N values in sequential key, then read "
     "them by seeking to each key\n"
     "\trandomtransaction     -- execute N random transactions and "
     "verify correctness\n"
+    "\ttwophasecommit        -- two phase commit transactions of one key, "
+    "and reads at snapshots kept for the whole run, with --transaction_db\n"
     "\trandomreplacekeys     -- randomly replaces N keys by deleting "
     "the old version and putting the new version\n\n"
     "\ttimeseries            -- 1 writer generates time series data "
@@ -194,6 +215,7 @@ DEFINE_string(
     "Meta operations:\n"
     "\tcompact     -- Compact the entire DB; If multiple, randomly choose one\n"
     "\tcompactall  -- Compact the entire DB\n"
+    "\topen        -- Close and reopen the DB, timing DB::Open()\n"
     "\tstats       -- Print DB stats\n"
     "\tresetstats  -- Reset DB stats\n"
     "\tlevelstats  -- Print the number of files and bytes per level\n"
@@ -326,6 +348,14 @@ DEFINE_int64(db_write_buffer_size,
 DEFINE_bool(cost_write_buffer_to_cache, false,
             "The usage of memtable is costed to the block cache");
 
+DEFINE_int64(memory_budget, 0,
+             "If non-zero, a MemoryGovernor splits this many bytes between "
+             "the write buffers, starting at a quarter of it, and the block "
+             "cache, overriding --db_write_buffer_size and --cache_size");
+
+DEFINE_uint32(memory_governor_period_sec, 10,
+              "Seconds between the rebalances of --memory_budget");
+
 DEFINE_int64(write_buffer_size, ROCKSDB_NAMESPACE::Options().write_buffer_size,
              "Number of bytes to buffer in memtable before compacting");
 
@@ -390,6 +420,10 @@ DEFINE_int32(num_low_pri_threads, 0,
              "The maximum number of concurrent background compactions"
              " that can occur in parallel.");
 
+DEFINE_int32(num_user_pri_threads, 0,
+             "The number of threads in the user-priority thread pool (used "
+             "by MultiGet with -optimize_multiget_for_io).");
+
 DEFINE_int32(max_background_compactions,
              ROCKSDB_NAMESPACE::Options().max_background_compactions,
              "The maximum number of concurrent background compactions"
@@ -439,6 +473,14 @@ DEFINE_int32(universal_compression_size_percent, -1,
 DEFINE_bool(universal_allow_trivial_move, false,
             "Allow trivial move in universal compaction.");
 
+DEFINE_int32(universal_runs_per_tier, 0,
+             "If non-zero, the number of sorted runs per tier with which "
+             "universal compaction does lazy leveling.");
+
+DEFINE_bool(universal_incremental, false,
+            "Reduce the size amplification of universal compaction a key "
+            "range slice at a time.");
+
 DEFINE_int64(cache_size, 8 << 20,  // 8MB
              "Number of bytes to use as a cache of uncompressed data");
 
@@ -455,6 +497,10 @@ DEFINE_double(cache_high_pri_pool_ratio, 0.0,
 DEFINE_bool(use_clock_cache, false,
             "Replace default LRU block cache with clock cache.");
 
+DEFINE_bool(cache_tiny_lfu_admission, false,
+            "Guard the LRU block cache with a TinyLFU admission filter, so "
+            "that blocks read only once do not evict frequently used ones.");
+
 DEFINE_int64(simcache_size, -1,
              "Number of bytes to use as a simcache of "
              "uncompressed data. Nagative value disables simcache.");
@@ -465,6 +511,11 @@ DEFINE_bool(cache_index_and_filter_blocks, false,
 DEFINE_bool(use_cache_memkind_kmem_allocator, false,
             "Use memkind kmem allocator for block cache.");
 
+DEFINE_int64(slow_memory_cache_size, 0,
+             "Bytes of a secondary cache below the block cache allocated with"
+             " the memkind kmem allocator, which the blocks evicted from the"
+             " block cache spill to (0 = disabled).");
+
 DEFINE_bool(partition_index_and_filters, false,
             "Partition index and filter blocks.");
 
@@ -472,11 +523,20 @@ DEFINE_bool(partition_index, false, "Partition index blocks");
 
 DEFINE_bool(index_with_first_key, false, "Include first key in the index");
 
+DEFINE_bool(use_trie_index, false,
+            "Use the succinct trie index (kSuccinctTrieSearch)");
+
 DEFINE_bool(
     optimize_filters_for_memory,
     ROCKSDB_NAMESPACE::BlockBasedTableOptions().optimize_filters_for_memory,
     "Minimize memory footprint of filters");
 
+DEFINE_bool(serve_data_blocks_from_mmap,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .serve_data_blocks_from_mmap,
+            "With --mmap_read and no compression, read data blocks in place "
+            "from the mapped files instead of through the block cache");
+
 DEFINE_int64(
     index_shortening_mode, 2,
     "mode to shorten index: 0 for no shortening; 1 for only shortening "
@@ -542,6 +602,10 @@ DEFINE_double(data_block_hash_table_util_ratio, 0.75,
               "This is only valid if use_data_block_hash_index is "
               "set to true");
 
+DEFINE_bool(data_block_restart_key_prefixes, false,
+            "Store the first bytes of each restart key in data blocks to "
+            "speed up seeks within a block");
+
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
@@ -549,6 +613,31 @@ DEFINE_int64(row_cache_size, 0,
              "Number of bytes to use as a cache of individual rows"
              " (0 = disabled).");
 
+DEFINE_bool(row_cache_negative_entries,
+            ROCKSDB_NAMESPACE::Options().row_cache_negative_entries,
+            "Also keep the lookups of keys absent from a table file in the"
+            " row cache");
+
+DEFINE_int32(immutable_memtable_numa_node,
+             ROCKSDB_NAMESPACE::Options().immutable_memtable_numa_node,
+             "NUMA node the memtables are migrated to when they become"
+             " immutable (-1 = disabled).");
+
+DEFINE_uint32(options_advisor_period_sec,
+              ROCKSDB_NAMESPACE::Options().options_advisor_period_sec,
+              "Seconds between the samples of the online options advisor"
+              " (0 = disabled).");
+
+DEFINE_bool(options_advisor_apply_changes,
+            ROCKSDB_NAMESPACE::Options().options_advisor_apply_changes,
+            "Apply the changes of the options advisor instead of only"
+            " logging them.");
+
+DEFINE_double(options_advisor_max_change_factor,
+              ROCKSDB_NAMESPACE::Options().options_advisor_max_change_factor,
+              "Factor the options advisor keeps the options within of their"
+              " initial values.");
+
 DEFINE_int32(open_files, ROCKSDB_NAMESPACE::Options().max_open_files,
              "Maximum number of files to keep open at the same time"
              " (use default if == 0)");
@@ -558,6 +647,11 @@ DEFINE_int32(file_opening_threads,
              "If open_files is set to -1, this option set the number of "
              "threads that will be used to open files during DB::Open()");
 
+DEFINE_bool(lazy_open_table_files,
+            ROCKSDB_NAMESPACE::Options().lazy_open_table_files,
+            "Open the table files on their first access and in the background "
+            "instead of in DB::Open()");
+
 DEFINE_bool(new_table_reader_for_compaction_inputs, true,
              "If true, uses a separate file handle for compaction inputs");
 
@@ -573,6 +667,13 @@ DEFINE_int32(writable_file_max_buffer_size, 1024 * 1024,
 
 DEFINE_int32(bloom_bits, -1, "Bloom filter bits per key. Negative means"
              " use default settings.");
+DEFINE_bool(use_ribbon_filter, false,
+            "Use a Ribbon filter with the FP rate of a Bloom filter with "
+            "-bloom_bits bits per key, instead of the Bloom filter");
+DEFINE_bool(reserve_table_builder_memory,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .reserve_table_builder_memory,
+            "Charge temporary filter construction memory to the block cache");
 DEFINE_double(memtable_bloom_size_ratio, 0,
               "Ratio of memtable size used for bloom filter. 0 means no bloom "
               "filter.");
@@ -630,9 +731,15 @@ DEFINE_bool(verify_checksum, true,
             " from storage");
 
 DEFINE_bool(statistics, false, "Database statistics");
+DEFINE_int32(statistics_hdr_precision_bits, 0,
+             "If non-zero, --statistics histograms have HDR-style buckets "
+             "with this many bits of precision.");
 DEFINE_int32(stats_level, ROCKSDB_NAMESPACE::StatsLevel::kExceptDetailedTimers,
              "stats level for statistics");
 DEFINE_string(statistics_string, "", "Serialized statistics string");
+DEFINE_int32(lock_profiling_sample_one_in, 0,
+             "If non-zero, profile the lock contention on one in this many "
+             "lock acquisitions and print it at the end.");
 static class std::shared_ptr<ROCKSDB_NAMESPACE::Statistics> dbstats;
 
 DEFINE_int64(writes, -1, "Number of write operations to do. If negative, do"
@@ -668,6 +775,16 @@ DEFINE_uint64(max_bytes_for_level_base,
 DEFINE_bool(level_compaction_dynamic_level_bytes, false,
             "Whether level size base is dynamic");
 
+DEFINE_uint64(zone_aware_compaction_window,
+              ROCKSDB_NAMESPACE::Options().zone_aware_compaction_window,
+              "Number of leveled compaction candidates compared by the zone "
+              "space they free, 0 to disable");
+
+DEFINE_int32(zone_capacity_partitioner_reserve_pct, -1,
+             "Split compaction outputs at the remaining capacity of their "
+             "zone, keeping this percent of a zone for the SST metadata. "
+             "Negative disables it");
+
 DEFINE_double(max_bytes_for_level_multiplier, 10,
               "A multiplier to compute max bytes for level-N (N >= 2)");
 
@@ -708,6 +825,44 @@ DEFINE_int32(readwritepercent, 90, "Ratio of reads to reads/writes (expressed"
              "default value 90 means 90% operations out of all reads and writes"
              " operations are reads. In other words, 9 gets for every 1 put.");
 
+DEFINE_int64(open_loop_ops_per_sec, 1000,
+             "Operations per second the openloop benchmark issues over all "
+             "its threads, whether or not the previous ones are done. The "
+             "latencies, see --histogram, are measured from when the "
+             "operations were due, so they include the time queued behind "
+             "slow operations.");
+
+DEFINE_string(open_loop_arrivals, "poisson",
+              "Arrivals of the openloop benchmark: poisson, for exponential "
+              "gaps between the operations of a thread, or fixed, for even "
+              "gaps.");
+
+DEFINE_int32(open_loop_read_percent, 80,
+             "Percentage of the operations of the openloop benchmark that "
+             "are point reads");
+
+DEFINE_int32(open_loop_scan_percent, 0,
+             "Percentage of the operations of the openloop benchmark that "
+             "are scans of --seek_nexts entries. The rest are writes.");
+
+DEFINE_string(ycsb_request_distribution, "",
+              "Keys of the ycsb benchmarks: uniform, zipfian, "
+              "scrambled_zipfian or latest. Empty for the one of the YCSB "
+              "workload, latest for D and scrambled_zipfian for the others.");
+
+DEFINE_double(ycsb_zipfian_constant, 0.99,
+              "Skew of the zipfian key distributions of the ycsb benchmarks");
+
+DEFINE_int32(ycsb_field_count, 10,
+             "Fields of the records of the ycsb benchmarks. An update "
+             "rewrites one of them.");
+
+DEFINE_int32(ycsb_field_length, 100,
+             "Bytes of each field of the records of the ycsb benchmarks");
+
+DEFINE_int32(ycsb_max_scan_length, 100,
+             "Most records a scan of ycsbe reads, the lengths being uniform");
+
 DEFINE_int32(mergereadpercent, 70, "Ratio of merges to merges&reads (expressed"
              " as percentage) for the ReadRandomMergeRandom workload. The"
              " default value 70 means 70% out of all read and merge operations"
@@ -767,6 +922,21 @@ DEFINE_int32(transaction_sleep, 0,
 DEFINE_uint64(transaction_lock_timeout, 100,
               "If using a transaction_db, specifies the lock wait timeout in"
               " milliseconds before failing a transaction waiting on a lock");
+
+DEFINE_int32(txn_write_policy, 0,
+             "If using a transaction_db, the TxnDBWritePolicy: 0 for "
+             "WRITE_COMMITTED, 1 for WRITE_PREPARED and 2 for "
+             "WRITE_UNPREPARED");
+
+DEFINE_int32(twopc_old_snapshots, 4,
+             "Snapshots each thread of twophasecommit takes at the start and "
+             "reads at until the end");
+
+DEFINE_bool(transaction_per_key_lock_wait_queues, false,
+            "If using a transaction_db, sets "
+            "TransactionDBOptions::per_key_lock_wait_queues. Run "
+            "randomtransaction with many threads and a small --num for "
+            "contention on a few hot keys.");
 DEFINE_string(
     options_file, "",
     "The path to a RocksDB options file.  If specified, then db_bench will "
@@ -791,6 +961,10 @@ DEFINE_uint64(fifo_compaction_max_table_files_size_mb, 0,
 DEFINE_bool(fifo_compaction_allow_compaction, true,
             "Allow compaction in FIFO compaction.");
 
+DEFINE_uint64(fifo_compaction_zone_time_bucket_seconds, 0,
+              "Write FIFO files created within this many seconds to zones "
+              "of their own, 0 to disable");
+
 DEFINE_uint64(fifo_compaction_ttl, 0, "TTL for the SST Files in seconds.");
 
 // Blob DB Options
@@ -842,6 +1016,60 @@ DEFINE_string(blob_db_compression_type, "snappy",
 static enum ROCKSDB_NAMESPACE::CompressionType
     FLAGS_blob_db_compression_type_e = ROCKSDB_NAMESPACE::kSnappyCompression;
 
+// Integrated BlobDB Options
+DEFINE_bool(
+    enable_blob_files,
+    ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions().enable_blob_files,
+    "Enable writing large values to separate blob files.");
+
+DEFINE_uint64(min_blob_size,
+              ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions().min_blob_size,
+              "The size of the smallest value to be stored separately in a "
+              "blob file.");
+
+DEFINE_int32(blob_file_starting_level,
+             ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
+                 .blob_file_starting_level,
+             "The level from which on large values are stored in blob "
+             "files.");
+
+DEFINE_uint64(blob_file_size,
+              ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions().blob_file_size,
+              "The size limit for blob files.");
+
+DEFINE_string(blob_compression_type, "none",
+              "The compression algorithm to use for large values stored in "
+              "blob files.");
+static enum ROCKSDB_NAMESPACE::CompressionType
+    FLAGS_blob_compression_type_e = ROCKSDB_NAMESPACE::kNoCompression;
+
+DEFINE_bool(enable_blob_garbage_collection,
+            ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
+                .enable_blob_garbage_collection,
+            "Enable blob garbage collection during compaction. The bytes "
+            "relocated are reported by --statistics as "
+            "rocksdb.blobdb.gc.bytes.relocated.");
+
+DEFINE_double(blob_garbage_collection_age_cutoff,
+              ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
+                  .blob_garbage_collection_age_cutoff,
+              "The fraction of the oldest blob files whose blobs are "
+              "relocated by compactions when blob garbage collection is "
+              "enabled.");
+
+DEFINE_int64(blob_cache_size, 0,
+             "Number of bytes to use as a cache of uncompressed blob values, "
+             "0 to disable. Ignored with -use_shared_block_and_blob_cache.");
+
+DEFINE_bool(use_shared_block_and_blob_cache, false,
+            "Cache blob values in the block cache, so both share "
+            "-cache_size.");
+
+DEFINE_bool(prepopulate_blob_cache,
+            ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
+                .prepopulate_blob_cache,
+            "Add the blobs written by flushes to the blob cache.");
+
 // Secondary DB instance Options
 DEFINE_bool(use_secondary_db, false,
             "Open a RocksDB secondary instance. A primary instance can be "
@@ -879,6 +1107,10 @@ DEFINE_int64(
 DEFINE_string(block_cache_trace_file, "", "Block cache trace file path.");
 DEFINE_int32(trace_replay_threads, 1,
              "The number of threads to replay, must >=1.");
+DEFINE_bool(trace_replay_sharded, false,
+            "Replay the queries of each key in trace order, sharded by key "
+            "over trace_replay_threads threads that keep to the times of the "
+            "trace each, and report the latencies of the queries.");
 
 static enum ROCKSDB_NAMESPACE::CompressionType StringToCompressionType(
     const char* ctype) {
@@ -915,6 +1147,29 @@ static std::string ColumnFamilyName(size_t i) {
   }
 }
 
+static enum ROCKSDB_NAMESPACE::ChecksumType StringToChecksumType(
+    const char* ctype) {
+  assert(ctype);
+
+  if (!strcasecmp(ctype, "none"))
+    return ROCKSDB_NAMESPACE::kNoChecksum;
+  else if (!strcasecmp(ctype, "crc32c"))
+    return ROCKSDB_NAMESPACE::kCRC32c;
+  else if (!strcasecmp(ctype, "xxhash"))
+    return ROCKSDB_NAMESPACE::kxxHash;
+  else if (!strcasecmp(ctype, "xxhash64"))
+    return ROCKSDB_NAMESPACE::kxxHash64;
+  else if (!strcasecmp(ctype, "xxh3"))
+    return ROCKSDB_NAMESPACE::kXXH3;
+
+  fprintf(stdout, "Cannot parse checksum type '%s'\n", ctype);
+  return ROCKSDB_NAMESPACE::kCRC32c;  // default value
+}
+
+DEFINE_string(checksum_type, "crc32c",
+              "Algorithm to checksum blocks of SST files with: none, crc32c, "
+              "xxhash, xxhash64 or xxh3");
+
 DEFINE_string(compression_type, "snappy",
               "Algorithm to use to compress the database");
 static enum ROCKSDB_NAMESPACE::CompressionType FLAGS_compression_type_e =
@@ -922,6 +1177,11 @@ static enum ROCKSDB_NAMESPACE::CompressionType FLAGS_compression_type_e =
 
 DEFINE_int64(sample_for_compression, 0, "Sample every N block for compression");
 
+DEFINE_uint32(max_flush_partitions,
+              ROCKSDB_NAMESPACE::Options().max_flush_partitions,
+              "The most SST files a flush writes in parallel, splitting the "
+              "key space of the memtables into ranges");
+
 DEFINE_int32(compression_level, ROCKSDB_NAMESPACE::CompressionOptions().level,
              "Compression level. The meaning of this value is library-"
              "dependent. If unset, we try to use the default for the library "
@@ -937,6 +1197,12 @@ DEFINE_int32(compression_zstd_max_train_bytes,
              "Maximum size of training data passed to zstd's dictionary "
              "trainer.");
 
+DEFINE_uint64(compression_shared_dict_retrain_bytes,
+              ROCKSDB_NAMESPACE::CompressionOptions().shared_dict_retrain_bytes,
+              "If nonzero, share the compression dictionary across the SST "
+              "files and train it again after this many bytes of data "
+              "blocks.");
+
 DEFINE_int32(min_level_to_compress, -1, "If non-negative, compression starts"
              " from this level. Levels with number < min_level_to_compress are"
              " not compressed. Otherwise, apply compression_type to "
@@ -964,6 +1230,24 @@ DEFINE_string(fs_uri, "",
               "URI for registry Filesystem lookup. Mutually exclusive"
               " with --hdfs and --env_uri."
               " Creates a default environment with the specified filesystem.");
+DEFINE_string(fast_tier_path, "",
+              "With --fs_uri, keep the WAL, the metadata files and the table"
+              " files of the levels up to --fast_tier_max_level under this"
+              " directory of the default filesystem, and the other files on"
+              " the --fs_uri filesystem. Empty for a single filesystem.");
+DEFINE_int32(fast_tier_max_level, 1,
+             "Deepest level whose table files go to --fast_tier_path");
+DEFINE_double(hedged_read_percentile, 0.0,
+              "With --fs_uri, issue a random read of a table file a second"
+              " time when it takes longer than this percentile of the read"
+              " latencies, and take the first to complete. 0 to disable.");
+DEFINE_uint64(hedged_read_max_delay_us, 100000,
+              "Upper bound of the delay before a read is hedged");
+DEFINE_string(encryption_cipher,
+              "AES:000102030405060708090A0B0C0D0E0F"
+              "101112131415161718191A1B1C1D1E1F",
+              "Block cipher of the CTR encryption of the encrypt benchmark,"
+              " e.g. AES:<hex key> or ROT13");
 #endif  // ROCKSDB_LITE
 DEFINE_string(hdfs, "",
               "Name of hdfs environment. Mutually exclusive with"
@@ -990,6 +1274,28 @@ DEFINE_string(report_file, "report.csv",
               "Filename where some simple stats are reported to (if "
               "--report_interval_seconds is bigger than 0)");
 
+DEFINE_string(json_report_file, "",
+              "If not empty, a JSON object is appended to this file, one "
+              "per line, for each run of a benchmark, but the warm up runs. "
+              "It has the throughput, the latency percentiles of the "
+              "operations, the changes of the statistics tickers and, with "
+              "--report_zenfs_stats, of the ZenFS counters, and with "
+              "--perf_level of 2 or more, the sums of the perf context "
+              "counters of the threads.");
+
+DEFINE_bool(report_zenfs_stats, false,
+            "Adds to the --report_file lines the user bytes written, the "
+            "bytes written to the zoned device, their ratio, the bytes "
+            "copied by zone cleaning, the zone resets and the zones placed "
+            "by each rule in the interval. Enables statistics for the user "
+            "bytes. Needs a zoned --fs_uri.");
+
+DEFINE_double(write_zipf_theta, 0.0,
+              "If in (0, 1), the random write benchmarks, e.g. fillrandom "
+              "and overwrite, draw their keys from a zipfian distribution of "
+              "this skew, with the hot keys spread over the key space. 0 "
+              "for uniform keys.");
+
 DEFINE_int32(thread_status_per_interval, 0,
              "Takes and report a snapshot of the current status of each thread"
              " when this is greater than 0.");
@@ -1025,6 +1331,22 @@ DEFINE_uint64(soft_pending_compaction_bytes_limit, 64ull * 1024 * 1024 * 1024,
 DEFINE_uint64(hard_pending_compaction_bytes_limit, 128ull * 1024 * 1024 * 1024,
               "Stop writes if pending compaction bytes exceed this number");
 
+DEFINE_bool(smooth_write_stall,
+            ROCKSDB_NAMESPACE::Options().smooth_write_stall,
+            "Slow down writes gradually before a slowdown trigger is hit");
+
+DEFINE_int32(smooth_write_stall_target_l0_files,
+             ROCKSDB_NAMESPACE::Options().smooth_write_stall_target_l0_files,
+             "L0 file count -smooth_write_stall steers towards, 0 for the "
+             "default");
+
+DEFINE_uint64(
+    smooth_write_stall_target_pending_compaction_bytes,
+    ROCKSDB_NAMESPACE::Options()
+        .smooth_write_stall_target_pending_compaction_bytes,
+    "Pending compaction bytes -smooth_write_stall steers towards, 0 for the "
+    "default");
+
 DEFINE_uint64(delayed_write_rate, 8388608u,
               "Limited bytes allowed to DB when soft_rate_limit or "
               "level0_slowdown_writes_trigger triggers");
@@ -1032,6 +1354,13 @@ DEFINE_uint64(delayed_write_rate, 8388608u,
 DEFINE_bool(enable_pipelined_write, true,
             "Allow WAL and memtable writes to be pipelined");
 
+DEFINE_bool(enable_pipelined_compaction,
+            ROCKSDB_NAMESPACE::Options().enable_pipelined_compaction,
+            "Overlap reading, merging and writing within each compaction");
+
+DEFINE_uint64(wal_streams, ROCKSDB_NAMESPACE::Options().wal_streams,
+              "Number of WAL files pipelined writes append to concurrently");
+
 DEFINE_bool(
     unordered_write, false,
     "Enable the unordered write feature, which provides higher throughput but "
@@ -1194,6 +1523,10 @@ DEFINE_bool(use_direct_io_for_flush_and_compaction,
             ROCKSDB_NAMESPACE::Options().use_direct_io_for_flush_and_compaction,
             "Use O_DIRECT for background flush and compaction writes");
 
+DEFINE_bool(async_table_file_flush,
+            ROCKSDB_NAMESPACE::Options().async_table_file_flush,
+            "Write the flush and compaction output buffers asynchronously");
+
 DEFINE_bool(advise_random_on_open,
             ROCKSDB_NAMESPACE::Options().advise_random_on_open,
             "Advise random access on table file open");
@@ -1248,6 +1581,10 @@ DEFINE_int32(num_deletion_threads, 1,
 DEFINE_int32(max_successive_merges, 0, "Maximum number of successive merge"
              " operations on a key in the memtable");
 
+DEFINE_bool(preaggregate_merge_operands, false,
+            "Combine a merge operand with the latest one of the key in the "
+            "memtable in place. Requires --inplace_update_support.");
+
 static bool ValidatePrefixSize(const char* flagname, int32_t value) {
   if (value < 0 || value>=2000000000) {
     fprintf(stderr, "Invalid value for --%s: %d. 0<= PrefixSize <=2000000000\n",
@@ -1302,6 +1639,7 @@ enum RepFactory {
   kPrefixHash,
   kVectorRep,
   kHashLinkedList,
+  kBTreeRep,
 };
 
 static enum RepFactory StringToRepFactory(const char* ctype) {
@@ -1315,6 +1653,8 @@ static enum RepFactory StringToRepFactory(const char* ctype) {
     return kVectorRep;
   else if (!strcasecmp(ctype, "hash_linkedlist"))
     return kHashLinkedList;
+  else if (!strcasecmp(ctype, "btree"))
+    return kBTreeRep;
 
   fprintf(stdout, "Cannot parse memreptable %s\n", ctype);
   return kSkipList;
@@ -1340,10 +1680,26 @@ DEFINE_string(merge_operator, "", "The merge operator to use with the database."
 DEFINE_int32(skip_list_lookahead, 0, "Used with skip_list memtablerep; try "
              "linear search first for this many steps from the previous "
              "position");
+DEFINE_int32(iter_next_batch_size, 0,
+             "If positive, readseq reads the entries this many at a time "
+             "with Iterator::NextBatch()");
+DEFINE_int32(skip_list_prefix_index_buckets, 0,
+             "Used with skip_list memtablerep and a prefix extractor; "
+             "index the first key of each prefix in a hash table of this "
+             "many buckets, for prefix seeks");
 DEFINE_bool(report_file_operations, false, "if report number of file "
             "operations");
 DEFINE_int32(readahead_size, 0, "Iterator readahead size");
 
+DEFINE_bool(async_io, false,
+            "Set ReadOptions::async_io for the iterators of readseq and "
+            "seekrandom, reading ahead in the background.");
+
+DEFINE_bool(optimize_multiget_for_io, false,
+            "Set ReadOptions::optimize_multiget_for_io for multireadrandom, "
+            "looking up the SST files of a level in parallel. Needs "
+            "-num_user_pri_threads > 0.");
+
 DEFINE_bool(read_with_latest_user_timestamp, true,
             "If true, always use the current latest timestamp for read. If "
             "false, choose a random timestamp from the past.");
@@ -1605,6 +1961,73 @@ class UniformDistribution
   std::mt19937 gen_;
 };
 
+// Draws integers in [0, n) with the zipfian distribution of skew theta. If
+// scrambled, as the scrambled zipfian generator of YCSB, the ranks are
+// hashed, so the hot integers are spread over the range rather than at its
+// start.
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(uint64_t n, double theta, bool scrambled = true)
+      : n_(n),
+        theta_(theta),
+        scrambled_(scrambled),
+        alpha_(1.0 / (1.0 - theta)),
+        zetan_(Zeta(n, theta)),
+        eta_((1.0 - std::pow(2.0 / n, 1.0 - theta)) /
+             (1.0 - Zeta(2, theta) / zetan_)) {}
+
+  uint64_t Next(Random64* rand) const {
+    double u = static_cast<double>(rand->Next() >> 11) /
+               static_cast<double>(uint64_t{1} << 53);
+    double uz = u * zetan_;
+    uint64_t rank;
+    if (uz < 1.0) {
+      rank = 0;
+    } else if (uz < 1.0 + std::pow(0.5, theta_)) {
+      rank = 1;
+    } else {
+      rank = static_cast<uint64_t>(
+          n_ * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+    }
+    rank = std::min(rank, n_ - 1);
+    return scrambled_ ? Scramble(rank) % n_ : rank;
+  }
+
+ private:
+  // The sum of 1 / i^theta for i in [1, n], the terms past the first
+  // million approximated by an integral
+  static double Zeta(uint64_t n, double theta) {
+    const uint64_t kExactTerms = uint64_t{1} << 20;
+    double sum = 0;
+    for (uint64_t i = 1; i <= std::min(n, kExactTerms); i++) {
+      sum += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    if (n > kExactTerms) {
+      sum += (std::pow(n + 0.5, 1.0 - theta) -
+              std::pow(kExactTerms + 0.5, 1.0 - theta)) /
+             (1.0 - theta);
+    }
+    return sum;
+  }
+
+  // The finalizer of MurmurHash3
+  static uint64_t Scramble(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+
+  const uint64_t n_;
+  const double theta_;
+  const bool scrambled_;
+  const double alpha_;
+  const double zetan_;
+  const double eta_;
+};
+
 // Helper for quickly generating random data.
 class RandomGenerator {
  private:
@@ -1764,14 +2187,67 @@ struct DBWithColumnFamilies {
 };
 
 // a class that reports stats to CSV file
+// The counters of the zoned file system reported by interval, after the
+// bytes written
+static const char* const kZenFSCounters[] = {
+    "gc-bytes-copied",       "zone-resets",          "placement-overlap",
+    "placement-l0",          "placement-same-level", "placement-lifetime",
+    "placement-empty",       "placement-time-bucket",
+    "placement-predicted"};
+
+static uint64_t GetZenFSCounter(DB* db, const std::string& name) {
+  std::string value;
+  uint64_t counter = 0;
+  if (db->GetProperty(DB::Properties::kZenFSPrefix + name, &value)) {
+    counter = ParseUint64(value);
+  }
+  return counter;
+}
+
+// The perf context counters of the JSON reports
+static const std::pair<const char*, uint64_t PerfContext::*>
+    kPerfContextCounters[] = {
+        {"user_key_comparison_count", &PerfContext::user_key_comparison_count},
+        {"block_cache_hit_count", &PerfContext::block_cache_hit_count},
+        {"block_read_count", &PerfContext::block_read_count},
+        {"block_read_byte", &PerfContext::block_read_byte},
+        {"block_read_time", &PerfContext::block_read_time},
+        {"block_checksum_time", &PerfContext::block_checksum_time},
+        {"block_decompress_time", &PerfContext::block_decompress_time},
+        {"internal_key_skipped_count",
+         &PerfContext::internal_key_skipped_count},
+        {"internal_delete_skipped_count",
+         &PerfContext::internal_delete_skipped_count},
+        {"get_from_memtable_time", &PerfContext::get_from_memtable_time},
+        {"get_from_output_files_time",
+         &PerfContext::get_from_output_files_time},
+        {"seek_on_memtable_time", &PerfContext::seek_on_memtable_time},
+        {"seek_internal_seek_time", &PerfContext::seek_internal_seek_time},
+        {"find_next_user_entry_time", &PerfContext::find_next_user_entry_time},
+        {"write_wal_time", &PerfContext::write_wal_time},
+        {"write_memtable_time", &PerfContext::write_memtable_time},
+        {"write_delay_time", &PerfContext::write_delay_time},
+        {"write_thread_wait_nanos", &PerfContext::write_thread_wait_nanos},
+        {"db_mutex_lock_nanos", &PerfContext::db_mutex_lock_nanos},
+        {"db_condition_wait_nanos", &PerfContext::db_condition_wait_nanos},
+        {"find_table_nanos", &PerfContext::find_table_nanos},
+        {"bloom_sst_hit_count", &PerfContext::bloom_sst_hit_count},
+        {"bloom_sst_miss_count", &PerfContext::bloom_sst_miss_count}};
+
 class ReporterAgent {
  public:
+  // If zenfs_db is not nullptr, the report has the write amplification of
+  // its zoned file system too, the user bytes being the BYTES_WRITTEN of
+  // stats
   ReporterAgent(Env* env, const std::string& fname,
-                uint64_t report_interval_secs)
+                uint64_t report_interval_secs, DB* zenfs_db = nullptr,
+                Statistics* stats = nullptr)
       : env_(env),
         total_ops_done_(0),
         last_report_(0),
         report_interval_secs_(report_interval_secs),
+        zenfs_db_(zenfs_db),
+        stats_(stats),
         stop_(false) {
     auto s = env_->NewWritableFile(fname, &report_file_, EnvOptions());
     if (s.ok()) {
@@ -1804,9 +2280,46 @@ class ReporterAgent {
   }
 
  private:
-  std::string Header() const { return "secs_elapsed,interval_qps"; }
+  std::string Header() const {
+    std::string header = "secs_elapsed,interval_qps";
+    if (zenfs_db_ != nullptr) {
+      header += ",user_bytes,device_bytes,write_amp,total_write_amp";
+      for (const char* name : kZenFSCounters) {
+        header += std::string(",") + name;
+      }
+    }
+    return header;
+  }
+
+
+  // Appends the columns of the zoned file system, as deltas from *last
+  void ReportZenFS(std::vector<uint64_t>* last, std::string* report) const {
+    std::vector<uint64_t> now;
+    now.push_back(stats_ ? stats_->getTickerCount(BYTES_WRITTEN) : 0);
+    now.push_back(GetZenFSCounter(zenfs_db_, "bytes-written"));
+    for (const char* name : kZenFSCounters) {
+      now.push_back(GetZenFSCounter(zenfs_db_, name));
+    }
+    if (last->empty()) {
+      last->assign(now.size(), 0);
+    }
+    uint64_t user_bytes = now[0] - (*last)[0];
+    uint64_t device_bytes = now[1] - (*last)[1];
+    char buf[64];
+    snprintf(buf, sizeof(buf), ",%" PRIu64 ",%" PRIu64 ",%.3f,%.3f",
+             user_bytes, device_bytes,
+             user_bytes ? static_cast<double>(device_bytes) / user_bytes : 0.0,
+             now[0] ? static_cast<double>(now[1]) / now[0] : 0.0);
+    report->append(buf);
+    for (size_t i = 2; i < now.size(); i++) {
+      report->append("," + ToString(now[i] - (*last)[i]));
+    }
+    *last = now;
+  }
+
   void SleepAndReport() {
     auto time_started = env_->NowMicros();
+    std::vector<uint64_t> last_zenfs;
     while (true) {
       {
         std::unique_lock<std::mutex> lk(mutex_);
@@ -1824,8 +2337,11 @@ class ReporterAgent {
           (env_->NowMicros() - time_started + kMicrosInSecond / 2) /
           kMicrosInSecond;
       std::string report = ToString(secs_elapsed) + "," +
-                           ToString(total_ops_done_snapshot - last_report_) +
-                           "\n";
+                           ToString(total_ops_done_snapshot - last_report_);
+      if (zenfs_db_ != nullptr) {
+        ReportZenFS(&last_zenfs, &report);
+      }
+      report += "\n";
       auto s = report_file_->Append(report);
       if (s.ok()) {
         s = report_file_->Flush();
@@ -1845,6 +2361,8 @@ class ReporterAgent {
   std::atomic<int64_t> total_ops_done_;
   int64_t last_report_;
   const uint64_t report_interval_secs_;
+  DB* const zenfs_db_;
+  Statistics* const stats_;
   ROCKSDB_NAMESPACE::port::Thread reporting_thread_;
   std::mutex mutex_;
   // will notify on stop
@@ -1863,6 +2381,8 @@ enum OperationType : unsigned char {
   kUncompress,
   kCrc,
   kHash,
+  kReadModifyWrite,
+  kEncrypt,
   kOthers
 };
 
@@ -1878,9 +2398,19 @@ static std::unordered_map<OperationType, std::string, std::hash<unsigned char>>
   {kCompress, "uncompress"},
   {kCrc, "crc"},
   {kHash, "hash"},
+  {kReadModifyWrite, "readmodifywrite"},
+  {kEncrypt, "encrypt"},
   {kOthers, "op"}
 };
 
+// The names of the operations in the reports of the ycsb benchmarks
+static const std::vector<std::pair<OperationType, const char*>>
+    YCSBOperationNames = {{kRead, "READ"},
+                          {kUpdate, "UPDATE"},
+                          {kWrite, "INSERT"},
+                          {kSeek, "SCAN"},
+                          {kReadModifyWrite, "READ-MODIFY-WRITE"}};
+
 class CombinedStats;
 class Stats {
  private:
@@ -1899,6 +2429,10 @@ class Stats {
                      std::hash<unsigned char>> hist_;
   std::string message_;
   bool exclude_from_merge_;
+  // Latencies are recorded without --histogram, and reported as YCSB does
+  bool ycsb_;
+  // Sums of kPerfContextCounters of the threads
+  std::vector<uint64_t> perf_counters_;
   ReporterAgent* reporter_agent_;  // does not own
   friend class CombinedStats;
 
@@ -1925,6 +2459,8 @@ class Stats {
     message_.clear();
     // When set, stats from this thread won't be merged with others.
     exclude_from_merge_ = false;
+    ycsb_ = false;
+    perf_counters_.clear();
   }
 
   void Merge(const Stats& other) {
@@ -1943,6 +2479,13 @@ class Stats {
     done_ += other.done_;
     bytes_ += other.bytes_;
     seconds_ += other.seconds_;
+    ycsb_ = ycsb_ || other.ycsb_;
+    if (perf_counters_.size() < other.perf_counters_.size()) {
+      perf_counters_.resize(other.perf_counters_.size(), 0);
+    }
+    for (size_t i = 0; i < other.perf_counters_.size(); i++) {
+      perf_counters_[i] += other.perf_counters_[i];
+    }
     if (other.start_ < start_) start_ = other.start_;
     if (other.finish_ > finish_) finish_ = other.finish_;
 
@@ -1962,6 +2505,16 @@ class Stats {
   void SetId(int id) { id_ = id; }
   void SetExcludeFromMerge() { exclude_from_merge_ = true; }
 
+  // Adds the perf context of the thread, when it is done, to the JSON report
+  void AddPerfContext(const PerfContext& perf) {
+    perf_counters_.resize(sizeof(kPerfContextCounters) /
+                              sizeof(kPerfContextCounters[0]),
+                          0);
+    for (size_t i = 0; i < perf_counters_.size(); i++) {
+      perf_counters_[i] += perf.*kPerfContextCounters[i].second;
+    }
+  }
+
   void PrintThreadStatus() {
     std::vector<ThreadStatus> thread_list;
     FLAGS_env->GetThreadList(&thread_list);
@@ -2009,12 +2562,22 @@ class Stats {
     last_op_finish_ = FLAGS_env->NowMicros();
   }
 
+  // The latency of the next operation is measured from micros, e.g. when
+  // it was due, rather than from the end of the previous one
+  void SetOpStartTime(uint64_t micros) {
+    last_op_finish_ = micros;
+  }
+
+  void EnableYCSBReport() {
+    ycsb_ = true;
+  }
+
   void FinishedOps(DBWithColumnFamilies* db_with_cfh, DB* db, int64_t num_ops,
                    enum OperationType op_type = kOthers) {
     if (reporter_agent_) {
       reporter_agent_->ReportFinishedOps(num_ops);
     }
-    if (FLAGS_histogram) {
+    if (FLAGS_histogram || ycsb_ || !FLAGS_json_report_file.empty()) {
       uint64_t now = FLAGS_env->NowMicros();
       uint64_t micros = now - last_op_finish_;
 
@@ -2127,6 +2690,66 @@ class Stats {
     bytes_ += n;
   }
 
+  // Writes the throughput, the latencies of the operations and the perf
+  // context counters as fields of the object of *json
+  void ReportJSON(JSONWriter* json) const {
+    uint64_t done = std::max<uint64_t>(done_, 1);
+    double elapsed = (finish_ - start_) * 1e-6;
+    *json << "ops" << done_ << "elapsed_seconds" << elapsed << "ops_per_sec"
+          << done / elapsed << "micros_per_op" << seconds_ * 1e6 / done
+          << "mb_per_sec" << (bytes_ / 1048576.0) / elapsed;
+
+    json->AddKey("latency_micros");
+    json->StartObject();
+    for (const auto& it : hist_) {
+      const HistogramImpl& hist = *it.second;
+      json->AddKey(OperationTypeString[it.first]);
+      json->StartObject();
+      *json << "count" << hist.num() << "average" << hist.Average() << "min"
+            << hist.min() << "p50" << hist.Median() << "p95"
+            << hist.Percentile(95) << "p99" << hist.Percentile(99) << "p99.9"
+            << hist.Percentile(99.9) << "max" << hist.max();
+      json->EndObject();
+    }
+    json->EndObject();
+
+    if (!perf_counters_.empty()) {
+      json->AddKey("perf_context");
+      json->StartObject();
+      for (size_t i = 0; i < perf_counters_.size(); i++) {
+        *json << kPerfContextCounters[i].first << perf_counters_[i];
+      }
+      json->EndObject();
+    }
+  }
+
+  // Prints the run time, the throughput and the latencies of the operations
+  // in the format of the YCSB client, to compare with its results
+  void ReportYCSB() {
+    double elapsed = (finish_ - start_) * 1e-6;
+    fprintf(stdout, "[OVERALL], RunTime(ms), %" PRIu64 "\n",
+            (finish_ - start_) / 1000);
+    fprintf(stdout, "[OVERALL], Throughput(ops/sec), %.1f\n",
+            elapsed > 0 ? done_ / elapsed : 0.0);
+    for (const auto& op : YCSBOperationNames) {
+      auto it = hist_.find(op.first);
+      if (it == hist_.end()) {
+        continue;
+      }
+      HistogramData data;
+      it->second->Data(&data);
+      const char* name = op.second;
+      fprintf(stdout, "[%s], Operations, %" PRIu64 "\n", name, data.count);
+      fprintf(stdout, "[%s], AverageLatency(us), %.3f\n", name, data.average);
+      fprintf(stdout, "[%s], MinLatency(us), %.0f\n", name, data.min);
+      fprintf(stdout, "[%s], MaxLatency(us), %.0f\n", name, data.max);
+      fprintf(stdout, "[%s], 95thPercentileLatency(us), %.0f\n", name,
+              data.percentile95);
+      fprintf(stdout, "[%s], 99thPercentileLatency(us), %.0f\n", name,
+              data.percentile99);
+    }
+  }
+
   void Report(const Slice& name) {
     // Pretend at least one op was done in case we are running a benchmark
     // that does not call FinishedOps().
@@ -2159,6 +2782,9 @@ class Stats {
                 it->second->ToString().c_str());
       }
     }
+    if (ycsb_) {
+      ReportYCSB();
+    }
     if (FLAGS_report_file_operations) {
       ReportFileOpEnv* env = static_cast<ReportFileOpEnv*>(FLAGS_env);
       ReportFileOpCounters* counters = env->counters();
@@ -2351,6 +2977,7 @@ class Benchmark {
  private:
   std::shared_ptr<Cache> cache_;
   std::shared_ptr<Cache> compressed_cache_;
+  std::unique_ptr<MemoryGovernor> memory_governor_;
   std::shared_ptr<const FilterPolicy> filter_policy_;
   const SliceTransform* prefix_extractor_;
   DBWithColumnFamilies db_;
@@ -2377,6 +3004,10 @@ class Benchmark {
   int64_t writes_;
   int64_t readwrites_;
   int64_t merge_keys_;
+  // The YCSB workload, 'a' to 'f', and the records, those the loading wrote
+  // and those the workload inserted
+  char ycsb_workload_ = 'a';
+  std::atomic<uint64_t> ycsb_records_{0};
   bool report_file_operations_;
   bool use_blob_db_;
   std::vector<std::string> keys_;
@@ -2515,6 +3146,9 @@ class Benchmark {
       case kHashLinkedList:
         fprintf(stdout, "Memtablerep: hash_linkedlist\n");
         break;
+      case kBTreeRep:
+        fprintf(stdout, "Memtablerep: btree\n");
+        break;
     }
     fprintf(stdout, "Perf Level: %d\n", FLAGS_perf_level);
 
@@ -2665,22 +3299,32 @@ class Benchmark {
       }
       return cache;
     } else {
+      LRUCacheOptions opts(
+          static_cast<size_t>(capacity), FLAGS_cache_numshardbits,
+          false /*strict_capacity_limit*/, FLAGS_cache_high_pri_pool_ratio);
+      opts.tiny_lfu_admission = FLAGS_cache_tiny_lfu_admission;
       if (FLAGS_use_cache_memkind_kmem_allocator) {
 #ifdef MEMKIND
-        return NewLRUCache(
-            static_cast<size_t>(capacity), FLAGS_cache_numshardbits,
-            false /*strict_capacity_limit*/, FLAGS_cache_high_pri_pool_ratio,
-            std::make_shared<MemkindKmemAllocator>());
-
+        opts.memory_allocator = std::make_shared<MemkindKmemAllocator>();
+#else
+        fprintf(stderr, "Memkind library is not linked with the binary.");
+        exit(1);
+#endif
+      }
+      if (FLAGS_slow_memory_cache_size > 0) {
+#ifdef MEMKIND
+        SlowMemorySecondaryCacheOptions slow_opts;
+        slow_opts.capacity = static_cast<size_t>(FLAGS_slow_memory_cache_size);
+        slow_opts.num_shard_bits = FLAGS_cache_numshardbits;
+        slow_opts.memory_allocator = std::make_shared<MemkindKmemAllocator>();
+        slow_opts.statistics = dbstats;
+        opts.secondary_cache = NewSlowMemorySecondaryCache(slow_opts);
 #else
         fprintf(stderr, "Memkind library is not linked with the binary.");
         exit(1);
 #endif
-      } else {
-        return NewLRUCache(
-            static_cast<size_t>(capacity), FLAGS_cache_numshardbits,
-            false /*strict_capacity_limit*/, FLAGS_cache_high_pri_pool_ratio);
       }
+      return NewLRUCache(opts);
     }
   }
 
@@ -2689,8 +3333,12 @@ class Benchmark {
       : cache_(NewCache(FLAGS_cache_size)),
         compressed_cache_(NewCache(FLAGS_compressed_cache_size)),
         filter_policy_(FLAGS_bloom_bits >= 0
-                           ? NewBloomFilterPolicy(FLAGS_bloom_bits,
-                                                  FLAGS_use_block_based_filter)
+                           ? FLAGS_use_ribbon_filter
+                                 ? NewExperimentalRibbonFilterPolicy(
+                                       FLAGS_bloom_bits)
+                                 : NewBloomFilterPolicy(
+                                       FLAGS_bloom_bits,
+                                       FLAGS_use_block_based_filter)
                            : nullptr),
         prefix_extractor_(NewFixedPrefixTransform(FLAGS_prefix_size)),
         num_(FLAGS_num),
@@ -3102,6 +3750,13 @@ class Benchmark {
         method = &Benchmark::ReadWhileScanning;
       } else if (name == "readrandomwriterandom") {
         method = &Benchmark::ReadRandomWriteRandom;
+      } else if (name == "openloop") {
+        method = &Benchmark::OpenLoop;
+      } else if (name.size() == 5 && name.compare(0, 4, "ycsb") == 0 &&
+                 name[4] >= 'a' && name[4] <= 'f') {
+        ycsb_workload_ = name[4];
+        ycsb_records_ = FLAGS_num;
+        method = &Benchmark::YCSB;
       } else if (name == "readrandommergerandom") {
         if (FLAGS_merge_operator.empty()) {
           fprintf(stdout, "%-12s : skipped (--merge_operator is unknown)\n",
@@ -3130,10 +3785,18 @@ class Benchmark {
         method = &Benchmark::Compact;
       } else if (name == "compactall") {
         CompactAll();
+      } else if (name == "open") {
+        ReopenDB();
       } else if (name == "crc32c") {
         method = &Benchmark::Crc32c;
       } else if (name == "xxhash") {
         method = &Benchmark::xxHash;
+      } else if (name == "xxh3") {
+        method = &Benchmark::XXH3;
+#ifndef ROCKSDB_LITE
+      } else if (name == "encrypt") {
+        method = &Benchmark::Encrypt;
+#endif  // ROCKSDB_LITE
       } else if (name == "acquireload") {
         method = &Benchmark::AcquireLoad;
       } else if (name == "compress") {
@@ -3144,6 +3807,8 @@ class Benchmark {
       } else if (name == "randomtransaction") {
         method = &Benchmark::RandomTransaction;
         post_process_method = &Benchmark::RandomTransactionVerify;
+      } else if (name == "twophasecommit") {
+        method = &Benchmark::TwoPhaseCommit;
 #endif  // ROCKSDB_LITE
       } else if (name == "randomreplacekeys") {
         fresh_db = true;
@@ -3292,8 +3957,12 @@ class Benchmark {
 
         CombinedStats combined_stats;
         for (int i = 0; i < num_repeat; i++) {
+          std::vector<uint64_t> counters_before = GetJSONReportCounters();
           Stats stats = RunBenchmark(num_threads, name, method);
           combined_stats.AddStats(stats);
+          if (!FLAGS_json_report_file.empty()) {
+            ReportJSON(name, num_threads, i, stats, counters_before);
+          }
         }
         if (num_repeat > 1) {
           combined_stats.Report(name);
@@ -3331,6 +4000,10 @@ class Benchmark {
     if (FLAGS_statistics) {
       fprintf(stdout, "STATISTICS:\n%s\n", dbstats->ToString().c_str());
     }
+    if (FLAGS_lock_profiling_sample_one_in > 0) {
+      fprintf(stdout, "LOCK CONTENTION:\n%s\n",
+              LockContentionStatsToString().c_str());
+    }
     if (FLAGS_simcache_size >= 0) {
       fprintf(
           stdout, "SIMULATOR CACHE STATISTICS:\n%s\n",
@@ -3349,6 +4022,7 @@ class Benchmark {
   std::shared_ptr<TimestampEmulator> timestamp_emulator_;
   std::unique_ptr<port::Thread> secondary_update_thread_;
   std::atomic<int> secondary_update_stopped_{0};
+  std::unique_ptr<WritableFile> json_report_file_;
 #ifndef ROCKSDB_LITE
   uint64_t secondary_db_updates_ = 0;
 #endif  // ROCKSDB_LITE
@@ -3379,6 +4053,10 @@ class Benchmark {
     thread->stats.Start(thread->tid);
     (arg->bm->*(arg->method))(thread);
     thread->stats.Stop();
+    if (!FLAGS_json_report_file.empty() &&
+        shared->perf_level >= PerfLevel::kEnableCount) {
+      thread->stats.AddPerfContext(*get_perf_context());
+    }
 
     {
       MutexLock l(&shared->mu);
@@ -3389,6 +4067,86 @@ class Benchmark {
     }
   }
 
+  // The counters of which the JSON reports have the changes: the tickers of
+  // the statistics, then with --report_zenfs_stats, the bytes written to
+  // the zoned device and kZenFSCounters
+  std::vector<uint64_t> GetJSONReportCounters() {
+    std::vector<uint64_t> counters;
+    if (FLAGS_json_report_file.empty()) {
+      return counters;
+    }
+    if (dbstats) {
+      for (const auto& t : TickersNameMap) {
+        counters.push_back(dbstats->getTickerCount(t.first));
+      }
+    }
+    if (FLAGS_report_zenfs_stats &&
+        (db_.db != nullptr || !multi_dbs_.empty())) {
+      DB* db = SelectDBWithCfh(uint64_t{0})->db;
+      counters.push_back(GetZenFSCounter(db, "bytes-written"));
+      for (const char* counter : kZenFSCounters) {
+        counters.push_back(GetZenFSCounter(db, counter));
+      }
+    }
+    return counters;
+  }
+
+  // Appends the JSON report of run repeat of benchmark name to
+  // --json_report_file, before having GetJSONReportCounters() before the run
+  void ReportJSON(const Slice& name, int num_threads, int repeat,
+                  const Stats& stats, const std::vector<uint64_t>& before) {
+    if (json_report_file_ == nullptr) {
+      Status s = FLAGS_env->NewWritableFile(FLAGS_json_report_file,
+                                            &json_report_file_, EnvOptions());
+      if (!s.ok()) {
+        fprintf(stderr, "Cannot open %s: %s\n",
+                FLAGS_json_report_file.c_str(), s.ToString().c_str());
+        ErrorExit();
+      }
+    }
+
+    JSONWriter json;
+    json << "benchmark" << name.ToString() << "threads" << num_threads
+         << "repeat" << repeat;
+    stats.ReportJSON(&json);
+
+    std::vector<uint64_t> after = GetJSONReportCounters();
+    auto delta = [&](size_t j) {
+      return after[j] - (j < before.size() ? before[j] : 0);
+    };
+    size_t i = 0;
+    if (dbstats && after.size() >= TickersNameMap.size()) {
+      json.AddKey("tickers");
+      json.StartObject();
+      for (const auto& t : TickersNameMap) {
+        uint64_t d = delta(i++);
+        if (d > 0) {
+          json << t.second << d;
+        }
+      }
+      json.EndObject();
+    }
+    if (i < after.size()) {
+      json.AddKey("zenfs");
+      json.StartObject();
+      json << "bytes-written" << delta(i++);
+      for (const char* counter : kZenFSCounters) {
+        json << counter << delta(i++);
+      }
+      json.EndObject();
+    }
+    json.EndObject();
+
+    Status s = json_report_file_->Append(json.Get() + "\n");
+    if (s.ok()) {
+      s = json_report_file_->Flush();
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Cannot write %s: %s\n", FLAGS_json_report_file.c_str(),
+              s.ToString().c_str());
+    }
+  }
+
   Stats RunBenchmark(int n, Slice name,
                      void (Benchmark::*method)(ThreadState*)) {
     SharedState shared;
@@ -3408,8 +4166,14 @@ class Benchmark {
 
     std::unique_ptr<ReporterAgent> reporter_agent;
     if (FLAGS_report_interval_seconds > 0) {
+      DB* zenfs_db = nullptr;
+      if (FLAGS_report_zenfs_stats &&
+          (db_.db != nullptr || !multi_dbs_.empty())) {
+        zenfs_db = SelectDBWithCfh(uint64_t{0})->db;
+      }
       reporter_agent.reset(new ReporterAgent(FLAGS_env, FLAGS_report_file,
-                                             FLAGS_report_interval_seconds));
+                                             FLAGS_report_interval_seconds,
+                                             zenfs_db, dbstats.get()));
     }
 
     ThreadArg* arg = new ThreadArg[n];
@@ -3508,6 +4272,78 @@ class Benchmark {
     thread->stats.AddMessage(label);
   }
 
+  void XXH3(ThreadState* thread) {
+    // Checksum about 500MB of data total, as kXXH3 block checksums do
+    const int size = FLAGS_block_size;
+    std::string labels = "(" + ToString(FLAGS_block_size) + " per op)";
+    const char* label = labels.c_str();
+
+    std::string data(size, 'x');
+    int64_t bytes = 0;
+    uint64_t xxh3 = 0;
+    while (bytes < 500 * 1048576) {
+      xxh3 = XXH3p_64bits(data.data(), size);
+      thread->stats.FinishedOps(nullptr, nullptr, 1, kHash);
+      bytes += size;
+    }
+    // Print so result is not dead
+    fprintf(stderr, "... xxh3=0x%" PRIx64 "\r", xxh3);
+
+    thread->stats.AddBytes(bytes);
+    thread->stats.AddMessage(label);
+  }
+
+#ifndef ROCKSDB_LITE
+  void Encrypt(ThreadState* thread) {
+    // Encrypt about 500MB of data total, through the cipher stream of a
+    // file of the CTR provider
+    const int size = FLAGS_block_size;
+    std::string labels = "(" + ToString(FLAGS_block_size) + " per op, " +
+                         FLAGS_encryption_cipher.substr(
+                             0, FLAGS_encryption_cipher.find(':')) +
+                         ")";
+
+    std::shared_ptr<BlockCipher> cipher;
+    Status s = BlockCipher::CreateFromString(
+        ConfigOptions(), FLAGS_encryption_cipher, &cipher);
+    std::unique_ptr<BlockAccessCipherStream> stream;
+    std::shared_ptr<EncryptionProvider> provider;
+    std::string prefix;
+    if (s.ok()) {
+      provider = EncryptionProvider::NewCTRProvider(cipher);
+      prefix.resize(provider->GetPrefixLength());
+      s = provider->CreateNewPrefix("encrypt", &prefix[0], prefix.size());
+    }
+    if (s.ok()) {
+      Slice prefix_slice(prefix);
+      s = provider->CreateCipherStream("encrypt", EnvOptions(), prefix_slice,
+                                       &stream);
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Cannot create cipher %s: %s\n",
+              FLAGS_encryption_cipher.c_str(), s.ToString().c_str());
+      exit(1);
+    }
+
+    std::string data(size, 'x');
+    int64_t bytes = 0;
+    while (bytes < 500 * 1048576) {
+      s = stream->Encrypt(bytes, &data[0], size);
+      if (!s.ok()) {
+        fprintf(stderr, "Encryption failed: %s\n", s.ToString().c_str());
+        exit(1);
+      }
+      thread->stats.FinishedOps(nullptr, nullptr, 1, kEncrypt);
+      bytes += size;
+    }
+    // Print so result is not dead
+    fprintf(stderr, "... data[0]=0x%x\r", static_cast<unsigned char>(data[0]));
+
+    thread->stats.AddBytes(bytes);
+    thread->stats.AddMessage(labels);
+  }
+#endif  // ROCKSDB_LITE
+
   void AcquireLoad(ThreadState* thread) {
     int dummy;
     std::atomic<void*> ap(&dummy);
@@ -3626,7 +4462,21 @@ class Benchmark {
 
     options.env = FLAGS_env;
     options.max_open_files = FLAGS_open_files;
-    if (FLAGS_cost_write_buffer_to_cache || FLAGS_db_write_buffer_size != 0) {
+    if (FLAGS_memory_budget > 0 && cache_ != nullptr) {
+      // The governor sets the size of the write buffers
+      options.write_buffer_manager.reset(new WriteBufferManager(
+          static_cast<size_t>(FLAGS_memory_budget),
+          FLAGS_cost_write_buffer_to_cache ? cache_ : nullptr));
+      MemoryGovernorOptions governor_options;
+      governor_options.total_budget = static_cast<size_t>(FLAGS_memory_budget);
+      governor_options.block_cache = cache_;
+      governor_options.write_buffer_manager = options.write_buffer_manager;
+      governor_options.statistics = dbstats;
+      governor_options.rebalance_period_sec = FLAGS_memory_governor_period_sec;
+      governor_options.env = FLAGS_env;
+      memory_governor_.reset(NewMemoryGovernor(governor_options));
+    } else if (FLAGS_cost_write_buffer_to_cache ||
+               FLAGS_db_write_buffer_size != 0) {
       options.write_buffer_manager.reset(
           new WriteBufferManager(FLAGS_db_write_buffer_size, cache_));
     }
@@ -3641,6 +4491,7 @@ class Benchmark {
     options.max_background_jobs = FLAGS_max_background_jobs;
     options.max_background_compactions = FLAGS_max_background_compactions;
     options.max_subcompactions = static_cast<uint32_t>(FLAGS_subcompactions);
+    options.enable_pipelined_compaction = FLAGS_enable_pipelined_compaction;
     options.max_background_flushes = FLAGS_max_background_flushes;
     options.compaction_style = FLAGS_compaction_style_e;
     options.compaction_pri = FLAGS_compaction_pri_e;
@@ -3649,11 +4500,14 @@ class Benchmark {
     options.use_direct_reads = FLAGS_use_direct_reads;
     options.use_direct_io_for_flush_and_compaction =
         FLAGS_use_direct_io_for_flush_and_compaction;
+    options.async_table_file_flush = FLAGS_async_table_file_flush;
 #ifndef ROCKSDB_LITE
     options.ttl = FLAGS_fifo_compaction_ttl;
     options.compaction_options_fifo = CompactionOptionsFIFO(
         FLAGS_fifo_compaction_max_table_files_size_mb * 1024 * 1024,
         FLAGS_fifo_compaction_allow_compaction);
+    options.compaction_options_fifo.zone_time_bucket_seconds =
+        FLAGS_fifo_compaction_zone_time_bucket_seconds;
 #endif  // ROCKSDB_LITE
     if (FLAGS_prefix_size != 0) {
       options.prefix_extractor.reset(
@@ -3679,6 +4533,7 @@ class Benchmark {
     }
     options.bloom_locality = FLAGS_bloom_locality;
     options.max_file_opening_threads = FLAGS_file_opening_threads;
+    options.lazy_open_table_files = FLAGS_lazy_open_table_files;
     options.new_table_reader_for_compaction_inputs =
         FLAGS_new_table_reader_for_compaction_inputs;
     options.compaction_readahead_size = FLAGS_compaction_readahead_size;
@@ -3692,6 +4547,13 @@ class Benchmark {
     options.max_bytes_for_level_base = FLAGS_max_bytes_for_level_base;
     options.level_compaction_dynamic_level_bytes =
         FLAGS_level_compaction_dynamic_level_bytes;
+    options.zone_aware_compaction_window =
+        static_cast<size_t>(FLAGS_zone_aware_compaction_window);
+    if (FLAGS_zone_capacity_partitioner_reserve_pct >= 0) {
+      options.sst_partitioner_factory = NewSstPartitionerZoneCapacityFactory(
+          FLAGS_env->GetFileSystem(),
+          static_cast<uint32_t>(FLAGS_zone_capacity_partitioner_reserve_pct));
+    }
     options.max_bytes_for_level_multiplier =
         FLAGS_max_bytes_for_level_multiplier;
     if ((FLAGS_prefix_size == 0) && (FLAGS_rep_factory == kPrefixHash ||
@@ -3702,8 +4564,9 @@ class Benchmark {
     }
     switch (FLAGS_rep_factory) {
       case kSkipList:
-        options.memtable_factory.reset(new SkipListFactory(
-            FLAGS_skip_list_lookahead));
+        options.memtable_factory.reset(
+            new SkipListFactory(FLAGS_skip_list_lookahead,
+                                FLAGS_skip_list_prefix_index_buckets));
         break;
 #ifndef ROCKSDB_LITE
       case kPrefixHash:
@@ -3719,6 +4582,9 @@ class Benchmark {
           new VectorRepFactory
         );
         break;
+      case kBTreeRep:
+        options.memtable_factory.reset(new BTreeRepFactory);
+        break;
 #else
       default:
         fprintf(stderr, "Only skip list is supported in lite mode\n");
@@ -3800,6 +4666,9 @@ class Benchmark {
       } else if (FLAGS_index_with_first_key) {
         block_based_options.index_type =
             BlockBasedTableOptions::kBinarySearchWithFirstKey;
+      } else if (FLAGS_use_trie_index) {
+        block_based_options.index_type =
+            BlockBasedTableOptions::kSuccinctTrieSearch;
       }
       BlockBasedTableOptions::IndexShorteningMode index_shortening =
           block_based_options.index_shortening;
@@ -3821,6 +4690,10 @@ class Benchmark {
       }
       block_based_options.optimize_filters_for_memory =
           FLAGS_optimize_filters_for_memory;
+      block_based_options.reserve_table_builder_memory =
+          FLAGS_reserve_table_builder_memory;
+      block_based_options.serve_data_blocks_from_mmap =
+          FLAGS_serve_data_blocks_from_mmap;
       block_based_options.index_shortening = index_shortening;
       if (cache_ == nullptr) {
         block_based_options.no_block_cache = true;
@@ -3844,6 +4717,8 @@ class Benchmark {
       block_based_options.filter_policy = filter_policy_;
       block_based_options.format_version =
           static_cast<uint32_t>(FLAGS_format_version);
+      block_based_options.checksum =
+          StringToChecksumType(FLAGS_checksum_type.c_str());
       block_based_options.read_amp_bytes_per_bit = FLAGS_read_amp_bytes_per_bit;
       block_based_options.enable_index_compression =
           FLAGS_enable_index_compression;
@@ -3857,6 +4732,8 @@ class Benchmark {
       }
       block_based_options.data_block_hash_table_util_ratio =
           FLAGS_data_block_hash_table_util_ratio;
+      block_based_options.data_block_restart_key_prefixes =
+          FLAGS_data_block_restart_key_prefixes;
       if (FLAGS_read_cache_path != "") {
 #ifndef ROCKSDB_LITE
         Status rc_status;
@@ -3917,6 +4794,22 @@ class Benchmark {
       FLAGS_level0_slowdown_writes_trigger;
     options.compression = FLAGS_compression_type_e;
     options.sample_for_compression = FLAGS_sample_for_compression;
+    options.max_flush_partitions = FLAGS_max_flush_partitions;
+    options.enable_blob_files = FLAGS_enable_blob_files;
+    options.min_blob_size = FLAGS_min_blob_size;
+    options.blob_file_starting_level = FLAGS_blob_file_starting_level;
+    options.blob_file_size = FLAGS_blob_file_size;
+    options.blob_compression_type = FLAGS_blob_compression_type_e;
+    options.enable_blob_garbage_collection =
+        FLAGS_enable_blob_garbage_collection;
+    options.blob_garbage_collection_age_cutoff =
+        FLAGS_blob_garbage_collection_age_cutoff;
+    if (FLAGS_use_shared_block_and_blob_cache) {
+      options.blob_cache = cache_;
+    } else {
+      options.blob_cache = NewCache(FLAGS_blob_cache_size);
+    }
+    options.prepopulate_blob_cache = FLAGS_prepopulate_blob_cache;
     options.WAL_ttl_seconds = FLAGS_wal_ttl_seconds;
     options.WAL_size_limit_MB = FLAGS_wal_size_limit_MB;
     options.max_total_wal_size = FLAGS_max_total_wal_size;
@@ -3938,6 +4831,11 @@ class Benchmark {
         FLAGS_soft_pending_compaction_bytes_limit;
     options.hard_pending_compaction_bytes_limit =
         FLAGS_hard_pending_compaction_bytes_limit;
+    options.smooth_write_stall = FLAGS_smooth_write_stall;
+    options.smooth_write_stall_target_l0_files =
+        FLAGS_smooth_write_stall_target_l0_files;
+    options.smooth_write_stall_target_pending_compaction_bytes =
+        FLAGS_smooth_write_stall_target_pending_compaction_bytes;
     options.delayed_write_rate = FLAGS_delayed_write_rate;
     options.allow_concurrent_memtable_write =
         FLAGS_allow_concurrent_memtable_write;
@@ -3946,6 +4844,7 @@ class Benchmark {
     options.enable_write_thread_adaptive_yield =
         FLAGS_enable_write_thread_adaptive_yield;
     options.enable_pipelined_write = FLAGS_enable_pipelined_write;
+    options.wal_streams = static_cast<size_t>(FLAGS_wal_streams);
     options.unordered_write = FLAGS_unordered_write;
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
@@ -3973,6 +4872,7 @@ class Benchmark {
       exit(1);
     }
     options.max_successive_merges = FLAGS_max_successive_merges;
+    options.preaggregate_merge_operands = FLAGS_preaggregate_merge_operands;
     options.report_bg_io_stats = FLAGS_report_bg_io_stats;
 
     // set universal style compaction configurations, if applicable
@@ -3998,6 +4898,10 @@ class Benchmark {
     }
     options.compaction_options_universal.allow_trivial_move =
         FLAGS_universal_allow_trivial_move;
+    options.compaction_options_universal.runs_per_tier =
+        FLAGS_universal_runs_per_tier;
+    options.compaction_options_universal.incremental =
+        FLAGS_universal_incremental;
     if (FLAGS_thread_status_per_interval > 0) {
       options.enable_thread_tracking = true;
     }
@@ -4044,6 +4948,8 @@ class Benchmark {
     options.compression_opts.max_dict_bytes = FLAGS_compression_max_dict_bytes;
     options.compression_opts.zstd_max_train_bytes =
         FLAGS_compression_zstd_max_train_bytes;
+    options.compression_opts.shared_dict_retrain_bytes =
+        FLAGS_compression_shared_dict_retrain_bytes;
     options.compression_opts.parallel_threads =
         FLAGS_compression_parallel_threads;
     // If this is a block based table, set some related options
@@ -4054,8 +4960,11 @@ class Benchmark {
         table_options->block_cache = cache_;
       }
       if (FLAGS_bloom_bits >= 0) {
-        table_options->filter_policy.reset(NewBloomFilterPolicy(
-            FLAGS_bloom_bits, FLAGS_use_block_based_filter));
+        table_options->filter_policy.reset(
+            FLAGS_use_ribbon_filter
+                ? NewExperimentalRibbonFilterPolicy(FLAGS_bloom_bits)
+                : NewBloomFilterPolicy(FLAGS_bloom_bits,
+                                       FLAGS_use_block_based_filter));
       }
     }
     if (FLAGS_row_cache_size) {
@@ -4065,7 +4974,13 @@ class Benchmark {
       } else {
         options.row_cache = NewLRUCache(FLAGS_row_cache_size);
       }
+      options.row_cache_negative_entries = FLAGS_row_cache_negative_entries;
     }
+    options.immutable_memtable_numa_node = FLAGS_immutable_memtable_numa_node;
+    options.options_advisor_period_sec = FLAGS_options_advisor_period_sec;
+    options.options_advisor_apply_changes = FLAGS_options_advisor_apply_changes;
+    options.options_advisor_max_change_factor =
+        FLAGS_options_advisor_max_change_factor;
     if (FLAGS_enable_io_prio) {
       FLAGS_env->LowerThreadPoolIOPriority(Env::LOW);
       FLAGS_env->LowerThreadPoolIOPriority(Env::HIGH);
@@ -4191,6 +5106,10 @@ class Benchmark {
       } else if (FLAGS_transaction_db) {
         TransactionDB* ptr;
         TransactionDBOptions txn_db_options;
+        txn_db_options.per_key_lock_wait_queues =
+            FLAGS_transaction_per_key_lock_wait_queues;
+        txn_db_options.write_policy =
+            static_cast<TxnDBWritePolicy>(FLAGS_txn_write_policy);
         if (options.unordered_write) {
           options.two_write_queues = true;
           txn_db_options.skip_concurrency_control = true;
@@ -4223,6 +5142,10 @@ class Benchmark {
     } else if (FLAGS_transaction_db) {
       TransactionDB* ptr = nullptr;
       TransactionDBOptions txn_db_options;
+      txn_db_options.per_key_lock_wait_queues =
+          FLAGS_transaction_per_key_lock_wait_queues;
+      txn_db_options.write_policy =
+          static_cast<TxnDBWritePolicy>(FLAGS_txn_write_policy);
       if (options.unordered_write) {
         options.two_write_queues = true;
         txn_db_options.skip_concurrency_control = true;
@@ -4317,6 +5240,9 @@ class Benchmark {
     KeyGenerator(Random64* rand, WriteMode mode, uint64_t num,
                  uint64_t /*num_per_set*/ = 64 * 1024)
         : rand_(rand), mode_(mode), num_(num), next_(0) {
+      if (mode_ == RANDOM && FLAGS_write_zipf_theta > 0) {
+        zipf_.reset(new ZipfianGenerator(num_, FLAGS_write_zipf_theta));
+      }
       if (mode_ == UNIQUE_RANDOM) {
         // NOTE: if memory consumption of this approach becomes a concern,
         // we can either break it into pieces and only random shuffle a section
@@ -4336,6 +5262,9 @@ class Benchmark {
         case SEQUENTIAL:
           return next_++;
         case RANDOM:
+          if (zipf_) {
+            return zipf_->Next(rand_);
+          }
           return rand_->Next() % num_;
         case UNIQUE_RANDOM:
           assert(next_ < num_);
@@ -4351,6 +5280,7 @@ class Benchmark {
     const uint64_t num_;
     uint64_t next_;
     std::vector<uint64_t> values_;
+    std::unique_ptr<ZipfianGenerator> zipf_;
   };
 
   DB* SelectDB(ThreadState* thread) {
@@ -4893,6 +5823,7 @@ class Benchmark {
   void ReadSequential(ThreadState* thread, DB* db) {
     ReadOptions options(FLAGS_verify_checksum, true);
     options.tailing = FLAGS_use_tailing_iterator;
+    options.async_io = FLAGS_async_io;
     std::unique_ptr<char[]> ts_guard;
     Slice ts;
     if (user_timestamp_size_ > 0) {
@@ -4904,16 +5835,36 @@ class Benchmark {
     Iterator* iter = db->NewIterator(options);
     int64_t i = 0;
     int64_t bytes = 0;
-    for (iter->SeekToFirst(); i < reads_ && iter->Valid(); iter->Next()) {
-      bytes += iter->key().size() + iter->value().size();
-      thread->stats.FinishedOps(nullptr, db, 1, kRead);
-      ++i;
+    if (FLAGS_iter_next_batch_size > 0) {
+      iter->SeekToFirst();
+      while (i < reads_ && iter->Valid()) {
+        size_t n = iter->NextBatch(
+            static_cast<size_t>(std::min<int64_t>(FLAGS_iter_next_batch_size,
+                                                  reads_ - i)),
+            port::kMaxSizet, [&](const Slice& key, const Slice& value) {
+              bytes += key.size() + value.size();
+            });
+        thread->stats.FinishedOps(nullptr, db, static_cast<int64_t>(n),
+                                  kRead);
+        if (thread->shared->read_rate_limiter.get() != nullptr) {
+          thread->shared->read_rate_limiter->Request(
+              static_cast<int64_t>(n), Env::IO_HIGH, nullptr /* stats */,
+              RateLimiter::OpType::kRead);
+        }
+        i += static_cast<int64_t>(n);
+      }
+    } else {
+      for (iter->SeekToFirst(); i < reads_ && iter->Valid(); iter->Next()) {
+        bytes += iter->key().size() + iter->value().size();
+        thread->stats.FinishedOps(nullptr, db, 1, kRead);
+        ++i;
 
-      if (thread->shared->read_rate_limiter.get() != nullptr &&
-          i % 1024 == 1023) {
-        thread->shared->read_rate_limiter->Request(1024, Env::IO_HIGH,
-                                                   nullptr /* stats */,
-                                                   RateLimiter::OpType::kRead);
+        if (thread->shared->read_rate_limiter.get() != nullptr &&
+            i % 1024 == 1023) {
+          thread->shared->read_rate_limiter->Request(
+              1024, Env::IO_HIGH, nullptr /* stats */,
+              RateLimiter::OpType::kRead);
+        }
       }
     }
 
@@ -5193,6 +6144,7 @@ class Benchmark {
     int64_t num_multireads = 0;
     int64_t found = 0;
     ReadOptions options(FLAGS_verify_checksum, true);
+    options.optimize_multiget_for_io = FLAGS_optimize_multiget_for_io;
     std::vector<Slice> keys;
     std::vector<std::unique_ptr<const char[]> > key_guards;
     std::vector<std::string> values(entries_per_batch_);
@@ -5782,6 +6734,7 @@ class Benchmark {
     options.prefix_same_as_start = FLAGS_prefix_same_as_start;
     options.tailing = FLAGS_use_tailing_iterator;
     options.readahead_size = FLAGS_readahead_size;
+    options.async_io = FLAGS_async_io;
     std::unique_ptr<char[]> ts_guard;
     Slice ts;
     if (user_timestamp_size_ > 0) {
@@ -6365,6 +7318,237 @@ class Benchmark {
     thread->stats.AddMessage(msg);
   }
 
+  // Issues random reads, writes and scans at --open_loop_ops_per_sec,
+  // whether or not the previous operations are done. An operation late
+  // behind a slow one is issued at once, and its latency counted from when
+  // it was due, so the latencies are not hidden by the slow operation as in
+  // the other benchmarks, which issue the next operation when the previous
+  // one is done.
+  void OpenLoop(ThreadState* thread) {
+    const bool poisson = FLAGS_open_loop_arrivals == "poisson";
+    if (FLAGS_open_loop_ops_per_sec <= 0 ||
+        (!poisson && FLAGS_open_loop_arrivals != "fixed") ||
+        FLAGS_open_loop_read_percent < 0 || FLAGS_open_loop_scan_percent < 0 ||
+        FLAGS_open_loop_read_percent + FLAGS_open_loop_scan_percent > 100) {
+      fprintf(stderr,
+              "openloop needs --open_loop_ops_per_sec > 0, "
+              "--open_loop_arrivals of poisson or fixed and at most 100%% "
+              "of reads and scans\n");
+      ErrorExit();
+    }
+    ReadOptions options(FLAGS_verify_checksum, true);
+    RandomGenerator gen;
+    std::string value;
+    int64_t found = 0;
+    int64_t reads_done = 0;
+    int64_t writes_done = 0;
+    int64_t scans_done = 0;
+    int64_t late = 0;
+    Duration duration(FLAGS_duration, readwrites_);
+
+    std::unique_ptr<const char[]> key_guard;
+    Slice key = AllocateKey(&key_guard);
+
+    // Each thread issues its share of the operations
+    const double gap_micros = 1e6 * FLAGS_threads / FLAGS_open_loop_ops_per_sec;
+    double due = static_cast<double>(FLAGS_env->NowMicros());
+    while (!duration.Done(1)) {
+      if (poisson) {
+        double u = static_cast<double>(thread->rand.Next() >> 11) /
+                   static_cast<double>(uint64_t{1} << 53);
+        due -= std::log(1.0 - u) * gap_micros;
+      } else {
+        due += gap_micros;
+      }
+      uint64_t now = FLAGS_env->NowMicros();
+      if (now < due) {
+        FLAGS_env->SleepForMicroseconds(static_cast<int>(due - now));
+        now = FLAGS_env->NowMicros();
+      } else {
+        late++;
+      }
+      thread->stats.SetOpStartTime(
+          std::min(static_cast<uint64_t>(due), now));
+
+      DB* db = SelectDB(thread);
+      GenerateKeyFromInt(thread->rand.Next() % FLAGS_num, FLAGS_num, &key);
+      int op = static_cast<int>(thread->rand.Uniform(100));
+      if (op < FLAGS_open_loop_read_percent) {
+        Status s = db->Get(options, key, &value);
+        if (!s.ok() && !s.IsNotFound()) {
+          fprintf(stderr, "get error: %s\n", s.ToString().c_str());
+        } else if (!s.IsNotFound()) {
+          found++;
+        }
+        reads_done++;
+        thread->stats.FinishedOps(nullptr, db, 1, kRead);
+      } else if (op < FLAGS_open_loop_read_percent +
+                          FLAGS_open_loop_scan_percent) {
+        std::unique_ptr<Iterator> iter(db->NewIterator(options));
+        iter->Seek(key);
+        for (int j = 0; j < FLAGS_seek_nexts && iter->Valid(); j++) {
+          iter->Next();
+        }
+        if (!iter->status().ok()) {
+          fprintf(stderr, "scan error: %s\n",
+                  iter->status().ToString().c_str());
+        }
+        scans_done++;
+        thread->stats.FinishedOps(nullptr, db, 1, kSeek);
+      } else {
+        Status s = db->Put(write_options_, key, gen.Generate());
+        if (!s.ok()) {
+          fprintf(stderr, "put error: %s\n", s.ToString().c_str());
+          ErrorExit();
+        }
+        writes_done++;
+        thread->stats.FinishedOps(nullptr, db, 1, kWrite);
+      }
+    }
+    char msg[150];
+    snprintf(msg, sizeof(msg),
+             "( reads:%" PRIu64 " writes:%" PRIu64 " scans:%" PRIu64
+             " found:%" PRIu64 " late:%" PRIu64 ")",
+             reads_done, writes_done, scans_done, found, late);
+    thread->stats.AddMessage(msg);
+  }
+
+  // A YCSB core workload: ycsba, update heavy, ycsbb, read mostly, ycsbc,
+  // read only, ycsbd, read latest, ycsbe, short ranges, or ycsbf,
+  // read-modify-write. As the RocksDB binding of YCSB, an update reads the
+  // record and writes it back with a new field.
+  void YCSB(ThreadState* thread) {
+    struct Mix {
+      int read, update, insert, scan;  // read-modify-write for the rest
+    };
+    static const Mix kMixes[] = {{50, 50, 0, 0},  {95, 5, 0, 0},
+                                 {100, 0, 0, 0},  {95, 0, 5, 0},
+                                 {0, 0, 5, 95},   {50, 0, 0, 0}};
+    const Mix& mix = kMixes[ycsb_workload_ - 'a'];
+
+    enum { kUniformKeys, kZipfianKeys, kLatestKeys } keys;
+    std::string dist = FLAGS_ycsb_request_distribution;
+    if (dist.empty()) {
+      dist = ycsb_workload_ == 'd' ? "latest" : "scrambled_zipfian";
+    }
+    if (dist == "uniform") {
+      keys = kUniformKeys;
+    } else if (dist == "zipfian" || dist == "scrambled_zipfian") {
+      keys = kZipfianKeys;
+    } else if (dist == "latest") {
+      keys = kLatestKeys;
+    } else {
+      fprintf(stderr, "Unknown --ycsb_request_distribution %s\n",
+              dist.c_str());
+      ErrorExit();
+      return;
+    }
+    // Latest draws the distance from the last record
+    std::unique_ptr<ZipfianGenerator> zipf;
+    if (keys != kUniformKeys) {
+      zipf.reset(new ZipfianGenerator(FLAGS_num, FLAGS_ycsb_zipfian_constant,
+                                      dist == "scrambled_zipfian"));
+    }
+
+    ReadOptions options(FLAGS_verify_checksum, true);
+    RandomGenerator gen;
+    const unsigned int field_length =
+        static_cast<unsigned int>(FLAGS_ycsb_field_length);
+    const size_t record_size =
+        static_cast<size_t>(FLAGS_ycsb_field_count) * field_length;
+    std::string value;
+    int64_t found = 0;
+    Duration duration(FLAGS_duration, readwrites_);
+
+    std::unique_ptr<const char[]> key_guard;
+    Slice key = AllocateKey(&key_guard);
+
+    thread->stats.EnableYCSBReport();
+    thread->stats.ResetLastOpTime();
+    while (!duration.Done(1)) {
+      DB* db = SelectDB(thread);
+      int op = static_cast<int>(thread->rand.Uniform(100));
+      if (op >= mix.read + mix.update && op < mix.read + mix.update +
+                                                  mix.insert) {
+        GenerateKeyFromInt(ycsb_records_.fetch_add(1), FLAGS_num, &key);
+        Status s = db->Put(write_options_, key,
+                           gen.Generate(static_cast<unsigned int>(
+                               record_size)));
+        if (!s.ok()) {
+          fprintf(stderr, "put error: %s\n", s.ToString().c_str());
+          ErrorExit();
+        }
+        thread->stats.FinishedOps(nullptr, db, 1, kWrite);
+        continue;
+      }
+
+      uint64_t records = std::max<uint64_t>(ycsb_records_.load(), 1);
+      uint64_t k;
+      if (keys == kUniformKeys) {
+        k = thread->rand.Next() % records;
+      } else if (keys == kZipfianKeys) {
+        k = zipf->Next(&thread->rand);
+      } else {
+        uint64_t distance = zipf->Next(&thread->rand);
+        k = distance < records ? records - 1 - distance : 0;
+      }
+      GenerateKeyFromInt(k, FLAGS_num, &key);
+
+      if (op < mix.read) {
+        Status s = db->Get(options, key, &value);
+        if (!s.ok() && !s.IsNotFound()) {
+          fprintf(stderr, "get error: %s\n", s.ToString().c_str());
+        } else if (!s.IsNotFound()) {
+          found++;
+        }
+        thread->stats.FinishedOps(nullptr, db, 1, kRead);
+      } else if (op >= mix.read + mix.update + mix.insert &&
+                 op < mix.read + mix.update + mix.insert + mix.scan) {
+        int length = 1 + static_cast<int>(thread->rand.Uniform(
+                             std::max(FLAGS_ycsb_max_scan_length, 1)));
+        std::unique_ptr<Iterator> iter(db->NewIterator(options));
+        iter->Seek(key);
+        for (int j = 1; j < length && iter->Valid(); j++) {
+          iter->Next();
+        }
+        if (!iter->status().ok()) {
+          fprintf(stderr, "scan error: %s\n",
+                  iter->status().ToString().c_str());
+        }
+        thread->stats.FinishedOps(nullptr, db, 1, kSeek);
+      } else {
+        // An update, or a read-modify-write
+        Status s = db->Get(options, key, &value);
+        if (!s.ok() && !s.IsNotFound()) {
+          fprintf(stderr, "get error: %s\n", s.ToString().c_str());
+        } else if (!s.IsNotFound()) {
+          found++;
+        }
+        if (!s.ok() || value.size() < record_size) {
+          value.assign(
+              gen.Generate(static_cast<unsigned int>(record_size)).ToString());
+        }
+        size_t field = thread->rand.Uniform(
+            std::max(FLAGS_ycsb_field_count, 1));
+        Slice field_value = gen.Generate(field_length);
+        value.replace(field * field_length, field_length, field_value.data(),
+                      field_value.size());
+        s = db->Put(write_options_, key, value);
+        if (!s.ok()) {
+          fprintf(stderr, "put error: %s\n", s.ToString().c_str());
+          ErrorExit();
+        }
+        thread->stats.FinishedOps(nullptr, db, 1,
+                                  op < mix.read + mix.update
+                                      ? kUpdate
+                                      : kReadModifyWrite);
+      }
+    }
+    char msg[100];
+    snprintf(msg, sizeof(msg), "(found:%" PRIu64 ")", found);
+    thread->stats.AddMessage(msg);
+  }
+
   //
   // Read-modify-write for random keys
   void UpdateRandom(ThreadState* thread) {
@@ -6886,6 +8070,90 @@ class Benchmark {
     thread->stats.AddBytes(static_cast<int64_t>(inserter.GetBytesInserted()));
   }
 
+  // Each operation either commits a transaction writing a random key with
+  // two phase commit, or, for --readwritepercent of them, reads a random key
+  // at one of the --twopc_old_snapshots snapshots the thread keeps for the
+  // whole run, as long running analytic reads would. With
+  // --txn_write_policy=1 and enough writes to evict the commit cache, the
+  // reads look the evicted commits up in the old commit map.
+  void TwoPhaseCommit(ThreadState* thread) {
+    if (!FLAGS_transaction_db || FLAGS_num_multi_db > 1) {
+      fprintf(stderr, "twophasecommit needs a single transaction_db\n");
+      ErrorExit();
+    }
+    TransactionDB* txn_db = reinterpret_cast<TransactionDB*>(db_.db);
+    ReadOptions read_options(FLAGS_verify_checksum, true);
+    TransactionOptions txn_options;
+    txn_options.lock_timeout = FLAGS_transaction_lock_timeout;
+    RandomGenerator gen;
+    Duration duration(FLAGS_duration, readwrites_);
+    std::unique_ptr<const char[]> key_guard;
+    Slice key = AllocateKey(&key_guard);
+    std::string value;
+
+    std::vector<const Snapshot*> snapshots;
+    for (int i = 0; i < FLAGS_twopc_old_snapshots; i++) {
+      snapshots.push_back(txn_db->GetSnapshot());
+    }
+
+    int64_t reads_done = 0;
+    int64_t found = 0;
+    int64_t commits = 0;
+    int64_t aborts = 0;
+    while (!duration.Done(1)) {
+      GenerateKeyFromInt(thread->rand.Next() % FLAGS_num, FLAGS_num, &key);
+      if (thread->rand.Uniform(100) <
+          static_cast<uint32_t>(FLAGS_readwritepercent)) {
+        read_options.snapshot =
+            snapshots.empty() ? nullptr
+                              : snapshots[reads_done % snapshots.size()];
+        Status s = txn_db->Get(read_options, key, &value);
+        if (s.ok()) {
+          found++;
+        } else if (!s.IsNotFound()) {
+          fprintf(stderr, "get error: %s\n", s.ToString().c_str());
+        }
+        reads_done++;
+        thread->stats.FinishedOps(nullptr, db_.db, 1, kRead);
+        continue;
+      }
+
+      std::unique_ptr<Transaction> txn(
+          txn_db->BeginTransaction(write_options_, txn_options));
+      Status s = txn->SetName(std::to_string(thread->tid) + "-" +
+                              std::to_string(commits + aborts));
+      if (s.ok()) {
+        s = txn->Put(key, gen.Generate());
+      }
+      if (s.ok()) {
+        s = txn->Prepare();
+      }
+      if (s.ok()) {
+        s = txn->Commit();
+      }
+      if (s.ok()) {
+        commits++;
+      } else if (s.IsBusy() || s.IsTimedOut()) {
+        txn->Rollback().PermitUncheckedError();
+        aborts++;
+      } else {
+        fprintf(stderr, "two phase commit error: %s\n", s.ToString().c_str());
+        ErrorExit();
+      }
+      thread->stats.FinishedOps(nullptr, db_.db, 1, kWrite);
+    }
+
+    for (auto* snapshot : snapshots) {
+      txn_db->ReleaseSnapshot(snapshot);
+    }
+    char msg[100];
+    snprintf(msg, sizeof(msg),
+             "( commits:%" PRIi64 " aborts:%" PRIi64 " reads:%" PRIi64
+             " found:%" PRIi64 ")",
+             commits, aborts, reads_done, found);
+    thread->stats.AddMessage(msg);
+  }
+
   // Verifies consistency of data after RandomTransaction() has been run.
   // Since each iteration of RandomTransaction() incremented a key in each set
   // by the same value, the sum of the keys in each set should be the same.
@@ -7156,6 +8424,33 @@ class Benchmark {
     }
   }
 
+  void ReopenDB() {
+    if (db_.db == nullptr) {
+      fprintf(stderr, "open benchmark needs a single DB\n");
+      ErrorExit();
+    }
+    db_.DeleteDBs();
+    const uint64_t start_micros = FLAGS_env->NowMicros();
+    OpenDb(open_options_, FLAGS_db, &db_);
+    const uint64_t open_micros = FLAGS_env->NowMicros() - start_micros;
+    uint64_t num_files = 0;
+    uint64_t num_pending = 0;
+    for (int level = 0; level < db_.db->NumberLevels(); level++) {
+      std::string value;
+      if (db_.db->GetProperty(
+              DB::Properties::kNumFilesAtLevelPrefix + ToString(level),
+              &value)) {
+        num_files += ParseUint64(value);
+      }
+    }
+    db_.db->GetIntProperty(DB::Properties::kNumTableFilesPendingOpen,
+                           &num_pending);
+    fprintf(stdout,
+            "%-12s : %11.3f ms; %" PRIu64 " table files, %" PRIu64
+            " left to open in the background\n",
+            "open", open_micros / 1000.0, num_files, num_pending);
+  }
+
   void ResetStats() {
     if (db_.db != nullptr) {
       db_.db->ResetStats();
@@ -7205,6 +8500,20 @@ class Benchmark {
     for (const auto& db_with_cfh : multi_dbs_) {
       PrintStats(db_with_cfh.db, key, true);
     }
+    if (memory_governor_ != nullptr) {
+      MemoryGovernorStats stats;
+      memory_governor_->GetStats(&stats);
+      fprintf(stdout,
+              "Memory governor: write buffers %" ROCKSDB_PRIszt
+              "/%" ROCKSDB_PRIszt " block cache %" ROCKSDB_PRIszt
+              "/%" ROCKSDB_PRIszt " miss ratio %.3f, %" PRIu64
+              " rebalances, %" PRIu64 " moves to write buffers, %" PRIu64
+              " to block cache\n",
+              stats.write_buffer_usage, stats.write_buffer_share,
+              stats.block_cache_usage, stats.block_cache_share,
+              stats.block_cache_miss_ratio, stats.rebalances,
+              stats.moves_to_write_buffer, stats.moves_to_block_cache);
+    }
   }
 
   void PrintStats(DB* db, const char* key, bool print_header = false) {
@@ -7241,9 +8550,18 @@ class Benchmark {
                       std::move(trace_reader));
     replayer.SetFastForward(
         static_cast<uint32_t>(FLAGS_trace_replay_fast_forward));
-    s = replayer.MultiThreadReplay(
-        static_cast<uint32_t>(FLAGS_trace_replay_threads));
+    ReplayLatencies latencies;
+    if (FLAGS_trace_replay_sharded) {
+      s = replayer.ShardedReplay(
+          static_cast<uint32_t>(FLAGS_trace_replay_threads), &latencies);
+    } else {
+      s = replayer.MultiThreadReplay(
+          static_cast<uint32_t>(FLAGS_trace_replay_threads));
+    }
     if (s.ok()) {
+      if (FLAGS_trace_replay_sharded) {
+        fprintf(stdout, "%s", latencies.ToString().c_str());
+      }
       fprintf(stdout, "Replay started from trace_file: %s\n",
               FLAGS_trace_file.c_str());
     } else {
@@ -7281,12 +8599,17 @@ int db_bench_tool(int argc, char** argv) {
     }
   }
 #endif  // ROCKSDB_LITE
-  if (FLAGS_statistics) {
-    dbstats = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  if (FLAGS_statistics || FLAGS_report_zenfs_stats) {
+    dbstats = FLAGS_statistics_hdr_precision_bits != 0
+                  ? ROCKSDB_NAMESPACE::CreateDBStatisticsWithHdrHistograms(
+                        FLAGS_statistics_hdr_precision_bits)
+                  : ROCKSDB_NAMESPACE::CreateDBStatistics();
   }
   if (dbstats) {
     dbstats->set_stats_level(static_cast<StatsLevel>(FLAGS_stats_level));
   }
+  ROCKSDB_NAMESPACE::SetLockProfilingSampleOneIn(
+      static_cast<uint32_t>(std::max(FLAGS_lock_profiling_sample_one_in, 0)));
   FLAGS_compaction_pri_e =
       (ROCKSDB_NAMESPACE::CompactionPri)FLAGS_compaction_pri;
 
@@ -7303,6 +8626,8 @@ int db_bench_tool(int argc, char** argv) {
 
   FLAGS_compression_type_e =
     StringToCompressionType(FLAGS_compression_type.c_str());
+  FLAGS_blob_compression_type_e =
+      StringToCompressionType(FLAGS_blob_compression_type.c_str());
 
 #ifndef ROCKSDB_LITE
   FLAGS_blob_db_compression_type_e =
@@ -7329,9 +8654,26 @@ int db_bench_tool(int argc, char** argv) {
       fprintf(stderr, "Error: %s\n", s.ToString().c_str());
       exit(1);
     }
+    if (!FLAGS_fast_tier_path.empty()) {
+      fs = NewTieredFileSystem(FileSystem::Default(), FLAGS_fast_tier_path, fs,
+                               FLAGS_fast_tier_max_level);
+    }
+    if (FLAGS_hedged_read_percentile > 0.0) {
+      HedgedReadOptions hedged_options;
+      hedged_options.delay_percentile = FLAGS_hedged_read_percentile;
+      hedged_options.max_delay_us = FLAGS_hedged_read_max_delay_us;
+      hedged_options.min_delay_us = std::min(
+          hedged_options.min_delay_us, FLAGS_hedged_read_max_delay_us);
+      hedged_options.statistics = dbstats;
+      fs = NewHedgedReadFileSystem(fs, hedged_options);
+    }
     FLAGS_env = GetCompositeEnv(fs);
   }
 #endif  // ROCKSDB_LITE
+  if (FLAGS_write_zipf_theta < 0 || FLAGS_write_zipf_theta >= 1) {
+    fprintf(stderr, "--write_zipf_theta must be in [0, 1)\n");
+    exit(1);
+  }
   if (FLAGS_use_existing_keys && !FLAGS_use_existing_db) {
     fprintf(stderr,
             "`-use_existing_db` must be true for `-use_existing_keys` to be "
@@ -7369,6 +8711,8 @@ int db_bench_tool(int argc, char** argv) {
                                   ROCKSDB_NAMESPACE::Env::Priority::BOTTOM);
   FLAGS_env->SetBackgroundThreads(FLAGS_num_low_pri_threads,
                                   ROCKSDB_NAMESPACE::Env::Priority::LOW);
+  FLAGS_env->SetBackgroundThreads(FLAGS_num_user_pri_threads,
+                                  ROCKSDB_NAMESPACE::Env::Priority::USER);
 
   // Choose a location for the test database if none given with --db=<path>
   if (FLAGS_db.empty()) {
@@ -21,6 +21,12 @@ int main() {
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "tools/io_tracer_parser_tool.h"
+#include "trace_replay/io_tracer.h"
+#include "util/gflags_compat.h"
+
+DECLARE_bool(io_trace_analyze);
+DECLARE_string(io_trace_db_path);
+DECLARE_string(io_trace_output_dir);
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -76,9 +82,11 @@ class IOTracerParserTest : public testing::Test {
     ASSERT_OK(env_->FileExists(trace_file_path_));
   }
 
-  void RunIOTracerParserTool() {
+  void RunIOTracerParserTool(
+      const std::vector<std::string>& extra_params = {}) {
     std::vector<std::string> params = {"./io_tracer_parser",
                                        "-io_trace_file=" + trace_file_path_};
+    params.insert(params.end(), extra_params.begin(), extra_params.end());
 
     char arg_buffer[kArgBufferSize];
     char* argv[kMaxArgCount];
@@ -130,6 +138,77 @@ TEST_F(IOTracerParserTest, DumpAndParseIOTraceRecords) {
   RunIOTracerParserTool();
 }
 
+TEST_F(IOTracerParserTest, AnalyzeIOTraceRecords) {
+  GenerateIOTrace();
+  const std::string output_dir = test_path_ + "/heatmaps";
+  RunIOTracerParserTool({"-io_trace_analyze", "-io_trace_db_path=" + dbname_,
+                         "-io_trace_output_dir=" + output_dir});
+  FLAGS_io_trace_analyze = false;
+  FLAGS_io_trace_db_path = "";
+  FLAGS_io_trace_output_dir = "";
+
+  // The table files written are mapped to their levels
+  std::string level_heatmap;
+  ASSERT_OK(ReadFileToString(env_, output_dir + "/level.csv", &level_heatmap));
+  ASSERT_NE(level_heatmap.find("\nL"), std::string::npos);
+  ASSERT_NE(level_heatmap.find("\nwal,"), std::string::npos);
+  for (const auto& name : {"file.csv", "level.csv", "zone.csv"}) {
+    ASSERT_OK(env_->DeleteFile(output_dir + "/" + name));
+  }
+  ASSERT_OK(env_->DeleteDir(output_dir));
+}
+
+TEST_F(IOTracerParserTest, AnalyzerSplitsRequestsOverZones) {
+  const std::string layout_file = test_path_ + "/layout";
+  ASSERT_OK(WriteStringToFile(
+      env_,
+      "rocksdbtest/000010.sst\tsize: 8192\textents: 2\n"
+      "\tzone: 3\tstart: 0x3000\tlength: 4096\n"
+      "\tzone: 7\tstart: 0x7000\tlength: 4096\n"
+      "zone\twritten MB\tvalid MB\tvalid%\n",
+      layout_file));
+  IOTraceAnalyzer analyzer(1000 /* time_window_nanos */);
+  ASSERT_OK(analyzer.LoadZoneLayout(layout_file));
+  ASSERT_OK(env_->DeleteFile(layout_file));
+
+  const std::string fname = "/db/000010.sst";
+  analyzer.Add(IOTraceRecord(0, TraceType::kIOFileNameLenAndOffset, "Append",
+                             0, "OK", fname, 4096, 0));
+  analyzer.Add(IOTraceRecord(10, TraceType::kIOFileNameLenAndOffset, "Append",
+                             0, "OK", fname, 4096, 4096));
+  analyzer.Add(IOTraceRecord(2000, TraceType::kIOFileNameLenAndOffset, "Read",
+                             0, "OK", fname, 2048, 3072));
+  // No file name, so not analyzed
+  analyzer.Add(IOTraceRecord(2000, TraceType::kIOLenAndOffset, "Read", 0,
+                             "OK", 10, 0));
+
+  const std::string output_dir = test_path_ + "/heatmaps";
+  ASSERT_OK(analyzer.WriteHeatmaps(env_, output_dir));
+  std::string heatmap;
+  ASSERT_OK(ReadFileToString(env_, output_dir + "/zone.csv", &heatmap));
+  ASSERT_EQ(
+      "name,window,bytes_read,bytes_written\n"
+      "3,0,0,4096\n"
+      "3,2,1024,0\n"
+      "7,0,0,4096\n"
+      "7,2,1024,0\n",
+      heatmap);
+  ASSERT_OK(ReadFileToString(env_, output_dir + "/level.csv", &heatmap));
+  ASSERT_EQ(
+      "name,window,bytes_read,bytes_written\n"
+      "sst,0,0,8192\n"
+      "sst,2,2048,0\n",
+      heatmap);
+  std::string stats = analyzer.ToString();
+  ASSERT_NE(stats.find("Records analyzed: 3, skipped: 1"), std::string::npos);
+  ASSERT_NE(stats.find("Sequential bytes: 4096, random bytes: 4096"),
+            std::string::npos);
+  for (const auto& name : {"file.csv", "level.csv", "zone.csv"}) {
+    ASSERT_OK(env_->DeleteFile(output_dir + "/" + name));
+  }
+  ASSERT_OK(env_->DeleteDir(output_dir));
+}
+
 TEST_F(IOTracerParserTest, NoRecordingAfterEndIOTrace) {
   uint64_t file_size = 0;
   // Generate IO trace records and parse them.
@@ -7,24 +7,317 @@
 #ifdef GFLAGS
 #include "tools/io_tracer_parser_tool.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstdio>
 #include <iomanip>
 #include <memory>
 #include <sstream>
 
+#include "file/filename.h"
 #include "port/lang.h"
+#include "rocksdb/db.h"
 #include "trace_replay/io_tracer.h"
 #include "util/gflags_compat.h"
 
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 
 DEFINE_string(io_trace_file, "", "The IO trace file path.");
+DEFINE_bool(io_trace_analyze, false,
+            "Instead of printing the records, print the distribution of the "
+            "request sizes and the share of sequential requests, and build "
+            "heatmaps of the bytes read and written.");
+DEFINE_uint64(io_trace_time_window_secs, 1,
+              "The length of a time window of the heatmaps.");
+DEFINE_string(io_trace_db_path, "",
+              "If set, the table files are mapped to their levels in the DB "
+              "at this path, opened read only.");
+DEFINE_string(io_trace_zone_layout, "",
+              "If set, a file with the output of `zenfs dump-layout` to map "
+              "the file offsets to zones by.");
+DEFINE_string(io_trace_output_dir, "",
+              "If set, the heatmaps are written to file.csv, level.csv and "
+              "zone.csv in this directory.");
 
 namespace ROCKSDB_NAMESPACE {
 
-IOTraceRecordParser::IOTraceRecordParser(const std::string& input_file)
-    : input_file_(input_file) {}
+namespace {
+// How many of the most read and written files ToString() lists
+const size_t kNumTopFiles = 20;
+
+std::string BaseName(const std::string& fname) {
+  size_t pos = fname.rfind('/');
+  return pos == std::string::npos ? fname : fname.substr(pos + 1);
+}
+}  // namespace
+
+IOTraceAnalyzer::IOTraceAnalyzer(uint64_t time_window_nanos)
+    : time_window_nanos_(std::max<uint64_t>(time_window_nanos, 1)) {}
+
+Status IOTraceAnalyzer::LoadLevels(const std::string& db_path) {
+  Options options;
+  std::vector<std::string> cf_names;
+  Status s = DB::ListColumnFamilies(options, db_path, &cf_names);
+  if (!s.ok()) {
+    return s;
+  }
+  std::vector<ColumnFamilyDescriptor> cf_descs;
+  for (const auto& name : cf_names) {
+    cf_descs.emplace_back(name, ColumnFamilyOptions());
+  }
+  std::vector<ColumnFamilyHandle*> handles;
+  DB* db = nullptr;
+  s = DB::OpenForReadOnly(options, db_path, cf_descs, &handles, &db);
+  if (!s.ok()) {
+    return s;
+  }
+  std::vector<LiveFileMetaData> files;
+  db->GetLiveFilesMetaData(&files);
+  for (const auto& file : files) {
+    levels_[file.file_number] = file.level;
+  }
+  for (auto handle : handles) {
+    s = db->DestroyColumnFamilyHandle(handle);
+    if (!s.ok()) {
+      break;
+    }
+  }
+  delete db;
+  return s;
+}
+
+Status IOTraceAnalyzer::LoadZoneLayout(const std::string& layout_file) {
+  std::string data;
+  Status s = ReadFileToString(Env::Default(), layout_file, &data);
+  if (!s.ok()) {
+    return s;
+  }
+  // A line of "<file name>\tsize: N\textents: M" per file, followed by a
+  // line of "\tzone: Z\tstart: 0x..\tlength: L" per extent
+  std::istringstream lines(data);
+  std::string line;
+  std::vector<Extent>* extents = nullptr;
+  uint64_t file_offset = 0;
+  while (std::getline(lines, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    if (line[0] != '\t') {
+      size_t pos = line.find("\tsize: ");
+      if (pos == std::string::npos) {
+        // The zone table that follows the files
+        extents = nullptr;
+        continue;
+      }
+      extents = &layout_[BaseName(line.substr(0, pos))];
+      extents->clear();
+      file_offset = 0;
+      continue;
+    }
+    int zone = 0;
+    unsigned long long start = 0;
+    unsigned long long length = 0;
+    if (extents == nullptr ||
+        sscanf(line.c_str(), "\tzone: %d\tstart: 0x%llx\tlength: %llu",
+               &zone, &start, &length) != 3) {
+      return Status::Corruption("Bad zone layout line", line);
+    }
+    extents->push_back({file_offset, length, zone});
+    file_offset += length;
+  }
+  return Status::OK();
+}
+
+std::string IOTraceAnalyzer::LevelOf(const std::string& base_name) const {
+  uint64_t number = 0;
+  FileType type;
+  if (!ParseFileName(base_name, &number, &type)) {
+    return "other";
+  }
+  switch (type) {
+    case kWalFile:
+      return "wal";
+    case kDescriptorFile:
+      return "manifest";
+    case kBlobFile:
+      return "blob";
+    case kTableFile: {
+      auto it = levels_.find(number);
+      if (it == levels_.end()) {
+        // Deleted, or no DB to look the levels up in
+        return "sst";
+      }
+      return "L" + std::to_string(it->second);
+    }
+    default:
+      return "other";
+  }
+}
+
+void IOTraceAnalyzer::AddBytes(Heatmap* heatmap, const std::string& name,
+                               uint64_t window, OpKind kind, uint64_t bytes) {
+  Bytes& b = (*heatmap)[name][window];
+  if (kind == kRead) {
+    b.read += bytes;
+  } else {
+    b.written += bytes;
+  }
+}
+
+void IOTraceAnalyzer::Add(const IOTraceRecord& record) {
+  if (record.trace_type != TraceType::kIOFileNameLenAndOffset) {
+    num_skipped_++;
+    return;
+  }
+  const std::string& op = record.file_operation;
+  OpKind kind;
+  if (op.find("Read") != std::string::npos || op == "Prefetch") {
+    kind = kRead;
+  } else if (op.find("Append") != std::string::npos || op == "Write") {
+    kind = kWrite;
+  } else {
+    num_skipped_++;
+    return;
+  }
+  if (num_records_++ == 0) {
+    start_time_ = record.access_timestamp;
+  }
+  // Records may come slightly out of order from concurrent threads
+  const uint64_t timestamp = std::max(start_time_, record.access_timestamp);
+  const uint64_t window = (timestamp - start_time_) / time_window_nanos_;
+  const std::string name = BaseName(record.file_name);
+
+  request_sizes_[kind].Add(record.len);
+  FileStats& stats = files_[name];
+  // Sequential if it starts where the last one of its kind on the file ended
+  if (stats.seen[kind] && stats.next_offset[kind] == record.offset) {
+    stats.sequential_requests[kind]++;
+    sequential_bytes_[kind] += record.len;
+  } else {
+    stats.random_requests[kind]++;
+    random_bytes_[kind] += record.len;
+  }
+  stats.seen[kind] = true;
+  stats.next_offset[kind] = record.offset + record.len;
+
+  AddBytes(&file_heatmap_, name, window, kind, record.len);
+  AddBytes(&level_heatmap_, LevelOf(name), window, kind, record.len);
+
+  auto layout = layout_.find(name);
+  if (layout == layout_.end()) {
+    return;
+  }
+  // Split the request over the extents it spans
+  const uint64_t end = record.offset + record.len;
+  for (const auto& extent : layout->second) {
+    uint64_t from = std::max(record.offset, extent.file_offset);
+    uint64_t to = std::min(end, extent.file_offset + extent.length);
+    if (from < to) {
+      AddBytes(&zone_heatmap_, std::to_string(extent.zone), window, kind,
+               to - from);
+    }
+  }
+}
+
+std::string IOTraceAnalyzer::ToString() const {
+  static const char* kOpKindNames[kNumOpKinds] = {"Reads", "Writes"};
+  std::ostringstream ss;
+  ss << "Records analyzed: " << num_records_
+     << ", skipped: " << num_skipped_ << "\n";
+  for (int kind = 0; kind < kNumOpKinds; kind++) {
+    ss << "\n" << kOpKindNames[kind] << "\n"
+       << "Sequential bytes: " << sequential_bytes_[kind]
+       << ", random bytes: " << random_bytes_[kind] << "\n"
+       << "Request sizes:\n"
+       << request_sizes_[kind].ToString();
+  }
+
+  struct Total {
+    std::string name;
+    Bytes bytes;
+  };
+  auto totals = [](const Heatmap& heatmap) {
+    std::vector<Total> result;
+    for (const auto& row : heatmap) {
+      Total total{row.first, Bytes()};
+      for (const auto& cell : row.second) {
+        total.bytes.read += cell.second.read;
+        total.bytes.written += cell.second.written;
+      }
+      result.push_back(total);
+    }
+    return result;
+  };
+
+  ss << "\nBytes by level\n";
+  for (const auto& total : totals(level_heatmap_)) {
+    ss << std::setw(10) << std::left << total.name
+       << " read: " << std::setw(14) << total.bytes.read
+       << " written: " << total.bytes.written << "\n";
+  }
+  if (!zone_heatmap_.empty()) {
+    ss << "\nBytes by zone\n";
+    for (const auto& total : totals(zone_heatmap_)) {
+      ss << std::setw(10) << std::left << total.name
+         << " read: " << std::setw(14) << total.bytes.read
+         << " written: " << total.bytes.written << "\n";
+    }
+  }
+
+  std::vector<Total> files = totals(file_heatmap_);
+  std::sort(files.begin(), files.end(), [](const Total& a, const Total& b) {
+    return a.bytes.read + a.bytes.written > b.bytes.read + b.bytes.written;
+  });
+  if (files.size() > kNumTopFiles) {
+    files.resize(kNumTopFiles);
+  }
+  ss << "\nMost read and written files\n";
+  for (const auto& total : files) {
+    const FileStats& stats = files_.at(total.name);
+    uint64_t sequential =
+        stats.sequential_requests[kRead] + stats.sequential_requests[kWrite];
+    uint64_t requests = sequential + stats.random_requests[kRead] +
+                        stats.random_requests[kWrite];
+    ss << std::setw(24) << std::left << total.name
+       << " read: " << std::setw(14) << total.bytes.read
+       << " written: " << std::setw(14) << total.bytes.written
+       << " sequential: " << (requests ? 100 * sequential / requests : 0)
+       << "%\n";
+  }
+  return ss.str();
+}
+
+Status IOTraceAnalyzer::WriteHeatmap(Env* env, const std::string& fname,
+                                     const Heatmap& heatmap) {
+  std::ostringstream ss;
+  ss << "name,window,bytes_read,bytes_written\n";
+  for (const auto& row : heatmap) {
+    for (const auto& cell : row.second) {
+      ss << row.first << "," << cell.first << "," << cell.second.read << ","
+         << cell.second.written << "\n";
+    }
+  }
+  return WriteStringToFile(env, ss.str(), fname);
+}
+
+Status IOTraceAnalyzer::WriteHeatmaps(Env* env,
+                                      const std::string& output_dir) const {
+  Status s = env->CreateDirIfMissing(output_dir);
+  if (s.ok()) {
+    s = WriteHeatmap(env, output_dir + "/file.csv", file_heatmap_);
+  }
+  if (s.ok()) {
+    s = WriteHeatmap(env, output_dir + "/level.csv", level_heatmap_);
+  }
+  if (s.ok()) {
+    s = WriteHeatmap(env, output_dir + "/zone.csv", zone_heatmap_);
+  }
+  return s;
+}
+
+IOTraceRecordParser::IOTraceRecordParser(const std::string& input_file,
+                                         IOTraceAnalyzer* analyzer)
+    : input_file_(input_file), analyzer_(analyzer) {}
 
 void IOTraceRecordParser::PrintHumanReadableHeader(
     const IOTraceHeader& header) {
@@ -56,6 +349,9 @@ void IOTraceRecordParser::PrintHumanReadableIOTraceRecord(
       }
       break;
     }
+    case TraceType::kIOFileNameLenAndOffset:
+      ss << ", File Name: " << record.file_name.c_str();
+      FALLTHROUGH_INTENDED;
     case TraceType::kIOLenAndOffset:
       ss << ", Offset: " << record.offset;
       FALLTHROUGH_INTENDED;
@@ -89,7 +385,9 @@ int IOTraceRecordParser::ReadIOTraceRecords() {
     fprintf(stderr, "%s: %s\n", input_file_.c_str(), status.ToString().c_str());
     return 1;
   }
-  PrintHumanReadableHeader(header);
+  if (analyzer_ == nullptr) {
+    PrintHumanReadableHeader(header);
+  }
 
   // Read the records one by one and print them in human readable format.
   while (status.ok()) {
@@ -98,7 +396,11 @@ int IOTraceRecordParser::ReadIOTraceRecords() {
     if (!status.ok()) {
       break;
     }
-    PrintHumanReadableIOTraceRecord(record);
+    if (analyzer_ != nullptr) {
+      analyzer_->Add(record);
+    } else {
+      PrintHumanReadableIOTraceRecord(record);
+    }
   }
   return 0;
 }
@@ -111,8 +413,37 @@ int io_tracer_parser(int argc, char** argv) {
     return 1;
   }
 
-  IOTraceRecordParser io_tracer_parser(FLAGS_io_trace_file);
-  return io_tracer_parser.ReadIOTraceRecords();
+  if (!FLAGS_io_trace_analyze) {
+    IOTraceRecordParser io_tracer_parser(FLAGS_io_trace_file);
+    return io_tracer_parser.ReadIOTraceRecords();
+  }
+
+  IOTraceAnalyzer analyzer(FLAGS_io_trace_time_window_secs * 1000000000);
+  Status s;
+  if (!FLAGS_io_trace_db_path.empty()) {
+    s = analyzer.LoadLevels(FLAGS_io_trace_db_path);
+  }
+  if (s.ok() && !FLAGS_io_trace_zone_layout.empty()) {
+    s = analyzer.LoadZoneLayout(FLAGS_io_trace_zone_layout);
+  }
+  if (!s.ok()) {
+    fprintf(stderr, "%s\n", s.ToString().c_str());
+    return 1;
+  }
+  IOTraceRecordParser io_tracer_parser(FLAGS_io_trace_file, &analyzer);
+  int ret = io_tracer_parser.ReadIOTraceRecords();
+  if (ret != 0) {
+    return ret;
+  }
+  fprintf(stdout, "%s", analyzer.ToString().c_str());
+  if (!FLAGS_io_trace_output_dir.empty()) {
+    s = analyzer.WriteHeatmaps(Env::Default(), FLAGS_io_trace_output_dir);
+    if (!s.ok()) {
+      fprintf(stderr, "%s\n", s.ToString().c_str());
+      return 1;
+    }
+  }
+  return 0;
 }
 
 }  // namespace ROCKSDB_NAMESPACE
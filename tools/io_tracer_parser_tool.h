@@ -6,8 +6,13 @@
 #ifndef ROCKSDB_LITE
 #pragma once
 
+#include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
+#include "monitoring/histogram.h"
 #include "rocksdb/env.h"
 #include "rocksdb/status.h"
 
@@ -15,12 +20,15 @@ namespace ROCKSDB_NAMESPACE {
 
 struct IOTraceHeader;
 struct IOTraceRecord;
+class IOTraceAnalyzer;
 
 // IOTraceRecordParser class reads the IO trace file (in binary format) and
-// dumps the human readable records in output_file_.
+// dumps the human readable records in output_file_, or passes them to
+// analyzer if there is one.
 class IOTraceRecordParser {
  public:
-  explicit IOTraceRecordParser(const std::string& input_file);
+  explicit IOTraceRecordParser(const std::string& input_file,
+                               IOTraceAnalyzer* analyzer = nullptr);
 
   // ReadIOTraceRecords reads the binary trace file records one by one and
   // invoke PrintHumanReadableIOTraceRecord to dump the records in output_file_.
@@ -32,6 +40,79 @@ class IOTraceRecordParser {
 
   // Binary file that contains IO trace records.
   std::string input_file_;
+  IOTraceAnalyzer* analyzer_;
+};
+
+// IOTraceAnalyzer aggregates the reads and writes of an IO trace, the
+// records that carry a file name, offset and length, into the distribution
+// of the request sizes, the share of sequential requests, and heatmaps of
+// the bytes read and written over time per file, per LSM level and, given
+// the layout of the files in ZenFS, per zone.
+class IOTraceAnalyzer {
+ public:
+  explicit IOTraceAnalyzer(uint64_t time_window_nanos);
+
+  // Maps the table files of the DB at db_path to their levels. The files
+  // not in the DB any more, and the others, are told apart by file type.
+  Status LoadLevels(const std::string& db_path);
+
+  // Reads the layout of the files in zones, as dumped by
+  // `zenfs dump-layout`.
+  Status LoadZoneLayout(const std::string& layout_file);
+
+  void Add(const IOTraceRecord& record);
+
+  std::string ToString() const;
+
+  // Writes the heatmaps to file.csv, level.csv and zone.csv in output_dir,
+  // a line of name,window,bytes_read,bytes_written each
+  Status WriteHeatmaps(Env* env, const std::string& output_dir) const;
+
+ private:
+  enum OpKind { kRead = 0, kWrite, kNumOpKinds };
+
+  struct Bytes {
+    uint64_t read = 0;
+    uint64_t written = 0;
+  };
+  // Bytes by time window, by name
+  typedef std::map<std::string, std::map<uint64_t, Bytes>> Heatmap;
+
+  struct FileStats {
+    uint64_t sequential_requests[kNumOpKinds] = {0, 0};
+    uint64_t random_requests[kNumOpKinds] = {0, 0};
+    // Where the last request of each kind ended
+    uint64_t next_offset[kNumOpKinds] = {0, 0};
+    bool seen[kNumOpKinds] = {false, false};
+  };
+
+  struct Extent {
+    uint64_t file_offset;  // Of the start of the extent
+    uint64_t length;
+    int zone;
+  };
+
+  std::string LevelOf(const std::string& base_name) const;
+  static void AddBytes(Heatmap* heatmap, const std::string& name,
+                       uint64_t window, OpKind kind, uint64_t bytes);
+  static Status WriteHeatmap(Env* env, const std::string& fname,
+                             const Heatmap& heatmap);
+
+  const uint64_t time_window_nanos_;
+  uint64_t start_time_ = 0;
+  uint64_t num_records_ = 0;
+  uint64_t num_skipped_ = 0;
+  HistogramImpl request_sizes_[kNumOpKinds];
+  uint64_t sequential_bytes_[kNumOpKinds] = {0, 0};
+  uint64_t random_bytes_[kNumOpKinds] = {0, 0};
+  std::unordered_map<std::string, FileStats> files_;
+  // Level by table file number
+  std::unordered_map<uint64_t, int> levels_;
+  // Extents by file base name, in file order
+  std::unordered_map<std::string, std::vector<Extent>> layout_;
+  Heatmap file_heatmap_;
+  Heatmap level_heatmap_;
+  Heatmap zone_heatmap_;
 };
 
 int io_tracer_parser(int argc, char** argv);
@@ -197,6 +197,10 @@ LDBCommand* LDBCommand::SelectCommand(const ParsedParams& parsed_params) {
   } else if (parsed_params.cmd == ApproxSizeCommand::Name()) {
     return new ApproxSizeCommand(parsed_params.cmd_params,
                                  parsed_params.option_map, parsed_params.flags);
+  } else if (parsed_params.cmd == KeyDistributionCommand::Name()) {
+    return new KeyDistributionCommand(parsed_params.cmd_params,
+                                      parsed_params.option_map,
+                                      parsed_params.flags);
   } else if (parsed_params.cmd == DBQuerierCommand::Name()) {
     return new DBQuerierCommand(parsed_params.cmd_params,
                                 parsed_params.option_map, parsed_params.flags);
@@ -2438,6 +2442,47 @@ void ApproxSizeCommand::DoCommand() {
 
 // ----------------------------------------------------------------------------
 
+const std::string KeyDistributionCommand::ARG_LEVEL = "level";
+
+KeyDistributionCommand::KeyDistributionCommand(
+    const std::vector<std::string>& /*params*/,
+    const std::map<std::string, std::string>& options,
+    const std::vector<std::string>& flags)
+    : LDBCommand(options, flags, true, BuildCmdLineOptions({ARG_LEVEL})) {
+  if (ParseIntOption(options, ARG_LEVEL, level_, exec_state_) &&
+      level_ < 0) {
+    exec_state_ = LDBCommandExecuteResult::Failed(
+        ARG_LEVEL + " must be non-negative for key_distribution command");
+  }
+}
+
+void KeyDistributionCommand::Help(std::string& ret) {
+  ret.append("  ");
+  ret.append(KeyDistributionCommand::Name());
+  ret.append(" [--" + ARG_LEVEL + "=<N>]");
+  ret.append("\n");
+}
+
+void KeyDistributionCommand::DoCommand() {
+  if (!db_) {
+    assert(GetExecuteState().IsFailed());
+    return;
+  }
+  std::string property = DB::Properties::kKeyDistribution;
+  if (level_ >= 0) {
+    property = DB::Properties::kKeyDistributionAtLevel + ToString(level_);
+  }
+  std::string value;
+  if (!db_->GetProperty(GetCfHandle(), property, &value)) {
+    exec_state_ =
+        LDBCommandExecuteResult::Failed("Failed to get " + property + ".");
+    return;
+  }
+  fprintf(stdout, "%s", value.c_str());
+}
+
+// ----------------------------------------------------------------------------
+
 BatchPutCommand::BatchPutCommand(
     const std::vector<std::string>& params,
     const std::map<std::string, std::string>& options,
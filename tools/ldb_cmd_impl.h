@@ -350,6 +350,25 @@ class ApproxSizeCommand : public LDBCommand {
   std::string end_key_;
 };
 
+class KeyDistributionCommand : public LDBCommand {
+ public:
+  static std::string Name() { return "key_distribution"; }
+
+  KeyDistributionCommand(const std::vector<std::string>& params,
+                         const std::map<std::string, std::string>& options,
+                         const std::vector<std::string>& flags);
+
+  virtual void DoCommand() override;
+
+  static void Help(std::string& ret);
+
+ private:
+  static const std::string ARG_LEVEL;
+
+  // Of all the levels if negative
+  int level_ = -1;
+};
+
 class BatchPutCommand : public LDBCommand {
  public:
   static std::string Name() { return "batchput"; }
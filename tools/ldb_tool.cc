@@ -74,6 +74,7 @@ void LDBCommandRunner::PrintHelp(const LDBOptions& ldb_options,
   DeleteRangeCommand::Help(ret);
   DBQuerierCommand::Help(ret);
   ApproxSizeCommand::Help(ret);
+  KeyDistributionCommand::Help(ret);
   CheckConsistencyCommand::Help(ret);
   ListFileRangeDeletesCommand::Help(ret);
 
@@ -306,6 +306,41 @@ TEST_F(SSTDumpToolTest, ReadaheadSize) {
   }
 }
 
+TEST_F(SSTDumpToolTest, ParallelRateLimitedVerify) {
+  Options opts;
+  opts.env = env();
+  std::vector<std::string> file_paths;
+  for (int i = 0; i < 3; i++) {
+    file_paths.push_back(
+        MakeFilePath("rocksdb_sst_test" + ToString(i) + ".sst"));
+    createSST(opts, file_paths.back());
+  }
+
+  char* usage[5];
+  PopulateCommandArgs(MakeFilePath(""), "--command=verify", usage);
+  snprintf(usage[3], kOptLength, "--verify_threads=3");
+  snprintf(usage[4], kOptLength, "--rate_limit_bytes_per_sec=1000000000");
+
+  std::atomic<int> num_reads(0);
+  SyncPoint::GetInstance()->SetCallBack("RandomAccessFileReader::Read",
+                                        [&](void*) { num_reads++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  SSTDumpTool tool;
+  ASSERT_TRUE(!tool.Run(5, usage, opts));
+  ASSERT_GT(num_reads.load(), 3);
+
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  SyncPoint::GetInstance()->DisableProcessing();
+
+  for (const auto& file_path : file_paths) {
+    cleanup(opts, file_path);
+  }
+  for (int i = 0; i < 5; i++) {
+    delete[] usage[i];
+  }
+}
+
 TEST_F(SSTDumpToolTest, NoSstFile) {
   Options opts;
   opts.env = env();
@@ -7,12 +7,18 @@
 
 #include "rocksdb/sst_dump_tool.h"
 
+#include <atomic>
 #include <cinttypes>
+#include <functional>
 #include <iostream>
 
+#include "env/composite_env_wrapper.h"
+#include "file/file_util.h"
 #include "port/port.h"
+#include "rocksdb/rate_limiter.h"
 #include "rocksdb/utilities/ldb_cmd.h"
 #include "table/sst_file_dumper.h"
+#include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -103,6 +109,16 @@ void print_help(bool to_stderr) {
 
     --compression_zstd_max_train_bytes=<uint32_t>
       Maximum size of training data passed to zstd's dictionary trainer
+
+    --readahead_size=<num>
+      Readahead size of the reads of the files, 2MB by default
+
+    --verify_threads=<num>
+      Number of threads verifying the files in parallel with --command=verify
+
+    --rate_limit_bytes_per_sec=<num>
+      Limit on the bytes read from the files per second, 0 (the default)
+      meaning none
 )");
 }
 
@@ -154,6 +170,8 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
   std::string compression_level_to_str;
   size_t block_size = 0;
   size_t readahead_size = 2 * 1024 * 1024;
+  int verify_threads = 1;
+  int64_t rate_limit_bytes_per_sec = 0;
   std::vector<std::pair<CompressionType, const char*>> compression_types;
   uint64_t total_num_files = 0;
   uint64_t total_num_data_blocks = 0;
@@ -207,6 +225,18 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
     } else if (ParseIntArg(argv[i], "--readahead_size=",
                            "readahead_size must be numeric", &tmp_val)) {
       readahead_size = static_cast<size_t>(tmp_val);
+    } else if (ParseIntArg(argv[i], "--verify_threads=",
+                           "verify_threads must be numeric", &tmp_val)) {
+      if (tmp_val < 1) {
+        fprintf(stderr, "verify_threads must be positive: '%s'\n", argv[i]);
+        print_help(/*to_stderr*/ true);
+        return 1;
+      }
+      verify_threads = static_cast<int>(tmp_val);
+    } else if (ParseIntArg(argv[i], "--rate_limit_bytes_per_sec=",
+                           "rate_limit_bytes_per_sec must be numeric",
+                           &tmp_val)) {
+      rate_limit_bytes_per_sec = tmp_val;
     } else if (strncmp(argv[i], "--compression_types=", 20) == 0) {
       std::string compression_types_csv = argv[i] + 20;
       std::istringstream iss(compression_types_csv);
@@ -337,6 +367,17 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
     fprintf(stdout, "options.env is %p\n", options.env);
   }
 
+  std::unique_ptr<Env> rate_limited_env;
+  if (rate_limit_bytes_per_sec > 0) {
+    std::shared_ptr<RateLimiter> rate_limiter(NewGenericRateLimiter(
+        rate_limit_bytes_per_sec, 100 * 1000 /* refill_period_us */,
+        10 /* fairness */, RateLimiter::Mode::kReadsOnly));
+    rate_limited_env.reset(new CompositeEnvWrapper(
+        options.env, NewReadRateLimitedFileSystem(
+                         options.env->GetFileSystem(), rate_limiter)));
+    options.env = rate_limited_env.get();
+  }
+
   std::vector<std::string> filenames;
   ROCKSDB_NAMESPACE::Env* env = options.env;
   ROCKSDB_NAMESPACE::Status st = env->GetChildren(dir_or_file, &filenames);
@@ -364,6 +405,55 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
   uint64_t total_read = 0;
   // List of RocksDB SST file without corruption
   std::vector<std::string> valid_sst_files;
+
+  if (command == "verify" && verify_threads > 1) {
+    std::vector<std::string> sst_files;
+    for (const auto& filename : filenames) {
+      if (filename.length() > 4 &&
+          filename.rfind(".sst") == filename.length() - 4) {
+        sst_files.push_back(dir ? std::string(dir_or_file) + "/" + filename
+                                : filename);
+      }
+    }
+    port::Mutex mu;
+    std::atomic<size_t> next_file(0);
+    std::function<void()> verify = [&]() {
+      for (size_t i = next_file.fetch_add(1); i < sst_files.size();
+           i = next_file.fetch_add(1)) {
+        const std::string& filename = sst_files[i];
+        ROCKSDB_NAMESPACE::SstFileDumper dumper(options, filename,
+                                                readahead_size, verify_checksum,
+                                                output_hex, decode_blob_index);
+        Status s = dumper.getStatus();
+        bool valid = s.ok();
+        if (valid) {
+          s = dumper.VerifyChecksum();
+        }
+        MutexLock l(&mu);
+        if (!valid) {
+          fprintf(stderr, "%s: %s\n", filename.c_str(), s.ToString().c_str());
+          continue;
+        }
+        valid_sst_files.push_back(filename);
+        if (!s.ok()) {
+          fprintf(stderr, "%s is corrupted: %s\n", filename.c_str(),
+                  s.ToString().c_str());
+        } else {
+          fprintf(stdout, "%s is ok\n", filename.c_str());
+        }
+      }
+    };
+    std::vector<port::Thread> threads;
+    for (int t = 1; t < verify_threads; t++) {
+      threads.emplace_back(verify);
+    }
+    verify();
+    for (auto& t : threads) {
+      t.join();
+    }
+    // All verified
+    filenames.clear();
+  }
   for (size_t i = 0; i < filenames.size(); i++) {
     std::string filename = filenames.at(i);
     if (filename.length() <= 4 ||
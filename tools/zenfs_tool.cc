@@ -6,7 +6,11 @@
 
 #if defined(GFLAGS) && !defined(ROCKSDB_LITE) && defined(LIBZBD)
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <thread>
 
 #include "env/fs_zenfs.h"
 #include "util/gflags_compat.h"
@@ -14,12 +18,41 @@ using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 using GFLAGS_NAMESPACE::RegisterFlagValidator;
 using GFLAGS_NAMESPACE::SetUsageMessage;
 
-DEFINE_string(zbd, "", "Path to a zoned block device.");
+DEFINE_string(zbd, "",
+              "Path to a zoned block device, or emu:<file>[?options] for a "
+              "file backed emulated device. A comma separated list spans "
+              "several devices, always give them in the same order.");
 DEFINE_string(aux_path, "",
               "Path for auxiliary file storage (log and lock files).");
 DEFINE_bool(force, false, "Force file system creation.");
 DEFINE_string(path, "", "Path to directory to list files under");
 DEFINE_int32(finish_threshold, 0, "Finish used zones if less than x% left");
+DEFINE_int32(streaming_buffer_mb, 0,
+             "Start writing compaction outputs once this many MB are buffered, "
+             "placing them by the compaction's key range. 0 buffers whole "
+             "files until their key range is known.");
+DEFINE_string(gc_policy, "greedy",
+              "Zone cleaning victim policy: greedy, cost-benefit or "
+              "compaction-aware");
+DEFINE_int32(stripe_width, 1,
+             "Number of zones an SST is written to in parallel, bounded by "
+             "the open zone limit of the device");
+DEFINE_int32(read_cache_mb, 0,
+             "DRAM cache for small reads from frequently read zones, in MB. "
+             "0 disables it.");
+DEFINE_int32(buffer_pool_mb, 0,
+             "Budget of the aligned buffers reused for writes, in MB. 0 "
+             "keeps the default.");
+DEFINE_bool(wal_data_sync, false,
+            "WAL syncs write the data only, the synced length is found from "
+            "the zone write pointer on mount instead of a metadata update "
+            "per sync");
+DEFINE_int32(mount_iterations, 5, "Number of mounts timed by benchmark-mount");
+DEFINE_string(backup_path, "",
+              "POSIX directory files are copied to by backup and from by "
+              "restore");
+DEFINE_int32(jobs, 8, "Number of files backup and restore copy in parallel");
+DEFINE_int32(io_size_mb, 4, "Size of the reads issued by backup and restore");
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -58,6 +91,18 @@ int zenfs_tool_mkfs() {
     return 1;
   }
 
+  uint32_t gc_policy;
+  if (FLAGS_gc_policy == "greedy") {
+    gc_policy = kGCGreedy;
+  } else if (FLAGS_gc_policy == "cost-benefit") {
+    gc_policy = kGCCostBenefit;
+  } else if (FLAGS_gc_policy == "compaction-aware") {
+    gc_policy = kGCCompactionAware;
+  } else {
+    fprintf(stderr, "Unknown --gc_policy: %s\n", FLAGS_gc_policy.c_str());
+    return 1;
+  }
+
   ZonedBlockDevice *zbd = zbd_open();
   if (zbd == nullptr) return 1;
 
@@ -77,7 +122,10 @@ int zenfs_tool_mkfs() {
 
   if (FLAGS_aux_path.back() != '/') FLAGS_aux_path.append("/");
 
-  s = zenFS->MkFS(FLAGS_aux_path, FLAGS_finish_threshold);
+  s = zenFS->MkFS(FLAGS_aux_path, FLAGS_finish_threshold,
+                  FLAGS_streaming_buffer_mb, gc_policy, FLAGS_stripe_width,
+                  FLAGS_read_cache_mb, FLAGS_buffer_pool_mb,
+                  FLAGS_wal_data_sync ? 1 : 0);
   if (!s.ok()) {
     fprintf(stderr, "Failed to create file system, error: %s\n",
             s.ToString().c_str());
@@ -150,6 +198,311 @@ int zenfs_tool_df() {
   return 0;
 }
 
+int zenfs_tool_benchmark_mount() {
+  Status s;
+  double total_ms = 0, min_ms = 0, max_ms = 0;
+
+  if (FLAGS_mount_iterations <= 0) {
+    fprintf(stderr, "--mount_iterations must be positive\n");
+    return 1;
+  }
+
+  for (int i = 0; i < FLAGS_mount_iterations; i++) {
+    ZonedBlockDevice *zbd = zbd_open();
+    if (zbd == nullptr) return 1;
+
+    ZenFS *zenFS;
+    auto start = std::chrono::steady_clock::now();
+    s = zenfs_mount(zbd, &zenFS);
+    auto end = std::chrono::steady_clock::now();
+    if (!s.ok()) {
+      fprintf(stderr, "Failed to mount filesystem, error: %s\n",
+              s.ToString().c_str());
+      return 1;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    fprintf(stdout, "Mount %d: %.1f ms\n", i, ms);
+    total_ms += ms;
+    if (i == 0 || ms < min_ms) min_ms = ms;
+    if (i == 0 || ms > max_ms) max_ms = ms;
+
+    delete zenFS;
+  }
+
+  fprintf(stdout, "Mounts: %d\nAverage: %.1f ms\nMin: %.1f ms\nMax: %.1f ms\n",
+          FLAGS_mount_iterations, total_ms / FLAGS_mount_iterations, min_ms,
+          max_ms);
+  return 0;
+}
+
+/* Copy of src in fs_src to dst in fs_dst, size bytes long */
+struct CopyJob {
+  std::string src_;
+  std::string dst_;
+  uint64_t size_;
+};
+
+IOStatus copy_file(FileSystem *fs_src, FileSystem *fs_dst, const CopyJob &job,
+                   char *buf, size_t buf_sz) {
+  std::unique_ptr<FSRandomAccessFile> src;
+  std::unique_ptr<FSWritableFile> dst;
+  FileOptions src_opts;
+  uint64_t offset = 0;
+  IOStatus s;
+
+  /* Not every POSIX file system supports O_DIRECT */
+  src_opts.use_direct_reads = true;
+  s = fs_src->NewRandomAccessFile(job.src_, src_opts, &src, nullptr);
+  if (!s.ok()) {
+    src_opts.use_direct_reads = false;
+    s = fs_src->NewRandomAccessFile(job.src_, src_opts, &src, nullptr);
+  }
+  if (!s.ok()) return s;
+
+  s = fs_dst->NewWritableFile(job.dst_, FileOptions(), &dst, nullptr);
+  if (!s.ok()) return s;
+
+  while (offset < job.size_) {
+    Slice result;
+    s = src->Read(offset, buf_sz, IOOptions(), &result, buf, nullptr);
+    if (!s.ok()) return s;
+    if (result.size() == 0) break;
+
+    size_t n = std::min<uint64_t>(result.size(), job.size_ - offset);
+    s = dst->Append(Slice(result.data(), n), IOOptions(), nullptr);
+    if (!s.ok()) return s;
+    offset += n;
+  }
+  if (offset != job.size_)
+    return IOStatus::Corruption("Short read of " + job.src_);
+
+  s = dst->Fsync(IOOptions(), nullptr);
+  if (!s.ok()) return s;
+  return dst->Close(IOOptions(), nullptr);
+}
+
+/* Copies the files with --jobs threads, largest first so the big files do
+ * not start last. Every thread reads --io_size_mb at a time into its own
+ * buffer aligned for direct reads. Returns the number of failed copies */
+int copy_files(FileSystem *fs_src, FileSystem *fs_dst,
+               std::vector<CopyJob> &jobs, uint32_t block_sz) {
+  std::atomic<size_t> next(0);
+  std::atomic<int> failed(0);
+  std::atomic<uint64_t> copied(0);
+  std::vector<std::thread> threads;
+  size_t buf_sz;
+  int nr_threads;
+
+  std::sort(jobs.begin(), jobs.end(), [](const CopyJob &a, const CopyJob &b) {
+    return a.size_ > b.size_;
+  });
+
+  buf_sz = (uint64_t)FLAGS_io_size_mb * 1024 * 1024;
+  buf_sz = std::max<size_t>(buf_sz - buf_sz % block_sz, block_sz);
+  nr_threads = std::min<int>(FLAGS_jobs, jobs.size());
+
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < nr_threads; t++) {
+    threads.emplace_back([&]() {
+      char *buf;
+      if (posix_memalign((void **)&buf, block_sz, buf_sz)) {
+        fprintf(stderr, "Failed to allocate a copy buffer\n");
+        failed++;
+        return;
+      }
+      for (size_t i = next++; i < jobs.size(); i = next++) {
+        IOStatus s = copy_file(fs_src, fs_dst, jobs[i], buf, buf_sz);
+        if (!s.ok()) {
+          fprintf(stderr, "Failed to copy %s to %s, error: %s\n",
+                  jobs[i].src_.c_str(), jobs[i].dst_.c_str(),
+                  s.ToString().c_str());
+          failed++;
+          continue;
+        }
+        copied += jobs[i].size_;
+      }
+      free(buf);
+    });
+  }
+  for (auto &t : threads) t.join();
+  auto end = std::chrono::steady_clock::now();
+
+  double secs = std::chrono::duration<double>(end - start).count();
+  if (secs <= 0) secs = 1e-9;
+  fprintf(stdout, "Copied %lu files, %lu MB in %.1f s (%.1f MB/s)\n",
+          jobs.size() - failed, copied / (1024 * 1024), secs,
+          copied / (1024.0 * 1024.0) / secs);
+  return failed;
+}
+
+/* Creates dir and its parents in fs, the root is expected to exist */
+IOStatus create_dirs(FileSystem *fs, const std::string &dir) {
+  IOStatus s;
+  for (size_t pos = dir.find('/', 1); pos != std::string::npos;
+       pos = dir.find('/', pos + 1)) {
+    s = fs->CreateDirIfMissing(dir.substr(0, pos), IOOptions(), nullptr);
+    if (!s.ok()) return s;
+  }
+  return fs->CreateDirIfMissing(dir, IOOptions(), nullptr);
+}
+
+int zenfs_tool_backup() {
+  Status s;
+  std::shared_ptr<FileSystem> posix = FileSystem::Default();
+  std::vector<ZenFSFileLayout> layouts;
+  std::vector<CopyJob> jobs;
+
+  if (FLAGS_backup_path.empty()) {
+    fprintf(stderr, "You need to specify --backup_path\n");
+    return 1;
+  }
+
+  ZonedBlockDevice *zbd = zbd_open();
+  if (zbd == nullptr) return 1;
+
+  ZenFS *zenFS;
+  s = zenfs_mount(zbd, &zenFS);
+  if (!s.ok()) {
+    fprintf(stderr, "Failed to mount filesystem, error: %s\n",
+            s.ToString().c_str());
+    return 1;
+  }
+
+  /* Files keep their path relative to --path */
+  zenFS->GetFileLayouts(FLAGS_path, &layouts);
+  for (const auto &l : layouts) {
+    std::string dst =
+        FLAGS_backup_path + "/" + l.filename_.substr(FLAGS_path.length());
+    s = create_dirs(posix.get(), dst.substr(0, dst.rfind('/')));
+    if (!s.ok()) {
+      fprintf(stderr, "Failed to create directory for %s, error: %s\n",
+              dst.c_str(), s.ToString().c_str());
+      delete zenFS;
+      return 1;
+    }
+    jobs.push_back(CopyJob{l.filename_, dst, l.size_});
+  }
+
+  int failed = copy_files(zenFS, posix.get(), jobs, zbd->GetBlockSize());
+  delete zenFS;
+  return failed ? 1 : 0;
+}
+
+/* Appends the regular files under the POSIX directory dir, rel is the path
+ * of dir relative to the backup root */
+IOStatus list_backup(FileSystem *fs, const std::string &dir,
+                     const std::string &rel,
+                     std::vector<std::pair<std::string, uint64_t>> *files) {
+  std::vector<std::string> children;
+  IOStatus s = fs->GetChildren(dir, IOOptions(), &children, nullptr);
+  if (!s.ok()) return s;
+
+  for (const auto &c : children) {
+    if (c == "." || c == "..") continue;
+    std::string path = dir + "/" + c;
+    bool is_dir = false;
+    s = fs->IsDirectory(path, IOOptions(), &is_dir, nullptr);
+    if (!s.ok()) return s;
+    if (is_dir) {
+      s = list_backup(fs, path, rel + c + "/", files);
+    } else {
+      uint64_t size;
+      s = fs->GetFileSize(path, IOOptions(), &size, nullptr);
+      files->emplace_back(rel + c, size);
+    }
+    if (!s.ok()) return s;
+  }
+  return s;
+}
+
+int zenfs_tool_restore() {
+  Status s;
+  std::shared_ptr<FileSystem> posix = FileSystem::Default();
+  std::vector<std::pair<std::string, uint64_t>> files;
+  std::vector<CopyJob> jobs;
+
+  if (FLAGS_backup_path.empty()) {
+    fprintf(stderr, "You need to specify --backup_path\n");
+    return 1;
+  }
+
+  s = list_backup(posix.get(), FLAGS_backup_path, "", &files);
+  if (!s.ok()) {
+    fprintf(stderr, "Failed to list %s, error: %s\n",
+            FLAGS_backup_path.c_str(), s.ToString().c_str());
+    return 1;
+  }
+
+  ZonedBlockDevice *zbd = zbd_open();
+  if (zbd == nullptr) return 1;
+
+  ZenFS *zenFS;
+  s = zenfs_mount(zbd, &zenFS);
+  if (!s.ok()) {
+    fprintf(stderr, "Failed to mount filesystem, error: %s\n",
+            s.ToString().c_str());
+    return 1;
+  }
+
+  /* Directories live in the aux file system, files in zones */
+  for (const auto &f : files) {
+    std::string dst = FLAGS_path + "/" + f.first;
+    s = create_dirs(zenFS, dst.substr(0, dst.rfind('/')));
+    if (!s.ok()) {
+      fprintf(stderr, "Failed to create directory for %s, error: %s\n",
+              dst.c_str(), s.ToString().c_str());
+      delete zenFS;
+      return 1;
+    }
+    jobs.push_back(CopyJob{FLAGS_backup_path + "/" + f.first, dst, f.second});
+  }
+
+  int failed = copy_files(posix.get(), zenFS, jobs, zbd->GetBlockSize());
+  delete zenFS;
+  return failed ? 1 : 0;
+}
+
+/* Extents of every file under --path, then the valid ratio of every zone
+ * holding data, from the mounted metadata only */
+int zenfs_tool_dump_layout() {
+  Status s;
+  std::vector<ZenFSFileLayout> layouts;
+
+  ZonedBlockDevice *zbd = zbd_open();
+  if (zbd == nullptr) return 1;
+
+  ZenFS *zenFS;
+  s = zenfs_mount(zbd, &zenFS);
+  if (!s.ok()) {
+    fprintf(stderr, "Failed to mount filesystem, error: %s\n",
+            s.ToString().c_str());
+    return 1;
+  }
+
+  zenFS->GetFileLayouts(FLAGS_path, &layouts);
+  for (const auto &l : layouts) {
+    fprintf(stdout, "%s\tsize: %lu\textents: %lu\n", l.filename_.c_str(),
+            l.size_, l.extents_.size());
+    for (const auto &e : l.extents_)
+      fprintf(stdout, "\tzone: %d\tstart: 0x%lx\tlength: %lu\n", e.zone_id,
+              e.start, e.length);
+  }
+
+  fprintf(stdout, "zone\twritten MB\tvalid MB\tvalid%%\n");
+  for (const auto z : zbd->GetIOZones()) {
+    uint64_t written = z->wp_ - z->start_;
+    uint64_t valid = std::max<long>(z->used_capacity_.load(), 0);
+    if (written == 0) continue;
+    fprintf(stdout, "%d\t%lu\t%lu\t%lu%%\n", z->zone_id_,
+            written / (1024 * 1024), valid / (1024 * 1024),
+            (100 * valid) / written);
+  }
+
+  delete zenFS;
+  return 0;
+}
+
 int zenfs_tool_lsuuid() {
   std::map<std::string, std::string>::iterator it;
   std::map<std::string, std::string> zenFileSystems = ListZenFileSystems();
@@ -163,7 +516,8 @@ int zenfs_tool_lsuuid() {
 
 int zenfs_tool(int argc, char **argv) {
   SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
-                  +" <command> [OPTIONS]...\nCommands: mkfs, list, ls-uuid");
+                  +" <command> [OPTIONS]...\nCommands: mkfs, list, ls-uuid, "
+                  "benchmark-mount, backup, restore, dump-layout");
   if (argc < 2) {
     fprintf(stderr, "You need to specify a command.\n");
     return 1;
@@ -182,6 +536,14 @@ int zenfs_tool(int argc, char **argv) {
     return ROCKSDB_NAMESPACE::zenfs_tool_list();
   } else if (subcmd == "ls-uuid") {
     return ROCKSDB_NAMESPACE::zenfs_tool_lsuuid();
+  } else if (subcmd == "benchmark-mount") {
+    return ROCKSDB_NAMESPACE::zenfs_tool_benchmark_mount();
+  } else if (subcmd == "backup") {
+    return ROCKSDB_NAMESPACE::zenfs_tool_backup();
+  } else if (subcmd == "restore") {
+    return ROCKSDB_NAMESPACE::zenfs_tool_restore();
+  } else if (subcmd == "dump-layout") {
+    return ROCKSDB_NAMESPACE::zenfs_tool_dump_layout();
   } else {
     fprintf(stderr, "Subcommand not recognized: %s\n", subcmd.c_str());
     return 1;
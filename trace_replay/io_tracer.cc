@@ -48,6 +48,11 @@ Status IOTraceWriter::WriteIOOp(const IOTraceRecord& record) {
       PutLengthPrefixedSlice(&trace.payload, file_name);
       break;
     }
+    case TraceType::kIOFileNameLenAndOffset: {
+      Slice file_name(record.file_name);
+      PutLengthPrefixedSlice(&trace.payload, file_name);
+      FALLTHROUGH_INTENDED;
+    }
     case TraceType::kIOLenAndOffset:
       PutFixed64(&trace.payload, record.offset);
       FALLTHROUGH_INTENDED;
@@ -170,6 +175,15 @@ Status IOTraceReader::ReadIOOp(IOTraceRecord* record) {
       record->file_name = file_name.ToString();
       break;
     }
+    case TraceType::kIOFileNameLenAndOffset: {
+      Slice file_name;
+      if (!GetLengthPrefixedSlice(&enc_slice, &file_name)) {
+        return Status::Incomplete(
+            "Incomplete access record: Failed to read file name.");
+      }
+      record->file_name = file_name.ToString();
+      FALLTHROUGH_INTENDED;
+    }
     case TraceType::kIOLenAndOffset:
       if (!GetFixed64(&enc_slice, &record->offset)) {
         return Status::Incomplete(
@@ -64,6 +64,19 @@ struct IOTraceRecord {
         io_status(_io_status),
         len(_len),
         offset(_offset) {}
+
+  IOTraceRecord(const uint64_t& _access_timestamp, const TraceType& _trace_type,
+                const std::string& _file_operation, const uint64_t& _latency,
+                const std::string& _io_status, const std::string& _file_name,
+                const uint64_t& _len, const uint64_t& _offset)
+      : access_timestamp(_access_timestamp),
+        trace_type(_trace_type),
+        file_operation(_file_operation),
+        latency(_latency),
+        io_status(_io_status),
+        file_name(_file_name),
+        len(_len),
+        offset(_offset) {}
 };
 
 struct IOTraceHeader {
@@ -5,13 +5,18 @@
 
 #include "trace_replay/trace_replay.h"
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
 #include <sstream>
 #include <thread>
 #include "db/db_impl/db_impl.h"
+#include "db/write_batch_internal.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/write_batch.h"
 #include "util/coding.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
 #include "util/string_util.h"
 #include "util/threadpool_imp.h"
 
@@ -30,8 +35,123 @@ void DecodeCFAndKey(std::string& buffer, uint32_t* cf_id, Slice* key) {
   GetFixed32(&buf, cf_id);
   GetLengthPrefixedSlice(&buf, key);
 }
+
+// An encoded trace routed to the shards of ShardedReplay(). A trace of the
+// keys of several shards is queued to each of them, and replayed by the
+// last one to reach it.
+struct ShardedTrace {
+  explicit ShardedTrace(std::string&& _encoded, uint32_t _pending)
+      : encoded(std::move(_encoded)), pending(_pending), cv(&mutex) {}
+
+  std::string encoded;
+  uint32_t pending;  // The shards yet to reach it
+  bool done = false;
+  port::Mutex mutex;
+  port::CondVar cv;
+};
+
+struct ReplayShard {
+  ReplayShard() : cv(&mutex) {}
+
+  port::Mutex mutex;
+  port::CondVar cv;  // Signalled on a push to and a pop from the queue
+  std::deque<std::shared_ptr<ShardedTrace>> queue;
+  bool closed = false;
+  ReplayLatencies latencies;
+};
+
+// Bounds the traces read ahead of the replay
+const size_t kMaxShardQueueSize = 4096;
+
+uint32_t ShardOf(uint32_t cf_id, const Slice& key, size_t num_shards) {
+  return Hash(key.data(), key.size(), cf_id) %
+         static_cast<uint32_t>(num_shards);
+}
+
+// Sets the shards the query of an encoded trace goes to, none if it is not
+// replayed
+Status RouteTrace(const std::string& encoded, TraceType* type,
+                  std::vector<bool>* shards) {
+  std::fill(shards->begin(), shards->end(), false);
+  if (encoded.size() < kTraceMetadataSize) {
+    return Status::Incomplete("Decode trace string failed");
+  }
+  *type = static_cast<TraceType>(encoded[kTraceTimestampSize]);
+  Slice payload(encoded.data() + kTraceMetadataSize,
+                encoded.size() - kTraceMetadataSize);
+  if (*type == kTraceGet || *type == kTraceIteratorSeek ||
+      *type == kTraceIteratorSeekForPrev) {
+    uint32_t cf_id = 0;
+    Slice key;
+    if (!GetFixed32(&payload, &cf_id) ||
+        !GetLengthPrefixedSlice(&payload, &key)) {
+      return Status::Corruption("Corrupted trace payload.");
+    }
+    (*shards)[ShardOf(cf_id, key, shards->size())] = true;
+  } else if (*type == kTraceWrite) {
+    if (payload.size() < WriteBatchInternal::kHeader) {
+      return Status::Corruption("Corrupted trace payload.");
+    }
+    payload.remove_prefix(WriteBatchInternal::kHeader);
+    bool routed = false;
+    while (!payload.empty()) {
+      char tag = 0;
+      uint32_t cf_id = 0;
+      Slice key, value, blob, xid;
+      Status s = ReadRecordFromWriteBatch(&payload, &tag, &cf_id, &key,
+                                          &value, &blob, &xid);
+      if (!s.ok()) {
+        return s;
+      }
+      switch (tag) {
+        case kTypeRangeDeletion:
+        case kTypeColumnFamilyRangeDeletion:
+          std::fill(shards->begin(), shards->end(), true);
+          routed = true;
+          break;
+        case kTypeValue:
+        case kTypeColumnFamilyValue:
+        case kTypeDeletion:
+        case kTypeColumnFamilyDeletion:
+        case kTypeSingleDeletion:
+        case kTypeColumnFamilySingleDeletion:
+        case kTypeMerge:
+        case kTypeColumnFamilyMerge:
+        case kTypeBlobIndex:
+        case kTypeColumnFamilyBlobIndex:
+          (*shards)[ShardOf(cf_id, key, shards->size())] = true;
+          routed = true;
+          break;
+        default:
+          break;
+      }
+    }
+    if (!routed) {
+      (*shards)[0] = true;
+    }
+  }
+  return Status::OK();
+}
 }  // namespace
 
+std::string ReplayLatencies::ToString() const {
+  const std::pair<const char*, const HistogramImpl*> histograms[] = {
+      {"Write", &write},
+      {"Get", &get},
+      {"IteratorSeek", &iter_seek},
+      {"IteratorSeekForPrev", &iter_seek_for_prev}};
+  std::string out;
+  for (const auto& histogram : histograms) {
+    if (histogram.second->num() > 0) {
+      out.append("Microseconds per ");
+      out.append(histogram.first);
+      out.append(":\n");
+      out.append(histogram.second->ToString());
+    }
+  }
+  return out;
+}
+
 void TracerHelper::EncodeTrace(const Trace& trace, std::string* encoded_trace) {
   assert(encoded_trace);
   PutFixed64(encoded_trace, trace.ts);
@@ -366,6 +486,157 @@ Status Replayer::MultiThreadReplay(uint32_t threads_num) {
   return s;
 }
 
+Status Replayer::ShardedReplay(uint32_t threads_num,
+                               ReplayLatencies* latencies) {
+  Trace header;
+  Status s = ReadHeader(&header);
+  if (!s.ok()) {
+    return s;
+  }
+
+  std::vector<std::unique_ptr<ReplayShard>> shards;
+  for (uint32_t i = 0; i < std::max<uint32_t>(threads_num, 1); i++) {
+    shards.emplace_back(new ReplayShard());
+  }
+  const std::chrono::system_clock::time_point replay_epoch =
+      std::chrono::system_clock::now();
+  auto replay_shard = [&](ReplayShard* shard) {
+    while (true) {
+      std::shared_ptr<ShardedTrace> sharded_trace;
+      {
+        MutexLock l(&shard->mutex);
+        while (shard->queue.empty() && !shard->closed) {
+          shard->cv.Wait();
+        }
+        if (shard->queue.empty()) {
+          break;
+        }
+        sharded_trace = std::move(shard->queue.front());
+        shard->queue.pop_front();
+        shard->cv.SignalAll();
+      }
+
+      // Each shard keeps to the times of the trace on its own
+      const uint64_t ts = DecodeFixed64(sharded_trace->encoded.data());
+      std::this_thread::sleep_until(
+          replay_epoch +
+          std::chrono::microseconds((ts - header.ts) / fast_forward_));
+
+      MutexLock l(&sharded_trace->mutex);
+      if (--sharded_trace->pending > 0) {
+        while (!sharded_trace->done) {
+          sharded_trace->cv.Wait();
+        }
+        continue;
+      }
+      Trace trace;
+      if (TracerHelper::DecodeTrace(sharded_trace->encoded, &trace).ok()) {
+        ReplayTrace(&trace, &shard->latencies);
+      }
+      sharded_trace->done = true;
+      sharded_trace->cv.SignalAll();
+    }
+  };
+  std::vector<port::Thread> threads;
+  for (auto& shard : shards) {
+    threads.emplace_back(replay_shard, shard.get());
+  }
+
+  std::vector<bool> in_shard(shards.size());
+  while (s.ok()) {
+    std::string encoded;
+    s = trace_reader_->Read(&encoded);
+    TraceType type = kTraceMax;
+    if (s.ok()) {
+      s = RouteTrace(encoded, &type, &in_shard);
+    }
+    if (!s.ok() || type == kTraceEnd) {
+      break;
+    }
+    const uint32_t num_shards = static_cast<uint32_t>(
+        std::count(in_shard.begin(), in_shard.end(), true));
+    if (num_shards == 0) {
+      // Other trace entry types that are not implemented for replay.
+      continue;
+    }
+    auto sharded_trace =
+        std::make_shared<ShardedTrace>(std::move(encoded), num_shards);
+    for (size_t i = 0; i < shards.size(); i++) {
+      if (!in_shard[i]) {
+        continue;
+      }
+      ReplayShard* shard = shards[i].get();
+      MutexLock l(&shard->mutex);
+      while (shard->queue.size() >= kMaxShardQueueSize) {
+        shard->cv.Wait();
+      }
+      shard->queue.push_back(sharded_trace);
+      shard->cv.SignalAll();
+    }
+  }
+
+  for (auto& shard : shards) {
+    MutexLock l(&shard->mutex);
+    shard->closed = true;
+    shard->cv.SignalAll();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (latencies != nullptr) {
+    for (auto& shard : shards) {
+      latencies->write.Merge(shard->latencies.write);
+      latencies->get.Merge(shard->latencies.get);
+      latencies->iter_seek.Merge(shard->latencies.iter_seek);
+      latencies->iter_seek_for_prev.Merge(shard->latencies.iter_seek_for_prev);
+    }
+  }
+
+  if (s.IsIncomplete()) {
+    // Reaching eof returns Incomplete status at the moment.
+    // Could happen when killing a process without calling EndTrace() API.
+    return Status::OK();
+  }
+  return s;
+}
+
+void Replayer::ReplayTrace(Trace* trace, ReplayLatencies* latencies) {
+  const uint64_t start_micros = env_->NowMicros();
+  HistogramImpl* histogram = nullptr;
+  if (trace->type == kTraceWrite) {
+    WriteBatch batch(trace->payload);
+    db_->Write(WriteOptions(), &batch).PermitUncheckedError();
+    histogram = &latencies->write;
+  } else {
+    uint32_t cf_id = 0;
+    Slice key;
+    DecodeCFAndKey(trace->payload, &cf_id, &key);
+    ColumnFamilyHandle* cfh = db_->DefaultColumnFamily();
+    if (cf_id > 0) {
+      auto it = cf_map_.find(cf_id);
+      if (it == cf_map_.end()) {
+        return;
+      }
+      cfh = it->second;
+    }
+    if (trace->type == kTraceGet) {
+      std::string value;
+      db_->Get(ReadOptions(), cfh, key, &value).PermitUncheckedError();
+      histogram = &latencies->get;
+    } else {
+      std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions(), cfh));
+      if (trace->type == kTraceIteratorSeek) {
+        iter->Seek(key);
+        histogram = &latencies->iter_seek;
+      } else {
+        iter->SeekForPrev(key);
+        histogram = &latencies->iter_seek_for_prev;
+      }
+    }
+  }
+  histogram->Add(env_->NowMicros() - start_micros);
+}
+
 Status Replayer::ReadHeader(Trace* header) {
   assert(header != nullptr);
   Status s = ReadTrace(header);
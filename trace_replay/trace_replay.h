@@ -9,6 +9,7 @@
 #include <unordered_map>
 #include <utility>
 
+#include "monitoring/histogram.h"
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
 #include "rocksdb/trace_reader_writer.h"
@@ -52,6 +53,7 @@ enum TraceType : char {
   kIOFileNameAndFileSize = 14,
   kIOLen = 15,
   kIOLenAndOffset = 16,
+  kIOFileNameLenAndOffset = 17,
   // All trace types should be added before kTraceMax
   kTraceMax,
 };
@@ -130,6 +132,16 @@ class Tracer {
   uint64_t trace_request_count_;
 };
 
+// The latencies of the queries of a replay, in microseconds, by trace type
+struct ReplayLatencies {
+  HistogramImpl write;
+  HistogramImpl get;
+  HistogramImpl iter_seek;
+  HistogramImpl iter_seek_for_prev;
+
+  std::string ToString() const;
+};
+
 // Replayer helps to replay the captured RocksDB operations, using a user
 // provided TraceReader.
 // The Replayer is instantiated via db_bench today, on using "replay" benchmark.
@@ -148,6 +160,19 @@ class Replayer {
   // User can set the number of threads in the thread pool.
   Status MultiThreadReplay(uint32_t threads_num);
 
+  // Replay the trace stream with threads_num threads, each replaying the
+  // queries of its shard of the keys in trace order, at the times of the
+  // traces sped up by the fast forward rate. So the queries of a key are
+  // replayed in the order traced, and a query slow to replay only holds up
+  // the queries of its own shard. A write batch of the keys of several
+  // shards is replayed once all of them are up to it, as are range
+  // deletions, by all the shards. The traces are only read and routed to
+  // the shards by the calling thread, and decoded by the shard threads.
+  // If latencies is not null, the latencies of the queries replayed are
+  // added to it.
+  Status ShardedReplay(uint32_t threads_num,
+                       ReplayLatencies* latencies = nullptr);
+
   // Enables fast forwarding a replay by reducing the delay between the ingested
   // traces.
   // fast_forward : Rate of replay speedup.
@@ -160,6 +185,10 @@ class Replayer {
   Status ReadFooter(Trace* footer);
   Status ReadTrace(Trace* trace);
 
+  // Replays the query of a trace for ShardedReplay(), adding its latency to
+  // latencies
+  void ReplayTrace(Trace* trace, ReplayLatencies* latencies);
+
   // The background function for MultiThreadReplay to execute Get query
   // based on the trace records.
   static void BGWorkGet(void* arg);
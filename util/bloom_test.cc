@@ -22,8 +22,10 @@ int main() {
 #include "logging/logging.h"
 #include "memory/arena.h"
 #include "port/jemalloc_helper.h"
+#include "rocksdb/cache.h"
 #include "rocksdb/filter_policy.h"
 #include "table/block_based/filter_policy_internal.h"
+#include "test_util/sync_point.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "util/gflags_compat.h"
@@ -382,6 +384,7 @@ class FullBloomTest : public testing::TestWithParam<BloomFilterPolicy::Mode> {
       case BloomFilterPolicy::kFastLocalBloom:
         return for_fast_local_bloom;
       case BloomFilterPolicy::kDeprecatedBlock:
+      case BloomFilterPolicy::kStandard128Ribbon:
       case BloomFilterPolicy::kAuto:
           /* N/A */;
     }
@@ -977,6 +980,182 @@ INSTANTIATE_TEST_CASE_P(Full, FullBloomTest,
                         testing::Values(BloomFilterPolicy::kLegacyBloom,
                                         BloomFilterPolicy::kFastLocalBloom));
 
+class Standard128RibbonTest : public testing::Test {
+ protected:
+  BlockBasedTableOptions table_options_;
+  uint32_t parallel_threads_ = 1;
+  std::unique_ptr<const char[]> buf_;
+
+  Standard128RibbonTest() {
+    table_options_.filter_policy.reset(
+        NewExperimentalRibbonFilterPolicy(FLAGS_bits_per_key));
+  }
+
+  BuiltinFilterBitsBuilder* NewBuilder() {
+    FilterBuildingContext context(table_options_);
+    context.parallel_threads = parallel_threads_;
+    return &dynamic_cast<BuiltinFilterBitsBuilder&>(
+        *BloomFilterPolicy::GetBuilderFromContext(context));
+  }
+
+  // Builds a filter of keys [0, num_keys)
+  Slice Build(int num_keys) {
+    char buffer[sizeof(int)];
+    std::unique_ptr<BuiltinFilterBitsBuilder> builder(NewBuilder());
+    for (int i = 0; i < num_keys; i++) {
+      builder->AddKey(Key(i, buffer));
+    }
+    return builder->Finish(&buf_);
+  }
+
+  FilterBitsReader* NewReader(const Slice& filter) {
+    return table_options_.filter_policy->GetFilterBitsReader(filter);
+  }
+
+  static char SubImpl(const Slice& filter) {
+    return filter.data()[filter.size() - 4];
+  }
+
+  static int NumShards(const Slice& filter) {
+    return static_cast<uint8_t>(filter.data()[filter.size() - 6]);
+  }
+
+  // Checks all keys match and returns the FP rate
+  static double CheckAndGetFpRate(FilterBitsReader* reader, int num_keys) {
+    char buffer[sizeof(int)];
+    for (int i = 0; i < num_keys; i++) {
+      EXPECT_TRUE(reader->MayMatch(Key(i, buffer))) << "key " << i;
+    }
+    int fps = 0;
+    for (int i = 0; i < 10000; i++) {
+      fps += reader->MayMatch(Key(i + 1000000000, buffer));
+    }
+    return fps / 10000.0;
+  }
+};
+
+TEST_F(Standard128RibbonTest, VaryingLengths) {
+  std::unique_ptr<BuiltinFilterBitsBuilder> builder(NewBuilder());
+  for (int n = 1; n < 100; n++) {
+    auto space = builder->CalculateSpace(n);
+    auto n2 = builder->CalculateNumEntry(space);
+    EXPECT_GE(n2, n);
+    EXPECT_EQ(space, builder->CalculateSpace(n2));
+  }
+
+  for (int length = 1; length <= 10000; length = NextLength(length)) {
+    Slice filter = Build(length);
+    ASSERT_EQ(1, SubImpl(filter));
+    ASSERT_EQ(1, NumShards(filter));
+    if (length >= 2000) {
+      // At least 20% smaller than Bloom with the same FP rate
+      ASSERT_LE(filter.size(),
+                static_cast<size_t>(length * FLAGS_bits_per_key / 10));
+    }
+    std::unique_ptr<FilterBitsReader> reader(NewReader(filter));
+    double rate = CheckAndGetFpRate(reader.get(), length);
+    if (kVerbose >= 1) {
+      fprintf(stderr, "False positives: %5.2f%% @ length = %6d ; bytes = %6d\n",
+              rate * 100.0, length, static_cast<int>(filter.size()));
+    }
+    ASSERT_LE(rate, 0.0125);
+  }
+}
+
+TEST_F(Standard128RibbonTest, ParallelBuild) {
+  const int kNumKeys = 300000;
+  Slice filter = Build(kNumKeys);
+  ASSERT_EQ(1, NumShards(filter));
+  size_t single_size = filter.size();
+
+  parallel_threads_ = 4;
+  filter = Build(kNumKeys);
+  ASSERT_EQ(1, SubImpl(filter));
+  ASSERT_EQ(4, NumShards(filter));
+  // Each shard rounds up to whole blocks
+  ASSERT_LE(filter.size(), single_size + 4 * 16 * 16 + 4 * 5);
+  std::unique_ptr<FilterBitsReader> reader(NewReader(filter));
+  ASSERT_LE(CheckAndGetFpRate(reader.get(), kNumKeys), 0.0125);
+
+  // Too few keys to be worth sharding
+  filter = Build(1000);
+  ASSERT_EQ(1, NumShards(filter));
+}
+
+TEST_F(Standard128RibbonTest, ReserveMemory) {
+  const int kNumKeys = 100000;
+  table_options_.reserve_table_builder_memory = true;
+  table_options_.block_cache = NewLRUCache(64 << 20);
+  Status reserve_status;
+  size_t reserved_during_finish = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "Standard128RibbonBitsBuilder::Finish:Reserved", [&](void* arg) {
+        reserve_status = *static_cast<Status*>(arg);
+        reserved_during_finish = table_options_.block_cache->GetPinnedUsage();
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Slice filter = Build(kNumKeys);
+  ASSERT_OK(reserve_status);
+  ASSERT_EQ(1, SubImpl(filter));
+  // At least the key hashes and the banding
+  ASSERT_GE(reserved_during_finish, size_t{kNumKeys} * (8 + 16 + 2));
+  ASSERT_EQ(size_t{0}, table_options_.block_cache->GetPinnedUsage());
+
+  // Falls back to Bloom when the block cache can't take the charge
+  table_options_.block_cache = NewLRUCache(1 << 20, 0 /* num_shard_bits */,
+                                           true /* strict_capacity_limit */);
+  filter = Build(kNumKeys);
+  ASSERT_TRUE(reserve_status.IsIncomplete());
+  ASSERT_EQ(0, SubImpl(filter));
+  std::unique_ptr<FilterBitsReader> reader(NewReader(filter));
+  ASSERT_LE(CheckAndGetFpRate(reader.get(), kNumKeys), 0.0125);
+  ASSERT_EQ(size_t{0}, table_options_.block_cache->GetPinnedUsage());
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(Standard128RibbonTest, CorruptFilters) {
+  parallel_threads_ = 2;
+  Slice filter = Build(200000);
+  ASSERT_EQ(2, NumShards(filter));
+  std::string good = filter.ToString();
+  const size_t shard_info = good.size() - 6 - 2 * 5;
+  std::unique_ptr<FilterBitsReader> reader;
+  std::string bad;
+
+  // Unsupported number of columns
+  for (char columns : {0, 17}) {
+    bad = good;
+    bad[bad.size() - 3] = columns;
+    reader.reset(NewReader(bad));
+    ASSERT_TRUE(reader->MayMatch("hello"));
+    ASSERT_TRUE(reader->MayMatch("world"));
+  }
+
+  // Shards not covering the solution exactly
+  for (int delta : {-1, 1}) {
+    bad = good;
+    EncodeFixed32(&bad[shard_info],
+                  DecodeFixed32(&bad[shard_info]) + delta);
+    reader.reset(NewReader(bad));
+    ASSERT_TRUE(reader->MayMatch("hello"));
+    ASSERT_TRUE(reader->MayMatch("world"));
+  }
+
+  // More shards than the solution has room for
+  bad = good;
+  bad[bad.size() - 6] = static_cast<char>(255);
+  reader.reset(NewReader(bad));
+  ASSERT_TRUE(reader->MayMatch("hello"));
+  ASSERT_TRUE(reader->MayMatch("world"));
+
+  // Still good
+  reader.reset(NewReader(good));
+  ASSERT_LE(CheckAndGetFpRate(reader.get(), 200000), 0.0125);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
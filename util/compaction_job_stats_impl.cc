@@ -46,6 +46,9 @@ void CompactionJobStats::Reset() {
 
   num_single_del_fallthru = 0;
   num_single_del_mismatch = 0;
+
+  num_blobs_relocated = 0;
+  total_blob_bytes_relocated = 0;
 }
 
 void CompactionJobStats::Add(const CompactionJobStats& stats) {
@@ -79,6 +82,9 @@ void CompactionJobStats::Add(const CompactionJobStats& stats) {
 
   num_single_del_fallthru += stats.num_single_del_fallthru;
   num_single_del_mismatch += stats.num_single_del_mismatch;
+
+  num_blobs_relocated += stats.num_blobs_relocated;
+  total_blob_bytes_relocated += stats.total_blob_bytes_relocated;
 }
 
 #else
@@ -0,0 +1,138 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/compression.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+#ifdef ROCKSDB_ZSTD_STREAMING
+namespace {
+
+class ZSTDStreamingCompress : public StreamingCompress {
+ public:
+  ZSTDStreamingCompress(const CompressionOptions& opts, size_t max_output_len)
+      : StreamingCompress(max_output_len), cctx_(ZSTD_createCCtx()) {
+    int level = opts.level;
+    if (level == CompressionOptions::kDefaultCompressionLevel) {
+      // 3 is the value of ZSTD_CLEVEL_DEFAULT (not exposed publicly), see
+      // https://github.com/facebook/zstd/issues/1148
+      level = 3;
+    }
+    ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level);
+    Reset();
+  }
+
+  ~ZSTDStreamingCompress() override { ZSTD_freeCCtx(cctx_); }
+
+  int Compress(const char* input, size_t input_size, char* output,
+               size_t* output_len) override {
+    assert(input != nullptr || input_size == 0);
+    assert(output != nullptr && output_len != nullptr);
+    *output_len = 0;
+    if (input_size == 0) {
+      // Nothing to frame, the caller writes an empty chunk
+      return 0;
+    }
+    if (input_buffer_.src == nullptr) {
+      input_buffer_ = {input, input_size, /*pos=*/0};
+    }
+    assert(input_buffer_.src == input && input_buffer_.size == input_size);
+    ZSTD_outBuffer output_buffer = {output, max_output_len_, /*pos=*/0};
+    const size_t remaining =
+        ZSTD_compressStream2(cctx_, &output_buffer, &input_buffer_, ZSTD_e_end);
+    if (ZSTD_isError(remaining)) {
+      Reset();
+      return -1;
+    }
+    *output_len = output_buffer.pos;
+    return static_cast<int>(remaining);
+  }
+
+  void Reset() override {
+    ZSTD_CCtx_reset(cctx_, ZSTD_reset_session_only);
+    input_buffer_ = {/*src=*/nullptr, /*size=*/0, /*pos=*/0};
+  }
+
+ private:
+  ZSTD_CCtx* const cctx_;
+  ZSTD_inBuffer input_buffer_;
+};
+
+class ZSTDStreamingUncompress : public StreamingUncompress {
+ public:
+  explicit ZSTDStreamingUncompress(size_t max_output_len)
+      : StreamingUncompress(max_output_len), dctx_(ZSTD_createDCtx()) {
+    Reset();
+  }
+
+  ~ZSTDStreamingUncompress() override { ZSTD_freeDCtx(dctx_); }
+
+  int Uncompress(const char* input, size_t input_size, char* output,
+                 size_t* output_len) override {
+    assert(output != nullptr && output_len != nullptr);
+    *output_len = 0;
+    if (input != nullptr) {
+      input_buffer_ = {input, input_size, /*pos=*/0};
+    }
+    if (input_buffer_.src == nullptr) {
+      return 0;
+    }
+    ZSTD_outBuffer output_buffer = {output, max_output_len_, /*pos=*/0};
+    const size_t ret =
+        ZSTD_decompressStream(dctx_, &output_buffer, &input_buffer_);
+    if (ZSTD_isError(ret)) {
+      Reset();
+      return -1;
+    }
+    *output_len = output_buffer.pos;
+    // A full output buffer may leave decoded bytes inside the context
+    return (input_buffer_.pos < input_buffer_.size ||
+            output_buffer.pos == max_output_len_)
+               ? 1
+               : 0;
+  }
+
+  void Reset() override {
+    ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_only);
+    input_buffer_ = {/*src=*/nullptr, /*size=*/0, /*pos=*/0};
+  }
+
+ private:
+  ZSTD_DCtx* const dctx_;
+  ZSTD_inBuffer input_buffer_;
+};
+
+}  // namespace
+#endif  // ROCKSDB_ZSTD_STREAMING
+
+StreamingCompress* StreamingCompress::Create(CompressionType compression_type,
+                                             const CompressionOptions& opts,
+                                             size_t max_output_len) {
+  switch (compression_type) {
+#ifdef ROCKSDB_ZSTD_STREAMING
+    case kZSTD:
+      return new ZSTDStreamingCompress(opts, max_output_len);
+#endif  // ROCKSDB_ZSTD_STREAMING
+    default:
+      (void)opts;
+      (void)max_output_len;
+      return nullptr;
+  }
+}
+
+StreamingUncompress* StreamingUncompress::Create(
+    CompressionType compression_type, size_t max_output_len) {
+  switch (compression_type) {
+#ifdef ROCKSDB_ZSTD_STREAMING
+    case kZSTD:
+      return new ZSTDStreamingUncompress(max_output_len);
+#endif  // ROCKSDB_ZSTD_STREAMING
+    default:
+      (void)max_output_len;
+      return nullptr;
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
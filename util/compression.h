@@ -73,6 +73,12 @@ ZSTD_customMem GetJeZstdAllocationOverrides();
 #define ROCKSDB_ZSTD_DDICT
 #endif  // defined(ZSTD_STATIC_LINKING_ONLY) && ZSTD_VERSION_NUMBER >= 10104
 
+// `ZSTD_compressStream2` and the `ZSTD_CCtx_reset`/`ZSTD_DCtx_reset` session
+// resets are stable since v1.4.0.
+#if ZSTD_VERSION_NUMBER >= 10400
+#define ROCKSDB_ZSTD_STREAMING
+#endif  // ZSTD_VERSION_NUMBER >= 10400
+
 // Cached data represents a portion that can be re-used
 // If, in the future we have more than one native context to
 // cache we can arrange this as a tuple
@@ -158,7 +164,9 @@ namespace ROCKSDB_NAMESPACE {
 // dictionary.
 struct CompressionDict {
 #if ZSTD_VERSION_NUMBER >= 700
-  ZSTD_CDict* zstd_cdict_ = nullptr;
+  // Shared through CompressionContextCache with the other CompressionDicts
+  // of the same dictionary and level
+  std::shared_ptr<ZSTD_CDict> zstd_cdict_;
 #endif  // ZSTD_VERSION_NUMBER >= 700
   std::string dict_;
 
@@ -179,25 +187,15 @@ struct CompressionDict {
       }
       // Should be safe (but slower) if below call fails as we'll use the
       // raw dictionary to compress.
-      zstd_cdict_ = ZSTD_createCDict(dict_.data(), dict_.size(), level);
+      zstd_cdict_ = CompressionContextCache::Instance()->GetZSTDCDict(
+          Slice(dict_), level);
       assert(zstd_cdict_ != nullptr);
     }
 #endif  // ZSTD_VERSION_NUMBER >= 700
   }
 
-  ~CompressionDict() {
 #if ZSTD_VERSION_NUMBER >= 700
-    size_t res = 0;
-    if (zstd_cdict_ != nullptr) {
-      res = ZSTD_freeCDict(zstd_cdict_);
-    }
-    assert(res == 0);  // Last I checked they can't fail
-    (void)res;         // prevent unused var warning
-#endif                 // ZSTD_VERSION_NUMBER >= 700
-  }
-
-#if ZSTD_VERSION_NUMBER >= 700
-  const ZSTD_CDict* GetDigestedZstdCDict() const { return zstd_cdict_; }
+  const ZSTD_CDict* GetDigestedZstdCDict() const { return zstd_cdict_.get(); }
 #endif  // ZSTD_VERSION_NUMBER >= 700
 
   Slice GetRawDict() const { return dict_; }
@@ -353,19 +351,18 @@ class CompressionContext {
  private:
 #if defined(ZSTD) && (ZSTD_VERSION_NUMBER >= 500)
   ZSTD_CCtx* zstd_ctx_ = nullptr;
+  // The context is borrowed from the pool of CompressionContextCache, as a
+  // table builder creates one per file, or per worker with parallel
+  // compression
   void CreateNativeContext(CompressionType type) {
     if (type == kZSTD || type == kZSTDNotFinalCompression) {
-#ifdef ROCKSDB_ZSTD_CUSTOM_MEM
-      zstd_ctx_ =
-          ZSTD_createCCtx_advanced(port::GetJeZstdAllocationOverrides());
-#else   // ROCKSDB_ZSTD_CUSTOM_MEM
-      zstd_ctx_ = ZSTD_createCCtx();
-#endif  // ROCKSDB_ZSTD_CUSTOM_MEM
+      zstd_ctx_ = CompressionContextCache::Instance()->GetZSTDCompressContext();
     }
   }
   void DestroyNativeContext() {
     if (zstd_ctx_ != nullptr) {
-      ZSTD_freeCCtx(zstd_ctx_);
+      CompressionContextCache::Instance()->ReturnZSTDCompressContext(
+          zstd_ctx_);
     }
   }
 
@@ -587,6 +584,9 @@ inline std::string CompressionOptionsToString(
   result.append("zstd_max_train_bytes=")
       .append(ToString(compression_options.zstd_max_train_bytes))
       .append("; ");
+  result.append("shared_dict_retrain_bytes=")
+      .append(ToString(compression_options.shared_dict_retrain_bytes))
+      .append("; ");
   result.append("enabled=")
       .append(ToString(compression_options.enabled))
       .append("; ");
@@ -1489,4 +1489,79 @@ inline CacheAllocationPtr UncompressData(
   }
 }
 
+// Whether `compression_type` can be used with StreamingCompress and
+// StreamingUncompress. Only ZSTD is supported for now.
+inline bool StreamingCompressionTypeSupported(
+    CompressionType compression_type) {
+  switch (compression_type) {
+    case kNoCompression:
+      return true;
+    case kZSTD:
+#ifdef ROCKSDB_ZSTD_STREAMING
+      return true;
+#else
+      return false;
+#endif  // ROCKSDB_ZSTD_STREAMING
+    default:
+      return false;
+  }
+}
+
+// Compresses a sequence of independent inputs into bounded output chunks,
+// keeping the native context alive across inputs so that it is only
+// allocated once. Each input is compressed into a self-contained frame.
+class StreamingCompress {
+ public:
+  // Returns nullptr if `compression_type` is not supported for streaming.
+  static StreamingCompress* Create(CompressionType compression_type,
+                                   const CompressionOptions& opts,
+                                   size_t max_output_len);
+
+  virtual ~StreamingCompress() {}
+
+  // Compresses `input`. Each call writes at most max_output_len bytes to
+  // `output` and sets `*output_len` to their number. Returns the number of
+  // bytes the context still has to flush, so the caller must call again
+  // with the same input while the result is positive. Returns -1 on error.
+  // Reset() must be called before moving on to a new input.
+  virtual int Compress(const char* input, size_t input_size, char* output,
+                       size_t* output_len) = 0;
+
+  // Discards the state of the current input, keeping the native context
+  virtual void Reset() = 0;
+
+ protected:
+  explicit StreamingCompress(size_t max_output_len)
+      : max_output_len_(max_output_len) {}
+
+  const size_t max_output_len_;
+};
+
+// Reverses StreamingCompress, one chunk of compressed input at a time.
+class StreamingUncompress {
+ public:
+  // Returns nullptr if `compression_type` is not supported for streaming.
+  static StreamingUncompress* Create(CompressionType compression_type,
+                                     size_t max_output_len);
+
+  virtual ~StreamingUncompress() {}
+
+  // Feeds the next chunk of compressed `input`, or continues with the
+  // previous chunk if `input` is nullptr. Each call writes at most
+  // max_output_len bytes to `output` and sets `*output_len` to their number.
+  // Returns a positive value if the caller must call again with a nullptr
+  // input to get more output, 0 once the chunk is consumed and -1 on error.
+  virtual int Uncompress(const char* input, size_t input_size, char* output,
+                         size_t* output_len) = 0;
+
+  // Discards the state of the current frame, keeping the native context
+  virtual void Reset() = 0;
+
+ protected:
+  explicit StreamingUncompress(size_t max_output_len)
+      : max_output_len_(max_output_len) {}
+
+  const size_t max_output_len_;
+};
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -9,19 +9,21 @@
 
 #include "util/compression_context_cache.h"
 
+#include "port/port.h"
 #include "util/compression.h"
 #include "util/core_local.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
 
 #include <atomic>
+#include <list>
+#include <string>
 
 namespace ROCKSDB_NAMESPACE {
 namespace compression_cache {
 
 void* const SentinelValue = nullptr;
 // Cache ZSTD uncompression contexts for reads
-// if needed we can add ZSTD compression context caching
-// which is currently is not done since BlockBasedTableBuilder
-// simply creates one compression context per new SST file.
 struct ZSTDCachedData {
   // We choose to cache the below structure instead of a ptr
   // because we want to avoid a) native types leak b) make
@@ -63,6 +65,52 @@ struct ZSTDCachedData {
 };
 static_assert(sizeof(ZSTDCachedData) % CACHE_LINE_SIZE == 0,
               "Expected CACHE_LINE_SIZE alignment");
+
+// A pooled ZSTD compression context, or nullptr if there is none
+struct ZSTDCachedCompressContext {
+  std::atomic<ZSTD_CCtx_s*> ctx_;
+
+  char padding[(CACHE_LINE_SIZE -
+                sizeof(std::atomic<ZSTD_CCtx_s*>) % CACHE_LINE_SIZE)];
+
+  ZSTDCachedCompressContext() : ctx_(nullptr) {}
+  ZSTDCachedCompressContext(const ZSTDCachedCompressContext&) = delete;
+  ZSTDCachedCompressContext& operator=(const ZSTDCachedCompressContext&) =
+      delete;
+};
+static_assert(sizeof(ZSTDCachedCompressContext) % CACHE_LINE_SIZE == 0,
+              "Expected CACHE_LINE_SIZE alignment");
+
+ZSTD_CCtx_s* NewZSTDCompressContext() {
+#if defined(ZSTD) && (ZSTD_VERSION_NUMBER >= 500)
+#ifdef ROCKSDB_ZSTD_CUSTOM_MEM
+  return ZSTD_createCCtx_advanced(port::GetJeZstdAllocationOverrides());
+#else   // ROCKSDB_ZSTD_CUSTOM_MEM
+  return ZSTD_createCCtx();
+#endif  // ROCKSDB_ZSTD_CUSTOM_MEM
+#else   // ZSTD && (ZSTD_VERSION_NUMBER >= 500)
+  return nullptr;
+#endif  // ZSTD && (ZSTD_VERSION_NUMBER >= 500)
+}
+
+void FreeZSTDCompressContext(ZSTD_CCtx_s* ctx) {
+#if defined(ZSTD) && (ZSTD_VERSION_NUMBER >= 500)
+  ZSTD_freeCCtx(ctx);
+#else   // ZSTD && (ZSTD_VERSION_NUMBER >= 500)
+  (void)ctx;
+  assert(ctx == nullptr);
+#endif  // ZSTD && (ZSTD_VERSION_NUMBER >= 500)
+}
+
+// The number of digested compression dictionaries kept for reuse
+const size_t kNumCachedZSTDCDicts = 8;
+
+struct ZSTDCachedCDict {
+  uint64_t hash;
+  int level;
+  std::string dict;
+  std::shared_ptr<ZSTD_CDict_s> cdict;
+};
 }  // namespace compression_cache
 
 using namespace compression_cache;
@@ -81,8 +129,68 @@ class CompressionContextCache::Rep {
     cn->ReturnUncompressData();
   }
 
+  ZSTD_CCtx_s* GetZSTDCompressContext() {
+    ZSTD_CCtx_s* ctx = per_core_compr_.Access()->ctx_.exchange(nullptr);
+    return ctx != nullptr ? ctx : NewZSTDCompressContext();
+  }
+
+  void ReturnZSTDCompressContext(ZSTD_CCtx_s* ctx) {
+    ZSTD_CCtx_s* expected = nullptr;
+    if (ctx != nullptr &&
+        !per_core_compr_.Access()->ctx_.compare_exchange_strong(expected,
+                                                                 ctx)) {
+      FreeZSTDCompressContext(ctx);
+    }
+  }
+
+  std::shared_ptr<ZSTD_CDict_s> GetZSTDCDict(const Slice& dict, int level) {
+#if defined(ZSTD) && (ZSTD_VERSION_NUMBER >= 700)
+    uint64_t hash = GetSliceNPHash64(dict);
+    {
+      MutexLock l(&cdicts_mutex_);
+      for (auto it = cdicts_.begin(); it != cdicts_.end(); ++it) {
+        if (it->hash == hash && it->level == level && Slice(it->dict) == dict) {
+          // Most recently used first
+          cdicts_.splice(cdicts_.begin(), cdicts_, it);
+          return cdicts_.front().cdict;
+        }
+      }
+    }
+    // Digest outside of the mutex; a racing caller may digest the same
+    // dictionary, which only costs the work saved otherwise.
+    ZSTD_CDict_s* raw = ZSTD_createCDict(dict.data(), dict.size(), level);
+    if (raw == nullptr) {
+      return nullptr;
+    }
+    std::shared_ptr<ZSTD_CDict_s> cdict(
+        raw, [](ZSTD_CDict_s* p) { ZSTD_freeCDict(p); });
+    MutexLock l(&cdicts_mutex_);
+    cdicts_.push_front({hash, level, dict.ToString(), cdict});
+    if (cdicts_.size() > kNumCachedZSTDCDicts) {
+      cdicts_.pop_back();
+    }
+    return cdict;
+#else   // ZSTD && (ZSTD_VERSION_NUMBER >= 700)
+    (void)dict;
+    (void)level;
+    return nullptr;
+#endif  // ZSTD && (ZSTD_VERSION_NUMBER >= 700)
+  }
+
+  ~Rep() {
+    for (size_t i = 0; i < per_core_compr_.Size(); i++) {
+      ZSTD_CCtx_s* ctx = per_core_compr_.AccessAtCore(i)->ctx_.load();
+      if (ctx != nullptr) {
+        FreeZSTDCompressContext(ctx);
+      }
+    }
+  }
+
  private:
   CoreLocalArray<ZSTDCachedData> per_core_uncompr_;
+  CoreLocalArray<ZSTDCachedCompressContext> per_core_compr_;
+  port::Mutex cdicts_mutex_;
+  std::list<ZSTDCachedCDict> cdicts_;
 };
 
 CompressionContextCache::CompressionContextCache() : rep_(new Rep()) {}
@@ -103,6 +211,19 @@ void CompressionContextCache::ReturnCachedZSTDUncompressData(int64_t idx) {
   rep_->ReturnZSTDUncompressData(idx);
 }
 
+ZSTD_CCtx_s* CompressionContextCache::GetZSTDCompressContext() {
+  return rep_->GetZSTDCompressContext();
+}
+
+void CompressionContextCache::ReturnZSTDCompressContext(ZSTD_CCtx_s* ctx) {
+  rep_->ReturnZSTDCompressContext(ctx);
+}
+
+std::shared_ptr<ZSTD_CDict_s> CompressionContextCache::GetZSTDCDict(
+    const Slice& dict, int level) {
+  return rep_->GetZSTDCDict(dict, level);
+}
+
 CompressionContextCache::~CompressionContextCache() { delete rep_; }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -14,12 +14,24 @@
 // instance is atomically replaced with a sentinel value for the time of being
 // used. If it turns out that another thread is already makes use of the
 // instance we still create one on the heap which is later is destroyed.
+//
+// ZSTD compression contexts, which table builders hold for a whole file, are
+// pooled per core instead: a context is taken from the pool of the core it is
+// requested on, and kept in the pool of the core it is returned on if that
+// pool is empty. Digested ZSTD compression dictionaries are shared between
+// the builders that compress with the same dictionary and level.
 
 #pragma once
 
 #include <stdint.h>
 
+#include <memory>
+
 #include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/slice.h"
+
+struct ZSTD_CCtx_s;
+struct ZSTD_CDict_s;
 
 namespace ROCKSDB_NAMESPACE {
 class ZSTDUncompressCachedData;
@@ -35,6 +47,17 @@ class CompressionContextCache {
   ZSTDUncompressCachedData GetCachedZSTDUncompressData();
   void ReturnCachedZSTDUncompressData(int64_t idx);
 
+  // Returns a pooled ZSTD compression context, or a new one if the pool of
+  // the current core is empty. Returns nullptr if ZSTD is not supported.
+  ZSTD_CCtx_s* GetZSTDCompressContext();
+  void ReturnZSTDCompressContext(ZSTD_CCtx_s* ctx);
+
+  // Returns the ZSTD compression dictionary digested from dict for level,
+  // reusing the one of a recent call with the same dictionary and level.
+  // Returns nullptr if ZSTD dictionaries are not supported or digesting
+  // fails.
+  std::shared_ptr<ZSTD_CDict_s> GetZSTDCDict(const Slice& dict, int level);
+
  private:
   // Singleton
   CompressionContextCache();
@@ -186,6 +186,85 @@ TEST_F(WritableFileWriterTest, IncrementalBuffer) {
   }
 }
 
+TEST_F(WritableFileWriterTest, AsyncFlush) {
+  // Writes the data of AppendAsync() only on WaitAsync(), from the caller's
+  // buffer
+  class FakeWF : public FSWritableFile {
+   public:
+    explicit FakeWF(std::string* _file_data) : file_data_(_file_data) {}
+
+    using FSWritableFile::Append;
+    IOStatus Append(const Slice& data, const IOOptions& /*options*/,
+                    IODebugContext* /*dbg*/) override {
+      EXPECT_TRUE(pending_.empty());
+      file_data_->append(data.data(), data.size());
+      return IOStatus::OK();
+    }
+    IOStatus AppendAsync(const Slice& data, const IOOptions& /*options*/,
+                         IODebugContext* /*dbg*/) override {
+      EXPECT_TRUE(pending_.empty());
+      pending_.push_back(data);
+      async_appends_++;
+      return IOStatus::OK();
+    }
+    IOStatus WaitAsync(const IOOptions& /*options*/,
+                       IODebugContext* /*dbg*/) override {
+      for (const Slice& data : pending_) {
+        file_data_->append(data.data(), data.size());
+      }
+      pending_.clear();
+      return IOStatus::OK();
+    }
+    IOStatus Close(const IOOptions& /*options*/,
+                   IODebugContext* /*dbg*/) override {
+      EXPECT_TRUE(pending_.empty());
+      return IOStatus::OK();
+    }
+    IOStatus Flush(const IOOptions& /*options*/,
+                   IODebugContext* /*dbg*/) override {
+      EXPECT_TRUE(pending_.empty());
+      return IOStatus::OK();
+    }
+    IOStatus Sync(const IOOptions& /*options*/,
+                  IODebugContext* /*dbg*/) override {
+      EXPECT_TRUE(pending_.empty());
+      return IOStatus::OK();
+    }
+
+    std::string* file_data_;
+    std::vector<Slice> pending_;
+    int async_appends_ = 0;
+  };
+
+  Random r(301);
+  for (int attempt = 0; attempt < 10; attempt++) {
+    FileOptions file_options;
+    file_options.async_flush = true;
+    file_options.writable_file_max_buffer_size = 256 * 1024;
+    std::string actual;
+    FakeWF* fake_wf = new FakeWF(&actual);
+    std::unique_ptr<WritableFileWriter> writer(new WritableFileWriter(
+        std::unique_ptr<FSWritableFile>(fake_wf), "" /* don't care */,
+        file_options));
+
+    std::string target;
+    for (int i = 0; i < 100; i++) {
+      uint32_t num = r.Skewed(16) * 10 + r.Uniform(100);
+      std::string random_string = r.RandomString(num);
+      ASSERT_OK(writer->Append(Slice(random_string.c_str(), num)));
+      target.append(random_string.c_str(), num);
+
+      if (r.Uniform(20) == 0) {
+        ASSERT_OK(writer->Sync(false /* use_fsync */));
+        ASSERT_EQ(target.size(), actual.size());
+      }
+    }
+    ASSERT_GT(fake_wf->async_appends_, 0);
+    ASSERT_OK(writer->Close());
+    ASSERT_EQ(target, actual);
+  }
+}
+
 #ifndef ROCKSDB_LITE
 TEST_F(WritableFileWriterTest, AppendStatusReturn) {
   class FakeWF : public WritableFile {
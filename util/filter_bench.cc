@@ -19,6 +19,7 @@ int main() {
 #include "memory/arena.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
+#include "rocksdb/cache.h"
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/mock_block_based_table.h"
@@ -80,8 +81,22 @@ DEFINE_bool(new_builder, false,
 
 DEFINE_uint32(impl, 0,
               "Select filter implementation. Without -use_plain_table_bloom:"
-              "0 = full filter, 1 = block-based filter. With "
-              "-use_plain_table_bloom: 0 = no locality, 1 = locality.");
+              "0 = legacy full filter, 1 = block-based filter, "
+              "2 = FastLocalBloom full filter, 3 = Standard128Ribbon full "
+              "filter. With -use_plain_table_bloom: 0 = no locality, "
+              "1 = locality.");
+
+DEFINE_uint32(parallel_threads, 1,
+              "Threads for building each filter, as with "
+              "CompressionOptions::parallel_threads (Ribbon filters only)");
+
+DEFINE_bool(reserve_table_builder_memory, false,
+            "Setting for BlockBasedTableOptions::reserve_table_builder_memory "
+            "(charged to a 1GB block cache)");
+
+DEFINE_bool(build_only, false,
+            "Only build the filters and report build time and size, without "
+            "running queries");
 
 DEFINE_bool(net_includes_hashing, false,
             "Whether query net ns/op times should include hashing. "
@@ -283,6 +298,10 @@ struct FilterBench : public MockBlockBasedTableTester {
     ioptions_.info_log = &stderr_logger_;
     table_options_.optimize_filters_for_memory =
         FLAGS_optimize_filters_for_memory;
+    if (FLAGS_reserve_table_builder_memory) {
+      table_options_.reserve_table_builder_memory = true;
+      table_options_.block_cache = ROCKSDB_NAMESPACE::NewLRUCache(1 << 30);
+    }
   }
 
   void Go();
@@ -306,9 +325,9 @@ void FilterBench::Go() {
       throw std::runtime_error(
           "Block-based filter not currently supported by filter_bench");
     }
-    if (FLAGS_impl > 2) {
+    if (FLAGS_impl > 3) {
       throw std::runtime_error(
-          "-impl must currently be 0 or 2 for Block-based table");
+          "-impl must currently be 0, 2 or 3 for Block-based table");
     }
   }
 
@@ -386,8 +405,8 @@ void FilterBench::Go() {
       info.filter_ = info.plain_table_bloom_->GetRawData();
     } else {
       if (!builder) {
-        builder.reset(
-            static_cast_with_check<BuiltinFilterBitsBuilder>(GetBuilder()));
+        builder.reset(static_cast_with_check<BuiltinFilterBitsBuilder>(
+            GetBuilder(FLAGS_parallel_threads)));
       }
       for (uint32_t i = 0; i < keys_to_add; ++i) {
         builder->AddKey(kms_[0].Get(filter_id, i));
@@ -439,6 +458,10 @@ void FilterBench::Go() {
             << 100.0 * (weighted_predicted_fp_rate / total_keys_added)
             << std::endl;
 #endif
+  if (FLAGS_build_only) {
+    std::cout << "Done (build only)." << std::endl;
+    return;
+  }
   if (!FLAGS_quick && !FLAGS_best_case) {
     double tolerable_rate = std::pow(2.0, -(bpk - 1.0) / (1.4 + bpk / 50.0));
     std::cout << "Best possible FP rate %: " << 100.0 * std::pow(2.0, -bpk)
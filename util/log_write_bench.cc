@@ -11,12 +11,18 @@ int main() {
 }
 #else
 
+#include <cinttypes>
+
+#include "db/log_writer.h"
+#include "env/composite_env_wrapper.h"
 #include "file/writable_file_writer.h"
 #include "monitoring/histogram.h"
 #include "rocksdb/env.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
+#include "util/compression.h"
 #include "util/gflags_compat.h"
+#include "util/random.h"
 
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 using GFLAGS_NAMESPACE::SetUsageMessage;
@@ -28,6 +34,14 @@ DEFINE_int32(record_size, 249, "Size of each record.");
 DEFINE_int32(record_interval, 10000, "Interval between records (microSec)");
 DEFINE_int32(bytes_per_sync, 0, "bytes_per_sync parameter in EnvOptions");
 DEFINE_bool(enable_sync, false, "sync after each write.");
+DEFINE_bool(log_writer, false,
+            "Write records through log::Writer instead of appending them to "
+            "the file directly.");
+DEFINE_string(wal_compression, "none",
+              "Compression of the records written through log::Writer: none "
+              "or zstd. Implies --log_writer unless none.");
+DEFINE_double(compression_ratio, 1.0,
+              "Fraction of each record that remains after compression.");
 
 namespace ROCKSDB_NAMESPACE {
 void RunBenchmark() {
@@ -39,22 +53,58 @@ void RunBenchmark() {
   std::unique_ptr<WritableFile> file;
   env->NewWritableFile(file_name, &file, env_options);
   std::unique_ptr<WritableFileWriter> writer;
-  writer.reset(new WritableFileWriter(std::move(file), file_name, env_options,
-                                      env, nullptr /* stats */,
-                                      options.listeners));
+  writer.reset(new WritableFileWriter(
+      NewLegacyWritableFileWrapper(std::move(file)), file_name, env_options,
+      env, nullptr /* io_tracer */, nullptr /* stats */, options.listeners));
+
+  CompressionType compression_type = kNoCompression;
+  if (FLAGS_wal_compression == "zstd") {
+    compression_type = kZSTD;
+  } else if (FLAGS_wal_compression != "none") {
+    fprintf(stderr, "Unknown --wal_compression %s\n",
+            FLAGS_wal_compression.c_str());
+    exit(1);
+  }
+  if (!StreamingCompressionTypeSupported(compression_type)) {
+    fprintf(stderr, "--wal_compression %s is not supported by this build\n",
+            FLAGS_wal_compression.c_str());
+    exit(1);
+  }
+  std::unique_ptr<log::Writer> log_writer;
+  if (FLAGS_log_writer || compression_type != kNoCompression) {
+    log_writer.reset(new log::Writer(std::move(writer), 0 /* log_number */,
+                                     false /* recycle_log_files */,
+                                     false /* manual_flush */,
+                                     compression_type));
+    log_writer->AddCompressionTypeRecord();
+  }
 
+  Random rnd(301);
   std::string record;
-  record.assign(FLAGS_record_size, 'X');
+  if (FLAGS_compression_ratio < 1.0) {
+    test::CompressibleString(&rnd, FLAGS_compression_ratio,
+                             FLAGS_record_size, &record);
+  } else {
+    record.assign(FLAGS_record_size, 'X');
+  }
 
   HistogramImpl hist;
 
   uint64_t start_time = env->NowMicros();
+  uint64_t start_cpu_nanos = env->NowCPUNanos();
   for (int i = 0; i < FLAGS_num_records; i++) {
     uint64_t start_nanos = env->NowNanos();
-    writer->Append(record);
-    writer->Flush();
-    if (FLAGS_enable_sync) {
-      writer->Sync(false);
+    if (log_writer) {
+      log_writer->AddRecord(record);
+      if (FLAGS_enable_sync) {
+        log_writer->file()->Sync(false);
+      }
+    } else {
+      writer->Append(record);
+      writer->Flush();
+      if (FLAGS_enable_sync) {
+        writer->Sync(false);
+      }
     }
     hist.Add(env->NowNanos() - start_nanos);
 
@@ -69,8 +119,21 @@ void RunBenchmark() {
     }
   }
 
+  uint64_t cpu_nanos = env->NowCPUNanos() - start_cpu_nanos;
+
   fprintf(stderr, "Distribution of latency of append+flush: \n%s",
           hist.ToString().c_str());
+
+  WritableFileWriter* dest = log_writer ? log_writer->file() : writer.get();
+  uint64_t record_bytes =
+      static_cast<uint64_t>(FLAGS_num_records) * FLAGS_record_size;
+  uint64_t file_bytes = dest->GetFileSize();
+  fprintf(stderr,
+          "Wrote %" PRIu64 " bytes of records as %" PRIu64
+          " bytes (%.3f), %.1f CPU nanos per record\n",
+          record_bytes, file_bytes,
+          record_bytes ? static_cast<double>(file_bytes) / record_bytes : 0.0,
+          static_cast<double>(cpu_nanos) / FLAGS_num_records);
 }
 }  // namespace ROCKSDB_NAMESPACE
 
@@ -0,0 +1,434 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "monitoring/instrumented_mutex.h"
+#include "rocksdb/env.h"
+#include "test_util/sync_point.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A timer running repeated work on a single thread, like Timer, for many
+// functions: they are kept in a hierarchical timer wheel instead of a heap,
+// so that adding and cancelling a function takes constant time, and the
+// thread only wakes up when a function is due or a wheel level cascades.
+//
+// Time is cut in ticks of tick_us. The wheel has kNumLevels levels of
+// kNumSlots slots; a slot of level L holds the functions due in a range of
+// kNumSlots^L ticks, and is cascaded to the lower levels once the time
+// reaches that range. Functions run at the first tick boundary at or after
+// their run time, so at most tick_us late.
+//
+// The interface and semantics are the ones of Timer, except that a
+// function not repeated is forgotten once it ran.
+class TimerWheel {
+ public:
+  static const uint64_t kDefaultTickUs = 1000;
+
+  explicit TimerWheel(Env* env, uint64_t tick_us = kDefaultTickUs)
+      : env_(env),
+        tick_us_(std::max<uint64_t>(tick_us, 1)),
+        mutex_(env),
+        cond_var_(&mutex_),
+        running_(false),
+        executing_task_(nullptr),
+        current_tick_(env->NowMicros() / tick_us_) {
+    for (int level = 0; level <= kNumLevels; level++) {
+      num_tasks_[level] = 0;
+    }
+  }
+
+  ~TimerWheel() { Shutdown(); }
+
+  // Add a new function to run, or override the one with the same fn_name.
+  // start_after_us is the initial delay, repeat_every_us the interval
+  // between the end of a run and the start of the next one; 0 does not
+  // repeat.
+  void Add(std::function<void()> fn, const std::string& fn_name,
+           uint64_t start_after_us, uint64_t repeat_every_us) {
+    {
+      InstrumentedMutexLock l(&mutex_);
+      auto it = tasks_.find(fn_name);
+      Task* task;
+      if (it == tasks_.end()) {
+        task = new Task(fn_name);
+        tasks_.emplace(fn_name, std::unique_ptr<Task>(task));
+      } else {
+        task = it->second.get();
+        Unlink(task);
+      }
+      task->fn = std::move(fn);
+      task->repeat_every_us = repeat_every_us;
+      task->expire_tick = TickAtOrAfter(env_->NowMicros() + start_after_us);
+      task->valid = true;
+      if (task == executing_task_) {
+        // Linked once it ran
+        task->readded = true;
+      } else {
+        Link(task);
+      }
+    }
+    cond_var_.SignalAll();
+  }
+
+  // Cancel the function, waiting for it to finish if it is running
+  void Cancel(const std::string& fn_name) {
+    InstrumentedMutexLock l(&mutex_);
+    auto it = tasks_.find(fn_name);
+    if (it == tasks_.end()) {
+      return;
+    }
+    Task* task = it->second.get();
+    if (task == executing_task_) {
+      // Forgotten by the timer thread once it ran
+      task->valid = false;
+      WaitForTaskCompleteIfNecessary();
+    } else {
+      Unlink(task);
+      tasks_.erase(it);
+    }
+  }
+
+  void CancelAll() {
+    InstrumentedMutexLock l(&mutex_);
+    CancelAllWithLock();
+  }
+
+  // Start the timer thread
+  bool Start() {
+    InstrumentedMutexLock l(&mutex_);
+    if (running_) {
+      return false;
+    }
+
+    running_ = true;
+    thread_.reset(new port::Thread(&TimerWheel::Run, this));
+    return true;
+  }
+
+  // Shutdown the timer thread, cancelling all the functions
+  bool Shutdown() {
+    {
+      InstrumentedMutexLock l(&mutex_);
+      if (!running_) {
+        return false;
+      }
+      running_ = false;
+      CancelAllWithLock();
+      cond_var_.SignalAll();
+    }
+
+    if (thread_) {
+      thread_->join();
+    }
+    return true;
+  }
+
+  bool HasPendingTask() const {
+    InstrumentedMutexLock l(&mutex_);
+    return NumValidTasks() > 0;
+  }
+
+#ifndef NDEBUG
+  // Wait until the timer thread waits, call the optional callback, then
+  // wait for it to wait again; see Timer::TEST_WaitForRun().
+  void TEST_WaitForRun(std::function<void()> callback = nullptr) {
+    InstrumentedMutexLock l(&mutex_);
+    while (executing_task_ != nullptr || HasDueTask()) {
+      cond_var_.TimedWait(env_->NowMicros() + 1000);
+    }
+    if (callback != nullptr) {
+      callback();
+    }
+    cond_var_.SignalAll();
+    do {
+      cond_var_.TimedWait(env_->NowMicros() + 1000);
+    } while (executing_task_ != nullptr || HasDueTask());
+  }
+
+  size_t TEST_GetPendingTaskNum() const {
+    InstrumentedMutexLock l(&mutex_);
+    return NumValidTasks();
+  }
+#endif  // NDEBUG
+
+ private:
+  static const int kSlotBits = 8;
+  static const int kNumSlots = 1 << kSlotBits;
+  static const int kNumLevels = 4;
+
+  struct Task;
+
+  // A doubly linked list of tasks
+  struct Slot {
+    Task* head = nullptr;
+  };
+
+  struct Task {
+    explicit Task(const std::string& _name) : name(_name) {}
+
+    std::function<void()> fn;
+    std::string name;
+    uint64_t repeat_every_us = 0;
+    // The tick to run at
+    uint64_t expire_tick = 0;
+    // False once cancelled while running
+    bool valid = true;
+    // Whether Add() overrode the task while it was running
+    bool readded = false;
+    // The slot holding the task and its level (kNumLevels for due_), null
+    // while the task is not in the wheel
+    Slot* slot = nullptr;
+    int level = 0;
+    Task* prev = nullptr;
+    Task* next = nullptr;
+  };
+
+  uint64_t TickAtOrAfter(uint64_t time_us) const {
+    return time_us / tick_us_ + (time_us % tick_us_ != 0 ? 1 : 0);
+  }
+
+  static uint64_t LevelSpan(int level) {
+    return uint64_t{1} << (kSlotBits * level);
+  }
+
+  Slot* SlotOf(int level, uint64_t tick) {
+    return &slots_[level][(tick >> (kSlotBits * level)) & (kNumSlots - 1)];
+  }
+
+  void PushFront(Slot* slot, int level, Task* task) {
+    task->slot = slot;
+    task->level = level;
+    task->prev = nullptr;
+    task->next = slot->head;
+    if (slot->head != nullptr) {
+      slot->head->prev = task;
+    }
+    slot->head = task;
+    num_tasks_[level]++;
+  }
+
+  // Links the task in the slot of its tick, or in due_ if it is due
+  void Link(Task* task) {
+    assert(task->slot == nullptr);
+    if (task->expire_tick <= current_tick_) {
+      PushFront(&due_, kNumLevels, task);
+      return;
+    }
+    const uint64_t delta = task->expire_tick - current_tick_;
+    int level = 0;
+    while (level < kNumLevels - 1 && delta >= LevelSpan(level + 1)) {
+      level++;
+    }
+    // Beyond the range of the wheel, the task is cascaded again from the
+    // last slot
+    const uint64_t max_delta = LevelSpan(kNumLevels) - 1;
+    const uint64_t tick = delta <= max_delta ? task->expire_tick
+                                             : current_tick_ + max_delta;
+    PushFront(SlotOf(level, tick), level, task);
+  }
+
+  void Unlink(Task* task) {
+    if (task->slot == nullptr) {
+      return;
+    }
+    if (task->prev != nullptr) {
+      task->prev->next = task->next;
+    } else {
+      task->slot->head = task->next;
+    }
+    if (task->next != nullptr) {
+      task->next->prev = task->prev;
+    }
+    num_tasks_[task->level]--;
+    task->slot = nullptr;
+    task->prev = nullptr;
+    task->next = nullptr;
+  }
+
+  // Relinks the tasks of the slot, moving them to lower levels or due_
+  void Cascade(Slot* slot) {
+    Task* task = slot->head;
+    while (task != nullptr) {
+      Task* next = task->next;
+      Unlink(task);
+      Link(task);
+      task = next;
+    }
+  }
+
+  // Moves the time to now_tick, collecting the tasks due in due_
+  void Advance(uint64_t now_tick) {
+    while (current_tick_ < now_tick) {
+      int level = 0;
+      while (level < kNumLevels && num_tasks_[level] == 0) {
+        level++;
+      }
+      if (level == kNumLevels) {
+        current_tick_ = now_tick;
+        break;
+      }
+      // With the lower levels empty, nothing happens before the next
+      // cascade of the level
+      uint64_t next_tick = current_tick_ + 1;
+      if (level > 0) {
+        const uint64_t span = LevelSpan(level);
+        next_tick = std::max(
+            next_tick, std::min(now_tick, (current_tick_ / span + 1) * span));
+      }
+      current_tick_ = next_tick;
+      for (int l = kNumLevels - 1; l > 0; l--) {
+        if ((current_tick_ & (LevelSpan(l) - 1)) == 0) {
+          Cascade(SlotOf(l, current_tick_));
+        }
+      }
+      Cascade(SlotOf(0, current_tick_));
+    }
+  }
+
+  // The first tick at which a task may be due or a non-empty slot cascades
+  uint64_t NextWakeTick() {
+    uint64_t wake_tick = port::kMaxUint64;
+    for (int level = 0; level < kNumLevels; level++) {
+      if (num_tasks_[level] == 0) {
+        continue;
+      }
+      const uint64_t base = current_tick_ >> (kSlotBits * level);
+      for (uint64_t k = 1; k <= kNumSlots; k++) {
+        if (slots_[level][(base + k) & (kNumSlots - 1)].head != nullptr) {
+          wake_tick = std::min(wake_tick, (base + k) << (kSlotBits * level));
+          break;
+        }
+      }
+    }
+    return wake_tick;
+  }
+
+  void Run() {
+    InstrumentedMutexLock l(&mutex_);
+
+    while (running_) {
+      Advance(env_->NowMicros() / tick_us_);
+      if (due_.head == nullptr) {
+        if (tasks_.empty()) {
+          TEST_SYNC_POINT("TimerWheel::Run::Waiting");
+          cond_var_.Wait();
+        } else {
+          const uint64_t wake_tick = NextWakeTick();
+          cond_var_.TimedWait(wake_tick < port::kMaxUint64 / tick_us_
+                                  ? wake_tick * tick_us_
+                                  : port::kMaxUint64);
+        }
+        continue;
+      }
+
+      Task* task = due_.head;
+      Unlink(task);
+      // make a copy of the function so it won't be changed after
+      // mutex_.unlock.
+      std::function<void()> fn = task->fn;
+      executing_task_ = task;
+      mutex_.Unlock();
+      // Execute the work
+      fn();
+      mutex_.Lock();
+      executing_task_ = nullptr;
+      cond_var_.SignalAll();
+
+      if (!task->valid) {
+        tasks_.erase(task->name);
+      } else if (task->readded) {
+        task->readded = false;
+        Link(task);
+      } else if (task->repeat_every_us > 0) {
+        assert(running_);
+        task->expire_tick =
+            TickAtOrAfter(env_->NowMicros() + task->repeat_every_us);
+        Link(task);
+      } else {
+        tasks_.erase(task->name);
+      }
+    }
+  }
+
+  void CancelAllWithLock() {
+    mutex_.AssertHeld();
+    for (auto& elem : tasks_) {
+      Task* task = elem.second.get();
+      task->valid = false;
+      Unlink(task);
+    }
+
+    // WaitForTaskCompleteIfNecessary() may release mutex_
+    WaitForTaskCompleteIfNecessary();
+
+    tasks_.clear();
+  }
+
+  void WaitForTaskCompleteIfNecessary() {
+    mutex_.AssertHeld();
+    while (executing_task_ != nullptr) {
+      TEST_SYNC_POINT(
+          "TimerWheel::WaitForTaskCompleteIfNecessary:TaskExecuting");
+      cond_var_.Wait();
+    }
+  }
+
+  size_t NumValidTasks() const {
+    size_t num = 0;
+    for (const auto& elem : tasks_) {
+      if (elem.second->valid) {
+        num++;
+      }
+    }
+    return num;
+  }
+
+#ifndef NDEBUG
+  bool HasDueTask() const {
+    const uint64_t now_tick = env_->NowMicros() / tick_us_;
+    for (const auto& elem : tasks_) {
+      const Task* task = elem.second.get();
+      if (task->slot != nullptr && task->expire_tick <= now_tick) {
+        return true;
+      }
+    }
+    return false;
+  }
+#endif  // NDEBUG
+
+  Env* const env_;
+  const uint64_t tick_us_;
+  // This mutex controls the wheel and tasks_. It needs to be held for
+  // making any changes in them.
+  mutable InstrumentedMutex mutex_;
+  InstrumentedCondVar cond_var_;
+  std::unique_ptr<port::Thread> thread_;
+  bool running_;
+  Task* executing_task_;
+
+  // The tick the wheel is at
+  uint64_t current_tick_;
+  Slot slots_[kNumLevels][kNumSlots];
+  // The tasks due, run in turn by the timer thread
+  Slot due_;
+  // The number of tasks per level, due_ last
+  size_t num_tasks_[kNumLevels + 1];
+
+  // The tasks by name, also responsible for memory management
+  std::unordered_map<std::string, std::unique_ptr<Task>> tasks_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
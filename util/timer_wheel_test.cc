@@ -0,0 +1,208 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/timer_wheel.h"
+
+#include "db/db_test_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class TimerWheelTest : public testing::Test {
+ public:
+  TimerWheelTest() : mock_env_(new MockTimeEnv(Env::Default())) {}
+
+ protected:
+  std::unique_ptr<MockTimeEnv> mock_env_;
+
+  void SetUp() override { mock_env_->InstallTimedWaitFixCallback(); }
+
+  const int kUsPerSec = 1000000;
+};
+
+TEST_F(TimerWheelTest, SingleScheduleOnce) {
+  const int kInitDelayUs = 1 * kUsPerSec;
+  TimerWheel timer(mock_env_.get());
+
+  int count = 0;
+  timer.Add([&] { count++; }, "fn_sch_test", kInitDelayUs, 0);
+
+  ASSERT_TRUE(timer.Start());
+
+  ASSERT_EQ(0, count);
+  // Not due one microsecond before
+  timer.TEST_WaitForRun(
+      [&] { mock_env_->MockSleepForMicroseconds(kInitDelayUs - 1); });
+  ASSERT_EQ(0, count);
+  timer.TEST_WaitForRun([&] { mock_env_->MockSleepForMicroseconds(1); });
+  ASSERT_EQ(1, count);
+  // Forgotten once it ran
+  ASSERT_EQ(0, timer.TEST_GetPendingTaskNum());
+  ASSERT_FALSE(timer.HasPendingTask());
+
+  ASSERT_TRUE(timer.Shutdown());
+}
+
+TEST_F(TimerWheelTest, MultipleScheduleRepeatedly) {
+  const int kIterations = 5;
+  const int kRepeatUs = 2 * kUsPerSec;
+  TimerWheel timer(mock_env_.get());
+
+  int count1 = 0;
+  timer.Add([&] { count1++; }, "fn_sch_test1", 0, kRepeatUs);
+  int count2 = 0;
+  timer.Add([&] { count2++; }, "fn_sch_test2", 1 * kUsPerSec, kRepeatUs);
+
+  ASSERT_TRUE(timer.Start());
+  for (int i = 1; i < kIterations * 2; i++) {
+    timer.TEST_WaitForRun(
+        [&] { mock_env_->MockSleepForMicroseconds(1 * kUsPerSec); });
+    ASSERT_EQ((i + 2) / 2, count1);
+    ASSERT_EQ((i + 1) / 2, count2);
+  }
+
+  timer.Cancel("fn_sch_test1");
+  ASSERT_EQ(1, timer.TEST_GetPendingTaskNum());
+  timer.TEST_WaitForRun(
+      [&] { mock_env_->MockSleepForMicroseconds(1 * kUsPerSec); });
+  ASSERT_EQ(kIterations, count1);
+  ASSERT_EQ(kIterations, count2);
+
+  ASSERT_TRUE(timer.Shutdown());
+  ASSERT_FALSE(timer.HasPendingTask());
+}
+
+TEST_F(TimerWheelTest, LongDelays) {
+  // Due in the last level of the wheel, and beyond its range
+  const int kDaySec = 24 * 3600;
+  TimerWheel timer(mock_env_.get());
+
+  int count1 = 0;
+  timer.Add([&] { count1++; }, "fn_day", uint64_t{kDaySec} * kUsPerSec, 0);
+  int count2 = 0;
+  timer.Add([&] { count2++; }, "fn_100_days",
+            uint64_t{100} * kDaySec * kUsPerSec, 0);
+
+  ASSERT_TRUE(timer.Start());
+  timer.TEST_WaitForRun(
+      [&] { mock_env_->MockSleepForSeconds(kDaySec - 1); });
+  ASSERT_EQ(0, count1);
+  timer.TEST_WaitForRun([&] { mock_env_->MockSleepForSeconds(1); });
+  ASSERT_EQ(1, count1);
+  ASSERT_EQ(0, count2);
+
+  timer.TEST_WaitForRun(
+      [&] { mock_env_->MockSleepForSeconds(98 * kDaySec); });
+  ASSERT_EQ(0, count2);
+  timer.TEST_WaitForRun(
+      [&] { mock_env_->MockSleepForSeconds(kDaySec - 1); });
+  ASSERT_EQ(0, count2);
+  timer.TEST_WaitForRun([&] { mock_env_->MockSleepForSeconds(1); });
+  ASSERT_EQ(1, count2);
+
+  ASSERT_TRUE(timer.Shutdown());
+}
+
+TEST_F(TimerWheelTest, ManyFunctions) {
+  const int kNumFuncs = 1000;
+  const int kRepeatUs = 10 * kUsPerSec;
+  TimerWheel timer(mock_env_.get());
+
+  std::vector<int> counts(kNumFuncs, 0);
+  for (int i = 0; i < kNumFuncs; i++) {
+    // Spread over the first 10 seconds, like the initial delays of
+    // PeriodicWorkScheduler
+    timer.Add([&counts, i] { counts[i]++; }, "fn" + ToString(i),
+              (i % 10) * kUsPerSec, kRepeatUs);
+  }
+  for (int i = 0; i < kNumFuncs; i += 2) {
+    timer.Cancel("fn" + ToString(i));
+  }
+  ASSERT_EQ(kNumFuncs / 2, timer.TEST_GetPendingTaskNum());
+
+  ASSERT_TRUE(timer.Start());
+  for (int sec = 1; sec <= 20; sec++) {
+    timer.TEST_WaitForRun(
+        [&] { mock_env_->MockSleepForMicroseconds(1 * kUsPerSec); });
+  }
+  for (int i = 0; i < kNumFuncs; i++) {
+    ASSERT_EQ(i % 2 == 0 ? 0 : 2, counts[i]);
+  }
+
+  ASSERT_TRUE(timer.Shutdown());
+}
+
+TEST_F(TimerWheelTest, AddSameFuncName) {
+  const int kInitDelayUs = 1 * kUsPerSec;
+  const int kRepeatUs = 5 * kUsPerSec;
+  TimerWheel timer(mock_env_.get());
+  ASSERT_TRUE(timer.Start());
+
+  int func_counter1 = 0;
+  timer.Add([&] { func_counter1++; }, "duplicated_func", kInitDelayUs,
+            kRepeatUs);
+  // New function with the same name should override the existing one
+  int func_counter2 = 0;
+  timer.Add([&] { func_counter2++; }, "duplicated_func", kInitDelayUs,
+            kRepeatUs);
+  ASSERT_EQ(1, timer.TEST_GetPendingTaskNum());
+
+  timer.TEST_WaitForRun(
+      [&] { mock_env_->MockSleepForMicroseconds(kInitDelayUs); });
+  ASSERT_EQ(0, func_counter1);
+  ASSERT_EQ(1, func_counter2);
+
+  timer.TEST_WaitForRun(
+      [&] { mock_env_->MockSleepForMicroseconds(kRepeatUs); });
+  ASSERT_EQ(0, func_counter1);
+  ASSERT_EQ(2, func_counter2);
+
+  ASSERT_TRUE(timer.Shutdown());
+}
+
+TEST_F(TimerWheelTest, CancelRunningTask) {
+  static constexpr char kTestFuncName[] = "test_func";
+  const int kRepeatUs = 1 * kUsPerSec;
+  TimerWheel timer(mock_env_.get());
+  ASSERT_TRUE(timer.Start());
+  int* value = new int;
+  *value = 0;
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->LoadDependency({
+      {"TimerWheelTest::CancelRunningTask:test_func:0",
+       "TimerWheelTest::CancelRunningTask:BeforeCancel"},
+      {"TimerWheel::WaitForTaskCompleteIfNecessary:TaskExecuting",
+       "TimerWheelTest::CancelRunningTask:test_func:1"},
+  });
+  SyncPoint::GetInstance()->EnableProcessing();
+  timer.Add(
+      [&]() {
+        *value = 1;
+        TEST_SYNC_POINT("TimerWheelTest::CancelRunningTask:test_func:0");
+        TEST_SYNC_POINT("TimerWheelTest::CancelRunningTask:test_func:1");
+      },
+      kTestFuncName, 0, kRepeatUs);
+  port::Thread control_thr([&]() {
+    TEST_SYNC_POINT("TimerWheelTest::CancelRunningTask:BeforeCancel");
+    timer.Cancel(kTestFuncName);
+    // Verify that *value has been set to 1.
+    ASSERT_EQ(1, *value);
+    delete value;
+    value = nullptr;
+  });
+  mock_env_->MockSleepForMicroseconds(kRepeatUs);
+  control_thr.join();
+  ASSERT_EQ(0, timer.TEST_GetPendingTaskNum());
+  ASSERT_TRUE(timer.Shutdown());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -8,33 +8,127 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "monitoring/perf_context_imp.h"
 #include "rocksdb/comparator.h"
+#include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+// Same as BytewiseComparator()->Compare(), comparing 8 bytes at a time as
+// big-endian words.
+inline int BytewiseCompare(const Slice& a, const Slice& b) {
+  const size_t min_len = std::min(a.size(), b.size());
+  const char* pa = a.data();
+  const char* pb = b.data();
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= min_len; i += sizeof(uint64_t)) {
+    uint64_t wa = DecodeFixed64(pa + i);
+    uint64_t wb = DecodeFixed64(pb + i);
+    if (wa != wb) {
+      // DecodeFixed64() reads little-endian
+      wa = EndianSwapValue(wa);
+      wb = EndianSwapValue(wb);
+      return wa < wb ? -1 : +1;
+    }
+  }
+  int r = min_len > i ? memcmp(pa + i, pb + i, min_len - i) : 0;
+  if (r == 0) {
+    if (a.size() < b.size()) {
+      r = -1;
+    } else if (a.size() > b.size()) {
+      r = +1;
+    }
+  }
+  return r;
+}
+
+// The built-in user comparators, whose comparisons UserComparatorWrapper
+// inlines instead of calling them through Comparator.
+enum class BuiltinComparator : unsigned char {
+  kNone,
+  kBytewise,
+  kReverseBytewise,
+};
+
+inline BuiltinComparator GetBuiltinComparator(const Comparator* cmp) {
+  if (cmp == BytewiseComparator()) {
+    return BuiltinComparator::kBytewise;
+  } else if (cmp == ReverseBytewiseComparator()) {
+    return BuiltinComparator::kReverseBytewise;
+  }
+  return BuiltinComparator::kNone;
+}
+
+// cmp->Compare(a, b), inlined for the built-in comparators
+template <BuiltinComparator kBuiltin>
+inline int CompareUserKeys(const Comparator* cmp, const Slice& a,
+                           const Slice& b) {
+  return cmp->Compare(a, b);
+}
+
+template <>
+inline int CompareUserKeys<BuiltinComparator::kBytewise>(
+    const Comparator* /*cmp*/, const Slice& a, const Slice& b) {
+  return BytewiseCompare(a, b);
+}
+
+template <>
+inline int CompareUserKeys<BuiltinComparator::kReverseBytewise>(
+    const Comparator* /*cmp*/, const Slice& a, const Slice& b) {
+  return -BytewiseCompare(a, b);
+}
+
 // Wrapper of user comparator, with auto increment to
-// perf_context.user_key_comparison_count.
+// perf_context.user_key_comparison_count. The comparisons of the built-in
+// bytewise comparators are inlined.
 class UserComparatorWrapper final : public Comparator {
  public:
   // `UserComparatorWrapper`s constructed with the default constructor are not
   // usable and will segfault on any attempt to use them for comparisons.
-  UserComparatorWrapper() : user_comparator_(nullptr) {}
+  UserComparatorWrapper()
+      : user_comparator_(nullptr), builtin_(BuiltinComparator::kNone) {}
 
   explicit UserComparatorWrapper(const Comparator* const user_cmp)
-      : Comparator(user_cmp->timestamp_size()), user_comparator_(user_cmp) {}
+      : UserComparatorWrapper(user_cmp, GetBuiltinComparator(user_cmp)) {}
+
+  // For wrappers made per comparison, with the GetBuiltinComparator() of
+  // user_cmp found once
+  UserComparatorWrapper(const Comparator* const user_cmp,
+                        BuiltinComparator builtin)
+      : Comparator(user_cmp->timestamp_size()),
+        user_comparator_(user_cmp),
+        builtin_(builtin) {
+    assert(builtin_ == GetBuiltinComparator(user_cmp));
+  }
 
   ~UserComparatorWrapper() = default;
 
   const Comparator* user_comparator() const { return user_comparator_; }
 
+  BuiltinComparator builtin() const { return builtin_; }
+
   int Compare(const Slice& a, const Slice& b) const override {
     PERF_COUNTER_ADD(user_key_comparison_count, 1);
-    return user_comparator_->Compare(a, b);
+    switch (builtin_) {
+      case BuiltinComparator::kBytewise:
+        return CompareUserKeys<BuiltinComparator::kBytewise>(user_comparator_,
+                                                              a, b);
+      case BuiltinComparator::kReverseBytewise:
+        return CompareUserKeys<BuiltinComparator::kReverseBytewise>(
+            user_comparator_, a, b);
+      default:
+        return CompareUserKeys<BuiltinComparator::kNone>(user_comparator_, a,
+                                                          b);
+    }
   }
 
   bool Equal(const Slice& a, const Slice& b) const override {
     PERF_COUNTER_ADD(user_key_comparison_count, 1);
+    if (builtin_ != BuiltinComparator::kNone) {
+      return a == b;
+    }
     return user_comparator_->Equal(a, b);
   }
 
@@ -70,11 +164,21 @@ class UserComparatorWrapper final : public Comparator {
   int CompareWithoutTimestamp(const Slice& a, bool a_has_ts, const Slice& b,
                               bool b_has_ts) const override {
     PERF_COUNTER_ADD(user_key_comparison_count, 1);
-    return user_comparator_->CompareWithoutTimestamp(a, a_has_ts, b, b_has_ts);
+    // The built-in comparators have no timestamps
+    switch (builtin_) {
+      case BuiltinComparator::kBytewise:
+        return BytewiseCompare(a, b);
+      case BuiltinComparator::kReverseBytewise:
+        return -BytewiseCompare(a, b);
+      default:
+        return user_comparator_->CompareWithoutTimestamp(a, a_has_ts, b,
+                                                         b_has_ts);
+    }
   }
 
  private:
   const Comparator* user_comparator_;
+  BuiltinComparator builtin_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
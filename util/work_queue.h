@@ -109,6 +109,26 @@ class WorkQueue {
     return true;
   }
 
+  /**
+   * Pops an item off the work queue if one is available, without blocking.
+   *
+   * @param[out] item  If `tryPop` returns `true`, it contains the popped item.
+   *                    If `tryPop` returns `false`, it is unmodified.
+   * @returns          True if an item was popped.
+   */
+  bool tryPop(T& item) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (queue_.empty()) {
+        return false;
+      }
+      item = queue_.front();
+      queue_.pop();
+    }
+    writerCv_.notify_one();
+    return true;
+  }
+
   /**
    * Sets the maximum queue size.  If `maxSize == 0` then it is unbounded.
    *
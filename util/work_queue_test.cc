@@ -260,6 +260,26 @@ TEST(WorkQueue, FailedPop) {
   EXPECT_EQ(5, x);
 }
 
+
+TEST(WorkQueue, TryPop) {
+  WorkQueue<int> queue(1);
+  int x = 5;
+  EXPECT_FALSE(queue.tryPop(x));
+  EXPECT_EQ(5, x);
+  EXPECT_TRUE(queue.push(1));
+  EXPECT_TRUE(queue.tryPop(x));
+  EXPECT_EQ(1, x);
+  // A push blocked on the full queue is let through
+  EXPECT_TRUE(queue.push(2));
+  std::thread pusher([&queue] { EXPECT_TRUE(queue.push(3)); });
+  EXPECT_TRUE(queue.tryPop(x));
+  EXPECT_EQ(2, x);
+  pusher.join();
+  EXPECT_TRUE(queue.tryPop(x));
+  EXPECT_EQ(3, x);
+  queue.finish();
+  EXPECT_FALSE(queue.tryPop(x));
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
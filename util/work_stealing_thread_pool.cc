@@ -0,0 +1,348 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/work_stealing_thread_pool.h"
+
+#ifdef NUMA
+#include <numa.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <sstream>
+
+#include "test_util/sync_point.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+uint64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+// The pool and the id of the worker running on the current thread, so that
+// the jobs a worker submits go to its own queue
+static __thread const WorkStealingThreadPool* tls_pool = nullptr;
+static __thread int tls_worker_id = 0;
+#endif
+}  // namespace
+
+const int WorkStealingThreadPool::kMaxThreads;
+
+WorkStealingThreadPool::WorkStealingThreadPool(
+    int num_job_classes, bool pin_to_numa_nodes,
+    QueueingDelayCallback queueing_delay_callback)
+    : num_job_classes_(std::max(num_job_classes, 1)),
+      queueing_delay_callback_(std::move(queueing_delay_callback)),
+      num_numa_nodes_(1),
+      queues_(new WorkerQueue[kMaxThreads]),
+      queue_lens_(new std::atomic<uint32_t>[num_job_classes_]),
+      num_queued_(0),
+      num_queues_(1),
+      next_queue_(0),
+      threads_limit_(0),
+      exit_all_threads_(false),
+      wait_for_jobs_(false),
+      discard_jobs_(false) {
+#ifdef NUMA
+  if (pin_to_numa_nodes && numa_available() != -1) {
+    num_numa_nodes_ = std::max(numa_num_configured_nodes(), 1);
+  }
+#else
+  (void)pin_to_numa_nodes;
+#endif
+  for (int i = 0; i < kMaxThreads; i++) {
+    queues_[i].items.resize(num_job_classes_);
+    queues_[i].numa_node = i % num_numa_nodes_;
+  }
+  for (int c = 0; c < num_job_classes_; c++) {
+    queue_lens_[c].store(0, std::memory_order_relaxed);
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  assert(threads_.empty());
+}
+
+bool WorkStealingThreadPool::TakeFrom(int queue, int job_class, Item* item) {
+  WorkerQueue& q = queues_[queue];
+  std::lock_guard<std::mutex> lock(q.mu);
+  auto& items = q.items[job_class];
+  if (items.empty()) {
+    return false;
+  }
+  *item = std::move(items.front());
+  items.pop_front();
+  queue_lens_[job_class].fetch_sub(1, std::memory_order_relaxed);
+  num_queued_.fetch_sub(1);
+  return true;
+}
+
+bool WorkStealingThreadPool::TakeItem(int id, Item* item) {
+  const int num_queues = num_queues_.load();
+  const int node = queues_[id].numa_node;
+  for (int c = 0; c < num_job_classes_; c++) {
+    if (queue_lens_[c].load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    if (TakeFrom(id, c, item)) {
+      return true;
+    }
+    // Steals from the workers on the same node first, then from the others
+    for (int same_node = 1; same_node >= 0; same_node--) {
+      for (int i = 1; i < num_queues; i++) {
+        const int victim = (id + i) % num_queues;
+        if ((queues_[victim].numa_node == node) == (same_node == 1) &&
+            TakeFrom(victim, c, item)) {
+          TEST_SYNC_POINT("WorkStealingThreadPool::TakeItem:Stolen");
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::WorkerThread(int id) {
+#ifdef NUMA
+  if (num_numa_nodes_ > 1) {
+    numa_run_on_node(queues_[id].numa_node);
+    numa_set_preferred(queues_[id].numa_node);
+  }
+#endif
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  tls_pool = this;
+  tls_worker_id = id;
+#endif
+
+  while (true) {
+    Item item;
+    // Excessive threads help running the queued jobs when the pool waits
+    // for them to complete
+    if (discard_jobs_.load() ||
+        (IsExcessiveThread(id) && !exit_all_threads_.load()) ||
+        !TakeItem(id, &item)) {
+      std::unique_lock<std::mutex> lock(mu_);
+      // The count of queued jobs is checked with mu_ held, which submitters
+      // take before notifying, so that no wake up is missed
+      while (!exit_all_threads_ && !IsLastExcessiveThread(id) &&
+             (num_queued_.load() == 0 || IsExcessiveThread(id))) {
+        cv_.wait(lock);
+      }
+      if (exit_all_threads_) {
+        if (!wait_for_jobs_ || num_queued_.load() == 0) {
+          break;
+        }
+      } else if (IsLastExcessiveThread(id)) {
+        // Excessive threads terminate in the reverse order of creation,
+        // leaving their queued jobs to the other workers
+        threads_.back().detach();
+        threads_.pop_back();
+        cv_.notify_all();
+        break;
+      }
+      continue;
+    }
+
+    if (queueing_delay_callback_) {
+      const uint64_t now = NowMicros();
+      queueing_delay_callback_(
+          item.job_class,
+          now > item.submit_micros ? now - item.submit_micros : 0);
+    }
+    item.function();
+  }
+
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  tls_pool = nullptr;
+#endif
+}
+
+void WorkStealingThreadPool::StartThreads() {
+  while (static_cast<int>(threads_.size()) < threads_limit_) {
+    const int id = static_cast<int>(threads_.size());
+    if (id >= num_queues_.load()) {
+      num_queues_.store(id + 1);
+    }
+    port::Thread thread(&WorkStealingThreadPool::WorkerThread, this, id);
+#if defined(_GNU_SOURCE) && defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2, 12)
+    std::ostringstream thread_name;
+    thread_name << "rocksdb:ws" << id;
+    pthread_setname_np(thread.native_handle(), thread_name.str().c_str());
+#endif
+#endif
+    threads_.push_back(std::move(thread));
+  }
+}
+
+int WorkStealingThreadPool::PickQueue() {
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  if (tls_pool == this) {
+    return tls_worker_id;
+  }
+#endif
+  const uint32_t num_queues =
+      static_cast<uint32_t>(std::max(threads_limit_.load(), 1));
+  return static_cast<int>(next_queue_.fetch_add(1) % num_queues);
+}
+
+void WorkStealingThreadPool::Submit(int job_class,
+                                    std::function<void()>&& function,
+                                    void* tag,
+                                    std::function<void()>&& unschedule) {
+  assert(job_class >= 0 && job_class < num_job_classes_);
+  job_class = std::min(std::max(job_class, 0), num_job_classes_ - 1);
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (exit_all_threads_) {
+      return;
+    }
+    StartThreads();
+  }
+
+  Item item;
+  item.function = std::move(function);
+  item.unschedule = std::move(unschedule);
+  item.tag = tag;
+  item.job_class = job_class;
+  if (queueing_delay_callback_) {
+    item.submit_micros = NowMicros();
+  }
+  {
+    WorkerQueue& q = queues_[PickQueue()];
+    std::lock_guard<std::mutex> lock(q.mu);
+    q.items[job_class].push_back(std::move(item));
+    queue_lens_[job_class].fetch_add(1, std::memory_order_relaxed);
+    num_queued_.fetch_add(1);
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  if (static_cast<int>(threads_.size()) > threads_limit_) {
+    // Wakes up all the threads, so that the one to run the job is not one
+    // to terminate
+    cv_.notify_all();
+  } else {
+    cv_.notify_one();
+  }
+}
+
+int WorkStealingThreadPool::UnSchedule(void* tag, int job_class) {
+  if (job_class < 0 || job_class >= num_job_classes_) {
+    return 0;
+  }
+  int count = 0;
+  std::vector<std::function<void()>> candidates;
+  const int num_queues = num_queues_.load();
+  for (int i = 0; i < num_queues; i++) {
+    WorkerQueue& q = queues_[i];
+    std::lock_guard<std::mutex> lock(q.mu);
+    auto& items = q.items[job_class];
+    for (auto it = items.begin(); it != items.end();) {
+      if (it->tag == tag) {
+        if (it->unschedule) {
+          candidates.push_back(std::move(it->unschedule));
+        }
+        it = items.erase(it);
+        queue_lens_[job_class].fetch_sub(1, std::memory_order_relaxed);
+        num_queued_.fetch_sub(1);
+        count++;
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // Run unschedule functions outside the queue mutexes
+  for (auto& f : candidates) {
+    f();
+  }
+  return count;
+}
+
+unsigned int WorkStealingThreadPool::GetQueueLen(int job_class) const {
+  if (job_class < 0 || job_class >= num_job_classes_) {
+    return 0;
+  }
+  return queue_lens_[job_class].load(std::memory_order_relaxed);
+}
+
+unsigned int WorkStealingThreadPool::GetQueueLen() const {
+  return num_queued_.load(std::memory_order_relaxed);
+}
+
+void WorkStealingThreadPool::JoinThreads(bool wait_for_jobs) {
+  std::vector<port::Thread> threads;
+  {
+    // Threads only terminate early with mu_ held and the flag not set, so
+    // the ones left are all joined here
+    std::lock_guard<std::mutex> lock(mu_);
+    assert(!exit_all_threads_);
+    exit_all_threads_ = true;
+    wait_for_jobs_ = wait_for_jobs;
+    discard_jobs_.store(!wait_for_jobs);
+    threads.swap(threads_);
+    cv_.notify_all();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Drops the jobs not run
+  const int num_queues = num_queues_.load();
+  for (int i = 0; i < num_queues; i++) {
+    WorkerQueue& q = queues_[i];
+    std::lock_guard<std::mutex> lock(q.mu);
+    for (int c = 0; c < num_job_classes_; c++) {
+      queue_lens_[c].fetch_sub(static_cast<uint32_t>(q.items[c].size()),
+                               std::memory_order_relaxed);
+      num_queued_.fetch_sub(static_cast<uint32_t>(q.items[c].size()));
+      q.items[c].clear();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  threads_limit_.store(0);
+  exit_all_threads_ = false;
+  wait_for_jobs_ = false;
+  discard_jobs_.store(false);
+}
+
+void WorkStealingThreadPool::JoinAllThreads() { JoinThreads(false); }
+
+void WorkStealingThreadPool::WaitForJobsAndJoinAllThreads() {
+  JoinThreads(true);
+}
+
+void WorkStealingThreadPool::SetBackgroundThreads(int num) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (exit_all_threads_) {
+    return;
+  }
+  threads_limit_.store(std::min(std::max(num, 0), kMaxThreads));
+  cv_.notify_all();
+  StartThreads();
+}
+
+int WorkStealingThreadPool::GetBackgroundThreads() {
+  return threads_limit_.load();
+}
+
+void WorkStealingThreadPool::SubmitJob(const std::function<void()>& job) {
+  auto copy(job);
+  Submit(num_job_classes_ - 1, std::move(copy), nullptr,
+         std::function<void()>());
+}
+
+void WorkStealingThreadPool::SubmitJob(std::function<void()>&& job) {
+  Submit(num_job_classes_ - 1, std::move(job), nullptr,
+         std::function<void()>());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,122 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/threadpool.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// WorkStealingThreadPool runs jobs of several classes on one set of worker
+// threads. Each worker has a queue of its own per job class, to which the
+// jobs it submits go, and takes work from the queues of the other workers,
+// those on its own NUMA node first, when it runs out of it. Workers always
+// run the most urgent class of job available, so jobs of a class never wait
+// behind queued jobs of a less urgent one.
+//
+// Optionally, each worker is pinned to a NUMA node, spreading the workers
+// evenly over the nodes, so that a job and the memory it allocates stay on
+// one socket. Pinning needs a build with NUMA support.
+class WorkStealingThreadPool : public ThreadPool {
+ public:
+  // Called with the job class and the time in microseconds a job waited in
+  // a queue, when it starts running
+  using QueueingDelayCallback = std::function<void(int, uint64_t)>;
+
+  // Job class 0 is the most urgent, num_job_classes - 1 the least.
+  WorkStealingThreadPool(int num_job_classes, bool pin_to_numa_nodes,
+                         QueueingDelayCallback queueing_delay_callback);
+  ~WorkStealingThreadPool();
+
+  // The most worker threads of a pool
+  static const int kMaxThreads = 1024;
+
+  // Implement ThreadPool interfaces, submitting jobs of the least urgent
+  // class
+  void JoinAllThreads() override;
+  void SetBackgroundThreads(int num) override;
+  int GetBackgroundThreads() override;
+  unsigned int GetQueueLen() const override;
+  void WaitForJobsAndJoinAllThreads() override;
+  void SubmitJob(const std::function<void()>& job) override;
+  void SubmitJob(std::function<void()>&& job) override;
+
+  // Queues a job of the class. Can be unscheduled by tag, which calls
+  // unschedule if it is set.
+  void Submit(int job_class, std::function<void()>&& function, void* tag,
+              std::function<void()>&& unschedule);
+
+  // Removes the queued jobs of the class with the tag, returning their
+  // number
+  int UnSchedule(void* tag, int job_class);
+
+  // Returns the number of queued jobs of the class
+  unsigned int GetQueueLen(int job_class) const;
+
+ private:
+  struct Item {
+    std::function<void()> function;
+    std::function<void()> unschedule;
+    void* tag = nullptr;
+    int job_class = 0;
+    uint64_t submit_micros = 0;
+  };
+
+  // The queues of a worker
+  struct WorkerQueue {
+    std::mutex mu;
+    // One per job class
+    std::vector<std::deque<Item>> items;
+    int numa_node = 0;
+  };
+
+  void WorkerThread(int id);
+  void StartThreads();
+  // Takes the most urgent job available to worker id
+  bool TakeItem(int id, Item* item);
+  bool TakeFrom(int queue, int job_class, Item* item);
+  int PickQueue();
+  void JoinThreads(bool wait_for_jobs);
+
+  bool IsExcessiveThread(int id) const { return id >= threads_limit_; }
+  bool IsLastExcessiveThread(int id) const {
+    return static_cast<int>(threads_.size()) > threads_limit_ &&
+           id == static_cast<int>(threads_.size()) - 1;
+  }
+
+  const int num_job_classes_;
+  const QueueingDelayCallback queueing_delay_callback_;
+  int num_numa_nodes_;
+
+  // One per possible worker, so that the queues never move
+  std::unique_ptr<WorkerQueue[]> queues_;
+  // The queued jobs per class
+  std::unique_ptr<std::atomic<uint32_t>[]> queue_lens_;
+  std::atomic<uint32_t> num_queued_;
+  // The queues which may hold jobs, those of the workers ever started
+  std::atomic<int> num_queues_;
+  std::atomic<uint32_t> next_queue_;
+
+  // Protects the fields below, and is held to sleep and wake up workers
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::atomic<int> threads_limit_;
+  std::vector<port::Thread> threads_;
+  std::atomic<bool> exit_all_threads_;
+  bool wait_for_jobs_;
+  // Set when the threads exit without running the queued jobs
+  std::atomic<bool> discard_jobs_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -104,6 +104,8 @@ void BackupableDBOptions::Dump(Logger* logger) const {
                  restore_rate_limit);
   ROCKS_LOG_INFO(logger, "Options.max_background_operations: %d",
                  max_background_operations);
+  ROCKS_LOG_INFO(logger, "      Options.restore_buffer_size: %" ROCKSDB_PRIszt,
+                 restore_buffer_size);
 }
 
 // -------- BackupEngineImpl class ---------
@@ -389,7 +391,17 @@ class BackupEngineImpl : public BackupEngine {
                           uint64_t* size = nullptr,
                           std::string* checksum_hex = nullptr,
                           uint64_t size_limit = 0,
-                          std::function<void()> progress_callback = []() {});
+                          std::function<void()> progress_callback = []() {},
+                          size_t pipeline_buffer_size = 0);
+
+  // Copies src_reader to dest_writer through two buffers of buffer_size,
+  // reading the next one while the other one is checksummed and written
+  Status PipelinedCopy(SequentialFileReader* src_reader,
+                       WritableFileWriter* dest_writer,
+                       RateLimiter* rate_limiter, uint64_t size_limit,
+                       size_t buffer_size,
+                       const std::function<void()>& progress_callback,
+                       uint64_t* size, uint32_t* checksum_value);
 
   Status ReadFileAndComputeChecksum(const std::string& src, Env* src_env,
                                     const EnvOptions& src_env_options,
@@ -429,6 +441,8 @@ class BackupEngineImpl : public BackupEngine {
     std::string src_checksum_hex;
     std::string db_id;
     std::string db_session_id;
+    // See CopyOrCreateFile()
+    size_t pipeline_buffer_size;
 
     CopyOrCreateWorkItem()
         : src_path(""),
@@ -444,7 +458,8 @@ class BackupEngineImpl : public BackupEngine {
           src_checksum_func_name(kUnknownFileChecksumFuncName),
           src_checksum_hex(""),
           db_id(""),
-          db_session_id("") {}
+          db_session_id(""),
+          pipeline_buffer_size(0) {}
 
     CopyOrCreateWorkItem(const CopyOrCreateWorkItem&) = delete;
     CopyOrCreateWorkItem& operator=(const CopyOrCreateWorkItem&) = delete;
@@ -470,6 +485,7 @@ class BackupEngineImpl : public BackupEngine {
       src_checksum_hex = std::move(o.src_checksum_hex);
       db_id = std::move(o.db_id);
       db_session_id = std::move(o.db_session_id);
+      pipeline_buffer_size = o.pipeline_buffer_size;
       return *this;
     }
 
@@ -497,7 +513,8 @@ class BackupEngineImpl : public BackupEngine {
           src_checksum_func_name(_src_checksum_func_name),
           src_checksum_hex(_src_checksum_hex),
           db_id(_db_id),
-          db_session_id(_db_session_id) {}
+          db_session_id(_db_session_id),
+          pipeline_buffer_size(0) {}
   };
 
   struct BackupAfterCopyOrCreateWorkItem {
@@ -879,7 +896,7 @@ Status BackupEngineImpl::Initialize() {
             work_item.src_env, work_item.dst_env, work_item.src_env_options,
             work_item.sync, work_item.rate_limiter, &result.size,
             &result.checksum_hex, work_item.size_limit,
-            work_item.progress_callback);
+            work_item.progress_callback, work_item.pipeline_buffer_size);
         result.db_id = work_item.db_id;
         result.db_session_id = work_item.db_session_id;
         if (result.status.ok() && work_item.verify_checksum_after_work) {
@@ -1344,7 +1361,7 @@ Status BackupEngineImpl::RestoreDBFromBackup(const RestoreOptions& options,
   }
 
   RateLimiter* rate_limiter = options_.restore_rate_limiter.get();
-  if (rate_limiter) {
+  if (rate_limiter && options_.restore_buffer_size == 0) {
     copy_file_buffer_size_ =
         static_cast<size_t>(rate_limiter->GetSingleBurstBytes());
   }
@@ -1386,6 +1403,8 @@ Status BackupEngineImpl::RestoreDBFromBackup(const RestoreOptions& options,
         GetAbsolutePath(file), dst, "" /* contents */, backup_env_, db_env_,
         EnvOptions() /* src_env_options */, false, rate_limiter,
         0 /* size_limit */);
+    copy_or_create_work_item.pipeline_buffer_size =
+        options_.restore_buffer_size;
     RestoreAfterCopyOrCreateWorkItem after_copy_or_create_work_item(
         copy_or_create_work_item.result.get_future(), file_info->checksum_hex);
     files_to_copy_or_create_.write(std::move(copy_or_create_work_item));
@@ -1481,7 +1500,8 @@ Status BackupEngineImpl::CopyOrCreateFile(
     const std::string& src, const std::string& dst, const std::string& contents,
     Env* src_env, Env* dst_env, const EnvOptions& src_env_options, bool sync,
     RateLimiter* rate_limiter, uint64_t* size, std::string* checksum_hex,
-    uint64_t size_limit, std::function<void()> progress_callback) {
+    uint64_t size_limit, std::function<void()> progress_callback,
+    size_t pipeline_buffer_size) {
   assert(src.empty() != contents.empty());
   Status s;
   std::unique_ptr<WritableFile> dst_file;
@@ -1514,62 +1534,134 @@ Status BackupEngineImpl::CopyOrCreateFile(
   if (!src.empty()) {
     src_reader.reset(new SequentialFileReader(
         NewLegacySequentialFileWrapper(src_file), src));
-    buf.reset(new char[copy_file_buffer_size_]);
+    if (pipeline_buffer_size == 0) {
+      buf.reset(new char[copy_file_buffer_size_]);
+    }
   }
 
+  if (pipeline_buffer_size > 0 && !src.empty()) {
+    s = PipelinedCopy(
+        src_reader.get(), dest_writer.get(), rate_limiter, size_limit,
+        pipeline_buffer_size, progress_callback, size,
+        checksum_hex != nullptr ? &checksum_value : nullptr);
+  } else {
+    Slice data;
+    uint64_t processed_buffer_size = 0;
+    do {
+      if (stop_backup_.load(std::memory_order_acquire)) {
+        return Status::Incomplete("Backup stopped");
+      }
+      if (!src.empty()) {
+        size_t buffer_to_read = (copy_file_buffer_size_ < size_limit)
+                                    ? copy_file_buffer_size_
+                                    : static_cast<size_t>(size_limit);
+        s = src_reader->Read(buffer_to_read, &data, buf.get());
+        processed_buffer_size += buffer_to_read;
+      } else {
+        data = contents;
+      }
+      size_limit -= data.size();
+      TEST_SYNC_POINT_CALLBACK(
+          "BackupEngineImpl::CopyOrCreateFile:CorruptionDuringBackup",
+          (src.length() > 4 && src.rfind(".sst") == src.length() - 4)
+              ? &data
+              : nullptr);
+
+      if (!s.ok()) {
+        return s;
+      }
+
+      if (size != nullptr) {
+        *size += data.size();
+      }
+      if (checksum_hex != nullptr) {
+        checksum_value =
+            crc32c::Extend(checksum_value, data.data(), data.size());
+      }
+      s = dest_writer->Append(data);
+      if (rate_limiter != nullptr) {
+        rate_limiter->Request(data.size(), Env::IO_LOW, nullptr /* stats */,
+                              RateLimiter::OpType::kWrite);
+      }
+      if (processed_buffer_size > options_.callback_trigger_interval_size) {
+        processed_buffer_size -= options_.callback_trigger_interval_size;
+        std::lock_guard<std::mutex> lock(byte_report_mutex_);
+        progress_callback();
+      }
+    } while (s.ok() && contents.empty() && data.size() > 0 && size_limit > 0);
+  }
+
+  // Convert uint32_t checksum to hex checksum
+  if (checksum_hex != nullptr) {
+    checksum_hex->assign(ChecksumInt32ToHex(checksum_value));
+  }
+
+  if (s.ok() && sync) {
+    s = dest_writer->Sync(false);
+  }
+  if (s.ok()) {
+    s = dest_writer->Close();
+  }
+  return s;
+}
+
+Status BackupEngineImpl::PipelinedCopy(
+    SequentialFileReader* src_reader, WritableFileWriter* dest_writer,
+    RateLimiter* rate_limiter, uint64_t size_limit, size_t buffer_size,
+    const std::function<void()>& progress_callback, uint64_t* size,
+    uint32_t* checksum_value) {
+  std::unique_ptr<char[]> bufs[2] = {
+      std::unique_ptr<char[]>(new char[buffer_size]),
+      std::unique_ptr<char[]>(new char[buffer_size])};
+  // size_limit only changes while no read is in flight
+  auto read = [&](int i, Slice* result) {
+    size_t n = static_cast<size_t>(std::min<uint64_t>(buffer_size, size_limit));
+    *result = Slice();
+    return n == 0 ? Status::OK() : src_reader->Read(n, result, bufs[i].get());
+  };
+
   Slice data;
+  Status s = read(0, &data);
   uint64_t processed_buffer_size = 0;
-  do {
+  for (int cur = 0; s.ok() && data.size() > 0; cur ^= 1) {
     if (stop_backup_.load(std::memory_order_acquire)) {
       return Status::Incomplete("Backup stopped");
     }
-    if (!src.empty()) {
-      size_t buffer_to_read = (copy_file_buffer_size_ < size_limit)
-                                  ? copy_file_buffer_size_
-                                  : static_cast<size_t>(size_limit);
-      s = src_reader->Read(buffer_to_read, &data, buf.get());
-      processed_buffer_size += buffer_to_read;
-    } else {
-      data = contents;
-    }
     size_limit -= data.size();
-    TEST_SYNC_POINT_CALLBACK(
-        "BackupEngineImpl::CopyOrCreateFile:CorruptionDuringBackup",
-        (src.length() > 4 && src.rfind(".sst") == src.length() - 4) ? &data
-                                                                    : nullptr);
-
-    if (!s.ok()) {
-      return s;
-    }
+    Slice next;
+    std::future<Status> next_read =
+        std::async(std::launch::async, read, cur ^ 1, &next);
 
     if (size != nullptr) {
       *size += data.size();
     }
-    if (checksum_hex != nullptr) {
-      checksum_value = crc32c::Extend(checksum_value, data.data(), data.size());
+    if (checksum_value != nullptr) {
+      *checksum_value =
+          crc32c::Extend(*checksum_value, data.data(), data.size());
     }
     s = dest_writer->Append(data);
     if (rate_limiter != nullptr) {
-      rate_limiter->Request(data.size(), Env::IO_LOW, nullptr /* stats */,
-                            RateLimiter::OpType::kWrite);
+      // The rate limiter is shared by all the files being restored
+      size_t burst = static_cast<size_t>(rate_limiter->GetSingleBurstBytes());
+      for (size_t left = data.size(); left > 0;) {
+        size_t n = std::min(left, burst);
+        rate_limiter->Request(n, Env::IO_LOW, nullptr /* stats */,
+                              RateLimiter::OpType::kWrite);
+        left -= n;
+      }
     }
+    processed_buffer_size += data.size();
     if (processed_buffer_size > options_.callback_trigger_interval_size) {
       processed_buffer_size -= options_.callback_trigger_interval_size;
       std::lock_guard<std::mutex> lock(byte_report_mutex_);
       progress_callback();
     }
-  } while (s.ok() && contents.empty() && data.size() > 0 && size_limit > 0);
 
-  // Convert uint32_t checksum to hex checksum
-  if (checksum_hex != nullptr) {
-    checksum_hex->assign(ChecksumInt32ToHex(checksum_value));
-  }
-
-  if (s.ok() && sync) {
-    s = dest_writer->Sync(false);
-  }
-  if (s.ok()) {
-    s = dest_writer->Close();
+    Status read_status = next_read.get();
+    if (s.ok()) {
+      s = read_status;
+    }
+    data = next;
   }
   return s;
 }
@@ -2449,6 +2449,27 @@ TEST_P(BackupableDBRateLimitingTestWithParam, RateLimiting) {
   AssertBackupConsistency(0, 0, 100000, 100010);
 }
 
+TEST_F(BackupableDBTest, PipelinedRestore) {
+  // Buffers smaller than both the files and the burst size of the rate
+  // limiter, and larger ones
+  for (size_t buffer_size : {size_t{4096}, size_t{8 * MB}}) {
+    std::shared_ptr<RateLimiter> restore_throttler(
+        NewGenericRateLimiter(10 * MB));
+    backupable_options_->restore_rate_limiter = restore_throttler;
+    backupable_options_->restore_buffer_size = buffer_size;
+    backupable_options_->max_background_operations = 4;
+    DestroyDB(dbname_, options_);
+    OpenDBAndBackupEngine(true);
+    FillDB(db_.get(), 0, 10000);
+    ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+    CloseDBAndBackupEngine();
+    DestroyDB(dbname_, options_);
+
+    // Restore compares the checksums of the files copied
+    AssertBackupConsistency(0, 0, 10000, 10010);
+  }
+}
+
 TEST_F(BackupableDBTest, ReadOnlyBackupEngine) {
   DestroyDB(dbname_, options_);
   OpenDBAndBackupEngine(true);
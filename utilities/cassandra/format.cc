@@ -386,5 +386,189 @@ RowValue RowValue::Merge(std::vector<RowValue>&& values) {
   return RowValue(std::move(columns), last_modified_time);
 }
 
+void SerializedRowMerger::Add(const Slice& value) {
+  const char* src = value.data();
+  std::size_t size = value.size();
+  std::size_t offset = 0;
+  assert(size >= sizeof(int32_t) + sizeof(int64_t));
+  offset += sizeof(int32_t);
+  int64_t marked_for_delete_at =
+      ROCKSDB_NAMESPACE::cassandra::Deserialize<int64_t>(src, offset);
+  offset += sizeof(int64_t);
+
+  RowRef row;
+  row.value = value;
+  row.begin = columns_.size();
+  row.tombstone = marked_for_delete_at > kDefaultMarkedForDeleteAt;
+  row.sorted = true;
+  row.last_modified_time = row.tombstone ? marked_for_delete_at : 0;
+  while (offset < size) {
+    ColumnRef column;
+    column.data = src + offset;
+    column.mask =
+        ROCKSDB_NAMESPACE::cassandra::Deserialize<int8_t>(src, offset);
+    column.index =
+        ROCKSDB_NAMESPACE::cassandra::Deserialize<int8_t>(src, offset + 1);
+    std::size_t fields = offset + sizeof(int8_t) * 2;
+    if ((column.mask & ColumnTypeMask::DELETION_MASK) != 0) {
+      column.timestamp = ROCKSDB_NAMESPACE::cassandra::Deserialize<int64_t>(
+          src, fields + sizeof(int32_t));
+      column.size = sizeof(int8_t) * 2 + sizeof(int32_t) + sizeof(int64_t);
+    } else {
+      column.timestamp =
+          ROCKSDB_NAMESPACE::cassandra::Deserialize<int64_t>(src, fields);
+      int32_t value_size = ROCKSDB_NAMESPACE::cassandra::Deserialize<int32_t>(
+          src, fields + sizeof(int64_t));
+      column.size = static_cast<uint32_t>(sizeof(int8_t) * 2 +
+                                          sizeof(int64_t) + sizeof(int32_t) +
+                                          value_size);
+      if ((column.mask & ColumnTypeMask::EXPIRATION_MASK) != 0) {
+        column.size += sizeof(int32_t);
+      }
+    }
+    offset += column.size;
+    assert(offset <= size);
+    if (columns_.size() > row.begin &&
+        columns_.back().index > column.index) {
+      row.sorted = false;
+    }
+    row.last_modified_time =
+        std::max(row.last_modified_time, column.timestamp);
+    columns_.push_back(column);
+  }
+  row.end = columns_.size();
+  rows_.push_back(row);
+}
+
+bool SerializedRowMerger::Collectable(const ColumnRef& column,
+                                      int32_t gc_grace_period) const {
+  int32_t local_deletion_time =
+      ROCKSDB_NAMESPACE::cassandra::Deserialize<int32_t>(
+          column.data, sizeof(int8_t) * 2);
+  return Tombstone(column.mask, column.index, local_deletion_time,
+                   column.timestamp)
+      .Collectable(gc_grace_period);
+}
+
+void SerializedRowMerger::AppendRow(const RowRef& row, bool remove_tombstones,
+                                    int32_t gc_grace_period,
+                                    std::string* dest) const {
+  if (!remove_tombstones) {
+    dest->append(row.value.data(), row.value.size());
+    return;
+  }
+  // RemoveTombstones() makes a row of the remaining columns, even of a row
+  // tombstone
+  ROCKSDB_NAMESPACE::cassandra::Serialize<int32_t>(kDefaultLocalDeletionTime,
+                                                   dest);
+  ROCKSDB_NAMESPACE::cassandra::Serialize<int64_t>(kDefaultMarkedForDeleteAt,
+                                                   dest);
+  for (size_t i = row.begin; i < row.end; i++) {
+    const ColumnRef& column = columns_[i];
+    if (column.mask == ColumnTypeMask::DELETION_MASK &&
+        Collectable(column, gc_grace_period)) {
+      continue;
+    }
+    dest->append(column.data, column.size);
+  }
+}
+
+void SerializedRowMerger::Finish(std::string* dest, bool remove_tombstones,
+                                 int32_t gc_grace_period) {
+  assert(rows_.size() > 0);
+  // The merge is no larger than the rows together
+  size_t max_size = dest->size();
+  for (const auto& row : rows_) {
+    max_size += row.value.size();
+  }
+  dest->reserve(max_size);
+  if (rows_.size() == 1) {
+    AppendRow(rows_[0], remove_tombstones, gc_grace_period, dest);
+    return;
+  }
+
+  // The rows by their last modified time, the latest first, up to the first
+  // row tombstone
+  autovector<size_t> order;
+  for (size_t i = 0; i < rows_.size(); i++) {
+    order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return rows_[a].last_modified_time > rows_[b].last_modified_time;
+  });
+  int64_t tombstone_timestamp = 0;
+  size_t num_rows = 0;
+  size_t num_columns = 0;
+  for (; num_rows < order.size(); num_rows++) {
+    const RowRef& row = rows_[order[num_rows]];
+    if (row.tombstone) {
+      if (num_columns == 0) {
+        AppendRow(row, remove_tombstones, gc_grace_period, dest);
+        return;
+      }
+      tombstone_timestamp = row.last_modified_time;
+      break;
+    }
+    num_columns += row.end - row.begin;
+  }
+
+  // Rows are usually written with their columns in index order already
+  for (size_t r = 0; r < num_rows; r++) {
+    const RowRef& row = rows_[order[r]];
+    for (size_t i = row.begin + 1; !row.sorted && i < row.end; i++) {
+      ColumnRef column = columns_[i];
+      size_t j = i;
+      for (; j > row.begin && columns_[j - 1].index > column.index; j--) {
+        columns_[j] = columns_[j - 1];
+      }
+      columns_[j] = column;
+    }
+  }
+
+  // k-way merge of the columns of the rows by index. Of the columns with
+  // the same index, the one with the latest timestamp wins, the first one
+  // in row order on a tie.
+  ROCKSDB_NAMESPACE::cassandra::Serialize<int32_t>(kDefaultLocalDeletionTime,
+                                                   dest);
+  ROCKSDB_NAMESPACE::cassandra::Serialize<int64_t>(kDefaultMarkedForDeleteAt,
+                                                   dest);
+  autovector<size_t> pos;
+  for (size_t r = 0; r < num_rows; r++) {
+    pos.push_back(rows_[order[r]].begin);
+  }
+  while (true) {
+    const ColumnRef* next = nullptr;
+    for (size_t r = 0; r < num_rows; r++) {
+      if (pos[r] < rows_[order[r]].end &&
+          (next == nullptr || columns_[pos[r]].index < next->index)) {
+        next = &columns_[pos[r]];
+      }
+    }
+    if (next == nullptr) {
+      break;
+    }
+    int8_t index = next->index;
+    const ColumnRef* winner = nullptr;
+    for (size_t r = 0; r < num_rows; r++) {
+      const RowRef& row = rows_[order[r]];
+      for (; pos[r] < row.end && columns_[pos[r]].index == index; pos[r]++) {
+        if (winner == nullptr ||
+            columns_[pos[r]].timestamp > winner->timestamp) {
+          winner = &columns_[pos[r]];
+        }
+      }
+    }
+    // Columns older than a row tombstone are deleted by it
+    if (winner->timestamp <= tombstone_timestamp) {
+      continue;
+    }
+    if (remove_tombstones && winner->mask == ColumnTypeMask::DELETION_MASK &&
+        Collectable(*winner, gc_grace_period)) {
+      continue;
+    }
+    dest->append(winner->data, winner->size);
+  }
+}
+
 } // namepsace cassandrda
 }  // namespace ROCKSDB_NAMESPACE
@@ -60,6 +60,7 @@
 #include <vector>
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/slice.h"
+#include "util/autovector.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace cassandra {
@@ -180,5 +181,46 @@ public:
   int64_t last_modified_time_;
 };
 
+// Merges serialized rows like RowValue::Merge(), straight from their
+// encoding: the columns are located in place, the rows merged by column
+// index, and the winning columns copied to the output, without a
+// RowValue or column object per row and column.
+class SerializedRowMerger {
+ public:
+  // The value must stay alive until Finish()
+  void Add(const Slice& value);
+
+  // Appends the merge of the rows added to dest, encoded as by
+  // RowValue::Serialize(). If remove_tombstones, the column tombstones
+  // past gc_grace_period are removed as by RowValue::RemoveTombstones().
+  void Finish(std::string* dest, bool remove_tombstones = false,
+              int32_t gc_grace_period = 0);
+
+ private:
+  struct ColumnRef {
+    const char* data;
+    uint32_t size;
+    int8_t mask;
+    int8_t index;
+    int64_t timestamp;
+  };
+  struct RowRef {
+    Slice value;
+    // Columns [begin, end) of columns_
+    size_t begin;
+    size_t end;
+    bool tombstone;
+    bool sorted;  // by column index
+    int64_t last_modified_time;
+  };
+
+  void AppendRow(const RowRef& row, bool remove_tombstones,
+                 int32_t gc_grace_period, std::string* dest) const;
+  bool Collectable(const ColumnRef& column, int32_t gc_grace_period) const;
+
+  autovector<ColumnRef, 32> columns_;
+  autovector<RowRef> rows_;
+};
+
 } // namepsace cassandrda
 }  // namespace ROCKSDB_NAMESPACE
@@ -22,21 +22,17 @@ bool CassandraValueMergeOperator::FullMergeV2(
     MergeOperationOutput* merge_out) const {
   // Clear the *new_value for writing.
   merge_out->new_value.clear();
-  std::vector<RowValue> row_values;
+  SerializedRowMerger merger;
   if (merge_in.existing_value) {
-    row_values.push_back(
-      RowValue::Deserialize(merge_in.existing_value->data(),
-                            merge_in.existing_value->size()));
+    merger.Add(*merge_in.existing_value);
   }
 
   for (auto& operand : merge_in.operand_list) {
-    row_values.push_back(RowValue::Deserialize(operand.data(), operand.size()));
+    merger.Add(operand);
   }
 
-  RowValue merged = RowValue::Merge(std::move(row_values));
-  merged = merged.RemoveTombstones(gc_grace_period_in_seconds_);
-  merge_out->new_value.reserve(merged.Size());
-  merged.Serialize(&(merge_out->new_value));
+  merger.Finish(&(merge_out->new_value), true /* remove_tombstones */,
+                gc_grace_period_in_seconds_);
 
   return true;
 }
@@ -48,13 +44,11 @@ bool CassandraValueMergeOperator::PartialMergeMulti(
   assert(new_value);
   new_value->clear();
 
-  std::vector<RowValue> row_values;
+  SerializedRowMerger merger;
   for (auto& operand : operand_list) {
-    row_values.push_back(RowValue::Deserialize(operand.data(), operand.size()));
+    merger.Add(operand);
   }
-  RowValue merged = RowValue::Merge(std::move(row_values));
-  new_value->reserve(merged.Size());
-  merged.Serialize(new_value);
+  merger.Finish(new_value);
   return true;
 }
 
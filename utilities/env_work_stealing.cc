@@ -0,0 +1,151 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+
+#include "monitoring/statistics.h"
+#include "rocksdb/env.h"
+#include "util/work_stealing_thread_pool.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// The job classes of the pool, from the most urgent
+const int kNumJobClasses = 3;
+
+bool InPool(Env::Priority pri) {
+  return pri == Env::Priority::HIGH || pri == Env::Priority::LOW ||
+         pri == Env::Priority::BOTTOM;
+}
+
+int JobClass(Env::Priority pri) {
+  assert(InPool(pri));
+  return pri == Env::Priority::HIGH ? 0 : pri == Env::Priority::LOW ? 1 : 2;
+}
+
+WorkStealingThreadPool::QueueingDelayCallback QueueingDelayRecorder(
+    const std::shared_ptr<Statistics>& statistics) {
+  if (statistics == nullptr) {
+    return WorkStealingThreadPool::QueueingDelayCallback();
+  }
+  return [statistics](int job_class, uint64_t micros) {
+    static const uint32_t kHistograms[kNumJobClasses] = {
+        HIGH_PRI_POOL_QUEUEING_MICROS, LOW_PRI_POOL_QUEUEING_MICROS,
+        BOTTOM_PRI_POOL_QUEUEING_MICROS};
+    RecordInHistogram(statistics.get(), kHistograms[job_class], micros);
+  };
+}
+}  // namespace
+
+// An environment that runs the jobs of the HIGH, LOW and BOTTOM thread pools
+// on one WorkStealingThreadPool, with a job class per priority.
+class WorkStealingEnv : public EnvWrapper {
+ public:
+  WorkStealingEnv(Env* base_env, const WorkStealingEnvOptions& options)
+      : EnvWrapper(base_env),
+        pool_(kNumJobClasses, options.pin_to_numa_nodes,
+              QueueingDelayRecorder(options.statistics)) {
+    for (int i = 0; i < kNumJobClasses; i++) {
+      thread_limits_[i] = 0;
+    }
+  }
+
+  ~WorkStealingEnv() override { pool_.JoinAllThreads(); }
+
+  void Schedule(void (*function)(void* arg), void* arg, Priority pri,
+                void* tag, void (*unschedFunction)(void* arg)) override {
+    if (!InPool(pri)) {
+      return EnvWrapper::Schedule(function, arg, pri, tag, unschedFunction);
+    }
+    pool_.Submit(JobClass(pri), std::bind(function, arg), tag,
+                 unschedFunction != nullptr
+                     ? std::function<void()>(std::bind(unschedFunction, arg))
+                     : std::function<void()>());
+  }
+
+  int UnSchedule(void* tag, Priority pri) override {
+    if (!InPool(pri)) {
+      return EnvWrapper::UnSchedule(tag, pri);
+    }
+    return pool_.UnSchedule(tag, JobClass(pri));
+  }
+
+  unsigned int GetThreadPoolQueueLen(Priority pri) const override {
+    if (!InPool(pri)) {
+      return EnvWrapper::GetThreadPoolQueueLen(pri);
+    }
+    return pool_.GetQueueLen(JobClass(pri));
+  }
+
+  void SetBackgroundThreads(int num, Priority pri) override {
+    if (!InPool(pri)) {
+      return EnvWrapper::SetBackgroundThreads(num, pri);
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    thread_limits_[JobClass(pri)] = std::max(num, 0);
+    UpdatePoolThreads();
+  }
+
+  int GetBackgroundThreads(Priority pri) override {
+    if (!InPool(pri)) {
+      return EnvWrapper::GetBackgroundThreads(pri);
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    return thread_limits_[JobClass(pri)];
+  }
+
+  void IncBackgroundThreadsIfNeeded(int num, Priority pri) override {
+    if (!InPool(pri)) {
+      return EnvWrapper::IncBackgroundThreadsIfNeeded(num, pri);
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    if (num > thread_limits_[JobClass(pri)]) {
+      thread_limits_[JobClass(pri)] = num;
+      UpdatePoolThreads();
+    }
+  }
+
+  void LowerThreadPoolIOPriority(Priority pool) override {
+    if (!InPool(pool)) {
+      EnvWrapper::LowerThreadPoolIOPriority(pool);
+    }
+  }
+
+  void LowerThreadPoolCPUPriority(Priority pool) override {
+    if (!InPool(pool)) {
+      EnvWrapper::LowerThreadPoolCPUPriority(pool);
+    }
+  }
+
+  Status LowerThreadPoolCPUPriority(Priority pool, CpuPriority pri) override {
+    if (!InPool(pool)) {
+      return EnvWrapper::LowerThreadPoolCPUPriority(pool, pri);
+    }
+    return Status::NotSupported(
+        "Work-stealing thread pools share their threads between priorities");
+  }
+
+ private:
+  // REQUIRES: mu_ held
+  void UpdatePoolThreads() {
+    int num_threads = 0;
+    for (int i = 0; i < kNumJobClasses; i++) {
+      num_threads += thread_limits_[i];
+    }
+    pool_.SetBackgroundThreads(num_threads);
+  }
+
+  WorkStealingThreadPool pool_;
+  std::mutex mu_;
+  int thread_limits_[kNumJobClasses];
+};
+
+Env* NewWorkStealingEnv(Env* base_env, const WorkStealingEnvOptions& options) {
+  return new WorkStealingEnv(base_env, options);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,213 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/parallel_scan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "port/port.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/db.h"
+#include "rocksdb/metadata.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Cuts the key space at the smallest keys of the table files of the level
+// with the most bytes, for about as many bytes of its files within the
+// bounds in each range. Returns the cut points in key order.
+std::vector<std::string> PickPartitionBoundaries(
+    DB* db, ColumnFamilyHandle* column_family, const Comparator* ucmp,
+    const ParallelScanOptions& options, size_t num_partitions) {
+  ColumnFamilyMetaData meta;
+  db->GetColumnFamilyMetaData(column_family, &meta);
+  const LevelMetaData* level = nullptr;
+  for (const auto& l : meta.levels) {
+    if (level == nullptr || l.size > level->size) {
+      level = &l;
+    }
+  }
+  std::vector<std::string> boundaries;
+  if (level == nullptr || num_partitions <= 1) {
+    return boundaries;
+  }
+
+  std::vector<const SstFileMetaData*> files;
+  uint64_t total_size = 0;
+  for (const auto& file : level->files) {
+    if ((options.lower_bound == nullptr ||
+         ucmp->Compare(file.largestkey, *options.lower_bound) >= 0) &&
+        (options.upper_bound == nullptr ||
+         ucmp->Compare(file.smallestkey, *options.upper_bound) < 0)) {
+      files.push_back(&file);
+      total_size += file.size;
+    }
+  }
+  // L0 files are not sorted
+  std::sort(files.begin(), files.end(),
+            [ucmp](const SstFileMetaData* a, const SstFileMetaData* b) {
+              return ucmp->Compare(a->smallestkey, b->smallestkey) < 0;
+            });
+  // Cuts before the file whose middle is past the next multiple of
+  // total_size / num_partitions, for the cuts not to drift with the sizes
+  // of the files
+  uint64_t size = 0;
+  for (const auto* file : files) {
+    const Slice key(file->smallestkey);
+    if (size > 0 &&
+        (size + file->size / 2) * num_partitions >=
+            (boundaries.size() + 1) * total_size &&
+        (options.lower_bound == nullptr ||
+         ucmp->Compare(key, *options.lower_bound) > 0) &&
+        (boundaries.empty() || ucmp->Compare(key, boundaries.back()) > 0)) {
+      boundaries.push_back(file->smallestkey);
+      if (boundaries.size() + 1 == num_partitions) {
+        break;
+      }
+    }
+    size += file->size;
+  }
+  return boundaries;
+}
+
+Status ScanPartition(DB* db, ColumnFamilyHandle* column_family,
+                     const ParallelScanOptions& options,
+                     const Snapshot* snapshot, size_t partition,
+                     const Slice* lower_bound, const Slice* upper_bound,
+                     const ParallelScanCallback& callback,
+                     const std::atomic<bool>& stop) {
+  ReadOptions read_options;
+  read_options.snapshot = snapshot;
+  read_options.fill_cache = options.fill_cache;
+  read_options.readahead_size = options.readahead_size;
+  read_options.total_order_seek = true;
+  read_options.iterate_lower_bound = lower_bound;
+  read_options.iterate_upper_bound = upper_bound;
+  std::unique_ptr<Iterator> iter(db->NewIterator(read_options, column_family));
+
+  ParallelScanBatch batch;
+  batch.partition = partition;
+  // The entries are copied into buf, and the slices made at the end of the
+  // batch, as buf may be reallocated until then
+  std::string buf;
+  std::vector<size_t> key_sizes;
+  std::vector<size_t> value_sizes;
+  auto flush = [&]() {
+    batch.keys.clear();
+    batch.values.clear();
+    const char* p = buf.data();
+    for (size_t i = 0; i < key_sizes.size(); i++) {
+      batch.keys.emplace_back(p, key_sizes[i]);
+      p += key_sizes[i];
+      batch.values.emplace_back(p, value_sizes[i]);
+      p += value_sizes[i];
+    }
+    Status s = callback(batch);
+    buf.clear();
+    key_sizes.clear();
+    value_sizes.clear();
+    return s;
+  };
+
+  Status s;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    const Slice key = iter->key();
+    const Slice value = iter->value();
+    buf.append(key.data(), key.size());
+    buf.append(value.data(), value.size());
+    key_sizes.push_back(key.size());
+    value_sizes.push_back(value.size());
+    if (buf.size() >= options.batch_size) {
+      s = flush();
+      if (!s.ok() || stop.load(std::memory_order_relaxed)) {
+        return s;
+      }
+    }
+  }
+  s = iter->status();
+  if (s.ok() && !key_sizes.empty()) {
+    s = flush();
+  }
+  return s;
+}
+
+}  // namespace
+
+Status ParallelScan(DB* db, ColumnFamilyHandle* column_family,
+                    const ParallelScanOptions& options,
+                    const ParallelScanCallback& callback) {
+  if (options.num_threads <= 0) {
+    return Status::InvalidArgument("num_threads must be positive");
+  }
+  if (column_family == nullptr) {
+    column_family = db->DefaultColumnFamily();
+  }
+  const Comparator* ucmp = column_family->GetComparator();
+  const size_t num_threads = static_cast<size_t>(options.num_threads);
+  const size_t num_partitions = options.num_partitions > 0
+                                    ? options.num_partitions
+                                    : 4 * num_threads;
+
+  const Snapshot* snapshot = options.snapshot;
+  if (snapshot == nullptr) {
+    snapshot = db->GetSnapshot();
+  }
+  // Partition i is [boundaries[i - 1], boundaries[i]), the first and the
+  // last ones bounded by the options
+  std::vector<std::string> boundary_keys = PickPartitionBoundaries(
+      db, column_family, ucmp, options, num_partitions);
+  std::vector<Slice> boundaries(boundary_keys.begin(), boundary_keys.end());
+  const size_t n = boundaries.size() + 1;
+
+  std::atomic<size_t> next_partition{0};
+  std::atomic<bool> stop{false};
+  std::mutex status_mutex;
+  Status status;
+  auto scan = [&]() {
+    for (;;) {
+      const size_t p = next_partition.fetch_add(1);
+      if (p >= n || stop.load(std::memory_order_relaxed)) {
+        return;
+      }
+      Status s = ScanPartition(
+          db, column_family, options, snapshot, p,
+          p == 0 ? options.lower_bound : &boundaries[p - 1],
+          p == n - 1 ? options.upper_bound : &boundaries[p], callback, stop);
+      if (!s.ok()) {
+        std::lock_guard<std::mutex> lock(status_mutex);
+        if (status.ok()) {
+          status = s;
+        }
+        stop.store(true, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  // The calling thread is one of the scanning threads
+  std::vector<port::Thread> threads;
+  for (size_t i = 1; i < std::min(num_threads, n); i++) {
+    threads.emplace_back(scan);
+  }
+  scan();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (options.snapshot == nullptr) {
+    db->ReleaseSnapshot(snapshot);
+  }
+  return status;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !ROCKSDB_LITE
@@ -15,6 +15,7 @@
 #include <thread>
 
 #include "utilities/persistent_cache/block_cache_tier.h"
+#include "utilities/persistent_cache/zone_cache_tier.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -116,6 +117,22 @@ std::unique_ptr<PersistentCacheTier> NewBlockCache(
   return scache;
 }
 
+// create zone cache
+std::unique_ptr<PersistentCacheTier> NewZoneCache(
+    Env* env, const std::string& path,
+    const uint64_t max_size = std::numeric_limits<uint64_t>::max()) {
+  const uint32_t zone_size =
+      static_cast<uint32_t>(2 * 1024 * 1024 * kStressFactor);
+  auto log = std::make_shared<ConsoleLogger>();
+  PersistentCacheConfig opt(env, path, max_size, log,
+                            /*write_buffer_size=*/64 * 1024);
+  opt.cache_file_size = zone_size;
+  std::unique_ptr<PersistentCacheTier> scache(new ZoneCacheTier(opt));
+  Status s = scache->Open();
+  assert(s.ok());
+  return scache;
+}
+
 // create a new cache tier
 std::unique_ptr<PersistentTieredCache> NewTieredCache(
     Env* env, const std::string& path, const uint64_t max_volatile_cache_size,
@@ -224,6 +241,53 @@ TEST_F(PersistentCacheTierTest, DISABLED_BlockCacheInsertWithEviction) {
   }
 }
 
+// Zone cache tests
+TEST_F(PersistentCacheTierTest, ZoneCacheInsert) {
+  for (auto nthreads : {1, 5}) {
+    cache_ = NewZoneCache(Env::Default(), path_);
+    RunInsertTest(nthreads, /*max_keys=*/1024);
+  }
+}
+
+TEST_F(PersistentCacheTierTest, ZoneCacheInsertWithEviction) {
+  for (auto nthreads : {1, 5}) {
+    // Four zones of 64 blocks or so, of 1024 blocks inserted
+    cache_ = NewZoneCache(Env::Default(), path_,
+                          /*max_size=*/1 * 1024 * 1024);
+    RunInsertTestWithEviction(nthreads, /*max_keys=*/1024);
+  }
+}
+
+TEST_F(PersistentCacheTierTest, ZoneCacheEvictsLeastRecentlyRead) {
+  cache_ = NewZoneCache(Env::Default(), path_, /*max_size=*/1 * 1024 * 1024);
+  char data[4 * 1024];
+  memset(data, 'x', sizeof(data));
+  // Fill the four zones
+  const int kBlocksPerZone =
+      static_cast<int>(2 * 1024 * 1024 * kStressFactor / (sizeof(data) + 64));
+  int num_keys = 0;
+  for (; num_keys < 4 * kBlocksPerZone; num_keys++) {
+    ASSERT_OK(cache_->Insert("key" + ToString(num_keys), data, sizeof(data)));
+  }
+  // Reading the first zone makes the second one the least recently read
+  std::unique_ptr<char[]> block;
+  size_t block_size;
+  ASSERT_OK(cache_->Lookup("key0", &block, &block_size));
+  for (int i = 0; i < kBlocksPerZone; i++) {
+    ASSERT_OK(cache_->Insert("more" + ToString(i), data, sizeof(data)));
+  }
+  ASSERT_OK(cache_->Lookup("key0", &block, &block_size));
+  ASSERT_EQ(sizeof(data), block_size);
+  ASSERT_TRUE(cache_->Lookup("key" + ToString(kBlocksPerZone + 1), &block,
+                             &block_size)
+                  .IsNotFound());
+  ASSERT_OK(
+      cache_->Lookup("key" + ToString(num_keys - 1), &block, &block_size));
+
+  ASSERT_OK(cache_->Close());
+  cache_.reset();
+}
+
 // Tiered cache tests
 // DISABLED for now (expensive)
 TEST_F(PersistentCacheTierTest, DISABLED_TieredCacheInsert) {
@@ -294,6 +358,16 @@ TEST_F(PersistentCacheTierTest, FactoryTest) {
     ASSERT_TRUE(cache->Stats()[0].size());
     cache.reset();
   }
+
+  auto log = std::make_shared<ConsoleLogger>();
+  std::shared_ptr<PersistentCache> cache;
+  ASSERT_OK(NewZonedPersistentCache(Env::Default(), path_,
+                                    /*size=*/1 * 1024 * 1024 * 1024, log,
+                                    /*zone_size=*/1 * 1024 * 1024, &cache));
+  ASSERT_TRUE(cache);
+  ASSERT_EQ(cache->Stats().size(), 1);
+  ASSERT_TRUE(cache->Stats()[0].size());
+  cache.reset();
 }
 
 PersistentCacheDBTest::PersistentCacheDBTest()
@@ -0,0 +1,455 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#ifndef ROCKSDB_LITE
+
+#include "utilities/persistent_cache/zone_cache_tier.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+
+#include "logging/logging.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/mutexlock.h"
+#include "util/stop_watch.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// A block is
+//   fixed32: masked crc32c of the rest
+//   fixed32: key size
+//   fixed32: data size
+//   key
+//   data
+const size_t kBlockHeaderSize = 3 * sizeof(uint32_t);
+
+bool IsSegmentFile(const std::string& file) {
+  const std::string suffix = ".zc";
+  return file.size() > suffix.size() &&
+         file.compare(file.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+}  // namespace
+
+//
+// ZoneCacheSegment
+//
+ZoneCacheSegment::ZoneCacheSegment(Env* env, const std::string& dir,
+                                   const uint32_t id, const uint64_t capacity,
+                                   const size_t buffer_size)
+    : id_(id),
+      env_(env),
+      path_(dir + "/" + ToString(id) + ".zc"),
+      capacity_(capacity),
+      buffer_size_(buffer_size) {}
+
+Status ZoneCacheSegment::Create() {
+  Status s = env_->NewWritableFile(path_, &file_, EnvOptions());
+  if (s.ok()) {
+    s = env_->NewRandomAccessFile(path_, &reader_, EnvOptions());
+  }
+  return s;
+}
+
+Status ZoneCacheSegment::Append(const Slice& key, const Slice& data,
+                                uint64_t* offset, uint32_t* size) {
+  assert(file_);
+  const size_t block_size = kBlockHeaderSize + key.size() + data.size();
+  if (size_ + block_size > capacity_) {
+    return Status::NoSpace("zone cache segment full");
+  }
+  if (!buffer_.empty() && buffer_.size() + block_size > buffer_size_) {
+    Status s = FlushBuffer();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  std::string block;
+  block.reserve(block_size);
+  PutFixed32(&block, 0);
+  PutFixed32(&block, static_cast<uint32_t>(key.size()));
+  PutFixed32(&block, static_cast<uint32_t>(data.size()));
+  block.append(key.data(), key.size());
+  block.append(data.data(), data.size());
+  EncodeFixed32(&block[0], crc32c::Mask(crc32c::Value(
+                               block.data() + sizeof(uint32_t),
+                               block.size() - sizeof(uint32_t))));
+  {
+    MutexLock l(&mutex_);
+    buffer_.append(block);
+  }
+  *offset = size_;
+  *size = static_cast<uint32_t>(block_size);
+  size_ += block_size;
+  return Status::OK();
+}
+
+Status ZoneCacheSegment::FlushBuffer() {
+  // Synced for the blocks to be readable through reader_ on any file
+  // system, ZenFS included
+  Status s = file_->Append(buffer_);
+  if (s.ok()) {
+    s = file_->Sync();
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  MutexLock l(&mutex_);
+  flushed_size_ += buffer_.size();
+  buffer_.clear();
+  return Status::OK();
+}
+
+Status ZoneCacheSegment::Seal() {
+  if (!file_) {
+    return Status::OK();
+  }
+  Status s;
+  if (!buffer_.empty()) {
+    s = FlushBuffer();
+  }
+  if (s.ok()) {
+    s = file_->Close();
+  }
+  file_.reset();
+  return s;
+}
+
+Status ZoneCacheSegment::Read(const Slice& key, const uint64_t offset,
+                              const uint32_t size,
+                              std::unique_ptr<char[]>* data,
+                              size_t* data_size) {
+  std::unique_ptr<char[]> scratch(new char[size]);
+  Slice block;
+  {
+    MutexLock l(&mutex_);
+    if (offset >= flushed_size_) {
+      assert(offset - flushed_size_ + size <= buffer_.size());
+      memcpy(scratch.get(), buffer_.data() + (offset - flushed_size_), size);
+      block = Slice(scratch.get(), size);
+    }
+  }
+  if (block.empty()) {
+    Status s = reader_->Read(offset, size, &block, scratch.get());
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  if (block.size() != size ||
+      crc32c::Unmask(DecodeFixed32(block.data())) !=
+          crc32c::Value(block.data() + sizeof(uint32_t),
+                        block.size() - sizeof(uint32_t))) {
+    return Status::Corruption("zone cache block checksum mismatch", path_);
+  }
+  const uint32_t key_size = DecodeFixed32(block.data() + sizeof(uint32_t));
+  const uint32_t value_size =
+      DecodeFixed32(block.data() + 2 * sizeof(uint32_t));
+  if (kBlockHeaderSize + key_size + value_size != size ||
+      Slice(block.data() + kBlockHeaderSize, key_size) != key) {
+    return Status::Corruption("zone cache block mismatch", path_);
+  }
+  data->reset(new char[value_size]);
+  memcpy(data->get(), block.data() + kBlockHeaderSize + key_size, value_size);
+  *data_size = value_size;
+  return Status::OK();
+}
+
+Status ZoneCacheSegment::Delete() {
+  file_.reset();
+  reader_.reset();
+  return env_->DeleteFile(path_);
+}
+
+//
+// ZoneCacheTier
+//
+ZoneCacheTier::ZoneCacheTier(const PersistentCacheConfig& opt)
+    : opt_(opt),
+      max_segments_(std::max<uint64_t>(
+          opt.cache_size / std::max<uint32_t>(opt.cache_file_size, 1), 2)),
+      segments_(/*capacity=*/1024, /*load_factor=*/2.0, /*nlocks=*/1) {}
+
+Status ZoneCacheTier::Open() {
+  if (!opt_.env || opt_.path.empty() || !opt_.cache_file_size) {
+    return Status::InvalidArgument("empty or null args");
+  }
+
+  Status s = opt_.env->CreateDirIfMissing(opt_.path);
+  if (s.ok()) {
+    s = opt_.env->CreateDirIfMissing(GetCachePath());
+  }
+  if (!s.ok()) {
+    Error(opt_.log, "Error creating directory %s. %s", opt_.path.c_str(),
+          s.ToString().c_str());
+    return s;
+  }
+
+  // Remove the segments of the last run
+  std::vector<std::string> files;
+  s = opt_.env->GetChildren(GetCachePath(), &files);
+  for (size_t i = 0; s.ok() && i < files.size(); i++) {
+    if (IsSegmentFile(files[i])) {
+      s = opt_.env->DeleteFile(GetCachePath() + "/" + files[i]);
+    }
+  }
+  if (!s.ok()) {
+    Error(opt_.log, "Error cleaning up %s. %s", GetCachePath().c_str(),
+          s.ToString().c_str());
+    return s;
+  }
+
+  MutexLock l(&write_mutex_);
+  return NewSegment();
+}
+
+Status ZoneCacheTier::Close() {
+  MutexLock l(&write_mutex_);
+  Status s;
+  if (active_) {
+    s = active_->Seal();
+    --active_->refs_;
+    active_ = nullptr;
+  }
+  segments_.Clear([](ZoneCacheSegment* segment) { delete segment; });
+  blocks_.Clear([](ZoneCacheBlock* block) { delete block; });
+  num_segments_ = 0;
+  return s;
+}
+
+Status ZoneCacheTier::NewSegment() {
+  write_mutex_.AssertHeld();
+
+  if (active_) {
+    Status s = active_->Seal();
+    --active_->refs_;
+    active_ = nullptr;
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  while (num_segments_ >= max_segments_) {
+    using std::placeholders::_1;
+    std::unique_ptr<ZoneCacheSegment> segment(segments_.Evict(
+        std::bind(&ZoneCacheTier::RemoveBlocks, this, _1)));
+    if (!segment) {
+      // All of them are being read
+      return Status::TryAgain("no zone cache segment evictable");
+    }
+    num_segments_--;
+    stats_.segments_evicted_++;
+    Status s = segment->Delete();
+    if (!s.ok()) {
+      Error(opt_.log, "Error deleting zone cache segment %u. %s",
+            segment->id(), s.ToString().c_str());
+    }
+  }
+
+  std::unique_ptr<ZoneCacheSegment> segment(
+      new ZoneCacheSegment(opt_.env, GetCachePath(), next_segment_id_,
+                           opt_.cache_file_size, opt_.write_buffer_size));
+  Status s = segment->Create();
+  if (!s.ok()) {
+    Error(opt_.log, "Error creating zone cache segment %u. %s",
+          next_segment_id_, s.ToString().c_str());
+    return s;
+  }
+  next_segment_id_++;
+  if (!segments_.Insert(segment.get())) {
+    return Status::IOError("Error inserting to segment index");
+  }
+  num_segments_++;
+  // Segments are inserted at the cold end of the LRU. Finding it moves it
+  // to the hot end, ahead of the segments not read since they were
+  // written, and pins it.
+  bool found = segments_.Find(segment.get(), &active_);
+  assert(found);
+  assert(active_ == segment.get());
+  (void)found;
+  segment.release();
+  return Status::OK();
+}
+
+void ZoneCacheTier::RemoveBlocks(ZoneCacheSegment* segment) {
+  for (const auto& key : segment->keys()) {
+    ZoneCacheBlock lookup_key(key);
+    ZoneCacheBlock* block = nullptr;
+    port::RWMutex* rlock = nullptr;
+    if (!blocks_.Find(&lookup_key, &block, &rlock)) {
+      // Erased
+      continue;
+    }
+    // Inserted again into a later segment after being erased here
+    const bool in_segment = block->segment_id_ == segment->id();
+    rlock->ReadUnlock();
+    if (in_segment && blocks_.Erase(&lookup_key, &block)) {
+      delete block;
+    }
+  }
+  segment->keys().clear();
+}
+
+Status ZoneCacheTier::Insert(const Slice& key, const char* data,
+                             const size_t size) {
+  assert(key.size());
+  if (kBlockHeaderSize + key.size() + size > opt_.cache_file_size) {
+    stats_.insert_dropped_++;
+    return Status::InvalidArgument("block larger than a zone cache segment");
+  }
+  StopWatchNano timer(opt_.env, /*auto_start=*/true);
+
+  MutexLock l(&write_mutex_);
+  ZoneCacheBlock lookup_key(key);
+  ZoneCacheBlock* block = nullptr;
+  port::RWMutex* rlock = nullptr;
+  if (blocks_.Find(&lookup_key, &block, &rlock)) {
+    // the key already exists, this is duplicate insert
+    rlock->ReadUnlock();
+    return Status::OK();
+  }
+
+  uint64_t offset = 0;
+  uint32_t block_size = 0;
+  Status s = active_ ? active_->Append(key, Slice(data, size), &offset,
+                                       &block_size)
+                     : Status::NoSpace();
+  if (s.IsNoSpace()) {
+    s = NewSegment();
+    if (s.ok()) {
+      s = active_->Append(key, Slice(data, size), &offset, &block_size);
+    }
+  }
+  if (!s.ok()) {
+    stats_.insert_dropped_++;
+    return s;
+  }
+
+  std::unique_ptr<ZoneCacheBlock> new_block(
+      new ZoneCacheBlock(key, active_->id(), offset, block_size));
+  if (!blocks_.Insert(new_block.get())) {
+    return Status::IOError("Unexpected error inserting to index");
+  }
+  new_block.release();
+  active_->keys().push_back(key.ToString());
+
+  stats_.bytes_written_.Add(size);
+  stats_.write_latency_.Add(timer.ElapsedNanos() / 1000);
+  return Status::OK();
+}
+
+Status ZoneCacheTier::Lookup(const Slice& key, std::unique_ptr<char[]>* data,
+                             size_t* size) {
+  StopWatchNano timer(opt_.env, /*auto_start=*/true);
+
+  ZoneCacheBlock lookup_key(key);
+  ZoneCacheBlock* block = nullptr;
+  port::RWMutex* rlock = nullptr;
+  if (!blocks_.Find(&lookup_key, &block, &rlock)) {
+    stats_.cache_misses_++;
+    stats_.read_miss_latency_.Add(timer.ElapsedNanos() / 1000);
+    return Status::NotFound("zonecache: key not found");
+  }
+  ZoneCacheSegment segment_key(block->segment_id_);
+  const uint64_t offset = block->offset_;
+  const uint32_t block_size = block->size_;
+  rlock->ReadUnlock();
+
+  // Moves the segment to the hot end of the LRU
+  ZoneCacheSegment* segment = nullptr;
+  if (!segments_.Find(&segment_key, &segment)) {
+    // evicted between the two lookups
+    stats_.cache_misses_++;
+    stats_.read_miss_latency_.Add(timer.ElapsedNanos() / 1000);
+    return Status::NotFound("zonecache: segment not found");
+  }
+  Status s = segment->Read(key, offset, block_size, data, size);
+  --segment->refs_;
+  if (!s.ok()) {
+    stats_.cache_misses_++;
+    stats_.cache_errors_++;
+    stats_.read_miss_latency_.Add(timer.ElapsedNanos() / 1000);
+    return Status::NotFound("zonecache: error reading data");
+  }
+
+  stats_.bytes_read_.Add(*size);
+  stats_.cache_hits_++;
+  stats_.read_hit_latency_.Add(timer.ElapsedNanos() / 1000);
+  return Status::OK();
+}
+
+bool ZoneCacheTier::Erase(const Slice& key) {
+  // The key stays in the keys of its segment, RemoveBlocks() skips it
+  MutexLock l(&write_mutex_);
+  ZoneCacheBlock lookup_key(key);
+  ZoneCacheBlock* block = nullptr;
+  if (!blocks_.Erase(&lookup_key, &block)) {
+    return false;
+  }
+  delete block;
+  return true;
+}
+
+template <class T>
+static void AddStat(std::map<std::string, double>* stats,
+                    const std::string& key, const T& t) {
+  stats->insert({key, static_cast<double>(t)});
+}
+
+PersistentCache::StatsType ZoneCacheTier::Stats() {
+  std::map<std::string, double> stats;
+  AddStat(&stats, "persistentcache.zonecachetier.bytes_written",
+          stats_.bytes_written_.Average());
+  AddStat(&stats, "persistentcache.zonecachetier.bytes_read",
+          stats_.bytes_read_.Average());
+  AddStat(&stats, "persistentcache.zonecachetier.insert_dropped",
+          stats_.insert_dropped_);
+  AddStat(&stats, "persistentcache.zonecachetier.cache_hits",
+          stats_.cache_hits_);
+  AddStat(&stats, "persistentcache.zonecachetier.cache_misses",
+          stats_.cache_misses_);
+  AddStat(&stats, "persistentcache.zonecachetier.cache_errors",
+          stats_.cache_errors_);
+  AddStat(&stats, "persistentcache.zonecachetier.segments_evicted",
+          stats_.segments_evicted_);
+  AddStat(&stats, "persistentcache.zonecachetier.read_hit_latency",
+          stats_.read_hit_latency_.Average());
+  AddStat(&stats, "persistentcache.zonecachetier.read_miss_latency",
+          stats_.read_miss_latency_.Average());
+  AddStat(&stats, "persistentcache.zonecachetier.write_latency",
+          stats_.write_latency_.Average());
+
+  auto out = PersistentCacheTier::Stats();
+  out.push_back(stats);
+  return out;
+}
+
+Status NewZonedPersistentCache(Env* const env, const std::string& path,
+                               const uint64_t size,
+                               const std::shared_ptr<Logger>& log,
+                               const uint32_t zone_size,
+                               std::shared_ptr<PersistentCache>* cache) {
+  if (!cache) {
+    return Status::IOError("invalid argument cache");
+  }
+
+  auto opt = PersistentCacheConfig(env, path, size, log);
+  opt.cache_file_size = zone_size;
+  auto pcache = std::make_shared<ZoneCacheTier>(opt);
+  Status s = pcache->Open();
+  if (!s.ok()) {
+    return s;
+  }
+
+  *cache = pcache;
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // ifndef ROCKSDB_LITE
@@ -0,0 +1,190 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "monitoring/histogram.h"
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/persistent_cache.h"
+#include "utilities/persistent_cache/hash_table.h"
+#include "utilities/persistent_cache/hash_table_evictable.h"
+#include "utilities/persistent_cache/lrulist.h"
+#include "utilities/persistent_cache/persistent_cache_tier.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A segment of the zone cache: a file written once from start to end, in
+// write buffer sized pieces, and deleted whole. Blocks still in the write
+// buffer are read from there.
+class ZoneCacheSegment : public LRUElement<ZoneCacheSegment> {
+ public:
+  // For lookups by id
+  explicit ZoneCacheSegment(const uint32_t id) : id_(id) {}
+
+  ZoneCacheSegment(Env* env, const std::string& dir, const uint32_t id,
+                   const uint64_t capacity, const size_t buffer_size);
+
+  // No copying allowed
+  ZoneCacheSegment(const ZoneCacheSegment&) = delete;
+  void operator=(const ZoneCacheSegment&) = delete;
+
+  Status Create();
+
+  // Appends a block, returning where it is in *offset and *size. Returns
+  // NoSpace if the segment is too full for it.
+  Status Append(const Slice& key, const Slice& data, uint64_t* offset,
+                uint32_t* size);
+
+  // Writes out the buffered blocks and closes the file for writing
+  Status Seal();
+
+  // Reads the block of key at offset
+  Status Read(const Slice& key, const uint64_t offset, const uint32_t size,
+              std::unique_ptr<char[]>* data, size_t* data_size);
+
+  Status Delete();
+
+  uint32_t id() const { return id_; }
+
+  // The keys of the blocks appended, guarded by the writer of the tier
+  std::vector<std::string>& keys() { return keys_; }
+
+ private:
+  Status FlushBuffer();
+
+  const uint32_t id_;
+  Env* const env_ = nullptr;
+  const std::string path_;
+  const uint64_t capacity_ = 0;
+  const size_t buffer_size_ = 0;
+  std::unique_ptr<WritableFile> file_;
+  std::unique_ptr<RandomAccessFile> reader_;
+  uint64_t size_ = 0;  // Including the buffer
+  std::vector<std::string> keys_;
+  port::Mutex mutex_;  // Guards the two below
+  std::string buffer_;
+  uint64_t flushed_size_ = 0;
+};
+
+// A persistent cache tier for zoned block devices. The blocks are appended
+// to the cache as a log of segments of cache_file_size bytes each, and the
+// cache is evicted a segment at a time, the least recently read first. No
+// block is ever overwritten or moved, so with the cache on ZenFS and
+// cache_file_size set to the zone capacity, each segment fills one zone
+// and evicting it resets the zone, without any device-level write
+// amplification.
+//
+// The index of the blocks, and of the segments for the LRU, is kept in
+// memory. The cache does not outlive the process: Open() removes the
+// segments left behind.
+class ZoneCacheTier : public PersistentCacheTier {
+ public:
+  explicit ZoneCacheTier(const PersistentCacheConfig& opt);
+
+  virtual ~ZoneCacheTier() { Close().PermitUncheckedError(); }
+
+  Status Insert(const Slice& key, const char* data, const size_t size) override;
+  Status Lookup(const Slice& key, std::unique_ptr<char[]>* data,
+                size_t* size) override;
+  Status Open() override;
+  Status Close() override;
+  bool Erase(const Slice& key) override;
+
+  bool IsCompressed() override { return opt_.is_compressed; }
+
+  std::string GetPrintableOptions() const override { return opt_.ToString(); }
+
+  PersistentCache::StatsType Stats() override;
+
+ private:
+  struct ZoneCacheBlock {
+    explicit ZoneCacheBlock(const Slice& key, const uint32_t segment_id = 0,
+                            const uint64_t offset = 0, const uint32_t size = 0)
+        : key_(key.ToString()),
+          segment_id_(segment_id),
+          offset_(offset),
+          size_(size) {}
+
+    std::string key_;
+    uint32_t segment_id_;
+    uint64_t offset_;
+    uint32_t size_;
+  };
+
+  // Block index
+  //
+  // key => ZoneCacheBlock
+  struct BlockHash {
+    size_t operator()(ZoneCacheBlock* node) const {
+      return std::hash<std::string>()(node->key_);
+    }
+  };
+
+  struct BlockEqual {
+    size_t operator()(ZoneCacheBlock* lhs, ZoneCacheBlock* rhs) const {
+      return lhs->key_ == rhs->key_;
+    }
+  };
+
+  // Segment index
+  //
+  // segment id => ZoneCacheSegment
+  struct SegmentHash {
+    uint64_t operator()(const ZoneCacheSegment* rec) {
+      return std::hash<uint32_t>()(rec->id());
+    }
+  };
+
+  struct SegmentEqual {
+    uint64_t operator()(const ZoneCacheSegment* lhs,
+                        const ZoneCacheSegment* rhs) {
+      return lhs->id() == rhs->id();
+    }
+  };
+
+  struct Statistics {
+    HistogramImpl bytes_written_;
+    HistogramImpl bytes_read_;
+    HistogramImpl read_hit_latency_;
+    HistogramImpl read_miss_latency_;
+    HistogramImpl write_latency_;
+    std::atomic<uint64_t> cache_hits_{0};
+    std::atomic<uint64_t> cache_misses_{0};
+    std::atomic<uint64_t> cache_errors_{0};
+    std::atomic<uint64_t> insert_dropped_{0};
+    std::atomic<uint64_t> segments_evicted_{0};
+  };
+
+  // Get cache directory path
+  std::string GetCachePath() const { return opt_.path + "/zcache"; }
+  // Seals the segment being written and starts a new one, evicting the
+  // least recently read segment if the cache is full
+  Status NewSegment();
+  // Drops the blocks of an evicted segment from the block index
+  void RemoveBlocks(ZoneCacheSegment* segment);
+
+  const PersistentCacheConfig opt_;
+  const uint64_t max_segments_;
+  // The segments by LRU. A single lock stripe, so that the LRU list spans
+  // all of them.
+  EvictableHashTable<ZoneCacheSegment, SegmentHash, SegmentEqual> segments_;
+  HashTable<ZoneCacheBlock*, BlockHash, BlockEqual> blocks_;
+  Statistics stats_;
+  port::Mutex write_mutex_;  // Guards the members below
+  ZoneCacheSegment* active_ = nullptr;  // Pinned while written
+  uint32_t next_segment_id_ = 0;
+  uint64_t num_segments_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif
@@ -6,11 +6,15 @@
 #include "utilities/simulator_cache/cache_simulator.h"
 #include <algorithm>
 #include "db/dbformat.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 namespace {
 const std::string kGhostCachePrefix = "ghost_";
+// Block keys are sampled by the low bits of their hash
+const uint64_t kSamplingModulus = uint64_t{1} << 24;
 }  // namespace
 
 GhostCache::GhostCache(std::shared_ptr<Cache> sim_cache)
@@ -202,25 +206,38 @@ void HybridRowBlockCacheSimulator::Access(const BlockCacheTraceRecord& access) {
 
 BlockCacheTraceSimulator::BlockCacheTraceSimulator(
     uint64_t warmup_seconds, uint32_t downsample_ratio,
-    const std::vector<CacheConfiguration>& cache_configurations)
+    const std::vector<CacheConfiguration>& cache_configurations,
+    uint32_t num_threads, double sampling_rate)
     : warmup_seconds_(warmup_seconds),
       downsample_ratio_(downsample_ratio),
-      cache_configurations_(cache_configurations) {}
+      cache_configurations_(cache_configurations),
+      num_threads_(std::max(num_threads, 1u)),
+      sampling_threshold_(sampling_rate > 0 && sampling_rate < 1
+                              ? static_cast<uint64_t>(sampling_rate *
+                                                      kSamplingModulus)
+                              : kSamplingModulus),
+      sampling_rate_(static_cast<double>(sampling_threshold_) /
+                     kSamplingModulus),
+      cv_(&mutex_) {}
+
+BlockCacheTraceSimulator::~BlockCacheTraceSimulator() { Finish(); }
 
 Status BlockCacheTraceSimulator::InitializeCaches() {
   for (auto const& config : cache_configurations_) {
     for (auto cache_capacity : config.cache_capacities) {
       // Scale down the cache capacity since the trace contains accesses on
       // 1/'downsample_ratio' blocks.
-      uint64_t simulate_cache_capacity = cache_capacity / downsample_ratio_;
+      // Scale down the cache capacity by the sampling rate too.
+      uint64_t simulate_cache_capacity = static_cast<uint64_t>(
+          cache_capacity / downsample_ratio_ * sampling_rate_);
       std::shared_ptr<CacheSimulator> sim_cache;
       std::unique_ptr<GhostCache> ghost_cache;
       std::string cache_name = config.cache_name;
       if (cache_name.find(kGhostCachePrefix) != std::string::npos) {
-        ghost_cache.reset(new GhostCache(
-            NewLRUCache(config.ghost_cache_capacity, /*num_shard_bits=*/1,
-                        /*strict_capacity_limit=*/false,
-                        /*high_pri_pool_ratio=*/0)));
+        ghost_cache.reset(new GhostCache(NewLRUCache(
+            static_cast<size_t>(config.ghost_cache_capacity * sampling_rate_),
+            /*num_shard_bits=*/1, /*strict_capacity_limit=*/false,
+            /*high_pri_pool_ratio=*/0)));
         cache_name = cache_name.substr(kGhostCachePrefix.size());
       }
       if (cache_name == "lru") {
@@ -229,6 +246,14 @@ Status BlockCacheTraceSimulator::InitializeCaches() {
             NewLRUCache(simulate_cache_capacity, config.num_shard_bits,
                         /*strict_capacity_limit=*/false,
                         /*high_pri_pool_ratio=*/0));
+      } else if (cache_name == "lru_tinylfu") {
+        LRUCacheOptions cache_opts(simulate_cache_capacity,
+                                   config.num_shard_bits,
+                                   /*strict_capacity_limit=*/false,
+                                   /*high_pri_pool_ratio=*/0);
+        cache_opts.tiny_lfu_admission = true;
+        sim_cache = std::make_shared<CacheSimulator>(std::move(ghost_cache),
+                                                     NewLRUCache(cache_opts));
       } else if (cache_name == "lru_priority") {
         sim_cache = std::make_shared<PrioritizedCacheSimulator>(
             std::move(ghost_cache),
@@ -257,10 +282,24 @@ Status BlockCacheTraceSimulator::InitializeCaches() {
       sim_caches_[config].push_back(sim_cache);
     }
   }
+  if (num_threads_ > 1) {
+    for (auto const& config_caches : sim_caches_) {
+      for (auto const& sim_cache : config_caches.second) {
+        all_caches_.push_back(sim_cache.get());
+      }
+    }
+    size_t num_workers = std::min<size_t>(num_threads_, all_caches_.size());
+    batch_.reset(new Batch());
+    queues_.resize(num_workers);
+    for (size_t i = 0; i < num_workers; i++) {
+      workers_.emplace_back(&BlockCacheTraceSimulator::WorkerThread, this, i);
+    }
+  }
   return Status::OK();
 }
 
 void BlockCacheTraceSimulator::Access(const BlockCacheTraceRecord& access) {
+  assert(!finished_);
   if (trace_start_time_ == 0) {
     trace_start_time_ = access.access_timestamp;
   }
@@ -268,13 +307,32 @@ void BlockCacheTraceSimulator::Access(const BlockCacheTraceRecord& access) {
   if (!warmup_complete_ &&
       trace_start_time_ + warmup_seconds_ * kMicrosInSecond <=
           access.access_timestamp) {
-    for (auto& config_caches : sim_caches_) {
-      for (auto& sim_cache : config_caches.second) {
-        sim_cache->reset_counter();
+    if (!workers_.empty()) {
+      if (!batch_->records.empty()) {
+        SubmitBatch();
+      }
+      batch_->reset_counters = true;
+    } else {
+      for (auto& config_caches : sim_caches_) {
+        for (auto& sim_cache : config_caches.second) {
+          sim_cache->reset_counter();
+        }
       }
     }
     warmup_complete_ = true;
   }
+  if (sampling_threshold_ < kSamplingModulus &&
+      (GetSliceHash64(access.block_key) & (kSamplingModulus - 1)) >=
+          sampling_threshold_) {
+    return;
+  }
+  if (!workers_.empty()) {
+    batch_->records.push_back(access);
+    if (batch_->records.size() >= kBatchSize) {
+      SubmitBatch();
+    }
+    return;
+  }
   for (auto& config_caches : sim_caches_) {
     for (auto& sim_cache : config_caches.second) {
       sim_cache->Access(access);
@@ -282,4 +340,67 @@ void BlockCacheTraceSimulator::Access(const BlockCacheTraceRecord& access) {
   }
 }
 
+void BlockCacheTraceSimulator::SubmitBatch() {
+  std::shared_ptr<const Batch> batch(batch_.release());
+  batch_.reset(new Batch());
+  batch_->records.reserve(kBatchSize);
+  MutexLock l(&mutex_);
+  // Bounds the memory used by records that are not simulated yet
+  while (std::any_of(queues_.begin(), queues_.end(),
+                     [](const std::deque<std::shared_ptr<const Batch>>& q) {
+                       return q.size() >= kMaxQueuedBatches;
+                     })) {
+    cv_.Wait();
+  }
+  for (auto& queue : queues_) {
+    queue.push_back(batch);
+  }
+  cv_.SignalAll();
+}
+
+void BlockCacheTraceSimulator::WorkerThread(size_t worker) {
+  while (true) {
+    std::shared_ptr<const Batch> batch;
+    {
+      MutexLock l(&mutex_);
+      while (queues_[worker].empty() && !finished_) {
+        cv_.Wait();
+      }
+      if (queues_[worker].empty()) {
+        break;
+      }
+      batch = std::move(queues_[worker].front());
+      queues_[worker].pop_front();
+      cv_.SignalAll();
+    }
+    for (size_t i = worker; i < all_caches_.size(); i += queues_.size()) {
+      CacheSimulator* sim_cache = all_caches_[i];
+      if (batch->reset_counters) {
+        sim_cache->reset_counter();
+      }
+      for (const BlockCacheTraceRecord& access : batch->records) {
+        sim_cache->Access(access);
+      }
+    }
+  }
+}
+
+void BlockCacheTraceSimulator::Finish() {
+  if (workers_.empty()) {
+    return;
+  }
+  if (!batch_->records.empty() || batch_->reset_counters) {
+    SubmitBatch();
+  }
+  {
+    MutexLock l(&mutex_);
+    finished_ = true;
+    cv_.SignalAll();
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -5,9 +5,11 @@
 
 #pragma once
 
+#include <deque>
 #include <unordered_map>
 
 #include "cache/lru_cache.h"
+#include "port/port.h"
 #include "trace_replay/block_cache_tracer.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -193,14 +195,26 @@ class HybridRowBlockCacheSimulator : public PrioritizedCacheSimulator {
 
 // A block cache simulator that reports miss ratio curves given a set of cache
 // configurations.
+//
+// With num_threads > 1, the simulated caches are partitioned among as many
+// worker threads. Access() only appends the record to a batch, and each full
+// batch is handed to all workers, so a trace is read once however many
+// configurations are simulated. Finish() must then be called before the
+// results in sim_caches() are read.
+//
+// With sampling_rate < 1, only the accesses to a pseudo-random subset of the
+// block keys, selected by hash as in SHARDS (Waldspurger et al., FAST '15),
+// are simulated, on caches scaled down by the same rate. This approximates
+// the miss ratio curve at a fraction of the cost.
 class BlockCacheTraceSimulator {
  public:
   // warmup_seconds: The number of seconds to warmup simulated caches. The
   // hit/miss counters are reset after the warmup completes.
   BlockCacheTraceSimulator(
       uint64_t warmup_seconds, uint32_t downsample_ratio,
-      const std::vector<CacheConfiguration>& cache_configurations);
-  ~BlockCacheTraceSimulator() = default;
+      const std::vector<CacheConfiguration>& cache_configurations,
+      uint32_t num_threads = 1, double sampling_rate = 1.0);
+  ~BlockCacheTraceSimulator();
   // No copy and move.
   BlockCacheTraceSimulator(const BlockCacheTraceSimulator&) = delete;
   BlockCacheTraceSimulator& operator=(const BlockCacheTraceSimulator&) = delete;
@@ -211,6 +225,10 @@ class BlockCacheTraceSimulator {
 
   void Access(const BlockCacheTraceRecord& access);
 
+  // Waits until all accesses have been simulated. No more accesses may be
+  // added afterwards.
+  void Finish();
+
   const std::map<CacheConfiguration,
                  std::vector<std::shared_ptr<CacheSimulator>>>&
   sim_caches() const {
@@ -218,14 +236,40 @@ class BlockCacheTraceSimulator {
   }
 
  private:
+  struct Batch {
+    // Whether the warmup completed right before the first record
+    bool reset_counters = false;
+    std::vector<BlockCacheTraceRecord> records;
+  };
+
+  static const size_t kBatchSize = 4096;
+  static const size_t kMaxQueuedBatches = 16;
+
+  void SubmitBatch();
+  void WorkerThread(size_t worker);
+
   const uint64_t warmup_seconds_;
   const uint32_t downsample_ratio_;
   const std::vector<CacheConfiguration> cache_configurations_;
+  const uint32_t num_threads_;
+  // Accesses are simulated if the hash of their block key is below this
+  const uint64_t sampling_threshold_;
+  const double sampling_rate_;
 
   bool warmup_complete_ = false;
   std::map<CacheConfiguration, std::vector<std::shared_ptr<CacheSimulator>>>
       sim_caches_;
   uint64_t trace_start_time_ = 0;
+
+  // With worker threads, worker i simulates the caches at positions i,
+  // i + queues_.size(), ... and consumes the batches in queues_[i].
+  std::vector<CacheSimulator*> all_caches_;
+  std::unique_ptr<Batch> batch_;
+  port::Mutex mutex_;
+  port::CondVar cv_;
+  std::vector<std::deque<std::shared_ptr<const Batch>>> queues_;
+  bool finished_ = false;
+  std::vector<port::Thread> workers_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -9,6 +9,7 @@
 #include "rocksdb/env.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
+#include "util/random.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace {
@@ -158,6 +159,127 @@ TEST_F(CacheSimulatorTest, GhostCacheSimulator) {
   ASSERT_EQ(100, cache_simulator->miss_ratio_stats().miss_ratio());
 }
 
+TEST_F(CacheSimulatorTest, TinyLfuCacheSimulator) {
+  const uint64_t kBlockSize = 4096;
+  CacheConfiguration lru_config;
+  lru_config.cache_name = "lru";
+  lru_config.num_shard_bits = 0;
+  lru_config.ghost_cache_capacity = 0;
+  lru_config.cache_capacities = {64 * kBlockSize};
+  CacheConfiguration tiny_lfu_config = lru_config;
+  tiny_lfu_config.cache_name = "lru_tinylfu";
+  BlockCacheTraceSimulator simulator(/*warmup_seconds=*/0,
+                                     /*downsample_ratio=*/1,
+                                     {lru_config, tiny_lfu_config});
+  ASSERT_OK(simulator.InitializeCaches());
+
+  // A hot set of half the cache capacity interleaved with long range scans
+  // of twice the capacity, which fill the cache.
+  BlockCacheTraceRecord access = GenerateGetRecord(kGetId);
+  for (int round = 0; round < 20; round++) {
+    access.caller = TableReaderCaller::kUserGet;
+    for (int i = 0; i < 32; i++) {
+      access.block_key = kBlockKeyPrefix + "hot" + std::to_string(i);
+      simulator.Access(access);
+    }
+    access.caller = TableReaderCaller::kUserIterator;
+    for (int i = 0; i < 128; i++) {
+      access.block_key = kBlockKeyPrefix + "scan" + std::to_string(round) +
+                         "_" + std::to_string(i);
+      simulator.Access(access);
+    }
+  }
+  const MissRatioStats& lru_stats =
+      simulator.sim_caches().at(lru_config)[0]->miss_ratio_stats();
+  const MissRatioStats& tiny_lfu_stats =
+      simulator.sim_caches().at(tiny_lfu_config)[0]->miss_ratio_stats();
+  ASSERT_EQ(20 * 160, lru_stats.total_accesses());
+  ASSERT_EQ(20 * 160, tiny_lfu_stats.total_accesses());
+  // Every access misses plain LRU, while TinyLFU keeps the hot set
+  ASSERT_EQ(100, lru_stats.miss_ratio());
+  ASSERT_LT(tiny_lfu_stats.miss_ratio(), 85);
+}
+
+TEST_F(CacheSimulatorTest, MultiThreadedCacheSimulator) {
+  const uint64_t kBlockSize = 4096;
+  std::vector<CacheConfiguration> configs(3);
+  configs[0].cache_name = "lru";
+  configs[1].cache_name = "lru_tinylfu";
+  configs[2].cache_name = "ghost_lru";
+  for (auto& config : configs) {
+    config.num_shard_bits = 0;
+    config.ghost_cache_capacity = kGhostCacheSize;
+    config.cache_capacities = {16 * kBlockSize, 64 * kBlockSize,
+                               256 * kBlockSize};
+  }
+  BlockCacheTraceSimulator single_threaded(/*warmup_seconds=*/0,
+                                           /*downsample_ratio=*/1, configs);
+  BlockCacheTraceSimulator multi_threaded(/*warmup_seconds=*/0,
+                                          /*downsample_ratio=*/1, configs,
+                                          /*num_threads=*/4);
+  ASSERT_OK(single_threaded.InitializeCaches());
+  ASSERT_OK(multi_threaded.InitializeCaches());
+
+  // Skewed accesses over 1024 blocks, spanning several batches
+  Random rnd(301);
+  BlockCacheTraceRecord access = GenerateGetRecord(kGetId);
+  for (int i = 0; i < 20000; i++) {
+    access.block_key = kBlockKeyPrefix + std::to_string(rnd.Skewed(10));
+    single_threaded.Access(access);
+    multi_threaded.Access(access);
+  }
+  single_threaded.Finish();
+  multi_threaded.Finish();
+
+  for (auto const& config : configs) {
+    const auto& expected_caches = single_threaded.sim_caches().at(config);
+    const auto& caches = multi_threaded.sim_caches().at(config);
+    ASSERT_EQ(expected_caches.size(), caches.size());
+    for (size_t i = 0; i < caches.size(); i++) {
+      const MissRatioStats& expected = expected_caches[i]->miss_ratio_stats();
+      const MissRatioStats& stats = caches[i]->miss_ratio_stats();
+      ASSERT_EQ(20000, stats.total_accesses());
+      ASSERT_EQ(expected.total_accesses(), stats.total_accesses());
+      ASSERT_EQ(expected.total_misses(), stats.total_misses());
+    }
+  }
+}
+
+TEST_F(CacheSimulatorTest, SampledCacheSimulator) {
+  const uint64_t kBlockSize = 4096;
+  CacheConfiguration config;
+  config.cache_name = "lru";
+  config.num_shard_bits = 0;
+  config.ghost_cache_capacity = 0;
+  config.cache_capacities = {1024 * kBlockSize};
+  BlockCacheTraceSimulator full(/*warmup_seconds=*/0, /*downsample_ratio=*/1,
+                                {config});
+  BlockCacheTraceSimulator sampled(/*warmup_seconds=*/0,
+                                   /*downsample_ratio=*/1, {config},
+                                   /*num_threads=*/1, /*sampling_rate=*/0.25);
+  ASSERT_OK(full.InitializeCaches());
+  ASSERT_OK(sampled.InitializeCaches());
+
+  Random rnd(301);
+  BlockCacheTraceRecord access = GenerateGetRecord(kGetId);
+  for (int i = 0; i < 100000; i++) {
+    access.block_key = kBlockKeyPrefix + std::to_string(rnd.Uniform(4096));
+    full.Access(access);
+    sampled.Access(access);
+  }
+
+  const MissRatioStats& full_stats =
+      full.sim_caches().at(config)[0]->miss_ratio_stats();
+  const MissRatioStats& sampled_stats =
+      sampled.sim_caches().at(config)[0]->miss_ratio_stats();
+  ASSERT_EQ(100000, full_stats.total_accesses());
+  // Only the accesses to about a quarter of the blocks are simulated, on a
+  // cache of a quarter of the size, which gives a close miss ratio.
+  ASSERT_LT(sampled_stats.total_accesses(), 100000);
+  ASSERT_GT(sampled_stats.total_accesses(), 0);
+  ASSERT_NEAR(full_stats.miss_ratio(), sampled_stats.miss_ratio(), 5);
+}
+
 TEST_F(CacheSimulatorTest, PrioritizedCacheSimulator) {
   const BlockCacheTraceRecord& access = GenerateGetRecord(kGetId);
   std::shared_ptr<Cache> sim_cache =
@@ -50,8 +50,9 @@ Status FileTraceReader::Read(std::string* data) {
   *data = result_.ToString();
   offset_ += kTraceMetadataSize;
 
+  // result_ points into the file mapping rather than buffer_ under mmap reads
   uint32_t payload_len =
-      DecodeFixed32(&buffer_[kTraceTimestampSize + kTraceTypeSize]);
+      DecodeFixed32(data->data() + kTraceTimestampSize + kTraceTypeSize);
 
   // Read Payload
   unsigned int bytes_to_read = payload_len;
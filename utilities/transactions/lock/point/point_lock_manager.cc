@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <deque>
 #include <mutex>
 
 #include "monitoring/perf_context_imp.h"
@@ -45,6 +46,15 @@ struct LockInfo {
   }
 };
 
+// A transaction waiting for the lock of a key, with
+// TransactionDBOptions::per_key_lock_wait_queues
+struct KeyLockWaiter {
+  bool exclusive;
+  std::shared_ptr<TransactionDBCondVar> cv;
+
+  explicit KeyLockWaiter(bool ex) : exclusive(ex) {}
+};
+
 struct LockMapStripe {
   explicit LockMapStripe(std::shared_ptr<TransactionDBMutexFactory> factory) {
     stripe_mutex = factory->AllocateMutex();
@@ -62,6 +72,10 @@ struct LockMapStripe {
   // Locked keys mapped to the info about the transactions that locked them.
   // TODO(agiardullo): Explore performance of other data structures.
   std::unordered_map<std::string, LockInfo> keys;
+
+  // The transactions waiting for the locks of keys, in the order they are
+  // woken up in. Only used with TransactionDBOptions::per_key_lock_wait_queues.
+  std::unordered_map<std::string, std::deque<KeyLockWaiter*>> wait_queues;
 };
 
 // Map of #num_stripes LockMapStripes
@@ -166,6 +180,7 @@ PointLockManager::PointLockManager(PessimisticTransactionDB* txn_db,
     : txn_db_impl_(txn_db),
       default_num_stripes_(opt.num_stripes),
       max_num_locks_(opt.max_num_locks),
+      per_key_lock_wait_queues_(opt.per_key_lock_wait_queues),
       lock_maps_cache_(new ThreadLocalPtr(&UnrefLockMapsCache)),
       dlock_buffer_(opt.max_num_deadlocks),
       mutex_factory_(opt.custom_mutex_factory
@@ -346,6 +361,7 @@ Status PointLockManager::AcquireWithTimeout(
     // If we weren't able to acquire the lock, we will keep retrying as long
     // as the timeout allows.
     bool timed_out = false;
+    KeyLockWaiter waiter(lock_info.exclusive);
     do {
       // Decide how long to wait
       int64_t cv_end_time = -1;
@@ -366,6 +382,9 @@ Status PointLockManager::AcquireWithTimeout(
           if (IncrementWaiters(txn, wait_ids, key, column_family_id,
                                lock_info.exclusive, env)) {
             result = Status::Busy(Status::SubCode::kDeadlock);
+            if (waiter.cv != nullptr) {
+              RemoveKeyLockWaiter(stripe, key, &waiter, true /* gave_up */);
+            }
             stripe->stripe_mutex->UnLock();
             return result;
           }
@@ -373,15 +392,32 @@ Status PointLockManager::AcquireWithTimeout(
         txn->SetWaitingTxn(wait_ids, column_family_id, &key);
       }
 
+      if (per_key_lock_wait_queues_ && waiter.cv == nullptr) {
+        waiter.cv = mutex_factory_->AllocateCondVar();
+        auto& queue = stripe->wait_queues[key];
+        auto key_iter = stripe->keys.find(key);
+        if (key_iter != stripe->keys.end() &&
+            std::find(key_iter->second.txn_ids.begin(),
+                      key_iter->second.txn_ids.end(),
+                      txn->GetID()) != key_iter->second.txn_ids.end()) {
+          // Upgrading the shared lock it holds, which the other waiters wait
+          // for anyway
+          queue.push_front(&waiter);
+        } else {
+          queue.push_back(&waiter);
+        }
+      }
+      TransactionDBCondVar* cv =
+          waiter.cv != nullptr ? waiter.cv.get() : stripe->stripe_cv.get();
+
       TEST_SYNC_POINT("PointLockManager::AcquireWithTimeout:WaitingTxn");
       if (cv_end_time < 0) {
         // Wait indefinitely
-        result = stripe->stripe_cv->Wait(stripe->stripe_mutex);
+        result = cv->Wait(stripe->stripe_mutex);
       } else {
         uint64_t now = env->NowMicros();
         if (static_cast<uint64_t>(cv_end_time) > now) {
-          result = stripe->stripe_cv->WaitFor(stripe->stripe_mutex,
-                                              cv_end_time - now);
+          result = cv->WaitFor(stripe->stripe_mutex, cv_end_time - now);
         }
       }
 
@@ -404,6 +440,10 @@ Status PointLockManager::AcquireWithTimeout(
                                &expire_time_hint, &wait_ids);
       }
     } while (!result.ok() && !timed_out);
+
+    if (waiter.cv != nullptr) {
+      RemoveKeyLockWaiter(stripe, key, &waiter, !result.ok() /* gave_up */);
+    }
   }
 
   stripe->stripe_mutex->UnLock();
@@ -411,6 +451,44 @@ Status PointLockManager::AcquireWithTimeout(
   return result;
 }
 
+void PointLockManager::RemoveKeyLockWaiter(LockMapStripe* stripe,
+                                           const std::string& key,
+                                           KeyLockWaiter* waiter,
+                                           bool gave_up) {
+  auto queue_iter = stripe->wait_queues.find(key);
+  assert(queue_iter != stripe->wait_queues.end());
+  auto& queue = queue_iter->second;
+  auto waiter_iter = std::find(queue.begin(), queue.end(), waiter);
+  assert(waiter_iter != queue.end());
+  const bool was_head = waiter_iter == queue.begin();
+  queue.erase(waiter_iter);
+  if (queue.empty()) {
+    stripe->wait_queues.erase(queue_iter);
+  } else if (was_head && gave_up) {
+    // It may have been woken up in place of the new head
+    WakeUpKeyLockWaiters(stripe, key);
+  }
+}
+
+void PointLockManager::WakeUpKeyLockWaiters(LockMapStripe* stripe,
+                                            const std::string& key) {
+  if (stripe->wait_queues.empty()) {
+    return;
+  }
+  auto queue_iter = stripe->wait_queues.find(key);
+  if (queue_iter == stripe->wait_queues.end()) {
+    return;
+  }
+  // Notified with the stripe mutex held, as the waiters own their condition
+  // variables and may leave as soon as they can lock it
+  for (KeyLockWaiter* waiter : queue_iter->second) {
+    waiter->cv->Notify();
+    if (waiter->exclusive) {
+      break;
+    }
+  }
+}
+
 void PointLockManager::DecrementWaiters(
     const PessimisticTransaction* txn,
     const autovector<TransactionID>& wait_ids) {
@@ -550,7 +628,18 @@ Status PointLockManager::AcquireLocked(LockMap* lock_map, LockMapStripe* stripe,
           // lock_cnt does not change
         } else {
           result = Status::TimedOut(Status::SubCode::kLockTimeout);
-          *txn_ids = lock_info.txn_ids;
+          if (per_key_lock_wait_queues_) {
+            // An upgrading transaction keeps its shared lock, so it does not
+            // wait for itself
+            txn_ids->clear();
+            for (auto id : lock_info.txn_ids) {
+              if (id != txn_lock_info.txn_ids[0]) {
+                txn_ids->push_back(id);
+              }
+            }
+          } else {
+            *txn_ids = lock_info.txn_ids;
+          }
         }
       }
     } else {
@@ -618,6 +707,10 @@ void PointLockManager::UnLockKey(PessimisticTransaction* txn,
     assert(txn->GetExpirationTime() > 0 &&
            txn->GetExpirationTime() < env->NowMicros());
   }
+
+  if (per_key_lock_wait_queues_) {
+    WakeUpKeyLockWaiters(stripe, key);
+  }
 }
 
 void PointLockManager::UnLock(PessimisticTransaction* txn,
@@ -639,8 +732,10 @@ void PointLockManager::UnLock(PessimisticTransaction* txn,
   UnLockKey(txn, key, stripe, lock_map, env);
   stripe->stripe_mutex->UnLock();
 
-  // Signal waiting threads to retry locking
-  stripe->stripe_cv->NotifyAll();
+  if (!per_key_lock_wait_queues_) {
+    // Signal waiting threads to retry locking
+    stripe->stripe_cv->NotifyAll();
+  }
 }
 
 void PointLockManager::UnLock(PessimisticTransaction* txn,
@@ -685,8 +780,10 @@ void PointLockManager::UnLock(PessimisticTransaction* txn,
 
       stripe->stripe_mutex->UnLock();
 
-      // Signal waiting threads to retry locking
-      stripe->stripe_cv->NotifyAll();
+      if (!per_key_lock_wait_queues_) {
+        // Signal waiting threads to retry locking
+        stripe->stripe_cv->NotifyAll();
+      }
     }
   }
 }
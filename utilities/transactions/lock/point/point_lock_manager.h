@@ -23,6 +23,7 @@
 namespace ROCKSDB_NAMESPACE {
 
 class ColumnFamilyHandle;
+struct KeyLockWaiter;
 struct LockInfo;
 struct LockMap;
 struct LockMapStripe;
@@ -100,6 +101,9 @@ class PointLockManager : public LockManager {
   // Limit on number of keys locked per column family
   const int64_t max_num_locks_;
 
+  // TransactionDBOptions::per_key_lock_wait_queues
+  const bool per_key_lock_wait_queues_;
+
   // The following lock order must be satisfied in order to avoid deadlocking
   // ourselves.
   //   - lock_map_mutex_
@@ -147,6 +151,14 @@ class PointLockManager : public LockManager {
   void UnLockKey(PessimisticTransaction* txn, const std::string& key,
                  LockMapStripe* stripe, LockMap* lock_map, Env* env);
 
+  // Dequeues the waiter once it locked the key or gave up. The waiters
+  // woken up are the first one, and if it wants a shared lock, the ones
+  // after it wanting one too.
+  // REQUIRED:  Stripe mutex must be held.
+  void RemoveKeyLockWaiter(LockMapStripe* stripe, const std::string& key,
+                           KeyLockWaiter* waiter, bool gave_up);
+  void WakeUpKeyLockWaiters(LockMapStripe* stripe, const std::string& key);
+
   bool IncrementWaiters(const PessimisticTransaction* txn,
                         const autovector<TransactionID>& wait_ids,
                         const std::string& key, const uint32_t& cf_id,
@@ -69,6 +69,16 @@ class PointLockManagerTest : public testing::Test {
     return reinterpret_cast<PessimisticTransaction*>(txn);
   }
 
+  // Replaces locker_ with one queueing the lock waiters by key
+  void UsePerKeyLockWaitQueues() {
+    TransactionDBOptions txn_opt;
+    txn_opt.transaction_lock_timeout = 0;
+    txn_opt.custom_mutex_factory = mutex_factory_;
+    txn_opt.per_key_lock_wait_queues = true;
+    locker_.reset(new PointLockManager(
+        static_cast<PessimisticTransactionDB*>(db_), txn_opt));
+  }
+
  protected:
   Env* env_;
   std::unique_ptr<PointLockManager> locker_;
@@ -364,6 +374,83 @@ TEST_F(PointLockManagerTest, DeadlockDepthExceeded) {
   delete txn1;
 }
 
+TEST_F(PointLockManagerTest, PerKeyLockWaitQueue) {
+  // Tests that the waiters for a key get the lock in the order they came in.
+  UsePerKeyLockWaitQueues();
+  MockColumnFamilyHandle cf(1);
+  locker_->AddColumnFamily(&cf);
+  TransactionOptions txn_opt;
+  txn_opt.lock_timeout = 1000000;
+  auto txn1 = NewTxn(txn_opt);
+  auto txn2 = NewTxn(txn_opt);
+  auto txn3 = NewTxn(txn_opt);
+
+  ASSERT_OK(locker_->TryLock(txn1, 1, "k", env_, true));
+  port::Thread t2 = BlockUntilWaitingTxn(
+      [&]() { ASSERT_OK(locker_->TryLock(txn2, 1, "k", env_, true)); });
+  port::Thread t3 = BlockUntilWaitingTxn(
+      [&]() { ASSERT_OK(locker_->TryLock(txn3, 1, "k", env_, false)); });
+
+  locker_->UnLock(txn1, 1, "k", env_);
+  t2.join();
+  auto s = locker_->GetPointLockStatus();
+  ASSERT_EQ(s.size(), 1u);
+  ASSERT_TRUE(s.begin()->second.exclusive);
+  ASSERT_EQ(s.begin()->second.ids[0], txn2->GetID());
+
+  locker_->UnLock(txn2, 1, "k", env_);
+  t3.join();
+  s = locker_->GetPointLockStatus();
+  ASSERT_EQ(s.size(), 1u);
+  ASSERT_FALSE(s.begin()->second.exclusive);
+  ASSERT_EQ(s.begin()->second.ids[0], txn3->GetID());
+
+  delete txn3;
+  delete txn2;
+  delete txn1;
+}
+
+TEST_F(PointLockManagerTest, PerKeyLockWaitQueueUpgrade) {
+  // Tests that a txn upgrading its shared lock keeps it while waiting, and
+  // gets the exclusive lock ahead of the txns waiting before it.
+  UsePerKeyLockWaitQueues();
+  MockColumnFamilyHandle cf(1);
+  locker_->AddColumnFamily(&cf);
+  TransactionOptions txn_opt;
+  txn_opt.deadlock_detect = true;
+  txn_opt.lock_timeout = 1000000;
+  auto txn1 = NewTxn(txn_opt);
+  auto txn2 = NewTxn(txn_opt);
+  auto txn3 = NewTxn(txn_opt);
+
+  ASSERT_OK(locker_->TryLock(txn1, 1, "k", env_, false));
+  ASSERT_OK(locker_->TryLock(txn2, 1, "k", env_, false));
+  port::Thread t3 = BlockUntilWaitingTxn(
+      [&]() { ASSERT_OK(locker_->TryLock(txn3, 1, "k", env_, true)); });
+  port::Thread t1 = BlockUntilWaitingTxn(
+      [&]() { ASSERT_OK(locker_->TryLock(txn1, 1, "k", env_, true)); });
+  auto s = locker_->GetPointLockStatus();
+  ASSERT_EQ(s.size(), 1u);
+  ASSERT_EQ(s.begin()->second.ids.size(), 2u);
+
+  locker_->UnLock(txn2, 1, "k", env_);
+  t1.join();
+  s = locker_->GetPointLockStatus();
+  ASSERT_EQ(s.size(), 1u);
+  ASSERT_TRUE(s.begin()->second.exclusive);
+  ASSERT_EQ(s.begin()->second.ids[0], txn1->GetID());
+
+  locker_->UnLock(txn1, 1, "k", env_);
+  t3.join();
+  s = locker_->GetPointLockStatus();
+  ASSERT_EQ(s.size(), 1u);
+  ASSERT_EQ(s.begin()->second.ids[0], txn3->GetID());
+
+  delete txn3;
+  delete txn2;
+  delete txn1;
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -0,0 +1,149 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "utilities/transactions/old_commit_map.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+OldCommitMap::ReadGuard::ReadGuard(const OldCommitMap* map) {
+  for (;;) {
+    uint64_t epoch = map->epoch_.load(std::memory_order_seq_cst);
+    count_ = &map->readers_.Access()->count[epoch & 1];
+    count_->fetch_add(1, std::memory_order_seq_cst);
+    // An update that bumped the epoch in between may not wait for us
+    if (map->epoch_.load(std::memory_order_seq_cst) == epoch) {
+      break;
+    }
+    count_->fetch_sub(1, std::memory_order_release);
+  }
+  view_ = map->view_.load(std::memory_order_acquire);
+}
+
+OldCommitMap::OldCommitMap(std::atomic<bool>* empty)
+    : empty_(empty), view_(new View()), epoch_(0) {}
+
+OldCommitMap::~OldCommitMap() { delete view_.load(std::memory_order_relaxed); }
+
+void OldCommitMap::AddSnapshots(const std::vector<SequenceNumber>& snapshots) {
+  MutexLock l(&mutex_);
+  bool added = false;
+  for (auto snap : snapshots) {
+    auto& prep_seqs = map_[snap];
+    if (prep_seqs == nullptr) {
+      prep_seqs = std::make_shared<const std::vector<SequenceNumber>>();
+      added = true;
+    }
+  }
+  if (added) {
+    Publish();
+  }
+}
+
+void OldCommitMap::Add(SequenceNumber snapshot_seq, SequenceNumber prep_seq) {
+  MutexLock l(&mutex_);
+  auto& prep_seqs = map_[snapshot_seq];
+  std::vector<SequenceNumber>* vec =
+      prep_seqs != nullptr ? new std::vector<SequenceNumber>(*prep_seqs)
+                           : new std::vector<SequenceNumber>();
+  vec->insert(std::upper_bound(vec->begin(), vec->end(), prep_seq), prep_seq);
+  prep_seqs.reset(vec);
+  Publish();
+}
+
+bool OldCommitMap::Erase(SequenceNumber snapshot_seq) {
+  MutexLock l(&mutex_);
+  if (map_.erase(snapshot_seq) == 0) {
+    return false;
+  }
+  Publish();
+  return true;
+}
+
+void OldCommitMap::Clear() {
+  MutexLock l(&mutex_);
+  map_.clear();
+  Publish();
+}
+
+bool OldCommitMap::Lookup(SequenceNumber snapshot_seq, SequenceNumber prep_seq,
+                          bool* snapshot_found) const {
+  ReadGuard guard(this);
+  const View* view = guard.view();
+  auto it = std::lower_bound(view->snapshots.begin(), view->snapshots.end(),
+                             snapshot_seq);
+  *snapshot_found = it != view->snapshots.end() && *it == snapshot_seq;
+  if (!*snapshot_found) {
+    return false;
+  }
+  const auto& prep_seqs = *view->prepared[it - view->snapshots.begin()];
+  return std::binary_search(prep_seqs.begin(), prep_seqs.end(), prep_seq);
+}
+
+bool OldCommitMap::Contains(SequenceNumber snapshot_seq) const {
+  ReadGuard guard(this);
+  const View* view = guard.view();
+  return std::binary_search(view->snapshots.begin(), view->snapshots.end(),
+                            snapshot_seq);
+}
+
+size_t OldCommitMap::size() const {
+  ReadGuard guard(this);
+  return guard.view()->snapshots.size();
+}
+
+std::vector<SequenceNumber> OldCommitMap::Get(
+    SequenceNumber snapshot_seq) const {
+  MutexLock l(&mutex_);
+  auto it = map_.find(snapshot_seq);
+  if (it == map_.end()) {
+    return {};
+  }
+  return *it->second;
+}
+
+void OldCommitMap::Publish() {
+  mutex_.AssertHeld();
+  View* view = new View();
+  view->snapshots.reserve(map_.size());
+  view->prepared.reserve(map_.size());
+  for (const auto& entry : map_) {
+    view->snapshots.push_back(entry.first);
+    view->prepared.push_back(entry.second);
+  }
+  // The flag is cleared before the entries show, and set after they are gone
+  if (!map_.empty()) {
+    empty_->store(false, std::memory_order_release);
+  }
+  const View* old_view = view_.exchange(view, std::memory_order_acq_rel);
+  if (map_.empty()) {
+    empty_->store(true, std::memory_order_release);
+  }
+
+  // Readers that joined the old epoch may use the old view. Those joining
+  // the new one use the new view.
+  uint64_t old_epoch = epoch_.fetch_add(1, std::memory_order_seq_cst);
+  for (;;) {
+    int64_t readers = 0;
+    for (size_t i = 0; i < readers_.Size(); ++i) {
+      readers += readers_.AccessAtCore(i)->count[old_epoch & 1].load(
+          std::memory_order_acquire);
+    }
+    if (readers == 0) {
+      break;
+    }
+    std::this_thread::yield();
+  }
+  delete old_view;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,107 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/types.h"
+#include "util/core_local.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Maps the old snapshots of a WritePreparedTxnDB to the sorted prepare
+// sequence numbers of the transactions evicted from the commit cache that
+// committed after them. Updates are rare, while reads at such snapshots may
+// be frequent, e.g. with long running analytic snapshots, so readers do not
+// lock: updates publish a new immutable view, which shares the arrays of the
+// snapshots they do not change, and free the old one once the readers that
+// may still use it are done. Readers are tracked in per-core counters of
+// two epochs.
+class OldCommitMap {
+ public:
+  // *empty is kept to whether the map is empty, with the updates
+  explicit OldCommitMap(std::atomic<bool>* empty);
+  ~OldCommitMap();
+
+  // No copying allowed
+  OldCommitMap(const OldCommitMap&) = delete;
+  OldCommitMap& operator=(const OldCommitMap&) = delete;
+
+  // Adds empty entries for the snapshots, so that Lookup() tells the reads
+  // at valid snapshots apart from those at released ones.
+  void AddSnapshots(const std::vector<SequenceNumber>& snapshots);
+
+  // Records that prep_seq committed after snapshot_seq.
+  void Add(SequenceNumber snapshot_seq, SequenceNumber prep_seq);
+
+  // Removes the entry of a released snapshot. Returns whether there was one.
+  bool Erase(SequenceNumber snapshot_seq);
+
+  void Clear();
+
+  // Lock-free. Sets *snapshot_found to whether snapshot_seq has an entry,
+  // and returns whether prep_seq committed after it.
+  bool Lookup(SequenceNumber snapshot_seq, SequenceNumber prep_seq,
+              bool* snapshot_found) const;
+
+  bool Contains(SequenceNumber snapshot_seq) const;
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+
+  // The prepare sequence numbers of snapshot_seq, for tests
+  std::vector<SequenceNumber> Get(SequenceNumber snapshot_seq) const;
+
+ private:
+  using PrepSeqs = std::shared_ptr<const std::vector<SequenceNumber>>;
+
+  struct View {
+    // Sorted, prepared[i] being the entry of snapshots[i]
+    std::vector<SequenceNumber> snapshots;
+    std::vector<PrepSeqs> prepared;
+  };
+
+  struct ALIGN_AS(CACHE_LINE_SIZE) ReaderCounts {
+    std::atomic<int64_t> count[2];
+    ReaderCounts() {
+      count[0].store(0, std::memory_order_relaxed);
+      count[1].store(0, std::memory_order_relaxed);
+    }
+    void* operator new[](size_t s) { return port::cacheline_aligned_alloc(s); }
+    void operator delete[](void* p) { port::cacheline_aligned_free(p); }
+  };
+
+  // Pins the current view until destroyed
+  class ReadGuard {
+   public:
+    explicit ReadGuard(const OldCommitMap* map);
+    ~ReadGuard() { count_->fetch_sub(1, std::memory_order_release); }
+    const View* view() const { return view_; }
+
+   private:
+    std::atomic<int64_t>* count_;
+    const View* view_;
+  };
+
+  // Publishes a view of map_ and frees the previous one once unused.
+  // REQUIRES: mutex_ held
+  void Publish();
+
+  // Written with mutex_ held
+  std::map<SequenceNumber, PrepSeqs> map_;
+  std::atomic<bool>* const empty_;
+  mutable port::Mutex mutex_;
+  std::atomic<const View*> view_;
+  std::atomic<uint64_t> epoch_;
+  mutable CoreLocalArray<ReaderCounts> readers_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
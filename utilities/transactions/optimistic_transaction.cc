@@ -15,6 +15,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/status.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
+#include "test_util/sync_point.h"
 #include "util/cast_util.h"
 #include "util/string_util.h"
 #include "utilities/transactions/lock/point/point_lock_tracker.h"
@@ -81,8 +82,26 @@ Status OptimisticTransaction::CommitWithSerialValidate() {
 
   DBImpl* db_impl = static_cast_with_check<DBImpl>(db_->GetRootDB());
 
+  auto txn_db_impl = static_cast_with_check<OptimisticTransactionDBImpl,
+                                            OptimisticTransactionDB>(txn_db_);
+  assert(txn_db_impl);
+  if (txn_db_impl->PrevalidateSerialCommits()) {
+    // The writes up to seq are visible, so the callback only has to look
+    // for the later ones
+    SequenceNumber seq = db_impl->GetLatestSequenceNumber();
+    Status s = TransactionUtil::CheckKeysForConflicts(
+        db_impl, *tracked_locks_, true /* cache_only */);
+    if (!s.ok()) {
+      return s;
+    }
+    prevalidated_seq_ = seq;
+    TEST_SYNC_POINT("OptimisticTransaction::CommitWithSerialValidate:"
+                    "Prevalidated");
+  }
+
   Status s = db_impl->WriteWithCallback(
       write_options_, GetWriteBatch()->GetWriteBatch(), &callback);
+  prevalidated_seq_ = 0;
 
   if (s.ok()) {
     Clear();
@@ -185,8 +204,8 @@ Status OptimisticTransaction::CheckTransactionForConflicts(DB* db) {
   // we will do a cache-only conflict check.  This can result in TryAgain
   // getting returned if there is not sufficient memtable history to check
   // for conflicts.
-  return TransactionUtil::CheckKeysForConflicts(db_impl, *tracked_locks_,
-                                                true /* cache_only */);
+  return TransactionUtil::CheckKeysForConflicts(
+      db_impl, *tracked_locks_, true /* cache_only */, prevalidated_seq_);
 }
 
 Status OptimisticTransaction::SetName(const TransactionName& /* unused */) {
@@ -57,6 +57,10 @@ class OptimisticTransaction : public TransactionBaseImpl {
  private:
   ROCKSDB_FIELD_UNUSED OptimisticTransactionDB* const txn_db_;
 
+  // The sequence number the keys were checked for conflicts up to before
+  // the commit entered the write group, or 0
+  SequenceNumber prevalidated_seq_ = 0;
+
   friend class OptimisticTransactionCallback;
 
   void Initialize(const OptimisticTransactionOptions& txn_options);
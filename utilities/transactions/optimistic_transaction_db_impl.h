@@ -23,7 +23,8 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
       bool take_ownership = true)
       : OptimisticTransactionDB(db),
         db_owner_(take_ownership),
-        validate_policy_(occ_options.validate_policy) {
+        validate_policy_(occ_options.validate_policy),
+        prevalidate_serial_commits_(occ_options.prevalidate_serial_commits) {
     if (validate_policy_ == OccValidationPolicy::kValidateParallel) {
       uint32_t bucket_size = std::max(16u, occ_options.occ_lock_buckets);
       bucketed_locks_.reserve(bucket_size);
@@ -50,6 +51,8 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
 
   OccValidationPolicy GetValidatePolicy() const { return validate_policy_; }
 
+  bool PrevalidateSerialCommits() const { return prevalidate_serial_commits_; }
+
   std::unique_lock<std::mutex> LockBucket(size_t idx);
 
  private:
@@ -61,6 +64,8 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
 
   const OccValidationPolicy validate_policy_;
 
+  const bool prevalidate_serial_commits_;
+
   void ReinitializeTransaction(Transaction* txn,
                                const WriteOptions& write_options,
                                const OptimisticTransactionOptions& txn_options =
@@ -33,6 +33,7 @@ class OptimisticTransactionTest
   OptimisticTransactionDB* txn_db;
   string dbname;
   Options options;
+  bool prevalidate_serial_commits = false;
 
   OptimisticTransactionTest() {
     options.create_if_missing = true;
@@ -59,6 +60,7 @@ private:
     ColumnFamilyOptions cf_options(options);
     OptimisticTransactionDBOptions occ_opts;
     occ_opts.validate_policy = GetParam();
+    occ_opts.prevalidate_serial_commits = prevalidate_serial_commits;
     std::vector<ColumnFamilyDescriptor> column_families;
     std::vector<ColumnFamilyHandle*> handles;
     column_families.push_back(
@@ -103,6 +105,54 @@ TEST_P(OptimisticTransactionTest, SuccessTest) {
   delete txn;
 }
 
+TEST_P(OptimisticTransactionTest, PrevalidateSerialCommits) {
+  if (GetParam() != OccValidationPolicy::kValidateSerial) {
+    return;
+  }
+  prevalidate_serial_commits = true;
+  Reopen();
+  WriteOptions write_options;
+  ReadOptions read_options;
+  string value;
+
+  ASSERT_OK(txn_db->Put(write_options, "foo", "bar"));
+
+  // Conflict found before the write group
+  Transaction* txn = txn_db->BeginTransaction(write_options);
+  ASSERT_OK(txn->GetForUpdate(read_options, "foo", &value));
+  ASSERT_OK(txn->Put("foo2", "bar2"));
+  ASSERT_OK(txn_db->Put(write_options, "foo", "bar3"));
+  ASSERT_TRUE(txn->Commit().IsBusy());
+  delete txn;
+
+  // Conflict written after the check before the write group, found in it
+  txn = txn_db->BeginTransaction(write_options);
+  ASSERT_OK(txn->GetForUpdate(read_options, "foo", &value));
+  ASSERT_OK(txn->Put("foo2", "bar2"));
+  SyncPoint::GetInstance()->SetCallBack(
+      "OptimisticTransaction::CommitWithSerialValidate:Prevalidated",
+      [&](void* /*arg*/) {
+        ASSERT_OK(txn_db->Put(write_options, "foo", "bar4"));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_TRUE(txn->Commit().IsBusy());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  delete txn;
+
+  // No conflict
+  txn = txn_db->BeginTransaction(write_options);
+  ASSERT_OK(txn->GetForUpdate(read_options, "foo", &value));
+  ASSERT_EQ("bar4", value);
+  ASSERT_OK(txn->Put("foo", "bar5"));
+  ASSERT_OK(txn->Commit());
+  delete txn;
+
+  ASSERT_OK(txn_db->Get(read_options, "foo", &value));
+  ASSERT_EQ("bar5", value);
+  ASSERT_TRUE(txn_db->Get(read_options, "foo2", &value).IsNotFound());
+}
+
 TEST_P(OptimisticTransactionTest, WriteConflictTest) {
   WriteOptions write_options;
   ReadOptions read_options;
@@ -7,6 +7,7 @@
 
 #include "utilities/transactions/transaction_util.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <string>
 #include <vector>
@@ -138,8 +139,10 @@ Status TransactionUtil::CheckKey(DBImpl* db_impl, SuperVersion* sv,
 
 Status TransactionUtil::CheckKeysForConflicts(DBImpl* db_impl,
                                               const LockTracker& tracker,
-                                              bool cache_only) {
+                                              bool cache_only,
+                                              SequenceNumber validated_seq) {
   Status result;
+  std::vector<const std::string*> keys;
 
   std::unique_ptr<LockTracker::ColumnFamilyIterator> cf_it(
       tracker.GetColumnFamilyIterator());
@@ -159,15 +162,23 @@ Status TransactionUtil::CheckKeysForConflicts(DBImpl* db_impl,
 
     // For each of the keys in this transaction, check to see if someone has
     // written to this key since the start of the transaction.
+    keys.clear();
     std::unique_ptr<LockTracker::KeyIterator> key_it(
         tracker.GetKeyIterator(cf));
     assert(key_it != nullptr);
     while (key_it->HasNext()) {
-      const std::string& key = key_it->Next();
-      PointLockStatus status = tracker.GetPointLockStatus(cf, key);
-      const SequenceNumber key_seq = status.seq;
-
-      result = CheckKey(db_impl, sv, earliest_seq, key_seq, key, cache_only);
+      keys.push_back(&key_it->Next());
+    }
+    const Comparator* ucmp = sv->cfd->user_comparator();
+    std::sort(keys.begin(), keys.end(),
+              [ucmp](const std::string* a, const std::string* b) {
+                return ucmp->Compare(*a, *b) < 0;
+              });
+    for (const std::string* key : keys) {
+      PointLockStatus status = tracker.GetPointLockStatus(cf, *key);
+      const SequenceNumber key_seq = std::max(status.seq, validated_seq);
+
+      result = CheckKey(db_impl, sv, earliest_seq, key_seq, *key, cache_only);
       if (!result.ok()) {
         break;
       }
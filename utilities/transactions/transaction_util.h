@@ -46,7 +46,11 @@ class TransactionUtil {
 
   // For each key,SequenceNumber pair tracked by the LockTracker, this function
   // will verify there have been no writes to the key in the db since that
-  // sequence number.
+  // sequence number. The keys of a column family are looked up in sorted
+  // order, for locality in the memtables and SST files.
+  //
+  // If validated_seq is not 0, the keys were checked up to that sequence
+  // number already, and only the writes after it are looked for.
   //
   // Returns OK on success, BUSY if there is a conflicting write, or other error
   // status for any unexpected errors.
@@ -57,7 +61,8 @@ class TransactionUtil {
   // tracker must support point lock.
   static Status CheckKeysForConflicts(DBImpl* db_impl,
                                       const LockTracker& tracker,
-                                      bool cache_only);
+                                      bool cache_only,
+                                      SequenceNumber validated_seq = 0);
 
  private:
   // If `snap_checker` == nullptr, writes are always commited in sequence number
@@ -1049,37 +1049,33 @@ TEST_P(WritePreparedTransactionTest, OldCommitMapGC) {
   // old_commit_map_
   {
     ASSERT_FALSE(wp_db->old_commit_map_empty_.load());
-    ReadLock rl(&wp_db->old_commit_map_mutex_);
     ASSERT_EQ(3, wp_db->old_commit_map_.size());
-    ASSERT_EQ(2, UniqueCnt(wp_db->old_commit_map_[snap_seq1]));
-    ASSERT_EQ(1, UniqueCnt(wp_db->old_commit_map_[snap_seq2]));
-    ASSERT_EQ(1, UniqueCnt(wp_db->old_commit_map_[snap_seq3]));
+    ASSERT_EQ(2, UniqueCnt(wp_db->old_commit_map_.Get(snap_seq1)));
+    ASSERT_EQ(1, UniqueCnt(wp_db->old_commit_map_.Get(snap_seq2)));
+    ASSERT_EQ(1, UniqueCnt(wp_db->old_commit_map_.Get(snap_seq3)));
   }
 
   // Verify that the 2nd snapshot is cleaned up after the release
   wp_db->ReleaseSnapshotInternal(snap_seq2);
   {
     ASSERT_FALSE(wp_db->old_commit_map_empty_.load());
-    ReadLock rl(&wp_db->old_commit_map_mutex_);
     ASSERT_EQ(2, wp_db->old_commit_map_.size());
-    ASSERT_EQ(2, UniqueCnt(wp_db->old_commit_map_[snap_seq1]));
-    ASSERT_EQ(1, UniqueCnt(wp_db->old_commit_map_[snap_seq3]));
+    ASSERT_EQ(2, UniqueCnt(wp_db->old_commit_map_.Get(snap_seq1)));
+    ASSERT_EQ(1, UniqueCnt(wp_db->old_commit_map_.Get(snap_seq3)));
   }
 
   // Verify that the 1st snapshot is cleaned up after the release
   wp_db->ReleaseSnapshotInternal(snap_seq1);
   {
     ASSERT_FALSE(wp_db->old_commit_map_empty_.load());
-    ReadLock rl(&wp_db->old_commit_map_mutex_);
     ASSERT_EQ(1, wp_db->old_commit_map_.size());
-    ASSERT_EQ(1, UniqueCnt(wp_db->old_commit_map_[snap_seq3]));
+    ASSERT_EQ(1, UniqueCnt(wp_db->old_commit_map_.Get(snap_seq3)));
   }
 
   // Verify that the 3rd snapshot is cleaned up after the release
   wp_db->ReleaseSnapshotInternal(snap_seq3);
   {
     ASSERT_TRUE(wp_db->old_commit_map_empty_.load());
-    ReadLock rl(&wp_db->old_commit_map_mutex_);
     ASSERT_EQ(0, wp_db->old_commit_map_.size());
   }
 }
@@ -1124,7 +1120,7 @@ TEST_P(WritePreparedTransactionTest, CheckAgainstSnapshots) {
     CommitEntry commit_entry = {snapshots.front() + 1,
                                 snapshots[cache_size - 1] - 1};
     wp_db->old_commit_map_empty_ = true;  // reset
-    wp_db->old_commit_map_.clear();
+    wp_db->old_commit_map_.Clear();
     wp_db->CheckAgainstSnapshots(commit_entry);
     ASSERT_EQ(wp_db->old_commit_map_.size(), cache_size - 2);
   }
@@ -1135,7 +1131,7 @@ TEST_P(WritePreparedTransactionTest, CheckAgainstSnapshots) {
     CommitEntry commit_entry = {snapshots[cache_size] + 1,
                                 snapshots[cache_size + 2] + 1};
     wp_db->old_commit_map_empty_ = true;  // reset
-    wp_db->old_commit_map_.clear();
+    wp_db->old_commit_map_.Clear();
     wp_db->CheckAgainstSnapshots(commit_entry);
     ASSERT_EQ(wp_db->old_commit_map_.size(), 2);
   }
@@ -1145,7 +1141,7 @@ TEST_P(WritePreparedTransactionTest, CheckAgainstSnapshots) {
   {
     CommitEntry commit_entry = {snapshots.front() - 1, snapshots.back() + 1};
     wp_db->old_commit_map_empty_ = true;  // reset
-    wp_db->old_commit_map_.clear();
+    wp_db->old_commit_map_.Clear();
     wp_db->CheckAgainstSnapshots(commit_entry);
     ASSERT_EQ(wp_db->old_commit_map_.size(), snapshots.size());
   }
@@ -1154,7 +1150,7 @@ TEST_P(WritePreparedTransactionTest, CheckAgainstSnapshots) {
   {
     CommitEntry commit_entry = {snapshots.front() + 1, snapshots.back() + 1};
     wp_db->old_commit_map_empty_ = true;  // reset
-    wp_db->old_commit_map_.clear();
+    wp_db->old_commit_map_.Clear();
     wp_db->CheckAgainstSnapshots(commit_entry);
     ASSERT_EQ(wp_db->old_commit_map_.size(), snapshots.size() - 1);
   }
@@ -1164,7 +1160,7 @@ TEST_P(WritePreparedTransactionTest, CheckAgainstSnapshots) {
     CommitEntry commit_entry = {snapshots[cache_size - 1] - 1,
                                 snapshots.back() + 1};
     wp_db->old_commit_map_empty_ = true;  // reset
-    wp_db->old_commit_map_.clear();
+    wp_db->old_commit_map_.Clear();
     wp_db->CheckAgainstSnapshots(commit_entry);
     ASSERT_EQ(wp_db->old_commit_map_.size(), snapshots.size() - cache_size + 1);
   }
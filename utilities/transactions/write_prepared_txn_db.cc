@@ -638,13 +638,9 @@ void WritePreparedTxnDB::AdvanceMaxEvictedSeq(const SequenceNumber& prev_max,
   if (update_snapshots) {
     UpdateSnapshots(snapshots, new_snapshots_version);
     if (!snapshots.empty()) {
-      WriteLock wl(&old_commit_map_mutex_);
-      for (auto snap : snapshots) {
-        // This allows IsInSnapshot to tell apart the reads from in valid
-        // snapshots from the reads from committed values in valid snapshots.
-        old_commit_map_[snap];
-      }
-      old_commit_map_empty_.store(false, std::memory_order_release);
+      // This allows IsInSnapshot to tell apart the reads from in valid
+      // snapshots from the reads from committed values in valid snapshots.
+      old_commit_map_.AddSnapshots(snapshots);
     }
   }
   auto updated_prev_max = prev_max;
@@ -760,23 +756,11 @@ void WritePreparedTxnDB::ReleaseSnapshotInternal(
     // advances. It is expected for a few read-only backup snapshots. For such
     // snapshots we might have kept around a couple of entries in the
     // old_commit_map_. Check and do garbage collection if that is the case.
-    bool need_gc = false;
-    {
-      WPRecordTick(TXN_OLD_COMMIT_MAP_MUTEX_OVERHEAD);
-      ROCKS_LOG_WARN(info_log_, "old_commit_map_mutex_ overhead for %" PRIu64,
-                     snap_seq);
-      ReadLock rl(&old_commit_map_mutex_);
-      auto prep_set_entry = old_commit_map_.find(snap_seq);
-      need_gc = prep_set_entry != old_commit_map_.end();
-    }
-    if (need_gc) {
+    if (old_commit_map_.Contains(snap_seq)) {
       WPRecordTick(TXN_OLD_COMMIT_MAP_MUTEX_OVERHEAD);
       ROCKS_LOG_WARN(info_log_, "old_commit_map_mutex_ overhead for %" PRIu64,
                      snap_seq);
-      WriteLock wl(&old_commit_map_mutex_);
-      old_commit_map_.erase(snap_seq);
-      old_commit_map_empty_.store(old_commit_map_.empty(),
-                                  std::memory_order_release);
+      old_commit_map_.Erase(snap_seq);
     }
   }
 }
@@ -953,10 +937,7 @@ bool WritePreparedTxnDB::MaybeUpdateOldCommitMap(
                    "old_commit_map_mutex_ overhead for %" PRIu64
                    " commit entry: <%" PRIu64 ",%" PRIu64 ">",
                    snapshot_seq, prep_seq, commit_seq);
-    WriteLock wl(&old_commit_map_mutex_);
-    old_commit_map_empty_.store(false, std::memory_order_release);
-    auto& vec = old_commit_map_[snapshot_seq];
-    vec.insert(std::upper_bound(vec.begin(), vec.end(), prep_seq), prep_seq);
+    old_commit_map_.Add(snapshot_seq, prep_seq);
     // We need to store it once for each overlapping snapshot. Returning true to
     // continue the search if there is more overlapping snapshot.
     return true;
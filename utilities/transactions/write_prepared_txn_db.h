@@ -24,6 +24,7 @@
 #include "util/cast_util.h"
 #include "util/set_comparator.h"
 #include "util/string_util.h"
+#include "utilities/transactions/old_commit_map.h"
 #include "utilities/transactions/pessimistic_transaction.h"
 #include "utilities/transactions/pessimistic_transaction_db.h"
 #include "utilities/transactions/write_prepared_txn.h"
@@ -283,17 +284,12 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
       return true;
     }
     {
-      // We should not normally reach here unless sapshot_seq is old. This is a
-      // rare case and it is ok to pay the cost of mutex ReadLock for such old,
-      // reading transactions.
-      WPRecordTick(TXN_OLD_COMMIT_MAP_MUTEX_OVERHEAD);
-      ReadLock rl(&old_commit_map_mutex_);
-      auto prep_set_entry = old_commit_map_.find(snapshot_seq);
-      bool found = prep_set_entry != old_commit_map_.end();
-      if (found) {
-        auto& vec = prep_set_entry->second;
-        found = std::binary_search(vec.begin(), vec.end(), prep_seq);
-      } else {
+      // We should not normally reach here unless sapshot_seq is old, e.g. the
+      // snapshot of a long running analytic read. The lookup takes no lock.
+      bool snapshot_found = false;
+      bool found =
+          old_commit_map_.Lookup(snapshot_seq, prep_seq, &snapshot_found);
+      if (!snapshot_found) {
         // coming from compaction
         ROCKS_LOG_DETAILS(info_log_,
                           "IsInSnapshot %" PRIu64 " in %" PRIu64
@@ -766,8 +762,8 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
   // the snapshot, to which they are mapped, cannot assume to be committed just
   // because it is no longer in the commit_cache_. The vector must be sorted
   // after each update.
-  // Thread-safety is provided with old_commit_map_mutex_.
-  std::map<SequenceNumber, std::vector<SequenceNumber>> old_commit_map_;
+  // Thread-safety is provided by OldCommitMap, whose readers do not lock.
+  OldCommitMap old_commit_map_{&old_commit_map_empty_};
   // A set of long-running prepared transactions that are not finished by the
   // time max_evicted_seq_ advances their sequence number. This is expected to
   // be empty normally. Thread-safety is provided with prepared_mutex_.
@@ -780,10 +776,10 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
   // Update when delayed_prepared_.empty() changes. Expected to be true
   // normally.
   std::atomic<bool> delayed_prepared_empty_ = {true};
-  // Update when old_commit_map_.empty() changes. Expected to be true normally.
+  // Updated by old_commit_map_ when its emptiness changes. Expected to be
+  // true normally.
   std::atomic<bool> old_commit_map_empty_ = {true};
   mutable port::RWMutex prepared_mutex_;
-  mutable port::RWMutex old_commit_map_mutex_;
   mutable port::RWMutex commit_cache_mutex_;
   mutable port::RWMutex snapshots_mutex_;
   // A cache of the cf comparators
@@ -6,6 +6,8 @@
 
 #include "utilities/ttl/db_ttl_impl.h"
 
+#include <algorithm>
+
 #include "db/write_batch_internal.h"
 #include "file/filename.h"
 #include "rocksdb/convenience.h"
@@ -16,6 +18,11 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+const char* TtlTablePropertiesCollector::kMinTimestamp =
+    "rocksdb.ttl.min.timestamp";
+const char* TtlTablePropertiesCollector::kMaxTimestamp =
+    "rocksdb.ttl.max.timestamp";
+
 void DBWithTTLImpl::SanitizeOptions(int32_t ttl, ColumnFamilyOptions* options,
                                     Env* env) {
   if (options->compaction_filter) {
@@ -31,6 +38,9 @@ void DBWithTTLImpl::SanitizeOptions(int32_t ttl, ColumnFamilyOptions* options,
     options->merge_operator.reset(
         new TtlMergeOperator(options->merge_operator, env));
   }
+
+  options->table_properties_collector_factories.push_back(
+      std::make_shared<TtlTablePropertiesCollectorFactory>());
 }
 
 // Open the db inside DBWithTTLImpl because options needs pointer to its ttl
@@ -330,5 +340,103 @@ void DBWithTTLImpl::SetTtl(ColumnFamilyHandle *h, int32_t ttl) {
   filter->SetTtl(ttl);
 }
 
+Status DBWithTTLImpl::DropExpiredFiles(ColumnFamilyHandle* column_family,
+                                       double compact_expired_ratio) {
+  Options opts = GetOptions(column_family);
+  int32_t ttl;
+  if (opts.compaction_filter != nullptr) {
+    ttl = static_cast<const TtlCompactionFilter*>(opts.compaction_filter)
+              ->GetTtl();
+  } else {
+    ttl = std::static_pointer_cast<TtlCompactionFilterFactory>(
+              opts.compaction_filter_factory)
+              ->GetTtl();
+  }
+  if (ttl <= 0) {
+    return Status::OK();
+  }
+  int64_t curtime;
+  Status s = GetEnv()->GetCurrentTime(&curtime);
+  if (!s.ok()) {
+    return s;
+  }
+
+  TablePropertiesCollection props;
+  s = GetPropertiesOfAllTables(column_family, &props);
+  if (!s.ok()) {
+    return s;
+  }
+  std::vector<LiveFileMetaData> all_files;
+  GetLiveFilesMetaData(&all_files);
+  std::vector<LiveFileMetaData> files;
+  int last_level = 0;
+  for (auto& file : all_files) {
+    if (file.column_family_name == column_family->GetName()) {
+      last_level = std::max(last_level, file.level);
+      files.push_back(std::move(file));
+    }
+  }
+  // The oldest files of level 0 first
+  std::sort(files.begin(), files.end(),
+            [](const LiveFileMetaData& a, const LiveFileMetaData& b) {
+              if (a.level != b.level) {
+                return a.level > b.level;
+              }
+              return a.smallest_seqno < b.smallest_seqno;
+            });
+
+  bool dropping_level0 = last_level == 0;
+  for (const auto& file : files) {
+    if (file.being_compacted) {
+      dropping_level0 = false;
+      continue;
+    }
+    auto it = props.find(file.db_path + file.name);
+    if (it == props.end()) {
+      dropping_level0 = false;
+      continue;
+    }
+    const UserCollectedProperties& user_props =
+        it->second->user_collected_properties;
+    auto min_it = user_props.find(TtlTablePropertiesCollector::kMinTimestamp);
+    auto max_it = user_props.find(TtlTablePropertiesCollector::kMaxTimestamp);
+    if (min_it == user_props.end() || max_it == user_props.end() ||
+        min_it->second.size() != sizeof(uint32_t) ||
+        max_it->second.size() != sizeof(uint32_t)) {
+      dropping_level0 = false;
+      continue;
+    }
+    int64_t min_timestamp =
+        static_cast<int32_t>(DecodeFixed32(min_it->second.data()));
+    int64_t max_timestamp =
+        static_cast<int32_t>(DecodeFixed32(max_it->second.data()));
+
+    bool droppable = file.level == last_level &&
+                     (file.level > 0 || dropping_level0);
+    if (max_timestamp + ttl < curtime && droppable) {
+      s = DeleteFile(file.name);
+      if (!s.ok()) {
+        return s;
+      }
+      continue;
+    }
+    dropping_level0 = false;
+
+    // Timestamps taken as spread evenly between the oldest and newest one
+    double expired_ratio =
+        static_cast<double>(curtime - ttl - min_timestamp) /
+        static_cast<double>(max_timestamp - min_timestamp + 1);
+    if (file.level > 0 && compact_expired_ratio <= 1.0 &&
+        expired_ratio >= compact_expired_ratio) {
+      s = CompactFiles(CompactionOptions(), column_family, {file.name},
+                       file.level);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  }
+  return Status::OK();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 #endif  // ROCKSDB_LITE
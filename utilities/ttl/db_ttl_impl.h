@@ -6,6 +6,7 @@
 #pragma once
 
 #ifndef ROCKSDB_LITE
+#include <algorithm>
 #include <deque>
 #include <string>
 #include <vector>
@@ -15,8 +16,10 @@
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/merge_operator.h"
+#include "rocksdb/table_properties.h"
 #include "rocksdb/utilities/db_ttl.h"
 #include "rocksdb/utilities/utility_db.h"
+#include "util/string_util.h"
 #include "utilities/compaction_filters/layered_compaction_filter_base.h"
 
 #ifdef _WIN32
@@ -102,6 +105,9 @@ class DBWithTTLImpl : public DBWithTTL {
 
   void SetTtl(ColumnFamilyHandle *h, int32_t ttl) override;
 
+  Status DropExpiredFiles(ColumnFamilyHandle* column_family,
+                          double compact_expired_ratio) override;
+
  private:
   // remember whether the Close completes or not
   bool closed_;
@@ -186,6 +192,8 @@ class TtlCompactionFilter : public LayeredCompactionFilterBase {
 
   virtual const char* Name() const override { return "Delete By TTL"; }
 
+  int32_t GetTtl() const { return ttl_; }
+
  private:
   int32_t ttl_;
   Env* env_;
@@ -215,6 +223,8 @@ class TtlCompactionFilterFactory : public CompactionFilterFactory {
     ttl_ = ttl;
   }
 
+  int32_t GetTtl() const { return ttl_; }
+
   virtual const char* Name() const override {
     return "TtlCompactionFilterFactory";
   }
@@ -225,6 +235,69 @@ class TtlCompactionFilterFactory : public CompactionFilterFactory {
   std::shared_ptr<CompactionFilterFactory> user_comp_filter_factory_;
 };
 
+// Records the oldest and newest timestamps of the values and merge operands
+// of a table file, for DBWithTTLImpl::DropExpiredFiles()
+class TtlTablePropertiesCollector : public TablePropertiesCollector {
+ public:
+  // Fixed32 encoded
+  static const char* kMinTimestamp;
+  static const char* kMaxTimestamp;
+
+  TtlTablePropertiesCollector()
+      : min_timestamp_(DBWithTTLImpl::kMaxTimestamp), max_timestamp_(0) {}
+
+  Status AddUserKey(const Slice& /*key*/, const Slice& value, EntryType type,
+                    SequenceNumber /*seq*/, uint64_t /*file_size*/) override {
+    if ((type == kEntryPut || type == kEntryMerge) &&
+        value.size() >= DBWithTTLImpl::kTSLength) {
+      int32_t timestamp = static_cast<int32_t>(DecodeFixed32(
+          value.data() + value.size() - DBWithTTLImpl::kTSLength));
+      min_timestamp_ = std::min(min_timestamp_, timestamp);
+      max_timestamp_ = std::max(max_timestamp_, timestamp);
+    }
+    return Status::OK();
+  }
+
+  Status Finish(UserCollectedProperties* properties) override {
+    if (max_timestamp_ >= min_timestamp_) {
+      std::string value;
+      PutFixed32(&value, static_cast<uint32_t>(min_timestamp_));
+      properties->insert({kMinTimestamp, value});
+      value.clear();
+      PutFixed32(&value, static_cast<uint32_t>(max_timestamp_));
+      properties->insert({kMaxTimestamp, value});
+    }
+    return Status::OK();
+  }
+
+  UserCollectedProperties GetReadableProperties() const override {
+    if (max_timestamp_ < min_timestamp_) {
+      return {};
+    }
+    return {{kMinTimestamp, ToString(min_timestamp_)},
+            {kMaxTimestamp, ToString(max_timestamp_)}};
+  }
+
+  const char* Name() const override { return "TtlTablePropertiesCollector"; }
+
+ private:
+  int32_t min_timestamp_;
+  int32_t max_timestamp_;
+};
+
+class TtlTablePropertiesCollectorFactory
+    : public TablePropertiesCollectorFactory {
+ public:
+  TablePropertiesCollector* CreateTablePropertiesCollector(
+      TablePropertiesCollectorFactory::Context /*context*/) override {
+    return new TtlTablePropertiesCollector();
+  }
+
+  const char* Name() const override {
+    return "TtlTablePropertiesCollectorFactory";
+  }
+};
+
 class TtlMergeOperator : public MergeOperator {
 
  public:
@@ -673,6 +673,35 @@ TEST_F(TtlTest, ChangeTtlOnOpenDb) {
   CloseTtl();
 }
 
+// Drops the file of expired values from the timestamps in its properties
+TEST_F(TtlTest, DropExpiredFiles) {
+  MakeKVMap(kSampleSize_);
+
+  OpenTtl(2);                  // T=0:Open the db with ttl = 2
+  PutValues(0, kSampleSize_);  // T=0:Insert Set1. Delete at t=2
+  TablePropertiesCollection props;
+  ASSERT_OK(db_ttl_->GetPropertiesOfAllTables(&props));
+  ASSERT_EQ(1U, props.size());
+  const UserCollectedProperties& user_props =
+      props.begin()->second->user_collected_properties;
+  ASSERT_EQ(1U, user_props.count("rocksdb.ttl.min.timestamp"));
+  ASSERT_EQ(1U, user_props.count("rocksdb.ttl.max.timestamp"));
+
+  std::vector<LiveFileMetaData> files;
+  ASSERT_OK(db_ttl_->DropExpiredFiles(db_ttl_->DefaultColumnFamily()));
+  db_ttl_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(1U, files.size());  // T=0:Set1 not expired
+
+  env_->Sleep(3);
+  ASSERT_OK(db_ttl_->DropExpiredFiles(db_ttl_->DefaultColumnFamily()));
+  files.clear();
+  db_ttl_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(0U, files.size());  // T=3:Set1 dropped without a compaction
+  std::string value;
+  ASSERT_TRUE(db_ttl_->Get(ReadOptions(), "keymock", &value).IsNotFound());
+  CloseTtl();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 // A black-box test for the ttl wrapper around rocksdb
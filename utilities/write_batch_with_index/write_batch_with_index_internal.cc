@@ -119,6 +119,11 @@ int WriteBatchEntryComparator::operator()(
     return 1;
   }
 
+  if (entry1->key_prefix != entry2->key_prefix &&
+      IsBytewise(entry1->column_family)) {
+    return entry1->key_prefix < entry2->key_prefix ? -1 : 1;
+  }
+
   Slice key1, key2;
   if (entry1->search_key == nullptr) {
     key1 = Slice(write_batch_->Data().data() + entry1->key_offset,
@@ -6,6 +6,7 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <algorithm>
 #include <limits>
 #include <string>
 #include <vector>
@@ -25,11 +26,13 @@ struct Options;
 
 // Key used by skip list, as the binary searchable index of WriteBatchWithIndex.
 struct WriteBatchIndexEntry {
-  WriteBatchIndexEntry(size_t o, uint32_t c, size_t ko, size_t ksz)
+  WriteBatchIndexEntry(size_t o, uint32_t c, size_t ko, size_t ksz,
+                       uint64_t kp)
       : offset(o),
         column_family(c),
         key_offset(ko),
         key_size(ksz),
+        key_prefix(kp),
         search_key(nullptr) {}
   // Create a dummy entry as the search key. This index entry won't be backed
   // by an entry from the write batch, but a pointer to the search key. Or a
@@ -47,10 +50,24 @@ struct WriteBatchIndexEntry {
         column_family(_column_family),
         key_offset(0),
         key_size(is_seek_to_first ? kFlagMinInCf : 0),
+        key_prefix(_search_key != nullptr ? KeyPrefix(*_search_key) : 0),
         search_key(_search_key) {
     assert(_search_key != nullptr || is_seek_to_first);
   }
 
+  // The first 8 bytes of key, zero padded, as a big-endian number. When the
+  // prefixes of two keys differ, they compare like the keys do with the
+  // bytewise comparator.
+  static uint64_t KeyPrefix(const Slice& key) {
+    uint64_t prefix = 0;
+    const size_t n = std::min(key.size(), sizeof(prefix));
+    for (size_t i = 0; i < n; i++) {
+      prefix |= static_cast<uint64_t>(static_cast<unsigned char>(key[i]))
+                << (56 - 8 * i);
+    }
+    return prefix;
+  }
+
   // If this flag appears in the key_size, it indicates a
   // key that is smaller than any other entry for the same column family.
   static const size_t kFlagMinInCf = port::kMaxSizet;
@@ -77,6 +94,9 @@ struct WriteBatchIndexEntry {
                            // SeekToFirst() to the beginning of the column
                            // family. We use the flag here to save a boolean
                            // in the struct.
+  uint64_t key_prefix;     // KeyPrefix() of the key, for comparing most
+                           // keys without reading them from the write
+                           // batch's buffer.
 
   const Slice* search_key;  // if not null, instead of reading keys from
                             // write batch, use it to compare. This is used
@@ -97,7 +117,9 @@ class WriteBatchEntryComparator {
  public:
   WriteBatchEntryComparator(const Comparator* _default_comparator,
                             const ReadableWriteBatch* write_batch)
-      : default_comparator_(_default_comparator), write_batch_(write_batch) {}
+      : default_comparator_(_default_comparator),
+        default_is_bytewise_(_default_comparator == BytewiseComparator()),
+        write_batch_(write_batch) {}
   // Compare a and b. Return a negative value if a is less than b, 0 if they
   // are equal, and a positive value if a is greater than b
   int operator()(const WriteBatchIndexEntry* entry1,
@@ -110,15 +132,28 @@ class WriteBatchEntryComparator {
                           const Comparator* comparator) {
     if (column_family_id >= cf_comparators_.size()) {
       cf_comparators_.resize(column_family_id + 1, nullptr);
+      cf_is_bytewise_.resize(column_family_id + 1, false);
     }
     cf_comparators_[column_family_id] = comparator;
+    cf_is_bytewise_[column_family_id] = comparator == BytewiseComparator();
   }
 
   const Comparator* default_comparator() { return default_comparator_; }
 
  private:
+  bool IsBytewise(uint32_t column_family) const {
+    if (column_family < cf_comparators_.size() &&
+        cf_comparators_[column_family] != nullptr) {
+      return cf_is_bytewise_[column_family];
+    }
+    return default_is_bytewise_;
+  }
+
   const Comparator* default_comparator_;
+  // Whether the key prefixes of the index entries order them
+  const bool default_is_bytewise_;
   std::vector<const Comparator*> cf_comparators_;
+  std::vector<bool> cf_is_bytewise_;
   const ReadableWriteBatch* write_batch_;
 };
 
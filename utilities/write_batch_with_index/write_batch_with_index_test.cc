@@ -12,6 +12,7 @@
 #include "rocksdb/utilities/write_batch_with_index.h"
 #include <map>
 #include <memory>
+#include <set>
 #include "db/column_family.h"
 #include "port/stack_trace.h"
 #include "test_util/testharness.h"
@@ -1827,6 +1828,42 @@ TEST_F(WriteBatchWithIndexTest, SingleDeleteDeltaIterTest) {
   ASSERT_EQ("B:b3,E:ee,", value);
 }
 
+TEST_F(WriteBatchWithIndexTest, KeyPrefixOrder) {
+  // Keys sharing prefixes, shorter than the inline key prefix, or with
+  // zero bytes that look like its padding are still ordered bytewise
+  Random rnd(301);
+  const char kBytes[] = {'\0', '\1', 'a', '\xff'};
+  std::set<std::string> keys;
+  WriteBatchWithIndex batch(BytewiseComparator(), 20, true /* overwrite_key */);
+  for (int i = 0; i < 2000; i++) {
+    std::string key;
+    const int len = static_cast<int>(rnd.Uniform(13));
+    for (int j = 0; j < len; j++) {
+      key.push_back(kBytes[rnd.Uniform(sizeof(kBytes))]);
+    }
+    keys.insert(key);
+    ASSERT_OK(batch.Put(key, key));
+  }
+
+  std::unique_ptr<WBWIIterator> iter(batch.NewIterator());
+  iter->SeekToFirst();
+  for (const auto& key : keys) {
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key, iter->Entry().key.ToString());
+    iter->Next();
+  }
+  ASSERT_FALSE(iter->Valid());
+
+  for (const auto& key : keys) {
+    iter->Seek(key);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key, iter->Entry().key.ToString());
+    std::string value;
+    ASSERT_OK(batch.GetFromBatch(DBOptions(), key, &value));
+    ASSERT_EQ(key, value);
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {